@@ -42,19 +42,23 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <ctype.h>
 #include <unistd.h>
 #include <stdarg.h>
 #include <inttypes.h>
 #include <errno.h>
 #include <signal.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <time.h>
 #include <syslog.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/param.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -64,6 +68,7 @@
 
 /* clicon */
 #include <clixon/clixon.h>
+#include <clixon/clixon_probe.h>
 
 #include "clixon_backend_client.h"
 #include "clixon_backend_plugin.h"
@@ -71,23 +76,18 @@
 #include "backend_handle.h"
 #include "backend_get.h"
 #include "backend_client.h"
+#include "backend_stats.h"
+#include "backend_push.h"
+#include "backend_private.h"
+#include "backend_standby.h"
+#include "backend_job.h"
+#include "backend_socket.h"
 
-/*! Find client by session-id 
- *
- * @param[in] ce_list   List of clients
- * @param[in] id        Session id
- */
-static struct client_entry *
-ce_find_byid(struct client_entry *ce_list,
-             uint32_t             id)
-{
-    struct client_entry *ce;
-
-    for (ce = ce_list; ce; ce = ce->ce_next)
-        if (ce->ce_id == id)
-            return ce;
-    return NULL;
-}
+static int client_stream_notify(struct client_entry *ce, cxobj *event);
+static void client_stream_free(struct client_entry *ce);
+static int client_stream_next(int fd, void *arg);
+static int client_notify(clicon_handle h, struct client_entry *ce, cxobj *event);
+static size_t client_output_queued(struct client_entry *ce);
 
 /*! Stream callback for netconf stream notification (RFC 5277)
  *
@@ -104,6 +104,7 @@ ce_event_cb(clicon_handle h,
             void         *arg)
 {
     struct client_entry *ce = (struct client_entry *)arg;
+    int                  ret;
     
     clicon_debug(1, "%s op:%d", __FUNCTION__, op);
     switch (op){
@@ -113,12 +114,14 @@ ce_event_cb(clicon_handle h,
             backend_client_rm(h, ce);
         break;
     default:
-        if (send_msg_notify_xml(h, ce->ce_s, ce->ce_source_host, event) < 0){
-            if (errno == ECONNRESET || errno == EPIPE){
-                clicon_log(LOG_WARNING, "client %d reset", ce->ce_nr);
-            }
+        if (ce->ce_stream && client_stream_notify(ce, event) < 0)
+            return -1;
+        if (ce->ce_stream)
+            break; /* Sent when the streamed reply is done */
+        if ((ret = client_notify(h, ce, event)) < 0)
+            return -1;
+        if (ret == 0) /* Dropped */
             break;
-        }
         /* note there may be other notifications than RFC5277 streams */
         ce->ce_out_notifications++;
         netconf_monitoring_counter_inc(h, "out-notifications");
@@ -145,7 +148,7 @@ ce_client_string(struct client_entry *ce,
         clicon_err(OE_UNIX, EINVAL, "ce or cbp is NULL");
         goto done;
     }
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
 
@@ -198,6 +201,91 @@ release_all_dbs(clicon_handle h,
     return retval;
 }
 
+/*! Get session-id of a session selected by an xpath, if any
+ *
+ * Sessions are selected by a predicate on session-id, such as:
+ *   /ncm:netconf-state/ncm:sessions/ncm:session[ncm:session-id='42']
+ * @param[in]  xpath  XML Xpath
+ * @param[out] id     Session id
+ * @retval     1      One session selected, id set
+ * @retval     0      No session-id predicate
+ */
+static int
+monitoring_xpath_session_id(char     *xpath,
+                            uint32_t *id)
+{
+    char *p;
+    char *q;
+    
+    if (xpath == NULL || (p = strstr(xpath, "session-id")) == NULL)
+        return 0;
+    /* Only a single predicate, not eg [session-id='1' or username='x'] */
+    if (strstr(p+1, "session-id") != NULL || strchr(xpath, '|') != NULL ||
+        strstr(xpath, " or ") != NULL || strstr(xpath, "not(") != NULL)
+        return 0;
+    p += strlen("session-id");
+    while (*p == ' ')
+        p++;
+    if (*p++ != '=')
+        return 0;
+    while (*p == ' ')
+        p++;
+    if (*p == '\'' || *p == '"')
+        p++;
+    if (!isdigit(*p))
+        return 0;
+    *id = strtoul(p, &q, 10);
+    if (*q != '\'' && *q != '"' && *q != ']' && *q != ' ')
+        return 0;
+    return 1;
+}
+
+/*! Get netconf monitoring state of one session
+ *
+ * @param[in]     ce  Client entry
+ * @param[in,out] cb  Cligen buf
+ * @retval        0   OK
+ * @retval       -1   Error
+ */
+static int
+monitoring_session_get(struct client_entry *ce,
+                       cbuf                *cb)
+{
+    char timestr[28];
+
+    cprintf(cb, "<session>");
+    cprintf(cb, "<session-id>%u</session-id>", ce->ce_id);
+    if (ce->ce_transport == NULL){
+#ifdef NOTYET // XXX: too strict, race conditions in clixon_snmp
+        clicon_err(OE_XML, 0, "Mandatory element transport missing");
+        return -1;
+#else
+        cprintf(cb, "<transport xmlns:%s=\"%s\">cl:netconf</transport>",
+                CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+#endif
+    }
+    else
+        cprintf(cb, "<transport xmlns:%s=\"%s\">%s</transport>",
+                CLIXON_LIB_PREFIX, CLIXON_LIB_NS,
+                ce->ce_transport);
+    cprintf(cb, "<username>%s</username>", ce->ce_username);
+    if (ce->ce_source_host)
+        cprintf(cb, "<source-host>%s</source-host>", ce->ce_source_host);
+    if (ce->ce_time.tv_sec != 0){
+        if (time2str(&ce->ce_time, timestr, sizeof(timestr)) < 0){
+            clicon_err(OE_UNIX, errno, "time2str");
+            return -1;
+        }
+        cprintf(cb, "<login-time>%s</login-time>", timestr);
+    }
+    cprintf(cb, "<in-rpcs>%u</in-rpcs>", ce->ce_in_rpcs);
+    cprintf(cb, "<in-bad-rpcs>%u</in-bad-rpcs>", ce->ce_in_bad_rpcs);
+    cprintf(cb, "<out-rpc-errors>%u</out-rpc-errors>", ce->ce_out_rpc_errors);
+    cprintf(cb, "<out-notifications>%u</out-notifications>", ce->ce_out_notifications);
+    cprintf(cb, "</session>");
+    return 0;
+}
+
 /*! Get backend-specific client netconf monitoring state
  *
  * Backend-specific netconf monitoring state is:
@@ -224,7 +312,7 @@ backend_monitoring_state_get(clicon_handle h,
     int                  retval = -1;
     cbuf                *cb = NULL;
     struct client_entry *ce;
-    char                 timestr[28];
+    uint32_t             id;
     int                  ret;
 
     if ((cb = cbuf_new()) ==NULL){
@@ -233,37 +321,16 @@ backend_monitoring_state_get(clicon_handle h,
     }
     cprintf(cb, "<netconf-state xmlns=\"%s\">", NETCONF_MONITORING_NAMESPACE);
     cprintf(cb, "<sessions>");
-    for (ce = backend_client_list(h); ce; ce = ce->ce_next){
-        cprintf(cb, "<session>");
-        cprintf(cb, "<session-id>%u</session-id>", ce->ce_id);
-        if (ce->ce_transport == NULL){
-#ifdef NOTYET // XXX: too strict, race conditions in clixon_snmp
-            clicon_err(OE_XML, 0, "Mandatory element transport missing");
+    /* Only the session selected by session-id, or all sessions */
+    if (monitoring_xpath_session_id(xpath, &id) == 1){
+        if ((ce = backend_client_find(h, id)) != NULL &&
+            monitoring_session_get(ce, cb) < 0)
             goto done;
-#else
-            cprintf(cb, "<transport xmlns:%s=\"%s\">cl:netconf</transport>",
-                    CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
-#endif
-        }
-        else
-            cprintf(cb, "<transport xmlns:%s=\"%s\">%s</transport>",
-                    CLIXON_LIB_PREFIX, CLIXON_LIB_NS,
-                    ce->ce_transport);
-        cprintf(cb, "<username>%s</username>", ce->ce_username);
-        if (ce->ce_source_host)
-            cprintf(cb, "<source-host>%s</source-host>", ce->ce_source_host);
-        if (ce->ce_time.tv_sec != 0){
-            if (time2str(&ce->ce_time, timestr, sizeof(timestr)) < 0){
-                clicon_err(OE_UNIX, errno, "time2str");
+    }
+    else {
+        for (ce = backend_client_list(h); ce; ce = ce->ce_next)
+            if (monitoring_session_get(ce, cb) < 0)
                 goto done;
-            }
-            cprintf(cb, "<login-time>%s</login-time>", timestr);
-        }
-        cprintf(cb, "<in-rpcs>%u</in-rpcs>", ce->ce_in_rpcs);
-        cprintf(cb, "<in-bad-rpcs>%u</in-bad-rpcs>", ce->ce_in_bad_rpcs);
-        cprintf(cb, "<out-rpc-errors>%u</out-rpc-errors>", ce->ce_out_rpc_errors);
-        cprintf(cb, "<out-notifications>%u</out-notifications>", ce->ce_out_notifications);
-        cprintf(cb, "</session>");
     }
     cprintf(cb, "</sessions>");
     cprintf(cb, "</netconf-state>");
@@ -282,190 +349,1350 @@ backend_monitoring_state_get(clicon_handle h,
     goto done;
 }
 
-/*! Remove client entry state
+static int client_reply_send(struct client_entry *ce, cbuf *cbret);
+static int client_reply_defer(clicon_handle h, struct client_entry *ce, cbuf *cbret);
+
+/*! Autocommit edit waiting for a group commit, see CLICON_AUTOCOMMIT_GROUP_WINDOW
  *
- * Close down everything wrt clients (eg sockets, subscriptions)
- * Finally actually remove client struct in handle
- * @param[in]  h   Clixon handle
- * @param[in]  ce  Client handle
- * @retval     0   Ok
- * @retval    -1   Error (fatal)
- * @see backend_client_delete for actual deallocation of client entry struct
+ * The edit is applied to candidate, but not yet committed.
  */
-int
-backend_client_rm(clicon_handle        h, 
-                  struct client_entry *ce)
+struct group_edit {
+    struct group_edit   *ge_next;
+    struct client_entry *ge_ce;       /* Client, or NULL if client has closed */
+    uint32_t             ge_id;       /* Session id of client */
+    cxobj               *ge_xc;       /* Copy of edit <config> */
+    enum operation_type  ge_op;       /* Default operation */
+    char                *ge_username; /* Username of edit */
+    cbuf                *ge_reply;    /* Reply if commit succeeds */
+};
+
+/* Pending autocommit edits in arrival order */
+static struct group_edit  *_group_edits = NULL;
+static struct group_edit **_group_last = &_group_edits;
+
+static int autocommit_group_timeout(int fd, void *arg);
+
+/*! Check if an edit conflicts with any pending autocommit edit
+ *
+ * @param[in]  xc  Edit <config>
+ * @retval     1   Conflict, pending edits should be committed first
+ * @retval     0   No conflict
+ * @retval    -1   Error
+ */
+static int
+autocommit_group_conflict(cxobj *xc)
 {
-    struct client_entry  *c;
-    struct client_entry  *c0;
-    struct client_entry **ce_prev;
-    uint32_t              myid = ce->ce_id;
-    yang_stmt            *yspec;
-    int                   retval = -1;
+    struct group_edit *ge;
+    int                ret;
 
-    /* If the confirmed-commit feature is enabled, rollback any ephemeral commit originated by this client */
-    if ((yspec = clicon_dbspec_yang(h)) == NULL) {
-        clicon_err(OE_YANG, ENOENT, "No yang spec");
+    for (ge = _group_edits; ge; ge = ge->ge_next)
+        if ((ret = xml_edit_conflict(ge->ge_xc, xc)) != 0)
+            return ret;
+    return 0;
+}
+
+/*! Add an edit applied to candidate to the pending autocommit edits
+ *
+ * Register a timeout committing the group if it is the first edit
+ * @param[in]  h         Clixon handle
+ * @param[in]  ce        Client entry
+ * @param[in]  xc        Edit <config>, copied
+ * @param[in]  op        Default operation
+ * @param[in]  username  Username of edit
+ * @retval     0         OK, reply is set by autocommit_group_reply
+ * @retval    -1         Error
+ */
+static int
+autocommit_group_add(clicon_handle        h,
+                     struct client_entry *ce,
+                     cxobj               *xc,
+                     enum operation_type  op,
+                     char                *username)
+{
+    int                retval = -1;
+    struct group_edit *ge;
+    struct timeval     t;
+    struct timeval     t1;
+    uint32_t           window;
+
+    if ((ge = malloc(sizeof(*ge))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
         goto done;
     }
-    if (if_feature(yspec, "ietf-netconf", "confirmed-commit")) {
-        if (confirmed_commit_state_get(h) == EPHEMERAL) {
-            /* See if this client is the origin */
-            clicon_debug(1, "session_id: %u, confirmed_commit.session_id: %u", ce->ce_id, confirmed_commit_session_id_get(h));
+    memset(ge, 0, sizeof(*ge));
+    ge->ge_ce = ce;
+    ge->ge_id = ce->ce_id;
+    ge->ge_op = op;
+    if ((ge->ge_xc = xml_dup(xc)) == NULL){
+        free(ge);
+        goto done;
+    }
+    if (username && (ge->ge_username = strdup(username)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        xml_free(ge->ge_xc);
+        free(ge);
+        goto done;
+    }
+    if (_group_edits == NULL){
+        window = clicon_option_int(h, "CLICON_AUTOCOMMIT_GROUP_WINDOW");
+        gettimeofday(&t, NULL);
+        t1.tv_sec = window/1000;
+        t1.tv_usec = (window%1000)*1000;
+        timeradd(&t, &t1, &t);
+        if (clixon_event_reg_timeout(t, autocommit_group_timeout, h, "autocommit group commit") < 0){
+            if (ge->ge_username)
+                free(ge->ge_username);
+            xml_free(ge->ge_xc);
+            free(ge);
+            goto done;
+        }
+    }
+    *_group_last = ge;
+    _group_last = &ge->ge_next;
+    retval = 0;
+ done:
+    return retval;
+}
 
-            if (myid == confirmed_commit_session_id_get(h)) {
-                clicon_debug(1, "ok, rolling back");
-                clicon_log(LOG_NOTICE, "a client with an active ephemeral confirmed-commit has disconnected; rolling back");
+/*! Take over the reply of the last edit of a client, if it is pending
+ *
+ * @param[in]  ce     Client entry
+ * @param[in]  cbret  Reply, taken over if edit is pending
+ * @retval     1      Reply is sent when the group is committed
+ * @retval     0      No pending edit, send reply now
+ */
+static int
+autocommit_group_reply(struct client_entry *ce,
+                       cbuf                *cbret)
+{
+    struct group_edit *ge;
 
-                /* do_rollback errors are logged internally and there is no client to report errors to, so errors are
-                 * ignored here.
-                 */
-                cancel_rollback_event(h);
-                do_rollback(h, NULL);
-            }
+    for (ge = _group_edits; ge; ge = ge->ge_next)
+        if (ge->ge_ce == ce && ge->ge_reply == NULL){
+            ge->ge_reply = cbret;
+            return 1;
         }
-    }
+    return 0;
+}
 
-    clicon_debug(1, "%s", __FUNCTION__);
-    /* for all streams: XXX better to do it top-level? */
-    stream_ss_delete_all(h, ce_event_cb, (void*)ce);
-    c0 = backend_client_list(h);
-    ce_prev = &c0; /* this points to stack and is not real backpointer */
-    for (c = *ce_prev; c; c = c->ce_next){
-        if (c == ce){
-            if (ce->ce_s){
-                clixon_event_unreg_fd(ce->ce_s, from_client);
-                close(ce->ce_s);
-                ce->ce_s = 0;
-                if (release_all_dbs(h, ce->ce_id) < 0)
-                    return -1;
+/*! Client is closed, drop replies of its pending edits
+ *
+ * The edits are still committed with the group
+ * @param[in]  ce  Client entry
+ */
+static void
+autocommit_group_client_rm(struct client_entry *ce)
+{
+    struct group_edit *ge;
+
+    for (ge = _group_edits; ge; ge = ge->ge_next)
+        if (ge->ge_ce == ce)
+            ge->ge_ce = NULL;
+}
+
+/*! Send the reply of a committed or failed edit
+ *
+ * If CLICON_XMLDB_ASYNC is reply-after-durable and the edit is committed, the reply is
+ * deferred until running is durable, as for commit.
+ * @param[in]  h          Clixon handle
+ * @param[in]  ge         Pending edit
+ * @param[in]  cbret      Reply
+ * @param[in]  committed  Edit is committed
+ * @retval     0          OK
+ * @retval    -1          Error
+ */
+static int
+group_edit_reply(clicon_handle      h,
+                 struct group_edit *ge,
+                 cbuf              *cbret,
+                 int                committed)
+{
+    struct client_entry *ce;
+    int                  ret;
+
+    if ((ce = ge->ge_ce) == NULL)
+        return 0;
+    if (strstr(cbuf_get(cbret), "<rpc-error") != NULL){
+        ce->ce_out_rpc_errors++;
+        netconf_monitoring_counter_inc(h, "out-rpc-errors");
+    }
+    else if (committed && clicon_xmldb_async(h) == XMLDB_ASYNC_REPLY_AFTER){
+        ce->ce_reply_seq = xmldb_async_queued(h);
+        if (cbret == ge->ge_reply){
+            if ((ret = client_reply_defer(h, ce, cbret)) < 0)
+                return -1;
+            if (ret == 1){ /* Sent later by backend_async_reply */
+                ge->ge_reply = NULL;
+                return 0;
             }
-            break;
         }
-        ce_prev = &c->ce_next;
+        ce->ce_reply_seq = 0;
     }
-    retval = backend_client_delete(h, ce); /* actually purge it */
- done:
-    return retval;
+    return client_reply_send(ce, cbret);
 }
 
-/*! Get clixon per datastore stats
+/*! Commit edits of the group one at a time after the group commit failed
  *
- * @param[in]     h       Clixon handle
- * @param[in]     dbname  Datastore name
- * @param[in,out] cb      Cligen buf
- * @retval        0       OK
- * @retval       -1       Error
+ * Candidate is reset to running, and each edit is applied and committed as in
+ * from_client_edit_config, so that errors are reported to the client of the failing edit.
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
  */
 static int
-clixon_stats_datastore_get(clicon_handle h,
-                           char         *dbname,
-                           cbuf         *cb)
+autocommit_group_serial(clicon_handle h)
 {
-    int       retval = -1;
-    cxobj    *xt = NULL; /* should not be freed */
-    uint64_t  nr = 0;
-    size_t    sz = 0;
-    cxobj    *xn = NULL;
-    
-    clicon_debug(CLIXON_DBG_DETAIL, "%s %s", __FUNCTION__, dbname);
-    /* This is the db cache */
-    if ((xt = xmldb_cache_get(h, dbname)) == NULL){
-        /* Trigger cache if no exist (trick to ensure cache is present) */
-        if (xmldb_get(h, dbname, NULL, "/", &xn) < 0)
-            //goto done;
-            goto ok;
-        xt = xmldb_cache_get(h, dbname);
+    int                retval = -1;
+    struct group_edit *ge;
+    cbuf              *cbret = NULL;
+    int                ret;
+
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
     }
-    if (xt != NULL){
-        if (xml_stats(xt, &nr, &sz) < 0)
+    for (ge = _group_edits; ge; ge = ge->ge_next){
+        cbuf_reset(cbret);
+        if (xmldb_copy(h, "running", "candidate") < 0){
+            if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
+                goto done;
+            if (group_edit_reply(h, ge, cbret, 0) < 0)
+                goto done;
+            continue;
+        }
+        if ((ret = xmldb_put(h, "candidate", ge->ge_op, ge->ge_xc, ge->ge_username, cbret)) < 0){
+            if (netconf_operation_failed(cbret, "protocol", clicon_err_reason)< 0)
+                goto done;
+        }
+        else if (ret == 1){
+            xmldb_modified_set(h, "candidate", 1); /* mark as dirty */
+            if ((ret = candidate_commit(h, NULL, "candidate", ge->ge_id, 0, cbret)) < 0){
+                if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
+                    goto done;
+            }
+            else if (ret == 1){
+                if (ge->ge_reply && group_edit_reply(h, ge, ge->ge_reply, 1) < 0)
+                    goto done;
+                continue;
+            }
+        }
+        if (group_edit_reply(h, ge, cbret, 0) < 0)
             goto done;
-        cprintf(cb, "<datastore><name>%s</name><nr>%" PRIu64 "</nr>"
-                "<size>%zu</size></datastore>",
-                dbname, nr, sz);
     }
- ok:
+    if (xmldb_copy(h, "running", "candidate") < 0)
+        goto done;
     retval = 0;
  done:
-    if (xn)
-        xml_free(xn);
+    if (cbret)
+        cbuf_free(cbret);
     return retval;
 }
 
-/*! Get clixon per datastore stats
+/*! Commit pending autocommit edits in one transaction and reply to their clients
  *
- * @param[in]     h       Clixon handle
- * @param[in]     dbname  Datastore name
- * @param[in,out] cb      Cligen buf
- * @retval        0       OK
- * @retval       -1       Error
+ * If the group commit fails, the edits are committed one at a time, see
+ * autocommit_group_serial
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see CLICON_AUTOCOMMIT_GROUP_WINDOW
  */
 static int
-clixon_stats_module_get(clicon_handle h,
-                        yang_stmt    *ys,
-                        cbuf         *cb)
+autocommit_group_commit(clicon_handle h)
 {
-    int       retval = -1;
-    uint64_t  nr = 0;
-    size_t    sz = 0;
-    cxobj    *xn = NULL;
-    
-    if (ys == NULL)
+    int                retval = -1;
+    struct group_edit *ge;
+    cbuf              *cbret = NULL;
+    int                ret;
+
+    if (_group_edits == NULL)
         return 0;
-    if (yang_stats(ys, &nr, &sz) < 0)
+    clixon_event_unreg_timeout(autocommit_group_timeout, h);
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
-    cprintf(cb, "<nr>%" PRIu64 "</nr><size>%zu</size>", nr, sz);
+    }
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s", __FUNCTION__);
+    if ((ret = candidate_commit(h, NULL, "candidate", _group_edits->ge_id, 0, cbret)) < 0)
+        ret = 0;
+    if (ret == 0){
+        if (autocommit_group_serial(h) < 0)
+            goto done;
+    }
+    else {
+        for (ge = _group_edits; ge; ge = ge->ge_next)
+            if (ge->ge_reply && group_edit_reply(h, ge, ge->ge_reply, 1) < 0)
+                goto done;
+    }
     retval = 0;
  done:
-    if (xn)
-        xml_free(xn);
+    while ((ge = _group_edits) != NULL){
+        _group_edits = ge->ge_next;
+        if (ge->ge_xc)
+            xml_free(ge->ge_xc);
+        if (ge->ge_username)
+            free(ge->ge_username);
+        if (ge->ge_reply)
+            cbuf_free(ge->ge_reply);
+        free(ge);
+    }
+    _group_last = &_group_edits;
+    if (cbret)
+        cbuf_free(cbret);
     return retval;
 }
 
-/*! Loads all or part of a specified configuration to target configuration
- * 
- * @param[in]  h       Clixon handle 
- * @param[in]  xn      Request: <rpc><xn></rpc> 
- * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
- * @param[in]  arg     client-entry
- * @param[in]  regarg  User argument given at rpc_callback_register() 
- * @retval     0       OK
- * @retval    -1       Error
- * @note  According to RFC 7950 8.3: constraints MUST be enforced:
- * o  during parsing of RPC payloads
- * o  during processing of the <edit-config> operation
- * But Clixon is flexible in allowing invalid XML payload here, only some specialized
- * validations are made.
- * However, what really should be done is to apply the change to the datastore and then
- * validate, if error, discard to previous state. 
- * But this could discard other previous changes to candidate.
-  */
+/*! Group commit window has expired, commit pending autocommit edits
+ *
+ * @param[in]  fd   No-op
+ * @param[in]  arg  Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
 static int
-from_client_edit_config(clicon_handle h,
-                        cxobj        *xn,
-                        cbuf         *cbret,
-                        void         *arg,
-                        void         *regarg)
+autocommit_group_timeout(int   fd,
+                         void *arg)
 {
-    int                 retval = -1;
-    struct client_entry *ce = (struct client_entry *)arg;
-    uint32_t            myid = ce->ce_id;
-    uint32_t            iddb;
-    char               *target;
-    cxobj              *xc;
-    cxobj              *x;
-    enum operation_type operation = OP_MERGE;
-    int                 non_config = 0;
-    yang_stmt          *yspec;
-    cbuf               *cbx = NULL; /* Assist cbuf */
-    int                 ret;
-    char               *username;
-    cxobj              *xret = NULL;
-    char               *attr;
-    int                 autocommit = 0;
+    clicon_handle h = (clicon_handle)arg;
+
+    return autocommit_group_commit(h);
+}
+
+/*! Read-only RPC handled by a worker process, see CLICON_BACKEND_READ_WORKERS
+ *
+ * The worker is a forked copy of the backend, its memory is a copy-on-write snapshot of
+ * the datastores made when the RPC arrives. It handles the RPC, including NACM and state
+ * callbacks, sends the reply to the client and exits, while the backend handles other
+ * clients. The client socket is not read by the backend until the worker has exited.
+ */
+struct read_worker {
+    struct read_worker  *rw_next;
+    struct client_entry *rw_ce;  /* Client, or NULL if client has closed */
+    pid_t                rw_pid; /* Worker process */
+    int                  rw_fd;  /* Read end of pipe: one byte when reply is sent, then eof */
+    int                  rw_replied; /* Worker has sent reply */
+};
+
+/* Running read workers */
+static struct read_worker *_read_workers = NULL;
+
+/* Write end of pipe in a worker process, -1 in the backend */
+static int _read_worker_fd = -1;
+
+/* This process is a commit reader, see backend_commit_reader_start */
+static int _commit_reader = 0;
+
+/* Client whose message is handled, or NULL */
+static struct client_entry *_client_current = NULL;
+
+/*! Check if RPC is read-only and may be handled by a worker process
+ *
+ * @param[in]  module  Module of RPC
+ * @param[in]  rpc     RPC name
+ * @retval     1       Yes: get or get-config
+ * @retval     0       No
+ */
+static int
+read_worker_rpc(char *module,
+                char *rpc)
+{
+    return strcmp(module, "ietf-netconf") == 0 &&
+        (strcmp(rpc, "get") == 0 || strcmp(rpc, "get-config") == 0);
+}
+
+/*! Worker process has sent its reply and exited, read client socket again
+ *
+ * If the worker did not send a reply, eg it crashed, an error is sent to the client
+ * @param[in]  fd   Read end of worker pipe
+ * @param[in]  arg  Read worker
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+read_worker_done(int   fd,
+                 void *arg)
+{
+    int                  retval = -1;
+    struct read_worker  *rw = (struct read_worker *)arg;
+    struct read_worker **rw_prev;
+    struct client_entry *ce;
+    char                 c;
+    int                  status = 0;
+    cbuf                *cbret = NULL;
+
+    if (read(fd, &c, 1) == 1){
+        rw->rw_replied = 1;
+        return 0; /* Wait for eof */
+    }
+    clixon_event_unreg_fd(fd, read_worker_done);
+    close(fd);
+    for (rw_prev = &_read_workers; *rw_prev; rw_prev = &(*rw_prev)->rw_next)
+        if (*rw_prev == rw){
+            *rw_prev = rw->rw_next;
+            break;
+        }
+    if (waitpid(rw->rw_pid, &status, 0) == rw->rw_pid &&
+        (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
+        clicon_log(LOG_WARNING, "%s: read worker %d failed", __FUNCTION__, rw->rw_pid);
+    if ((ce = rw->rw_ce) != NULL){
+        if (!rw->rw_replied){
+            if ((cbret = cbuf_new()) == NULL){
+                clicon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
+            }
+            if (netconf_operation_failed(cbret, "application", "read worker failed") < 0)
+                goto done;
+            ce->ce_out_rpc_errors++;
+            netconf_monitoring_counter_inc(ce->ce_handle, "out-rpc-errors");
+            if (client_reply_send(ce, cbret) < 0)
+                goto done;
+        }
+        if (clixon_event_reg_fd(ce->ce_s, from_client, (void*)ce, "local netconf client socket") < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (cbret)
+        cbuf_free(cbret);
+    free(rw);
+    return retval;
+}
+
+/*! Start a worker process handling a read-only RPC of a client
+ *
+ * Not started if CLICON_BACKEND_READ_WORKERS workers are running, or if the client has a
+ * deferred reply or queued output. Then the RPC is handled by the backend.
+ * In the worker process, 0 is returned and the RPC is handled as usual, see read_worker_exit
+ * @param[in]  h    Clixon handle
+ * @param[in]  ce   Client entry
+ * @retval     1    Worker started, it sends the reply
+ * @retval     0    Not started, or in worker: handle RPC
+ * @retval    -1    Error
+ */
+static int
+read_worker_start(clicon_handle        h,
+                  struct client_entry *ce)
+{
+    struct read_worker *rw;
+    int                 max;
+    int                 nr = 0;
+    int                 fd[2];
+
+    if ((max = clicon_option_int(h, "CLICON_BACKEND_READ_WORKERS")) <= 0 ||
+        _read_worker_fd != -1 || _commit_reader ||
+        ce->ce_reply != NULL ||
+        client_output_queued(ce) > 0)
+        return 0;
+    for (rw = _read_workers; rw; rw = rw->rw_next)
+        nr++;
+    if (nr >= max)
+        return 0;
+    if ((rw = malloc(sizeof(*rw))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memset(rw, 0, sizeof(*rw));
+    if (pipe(fd) < 0){
+        clicon_err(OE_UNIX, errno, "pipe");
+        free(rw);
+        return -1;
+    }
+    if ((rw->rw_pid = fork()) < 0){
+        clicon_log(LOG_WARNING, "%s: fork: %s", __FUNCTION__, strerror(errno));
+        close(fd[0]);
+        close(fd[1]);
+        free(rw);
+        return 0;
+    }
+    if (rw->rw_pid == 0){ /* Worker */
+        close(fd[0]);
+        free(rw);
+        _read_worker_fd = fd[1];
+        return 0;
+    }
+    close(fd[1]);
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s pid:%d ce_id:%u", __FUNCTION__, rw->rw_pid, ce->ce_id);
+    rw->rw_ce = ce;
+    rw->rw_fd = fd[0];
+    if (clixon_event_reg_fd(rw->rw_fd, read_worker_done, rw, "read worker") < 0){
+        close(rw->rw_fd);
+        free(rw); /* Worker exits by itself */
+        return -1;
+    }
+    clixon_event_unreg_fd(ce->ce_s, from_client);
+    rw->rw_next = _read_workers;
+    _read_workers = rw;
+    return 1;
+}
+
+/*! Exit worker process after the RPC is handled
+ *
+ * @param[in]  replied  Reply is sent to the client
+ */
+static void
+read_worker_exit(int replied)
+{
+    char c = 0;
+
+    if (replied && write(_read_worker_fd, &c, 1) < 0)
+        replied = 0;
+    /* Not exit(): the backend exit handlers are not run in the worker */
+    _exit(replied?0:1);
+}
+
+/*! Client is closed, do not read the client socket when its worker exits
+ *
+ * @param[in]  ce  Client entry
+ */
+static void
+read_worker_client_rm(struct client_entry *ce)
+{
+    struct read_worker *rw;
+
+    for (rw = _read_workers; rw; rw = rw->rw_next)
+        if (rw->rw_ce == ce)
+            rw->rw_ce = NULL;
+}
+
+/*
+ * Commit reader, see CLICON_BACKEND_COMMIT_READER
+ * A process forked when a commit starts. Its memory is a copy-on-write snapshot of the
+ * datastores before the commit. While the backend runs the commit, including plugin
+ * callbacks, the reader handles get and get-config of other clients from the snapshot.
+ * When the commit is done, the reader is stopped after its current RPC, and the backend
+ * reads the clients again. Readers thus see the old running until the commit is done,
+ * and then the new running.
+ */
+/* Reader process, or 0 */
+static pid_t _commit_reader_pid = 0;
+
+/* Write end of stop pipe of reader in the backend, or -1 */
+static int _commit_reader_fd = -1;
+
+/*! Check if the requests of a client may be handled by the commit reader
+ *
+ * Not the client of the commit, nor a client whose replies or notifications are sent by
+ * the backend, eg with a worker, queued output or pending autocommit edit.
+ * @param[in]  h    Clixon handle
+ * @param[in]  ce   Client entry
+ * @retval     1    Yes
+ * @retval     0    No
+ */
+static int
+commit_reader_client(clicon_handle        h,
+                     struct client_entry *ce)
+{
+    struct read_worker *rw;
+    struct group_edit  *ge;
+    event_stream_t     *es;
+
+    if (ce == _client_current ||
+        ce->ce_reply != NULL ||
+        ce->ce_reply_seq != 0 ||
+        ce->ce_stream != NULL ||
+        ce->ce_out_paused ||
+        ce->ce_out_closed ||
+        client_output_queued(ce) > 0)
+        return 0;
+    for (rw = _read_workers; rw; rw = rw->rw_next)
+        if (rw->rw_ce == ce)
+            return 0;
+    for (ge = _group_edits; ge; ge = ge->ge_next)
+        if (ge->ge_ce == ce)
+            return 0;
+    if ((es = clicon_stream(h)) != NULL)
+        do {
+            if (stream_ss_find(es, ce_event_cb, (void*)ce) != NULL)
+                return 0;
+            es = NEXTQ(event_stream_t *, es);
+        } while (es && es != clicon_stream(h));
+    return 1;
+}
+
+/*! Parse the next message on a client socket without reading it
+ *
+ * The message must be completely received and at most COMMIT_READER_MSGLEN bytes
+ * @param[in]  s    Client socket
+ * @param[out] xtp  Parsed message without yang binding, free with xml_free
+ * @retval     1    OK, xtp set
+ * @retval     0    Not yet received, too long, not parsable, or eof
+ */
+static int
+client_msg_peek(int     s,
+                cxobj **xtp)
+{
+    int                retval = 0;
+    struct clicon_msg  hdr;
+    char              *buf = NULL;
+    uint32_t           len;
+
+    if (recv(s, &hdr, sizeof(hdr), MSG_PEEK|MSG_DONTWAIT) != sizeof(hdr))
+        goto done;
+    len = ntohl(hdr.op_len);
+    if (ntohl(hdr.op_id) == CLICON_MSG_ID_MORE ||
+        len <= sizeof(hdr) || len > COMMIT_READER_MSGLEN)
+        goto done;
+    if ((buf = malloc(len)) == NULL)
+        goto done;
+    if (recv(s, buf, len, MSG_PEEK|MSG_DONTWAIT) != len || buf[len-1] != '\0')
+        goto done;
+    if (clixon_xml_parse_string(buf + sizeof(hdr), YB_NONE, NULL, xtp, NULL) < 0){
+        clicon_err_reset();
+        goto done;
+    }
+    retval = 1;
+ done:
+    if (buf)
+        free(buf);
+    return retval;
+}
+
+/*! Check if the next message on a client socket is a get or get-config, without reading it
+ *
+ * @param[in]  s    Client socket
+ * @retval     1    Yes, handle it in the reader
+ * @retval     0    No, or not yet received, or eof: leave it to the backend
+ * @see client_msg_peek
+ */
+static int
+commit_reader_peek(int s)
+{
+    int                retval = 0;
+    cxobj             *xt = NULL;
+    cxobj             *xrpc;
+    cxobj             *xe;
+    char              *ns = NULL;
+
+    if (client_msg_peek(s, &xt) == 0)
+        goto done;
+    if ((xrpc = xml_child_i_type(xt, 0, CX_ELMNT)) == NULL ||
+        strcmp(xml_name(xrpc), "rpc") != 0 ||
+        (xe = xml_child_i_type(xrpc, 0, CX_ELMNT)) == NULL ||
+        (strcmp(xml_name(xe), "get") != 0 && strcmp(xml_name(xe), "get-config") != 0))
+        goto done;
+    if (xml2ns(xe, xml_prefix(xe), &ns) < 0){
+        clicon_err_reset();
+        goto done;
+    }
+    if (ns != NULL && strcmp(ns, NETCONF_BASE_NAMESPACE) == 0)
+        retval = 1;
+ done:
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Commit reader process: handle get and get-config of clients until stopped
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  fd    Read end of stop pipe
+ * @param[in]  ppid  Backend process
+ * @note Does not return
+ */
+static void
+commit_reader_run(clicon_handle h,
+                  int           fd,
+                  pid_t         ppid)
+{
+    struct client_entry  *ce;
+    struct client_entry **cev = NULL;
+    struct pollfd        *fds = NULL;
+    nfds_t                nfds = 1;
+    nfds_t                i;
+    int                   ret;
+    int                   status = 1;
+
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next)
+        nfds++;
+    if ((fds = calloc(nfds, sizeof(*fds))) == NULL ||
+        (cev = calloc(nfds, sizeof(*cev))) == NULL)
+        goto done;
+    fds[0].fd = fd;
+    fds[0].events = POLLIN;
+    nfds = 1;
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next)
+        if (commit_reader_client(h, ce)){
+            fds[nfds].fd = ce->ce_s;
+            fds[nfds].events = POLLIN;
+            cev[nfds++] = ce;
+        }
+    /* Pending autocommit edits are committed by the backend */
+    _group_edits = NULL;
+    _group_last = &_group_edits;
+    while (1){
+        if ((ret = poll(fds, nfds, 1000)) < 0){
+            if (errno == EINTR)
+                continue;
+            goto done;
+        }
+        if (fds[0].revents || getppid() != ppid)
+            break;
+        for (i=1; i<nfds; i++){
+            if (fds[i].fd < 0 || fds[i].revents == 0)
+                continue;
+            /* A negative fd is not polled, the client is read by the backend when done */
+            if (commit_reader_peek(fds[i].fd) == 0){
+                fds[i].fd = -1;
+                continue;
+            }
+            clicon_debug(CLIXON_DBG_DEFAULT, "%s ce_id:%u", __FUNCTION__, cev[i]->ce_id);
+            if (from_client(cev[i]->ce_s, cev[i]) < 0)
+                goto done;
+        }
+    }
+    status = 0;
+ done:
+    /* Not exit(): the backend exit handlers are not run in the reader */
+    _exit(status);
+}
+
+/*! Start commit reader serving get and get-config of other clients during a commit
+ *
+ * Not started if CLICON_BACKEND_COMMIT_READER is false, or if no client may be served
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK, reader started or not
+ * @retval    -1    Error
+ * @see backend_commit_reader_stop
+ */
+int
+backend_commit_reader_start(clicon_handle h)
+{
+    struct client_entry *ce;
+    int                  nr = 0;
+    int                  fd[2];
+    pid_t                pid;
+    pid_t                ppid;
+
+    if (!clicon_option_bool(h, "CLICON_BACKEND_COMMIT_READER") ||
+        _commit_reader || _read_worker_fd != -1 || _commit_reader_fd != -1)
+        return 0;
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next)
+        nr += commit_reader_client(h, ce);
+    if (nr == 0)
+        return 0;
+    if (pipe(fd) < 0){
+        clicon_err(OE_UNIX, errno, "pipe");
+        return -1;
+    }
+    ppid = getpid();
+    if ((pid = fork()) < 0){
+        clicon_log(LOG_WARNING, "%s: fork: %s", __FUNCTION__, strerror(errno));
+        close(fd[0]);
+        close(fd[1]);
+        return 0;
+    }
+    if (pid == 0){ /* Reader */
+        close(fd[1]);
+        _commit_reader = 1;
+        commit_reader_run(h, fd[0], ppid);
+    }
+    close(fd[0]);
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s pid:%d clients:%d", __FUNCTION__, pid, nr);
+    _commit_reader_pid = pid;
+    _commit_reader_fd = fd[1];
+    return 0;
+}
+
+/*! Stop commit reader when the commit is done, after it has handled its current RPC
+ *
+ * The stop pipe is written and not only closed, since processes forked during the commit
+ * may also have its write end
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ * @see backend_commit_reader_start
+ */
+int
+backend_commit_reader_stop(clicon_handle h)
+{
+    char c = 0;
+    int  status = 0;
+
+    if (_commit_reader_fd == -1)
+        return 0;
+    if (write(_commit_reader_fd, &c, 1) < 0)
+        clicon_log(LOG_WARNING, "%s: write: %s", __FUNCTION__, strerror(errno));
+    close(_commit_reader_fd);
+    _commit_reader_fd = -1;
+    if (waitpid(_commit_reader_pid, &status, 0) == _commit_reader_pid &&
+        (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
+        clicon_log(LOG_WARNING, "%s: commit reader %d failed", __FUNCTION__, _commit_reader_pid);
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s pid:%d", __FUNCTION__, _commit_reader_pid);
+    _commit_reader_pid = 0;
+    return 0;
+}
+
+/*
+ * Output queues of clients
+ * Replies and notifications are written to a client socket without blocking. What the client
+ * does not read is kept in its output queue and written when the socket is writable, at most
+ * BACKEND_OUTPUT_QUANTUM bytes per client and event loop iteration.
+ * See CLICON_BACKEND_OUTPUT_HWM and CLICON_BACKEND_OUTPUT_POLICY
+ */
+static int client_output_write(int fd, void *arg);
+
+/*! Number of bytes in output queue of client not yet written
+ *
+ * @param[in]  ce   Client entry
+ * @retval     len  Bytes queued
+ */
+static size_t
+client_output_queued(struct client_entry *ce)
+{
+    if (ce->ce_outq == NULL)
+        return 0;
+    return cbuf_len(ce->ce_outq) - ce->ce_outq_off;
+}
+
+/*! Read requests from client again
+ *
+ * @param[in]  ce   Client entry
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+client_output_resume(struct client_entry *ce)
+{
+    if (!ce->ce_out_paused)
+        return 0;
+    ce->ce_out_paused = 0;
+    clixon_event_unreg_fd(ce->ce_s, from_client); /* In case registered meanwhile */
+    return clixon_event_reg_fd(ce->ce_s, from_client, (void*)ce, "local netconf client socket");
+}
+
+/*! Discard output queue of client
+ *
+ * @param[in]  ce   Client entry
+ */
+static void
+client_output_free(struct client_entry *ce)
+{
+    if (client_output_queued(ce) > 0)
+        clixon_event_unreg_fd_write(ce->ce_s, client_output_write);
+    if (ce->ce_outq){
+        cbuf_free(ce->ce_outq);
+        ce->ce_outq = NULL;
+    }
+    ce->ce_outq_off = 0;
+}
+
+/*! Writing to client failed, or the client is disconnected: discard its output
+ *
+ * The client socket is shut down, so that the client is removed when its eof is read
+ * @param[in]  ce   Client entry
+ * @param[in]  err  Errno of failed write, or 0 if disconnected
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+client_output_close(struct client_entry *ce,
+                    int                  err)
+{
+    if (err == EPIPE || err == ECONNRESET)
+        clicon_log(LOG_WARNING, "client %d reset", ce->ce_nr);
+    else if (err)
+        clicon_log(LOG_WARNING, "client %d write: %s", ce->ce_nr, strerror(err));
+    client_output_free(ce);
+    ce->ce_out_closed = 1;
+    shutdown(ce->ce_s, SHUT_RDWR);
+    return client_output_resume(ce);
+}
+
+/*! Send a message to a client, queue what cannot be written without blocking
+ *
+ * The message header and body are sent with one sendmsg(2) call, the body is not copied
+ * into a message, only what is not written is copied to the output queue.
+ * In a read worker process, the message is written blocking, since the worker exits
+ * after the reply. Likewise in a commit reader.
+ * @param[in]  ce      Client entry
+ * @param[in]  descr   Description of client for logging
+ * @param[in]  id      Session id of message, or CLICON_MSG_ID_MORE
+ * @param[in]  data    Message body, copied if queued
+ * @param[in]  datalen Length of body, including terminating null byte if any
+ * @retval     0       OK, or client has closed
+ * @retval    -1       Error
+ * @see clicon_msg_send_buf
+ */
+static int
+client_output(struct client_entry *ce,
+              const char          *descr,
+              uint32_t             id,
+              char                *data,
+              uint32_t             datalen)
+{
+    struct clicon_msg hdr;
+    struct iovec      iov[2];
+    struct msghdr     mh = {0,};
+    size_t            len;
+    size_t            queued;
+    ssize_t           n = 0;
+
+    if (ce->ce_out_closed)
+        return 0;
+    if (_read_worker_fd != -1 || _commit_reader)
+        return clicon_msg_send_buf(ce->ce_s, descr, id, data, datalen);
+    len = sizeof(hdr) + datalen;
+    hdr.op_len = htonl(len);
+    hdr.op_id = htonl(id);
+    if (id != CLICON_MSG_ID_MORE && datalen)
+        clicon_debug(CLIXON_DBG_MSG, "Send [%s]: %s", descr, data);
+    if ((queued = client_output_queued(ce)) == 0){
+        iov[0].iov_base = &hdr;
+        iov[0].iov_len = sizeof(hdr);
+        iov[1].iov_base = data;
+        iov[1].iov_len = datalen;
+        mh.msg_iov = iov;
+        mh.msg_iovlen = 2;
+        if ((n = sendmsg(ce->ce_s, &mh, MSG_DONTWAIT)) < 0){
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                return client_output_close(ce, errno);
+            n = 0;
+        }
+        if (n == len)
+            return 0;
+    }
+    if (ce->ce_outq == NULL && (ce->ce_outq = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        return -1;
+    }
+    /* Queue unwritten part of header and body */
+    if (n < sizeof(hdr) &&
+        cbuf_append_buf(ce->ce_outq, (char*)&hdr + n, sizeof(hdr) - n) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    n = n < sizeof(hdr) ? 0 : n - sizeof(hdr);
+    if (datalen - n > 0 &&
+        cbuf_append_buf(ce->ce_outq, data + n, datalen - n) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    if (queued == 0 &&
+        clixon_event_reg_fd_write(ce->ce_s, client_output_write, ce, "local netconf client output") < 0)
+        return -1;
+    return 0;
+}
+
+/*! Client socket is writable, write from its output queue
+ *
+ * When the queue is written, requests are read again if paused, and the next fragment of a
+ * streamed reply is sent.
+ * @param[in]  fd   Client socket
+ * @param[in]  arg  Client entry
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+client_output_write(int   fd,
+                    void *arg)
+{
+    struct client_entry *ce = (struct client_entry *)arg;
+    cbuf                *q = ce->ce_outq;
+    size_t               len;
+    ssize_t              n;
+    struct timeval       t;
+
+    if ((len = client_output_queued(ce)) > BACKEND_OUTPUT_QUANTUM)
+        len = BACKEND_OUTPUT_QUANTUM;
+    if ((n = send(fd, cbuf_get(q) + ce->ce_outq_off, len, MSG_DONTWAIT)) < 0){
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return 0;
+        return client_output_close(ce, errno);
+    }
+    ce->ce_outq_off += n;
+    if ((len = client_output_queued(ce)) > 0){
+        if (ce->ce_outq_off > len){ /* Compact, amortized over written output */
+            memmove(cbuf_get(q), cbuf_get(q) + ce->ce_outq_off, len);
+            cbuf_trunc(q, len);
+            ce->ce_outq_off = 0;
+        }
+        return 0;
+    }
+    cbuf_reset(q);
+    ce->ce_outq_off = 0;
+    clixon_event_unreg_fd_write(fd, client_output_write);
+    if (ce->ce_out_dropped){
+        clicon_log(LOG_NOTICE, "client %d: %u notifications dropped", ce->ce_nr, ce->ce_out_dropped);
+        ce->ce_out_dropped = 0;
+    }
+    if (client_output_resume(ce) < 0)
+        return -1;
+    if (ce->ce_stream){
+        gettimeofday(&t, NULL);
+        if (clixon_event_reg_timeout(t, client_stream_next, ce, "streamed reply") < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Send a notification to a client
+ *
+ * If the output queue of the client exceeds CLICON_BACKEND_OUTPUT_HWM, the notification is
+ * dropped or the client disconnected, see CLICON_BACKEND_OUTPUT_POLICY
+ * @param[in]  h      Clixon handle
+ * @param[in]  ce     Client entry
+ * @param[in]  event  Notification
+ * @retval     1      Sent or queued
+ * @retval     0      Dropped
+ * @retval    -1      Error
+ */
+static int
+client_notify(clicon_handle        h,
+              struct client_entry *ce,
+              cxobj               *event)
+{
+    int                retval = -1;
+    cbuf              *cb = NULL;
+    cbuf              *cbev = NULL;
+    uint32_t           hwm;
+    int                ret;
+
+    if (ce->ce_out_closed)
+        return 0;
+    hwm = clicon_option_int(h, "CLICON_BACKEND_OUTPUT_HWM");
+    if (hwm && client_output_queued(ce) > hwm){
+        if (clicon_backend_output_policy(h) == BACKEND_OUTPUT_DISCONNECT){
+            clicon_log(LOG_WARNING, "client %d output queue full, disconnecting", ce->ce_nr);
+            if (client_output_close(ce, 0) < 0)
+                goto done;
+        }
+        else if (ce->ce_out_dropped++ == 0)
+            clicon_log(LOG_WARNING, "client %d output queue full, dropping notifications", ce->ce_nr);
+        retval = 0;
+        goto done;
+    }
+    /* Same serialized event is shared by all subscribers */
+    if ((ret = stream_notify_cbuf(event, &cbev)) < 0)
+        goto done;
+    if (ret == 0){
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if (clixon_xml2cbuf(cb, event, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+        cbev = cb;
+    }
+    if (client_output(ce, ce->ce_source_host, 0, cbuf_get(cbev), cbuf_len(cbev)+1) < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Remove client entry state
+ *
+ * Close down everything wrt clients (eg sockets, subscriptions)
+ * Finally actually remove client struct in handle
+ * @param[in]  h   Clixon handle
+ * @param[in]  ce  Client handle
+ * @retval     0   Ok
+ * @retval    -1   Error (fatal)
+ * @see backend_client_delete for actual deallocation of client entry struct
+ */
+int
+backend_client_rm(clicon_handle        h, 
+                  struct client_entry *ce)
+{
+    uint32_t              myid = ce->ce_id;
+    yang_stmt            *yspec;
+    int                   retval = -1;
+
+    /* If the confirmed-commit feature is enabled, rollback any ephemeral commit originated by this client */
+    if ((yspec = clicon_dbspec_yang(h)) == NULL) {
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if (if_feature(yspec, "ietf-netconf", "confirmed-commit")) {
+        if (confirmed_commit_state_get(h) == EPHEMERAL) {
+            /* See if this client is the origin */
+            clicon_debug(1, "session_id: %u, confirmed_commit.session_id: %u", ce->ce_id, confirmed_commit_session_id_get(h));
+
+            if (myid == confirmed_commit_session_id_get(h)) {
+                clicon_debug(1, "ok, rolling back");
+                clicon_log(LOG_NOTICE, "a client with an active ephemeral confirmed-commit has disconnected; rolling back");
+
+                /* do_rollback errors are logged internally and there is no client to report errors to, so errors are
+                 * ignored here.
+                 */
+                cancel_rollback_event(h);
+                do_rollback(h, NULL);
+            }
+        }
+    }
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    autocommit_group_client_rm(ce);
+    read_worker_client_rm(ce);
+    client_stream_free(ce);
+    client_output_free(ce);
+    /* for all streams: XXX better to do it top-level? */
+    stream_ss_delete_all(h, ce_event_cb, (void*)ce);
+    backend_push_delete_all(h, ce_event_cb, (void*)ce);
+    if (ce->ce_pprev && ce->ce_s){ /* In client list */
+        clixon_event_unreg_fd(ce->ce_s, from_client);
+        close(ce->ce_s);
+        ce->ce_s = 0;
+        if (release_all_dbs(h, ce->ce_id) < 0)
+            return -1;
+    }
+    retval = backend_client_delete(h, ce); /* actually purge it */
+    /* Private candidate of session, unless other clients share the session id */
+    if (retval == 0 &&
+        backend_client_find(h, myid) == NULL &&
+        backend_private_rm(h, myid) < 0)
+        retval = -1;
+ done:
+    return retval;
+}
+
+/*! Get clixon per datastore stats
+ *
+ * @param[in]     h       Clixon handle
+ * @param[in]     dbname  Datastore name
+ * @param[in,out] cb      Cligen buf
+ * @retval        0       OK
+ * @retval       -1       Error
+ */
+static int
+clixon_stats_datastore_get(clicon_handle h,
+                           char         *dbname,
+                           cbuf         *cb)
+{
+    int       retval = -1;
+    cxobj    *xt = NULL; /* should not be freed */
+    uint64_t  nr = 0;
+    size_t    sz = 0;
+    cxobj    *xn = NULL;
+    
+    clicon_debug(CLIXON_DBG_DETAIL, "%s %s", __FUNCTION__, dbname);
+    /* This is the db cache, evicted caches are not read, see CLICON_DATASTORE_CACHE_BUDGET */
+    if ((xt = xmldb_cache_get(h, dbname)) == NULL &&
+        clicon_option_int(h, "CLICON_DATASTORE_CACHE_BUDGET") == 0){
+        /* Trigger cache if no exist (trick to ensure cache is present) */
+        if (xmldb_get(h, dbname, NULL, "/", &xn) < 0)
+            //goto done;
+            goto ok;
+        xt = xmldb_cache_get(h, dbname);
+    }
+    if (xt != NULL){
+        if (xml_stats(xt, &nr, &sz) < 0)
+            goto done;
+        cprintf(cb, "<datastore><name>%s</name><nr>%" PRIu64 "</nr>"
+                "<size>%zu</size><nodesize>%zu</nodesize></datastore>",
+                dbname, nr, sz, nr ? (size_t)(sz/nr) : 0);
+    }
+ ok:
+    retval = 0;
+ done:
+    if (xn)
+        xml_free(xn);
+    return retval;
+}
+
+/*! Get clixon per datastore stats
+ *
+ * @param[in]     h       Clixon handle
+ * @param[in]     dbname  Datastore name
+ * @param[in,out] cb      Cligen buf
+ * @retval        0       OK
+ * @retval       -1       Error
+ */
+static int
+clixon_stats_module_get(clicon_handle h,
+                        yang_stmt    *ys,
+                        cbuf         *cb)
+{
+    int       retval = -1;
+    uint64_t  nr = 0;
+    size_t    sz = 0;
+    cxobj    *xn = NULL;
+    
+    if (ys == NULL)
+        return 0;
+    if (yang_stats(ys, &nr, &sz) < 0)
+        goto done;
+    cprintf(cb, "<nr>%" PRIu64 "</nr><size>%zu</size>", nr, sz);
+    retval = 0;
+ done:
+    if (xn)
+        xml_free(xn);
+    return retval;
+}
+
+/*! Parse a local configuration file given as a file url into a bound and sorted XML tree
+ *
+ * The file is opened with the credentials of the peer user of the client, ie the backend
+ * temporarily takes the effective uid of the client if it runs as root. Otherwise only
+ * root or the user of the backend itself may read files.
+ * The file has a top element, eg <config>, as written by save_config_file, and is XML,
+ * or JSON if it starts with '{'. The children of the top element are bound to yang as
+ * they are parsed, see CLICON_XML_SCANNER.
+ * @param[in]  h       Clixon handle
+ * @param[in]  ce      Client entry
+ * @param[in]  url     File url, eg file:///tmp/config.xml
+ * @param[in]  yspec   Yang spec
+ * @param[out] xtp     XML tree: <top><config>...</config></top>, free with xml_free
+ * @param[out] cbret   Error XML tree if retval is 0
+ * @retval     1       OK
+ * @retval     0       Error, cbret set
+ * @retval    -1       Error
+ * @see load_config_file  CLI client
+ */
+static int
+from_client_url_load(clicon_handle        h,
+                     struct client_entry *ce,
+                     char                *url,
+                     yang_stmt           *yspec,
+                     cxobj              **xtp,
+                     cbuf                *cbret)
+{
+    int    retval = -1;
+    char  *path;
+    uid_t  uid;
+    int    priv = 0;
+    FILE  *fp = NULL;
+    int    err = 0;
+    int    c;
+    cxobj *xt = NULL;
+    cxobj *xerr = NULL;
+    cbuf  *cbmsg = NULL;
+    int    ret;
+
+    if ((cbmsg = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (strncmp(url, "file://", strlen("file://")) != 0 ||
+        *(path = url + strlen("file://")) != '/'){
+        cprintf(cbmsg, "Only absolute file urls are supported: %s", url);
+        if (netconf_operation_not_supported(cbret, "application", cbuf_get(cbmsg)) < 0)
+            goto done;
+        goto fail;
+    }
+    if (ce->ce_username == NULL){
+        if (netconf_access_denied(cbret, "application", "No peer user credentials available") < 0)
+            goto done;
+        goto fail;
+    }
+    if (name2uid(ce->ce_username, &uid) < 0){
+        if (netconf_access_denied(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        goto fail;
+    }
+    if (uid != 0 && uid != geteuid()){
+        if (geteuid() != 0){
+            cprintf(cbmsg, "User %s may not read files as backend user", ce->ce_username);
+            if (netconf_access_denied(cbret, "application", cbuf_get(cbmsg)) < 0)
+                goto done;
+            goto fail;
+        }
+        if (drop_priv_temp(uid) < 0)
+            goto done;
+        priv++;
+    }
+    if ((fp = fopen(path, "r")) == NULL)
+        err = errno;
+    if (priv && restore_priv() < 0)
+        goto done;
+    if (fp == NULL){
+        cprintf(cbmsg, "%s: %s", path, strerror(err));
+        if (err == EACCES){
+            if (netconf_access_denied(cbret, "application", cbuf_get(cbmsg)) < 0)
+                goto done;
+        }
+        else if (netconf_operation_failed(cbret, "application", cbuf_get(cbmsg)) < 0)
+            goto done;
+        goto fail;
+    }
+    while ((c = getc(fp)) != EOF && isspace(c))
+        ;
+    if (c != EOF)
+        ungetc(c, fp);
+    if (c == '{')
+        ret = clixon_json_parse_file(fp, 1, YB_MODULE_NEXT, yspec, &xt, &xerr);
+    else
+        ret = clixon_xml_parse_file(fp, YB_MODULE_NEXT, yspec, &xt, &xerr);
+    if (ret < 0){
+        cprintf(cbmsg, "%s: %s", path, clicon_err_reason);
+        if (netconf_operation_failed(cbret, "application", cbuf_get(cbmsg)) < 0)
+            goto done;
+        goto fail;
+    }
+    if (ret == 0){
+        if (clixon_xml2cbuf(cbret, xerr, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+        goto fail;
+    }
+    *xtp = xt;
+    xt = NULL;
+    retval = 1;
+ done:
+    if (fp)
+        fclose(fp);
+    if (xt)
+        xml_free(xt);
+    if (xerr)
+        xml_free(xerr);
+    if (cbmsg)
+        cbuf_free(cbmsg);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Loads all or part of a specified configuration to target configuration
+ * 
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xn      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @note  According to RFC 7950 8.3: constraints MUST be enforced:
+ * o  during parsing of RPC payloads
+ * o  during processing of the <edit-config> operation
+ * But Clixon is flexible in allowing invalid XML payload here, only some specialized
+ * validations are made.
+ * However, what really should be done is to apply the change to the datastore and then
+ * validate, if error, discard to previous state. 
+ * But this could discard other previous changes to candidate.
+ * @note  Instead of <config>, a local file may be given as <url>, see from_client_url_load
+  */
+static int
+from_client_edit_config(clicon_handle h,
+                        cxobj        *xn,
+                        cbuf         *cbret,
+                        void         *arg,
+                        void         *regarg)
+{
+    int                 retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    uint32_t            myid = ce->ce_id;
+    uint32_t            iddb;
+    char               *target;
+    cxobj              *xc;
+    cxobj              *x;
+    enum operation_type operation = OP_MERGE;
+    int                 non_config = 0;
+    yang_stmt          *yspec;
+    cbuf               *cbx = NULL; /* Assist cbuf */
+    int                 ret;
+    char               *username;
+    cxobj              *xret = NULL;
+    char               *attr;
+    int                 autocommit = 0;
     char               *val = NULL;
     cvec               *nsc = NULL;
     char               *prefix = NULL;
+    int                 group = 0;
+    int                 privcand = 0;
+    uint64_t            version = 0;
+    char               *url = NULL;
+    cxobj              *xurl = NULL;
 
     username = clicon_username_get(h);
     if ((yspec =  clicon_dbspec_yang(h)) == NULL){
@@ -506,25 +1733,44 @@ from_client_edit_config(clicon_handle h,
             goto ok;
         }
     }
-    /* Get config element */
+    /* Get config element, or url of local file (bound when parsed) */
     if ((xc = xpath_first(xn, nsc, "%s%s%s",
                           prefix?prefix:"",
                           prefix?":":"",
-                          NETCONF_INPUT_CONFIG)) == NULL){
+                          NETCONF_INPUT_CONFIG)) == NULL &&
+        (url = xml_body(xpath_first(xn, nsc, "%s%surl",
+                                    prefix?prefix:"",
+                                    prefix?":":""))) == NULL){
         cprintf(cbx, "Element not found, or mismatching prefix %s for namespace %s",
                 prefix?prefix:"null", NETCONF_BASE_NAMESPACE);
         if (netconf_missing_element(cbret, "protocol", NETCONF_INPUT_CONFIG, cbuf_get(cbx)) < 0)
             goto done;
         goto ok;
     }
-    /* <config> yang spec may be set to anyxml by ingress yang check,...*/
-    if (xml_spec(xc) != NULL)
-        xml_spec_set(xc, NULL);
-    /* Populate XML with Yang spec. Binding is done in from_client_msg only frm an RPC perspective,
-     * where <config> is ANYDATA
-     */
-    if ((ret = xml_bind_yang(h, xc, YB_MODULE, yspec, &xret)) < 0)
-        goto done;
+    if (url != NULL){
+        if ((ret = from_client_url_load(h, ce, url, yspec, &xurl, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+        if ((xc = xml_child_i_type(xurl, 0, CX_ELMNT)) == NULL){
+            if (netconf_missing_element(cbret, "application", NETCONF_INPUT_CONFIG, "Empty file") < 0)
+                goto done;
+            goto ok;
+        }
+        if (xml_name_set(xc, NETCONF_INPUT_CONFIG) < 0)
+            goto done;
+        ret = 1;
+    }
+    else {
+        /* <config> yang spec may be set to anyxml by ingress yang check,...*/
+        if (xml_spec(xc) != NULL)
+            xml_spec_set(xc, NULL);
+        /* Populate XML with Yang spec. Binding is done in from_client_msg only frm an RPC perspective,
+         * where <config> is ANYDATA
+         */
+        if ((ret = xml_bind_yang(h, xc, YB_MODULE, yspec, &xret)) < 0)
+            goto done;
+    }
     if (ret == 0){
         if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
             goto done;
@@ -560,6 +1806,35 @@ from_client_edit_config(clicon_handle h,
      */
     if (xml_sort_recurse(xc) < 0)
         goto done;
+    /* Clixon extension: autocommit */
+    if ((attr = xml_find_value(xn, "autocommit")) != NULL &&
+        strcmp(attr,"true") == 0)
+        autocommit = 1;
+    /* Group commit of non-conflicting merge edits, see CLICON_AUTOCOMMIT_GROUP_WINDOW */
+    if ((clicon_autocommit(h) || autocommit) &&
+        clicon_option_int(h, "CLICON_AUTOCOMMIT_GROUP_WINDOW") > 0 &&
+        strcmp(target, "candidate") == 0 &&
+        operation != OP_REPLACE &&
+        xml_find_value(xc, "operation") == NULL &&
+        xml_find_value(xn, "copystartup") == NULL &&
+        (!if_feature(yspec, "ietf-netconf", "confirmed-commit") ||
+         confirmed_commit_state_get(h) == INACTIVE)){
+        if ((ret = autocommit_group_conflict(xc)) < 0)
+            goto done;
+        group = 1;
+    }
+    else
+        ret = 1;
+    /* Commit pending edits before a conflicting or non-grouped edit */
+    if (ret == 1 && autocommit_group_commit(h) < 0)
+        goto done;
+    /* Inverse changes of a confirmed-commit do not cover direct edits of running */
+    if (strcmp(target, "running") == 0 &&
+        confirmed_commit_rollback_save(h) < 0)
+        goto done;
+    if (strcmp(target, "running") == 0 &&
+        xmldb_version_get(h, "running", &version, NULL) < 0)
+        goto done;
     if ((ret = xmldb_put(h, target, operation, xc, username, cbret)) < 0){
         if (netconf_operation_failed(cbret, "protocol", clicon_err_reason)< 0)
             goto done;
@@ -568,12 +1843,15 @@ from_client_edit_config(clicon_handle h,
     if (ret == 0)
         goto ok;
     xmldb_modified_set(h, target, 1); /* mark as dirty */
-    /* Clixon extension: autocommit */
-    if ((attr = xml_find_value(xn, "autocommit")) != NULL &&
-        strcmp(attr,"true") == 0)
-        autocommit = 1;
+    /* Record edit for rebase of private candidates, see CLICON_XMLDB_PRIVATE_CANDIDATE */
+    if (strcmp(target, "running") == 0){
+        if (backend_private_running(h, version, operation==OP_REPLACE?NULL:xc) < 0)
+            goto done;
+    }
+    else if ((privcand = backend_private_edit(h, myid, target, xc, operation)) < 0)
+        goto done;
     /* If autocommit option is set or requested by client */
-    if (clicon_autocommit(h) || autocommit) {
+    if (!group && (clicon_autocommit(h) || autocommit)) {
         /* if this is from a restconf client ...
          *      and, if there is an existing ephemeral commit, set is_valid_confirming_commit=1 such that
          *          candidate_commit will apply the configuration per RFC 8040 1.4:
@@ -602,14 +1880,25 @@ from_client_edit_config(clicon_handle h,
                 break;
             }
         }
-        if ((ret = candidate_commit(h, NULL, "candidate", myid, 0, cbret)) < 0){ /* Assume validation fail, nofatal */
+        if (privcand)
+            ret = backend_private_commit(h, NULL, myid, cbret);
+        else
+            ret = candidate_commit(h, NULL, "candidate", myid, 0, cbret);
+        if (ret < 0){ /* Assume validation fail, nofatal */
             if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
                 goto done;
-            xmldb_copy(h, "running", "candidate");
+            if (privcand)
+                backend_private_discard(h, myid);
+            else
+                xmldb_copy(h, "running", "candidate");
             goto ok;
         }
         if (ret == 0){ /* discard */
-            if (xmldb_copy(h, "running", "candidate") < 0){
+            if (privcand)
+                ret = backend_private_discard(h, myid);
+            else
+                ret = xmldb_copy(h, "running", "candidate");
+            if (ret < 0){
                 if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
                     goto done;
                 goto ok;
@@ -636,9 +1925,14 @@ from_client_edit_config(clicon_handle h,
                 CLIXON_LIB_PREFIX, val,
                 CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     cprintf(cbret, "/></rpc-reply>");
+    /* Reply is sent when the group is committed, see from_client_msg */
+    if (group && autocommit_group_add(h, ce, xc, operation, username) < 0)
+        goto done;
  ok:
     retval = 0;
  done:
+    if (xurl)
+        xml_free(xurl);
     if (nsc)
         cvec_free(nsc);
     if (xret)
@@ -679,6 +1973,7 @@ from_client_copy_config(clicon_handle h,
     uint32_t             myid = ce->ce_id;
     cbuf                *cbx = NULL; /* Assist cbuf */
     cbuf                *cbmsg = NULL;
+    uint64_t             version = 0;
     
     if ((source = netconf_db_find(xe, "source")) == NULL){
         if (netconf_missing_element(cbret, "protocol", "source", NULL) < 0)
@@ -702,6 +1997,12 @@ from_client_copy_config(clicon_handle h,
             goto done;
         goto ok;
     }
+    if (strcmp(target, "running") == 0 &&
+        confirmed_commit_rollback_save(h) < 0)
+        goto done;
+    if (strcmp(target, "running") == 0 &&
+        xmldb_version_get(h, "running", &version, NULL) < 0)
+        goto done;
     if (xmldb_copy(h, source, target) < 0){
         if ((cbmsg = cbuf_new()) == NULL){
             clicon_err(OE_UNIX, errno, "cbuf_new");
@@ -713,6 +2014,13 @@ from_client_copy_config(clicon_handle h,
         goto ok;
     }
     xmldb_modified_set(h, target, 1); /* mark as dirty */
+    /* A replaced private candidate or running is not rebased */
+    if (strcmp(target, "running") == 0){
+        if (backend_private_running(h, version, NULL) < 0)
+            goto done;
+    }
+    else if (backend_private_edit(h, myid, target, NULL, OP_REPLACE) < 0)
+        goto done;
     cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
  ok:
     retval = 0;
@@ -980,6 +2288,7 @@ from_client_close_session(clicon_handle h,
     if (release_all_dbs(h, id) < 0)
         return -1;
     stream_ss_delete_all(h, ce_event_cb, (void*)ce);
+    backend_push_delete_all(h, ce_event_cb, (void*)ce);
     cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
     return 0;
 }
@@ -1021,7 +2330,7 @@ from_client_kill_session(clicon_handle h,
     if (ret == 0)
         goto ok;
     /* may or may not be in active client list, probably not */
-    if ((ce = ce_find_byid(backend_client_list(h), id)) != NULL){
+    if ((ce = backend_client_find(h, id)) != NULL){
         if (release_all_dbs(h, id) < 0)
             goto done;
         backend_client_rm(h, ce); /* Removes client struct */
@@ -1100,47 +2409,211 @@ from_client_create_subscription(clicon_handle h,
             goto ok;    
         }       
     }
-    if ((xfilter = xpath_first(xe, nsc, "//filter")) != NULL){
-        if ((ftype = xml_find_value(xfilter, "type")) != NULL){
-            /* Only accept xpath as filter type */
-            if (strcmp(ftype, "xpath") != 0){
-                if (netconf_operation_failed(cbret, "application", "Only xpath filter type supported")< 0)
-                    goto done;
-                goto ok;
-            }
-            if ((selector = xml_find_value(xfilter, "select")) == NULL)
-                goto done;
-        }
+    if ((xfilter = xpath_first(xe, nsc, "//filter")) != NULL){
+        if ((ftype = xml_find_value(xfilter, "type")) != NULL){
+            /* Only accept xpath as filter type */
+            if (strcmp(ftype, "xpath") != 0){
+                if (netconf_operation_failed(cbret, "application", "Only xpath filter type supported")< 0)
+                    goto done;
+                goto ok;
+            }
+            if ((selector = xml_find_value(xfilter, "select")) == NULL)
+                goto done;
+        }
+    }
+    if ((stream_find(h, stream)) == NULL){
+        if (netconf_invalid_value(cbret, "application", "No such stream") < 0)
+            goto done;
+        goto ok;
+    }
+    /* Add subscriber to stream - to make notifications for this client */
+    if (stream_ss_add(h, stream, selector,
+                      starttime?&start:NULL, stoptime?&stop:NULL,
+                      ce_event_cb, (void*)ce) == NULL)
+        goto done;
+    /* Replay of this stream to specific subscription according to start and 
+     * stop (if present). 
+     * RFC 5277: If <startTime> is not present, this is not a replay
+     * subscription.
+     * Schedule the replay to occur right after this RPC completes, eg "now"
+     */
+    if (starttime){ 
+        if (stream_replay_trigger(h, stream, ce_event_cb, (void*)ce) < 0)
+            goto done;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+ ok:
+    retval = 0;
+  done:
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+}
+
+/*! Create an on-change or periodic subscription of the running datastore, subset of RFC 8641
+ *
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see backend_push_commit where changes are sent as push-change-update notifications
+ * @see backend_push_periodic_add for periodic push-update notifications
+ */
+static int
+from_client_datastore_push(clicon_handle h,
+                           cxobj        *xe,
+                           cbuf         *cbret,
+                           void         *arg, 
+                           void         *regarg)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    cxobj               *x;
+    char                *xpath;
+    char                *str;
+    uint32_t             dampening = 0;
+    uint32_t             period = 0;
+    uint32_t             id = 0;
+    cvec                *nsc = NULL;
+    int                  ret;
+
+    if ((x = xml_find_type(xe, NULL, "datastore-xpath-filter", CX_ELMNT)) == NULL ||
+        (xpath = xml_body(x)) == NULL){
+        if (netconf_missing_element(cbret, "application", "datastore-xpath-filter", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Namespace context of xpath prefixes */
+    if (xml_nsctx_node(x, &nsc) < 0)
+        goto done;
+    if ((str = xml_find_body(xe, "dampening-period")) != NULL){
+        if ((ret = netconf_parse_uint32("dampening-period", str, NULL, 0, cbret, &dampening)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    if ((str = xml_find_body(xe, "period")) != NULL){
+        if ((ret = netconf_parse_uint32("period", str, NULL, 0, cbret, &period)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
     }
-    if ((stream_find(h, stream)) == NULL){
-        if (netconf_invalid_value(cbret, "application", "No such stream") < 0)
+    if (period){
+        if ((ret = backend_push_periodic_add(h, xpath, nsc, period, ce->ce_username,
+                                             ce_event_cb, (void*)ce, &id)) < 0)
             goto done;
-        goto ok;
     }
-    /* Add subscriber to stream - to make notifications for this client */
-    if (stream_ss_add(h, stream, selector,
-                      starttime?&start:NULL, stoptime?&stop:NULL,
-                      ce_event_cb, (void*)ce) < 0)
+    else if ((ret = backend_push_add(h, xpath, nsc, dampening, ce_event_cb, (void*)ce, &id)) < 0)
         goto done;
-    /* Replay of this stream to specific subscription according to start and 
-     * stop (if present). 
-     * RFC 5277: If <startTime> is not present, this is not a replay
-     * subscription.
-     * Schedule the replay to occur right after this RPC completes, eg "now"
-     */
-    if (starttime){ 
-        if (stream_replay_trigger(h, stream, ce_event_cb, (void*)ce) < 0)
+    if (ret == 0){
+        if (netconf_invalid_value(cbret, "application", "Invalid datastore-xpath-filter") < 0)
             goto done;
+        goto ok;
     }
-    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><id xmlns=\"%s\">%" PRIu32 "</id></rpc-reply>",
+            NETCONF_BASE_NAMESPACE, CLIXON_LIB_NS, id);
  ok:
     retval = 0;
-  done:
+ done:
     if (nsc)
         xml_nsctx_free(nsc);
     return retval;
 }
 
+/* XML encoded yang source text of all modules of a yang spec, see from_client_get_schema */
+static clicon_hash_t *_schema_cache = NULL;
+static yang_stmt     *_schema_cache_yspec = NULL;
+static int            _schema_cache_len = 0;
+
+/*! Key of yang module in schema cache: "identifier@revision" or "identifier"
+ */
+static int
+schema_cache_key(yang_stmt *ymod,
+                 char      *key,
+                 size_t     len)
+{
+    yang_stmt *yrev;
+
+    if ((yrev = yang_find(ymod, Y_REVISION, NULL)) != NULL)
+        snprintf(key, len, "%s@%s", yang_argument_get(ymod), yang_argument_get(yrev));
+    else
+        snprintf(key, len, "%s", yang_argument_get(ymod));
+    return 0;
+}
+
+/*! Read and encode the yang source text of all modules of a yang spec into the schema cache
+ *
+ * The cache is rebuilt if the yang spec has changed since it was built
+ * @param[in]  yspec  Yang spec
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+schema_cache_build(yang_stmt *yspec)
+{
+    int         retval = -1;
+    yang_stmt  *ymod = NULL;
+    cbuf       *cbyang = NULL;
+    cbuf       *cbenc = NULL;
+    const char *filename;
+    char        key[256];
+
+    if (_schema_cache && _schema_cache_yspec == yspec &&
+        _schema_cache_len == yang_len_get(yspec))
+        return 0;
+    backend_schema_cache_free();
+    if ((_schema_cache = clicon_hash_init()) == NULL)
+        goto done;
+    if ((cbyang = cbuf_new()) == NULL ||
+        (cbenc = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    while ((ymod = yn_each(yspec, ymod)) != NULL) {
+        if (yang_keyword_get(ymod) != Y_MODULE &&
+            yang_keyword_get(ymod) != Y_SUBMODULE)
+            continue;
+        cbuf_reset(cbyang);
+        cbuf_reset(cbenc);
+        if ((filename = yang_filename_get(ymod)) != NULL){
+            if (clicon_file_cbuf(filename, cbyang) < 0)
+                goto done;
+        }
+        if (xml_chardata_cbuf_append(cbenc, cbuf_get(cbyang)) < 0)
+            goto done;
+        schema_cache_key(ymod, key, sizeof(key));
+        if (clicon_hash_add(_schema_cache, key, cbuf_get(cbenc), cbuf_len(cbenc)+1) == NULL)
+            goto done;
+    }
+    _schema_cache_yspec = yspec;
+    _schema_cache_len = yang_len_get(yspec);
+    retval = 0;
+ done:
+    if (retval < 0)
+        backend_schema_cache_free();
+    if (cbyang)
+        cbuf_free(cbyang);
+    if (cbenc)
+        cbuf_free(cbenc);
+    return retval;
+}
+
+/*! Free schema cache
+ */
+int
+backend_schema_cache_free(void)
+{
+    if (_schema_cache)
+        clicon_hash_free(_schema_cache);
+    _schema_cache = NULL;
+    _schema_cache_yspec = NULL;
+    _schema_cache_len = 0;
+    return 0;
+}
+
 /*! Retrieve a schema from the NETCONF server.
  *
  * @param[in]  h       Clixon handle 
@@ -1169,9 +2642,9 @@ from_client_get_schema(clicon_handle h,
     yang_stmt  *ymod;
     yang_stmt  *ymatch;
     yang_stmt  *yrev;
-    cbuf       *cbyang = NULL;
     cbuf       *cbmsg = NULL;
-    const char *filename;    
+    char        key[256];
+    char       *body;
 
     if ((yspec =  clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_YANG, ENOENT, "No yang spec");
@@ -1240,32 +2713,380 @@ from_client_get_schema(clicon_handle h,
             goto done;
         goto ok;
     }
+    /* Yang source text is read and encoded once, not on every request */
+    if (schema_cache_build(yspec) < 0)
+        goto done;
+    schema_cache_key(ymatch, key, sizeof(key));
     cprintf(cbret, "<rpc-reply xmlns=\"%s\"><data xmlns=\"%s\">",
             NETCONF_BASE_NAMESPACE, NETCONF_MONITORING_NAMESPACE);
-    if ((cbyang = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
+    if ((body = clicon_hash_value(_schema_cache, key, NULL)) != NULL)
+        cbuf_append_str(cbret, body);
+    cprintf(cbret, "</data></rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    if (cbmsg)
+        cbuf_free(cbmsg);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+}
+
+/*! Set debug level. 
+ *
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+from_client_debug(clicon_handle h,
+                  cxobj        *xe,
+                  cbuf         *cbret,
+                  void         *arg,
+                  void         *regarg)
+{
+    int      retval = -1;
+    uint32_t level;
+    char    *valstr;
+    
+    if ((valstr = xml_find_body(xe, "level")) == NULL){
+        if (netconf_missing_element(cbret, "application", "level", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    level = atoi(valstr);
+
+    clicon_debug_init(level, NULL); /* 0: dont debug, 1:debug */
+    setlogmask(LOG_UPTO(level?LOG_DEBUG:LOG_INFO)); /* for syslog */
+    clicon_log(LOG_NOTICE, "%s debug:%d", __FUNCTION__, clicon_debug_get());
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Wait until all pending datastore writes are durable, then send a reply
+ *
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_XMLDB_ASYNC
+ */
+static int
+from_client_datastore_sync(clicon_handle h,
+                           cxobj        *xe,
+                           cbuf         *cbret,
+                           void         *arg,
+                           void         *regarg)
+{
+    if (xmldb_async_barrier(h, NULL) < 0){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            return -1;
+        return 0;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+    return 0;
+}
+
+/*! Compact datastore caches and reply with number of reclaimed bytes
+ *
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see xmldb_cache_compact
+ */
+static int
+from_client_compact(clicon_handle h,
+                    cxobj        *xe,
+                    cbuf         *cbret,
+                    void         *arg,
+                    void         *regarg)
+{
+    size_t sz = 0;
+
+    if (xmldb_cache_compact(h, &sz) < 0)
+        return -1;
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><reclaimed xmlns=\"%s\">%zu</reclaimed></rpc-reply>",
+            NETCONF_BASE_NAMESPACE, CLIXON_LIB_NS, sz);
+    return 0;
+}
+
+/*! Get content version and last modification time of a datastore
+ *
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see xmldb_version_get
+ */
+static int
+from_client_datastore_version(clicon_handle h,
+                              cxobj        *xe,
+                              cbuf         *cbret,
+                              void         *arg,
+                              void         *regarg)
+{
+    int            retval = -1;
+    char          *db = "running";
+    cxobj         *x;
+    uint64_t       version;
+    struct timeval tv;
+    char           timestr[28];
+
+    if ((x = xml_find_type(xe, NULL, "datastore", CX_ELMNT)) != NULL &&
+        xml_body(x) != NULL)
+        db = xml_body(x);
+    if (xmldb_exists(h, db) != 1){
+        if (netconf_invalid_value(cbret, "protocol", "No such datastore") < 0)
+            goto done;
+        goto ok;
+    }
+    if (xmldb_version_get(h, db, &version, &tv) < 0)
+        goto done;
+    if (time2str(&tv, timestr, sizeof(timestr)) < 0){
+        clicon_err(OE_UNIX, errno, "time2str");
+        goto done;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<version xmlns=\"%s\">%" PRIu64 "</version>", CLIXON_LIB_NS, version);
+    cprintf(cbret, "<last-modified xmlns=\"%s\">%s</last-modified>", CLIXON_LIB_NS, timestr);
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get values of leaf and leaf-list nodes selected by an xpath in a datastore
+ *
+ * Only the values are sent, not the sub-trees of the nodes or their ancestors.
+ * Duplicates are removed: values of ordered-by system lists are sorted so only adjacent
+ * values are compared, ordered-by user values are compared with all previous values.
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see from_client_datastore_version
+ */
+static int
+from_client_datastore_values(clicon_handle h,
+                             cxobj        *xe,
+                             cbuf         *cbret,
+                             void         *arg,
+                             void         *regarg)
+{
+    int            retval = -1;
+    char          *db = "running";
+    cxobj         *x;
+    char          *xpath;
+    char          *prefix;
+    char          *str;
+    char          *reason = NULL;
+    char          *username;
+    cvec          *nsc = NULL;
+    uint64_t       version0 = 0;
+    uint64_t       version;
+    struct timeval tv;
+    cxobj         *xt = NULL;
+    cxobj        **xvec = NULL;
+    size_t         xlen = 0;
+    cxobj         *xnacm;
+    yang_stmt     *y;
+    yang_stmt     *yp;
+    char          *bodystr;
+    char          *bodystr0 = NULL;
+    cvec          *values = NULL;
+    cg_var        *cv;
+    int            i;
+    int            ret;
+
+    if ((x = xml_find_type(xe, NULL, "datastore", CX_ELMNT)) != NULL &&
+        xml_body(x) != NULL)
+        db = xml_body(x);
+    if (xmldb_exists(h, db) != 1){
+        if (netconf_invalid_value(cbret, "protocol", "No such datastore") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((x = xml_find_type(xe, NULL, "xpath", CX_ELMNT)) == NULL ||
+        (xpath = xml_body(x)) == NULL){
+        if (netconf_missing_element(cbret, "application", "xpath", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Namespace context of xpath prefixes */
+    if (xml_nsctx_node(x, &nsc) < 0)
+        goto done;
+    prefix = xml_find_body(xe, "prefix");
+    if ((str = xml_find_body(xe, "version")) != NULL){
+        if ((ret = parse_uint64(str, &version0, &reason)) < 0){
+            clicon_err(OE_XML, errno, "parse_uint64");
+            goto done;
+        }
+        if (ret == 0){
+            if (netconf_bad_element(cbret, "application", "version", reason) < 0)
+                goto done;
+            goto ok;
+        }
+    }
+    if (xmldb_version_get(h, db, &version, &tv) < 0)
+        goto done;
+    if (version0 != 0 && version0 == version){
+        cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+        cprintf(cbret, "<version xmlns=\"%s\">%" PRIu64 "</version>", CLIXON_LIB_NS, version);
+        cprintf(cbret, "<unchanged xmlns=\"%s\"/>", CLIXON_LIB_NS);
+        cprintf(cbret, "</rpc-reply>");
+        goto ok;
+    }
+    if (xmldb_get0(h, db, YB_MODULE, nsc, xpath, 1, WITHDEFAULTS_EXPLICIT, &xt, NULL, NULL) < 0)
+        goto done;
+    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath) < 0)
+        goto done;
+    if ((username = clicon_username_get(h)) != NULL &&
+        (xnacm = clicon_nacm_cache(h)) != NULL){
+        if (nacm_datanode_read(h, xt, xvec, xlen, username, xnacm) < 0)
+            goto done;
+        /* Read access may have removed nodes */
+        free(xvec);
+        xvec = NULL;
+        if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath) < 0)
+            goto done;
+    }
+    if ((values = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    for (i = 0; i < xlen; i++) {
+        x = xvec[i];
+        if (xml_type(x) == CX_BODY)
+            bodystr = xml_value(x);
+        else
+            bodystr = xml_body(x);
+        if (bodystr == NULL)
+            continue; /* no body, cornercase */
+        if (prefix && strncmp(bodystr, prefix, strlen(prefix)) != 0)
+            continue;
+        if ((y = xml_spec(x)) != NULL &&
+            (yp = yang_parent_get(y)) != NULL &&
+            yang_keyword_get(yp) == Y_LIST &&
+            yang_find(yp, Y_ORDERED_BY, "user") != NULL){
+            /* Detect duplicates linearly in existing values */
+            cv = NULL;
+            while ((cv = cvec_each(values, cv)) != NULL)
+                if (strcmp(cv_string_get(cv), bodystr) == 0)
+                    break;
+            if (cv != NULL)
+                continue;
+        }
+        else{
+            if (bodystr0 && strcmp(bodystr, bodystr0) == 0)
+                continue; /* duplicate, assume sorted */
+            bodystr0 = bodystr;
+        }
+        if (cvec_add_string(values, NULL, bodystr) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<version xmlns=\"%s\">%" PRIu64 "</version>", CLIXON_LIB_NS, version);
+    cprintf(cbret, "<values xmlns=\"%s\">", CLIXON_LIB_NS);
+    cv = NULL;
+    while ((cv = cvec_each(values, cv)) != NULL){
+        cprintf(cbret, "<value>");
+        if (xml_chardata_cbuf_append(cbret, cv_string_get(cv)) < 0)
+            goto done;
+        cprintf(cbret, "</value>");
+    }
+    cprintf(cbret, "</values>");
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    if (values)
+        cvec_free(values);
+    if (xvec)
+        free(xvec);
+    if (xt)
+        xml_free(xt);
+    if (reason)
+        free(reason);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+}
+
+/*! Copy the nodes of a datastore tree that differ from another datastore
+ *
+ * @param[in]  xt    Datastore tree
+ * @param[in]  vec   Nodes only in xt
+ * @param[in]  len   Length of vec
+ * @param[in]  cvec  Changed nodes of xt
+ * @param[in]  clen  Length of cvec
+ * @param[out] xp    Copy of nodes with ancestors and list keys. Free with xml_free
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+datastore_diff_copy(cxobj  *xt,
+                    cxobj **vec,
+                    int     len,
+                    cxobj **cvec,
+                    int     clen,
+                    cxobj **xp)
+{
+    int    retval = -1;
+    cxobj *x = NULL;
+    int    i;
+
+    if ((x = xml_new(NETCONF_OUTPUT_DATA, NULL, CX_ELMNT)) == NULL)
         goto done;
+    for (i=0; i<len; i++){
+        xml_flag_set(vec[i], XML_FLAG_MARK);
+        xml_apply_ancestor(vec[i], (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
     }
-    if ((filename = yang_filename_get(ymatch)) != NULL){
-        if (clicon_file_cbuf(filename, cbyang) < 0)
-            goto done;
+    for (i=0; i<clen; i++){
+        xml_flag_set(cvec[i], XML_FLAG_MARK);
+        xml_apply_ancestor(cvec[i], (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
     }
-    xml_chardata_cbuf_append(cbret, cbuf_get(cbyang));
-    cprintf(cbret, "</data></rpc-reply>");
- ok:
+    if (xml_copy_marked(xt, x) < 0)
+        goto done;
+    if (xml_flag_reset_rec(xt, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
+        goto done;
+    if (xml_flag_reset_rec(x, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
+        goto done;
+    *xp = x;
+    x = NULL;
     retval = 0;
  done:
-    if (cbmsg)
-        cbuf_free(cbmsg);
-    if (cbyang)
-        cbuf_free(cbyang);
-    if (nsc)
-        xml_nsctx_free(nsc);
+    if (x)
+        xml_free(x);
     return retval;
 }
 
-/*! Set debug level. 
+/*! Get differences between configuration of two datastores
  *
+ * The differences are computed from the datastore caches, and only the nodes that differ are
+ * copied and sent, instead of both datastores.
  * @param[in]  h       Clixon handle 
  * @param[in]  xe      Request: <rpc><xn></rpc> 
  * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
@@ -1273,32 +3094,102 @@ from_client_get_schema(clicon_handle h,
  * @param[in]  regarg  User argument given at rpc_callback_register() 
  * @retval     0       OK
  * @retval    -1       Error
+ * @see compare_db_names  CLI rendering of the differences
  */
 static int
-from_client_debug(clicon_handle h,
-                  cxobj        *xe,
-                  cbuf         *cbret,
-                  void         *arg,
-                  void         *regarg)
+from_client_datastore_diff(clicon_handle h,
+                           cxobj        *xe,
+                           cbuf         *cbret,
+                           void         *arg,
+                           void         *regarg)
 {
     int      retval = -1;
-    uint32_t level;
-    char    *valstr;
-    
-    if ((valstr = xml_find_body(xe, "level")) == NULL){
-        if (netconf_missing_element(cbret, "application", "level", NULL) < 0)
+    char    *db1;
+    char    *db2;
+    cxobj   *xt1 = NULL;
+    cxobj   *xt2 = NULL;
+    cxobj   *x1 = NULL;
+    cxobj   *x2 = NULL;
+    cxobj  **dvec = NULL;
+    int      dlen;
+    cxobj  **avec = NULL;
+    int      alen;
+    cxobj  **chvec0 = NULL;
+    cxobj  **chvec1 = NULL;
+    int      chlen;
+    char    *username;
+    cxobj   *xnacm;
+
+    if ((db1 = xml_find_body(xe, "datastore1")) == NULL){
+        if (netconf_missing_element(cbret, "application", "datastore1", NULL) < 0)
             goto done;
         goto ok;
     }
-    level = atoi(valstr);
-
-    clicon_debug_init(level, NULL); /* 0: dont debug, 1:debug */
-    setlogmask(LOG_UPTO(level?LOG_DEBUG:LOG_INFO)); /* for syslog */
-    clicon_log(LOG_NOTICE, "%s debug:%d", __FUNCTION__, clicon_debug_get());
-    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+    if ((db2 = xml_find_body(xe, "datastore2")) == NULL){
+        if (netconf_missing_element(cbret, "application", "datastore2", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if (xmldb_exists(h, db1) != 1 || xmldb_exists(h, db2) != 1){
+        if (netconf_invalid_value(cbret, "protocol", "No such datastore") < 0)
+            goto done;
+        goto ok;
+    }
+    if (xmldb_get0(h, db1, YB_MODULE, NULL, "/", 0, WITHDEFAULTS_EXPLICIT, &xt1, NULL, NULL) < 0)
+        goto done;
+    if (xmldb_get0(h, db2, YB_MODULE, NULL, "/", 0, WITHDEFAULTS_EXPLICIT, &xt2, NULL, NULL) < 0)
+        goto done;
+    if (xml_diff_threads(xt1, xt2,
+                         clicon_option_int(h, "CLICON_XML_DIFF_THREADS"),
+                         &dvec, &dlen,       /* only in db1 */
+                         &avec, &alen,       /* only in db2 */
+                         &chvec0, &chvec1,   /* changed: values in db1 and db2 */
+                         &chlen) < 0)
+        goto done;
+    if (datastore_diff_copy(xt1, dvec, dlen, chvec0, chlen, &x1) < 0)
+        goto done;
+    if (datastore_diff_copy(xt2, avec, alen, chvec1, chlen, &x2) < 0)
+        goto done;
+    if ((username = clicon_username_get(h)) != NULL &&
+        (xnacm = clicon_nacm_cache(h)) != NULL){
+        if (nacm_datanode_read(h, x1, NULL, 0, username, xnacm) < 0)
+            goto done;
+        if (nacm_datanode_read(h, x2, NULL, 0, username, xnacm) < 0)
+            goto done;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<config1 xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (clixon_xml2cbuf(cbret, x1, 0, 0, NULL, -1, 1) < 0)
+        goto done;
+    cprintf(cbret, "</config1>");
+    cprintf(cbret, "<config2 xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (clixon_xml2cbuf(cbret, x2, 0, 0, NULL, -1, 1) < 0)
+        goto done;
+    cprintf(cbret, "</config2>");
+    cprintf(cbret, "</rpc-reply>");
  ok:
     retval = 0;
  done:
+    if (dvec)
+        free(dvec);
+    if (avec)
+        free(avec);
+    if (chvec0)
+        free(chvec0);
+    if (chvec1)
+        free(chvec1);
+    if (x1)
+        xml_free(x1);
+    if (x2)
+        xml_free(x2);
+    if (xt1){
+        xmldb_get0_clear(h, xt1);
+        xmldb_get0_free(h, &xt1);
+    }
+    if (xt2){
+        xmldb_get0_clear(h, xt2);
+        xmldb_get0_free(h, &xt2);
+    }
     return retval;
 }
 
@@ -1342,6 +3233,12 @@ from_client_stats(clicon_handle h,
 {
     int        retval = -1;
     uint64_t   nr;
+    uint64_t   slabnr;
+    uint64_t   hits;
+    uint64_t   misses;
+    size_t     sz;
+    size_t     elsz;
+    size_t     bodysz;
     yang_stmt *ym;
     char      *str;
     int        modules = 0;
@@ -1360,8 +3257,39 @@ from_client_stats(clicon_handle h,
     nr=0;
     yang_stats_global(&nr);
     cprintf(cbret, "<yangnr>%" PRIu64 "</yangnr>", nr);
+    nr = 0; slabnr = 0; sz = 0;
+    xml_stats_arena_global(&nr, &slabnr, &sz);
+    cprintf(cbret, "<xmlarenanr>%" PRIu64 "</xmlarenanr>", nr);
+    cprintf(cbret, "<xmlarenaslabs>%" PRIu64 "</xmlarenaslabs>", slabnr);
+    cprintf(cbret, "<xmlarenasize>%zu</xmlarenasize>", sz);
+    nr = 0; sz = 0;
+    clixon_string_intern_stats(&nr, &sz);
+    cprintf(cbret, "<internnr>%" PRIu64 "</internnr>", nr);
+    cprintf(cbret, "<internsize>%zu</internsize>", sz);
+    nr = 0;
+    xml_stats_nodesize(&elsz, &bodysz, &sz, &nr);
+    cprintf(cbret, "<xmlelementsize>%zu</xmlelementsize>", elsz);
+    cprintf(cbret, "<xmlbodysize>%zu</xmlbodysize>", bodysz);
+    cprintf(cbret, "<xmlextsize>%zu</xmlextsize>", sz);
+    cprintf(cbret, "<xmlextnr>%" PRIu64 "</xmlextnr>", nr);
+    nr = 0; sz = 0; hits = 0; misses = 0;
+    xpath_cache_stats(&nr, &sz, &hits, &misses);
+    cprintf(cbret, "<xpathcachenr>%" PRIu64 "</xpathcachenr>", nr);
+    cprintf(cbret, "<xpathcachesize>%zu</xpathcachesize>", sz);
+    cprintf(cbret, "<xpathcachehits>%" PRIu64 "</xpathcachehits>", hits);
+    cprintf(cbret, "<xpathcachemisses>%" PRIu64 "</xpathcachemisses>", misses);
+    cprintf(cbret, "<logdropped>%" PRIu64 "</logdropped>", clicon_log_dropped());
+    hits = 0; misses = 0; sz = 0;
+    clixon_pool_stats(&hits, &misses, &sz);
+    cprintf(cbret, "<poolhits>%" PRIu64 "</poolhits>", hits);
+    cprintf(cbret, "<poolmisses>%" PRIu64 "</poolmisses>", misses);
+    cprintf(cbret, "<poolsize>%zu</poolsize>", sz);
     cprintf(cbret, "</global>");
     cprintf(cbret, "<datastores xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (xmldb_cache_stats(h, &sz, &nr) < 0)
+        goto done;
+    cprintf(cbret, "<cachesize>%zu</cachesize>", sz);
+    cprintf(cbret, "<cacheevictions>%" PRIu64 "</cacheevictions>", nr);
     if (clixon_stats_datastore_get(h, "running", cbret) < 0)
         goto done;
     if (clixon_stats_datastore_get(h, "candidate", cbret) < 0)
@@ -1370,6 +3298,18 @@ from_client_stats(clicon_handle h,
 	if (clixon_stats_datastore_get(h, "startup", cbret) < 0)
 	    goto done;
     cprintf(cbret, "</datastores>");
+    if (commit_stats_get(h, cbret) < 0)
+        goto done;
+    if (rpc_stats_get(h, cbret) < 0)
+        goto done;
+    if (sched_stats_get(h, cbret) < 0)
+        goto done;
+    if (clixon_plugin_statedata_stats(h, cbret) < 0)
+        goto done;
+    if (clixon_plugin_stats_get(h, cbret) < 0)
+        goto done;
+    if (memory_stats_get(h, cbret) < 0)
+        goto done;
     /* per module-set, first configuration, then main dbspec, then mountpoints */
     cprintf(cbret, "<module-sets xmlns=\"%s\">", CLIXON_LIB_NS);
     cprintf(cbret, "<module-set><name>clixon-config</name>");
@@ -1464,86 +3404,536 @@ from_client_restart_plugin(clicon_handle h,
     return retval;
 }
 
-/*! Control a specific process or daemon: start/stop, etc
+/*! Promote a standby backend to active, see CLICON_BACKEND_STANDBY
+ *
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+from_client_standby_promote(clicon_handle h,
+                            cxobj        *xe,
+                            cbuf         *cbret,
+                            void         *arg,
+                            void         *regarg)
+{
+    int retval = -1;
+    int ret;
+
+    if ((ret = backend_standby_promote(h, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok; /* cbret set */
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Control a specific process or daemon: start/stop, etc
+ *
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+from_client_process_control(clicon_handle  h,
+                            cxobj         *xe,
+                            cbuf          *cbret,
+                            void          *arg,
+                            void          *regarg)
+{
+    int      retval = -1;
+    cxobj   *x;
+    char    *name = NULL;
+    char    *opstr = NULL;
+    proc_operation op = PROC_OP_NONE;
+    
+    if ((x = xml_find_type(xe, NULL, "name", CX_ELMNT)) != NULL)
+        name = xml_body(x);
+    if ((x = xml_find_type(xe, NULL, "operation", CX_ELMNT)) != NULL){
+        opstr = xml_body(x);
+        op = clixon_process_op_str2int(opstr);
+    }
+    /* Make the actual process operation (with wrap function enabled) */
+    if (op == PROC_OP_STATUS){
+        if (clixon_process_status(h, name, cbret) < 0)
+            goto done;
+    }
+    else{
+        if (clixon_process_operation(h, name, op, 1) < 0)
+            goto done;
+        cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok xmlns=\"%s\"/></rpc-reply>",
+                NETCONF_BASE_NAMESPACE, CLIXON_LIB_NS);
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Clixon hello to check liveness
+ *
+ * The client may request binary replies with the encoding attribute. It is accepted if
+ * CLICON_PROTO_BINARY is set, and then the attribute is echoed in the reply.
+ * Likewise streamed get replies with the stream attribute, if CLICON_PROTO_STREAM_CHUNK is set.
+ * @param[in]  h       Clixon handle
+ * @param[in]  x       Incoming XML of hello request
+ * @param[in]  ce      Client entry (from)
+ * @param[out] cbret   Hello reply
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+from_client_hello(clicon_handle       h,
+                  cxobj               *x,
+                  struct client_entry *ce,
+                  cbuf                *cbret)
+{
+    int      retval = -1;
+    char    *val;
+    int      chunk;
+
+    if ((val = xml_find_type_value(x, "cl", "transport", CX_ATTR)) != NULL){
+        if ((ce->ce_transport = strdup(val)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    }
+    if ((val = xml_find_type_value(x, "cl", "source-host", CX_ATTR)) != NULL){
+        if ((ce->ce_source_host = strdup(val)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    }
+    if ((val = xml_find_type_value(x, "cl", "encoding", CX_ATTR)) != NULL &&
+        strcmp(val, "binary") == 0 &&
+        clicon_option_bool(h, "CLICON_PROTO_BINARY"))
+        ce->ce_binary = 1;
+    if ((val = xml_find_type_value(x, "cl", "stream", CX_ATTR)) != NULL &&
+        strcmp(val, "true") == 0 &&
+        (chunk = clicon_option_int(h, "CLICON_PROTO_STREAM_CHUNK")) > 0)
+        ce->ce_stream_chunk = chunk;
+    cprintf(cbret, "<hello xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    if (ce->ce_binary || ce->ce_stream_chunk)
+        cprintf(cbret, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    if (ce->ce_binary)
+        cprintf(cbret, " %s:encoding=\"binary\"", CLIXON_LIB_PREFIX);
+    if (ce->ce_stream_chunk)
+        cprintf(cbret, " %s:stream=\"true\"", CLIXON_LIB_PREFIX);
+    cprintf(cbret, "><session-id>%u</session-id></hello>", ce->ce_id);
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Send a reply to a client
+ *
+ * The reply is queued if the client does not read it, see client_output
+ * @param[in]  ce     Client entry
+ * @param[in]  cbret  Reply
+ * @retval     0      OK, or client has closed
+ * @retval    -1      Error
+ */
+static int
+client_reply_send(struct client_entry *ce,
+                  cbuf                *cbret)
+{
+    int                retval = -1;
+    cbuf              *cbce = NULL;
+
+    if (ce_client_string(ce, &cbce) < 0)
+        goto done;
+    if (client_output(ce, cbuf_get(cbce), 0, cbuf_get(cbret), cbuf_len(cbret)+1) < 0){
+        switch (errno){
+        case EPIPE:
+            /* man (2) write: 
+             * EPIPE  fd is connected to a pipe or socket whose reading end is 
+             * closed.  When this happens the writing process will also receive 
+             * a SIGPIPE signal. 
+             * In Clixon this means a client, eg restconf, netconf or cli closes
+             * the (UNIX domain) socket.
+             */
+        case ECONNRESET:
+            clicon_log(LOG_WARNING, "client rpc reset");
+            break;
+        default:
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (cbce)
+        clixon_cbuf_put(cbce);
+    return retval;
+}
+
+/*! Defer a reply until the datastore write of the request is durable
+ *
+ * ce_reply_seq is set by an RPC handler, eg commit, if CLICON_XMLDB_ASYNC is
+ * reply-after-durable.
+ * The client socket is not read while a reply is deferred, so that replies to pipelined
+ * requests are sent in order. If a reply of the client is already deferred, eg of
+ * pipelined edits committed in one autocommit group, wait until it is durable and send it.
+ * @param[in]  h      Clixon handle
+ * @param[in]  ce     Client entry
+ * @param[in]  cbret  Reply, taken over by ce if deferred
+ * @retval     1      Deferred, sent later by backend_async_reply
+ * @retval     0      Already durable, or write failed and cbret replaced by error: send now
+ * @retval    -1      Error
+ */
+static int
+client_reply_defer(clicon_handle        h,
+                   struct client_entry *ce,
+                   cbuf                *cbret)
+{
+    uint64_t durable = 0;
+    int      ret;
+
+    if (ce->ce_reply != NULL){
+        if (xmldb_async_barrier(h, NULL) < 0){
+            cbuf_reset(ce->ce_reply);
+            if (netconf_operation_failed(ce->ce_reply, "application", clicon_err_reason) < 0)
+                return -1;
+            cbuf_reset(cbret);
+            if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+                return -1;
+        }
+        ret = client_reply_send(ce, ce->ce_reply);
+        cbuf_free(ce->ce_reply);
+        ce->ce_reply = NULL;
+        ce->ce_reply_seq = 0;
+        if (ret < 0 ||
+            clixon_event_reg_fd(ce->ce_s, from_client, (void*)ce, "local netconf client socket") < 0)
+            return -1;
+        return 0;
+    }
+    if (xmldb_async_poll(h, &durable) < 0){
+        ce->ce_reply_seq = 0;
+        cbuf_reset(cbret);
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            return -1;
+        return 0;
+    }
+    if (ce->ce_reply_seq <= durable){
+        ce->ce_reply_seq = 0;
+        return 0;
+    }
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s defer reply until write %" PRIu64 " is durable",
+                 __FUNCTION__, ce->ce_reply_seq);
+    ce->ce_reply = cbret;
+    clixon_event_unreg_fd(ce->ce_s, from_client);
+    return 1;
+}
+
+/*! Asynchronous datastore writes are done, send deferred replies
+ *
+ * @param[in]  fd    Completion socket of datastore writer, see xmldb_async_fd
+ * @param[in]  arg   Clixon handle
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see client_reply_defer
+ */
+int
+backend_async_reply(int   fd,
+                    void *arg)
+{
+    int                  retval = -1;
+    clicon_handle        h = (clicon_handle)arg;
+    struct client_entry *ce;
+    uint64_t             durable = 0;
+    int                  failed = 0;
+
+    if (xmldb_async_poll(h, &durable) < 0){
+        clicon_log(LOG_WARNING, "%s: %s", __FUNCTION__, clicon_err_reason);
+        failed++;
+    }
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next){
+        if (ce->ce_reply == NULL || ce->ce_reply_seq > durable)
+            continue;
+        if (failed){
+            cbuf_reset(ce->ce_reply);
+            if (netconf_operation_failed(ce->ce_reply, "application", clicon_err_reason) < 0)
+                goto done;
+        }
+        if (client_reply_send(ce, ce->ce_reply) < 0)
+            goto done;
+        cbuf_free(ce->ce_reply);
+        ce->ce_reply = NULL;
+        ce->ce_reply_seq = 0;
+        if (clixon_event_reg_fd(ce->ce_s, from_client, (void*)ce, "local netconf client socket") < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Streamed get reply, see CLICON_PROTO_STREAM_CHUNK
+ *
+ * The top-level subtrees of the reply tree are serialized a few at a time into fragments
+ * of at most about ce_stream_chunk bytes. One fragment is written per event loop
+ * iteration, so that the backend serves other clients in between and the full text of
+ * the reply is never in memory. If the client does not read a fragment, the next is
+ * serialized when the output queue of the client is written, see client_output_write.
+ * The client socket is not read, and notifications to the client are queued, until the
+ * last fragment is sent.
+ */
+struct reply_stream {
+    cxobj *rs_xt;     /* Reply <data> tree */
+    cxobj *rs_x;      /* Last serialized child of rs_xt, or NULL */
+    int    rs_start;  /* Start of reply is sent */
+    cbuf  *rs_cb;     /* Fragment buffer */
+    cxobj *rs_notify; /* Queued notifications as children */
+};
+
+/*! Hand over a get reply tree to be streamed to a client
+ *
+ * The reply is streamed by from_client_msg when the RPC is done.
+ * @param[in]  ce   Client entry, streamed replies negotiated
+ * @param[in]  xt   Reply <data> tree, freed when the reply is sent
+ * @retval     0    OK
+ * @retval    -1    Error, xt is not taken over
+ */
+int
+backend_client_stream(struct client_entry *ce,
+                      cxobj               *xt)
+{
+    struct reply_stream *rs;
+
+    if ((rs = malloc(sizeof(*rs))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memset(rs, 0, sizeof(*rs));
+    if ((rs->rs_cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        free(rs);
+        return -1;
+    }
+    rs->rs_xt = xt;
+    ce->ce_stream = rs;
+    return 0;
+}
+
+/*! Queue a notification to a client while a streamed reply is sent
+ *
+ * @param[in]  ce     Client entry with streamed reply
+ * @param[in]  event  Notification, copied
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+client_stream_notify(struct client_entry *ce,
+                     cxobj               *event)
+{
+    struct reply_stream *rs = ce->ce_stream;
+    cxobj               *x;
+
+    if (rs->rs_notify == NULL &&
+        (rs->rs_notify = xml_new("notifications", NULL, CX_ELMNT)) == NULL)
+        return -1;
+    if ((x = xml_dup(event)) == NULL)
+        return -1;
+    if (xml_addsub(rs->rs_notify, x) < 0){
+        xml_free(x);
+        return -1;
+    }
+    return 0;
+}
+
+/*! Free streamed reply of a client
  *
- * @param[in]  h       Clixon handle 
- * @param[in]  xe      Request: <rpc><xn></rpc> 
- * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
- * @param[in]  arg     client-entry
- * @param[in]  regarg  User argument given at rpc_callback_register() 
- * @retval     0       OK
- * @retval    -1       Error
+ * @param[in]  ce  Client entry
+ */
+static void
+client_stream_free(struct client_entry *ce)
+{
+    struct reply_stream *rs;
+
+    if ((rs = ce->ce_stream) == NULL)
+        return;
+    clixon_event_unreg_timeout(client_stream_next, ce);
+    if (rs->rs_xt)
+        xml_free(rs->rs_xt);
+    if (rs->rs_notify)
+        xml_free(rs->rs_notify);
+    if (rs->rs_cb)
+        cbuf_free(rs->rs_cb);
+    free(rs);
+    ce->ce_stream = NULL;
+}
+
+/*! Send next fragment of a streamed reply
+ *
+ * @param[in]  ce    Client entry with streamed reply
+ * @param[out] last  Set if the last fragment was sent
+ * @retval     0     OK
+ * @retval    -1     Error
  */
 static int
-from_client_process_control(clicon_handle  h,
-                            cxobj         *xe,
-                            cbuf          *cbret,
-                            void          *arg,
-                            void          *regarg)
+client_stream_send(struct client_entry *ce,
+                   int                 *last)
 {
-    int      retval = -1;
-    cxobj   *x;
-    char    *name = NULL;
-    char    *opstr = NULL;
-    proc_operation op = PROC_OP_NONE;
-    
-    if ((x = xml_find_type(xe, NULL, "name", CX_ELMNT)) != NULL)
-        name = xml_body(x);
-    if ((x = xml_find_type(xe, NULL, "operation", CX_ELMNT)) != NULL){
-        opstr = xml_body(x);
-        op = clixon_process_op_str2int(opstr);
-    }
-    /* Make the actual process operation (with wrap function enabled) */
-    if (op == PROC_OP_STATUS){
-        if (clixon_process_status(h, name, cbret) < 0)
-            goto done;
+    int                  retval = -1;
+    struct reply_stream *rs = ce->ce_stream;
+    cbuf                *cb = rs->rs_cb;
+    cxobj               *x = NULL;
+    cbuf                *cbce = NULL;
+
+    cbuf_reset(cb);
+    if (!rs->rs_start){
+        cprintf(cb, "<rpc-reply xmlns=\"%s\"><%s", NETCONF_BASE_NAMESPACE, NETCONF_OUTPUT_DATA);
+        while ((x = xml_child_each(rs->rs_xt, x, CX_ATTR)) != NULL){
+            cprintf(cb, " ");
+            if (xml_prefix(x))
+                cprintf(cb, "%s:", xml_prefix(x));
+            cprintf(cb, "%s=\"%s\"", xml_name(x), xml_value(x));
+        }
+        cprintf(cb, ">");
+        rs->rs_start = 1;
     }
-    else{
-        if (clixon_process_operation(h, name, op, 1) < 0)
+    while (cbuf_len(cb) < ce->ce_stream_chunk &&
+           (x = xml_child_each(rs->rs_xt, rs->rs_x, CX_ELMNT)) != NULL){
+        if (clixon_xml2cbuf(cb, x, 0, 0, NULL, -1, 0) < 0)
             goto done;
-        cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok xmlns=\"%s\"/></rpc-reply>",
-                NETCONF_BASE_NAMESPACE, CLIXON_LIB_NS);
+        rs->rs_x = x;
     }
+    *last = (cbuf_len(cb) < ce->ce_stream_chunk);
+    if (*last)
+        cprintf(cb, "</%s></rpc-reply>", NETCONF_OUTPUT_DATA);
+    if (ce_client_string(ce, &cbce) < 0)
+        goto done;
+    if (client_output(ce, cbuf_get(cbce), *last?0:CLICON_MSG_ID_MORE, cbuf_get(cb),
+                      cbuf_len(cb) + (*last?1:0)) < 0)
+        goto done;
+    if (ce->ce_out_closed) /* Client has closed */
+        *last = 1;
     retval = 0;
  done:
+    if (cbce)
+        clixon_cbuf_put(cbce);
     return retval;
 }
 
-/*! Clixon hello to check liveness
+/*! Streamed reply is sent, send queued notifications and read the client socket again
  *
  * @param[in]  h       Clixon handle
- * @param[in]  x       Incoming XML of hello request
- * @param[in]  ce      Client entry (from)
- * @param[out] cbret   Hello reply
+ * @param[in]  ce      Client entry with streamed reply
+ * @param[in]  resume  Register client socket in event loop again
  * @retval     0       OK
  * @retval    -1       Error
  */
 static int
-from_client_hello(clicon_handle       h,
-                  cxobj               *x,
-                  struct client_entry *ce,
-                  cbuf                *cbret)
+client_stream_done(clicon_handle        h,
+                   struct client_entry *ce,
+                   int                  resume)
 {
-    int      retval = -1;
-    char    *val;
+    struct reply_stream *rs = ce->ce_stream;
+    cxobj               *xn;
+    cxobj               *x;
 
-    if ((val = xml_find_type_value(x, "cl", "transport", CX_ATTR)) != NULL){
-        if ((ce->ce_transport = strdup(val)) == NULL){
-            clicon_err(OE_UNIX, errno, "strdup");
-            goto done;
-        }
+    xn = rs->rs_notify;
+    rs->rs_notify = NULL;
+    client_stream_free(ce);
+    if (xn != NULL){
+        x = NULL;
+        while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL)
+            ce_event_cb(h, 0, x, ce);
+        xml_free(xn);
     }
-    if ((val = xml_find_type_value(x, "cl", "source-host", CX_ATTR)) != NULL){
-        if ((ce->ce_source_host = strdup(val)) == NULL){
-            clicon_err(OE_UNIX, errno, "strdup");
-            goto done;
-        }
+    if (!resume)
+        return 0;
+    return clixon_event_reg_fd(ce->ce_s, from_client, (void*)ce, "local netconf client socket");
+}
+
+/*! Event loop timeout: send next fragment of a streamed reply
+ *
+ * @param[in]  fd   No-op
+ * @param[in]  arg  Client entry
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+client_stream_next(int   fd,
+                   void *arg)
+{
+    struct client_entry *ce = (struct client_entry *)arg;
+    struct timeval       t;
+    int                  last = 0;
+
+    if (client_stream_send(ce, &last) < 0)
+        return -1;
+    if (last)
+        return client_stream_done(ce->ce_handle, ce, 1);
+    if (client_output_queued(ce) > 0) /* Resumed by client_output_write */
+        return 0;
+    gettimeofday(&t, NULL);
+    return clixon_event_reg_timeout(t, client_stream_next, ce, "streamed reply");
+}
+
+/*! Start sending a streamed reply handed over by backend_client_stream
+ *
+ * The first fragment is sent now, the rest from the event loop. In a read worker process
+ * or commit reader, all fragments are sent now.
+ * @param[in]  h   Clixon handle
+ * @param[in]  ce  Client entry with streamed reply
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+client_stream_start(clicon_handle        h,
+                    struct client_entry *ce)
+{
+    struct timeval t;
+    int            last = 0;
+
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s ce_id:%u", __FUNCTION__, ce->ce_id);
+    do {
+        if (client_stream_send(ce, &last) < 0)
+            return -1;
+    } while (!last && (_read_worker_fd != -1 || _commit_reader));
+    if (last) /* Client socket is still registered, or worker exits after reply */
+        return client_stream_done(h, ce, 0);
+    clixon_event_unreg_fd(ce->ce_s, from_client);
+    if (client_output_queued(ce) > 0) /* Resumed by client_output_write */
+        return 0;
+    gettimeofday(&t, NULL);
+    return clixon_event_reg_timeout(t, client_stream_next, ce, "streamed reply");
+}
+
+/*! Compact datastore caches if the number of XML objects has dropped sharply
+ *
+ * Keep a high-water mark of existing XML objects, and compact when it has dropped by
+ * XMLDB_COMPACT_NODES, eg after a large delete has been committed.
+ * @param[in]   h    Clixon handle
+ * @retval      0    OK
+ * @retval     -1    Error
+ * @see XMLDB_COMPACT_NODES
+ */
+static int
+backend_compact_check(clicon_handle h)
+{
+    static uint64_t mark = 0;
+    uint64_t        nr = 0;
+
+    xml_stats_global(&nr);
+    if (nr > mark)
+        mark = nr;
+    else if (nr + XMLDB_COMPACT_NODES < mark){
+        if (xmldb_cache_compact(h, NULL) < 0)
+            return -1;
+        mark = nr;
     }
-    cprintf(cbret, "<hello xmlns=\"%s\"><session-id>%u</session-id></hello>",
-            NETCONF_BASE_NAMESPACE, ce->ce_id);
-    retval = 0;
- done:
-    return retval;
+    return 0;
 }
 
 /*! An internal clixon NETCONF message has arrived from a local client. Receive and dispatch.
@@ -1580,14 +3970,26 @@ from_client_msg(clicon_handle        h,
     char                *rpcprefix;
     char                *namespace = NULL;
     int                  nr = 0;
-    cbuf                *cbce = NULL;
+    yang_stmt           *yrpc = NULL; /* Last RPC of message, for statistics */
+    struct timespec      tready;
+    struct timespec      t0;
+    size_t               replylen = 0;
+    enum sched_class     sc = SC_BULK;
+    int                  section = 0;
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    CLIXON_PROBE2(backend_msg_start, ce->ce_id, ntohl(msg->op_len));
+    clixon_event_wakeup(&tready);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    /* Interactive requests of other clients are handled at safe points of this request,
+     * not in worker processes. See CLICON_BACKEND_YIELD_INTERVAL */
+    if (_read_worker_fd == -1 && !_commit_reader)
+        section = clixon_event_yield_begin();
     yspec = clicon_dbspec_yang(h); 
     /* Return netconf message. Should be filled in by the dispatch(sub) functions 
      * as wither rpc-error or by positive response.
      */
-    if ((cbret = cbuf_new()) == NULL){
+    if ((cbret = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1643,20 +4045,21 @@ from_client_msg(clicon_handle        h,
     }
     else if (strcmp(namespace, NETCONF_BASE_NAMESPACE) != 0){
         cbuf *cbmsg = NULL;
-        if ((cbmsg = cbuf_new()) == NULL){
+        if ((cbmsg = clixon_cbuf_get()) == NULL){
             clicon_err(OE_UNIX, errno, "cbuf_new");
             goto done;
         }
         cprintf(cbmsg, "No appropriate namespace found for: %s %s", rpcprefix, rpcname);
         if (netconf_unknown_namespace(cbret, "protocol", namespace, cbuf_get(cbmsg)) < 0)
             goto done;
-        cbuf_free(cbmsg);
+        clixon_cbuf_put(cbmsg);
         goto reply;
     }
 
     if (strcmp(rpcname, "rpc") == 0){
     }
     else if (strcmp(rpcname, "hello") == 0){
+        sc = SC_INTERACTIVE;
         if ((ret = from_client_hello(h, x, ce, cbret)) <0)
             goto done;
         goto reply;
@@ -1707,8 +4110,14 @@ from_client_msg(clicon_handle        h,
             goto done;
         }
         module = yang_argument_get(ymod);
+        yrpc = ye;
+        if (strcmp(module, "clixon-lib") == 0 && strcmp(rpc, "ping") == 0)
+            sc = SC_INTERACTIVE;
+        else
+            sc = SC_BULK;
         clicon_debug(CLIXON_DBG_DEFAULT, "%s module:%s rpc:%s ce_id:%u s:%d", __FUNCTION__, module,
                      rpc, ce->ce_id, ce->ce_s);
+        CLIXON_PROBE2(backend_rpc, ce->ce_id, rpc);
         /* Pre-NACM access step */
         xnacm = NULL;
 
@@ -1742,6 +4151,20 @@ from_client_msg(clicon_handle        h,
             }
         }
         clicon_err_reset();
+        /* Pending autocommit edits are committed before any other operation */
+        if (strcmp(rpc, "edit-config") != 0 && autocommit_group_commit(h) < 0)
+            goto done;
+        /* Candidate of session, see CLICON_XMLDB_PRIVATE_CANDIDATE */
+        if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE") &&
+            strcmp(module, "ietf-netconf") == 0 &&
+            backend_private_rpc(h, ce->ce_id, xe) < 0)
+            goto done;
+        if (read_worker_rpc(module, rpc)){
+            if ((ret = read_worker_start(h, ce)) < 0)
+                goto done;
+            if (ret == 1) /* Sent by worker process */
+                goto ok;
+        }
         if ((ret = rpc_callback_call(h, xe, ce, &nr, cbret)) < 0){
             if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
                 goto done;
@@ -1770,35 +4193,55 @@ from_client_msg(clicon_handle        h,
         }
     } /* while */
  reply:
+    if (ce->ce_stream != NULL){ /* Streamed get reply */
+        if (cbuf_len(cbret) == 0){
+            if (client_stream_start(h, ce) < 0)
+                goto done;
+            goto ok;
+        }
+        client_stream_free(ce);
+    }
     if (cbuf_len(cbret) == 0)
         if (netconf_operation_failed(cbret, "application", clicon_errno?clicon_err_reason:"unknown")< 0)
             goto done;
+    replylen = cbuf_len(cbret);
     // XXX    clicon_debug(CLIXON_DBG_MSG, "Reply:%s", cbuf_get(cbret));
     /* XXX problem here is that cbret has not been parsed so may contain 
        parse errors */
-    if (ce_client_string(ce, &cbce) < 0)
-        goto done;
-    if (send_msg_reply(ce->ce_s, cbuf_get(cbce), cbuf_get(cbret), cbuf_len(cbret)+1) < 0){
-        switch (errno){
-        case EPIPE:
-            /* man (2) write: 
-             * EPIPE  fd is connected to a pipe or socket whose reading end is 
-             * closed.  When this happens the writing process will also receive 
-             * a SIGPIPE signal. 
-             * In Clixon this means a client, eg restconf, netconf or cli closes
-             * the (UNIX domain) socket.
-             */
-        case ECONNRESET:
-            clicon_log(LOG_WARNING, "client rpc reset");
-            break;
-        default:
+    if (autocommit_group_reply(ce, cbret) == 1){ /* Sent by autocommit_group_commit */
+        cbret = NULL;
+        goto ok;
+    }
+    if (ce->ce_reply_seq){
+        if ((ret = client_reply_defer(h, ce, cbret)) < 0)
             goto done;
+        if (ret == 1){ /* Sent later by backend_async_reply */
+            cbret = NULL;
+            goto ok;
         }
     }
-    // ok:
+    if (client_reply_send(ce, cbret) < 0)
+        goto done;
+ ok:
+    if (yrpc && _read_worker_fd == -1 &&
+        rpc_stats_add(h, yrpc, &tready, &t0, ntohl(msg->op_len), replylen) < 0)
+        goto done;
+    if (_read_worker_fd == -1 &&
+        sched_stats_add(h, sc, &tready, &t0, 0) < 0)
+        goto done;
+    /* No datastore trees are in use between RPCs, see CLICON_DATASTORE_CACHE_BUDGET */
+    if (xmldb_cache_evict(h) < 0)
+        goto done;
+    if (backend_compact_check(h) < 0)
+        goto done;
+    /* Free pooled objects beyond what the requests since the last trim needed */
+    clixon_pool_trim();
     retval = 0;
   done:  
+    if (section)
+        clixon_event_yield_end();
     clicon_debug(CLIXON_DBG_DETAIL, "%s retval:%d", __FUNCTION__, retval);
+    CLIXON_PROBE3(backend_msg_done, ce->ce_id, rpc?rpc:"", retval);
     if (xnacm){
         xml_free(xnacm);
         if (clicon_nacm_cache_set(h, NULL) < 0)
@@ -1808,15 +4251,15 @@ from_client_msg(clicon_handle        h,
         xml_free(xret);
     if (xt)
         xml_free(xt);
-    if (cbce)
-        cbuf_free(cbce);
     if (cbret)
-        cbuf_free(cbret);
+        clixon_cbuf_put(cbret);
     /* Sanity: log if clicon_err() is not called ! */
     if (retval < 0 && clicon_errno < 0) 
         clicon_log(LOG_NOTICE, "%s: Internal error: No clicon_err call on RPC error (message: %s)",
                    __FUNCTION__, rpc?rpc:"");
     //    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (_read_worker_fd != -1)
+        read_worker_exit(retval == 0);
     return retval;// -1 here terminates backend
 }
 
@@ -1838,12 +4281,21 @@ from_client(int   s,
     clicon_handle        h = ce->ce_handle;
     int                  eof = 0;
     cbuf                *cbce = NULL;
+    uint32_t             hwm;
+    int                  ret;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
     if (s != ce->ce_s){
         clicon_err(OE_NETCONF, EINVAL, "Internal error: s != ce->ce_s");
         goto done;
     }
+    hwm = clicon_option_int(h, "CLICON_BACKEND_OUTPUT_HWM");
+    if (hwm && client_output_queued(ce) > hwm){
+        /* Read requests when the output queue is written, see client_output_write */
+        clixon_event_unreg_fd(ce->ce_s, from_client);
+        ce->ce_out_paused = 1;
+        goto ok;
+    }
     if (ce_client_string(ce, &cbce) < 0)
         goto done;
     if (clicon_msg_rcv(ce->ce_s, cbuf_get(cbce), 0, &msg, &eof) < 0)
@@ -1852,19 +4304,200 @@ from_client(int   s,
         backend_client_rm(h, ce); 
         netconf_monitoring_counter_inc(h, "dropped-sessions");
     }
-    else
-        if (from_client_msg(h, ce, msg) < 0)
+    else{
+        _client_current = ce;
+        ret = from_client_msg(h, ce, msg);
+        _client_current = NULL;
+        if (ret < 0)
             goto done;
+    }
+ ok:
     retval = 0;
   done:
     clicon_debug(CLIXON_DBG_DETAIL, "%s retval=%d", __FUNCTION__, retval);
     if (cbce)
-        cbuf_free(cbce);
+        clixon_cbuf_put(cbce);
     if (msg)
         free(msg);
     return retval; /* -1 here terminates backend */
 }
 
+/*! Check if the next message on a client socket is interactive, without reading it
+ *
+ * Interactive messages are hello, and ping without parameters if NACM is disabled, since
+ * they do not need the datastores
+ * @param[in]  h    Clixon handle
+ * @param[in]  s    Client socket
+ * @retval     1    Yes
+ * @retval     0    No, or not yet received, or eof
+ * @see client_msg_peek
+ */
+static int
+client_msg_interactive(clicon_handle h,
+                       int           s)
+{
+    int    retval = 0;
+    cxobj *xt = NULL;
+    cxobj *xrpc;
+    cxobj *xe;
+    char  *ns = NULL;
+    char  *mode;
+
+    if (client_msg_peek(s, &xt) == 0)
+        goto done;
+    if (xml_child_nr_type(xt, CX_ELMNT) != 1 ||
+        (xrpc = xml_child_i_type(xt, 0, CX_ELMNT)) == NULL)
+        goto done;
+    if (xml2ns(xrpc, xml_prefix(xrpc), &ns) < 0){
+        clicon_err_reset();
+        goto done;
+    }
+    if (ns == NULL || strcmp(ns, NETCONF_BASE_NAMESPACE) != 0)
+        goto done;
+    if (strcmp(xml_name(xrpc), "hello") == 0){
+        retval = 1;
+        goto done;
+    }
+    mode = clicon_option_str(h, "CLICON_NACM_MODE");
+    if (strcmp(xml_name(xrpc), "rpc") != 0 ||
+        (mode != NULL && strcmp(mode, "disabled") != 0) ||
+        xml_child_nr_type(xrpc, CX_ELMNT) != 1 ||
+        (xe = xml_child_i_type(xrpc, 0, CX_ELMNT)) == NULL ||
+        strcmp(xml_name(xe), "ping") != 0 ||
+        xml_child_nr_type(xe, CX_ELMNT) != 0)
+        goto done;
+    ns = NULL;
+    if (xml2ns(xe, xml_prefix(xe), &ns) < 0){
+        clicon_err_reset();
+        goto done;
+    }
+    if (ns != NULL && strcmp(ns, CLIXON_LIB_NS) == 0)
+        retval = 1;
+ done:
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Handle an interactive request at a safe point of a long RPC of another client
+ *
+ * Called instead of from_client at safe points, see CLICON_BACKEND_YIELD_INTERVAL.
+ * Only interactive messages of clients that the commit reader could serve are read, ie
+ * not of the client of the preempted RPC or of clients with pending replies or
+ * subscriptions. They are handled without datastores, NACM or plugin callbacks, so that
+ * the preempted RPC is not affected. Other messages are left for the event loop.
+ * @param[in]   s    Socket where message arrived
+ * @param[in]   arg  Client entry
+ * @retval      0    OK, also if the message is left for the event loop
+ * @retval     -1    Error
+ * @see client_msg_interactive
+ */
+static int
+from_client_yield(int   s,
+                  void *arg)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    clicon_handle        h = ce->ce_handle;
+    struct clicon_msg   *msg = NULL;
+    cbuf                *cbce = NULL;
+    cbuf                *cbret = NULL;
+    cxobj               *xt = NULL;
+    cxobj               *xret = NULL;
+    cxobj               *x;
+    cxobj               *xe;
+    uint32_t             op_id;
+    struct timespec      t0;
+    struct timespec      tready = {0,};
+    int                  eof = 0;
+    int                  ret;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    /* During a commit, get and get-config of other clients are served by the commit reader,
+     * which reads client sockets as well */
+    if (_commit_reader_fd != -1 ||
+        !commit_reader_client(h, ce) ||
+        client_msg_interactive(h, s) == 0)
+        goto ok;
+    if (ce_client_string(ce, &cbce) < 0)
+        goto done;
+    if (clicon_msg_rcv(s, cbuf_get(cbce), 0, &msg, &eof) < 0)
+        goto done;
+    if (eof) /* Removed by the event loop */
+        goto ok;
+    if ((cbret = clixon_cbuf_get()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s ce_id:%u", __FUNCTION__, ce->ce_id);
+    if ((ret = clicon_msg_decode(msg, clicon_dbspec_yang(h), &op_id, &xt, &xret)) < 0){
+        if (netconf_malformed_message(cbret, "XML parse error") < 0)
+            goto done;
+    }
+    else if (ret == 0){
+        if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+    }
+    else if ((x = xml_child_i_type(xt, 0, CX_ELMNT)) == NULL){ /* Shouldnt happen */
+        clicon_err(OE_XML, EFAULT, "No xml req (shouldnt happen)");
+        goto done;
+    }
+    else if (strcmp(xml_name(x), "hello") == 0){
+        if (from_client_hello(h, x, ce, cbret) < 0)
+            goto done;
+    }
+    else if ((xe = xml_child_i_type(x, 0, CX_ELMNT)) != NULL){ /* ping */
+        ce->ce_in_rpcs++;
+        netconf_monitoring_counter_inc(h, "in-rpcs");
+        if (from_client_ping(h, xe, cbret, ce, NULL) < 0)
+            goto done;
+        if (xml_spec(xe) &&
+            rpc_stats_add(h, xml_spec(xe), &tready, &t0, ntohl(msg->op_len), cbuf_len(cbret)) < 0)
+            goto done;
+    }
+    if (client_reply_send(ce, cbret) < 0)
+        goto done;
+    if (sched_stats_add(h, SC_INTERACTIVE, &tready, &t0, 1) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (xret)
+        xml_free(xret);
+    if (xt)
+        xml_free(xt);
+    if (cbret)
+        clixon_cbuf_put(cbret);
+    if (cbce)
+        clixon_cbuf_put(cbce);
+    if (msg)
+        free(msg);
+    return retval;
+}
+
+/*! Init handling of interactive requests at safe points of long RPCs
+ *
+ * New clients are accepted and interactive requests of other clients are handled at
+ * safe points, see CLICON_BACKEND_YIELD_INTERVAL
+ * @param[in]  h     Clixon handle
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see from_client_yield
+ */
+int
+backend_client_yield_init(clicon_handle h)
+{
+    uint32_t ms;
+
+    if ((ms = clicon_option_int(h, "CLICON_BACKEND_YIELD_INTERVAL")) == 0)
+        return 0;
+    clixon_event_yield_interval((uint64_t)ms*1000);
+    if (clixon_event_yield_reg(from_client, from_client_yield) < 0 ||
+        clixon_event_yield_reg(backend_accept_client, backend_accept_client) < 0)
+        return -1;
+    return 0;
+}
+
 /*! Init backend rpc: Set up standard netconf rpc callbacks
  *
  * @param[in]  h     Clixon handle
@@ -1938,6 +4571,24 @@ backend_rpc_init(clicon_handle h)
     if (rpc_callback_register(h, from_client_ping, NULL,
                               CLIXON_LIB_NS, "ping") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_datastore_sync, NULL,
+                              CLIXON_LIB_NS, "datastore-sync") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_compact, NULL,
+                              CLIXON_LIB_NS, "compact") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_datastore_version, NULL,
+                              CLIXON_LIB_NS, "datastore-version") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_datastore_values, NULL,
+                              CLIXON_LIB_NS, "datastore-values") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_datastore_diff, NULL,
+                              CLIXON_LIB_NS, "datastore-diff") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_datastore_push, NULL,
+                              CLIXON_LIB_NS, "datastore-push") < 0)
+        goto done;
     if (rpc_callback_register(h, from_client_stats, NULL,
                               CLIXON_LIB_NS, "stats") < 0)
         goto done;
@@ -1947,6 +4598,16 @@ backend_rpc_init(clicon_handle h)
     if (rpc_callback_register(h, from_client_process_control, NULL,
                               CLIXON_LIB_NS, "process-control") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_standby_promote, NULL,
+                              CLIXON_LIB_NS, "standby-promote") < 0)
+        goto done;
+    /* In backend_job.c */
+    if (rpc_callback_register(h, from_client_commit_async, NULL,
+                              CLIXON_LIB_NS, "commit-async") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_commit_job_status, NULL,
+                              CLIXON_LIB_NS, "commit-job-status") < 0)
+        goto done;
     retval =0;
  done:
     return retval;
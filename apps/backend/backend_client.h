@@ -43,6 +43,12 @@
 int backend_monitoring_state_get(clicon_handle h, yang_stmt *yspec, char *xpath, cvec *nsc, cxobj **xret, cxobj **xerr);
 int backend_client_rm(clicon_handle h, struct client_entry *ce);
 int from_client(int fd, void *arg);
+int backend_async_reply(int fd, void *arg);
+int backend_client_stream(struct client_entry *ce, cxobj *xt);
+int backend_commit_reader_start(clicon_handle h);
+int backend_commit_reader_stop(clicon_handle h);
 int backend_rpc_init(clicon_handle h);
+int backend_client_yield_init(clicon_handle h);
+int backend_schema_cache_free(void);
 
 #endif  /* _BACKEND_CLIENT_H_ */
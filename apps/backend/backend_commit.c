@@ -42,6 +42,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <unistd.h>
 #include <stdarg.h>
 #include <errno.h>
@@ -71,6 +73,10 @@
 #include "backend_handle.h"
 #include "clixon_backend_commit.h"
 #include "backend_client.h"
+#include "backend_stats.h"
+#include "backend_push.h"
+#include "backend_private.h"
+#include "backend_job.h"
 
 /*! Key values are checked for validity independent of user-defined callbacks
  *
@@ -101,8 +107,16 @@ generic_validate(clicon_handle       h,
     int        ret;
     cbuf      *cb = NULL;
 
-    /* All entries */
-    if ((ret = xml_yang_validate_all_top(h, td->td_target, xret)) < 0) 
+    /* All entries, or only changed entries and entries depending on them */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL"))
+        ret = xml_yang_validate_changes(h, td->td_target,
+                                        td->td_dvec, td->td_dlen,
+                                        td->td_avec, td->td_alen,
+                                        td->td_tcvec, td->td_clen,
+                                        xret);
+    else
+        ret = xml_yang_validate_all_top(h, td->td_target, xret);
+    if (ret < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -134,6 +148,188 @@ generic_validate(clicon_handle       h,
     goto done;
 }
 
+/*! Compute hashes of a startup datastore and of the yang spec, see CLICON_STARTUP_TRUST
+ *
+ * The content hash is a FNV-1a hash of the datastore file as stored.
+ * The schema hash covers options, config, plugin names and yang module files, see
+ * yang_spec_cache_hash
+ * @param[in]  h       Clixon handle
+ * @param[in]  db      Datastore
+ * @param[out] schema  Hash of yang spec
+ * @param[out] content Hash of datastore file
+ * @retval     1       OK
+ * @retval     0       No hash, eg split datastore, no file or a yang module without file
+ * @retval    -1       Error
+ */
+static int
+startup_trust_hash(clicon_handle h,
+                   char         *db,
+                   uint64_t     *schema,
+                   uint64_t     *content)
+{
+    int         retval = -1;
+    char       *filename = NULL;
+    cbuf       *cb = NULL;
+    struct stat st;
+    FILE       *f = NULL;
+    uint8_t     buf[8192];
+    size_t      len;
+    size_t      i;
+    uint64_t    k = 14695981039346656037ULL;
+    int         ret;
+
+    if (clicon_option_bool(h, "CLICON_XMLDB_SPLIT"))
+        goto nohash;
+    if (xmldb_db2file(h, db, &filename) < 0)
+        goto done;
+    /* A split directory is read also if the option is not set */
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s.d", filename);
+    if (stat(cbuf_get(cb), &st) == 0)
+        goto nohash;
+    if (stat(filename, &st) < 0 || !S_ISREG(st.st_mode))
+        goto nohash;
+    if ((ret = yang_spec_cache_hash(h, "backend", clicon_dbspec_yang(h), schema)) < 0)
+        goto done;
+    if (ret == 0)
+        goto nohash;
+    if ((f = fopen(filename, "r")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen(%s)", filename);
+        goto done;
+    }
+    while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+        for (i=0; i<len; i++){
+            k ^= buf[i];
+            k *= 1099511628211ULL;
+        }
+    if (ferror(f)){
+        clicon_err(OE_UNIX, errno, "fread(%s)", filename);
+        goto done;
+    }
+    *content = k;
+    retval = 1;
+ done:
+    if (f)
+        fclose(f);
+    if (cb)
+        cbuf_free(cb);
+    if (filename)
+        free(filename);
+    return retval;
+ nohash:
+    retval = 0;
+    goto done;
+}
+
+/*! Get name of file with hashes of last committed startup datastore
+ *
+ * @param[in]  h   Clixon handle
+ * @param[in]  db  Datastore
+ * @param[out] cb  File name, <db>_db.trust in CLICON_XMLDB_DIR
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+startup_trust_file(clicon_handle h,
+                   char         *db,
+                   cbuf         *cb)
+{
+    char *filename = NULL;
+
+    if (xmldb_db2file(h, db, &filename) < 0)
+        return -1;
+    cprintf(cb, "%s.trust", filename);
+    free(filename);
+    return 0;
+}
+
+/*! Check if startup datastore is unchanged since it was last committed
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  db      Datastore
+ * @param[in]  schema  Hash of yang spec
+ * @param[in]  content Hash of datastore file
+ * @retval     1       Unchanged, and the yang spec is the same
+ * @retval     0       Changed, or no hashes saved
+ * @retval    -1       Error
+ */
+static int
+startup_trust_check(clicon_handle h,
+                    char         *db,
+                    uint64_t      schema,
+                    uint64_t      content)
+{
+    int      retval = -1;
+    cbuf    *cb = NULL;
+    FILE    *f = NULL;
+    uint64_t s0;
+    uint64_t c0;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (startup_trust_file(h, db, cb) < 0)
+        goto done;
+    retval = 0;
+    if ((f = fopen(cbuf_get(cb), "r")) == NULL)
+        goto done;
+    if (fscanf(f, "%" SCNx64 " %" SCNx64, &s0, &c0) != 2)
+        goto done;
+    if (s0 == schema && c0 == content)
+        retval = 1;
+ done:
+    if (f)
+        fclose(f);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Save hashes of a committed startup datastore
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  db      Datastore
+ * @param[in]  schema  Hash of yang spec
+ * @param[in]  content Hash of datastore file
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+startup_trust_save(clicon_handle h,
+                   char         *db,
+                   uint64_t      schema,
+                   uint64_t      content)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+    FILE *f = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (startup_trust_file(h, db, cb) < 0)
+        goto done;
+    if ((f = fopen(cbuf_get(cb), "w")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen(%s)", cbuf_get(cb));
+        goto done;
+    }
+    fprintf(f, "%016" PRIx64 " %016" PRIx64 "\n", schema, content);
+    retval = 0;
+ done:
+    if (f && fclose(f) != 0 && retval == 0){
+        clicon_err(OE_UNIX, errno, "fclose");
+        retval = -1;
+    }
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Common startup validation
  * Get db, upgrade it w potential transformed XML, populate it w yang spec,
  * sort it, validate it by triggering a transaction
@@ -141,6 +337,7 @@ generic_validate(clicon_handle       h,
  * @param[in]  h       Clicon handle
  * @param[in]  db      The startup database. The wanted backend state
  * @param[in]  td      Transaction data
+ * @param[in]  trusted db is unchanged since last commit, skip generic validation
  * @param[out] cbret   CLIgen buffer w error stmt if retval = 0
  * @retval     1       Validation OK       
  * @retval     0       Validation failed (with cbret set)
@@ -160,6 +357,7 @@ static int
 startup_common(clicon_handle       h, 
                char               *db,
                transaction_data_t *td,
+               int                 trusted,
                cbuf               *cbret)
 {
     int                 retval = -1;
@@ -214,8 +412,8 @@ startup_common(clicon_handle       h,
     }
     clicon_debug(1, "Reading startup config done");
     /* Clear flags xpath for get */
-    xml_apply0(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
+    xml_flag_reset(xt, XML_FLAG_MARK|XML_FLAG_CHANGE);
+    xml_flag_reset_rec(xt, XML_FLAG_MARK|XML_FLAG_CHANGE);
     /* Here xt is old syntax */
     /* General purpose datastore upgrade */
     if (clixon_plugin_datastore_upgrade_all(h, db, xt, msdiff) < 0)
@@ -275,7 +473,7 @@ startup_common(clicon_handle       h,
         goto fail; 
     }
     /* Sort xml */
-    if (xml_sort_recurse(xt) < 0)
+    if (xml_sort_recurse_parallel(xt, clicon_option_int(h, "CLICON_XML_SORT_THREADS")) < 0)
         goto done;
     /* Add global defaults. */
     if (xml_global_defaults(h, xt, NULL, NULL, yspec, 0) < 0)
@@ -301,13 +499,17 @@ startup_common(clicon_handle       h,
 
     /* 5. Make generic validation on all new or changed data.
        Note this is only call that uses 3-values */
-    clicon_debug(1, "Validating startup %s", db);
-    if ((ret = generic_validate(h, yspec, td, &xret)) < 0)
-        goto done;
-    if (ret == 0){
-        if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
+    if (trusted)
+        clicon_log(LOG_INFO, "Startup %s unchanged since last commit, not validated", db);
+    else {
+        clicon_debug(1, "Validating startup %s", db);
+        if ((ret = generic_validate(h, yspec, td, &xret)) < 0)
             goto done;
-        goto fail; /* STARTUP_INVALID */
+        if (ret == 0){
+            if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
+                goto done;
+            goto fail; /* STARTUP_INVALID */
+        }
     }
     /* 6. Call plugin transaction validate callbacks */
     if (plugin_transaction_validate_all(h, td) < 0)
@@ -356,7 +558,7 @@ startup_validate(clicon_handle  h,
     /* Handcraft a transition with only target and add trees */
     if ((td = transaction_new()) == NULL)
         goto done;
-    if ((ret = startup_common(h, db, td, cbret)) < 0){
+    if ((ret = startup_common(h, db, td, 0, cbret)) < 0){
         plugin_transaction_abort_all(h, td);
         goto done;
     }
@@ -393,6 +595,8 @@ startup_validate(clicon_handle  h,
  * @retval     0       Validation failed (with cbret set)
  * @retval    -1       Error - or validation failed (but cbret not set)
  * Only called from startup_mode_startup
+ * If CLICON_STARTUP_TRUST is set and the startup datastore and yang spec are unchanged
+ * since startup was last committed, generic validation is skipped
  */
 int
 startup_commit(clicon_handle  h, 
@@ -402,15 +606,27 @@ startup_commit(clicon_handle  h,
     int                 retval = -1;
     int                 ret;
     transaction_data_t *td = NULL;
+    int                 hashed = 0;
+    int                 trusted = 0;
+    uint64_t            schema = 0;
+    uint64_t            content = 0;
 
     if (strcmp(db,"running")==0){
         clicon_err(OE_FATAL, 0, "Invalid startup db: %s", db);
         goto done;
     }
+    /* Hash startup before it is read, see CLICON_STARTUP_TRUST */
+    if (clicon_option_bool(h, "CLICON_STARTUP_TRUST") && strcmp(db, "startup") == 0){
+        if ((hashed = startup_trust_hash(h, db, &schema, &content)) < 0)
+            goto done;
+        if (hashed &&
+            (trusted = startup_trust_check(h, db, schema, content)) < 0)
+            goto done;
+    }
     /* Handcraft a transition with only target and add trees */
     if ((td = transaction_new()) == NULL)
         goto done;
-    if ((ret = startup_common(h, db, td, cbret)) < 0)
+    if ((ret = startup_common(h, db, td, trusted, cbret)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -448,6 +664,9 @@ startup_commit(clicon_handle  h,
         goto fail;
     /* 10. Call plugin transaction end callbacks */
     plugin_transaction_end_all(h, td);
+    if (hashed && !trusted &&
+        startup_trust_save(h, db, schema, content) < 0)
+        goto done;
     retval = 1;
  done:
     if (td){
@@ -462,6 +681,70 @@ startup_commit(clicon_handle  h,
     goto done;
 }
 
+/*! Datastore versions of the last successful validation, see validate_cache_check
+ */
+struct validate_cache {
+    char     *vc_db;      /* Validated datastore, or NULL */
+    uint64_t  vc_version; /* Version of vc_db when validated */
+    uint64_t  vc_running; /* Version of running when validated */
+};
+
+static struct validate_cache _vcache = {NULL, 0, 0};
+
+/*! Check if a datastore has been validated against running in their current versions
+ *
+ * Typically a validate of candidate directly followed by a commit. The yang validation
+ * is then not made again, since its result is the same.
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Datastore
+ * @retval     1    Validated, neither db nor running has changed since
+ * @retval     0    Not validated
+ * @retval    -1    Error
+ * @see validate_cache_set
+ */
+static int
+validate_cache_check(clicon_handle h,
+                     char         *db)
+{
+    uint64_t version;
+    uint64_t running;
+
+    if (_vcache.vc_db == NULL || strcmp(_vcache.vc_db, db) != 0)
+        return 0;
+    if (xmldb_version_get(h, db, &version, NULL) < 0 ||
+        xmldb_version_get(h, "running", &running, NULL) < 0)
+        return -1;
+    return version == _vcache.vc_version && running == _vcache.vc_running;
+}
+
+/*! Record the current versions of a datastore and running after a successful validation
+ *
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Datastore, or NULL to forget the last validation
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see validate_cache_check
+ */
+static int
+validate_cache_set(clicon_handle h,
+                   char         *db)
+{
+    if (_vcache.vc_db){
+        free(_vcache.vc_db);
+        _vcache.vc_db = NULL;
+    }
+    if (db == NULL)
+        return 0;
+    if (xmldb_version_get(h, db, &_vcache.vc_version, NULL) < 0 ||
+        xmldb_version_get(h, "running", &_vcache.vc_running, NULL) < 0)
+        return -1;
+    if ((_vcache.vc_db = strdup(db)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        return -1;
+    }
+    return 0;
+}
+
 /*! Validate a candidate db and comnpare to running
  * Get both source and dest datastore, validate target, compute diffs
  * and call application callback validations.
@@ -482,24 +765,26 @@ validate_common(clicon_handle       h,
                 transaction_data_t *td,
                 cxobj             **xret)
 {
-    int         retval = -1;
-    yang_stmt  *yspec;
-    int         i;
-    cxobj      *xn;
-    int         ret;
+    int             retval = -1;
+    yang_stmt      *yspec;
+    int             i;
+    cxobj          *xn;
+    int             ret;
+    struct timespec t0;
     
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_FATAL, 0, "No DB_SPEC");
         goto done;
     }   
+    commit_stats_start(&t0);
     /* This is the state we are going to */
     if ((ret = xmldb_get0(h, db, YB_MODULE, NULL, "/", 0, 0, &td->td_target, NULL, xret)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
     /* Clear flags xpath for get */
-    xml_apply0(td->td_target, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
+    xml_flag_reset(td->td_target, XML_FLAG_MARK|XML_FLAG_CHANGE);
+    xml_flag_reset_rec(td->td_target, XML_FLAG_MARK|XML_FLAG_CHANGE);
     /* 2. Parse xml trees 
      * This is the state we are going from */
     if ((ret = xmldb_get0(h, "running", YB_MODULE, NULL, "/", 0, 0, &td->td_src, NULL, xret)) < 0)
@@ -507,18 +792,34 @@ validate_common(clicon_handle       h,
     if (ret == 0)
         goto fail;
     /* Clear flags xpath for get */
-    xml_apply0(td->td_src, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
-    /* 3. Compute differences */
-    if (xml_diff(td->td_src,
-                 td->td_target,
-                 &td->td_dvec,      /* removed: only in running */
-                 &td->td_dlen,
-                 &td->td_avec,      /* added: only in candidate */
-                 &td->td_alen,
-                 &td->td_scvec,     /* changed: original values */
-                 &td->td_tcvec,     /* changed: wanted values */
-                 &td->td_clen) < 0)
+    xml_flag_reset(td->td_src, XML_FLAG_MARK|XML_FLAG_CHANGE);
+    xml_flag_reset_rec(td->td_src, XML_FLAG_MARK|XML_FLAG_CHANGE);
+    if (commit_stats_phase(h, CP_READ, &t0) < 0)
+        goto done;
+    /* 3. Compute differences
+     * If db is running with edits marked, only compare the edited subtrees */
+    if ((ret = xmldb_delta_get(h, db, "running")) == 1){
+        if (xml_diff_dirty(td->td_src,
+                           td->td_target,
+                           &td->td_dvec,      /* removed: only in running */
+                           &td->td_dlen,
+                           &td->td_avec,      /* added: only in candidate */
+                           &td->td_alen,
+                           &td->td_scvec,     /* changed: original values */
+                           &td->td_tcvec,     /* changed: wanted values */
+                           &td->td_clen) < 0)
+            goto done;
+    }
+    else if (xml_diff_threads(td->td_src,
+                              td->td_target,
+                              clicon_option_int(h, "CLICON_XML_DIFF_THREADS"),
+                              &td->td_dvec,      /* removed: only in running */
+                              &td->td_dlen,
+                              &td->td_avec,      /* added: only in candidate */
+                              &td->td_alen,
+                              &td->td_scvec,     /* changed: original values */
+                              &td->td_tcvec,     /* changed: wanted values */
+                              &td->td_clen) < 0)
         goto done;
     if (clicon_debug_get() & CLIXON_DBG_DETAIL)
         transaction_dbg(h, CLIXON_DBG_DETAIL, td, __FUNCTION__);
@@ -543,13 +844,25 @@ validate_common(clicon_handle       h,
         xml_flag_set(xn, XML_FLAG_CHANGE);
         xml_apply_ancestor(xn, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
     }
+    if (commit_stats_phase(h, CP_DIFF, &t0) < 0)
+        goto done;
     /* 4. Call plugin transaction start callbacks */
     if (plugin_transaction_begin_all(h, td) < 0)
         goto done;
+    if (commit_stats_phase(h, CP_BEGIN, &t0) < 0)
+        goto done;
 
-    /* 5. Make generic validation on all new or changed data.
+    /* 5. Make generic validation on all new or changed data, unless db and running are
+       unchanged since the last successful validation.
        Note this is only call that uses 3-values */
-    if ((ret = generic_validate(h, yspec, td, xret)) < 0)
+    if ((ret = validate_cache_check(h, db)) < 0)
+        goto done;
+    if (ret == 1)
+        clicon_debug(CLIXON_DBG_DEFAULT, "%s %s unchanged since last validation, not validated",
+                     __FUNCTION__, db);
+    else if ((ret = generic_validate(h, yspec, td, xret)) < 0)
+        goto done;
+    if (commit_stats_phase(h, CP_VALIDATE, &t0) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -557,10 +870,16 @@ validate_common(clicon_handle       h,
     /* 6. Call plugin transaction validate callbacks */
     if (plugin_transaction_validate_all(h, td) < 0)
         goto done;
+    if (commit_stats_phase(h, CP_PVALIDATE, &t0) < 0)
+        goto done;
 
     /* 7. Call plugin transaction complete callbacks */
     if (plugin_transaction_complete_all(h, td) < 0)
         goto done;
+    if (commit_stats_phase(h, CP_COMPLETE, &t0) < 0)
+        goto done;
+    if (validate_cache_set(h, db) < 0)
+        goto done;
     retval = 1;
  done:
     return retval;
@@ -670,7 +989,18 @@ candidate_commit(clicon_handle h,
     int                 ret;
     cxobj              *xret = NULL;
     yang_stmt          *yspec;
+    cxobj              *xrec = NULL;
+    cxobj              *xship = NULL;
+    struct timespec     tstart;
+    struct timespec     t0;
 
+    /* Asynchronous commits submitted before are committed first */
+    if (backend_job_drain(h) < 0)
+        goto done;
+    commit_stats_start(&tstart);
+    /* Other clients read the old running until the commit is done */
+    if (backend_commit_reader_start(h) < 0)
+        goto done;
     /* 1. Start transaction */
     if ((td = transaction_new()) == NULL)
         goto done;
@@ -708,12 +1038,32 @@ candidate_commit(clicon_handle h,
         goto fail;
     }
     /* 7. Call plugin transaction commit callbacks */
+    commit_stats_start(&t0);
     if (plugin_transaction_commit_all(h, td) < 0)
         goto done;
+    if (commit_stats_phase(h, CP_COMMIT, &t0) < 0)
+        goto done;
     /* After commit, make a post-commit call (sure that all plugins have committed) */
     if (plugin_transaction_commit_done_all(h, td) < 0)
         goto done;
+    if (commit_stats_phase(h, CP_COMMIT_DONE, &t0) < 0)
+        goto done;
      
+    /* Record changes for the running journal, before defaults are cleared */
+    if (xmldb_journal_record(h, td->td_dvec, td->td_dlen, td->td_avec, td->td_alen,
+                             td->td_scvec, td->td_tcvec, td->td_clen, &xrec) < 0)
+        goto done;
+    /* Record changes for standby backends, see CLICON_STREAM_JOURNAL */
+    if (clicon_option_bool(h, "CLICON_STREAM_JOURNAL") &&
+        xmldb_journal_changes(h, td->td_dvec, td->td_dlen, td->td_avec, td->td_alen,
+                              td->td_scvec, td->td_tcvec, td->td_clen, &xship) < 0)
+        goto done;
+    /* Retain inverse changes for rollback of an ephemeral confirmed-commit */
+    if (confirmed_commit_record(h, (transaction_data)td) < 0)
+        goto done;
+    /* Match changes against on-change push subscriptions */
+    if (backend_push_commit(h, td) < 0)
+        goto done;
     /* Clear cached trees from default values and marking */
     if (xmldb_get0_clear(h, td->td_target) < 0)
         goto done;
@@ -721,10 +1071,23 @@ candidate_commit(clicon_handle h,
         goto done;
 
     /* 8. Success: Copy candidate to running 
+     * If CLICON_XMLDB_JOURNAL is set, append the changes to the running journal instead
      */
-    if (xmldb_copy(h, db, "running") < 0)
+    if (xmldb_journal_commit(h, db, "running", xrec) < 0)
+        goto done;
+    /* db is now equal to running, see CLICON_XMLDB_CANDIDATE_DELTA */
+    if (xmldb_delta_set(h, db, "running") < 0)
         goto done;
     xmldb_modified_set(h, db, 0); /* reset dirty bit */
+    /* Send changed top-level nodes on datastore stream, with new version of running */
+    if (backend_push_changed(h) < 0)
+        goto done;
+    /* Ship changes to standby backends, or all of running if there is no record */
+    if (clicon_option_bool(h, "CLICON_STREAM_JOURNAL") &&
+        backend_push_journal(h, xship) < 0)
+        goto done;
+    if (commit_stats_phase(h, CP_WRITE, &t0) < 0)
+        goto done;
     /* Here pointers to old (source) tree are obsolete */
     if (td->td_dvec){
         td->td_dlen = 0;
@@ -735,9 +1098,14 @@ candidate_commit(clicon_handle h,
         free(td->td_scvec);
         td->td_scvec = NULL;
     }
+    transaction_change_index_reset(td);
 
     /* 9. Call plugin transaction end callbacks */
     plugin_transaction_end_all(h, td);
+    if (commit_stats_phase(h, CP_END, &t0) < 0)
+        goto done;
+    if (commit_stats_phase(h, CP_TOTAL, &tstart) < 0)
+        goto done;
     
     retval = 1;
  done:
@@ -749,8 +1117,13 @@ candidate_commit(clicon_handle h,
         xmldb_get0_free(h, &td->td_src);
         transaction_free(td);
     }
+    backend_commit_reader_stop(h);
     if (xret)
         xml_free(xret);
+    if (xrec)
+        xml_free(xrec);
+    if (xship)
+        xml_free(xship);
     return retval;
  fail:
     retval = 0;
@@ -803,6 +1176,12 @@ from_client_commit(clicon_handle h,
         clicon_err(OE_YANG, ENOENT, "No yang spec");
         goto done;
     }
+    /* Running is replicated from an active backend, see backend_standby_start */
+    if (clicon_data_int_get(h, "backend-standby") == 1){
+        if (netconf_operation_failed(cbret, "application", "Backend is standby") < 0)
+            goto done;
+        goto ok;
+    }
     if (if_feature(yspec, "ietf-netconf", "confirmed-commit")) {
         if ((ret = from_client_confirmed_commit(h, xe, myid, cbret)) < 0)
             goto done;
@@ -820,15 +1199,24 @@ from_client_commit(clicon_handle h,
             goto done;
         goto ok;
     }
-    if ((ret = candidate_commit(h, xe, "candidate", myid, 0, cbret)) < 0){ /* Assume validation fail, nofatal */
+    /* Private candidate is rebased on running first, see CLICON_XMLDB_PRIVATE_CANDIDATE */
+    if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE"))
+        ret = backend_private_commit(h, xe, myid, cbret);
+    else
+        ret = candidate_commit(h, xe, "candidate", myid, 0, cbret);
+    if (ret < 0){ /* Assume validation fail, nofatal */
         clicon_debug(1, "Commit candidate failed");
         if (ret < 0)
             if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
                 goto done;
         goto ok;
     }
-    if (ret == 1)
+    if (ret == 1){
         cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+        /* Reply is sent when running is durable, see from_client_msg */
+        if (clicon_xmldb_async(h) == XMLDB_ASYNC_REPLY_AFTER)
+            ce->ce_reply_seq = xmldb_async_queued(h);
+    }
  ok:
     retval = 0;
  done:
@@ -861,7 +1249,17 @@ from_client_discard_changes(clicon_handle h,
     uint32_t             myid = ce->ce_id;
     uint32_t             iddb;
     cbuf                *cbx = NULL; /* Assist cbuf */
-    
+
+    /* Private candidate of session, see CLICON_XMLDB_PRIVATE_CANDIDATE */
+    if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE")){
+        if (backend_private_discard(h, myid) < 0){
+            if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
+                goto done;
+            goto ok;
+        }
+        cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+        goto ok;
+    }
     /* Check if target locked by other client */
     iddb = xmldb_islocked(h, "candidate");
     if (iddb && myid != iddb){
@@ -979,15 +1377,16 @@ from_client_restart_one(clicon_handle h,
         goto done;
 
     /* 3. Compute differences */
-    if (xml_diff(td->td_src,
-                 td->td_target,
-                 &td->td_dvec,      /* removed: only in running */
-                 &td->td_dlen,
-                 &td->td_avec,      /* added: only in candidate */
-                 &td->td_alen,
-                 &td->td_scvec,     /* changed: original values */
-                 &td->td_tcvec,     /* changed: wanted values */
-                 &td->td_clen) < 0)
+    if (xml_diff_threads(td->td_src,
+                         td->td_target,
+                         clicon_option_int(h, "CLICON_XML_DIFF_THREADS"),
+                         &td->td_dvec,      /* removed: only in running */
+                         &td->td_dlen,
+                         &td->td_avec,      /* added: only in candidate */
+                         &td->td_alen,
+                         &td->td_scvec,     /* changed: original values */
+                         &td->td_tcvec,     /* changed: wanted values */
+                         &td->td_clen) < 0)
         goto done;
 
     /* Mark as changed in tree */
@@ -84,8 +84,27 @@ struct confirmed_commit {
     uint32_t    cc_session_id;       /* the session_id of the client that gave no <persist> value */
     int        (*cc_fn)(int, void*); /* function pointer for rollback event (rollback_fn()) */
     void        *cc_arg;             /* clicon_handle that will be passed to rollback_fn() */
+    int          cc_undo;            /* Rollback is running with cc_undovec reverted, no rollback db */
+    cxobj      **cc_undovec;         /* Inverse records of the commits of the sequence, in order */
+    int          cc_undolen;         /* Length of cc_undovec */
 };
 
+/*! Stop retaining inverse records of commits and free them
+ */
+static void
+confirmed_commit_undo_reset(struct confirmed_commit *cc)
+{
+    int i;
+
+    for (i=0; i<cc->cc_undolen; i++)
+        xml_free(cc->cc_undovec[i]);
+    if (cc->cc_undovec)
+        free(cc->cc_undovec);
+    cc->cc_undovec = NULL;
+    cc->cc_undolen = 0;
+    cc->cc_undo = 0;
+}
+
 int
 confirmed_commit_init(clicon_handle h)
 {
@@ -117,6 +136,7 @@ confirmed_commit_free(clicon_handle h)
     if (cc != NULL){
         if (cc->cc_persist_id != NULL)
             free (cc->cc_persist_id);
+        confirmed_commit_undo_reset(cc);
         free(cc);
     }
     clicon_ptr_del(h, "confirmed-commit-struct");
@@ -221,6 +241,133 @@ confirmed_commit_fn_arg_set(clicon_handle h,
     return 0;
 }
 
+/*! Write the rollback database and stop retaining inverse records of commits
+ *
+ * The rollback database is running with the retained inverse records reverted, ie running
+ * before the first commit of the confirmed-commit sequence.
+ * Needed when the sequence becomes persistent, or when running is changed in a way that
+ * can not be reverted by an inverse record, eg by an edit-config with running as target.
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK, or rollback database already used
+ * @retval    -1   Error
+ */
+int
+confirmed_commit_rollback_save(clicon_handle h)
+{
+    int                      retval = -1;
+    struct confirmed_commit *cc = NULL;
+    cbuf                    *cbret = NULL;
+    int                      ret;
+
+    clicon_ptr_get(h, "confirmed-commit-struct", (void**)&cc);
+    if (cc == NULL || !cc->cc_undo)
+        goto ok;
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s %d records", __FUNCTION__, cc->cc_undolen);
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (xmldb_copy(h, "running", "rollback") < 0)
+        goto done;
+    if ((ret = xmldb_journal_revert(h, "rollback", cc->cc_undovec, cc->cc_undolen, 1, cbret)) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_err(OE_DB, 0, "Revert of rollback database: %s", cbuf_get(cbret));
+        goto done;
+    }
+    confirmed_commit_undo_reset(cc);
+ ok:
+    retval = 0;
+ done:
+    if (cbret)
+        cbuf_free(cbret);
+    return retval;
+}
+
+/*! Retain the inverse changes of a commit of a confirmed-commit sequence
+ *
+ * Instead of copying running to the rollback database when an ephemeral confirmed-commit
+ * sequence starts, the inverse records of its commits are retained in memory, and the
+ * rollback configuration is made from them only on rollback, see do_rollback.
+ * Must be called before running is changed and before defaults are cleared
+ * @param[in]  h   Clicon handle
+ * @param[in]  td  Transaction data of commit
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see confirmed_commit_rollback_save  If a commit can not be inverted
+ */
+int
+confirmed_commit_record(clicon_handle    h,
+                        transaction_data td0)
+{
+    int                      retval = -1;
+    transaction_data_t      *td = (transaction_data_t *)td0;
+    struct confirmed_commit *cc = NULL;
+    cxobj                   *xinv = NULL;
+
+    clicon_ptr_get(h, "confirmed-commit-struct", (void**)&cc);
+    if (cc == NULL || !cc->cc_undo || cc->cc_state == ROLLBACK)
+        goto ok;
+    if (xmldb_journal_inverse(h, td->td_dvec, td->td_dlen, td->td_avec, td->td_alen,
+                              td->td_scvec, td->td_tcvec, td->td_clen, &xinv) < 0)
+        goto done;
+    if (xinv == NULL){ /* Running is not yet changed */
+        if (confirmed_commit_rollback_save(h) < 0)
+            goto done;
+        goto ok;
+    }
+    if (cxvec_append(xinv, &cc->cc_undovec, &cc->cc_undolen) < 0)
+        goto done;
+    xinv = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (xinv)
+        xml_free(xinv);
+    return retval;
+}
+
+/*! Make the rollback database in memory from running and the retained inverse records
+ *
+ * Only the reverted nodes are marked as edited, so the rollback commit only compares those
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK, or rollback database already exists
+ * @retval    -1   Error
+ */
+static int
+rollback_db_undo(clicon_handle h)
+{
+    int                      retval = -1;
+    struct confirmed_commit *cc = NULL;
+    cbuf                    *cbret = NULL;
+    int                      ret;
+
+    clicon_ptr_get(h, "confirmed-commit-struct", (void**)&cc);
+    if (!cc->cc_undo)
+        goto ok;
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (xmldb_copy_cache(h, "running", "rollback") < 0)
+        goto done;
+    if (xmldb_delta_set(h, "rollback", "running") < 0)
+        goto done;
+    if ((ret = xmldb_journal_revert(h, "rollback", cc->cc_undovec, cc->cc_undolen, 0, cbret)) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_err(OE_DB, 0, "Revert of rollback database: %s", cbuf_get(cbret));
+        goto done;
+    }
+    confirmed_commit_undo_reset(cc);
+ ok:
+    retval = 0;
+ done:
+    if (cbret)
+        cbuf_free(cbret);
+    return retval;
+}
+
 /*! Return if confirmed tag found
  * @param[in]  xe  Commit rpc xml
  * @retval     1   Confirmed tag exists
@@ -380,7 +527,11 @@ schedule_rollback_event(clicon_handle h,
 int
 cancel_confirmed_commit(clicon_handle h)
 {
+    struct confirmed_commit *cc = NULL;
+
     cancel_rollback_event(h);
+    clicon_ptr_get(h, "confirmed-commit-struct", (void**)&cc);
+    confirmed_commit_undo_reset(cc);
 
     if (confirmed_commit_state_get(h) == PERSISTENT &&
         confirmed_commit_persist_id_get(h) != NULL) {
@@ -484,11 +635,12 @@ handle_confirmed_commit(clicon_handle h,
                         cxobj        *xe,
                         uint32_t      myid)
 {
-    int           retval = -1;
-    char         *persist;
-    unsigned long confirm_timeout = 0L;
-    int           cc_valid;
-    int           db_exists;
+    int                      retval = -1;
+    char                    *persist;
+    unsigned long            confirm_timeout = 0L;
+    int                      cc_valid;
+    int                      db_exists;
+    struct confirmed_commit *cc = NULL;
 
     if (xe == NULL){
         clicon_err(OE_CFG, EINVAL, "xe is NULL");
@@ -496,6 +648,7 @@ handle_confirmed_commit(clicon_handle h,
     }
     if (myid == 0)
         goto ok;
+    clicon_ptr_get(h, "confirmed-commit-struct", (void**)&cc);
     /* The case of a valid confirming-commit is also handled in the first phase, but only if there is no subsequent
      * confirmed-commit.  It is tested again here as the case of a valid confirming-commit *with* a subsequent
      * confirmed-commit must be handled once the transaction has begun and after all the plugins' validate callbacks
@@ -577,15 +730,26 @@ handle_confirmed_commit(clicon_handle h,
          *     rollback database will be committed to running and then deleted.  If the system is configured to use a
          *     startup configuration instead, any present rollback database will be deleted.
          *
+         * An ephemeral sequence does not copy running to the rollback database if there is a datastore cache.
+         * Instead, the inverse changes of its commits are retained in memory, see confirmed_commit_record(),
+         * and the rollback database is written only if the sequence becomes persistent.
          */
-
-        db_exists = xmldb_exists(h, "rollback");
-        if (db_exists == -1) {
+        if (cc->cc_undo){
+            if (confirmed_commit_state_get(h) == PERSISTENT &&
+                confirmed_commit_rollback_save(h) < 0){
+                clicon_err(OE_DAEMON, 0, "there was an error while writing the rollback database.");
+                goto done;
+            }
+        }
+        else if ((db_exists = xmldb_exists(h, "rollback")) == -1) {
             clicon_err(OE_DAEMON, 0, "there was an error while checking existence of the rollback database");
             goto done;
         } else if (db_exists == 0) {
             // db does not yet exists
-            if (xmldb_copy(h, "running", "rollback") < 0) {
+            if (confirmed_commit_state_get(h) == EPHEMERAL &&
+                clicon_datastore_cache(h) != DATASTORE_NOCACHE)
+                cc->cc_undo = 1;
+            else if (xmldb_copy(h, "running", "rollback") < 0) {
                 clicon_err(OE_DAEMON, 0, "there was an error while copying the running configuration to rollback database.");
                 goto done;
             };
@@ -601,6 +765,7 @@ handle_confirmed_commit(clicon_handle h,
         /* There was no subsequent confirmed-commit, meaning this is the end of the confirmed/confirming sequence;
          * The new configuration is already committed to running and the rollback database can now be deleted
          */
+        confirmed_commit_undo_reset(cc);
         if (xmldb_delete(h, "rollback") < 0) {
             clicon_err(OE_DB, 0, "Error deleting the rollback configuration");
             goto done;
@@ -614,7 +779,8 @@ handle_confirmed_commit(clicon_handle h,
 
 /*! Do a rollback of the running configuration to the state prior to initiation of a confirmed-commit
  *
- * The "running" configuration prior to the first confirmed-commit was stored in another database named "rollback".
+ * The "running" configuration prior to the first confirmed-commit was stored in another database named "rollback",
+ * or is made in memory from the retained inverse changes of the commits since then.
  * Here, it is committed as if it is the candidate configuration.
  *
  * Execution has arrived here because do_rollback() was called by one of:
@@ -633,9 +799,10 @@ int
 do_rollback(clicon_handle h,
             uint8_t      *errs)
 {
-    int     retval = -1;
-    uint8_t errstate = 0;
-    cbuf   *cbret;
+    int                      retval = -1;
+    uint8_t                  errstate = 0;
+    cbuf                    *cbret;
+    struct confirmed_commit *cc = NULL;
 
     if ((cbret = cbuf_new()) == NULL) {
         clicon_err(OE_DAEMON, 0, "rollback was not performed. (cbuf_new: %s)", strerror(errno));
@@ -654,15 +821,17 @@ do_rollback(clicon_handle h,
         confirmed_commit_persist_id_set(h, NULL);
     }
     confirmed_commit_state_set(h, ROLLBACK);
-    if (candidate_commit(h, NULL, "rollback", 0, 0, cbret) < 0) { /* Assume validation fail, nofatal */
+    if (rollback_db_undo(h) < 0 ||
+        candidate_commit(h, NULL, "rollback", 0, 0, cbret) < 0) { /* Assume validation fail, nofatal */
         /* theoretically, this should never error, since the rollback database was previously active and therefore
          * had itself been previously and successfully committed.
          */
         clicon_log(LOG_CRIT, "An error occurred committing the rollback database.");
         errstate |= ROLLBACK_NOT_APPLIED;
 
-        /* Rename the errored rollback database */
-        if (xmldb_rename(h, "rollback", NULL, ".error") < 0) {
+        /* Rename the errored rollback database, unless only made in memory */
+        if (xmldb_exists(h, "rollback") == 1 &&
+            xmldb_rename(h, "rollback", NULL, ".error") < 0) {
             clicon_log(LOG_CRIT, "An error occurred renaming the rollback database.");
             errstate |= ROLLBACK_DB_NOT_DELETED;
         }
@@ -678,6 +847,7 @@ do_rollback(clicon_handle h,
         }
 
         errstate |= ROLLBACK_FAILSAFE_APPLIED;
+        xmldb_clear(h, "rollback");
         goto done;
     }
     cbuf_free(cbret);
@@ -689,6 +859,8 @@ do_rollback(clicon_handle h,
     };
     retval = 0;
  done:
+    clicon_ptr_get(h, "confirmed-commit-struct", (void**)&cc);
+    confirmed_commit_undo_reset(cc);
     confirmed_commit_state_set(h, INACTIVE);
     if (errs)
         *errs = errstate;
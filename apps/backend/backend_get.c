@@ -89,27 +89,25 @@ restconf_client_get_capabilities(clicon_handle h,
 {
     int     retval = -1;
     cxobj  *xrstate = NULL; /* xml restconf-state node */
-    cbuf   *cb = NULL;
-    
+    cxobj  *xc;
+    char   *capv[] = {"urn:ietf:params:restconf:capability:defaults:1.0?basic-mode=explicit",
+                      "urn:ietf:params:restconf:capability:depth:1.0",
+                      "urn:ietf:params:restconf:capability:fields:1.0",
+                      "urn:ietf:params:restconf:capability:with-defaults:1.0",
+                      NULL};
+    char  **cap;
+
     if ((xrstate = xpath_first(*xret, NULL, "restconf-state")) == NULL){
         clicon_err(OE_YANG, ENOENT, "restconf-state not found in config node");
         goto done;
     }
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    cprintf(cb, "<capabilities>");
-    cprintf(cb, "<capability>urn:ietf:params:restconf:capability:defaults:1.0?basic-mode=explicit</capability>");
-    cprintf(cb, "<capability>urn:ietf:params:restconf:capability:depth:1.0</capability>");
-    cprintf(cb, "<capability>urn:ietf:params:restconf:capability:with-defaults:1.0</capability>");
-    cprintf(cb, "</capabilities>");
-    if (clixon_xml_parse_string(cbuf_get(cb), YB_PARENT, NULL, &xrstate, NULL) < 0)
+    if ((xc = xml_build_child(xrstate, "capabilities")) == NULL)
         goto done;
+    for (cap = capv; *cap; cap++)
+        if (xml_build_str(xc, "capability", *cap) == NULL)
+            goto done;
     retval = 0;
  done:
-    if (cb)
-        cbuf_free(cb);
     return retval;
 }
 
@@ -119,9 +117,8 @@ restconf_client_get_capabilities(clicon_handle h,
  * @param[in]     xpath   Xpath selection, not used but may be to filter early
  * @param[in]     module  Name of yang module
  * @param[in]     top     Top symbol, ie netconf or restconf-state
- * @param[in,out] xret    Existing XML tree, merge x into this
+ * @param[in,out] xret    Existing XML tree, streams are added to top symbol, created if needed
  * @retval        1       OK
- * @retval        0       Statedata callback failed
  * @retval       -1       Error (fatal)
  */
 static int
@@ -133,46 +130,23 @@ client_get_streams(clicon_handle   h,
                    cxobj         **xret)
 {
     int            retval = -1;
-    yang_stmt     *yns = NULL;  /* yang namespace */
-    cxobj         *x = NULL;
-    cbuf          *cb = NULL;
-    int            ret;
+    yang_stmt     *yc;
+    cxobj         *x;
 
-    if ((yns = yang_find(ymod, Y_NAMESPACE, NULL)) == NULL){
-        clicon_err(OE_YANG, 0, "%s yang namespace not found", yang_argument_get(ymod));
+    if ((yc = yang_find(ymod, Y_CONTAINER, top)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "%s not found in yang module %s", top, yang_argument_get(ymod));
         goto done;
     }
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
+    if ((x = xml_build_top(*xret, yc)) == NULL)
         goto done;
-    }
-    cprintf(cb, "<%s xmlns=\"%s\">", top, yang_argument_get(yns));
     /* Second argument is a hack to have the same function for the
      * RFC5277 and 8040 stream cases
      */
-    if (stream_get_xml(h, strcmp(top,"restconf-state")==0, cb) < 0)
-        goto done;
-    cprintf(cb,"</%s>", top);
-
-    if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, &x, NULL) < 0){
-        if (xret && netconf_operation_failed_xml(xret, "protocol", clicon_err_reason)< 0)
-            goto done;
-        goto fail;
-    }
-    if ((ret = netconf_trymerge(x, yspec, xret)) < 0)
+    if (stream_build_xml(h, strcmp(top,"restconf-state")==0, x) < 0)
         goto done;
-    if (ret == 0)
-        goto fail;
     retval = 1;
  done:
-    if (cb)
-        cbuf_free(cb);
-    if (x)
-        xml_free(x);
     return retval;
- fail:
-    retval = 0;
-    goto done;
 }
 
 /*! Get system state-data, including streams and plugins
@@ -180,6 +154,7 @@ client_get_streams(clicon_handle   h,
  * @param[in]     xpath   XPath selection, may be used to filter early
  * @param[in]     nsc     XML Namespace context for xpath
  * @param[in]     wdef    With-defaults parameter, see RFC 6243
+ * @param[out]    untrusted Number of state trees from plugins that should be validated
  * @param[in,out] xret    Existing XML tree, merge x into this, or rpc-error
  * @retval        1       OK
  * @retval        0       Statedata callback failed (error in xret)
@@ -202,6 +177,7 @@ get_statedata(clicon_handle     h,
               char             *xpath,
               cvec             *nsc,
               withdefaults_type wdef,
+              int              *untrusted,
               cxobj           **xret)
 {
     int        retval = -1;
@@ -209,31 +185,19 @@ get_statedata(clicon_handle     h,
     yang_stmt *ymod;
     cxobj     *x1 = NULL;
     int        ret;
-    char      *namespace;
-    cbuf      *cb = NULL;
     cxobj     *xerr = NULL;
     
     clicon_debug(1, "%s", __FUNCTION__);
+    *untrusted = 0;
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_YANG, ENOENT, "No yang spec");
         goto done;
     }
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
     if (clicon_option_bool(h, "CLICON_STREAM_DISCOVERY_RFC5277")){
         if ((ymod = yang_find_module_by_name(yspec, "clixon-rfc5277")) == NULL){
             clicon_err(OE_YANG, ENOENT, "yang module clixon-rfc5277 not found");
             goto done;
         }
-        if ((namespace = yang_find_mynamespace(ymod)) == NULL){
-            clicon_err(OE_YANG, ENOENT, "clixon-rfc5277 namespace not found");
-            goto done;
-        }
-        cprintf(cb, "<netconf xmlns=\"%s\"/>", namespace);
-        if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, xret, NULL) < 0)
-            goto done;
         if ((ret = client_get_streams(h, yspec, xpath, ymod, "netconf", xret)) < 0)
             goto done;
         if (ret == 0)
@@ -244,14 +208,6 @@ get_statedata(clicon_handle     h,
             clicon_err(OE_YANG, ENOENT, "yang module ietf-restconf-monitoring not found");
             goto done;
         }
-        if ((namespace = yang_find_mynamespace(ymod)) == NULL){
-            clicon_err(OE_YANG, ENOENT, "ietf-restconf-monitoring namespace not found");
-            goto done;
-        }
-        cbuf_reset(cb);
-        cprintf(cb, "<restconf-state xmlns=\"%s\"/>", namespace);
-        if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, xret, NULL) < 0)
-            goto done;
         if ((ret = client_get_streams(h, yspec, xpath, ymod, "restconf-state", xret)) < 0)
             goto done;
         if (ret == 0)
@@ -310,7 +266,12 @@ get_statedata(clicon_handle     h,
         }
     }
     /* Use plugin state callbacks */
-    if ((ret = clixon_plugin_statedata_all(h, yspec, nsc, xpath, wdef, xret)) < 0)
+    if ((ret = clixon_plugin_statedata_all(h, yspec, nsc, xpath, wdef, untrusted, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* Use subtree state providers intersecting xpath */
+    if ((ret = clixon_statedata_subtree_all(h, yspec, nsc, xpath, untrusted, xret)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -373,8 +334,6 @@ get_statedata(clicon_handle     h,
         xml_free(xerr);
     if (x1)
         xml_free(x1);
-    if (cb)
-        cbuf_free(cb);
     return retval;
  fail:
     retval = 0;
@@ -429,7 +388,7 @@ filter_xpath_again(clicon_handle h,
         if (xml_tree_prune_flagged_sub(xret, XML_FLAG_MARK, 1, NULL) < 0)
             goto done;
     /* reset flag */
-    if (xml_apply(xret, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
+    if (xml_flag_reset_rec(xret, XML_FLAG_MARK) < 0)
         goto done;
     retval = 0;
  done:
@@ -439,30 +398,37 @@ filter_xpath_again(clicon_handle h,
 /*! Help function for NACM access and return message
  *
  * @param[in]  h        Clicon handle 
- * @param[in]  xret     Result XML tree
+ * @param[in]  ce       Client entry, or NULL
+ * @param[in]  xretp    Result XML tree, set to NULL if taken over by a streamed reply
  * @param[in]  xvec    xpath lookup result on xret
  * @param[in]  xlen    length of xvec
  * @param[in]  xpath    XPath point to object to get
  * @param[in]  nsc      Namespace context of xpath
  * @param[in]  username User name for NACM access
  * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
- * @param[out] cbret    Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[out] cbret    Return xml tree, eg <rpc-reply>..., <rpc-error.. , empty if streamed
  * @retval     0        OK
  * @retval    -1        Error
+ * If the client has negotiated binary replies, see CLICON_PROTO_BINARY, the reply is encoded
+ * in binary. Otherwise if it has negotiated streamed replies, see CLICON_PROTO_STREAM_CHUNK,
+ * the tree is handed over to be streamed after the RPC.
  */
 static int
-get_nacm_and_reply(clicon_handle h,
-                   cxobj        *xret,
-                   cxobj       **xvec,
-                   size_t        xlen,
-                   char         *xpath,
-                   cvec         *nsc,
-                   char         *username,
-                   int32_t       depth,
-                   cbuf         *cbret)
+get_nacm_and_reply(clicon_handle        h,
+                   struct client_entry *ce,
+                   cxobj              **xretp,
+                   cxobj              **xvec,
+                   size_t               xlen,
+                   char                *xpath,
+                   cvec                *nsc,
+                   char                *username,
+                   int32_t              depth,
+                   cbuf                *cbret)
 {
     int     retval = -1;
+    cxobj  *xret = *xretp;
     cxobj  *xnacm = NULL;
+    cxobj  *xr = NULL;
 
     /* Pre-NACM access step */
     xnacm = clicon_nacm_cache(h);
@@ -471,6 +437,29 @@ get_nacm_and_reply(clicon_handle h,
         if (nacm_datanode_read(h, xret, xvec, xlen, username, xnacm) < 0) 
             goto done;
     }
+    /* Binary encoding has no depth limit, the tree is encoded as is */
+    if (ce && ce->ce_binary && xret != NULL && depth < 0){
+        if (xml_name_set(xret, NETCONF_OUTPUT_DATA) < 0)
+            goto done;
+        if ((xr = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
+            goto done;
+        if (xmlns_set(xr, NULL, NETCONF_BASE_NAMESPACE) < 0)
+            goto done;
+        if (xml_addsub(xr, xret) < 0)
+            goto done;
+        retval = clixon_xml2binary_cbuf(cbret, xr);
+        xml_rm(xret);
+        goto done;
+    }
+    if (ce && ce->ce_stream_chunk && xret != NULL && depth < 0){
+        if (xml_name_set(xret, NETCONF_OUTPUT_DATA) < 0)
+            goto done;
+        if (backend_client_stream(ce, xret) < 0)
+            goto done;
+        *xretp = NULL;
+        retval = 0;
+        goto done;
+    }
     cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);     /* OK */
     if (xret==NULL)
         cprintf(cbret, "<data/>");
@@ -484,6 +473,8 @@ get_nacm_and_reply(clicon_handle h,
     cprintf(cbret, "</rpc-reply>");
     retval = 0;
  done:
+    if (xr)
+        xml_free(xr);
     return retval;
 }
 
@@ -548,6 +539,122 @@ list_pagination_hdr(clicon_handle h,
     return retval;
 }
 
+/*! Make list entry of a list-pagination cursor
+ *
+ * The cursor is the key values of a list entry in key order, or the value of a leaf-list
+ * entry, each percent-encoded and separated with comma as list keys in RESTCONF, RFC 8040
+ * Sec 3.5.3. Typically the keys of the last entry of the previous page.
+ * @param[in]  ylist    Yang list or leaf-list
+ * @param[in]  cursor   Cursor attribute
+ * @param[out] xcursor  List entry with key values, or leaf-list entry. Free with xml_free
+ * @param[out] cbret    Netconf error 
+ * @retval     1        OK
+ * @retval     0        Invalid cursor, netconf error cbret set
+ * @retval    -1        Error
+ */
+static int
+list_pagination_cursor(yang_stmt *ylist,
+                       char      *cursor,
+                       cxobj    **xcursor,
+                       cbuf      *cbret)
+{
+    int        retval = -1;
+    cxobj     *xc = NULL;
+    cxobj     *xk;
+    cvec      *cvk;
+    cg_var    *cvi = NULL;
+    char     **vec = NULL;
+    int        nvec = 0;
+    char      *val = NULL;
+    int        i;
+
+    if ((vec = clicon_strsep(cursor, ",", &nvec)) == NULL)
+        goto done;
+    cvk = yang_keyword_get(ylist) == Y_LIST ? yang_cvec_get(ylist) : NULL;
+    if (nvec != (cvk ? cvec_len(cvk) : 1)){
+        if (netconf_bad_attribute(cbret, "application",
+                                  "cursor", "Cursor does not match keys of list") < 0)
+            goto done;
+        goto fail;
+    }
+    if ((xc = xml_new(yang_argument_get(ylist), NULL, CX_ELMNT)) == NULL)
+        goto done;
+    xml_spec_set(xc, ylist);
+    for (i=0; i<nvec; i++){
+        if (uri_percent_decode(vec[i], &val) < 0)
+            goto done;
+        if (cvk == NULL){
+            if ((xk = xml_new("body", xc, CX_BODY)) == NULL ||
+                xml_value_set(xk, val) < 0)
+                goto done;
+        }
+        else {
+            cvi = cvec_i(cvk, i);
+            if ((xk = xml_new_body(cv_string_get(cvi), xc, val)) == NULL)
+                goto done;
+            xml_spec_set(xk, yang_find(ylist, Y_LEAF, cv_string_get(cvi)));
+        }
+        free(val);
+        val = NULL;
+    }
+    *xcursor = xc;
+    xc = NULL;
+    retval = 1;
+ done:
+    if (val)
+        free(val);
+    if (vec)
+        free(vec);
+    if (xc)
+        xml_free(xc);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Nr of levels of data nodes to copy from a datastore for a get with depth
+ *
+ * Nodes below depth are not printed in the reply and are not copied from the datastore.
+ * But the xpath is evaluated again on the copy, and its predicates may refer to nodes
+ * below depth. Every step and predicate of an xpath may descend one level, so these levels
+ * are copied as well. If the xpath may descend any number of levels, or NACM read-default
+ * is deny and a read rule of a node below depth may permit its ancestors, all are copied.
+ * @param[in]  h      Clicon handle 
+ * @param[in]  xpath  XPath selection, or NULL
+ * @param[in]  depth  Nr of levels to print, -1 is all
+ * @retval     n      Nr of levels to copy, see xmldb_get_depth
+ * @retval    -1      Copy all levels
+ */
+static int32_t
+get_copy_depth(clicon_handle h,
+               char         *xpath,
+               int32_t       depth)
+{
+    cxobj  *xnacm;
+    char   *str;
+    char   *s;
+    int32_t n = 0;
+
+    if (depth < 0)
+        return -1;
+    if ((xnacm = clicon_nacm_cache(h)) != NULL &&
+        (str = xml_find_body(xnacm, "read-default")) != NULL &&
+        strcmp(str, "deny") == 0)
+        return -1;
+    if (xpath != NULL){
+        if (strstr(xpath, "//") != NULL ||
+            strstr(xpath, "descendant") != NULL ||
+            strstr(xpath, "following::") != NULL ||
+            strstr(xpath, "preceding::") != NULL)
+            return -1;
+        for (s = xpath; *s != '\0'; s++)
+            if (*s == '/' || *s == '[')
+                n++;
+    }
+    return depth > n ? depth : n;
+}
+
 /*! Specialized get for list-pagination
  *
  * It is specialized enough to have its own function. Specifically, extra attributes as well
@@ -563,11 +670,12 @@ list_pagination_hdr(clicon_handle h,
  * @param[in]  nsc     Namespace context of xpath
  * @param[in]  username
  * @param[in]  wdef   With-defaults parameter, see RFC 6243
+ * @param[in]  cursor  Cursor attribute: page starts after this entry, or NULL
  * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
  * @retval     0       OK
  * @retval    -1       Error
- * @note pagination uses appending xpath with predicate, eg [position()<limit], this may not work 
- *       if there is an existing predicate
+ * @note Without datastore cache, pagination appends a predicate to xpath, eg [position()<limit],
+ *       this may not work if there is an existing predicate, see xmldb_get_page
  * XXX Lots of this code (in particular at the end) is copy of get_common
  */
 static int
@@ -582,19 +690,19 @@ get_list_pagination(clicon_handle        h,
                     cvec                *nsc,
                     char                *username,
                     withdefaults_type    wdef,
+                    char                *cursor,
                     cbuf                *cbret
                     )
 {
     int             retval = -1;
     uint32_t        offset = 0;
     uint32_t        limit = 0;
-    cbuf           *cbpath = NULL;
+    cxobj          *xcursor = NULL;
     int             list_config;
     yang_stmt      *ylist;
     cxobj          *xerr = NULL;
     cbuf           *cbmsg = NULL; /* For error msg */
     cxobj          *xret = NULL;
-    char           *xpath2; /* With optional pagination predicate */
     int             ret;
     uint32_t        iddb; /* DBs lock, if any */
     int             locked;
@@ -673,39 +781,19 @@ get_list_pagination(clicon_handle        h,
     if (ret == 0)
         goto ok;
     /* Read config */
+    if (cursor && list_config){
+        if ((ret = list_pagination_cursor(ylist, cursor, &xcursor, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
     switch (content){
     case CONTENT_CONFIG:    /* config data only */
     case CONTENT_ALL:       /* both config and state */
-        /* Build a "predicate" cbuf 
-         * This solution uses xpath predicates to translate "limit" and "offset" to
-         * relational operators <>.
+        /* The page is found in the datastore cache, or with a positional predicate
          */
-        if ((cbpath = cbuf_new()) == NULL){
-            clicon_err(OE_UNIX, errno, "cbuf_new");
-            goto done;
-        }
-        /* This uses xpath. Maybe limit should use parameters */
-        if (xpath)
-            cprintf(cbpath, "%s", xpath);
-        else
-            cprintf(cbpath, "/");
-#ifdef NOTYET
-        if (where)
-            cprintf(cbpath, "[%s]", where);
-#endif
-        if (offset){
-            cprintf(cbpath, "[%u <= position()", offset);
-            if (limit)
-                cprintf(cbpath, " and position() < %u", limit+offset);
-            cprintf(cbpath, "]");
-        }
-        else if (limit)
-            cprintf(cbpath, "[position() < %u]", limit);
-
-        /* Append predicate to original xpath and replace it */
-        xpath2 = cbuf_get(cbpath);
-        /* specific xpath */
-        if (xmldb_get0(h, db, YB_MODULE, nsc, xpath2?xpath2:"/", 1, wdef, &xret, NULL, NULL) < 0) {
+        if ((ret = xmldb_get_page(h, db, nsc, xpath?xpath:"/", xcursor, offset, limit,
+                                  wdef, &xret, &xerr)) < 0) {
             if ((cbmsg = cbuf_new()) == NULL){
                 clicon_err(OE_UNIX, errno, "cbuf_new");
                 goto done;
@@ -715,6 +803,11 @@ get_list_pagination(clicon_handle        h,
                 goto done;
             goto ok;
         }
+        if (ret == 0){
+            if (clixon_xml2cbuf(cbret, xerr, 0, 0, NULL, -1, 0) < 0)
+                goto done;
+            goto ok;
+        }
         break;
     case CONTENT_NONCONFIG: /* state data only */
         if ((xret = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)/* Only top tree */
@@ -742,7 +835,7 @@ get_list_pagination(clicon_handle        h,
         else
             locked = 0;
         if ((ret = clixon_pagination_cb_call(h, xpath, locked,
-                                             offset, limit,
+                                             offset, limit, cursor,
                                              xret)) < 0)
             goto done;
         if (ret == 0){
@@ -799,7 +892,8 @@ get_list_pagination(clicon_handle        h,
             cbuf_free(cba);
     }
 #endif /* LIST_PAGINATION_REMAINING */
-    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, cbret) < 0)
+    if (get_nacm_and_reply(h, ce, &xret, xvec, xlen, xpath, nsc, username, depth,
+                           cbret) < 0)
         goto done;
  ok:
     retval = 0;
@@ -808,8 +902,8 @@ get_list_pagination(clicon_handle        h,
         free(xvec);
     if (cbmsg)
         cbuf_free(cbmsg);
-    if (cbpath)
-        cbuf_free(cbpath);
+    if (xcursor)
+        xml_free(xcursor);
     if (xerr)
         xml_free(xerr);
     if (cberr)
@@ -863,8 +957,11 @@ get_common(clicon_handle        h,
     cxobj          *xfind;
     uint32_t        offset = 0;
     uint32_t        limit = 0;
+    char           *cursor;
     withdefaults_type wdef;
     char             *wdefstr;
+    int             untrusted = 0; /* State trees to validate */
+    int32_t         copydepth;     /* Nr of levels to copy from datastore, -1 is all */
 
     wdef = WITHDEFAULTS_EXPLICIT;
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
@@ -907,6 +1004,8 @@ get_common(clicon_handle        h,
     }
     if ((wdefstr = xml_find_body(xe, "with-defaults")) != NULL) 
         wdef = withdefaults_str2int(wdefstr);
+    /* Clixon extensions: list pagination cursor */
+    cursor = xml_find_value(xe, "cursor");
     /* Check if list pagination */
     if ((xfind = xml_find_type(xe, NULL, "list-pagination", CX_ELMNT)) != NULL){
         /* with non-presence list-pagination, use ad-hoc algorithm to determine
@@ -921,7 +1020,13 @@ get_common(clicon_handle        h,
             goto done;
         if (ret == 0)
             goto ok;
-        list_pagination = (offset != 0 || limit != 0);
+        list_pagination = (offset != 0 || limit != 0 || cursor != NULL);
+    }
+    else if (cursor != NULL){
+        if (netconf_bad_attribute(cbret, "application",
+                                  "cursor", "Cursor attribute without list-pagination") < 0)
+            goto done;
+        goto ok;
     }
     /* Sanity check for list pagination: path must be a list/leaf-list, if it is,
      * check config/state
@@ -931,15 +1036,37 @@ get_common(clicon_handle        h,
                                 xfind,
                                 content, db,
                                 depth, yspec, xpath, nsc, username, wdef,
-                                cbret) < 0)
+                                cursor, cbret) < 0)
             goto done;
         goto ok;
     }
+    /* Nodes below depth are not copied, see xmldb_get_depth */
+    copydepth = get_copy_depth(h, xpath, depth);
     /* Read configuration */
     switch (content){
     case CONTENT_CONFIG:    /* config data only */
+        /* Without NACM and depth, print directly from the datastore cache */
+        if (depth < 0 && clicon_nacm_cache(h) == NULL &&
+            (ce == NULL || (!ce->ce_binary && !ce->ce_stream_chunk))){
+            cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+            if ((ret = xmldb_get_cbuf(h, db, nsc, xpath?xpath:"/", wdef, cbret, NULL)) < 0){
+                cbuf_reset(cbret);
+                if ((cbmsg = cbuf_new()) == NULL){
+                    clicon_err(OE_UNIX, errno, "cbuf_new");
+                    goto done;
+                }
+                cprintf(cbmsg, "Get %s datastore: %s", db, clicon_err_reason);
+                if (netconf_operation_failed(cbret, "application", cbuf_get(cbmsg)) < 0)
+                    goto done;
+                goto ok;
+            }
+            if (ret == 0)
+                cprintf(cbret, "<data/>");
+            cprintf(cbret, "</rpc-reply>");
+            goto ok;
+        }
         /* specific xpath */
-        if (xmldb_get0(h, db, YB_MODULE, nsc, xpath?xpath:"/", 1, wdef, &xret, NULL, NULL) < 0) {
+        if (xmldb_get_depth(h, db, nsc, xpath?xpath:"/", copydepth, wdef, &xret, NULL) < 0) {
             if ((cbmsg = cbuf_new()) == NULL){
                 clicon_err(OE_UNIX, errno, "cbuf_new");
                 goto done;
@@ -967,7 +1094,7 @@ get_common(clicon_handle        h,
         }
         else if (content == CONTENT_ALL){
             /* specific xpath */
-            if (xmldb_get0(h, db, YB_MODULE, nsc, xpath?xpath:"/", 1, wdef, &xret, NULL, NULL) < 0) {
+            if (xmldb_get_depth(h, db, nsc, xpath?xpath:"/", copydepth, wdef, &xret, NULL) < 0) {
                 if ((cbmsg = cbuf_new()) == NULL){
                     clicon_err(OE_UNIX, errno, "cbuf_new");
                     goto done;
@@ -992,7 +1119,7 @@ get_common(clicon_handle        h,
         break;
     case CONTENT_ALL:       /* both config and state */
     case CONTENT_NONCONFIG: /* state data only */
-        if ((ret = get_statedata(h, xpath?xpath:"/", nsc, wdef, &xret)) < 0)
+        if ((ret = get_statedata(h, xpath?xpath:"/", nsc, wdef, &untrusted, &xret)) < 0)
             goto done;
         if (ret == 0){ /* Error from callback (error in xret) */
             if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
@@ -1002,6 +1129,7 @@ get_common(clicon_handle        h,
         break;
     }
     if (content != CONTENT_CONFIG &&
+        untrusted > 0 &&    /* Not only state of trusted plugins, see ca_statedata_trusted */
         clicon_option_bool(h, "CLICON_VALIDATE_STATE_XML")){
         /* Check XML  by validating it. return internal error with error cause 
          * Primarily intended for user-supplied state-data.
@@ -1032,14 +1160,15 @@ get_common(clicon_handle        h,
             goto done;
         if (xml_tree_prune_flagged_sub(xret, XML_FLAG_MARK, 1, NULL) < 0)
             goto done;
-        if (xml_apply(xret, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
+        if (xml_flag_reset_rec(xret, XML_FLAG_MARK) < 0)
             goto done;
     }
     if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
         goto done;
     if (filter_xpath_again(h, yspec, xret, xvec, xlen, xpath, nsc) < 0)
         goto done;
-    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, cbret) < 0)
+    if (get_nacm_and_reply(h, ce, &xret, xvec, xlen, xpath, nsc, username, depth,
+                           cbret) < 0)
         goto done;
  ok:
     retval = 0;
@@ -1066,6 +1195,67 @@ get_common(clicon_handle        h,
     return retval;
 }
 
+/*! Get config and state data of running selected by xpath, eg a periodic push sample
+ *
+ * Same data as a get with both config and state, but not serialized
+ * @param[in]  h        Clixon handle
+ * @param[in]  xpath    XPath selection
+ * @param[in]  nsc      Namespace context of xpath
+ * @param[in]  username User name for NACM read access, or NULL
+ * @param[out] xret     Data tree with selected nodes, or rpc-error if 0. Free with xml_free
+ * @retval     1        OK
+ * @retval     0        State data callback failed, rpc-error in xret
+ * @retval    -1        Error
+ * @see get_common
+ */
+int
+backend_get_sample(clicon_handle h,
+                   char         *xpath,
+                   cvec         *nsc,
+                   char         *username,
+                   cxobj       **xret)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *xt = NULL;
+    cxobj    **xvec = NULL;
+    size_t     xlen;
+    cxobj     *xnacm;
+    int        ret;
+    int        untrusted;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if (xmldb_get0(h, "running", YB_MODULE, nsc, xpath, 1, WITHDEFAULTS_EXPLICIT, &xt, NULL, NULL) < 0)
+        goto done;
+    if ((ret = get_statedata(h, xpath, nsc, WITHDEFAULTS_EXPLICIT, &untrusted, &xt)) < 0)
+        goto done;
+    if (ret == 0){
+        *xret = xt;
+        xt = NULL;
+        retval = 0;
+        goto done;
+    }
+    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath) < 0)
+        goto done;
+    if (filter_xpath_again(h, yspec, xt, xvec, xlen, xpath, nsc) < 0)
+        goto done;
+    if (username && (xnacm = clicon_nacm_cache(h)) != NULL &&
+        nacm_datanode_read(h, xt, xvec, xlen, username, xnacm) < 0)
+        goto done;
+    *xret = xt;
+    xt = NULL;
+    retval = 1;
+ done:
+    if (xvec)
+        free(xvec);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
 /*! Retrieve all or part of a specified configuration.
  * 
  * @param[in]  h       Clicon handle 
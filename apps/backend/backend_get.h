@@ -42,6 +42,7 @@
  */ 
 int from_client_get_config(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 int from_client_get(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
+int backend_get_sample(clicon_handle h, char *xpath, cvec *nsc, char *username, cxobj **xret);
 int from_client_get_pageable_list(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg); /* XXX */
 
 #endif  /* _BACKEND_GET_H_ */
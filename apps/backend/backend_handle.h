@@ -51,6 +51,8 @@ struct client_entry *backend_client_add(clicon_handle h, struct sockaddr *addr);
 
 struct client_entry *backend_client_list(clicon_handle h);
 
+struct client_entry *backend_client_find(clicon_handle h, uint32_t id);
+
 int backend_client_delete(clicon_handle h, struct client_entry *ce);
 
 int backend_client_print(clicon_handle h, FILE *f);
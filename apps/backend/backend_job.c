@@ -0,0 +1,584 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+  Asynchronous commits with job handles, see the clixon-lib commit-async rpc
+  The candidate is copied to a job datastore "commit-job-<id>" and validated synchronously,
+  and the client gets the job id in the reply. The job is then committed from the event
+  loop after the reply is sent, ie plugin commit callbacks are called without a client
+  waiting. Jobs are committed one at a time in the order they were submitted, and queued
+  jobs are committed before any other commit, so that commits stay in order.
+  With CLICON_BACKEND_COMMIT_READER, other clients read the old running meanwhile.
+  When a job is done, a commit-job-done notification is sent on the CLIXON-COMMIT stream,
+  see CLICON_STREAM_COMMIT, and its state can be read with the commit-job-status rpc.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+#include "clixon_backend_client.h"
+#include "clixon_backend_commit.h"
+#include "backend_job.h"
+
+#define JOB_STATE_NAME "commit-job-state"
+
+/* Number of done jobs whose state is kept for commit-job-status */
+#define JOB_HISTORY 16
+
+enum job_status{
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_COMPLETED,
+    JOB_ABORTED,
+};
+
+static const map_str2int job_status_map[] = {
+    {"queued",    JOB_QUEUED},
+    {"running",   JOB_RUNNING},
+    {"completed", JOB_COMPLETED},
+    {"aborted",   JOB_ABORTED},
+    {NULL,        -1}
+};
+
+/* Commit job
+ */
+struct commit_job{
+    struct commit_job *cj_next;
+    uint32_t           cj_id;      /* Job id */
+    uint32_t           cj_session; /* Session id of client */
+    enum job_status    cj_status;
+    char              *cj_db;      /* Job datastore, copy of candidate, NULL when done */
+    uint64_t           cj_base;    /* Version of candidate when copied */
+    uint64_t           cj_version; /* Version of running after commit */
+    char              *cj_reason;  /* Error message if aborted */
+};
+
+/* Commit jobs of handle, in submit order
+ */
+struct job_state{
+    struct commit_job  *js_jobs;
+    struct commit_job **js_last;
+    uint32_t            js_id;      /* Last job id */
+    int                 js_running; /* A job is being committed */
+    int                 js_timer;   /* Timeout is registered */
+};
+
+static int job_timeout(int fd, void *arg);
+
+/*! Get commit job state of handle
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  create  Create state if not found
+ * @retval     js      Job state
+ * @retval     NULL    Not found, or error if create
+ */
+static struct job_state *
+job_state_get(clicon_handle h,
+              int           create)
+{
+    struct job_state *js = NULL;
+
+    if (clicon_ptr_get(h, JOB_STATE_NAME, (void**)&js) == 0 && js != NULL)
+        return js;
+    if (!create)
+        return NULL;
+    if ((js = calloc(1, sizeof(*js))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    js->js_last = &js->js_jobs;
+    if (clicon_ptr_set(h, JOB_STATE_NAME, js) < 0){
+        free(js);
+        return NULL;
+    }
+    return js;
+}
+
+/*! Free a job and remove its job datastore
+ *
+ * @param[in]  h   Clixon handle
+ * @param[in]  cj  Job, not in list
+ */
+static void
+job_free(clicon_handle      h,
+         struct commit_job *cj)
+{
+    if (cj->cj_db){
+        (void)xmldb_delete(h, cj->cj_db);
+        free(cj->cj_db);
+    }
+    if (cj->cj_reason)
+        free(cj->cj_reason);
+    free(cj);
+}
+
+/*! Remove the oldest done jobs beyond JOB_HISTORY
+ *
+ * @param[in]  h   Clixon handle
+ * @param[in]  js  Job state
+ */
+static void
+job_prune(clicon_handle     h,
+          struct job_state *js)
+{
+    struct commit_job  *cj;
+    struct commit_job **cjp;
+    int                 nr = 0;
+
+    for (cj = js->js_jobs; cj; cj = cj->cj_next)
+        if (cj->cj_status == JOB_COMPLETED || cj->cj_status == JOB_ABORTED)
+            nr++;
+    cjp = &js->js_jobs;
+    while (nr > JOB_HISTORY && (cj = *cjp) != NULL){
+        if (cj->cj_status != JOB_COMPLETED && cj->cj_status != JOB_ABORTED){
+            cjp = &cj->cj_next;
+            continue;
+        }
+        *cjp = cj->cj_next;
+        job_free(h, cj);
+        nr--;
+    }
+    /* Last may be removed */
+    js->js_last = &js->js_jobs;
+    while (*js->js_last)
+        js->js_last = &(*js->js_last)->cj_next;
+}
+
+/*! Get error message of a failed commit
+ *
+ * @param[in]  cbret   Reply with rpc-error, or empty
+ * @param[out] reason  Malloced error message
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+job_reason(cbuf  *cbret,
+           char **reason)
+{
+    int    retval = -1;
+    cxobj *xt = NULL;
+    cxobj *xm;
+    char  *str = clicon_err_reason;
+
+    if (cbuf_len(cbret) &&
+        clixon_xml_parse_string(cbuf_get(cbret), YB_NONE, NULL, &xt, NULL) > 0 &&
+        (xm = xpath_first(xt, NULL, "//error-message")) != NULL &&
+        xml_body(xm) != NULL)
+        str = xml_body(xm);
+    if ((*reason = strdup(str)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Send notification that a job is done on the CLIXON-COMMIT stream, if it exists
+ *
+ * @param[in]  h   Clixon handle
+ * @param[in]  cj  Job
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+job_notify(clicon_handle      h,
+           struct commit_job *cj)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if (stream_find(h, CLIXON_COMMIT_STREAM) == NULL)
+        return 0;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<commit-job-done xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cb, "<job-id>%" PRIu32 "</job-id>", cj->cj_id);
+    cprintf(cb, "<session-id>%" PRIu32 "</session-id>", cj->cj_session);
+    cprintf(cb, "<status>%s</status>", clicon_int2str(job_status_map, cj->cj_status));
+    if (cj->cj_status == JOB_COMPLETED)
+        cprintf(cb, "<version>%" PRIu64 "</version>", cj->cj_version);
+    if (cj->cj_reason){
+        cprintf(cb, "<error-message>");
+        if (xml_chardata_cbuf_append(cb, cj->cj_reason) < 0)
+            goto done;
+        cprintf(cb, "</error-message>");
+    }
+    cprintf(cb, "</commit-job-done>");
+    if (stream_notify(h, CLIXON_COMMIT_STREAM, "%s", cbuf_get(cb)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Commit the first queued job
+ *
+ * If the candidate has not been changed since it was copied, it is now equal to running
+ * @param[in]  h   Clixon handle
+ * @param[in]  js  Job state
+ * @param[in]  cj  Queued job
+ * @retval     0   OK, job is done, see its status
+ * @retval    -1   Error
+ */
+static int
+job_run(clicon_handle      h,
+        struct job_state  *js,
+        struct commit_job *cj)
+{
+    int      retval = -1;
+    cbuf    *cbret = NULL;
+    uint64_t version;
+    int      ret;
+
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s %" PRIu32, __FUNCTION__, cj->cj_id);
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cj->cj_status = JOB_RUNNING;
+    js->js_running = 1;
+    ret = candidate_commit(h, NULL, cj->cj_db, cj->cj_session, 0, cbret);
+    js->js_running = 0;
+    if (ret == 1){
+        cj->cj_status = JOB_COMPLETED;
+        if (xmldb_version_get(h, "running", &cj->cj_version, NULL) < 0)
+            goto done;
+        if (xmldb_version_get(h, "candidate", &version, NULL) < 0)
+            goto done;
+        if (version == cj->cj_base){
+            if (xmldb_delta_set(h, "candidate", "running") < 0)
+                goto done;
+            xmldb_modified_set(h, "candidate", 0);
+        }
+    }
+    else {
+        cj->cj_status = JOB_ABORTED;
+        if (job_reason(cbret, &cj->cj_reason) < 0)
+            goto done;
+        clicon_log(LOG_NOTICE, "Commit job %" PRIu32 " aborted: %s", cj->cj_id, cj->cj_reason);
+    }
+    if (xmldb_delete(h, cj->cj_db) < 0)
+        goto done;
+    free(cj->cj_db);
+    cj->cj_db = NULL;
+    if (job_notify(h, cj) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cbret)
+        cbuf_free(cbret);
+    return retval;
+}
+
+/*! Find first queued job
+ */
+static struct commit_job *
+job_queued(struct job_state *js)
+{
+    struct commit_job *cj;
+
+    for (cj = js->js_jobs; cj; cj = cj->cj_next)
+        if (cj->cj_status == JOB_QUEUED)
+            break;
+    return cj;
+}
+
+/*! Register timeout to commit the next queued job from the event loop
+ *
+ * @param[in]  h   Clixon handle
+ * @param[in]  js  Job state
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+job_schedule(clicon_handle     h,
+             struct job_state *js)
+{
+    struct timeval t;
+
+    if (js->js_timer || job_queued(js) == NULL)
+        return 0;
+    gettimeofday(&t, NULL);
+    if (clixon_event_reg_timeout(t, job_timeout, h, "commit job") < 0)
+        return -1;
+    js->js_timer = 1;
+    return 0;
+}
+
+/*! Commit the next queued job, one job per event so that clients are served in between
+ *
+ * @param[in]  fd   No-op
+ * @param[in]  arg  Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+job_timeout(int   fd,
+            void *arg)
+{
+    clicon_handle      h = (clicon_handle)arg;
+    struct job_state  *js;
+    struct commit_job *cj;
+
+    if ((js = job_state_get(h, 0)) == NULL)
+        return 0;
+    js->js_timer = 0;
+    if ((cj = job_queued(js)) != NULL && job_run(h, js, cj) < 0)
+        return -1;
+    job_prune(h, js);
+    return job_schedule(h, js);
+}
+
+/*! Commit all queued jobs, before another commit
+ *
+ * Called by candidate_commit, so that commits are made in order
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+backend_job_drain(clicon_handle h)
+{
+    struct job_state  *js;
+    struct commit_job *cj;
+
+    if ((js = job_state_get(h, 0)) == NULL || js->js_running)
+        return 0;
+    while ((cj = job_queued(js)) != NULL)
+        if (job_run(h, js, cj) < 0)
+            return -1;
+    if (js->js_timer){
+        clixon_event_unreg_timeout(job_timeout, h);
+        js->js_timer = 0;
+    }
+    job_prune(h, js);
+    return 0;
+}
+
+/*! Validate candidate and queue a commit job, reply with the job id
+ *
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see from_client_commit  for the checks made before a commit
+ */
+int
+from_client_commit_async(clicon_handle h,
+                         cxobj        *xe,
+                         cbuf         *cbret,
+                         void         *arg,
+                         void         *regarg)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    struct job_state    *js;
+    struct commit_job   *cj = NULL;
+    uint32_t             iddb;
+    cbuf                *cb = NULL;
+    int                  ret;
+
+    if (clicon_data_int_get(h, "backend-standby") == 1){
+        if (netconf_operation_failed(cbret, "application", "Backend is standby") < 0)
+            goto done;
+        goto ok;
+    }
+    if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE")){
+        if (netconf_operation_not_supported(cbret, "application",
+                                            "Asynchronous commit of private candidate") < 0)
+            goto done;
+        goto ok;
+    }
+    iddb = xmldb_islocked(h, "running");
+    if (iddb && ce->ce_id != iddb){
+        if (netconf_in_use(cbret, "protocol", "Operation failed, lock is already held") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((js = job_state_get(h, 1)) == NULL)
+        goto done;
+    if ((cj = calloc(1, sizeof(*cj))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    cj->cj_id = ++js->js_id;
+    cj->cj_session = ce->ce_id;
+    cj->cj_status = JOB_QUEUED;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "commit-job-%" PRIu32, cj->cj_id);
+    if ((cj->cj_db = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    /* Validate the copy, so that the commit need not validate it again if running is
+     * unchanged, see validate_cache_check */
+    if (xmldb_version_get(h, "candidate", &cj->cj_base, NULL) < 0)
+        goto done;
+    if (xmldb_copy(h, "candidate", cj->cj_db) < 0)
+        goto done;
+    if ((ret = candidate_validate(h, cj->cj_db, cbret)) < 0)
+        goto done;
+    if (ret == 0) /* cbret set */
+        goto ok;
+    *js->js_last = cj;
+    js->js_last = &cj->cj_next;
+    if (job_schedule(h, js) < 0){
+        cj = NULL;
+        goto done;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><job-id xmlns=\"%s\">%" PRIu32 "</job-id></rpc-reply>",
+            NETCONF_BASE_NAMESPACE, CLIXON_LIB_NS, cj->cj_id);
+    cj = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (cj)
+        job_free(h, cj);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Get state of commit jobs, queued and recently done
+ *
+ * @param[in]  h       Clixon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+from_client_commit_job_status(clicon_handle h,
+                              cxobj        *xe,
+                              cbuf         *cbret,
+                              void         *arg,
+                              void         *regarg)
+{
+    int                retval = -1;
+    struct job_state  *js;
+    struct commit_job *cj;
+    char              *str;
+    uint32_t           id = 0;
+    int                ret;
+
+    if ((str = xml_find_body(xe, "job-id")) != NULL){
+        if ((ret = netconf_parse_uint32("job-id", str, NULL, 0, cbret, &id)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    if ((js = job_state_get(h, 0)) != NULL)
+        for (cj = js->js_jobs; cj; cj = cj->cj_next){
+            if (id && cj->cj_id != id)
+                continue;
+            cprintf(cbret, "<job xmlns=\"%s\">", CLIXON_LIB_NS);
+            cprintf(cbret, "<job-id>%" PRIu32 "</job-id>", cj->cj_id);
+            cprintf(cbret, "<session-id>%" PRIu32 "</session-id>", cj->cj_session);
+            cprintf(cbret, "<status>%s</status>", clicon_int2str(job_status_map, cj->cj_status));
+            if (cj->cj_status == JOB_COMPLETED)
+                cprintf(cbret, "<version>%" PRIu64 "</version>", cj->cj_version);
+            if (cj->cj_reason){
+                cprintf(cbret, "<error-message>");
+                if (xml_chardata_cbuf_append(cbret, cj->cj_reason) < 0)
+                    goto done;
+                cprintf(cbret, "</error-message>");
+            }
+            cprintf(cbret, "</job>");
+        }
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free commit jobs at exit, queued jobs are not committed
+ *
+ * Called after the datastores are disconnected, job datastores are not deleted
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ */
+int
+backend_job_free(clicon_handle h)
+{
+    struct job_state  *js;
+    struct commit_job *cj;
+
+    if ((js = job_state_get(h, 0)) == NULL)
+        return 0;
+    if (js->js_timer)
+        clixon_event_unreg_timeout(job_timeout, h);
+    while ((cj = js->js_jobs) != NULL){
+        js->js_jobs = cj->cj_next;
+        if (cj->cj_db){
+            free(cj->cj_db);
+            cj->cj_db = NULL;
+        }
+        job_free(h, cj);
+    }
+    free(js);
+    clicon_ptr_del(h, JOB_STATE_NAME);
+    return 0;
+}
@@ -77,6 +77,11 @@
 #include "backend_handle.h"
 #include "backend_startup.h"
 #include "backend_plugin_restconf.h"
+#include "backend_stats.h"
+#include "backend_push.h"
+#include "backend_private.h"
+#include "backend_standby.h"
+#include "backend_job.h"
 
 /* Command line options to be passed to getopt(3) */
 #define BACKEND_OPTS "hD:f:E:l:C:d:p:b:Fza:u:P:1qs:c:U:g:y:o:"
@@ -127,6 +132,16 @@ backend_terminate(clicon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     confirmed_commit_free(h);
+    commit_stats_free(h);
+    rpc_stats_free(h);
+    sched_stats_free(h);
+    backend_push_free(h);
+    backend_private_free(h);
+    backend_standby_free(h);
+    backend_job_free(h);
+    backend_schema_cache_free();
+    netconf_monitoring_schemas_free();
+    clixon_plugin_statedata_cache_free(h);
     stream_publish_exit();
     /* Delete all plugins, RPC callbacks, and upgrade callbacks */
     clixon_plugin_module_exit(h);
@@ -134,7 +149,13 @@ backend_terminate(clicon_handle h)
     clixon_process_delete_all(h); 
 
     xpath_optimize_exit();
+    xpath_cache_exit();
+    api_path_cache_exit();
+    xml_nsid_exit();
+    nacm_ruleset_free(h);
     clixon_pagination_free(h);
+    clixon_statedata_subtree_free(h);
+    plugin_transaction_subtree_free(h);
     
     if (pidfile)
         unlink(pidfile);   
@@ -143,6 +164,7 @@ backend_terminate(clicon_handle h)
     backend_handle_exit(h); /* Also deletes streams. Cannot use h after this. */
     clixon_event_exit();
     clicon_debug(1, "%s done", __FUNCTION__); 
+    clixon_pool_exit();
     clixon_err_exit();
     clicon_log_exit();
     return 0;
@@ -256,6 +278,8 @@ xmldb_drop_priv(clicon_handle h,
 {
     int         retval = -1;
     char       *filename = NULL;
+    char       *dir = NULL;
+    struct stat st;
 
     if (xmldb_db2file(h, db, &filename) < 0)
         goto done;
@@ -263,10 +287,19 @@ xmldb_drop_priv(clicon_handle h,
         clicon_err(OE_UNIX, errno, "chown");
         goto done;
     }
+    /* Split datastore directory, see CLICON_XMLDB_SPLIT */
+    if (xmldb_db2dir(h, db, &dir) < 0)
+        goto done;
+    if (stat(dir, &st) == 0 && chown(dir, uid, gid) < 0){
+        clicon_err(OE_UNIX, errno, "chown");
+        goto done;
+    }
     retval = 0;
  done:
     if (filename)
         free(filename);
+    if (dir)
+        free(dir);
     return retval;
 }
 
@@ -517,6 +550,7 @@ main(int    argc,
     yang_stmt    *yspec = NULL;
     char         *str;
     int           ss = -1; /* server socket */
+    int           fd;
     cbuf         *cbret = NULL; /* startup cbuf if invalid */
     enum startup_status status = STARTUP_ERR; /* Startup status */
     int           ret;
@@ -528,6 +562,7 @@ main(int    argc,
     int           dbg;
     size_t        sz;
     int           config_dump;
+    int           cached;
     enum format_enum config_dump_format = FORMAT_XML;
     
     /* In the startup, logs to stderr & syslog and debug flag set later */
@@ -721,12 +756,20 @@ main(int    argc,
 
     if ((sz = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clicon_log_string_limit_set(sz);
+    if ((sz = clicon_option_int(h, "CLICON_LOG_RATE_LIMIT")) != 0)
+        clicon_log_rate_limit_set(sz);
     
 #ifndef HAVE_LIBXML2
     if (clicon_yang_regexp(h) ==  REGEXP_LIBXML2){
         clicon_err(OE_FATAL, 0, "CLICON_YANG_REGEXP set to libxml2, but HAVE_LIBXML2 not set (Either change CLICON_YANG_REGEXP to posix, or run: configure --with-libxml2))");
         goto done;
     }
+#endif
+#ifndef HAVE_LIBPCRE2_8
+    if (clicon_yang_regexp(h) ==  REGEXP_PCRE2){
+        clicon_err(OE_FATAL, 0, "CLICON_YANG_REGEXP set to pcre2, but HAVE_LIBPCRE2_8 not set (Either change CLICON_YANG_REGEXP to posix, or run: configure --with-pcre2))");
+        goto done;
+    }
 #endif
     /* Check pid-file, if zap kil the old daemon, else return here */
     if ((pidfile = clicon_backend_pidfile(h)) == NULL){
@@ -786,9 +829,29 @@ main(int    argc,
     if (clicon_option_exists(h, "CLICON_STREAM_PUB") &&
         stream_publish_init() < 0)
         goto done;
+    /* Internal stream of datastore changes, see backend_push_changed */
+    if (clicon_option_bool(h, "CLICON_STREAM_DATASTORE") &&
+        stream_add(h, CLIXON_DATASTORE_STREAM, "Clixon datastore changes after commit", 0, NULL) < 0)
+        goto done;
+    /* Internal stream of commit changes for standby backends, see backend_push_journal */
+    if (clicon_option_bool(h, "CLICON_STREAM_JOURNAL") &&
+        stream_add(h, CLIXON_JOURNAL_STREAM, "Clixon journal records after commit", 0, NULL) < 0)
+        goto done;
+    /* Internal stream of asynchronous commit jobs done, see from_client_commit_async */
+    if (clicon_option_bool(h, "CLICON_STREAM_COMMIT") &&
+        stream_add(h, CLIXON_COMMIT_STREAM, "Clixon commit jobs done", 0, NULL) < 0)
+        goto done;
     /* Connect to plugin to get a handle */
     if (xmldb_connect(h) < 0)
         goto done;
+    /* Parse startup in a thread while plugins and yangs are loaded, see CLICON_XMLDB_PREFETCH */
+    if (clicon_option_bool(h, "CLICON_XMLDB_PREFETCH")){
+        startup_mode = clicon_startup_mode(h);
+        if ((startup_mode == SM_STARTUP ||
+             (startup_mode == SM_RUNNING_STARTUP && xmldb_exists(h, "running") != 1)) &&
+            xmldb_prefetch_start(h, "startup") < 0)
+            goto done;
+    }
 
     /* Set default namespace according to CLICON_NAMESPACE_NETCONF_DEFAULT */
     xml_nsctx_namespace_netconf_default(h);
@@ -821,6 +884,9 @@ main(int    argc,
                             clicon_option_str(h, "CLICON_BACKEND_REGEXP")) < 0)
         goto done;
 
+    /* Load yang spec from cache if valid, then the modules below are already loaded */
+    if ((cached = yang_spec_cache_load(h, "backend", yspec)) < 0)
+        goto done;
     /* Load Yang modules
      * 1. Load a yang module as a specific absolute filename */
     if ((str = clicon_yang_main_file(h)) != NULL)
@@ -852,6 +918,9 @@ main(int    argc,
     if (clicon_option_bool(h, "CLICON_XMLDB_MODSTATE") &&
         yang_spec_parse_module(h, "ietf-yang-library", NULL, yspec)< 0)
         goto done;
+    if (cached == 0 &&
+        yang_spec_cache_save(h, "backend", yspec) < 0)
+        goto done;
     /* Check restconf start/stop from backend */
     if (clicon_option_bool(h, "CLICON_BACKEND_RESTCONF_PROCESS")){
         if (backend_plugin_restconf_register(h, yspec) < 0)
@@ -868,6 +937,9 @@ main(int    argc,
     /* Initialize server socket and save it to handle */
     if (backend_rpc_init(h) < 0)
         goto done;
+    /* Interactive requests at safe points of long RPCs, see CLICON_BACKEND_YIELD_INTERVAL */
+    if (backend_client_yield_init(h) < 0)
+        goto done;
 
     /* Must be after netconf_module_load, but before startup code */
     if (clicon_option_bool(h, "CLICON_XML_CHANGELOG"))
@@ -957,6 +1029,11 @@ main(int    argc,
     default:
         break;  
     }
+    /* Free prefetched startup if not used */
+    xmldb_prefetch_exit(h);
+    /* Startup and tmp caches may exceed budget, see CLICON_DATASTORE_CACHE_BUDGET */
+    if (xmldb_cache_evict(h) < 0)
+        goto done;
     /* Quit after upgrade catch-all, running/startup quits in upgrade code */
     if (clicon_quit_upgrade_get(h) == 1)
         goto done;
@@ -1001,6 +1078,9 @@ main(int    argc,
         goto done;
     if (xmldb_modified_set(h, "candidate", 0) <0)
         goto done;
+    /* Publish running to local frontends, see CLICON_XMLDB_SNAPSHOT */
+    if (xmldb_snapshot_write(h, "running") < 0)
+        goto done;
     
     /* Set startup status */
     if (clicon_startup_status_set(h, status) < 0)
@@ -1010,7 +1090,10 @@ main(int    argc,
         clicon_log(LOG_NOTICE, "%s: %u %s", __PROGRAM__, getpid(), cbuf_get(cbret));
         
     /* Call backend plugin_start with user -- options */
-    if (clixon_plugin_start_all(h) < 0)
+    if (clixon_plugin_start_backend_all(h) < 0)
+        goto done;
+    /* Replicate running from an active backend, see CLICON_BACKEND_STANDBY */
+    if (backend_standby_start(h) < 0)
         goto done;
     /* Explicit dump of config (also debug dump below). */
     if (config_dump){
@@ -1032,6 +1115,9 @@ main(int    argc,
         /* Call plugin callbacks just before fork/daemonization */
         if (clixon_plugin_pre_daemon_all(h) < 0)
             goto done;
+        /* Writer thread does not survive fork, restarted on demand after */
+        if (xmldb_async_exit(h) < 0)
+            goto done;
         clicon_log_init(__PROGRAM__, dbg?LOG_DEBUG:LOG_INFO,
                         logdst==CLICON_LOG_FILE?CLICON_LOG_FILE:CLICON_LOG_SYSLOG);
         if (daemon(0, 0) < 0){
@@ -1044,6 +1130,10 @@ main(int    argc,
      */
     if (clixon_plugin_daemon_all(h) < 0)
         goto done;
+    /* After daemonization, since queued log messages do not survive fork */
+    if (clicon_option_bool(h, "CLICON_LOG_ASYNC") &&
+        clicon_log_async(1) < 0)
+        goto done;
 
     /* Write pid-file */
     if (pidfile_write(pidfile) <  0)
@@ -1072,6 +1162,13 @@ main(int    argc,
         goto done;
     if (clicon_socket_set(h, ss) < 0)
         goto done;
+    /* Send commit replies deferred until datastore writes are durable */
+    if (clicon_xmldb_async(h) == XMLDB_ASYNC_REPLY_AFTER){
+        if ((fd = xmldb_async_fd(h)) < 0)
+            goto done;
+        if (clixon_event_reg_fd(fd, backend_async_reply, h, "datastore writer") < 0)
+            goto done;
+    }
 
     /* Depending on configure setting, privileges may be dropped here after
      * initializations */
@@ -44,15 +44,23 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <ctype.h>
 #include <dlfcn.h>
 #include <unistd.h>
 #include <errno.h>
 #include <signal.h>
 #include <syslog.h>
+#include <time.h>
+#include <inttypes.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <sys/param.h>
 #include <netinet/in.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -63,6 +71,7 @@
 #include "clixon_backend_transaction.h"
 #include "clixon_backend_plugin.h"
 #include "clixon_backend_commit.h"
+#include "backend_stats.h"
 
 /*! Request plugins to reset system state
  *
@@ -80,13 +89,18 @@ clixon_plugin_reset_one(clixon_plugin_t *cp,
 {
     int         retval = -1;
     plgreset_t *fn;       /* callback */
+    uint64_t    t0;
+    int         ret;
     void       *wh = NULL;
 
     if ((fn = clixon_plugin_api_get(cp)->ca_reset) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
-        if (fn(h, db) < 0) {
+        t0 = clixon_plugin_call_start();
+        ret = fn(h, db);
+        clixon_plugin_call_stats(h, cp, PC_RESET, t0);
+        if (ret < 0) {
             if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
                 goto done;
             if (clicon_errno < 0) 
@@ -141,13 +155,18 @@ clixon_plugin_pre_daemon_one(clixon_plugin_t *cp,
 {
     int          retval = -1;
     plgdaemon_t *fn;          /* Daemonize plugin callback function */
+    uint64_t     t0;
+    int          ret;
     void        *wh = NULL;
 
     if ((fn = clixon_plugin_api_get(cp)->ca_pre_daemon) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
-        if (fn(h) < 0) {
+        t0 = clixon_plugin_call_start();
+        ret = fn(h);
+        clixon_plugin_call_stats(h, cp, PC_PRE_DAEMON, t0);
+        if (ret < 0) {
             if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
                 goto done;
             if (clicon_errno < 0)
@@ -203,13 +222,18 @@ clixon_plugin_daemon_one(clixon_plugin_t *cp,
 {
     int          retval = -1;
     plgdaemon_t *fn;          /* Daemonize plugin callback function */    
+    uint64_t     t0;
+    int          ret;
     void        *wh = NULL;
 
     if ((fn = clixon_plugin_api_get(cp)->ca_daemon) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
-        if (fn(h) < 0) {
+        t0 = clixon_plugin_call_start();
+        ret = fn(h);
+        clixon_plugin_call_stats(h, cp, PC_DAEMON, t0);
+        if (ret < 0) {
             if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
                 goto done;
             if (clicon_errno < 0) 
@@ -287,6 +311,8 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
 {
     int              retval = -1;
     plgstatedata_t  *fn;          /* Plugin statedata fn */
+    uint64_t         t0;
+    int              ret;
     cxobj           *x = NULL;
     void            *wh = NULL;
     
@@ -296,7 +322,10 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
-        if (fn(h, nsc, xpath, x) < 0){
+        t0 = clixon_plugin_call_start();
+        ret = fn(h, nsc, xpath, x);
+        clixon_plugin_call_stats(h, cp, PC_STATEDATA, t0);
+        if (ret < 0){
             if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
                 goto done;
             if (clicon_errno < 0) 
@@ -317,6 +346,608 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
     goto done;
 }
 
+/*
+ * State data cache, see ca_statedata_ttl
+ * State trees of a plugin are cached per xpath and namespace context, bound to yang and
+ * sorted. Expired entries are removed when the cache is searched.
+ */
+/* Handle data name of state data cache */
+#define STATEDATA_CACHE_NAME "statedata-cache"
+
+/*! Cached state tree of a plugin for one xpath and namespace context
+ */
+struct statedata_entry {
+    struct statedata_entry *se_next;
+    clixon_plugin_t        *se_cp;
+    char                   *se_key;    /* Xpath and namespace context, see statedata_cache_key */
+    cxobj                  *se_x;      /* State tree, or NULL if empty */
+    struct timespec         se_expire; /* Monotonic time when entry expires */
+};
+
+/*! Hit and miss counters of a plugin
+ */
+struct statedata_stats {
+    struct statedata_stats *ss_next;
+    clixon_plugin_t        *ss_cp;
+    uint64_t                ss_hits;
+    uint64_t                ss_misses;
+};
+
+struct statedata_cache {
+    struct statedata_entry *sc_entries;
+    struct statedata_stats *sc_stats;
+};
+
+/*! Get state data cache of handle, create if not found
+ */
+static struct statedata_cache *
+statedata_cache_get_create(clicon_handle h)
+{
+    struct statedata_cache *sc = NULL;
+
+    if (clicon_ptr_get(h, STATEDATA_CACHE_NAME, (void**)&sc) == 0 && sc != NULL)
+        return sc;
+    if ((sc = calloc(1, sizeof(*sc))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    if (clicon_ptr_set(h, STATEDATA_CACHE_NAME, sc) < 0){
+        free(sc);
+        return NULL;
+    }
+    return sc;
+}
+
+/*! Get hit and miss counters of a plugin, create if not found
+ */
+static struct statedata_stats *
+statedata_stats_get(struct statedata_cache *sc,
+                    clixon_plugin_t        *cp)
+{
+    struct statedata_stats *ss;
+
+    for (ss = sc->sc_stats; ss; ss = ss->ss_next)
+        if (ss->ss_cp == cp)
+            return ss;
+    if ((ss = calloc(1, sizeof(*ss))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    ss->ss_cp = cp;
+    ss->ss_next = sc->sc_stats;
+    sc->sc_stats = ss;
+    return ss;
+}
+
+static void
+statedata_entry_free(struct statedata_entry *se)
+{
+    if (se->se_key)
+        free(se->se_key);
+    if (se->se_x)
+        xml_free(se->se_x);
+    free(se);
+}
+
+/*! Make cache key of a state data request
+ *
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[in]  xpath  Xpath, or NULL
+ * @retval     key    Malloced key string
+ * @retval     NULL   Error
+ */
+static char *
+statedata_cache_key(cvec *nsc,
+                    char *xpath)
+{
+    cbuf   *cb;
+    cg_var *cv = NULL;
+    char   *key = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        return NULL;
+    }
+    cprintf(cb, "%s", xpath?xpath:"/");
+    while ((cv = cvec_each(nsc, cv)) != NULL)
+        cprintf(cb, " %s=%s", cv_name_get(cv)?cv_name_get(cv):"", cv_string_get(cv));
+    if ((key = strdup(cbuf_get(cb))) == NULL)
+        clicon_err(OE_UNIX, errno, "strdup");
+    cbuf_free(cb);
+    return key;
+}
+
+/*! Look up state tree of a plugin in the cache, and remove expired entries
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  cp   Plugin
+ * @param[in]  key  Cache key, see statedata_cache_key
+ * @param[out] xp   Copy of cached state tree, or NULL if cached as empty
+ * @retval     1    Found
+ * @retval     0    Not found
+ * @retval    -1    Error
+ */
+static int
+statedata_cache_lookup(clicon_handle    h,
+                       clixon_plugin_t *cp,
+                       char            *key,
+                       cxobj          **xp)
+{
+    struct statedata_cache  *sc;
+    struct statedata_stats  *ss;
+    struct statedata_entry **sep;
+    struct statedata_entry  *se;
+    struct timespec          now;
+
+    if ((sc = statedata_cache_get_create(h)) == NULL ||
+        (ss = statedata_stats_get(sc, cp)) == NULL)
+        return -1;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    sep = &sc->sc_entries;
+    while ((se = *sep) != NULL){
+        if (se->se_expire.tv_sec < now.tv_sec ||
+            (se->se_expire.tv_sec == now.tv_sec && se->se_expire.tv_nsec <= now.tv_nsec)){
+            *sep = se->se_next;
+            statedata_entry_free(se);
+            continue;
+        }
+        if (se->se_cp == cp && strcmp(se->se_key, key) == 0)
+            break;
+        sep = &se->se_next;
+    }
+    if (se == NULL){
+        ss->ss_misses++;
+        return 0;
+    }
+    ss->ss_hits++;
+    *xp = NULL;
+    if (se->se_x && (*xp = xml_dup(se->se_x)) == NULL)
+        return -1;
+    return 1;
+}
+
+/*! Add state tree of a plugin to the cache
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  cp   Plugin
+ * @param[in]  key  Cache key, see statedata_cache_key
+ * @param[in]  x    State tree, copied, or NULL if empty
+ * @param[in]  ttl  Time to live in milliseconds
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+statedata_cache_add(clicon_handle    h,
+                    clixon_plugin_t *cp,
+                    char            *key,
+                    cxobj           *x,
+                    uint32_t         ttl)
+{
+    struct statedata_cache *sc;
+    struct statedata_entry *se;
+
+    if ((sc = statedata_cache_get_create(h)) == NULL)
+        return -1;
+    if ((se = calloc(1, sizeof(*se))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return -1;
+    }
+    se->se_cp = cp;
+    if ((se->se_key = strdup(key)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        free(se);
+        return -1;
+    }
+    if (x && (se->se_x = xml_dup(x)) == NULL){
+        statedata_entry_free(se);
+        return -1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &se->se_expire);
+    se->se_expire.tv_sec += ttl/1000;
+    se->se_expire.tv_nsec += (ttl%1000)*1000000;
+    if (se->se_expire.tv_nsec >= 1000000000){
+        se->se_expire.tv_sec++;
+        se->se_expire.tv_nsec -= 1000000000;
+    }
+    se->se_next = sc->sc_entries;
+    sc->sc_entries = se;
+    return 0;
+}
+
+/*! Invalidate cached state data of a plugin, or of all plugins
+ *
+ * A plugin with ca_statedata_ttl set calls this when its state has changed, so that the
+ * next get calls its statedata callback.
+ * @param[in]  h     Clixon handle
+ * @param[in]  name  Plugin name, or NULL for all plugins
+ * @retval     0     OK
+ * @retval    -1    Error
+ * @code
+ *   clixon_plugin_statedata_invalidate(h, "example_backend");
+ * @endcode
+ */
+int
+clixon_plugin_statedata_invalidate(clicon_handle h,
+                                   const char   *name)
+{
+    struct statedata_cache  *sc = NULL;
+    struct statedata_entry **sep;
+    struct statedata_entry  *se;
+
+    if (clicon_ptr_get(h, STATEDATA_CACHE_NAME, (void**)&sc) < 0 || sc == NULL)
+        return 0;
+    sep = &sc->sc_entries;
+    while ((se = *sep) != NULL){
+        if (name == NULL || strcmp(clixon_plugin_name_get(se->se_cp), name) == 0){
+            *sep = se->se_next;
+            statedata_entry_free(se);
+            continue;
+        }
+        sep = &se->se_next;
+    }
+    return 0;
+}
+
+/*! Get state data cache statistics as XML for the stats rpc
+ *
+ * Only plugins with cached state data are included
+ * @param[in]  h   Clixon handle
+ * @param[out] cb  CLIgen buf, statedata-cache container is appended
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+clixon_plugin_statedata_stats(clicon_handle h,
+                              cbuf         *cb)
+{
+    struct statedata_cache *sc = NULL;
+    struct statedata_stats *ss;
+    struct statedata_entry *se;
+    uint64_t                nr;
+
+    cprintf(cb, "<statedata-cache xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (clicon_ptr_get(h, STATEDATA_CACHE_NAME, (void**)&sc) == 0 && sc != NULL)
+        for (ss = sc->sc_stats; ss; ss = ss->ss_next){
+            nr = 0;
+            for (se = sc->sc_entries; se; se = se->se_next)
+                if (se->se_cp == ss->ss_cp)
+                    nr++;
+            cprintf(cb, "<plugin><name>%s</name>", clixon_plugin_name_get(ss->ss_cp));
+            cprintf(cb, "<nr>%" PRIu64 "</nr>", nr);
+            cprintf(cb, "<hits>%" PRIu64 "</hits>", ss->ss_hits);
+            cprintf(cb, "<misses>%" PRIu64 "</misses>", ss->ss_misses);
+            cprintf(cb, "</plugin>");
+        }
+    cprintf(cb, "</statedata-cache>");
+    return 0;
+}
+
+/*! Free state data cache
+ *
+ * @param[in]  h   Clixon handle
+ */
+int
+clixon_plugin_statedata_cache_free(clicon_handle h)
+{
+    struct statedata_cache *sc = NULL;
+    struct statedata_entry *se;
+    struct statedata_stats *ss;
+
+    if (clicon_ptr_get(h, STATEDATA_CACHE_NAME, (void**)&sc) < 0 || sc == NULL)
+        return 0;
+    clicon_ptr_del(h, STATEDATA_CACHE_NAME);
+    while ((se = sc->sc_entries) != NULL){
+        sc->sc_entries = se->se_next;
+        statedata_entry_free(se);
+    }
+    while ((ss = sc->sc_stats) != NULL){
+        sc->sc_stats = ss->ss_next;
+        free(ss);
+    }
+    free(sc);
+    return 0;
+}
+
+/*! State data request of one plugin in clixon_plugin_statedata_all
+ */
+struct statedata_res {
+    clixon_plugin_t *rs_cp;
+    uint32_t         rs_ttl;      /* See ca_statedata_ttl */
+    char            *rs_key;      /* Cache key if rs_ttl is set */
+    int              rs_hit;      /* State tree rs_x is from the cache */
+    int              rs_worker;   /* Called in worker, see CLICON_PLUGIN_STATEDATA_WORKERS */
+    int              rs_timeout;  /* Worker did not finish in time, no state tree */
+    int              rs_ret;      /* Result of worker, as clixon_plugin_statedata_one */
+    char            *rs_reason;   /* Error reason of failed worker */
+    cxobj           *rs_x;        /* State tree, or NULL */
+    pid_t            rs_pid;      /* Worker process, 0 if not running */
+    int              rs_fd;       /* Read end of pipe from worker */
+    cbuf            *rs_cb;       /* Output of worker */
+    struct timespec  rs_deadline; /* Monotonic time when worker is killed, if timeout set */
+};
+
+/*! Call state data callback of a plugin in a worker process and write the result to a pipe
+ *
+ * The output is "1" followed by the state tree as XML, or "0" followed by the error reason.
+ * Does not return.
+ * @param[in]  h      Clixon handle
+ * @param[in]  cp     Plugin
+ * @param[in]  nsc    Namespace context
+ * @param[in]  xpath  Xpath
+ * @param[in]  fd     Write end of pipe
+ */
+static void
+statedata_worker(clicon_handle    h,
+                 clixon_plugin_t *cp,
+                 cvec            *nsc,
+                 char            *xpath,
+                 int              fd)
+{
+    cxobj  *x;
+    cbuf   *cb;
+    char   *p;
+    size_t  len;
+    ssize_t n;
+
+    if ((cb = cbuf_new()) == NULL ||
+        (x = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        _exit(1);
+    if (clixon_plugin_api_get(cp)->ca_statedata(h, nsc, xpath, x) < 0)
+        cprintf(cb, "0%s", clicon_err_reason);
+    else{
+        cprintf(cb, "1");
+        if (clixon_xml2cbuf(cb, x, 0, 0, NULL, -1, 1) < 0)
+            _exit(1);
+    }
+    p = cbuf_get(cb);
+    len = cbuf_len(cb);
+    while (len > 0){
+        if ((n = write(fd, p, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            _exit(1);
+        }
+        p += n;
+        len -= n;
+    }
+    /* Not exit(): the backend exit handlers are not run in the worker */
+    _exit(0);
+}
+
+/*! Start a worker process calling the state data callback of a plugin
+ *
+ * @param[in]  h        Clixon handle
+ * @param[in]  rs       State data request
+ * @param[in]  nsc      Namespace context
+ * @param[in]  xpath    Xpath
+ * @param[in]  timeout  Deadline in ms of worker, or 0
+ * @retval     1        Started
+ * @retval     0        Not started, call the callback in the backend
+ * @retval    -1        Error
+ */
+static int
+statedata_worker_start(clicon_handle         h,
+                       struct statedata_res *rs,
+                       cvec                 *nsc,
+                       char                 *xpath,
+                       uint32_t              timeout)
+{
+    int fd[2];
+
+    if ((rs->rs_cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        return -1;
+    }
+    if (pipe(fd) < 0){
+        clicon_err(OE_UNIX, errno, "pipe");
+        return -1;
+    }
+    if ((rs->rs_pid = fork()) < 0){
+        clicon_log(LOG_WARNING, "%s: fork: %s", __FUNCTION__, strerror(errno));
+        rs->rs_pid = 0;
+        close(fd[0]);
+        close(fd[1]);
+        return 0;
+    }
+    if (rs->rs_pid == 0){ /* Worker */
+        close(fd[0]);
+        statedata_worker(h, rs->rs_cp, nsc, xpath, fd[1]);
+    }
+    close(fd[1]);
+    clicon_debug(CLIXON_DBG_DETAIL, "%s pid:%d plugin:%s", __FUNCTION__,
+                 rs->rs_pid, clixon_plugin_name_get(rs->rs_cp));
+    rs->rs_fd = fd[0];
+    if (timeout){
+        clock_gettime(CLOCK_MONOTONIC, &rs->rs_deadline);
+        rs->rs_deadline.tv_sec += timeout/1000;
+        rs->rs_deadline.tv_nsec += (timeout%1000)*1000000;
+        if (rs->rs_deadline.tv_nsec >= 1000000000){
+            rs->rs_deadline.tv_sec++;
+            rs->rs_deadline.tv_nsec -= 1000000000;
+        }
+    }
+    return 1;
+}
+
+/*! Worker has closed its pipe or is killed, reap it and parse its output
+ *
+ * @param[in]  rs      State data request
+ * @param[in]  killed  Worker is killed since its deadline has passed
+ * @retval     0       OK, rs_ret and rs_x or rs_reason set
+ * @retval    -1       Error
+ */
+static int
+statedata_worker_done(struct statedata_res *rs,
+                      int                   killed)
+{
+    int   status = 0;
+    char *str;
+
+    if (killed)
+        kill(rs->rs_pid, SIGKILL);
+    close(rs->rs_fd);
+    rs->rs_fd = -1;
+    if (waitpid(rs->rs_pid, &status, 0) != rs->rs_pid)
+        status = 0;
+    rs->rs_pid = 0;
+    rs->rs_ret = 1;
+    if (killed){
+        clicon_log(LOG_WARNING, "%s: State callback of plugin %s did not finish in time",
+                   __FUNCTION__, clixon_plugin_name_get(rs->rs_cp));
+        rs->rs_timeout = 1;
+        return 0;
+    }
+    str = cbuf_get(rs->rs_cb);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || *str == '\0'){
+        rs->rs_ret = 0;
+        str = "state worker failed";
+    }
+    else if (*str++ == '0')
+        rs->rs_ret = 0;
+    else {
+        if ((rs->rs_x = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            return -1;
+        if (clixon_xml_parse_string(str, YB_NONE, NULL, &rs->rs_x, NULL) < 0){
+            rs->rs_ret = 0;
+            str = clicon_err_reason;
+        }
+    }
+    if (rs->rs_ret == 0 && (rs->rs_reason = strdup(str)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Call state data callbacks of parallel-safe plugins in worker processes
+ *
+ * At most max workers run at the same time. A worker that has not finished when its deadline
+ * has passed is killed, and the state data of its plugin is not included.
+ * If a worker cannot be started, its callback is called later in the backend.
+ * @param[in]  h        Clixon handle
+ * @param[in]  rv       State data requests, those with rs_worker set are called
+ * @param[in]  len      Length of rv
+ * @param[in]  nsc      Namespace context
+ * @param[in]  xpath    Xpath
+ * @param[in]  max      Max number of workers
+ * @param[in]  timeout  Deadline in ms of each worker, or 0
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see CLICON_PLUGIN_STATEDATA_WORKERS
+ */
+static int
+statedata_workers_run(clicon_handle         h,
+                      struct statedata_res *rv,
+                      int                   len,
+                      cvec                 *nsc,
+                      char                 *xpath,
+                      int                   max,
+                      uint32_t              timeout)
+{
+    int                   retval = -1;
+    struct pollfd        *fds = NULL;
+    struct statedata_res *rs;
+    struct timespec       now;
+    char                  buf[BUFSIZ];
+    ssize_t               n;
+    int                   next = 0;
+    int                   running;
+    int                   wait;
+    int                   ms;
+    int                   ret;
+    int                   i;
+    int                   j;
+
+    if ((fds = calloc(len, sizeof(*fds))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    while (1){
+        running = 0;
+        for (i=0; i<len; i++)
+            if (rv[i].rs_pid)
+                running++;
+        for (; next < len && running < max; next++){
+            rs = &rv[next];
+            if (!rs->rs_worker)
+                continue;
+            if ((ret = statedata_worker_start(h, rs, nsc, xpath, timeout)) < 0)
+                goto done;
+            if (ret == 0)
+                rs->rs_worker = 0;
+            else
+                running++;
+        }
+        if (running == 0)
+            break;
+        /* Wait for output of running workers until the first deadline */
+        wait = -1;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        for (i=0, j=0; i<len; i++){
+            rs = &rv[i];
+            if (rs->rs_pid == 0)
+                continue;
+            if (timeout){
+                ms = (rs->rs_deadline.tv_sec - now.tv_sec)*1000 +
+                    (rs->rs_deadline.tv_nsec - now.tv_nsec)/1000000;
+                if (ms < 0)
+                    ms = 0;
+                if (wait == -1 || ms < wait)
+                    wait = ms;
+            }
+            fds[j].fd = rs->rs_fd;
+            fds[j].events = POLLIN;
+            fds[j].revents = 0;
+            j++;
+        }
+        if (poll(fds, j, wait) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "poll");
+            goto done;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        for (i=0, j=0; i<len; i++){
+            rs = &rv[i];
+            if (rs->rs_pid == 0)
+                continue;
+            if (fds[j++].revents){
+                if ((n = read(rs->rs_fd, buf, sizeof(buf))) < 0 && errno == EINTR)
+                    continue;
+                if (n > 0){
+                    if (cbuf_append_buf(rs->rs_cb, buf, n) < 0){
+                        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                        goto done;
+                    }
+                    continue;
+                }
+                if (statedata_worker_done(rs, 0) < 0)
+                    goto done;
+            }
+            else if (timeout &&
+                     (rs->rs_deadline.tv_sec < now.tv_sec ||
+                      (rs->rs_deadline.tv_sec == now.tv_sec &&
+                       rs->rs_deadline.tv_nsec <= now.tv_nsec))){
+                if (statedata_worker_done(rs, 1) < 0)
+                    goto done;
+            }
+        }
+    }
+    retval = 0;
+ done:
+    /* On error, kill remaining workers */
+    for (i=0; i<len; i++)
+        if ((rs = &rv[i])->rs_pid){
+            kill(rs->rs_pid, SIGKILL);
+            close(rs->rs_fd);
+            waitpid(rs->rs_pid, NULL, 0);
+            rs->rs_pid = 0;
+        }
+    if (fds)
+        free(fds);
+    return retval;
+}
+
 /*! Go through all backend statedata callbacks and collect state data
  *
  * This is internal system call, plugin is invoked (does not call) this function
@@ -326,11 +957,14 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
  * @param[in]     nsc     Namespace context
  * @param[in]     xpath   String with XPATH syntax. or NULL for all
  * @param[in]     wdef    With-defaults parameter, see RFC 6243
+ * @param[in,out] untrusted Incremented for each plugin state tree that should be validated
  * @param[in,out] xret    State XML tree is merged with existing tree.
  * @retval        1       OK
  * @retval        0       Statedata callback failed (xret set with netconf-error)
  * @retval       -1       Error
  * @note xret can be replaced in this function
+ * State of a plugin with ca_statedata_trusted is bound to yang but not sorted or validated.
+ * In debug mode, it is verified that it is sorted, and it is validated.
  */
 int
 clixon_plugin_statedata_all(clicon_handle   h,
@@ -338,18 +972,85 @@ clixon_plugin_statedata_all(clicon_handle   h,
                             cvec           *nsc,
                             char           *xpath,
                             withdefaults_type wdef,
+                            int            *untrusted,
                             cxobj         **xret)
 {
-    int              retval = -1;
-    int              ret;
-    cxobj           *x = NULL;
-    clixon_plugin_t *cp = NULL;
-    cbuf            *cberr = NULL; 
-    cxobj           *xerr = NULL;
+    int                   retval = -1;
+    int                   ret;
+    cxobj                *x = NULL;
+    clixon_plugin_t      *cp = NULL;
+    clixon_plugin_api    *api;
+    cbuf                 *cberr = NULL; 
+    cxobj                *xerr = NULL;
+    struct statedata_res *rv = NULL;
+    struct statedata_res *rs;
+    int                   len = 0;
+    int                   workers;
+    int                   nworker = 0;
+    int                   i;
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
+    while ((cp = clixon_plugin_each(h, cp)) != NULL)
+        if (clixon_plugin_api_get(cp)->ca_statedata != NULL)
+            len++;
+    if (len == 0)
+        return 1;
+    if ((rv = calloc(len, sizeof(*rv))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Plugin context checks are made one callback at a time */
+    workers = clicon_option_int(h, "CLICON_PLUGIN_STATEDATA_WORKERS");
+    if (clicon_option_int(h, "CLICON_PLUGIN_CALLBACK_CHECK") > 0)
+        workers = 0;
+    len = 0;
+    while ((cp = clixon_plugin_each(h, cp)) != NULL){
+        api = clixon_plugin_api_get(cp);
+        if (api->ca_statedata == NULL)
+            continue;
+        rs = &rv[len++];
+        rs->rs_cp = cp;
+        rs->rs_fd = -1;
+        if ((rs->rs_ttl = api->ca_statedata_ttl) != 0){
+            if ((rs->rs_key = statedata_cache_key(nsc, xpath)) == NULL)
+                goto done;
+            if ((ret = statedata_cache_lookup(h, cp, rs->rs_key, &rs->rs_x)) < 0)
+                goto done;
+            if (ret == 1){
+                rs->rs_hit = 1;
+                continue;
+            }
+        }
+        if (workers > 0 && api->ca_statedata_parallel){
+            rs->rs_worker = 1;
+            nworker++;
+        }
+    }
+    /* A single callback is called in the backend, unless it has a deadline */
+    if (nworker > 1 ||
+        (nworker == 1 && clicon_option_int(h, "CLICON_PLUGIN_STATEDATA_TIMEOUT") > 0)){
+        if (statedata_workers_run(h, rv, len, nsc, xpath, workers,
+                                  clicon_option_int(h, "CLICON_PLUGIN_STATEDATA_TIMEOUT")) < 0)
+            goto done;
+    }
+    else
+        for (i=0; i<len; i++)
+            rv[i].rs_worker = 0;
+    for (i=0; i<len; i++){
+        rs = &rv[i];
+        cp = rs->rs_cp;
+        x = rs->rs_x;
+        rs->rs_x = NULL;
+        if (rs->rs_hit){
+            if (x == NULL)
+                continue;
+            goto merge;
+        }
+        if (rs->rs_worker){
+            if ((ret = rs->rs_ret) == 0)
+                clicon_err(OE_PLUGIN, 0, "%s", rs->rs_reason);
+        }
+        else if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
             goto done;
         if (ret == 0){
             if ((cberr = cbuf_new()) == NULL){
@@ -366,16 +1067,22 @@ clixon_plugin_statedata_all(clicon_handle   h,
             xerr = NULL;
             goto fail;
         }
-        if (x == NULL)
-            continue;
-        if (xml_child_nr(x) == 0){
+        if (x && xml_child_nr(x) == 0){
             xml_free(x);
             x = NULL;
+        }
+        if (x == NULL){
+            /* State of a plugin that did not finish in time is not cached */
+            if (rs->rs_ttl && !rs->rs_timeout &&
+                statedata_cache_add(h, cp, rs->rs_key, NULL, rs->rs_ttl) < 0)
+                goto done;
             continue;
         }
         clicon_debug_xml(CLIXON_DBG_DETAIL, x, "%s %s STATE:", __FUNCTION__, clixon_plugin_name_get(cp));
         /* XXX: ret == 0 invalid yang binding should be handled as internal error */
-        if ((ret = xml_bind_yang(h, x, YB_MODULE, yspec, &xerr)) < 0)
+        if (xml_build_bound(x)) /* Built with xml_build_* functions */
+            ret = 1;
+        else if ((ret = xml_bind_yang(h, x, YB_MODULE, yspec, &xerr)) < 0)
             goto done;
         if (ret == 0){
             if (clixon_netconf_internal_error(xerr,
@@ -387,12 +1094,26 @@ clixon_plugin_statedata_all(clicon_handle   h,
             xerr = NULL;
             goto fail;
         }
-        if (xml_sort_recurse(x) < 0)
-            goto done;
+        if (!clixon_plugin_api_get(cp)->ca_statedata_trusted){
+            if (xml_sort_recurse(x) < 0)
+                goto done;
+        }
+        else if (clicon_debug_get() &&
+                 xml_apply0(x, CX_ELMNT, xml_sort_verify, NULL) < 0){
+            clicon_log(LOG_WARNING, "%s: State data of trusted plugin %s is not sorted",
+                       __FUNCTION__, clixon_plugin_name_get(cp));
+            if (xml_sort_recurse(x) < 0)
+                goto done;
+        }
         /* Remove global defaults and empty non-presence containers */
         /* XXX: only for state data and according to with-defaults setting */
         if (xml_defaults_nopresence(x, 2) < 0)
             goto done;
+        if (rs->rs_ttl && statedata_cache_add(h, cp, rs->rs_key, x, rs->rs_ttl) < 0)
+            goto done;
+    merge:
+        if (!clixon_plugin_api_get(cp)->ca_statedata_trusted || clicon_debug_get())
+            (*untrusted)++;
         if ((ret = netconf_trymerge(x, yspec, xret)) < 0)
             goto done;
         if (ret == 0)
@@ -401,7 +1122,7 @@ clixon_plugin_statedata_all(clicon_handle   h,
             xml_free(x);
             x = NULL;
         }
-    } /* while plugin */
+    } /* for plugin */
     retval = 1;
  done:
     if (xerr)
@@ -410,6 +1131,20 @@ clixon_plugin_statedata_all(clicon_handle   h,
         cbuf_free(cberr);
     if (x)
         xml_free(x);
+    if (rv){
+        for (i=0; i<len; i++){
+            rs = &rv[i];
+            if (rs->rs_key)
+                free(rs->rs_key);
+            if (rs->rs_reason)
+                free(rs->rs_reason);
+            if (rs->rs_x)
+                xml_free(rs->rs_x);
+            if (rs->rs_cb)
+                cbuf_free(rs->rs_cb);
+        }
+        free(rv);
+    }
     return retval;
  fail:
     retval = 0;
@@ -435,13 +1170,18 @@ clixon_plugin_lockdb_one(clixon_plugin_t *cp,
 {
     int          retval = -1;
     plglockdb_t *fn;          /* Plugin statedata fn */
+    uint64_t     t0;
+    int          ret;
     void        *wh = NULL;
     
     if ((fn = clixon_plugin_api_get(cp)->ca_lockdb) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
-        if (fn(h, db, lock, id) < 0)
+        t0 = clixon_plugin_call_start();
+        ret = fn(h, db, lock, id);
+        clixon_plugin_call_stats(h, cp, PC_LOCKDB, t0);
+        if (ret < 0)
             goto done;  
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
@@ -485,6 +1225,11 @@ clixon_plugin_lockdb_all(clicon_handle h,
  * 
  * @param[in]  h      Clixon handle
  * @param[in]  xpath  Registered XPath using canonical prefixes
+ * @param[in]  locked Running datastore is locked by this caller
+ * @param[in]  offset Start of pagination interval
+ * @param[in]  limit  Number of elements
+ * @param[in]  cursor Page starts after this list entry, see pagination_cursor, or NULL
+ * @param[out] xstate Returned xml state tree
  */
 int
 clixon_pagination_cb_call(clicon_handle h,
@@ -492,6 +1237,7 @@ clixon_pagination_cb_call(clicon_handle h,
                           int          locked,
                           uint32_t     offset,
                           uint32_t     limit,
+                          char        *cursor,
                           cxobj       *xstate)
 {
     int                 retval = -1;
@@ -500,6 +1246,7 @@ clixon_pagination_cb_call(clicon_handle h,
 
     pd.pd_offset = offset;
     pd.pd_limit = limit;
+    pd.pd_cursor = cursor;
     pd.pd_locked = locked;
     pd.pd_xstate = xstate;
     clicon_ptr_get(h, "pagination-entries", (void**)&htable);
@@ -554,6 +1301,446 @@ clixon_pagination_free(clicon_handle h)
     return 0;
 }
 
+/*
+ * Subtree state providers
+ * A provider is registered on a YANG subtree and called only if the subtree intersects the
+ * request, with a compiled filter, see statedata_filter_t
+ */
+/* Handle data name of subtree state provider dispatcher */
+#define STATEDATA_SUBTREE_NAME "statedata-subtree-entries"
+
+/*! Check if xpath predicate is a key or leaf-list value predicate: [p:k='v'] or [.='v']
+ *
+ * @param[in]  s    Predicate after '['
+ * @param[out] end  Terminating ']'
+ * @retval     1    Key or leaf-list value predicate
+ * @retval     0    Other predicate
+ */
+static int
+statedata_key_pred(char  *s,
+                   char **end)
+{
+    char q;
+
+    while (isspace(*s))
+        s++;
+    if (*s == '.')
+        s++;
+    else {
+        if (!isalpha(*s) && *s != '_')
+            return 0;
+        while (isalnum(*s) || (*s && strchr("_-.:", *s)))
+            s++;
+    }
+    while (isspace(*s))
+        s++;
+    if (*s++ != '=')
+        return 0;
+    while (isspace(*s))
+        s++;
+    if (*s != '\'' && *s != '"')
+        return 0;
+    q = *s++;
+    if ((s = strchr(s, q)) == NULL)
+        return 0;
+    s++;
+    while (isspace(*s))
+        s++;
+    if (*s != ']')
+        return 0;
+    *end = s;
+    return 1;
+}
+
+/*! Compile request xpath into state data filter
+ *
+ * The longest prefix of the xpath with node names and key predicates only is parsed as an
+ * instance-identifier, eg /if:interfaces/if:interface[if:name='eth0'] of
+ * /if:interfaces/if:interface[if:name='eth0']/if:statistics[if:in-octets>0]
+ * A step with other predicates ends the prefix, excluding its predicates.
+ * If the prefix does not resolve in yang, the filter selects all state data.
+ * @param[in]  yspec  Yang spec
+ * @param[out] sf     State data filter, sf_path and sf_cplist are set. Free sf_path
+ *                    and sf_cplist after use
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+statedata_filter_compile(yang_stmt          *yspec,
+                         statedata_filter_t *sf)
+{
+    int    retval = -1;
+    cbuf  *cbpath = NULL;
+    cbuf  *cbid = NULL;
+    char  *p;
+    char  *s;
+    char  *e;
+    int    colons;
+    int    ret;
+
+    if ((cbpath = cbuf_new()) == NULL ||
+        (cbid = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    p = sf->sf_xpath;
+    while (p && *p == '/'){
+        s = ++p;
+        if (!isalpha(*p) && *p != '_')
+            break;
+        colons = 0;
+        while (isalnum(*p) || (*p && strchr("_-.:", *p)))
+            if (*p++ == ':')
+                colons++;
+        /* Not a node name, eg axis or function */
+        if (colons > 1 || (*p != '\0' && *p != '/' && *p != '['))
+            break;
+        cprintf(cbpath, "/%.*s", (int)(p-s), s);
+        cprintf(cbid, "/%.*s", (int)(p-s), s);
+        while (*p == '[' && statedata_key_pred(p+1, &e)){
+            cprintf(cbid, "%.*s", (int)(e-p+1), p);
+            p = e+1;
+        }
+        if (*p != '/')
+            break;
+    }
+    if (cbuf_len(cbid)){
+        if ((ret = clixon_instance_id_parse(yspec, &sf->sf_cplist, NULL, "%s", cbuf_get(cbid))) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_err_reset();
+            cbuf_reset(cbpath);
+        }
+    }
+    if ((sf->sf_path = strdup(cbuf_len(cbpath) ? cbuf_get(cbpath) : "/")) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cbpath)
+        cbuf_free(cbpath);
+    if (cbid)
+        cbuf_free(cbid);
+    return retval;
+}
+
+/*! Call subtree state providers that intersect the request and merge their state data
+ *
+ * @param[in]     h      Clixon handle
+ * @param[in]     yspec  Yang spec
+ * @param[in]     nsc    Namespace context
+ * @param[in]     xpath  Request xpath using canonical prefixes, or NULL for all
+ * @param[in,out] untrusted Incremented if state data of providers should be validated
+ * @param[in,out] xret   State XML tree is merged with existing tree.
+ * @retval        1      OK
+ * @retval        0      A provider failed (xret set with netconf-error)
+ * @retval       -1      Error
+ * @note xret can be replaced in this function
+ * @see clixon_statedata_subtree_register
+ */
+int
+clixon_statedata_subtree_all(clicon_handle h,
+                             yang_stmt    *yspec,
+                             cvec         *nsc,
+                             char         *xpath,
+                             int          *untrusted,
+                             cxobj       **xret)
+{
+    int                 retval = -1;
+    dispatcher_entry_t *htable = NULL;
+    statedata_filter_t  sf = {0,};
+    cbuf               *cberr = NULL;
+    cxobj              *xerr = NULL;
+    int                 ret;
+
+    clicon_ptr_get(h, STATEDATA_SUBTREE_NAME, (void**)&htable);
+    if (htable == NULL)
+        return 1;
+    sf.sf_xpath = xpath;
+    sf.sf_nsc = nsc;
+    if (statedata_filter_compile(yspec, &sf) < 0)
+        goto done;
+    if ((sf.sf_xstate = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    clicon_debug(CLIXON_DBG_DETAIL, "%s %s", __FUNCTION__, sf.sf_path);
+    if (dispatcher_call_subtree(htable, h, sf.sf_path, &sf) < 0){
+        if ((cberr = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cberr, "Internal error, subtree state provider of %s failed: %s",
+                sf.sf_path, clicon_err_reason);
+        if (netconf_operation_failed_xml(&xerr, "application", cbuf_get(cberr)) < 0)
+            goto done;
+        xml_free(*xret);
+        *xret = xerr;
+        xerr = NULL;
+        goto fail;
+    }
+    if (xml_child_nr(sf.sf_xstate) == 0)
+        goto ok;
+    if (xml_build_bound(sf.sf_xstate)) /* Built with xml_build_* functions */
+        ret = 1;
+    else if ((ret = xml_bind_yang(h, sf.sf_xstate, YB_MODULE, yspec, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        if (clixon_netconf_internal_error(xerr,
+                                          ". Internal error, subtree state provider returned invalid XML: ",
+                                          sf.sf_path) < 0)
+            goto done;
+        xml_free(*xret);
+        *xret = xerr;
+        xerr = NULL;
+        goto fail;
+    }
+    if (xml_sort_recurse(sf.sf_xstate) < 0)
+        goto done;
+    if (xml_defaults_nopresence(sf.sf_xstate, 2) < 0)
+        goto done;
+    (*untrusted)++;
+    if ((ret = netconf_trymerge(sf.sf_xstate, yspec, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+ ok:
+    retval = 1;
+ done:
+    if (sf.sf_path)
+        free(sf.sf_path);
+    if (sf.sf_cplist)
+        clixon_path_free(sf.sf_cplist);
+    if (sf.sf_xstate)
+        xml_free(sf.sf_xstate);
+    if (xerr)
+        xml_free(xerr);
+    if (cberr)
+        cbuf_free(cberr);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Register a state data provider of a YANG subtree
+ *
+ * The provider is called on get requests whose xpath intersects the subtree: the request
+ * is in the subtree, or the subtree is below the request. The callback is called as:
+ *   fn(h, path, statedata_filter sf, arg)
+ * and adds state data of the subtree to statedata_filter_xstate(sf), possibly constrained
+ * by statedata_filter_key(). It returns 0 on success and -1 on error.
+ * @param[in]  h      Clixon handle
+ * @param[in]  fn     Callback 
+ * @param[in]  path   Schema node path using canonical prefixes, eg /if:interfaces-state
+ * @param[in]  arg    Domain-specific argument to send to callback
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see ca_statedata  for state data callbacks called on every request
+ */
+int
+clixon_statedata_subtree_register(clicon_handle    h,
+                                  handler_function fn,
+                                  char            *path,
+                                  void            *arg)
+{
+    int                       retval = -1;
+    dispatcher_definition     x = {path, fn, arg};
+    dispatcher_entry_t       *htable = NULL;
+    
+    clicon_ptr_get(h, STATEDATA_SUBTREE_NAME, (void**)&htable);
+    if (dispatcher_register_handler(&htable, &x) < 0){
+        clicon_err(OE_PLUGIN, errno, "dispatcher");
+        goto done;
+    }
+    if (clicon_ptr_set(h, STATEDATA_SUBTREE_NAME, htable) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free subtree state provider structure
+ *
+ * @param[in]  h      Clixon handle
+ */
+int
+clixon_statedata_subtree_free(clicon_handle h)
+{
+    dispatcher_entry_t       *htable = NULL;
+    
+    clicon_ptr_get(h, STATEDATA_SUBTREE_NAME, (void**)&htable);
+    if (htable)
+        dispatcher_free(htable);
+    return 0;
+}
+
+/*
+ * Subtrees of transaction callbacks
+ * A plugin with ca_trans_subtree is only called in transactions that change its subtrees
+ */
+/* Handle data name of resolved subtrees of plugins */
+#define TRANS_SUBTREE_NAME "trans-subtree-entries"
+
+/*! Schema nodes of the subtrees of a plugin
+ */
+struct trans_subtree {
+    clixon_plugin_t *ts_cp;   /* Plugin */
+    yang_stmt      **ts_yvec; /* Schema nodes of ca_trans_subtree */
+    int              ts_ylen; /* Length of ts_yvec, -1 if a path is not found: all changes */
+};
+
+/*! Resolved subtrees of all plugins with ca_trans_subtree
+ */
+struct trans_subtree_table {
+    struct trans_subtree *tt_vec;
+    int                   tt_len;
+};
+
+/*! Get the schema nodes of the subtrees of a plugin, resolve them at first use
+ *
+ * A path that does not resolve is logged, and the plugin is then called on all changes
+ * @param[in]  h    Clixon handle
+ * @param[in]  cp   Plugin with ca_trans_subtree
+ * @param[out] tsp  Subtrees of plugin
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+trans_subtree_get(clicon_handle          h,
+                  clixon_plugin_t       *cp,
+                  struct trans_subtree **tsp)
+{
+    int                         retval = -1;
+    struct trans_subtree_table *tt = NULL;
+    struct trans_subtree       *ts;
+    yang_stmt                 **yvec;
+    yang_stmt                  *y;
+    char                      **path;
+    int                         i;
+
+    clicon_ptr_get(h, TRANS_SUBTREE_NAME, (void**)&tt);
+    if (tt == NULL){
+        if ((tt = calloc(1, sizeof(*tt))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if (clicon_ptr_set(h, TRANS_SUBTREE_NAME, tt) < 0){
+            free(tt);
+            goto done;
+        }
+    }
+    for (i=0; i<tt->tt_len; i++)
+        if (tt->tt_vec[i].ts_cp == cp){
+            *tsp = &tt->tt_vec[i];
+            goto ok;
+        }
+    if ((ts = realloc(tt->tt_vec, (tt->tt_len+1)*sizeof(*ts))) == NULL){
+        clicon_err(OE_UNIX, errno, "realloc");
+        goto done;
+    }
+    tt->tt_vec = ts;
+    ts = &tt->tt_vec[tt->tt_len++];
+    memset(ts, 0, sizeof(*ts));
+    ts->ts_cp = cp;
+    for (path = clixon_plugin_api_get(cp)->ca_trans_subtree; *path; path++){
+        y = NULL;
+        if (yang_abs_schema_nodeid(clicon_dbspec_yang(h), *path, &y) < 0)
+            clicon_err_reset();
+        if (y == NULL){
+            clicon_log(LOG_WARNING, "%s: Plugin '%s' subtree %s not found, called on all changes",
+                       __FUNCTION__, clixon_plugin_name_get(cp), *path);
+            ts->ts_ylen = -1;
+            break;
+        }
+        if ((yvec = realloc(ts->ts_yvec, (ts->ts_ylen+1)*sizeof(*yvec))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        ts->ts_yvec = yvec;
+        ts->ts_yvec[ts->ts_ylen++] = y;
+    }
+    *tsp = ts;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check if a transaction changes the subtrees of a plugin
+ *
+ * A plugin without ca_trans_subtree is affected by all transactions. Otherwise it is affected
+ * if a node of, or below, one of its subtrees is changed, or if an ancestor is added or
+ * deleted, see transaction_change_it_init.
+ * The result is kept in the transaction at the first call, before the change index is reset
+ * at the end of a commit, so that a plugin gets all or none of the callbacks of a transaction.
+ * @param[in]  cp   Plugin
+ * @param[in]  h    Clixon handle
+ * @param[in]  td   Transaction data
+ * @retval     1    Affected, call the transaction callbacks of the plugin
+ * @retval     0    Not affected, skip the callbacks
+ * @retval    -1    Error
+ */
+static int
+plugin_transaction_affected(clixon_plugin_t    *cp,
+                            clicon_handle       h,
+                            transaction_data_t *td)
+{
+    struct transaction_plugin_entry *tp;
+    struct trans_subtree            *ts;
+    transaction_change_it            it;
+    cxobj                           *x0;
+    cxobj                           *x1;
+    int                              affected;
+    int                              i;
+
+    if (clixon_plugin_api_get(cp)->ca_trans_subtree == NULL)
+        return 1;
+    for (i=0; i<td->td_pllen; i++)
+        if (td->td_plvec[i].tp_cp == cp)
+            return td->td_plvec[i].tp_affected;
+    if (trans_subtree_get(h, cp, &ts) < 0)
+        return -1;
+    affected = ts->ts_ylen < 0;
+    for (i=0; !affected && i<ts->ts_ylen; i++){
+        if (transaction_change_it_init(td, &it, ts->ts_yvec[i]) < 0)
+            return -1;
+        affected = transaction_change_it_next(&it, NULL, &x0, &x1);
+    }
+    if ((tp = realloc(td->td_plvec, (td->td_pllen+1)*sizeof(*tp))) == NULL){
+        clicon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    td->td_plvec = tp;
+    tp = &td->td_plvec[td->td_pllen++];
+    tp->tp_cp = cp;
+    tp->tp_affected = affected;
+    clicon_debug(CLIXON_DBG_DETAIL, "%s %s: %d", __FUNCTION__, clixon_plugin_name_get(cp), affected);
+    return affected;
+}
+
+/*! Free resolved subtrees of transaction callbacks
+ *
+ * @param[in]  h      Clixon handle
+ */
+int
+plugin_transaction_subtree_free(clicon_handle h)
+{
+    struct trans_subtree_table *tt = NULL;
+    int                         i;
+
+    clicon_ptr_get(h, TRANS_SUBTREE_NAME, (void**)&tt);
+    if (tt == NULL)
+        return 0;
+    for (i=0; i<tt->tt_len; i++)
+        if (tt->tt_vec[i].ts_yvec)
+            free(tt->tt_vec[i].ts_yvec);
+    if (tt->tt_vec)
+        free(tt->tt_vec);
+    free(tt);
+    clicon_ptr_del(h, TRANS_SUBTREE_NAME);
+    return 0;
+}
+
 /*! Create and initialize a validate/commit transaction 
  *
  * @retval  td     New alloced transaction, 
@@ -594,10 +1781,34 @@ transaction_free(transaction_data_t *td)
         free(td->td_scvec);
     if (td->td_tcvec)
         free(td->td_tcvec);
+    transaction_change_index_reset(td);
+    if (td->td_plvec)
+        free(td->td_plvec);
     free(td);
     return 0;
 }
 
+/*! Free the change index of a transaction, it is built again when needed
+ *
+ * Called when the change vectors of the transaction are modified
+ * @param[in]  td      Transaction data
+ * @see transaction_change_it_init
+ */
+int
+transaction_change_index_reset(transaction_data_t *td)
+{
+    if (td->td_chvec)
+        free(td->td_chvec);
+    if (td->td_chself)
+        free(td->td_chself);
+    td->td_chvec = NULL;
+    td->td_chlen = 0;
+    td->td_chself = NULL;
+    td->td_chselflen = 0;
+    td->td_chbuilt = 0;
+    return 0;
+}
+
 /*! Call single plugin transaction_begin() before a validate/commit.
  *
  * @param[in]  cp      Plugin handle
@@ -611,15 +1822,25 @@ plugin_transaction_begin_one(clixon_plugin_t    *cp,
                              clicon_handle       h, 
                              transaction_data_t *td)
 {
-    int         retval = -1;
-    trans_cb_t *fn;
-    void       *wh = NULL;
+    int             retval = -1;
+    trans_cb_t     *fn;
+    void           *wh = NULL;
+    int             affected;
+    struct timespec t0;
+    int             ret;
     
-    if ((fn = clixon_plugin_api_get(cp)->ca_trans_begin) != NULL){
+    if ((affected = plugin_transaction_affected(cp, h, td)) < 0)
+        goto done;
+    if (affected &&
+        (fn = clixon_plugin_api_get(cp)->ca_trans_begin) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
-        if (fn(h, (transaction_data)td) < 0){
+        commit_stats_start(&t0);
+        ret = fn(h, (transaction_data)td);
+        if (commit_stats_plugin(h, cp, CC_BEGIN, &t0) < 0)
+            goto done;
+        if (ret < 0){
             if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
                 goto done;
             if (!clicon_errno) /* sanity: log if clicon_err() is not called ! */
@@ -674,15 +1895,25 @@ plugin_transaction_validate_one(clixon_plugin_t      *cp,
                                 clicon_handle       h, 
                                 transaction_data_t *td)
 {
-    int         retval = -1;
-    trans_cb_t *fn;
-    void       *wh = NULL;
+    int             retval = -1;
+    trans_cb_t     *fn;
+    void           *wh = NULL;
+    int             affected;
+    struct timespec t0;
+    int             ret;
 
-    if ((fn = clixon_plugin_api_get(cp)->ca_trans_validate) != NULL){
+    if ((affected = plugin_transaction_affected(cp, h, td)) < 0)
+        goto done;
+    if (affected &&
+        (fn = clixon_plugin_api_get(cp)->ca_trans_validate) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
-        if (fn(h, (transaction_data)td) < 0){
+        commit_stats_start(&t0);
+        ret = fn(h, (transaction_data)td);
+        if (commit_stats_plugin(h, cp, CC_VALIDATE, &t0) < 0)
+            goto done;
+        if (ret < 0){
             if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
                 goto done;
             if (!clicon_errno) /* sanity: log if clicon_err() is not called ! */
@@ -736,15 +1967,25 @@ plugin_transaction_complete_one(clixon_plugin_t      *cp,
                                 clicon_handle       h, 
                                 transaction_data_t *td)
 {
-    int         retval = -1;
-    trans_cb_t *fn;
-    void       *wh = NULL;
+    int             retval = -1;
+    trans_cb_t     *fn;
+    void           *wh = NULL;
+    int             affected;
+    struct timespec t0;
+    int             ret;
     
-    if ((fn = clixon_plugin_api_get(cp)->ca_trans_complete) != NULL){
+    if ((affected = plugin_transaction_affected(cp, h, td)) < 0)
+        goto done;
+    if (affected &&
+        (fn = clixon_plugin_api_get(cp)->ca_trans_complete) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
-        if (fn(h, (transaction_data)td) < 0){
+        commit_stats_start(&t0);
+        ret = fn(h, (transaction_data)td);
+        if (commit_stats_plugin(h, cp, CC_COMPLETE, &t0) < 0)
+            goto done;
+        if (ret < 0){
             if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
                 goto done;
             if (!clicon_errno) /* sanity: log if clicon_err() is not called ! */
@@ -807,6 +2048,8 @@ plugin_transaction_revert_all(clicon_handle       h,
     while ((cp = clixon_plugin_each_revert(h, cp, nr)) != NULL) {
         if ((fn = clixon_plugin_api_get(cp)->ca_trans_revert) == NULL)
             continue;
+        if (plugin_transaction_affected(cp, h, td) != 1)
+            continue;
         if ((retval = fn(h, (transaction_data)td)) < 0){
                 clicon_log(LOG_NOTICE, "%s: Plugin '%s' trans_revert callback failed", 
                            __FUNCTION__, clixon_plugin_name_get(cp));
@@ -830,15 +2073,25 @@ plugin_transaction_commit_one(clixon_plugin_t      *cp,
                               clicon_handle       h, 
                               transaction_data_t *td)
 {
-    int         retval = -1;
-    trans_cb_t *fn;
-    void       *wh = NULL;
+    int             retval = -1;
+    trans_cb_t     *fn;
+    void           *wh = NULL;
+    int             affected;
+    struct timespec t0;
+    int             ret;
     
-    if ((fn = clixon_plugin_api_get(cp)->ca_trans_commit) != NULL){
+    if ((affected = plugin_transaction_affected(cp, h, td)) < 0)
+        goto done;
+    if (affected &&
+        (fn = clixon_plugin_api_get(cp)->ca_trans_commit) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
-        if (fn(h, (transaction_data)td) < 0){
+        commit_stats_start(&t0);
+        ret = fn(h, (transaction_data)td);
+        if (commit_stats_plugin(h, cp, CC_COMMIT, &t0) < 0)
+            goto done;
+        if (ret < 0){
             if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
                 goto done;
             if (!clicon_errno) /* sanity: log if clicon_err() is not called ! */
@@ -854,6 +2107,406 @@ plugin_transaction_commit_one(clixon_plugin_t      *cp,
     return retval;
 }
 
+#ifdef HAVE_LIBPTHREAD
+/*! Commit callbacks of consecutive parallel-safe plugins run by a pool of threads
+ * A plugin is started when the plugins of the wave it declares in ca_trans_after are done
+ * Also used for start callbacks, then with ca_start_parallel and ca_start_after
+ * While a wave runs, string interning and xpaths are serialized and only the calling thread
+ * reports errors and logs, see commit_wave_run
+ */
+struct commit_wave {
+    pthread_mutex_t     cw_mutex;
+    pthread_cond_t      cw_cond;
+    clicon_handle       cw_h;
+    transaction_data_t *cw_td;    /* NULL for start callbacks */
+    clixon_plugin_t   **cw_vec;   /* Plugins of the wave, in load order */
+    int                *cw_state; /* Per plugin, see CW_* */
+    int                 cw_len;
+    int                 cw_error; /* Set if any commit callback failed */
+    int                 cw_failed; /* First plugin that failed in another thread, or -1 */
+    int                 cw_reported; /* Set if a failure was reported by calling thread */
+};
+#define CW_WAIT 0 /* Not started */
+#define CW_RUN  1 /* Commit callback running */
+#define CW_DONE 2 /* Committed, revert if a later plugin fails */
+#define CW_FAIL 3 /* Commit callback failed */
+#define CW_SKIP 4 /* Not affected by transaction, see plugin_transaction_affected */
+
+/*! Check if all plugins of the wave that a plugin depends on are done
+ * @param[in]  cw  Commit wave
+ * @param[in]  i   Plugin index in wave
+ * @retval     1   Yes, plugin can be started
+ * @retval     0   No
+ * @note Only dependencies on plugins loaded before are considered
+ */
+static int
+commit_wave_ready(struct commit_wave *cw,
+                  int                 i)
+{
+    clixon_plugin_api *api = clixon_plugin_api_get(cw->cw_vec[i]);
+    char             **after;
+    int                j;
+
+    if ((after = cw->cw_td ? api->ca_trans_after : api->ca_start_after) == NULL)
+        return 1;
+    for (; *after; after++)
+        for (j=0; j<i; j++)
+            if (cw->cw_state[j] != CW_DONE && cw->cw_state[j] != CW_SKIP &&
+                strcmp(*after, clixon_plugin_name_get(cw->cw_vec[j])) == 0)
+                return 0;
+    return 1;
+}
+
+/*! Record that a callback of a plugin in the wave failed, called with the mutex held
+ *
+ * Errors and logs of other threads than the calling thread of commit_wave_run are dropped,
+ * the failure is then reported by commit_wave_run after the join
+ * @param[in]  cw  Commit wave
+ * @param[in]  i   Plugin index in wave
+ */
+static void
+commit_wave_fail(struct commit_wave *cw,
+                 int                 i)
+{
+    cw->cw_state[i] = CW_FAIL;
+    cw->cw_error = 1;
+    if (clicon_err_thread_owner())
+        cw->cw_reported = 1;
+    else if (cw->cw_failed < 0)
+        cw->cw_failed = i;
+}
+
+/*! Commit thread: start plugins whose dependencies are done until none remain or one fails
+ * The calling thread also runs this, so all plugins are committed even if no thread could be created
+ */
+static void *
+commit_wave_worker(void *arg)
+{
+    struct commit_wave *cw = (struct commit_wave *)arg;
+    trans_cb_t         *fn;
+    plgstart_t         *sfn;
+    int                 i;
+    int                 waiting;
+    int                 ret;
+    struct timespec     t0;
+    uint64_t            us;
+
+    pthread_mutex_lock(&cw->cw_mutex);
+    while (!cw->cw_error){
+        waiting = 0;
+        for (i=0; i<cw->cw_len; i++){
+            if (cw->cw_state[i] != CW_WAIT)
+                continue;
+            waiting++;
+            if (commit_wave_ready(cw, i))
+                break;
+        }
+        if (i == cw->cw_len){
+            if (waiting == 0)
+                break;
+            /* Wait for a running plugin this one depends on */
+            pthread_cond_wait(&cw->cw_cond, &cw->cw_mutex);
+            continue;
+        }
+        if (cw->cw_td == NULL){ /* Start callbacks */
+            if ((sfn = clixon_plugin_api_get(cw->cw_vec[i])->ca_start) == NULL){
+                cw->cw_state[i] = CW_DONE;
+                continue;
+            }
+            cw->cw_state[i] = CW_RUN;
+            pthread_mutex_unlock(&cw->cw_mutex);
+            us = clixon_plugin_call_start();
+            ret = sfn(cw->cw_h);
+            pthread_mutex_lock(&cw->cw_mutex);
+            clixon_plugin_call_stats(cw->cw_h, cw->cw_vec[i], PC_START, us);
+            clicon_debug(1, "%s: %s started in %" PRIu64 " ms", __FUNCTION__,
+                         clixon_plugin_name_get(cw->cw_vec[i]), (clixon_plugin_call_start()-us)/1000);
+            if (ret < 0){
+                clicon_log(LOG_NOTICE, "%s: Plugin '%s' start callback failed",
+                           __FUNCTION__, clixon_plugin_name_get(cw->cw_vec[i]));
+                commit_wave_fail(cw, i);
+            }
+            else
+                cw->cw_state[i] = CW_DONE;
+            pthread_cond_broadcast(&cw->cw_cond);
+            continue;
+        }
+        if ((fn = clixon_plugin_api_get(cw->cw_vec[i])->ca_trans_commit) == NULL){
+            cw->cw_state[i] = CW_DONE;
+            continue;
+        }
+        cw->cw_state[i] = CW_RUN;
+        pthread_mutex_unlock(&cw->cw_mutex);
+        commit_stats_start(&t0);
+        ret = fn(cw->cw_h, (transaction_data)cw->cw_td);
+        pthread_mutex_lock(&cw->cw_mutex);
+        /* Recorded with the mutex held, one thread at a time */
+        if (commit_stats_plugin(cw->cw_h, cw->cw_vec[i], CC_COMMIT, &t0) < 0)
+            ret = -1;
+        if (ret < 0){
+            clicon_log(LOG_NOTICE, "%s: Plugin '%s' trans_commit callback failed",
+                       __FUNCTION__, clixon_plugin_name_get(cw->cw_vec[i]));
+            commit_wave_fail(cw, i);
+        }
+        else
+            cw->cw_state[i] = CW_DONE;
+        pthread_cond_broadcast(&cw->cw_cond);
+    }
+    pthread_mutex_unlock(&cw->cw_mutex);
+    return NULL;
+}
+
+/*! Run commit callbacks of a wave of plugins using at most nthreads threads
+ *
+ * Return when all started callbacks are done. If one fails, no more are started.
+ * While the threads run, the string intern table is locked, xpaths are serialized, and errors
+ * and logs of callbacks in other threads than the calling thread are dropped. A failure in
+ * another thread is reported here after the join.
+ * @param[in]  cw        Commit wave
+ * @param[in]  nthreads  Number of threads including the calling thread
+ * @retval     0         OK
+ * @retval    -1         Error, a commit callback failed or a thread error
+ */
+static int
+commit_wave_run(struct commit_wave *cw,
+                int                 nthreads)
+{
+    int        retval = -1;
+    pthread_t *tids = NULL;
+    int        n = 0;
+
+    if (nthreads > cw->cw_len)
+        nthreads = cw->cw_len;
+    if (nthreads > 1 &&
+        (tids = malloc((nthreads-1)*sizeof(pthread_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    cw->cw_failed = -1;
+    cw->cw_reported = 0;
+    clicon_err_thread(1);
+    clixon_string_intern_lock(1);
+    xpath_lock(1);
+    /* Failing to create a thread is not an error: the remaining threads do the work */
+    for (n=0; n<nthreads-1; n++)
+        if (pthread_create(&tids[n], NULL, commit_wave_worker, cw) != 0)
+            break;
+    commit_wave_worker(cw);
+    while (n > 0)
+        pthread_join(tids[--n], NULL);
+    xpath_lock(0);
+    clixon_string_intern_lock(0);
+    clicon_err_thread(0);
+    if (cw->cw_error){
+        if (!cw->cw_reported && cw->cw_failed >= 0)
+            clicon_err(OE_PLUGIN, 0, "Plugin '%s' %s callback failed",
+                       clixon_plugin_name_get(cw->cw_vec[cw->cw_failed]),
+                       cw->cw_td ? "trans_commit" : "start");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (tids)
+        free(tids);
+    return retval;
+}
+
+/*! Call transaction_commit callbacks in all backend plugins, parallel-safe plugins in parallel
+ *
+ * Consecutive plugins with ca_trans_parallel set, or without commit callback, form a wave
+ * whose commit callbacks are run by a pool of threads. Other plugins are called one at a time
+ * between waves, as in plugin_transaction_commit_all.
+ * If a commit callback fails, the plugins committed before, including those of its wave
+ * that are done, are reverted in reverse load order.
+ * @param[in]  h         Clicon handle
+ * @param[in]  td        Transaction data
+ * @param[in]  nthreads  Number of threads
+ * @retval     0         OK
+ * @retval    -1         Error: one of the plugin callbacks returned error
+ */
+static int
+plugin_transaction_commit_parallel(clicon_handle       h,
+                                   transaction_data_t *td,
+                                   int                 nthreads)
+{
+    int                 retval = -1;
+    clixon_plugin_t    *cp = NULL;
+    clixon_plugin_api  *api;
+    struct commit_wave  cw = {0,};
+    int                 len = 0;
+    trans_cb_t         *fn;
+    int                 i;
+    int                 j;
+    int                 ret;
+
+    pthread_mutex_init(&cw.cw_mutex, NULL);
+    pthread_cond_init(&cw.cw_cond, NULL);
+    while ((cp = clixon_plugin_each(h, cp)) != NULL)
+        len++;
+    if ((cw.cw_vec = calloc(len+1, sizeof(clixon_plugin_t *))) == NULL ||
+        (cw.cw_state = calloc(len+1, sizeof(int))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    len = 0;
+    while ((cp = clixon_plugin_each(h, cp)) != NULL){
+        /* Decided here, not in the commit threads */
+        if ((ret = plugin_transaction_affected(cp, h, td)) < 0)
+            goto done;
+        if (ret == 0)
+            cw.cw_state[len] = CW_SKIP;
+        cw.cw_vec[len++] = cp;
+    }
+    cw.cw_h = h;
+    cw.cw_td = td;
+    for (i=0; i<len; i=j){
+        /* Wave of parallel-safe plugins starting at i, skipped plugins are not called */
+        for (j=i; j<len; j++){
+            api = clixon_plugin_api_get(cw.cw_vec[j]);
+            if (cw.cw_state[j] != CW_SKIP &&
+                api->ca_trans_commit != NULL && !api->ca_trans_parallel)
+                break;
+        }
+        if (j > i){
+            cw.cw_len = j;
+            /* Plugins before i are done */
+            if (commit_wave_run(&cw, nthreads) < 0)
+                goto revert;
+            continue;
+        }
+        if (plugin_transaction_commit_one(cw.cw_vec[i], h, td) < 0){
+            cw.cw_state[i] = CW_FAIL;
+            goto revert;
+        }
+        cw.cw_state[i] = CW_DONE;
+        j = i+1;
+    }
+    retval = 0;
+ done:
+    pthread_cond_destroy(&cw.cw_cond);
+    pthread_mutex_destroy(&cw.cw_mutex);
+    if (cw.cw_vec)
+        free(cw.cw_vec);
+    if (cw.cw_state)
+        free(cw.cw_state);
+    return retval;
+ revert:
+    /* Make an effort to revert transaction */
+    for (i=len-1; i>=0; i--){
+        if (cw.cw_state[i] != CW_DONE)
+            continue;
+        if ((fn = clixon_plugin_api_get(cw.cw_vec[i])->ca_trans_revert) == NULL)
+            continue;
+        if (fn(h, (transaction_data)td) < 0){
+            clicon_log(LOG_NOTICE, "%s: Plugin '%s' trans_revert callback failed",
+                       __FUNCTION__, clixon_plugin_name_get(cw.cw_vec[i]));
+            break;
+        }
+    }
+    goto done;
+}
+
+/*! Call start callbacks in all backend plugins, parallel-safe plugins in parallel
+ *
+ * Consecutive plugins with ca_start_parallel set, or without start callback, form a wave
+ * whose start callbacks are run by a pool of threads. A plugin is started after the plugins
+ * of the wave it declares in ca_start_after. Other plugins are started one at a time between
+ * waves, as in clixon_plugin_start_all.
+ * If a start callback fails, no more plugins are started.
+ * @param[in]  h         Clicon handle
+ * @param[in]  nthreads  Number of threads
+ * @retval     0         OK
+ * @retval    -1         Error: one of the plugin callbacks returned error
+ */
+static int
+plugin_start_parallel(clicon_handle h,
+                      int           nthreads)
+{
+    int                 retval = -1;
+    clixon_plugin_t    *cp = NULL;
+    clixon_plugin_api  *api;
+    struct commit_wave  cw = {0,};
+    int                 len = 0;
+    int                 i;
+    int                 j;
+
+    pthread_mutex_init(&cw.cw_mutex, NULL);
+    pthread_cond_init(&cw.cw_cond, NULL);
+    while ((cp = clixon_plugin_each(h, cp)) != NULL)
+        len++;
+    if ((cw.cw_vec = calloc(len+1, sizeof(clixon_plugin_t *))) == NULL ||
+        (cw.cw_state = calloc(len+1, sizeof(int))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    len = 0;
+    while ((cp = clixon_plugin_each(h, cp)) != NULL)
+        cw.cw_vec[len++] = cp;
+    cw.cw_h = h;
+    for (i=0; i<len; i=j){
+        /* Wave of parallel-safe plugins starting at i */
+        for (j=i; j<len; j++){
+            api = clixon_plugin_api_get(cw.cw_vec[j]);
+            if (api->ca_start != NULL && !api->ca_start_parallel)
+                break;
+        }
+        if (j > i){
+            cw.cw_len = j;
+            /* Plugins before i are done */
+            if (commit_wave_run(&cw, nthreads) < 0)
+                goto done;
+            continue;
+        }
+        if (clixon_plugin_start_one(cw.cw_vec[i], h) < 0)
+            goto done;
+        cw.cw_state[i] = CW_DONE;
+        j = i+1;
+    }
+    retval = 0;
+ done:
+    pthread_cond_destroy(&cw.cw_cond);
+    pthread_mutex_destroy(&cw.cw_mutex);
+    if (cw.cw_vec)
+        free(cw.cw_vec);
+    if (cw.cw_state)
+        free(cw.cw_state);
+    return retval;
+}
+#endif /* HAVE_LIBPTHREAD */
+
+/*! Call start callbacks in all backend plugins
+ *
+ * Return when all plugins are started, ie the backend is ready only after the full set.
+ * @param[in]  h       Clicon handle
+ * @retval     0       OK
+ * @retval    -1       Error: one of the plugin callbacks returned error
+ * @see plugin_start_parallel  if CLICON_PLUGIN_START_THREADS is larger than 1
+ */
+int
+clixon_plugin_start_backend_all(clicon_handle h)
+{
+    int      retval = -1;
+    uint64_t t0;
+
+    t0 = clixon_plugin_call_start();
+#ifdef HAVE_LIBPTHREAD
+    /* Plugin context checks are made one callback at a time */
+    if (clicon_option_int(h, "CLICON_PLUGIN_START_THREADS") > 1 &&
+        clicon_option_int(h, "CLICON_PLUGIN_CALLBACK_CHECK") <= 0){
+        if (plugin_start_parallel(h, clicon_option_int(h, "CLICON_PLUGIN_START_THREADS")) < 0)
+            goto done;
+    }
+    else
+#endif
+    if (clixon_plugin_start_all(h) < 0)
+        goto done;
+    clicon_debug(1, "%s: all plugins started in %" PRIu64 " ms", __FUNCTION__,
+                 (clixon_plugin_call_start()-t0)/1000);
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Call transaction_commit callbacks in all backend plugins
  *
  * @param[in]  h       Clicon handle
@@ -863,6 +2516,7 @@ plugin_transaction_commit_one(clixon_plugin_t      *cp,
  * If any of the commit callbacks fail by returning -1, a revert of the 
  * transaction is tried by calling the commit callbacsk with reverse arguments
  * and in reverse order.
+ * @see plugin_transaction_commit_parallel  if CLICON_PLUGIN_COMMIT_THREADS is larger than 1
  */
 int
 plugin_transaction_commit_all(clicon_handle       h, 
@@ -872,6 +2526,13 @@ plugin_transaction_commit_all(clicon_handle       h,
     clixon_plugin_t *cp = NULL;
     int            i=0;
     
+#ifdef HAVE_LIBPTHREAD
+    /* Plugin context checks are made one callback at a time */
+    if (clicon_option_int(h, "CLICON_PLUGIN_COMMIT_THREADS") > 1 &&
+        clicon_option_int(h, "CLICON_PLUGIN_CALLBACK_CHECK") <= 0)
+        return plugin_transaction_commit_parallel(h, td,
+                                                  clicon_option_int(h, "CLICON_PLUGIN_COMMIT_THREADS"));
+#endif
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
         i++;
         if (plugin_transaction_commit_one(cp, h, td) < 0){
@@ -898,15 +2559,25 @@ plugin_transaction_commit_done_one(clixon_plugin_t      *cp,
                                    clicon_handle       h, 
                                    transaction_data_t *td)
 {
-    int         retval = -1;
-    trans_cb_t *fn;
-    void       *wh = NULL;
+    int             retval = -1;
+    trans_cb_t     *fn;
+    void           *wh = NULL;
+    int             affected;
+    struct timespec t0;
+    int             ret;
     
-    if ((fn = clixon_plugin_api_get(cp)->ca_trans_commit_done) != NULL){
+    if ((affected = plugin_transaction_affected(cp, h, td)) < 0)
+        goto done;
+    if (affected &&
+        (fn = clixon_plugin_api_get(cp)->ca_trans_commit_done) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
-        if (fn(h, (transaction_data)td) < 0){
+        commit_stats_start(&t0);
+        ret = fn(h, (transaction_data)td);
+        if (commit_stats_plugin(h, cp, CC_COMMIT_DONE, &t0) < 0)
+            goto done;
+        if (ret < 0){
             if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
                 goto done;
             if (!clicon_errno) /* sanity: log if clicon_err() is not called ! */
@@ -959,15 +2630,25 @@ plugin_transaction_end_one(clixon_plugin_t      *cp,
                            clicon_handle       h, 
                            transaction_data_t *td)
 {
-    int         retval = -1;
-    trans_cb_t *fn;
-    void       *wh = NULL;
+    int             retval = -1;
+    trans_cb_t     *fn;
+    void           *wh = NULL;
+    int             affected;
+    struct timespec t0;
+    int             ret;
     
-    if ((fn = clixon_plugin_api_get(cp)->ca_trans_end) != NULL){
+    if ((affected = plugin_transaction_affected(cp, h, td)) < 0)
+        goto done;
+    if (affected &&
+        (fn = clixon_plugin_api_get(cp)->ca_trans_end) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
-        if (fn(h, (transaction_data)td) < 0){
+        commit_stats_start(&t0);
+        ret = fn(h, (transaction_data)td);
+        if (commit_stats_plugin(h, cp, CC_END, &t0) < 0)
+            goto done;
+        if (ret < 0){
             if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
                 goto done;
             if (!clicon_errno) /* sanity: log if clicon_err() is not called ! */
@@ -1015,8 +2696,12 @@ plugin_transaction_abort_one(clixon_plugin_t      *cp,
     int         retval = -1;
     trans_cb_t *fn;
     void       *wh = NULL;
+    int         affected;
     
-    if ((fn = clixon_plugin_api_get(cp)->ca_trans_abort) != NULL){
+    if ((affected = plugin_transaction_affected(cp, h, td)) < 0)
+        goto done;
+    if (affected &&
+        (fn = clixon_plugin_api_get(cp)->ca_trans_abort) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, clixon_plugin_name_get(cp), __FUNCTION__) < 0)
             goto done;
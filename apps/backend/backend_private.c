@@ -0,0 +1,651 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+  Private candidate datastores of sessions, see CLICON_XMLDB_PRIVATE_CANDIDATE
+  Each session gets its own candidate datastore "candidate-<session-id>", created as a copy
+  of running at its first use. The edits of the session are applied to its candidate and
+  recorded, together with the version of running the candidate is based on.
+  On commit, if running has changed since then, the candidate is rebased: the edits are
+  checked for conflicts with the changes of running since the base, and applied again to a
+  copy of the latest running. Changes of running are recorded as the edits of each private
+  commit or direct edit of running, keyed by the versions of running before and after.
+  Other changes of running, eg by a copy-config or a rollback, conflict with any edit.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+#include "clixon_backend_commit.h"
+#include "backend_private.h"
+
+#define PRIVATE_STATE_NAME "private-candidate-state"
+
+/* Recorded edit of a private candidate or of running
+ */
+struct private_edit{
+    struct private_edit *pe_next;
+    cxobj               *pe_xc;  /* Copy of edit <config> */
+    enum operation_type  pe_op;  /* Default operation */
+};
+
+/* Private candidate of a session
+ */
+struct private_candidate{
+    struct private_candidate *pc_next;
+    uint32_t                  pc_id;       /* Session id */
+    char                     *pc_db;       /* Datastore name */
+    uint64_t                  pc_base;     /* Version of running the candidate is based on */
+    int                       pc_replaced; /* Replaced, eg by copy-config: not rebased */
+    struct private_edit      *pc_edits;    /* Edits in order */
+    struct private_edit     **pc_last;
+};
+
+/* Recorded change of running
+ */
+struct private_commit{
+    struct private_commit *pm_next;
+    uint64_t               pm_prev;     /* Version of running before */
+    uint64_t               pm_version;  /* Version of running after */
+    int                    pm_replaced; /* Change is not known: conflicts with any edit */
+    struct private_edit   *pm_edits;    /* Edits of change */
+};
+
+/* Private candidates of handle
+ */
+struct private_state{
+    struct private_candidate *ps_candidates;
+    struct private_commit    *ps_commits;  /* Changes of running, oldest first */
+    struct private_commit   **ps_last;
+};
+
+/*! Get private candidate state of handle
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  create  Create if not found
+ * @retval     ps      Private candidate state
+ * @retval     NULL    Not found, or error if create
+ */
+static struct private_state *
+private_state_get(clicon_handle h,
+                  int           create)
+{
+    struct private_state *ps = NULL;
+
+    if (clicon_ptr_get(h, PRIVATE_STATE_NAME, (void**)&ps) == 0 && ps != NULL)
+        return ps;
+    if (!create)
+        return NULL;
+    if ((ps = calloc(1, sizeof(*ps))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    ps->ps_last = &ps->ps_commits;
+    if (clicon_ptr_set(h, PRIVATE_STATE_NAME, ps) < 0){
+        free(ps);
+        return NULL;
+    }
+    return ps;
+}
+
+/*! Find private candidate of session
+ */
+static struct private_candidate *
+private_find(struct private_state *ps,
+             uint32_t              id)
+{
+    struct private_candidate *pc;
+
+    if (ps == NULL)
+        return NULL;
+    for (pc = ps->ps_candidates; pc; pc = pc->pc_next)
+        if (pc->pc_id == id)
+            return pc;
+    return NULL;
+}
+
+/*! Free list of recorded edits
+ */
+static void
+private_edits_free(struct private_edit *pe)
+{
+    struct private_edit *pe1;
+
+    while ((pe1 = pe) != NULL){
+        pe = pe->pe_next;
+        if (pe1->pe_xc)
+            xml_free(pe1->pe_xc);
+        free(pe1);
+    }
+}
+
+/*! Create a recorded edit
+ *
+ * @param[in]  xc   Edit <config>, copied
+ * @param[in]  op   Default operation
+ * @retval     pe   Recorded edit
+ * @retval     NULL Error
+ */
+static struct private_edit *
+private_edit_new(cxobj              *xc,
+                 enum operation_type op)
+{
+    struct private_edit *pe;
+
+    if ((pe = calloc(1, sizeof(*pe))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    pe->pe_op = op;
+    if ((pe->pe_xc = xml_dup(xc)) == NULL){
+        free(pe);
+        return NULL;
+    }
+    return pe;
+}
+
+/*! Remove recorded changes of running that no private candidate is based on
+ *
+ * @param[in]  ps  Private candidate state
+ */
+static void
+private_prune(struct private_state *ps)
+{
+    struct private_candidate *pc;
+    struct private_commit    *pm;
+    uint64_t                  base = UINT64_MAX;
+
+    for (pc = ps->ps_candidates; pc; pc = pc->pc_next)
+        if (pc->pc_base < base)
+            base = pc->pc_base;
+    while ((pm = ps->ps_commits) != NULL && pm->pm_prev < base){
+        ps->ps_commits = pm->pm_next;
+        private_edits_free(pm->pm_edits);
+        free(pm);
+    }
+    if (ps->ps_commits == NULL)
+        ps->ps_last = &ps->ps_commits;
+}
+
+/*! Record a change of running, if there are private candidates
+ *
+ * @param[in]  ps        Private candidate state
+ * @param[in]  prev      Version of running before change
+ * @param[in]  version   Version of running after change
+ * @param[in]  edits     Edits of change, taken over, or NULL
+ * @param[in]  replaced  Change is not known by its edits
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+private_commit_add(struct private_state *ps,
+                   uint64_t              prev,
+                   uint64_t              version,
+                   struct private_edit  *edits,
+                   int                   replaced)
+{
+    struct private_commit *pm;
+
+    if (ps->ps_candidates == NULL || prev == version){
+        private_edits_free(edits);
+        return 0;
+    }
+    if ((pm = calloc(1, sizeof(*pm))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        private_edits_free(edits);
+        return -1;
+    }
+    pm->pm_prev = prev;
+    pm->pm_version = version;
+    pm->pm_edits = edits;
+    pm->pm_replaced = replaced;
+    *ps->ps_last = pm;
+    ps->ps_last = &pm->pm_next;
+    return 0;
+}
+
+/*! Reset private candidate to running, drop its edits
+ *
+ * @param[in]  h   Clixon handle
+ * @param[in]  pc  Private candidate
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+private_reset(clicon_handle             h,
+              struct private_candidate *pc)
+{
+    if (xmldb_copy(h, "running", pc->pc_db) < 0)
+        return -1;
+    xmldb_modified_set(h, pc->pc_db, 0);
+    if (xmldb_version_get(h, "running", &pc->pc_base, NULL) < 0)
+        return -1;
+    private_edits_free(pc->pc_edits);
+    pc->pc_edits = NULL;
+    pc->pc_last = &pc->pc_edits;
+    pc->pc_replaced = 0;
+    return 0;
+}
+
+/*! Get name of private candidate of a session, create it from running if not found
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  id   Session id
+ * @param[out] db   Datastore name, do not free
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+backend_private_db(clicon_handle h,
+                   uint32_t      id,
+                   char        **db)
+{
+    struct private_state     *ps;
+    struct private_candidate *pc;
+    cbuf                     *cb = NULL;
+
+    if ((ps = private_state_get(h, 1)) == NULL)
+        return -1;
+    if ((pc = private_find(ps, id)) == NULL){
+        if ((pc = calloc(1, sizeof(*pc))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        pc->pc_id = id;
+        pc->pc_last = &pc->pc_edits;
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            free(pc);
+            return -1;
+        }
+        cprintf(cb, "candidate-%u", id);
+        if ((pc->pc_db = strdup(cbuf_get(cb))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            cbuf_free(cb);
+            free(pc);
+            return -1;
+        }
+        cbuf_free(cb);
+        pc->pc_next = ps->ps_candidates;
+        ps->ps_candidates = pc;
+        if (private_reset(h, pc) < 0)
+            return -1;
+        clicon_debug(CLIXON_DBG_DEFAULT, "%s %s", __FUNCTION__, pc->pc_db);
+    }
+    *db = pc->pc_db;
+    return 0;
+}
+
+/*! Replace candidate datastore of an RPC with the private candidate of the session
+ *
+ * The first child of <source> and <target> named candidate is renamed, eg
+ * <get-config><source><candidate/></source></get-config>
+ * @param[in]  h    Clixon handle
+ * @param[in]  id   Session id
+ * @param[in]  xe   RPC, eg <get-config>
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+backend_private_rpc(clicon_handle h,
+                    uint32_t      id,
+                    cxobj        *xe)
+{
+    cxobj *x = NULL;
+    cxobj *xi;
+    char  *db;
+
+    while ((x = xml_child_each(xe, x, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(x), "source") != 0 && strcmp(xml_name(x), "target") != 0)
+            continue;
+        if ((xi = xml_child_i(x, 0)) == NULL ||
+            xml_type(xi) != CX_ELMNT ||
+            strcmp(xml_name(xi), "candidate") != 0)
+            continue;
+        if (backend_private_db(h, id, &db) < 0)
+            return -1;
+        if (xml_name_set(xi, db) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Record an edit of a datastore, if it is the private candidate of the session
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  id   Session id
+ * @param[in]  db   Edited datastore
+ * @param[in]  xc   Edit <config>, copied, or NULL if the datastore is replaced
+ * @param[in]  op   Default operation
+ * @retval     1    Private candidate of session
+ * @retval     0    Not a private candidate
+ * @retval    -1    Error
+ */
+int
+backend_private_edit(clicon_handle       h,
+                     uint32_t            id,
+                     const char         *db,
+                     cxobj              *xc,
+                     enum operation_type op)
+{
+    struct private_candidate *pc;
+    struct private_edit      *pe;
+
+    if ((pc = private_find(private_state_get(h, 0), id)) == NULL ||
+        strcmp(db, pc->pc_db) != 0)
+        return 0;
+    if (xc == NULL || op == OP_REPLACE)
+        pc->pc_replaced = 1;
+    if (xc != NULL){
+        if ((pe = private_edit_new(xc, op)) == NULL)
+            return -1;
+        *pc->pc_last = pe;
+        pc->pc_last = &pe->pe_next;
+    }
+    return 1;
+}
+
+/*! Record a direct change of running, eg edit-config or copy-config with target running
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  prev  Version of running before change
+ * @param[in]  xc    Edit <config>, copied, or NULL if running is replaced
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+backend_private_running(clicon_handle h,
+                        uint64_t      prev,
+                        cxobj        *xc)
+{
+    struct private_state *ps;
+    struct private_edit  *pe = NULL;
+    uint64_t              version;
+
+    if ((ps = private_state_get(h, 0)) == NULL || ps->ps_candidates == NULL)
+        return 0;
+    if (xmldb_version_get(h, "running", &version, NULL) < 0)
+        return -1;
+    if (xc != NULL && (pe = private_edit_new(xc, OP_MERGE)) == NULL)
+        return -1;
+    return private_commit_add(ps, prev, version, pe, xc == NULL);
+}
+
+/*! Check if the edits of a private candidate conflict with the changes of running since its base
+ *
+ * @param[in]  ps       Private candidate state
+ * @param[in]  pc       Private candidate
+ * @param[in]  version  Version of running
+ * @param[out] cbret    Error reply if conflict
+ * @retval     1        No conflict
+ * @retval     0        Conflict, cbret set
+ * @retval    -1        Error
+ */
+static int
+private_conflict(struct private_state     *ps,
+                 struct private_candidate *pc,
+                 uint64_t                  version,
+                 cbuf                     *cbret)
+{
+    struct private_commit *pm;
+    struct private_edit   *pe;
+    struct private_edit   *pe1;
+    uint64_t               v = pc->pc_base;
+    int                    ret;
+
+    while (v != version){
+        for (pm = ps->ps_commits; pm; pm = pm->pm_next)
+            if (pm->pm_prev == v)
+                break;
+        if (pm == NULL || pm->pm_replaced || pc->pc_replaced)
+            goto fail;
+        for (pe = pc->pc_edits; pe; pe = pe->pe_next)
+            for (pe1 = pm->pm_edits; pe1; pe1 = pe1->pe_next){
+                if ((ret = xml_edit_conflict(pe1->pe_xc, pe->pe_xc)) < 0)
+                    return -1;
+                if (ret == 1)
+                    goto fail;
+            }
+        v = pm->pm_version;
+    }
+    return 1;
+ fail:
+    if (netconf_operation_failed(cbret, "application",
+                                 "Private candidate conflicts with changes of running, discard changes and edit again") < 0)
+        return -1;
+    return 0;
+}
+
+/*! Apply the edits of a private candidate to the latest running
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  ps        Private candidate state
+ * @param[in]  pc        Private candidate
+ * @param[in]  username  User of edits, for NACM
+ * @param[out] cbret     Error reply if conflict or edit fails
+ * @retval     1         OK, candidate is based on running
+ * @retval     0         Conflict or failed edit, cbret set
+ * @retval    -1         Error
+ */
+static int
+private_rebase(clicon_handle             h,
+               struct private_state     *ps,
+               struct private_candidate *pc,
+               char                     *username,
+               cbuf                     *cbret)
+{
+    int                  retval = -1;
+    struct private_edit *pe;
+    cxobj               *xc = NULL;
+    uint64_t             version;
+    int                  ret;
+
+    if (xmldb_version_get(h, "running", &version, NULL) < 0)
+        goto done;
+    if (version == pc->pc_base)
+        goto ok;
+    if ((ret = private_conflict(ps, pc, version, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s %s", __FUNCTION__, pc->pc_db);
+    if (xmldb_copy(h, "running", pc->pc_db) < 0)
+        goto done;
+    for (pe = pc->pc_edits; pe; pe = pe->pe_next){
+        if ((xc = xml_dup(pe->pe_xc)) == NULL)
+            goto done;
+        if ((ret = xmldb_put(h, pc->pc_db, pe->pe_op, xc, username, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        xml_free(xc);
+        xc = NULL;
+    }
+    xmldb_modified_set(h, pc->pc_db, 1);
+    pc->pc_base = version;
+ ok:
+    retval = 1;
+ done:
+    if (xc)
+        xml_free(xc);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Commit the private candidate of a session, rebase it first if running has changed
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  xe     Request: <rpc><commit/></rpc>, or NULL
+ * @param[in]  id     Session id
+ * @param[out] cbret  Error reply if validation fails or conflict
+ * @retval     1      OK
+ * @retval     0      Validation failed or conflict, cbret set
+ * @retval    -1      Error
+ * @see candidate_commit
+ */
+int
+backend_private_commit(clicon_handle h,
+                       cxobj        *xe,
+                       uint32_t      id,
+                       cbuf         *cbret)
+{
+    struct private_state     *ps;
+    struct private_candidate *pc;
+    char                     *db;
+    uint64_t                  prev;
+    uint64_t                  version;
+    int                       ret;
+
+    if (backend_private_db(h, id, &db) < 0)
+        return -1;
+    ps = private_state_get(h, 0);
+    pc = private_find(ps, id);
+    if ((ret = private_rebase(h, ps, pc, clicon_username_get(h), cbret)) <= 0)
+        return ret;
+    prev = pc->pc_base;
+    if ((ret = candidate_commit(h, xe, db, id, 0, cbret)) <= 0)
+        return ret;
+    if (xmldb_version_get(h, "running", &version, NULL) < 0)
+        return -1;
+    if (private_commit_add(ps, prev, version, pc->pc_edits, pc->pc_replaced) < 0)
+        return -1;
+    pc->pc_edits = NULL;
+    pc->pc_last = &pc->pc_edits;
+    pc->pc_replaced = 0;
+    pc->pc_base = version;
+    private_prune(ps);
+    return 1;
+}
+
+/*! Reset the private candidate of a session to running, eg discard-changes
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  id   Session id
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+backend_private_discard(clicon_handle h,
+                        uint32_t      id)
+{
+    struct private_state     *ps;
+    struct private_candidate *pc;
+    char                     *db;
+
+    if (backend_private_db(h, id, &db) < 0)
+        return -1;
+    ps = private_state_get(h, 0);
+    if ((pc = private_find(ps, id)) == NULL)
+        return 0;
+    if (private_reset(h, pc) < 0)
+        return -1;
+    private_prune(ps);
+    return 0;
+}
+
+/*! Session is closed: delete its private candidate
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  id   Session id
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+backend_private_rm(clicon_handle h,
+                   uint32_t      id)
+{
+    struct private_state      *ps;
+    struct private_candidate **pcp;
+    struct private_candidate  *pc;
+    int                        retval = 0;
+
+    if ((ps = private_state_get(h, 0)) == NULL)
+        return 0;
+    for (pcp = &ps->ps_candidates; (pc = *pcp) != NULL; pcp = &pc->pc_next)
+        if (pc->pc_id == id)
+            break;
+    if (pc == NULL)
+        return 0;
+    *pcp = pc->pc_next;
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s %s", __FUNCTION__, pc->pc_db);
+    if (xmldb_delete(h, pc->pc_db) < 0)
+        retval = -1;
+    private_edits_free(pc->pc_edits);
+    free(pc->pc_db);
+    free(pc);
+    private_prune(ps);
+    return retval;
+}
+
+/*! Free private candidate state of handle
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ */
+int
+backend_private_free(clicon_handle h)
+{
+    struct private_state     *ps;
+    struct private_candidate *pc;
+
+    if ((ps = private_state_get(h, 0)) == NULL)
+        return 0;
+    while ((pc = ps->ps_candidates) != NULL){
+        ps->ps_candidates = pc->pc_next;
+        private_edits_free(pc->pc_edits);
+        free(pc->pc_db);
+        free(pc);
+    }
+    private_prune(ps);
+    free(ps);
+    clicon_ptr_del(h, PRIVATE_STATE_NAME);
+    return 0;
+}
@@ -0,0 +1,1025 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+  On-change push of running datastore changes, subset of RFC 8641 YANG-Push
+  A client subscribes with the clixon-lib datastore-push rpc with an xpath selecting the
+  running datastore nodes of interest. After each commit, the changes of the transaction are
+  matched against the subscriptions and a push-change-update notification with a yang-patch
+  (RFC 8072) of the changes is sent to the subscriber.
+  Subscriptions are indexed by the top-level schema node of their xpath, the xpath is only
+  evaluated if the commit changes that schema node.
+  With a dampening period, changes are collected and sent at most once per period.
+  A periodic subscription instead gets a push-update notification with the selected config and
+  state data every period. Subscriptions with the same xpath, period and user share one sample,
+  and samples of the same period are aligned to multiples of the period.
+  If CLICON_STREAM_DATASTORE is set, the top-level nodes changed by a commit are also sent
+  in a datastore-changed notification on the CLIXON-DATASTORE stream, for frontend caches.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+#include "clixon_backend_plugin.h"
+#include "backend_get.h"
+#include "backend_push.h"
+
+#define PUSH_STATE_NAME "yang-push-state"
+
+/* Periodic sample shared by subscriptions with same xpath, period and user
+ */
+struct push_sample{
+    qelem_t         pg_q;          /* queue header */
+    clicon_handle   pg_h;          /* Clixon handle, for timer callback */
+    char           *pg_xpath;      /* Datastore selector as xpath */
+    cvec           *pg_nsc;        /* Namespace context of xpath */
+    char           *pg_username;   /* User for NACM read access, or NULL */
+    struct timeval  pg_period;     /* Sample period */
+    struct timeval  pg_next;       /* Time of next sample */
+    int             pg_refs;       /* Nr of subscriptions using sample */
+};
+
+/* On-change or periodic subscription of running datastore
+ */
+struct push_subscription{
+    qelem_t         ps_q;          /* queue header */
+    uint32_t        ps_id;         /* Subscription id */
+    clicon_handle   ps_h;          /* Clixon handle, for timer callback */
+    char           *ps_xpath;      /* Datastore selector as xpath */
+    cvec           *ps_nsc;        /* Namespace context of xpath */
+    yang_stmt      *ps_ytop;       /* Top-level schema node of xpath, or NULL if unknown */
+    struct timeval  ps_dampening;  /* Minimum time between updates */
+    struct timeval  ps_last;       /* Time of last update */
+    cxobj          *ps_patch;      /* Pending yang-patch, or NULL */
+    uint32_t        ps_patch_id;   /* Next patch-id */
+    uint32_t        ps_edit_id;    /* Last edit-id in pending patch */
+    int             ps_timer;      /* Set if update timer is registered */
+    struct push_sample *ps_sample; /* Periodic sample, or NULL if on-change */
+    stream_fn_t     ps_fn;         /* Callback to send update */
+    void           *ps_arg;        /* Callback argument, eg client entry */
+};
+
+/* Push subscriptions of handle
+ */
+struct push_state{
+    struct push_subscription *pu_subscriptions;
+    struct push_sample       *pu_samples;
+    uint32_t                  pu_id;   /* Last subscription id */
+    yang_stmt               **pu_ymark; /* Marked top-level schema nodes of commit */
+    size_t                    pu_ymarklen;
+    size_t                    pu_ymarksize;
+    cbuf                     *pu_changed; /* Subtrees of commit to datastore stream, or NULL */
+};
+
+static int push_send(int fd, void *arg);
+static int push_sample_send(int fd, void *arg);
+static void push_sample_put(struct push_state *pu, struct push_sample *pg);
+static void push_subscription_free(struct push_subscription *ps);
+
+/*! Get push state of handle, create if not found
+ */
+static struct push_state *
+push_state_get_create(clicon_handle h)
+{
+    struct push_state *pu = NULL;
+
+    if (clicon_ptr_get(h, PUSH_STATE_NAME, (void**)&pu) == 0 && pu != NULL)
+        return pu;
+    if ((pu = calloc(1, sizeof(*pu))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    if (clicon_ptr_set(h, PUSH_STATE_NAME, pu) < 0){
+        free(pu);
+        return NULL;
+    }
+    return pu;
+}
+
+/*! Find the top-level schema node of an absolute location path
+ *
+ * Only a simple leading step, eg /ex:a/..., is recognized. Otherwise, eg with unions or
+ * descendant axes, the subscription is matched with any commit.
+ * @param[in]  yspec  Yang spec
+ * @param[in]  xpath  Xpath
+ * @param[in]  nsc    Namespace context of xpath
+ * @retval     ytop   Top-level schema data node
+ * @retval     NULL   Not known
+ */
+static yang_stmt *
+push_xpath_top(yang_stmt *yspec,
+               char      *xpath,
+               cvec      *nsc)
+{
+    yang_stmt *ymod;
+    char      *name;
+    char      *prefix = NULL;
+    char      *ns;
+    size_t     len;
+    char       step[128];
+    char      *p;
+
+    if (nsc == NULL || xpath[0] != '/' || xpath[1] == '/' || strchr(xpath, '|') != NULL)
+        return NULL;
+    len = strcspn(xpath+1, "/[ ");
+    if (len == 0 || len >= sizeof(step))
+        return NULL;
+    memcpy(step, xpath+1, len);
+    step[len] = '\0';
+    if ((p = strchr(step, ':')) != NULL){
+        *p = '\0';
+        prefix = step;
+        name = p+1;
+    }
+    else
+        name = step;
+    if ((ns = xml_nsctx_get(nsc, prefix)) == NULL)
+        return NULL;
+    if ((ymod = yang_find_module_by_namespace(yspec, ns)) == NULL)
+        return NULL;
+    return yang_find_datanode(ymod, name);
+}
+
+/*! Add an on-change subscription of the running datastore
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  xpath     Selector of datastore nodes
+ * @param[in]  nsc       Namespace context of xpath, copied
+ * @param[in]  dampening Minimum time between updates in centiseconds, or 0
+ * @param[in]  fn        Callback to send update notification
+ * @param[in]  arg       Callback argument, also used when deleting
+ * @param[out] id        Subscription id
+ * @retval     1         OK
+ * @retval     0         Invalid xpath
+ * @retval    -1         Error
+ */
+int
+backend_push_add(clicon_handle h,
+                 char         *xpath,
+                 cvec         *nsc,
+                 uint32_t      dampening,
+                 stream_fn_t   fn,
+                 void         *arg,
+                 uint32_t     *id)
+{
+    int                       retval = -1;
+    struct push_state        *pu;
+    struct push_subscription *ps = NULL;
+    xpath_tree               *xptree = NULL;
+
+    if (xpath_parse(xpath, &xptree) < 0)
+        goto fail;
+    if ((pu = push_state_get_create(h)) == NULL)
+        goto done;
+    if ((ps = calloc(1, sizeof(*ps))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((ps->ps_xpath = strdup(xpath)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (nsc && (ps->ps_nsc = cvec_dup(nsc)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_dup");
+        goto done;
+    }
+    ps->ps_h = h;
+    ps->ps_id = ++pu->pu_id;
+    ps->ps_ytop = push_xpath_top(clicon_dbspec_yang(h), xpath, nsc);
+    ps->ps_dampening.tv_sec = dampening/100;
+    ps->ps_dampening.tv_usec = (dampening%100)*10000;
+    ps->ps_fn = fn;
+    ps->ps_arg = arg;
+    ADDQ(ps, pu->pu_subscriptions);
+    *id = ps->ps_id;
+    ps = NULL;
+    retval = 1;
+ done:
+    if (ps)
+        push_subscription_free(ps);
+    if (xptree)
+        xpath_tree_free(xptree);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Check if two namespace contexts are equal
+ */
+static int
+push_nsc_eq(cvec *nsc1,
+            cvec *nsc2)
+{
+    cg_var *cv1 = NULL;
+    cg_var *cv2 = NULL;
+    char   *n1;
+    char   *n2;
+
+    if (nsc1 == NULL || nsc2 == NULL)
+        return nsc1 == nsc2;
+    if (cvec_len(nsc1) != cvec_len(nsc2))
+        return 0;
+    while ((cv1 = cvec_each(nsc1, cv1)) != NULL &&
+           (cv2 = cvec_each(nsc2, cv2)) != NULL){
+        n1 = cv_name_get(cv1);
+        n2 = cv_name_get(cv2);
+        if ((n1 == NULL || n2 == NULL) ? n1 != n2 : strcmp(n1, n2) != 0)
+            return 0;
+        if (strcmp(cv_string_get(cv1), cv_string_get(cv2)) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+/*! Schedule next sample at the next multiple of its period
+ *
+ * All samples with the same period are taken at the same time
+ */
+static int
+push_sample_schedule(struct push_sample *pg)
+{
+    struct timeval now;
+    uint64_t       us;
+    uint64_t       period;
+
+    gettimeofday(&now, NULL);
+    period = (uint64_t)pg->pg_period.tv_sec*1000000 + pg->pg_period.tv_usec;
+    us = (uint64_t)now.tv_sec*1000000 + now.tv_usec;
+    us = (us/period + 1)*period;
+    pg->pg_next.tv_sec = us/1000000;
+    pg->pg_next.tv_usec = us%1000000;
+    return clixon_event_reg_timeout(pg->pg_next, push_sample_send, pg, "yang-push sample");
+}
+
+/*! Get a shared periodic sample, create and schedule it if not found
+ *
+ * @param[in]  pu       Push state
+ * @param[in]  h        Clixon handle
+ * @param[in]  xpath    Datastore selector
+ * @param[in]  nsc      Namespace context of xpath
+ * @param[in]  period   Period, centiseconds
+ * @param[in]  username User for NACM, or NULL
+ * @retval     pg       Sample, reference counted
+ * @retval     NULL     Error
+ */
+static struct push_sample *
+push_sample_get(struct push_state *pu,
+                clicon_handle      h,
+                char              *xpath,
+                cvec              *nsc,
+                uint32_t           period,
+                char              *username)
+{
+    struct push_sample *pg;
+
+    if ((pg = pu->pu_samples) != NULL)
+        do {
+            if (strcmp(pg->pg_xpath, xpath) == 0 &&
+                (uint64_t)pg->pg_period.tv_sec*100 + pg->pg_period.tv_usec/10000 == period &&
+                (username == NULL || pg->pg_username == NULL ?
+                 username == pg->pg_username : strcmp(username, pg->pg_username) == 0) &&
+                push_nsc_eq(pg->pg_nsc, nsc)){
+                pg->pg_refs++;
+                return pg;
+            }
+            pg = NEXTQ(struct push_sample *, pg);
+        } while (pg && pg != pu->pu_samples);
+    if ((pg = calloc(1, sizeof(*pg))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    pg->pg_h = h;
+    pg->pg_period.tv_sec = period/100;
+    pg->pg_period.tv_usec = (period%100)*10000;
+    if ((pg->pg_xpath = strdup(xpath)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto err;
+    }
+    if (nsc && (pg->pg_nsc = cvec_dup(nsc)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_dup");
+        goto err;
+    }
+    if (username && (pg->pg_username = strdup(username)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto err;
+    }
+    if (push_sample_schedule(pg) < 0)
+        goto err;
+    pg->pg_refs = 1;
+    ADDQ(pg, pu->pu_samples);
+    return pg;
+ err:
+    if (pg->pg_xpath)
+        free(pg->pg_xpath);
+    if (pg->pg_nsc)
+        cvec_free(pg->pg_nsc);
+    if (pg->pg_username)
+        free(pg->pg_username);
+    free(pg);
+    return NULL;
+}
+
+/*! Release a shared periodic sample, stop and free it if no subscription uses it
+ */
+static void
+push_sample_put(struct push_state  *pu,
+                struct push_sample *pg)
+{
+    if (--pg->pg_refs > 0)
+        return;
+    clixon_event_unreg_timeout(push_sample_send, pg);
+    DELQ(pg, pu->pu_samples, struct push_sample *);
+    free(pg->pg_xpath);
+    if (pg->pg_nsc)
+        cvec_free(pg->pg_nsc);
+    if (pg->pg_username)
+        free(pg->pg_username);
+    free(pg);
+}
+
+/*! Add a periodic subscription of config and state data
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  xpath     Selector of datastore nodes
+ * @param[in]  nsc       Namespace context of xpath, copied
+ * @param[in]  period    Period in centiseconds, > 0
+ * @param[in]  username  User for NACM read access of samples, or NULL
+ * @param[in]  fn        Callback to send update notification
+ * @param[in]  arg       Callback argument, also used when deleting
+ * @param[out] id        Subscription id
+ * @retval     1         OK
+ * @retval     0         Invalid xpath
+ * @retval    -1         Error
+ */
+int
+backend_push_periodic_add(clicon_handle h,
+                          char         *xpath,
+                          cvec         *nsc,
+                          uint32_t      period,
+                          char         *username,
+                          stream_fn_t   fn,
+                          void         *arg,
+                          uint32_t     *id)
+{
+    int                       retval = -1;
+    struct push_state        *pu;
+    struct push_subscription *ps = NULL;
+    xpath_tree               *xptree = NULL;
+
+    if (xpath_parse(xpath, &xptree) < 0)
+        goto fail;
+    if ((pu = push_state_get_create(h)) == NULL)
+        goto done;
+    if ((ps = calloc(1, sizeof(*ps))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    ps->ps_h = h;
+    if ((ps->ps_sample = push_sample_get(pu, h, xpath, nsc, period, username)) == NULL)
+        goto done;
+    ps->ps_id = ++pu->pu_id;
+    ps->ps_fn = fn;
+    ps->ps_arg = arg;
+    ADDQ(ps, pu->pu_subscriptions);
+    *id = ps->ps_id;
+    ps = NULL;
+    retval = 1;
+ done:
+    if (ps)
+        push_subscription_free(ps);
+    if (xptree)
+        xpath_tree_free(xptree);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Free a push subscription
+ */
+static void
+push_subscription_free(struct push_subscription *ps)
+{
+    struct push_state *pu = NULL;
+
+    if (ps->ps_timer)
+        clixon_event_unreg_timeout(push_send, ps);
+    if (ps->ps_sample &&
+        clicon_ptr_get(ps->ps_h, PUSH_STATE_NAME, (void**)&pu) == 0 && pu != NULL)
+        push_sample_put(pu, ps->ps_sample);
+    if (ps->ps_xpath)
+        free(ps->ps_xpath);
+    if (ps->ps_nsc)
+        cvec_free(ps->ps_nsc);
+    if (ps->ps_patch)
+        xml_free(ps->ps_patch);
+    free(ps);
+}
+
+/*! Remove all push subscriptions identified with fn and arg, eg when a client is removed
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  fn   Callback
+ * @param[in]  arg  Callback argument, eg client entry
+ * @retval     0    OK
+ */
+int
+backend_push_delete_all(clicon_handle h,
+                        stream_fn_t   fn,
+                        void         *arg)
+{
+    struct push_state        *pu = NULL;
+    struct push_subscription *ps;
+    struct push_subscription *ps1;
+
+    if (clicon_ptr_get(h, PUSH_STATE_NAME, (void**)&pu) < 0 || pu == NULL)
+        return 0;
+    if ((ps = pu->pu_subscriptions) != NULL)
+        do {
+            ps1 = NEXTQ(struct push_subscription *, ps);
+            if (ps->ps_fn == fn && ps->ps_arg == arg){
+                DELQ(ps, pu->pu_subscriptions, struct push_subscription *);
+                push_subscription_free(ps);
+                if (pu->pu_subscriptions == NULL)
+                    break;
+            }
+            ps = ps1;
+        } while (ps != pu->pu_subscriptions);
+    return 0;
+}
+
+/*! Send pending yang-patch of a subscription as push-change-update notification
+ *
+ * @param[in]  fd   No-op
+ * @param[in]  arg  Push subscription
+ * @note format is given by clixon_event_reg_timeout callback function
+ */
+static int
+push_send(int   fd,
+          void *arg)
+{
+    int                       retval = -1;
+    struct push_subscription *ps = (struct push_subscription *)arg;
+    cxobj                    *xn = NULL;
+    cxobj                    *xu;
+    cxobj                    *xc;
+    char                      timestr[28];
+    char                      idstr[16];
+
+    ps->ps_timer = 0;
+    if (ps->ps_patch == NULL)
+        goto ok;
+    gettimeofday(&ps->ps_last, NULL);
+    if (time2str(&ps->ps_last, timestr, sizeof(timestr)) < 0){
+        clicon_err(OE_UNIX, errno, "time2str");
+        goto done;
+    }
+    if ((xn = xml_new("notification", NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xmlns_set(xn, NULL, NETCONF_NOTIFICATION_NAMESPACE) < 0)
+        goto done;
+    if (xml_new_body("eventTime", xn, timestr) == NULL)
+        goto done;
+    if ((xu = xml_new("push-change-update", xn, CX_ELMNT)) == NULL)
+        goto done;
+    if (xmlns_set(xu, NULL, YANG_PUSH_NAMESPACE) < 0)
+        goto done;
+    snprintf(idstr, sizeof(idstr), "%" PRIu32, ps->ps_id);
+    if (xml_new_body("id", xu, idstr) == NULL)
+        goto done;
+    if ((xc = xml_new("datastore-changes", xu, CX_ELMNT)) == NULL)
+        goto done;
+    if (xml_addsub(xc, ps->ps_patch) < 0)
+        goto done;
+    ps->ps_patch = NULL;
+    /* Callback may remove the subscription */
+    if ((*ps->ps_fn)(ps->ps_h, 0, xn, ps->ps_arg) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (xn)
+        xml_free(xn);
+    return retval;
+}
+
+/*! Schedule sending of pending yang-patch, after dampening period since last update
+ */
+static int
+push_schedule(struct push_subscription *ps)
+{
+    struct timeval now;
+    struct timeval t;
+
+    if (ps->ps_timer)
+        return 0;
+    gettimeofday(&now, NULL);
+    timeradd(&ps->ps_last, &ps->ps_dampening, &t);
+    if (timercmp(&t, &now, <))
+        t = now;
+    if (clixon_event_reg_timeout(t, push_send, ps, "yang-push update") < 0)
+        return -1;
+    ps->ps_timer = 1;
+    return 0;
+}
+
+/*! Take a periodic sample and send it as push-update notification to all its subscriptions
+ *
+ * The sample is read once and the same notification is sent to each subscription, with only
+ * the subscription id changed.
+ * @param[in]  fd   No-op
+ * @param[in]  arg  Push sample
+ * @note format is given by clixon_event_reg_timeout callback function
+ */
+static int
+push_sample_send(int   fd,
+                 void *arg)
+{
+    int                       retval = -1;
+    struct push_sample       *pg = (struct push_sample *)arg;
+    struct push_state        *pu = NULL;
+    struct push_subscription *ps;
+    struct timeval            now;
+    cxobj                    *xt = NULL;
+    cxobj                    *xn = NULL;
+    cxobj                    *xu;
+    cxobj                    *xid;
+    cxobj                    *xc;
+    cxobj                    *x;
+    char                      timestr[28];
+    char                      idstr[16];
+    int                       ret;
+
+    if (clicon_ptr_get(pg->pg_h, PUSH_STATE_NAME, (void**)&pu) < 0 || pu == NULL)
+        goto ok;
+    if ((ret = backend_get_sample(pg->pg_h, pg->pg_xpath, pg->pg_nsc, pg->pg_username, &xt)) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_log(LOG_WARNING, "%s: sample of %s failed, push-update skipped", __FUNCTION__, pg->pg_xpath);
+        goto next;
+    }
+    gettimeofday(&now, NULL);
+    if (time2str(&now, timestr, sizeof(timestr)) < 0){
+        clicon_err(OE_UNIX, errno, "time2str");
+        goto done;
+    }
+    if ((xn = xml_new("notification", NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xmlns_set(xn, NULL, NETCONF_NOTIFICATION_NAMESPACE) < 0)
+        goto done;
+    if (xml_new_body("eventTime", xn, timestr) == NULL)
+        goto done;
+    if ((xu = xml_new("push-update", xn, CX_ELMNT)) == NULL)
+        goto done;
+    if (xmlns_set(xu, NULL, YANG_PUSH_NAMESPACE) < 0)
+        goto done;
+    if ((xid = xml_new_body("id", xu, "0")) == NULL)
+        goto done;
+    if ((xc = xml_new("datastore-contents", xu, CX_ELMNT)) == NULL)
+        goto done;
+    while ((x = xml_child_i_type(xt, 0, CX_ELMNT)) != NULL){
+        if (xml_addsub(xc, x) < 0)
+            goto done;
+    }
+    if ((ps = pu->pu_subscriptions) != NULL)
+        do {
+            if (ps->ps_sample == pg){
+                snprintf(idstr, sizeof(idstr), "%" PRIu32, ps->ps_id);
+                if (xml_value_set(xml_body_get(xid), idstr) < 0)
+                    goto done;
+                if ((*ps->ps_fn)(ps->ps_h, 0, xn, ps->ps_arg) < 0)
+                    goto done;
+            }
+            ps = NEXTQ(struct push_subscription *, ps);
+        } while (ps && ps != pu->pu_subscriptions);
+ next:
+    /* Next multiple of period, skip samples if behind */
+    timeradd(&pg->pg_next, &pg->pg_period, &pg->pg_next);
+    gettimeofday(&now, NULL);
+    if (timercmp(&pg->pg_next, &now, <)){
+        if (push_sample_schedule(pg) < 0)
+            goto done;
+    }
+    else if (clixon_event_reg_timeout(pg->pg_next, push_sample_send, pg, "yang-push sample") < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (xn)
+        xml_free(xn);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Append api-path of a data node to a cbuf
+ */
+static int
+push_api_path(cxobj *x,
+              cbuf  *cb)
+{
+    cxobj *xp;
+
+    if ((xp = xml_parent(x)) != NULL && xml_spec(xp) != NULL)
+        if (push_api_path(xp, cb) < 0)
+            return -1;
+    return xml2api_path_1(x, cb);
+}
+
+/*! Add edit to pending yang-patch of a subscription
+ *
+ * @param[in]  ps   Push subscription
+ * @param[in]  op   Yang-patch operation: create, delete or replace
+ * @param[in]  x    Changed data node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+push_edit_add(struct push_subscription *ps,
+              char                     *op,
+              cxobj                    *x)
+{
+    int    retval = -1;
+    cxobj *xe;
+    cxobj *xv;
+    cxobj *xc;
+    cbuf  *cb = NULL;
+    cvec  *nsc = NULL;
+    char   idstr[24];
+
+    if (ps->ps_patch == NULL){
+        if ((ps->ps_patch = xml_new("yang-patch", NULL, CX_ELMNT)) == NULL)
+            goto done;
+        if (xmlns_set(ps->ps_patch, NULL, YANG_PATCH_NAMESPACE) < 0)
+            goto done;
+        snprintf(idstr, sizeof(idstr), "%" PRIu32, ps->ps_patch_id++);
+        if (xml_new_body("patch-id", ps->ps_patch, idstr) == NULL)
+            goto done;
+        ps->ps_edit_id = 0;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (push_api_path(x, cb) < 0)
+        goto done;
+    if ((xe = xml_new("edit", ps->ps_patch, CX_ELMNT)) == NULL)
+        goto done;
+    snprintf(idstr, sizeof(idstr), "edit%" PRIu32, ++ps->ps_edit_id);
+    if (xml_new_body("edit-id", xe, idstr) == NULL)
+        goto done;
+    if (xml_new_body("operation", xe, op) == NULL)
+        goto done;
+    if (xml_new_body("target", xe, cbuf_get(cb)) == NULL)
+        goto done;
+    if (strcmp(op, "delete") != 0){
+        if ((xv = xml_new("value", xe, CX_ELMNT)) == NULL)
+            goto done;
+        if (xml_nsctx_node(x, &nsc) < 0)
+            goto done;
+        if ((xc = xml_dup(x)) == NULL)
+            goto done;
+        if (xml_addsub(xv, xc) < 0)
+            goto done;
+        /* Namespaces declared by ancestors of x */
+        if (xmlns_set_all(xc, nsc) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (nsc)
+        cvec_free(nsc);
+    return retval;
+}
+
+/*! Check if node is an ancestor of, or same as, another node
+ */
+static int
+push_ancestor(cxobj *xa,
+              cxobj *x)
+{
+    for (; x != NULL; x = xml_parent(x))
+        if (x == xa)
+            return 1;
+    return 0;
+}
+
+/*! Add edits of changed nodes selected by the xpath of a subscription
+ *
+ * A changed node is selected if it is inside a node selected by the xpath.
+ * If instead the changed node contains selected nodes, those are the edits.
+ * @param[in]  ps    Push subscription
+ * @param[in]  xt    Source or target tree of transaction
+ * @param[in]  op    Yang-patch operation
+ * @param[in]  xvec  Changed nodes in xt
+ * @param[in]  xlen  Length of xvec
+ * @retval     0     OK
+ * @retval    -1    Error
+ */
+static int
+push_match(struct push_subscription *ps,
+           cxobj                    *xt,
+           char                     *op,
+           cxobj                   **xvec,
+           int                       xlen)
+{
+    int     retval = -1;
+    cxobj **vec = NULL;
+    size_t  veclen = 0;
+    int     i;
+    size_t  j;
+
+    if (xlen == 0)
+        return 0;
+    if (xpath_vec(xt, ps->ps_nsc, "%s", &vec, &veclen, ps->ps_xpath) < 0)
+        goto done;
+    for (i=0; i<xlen; i++){
+        for (j=0; j<veclen; j++)
+            if (push_ancestor(vec[j], xvec[i]))
+                break;
+        if (j < veclen){
+            if (push_edit_add(ps, op, xvec[i]) < 0)
+                goto done;
+            continue;
+        }
+        for (j=0; j<veclen; j++)
+            if (push_ancestor(xvec[i], vec[j]) &&
+                push_edit_add(ps, op, vec[j]) < 0)
+                goto done;
+    }
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Mark top-level schema node of a changed node
+ */
+static int
+push_mark(struct push_state *pu,
+          cxobj             *x)
+{
+    yang_stmt *y;
+    cxobj     *xp;
+
+    while ((xp = xml_parent(x)) != NULL && xml_spec(xp) != NULL)
+        x = xp;
+    if ((y = xml_spec(x)) == NULL || yang_flag_get(y, YANG_FLAG_MARK))
+        return 0;
+    if (pu->pu_ymarklen == pu->pu_ymarksize){
+        pu->pu_ymarksize = pu->pu_ymarksize ? 2*pu->pu_ymarksize : 16;
+        if ((pu->pu_ymark = realloc(pu->pu_ymark, pu->pu_ymarksize*sizeof(yang_stmt *))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+    }
+    pu->pu_ymark[pu->pu_ymarklen++] = y;
+    yang_flag_set(y, YANG_FLAG_MARK);
+    return 0;
+}
+
+/*! Match changes of a commit against push subscriptions and schedule updates
+ *
+ * Call after a successful commit while the change vectors of the transaction are valid
+ * @param[in]  h    Clixon handle
+ * @param[in]  td   Transaction
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+backend_push_commit(clicon_handle       h,
+                    transaction_data_t *td)
+{
+    int                       retval = -1;
+    struct push_state        *pu = NULL;
+    struct push_subscription *ps;
+    event_stream_t           *es;
+    yang_stmt                *y;
+    int                       i;
+    size_t                    j;
+
+    /* Changes are only sent on datastore stream if there are subscribers */
+    if ((es = stream_find(h, CLIXON_DATASTORE_STREAM)) != NULL &&
+        es->es_subscription == NULL)
+        es = NULL;
+    if (es != NULL){
+        if ((pu = push_state_get_create(h)) == NULL)
+            return -1;
+    }
+    else if (clicon_ptr_get(h, PUSH_STATE_NAME, (void**)&pu) < 0 || pu == NULL ||
+             pu->pu_subscriptions == NULL)
+        return 0;
+    if (pu->pu_changed)
+        cbuf_reset(pu->pu_changed);
+    /* Index: mark top-level schema nodes changed by the commit */
+    for (i=0; i<td->td_dlen; i++)
+        if (push_mark(pu, td->td_dvec[i]) < 0)
+            goto done;
+    for (i=0; i<td->td_alen; i++)
+        if (push_mark(pu, td->td_avec[i]) < 0)
+            goto done;
+    for (i=0; i<td->td_clen; i++)
+        if (push_mark(pu, td->td_tcvec[i]) < 0)
+            goto done;
+    if (es != NULL && pu->pu_ymarklen){
+        if (pu->pu_changed == NULL &&
+            (pu->pu_changed = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        for (j=0; j<pu->pu_ymarklen; j++){
+            y = pu->pu_ymark[j];
+            cprintf(pu->pu_changed, "<subtree>/%s:%s</subtree>",
+                    yang_argument_get(ys_module(y)), yang_argument_get(y));
+        }
+    }
+    if ((ps = pu->pu_subscriptions) == NULL)
+        goto ok;
+    do {
+        if (ps->ps_sample == NULL &&
+            (ps->ps_ytop == NULL || yang_flag_get(ps->ps_ytop, YANG_FLAG_MARK))){
+            if (push_match(ps, td->td_src, "delete", td->td_dvec, td->td_dlen) < 0)
+                goto done;
+            if (push_match(ps, td->td_target, "create", td->td_avec, td->td_alen) < 0)
+                goto done;
+            if (push_match(ps, td->td_target, "replace", td->td_tcvec, td->td_clen) < 0)
+                goto done;
+            if (ps->ps_patch && push_schedule(ps) < 0)
+                goto done;
+        }
+        ps = NEXTQ(struct push_subscription *, ps);
+    } while (ps != pu->pu_subscriptions);
+ ok:
+    retval = 0;
+ done:
+    for (j=0; j<pu->pu_ymarklen; j++)
+        yang_flag_reset(pu->pu_ymark[j], YANG_FLAG_MARK);
+    pu->pu_ymarklen = 0;
+    return retval;
+}
+
+/*! Send top-level nodes changed by last commit on the datastore stream
+ *
+ * Call after running has been written, so that the notification has its new content version
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see backend_push_commit where the changed nodes are collected
+ */
+int
+backend_push_changed(clicon_handle h)
+{
+    int                retval = -1;
+    struct push_state *pu = NULL;
+    uint64_t           version;
+    struct timeval     tv;
+
+    if (clicon_ptr_get(h, PUSH_STATE_NAME, (void**)&pu) < 0 || pu == NULL ||
+        pu->pu_changed == NULL || cbuf_len(pu->pu_changed) == 0)
+        return 0;
+    if (xmldb_version_get(h, "running", &version, &tv) < 0)
+        goto done;
+    if (stream_notify(h, CLIXON_DATASTORE_STREAM,
+                      "<datastore-changed xmlns=\"%s\"><datastore>running</datastore>"
+                      "<version>%" PRIu64 "</version>%s</datastore-changed>",
+                      CLIXON_LIB_NS, version, cbuf_get(pu->pu_changed)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    cbuf_reset(pu->pu_changed);
+    return retval;
+}
+
+/*! Send the changes of a commit to standby backends on the CLIXON-JOURNAL stream
+ *
+ * See clixon_datastore_journal.c for the record format. If the changes can not be expressed
+ * as a record, all of running is sent with a replace flag.
+ * Called after running is written, so that the version of running is the new version
+ * @param[in]  h     Clixon handle
+ * @param[in]  xrec  Changes of commit from xmldb_journal_changes, or NULL to send all of running
+ * @retval     0     OK, or no stream or no standby subscribed
+ * @retval    -1     Error
+ * @see backend_standby_start  Receiver of records
+ */
+int
+backend_push_journal(clicon_handle h,
+                     cxobj        *xrec)
+{
+    int             retval = -1;
+    cxobj          *xt = NULL;
+    cbuf           *cb = NULL;
+    uint64_t        version;
+    event_stream_t *es;
+
+    if ((es = stream_find(h, CLIXON_JOURNAL_STREAM)) == NULL ||
+        es->es_subscription == NULL)
+        return 0;
+    if (xmldb_version_get(h, "running", &version, NULL) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (xrec == NULL){
+        if (xmldb_get(h, "running", NULL, "/", &xt) < 0)
+            goto done;
+        if (xml_name_set(xt, NETCONF_INPUT_CONFIG) < 0)
+            goto done;
+        cprintf(cb, "<replace/>");
+        xrec = xt;
+    }
+    if (clixon_xml2cbuf(cb, xrec, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    if (stream_notify(h, CLIXON_JOURNAL_STREAM,
+                      "<journal-record xmlns=\"%s\"><datastore>running</datastore>"
+                      "<version>%" PRIu64 "</version>%s</journal-record>",
+                      CLIXON_LIB_NS, version, cbuf_get(cb)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Free all push subscriptions
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+backend_push_free(clicon_handle h)
+{
+    struct push_state        *pu = NULL;
+    struct push_subscription *ps;
+
+    if (clicon_ptr_get(h, PUSH_STATE_NAME, (void**)&pu) < 0 || pu == NULL)
+        return 0;
+    clicon_ptr_del(h, PUSH_STATE_NAME);
+    while ((ps = pu->pu_subscriptions) != NULL){
+        DELQ(ps, pu->pu_subscriptions, struct push_subscription *);
+        if (ps->ps_sample){
+            push_sample_put(pu, ps->ps_sample);
+            ps->ps_sample = NULL;
+        }
+        push_subscription_free(ps);
+    }
+    if (pu->pu_ymark)
+        free(pu->pu_ymark);
+    if (pu->pu_changed)
+        cbuf_free(pu->pu_changed);
+    free(pu);
+    return 0;
+}
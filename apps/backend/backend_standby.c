@@ -0,0 +1,411 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  Journal shipping to a hot-standby backend, see CLICON_STREAM_JOURNAL and CLICON_BACKEND_STANDBY
+  The active backend sends the changes of each commit as a journal-record notification on
+  the CLIXON-JOURNAL stream, see backend_push_journal.
+  A standby backend connects to the socket of the active backend, subscribes to the stream
+  and gets the running datastore on the same session, so that records following the reply
+  are changes made after it. Records are applied to running of the standby as edits without
+  plugin transaction callbacks, ie yang is parsed and the datastore cache is loaded as the
+  active backend changes. Commits are rejected while standby, the candidate is a copy of
+  running when replication started.
+  Promotion with the standby-promote rpc closes the connection and commits running as
+  with startup mode running, where plugin reset and commit callbacks are called.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+#include "clixon_backend_commit.h"
+#include "backend_startup.h"
+#include "backend_standby.h"
+
+#define STANDBY_STATE_NAME "standby-state"
+
+/* Replication state of a standby backend
+ */
+struct standby_state {
+    char     *ss_sock;    /* Socket path of active backend */
+    int       ss_s;       /* Session to active backend, or -1 if closed */
+    uint64_t  ss_version; /* Version of running of active backend of last record */
+    uint64_t  ss_records; /* Number of applied records */
+};
+
+/*! Apply a config tree received from the active backend to running of the standby
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  xc    Config tree: <config>...</config>, not bound
+ * @param[in]  op    OP_MERGE for a journal record, OP_REPLACE for the full datastore
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+standby_apply(clicon_handle       h,
+              cxobj              *xc,
+              enum operation_type op)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *xerr = NULL;
+    cbuf      *cbret = NULL;
+    int        ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((ret = xml_bind_yang(h, xc, YB_MODULE, yspec, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        clixon_netconf_error(xerr, "Standby journal record", NULL);
+        goto done;
+    }
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((ret = xmldb_put(h, "running", op, xc, NULL, cbret)) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_err(OE_DB, 0, "Standby journal record: %s", cbuf_get(cbret));
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    if (cbret)
+        cbuf_free(cbret);
+    return retval;
+}
+
+/*! Close the session to the active backend
+ */
+static void standby_close(struct standby_state *ss);
+
+/*! Read and apply a journal record from the active backend
+ *
+ * If the session is closed, eg the active backend has failed, replication stops and
+ * the standby waits for promotion.
+ * @param[in]  s    Socket to active backend
+ * @param[in]  arg  Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+standby_input(int   s,
+              void *arg)
+{
+    int                   retval = -1;
+    clicon_handle         h = (clicon_handle)arg;
+    struct standby_state *ss = NULL;
+    struct clicon_msg    *reply = NULL;
+    int                   eof = 0;
+    cxobj                *xt = NULL;
+    cxobj                *xr;
+    cxobj                *xc;
+    char                 *str;
+
+    if (clicon_ptr_get(h, STANDBY_STATE_NAME, (void**)&ss) < 0 || ss == NULL)
+        goto ok;
+    if (clicon_msg_rcv(s, ss->ss_sock, 0, &reply, &eof) < 0)
+        goto done;
+    if (eof){
+        clicon_log(LOG_WARNING, "Standby: session to active backend %s closed after version %" PRIu64 ", waiting for promotion",
+                   ss->ss_sock, ss->ss_version);
+        standby_close(ss);
+        goto ok;
+    }
+    if (clixon_xml_parse_string(reply->op_body, YB_NONE, NULL, &xt, NULL) < 0)
+        goto done;
+    if ((xr = xpath_first(xt, NULL, "notification/journal-record")) == NULL)
+        goto ok; /* Not a journal record */
+    if ((xc = xml_find_type(xr, NULL, NETCONF_INPUT_CONFIG, CX_ELMNT)) == NULL){
+        clicon_err(OE_PROTO, EFAULT, "Standby: journal record without config");
+        goto done;
+    }
+    if ((str = xml_find_body(xr, "version")) != NULL &&
+        parse_uint64(str, &ss->ss_version, NULL) < 1){
+        clicon_err(OE_PROTO, EINVAL, "Standby: journal record version: %s", str);
+        goto done;
+    }
+    if (standby_apply(h, xc, xml_find_type(xr, NULL, "replace", CX_ELMNT)?OP_REPLACE:OP_MERGE) < 0)
+        goto done;
+    ss->ss_records++;
+    clicon_debug(1, "%s version %" PRIu64, __FUNCTION__, ss->ss_version);
+ ok:
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    if (reply)
+        free(reply);
+    return retval;
+}
+
+static void
+standby_close(struct standby_state *ss)
+{
+    if (ss->ss_s != -1){
+        clixon_event_unreg_fd(ss->ss_s, standby_input);
+        close(ss->ss_s);
+        ss->ss_s = -1;
+    }
+}
+
+/*! Send an rpc to the active backend and read its reply, skipping notifications
+ *
+ * @param[in]  ss    Standby state
+ * @param[in]  rpc   Rpc body, eg <get-config>...
+ * @param[out] xt    Reply tree: <rpc-reply>, free with xml_free
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+standby_rpc(struct standby_state *ss,
+            const char           *rpc,
+            cxobj               **xt)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    struct clicon_msg *reply = NULL;
+    int                eof = 0;
+    cxobj             *xerr;
+
+    if ((msg = clicon_msg_encode(0, "<rpc xmlns=\"%s\" %s>%s</rpc>",
+                                 NETCONF_BASE_NAMESPACE, NETCONF_MESSAGE_ID_ATTR, rpc)) == NULL)
+        goto done;
+    if (clicon_msg_send(ss->ss_s, ss->ss_sock, msg) < 0)
+        goto done;
+    do {
+        if (reply){
+            free(reply);
+            reply = NULL;
+        }
+        if (*xt){
+            xml_free(*xt);
+            *xt = NULL;
+        }
+        if (clicon_msg_rcv(ss->ss_s, ss->ss_sock, 0, &reply, &eof) < 0)
+            goto done;
+        if (eof){
+            clicon_err(OE_PROTO, ESHUTDOWN, "Standby: unexpected close of active backend %s", ss->ss_sock);
+            goto done;
+        }
+        if (clixon_xml_parse_string(reply->op_body, YB_NONE, NULL, xt, NULL) < 0)
+            goto done;
+    } while (xpath_first(*xt, NULL, "rpc-reply") == NULL);
+    if ((xerr = xpath_first(*xt, NULL, "rpc-reply/rpc-error")) != NULL){
+        clixon_netconf_error(xerr, "Standby", ss->ss_sock);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
+    if (reply)
+        free(reply);
+    return retval;
+}
+
+/*! Start replication from the active backend, if CLICON_BACKEND_STANDBY is set
+ *
+ * Subscribe to the CLIXON-JOURNAL stream and replace running with running of the active
+ * backend. Then apply journal records as they arrive.
+ * Called after startup, the startup mode of a standby is typically init.
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+backend_standby_start(clicon_handle h)
+{
+    int                   retval = -1;
+    char                 *sock;
+    struct standby_state *ss = NULL;
+    cxobj                *xt = NULL;
+    cxobj                *xd;
+    cbuf                 *cb = NULL;
+
+    if ((sock = clicon_option_str(h, "CLICON_BACKEND_STANDBY")) == NULL || *sock == '\0')
+        return 0;
+    if ((ss = malloc(sizeof(*ss))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(ss, 0, sizeof(*ss));
+    ss->ss_s = -1;
+    if ((ss->ss_sock = strdup(sock)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (clicon_rpc_connect_unix(h, ss->ss_sock, &ss->ss_s) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<create-subscription xmlns=\"%s\"><stream>%s</stream></create-subscription>",
+            EVENT_RFC5277_NAMESPACE, CLIXON_JOURNAL_STREAM);
+    if (standby_rpc(ss, cbuf_get(cb), &xt) < 0)
+        goto done;
+    /* Records of commits before the reply are included in the reply */
+    if (standby_rpc(ss, "<get-config><source><running/></source></get-config>", &xt) < 0)
+        goto done;
+    if ((xd = xpath_first(xt, NULL, "rpc-reply/data")) == NULL){
+        clicon_err(OE_PROTO, EFAULT, "Standby: get-config reply without data");
+        goto done;
+    }
+    if (xml_name_set(xd, NETCONF_INPUT_CONFIG) < 0)
+        goto done;
+    if (standby_apply(h, xd, OP_REPLACE) < 0)
+        goto done;
+    if (clixon_event_reg_fd(ss->ss_s, standby_input, h, "standby journal socket") < 0)
+        goto done;
+    if (clicon_ptr_set(h, STANDBY_STATE_NAME, ss) < 0)
+        goto done;
+    /* Commits are rejected while standby, see from_client_commit */
+    if (clicon_data_int_set(h, "backend-standby", 1) < 0)
+        goto done;
+    clicon_log(LOG_NOTICE, "Standby: replicating running from active backend %s", ss->ss_sock);
+    ss = NULL;
+    retval = 0;
+ done:
+    if (ss){
+        if (ss->ss_s != -1)
+            close(ss->ss_s);
+        if (ss->ss_sock)
+            free(ss->ss_sock);
+        free(ss);
+    }
+    if (cb)
+        cbuf_free(cb);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Promote a standby backend to active
+ *
+ * Stop replication and commit running as in startup mode running: plugin commit callbacks
+ * are called with running as target, and extra XML of plugin reset callbacks is merged.
+ * If the commit fails, running is restored.
+ * @param[in]  h      Clixon handle
+ * @param[out] cbret  Error XML if retval is 0
+ * @retval     1      OK
+ * @retval     0      Not standby or failed, cbret set
+ * @retval    -1      Error
+ */
+int
+backend_standby_promote(clicon_handle h,
+                        cbuf         *cbret)
+{
+    int                   retval = -1;
+    struct standby_state *ss = NULL;
+    int                   ret;
+
+    if (clicon_ptr_get(h, STANDBY_STATE_NAME, (void**)&ss) < 0 || ss == NULL){
+        if (netconf_operation_failed(cbret, "application", "Backend is not standby") < 0)
+            goto done;
+        goto fail;
+    }
+    clicon_log(LOG_NOTICE, "Standby: promoted after version %" PRIu64 ", %" PRIu64 " records",
+               ss->ss_version, ss->ss_records);
+    if (backend_standby_free(h) < 0)
+        goto done;
+    /* Copy original running to tmp as backup (restore if error) */
+    if (xmldb_copy(h, "running", "tmp") < 0)
+        goto done;
+    ret = startup_mode_startup(h, "tmp", cbret);
+    if (ret != 1)
+        if (xmldb_copy(h, "tmp", "running") < 0)
+            goto done;
+    xmldb_delete(h, "tmp");
+    if (ret < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if ((ret = startup_extraxml(h, NULL, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (xmldb_copy(h, "running", "candidate") < 0)
+        goto done;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Stop replication and free standby state
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+backend_standby_free(clicon_handle h)
+{
+    struct standby_state *ss = NULL;
+
+    if (clicon_ptr_get(h, STANDBY_STATE_NAME, (void**)&ss) < 0 || ss == NULL)
+        return 0;
+    clicon_ptr_del(h, STANDBY_STATE_NAME);
+    clicon_data_int_del(h, "backend-standby");
+    standby_close(ss);
+    if (ss->ss_sock)
+        free(ss->ss_sock);
+    free(ss);
+    return 0;
+}
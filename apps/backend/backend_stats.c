@@ -0,0 +1,802 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+  Timing statistics of validate and commit transactions, and of backend RPCs
+  Each transaction phase and each plugin callback has a histogram of durations, retrieved
+  with the clixon-lib stats rpc
+  Each RPC has histograms of latency, queue wait, request and reply size
+  Memory per subsystem: datastore caches, yang specs, stream replay buffers, clients and
+  plugin allocations
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <time.h>
+#include <syslog.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#ifdef HAVE_MALLINFO2
+#include <malloc.h>
+#endif
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+#include <clixon/clixon_probe.h>
+
+#include "clixon_backend_client.h"
+#include "backend_handle.h"
+#include "backend_stats.h"
+
+/* Number of histogram buckets. Bucket i counts durations less than 2^i microseconds, and
+ * not in a lower bucket. The last bucket counts all longer durations. */
+#define COMMIT_STATS_BUCKETS 24
+
+/* Handle data name of commit statistics */
+#define COMMIT_STATS_NAME "commit-stats"
+
+/* Handle data name of RPC statistics */
+#define RPC_STATS_NAME "rpc-stats"
+
+/* Handle data name of scheduler statistics */
+#define SCHED_STATS_NAME "sched-stats"
+
+/*! Histogram of durations in microseconds
+ */
+struct commit_hist {
+    uint64_t ch_count;
+    uint64_t ch_total;
+    uint64_t ch_max;
+    uint64_t ch_bucket[COMMIT_STATS_BUCKETS];
+};
+
+/*! Callback histograms of one plugin
+ */
+struct plugin_stats {
+    struct plugin_stats *ps_next;
+    clixon_plugin_t     *ps_cp;
+    struct commit_hist   ps_cb[CC_NR];
+};
+
+struct commit_stats {
+    struct commit_hist   cs_phase[CP_NR];
+    struct plugin_stats *cs_plugins;  /* In order of first call */
+    struct plugin_stats *cs_last;
+};
+
+/*! Histograms of one RPC
+ *
+ * Looked up by the yang statement of the RPC, names are kept if the yang is freed
+ */
+struct rpc_stats {
+    struct rpc_stats    *rs_next;
+    yang_stmt           *rs_yrpc;
+    char                *rs_namespace;
+    char                *rs_name;
+    struct commit_hist   rs_latency; /* Microseconds from received to reply */
+    struct commit_hist   rs_wait;    /* Microseconds from ready to received */
+    struct commit_hist   rs_request; /* Bytes of request message */
+    struct commit_hist   rs_reply;   /* Bytes of reply message */
+};
+
+/*! Latency of a request class of the scheduler
+ */
+struct sched_class_stats {
+    uint64_t             sc_missed;    /* Requests with latency over target */
+    uint64_t             sc_preempted; /* Requests handled at safe points of other RPCs */
+    struct commit_hist   sc_latency;   /* Microseconds from ready to reply */
+};
+
+struct sched_stats {
+    struct sched_class_stats ss_class[SC_NR];
+};
+
+static const char *sched_class_names[SC_NR] = {
+    "interactive",
+    "bulk"
+};
+
+static const char *commit_phase_names[CP_NR] = {
+    "read",
+    "diff",
+    "begin",
+    "validate",
+    "plugin-validate",
+    "complete",
+    "commit",
+    "commit-done",
+    "write",
+    "end",
+    "total"
+};
+
+static const char *commit_callback_names[CC_NR] = {
+    "begin",
+    "validate",
+    "complete",
+    "commit",
+    "commit-done",
+    "end"
+};
+
+/*! Get commit statistics of handle, create if not found
+ */
+static struct commit_stats *
+commit_stats_get_create(clicon_handle h)
+{
+    struct commit_stats *cs = NULL;
+
+    if (clicon_ptr_get(h, COMMIT_STATS_NAME, (void**)&cs) == 0 && cs != NULL)
+        return cs;
+    if ((cs = calloc(1, sizeof(*cs))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    if (clicon_ptr_set(h, COMMIT_STATS_NAME, cs) < 0){
+        free(cs);
+        return NULL;
+    }
+    return cs;
+}
+
+/*! Add a value to a histogram
+ */
+static void
+commit_hist_value(struct commit_hist *ch,
+                  uint64_t            v)
+{
+    int i;
+
+    for (i=0; i<COMMIT_STATS_BUCKETS-1 && (v >> i) != 0; i++)
+        ;
+    ch->ch_bucket[i]++;
+    ch->ch_count++;
+    ch->ch_total += v;
+    if (v > ch->ch_max)
+        ch->ch_max = v;
+}
+
+/*! Add the time since t0 to a histogram and restart t0
+ *
+ * @retval  us  Duration in microseconds
+ */
+static uint64_t
+commit_hist_add(struct commit_hist *ch,
+                struct timespec    *t0)
+{
+    struct timespec t;
+    uint64_t        us;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    us = (t.tv_sec - t0->tv_sec)*1000000 + (t.tv_nsec - t0->tv_nsec)/1000;
+    *t0 = t;
+    commit_hist_value(ch, us);
+    return us;
+}
+
+/*! Estimate a percentile of a histogram as the limit of the bucket where it is reached
+ *
+ * The estimate is at most twice the real value, and never more than max
+ * @param[in]  ch   Histogram
+ * @param[in]  pct  Percentile, 0-100
+ * @retval     v    Upper bound of percentile
+ */
+static uint64_t
+commit_hist_percentile(struct commit_hist *ch,
+                       int                 pct)
+{
+    uint64_t n = 0;
+    uint64_t limit;
+    int      i;
+
+    for (i=0; i<COMMIT_STATS_BUCKETS-1; i++){
+        n += ch->ch_bucket[i];
+        if (n*100 >= ch->ch_count*pct)
+            break;
+    }
+    limit = (uint64_t)1 << i;
+    if (i == COMMIT_STATS_BUCKETS-1 || limit > ch->ch_max)
+        return ch->ch_max;
+    return limit;
+}
+
+/*! Start timing of a transaction phase or plugin callback
+ *
+ * @param[out] t0  Start time
+ */
+void
+commit_stats_start(struct timespec *t0)
+{
+    clock_gettime(CLOCK_MONOTONIC, t0);
+}
+
+/*! Record the duration of a transaction phase
+ *
+ * @param[in]     h      Clixon handle
+ * @param[in]     phase  Transaction phase
+ * @param[in,out] t0     Start time of phase, set to now, ie start of next phase
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+int
+commit_stats_phase(clicon_handle      h,
+                   enum commit_phase  phase,
+                   struct timespec   *t0)
+{
+    struct commit_stats *cs;
+    uint64_t             us;
+
+    if ((cs = commit_stats_get_create(h)) == NULL)
+        return -1;
+    us = commit_hist_add(&cs->cs_phase[phase], t0);
+    CLIXON_PROBE2(commit_phase, commit_phase_names[phase], us);
+    return 0;
+}
+
+/*! Record the duration of a plugin transaction callback
+ *
+ * May be called from parallel commit threads, but not concurrently
+ * A callback longer than CLICON_PLUGIN_SLOW_LOG is logged
+ * @param[in]     h   Clixon handle
+ * @param[in]     cp  Plugin
+ * @param[in]     cb  Callback
+ * @param[in,out] t0  Start time of callback, set to now
+ * @retval        0   OK
+ * @retval       -1   Error
+ */
+int
+commit_stats_plugin(clicon_handle         h,
+                    clixon_plugin_t      *cp,
+                    enum commit_callback  cb,
+                    struct timespec      *t0)
+{
+    struct commit_stats *cs;
+    struct plugin_stats *ps;
+    uint64_t             us;
+
+    if ((cs = commit_stats_get_create(h)) == NULL)
+        return -1;
+    for (ps = cs->cs_plugins; ps; ps = ps->ps_next)
+        if (ps->ps_cp == cp)
+            break;
+    if (ps == NULL){
+        if ((ps = calloc(1, sizeof(*ps))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        ps->ps_cp = cp;
+        if (cs->cs_last)
+            cs->cs_last->ps_next = ps;
+        else
+            cs->cs_plugins = ps;
+        cs->cs_last = ps;
+    }
+    us = commit_hist_add(&ps->ps_cb[cb], t0);
+    CLIXON_PROBE3(transaction_callback, clixon_plugin_name_get(cp), commit_callback_names[cb], us);
+    clixon_plugin_slow_log(h, clixon_plugin_name_get(cp), commit_callback_names[cb], us);
+    return 0;
+}
+
+/*! Print a histogram as XML, only non-empty buckets
+ */
+static void
+commit_hist_data2cbuf(cbuf               *cb,
+                      struct commit_hist *ch)
+{
+    int i;
+
+    cprintf(cb, "<count>%" PRIu64 "</count>", ch->ch_count);
+    cprintf(cb, "<total>%" PRIu64 "</total>", ch->ch_total);
+    cprintf(cb, "<max>%" PRIu64 "</max>", ch->ch_max);
+    for (i=0; i<COMMIT_STATS_BUCKETS; i++){
+        if (ch->ch_bucket[i] == 0)
+            continue;
+        cprintf(cb, "<bucket>");
+        if (i < COMMIT_STATS_BUCKETS-1)
+            cprintf(cb, "<limit>%" PRIu64 "</limit>", (uint64_t)1 << i);
+        else
+            cprintf(cb, "<limit>max</limit>");
+        cprintf(cb, "<count>%" PRIu64 "</count>", ch->ch_bucket[i]);
+        cprintf(cb, "</bucket>");
+    }
+    if (ch->ch_count){
+        cprintf(cb, "<p50>%" PRIu64 "</p50>", commit_hist_percentile(ch, 50));
+        cprintf(cb, "<p99>%" PRIu64 "</p99>", commit_hist_percentile(ch, 99));
+    }
+}
+
+/*! Print a named histogram as XML
+ */
+static void
+commit_hist2cbuf(cbuf               *cb,
+                 const char         *name,
+                 struct commit_hist *ch)
+{
+    cprintf(cb, "<name>%s</name>", name);
+    commit_hist_data2cbuf(cb, ch);
+}
+
+/*! Get commit timing statistics as XML for the stats rpc
+ *
+ * Phases and callbacks that have not been timed are not included
+ * @param[in]  h   Clixon handle
+ * @param[out] cb  CLIgen buf, commit container is appended
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+commit_stats_get(clicon_handle h,
+                 cbuf         *cb)
+{
+    struct commit_stats *cs = NULL;
+    struct plugin_stats *ps;
+    clixon_plugin_t     *cp;
+    int                  i;
+
+    cprintf(cb, "<commit xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (clicon_ptr_get(h, COMMIT_STATS_NAME, (void**)&cs) == 0 && cs != NULL){
+        for (i=0; i<CP_NR; i++){
+            if (cs->cs_phase[i].ch_count == 0)
+                continue;
+            cprintf(cb, "<phase>");
+            commit_hist2cbuf(cb, commit_phase_names[i], &cs->cs_phase[i]);
+            cprintf(cb, "</phase>");
+        }
+        /* Only plugins that are still loaded */
+        cp = NULL;
+        while ((cp = clixon_plugin_each(h, cp)) != NULL){
+            for (ps = cs->cs_plugins; ps; ps = ps->ps_next)
+                if (ps->ps_cp == cp)
+                    break;
+            if (ps == NULL)
+                continue;
+            cprintf(cb, "<plugin><name>%s</name>", clixon_plugin_name_get(cp));
+            for (i=0; i<CC_NR; i++){
+                if (ps->ps_cb[i].ch_count == 0)
+                    continue;
+                cprintf(cb, "<callback>");
+                commit_hist2cbuf(cb, commit_callback_names[i], &ps->ps_cb[i]);
+                cprintf(cb, "</callback>");
+            }
+            cprintf(cb, "</plugin>");
+        }
+    }
+    cprintf(cb, "</commit>");
+    return 0;
+}
+
+/*! Free commit statistics
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+commit_stats_free(clicon_handle h)
+{
+    struct commit_stats *cs = NULL;
+    struct plugin_stats *ps;
+
+    if (clicon_ptr_get(h, COMMIT_STATS_NAME, (void**)&cs) < 0 || cs == NULL)
+        return 0;
+    clicon_ptr_del(h, COMMIT_STATS_NAME);
+    while ((ps = cs->cs_plugins) != NULL){
+        cs->cs_plugins = ps->ps_next;
+        free(ps);
+    }
+    free(cs);
+    return 0;
+}
+
+/*! Record latency, queue wait and sizes of an RPC
+ *
+ * @param[in]  h        Clixon handle
+ * @param[in]  yrpc     Yang statement of RPC
+ * @param[in]  tready   Time the client socket was found ready, zero if not known
+ * @param[in]  t0       Time the request was received
+ * @param[in]  reqlen   Length of request message in bytes
+ * @param[in]  replylen Length of reply message in bytes, 0 if not known, eg streamed reply
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+int
+rpc_stats_add(clicon_handle    h,
+              yang_stmt       *yrpc,
+              struct timespec *tready,
+              struct timespec *t0,
+              size_t           reqlen,
+              size_t           replylen)
+{
+    struct rpc_stats *rs0 = NULL;
+    struct rpc_stats *rs;
+    struct timespec   t;
+    char             *ns;
+
+    if (clicon_ptr_get(h, RPC_STATS_NAME, (void**)&rs0) < 0)
+        rs0 = NULL;
+    for (rs = rs0; rs; rs = rs->rs_next)
+        if (rs->rs_yrpc == yrpc)
+            break;
+    if (rs == NULL){
+        if ((rs = calloc(1, sizeof(*rs))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        ns = yang_find_mynamespace(yrpc);
+        if ((rs->rs_name = strdup(yang_argument_get(yrpc))) == NULL ||
+            (rs->rs_namespace = strdup(ns?ns:"")) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            if (rs->rs_name)
+                free(rs->rs_name);
+            free(rs);
+            return -1;
+        }
+        rs->rs_yrpc = yrpc;
+        rs->rs_next = rs0;
+        if (clicon_ptr_set(h, RPC_STATS_NAME, rs) < 0){
+            free(rs->rs_name);
+            free(rs->rs_namespace);
+            free(rs);
+            return -1;
+        }
+    }
+    /* A request read later than in the event loop, eg a paused client, has no wait */
+    if ((tready->tv_sec || tready->tv_nsec) &&
+        (tready->tv_sec < t0->tv_sec ||
+         (tready->tv_sec == t0->tv_sec && tready->tv_nsec <= t0->tv_nsec)))
+        commit_hist_value(&rs->rs_wait, (t0->tv_sec - tready->tv_sec)*1000000 +
+                          (t0->tv_nsec - tready->tv_nsec)/1000);
+    t = *t0;
+    commit_hist_add(&rs->rs_latency, &t);
+    commit_hist_value(&rs->rs_request, reqlen);
+    if (replylen)
+        commit_hist_value(&rs->rs_reply, replylen);
+    return 0;
+}
+
+/*! Get RPC statistics as XML for the stats rpc
+ *
+ * @param[in]  h   Clixon handle
+ * @param[out] cb  CLIgen buf, rpcs container is appended
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+rpc_stats_get(clicon_handle h,
+              cbuf         *cb)
+{
+    struct rpc_stats *rs = NULL;
+
+    cprintf(cb, "<rpcs xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (clicon_ptr_get(h, RPC_STATS_NAME, (void**)&rs) < 0)
+        rs = NULL;
+    for (; rs; rs = rs->rs_next){
+        cprintf(cb, "<rpc>");
+        cprintf(cb, "<namespace>%s</namespace>", rs->rs_namespace);
+        cprintf(cb, "<name>%s</name>", rs->rs_name);
+        cprintf(cb, "<latency>");
+        commit_hist_data2cbuf(cb, &rs->rs_latency);
+        cprintf(cb, "</latency>");
+        if (rs->rs_wait.ch_count){
+            cprintf(cb, "<wait>");
+            commit_hist_data2cbuf(cb, &rs->rs_wait);
+            cprintf(cb, "</wait>");
+        }
+        cprintf(cb, "<request>");
+        commit_hist_data2cbuf(cb, &rs->rs_request);
+        cprintf(cb, "</request>");
+        if (rs->rs_reply.ch_count){
+            cprintf(cb, "<reply>");
+            commit_hist_data2cbuf(cb, &rs->rs_reply);
+            cprintf(cb, "</reply>");
+        }
+        cprintf(cb, "</rpc>");
+    }
+    cprintf(cb, "</rpcs>");
+    return 0;
+}
+
+/*! Free RPC statistics
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+rpc_stats_free(clicon_handle h)
+{
+    struct rpc_stats *rs = NULL;
+    struct rpc_stats *rs_next;
+
+    if (clicon_ptr_get(h, RPC_STATS_NAME, (void**)&rs) < 0 || rs == NULL)
+        return 0;
+    clicon_ptr_del(h, RPC_STATS_NAME);
+    for (; rs; rs = rs_next){
+        rs_next = rs->rs_next;
+        free(rs->rs_name);
+        free(rs->rs_namespace);
+        free(rs);
+    }
+    return 0;
+}
+
+/*! Latency target of a request class in microseconds, 0 if none
+ */
+static uint64_t
+sched_class_target(clicon_handle    h,
+                   enum sched_class sc)
+{
+    if (sc == SC_INTERACTIVE)
+        return (uint64_t)clicon_option_int(h, "CLICON_BACKEND_YIELD_INTERVAL")*1000;
+    return 0;
+}
+
+/*! Record the latency of a request of a scheduler class
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  sc        Request class
+ * @param[in]  tready    Time the client socket was found ready, zero if not known
+ * @param[in]  t0        Time the request was received
+ * @param[in]  preempted Handled at a safe point of another RPC
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @see CLICON_BACKEND_YIELD_INTERVAL
+ */
+int
+sched_stats_add(clicon_handle    h,
+                enum sched_class sc,
+                struct timespec *tready,
+                struct timespec *t0,
+                int              preempted)
+{
+    struct sched_stats       *ss = NULL;
+    struct sched_class_stats *scs;
+    struct timespec           t;
+    uint64_t                  target;
+    uint64_t                  us;
+
+    if (clicon_ptr_get(h, SCHED_STATS_NAME, (void**)&ss) < 0 || ss == NULL){
+        if ((ss = calloc(1, sizeof(*ss))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        if (clicon_ptr_set(h, SCHED_STATS_NAME, ss) < 0){
+            free(ss);
+            return -1;
+        }
+    }
+    scs = &ss->ss_class[sc];
+    /* A request read later than in the event loop, eg a paused client, is from received */
+    if ((tready->tv_sec || tready->tv_nsec) &&
+        (tready->tv_sec < t0->tv_sec ||
+         (tready->tv_sec == t0->tv_sec && tready->tv_nsec <= t0->tv_nsec)))
+        t = *tready;
+    else
+        t = *t0;
+    us = commit_hist_add(&scs->sc_latency, &t);
+    if ((target = sched_class_target(h, sc)) != 0 && us > target)
+        scs->sc_missed++;
+    if (preempted)
+        scs->sc_preempted++;
+    return 0;
+}
+
+/*! Get scheduler statistics as XML for the stats rpc
+ *
+ * @param[in]  h   Clixon handle
+ * @param[out] cb  CLIgen buf, scheduler container is appended
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+sched_stats_get(clicon_handle h,
+                cbuf         *cb)
+{
+    struct sched_stats       *ss = NULL;
+    struct sched_class_stats *scs;
+    struct sched_class_stats  scs0 = {0,};
+    uint64_t                  sections;
+    uint64_t                  yields;
+    uint64_t                  ytime;
+    uint64_t                  maxgap;
+    uint64_t                  target;
+    int                       i;
+
+    clixon_event_yield_stats(&sections, &yields, &ytime, &maxgap);
+    cprintf(cb, "<scheduler xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cb, "<yield-interval>%" PRIu64 "</yield-interval>", sched_class_target(h, SC_INTERACTIVE));
+    cprintf(cb, "<sections>%" PRIu64 "</sections>", sections);
+    cprintf(cb, "<yields>%" PRIu64 "</yields>", yields);
+    cprintf(cb, "<yield-time>%" PRIu64 "</yield-time>", ytime);
+    cprintf(cb, "<max-gap>%" PRIu64 "</max-gap>", maxgap);
+    if (clicon_ptr_get(h, SCHED_STATS_NAME, (void**)&ss) < 0)
+        ss = NULL;
+    for (i=0; i<SC_NR; i++){
+        cprintf(cb, "<class><name>%s</name>", sched_class_names[i]);
+        if ((target = sched_class_target(h, i)) != 0)
+            cprintf(cb, "<target>%" PRIu64 "</target>", target);
+        scs = ss ? &ss->ss_class[i] : &scs0;
+        cprintf(cb, "<missed>%" PRIu64 "</missed>", scs->sc_missed);
+        cprintf(cb, "<preempted>%" PRIu64 "</preempted>", scs->sc_preempted);
+        cprintf(cb, "<latency>");
+        commit_hist_data2cbuf(cb, &scs->sc_latency);
+        cprintf(cb, "</latency>");
+        cprintf(cb, "</class>");
+    }
+    cprintf(cb, "</scheduler>");
+    return 0;
+}
+
+/*! Free scheduler statistics
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+sched_stats_free(clicon_handle h)
+{
+    struct sched_stats *ss = NULL;
+
+    if (clicon_ptr_get(h, SCHED_STATS_NAME, (void**)&ss) < 0 || ss == NULL)
+        return 0;
+    clicon_ptr_del(h, SCHED_STATS_NAME);
+    free(ss);
+    return 0;
+}
+
+/*! Get memory of a client entry including its buffers
+ */
+static size_t
+client_entry_size(struct client_entry *ce)
+{
+    size_t sz;
+
+    sz = sizeof(*ce);
+    if (ce->ce_username)
+        sz += strlen(ce->ce_username) + 1;
+    if (ce->ce_transport)
+        sz += strlen(ce->ce_transport) + 1;
+    if (ce->ce_source_host)
+        sz += strlen(ce->ce_source_host) + 1;
+    if (ce->ce_outq)
+        sz += cbuf_buflen(ce->ce_outq);
+    if (ce->ce_reply)
+        sz += cbuf_buflen(ce->ce_reply);
+    return sz;
+}
+
+/*! Get memory per subsystem as XML for the stats rpc
+ *
+ * Datastore cache sizes are only computed for caches changed since last call, other
+ * subsystems keep counters or are small. Yang specs are traversed
+ * @param[in]  h   Clixon handle
+ * @param[out] cb  CLIgen buf, memory container is appended
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+memory_stats_get(clicon_handle h,
+                 cbuf         *cb)
+{
+    int                  retval = -1;
+    char               **keys = NULL;
+    size_t               klen;
+    size_t               sz;
+    size_t               total = 0;
+    uint64_t             nr;
+    uint64_t             ynr;
+    yang_stmt           *yspec;
+    event_stream_t      *es;
+    struct client_entry *ce;
+    int                  i;
+#ifdef HAVE_MALLINFO2
+    struct mallinfo2     mi;
+#endif
+
+    cprintf(cb, "<memory xmlns=\"%s\">", CLIXON_LIB_NS);
+    /* Datastore caches, including private candidates */
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i = 0; i < klen; i++){
+        if (xmldb_cache_size(h, keys[i], &sz) < 0)
+            goto done;
+        if (sz == 0)
+            continue;
+        cprintf(cb, "<datastore><name>%s</name><size>%zu</size></datastore>", keys[i], sz);
+        total += sz;
+    }
+    /* Yang specs */
+    if ((yspec = clicon_dbspec_yang(h)) != NULL){
+        ynr = 0; sz = 0;
+        if (yang_stats(yspec, &ynr, &sz) < 0)
+            goto done;
+        cprintf(cb, "<yang><name>main</name><nr>%" PRIu64 "</nr><size>%zu</size></yang>", ynr, sz);
+        total += sz;
+    }
+    if ((yspec = clicon_config_yang(h)) != NULL){
+        ynr = 0; sz = 0;
+        if (yang_stats(yspec, &ynr, &sz) < 0)
+            goto done;
+        cprintf(cb, "<yang><name>clixon-config</name><nr>%" PRIu64 "</nr><size>%zu</size></yang>", ynr, sz);
+        total += sz;
+    }
+    if (yang_schema_mount_mem_stats(&nr, &sz) < 0)
+        goto done;
+    if (nr){
+        cprintf(cb, "<yang><name>mountpoints</name><nr>%" PRIu64 "</nr><size>%zu</size></yang>", nr, sz);
+        total += sz;
+    }
+    /* Stream replay buffers */
+    if ((es = clicon_stream(h)) != NULL){
+        do {
+            stream_replay_stats(es, &nr, &sz);
+            cprintf(cb, "<stream><name>%s</name><replaynr>%" PRIu64 "</replaynr><size>%zu</size></stream>",
+                    es->es_name, nr, sz);
+            total += sz;
+            es = NEXTQ(struct event_stream *, es);
+        } while (es && es != clicon_stream(h));
+    }
+    /* Client sessions */
+    nr = 0; sz = 0;
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next){
+        nr++;
+        sz += client_entry_size(ce);
+    }
+    cprintf(cb, "<clients><nr>%" PRIu64 "</nr><size>%zu</size></clients>", nr, sz);
+    total += sz;
+    /* Plugin allocations */
+    clixon_plugin_mem_stats(&nr, &sz);
+    cprintf(cb, "<plugins><nr>%" PRIu64 "</nr><size>%zu</size></plugins>", nr, sz);
+    total += sz;
+    cprintf(cb, "<total>%zu</total>", total);
+#ifdef HAVE_MALLINFO2
+    mi = mallinfo2();
+    cprintf(cb, "<heapsize>%zu</heapsize>", mi.arena + mi.hblkhd);
+    cprintf(cb, "<heapinuse>%zu</heapinuse>", mi.uordblks + mi.hblkhd);
+#endif
+    cprintf(cb, "</memory>");
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
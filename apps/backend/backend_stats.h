@@ -0,0 +1,94 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+  Timing statistics of validate and commit transactions, and of backend RPCs
+ */
+
+#ifndef _BACKEND_STATS_H_
+#define _BACKEND_STATS_H_
+
+/*
+ * Types
+ */
+/* Phases of a validate or commit transaction */
+enum commit_phase {
+    CP_READ,        /* Read candidate and running trees */
+    CP_DIFF,        /* Compute differences */
+    CP_BEGIN,       /* Plugin begin callbacks */
+    CP_VALIDATE,    /* Generic validation */
+    CP_PVALIDATE,   /* Plugin validate callbacks */
+    CP_COMPLETE,    /* Plugin complete callbacks */
+    CP_COMMIT,      /* Plugin commit callbacks */
+    CP_COMMIT_DONE, /* Plugin commit-done callbacks */
+    CP_WRITE,       /* Write running datastore */
+    CP_END,         /* Plugin end callbacks */
+    CP_TOTAL,       /* Whole commit */
+    CP_NR
+};
+
+/* Plugin transaction callbacks */
+enum commit_callback {
+    CC_BEGIN,
+    CC_VALIDATE,
+    CC_COMPLETE,
+    CC_COMMIT,
+    CC_COMMIT_DONE,
+    CC_END,
+    CC_NR
+};
+
+/* Request classes of the scheduler, see CLICON_BACKEND_YIELD_INTERVAL */
+enum sched_class {
+    SC_INTERACTIVE, /* Hello and ping, handled at safe points of other RPCs */
+    SC_BULK,        /* Other requests */
+    SC_NR
+};
+
+/*
+ * Prototypes
+ */
+void commit_stats_start(struct timespec *t0);
+int  commit_stats_phase(clicon_handle h, enum commit_phase phase, struct timespec *t0);
+int  commit_stats_plugin(clicon_handle h, clixon_plugin_t *cp, enum commit_callback cb, struct timespec *t0);
+int  commit_stats_get(clicon_handle h, cbuf *cb);
+int  commit_stats_free(clicon_handle h);
+int  rpc_stats_add(clicon_handle h, yang_stmt *yrpc, struct timespec *tready, struct timespec *t0, size_t reqlen, size_t replylen);
+int  rpc_stats_get(clicon_handle h, cbuf *cb);
+int  memory_stats_get(clicon_handle h, cbuf *cb);
+int  rpc_stats_free(clicon_handle h);
+int  sched_stats_add(clicon_handle h, enum sched_class sc, struct timespec *tready, struct timespec *t0, int preempted);
+int  sched_stats_get(clicon_handle h, cbuf *cb);
+int  sched_stats_free(clicon_handle h);
+
+#endif  /* _BACKEND_STATS_H_ */
@@ -56,6 +56,7 @@
  */
 struct client_entry{
     struct client_entry  *ce_next;    /* The clients linked list */
+    struct client_entry **ce_pprev;   /* Pointer to ce_next of previous or list head, for unlink */
     struct sockaddr       ce_addr;    /* The clients (UNIX domain) address */
     int                   ce_s;       /* Stream socket to client */
     int                   ce_nr;      /* Client number (for dbg/tracing) */
@@ -72,6 +73,16 @@ struct client_entry{
     uint32_t              ce_in_bad_rpcs;    /* Not correct <rpc> messages */
     uint32_t              ce_out_rpc_errors; /*  <rpc-error> messages*/
     uint32_t              ce_out_notifications; /* Outgoing notifications */
+    uint64_t              ce_reply_seq; /* Defer reply until this datastore write is durable */
+    cbuf                 *ce_reply;   /* Deferred reply, see CLICON_XMLDB_ASYNC */
+    int                   ce_binary;  /* Binary replies negotiated in hello, see CLICON_PROTO_BINARY */
+    uint32_t              ce_stream_chunk; /* Streamed replies negotiated in hello: fragment size, or 0 */
+    struct reply_stream  *ce_stream;  /* Streamed reply in progress, see backend_client_stream */
+    cbuf                 *ce_outq;    /* Output queue, see client_output */
+    size_t                ce_outq_off; /* Start of unwritten output in ce_outq */
+    uint32_t              ce_out_dropped; /* Notifications dropped since output queue was written */
+    int                   ce_out_paused; /* Requests not read until output queue is written */
+    int                   ce_out_closed; /* Write failed or client disconnected, output discarded */
 };
 typedef struct client_entry client_entry;
 
@@ -61,6 +61,8 @@ int confirmed_commit_free(clicon_handle h);
 enum confirmed_commit_state confirmed_commit_state_get(clicon_handle h);
 uint32_t confirmed_commit_session_id_get(clicon_handle h);
 int cancel_rollback_event(clicon_handle h);
+int confirmed_commit_rollback_save(clicon_handle h);
+int confirmed_commit_record(clicon_handle h, transaction_data td);
 int cancel_confirmed_commit(clicon_handle h);
 int handle_confirmed_commit(clicon_handle h, cxobj *xe, uint32_t myid);
 int do_rollback(clicon_handle h, uint8_t *errs);
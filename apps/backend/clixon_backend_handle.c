@@ -92,6 +92,7 @@ struct backend_handle {
     
     /* ------ end of common handle ------ */
     struct client_entry     *bh_ce_list;   /* The client list */
+    clicon_hash_t           *bh_ce_hash;   /* Client index by session id */
     int                      bh_ce_nr;     /* Number of clients, just increment */
 };
 
@@ -120,6 +121,8 @@ backend_handle_exit(clicon_handle h)
         }
         backend_client_delete(h, ce);
     }
+    if (handle(h)->bh_ce_hash)
+        clicon_hash_free(handle(h)->bh_ce_hash);
     clicon_handle_exit(h); /* frees h and options (and streams) */
     return 0;
 }
@@ -136,7 +139,11 @@ backend_client_add(clicon_handle    h,
 {
     struct backend_handle *bh = handle(h);
     struct client_entry   *ce;
+    char                   key[16];
 
+    if (bh->bh_ce_hash == NULL &&
+        (bh->bh_ce_hash = clicon_hash_init()) == NULL)
+        return NULL;
     if ((ce = (struct client_entry *)malloc(sizeof(*ce))) == NULL){
         clicon_err(OE_PLUGIN, errno, "malloc");
         return NULL;
@@ -144,15 +151,23 @@ backend_client_add(clicon_handle    h,
     memset(ce, 0, sizeof(*ce));
     ce->ce_nr = bh->bh_ce_nr++; /* Session-id ? */
     memcpy(&ce->ce_addr, addr, sizeof(*addr));
-    ce->ce_next = bh->bh_ce_list;
     ce->ce_handle = h;
     if (clicon_session_id_get(h, &ce->ce_id) < 0){
         clicon_err(OE_NETCONF, ENOENT, "session_id not set");
+        free(ce);
+        return NULL;
+    }
+    snprintf(key, sizeof(key), "%u", ce->ce_id);
+    if (clicon_hash_add(bh->bh_ce_hash, key, &ce, sizeof(ce)) == NULL){
+        free(ce);
         return NULL;
     }
     clicon_session_id_set(h, ce->ce_id + 1);
     gettimeofday(&ce->ce_time, NULL);
     netconf_monitoring_counter_inc(h, "in-sessions");
+    if ((ce->ce_next = bh->bh_ce_list) != NULL)
+        ce->ce_next->ce_pprev = &ce->ce_next;
+    ce->ce_pprev = &bh->bh_ce_list;
     bh->bh_ce_list = ce;
     return ce;
 }
@@ -169,6 +184,29 @@ backend_client_list(clicon_handle h)
     return bh->bh_ce_list;
 }
 
+/*! Find client by session id
+ *
+ * @param[in]  h   Clicon handle
+ * @param[in]  id  Session id
+ * @retval     ce  Client entry
+ * @retval     NULL Not found
+ */
+struct client_entry *
+backend_client_find(clicon_handle h,
+                    uint32_t      id)
+{
+    struct backend_handle *bh = handle(h);
+    struct client_entry  **cep;
+    char                   key[16];
+
+    if (bh->bh_ce_hash == NULL)
+        return NULL;
+    snprintf(key, sizeof(key), "%u", id);
+    if ((cep = clicon_hash_value(bh->bh_ce_hash, key, NULL)) == NULL)
+        return NULL;
+    return *cep;
+}
+
 /*! Actually remove client from client list
  * @param[in]  h   Clicon handle
  * @param[in]  ce  Client handle
@@ -178,25 +216,28 @@ int
 backend_client_delete(clicon_handle        h,
                       struct client_entry *ce)
 {
-    struct client_entry   *c;
-    struct client_entry  **ce_prev;
     struct backend_handle *bh = handle(h);
+    char                   key[16];
 
-    ce_prev = &bh->bh_ce_list;
-    for (c = *ce_prev; c; c = c->ce_next){
-        if (c == ce){
-            *ce_prev = c->ce_next;
-            if (ce->ce_username)
-                free(ce->ce_username);
-            if (ce->ce_transport)
-                free(ce->ce_transport);
-            if (ce->ce_source_host)
-                free(ce->ce_source_host);
-            free(ce);
-            break;
-        }
-        ce_prev = &c->ce_next;
+    if (ce->ce_pprev == NULL) /* Not in list */
+        return 0;
+    if ((*ce->ce_pprev = ce->ce_next) != NULL)
+        ce->ce_next->ce_pprev = ce->ce_pprev;
+    if (backend_client_find(h, ce->ce_id) == ce){
+        snprintf(key, sizeof(key), "%u", ce->ce_id);
+        clicon_hash_del(bh->bh_ce_hash, key);
     }
+    if (ce->ce_username)
+        free(ce->ce_username);
+    if (ce->ce_transport)
+        free(ce->ce_transport);
+    if (ce->ce_source_host)
+        free(ce->ce_source_host);
+    if (ce->ce_reply)
+        cbuf_free(ce->ce_reply);
+    if (ce->ce_outq)
+        cbuf_free(ce->ce_outq);
+    free(ce);
     return 0;
 }
 
@@ -42,6 +42,21 @@
  * Types
  */
 
+/*! Entry of the change index of a transaction, see transaction_change_it_init
+ */
+struct transaction_change_entry {
+    yang_stmt *ce_y;    /* Schema node of, or above, the changed node */
+    int        ce_kind; /* TC_DELETE, TC_ADD or TC_CHANGE */
+    int        ce_i;    /* Index in td_dvec, td_avec or td_scvec/td_tcvec */
+};
+
+/*! Entry of the plugins of a transaction with ca_trans_subtree, see plugin_transaction_affected
+ */
+struct transaction_plugin_entry {
+    clixon_plugin_t *tp_cp;       /* Plugin */
+    int              tp_affected; /* Changes of the transaction are in subtrees of the plugin */
+};
+
 /*! Transaction data describing a system transition from a src to target state
  * Clixon internal, presented as void* to app's callback in the 'transaction_data'
  * type in clicon_backend_api.h
@@ -65,6 +80,13 @@ typedef struct {
     cxobj    **td_scvec;    /* Source changed xml vector */
     cxobj    **td_tcvec;    /* Target changed xml vector */
     int        td_clen;     /* Changed xml vector length */
+    int        td_chbuilt;  /* Change index is built */
+    struct transaction_change_entry *td_chvec;  /* Changes by schema node and its ancestors */
+    int        td_chlen;    /* Length of td_chvec */
+    struct transaction_change_entry *td_chself; /* Changes by schema node of the node only */
+    int        td_chselflen;/* Length of td_chself */
+    struct transaction_plugin_entry *td_plvec;  /* Plugins with subtrees, and if affected */
+    int        td_pllen;    /* Length of td_plvec */
 } transaction_data_t;
 
 /*! Pagination userdata 
@@ -85,10 +107,28 @@ typedef struct {
 typedef struct {
     uint32_t          pd_offset;    /* Start of pagination interval */
     uint32_t          pd_limit;     /* Number of elements (limit) */
+    char             *pd_cursor;    /* Start after this entry: list keys or NULL */
     int               pd_locked;    /* Running datastore is locked by this caller */
     cxobj            *pd_xstate;    /* Returned xml state tree */
 } pagination_data_t;
 
+/*! Compiled state data filter given to subtree state providers
+ *
+ * The request xpath is compiled into the longest prefix of steps with plain node names and
+ * key predicates, eg /if:interfaces/if:interface[if:name='eth0'] of
+ * /if:interfaces/if:interface[if:name='eth0']/if:statistics[if:in-octets>0]
+ * Providers registered on a subtree that intersects the prefix are called.
+ * @see statedata_filter in clixon_plugin.h
+ * @see statedata_filter_key() and other accessor functions
+ */
+typedef struct {
+    char             *sf_xpath;     /* Request xpath, canonical prefixes, or NULL */
+    cvec             *sf_nsc;       /* Namespace context of xpath */
+    char             *sf_path;      /* Schema path of prefix without keys, eg /if:interfaces */
+    clixon_path      *sf_cplist;    /* Parsed prefix with yang and keys, or NULL if "/" */
+    cxobj            *sf_xstate;    /* Returned xml state tree */
+} statedata_filter_t;
+
 /*
  * Prototypes
  */
@@ -97,19 +137,31 @@ int clixon_plugin_reset_all(clicon_handle h, char *db);
 
 int clixon_plugin_pre_daemon_all(clicon_handle h);
 int clixon_plugin_daemon_all(clicon_handle h);
+int clixon_plugin_start_backend_all(clicon_handle h);
 
 int clixon_plugin_statedata_all(clicon_handle h, yang_stmt *yspec, cvec *nsc, char *xpath,
-                                withdefaults_type wdef, cxobj **xtop);
+                                withdefaults_type wdef, int *untrusted, cxobj **xtop);
+int clixon_plugin_statedata_invalidate(clicon_handle h, const char *name);
+int clixon_plugin_statedata_stats(clicon_handle h, cbuf *cb);
+int clixon_plugin_statedata_cache_free(clicon_handle h);
 int clixon_plugin_lockdb_all(clicon_handle h, char *db, int lock, int id);
 
 int clixon_pagination_cb_register(clicon_handle h, handler_function fn, char *path, void *arg);
 int clixon_pagination_cb_call(clicon_handle h, char *xpath, int locked,
-                              uint32_t offset, uint32_t limit, 
+                              uint32_t offset, uint32_t limit, char *cursor,
                               cxobj *xstate);
 int clixon_pagination_free(clicon_handle h);
 
+int clixon_statedata_subtree_register(clicon_handle h, handler_function fn, char *path, void *arg);
+int clixon_statedata_subtree_all(clicon_handle h, yang_stmt *yspec, cvec *nsc, char *xpath,
+                                 int *untrusted, cxobj **xret);
+int clixon_statedata_subtree_free(clicon_handle h);
+
+int plugin_transaction_subtree_free(clicon_handle h);
+
 transaction_data_t * transaction_new(void);
 int transaction_free(transaction_data_t *);
+int transaction_change_index_reset(transaction_data_t *td);
 
 int plugin_transaction_begin_one(clixon_plugin_t *cp, clicon_handle h, transaction_data_t *td);
 int plugin_transaction_begin_all(clicon_handle h, transaction_data_t *td);
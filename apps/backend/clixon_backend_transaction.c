@@ -45,6 +45,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <inttypes.h>
 #include <errno.h>
 #include <ctype.h>
@@ -201,6 +202,279 @@ transaction_clen(transaction_data td)
     return ((transaction_data_t *)td)->td_clen;
 }
 
+/*! Iterator states, see transaction_change_it_next
+ */
+#define TI_ANCESTORS 0 /* Added or deleted ancestors of ti_ys */
+#define TI_CHANGES   1 /* Changes of or below ti_ys */
+#define TI_ALL       2 /* All changes, ti_ys is NULL */
+#define TI_DONE      3
+
+/*! Order change index entries by schema node, kind and position
+ */
+static int
+transaction_change_cmp(const void *arg1,
+                       const void *arg2)
+{
+    const struct transaction_change_entry *e1 = arg1;
+    const struct transaction_change_entry *e2 = arg2;
+
+    if (e1->ce_y != e2->ce_y)
+        return (uintptr_t)e1->ce_y < (uintptr_t)e2->ce_y ? -1 : 1;
+    if (e1->ce_kind != e2->ce_kind)
+        return e1->ce_kind - e2->ce_kind;
+    return e1->ce_i - e2->ce_i;
+}
+
+/*! Add a changed node to the change index, for its schema node and all its ancestors
+ *
+ * @param[in]  td    Transaction data
+ * @param[in]  x     Changed node
+ * @param[in]  kind  Kind of change
+ * @param[in]  i     Position in change vector
+ * @param[in,out] max  Allocated entries of td_chvec
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+transaction_change_add(transaction_data_t *td,
+                       cxobj              *x,
+                       int                 kind,
+                       int                 i,
+                       int                *max)
+{
+    struct transaction_change_entry *e;
+    yang_stmt                       *y;
+
+    /* Nodes without yang, eg in anydata, are indexed by their closest bound ancestor */
+    while ((y = xml_spec(x)) == NULL && (x = xml_parent(x)) != NULL)
+        ;
+    if (y == NULL)
+        return 0;
+    e = &td->td_chself[td->td_chselflen++];
+    e->ce_y = y;
+    e->ce_kind = kind;
+    e->ce_i = i;
+    for (; y != NULL && yang_keyword_get(y) != Y_SPEC; y = yang_parent_get(y)){
+        if (td->td_chlen == *max){
+            *max = *max ? 2 * *max : 64;
+            if ((e = realloc(td->td_chvec, *max * sizeof(*e))) == NULL){
+                clicon_err(OE_UNIX, errno, "realloc");
+                return -1;
+            }
+            td->td_chvec = e;
+        }
+        e = &td->td_chvec[td->td_chlen++];
+        e->ce_y = y;
+        e->ce_kind = kind;
+        e->ce_i = i;
+    }
+    return 0;
+}
+
+/*! Build the change index of a transaction, if not already built
+ *
+ * @param[in]  td   Transaction data
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+transaction_change_index(transaction_data_t *td)
+{
+    int max = 0;
+    int clen;
+    int i;
+
+    if (td->td_chbuilt)
+        return 0;
+    /* Source values are not available after commit, see transaction_end */
+    clen = td->td_scvec ? td->td_clen : 0;
+    if (td->td_dlen + td->td_alen + clen > 0 &&
+        (td->td_chself = calloc(td->td_dlen + td->td_alen + clen,
+                                sizeof(*td->td_chself))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return -1;
+    }
+    for (i=0; i<td->td_dlen; i++)
+        if (transaction_change_add(td, td->td_dvec[i], TC_DELETE, i, &max) < 0)
+            return -1;
+    for (i=0; i<td->td_alen; i++)
+        if (transaction_change_add(td, td->td_avec[i], TC_ADD, i, &max) < 0)
+            return -1;
+    for (i=0; i<clen; i++)
+        if (transaction_change_add(td, td->td_tcvec[i], TC_CHANGE, i, &max) < 0)
+            return -1;
+    if (td->td_chlen)
+        qsort(td->td_chvec, td->td_chlen, sizeof(*td->td_chvec), transaction_change_cmp);
+    if (td->td_chselflen)
+        qsort(td->td_chself, td->td_chselflen, sizeof(*td->td_chself), transaction_change_cmp);
+    td->td_chbuilt = 1;
+    return 0;
+}
+
+/*! Position of the first entry of a schema node in a sorted change index
+ */
+static int
+transaction_change_find(struct transaction_change_entry *vec,
+                        int                              len,
+                        yang_stmt                       *y)
+{
+    int lo = 0;
+    int hi = len;
+    int mid;
+
+    while (lo < hi){
+        mid = (lo + hi) / 2;
+        if ((uintptr_t)vec[mid].ce_y < (uintptr_t)y)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/*! Initialize an iterator over the changes of a transaction
+ *
+ * With a schema node, the changes of nodes of, or below, that schema node are returned:
+ * 1. Added or deleted nodes of its ancestors, nearest first. The subtree of the schema node
+ *    is then part of the returned node
+ * 2. Deleted, added and changed nodes of, or below, the schema node, in this order, each in
+ *    document order
+ * The changes are looked up in an index of the transaction built at first use, so that the
+ * cost of an iteration is in proportion to the changes returned.
+ * A module as schema node gives the changes of its top-level nodes.
+ * @param[in]  td   Transaction data
+ * @param[out] it   Iterator
+ * @param[in]  ys   Schema node, or module, or NULL for all changes
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @code
+ *    transaction_change_it        it;
+ *    enum transaction_change_kind kind;
+ *    cxobj                       *x0;
+ *    cxobj                       *x1;
+ *
+ *    if (transaction_change_it_init(td, &it, ys) < 0)
+ *       err;
+ *    while (transaction_change_it_next(&it, &kind, &x0, &x1) == 1){
+ *       ...
+ *    }
+ * @endcode
+ * @note In the end callback of a commit, deleted nodes and source values are no longer
+ *       available, and only added and changed nodes are returned
+ * @see transaction_dvec  etc, for the change vectors
+ */
+int
+transaction_change_it_init(transaction_data        td,
+                           transaction_change_it *it,
+                           yang_stmt              *ys)
+{
+    memset(it, 0, sizeof(*it));
+    it->ti_td = td;
+    it->ti_ys = ys;
+    if (ys == NULL){
+        it->ti_state = TI_ALL;
+        return 0;
+    }
+    if (transaction_change_index((transaction_data_t *)td) < 0)
+        return -1;
+    it->ti_state = TI_ANCESTORS;
+    it->ti_ya = yang_parent_get(ys);
+    it->ti_pos = -1;
+    return 0;
+}
+
+/*! Get next change of an iterator
+ *
+ * @param[in,out] it    Iterator initialized with transaction_change_it_init
+ * @param[out]    kind  Kind of change (if not NULL)
+ * @param[out]    x0p   Node in source tree, or NULL if added
+ * @param[out]    x1p   Node in target tree, or NULL if deleted
+ * @retval        1     Next change
+ * @retval        0     No more changes
+ */
+int
+transaction_change_it_next(transaction_change_it        *it,
+                           enum transaction_change_kind *kind,
+                           cxobj                       **x0p,
+                           cxobj                       **x1p)
+{
+    transaction_data_t              *td = (transaction_data_t *)it->ti_td;
+    struct transaction_change_entry *e = NULL;
+    int                              i;
+
+    while (e == NULL){
+        switch (it->ti_state){
+        case TI_ANCESTORS:
+            if (it->ti_ya == NULL || yang_keyword_get(it->ti_ya) == Y_SPEC){
+                it->ti_state = TI_CHANGES;
+                it->ti_pos = transaction_change_find(td->td_chvec, td->td_chlen, it->ti_ys);
+                break;
+            }
+            if (it->ti_pos == -1)
+                it->ti_pos = transaction_change_find(td->td_chself, td->td_chselflen, it->ti_ya);
+            if (it->ti_pos < td->td_chselflen &&
+                td->td_chself[it->ti_pos].ce_y == it->ti_ya)
+                e = &td->td_chself[it->ti_pos++];
+            else{
+                it->ti_ya = yang_parent_get(it->ti_ya);
+                it->ti_pos = -1;
+            }
+            break;
+        case TI_CHANGES:
+            if (it->ti_pos < td->td_chlen &&
+                td->td_chvec[it->ti_pos].ce_y == it->ti_ys)
+                e = &td->td_chvec[it->ti_pos++];
+            else
+                it->ti_state = TI_DONE;
+            break;
+        case TI_ALL:
+            i = it->ti_pos++;
+            if (i < td->td_dlen){
+                *x0p = td->td_dvec[i];
+                *x1p = NULL;
+                if (kind)
+                    *kind = TC_DELETE;
+                return 1;
+            }
+            if ((i -= td->td_dlen) < td->td_alen){
+                *x0p = NULL;
+                *x1p = td->td_avec[i];
+                if (kind)
+                    *kind = TC_ADD;
+                return 1;
+            }
+            if ((i -= td->td_alen) < td->td_clen && td->td_scvec){
+                *x0p = td->td_scvec[i];
+                *x1p = td->td_tcvec[i];
+                if (kind)
+                    *kind = TC_CHANGE;
+                return 1;
+            }
+            it->ti_state = TI_DONE;
+            break;
+        default:
+            return 0;
+        }
+    }
+    if (kind)
+        *kind = e->ce_kind;
+    switch (e->ce_kind){
+    case TC_DELETE:
+        *x0p = td->td_dvec[e->ce_i];
+        *x1p = NULL;
+        break;
+    case TC_ADD:
+        *x0p = NULL;
+        *x1p = td->td_avec[e->ce_i];
+        break;
+    default:
+        *x0p = td->td_scvec[e->ce_i];
+        *x1p = td->td_tcvec[e->ce_i];
+        break;
+    }
+    return 1;
+}
+
 /*! Print info about transaction on FILE, including what has changed
  *
  * @param[in] f   stdio FILE
@@ -374,6 +648,21 @@ pagination_limit(pagination_data pd)
     return ((pagination_data_t *)pd)->pd_limit;
 }
 
+/*! Get pagination data: cursor parameter
+ *
+ * The page starts after the list entry given by the cursor, instead of at offset.
+ * The cursor is the comma-separated and percent-encoded key values of the entry, as in
+ * RFC 8040 Sec 3.5.3, or the value of a leaf-list entry.
+ * @param[in]  pd     Pagination userdata
+ * @retval     cursor Cursor string
+ * @retval     NULL   No cursor
+ */
+char *
+pagination_cursor(pagination_data pd)
+{
+    return ((pagination_data_t *)pd)->pd_cursor;
+}
+
 /*! Get pagination data: locked parameter
  *
  * Pagination can use a lock/transaction mechanism 
@@ -402,3 +691,79 @@ pagination_xstate(pagination_data pd)
 {
     return ((pagination_data_t *)pd)->pd_xstate;
 }
+
+/*! Get state data filter: request xpath
+ *
+ * @param[in]  sf     Compiled state data filter
+ * @retval     xpath  Request xpath using canonical prefixes, or NULL for all
+ */
+char *
+statedata_filter_xpath(statedata_filter sf)
+{
+    return ((statedata_filter_t *)sf)->sf_xpath;
+}
+
+/*! Get state data filter: namespace context of request xpath
+ *
+ * @param[in]  sf     Compiled state data filter
+ * @retval     nsc    Namespace context
+ */
+cvec *
+statedata_filter_nsc(statedata_filter sf)
+{
+    return ((statedata_filter_t *)sf)->sf_nsc;
+}
+
+/*! Get state data filter: parsed path prefix of request
+ *
+ * Each element has its yang node and key values, if any
+ * @param[in]  sf     Compiled state data filter
+ * @retval     cplist Path prefix of request xpath 
+ * @retval     NULL   All state data is requested
+ */
+clixon_path *
+statedata_filter_path(statedata_filter sf)
+{
+    return ((statedata_filter_t *)sf)->sf_cplist;
+}
+
+/*! Get state data filter: key value of a list in the request
+ *
+ * Eg "eth0" for ylist interface and keyname name in /if:interfaces/if:interface[if:name='eth0']
+ * A provider can then return the state of that list entry only
+ * @param[in]  sf      Compiled state data filter
+ * @param[in]  ylist   Yang list
+ * @param[in]  keyname Name of key of ylist
+ * @retval     value   Requested key value
+ * @retval     NULL    Key value is not constrained by request
+ */
+char *
+statedata_filter_key(statedata_filter sf,
+                     yang_stmt       *ylist,
+                     char            *keyname)
+{
+    clixon_path *cplist = ((statedata_filter_t *)sf)->sf_cplist;
+    clixon_path *cp;
+    cg_var      *cv;
+
+    if ((cp = cplist) != NULL){
+        do {
+            if (cp->cp_yang == ylist && cp->cp_cvk != NULL &&
+                (cv = cvec_find(cp->cp_cvk, keyname)) != NULL)
+                return cv_string_get(cv);
+            cp = NEXTQ(clixon_path *, cp);
+        } while (cp && cp != cplist);
+    }
+    return NULL;
+}
+
+/*! Get state data filter: Returned xml state tree
+ *
+ * @param[in]  sf     Compiled state data filter
+ * @retval     xstate Returned xml state tree, add state data here
+ */
+cxobj *
+statedata_filter_xstate(statedata_filter sf)
+{
+    return ((statedata_filter_t *)sf)->sf_xstate;
+}
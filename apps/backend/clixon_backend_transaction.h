@@ -42,6 +42,31 @@
 #ifndef _CLIXON_BACKEND_TRANSACTION_H_
 #define _CLIXON_BACKEND_TRANSACTION_H_
 
+/*
+ * Types
+ */
+/*! Kind of change in a transaction, see transaction_change_it_next
+ */
+enum transaction_change_kind {
+    TC_DELETE, /* Node only in source, see transaction_dvec */
+    TC_ADD,    /* Node only in target, see transaction_avec */
+    TC_CHANGE, /* Leaf with changed value, see transaction_scvec and transaction_tcvec */
+};
+
+/*! External iterator over the changes of a transaction
+ *
+ * Allocated by the caller, typically on the stack. Fields are internal.
+ * @see transaction_change_it_init
+ */
+struct transaction_change_it {
+    transaction_data ti_td;
+    yang_stmt       *ti_ys;    /* Schema node filter, or NULL for all changes */
+    yang_stmt       *ti_ya;    /* Ancestor of ti_ys whose added/deleted nodes are returned */
+    int              ti_pos;   /* Next entry */
+    int              ti_state; /* Ancestors, changes of ti_ys, or done */
+};
+typedef struct transaction_change_it transaction_change_it;
+
 /*
  * Prototypes
  */
@@ -60,6 +85,9 @@ size_t  transaction_alen(transaction_data td);
 cxobj **transaction_scvec(transaction_data td);
 cxobj **transaction_tcvec(transaction_data td);
 size_t  transaction_clen(transaction_data td);
+int     transaction_change_it_init(transaction_data td, transaction_change_it *it, yang_stmt *ys);
+int     transaction_change_it_next(transaction_change_it *it, enum transaction_change_kind *kind,
+                                   cxobj **x0p, cxobj **x1p);
 
 int transaction_print(FILE *f, transaction_data th);
 int transaction_dbg(clicon_handle h, int dbglevel, transaction_data th, const char *msg);
@@ -71,7 +99,17 @@ int transaction_log(clicon_handle h, transaction_data th, int level, const char
  */
 uint32_t pagination_offset(pagination_data pd); 
 uint32_t pagination_limit(pagination_data pd); 
+char    *pagination_cursor(pagination_data pd); 
 int      pagination_locked(pagination_data pd); 
 cxobj   *pagination_xstate(pagination_data pd); 
 
+/* Subtree state providers
+ * @see statedata_filter_t  internal structure
+ */
+char        *statedata_filter_xpath(statedata_filter sf);
+cvec        *statedata_filter_nsc(statedata_filter sf);
+clixon_path *statedata_filter_path(statedata_filter sf);
+char        *statedata_filter_key(statedata_filter sf, yang_stmt *ylist, char *keyname);
+cxobj       *statedata_filter_xstate(statedata_filter sf);
+
 #endif /* _CLIXON_BACKEND_TRANSACTION_H_ */
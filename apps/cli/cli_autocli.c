@@ -427,6 +427,52 @@ autocli_grouping_treeref(clicon_handle h,
     return retval;
 }
 
+/*! Return autocli lazy option
+ *
+ * When true generate sub-trees of top-level containers on demand
+ * @param[in]  h          Clixon handle
+ * @param[out] lazy       Lazy generation enabled
+ * @retval    -1          Error
+ * @retval     0          OK
+ * @see yang2cli_lazy
+ */
+int
+autocli_lazy(clicon_handle h,
+             int          *lazy)
+{
+    int     retval = -1;
+    char   *str;
+    uint8_t val;
+    char   *reason = NULL;
+    int     ret;
+    cxobj  *xautocli;
+    
+    if (lazy == NULL){
+        clicon_err(OE_YANG, EINVAL, "Argument is NULL");
+        goto done;
+    }
+    if ((xautocli = clicon_conf_autocli(h)) == NULL){
+        clicon_err(OE_YANG, 0, "No clixon-autocli");
+        goto done;
+    }
+    /* Not mandatory, may be an older config */
+    if ((str = xml_find_body(xautocli, "lazy")) == NULL){
+        *lazy = 0;
+        goto ok;
+    }
+    if ((ret = parse_bool(str, &val, &reason)) < 0){
+        clicon_err(OE_CFG, errno, "parse_bool");
+        goto done;
+    }
+    *lazy = val;
+ ok:
+    retval = 0; 
+ done:
+    if (reason)
+        free(reason);
+    return retval;
+}
+
 /*! Return default autocli list keyword setting
  *
  * Currently only returns list-keyword-default, could be extended to rules
@@ -344,6 +344,264 @@ mtpoint_paths(yang_stmt  *yspec0,
     return retval;
 }
 
+/*! Handle-stored batch of edits, see CLICON_CLI_BATCH_EDITS
+ */
+#define CLI_BATCH_NAME "cli-batch"
+
+struct cli_batch {
+    cxobj *cb_xtop;  /* Merged edit-config tree, or NULL if empty */
+    int    cb_n;     /* Number of edits in tree */
+    int    cb_line;  /* Current script line */
+    int    cb_line0; /* Script line of first edit in tree */
+    int    cb_line1; /* Script line of last edit in tree */
+};
+
+/* Cli callbacks that only edit the candidate via cli_dbxml and may be batched */
+static const char *cli_batch_callbacks[] = {
+    "cli_set", "cli_merge", "cli_create", "cli_remove", "cli_del",
+    "cli_auto_set", "cli_auto_merge", "cli_auto_create", "cli_auto_del",
+    NULL
+};
+
+/*! Start batching edits of a script, if CLICON_CLI_BATCH_EDITS is set
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see cli_batch_exit
+ */
+int
+cli_batch_init(clicon_handle h)
+{
+    int               retval = -1;
+    struct cli_batch *cb;
+
+    if (clicon_option_int(h, "CLICON_CLI_BATCH_EDITS") <= 0)
+        goto ok;
+    if ((cb = malloc(sizeof(*cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(cb, 0, sizeof(*cb));
+    if (clicon_ptr_set(h, CLI_BATCH_NAME, cb) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Set current script line, for error messages of batched edits
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  line  Line number of next command
+ */
+int
+cli_batch_line(clicon_handle h,
+               int           line)
+{
+    struct cli_batch *cb = NULL;
+
+    if (clicon_ptr_get(h, CLI_BATCH_NAME, (void**)&cb) == 0 && cb != NULL)
+        cb->cb_line = line;
+    return 0;
+}
+
+/*! Check if all callbacks of a matched command may be batched
+ *
+ * @param[in]  co   Matched cligen object
+ * @retval     1    Batchable
+ * @retval     0    Not batchable, flush batch before evaluating
+ */
+int
+cli_batch_callback(cg_obj *co)
+{
+    cg_callback *cc;
+    int          i;
+
+    if ((cc = co->co_callbacks) == NULL || co_callback_next(cc) != NULL)
+        return 0;
+    if (cc->cc_fn_str == NULL)
+        return 0;
+    for (i=0; cli_batch_callbacks[i]; i++)
+        if (strcmp(cc->cc_fn_str, cli_batch_callbacks[i]) == 0)
+            return 1;
+    return 0;
+}
+
+/*! Send batched edits to the backend as one edit-config
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK, or nothing to send
+ * @retval    -1   Error, with the script lines of the batch, edits are discarded
+ */
+int
+cli_batch_flush(clicon_handle h)
+{
+    int               retval = -1;
+    struct cli_batch *cb = NULL;
+    cbuf             *cbx = NULL;
+    char             *reason = NULL;
+
+    if (clicon_ptr_get(h, CLI_BATCH_NAME, (void**)&cb) < 0 || cb == NULL || cb->cb_xtop == NULL)
+        goto ok;
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s %d edits lines %d-%d", __FUNCTION__,
+                 cb->cb_n, cb->cb_line0, cb->cb_line1);
+    if ((cbx = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cbx, cb->cb_xtop, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    xml_free(cb->cb_xtop);
+    cb->cb_xtop = NULL;
+    cb->cb_n = 0;
+    if (clicon_rpc_edit_config(h, "candidate", OP_NONE, cbuf_get(cbx)) < 0){
+        /* Map error back to script lines */
+        if ((reason = strdup(clicon_err_reason)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        if (cb->cb_line0 == cb->cb_line1)
+            clicon_err(OE_CFG, 0, "Line %d: %s", cb->cb_line0, reason);
+        else
+            clicon_err(OE_CFG, 0, "Lines %d-%d: %s", cb->cb_line0, cb->cb_line1, reason);
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    if (cbx)
+        cbuf_free(cbx);
+    return retval;
+}
+
+/*! Merge a single-path edit into a batch tree
+ *
+ * An edit conflicts if it meets a node with an operation in the batch, or if it has an
+ * operation on a node that already exists in the batch, since order then matters
+ * @param[in]  x0   Batch tree node
+ * @param[in]  x1   Edit tree node, children are moved to x0
+ * @retval     1    Merged
+ * @retval     0    Conflict, nothing moved
+ * @retval    -1    Error
+ */
+static int
+cli_batch_merge(cxobj *x0,
+                cxobj *x1)
+{
+    int    retval = -1;
+    cxobj *x1c;
+    cxobj *x0c = NULL;
+    int    ret;
+
+    while ((x1c = xml_child_each(x1, NULL, CX_ELMNT)) != NULL){
+        if (xml_spec(x1c) == NULL)
+            goto conflict;
+        if (match_base_child(x0, x1c, xml_spec(x1c), &x0c) < 0)
+            goto done;
+        if (x0c == NULL){
+            if (xml_find_type(x0, NULL, "operation", CX_ATTR) != NULL)
+                goto conflict;
+            /* Keep batch sorted for match_base_child */
+            if (xml_rm(x1c) < 0)
+                goto done;
+            if (xml_insert(x0, x1c, INS_LAST, NULL, NULL) < 0)
+                goto done;
+            continue;
+        }
+        if (xml_find_type(x0c, NULL, "operation", CX_ATTR) != NULL ||
+            xml_find_type(x1c, NULL, "operation", CX_ATTR) != NULL)
+            goto conflict;
+        /* Edits are single paths, so a conflict below has not moved anything */
+        if ((ret = cli_batch_merge(x0c, x1c)) < 0)
+            goto done;
+        if (ret == 0)
+            goto conflict;
+        if (xml_rm(x1c) < 0)
+            goto done;
+        xml_free(x1c);
+    }
+    retval = 1;
+ done:
+    return retval;
+ conflict:
+    retval = 0;
+    goto done;
+}
+
+/*! Add an edit to the batch, sending the batch first if needed
+ *
+ * A failed send of earlier edits is an error, but the edit is still batched
+ * @param[in]  h     Clixon handle
+ * @param[in]  xtop  Edit-config tree of one edit, consumed if batching
+ * @retval     1     Batched, xtop consumed
+ * @retval     0     Not batching
+ * @retval    -1     Error, xtop consumed
+ */
+static int
+cli_batch_add(clicon_handle h,
+              cxobj        *xtop)
+{
+    int               retval = -1;
+    struct cli_batch *cb = NULL;
+    int               ret;
+    int               failed = 0;
+
+    if (clicon_ptr_get(h, CLI_BATCH_NAME, (void**)&cb) < 0 || cb == NULL)
+        return 0;
+    if (cb->cb_xtop != NULL){
+        if ((ret = cli_batch_merge(cb->cb_xtop, xtop)) < 0){
+            xml_free(xtop);
+            goto done;
+        }
+        if (ret == 1){
+            xml_free(xtop);
+            cb->cb_n++;
+            cb->cb_line1 = cb->cb_line;
+            goto batched;
+        }
+        if (cli_batch_flush(h) < 0)
+            failed++;
+    }
+    cb->cb_xtop = xtop;
+    cb->cb_n = 1;
+    cb->cb_line0 = cb->cb_line1 = cb->cb_line;
+    if (failed)
+        goto done;
+ batched:
+    if (cb->cb_n >= clicon_option_int(h, "CLICON_CLI_BATCH_EDITS"))
+        if (cli_batch_flush(h) < 0)
+            goto done;
+    retval = 1;
+ done:
+    return retval;
+}
+
+/*! Send remaining batched edits and stop batching
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error sending edits
+ */
+int
+cli_batch_exit(clicon_handle h)
+{
+    int               retval;
+    struct cli_batch *cb = NULL;
+
+    if (clicon_ptr_get(h, CLI_BATCH_NAME, (void**)&cb) < 0 || cb == NULL)
+        return 0;
+    retval = cli_batch_flush(h);
+    if (cb->cb_xtop)
+        xml_free(cb->cb_xtop);
+    free(cb);
+    clicon_ptr_del(h, CLI_BATCH_NAME);
+    return retval;
+}
+
 /*! Modify xml datastore from a callback using xml key format strings
  *
  * @param[in]  h     Clicon handle
@@ -486,6 +744,15 @@ cli_dbxml(clicon_handle       h,
      */
     if ((ret = xml_apply0(xbot, CX_ELMNT, identityref_add_ns, yspec0)) < 0)
         goto done;
+    /* Script edits may be sent later in one edit-config */
+    if ((ret = cli_batch_add(h, xtop)) < 0){
+        xtop = NULL;
+        goto done;
+    }
+    if (ret == 1){
+        xtop = NULL;
+        goto ok;
+    }
     if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
@@ -494,6 +761,7 @@ cli_dbxml(clicon_handle       h,
         goto done;
     if (clicon_rpc_edit_config(h, "candidate", OP_NONE, cbuf_get(cb)) < 0)
         goto done;
+ ok:
     retval = 0;
  done:
     if (api_path_fmt_cb)
@@ -871,21 +1139,11 @@ compare_db_names(clicon_handle    h,
     int              retval = -1;
     cxobj           *xc1 = NULL;
     cxobj           *xc2 = NULL;
-    cxobj           *xerr = NULL;
     cbuf            *cb = NULL;
 
-    if (clicon_rpc_get_config(h, NULL, db1, "/", NULL, NULL, &xc1) < 0)
+    /* Only the differing nodes are sent by the backend */
+    if (clicon_rpc_datastore_diff(h, db1, db2, &xc1, &xc2) < 0)
         goto done;
-    if ((xerr = xpath_first(xc1, NULL, "/rpc-error")) != NULL){
-        clixon_netconf_error(xerr, "Get configuration", NULL);
-        goto done;
-    }
-    if (clicon_rpc_get_config(h, NULL, db2, "/", NULL, NULL, &xc2) < 0)
-        goto done;
-    if ((xerr = xpath_first(xc2, NULL, "/rpc-error")) != NULL){
-        clixon_netconf_error(xerr, "Get configuration", NULL);
-        goto done;
-    }
     /* Note that XML and TEXT uses a (new) structured in-mem algorithm while 
      * JSON and CLI uses (old) UNIX file diff.
      */
@@ -972,6 +1230,9 @@ compare_dbs(clicon_handle h,
  * 
  * @note that "filename" is local on client filesystem not backend. 
  * @note file is assumed to have a dummy top-tag, eg <clicon></clicon>
+ * @note If the ietf-netconf:url feature is enabled, XML and JSON files are not parsed by the
+ *       CLI, instead the path is sent as a file url and the backend reads the file with the
+ *       credentials of the CLI user. Then client and backend need to share the filesystem.
  * @code
  *   # cligen spec
  *   load file <name2:string>, load_config_file("name2","merge");
@@ -999,6 +1260,7 @@ load_config_file(clicon_handle h,
     yang_stmt       *yspec;
     cxobj           *xerr = NULL; 
     char            *lineptr = NULL;
+    char            *abspath = NULL;
 
     if (cvec_len(argv) < 2 || cvec_len(argv) > 4){
         clicon_err(OE_PLUGIN, EINVAL, "Received %d arguments. Expected: <dbname>,<varname>[,<format>]",
@@ -1035,6 +1297,25 @@ load_config_file(clicon_handle h,
         clicon_err(OE_UNIX, errno, "load_config: stat(%s)", filename);
         goto done;
     }
+    /* Backend parses XML and JSON files directly if it supports file urls */
+    if ((format == FORMAT_XML || format == FORMAT_JSON) &&
+        if_feature(yspec, "ietf-netconf", "url")){
+        if ((abspath = realpath(filename, NULL)) == NULL){
+            clicon_err(OE_UNIX, errno, "realpath(%s)", filename);
+            goto done;
+        }
+        if ((cbxml = cbuf_new()) == NULL)
+            goto done;
+        cprintf(cbxml, "<url>file://");
+        if (xml_chardata_cbuf_append(cbxml, abspath) < 0)
+            goto done;
+        cprintf(cbxml, "</url>");
+        if (clicon_rpc_edit_config(h, "candidate",
+                                   replace?OP_REPLACE:OP_MERGE,
+                                   cbuf_get(cbxml)) < 0)
+            goto done;
+        goto ok;
+    }
     /* Open and parse local file into xml */
     if ((fp = fopen(filename, "r")) == NULL){
         clicon_err(OE_UNIX, errno, "fopen(%s)", filename);
@@ -1120,6 +1401,8 @@ load_config_file(clicon_handle h,
  ok:
     ret = 0;
  done:
+    if (abspath)
+        free(abspath);
     if (cbxml)
         cbuf_free(cbxml);
     if (lineptr)
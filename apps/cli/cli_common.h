@@ -43,6 +43,12 @@ void  cli_signal_block(clicon_handle h);
 void  cli_signal_unblock(clicon_handle h);
 int   mtpoint_paths(yang_stmt *yspec0, char *mtpoint, char *api_path_fmt1, char **api_path_fmt01);
 cvec *cvec_append(cvec *cvv0, cvec *cvv1);
+int   cli_expand_cache_free(clicon_handle h);
+int   cli_batch_init(clicon_handle h);
+int   cli_batch_line(clicon_handle h, int line);
+int   cli_batch_callback(cg_obj *co);
+int   cli_batch_flush(clicon_handle h);
+int   cli_batch_exit(clicon_handle h);
 
 /* If you do not find a function here it may be in clixon_cli_api.h which is 
    the external API */
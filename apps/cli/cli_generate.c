@@ -90,6 +90,8 @@ You can see which CLISPEC it generates via clixon_cli -D 2:
 #include <fcntl.h>
 #include <syslog.h>
 #include <signal.h>
+#include <unistd.h>
+#include <inttypes.h>
 #include <sys/param.h>
 
 /* cligen */
@@ -401,7 +403,8 @@ yang2cli_var_pattern(clicon_handle h,
         pattern = cv_string_get(cvp);
         invert = cv_flag(cvp, V_INVERT);
         cprintf(cb, " regexp:%s\"", invert?"!":"");
-        if (mode == REGEXP_POSIX){
+        /* CLIgen has no pcre2 engine, use its posix engine */
+        if (mode == REGEXP_POSIX || mode == REGEXP_PCRE2){
             posix = NULL;
             if (regexp_xsd2posix(pattern, &posix) < 0)
                 goto done;
@@ -924,6 +927,14 @@ yang2cli_container(clicon_handle h,
     int           compress = 0;
     yang_stmt    *ymod = NULL;
     int           extvalue = 0;
+    int           mount = 0;
+    yang_stmt    *yp;
+    cvec         *lazy;
+    cg_var       *cv;
+    cbuf         *cbtree = NULL;
+    char         *ns;
+    pt_head      *ph;
+    parse_tree   *pt;
     int           ret;
     
     if (ys_real_module(ys, &ymod) < 0)
@@ -961,16 +972,56 @@ yang2cli_container(clicon_handle h,
             goto done;
         if (ret){
             cprintf(cb, "%*s%s", (level+1)*3, "", "@mountpoint;\n");
+            mount++;
         }
     }
-    yc = NULL;
-    while ((yc = yn_each(ys, yc)) != NULL) 
-        if (yang2cli_stmt(h, yc, level+1, cb) < 0)
+    /* Lazy: reference to sub-tree of top-level container, generated on demand */
+    if (!compress && !mount &&
+        (lazy = clicon_data_cvec_get(h, AUTOCLI_LAZY_TREES)) != NULL &&
+        (yp = yang_parent_get(ys)) != NULL &&
+        (yang_keyword_get(yp) == Y_MODULE || yang_keyword_get(yp) == Y_SUBMODULE)){
+        if ((ns = yang_find_mynamespace(ys)) == NULL)
             goto done;
+        if ((cbtree = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cbtree, "lazy-%s-%s", ns, yang_argument_get(ys));
+        if (cligen_ph_find(cli_cligen(h), cbuf_get(cbtree)) == NULL){
+            /* Empty until generated */
+            if ((ph = cligen_ph_add(cli_cligen(h), cbuf_get(cbtree))) == NULL){
+                clicon_err(OE_UNIX, 0, "cligen_ph_add");
+                goto done;
+            }
+            if ((pt = pt_new()) == NULL){
+                clicon_err(OE_UNIX, errno, "pt_new");
+                goto done;
+            }
+            if (cligen_ph_parsetree_set(ph, pt) < 0){
+                clicon_err(OE_UNIX, 0, "cligen_ph_parsetree_set");
+                goto done;
+            }
+            if ((cv = cvec_add(lazy, CGV_VOID)) == NULL){
+                clicon_err(OE_UNIX, errno, "cvec_add");
+                goto done;
+            }
+            cv_name_set(cv, cbuf_get(cbtree));
+            cv_void_set(cv, ys);
+        }
+        cprintf(cb, "%*s@%s;\n", (level+1)*3, "", cbuf_get(cbtree));
+    }
+    else {
+        yc = NULL;
+        while ((yc = yn_each(ys, yc)) != NULL) 
+            if (yang2cli_stmt(h, yc, level+1, cb) < 0)
+                goto done;
+    }
     if (!compress)
         cprintf(cb, "%*s}\n", level*3, "");
     retval = 0;
  done:
+    if (cbtree)
+        cbuf_free(cbtree);
     if (helptext)
         free(helptext);
     return retval;
@@ -1602,10 +1653,182 @@ yang2cli_grouping(clicon_handle      h,
     goto done;
 }
 
+/*! FNV-1a 64-bit hash of a string, continued from h
+ */
+static uint64_t
+autocli_cache_hash(uint64_t    h,
+                   const char *str)
+{
+    while (*str){
+        h ^= (uint8_t)*str++;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/*! Compute key of autocli cache: yang spec sources and clixon-autocli config
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Yang spec
+ * @param[out] keyp   Key
+ * @retval     1      OK
+ * @retval     0      Yang spec cannot be cached
+ * @retval    -1      Error
+ */
+static int
+autocli_cache_key(clicon_handle h,
+                  yang_stmt    *yspec,
+                  uint64_t     *keyp)
+{
+    int       retval = -1;
+    uint64_t  k;
+    cxobj    *xautocli;
+    cbuf     *cb = NULL;
+    int       ret;
+
+    if ((ret = yang_spec_cache_hash(h, "cli", yspec, &k)) < 0)
+        goto done;
+    if (ret == 0)
+        goto empty;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* Autocli settings are not options but a subtree of the config */
+    if ((xautocli = clicon_conf_autocli(h)) != NULL &&
+        clixon_xml2cbuf(cb, xautocli, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    *keyp = autocli_cache_hash(k, cbuf_get(cb));
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ empty:
+    retval = 0;
+    goto done;
+}
+
+/*! Load generated clispecs of modules from autocli cache file, if key matches
+ *
+ * File format: a header line "clixon-autocli <key>" followed by one entry per module:
+ * "<module> <len>" line and <len> bytes of clispec
+ * @param[in]  filename  Cache file
+ * @param[in]  key       Cache key
+ * @param[out] cvv       Clispecs of modules with name of module, if 1. Free with cvec_free
+ * @retval     1         Cache loaded
+ * @retval     0         No cache or stale cache
+ * @retval    -1         Error
+ */
+static int
+autocli_cache_load(char     *filename,
+                   uint64_t  key,
+                   cvec    **cvvp)
+{
+    int     retval = -1;
+    FILE   *f = NULL;
+    cvec   *cvv = NULL;
+    char    line[256];
+    char    modname[200];
+    char   *str = NULL;
+    size_t  len;
+    unsigned long long k;
+
+    if ((f = fopen(filename, "r")) == NULL)
+        goto stale;
+    if (fgets(line, sizeof(line), f) == NULL ||
+        sscanf(line, "clixon-autocli %llx", &k) != 1 ||
+        k != key)
+        goto stale;
+    if ((cvv = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    while (fgets(line, sizeof(line), f) != NULL){
+        if (sscanf(line, "%199s %zu", modname, &len) != 2)
+            goto stale;
+        if ((str = malloc(len+1)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        if (fread(str, 1, len, f) != len)
+            goto stale;
+        str[len] = '\0';
+        if (cvec_add_string(cvv, modname, str) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+        free(str);
+        str = NULL;
+    }
+    clicon_debug(1, "%s loaded %s", __FUNCTION__, filename);
+    *cvvp = cvv;
+    cvv = NULL;
+    retval = 1;
+ done:
+    if (str)
+        free(str);
+    if (cvv)
+        cvec_free(cvv);
+    if (f)
+        fclose(f);
+    return retval;
+ stale:
+    clicon_debug(1, "%s %s not found or stale", __FUNCTION__, filename);
+    retval = 0;
+    goto done;
+}
+
+/*! Save generated clispecs of modules to autocli cache file
+ *
+ * Written to a temporary file and renamed. If the file cannot be written, only a warning
+ * is logged.
+ * @param[in]  filename  Cache file
+ * @param[in]  key       Cache key
+ * @param[in]  cvv       Clispecs of modules with name of module
+ * @retval     0         OK, saved or not
+ * @see autocli_cache_load
+ */
+static int
+autocli_cache_save(char     *filename,
+                   uint64_t  key,
+                   cvec     *cvv)
+{
+    char    tmpfile[MAXPATHLEN];
+    FILE   *f;
+    cg_var *cv = NULL;
+    char   *str;
+    int     ok;
+
+    snprintf(tmpfile, sizeof(tmpfile), "%s.%d", filename, getpid());
+    if ((f = fopen(tmpfile, "w")) == NULL){
+        clicon_log(LOG_WARNING, "%s: %s: %s", __FUNCTION__, tmpfile, strerror(errno));
+        return 0;
+    }
+    ok = fprintf(f, "clixon-autocli %016llx\n", (unsigned long long)key) > 0;
+    while (ok && (cv = cvec_each(cvv, cv)) != NULL){
+        str = cv_string_get(cv);
+        ok = fprintf(f, "%s %zu\n", cv_name_get(cv), strlen(str)) > 0 &&
+            fwrite(str, 1, strlen(str), f) == strlen(str);
+    }
+    if (fclose(f) != 0)
+        ok = 0;
+    if (!ok || rename(tmpfile, filename) < 0){
+        clicon_log(LOG_WARNING, "%s: %s: %s", __FUNCTION__, filename, strerror(errno));
+        unlink(tmpfile);
+        return 0;
+    }
+    clicon_debug(1, "%s saved %s", __FUNCTION__, filename);
+    return 0;
+}
+
 /*! Generate clispec for all modules in yspec (except excluded)
  * 
  * Called in cli main function for top-level yangs. But may also be called dynamically for
  * mountpoints.
+ * If CLICON_YANG_CACHE_DIR is set, the generated clispec of each module is saved in
+ * <treename>.acache in that directory, and read from it at next start instead of generated
+ * from yang, unless the yang spec sources, options or clixon-autocli config have changed.
  * @param[in]  h         Clixon handle
  * @param[in]  yspec     Top-level Yang statement of type Y_SPEC
  * @param[in]  treename  Name of tree
@@ -1629,6 +1852,15 @@ yang2cli_yspec(clicon_handle      h,
     cg_obj         *co;
     int             i;
     int             config;
+    char           *dir;
+    cbuf           *cbc = NULL;  /* Cache file name */
+    uint64_t        key = 0;
+    cvec           *cache = NULL; /* Clispecs of modules from cache */
+    cvec           *save = NULL;  /* Clispecs of modules to cache */
+    cg_var         *cv;
+    int             lazy = 0;
+    cvec           *cvl;
+    int             ret;
     
     if ((pt0 = pt_new()) == NULL){
         clicon_err(OE_UNIX, errno, "pt_new");
@@ -1638,6 +1870,39 @@ yang2cli_yspec(clicon_handle      h,
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
+    /* Lazy generation of top-level containers of main yang spec, see yang2cli_container */
+    if (yspec == clicon_dbspec_yang(h)){
+        if (autocli_lazy(h, &lazy) < 0)
+            goto done;
+        if (lazy && clicon_data_cvec_get(h, AUTOCLI_LAZY_TREES) == NULL){
+            if ((cvl = cvec_new(0)) == NULL){
+                clicon_err(OE_UNIX, errno, "cvec_new");
+                goto done;
+            }
+            if (clicon_data_cvec_set(h, AUTOCLI_LAZY_TREES, cvl) < 0)
+                goto done;
+        }
+    }
+    /* Autocli cache of generated clispec of main yang spec, not when lazy since the cached
+     * clispec does not register the lazy trees */
+    if (yspec == clicon_dbspec_yang(h) && !lazy &&
+        (dir = clicon_option_str(h, "CLICON_YANG_CACHE_DIR")) != NULL){
+        if ((ret = autocli_cache_key(h, yspec, &key)) < 0)
+            goto done;
+        if (ret == 1){
+            if ((cbc = cbuf_new()) == NULL){
+                clicon_err(OE_XML, errno, "cbuf_new");
+                goto done;
+            }
+            cprintf(cbc, "%s/%s.acache", dir, treename);
+            if ((ret = autocli_cache_load(cbuf_get(cbc), key, &cache)) < 0)
+                goto done;
+            if (ret == 0 && (save = cvec_new(0)) == NULL){
+                clicon_err(OE_UNIX, errno, "cvec_new");
+                goto done;
+            }
+        }
+    }
     /* Traverse YANG, loop through all modules and generate CLI */
     ymod = NULL;
     while ((ymod = yn_each(yspec, ymod)) != NULL){
@@ -1649,10 +1914,18 @@ yang2cli_yspec(clicon_handle      h,
         if (!enable)
             continue;
         cbuf_reset(cb);
-        if (yang2cli_stmt(h, ymod, 0, cb) < 0)
+        if (cache){ /* Modules with empty clispec are not in cache */
+            if ((cv = cvec_find(cache, yang_argument_get(ymod))) != NULL)
+                cprintf(cb, "%s", cv_string_get(cv));
+        }
+        else if (yang2cli_stmt(h, ymod, 0, cb) < 0)
             goto done;
         if (cbuf_len(cb) == 0)
             continue;
+        if (save && cvec_add_string(save, yang_argument_get(ymod), cbuf_get(cb)) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
         /* Note Tie-break of same top-level symbol: prefix is NYI
          * Needs to move cligen_parse_str() call here instead of later
          */
@@ -1702,6 +1975,8 @@ yang2cli_yspec(clicon_handle      h,
         pt_free(pt, 1);
         pt = NULL;
     } /* ymod */
+    if (save && autocli_cache_save(cbuf_get(cbc), key, save) < 0)
+        goto done;
     /* Resolve the expand callback functions in the generated syntax.
      * This "should" only be GENERATE_EXPAND_XMLDB
      * handle=NULL for global namespace, this means expand callbacks must be in
@@ -1727,6 +2002,12 @@ yang2cli_yspec(clicon_handle      h,
 #endif
     retval = 0;
  done:
+    if (cache)
+        cvec_free(cache);
+    if (save)
+        cvec_free(save);
+    if (cbc)
+        cbuf_free(cbc);
     if (pt)
         pt_free(pt, 1);
     if (pt0)
@@ -1736,6 +2017,128 @@ yang2cli_yspec(clicon_handle      h,
     return retval;
 }
 
+/*! Generate sub-tree of a top-level container on demand
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  ys        Yang container
+ * @param[in]  treename  Name of tree, referenced from the container in the autocli tree
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @see yang2cli_container where the reference is generated
+ */
+static int
+yang2cli_lazy_tree(clicon_handle h,
+                   yang_stmt    *ys,
+                   char         *treename)
+{
+    int         retval = -1;
+    cbuf       *cb = NULL;
+    parse_tree *pt = NULL;
+    parse_tree *pt0;
+    pt_head    *ph;
+    yang_stmt  *yc;
+    int         config;
+
+    if ((ph = cligen_ph_find(cli_cligen(h), treename)) == NULL){
+        clicon_err(OE_PLUGIN, ENOENT, "No such parsetree header: %s", treename);
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    /* Same as children of container at top-level, see yang2cli_container */
+    yc = NULL;
+    while ((yc = yn_each(ys, yc)) != NULL) 
+        if (yang2cli_stmt(h, yc, 2, cb) < 0)
+            goto done;
+    if ((pt = pt_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "pt_new");
+        goto done;
+    }
+    if (cbuf_len(cb) &&
+        clispec_parse_str(cli_cligen(h), cbuf_get(cb), "yang2cli", NULL, pt, NULL) < 0){
+        fprintf(stderr, "%s\n", cbuf_get(cb));
+        goto done;
+    }
+    config = yang_config(ys);
+    if (yang2cli_post(h, NULL, pt, 0, ys, NULL, &config) < 0)
+        goto done;
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: Lazy cli-spec %s:\n%s",
+                 __FUNCTION__, treename, cbuf_get(cb));
+    if (cligen_expandv_str2fn(pt, (expandv_str2fn_t*)clixon_str2fn, NULL) < 0)
+        goto done;
+    pt0 = cligen_ph_parsetree_get(ph);
+    if (cligen_ph_parsetree_set(ph, pt) < 0){
+        clicon_err(OE_UNIX, 0, "cligen_ph_parsetree_set");
+        goto done;
+    }
+    pt = NULL;
+    if (pt0)
+        pt_free(pt0, 1);
+    retval = 0;
+ done:
+    if (pt)
+        pt_free(pt, 1);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Check if a word of a command line may be an abbreviation of a keyword
+ */
+static int
+yang2cli_lazy_match(char *cmd,
+                    char *keyword)
+{
+    char   *s = cmd;
+    size_t  len;
+
+    while (*s){
+        while (*s == ' ' || *s == '\t')
+            s++;
+        len = strcspn(s, " \t");
+        if (len && len <= strlen(keyword) && strncmp(s, keyword, len) == 0)
+            return 1;
+        s += len;
+    }
+    return 0;
+}
+
+/*! Generate sub-trees of top-level containers not yet generated, if autocli lazy is set
+ *
+ * Called before a command line is parsed. Since cligen has no hook for completion, all
+ * remaining sub-trees are generated before an interactive command is read.
+ * @param[in]  h    Clixon handle
+ * @param[in]  cmd  Command line: generate sub-trees of containers it may refer to. 
+ *                  If NULL, generate all.
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see autocli_lazy
+ */
+int
+yang2cli_lazy(clicon_handle h,
+              char         *cmd)
+{
+    cvec      *cvv;
+    cg_var    *cv = NULL;
+    yang_stmt *ys;
+
+    if ((cvv = clicon_data_cvec_get(h, AUTOCLI_LAZY_TREES)) == NULL)
+        return 0;
+    while ((cv = cvec_each(cvv, cv)) != NULL){
+        if ((ys = cv_void_get(cv)) == NULL)
+            continue;
+        if (cmd && !yang2cli_lazy_match(cmd, yang_argument_get(ys)))
+            continue;
+        cv_void_set(cv, NULL);
+        clicon_debug(1, "%s %s", __FUNCTION__, cv_name_get(cv));
+        if (yang2cli_lazy_tree(h, ys, cv_name_get(cv)) < 0)
+            return -1;
+    }
+    return 0;
+}
+
 /*! Init yang2cli
  *
  * Initialize CLIgen generation from YANG models.
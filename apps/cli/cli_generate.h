@@ -58,10 +58,16 @@
  */
 #define AUTOCLI_TREENAME "basemodel"
 
+/* Handle data: trees of top-level containers to generate on demand, see yang2cli_lazy
+ * Cvec with name of tree and yang container, NULL when generated
+ */
+#define AUTOCLI_LAZY_TREES "autocli-lazy-trees"
+
 /*
  * Prototypes
  */
 int yang2cli_yspec(clicon_handle h, yang_stmt *yspec, char *treename);
+int yang2cli_lazy(clicon_handle h, char *cmd);
 int yang2cli_init(clicon_handle h);
 
 #endif  /* _CLI_GENERATE_H_ */
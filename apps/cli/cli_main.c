@@ -181,14 +181,22 @@ cli_terminate(clicon_handle h)
         xml_free(x);
     clicon_data_cvec_del(h, "cli-edit-cvv");;
     clicon_data_cvec_del(h, "cli-edit-filter");;
+    clicon_data_cvec_del(h, AUTOCLI_LAZY_TREES);
+    cli_expand_cache_free(h);
     xpath_optimize_exit();
     /* Delete all plugins, and RPC callbacks */
     clixon_plugin_module_exit(h);
     /* Delete CLI syntax et al */
     cli_plugin_finish(h);
+    xmldb_snapshot_exit(h);
+    xpath_cache_exit();
+    api_path_cache_exit();
+    xml_nsid_exit();
+    nacm_ruleset_free(h);
 
     cli_history_save(h);
     cli_handle_exit(h);
+    clixon_pool_exit();
     clixon_err_exit();
     clicon_log_exit();
     return 0;
@@ -226,6 +234,8 @@ cli_signal_init (clicon_handle h)
 }
 
 /*! Interactive CLI command loop
+ *
+ * If commands are read from a file or pipe, edits may be batched, see CLICON_CLI_BATCH_EDITS
  * @param[in]  h    CLICON handle
  * @retval     0
  * @retval    -1
@@ -240,7 +250,10 @@ cli_interactive(clicon_handle h)
     cligen_result result;
     int           ret;
     pt_head      *ph;
+    int           line = 0;
 
+    if (!isatty(0) && cli_batch_init(h) < 0)
+        goto done;
     /* Loop through all commands */
     while(!cligen_exiting(cli_cligen(h))) {
         if ((ph =  cligen_pt_head_active_get(cli_cligen(h))) == NULL){
@@ -258,6 +271,7 @@ cli_interactive(clicon_handle h)
             cligen_exiting_set(cli_cligen(h), 1);
             continue;
         }
+        cli_batch_line(h, ++line);
         /* Here errors are handled */
         if (clicon_parse(h, cmd, &new_mode, &result, NULL) < 0)
             goto done;
@@ -265,6 +279,9 @@ cli_interactive(clicon_handle h)
     }
     retval = 0;
  done:
+    /* Send remaining edits */
+    if (cli_batch_exit(h) < 0)
+        cli_handler_err(stdout);
     return retval;
 }
 
@@ -523,6 +540,7 @@ main(int    argc,
     size_t         cligen_bufthreshold;
     int            dbg=0;
     int            nr;
+    int            cached;
     int           config_dump;
     enum format_enum config_dump_format = FORMAT_XML;
     
@@ -732,6 +750,8 @@ main(int    argc,
 
     if ((nr = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clicon_log_string_limit_set(nr);
+    if ((nr = clicon_option_int(h, "CLICON_LOG_RATE_LIMIT")) != 0)
+        clicon_log_rate_limit_set(nr);
     
     /* Setup signal handlers */
     if (cli_signal_init(h) < 0)
@@ -773,6 +793,9 @@ main(int    argc,
         goto done;
     clicon_dbspec_yang_set(h, yspec);
     
+    /* Load yang spec from cache if valid, then the modules below are already loaded */
+    if ((cached = yang_spec_cache_load(h, "cli", yspec)) < 0)
+        goto done;
     /* Load Yang modules
      * 1. Load a yang module as a specific absolute filename */
     if ((str = clicon_yang_main_file(h)) != NULL){
@@ -803,6 +826,9 @@ main(int    argc,
     if (netconf_module_load(h) < 0)
         goto done;
     
+    if (cached == 0 &&
+        yang_spec_cache_save(h, "cli", yspec) < 0)
+        goto done;
     /* Here all modules are loaded 
      * Compute and set canonical namespace context
      */
@@ -34,6 +34,7 @@
  * Example cli pipe output functions.
  * @note Paths to bins, such as GREP_BIN, are detected in configure.ac
  * @note These functions are normally run in a forked sub-process as spawned in cligen_eval()
+ * grep, tail and count are made in-process for common options, other options exec the UNIX commands
  * A developer should probably revise these functions, since they are primarily intended for testing
  * of the pipe functionality
  */
@@ -50,6 +51,7 @@
 #include <stdarg.h>
 #include <time.h>
 #include <ctype.h>
+#include <regex.h>
 
 #include <unistd.h>
 #include <dirent.h>
@@ -121,6 +123,128 @@ pipe_arg_fn(clicon_handle h,
     return retval;
 }
 
+/*! Print lines of stdin matching a basic regular expression, as grep -e or grep -v
+ *
+ * @param[in]  pattern  Basic regular expression, as grep
+ * @param[in]  invert   If set, print non-matching lines, as grep -v
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+pipe_grep_stdin(char *pattern,
+                int   invert)
+{
+    int     retval = -1;
+    regex_t re = {0,};
+    int     compiled = 0;
+    char   *line = NULL;
+    size_t  len = 0;
+    char    errbuf[128];
+    int     ret;
+
+    if ((ret = regcomp(&re, pattern, REG_NOSUB)) != 0){
+        regerror(ret, &re, errbuf, sizeof(errbuf));
+        clicon_err(OE_REGEX, 0, "regcomp(%s): %s", pattern, errbuf);
+        goto done;
+    }
+    compiled++;
+    while (getline(&line, &len, stdin) != -1){
+        if ((regexec(&re, line, 0, NULL, 0) == 0) != invert)
+            cligen_output(stdout, "%s", line);
+        if (cli_output_status() < 0)
+            break;
+    }
+    retval = 0;
+ done:
+    if (line)
+        free(line);
+    if (compiled)
+        regfree(&re);
+    return retval;
+}
+
+/*! Print number of lines of stdin, as wc -l
+ *
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+pipe_count_stdin(void)
+{
+    char   *line = NULL;
+    size_t  len = 0;
+    int     n = 0;
+
+    while (getline(&line, &len, stdin) != -1)
+        n++;
+    if (line)
+        free(line);
+    cligen_output(stdout, "%d\n", n);
+    return 0;
+}
+
+/*! Print the last lines of stdin, as tail -n
+ *
+ * @param[in]  value  Number of lines
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+pipe_tail_stdin(char *value)
+{
+    int       retval = -1;
+    uint32_t  nr = 0;
+    char     *reason = NULL;
+    char    **ring = NULL;
+    char     *line = NULL;
+    size_t    len = 0;
+    uint64_t  n = 0;
+    uint64_t  i;
+    int       ret;
+
+    if ((ret = parse_uint32(value, &nr, &reason)) < 0){
+        clicon_err(OE_UNIX, errno, "parse_uint32");
+        goto done;
+    }
+    if (ret == 0){
+        clicon_err(OE_PLUGIN, EINVAL, "tail %s: %s", value, reason);
+        goto done;
+    }
+    if (nr && (ring = calloc(nr, sizeof(char *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Keep the last nr lines in a ring */
+    while (getline(&line, &len, stdin) != -1){
+        if (nr == 0)
+            continue;
+        if (ring[n%nr])
+            free(ring[n%nr]);
+        ring[n%nr] = line;
+        line = NULL;
+        len = 0;
+        n++;
+    }
+    for (i = n>nr?n-nr:0; i<n; i++){
+        cligen_output(stdout, "%s", ring[i%nr]);
+        if (cli_output_status() < 0)
+            break;
+    }
+    retval = 0;
+ done:
+    if (ring){
+        for (i=0; i<nr; i++)
+            if (ring[i])
+                free(ring[i]);
+        free(ring);
+    }
+    if (line)
+        free(line);
+    if (reason)
+        free(reason);
+    return retval;
+}
+
 /* Grep pipe output function
  *
  * @param[in]  h     Clicon handle
@@ -165,6 +289,10 @@ pipe_grep_fn(clicon_handle h,
             strlen(str))
             pattern = str;
     }
+    if (pattern == NULL){
+        clicon_err(OE_PLUGIN, EINVAL, "No pattern");
+        goto done;
+    }
     /* quote | in pattern into cbuf */
     for (i=0; i<strlen(pattern); i++){
         c = pattern[i];
@@ -173,7 +301,12 @@ pipe_grep_fn(clicon_handle h,
         else
             cprintf(cb, "%c", c);
     }
-    retval = pipe_arg_fn(h, GREP_BIN, option, cbuf_get(cb));
+    if (option == NULL || strcmp(option, "-e") == 0)
+        retval = pipe_grep_stdin(cbuf_get(cb), 0);
+    else if (strcmp(option, "-v") == 0)
+        retval = pipe_grep_stdin(cbuf_get(cb), 1);
+    else
+        retval = pipe_arg_fn(h, GREP_BIN, option, cbuf_get(cb));
  done:
     if (cb)
         cbuf_free(cb);
@@ -204,7 +337,10 @@ pipe_wc_fn(clicon_handle h,
         (str = cv_string_get(cv)) != NULL &&
         strlen(str))
         option = str;
-    retval = pipe_arg_fn(h, WC_BIN, option, NULL);
+    if (option && strcmp(option, "-l") == 0)
+        retval = pipe_count_stdin();
+    else
+        retval = pipe_arg_fn(h, WC_BIN, option, NULL);
  done:
     return retval;
 }
@@ -245,55 +381,37 @@ pipe_tail_fn(clicon_handle h,
             strlen(str))
             value = str;
     }
-    return pipe_arg_fn(h, TAIL_BIN, option, value);
+    if (option && strcmp(option, "-n") == 0 && value)
+        retval = pipe_tail_stdin(value);
+    else
+        retval = pipe_arg_fn(h, TAIL_BIN, option, value);
  done:
     return retval;
 }
 
-/*! Output pipe translate from xml to other format: json,text,
+/*! Parse xml from stdin and print it in another format
  *
- * @param[in]  h     Clicon handle
- * @param[in]  cvv   Vector of cli string and instantiated variables 
- * @param[in]  argv  String vector of show options, format:
- *   <format>        "text"|"xml"|"json"|"cli"|"netconf" (see format_enum), default: xml
- *   <pretty>        true|false: pretty-print or not
- *   <prepend>       CLI prefix: prepend before cli syntax output
- * @see cli_show_auto_devs
+ * @param[in]  h        Clixon handle
+ * @param[in]  xt       XML tree parsed from stdin
+ * @param[in]  format   Output format
+ * @param[in]  pretty   Pretty-print or not
+ * @param[in]  prepend  CLI prefix: prepend before cli syntax output
+ * @retval     0        OK
+ * @retval    -1        Error
  */
-int
-pipe_showas_fn(clicon_handle h,
-               cvec         *cvv,
-               cvec         *argv)
+static int
+pipe_xml2output(clicon_handle    h,
+                cxobj           *xt,
+                enum format_enum format,
+                int              pretty,
+                char            *prepend)
 {
-    int              retval = -1;
-    cxobj           *xt = NULL;
-    int              argc = 0;
-    enum format_enum format = FORMAT_XML;
-    yang_stmt       *yspec;
-    int              pretty = 1;
-    char            *prepend = NULL;
-    int              ret;
-    cxobj           *xerr = NULL;
+    int        retval = -1;
+    yang_stmt *yspec;
+    int        ret;
+    cxobj     *xerr = NULL;
 
-    if (cvec_len(argv) < 1 || cvec_len(argv) > 3){
-        clicon_err(OE_PLUGIN, EINVAL, "Received %d arguments. Expected:: <format> [<pretty> [<prepend>]]", cvec_len(argv));
-        goto done;
-    }
-    if (cvec_len(argv) > argc){
-        if (cli_show_option_format(argv, argc++, &format) < 0)
-            goto done;
-    }
-    if (cvec_len(argv) > argc){
-        if (cli_show_option_bool(argv, argc++, &pretty) < 0)
-            goto done;
-    }
-    if (cvec_len(argv) > argc){
-        prepend = cv_string_get(cvec_i(argv, argc++));
-    }
     yspec = clicon_dbspec_yang(h);
-    /* Bind module with mtpoints requires h, but parse functions font have h */
-    if (clixon_xml_parse_file(stdin, YB_NONE, yspec, &xt, NULL) < 0)
-        goto done;
     switch (format){
     case FORMAT_CLI:
     case FORMAT_TEXT:
@@ -333,6 +451,182 @@ pipe_showas_fn(clicon_handle h,
  done:
     if (xerr)
         xml_free(xerr);
+    return retval;
+}
+
+/*! Parse format, pretty and prepend options of pipe functions
+ *
+ * @param[in]     argv     String vector of options
+ * @param[in]     argc     Index of first option
+ * @param[out]    format   Output format, if given
+ * @param[out]    pretty   Pretty-print, if given
+ * @param[out]    prepend  CLI prefix, if given
+ * @retval        0        OK
+ * @retval       -1        Error
+ */
+static int
+pipe_format_options(cvec             *argv,
+                    int               argc,
+                    enum format_enum *format,
+                    int              *pretty,
+                    char            **prepend)
+{
+    int retval = -1;
+
+    if (cvec_len(argv) > argc){
+        if (cli_show_option_format(argv, argc++, format) < 0)
+            goto done;
+    }
+    if (cvec_len(argv) > argc){
+        if (cli_show_option_bool(argv, argc++, pretty) < 0)
+            goto done;
+    }
+    if (cvec_len(argv) > argc){
+        *prepend = cv_string_get(cvec_i(argv, argc++));
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Output pipe translate from xml to other format: json,text,
+ *
+ * @param[in]  h     Clicon handle
+ * @param[in]  cvv   Vector of cli string and instantiated variables 
+ * @param[in]  argv  String vector of show options, format:
+ *   <format>        "text"|"xml"|"json"|"cli"|"netconf" (see format_enum), default: xml
+ *   <pretty>        true|false: pretty-print or not
+ *   <prepend>       CLI prefix: prepend before cli syntax output
+ * @see cli_show_auto_devs
+ */
+int
+pipe_showas_fn(clicon_handle h,
+               cvec         *cvv,
+               cvec         *argv)
+{
+    int              retval = -1;
+    cxobj           *xt = NULL;
+    enum format_enum format = FORMAT_XML;
+    yang_stmt       *yspec;
+    int              pretty = 1;
+    char            *prepend = NULL;
+
+    if (cvec_len(argv) < 1 || cvec_len(argv) > 3){
+        clicon_err(OE_PLUGIN, EINVAL, "Received %d arguments. Expected:: <format> [<pretty> [<prepend>]]", cvec_len(argv));
+        goto done;
+    }
+    if (pipe_format_options(argv, 0, &format, &pretty, &prepend) < 0)
+        goto done;
+    yspec = clicon_dbspec_yang(h);
+    /* Bind module with mtpoints requires h, but parse functions font have h */
+    if (clixon_xml_parse_file(stdin, YB_NONE, yspec, &xt, NULL) < 0)
+        goto done;
+    if (pipe_xml2output(h, xt, format, pretty, prepend) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Remove entries whose leaf does not have a value, recursively
+ *
+ * An entry is an element with a child leaf of the given name, such as a list entry
+ * Other elements, such as containers, are traversed
+ * @param[in]  xn     XML node
+ * @param[in]  leaf   Name of leaf
+ * @param[in]  value  Value of leaf of entries to keep
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+pipe_select_entries(cxobj *xn,
+                    char  *leaf,
+                    char  *value)
+{
+    int    retval = -1;
+    cxobj *x;
+    cxobj *xprev;
+    cxobj *xl;
+    char  *body;
+
+    x = NULL;
+    xprev = NULL;
+    while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL){
+        if ((xl = xml_find_type(x, NULL, leaf, CX_ELMNT)) != NULL){
+            if ((body = xml_body(xl)) == NULL || strcmp(body, value) != 0){
+                if (xml_purge(x) < 0)
+                    goto done;
+                x = xprev;
+                continue;
+            }
+        }
+        else if (pipe_select_entries(x, leaf, value) < 0)
+            goto done;
+        xprev = x;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Output pipe selecting list entries by leaf value, then print in a format
+ *
+ * Filters the XML tree before rendering, instead of filtering rendered lines as grep
+ * Entries are elements with a child leaf of the given name, such as list entries, they are kept
+ * only if the leaf has the given value. Other nodes are kept.
+ * @param[in]  h     Clicon handle
+ * @param[in]  cvv   Vector of cli string and instantiated variables 
+ * @param[in]  argv  String vector of options, format:
+ *   <leafname>      Name of cli variable with leaf name
+ *   <valuename>     Name of cli variable with leaf value
+ *   <format>        "text"|"xml"|"json"|"cli" (see format_enum), default: xml
+ *   <pretty>        true|false: pretty-print or not
+ *   <prepend>       CLI prefix: prepend before cli syntax output
+ * @code
+ *   select <leaf:string> <value:string>, pipe_select_fn("leaf", "value", "xml");
+ * @endcode
+ * @see pipe_showas_fn
+ */
+int
+pipe_select_fn(clicon_handle h,
+               cvec         *cvv,
+               cvec         *argv)
+{
+    int              retval = -1;
+    cxobj           *xt = NULL;
+    enum format_enum format = FORMAT_XML;
+    yang_stmt       *yspec;
+    int              pretty = 1;
+    char            *prepend = NULL;
+    cg_var          *cv;
+    char            *leaf = NULL;
+    char            *value = NULL;
+
+    if (cvec_len(argv) < 2 || cvec_len(argv) > 5){
+        clicon_err(OE_PLUGIN, EINVAL, "Received %d arguments. Expected:: <leafname> <valuename> [<format> [<pretty> [<prepend>]]]", cvec_len(argv));
+        goto done;
+    }
+    if ((cv = cvec_find_var(cvv, cv_string_get(cvec_i(argv, 0)))) != NULL)
+        leaf = cv_string_get(cv);
+    if ((cv = cvec_find_var(cvv, cv_string_get(cvec_i(argv, 1)))) != NULL)
+        value = cv_string_get(cv);
+    if (leaf == NULL || value == NULL){
+        clicon_err(OE_PLUGIN, EINVAL, "No leaf or value in command");
+        goto done;
+    }
+    if (pipe_format_options(argv, 2, &format, &pretty, &prepend) < 0)
+        goto done;
+    yspec = clicon_dbspec_yang(h);
+    if (clixon_xml_parse_file(stdin, YB_NONE, yspec, &xt, NULL) < 0)
+        goto done;
+    if (pipe_select_entries(xt, leaf, value) < 0)
+        goto done;
+    if (pipe_xml2output(h, xt, format, pretty, prepend) < 0)
+        goto done;
+    retval = 0;
+ done:
     if (xt)
         xml_free(xt);
     return retval;
@@ -67,6 +67,7 @@
 #include "cli_plugin.h"
 #include "cli_handle.h"
 #include "cli_generate.h"
+#include "cli_common.h"
 
 /*
  * Constants
@@ -533,6 +534,9 @@ clicon_parse(clicon_handle  h,
     else
         f = stderr;
     modename = *modenamep;
+    /* Generate parts of autocli tree the command may refer to */
+    if (yang2cli_lazy(h, cmd) < 0)
+        goto done;
     ph = cligen_ph_find(cli_cligen(h), modename);
     if (ph != NULL){
         if (cligen_ph_active_set_byname(ch, modename) < 0){
@@ -563,6 +567,12 @@ clicon_parse(clicon_handle  h,
             cli_output_reset();
             if (!cligen_exiting(ch)) {  
                 clicon_err_reset();
+                /* Send batched edits before other commands, see CLICON_CLI_BATCH_EDITS */
+                if (!cli_batch_callback(match_obj) &&
+                    cli_batch_flush(h) < 0){
+                    cli_handler_err(stdout);
+                    clicon_err_reset();
+                }
                 if ((ret = cligen_eval(ch, match_obj, cvv)) < 0) {
                     cli_handler_err(stdout);
                     if (clicon_suberrno == ESHUTDOWN)
@@ -732,6 +742,9 @@ clicon_cliread(clicon_handle h,
         free(promptstr);
     }
     clicon_err_reset();
+    /* Completion may refer to any part of autocli tree */
+    if (yang2cli_lazy(h, NULL) < 0)
+        goto done;
     if (cliread(cli_cligen(h), stringp) < 0){
         cli_handler_err(stdout);
         if (clicon_suberrno == ESHUTDOWN)
@@ -167,6 +167,158 @@ xpath_append(cbuf      *cb0,
     return retval;
 }
 
+/*
+ * Expansion cache of datastore values, see CLI_EXPAND_CACHE_MAX
+ * Values of a datastore and xpath are kept in the session with the content version of the
+ * datastore, and only read again if the version has changed, eg by a commit or edit.
+ */
+/* Handle data name of expansion cache */
+#define EXPAND_CACHE_NAME "cli-expand-cache"
+
+/*! Cached values of one datastore, xpath and namespace context
+ */
+struct expand_entry {
+    struct expand_entry *ee_next;
+    char                *ee_key;     /* Datastore, xpath and namespace context */
+    uint64_t             ee_version; /* Content version of datastore */
+    cvec                *ee_values;  /* Values as strings */
+};
+
+static void
+expand_entry_free(struct expand_entry *ee)
+{
+    if (ee->ee_key)
+        free(ee->ee_key);
+    if (ee->ee_values)
+        cvec_free(ee->ee_values);
+    free(ee);
+}
+
+/*! Get values of datastore and xpath via the expansion cache
+ *
+ * The version of a cached entry is sent to the backend, which only sends the values if
+ * the datastore has changed. Entries are kept most recently used first.
+ * @param[in]  h       Clixon handle
+ * @param[in]  db      Name of datastore
+ * @param[in]  xpath   XPath of values
+ * @param[in]  nsc     Namespace context of xpath
+ * @param[out] values  Cached values, or NULL on netconf error. Do not free
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+expand_cache_values(clicon_handle h,
+                    char         *db,
+                    char         *xpath,
+                    cvec         *nsc,
+                    cvec        **values)
+{
+    int                   retval = -1;
+    struct expand_entry  *ehead = NULL;
+    struct expand_entry **eep;
+    struct expand_entry  *ee = NULL;
+    cbuf                 *cb = NULL;
+    cg_var               *cv = NULL;
+    cvec                 *cvv = NULL;
+    cxobj                *xerr = NULL;
+    uint64_t              version = 0;
+    int                   n;
+
+    *values = NULL;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s %s", db, xpath);
+    while ((cv = cvec_each(nsc, cv)) != NULL)
+        cprintf(cb, " %s=%s", cv_name_get(cv)?cv_name_get(cv):"", cv_string_get(cv));
+    clicon_ptr_get(h, EXPAND_CACHE_NAME, (void**)&ehead);
+    /* Unlink entry if found, it is put first below */
+    for (eep = &ehead; *eep; eep = &(*eep)->ee_next)
+        if (strcmp((*eep)->ee_key, cbuf_get(cb)) == 0){
+            ee = *eep;
+            *eep = ee->ee_next;
+            ee->ee_next = NULL;
+            version = ee->ee_version;
+            break;
+        }
+    if (clicon_rpc_datastore_values(h, db, xpath, nsc, NULL, &version, &cvv, &xerr) < 0)
+        goto done;
+    if (xerr){
+        clixon_netconf_error(xerr, "Get configuration", NULL);
+        if (ee){
+            expand_entry_free(ee);
+            ee = NULL;
+        }
+        goto ok;
+    }
+    if (ee == NULL){
+        if ((ee = calloc(1, sizeof(*ee))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if ((ee->ee_key = strdup(cbuf_get(cb))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    }
+    if (cvv){ /* Changed */
+        if (ee->ee_values)
+            cvec_free(ee->ee_values);
+        ee->ee_values = cvv;
+        cvv = NULL;
+    }
+    ee->ee_version = version;
+    ee->ee_next = ehead;
+    ehead = ee;
+    *values = ee->ee_values;
+    ee = NULL;
+    /* Remove least recently used entries */
+    for (eep = &ehead, n = 0; *eep; eep = &(*eep)->ee_next)
+        if (++n == CLI_EXPAND_CACHE_MAX){
+            while ((ee = (*eep)->ee_next) != NULL){
+                (*eep)->ee_next = ee->ee_next;
+                expand_entry_free(ee);
+            }
+            break;
+        }
+ ok:
+    retval = 0;
+ done:
+    if (clicon_ptr_set(h, EXPAND_CACHE_NAME, ehead) < 0)
+        retval = -1;
+    if (ee)
+        expand_entry_free(ee);
+    if (cvv)
+        cvec_free(cvv);
+    if (xerr)
+        xml_free(xerr);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Free expansion cache of datastore values
+ *
+ * @param[in]  h  Clixon handle
+ * @retval     0  OK
+ */
+int
+cli_expand_cache_free(clicon_handle h)
+{
+    struct expand_entry *ehead = NULL;
+    struct expand_entry *ee;
+
+    if (clicon_ptr_get(h, EXPAND_CACHE_NAME, (void**)&ehead) < 0)
+        return 0;
+    while ((ee = ehead) != NULL){
+        ehead = ee->ee_next;
+        expand_entry_free(ee);
+    }
+    clicon_ptr_del(h, EXPAND_CACHE_NAME);
+    return 0;
+}
+
 /*! Completion callback intended for automatically generated data model
  *
  * Returns an expand-type list of commands as used by cligen 'expand' 
@@ -183,6 +335,8 @@ xpath_append(cbuf      *cb0,
  * @param[out]  commands vector of function pointers to callback functions
  * @param[out]  helptxt  vector of pointers to helptexts
  * @see cli_expand_var_generate where api_path_fmt + mt-point are generated
+ * @note Only the values are read from the backend, and are cached in the session until the
+ *       datastore is changed, see expand_cache_values
  */
 int
 expand_dbvar(void   *h, 
@@ -198,22 +352,14 @@ expand_dbvar(void   *h,
     char            *api_path = NULL;
     char            *api_path_fmt01 = NULL;
     char            *dbstr;
-    cxobj           *xt = NULL;
     char            *xpath = NULL;
-    cxobj          **xvec = NULL;
-    cxobj           *xe; /* direct ptr */
     cxobj           *xerr = NULL; /* free */
-    size_t           xlen = 0;
-    cxobj           *x;
-    char            *bodystr;
-    int              i;
-    char            *bodystr0 = NULL; /* previous */
     cg_var          *cv;
     cxobj           *xtop = NULL; /* xpath root */
     cxobj           *xbot = NULL; /* xpath, NULL if datastore */
     yang_stmt       *y = NULL; /* yang spec of xpath */
-    yang_stmt       *yp;
     cvec            *nsc = NULL;
+    cvec            *values = NULL;
     int              ret;
     int              cvvi = 0;
     cbuf            *cbxpath = NULL;
@@ -359,51 +505,12 @@ expand_dbvar(void   *h,
         if (xpath_append(cbxpath, yang_argument_get(ypath), y, nsc) < 0)
             goto done;
     }
-    /* Get configuration based on cbxpath */
-    if (clicon_rpc_get_config(h, NULL, dbstr, cbuf_get(cbxpath), nsc, NULL, &xt) < 0) 
+    /* Get values based on cbxpath, duplicates are removed by backend */
+    if (expand_cache_values(h, dbstr, cbuf_get(cbxpath), nsc, &values) < 0)
         goto done;
-    if ((xe = xpath_first(xt, NULL, "/rpc-error")) != NULL){
-        clixon_netconf_error(xe, "Get configuration", NULL);
-        goto ok; 
-    }
-    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, cbuf_get(cbxpath)) < 0) 
-        goto done;
-    /* Loop for inserting into commands cvec. 
-     * Detect duplicates: for ordered-by system assume list is ordered, so you need
-     * just remember previous
-     * but for ordered-by system, check the whole list
-     */
-    bodystr0 = NULL;
-    for (i = 0; i < xlen; i++) {
-        x = xvec[i];
-        if (xml_type(x) == CX_BODY)
-            bodystr = xml_value(x);
-        else
-            bodystr = xml_body(x);
-        if (bodystr == NULL)
-            continue; /* no body, cornercase */
-        if ((y = xml_spec(x)) != NULL &&
-            (yp = yang_parent_get(y)) != NULL &&
-            yang_keyword_get(yp) == Y_LIST &&
-            yang_find(yp, Y_ORDERED_BY, "user") != NULL){
-            /* Detect duplicates linearly in existing values */
-            {
-                cg_var *cv = NULL;
-                while ((cv = cvec_each(commands, cv)) != NULL)
-                    if (strcmp(cv_string_get(cv), bodystr) == 0)
-                        break;
-                if (cv == NULL)
-                    cvec_add_string(commands, NULL, bodystr);
-            }
-        }
-        else{
-            if (bodystr0 && strcmp(bodystr, bodystr0) == 0)
-                continue; /* duplicate, assume sorted */
-            bodystr0 = bodystr;
-            /* RFC3986 decode */
-            cvec_add_string(commands, NULL, bodystr);
-        }
-    }
+    cv = NULL;
+    while ((cv = cvec_each(values, cv)) != NULL)
+        cvec_add_string(commands, NULL, cv_string_get(cv));
  ok:
     retval = 0;
  done:
@@ -421,12 +528,8 @@ expand_dbvar(void   *h,
         xml_nsctx_free(nsc);
     if (api_path)
         free(api_path);
-    if (xvec)
-        free(xvec);
     if (xtop)
         xml_free(xtop);
-    if (xt)
-        xml_free(xt);
     if (xpath) 
         free(xpath);
     return retval;
@@ -462,6 +565,235 @@ show_yang(clicon_handle h,
     return retval;
 }
 
+/*! Strip wd:default=true attribute and (optionally) nodes associated with it
+ *
+ * @param[in] xt          XML tree
+ * @param[in] extdefault  with-defaults with propriatary extensions, or NULL
+ * @retval    0           OK
+ * @retval   -1           Error
+ */
+static int
+cli_show_extdefault(cxobj *xt,
+                    char  *extdefault)
+{
+    int retval = -1;
+
+    /* Special tagged modes: strip wd:default=true attribute and (optionally) nodes associated with it */
+    if (extdefault &&
+        (strcmp(extdefault, "report-all-tagged-strip") == 0 ||
+         strcmp(extdefault, "report-all-tagged-default") == 0)){
+        if (purge_tagged_nodes(xt, IETF_NETCONF_WITH_DEFAULTS_ATTR_NAMESPACE, "default", "true",
+                               strcmp(extdefault, "report-all-tagged-strip")
+                               ) < 0)
+            goto done;  
+        /* Remove empty containers */
+        if (xml_defaults_nopresence(xt, 2) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Make list-pagination cursor of a list or leaf-list entry
+ *
+ * @param[in]  ylist   Yang of list or leaf-list
+ * @param[in]  x       List or leaf-list entry
+ * @param[out] cursor  Comma-separated and percent-encoded keys or value. Free with free
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see list_pagination_cursor  in backend
+ */
+static int
+cli_show_page_cursor(yang_stmt *ylist,
+                     cxobj     *x,
+                     char     **cursor)
+{
+    int     retval = -1;
+    cbuf   *cb = NULL;
+    cg_var *cvk = NULL;
+    char   *enc = NULL;
+    char   *body;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (yang_keyword_get(ylist) == Y_LEAF_LIST){
+        if (uri_percent_encode(&enc, "%s", xml_body(x)?xml_body(x):"") < 0)
+            goto done;
+        cprintf(cb, "%s", enc);
+    }
+    else while ((cvk = cvec_each(yang_cvec_get(ylist), cvk)) != NULL){
+            if ((body = xml_find_body(x, cv_string_get(cvk))) == NULL)
+                body = "";
+            if (uri_percent_encode(&enc, "%s", body) < 0)
+                goto done;
+            cprintf(cb, "%s%s", cbuf_len(cb)?",":"", enc);
+            free(enc);
+            enc = NULL;
+        }
+    if ((*cursor = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (enc)
+        free(enc);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Show a config list or leaf-list page by page, see CLICON_CLI_SHOW_PAGE
+ *
+ * Get and print a page of entries at a time, each page starts after the last entry of
+ * the previous page. Stop when a page is empty or the output is quit.
+ * @param[in] h            Clixon handle
+ * @param[in] db           Datastore
+ * @param[in] format       Output format: xml, text or cli
+ * @param[in] pretty        
+ * @param[in] withdefault  RFC 6243 with-default modes
+ * @param[in] extdefault   with-defaults with propriatary extensions
+ * @param[in] prepend      CLI prefix to prepend cli syntax, eg "set "
+ * @param[in] xpath        XPath
+ * @param[in] nsc          Namespace mapping for xpath
+ * @param[in] skiptop      If set, do not show object itself, only its children
+ * @retval    1            Shown
+ * @retval    0            Not a pageable list, nothing shown
+ * @retval   -1            Error
+ * @see cli_show_common
+ */
+static int
+cli_show_paged(clicon_handle    h,
+               char            *db,
+               enum format_enum format,
+               int              pretty,
+               char            *withdefault,
+               char            *extdefault,
+               char            *prepend,
+               char            *xpath,
+               cvec            *nsc,
+               int              skiptop)
+{
+    int           retval = -1;
+    int           limit;
+    yang_stmt    *yspec;
+    yang_stmt    *ylist = NULL;
+    char         *last;
+    char         *cursor = NULL;
+    cxobj        *xt = NULL;
+    cxobj        *xerr;
+    cxobj       **vec = NULL;
+    size_t        veclen;
+    size_t        n = 0;
+    cxobj        *xp;
+    int           i;
+    char         *xpath1 = NULL;
+    cvec         *nsc1 = NULL;
+    cbuf         *cbreason = NULL;
+    int           ret;
+
+    if ((limit = clicon_option_int(h, "CLICON_CLI_SHOW_PAGE")) <= 0 ||
+        xpath == NULL ||
+        (format != FORMAT_XML && format != FORMAT_TEXT && format != FORMAT_CLI) ||
+        clicon_datastore_cache(h) == DATASTORE_NOCACHE)
+        goto skip;
+    /* Running is read locally from the snapshot, if any */
+    if (strcmp(db, "running") == 0 && clicon_option_bool(h, "CLICON_XMLDB_SNAPSHOT"))
+        goto skip;
+    /* Only simple paths where the last step has no predicate, see xmldb_get_page */
+    if (strpbrk(xpath, "|()*@ ") != NULL ||
+        (last = strrchr(xpath, '/')) == NULL ||
+        strpbrk(last+1, "[]") != NULL ||
+        (last > xpath && *(last-1) == '/'))
+        goto skip;
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_FATAL, 0, "No DB_SPEC");
+        goto done;
+    }
+    /* Yang lookup needs module prefixes */
+    if ((ret = xpath2canonical(xpath, nsc, yspec, &xpath1, &nsc1, &cbreason)) < 0)
+        goto done;
+    if (ret == 0)
+        goto skip;
+    if (yang_path_arg(yspec, xpath1, &ylist) < 0)
+        goto done;
+    if (ylist == NULL ||
+        (yang_keyword_get(ylist) != Y_LIST && yang_keyword_get(ylist) != Y_LEAF_LIST) ||
+        yang_config_ancestor(ylist) == 0)
+        goto skip;
+    do {
+        if (clicon_rpc_get_config_page(h, db, xpath, nsc, withdefault, cursor, limit, &xt) < 0)
+            goto done;
+        if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
+            clixon_netconf_error(xerr, "Get configuration", NULL);
+            goto done;
+        }
+        if (cli_show_extdefault(xt, extdefault) < 0)
+            goto done;
+        if (xpath_vec(xt, nsc, "%s", &vec, &veclen, xpath) < 0) 
+            goto done;
+        for (i=0; i<veclen; i++){
+            xp = vec[i];
+            switch (format){
+            case FORMAT_XML:
+                if (clixon_xml2file(stdout, xp, 0, pretty, NULL, cligen_output, skiptop, 1) < 0)
+                    goto done;
+                break;
+            case FORMAT_TEXT:
+                if (clixon_text2file(stdout, xp, 0, cligen_output, skiptop, 1) < 0)
+                    goto done;
+                break;
+            case FORMAT_CLI:
+                if (clixon_cli2file(h, stdout, xp, prepend, cligen_output, skiptop) < 0)
+                    goto done;
+                break;
+            default:
+                break;
+            }
+            n++;
+            if (cli_output_status() < 0)
+                break;
+        }
+        if (cli_output_status() < 0)
+            break;
+        /* Entries removed by NACM are not in vec, so only an empty page is the end */
+        if (veclen){
+            if (cursor)
+                free(cursor);
+            cursor = NULL;
+            if (cli_show_page_cursor(ylist, vec[veclen-1], &cursor) < 0)
+                goto done;
+        }
+        free(vec);
+        vec = NULL;
+        xml_free(xt);
+        xt = NULL;
+    } while (veclen);
+    if (format == FORMAT_XML && !pretty && n)
+        cligen_output(stdout, "\n");
+    retval = 1;
+ done:
+    if (xpath1)
+        free(xpath1);
+    if (nsc1)
+        xml_nsctx_free(nsc1);
+    if (cbreason)
+        cbuf_free(cbreason);
+    if (cursor)
+        free(cursor);
+    if (vec)
+        free(vec);
+    if (xt)
+        xml_free(xt);
+    return retval;
+ skip:
+    retval = 0;
+    goto done;
+}
+
 /*! Common internal show routine for several show cli callbacks
  *
  * @param[in] h            Clixon handle
@@ -499,11 +831,20 @@ cli_show_common(clicon_handle    h,
     size_t        veclen;
     cxobj        *xp;
     int           i;
+    int           ret;
 
     if (state && strcmp(db, "running") != 0){
         clicon_err(OE_FATAL, 0, "Show state only for running database, not %s", db);
         goto done;
     }
+    /* Config lists are shown page by page */
+    if (state == 0 && !fromroot){
+        if ((ret = cli_show_paged(h, db, format, pretty, withdefault, extdefault, prepend,
+                                  xpath, nsc, skiptop)) < 0)
+            goto done;
+        if (ret == 1)
+            goto ok;
+    }
     if (state == 0){     /* Get configuration-only from a database */
         if (clicon_rpc_get_config(h, NULL, db, xpath, nsc, withdefault, &xt) < 0)
             goto done;
@@ -516,18 +857,8 @@ cli_show_common(clicon_handle    h,
         clixon_netconf_error(xerr, "Get configuration", NULL);
         goto done;
     }
-    /* Special tagged modes: strip wd:default=true attribute and (optionally) nodes associated with it */
-    if (extdefault &&
-        (strcmp(extdefault, "report-all-tagged-strip") == 0 ||
-         strcmp(extdefault, "report-all-tagged-default") == 0)){
-        if (purge_tagged_nodes(xt, IETF_NETCONF_WITH_DEFAULTS_ATTR_NAMESPACE, "default", "true",
-                               strcmp(extdefault, "report-all-tagged-strip")
-                               ) < 0)
-            goto done;  
-        /* Remove empty containers */
-        if (xml_defaults_nopresence(xt, 2) < 0)
-            goto done;
-    }
+    if (cli_show_extdefault(xt, extdefault) < 0)
+        goto done;
     if (fromroot)
         xpath="/";
     if (xpath_vec(xt, nsc, "%s", &vec, &veclen, xpath) < 0) 
@@ -583,6 +914,7 @@ cli_show_common(clicon_handle    h,
     }
     else if (format == FORMAT_JSON)
         cligen_output(stdout, "{}\n");
+ ok:
     retval = 0;
 done:
     if (vec)
@@ -1677,6 +2009,11 @@ clixon_cli2cbuf(clicon_handle     h,
 }
 
 /*! CLI callback show statistics
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  cvv   Vector of command variables
+ * @param[in]  argv  Optional: "modules" for per-module statistics, or "memory" for backend
+ *                   memory per subsystem only
  */
 int
 cli_show_statistics(clicon_handle h, 
@@ -1689,27 +2026,31 @@ cli_show_statistics(clicon_handle h,
     cxobj      *xerr;
     cg_var     *cv;
     int         modules = 0;
+    int         memory = 0;
+    cxobj      *xm;
     pt_head    *ph;
     parse_tree *pt;
     uint64_t    nr = 0;
     size_t      sz = 0;
     
     if (argv != NULL && cvec_len(argv) != 1){
-        clicon_err(OE_PLUGIN, EINVAL, "Expected arguments: [modules]");
+        clicon_err(OE_PLUGIN, EINVAL, "Expected arguments: [modules|memory]");
         goto done;
     }
     if (argv){
         cv = cvec_i(argv, 0);
         modules = (strcmp(cv_string_get(cv), "modules") == 0);
+        memory = (strcmp(cv_string_get(cv), "memory") == 0);
     }
     if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_PLUGIN, errno, "cbuf_new");
         goto done;
     }
     /* CLI */
-    cligen_output(stdout, "CLI:\n");
+    if (!memory)
+        cligen_output(stdout, "CLI:\n");
     ph = NULL;
-    while ((ph = cligen_ph_each(cli_cligen(h), ph)) != NULL) {
+    while (!memory && (ph = cligen_ph_each(cli_cligen(h), ph)) != NULL) {
         if ((pt = cligen_ph_parsetree_get(ph)) == NULL)
             continue;
         nr = 0; sz = 0;
@@ -1732,10 +2073,17 @@ cli_show_statistics(clicon_handle h,
         clixon_netconf_error(xerr, "Get configuration", NULL);
         goto done;
     }
+    if (memory){
+        if ((xm = xpath_first(xret, NULL, "rpc-reply/memory")) != NULL &&
+            clixon_xml2file(stdout, xm, 0, 1, NULL, cligen_output, 0, 1) < 0)
+            goto done;
+        goto ok;
+    }
     fprintf(stdout, "Backend:\n");
     if (clixon_xml2file(stdout, xml_child_i(xret, 0), 0, 1, NULL, cligen_output, 0, 1) < 0)
         goto done;
     fprintf(stdout, "CLI:\n");
+ ok:
     retval = 0;
  done:
     if (xret)
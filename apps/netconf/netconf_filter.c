@@ -210,3 +210,211 @@ xml_filter(cxobj *xfilter,
     return retval;
 }
 
+
+/*! Get prefix of namespace in xpath namespace context, add a new prefix if not found
+ *
+ * @param[in]  xfilter  Filter, new prefixes must not be used by it
+ * @param[in]  nsc      Namespace context of xpath
+ * @param[in]  ns       Namespace
+ * @param[out] prefix   Prefix, direct pointer into nsc
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+xml_filter_prefix(cxobj *xfilter,
+                  cvec  *nsc,
+                  char  *ns,
+                  char **prefix)
+{
+    int   retval = -1;
+    char  pf[16];
+    char *ns1;
+    int   i;
+
+    if (xml_nsctx_get_prefix(nsc, ns, prefix) == 1)
+        goto ok;
+    for (i=cvec_len(nsc);;i++){
+        snprintf(pf, sizeof(pf), "sf%d", i);
+        if (xml_nsctx_get(nsc, pf) != NULL)
+            continue;
+        if (xml2ns(xfilter, pf, &ns1) < 0)
+            goto done;
+        if (ns1 == NULL || strcmp(ns1, ns) == 0)
+            break;
+    }
+    if (xml_nsctx_add(nsc, pf, ns) < 0)
+        goto done;
+    if (xml_nsctx_get_prefix(nsc, ns, prefix) != 1){
+        clicon_err(OE_XML, EFAULT, "Prefix %s not found", pf);
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Append xpath name of filter node, eg sf0:name
+ *
+ * @retval     1        OK
+ * @retval     0        Node has no namespace known by yang
+ * @retval    -1        Error
+ */
+static int
+xml_filter2xpath_step(cxobj     *xfilter,
+                      cxobj     *f,
+                      yang_stmt *yspec,
+                      cbuf      *cb,
+                      cvec      *nsc)
+{
+    int   retval = -1;
+    char *ns = NULL;
+    char *prefix;
+
+    if (xml2ns(f, xml_prefix(f), &ns) < 0)
+        goto done;
+    if (ns == NULL || yang_find_module_by_namespace(yspec, ns) == NULL)
+        goto fail;
+    if (xml_filter_prefix(xfilter, nsc, ns, &prefix) < 0)
+        goto done;
+    cprintf(cb, "%s:%s", prefix, xml_name(f));
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Translate a filter node to xpath, recursive part
+ *
+ * @retval     1        OK
+ * @retval     0        Filter cannot be translated
+ * @retval    -1        Error
+ * @see xml_filter2xpath
+ */
+static int
+xml_filter2xpath_recursive(cxobj     *xfilter,
+                           cxobj     *f,
+                           yang_stmt *yspec,
+                           cbuf      *cbpath,
+                           cbuf      *cbxpath,
+                           cvec      *nsc)
+{
+    int    retval = -1;
+    size_t len0;
+    cxobj *c;
+    cxobj *xa;
+    char  *str;
+    int    contents = 0;
+    char   q;
+    int    ret;
+
+    /* Attribute match is not translated */
+    xa = NULL;
+    while ((xa = xml_child_each(f, xa, CX_ATTR)) != NULL){
+        if (strcmp(xml_name(xa), "xmlns") != 0 &&
+            (xml_prefix(xa) == NULL || strcmp(xml_prefix(xa), "xmlns") != 0))
+            goto fail;
+    }
+    len0 = cbuf_len(cbpath);
+    cprintf(cbpath, "/");
+    if ((ret = xml_filter2xpath_step(xfilter, f, yspec, cbpath, nsc)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* Content match nodes are predicates, the whole node is selected */
+    c = NULL;
+    while ((c = xml_child_each(f, c, CX_ELMNT)) != NULL) {
+        if ((str = leafstring(c)) == NULL)
+            continue;
+        if (strchr(str, '\'') == NULL)
+            q = '\'';
+        else if (strchr(str, '"') == NULL)
+            q = '"';
+        else
+            goto fail;
+        cprintf(cbpath, "[");
+        if ((ret = xml_filter2xpath_step(xfilter, c, yspec, cbpath, nsc)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        cprintf(cbpath, "=%c%s%c]", q, str, q);
+        contents++;
+    }
+    if (contents || xml_child_nr_type(f, CX_ELMNT) == 0){
+        if (cbuf_len(cbxpath))
+            cprintf(cbxpath, " | ");
+        cbuf_append_str(cbxpath, cbuf_get(cbpath));
+    }
+    /* Pure containment node: only its containment and selection nodes are selected */
+    else {
+        c = NULL;
+        while ((c = xml_child_each(f, c, CX_ELMNT)) != NULL) {
+            if ((ret = xml_filter2xpath_recursive(xfilter, c, yspec, cbpath, cbxpath, nsc)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+    }
+    cbuf_trunc(cbpath, len0);
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Translate subtree filter to an xpath selecting a superset of what the filter selects
+ *
+ * A containment node is a location step, a node with content match nodes selects the whole
+ * node with the content match nodes as predicates, eg:
+ *   <x xmlns="urn:example:filter"><y><a>1</a></y></x>  -> /sf0:x/sf0:y[sf0:a='1']
+ * This makes the backend read, send and the frontend parse only the selected data, which
+ * is then filtered exactly by xml_filter.
+ * @param[in]  xfilter  Subtree filter, ie <filter>
+ * @param[in]  yspec    Yang spec
+ * @param[out] cbxpath  XPath
+ * @param[out] nsc      Namespace context of xpath
+ * @retval     1        OK, xpath and nsc set
+ * @retval     0        Filter cannot be translated, eg no namespace, attribute or top-level content match
+ * @retval    -1        Error
+ * @see xml_filter
+ */
+int
+xml_filter2xpath(cxobj     *xfilter,
+                 yang_stmt *yspec,
+                 cbuf      *cbxpath,
+                 cvec      *nsc)
+{
+    int    retval = -1;
+    cbuf  *cbpath = NULL;
+    cxobj *f;
+    int    ret;
+
+    if (xml_child_nr_type(xfilter, CX_ELMNT) == 0)
+        goto fail;
+    if ((cbpath = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    f = NULL;
+    while ((f = xml_child_each(xfilter, f, CX_ELMNT)) != NULL) {
+        /* Top-level content match selects all top-level siblings */
+        if (leafstring(f))
+            goto fail;
+        if ((ret = xml_filter2xpath_recursive(xfilter, f, yspec, cbpath, cbxpath, nsc)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    retval = 1;
+ done:
+    if (cbpath)
+        cbuf_free(cbpath);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
@@ -43,5 +43,6 @@
  * Prototypes
  */ 
 int xml_filter(cxobj *xf, cxobj *xn);
+int xml_filter2xpath(cxobj *xfilter, yang_stmt *yspec, cbuf *cbxpath, cvec *nsc);
 
 #endif  /* _NETCONF_FILTER_H_ */
@@ -68,9 +68,10 @@
 
 //#include "clixon_netconf.h"
 #include "netconf_rpc.h"
+#include "netconf_zygote.h"
 
 /* Command line options to be passed to getopt(3) */
-#define NETCONF_OPTS "hD:f:E:l:C:q01ca:u:d:p:y:U:t:eo:"
+#define NETCONF_OPTS "hD:f:E:l:C:q01ca:u:d:p:y:U:t:eo:Z:z:"
 
 #define NETCONF_LOGFILE "/tmp/clixon_netconf.log"
 
@@ -223,7 +224,7 @@ netconf_rpc_message(clicon_handle h,
         /* Copy attributes from incoming request to reply. Skip already present (dont overwrite) */
         if (netconf_add_request_attr(xrpc, xret) < 0)
             goto done;
-        if ((cbret = cbuf_new()) == NULL){ 
+        if ((cbret = clixon_cbuf_get()) == NULL){ 
             clicon_err(OE_XML, errno, "cbuf_new");
             goto done;
         }
@@ -244,7 +245,7 @@ netconf_rpc_message(clicon_handle h,
     if (ret == 0){
         if (netconf_add_request_attr(xrpc, xret) < 0)
             goto done;
-        if ((cbret = cbuf_new()) == NULL){ 
+        if ((cbret = clixon_cbuf_get()) == NULL){ 
             clicon_err(OE_XML, errno, "cbuf_new");
             goto done;
         }
@@ -265,7 +266,7 @@ netconf_rpc_message(clicon_handle h,
             goto done;
         if (netconf_add_request_attr(xrpc, xret) < 0)
             goto done;
-        if ((cbret = cbuf_new()) == NULL){ 
+        if ((cbret = clixon_cbuf_get()) == NULL){ 
             clicon_err(OE_XML, errno, "cbuf_new");
             goto done;
         }
@@ -281,7 +282,7 @@ netconf_rpc_message(clicon_handle h,
         /* Copy attributes from incoming request to reply. Skip already present (dont overwrite) */
         if (netconf_add_request_attr(xrpc, xc) < 0)
             goto done;
-        if ((cbret = cbuf_new()) == NULL){ 
+        if ((cbret = clixon_cbuf_get()) == NULL){ 
             clicon_err(OE_XML, errno, "cbuf_new");
             goto done;
         }
@@ -296,7 +297,7 @@ netconf_rpc_message(clicon_handle h,
     retval = 0;
  done:
     if (cbret)
-        cbuf_free(cbret);
+        clixon_cbuf_put(cbret);
     if (xret)
         xml_free(xret);
     return retval;
@@ -339,7 +340,7 @@ netconf_input_packet(clicon_handle h,
                 goto done;
             if (netconf_add_request_attr(xreq, xret) < 0)
                 goto done;
-            if ((cbret = cbuf_new()) == NULL){ 
+            if ((cbret = clixon_cbuf_get()) == NULL){ 
                 clicon_err(OE_XML, errno, "cbuf_new");
                 goto done;
             }
@@ -376,7 +377,7 @@ netconf_input_packet(clicon_handle h,
     if (xret)
         xml_free(xret);
     if (cbret)
-        cbuf_free(cbret);
+        clixon_cbuf_put(cbret);
     return retval;
 }
 
@@ -469,7 +470,7 @@ netconf_input_cb(int   s,
             goto done;
         cbuf_reset(cbmsg);
         if (ret == 0){ /* Invalid frame, parse error, etc */
-            if ((cberr = cbuf_new()) == NULL){
+            if ((cberr = clixon_cbuf_get()) == NULL){
                 clicon_err(OE_XML, errno, "cbuf_new");
                 goto done;
             }
@@ -508,12 +509,14 @@ netconf_input_cb(int   s,
         clicon_data_int_set(h, NETCONF_FRAME_STATE, frame_state);
         clicon_data_int_set(h, NETCONF_FRAME_SIZE, frame_size);
     }
+    /* Free pooled objects beyond what the requests since the last trim needed */
+    clixon_pool_trim();
     retval = 0;
  done:
     if (cbmsg)
         cbuf_free(cbmsg);
     if (cberr)
-        cbuf_free(cberr);
+        clixon_cbuf_put(cberr);
     if (xtop)
         xml_free(xtop);
     if (xerr)
@@ -534,7 +537,7 @@ send_hello(clicon_handle h,
     cbuf *cb;
     netconf_framing_type framing;
 
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_log(LOG_ERR, "%s: cbuf_new", __FUNCTION__);
         goto done;
     }
@@ -548,7 +551,7 @@ send_hello(clicon_handle h,
     retval = 0;
   done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     return retval;
 }
 
@@ -577,8 +580,14 @@ netconf_terminate(clicon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xmldb_snapshot_exit(h);
+    xpath_cache_exit();
+    api_path_cache_exit();
+    xml_nsid_exit();
+    nacm_ruleset_free(h);
     clixon_event_exit();
     clicon_handle_exit(h);
+    clixon_pool_exit();
     clixon_err_exit();
     clicon_log_exit();
     return 0;
@@ -636,7 +645,9 @@ usage(clicon_handle h,
             "\t-U <user>\tOver-ride unix user with a pseudo user for NACM.\n"
             "\t-t <sec>\tTimeout in seconds. Quit after this time.\n"
             "\t-e \t\tDont ignore errors on packet input.\n"
-            "\t-o \"<option>=<value>\"\tGive configuration option overriding config file (see clixon-config.yang)\n",
+            "\t-o \"<option>=<value>\"\tGive configuration option overriding config file (see clixon-config.yang)\n"
+            "\t-Z <path>\tPrewarmed: load config, yang and plugins, then fork a session for each handoff on unix socket path\n"
+            "\t-z <path>\tHand off this session (stdin/stdout) to prewarmed netconf on unix socket path\n",
             argv0,
             clicon_netconf_dir(h)
             );
@@ -665,7 +676,11 @@ main(int    argc,
     int              dbg = 0;
     size_t           sz;
     int              config_dump = 0;
+    int              cached;
     enum format_enum config_dump_format = FORMAT_XML;
+    char            *zygote = NULL;
+    char            *zygote_connect = NULL;
+    int              ret;
     
     /* Create handle */
     if ((h = clicon_handle_init()) == NULL)
@@ -707,6 +722,11 @@ main(int    argc,
                 clicon_log_file(optarg+1) < 0)
                 goto done;
              break;
+        case 'z': /* Hand off session to prewarmed netconf */
+            if (!strlen(optarg))
+                usage(h, argv[0]);
+            zygote_connect = optarg;
+            break;
         }
 
     /* 
@@ -714,6 +734,12 @@ main(int    argc,
      */
     clicon_log_init(__PROGRAM__, dbg?LOG_DEBUG:LOG_INFO, logdst); 
     clicon_debug_init(dbg, NULL); 
+    /* Session helper, no config, yang or plugins loaded */
+    if (zygote_connect){
+        if (netconf_zygote_connect(zygote_connect) < 0)
+            return -1;
+        return 0;
+    }
     yang_init(h);
     
     /* Find, read and parse configfile */
@@ -730,6 +756,7 @@ main(int    argc,
         case 'f':  /* config file */
         case 'E': /* extra config dir */
         case 'l':  /* log  */
+        case 'z':  /* session helper */
             break; /* see above */
         case 'C': /* Explicitly dump configuration */
             if ((config_dump_format = format_str2int(optarg)) ==  (enum format_enum)-1){
@@ -783,6 +810,11 @@ main(int    argc,
             clicon_option_int_set(h, "CLICON_NETCONF_BASE_CAPABILITY", 1);
             clicon_option_bool_set(h, "CLICON_NETCONF_HELLO_OPTIONAL", 1);
             break;
+        case 'Z': /* Prewarmed netconf */
+            if (!strlen(optarg))
+                usage(h, argv[0]);
+            zygote = optarg;
+            break;
         case 'o':{ /* Configuration option */
             char          *val;
             if ((val = index(optarg, '=')) == NULL)
@@ -839,6 +871,9 @@ main(int    argc,
         clixon_plugins_load(h, CLIXON_PLUGIN_INIT, dir, NULL) < 0)
         goto done;
     
+    /* Load yang spec from cache if valid, then the modules below are already loaded */
+    if ((cached = yang_spec_cache_load(h, "netconf", yspec)) < 0)
+        goto done;
     /* Load Yang modules
      * 1. Load a yang module as a specific absolute filename */
     if ((str = clicon_yang_main_file(h)) != NULL){
@@ -865,6 +900,9 @@ main(int    argc,
     /* Add netconf yang spec, used by netconf client and as internal protocol */
     if (netconf_module_load(h) < 0)
         goto done;
+    if (cached == 0 &&
+        yang_spec_cache_save(h, "netconf", yspec) < 0)
+        goto done;
     /* Here all modules are loaded 
      * Compute and set canonical namespace context
      */
@@ -886,6 +924,14 @@ main(int    argc,
     /* Debug dump of config options */
     clicon_option_dump(h, 1);
 
+    /* Prewarmed: wait for sessions, only forked session children continue here */
+    if (zygote){
+        if ((ret = netconf_zygote_serve(h, zygote)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+
     /* Send hello request to backend to get session-id back
      * This is done once at the beginning of the session and then this is
      * used by the client, even though new TCP sessions are created for
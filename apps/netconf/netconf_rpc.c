@@ -106,6 +106,63 @@ ok:
     return retval;
 }
 
+/*! Replace subtree filter of request with an xpath filter evaluated by the backend
+ *
+ * The xpath selects a superset of the subtree filter, the reply is then filtered with the
+ * original subtree filter
+ * @param[in]  h        Clicon handle
+ * @param[in]  xfilter  Subtree filter of request, changed to xpath filter if translated
+ * @param[out] xfsub    Copy of subtree filter if translated, free with xml_free
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see xml_filter2xpath
+ */
+static int
+netconf_filter_subtree2xpath(clicon_handle h,
+                             cxobj        *xfilter,
+                             cxobj       **xfsub)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    cvec  *nsc = NULL;
+    cxobj *x;
+    int    ret;
+
+    if ((cb = clixon_cbuf_get()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((nsc = xml_nsctx_init(NULL, NULL)) == NULL)
+        goto done;
+    if ((ret = xml_filter2xpath(xfilter, clicon_dbspec_yang(h), cb, nsc)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
+    clicon_debug(1, "%s %s", __FUNCTION__, cbuf_get(cb));
+    if ((*xfsub = xml_dup(xfilter)) == NULL)
+        goto done;
+    while ((x = xml_child_each(xfilter, NULL, CX_ELMNT)) != NULL)
+        xml_purge(x);
+    if ((x = xml_find_type(xfilter, NULL, "type", CX_ATTR)) != NULL){
+        if (xml_value_set(x, "xpath") < 0)
+            goto done;
+    }
+    else if (xml_add_attr(xfilter, "type", "xpath", NULL, NULL) < 0)
+        goto done;
+    if (xml_add_attr(xfilter, "select", cbuf_get(cb), NULL, NULL) < 0)
+        goto done;
+    if (xmlns_set_all(xfilter, nsc) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        clixon_cbuf_put(cb);
+    if (nsc)
+        cvec_free(nsc);
+    return retval;
+}
+
 /*! Get configuration
  * @param[in]  h       Clicon handle
  * @param[in]  xn      Sub-tree (under xorig) at <rpc>...</rpc> level.
@@ -164,6 +221,7 @@ netconf_get_config(clicon_handle h,
      char      *ftype = NULL;
      cvec      *nsc = NULL;
      char      *prefix = NULL;
+     cxobj     *xfsub = NULL;
 
      if(xml_nsctx_node(xn, &nsc) < 0)
          goto done;
@@ -177,12 +235,12 @@ netconf_get_config(clicon_handle h,
     if ((xfilter = xpath_first(xn, nsc, "%s%sfilter", prefix ? prefix : "", prefix ? ":" : "")) != NULL)
         ftype = xml_find_value(xfilter, "type");
     if (xfilter == NULL || ftype == NULL || strcmp(ftype, "subtree") == 0) {
-        /* Get whole config first, then filter. This is suboptimal
-         */
+        /* Get config selected by an equivalent xpath if possible, then filter */
+        if (xfilter && netconf_filter_subtree2xpath(h, xfilter, &xfsub) < 0)
+            goto done;
         if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
             goto done;
-        /* Now filter on whole tree */
-        if (netconf_get_config_subtree(h, xfilter, xret) < 0)
+        if (netconf_get_config_subtree(h, xfsub?xfsub:xfilter, xret) < 0)
             goto done;
     } else if (strcmp(ftype, "xpath") == 0) {
         if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0) {
@@ -202,6 +260,8 @@ netconf_get_config(clicon_handle h,
  done:
     if (nsc)
         cvec_free(nsc);
+    if (xfsub)
+        xml_free(xfsub);
     return retval;
 }
 
@@ -373,6 +433,7 @@ netconf_get(clicon_handle h,
      char      *ftype = NULL;
      cvec      *nsc = NULL;
      char      *prefix = NULL;
+     cxobj     *xfsub = NULL;
 
      if(xml_nsctx_node(xn, &nsc) < 0)
          goto done;
@@ -386,12 +447,12 @@ netconf_get(clicon_handle h,
     if ((xfilter = xpath_first(xn, nsc, "%s%sfilter", prefix ? prefix : "", prefix ? ":" : "")) != NULL)
         ftype = xml_find_value(xfilter, "type");
     if (xfilter == NULL || ftype == NULL || strcmp(ftype, "subtree") == 0) {
-        /* Get whole config + state first, then filter. This is suboptimal
-         */
+        /* Get config + state selected by an equivalent xpath if possible, then filter */
+        if (xfilter && netconf_filter_subtree2xpath(h, xfilter, &xfsub) < 0)
+            goto done;
         if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
             goto done;
-        /* Now filter on whole tree */
-        if (netconf_get_config_subtree(h, xfilter, xret) < 0)
+        if (netconf_get_config_subtree(h, xfsub?xfsub:xfilter, xret) < 0)
             goto done;
     } else if (strcmp(ftype, "xpath") == 0) {
         if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
@@ -410,6 +471,8 @@ netconf_get(clicon_handle h,
  done:
     if(nsc)
         cvec_free(nsc); 
+    if (xfsub)
+        xml_free(xfsub);
     return retval;
 }
 
@@ -475,7 +538,7 @@ netconf_notification_cb(int   s,
     if ((xn = xpath_first(xt, nsc, "notification")) == NULL)
         goto ok;
     /* create netconf message */
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_PLUGIN, errno, "cbuf_new");
         goto done;
     }
@@ -498,7 +561,7 @@ netconf_notification_cb(int   s,
  done:
     clicon_debug(1, "%s %d", __FUNCTION__, retval);
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (nsc)
         xml_nsctx_free(nsc);
     if (xt != NULL)
@@ -595,11 +658,11 @@ netconf_application_rpc(clicon_handle h,
     int            nr = 0;
     
     /* First check system / netconf RPC:s */
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_UNIX, 0, "cbuf_new");
         goto done;
     }
-    if ((cbret = cbuf_new()) == NULL){
+    if ((cbret = clixon_cbuf_get()) == NULL){
         clicon_err(OE_UNIX, 0, "cbuf_new");
         goto done;
     }
@@ -672,9 +735,9 @@ netconf_application_rpc(clicon_handle h,
     if (xerr)
         xml_free(xerr);
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (cbret)
-        cbuf_free(cbret);
+        clixon_cbuf_put(cbret);
     return retval;
 }
 
@@ -745,8 +808,9 @@ netconf_rpc_dispatch(clicon_handle h,
             if (clicon_rpc_netconf_xml(h, xml_parent(xe), xret, NULL) < 0)
                 goto done;      
         }
-        /* RFC 5277 :notification */
-        else if (strcmp(xml_name(xe), "create-subscription") == 0){
+        /* RFC 5277 :notification, and clixon-lib on-change datastore push */
+        else if (strcmp(xml_name(xe), "create-subscription") == 0 ||
+                 strcmp(xml_name(xe), "datastore-push") == 0){
             if (netconf_create_subscription(h, xe, xret) < 0)
                 goto done;
         }
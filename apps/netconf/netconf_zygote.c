@@ -0,0 +1,470 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+  ***** END LICENSE BLOCK *****
+
+ *
+ *  Prewarmed netconf: a resident netconf process that has loaded config, yang and plugins
+ *  accepts sessions on a unix socket and forks one child per session.
+ *  A session is handed off by a small helper (clixon_netconf -z <path>), eg run by sshd as
+ *  netconf subsystem, which passes its stdin and stdout over the socket.
+ *
+ *  sshd ---stdin/out--- clixon_netconf -z <path>
+ *                            |  SCM_RIGHTS
+ *                       clixon_netconf -Z <path>  (zygote)
+ *                            |  fork
+ *                       session child: stdin/out of the helper, hello to backend
+ *
+ *  The child keeps the socket of the helper open until it exits, the helper blocks
+ *  reading it and exits when the session terminates.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <syslog.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#define __USE_GNU   /* for ucred */
+#define _GNU_SOURCE /* for ucred */
+#include <sys/socket.h>
+#ifdef HAVE_LOCAL_PEERCRED
+#include <sys/ucred.h>
+#endif
+#include <sys/un.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+#include "netconf_zygote.h"
+
+/* Number of fds handed off per session: stdin and stdout */
+#define NETCONF_ZYGOTE_NFDS 2
+
+/*! Set when zygote should terminate, eg on SIGTERM */
+static int _zygote_exit = 0;
+
+/*! Zygote termination signal handler
+ */
+static void
+netconf_zygote_sig_term(int arg)
+{
+    _zygote_exit++;
+}
+
+/*! Send session fds on unix socket
+ *
+ * @param[in]  s    Unix socket
+ * @param[in]  fds  Vector of NETCONF_ZYGOTE_NFDS file descriptors
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+netconf_zygote_send_fds(int  s,
+                        int *fds)
+{
+    int             retval = -1;
+    struct msghdr   msg = {0,};
+    struct cmsghdr *cmsg;
+    struct iovec    iov;
+    char            ch = 0;
+    char            buf[CMSG_SPACE(NETCONF_ZYGOTE_NFDS*sizeof(int))];
+
+    memset(buf, 0, sizeof(buf));
+    /* At least one byte of data is needed on a stream socket */
+    iov.iov_base = &ch;
+    iov.iov_len = 1;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = buf;
+    msg.msg_controllen = sizeof(buf);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(NETCONF_ZYGOTE_NFDS*sizeof(int));
+    memcpy(CMSG_DATA(cmsg), fds, NETCONF_ZYGOTE_NFDS*sizeof(int));
+    if (sendmsg(s, &msg, 0) < 0){
+        clicon_err(OE_UNIX, errno, "sendmsg");
+        goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Receive session fds on unix socket
+ *
+ * @param[in]  s    Unix socket
+ * @param[out] fds  Vector of NETCONF_ZYGOTE_NFDS file descriptors
+ * @retval     1    OK
+ * @retval     0    No or invalid fds received
+ * @retval    -1    Error
+ */
+static int
+netconf_zygote_recv_fds(int  s,
+                        int *fds)
+{
+    int             retval = -1;
+    struct msghdr   msg = {0,};
+    struct cmsghdr *cmsg;
+    struct iovec    iov;
+    char            ch;
+    char            buf[CMSG_SPACE(NETCONF_ZYGOTE_NFDS*sizeof(int))];
+    ssize_t         len;
+
+    iov.iov_base = &ch;
+    iov.iov_len = 1;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = buf;
+    msg.msg_controllen = sizeof(buf);
+    if ((len = recvmsg(s, &msg, 0)) < 0){
+        clicon_err(OE_UNIX, errno, "recvmsg");
+        goto done;
+    }
+    if (len == 0 || (msg.msg_flags & MSG_CTRUNC))
+        goto fail;
+    if ((cmsg = CMSG_FIRSTHDR(&msg)) == NULL ||
+        cmsg->cmsg_level != SOL_SOCKET ||
+        cmsg->cmsg_type != SCM_RIGHTS ||
+        cmsg->cmsg_len != CMSG_LEN(NETCONF_ZYGOTE_NFDS*sizeof(int)))
+        goto fail;
+    memcpy(fds, CMSG_DATA(cmsg), NETCONF_ZYGOTE_NFDS*sizeof(int));
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get user name of the peer of a unix socket
+ *
+ * @param[in]  s     Unix socket
+ * @param[out] name  User name, malloced, free with free()
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+netconf_zygote_peer(int    s,
+                    char **name)
+{
+    int          retval = -1;
+#if defined(HAVE_SO_PEERCRED)
+    socklen_t    clen;
+    struct ucred cr = {0,};
+
+    clen = sizeof(cr);
+    if (getsockopt(s, SOL_SOCKET, SO_PEERCRED, &cr, &clen) < 0){
+        clicon_err(OE_UNIX, errno, "getsockopt");
+        goto done;
+    }
+    if (uid2name(cr.uid, name) < 0)
+        goto done;
+#elif defined(HAVE_GETPEEREID)
+    uid_t        euid;
+    gid_t        egid;
+
+    if (getpeereid(s, &euid, &egid) < 0){
+        clicon_err(OE_UNIX, errno, "getpeereid");
+        goto done;
+    }
+    if (uid2name(euid, name) < 0)
+        goto done;
+#else
+#error "Need getsockopt O_PEERCRED or getpeereid for unix socket peer cred"
+#endif
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Open zygote unix socket, accessible by the clixon socket group
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  sockpath  Unix socket path
+ * @retval     s         Socket
+ * @retval    -1         Error
+ */
+static int
+netconf_zygote_socket(clicon_handle h,
+                      char         *sockpath)
+{
+    int                s = -1;
+    struct sockaddr_un addr;
+    struct stat        st;
+    mode_t             old_mask;
+    char              *group;
+    gid_t              gid;
+
+    if (strlen(sockpath) >= sizeof(addr.sun_path)){
+        clicon_err(OE_UNIX, ENAMETOOLONG, "%s", sockpath);
+        goto err;
+    }
+    if (lstat(sockpath, &st) == 0 && unlink(sockpath) < 0){
+        clicon_err(OE_UNIX, errno, "unlink(%s)", sockpath);
+        goto err;
+    }
+    if ((group = clicon_sock_group(h)) == NULL){
+        clicon_err(OE_FATAL, 0, "CLICON_SOCK_GROUP option not set");
+        goto err;
+    }
+    if (group_name2gid(group, &gid) < 0)
+        goto err;
+    if ((s = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        clicon_err(OE_UNIX, errno, "socket");
+        goto err;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sockpath, sizeof(addr.sun_path)-1);
+    old_mask = umask(S_IRWXO | S_IXGRP | S_IXUSR);
+    if (bind(s, (struct sockaddr *)&addr, SUN_LEN(&addr)) < 0){
+        clicon_err(OE_UNIX, errno, "bind(%s)", sockpath);
+        umask(old_mask);
+        goto err;
+    }
+    umask(old_mask);
+    if (lchown(sockpath, -1, gid) < 0){
+        clicon_err(OE_UNIX, errno, "lchown(%s, %s)", sockpath, group);
+        goto err;
+    }
+    if (listen(s, 16) < 0){
+        clicon_err(OE_UNIX, errno, "listen");
+        goto err;
+    }
+    return s;
+ err:
+    if (s != -1)
+        close(s);
+    return -1;
+}
+
+/*! Set up the netconf session of a forked child
+ *
+ * Install the handed-off fds as stdin and stdout, and use the user of the helper
+ * @param[in]  h     Clixon handle
+ * @param[in]  ss    Socket of helper, kept open until session terminates
+ * @param[in]  fds   Handed-off stdin and stdout
+ * @param[in]  name  User name of helper
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+netconf_zygote_child(clicon_handle h,
+                     int           ss,
+                     int          *fds,
+                     char         *name)
+{
+    int retval = -1;
+    int s;
+
+    if (set_signal(SIGTERM, SIG_DFL, NULL) < 0 ||
+        set_signal(SIGINT, SIG_DFL, NULL) < 0 ||
+        set_signal(SIGCHLD, SIG_DFL, NULL) < 0)
+        goto done;
+    if (dup2(fds[0], 0) < 0 || dup2(fds[1], 1) < 0){
+        clicon_err(OE_UNIX, errno, "dup2");
+        goto done;
+    }
+    if (fds[0] > 1)
+        close(fds[0]);
+    if (fds[1] > 1)
+        close(fds[1]);
+    /* Not inherited by processes started by the session */
+    if (fcntl(ss, F_SETFD, FD_CLOEXEC) < 0){
+        clicon_err(OE_UNIX, errno, "fcntl");
+        goto done;
+    }
+    /* A backend connection made by a plugin before the fork is not shared */
+    if ((s = clicon_client_socket_get(h)) != -1){
+        close(s);
+        clicon_client_socket_set(h, -1);
+    }
+    if (clicon_username_set(h, name) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Serve netconf sessions handed off on a unix socket, fork one child per session
+ *
+ * Called after config, yang and plugins are loaded but before the session is started.
+ * The parent loops until terminated, each child returns to continue with the session
+ * @param[in]  h         Clixon handle
+ * @param[in]  sockpath  Unix socket path
+ * @retval     1         In session child: stdin and stdout are the session
+ * @retval     0         Zygote terminated
+ * @retval    -1         Error
+ * @see netconf_zygote_connect  for the session helper
+ */
+int
+netconf_zygote_serve(clicon_handle h,
+                     char         *sockpath)
+{
+    int                retval = -1;
+    int                s = -1;
+    int                ss = -1;
+    int                fds[NETCONF_ZYGOTE_NFDS] = {-1, -1};
+    char              *name = NULL;
+    struct sockaddr_un from;
+    socklen_t          len;
+    pid_t              pid;
+    int                ret;
+
+    if ((s = netconf_zygote_socket(h, sockpath)) < 0)
+        goto done;
+    /* Without SA_RESTART to break accept */
+    if (set_signal_flags(SIGTERM, 0, netconf_zygote_sig_term, NULL) < 0 ||
+        set_signal_flags(SIGINT, 0, netconf_zygote_sig_term, NULL) < 0)
+        goto done;
+    /* Children are reaped automatically */
+    if (set_signal(SIGCHLD, SIG_IGN, NULL) < 0)
+        goto done;
+    clicon_log(LOG_NOTICE, "%s: %u Started zygote on %s", __PROGRAM__, getpid(), sockpath);
+    while (!_zygote_exit){
+        len = sizeof(from);
+        if ((ss = accept(s, (struct sockaddr*)&from, &len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "accept");
+            goto done;
+        }
+        if (netconf_zygote_peer(ss, &name) < 0 ||
+            (ret = netconf_zygote_recv_fds(ss, fds)) < 0){
+            clicon_log(LOG_WARNING, "%s: session handoff: %s", __FUNCTION__, clicon_err_reason);
+            goto next;
+        }
+        if (ret == 0){
+            clicon_log(LOG_WARNING, "%s: session handoff: no fds received", __FUNCTION__);
+            goto next;
+        }
+        if ((pid = fork()) < 0){
+            clicon_err(OE_UNIX, errno, "fork");
+            goto done;
+        }
+        if (pid == 0){ /* child */
+            close(s);
+            s = -1;
+            if (netconf_zygote_child(h, ss, fds, name) < 0)
+                goto done;
+            ss = -1; /* Kept open until exit */
+            retval = 1;
+            goto done;
+        }
+        clicon_debug(1, "%s session of %s: pid %u", __FUNCTION__, name, pid);
+    next:
+        if (fds[0] != -1)
+            close(fds[0]);
+        if (fds[1] != -1)
+            close(fds[1]);
+        fds[0] = fds[1] = -1;
+        close(ss);
+        ss = -1;
+        if (name){
+            free(name);
+            name = NULL;
+        }
+    }
+    unlink(sockpath);
+    retval = 0;
+ done:
+    if (s != -1)
+        close(s);
+    if (ss != -1)
+        close(ss);
+    if (name)
+        free(name);
+    return retval;
+}
+
+/*! Hand off this netconf session (stdin and stdout) to a netconf zygote
+ *
+ * Block until session terminates. Does not need config, yang or plugins
+ * @param[in]  sockpath  Unix socket path of zygote
+ * @retval     0         OK, session terminated
+ * @retval    -1         Error
+ * @see netconf_zygote_serve
+ */
+int
+netconf_zygote_connect(char *sockpath)
+{
+    int                retval = -1;
+    int                s = -1;
+    struct sockaddr_un addr;
+    int                fds[NETCONF_ZYGOTE_NFDS] = {0, 1};
+    char               buf[64];
+    ssize_t            len;
+
+    if (strlen(sockpath) >= sizeof(addr.sun_path)){
+        clicon_err(OE_UNIX, ENAMETOOLONG, "%s", sockpath);
+        goto done;
+    }
+    if ((s = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        clicon_err(OE_UNIX, errno, "socket");
+        goto done;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sockpath, sizeof(addr.sun_path)-1);
+    if (connect(s, (struct sockaddr *)&addr, SUN_LEN(&addr)) < 0){
+        clicon_err(OE_UNIX, errno, "connect(%s)", sockpath);
+        goto done;
+    }
+    if (netconf_zygote_send_fds(s, fds) < 0)
+        goto done;
+    /* The session child has stdin and stdout now */
+    close(0);
+    close(1);
+    while ((len = read(s, buf, sizeof(buf))) != 0){
+        if (len < 0 && errno != EINTR){
+            clicon_err(OE_UNIX, errno, "read");
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (s != -1)
+        close(s);
+    return retval;
+}
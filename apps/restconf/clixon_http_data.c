@@ -35,6 +35,7 @@
   * Limited static http data service embedded in restconf code
  */
 
+#define _GNU_SOURCE /* strptime, timegm */
 
 #ifdef HAVE_CONFIG_H
 #include "clixon_config.h" /* generated by config & autoconf */
@@ -48,6 +49,8 @@
 #include <syslog.h>
 #include <fcntl.h>
 #include <time.h>
+#include <strings.h>
+#include <stdint.h>
 #include <limits.h>
 #include <signal.h>
 #include <sys/time.h>
@@ -164,29 +167,26 @@ api_http_data_err(clicon_handle  h,
  * @param[in]      req     Generic Www handle (can be part of clixon handle)
  * @param[in]      prefix  Prefix of path0, where to start file check
  * @param[in,out]  cbpath  Filepath as cbuf, internal redirection may change it
- * @param[out]     fp      Open file, if retval = 1
- * @param[out]     fsz     Size of file, if retval = 1
+ * @param[out]     st      Status of file, if retval = 1
  * @retval        -1       Error
  * @retval         0       Invalid
- * @retval         1       OK, fp,fsz set
+ * @retval         1       OK, st set
  */
 static int
 http_data_check_file_path(clicon_handle h,
                           void         *req,
                           char         *prefix,
                           cbuf         *cbpath,
-                          FILE        **fp,
-                          off_t        *fsz)
+                          struct stat  *st)
 {
     int         retval = -1;
     struct stat fstat;
     char       *p;
     int         i;
     int         code = 0;
-    FILE       *f;
 
-    if (prefix == NULL || cbpath == NULL || fp == NULL){
-        clicon_err(OE_UNIX, EINVAL, "prefix, cbpath0 or fp is NULL");
+    if (prefix == NULL || cbpath == NULL || st == NULL){
+        clicon_err(OE_UNIX, EINVAL, "prefix, cbpath0 or st is NULL");
         goto done;
     }
     p = cbuf_get(cbpath);
@@ -246,13 +246,7 @@ http_data_check_file_path(clicon_handle h,
         code = 403;
         goto invalid;
     }
-    *fsz = fstat.st_size;
-    if ((f = fopen(p, "rb")) == NULL){
-        clicon_debug(1, "%s Error fopen(%s) %s", __FUNCTION__, p, strerror(errno));
-        code = 403;
-        goto invalid;
-    }
-    *fp = f;
+    *st = fstat;
     retval = 1; /* OK */
  done:
     return retval;
@@ -262,14 +256,356 @@ http_data_check_file_path(clicon_handle h,
     retval = 0;
     goto done;
 }
-                   
+
+/*! Check if a content coding is accepted by Accept-Encoding request header
+ *
+ * @param[in]  accept  Value of Accept-Encoding, or NULL
+ * @param[in]  coding  Content coding, eg gzip
+ * @retval     1       Accepted
+ * @retval     0       Not accepted, also if q=0
+ * @see restconf_accept_encoding  for compression of native restconf
+ */
+static int
+http_data_accept_coding(const char *accept,
+                        const char *coding)
+{
+    const char *p;
+    const char *q;
+    size_t      len;
+
+    if (accept == NULL)
+        return 0;
+    len = strlen(coding);
+    p = accept;
+    while (*p){
+        while (*p == ' ' || *p == '\t' || *p == ',')
+            p++;
+        if ((strncasecmp(p, coding, len) == 0 && strchr(" \t;,", p[len])) ||
+            (*p == '*' && strchr(" \t;,", p[1]))){
+            /* q=0 means not acceptable, RFC 9110 Sec 12.5.3 */
+            q = p;
+            while (*q && *q != ',' && *q != ';')
+                q++;
+            if (*q != ';')
+                return 1;
+            q++;
+            while (*q == ' ' || *q == '\t')
+                q++;
+            if (strncasecmp(q, "q=0", 3) != 0)
+                return 1;
+            q += 3;
+            if (*q == '.')
+                q += strspn(q+1, "0") + 1;
+            return *q >= '1' && *q <= '9';
+        }
+        while (*p && *p != ',')
+            p++;
+    }
+    return 0;
+}
+
+/*! Http-data file contents, cached if HTTP_DATA_CACHE
+ */
+struct http_data_file{
+    qelem_t     hf_qelem;  /* LRU list, most recently used first */
+    cbuf       *hf_body;   /* File contents */
+    struct stat hf_st;     /* Status of file when read, see http_data_file_valid */
+    char        hf_etag[64]; /* Strong entity-tag of contents */
+    size_t      hf_size;   /* Memory of entry in bytes */
+    char        hf_path[]; /* Filename, also hash key */
+};
+typedef struct http_data_file http_data_file;
+
+#ifdef HTTP_DATA_CACHE
+static clicon_hash_t  *_http_data_cache_hash = NULL; /* filename -> entry */
+static http_data_file *_http_data_cache_lru = NULL;  /* Circular list, last is least recently used */
+static size_t          _http_data_cache_size = 0;    /* Memory of cached entries */
+static uint64_t        _http_data_cache_nr = 0;      /* Nr of cached entries */
+static uint64_t        _http_data_cache_hits = 0;
+static uint64_t        _http_data_cache_misses = 0;
+#endif
+
+/*! Free http-data file entry
+ */
+static int
+http_data_file_free(http_data_file *hf)
+{
+    if (hf->hf_body)
+        cbuf_free(hf->hf_body);
+    free(hf);
+    return 0;
+}
+
+/*! Check if contents read earlier is still valid for file status
+ *
+ * @note The time resolution is seconds, a file changed twice within a second to contents of
+ *       the same size is not detected
+ */
+static int
+http_data_file_valid(http_data_file *hf,
+                     struct stat    *st)
+{
+    return hf->hf_st.st_ino == st->st_ino &&
+        hf->hf_st.st_dev == st->st_dev &&
+        hf->hf_st.st_size == st->st_size &&
+        hf->hf_st.st_mtime == st->st_mtime &&
+        hf->hf_st.st_ctime == st->st_ctime;
+}
+
+#ifdef HTTP_DATA_CACHE
+/*! Remove entry from cache and free it
+ */
+static int
+http_data_cache_evict(http_data_file *hf)
+{
+    DELQ(hf, _http_data_cache_lru, http_data_file *);
+    clicon_hash_del(_http_data_cache_hash, hf->hf_path);
+    _http_data_cache_size -= hf->hf_size;
+    _http_data_cache_nr--;
+    http_data_file_free(hf);
+    return 0;
+}
+
+/*! Add file contents to cache
+ *
+ * Least recently used entries are evicted when the cache exceeds HTTP_DATA_CACHE_SIZE bytes.
+ * @param[in]  hf   File entry
+ * @retval     1    Cached, hf is owned by the cache
+ * @retval     0    Not cached, too large
+ * @retval    -1    Error
+ */
+static int
+http_data_cache_add(http_data_file *hf)
+{
+    if (hf->hf_size > HTTP_DATA_CACHE_SIZE)
+        return 0;
+    if (_http_data_cache_hash == NULL &&
+        (_http_data_cache_hash = clicon_hash_init()) == NULL)
+        return -1;
+    while (_http_data_cache_lru && _http_data_cache_size + hf->hf_size > HTTP_DATA_CACHE_SIZE)
+        http_data_cache_evict(PREVQ(http_data_file *, _http_data_cache_lru));
+    if (clicon_hash_add(_http_data_cache_hash, hf->hf_path, &hf, sizeof(hf)) == NULL)
+        return -1;
+    INSQ(hf, _http_data_cache_lru);
+    _http_data_cache_size += hf->hf_size;
+    _http_data_cache_nr++;
+    return 1;
+}
+#endif /* HTTP_DATA_CACHE */
+
+/*! Get contents of a http-data file, from cache if valid, otherwise read file
+ *
+ * @param[in]  h         Clicon handle
+ * @param[in]  req       Generic Www handle
+ * @param[in]  filename  File, checked by http_data_check_file_path
+ * @param[in]  st        Status of file from lstat
+ * @param[out] hfp       File entry
+ * @param[out] cached    If 1, hfp is owned by the cache, otherwise free with http_data_file_free
+ * @retval     1         OK, hfp set
+ * @retval     0         Invalid, error reply sent
+ * @retval    -1         Error
+ */
+static int
+http_data_file_get(clicon_handle    h,
+                   void            *req,
+                   char            *filename,
+                   struct stat     *st,
+                   http_data_file **hfp,
+                   int             *cached)
+{
+    int             retval = -1;
+    http_data_file *hf = NULL;
+    struct stat     fst;
+    size_t          len;
+    int             fd = -1;
+    ssize_t         n;
+    off_t           off;
+    int             ret;
+#ifdef HTTP_DATA_CACHE
+    void           *val;
+#endif
+
+    *cached = 0;
+#ifdef HTTP_DATA_CACHE
+    if (_http_data_cache_hash &&
+        (val = clicon_hash_value(_http_data_cache_hash, filename, NULL)) != NULL){
+        hf = *(http_data_file **)val;
+        if (http_data_file_valid(hf, st)){
+            _http_data_cache_hits++;
+            if (hf != _http_data_cache_lru){ /* Move first */
+                DELQ(hf, _http_data_cache_lru, http_data_file *);
+                INSQ(hf, _http_data_cache_lru);
+            }
+            clicon_debug(1, "%s %s cached", __FUNCTION__, filename);
+            *hfp = hf;
+            *cached = 1;
+            goto ok;
+        }
+        http_data_cache_evict(hf); /* Changed */
+        hf = NULL;
+    }
+    _http_data_cache_misses++;
+#endif
+    if ((fd = open(filename, O_RDONLY)) < 0){
+        clicon_debug(1, "%s Error open(%s) %s", __FUNCTION__, filename, strerror(errno));
+        if (api_http_data_err(h, req, 403) < 0)
+            goto done;
+        goto fail;
+    }
+    /* Size could have been taken from lstat() but this reduces the race condition interval 
+     * There is still one without flock
+     * Extra sanity check, had some problems with wrong file types
+     */
+    if (fstat(fd, &fst) < 0 || fst.st_ino != st->st_ino || fst.st_size != st->st_size){
+        clicon_debug(1, "%s Error file %s changed sz:%zu", __FUNCTION__, filename, (size_t)st->st_size);
+        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+            goto done;
+        goto fail;
+    }
+    len = strlen(filename);
+    if ((hf = malloc(sizeof(*hf) + len + 1)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(hf, 0, sizeof(*hf));
+    memcpy(hf->hf_path, filename, len + 1);
+    hf->hf_st = fst;
+    snprintf(hf->hf_etag, sizeof(hf->hf_etag), "\"%jx-%jx-%jx\"",
+             (uintmax_t)fst.st_ino, (uintmax_t)fst.st_size, (uintmax_t)fst.st_mtime);
+    if ((hf->hf_body = cbuf_new_alloc(fst.st_size+1)) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
+        goto done;
+    }
+    /* Read directly into the buffer */
+    for (off = 0; off < fst.st_size; off += n){
+        if ((n = read(fd, cbuf_get(hf->hf_body) + off, fst.st_size - off)) < 0){
+            if (errno == EINTR){
+                n = 0;
+                continue;
+            }
+            clicon_err(OE_UNIX, errno, "read");
+            goto done;
+        }
+        if (n == 0)
+            break;
+    }
+    if (off != fst.st_size){
+        clicon_debug(1, "%s Error read(%s) sz:%zu", __FUNCTION__, filename, (size_t)off);
+        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+            goto done;
+        goto fail;
+    }
+    if (cbuf_trunc(hf->hf_body, fst.st_size) < 0)
+        goto done;
+    hf->hf_size = sizeof(*hf) + 2*(len + 1) + cbuf_buflen(hf->hf_body);
+#ifdef HTTP_DATA_CACHE
+    if ((ret = http_data_cache_add(hf)) < 0)
+        goto done;
+    *cached = ret;
+#else
+    ret = 0;
+#endif
+    clicon_debug(1, "%s Read %s OK", __FUNCTION__, filename);
+    *hfp = hf;
+    hf = NULL;
+ ok:
+    retval = 1;
+ done:
+    if (fd != -1)
+        close(fd);
+    if (hf)
+        http_data_file_free(hf);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/* Precompressed variants of http-data files, in order of preference
+ * A file is sent as its variant with Content-Encoding if the variant exists and the coding
+ * is accepted, eg index.html.gz for index.html
+ */
+static const map_str2str http_data_variants[] = {
+    {"br",    ".br"},
+    {"zstd",  ".zst"},
+    {"gzip",  ".gz"},
+    { NULL,    NULL}
+};
+
+/*! Find a precompressed variant of a http-data file
+ *
+ * @param[in]  filename  File
+ * @param[in]  accept    Value of Accept-Encoding, or NULL
+ * @param[out] cbvar     Filename of variant
+ * @param[out] st        Status of variant
+ * @param[out] coding    Content coding of variant, or NULL if no variant accepted
+ * @retval     1         A variant exists, whether accepted or not
+ * @retval     0         No variant exists
+ */
+static int
+http_data_variant(char        *filename,
+                  const char  *accept,
+                  cbuf        *cbvar,
+                  struct stat *st,
+                  const char **coding)
+{
+    const map_str2str *mp;
+    struct stat        vst;
+    int                exist = 0;
+
+    *coding = NULL;
+    for (mp = &http_data_variants[0]; mp->ms_s0; mp++){
+        cbuf_reset(cbvar);
+        cprintf(cbvar, "%s%s", filename, mp->ms_s1);
+        /* Ensure not soft link */
+        if (lstat(cbuf_get(cbvar), &vst) < 0 || !S_ISREG(vst.st_mode))
+            continue;
+        exist = 1;
+        if (http_data_accept_coding(accept, mp->ms_s0)){
+            *coding = mp->ms_s0;
+            *st = vst;
+            break;
+        }
+    }
+    return exist;
+}
+
+/*! Check conditional request of a http-data file
+ *
+ * @param[in]  h         Clicon handle
+ * @param[in]  hf        File entry
+ * @retval     1         Not modified
+ * @retval     0         Modified, or no condition
+ * @see api_data_get_conditional
+ */
+static int
+http_data_not_modified(clicon_handle   h,
+                       http_data_file *hf)
+{
+    char      *str;
+    struct tm  tm = {0,};
+    char      *p;
+
+    /* If-None-Match has precedence over If-Modified-Since, RFC 7232 Sec 3.3 */
+    if ((str = restconf_param_get(h, "HTTP_IF_NONE_MATCH")) != NULL)
+        return strcmp(str, "*") == 0 || strstr(str, hf->hf_etag) != NULL;
+    if ((str = restconf_param_get(h, "HTTP_IF_MODIFIED_SINCE")) != NULL){
+        if ((p = strptime(str, "%a, %d %b %Y %H:%M:%S GMT", &tm)) == NULL || *p != '\0')
+            return 0; /* Invalid date is ignored */
+        return timegm(&tm) >= hf->hf_st.st_mtime;
+    }
+    return 0;
+}
+
 /*! Read file data request
  * @param[in]  h         Clicon handle
  * @param[in]  req       Generic Www handle (can be part of clixon handle)
  * @param[in]  pathname  With stripped prefix (eg /data), ultimately a filename
  * @param[in]  head      HEAD not GET
- * @note: primitive file handling, just check if file exists and read it all
- * XXX 1: Buffer copying once too many, see #if 0 below
+ * A precompressed variant of the file is sent if accepted, see http_data_variants.
+ * The reply has a strong entity-tag and Last-Modified of the file, and a conditional
+ * request is replied with 304.
+ * @see HTTP_DATA_CACHE
  */
 static int
 api_http_data_file(clicon_handle h,
@@ -277,22 +613,25 @@ api_http_data_file(clicon_handle h,
                    char         *pathname,
                    int           head)
 {
-    int         retval = -1;
-    cbuf       *cbfile = NULL;
-    char       *filename = NULL;
-    cbuf       *cbdata = NULL;
-    FILE       *f = NULL;
-    off_t       fsz = 0;
-    long        fsize;
-    char       *www_data_root = NULL;
-    char       *suffix;
-    char       *media;
-    int         ret;
-    char       *buf = NULL;
-    size_t      sz;
+    int             retval = -1;
+    cbuf           *cbfile = NULL;
+    cbuf           *cbvar = NULL;
+    char           *filename = NULL;
+    cbuf           *cbdata = NULL;
+    struct stat     st;
+    char           *www_data_root = NULL;
+    char           *suffix;
+    char           *media;
+    const char     *coding = NULL;
+    char           *cachecontrol;
+    http_data_file *hf = NULL;
+    int             cached = 0;
+    char            timestr[40];
+    int             ret;
 
     clicon_debug(1, "%s", __FUNCTION__);    
-    if ((cbfile = cbuf_new()) == NULL){
+    if ((cbfile = cbuf_new()) == NULL ||
+        (cbvar = cbuf_new()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
@@ -312,7 +651,7 @@ api_http_data_file(clicon_handle h,
         }
         cprintf(cbfile, "%s", pathname); /* Assume pathname starts with '/' */
     }
-    if ((ret = http_data_check_file_path(h, req, www_data_root, cbfile, &f, &fsz)) < 0)
+    if ((ret = http_data_check_file_path(h, req, www_data_root, cbfile, &st)) < 0)
         goto done;
     if (ret == 0) /* Invalid, return code set */
         goto ok;
@@ -326,59 +665,65 @@ api_http_data_file(clicon_handle h,
         if ((media = clicon_str2str(mime_map, suffix)) == NULL)
             media = "application/octet-stream";
     }
-    /* Size could have been taken from stat() but this reduces the race condition interval 
-     * There is still one without flock
-     */
-    fseek(f, 0, SEEK_END);
-    fsize = ftell(f);
-    /* Extra sanity check, had some problems with wrong file types */
-    if (fsz != fsize){
-        clicon_debug(1, "%s Error file %s size mismatch sz:%zu vs %li",
-                     __FUNCTION__, filename, (size_t)fsz, fsize);
-        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+    if (http_data_variant(filename, restconf_param_get(h, "HTTP_ACCEPT_ENCODING"),
+                          cbvar, &st, &coding)){
+        if (restconf_reply_header(req, "Vary", "Accept-Encoding") < 0)
             goto done;
-        goto ok;
+        if (coding)
+            filename = cbuf_get(cbvar);
     }
-    fseek(f, 0, SEEK_SET);  /* same as rewind(f); */
-    if ((cbdata = cbuf_new_alloc(fsize+1)) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
+    if ((ret = http_data_file_get(h, req, filename, &st, &hf, &cached)) < 0)
         goto done;
-    }
-    /* Unoptimized, no direct read but requires an extra copy,
-     * the cligen buf API should have some mechanism for this case without the extra copy.
-     */
-    if ((buf = malloc(fsize)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if (ret == 0) /* Invalid, return code set */
+        goto ok;
+    if (restconf_reply_header(req, "ETag", "%s", hf->hf_etag) < 0)
         goto done;
-    }
-    if ((ret = fread(buf, fsize, 1, f)) < 0){
-        clicon_err(OE_UNIX, errno, "fread");
+    if ((cachecontrol = clicon_option_str(h, "CLICON_HTTP_DATA_CACHE_CONTROL")) != NULL &&
+        strlen(cachecontrol) &&
+        restconf_reply_header(req, "Cache-Control", "%s", cachecontrol) < 0)
         goto done;
-    }
-    sz = (size_t)ret;
-    if (sz != 1){
-        clicon_debug(1, "%s Error fread(%s) sz:%zu", __FUNCTION__, filename, sz);
-        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+    if (http_data_not_modified(h, hf)){
+        clicon_debug(1, "%s not modified %s", __FUNCTION__, hf->hf_etag);
+        if (restconf_reply_send(req, 304, NULL, head) < 0)
             goto done;
         goto ok;
     }
-    if (cbuf_append_buf(cbdata, buf, fsize) < 0){
-        clicon_err(OE_UNIX, errno, "cbuf_append_str");
+    if (strftime(timestr, sizeof(timestr), "%a, %d %b %Y %H:%M:%S GMT",
+                 gmtime(&hf->hf_st.st_mtime)) > 0 &&
+        restconf_reply_header(req, "Last-Modified", "%s", timestr) < 0)
         goto done;
-    }
     if (restconf_reply_header(req, "Content-Type", "%s", media) < 0)
         goto done;
-    if (restconf_reply_send(req, 200, cbdata, head) < 0)
+    if (coding &&
+        restconf_reply_header(req, "Content-Encoding", "%s", coding) < 0)
         goto done;
+    if (cached){
+        /* The reply consumes its body, copy contents from cache */
+        if ((cbdata = cbuf_new_alloc(cbuf_len(hf->hf_body)+1)) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
+            goto done;
+        }
+        if (cbuf_append_buf(cbdata, cbuf_get(hf->hf_body), cbuf_len(hf->hf_body)) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+    }
+    else {
+        cbdata = hf->hf_body;
+        hf->hf_body = NULL;
+    }
+    if (restconf_reply_send(req, 200, cbdata, head) < 0){
+        cbdata = NULL; /* freed by reply-send on error */
+        goto done;
+    }
     cbdata = NULL; /* consumed by reply-send */
-    clicon_debug(1, "%s Read %s OK", __FUNCTION__, filename);
  ok:
     retval = 0;
  done:
-    if (buf)
-        free(buf);
-    if (f)
-        fclose(f);
+    if (hf && !cached)
+        http_data_file_free(hf);
+    if (cbvar)
+        cbuf_free(cbvar);
     if (cbfile)
         cbuf_free(cbfile);
     if (cbdata)
@@ -494,3 +839,47 @@ api_http_data(clicon_handle  h,
     clicon_debug(1, "%s %d", __FUNCTION__, retval);
     return retval;
 }
+
+/*! Get http-data file cache statistics
+ *
+ * @param[out] nr      Number of cached files
+ * @param[out] sz      Memory of cached files in bytes
+ * @param[out] hits    Number of files sent from cache
+ * @param[out] misses  Number of files read
+ * @retval     0       OK
+ * @see HTTP_DATA_CACHE
+ */
+int
+http_data_cache_stats(uint64_t *nr,
+                      size_t   *sz,
+                      uint64_t *hits,
+                      uint64_t *misses)
+{
+#ifdef HTTP_DATA_CACHE
+    *nr = _http_data_cache_nr;
+    *sz = _http_data_cache_size;
+    *hits = _http_data_cache_hits;
+    *misses = _http_data_cache_misses;
+#else
+    *nr = 0;
+    *sz = 0;
+    *hits = 0;
+    *misses = 0;
+#endif
+    return 0;
+}
+
+/*! Free all cached http-data files
+ */
+void
+http_data_cache_exit(void)
+{
+#ifdef HTTP_DATA_CACHE
+    while (_http_data_cache_lru)
+        http_data_cache_evict(_http_data_cache_lru);
+    if (_http_data_cache_hash){
+        clicon_hash_free(_http_data_cache_hash);
+        _http_data_cache_hash = NULL;
+    }
+#endif
+}
@@ -43,5 +43,7 @@
  */
 int api_path_is_data(clicon_handle h);
 int api_http_data(clicon_handle h, void *req, cvec *qvec);
+int http_data_cache_stats(uint64_t *nr, size_t *sz, uint64_t *hits, uint64_t *misses);
+void http_data_cache_exit(void);
 
 #endif /* _CLIXON_HTTP_DATA_H_ */
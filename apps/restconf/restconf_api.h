@@ -46,6 +46,9 @@ int restconf_reply_header(void *req, const char *name, const char *vfmt, ...)  _
 /* note cb is consumed dont free */
 int restconf_reply_send(void *req, int code, cbuf *cb, int head);
 
+/* note arg is consumed and freed with freefn */
+int restconf_reply_send_stream(void *req, int code, restconf_body_fn *fn, void *arg, restconf_body_free_fn *freefn, int head);
+
 cbuf *restconf_get_indata(void *req);
 
 #endif /* _RESTCONF_API_H_ */
@@ -61,6 +61,7 @@
 
 /* clicon */
 #include <clixon/clixon.h>
+#include <clixon/clixon_probe.h>
 
 #include <fcgiapp.h> /* Need to be after clixon_xml-h due to attribute format */
 
@@ -201,6 +202,7 @@ restconf_reply_send(void  *req0,
     int           retval = -1;
     const char *reason_phrase;
 
+    CLIXON_PROBE2(restconf_reply, code, cb?cbuf_len(cb):0);
     FCGX_SetExitStatus(code, req->out);
     if ((reason_phrase = restconf_code2reason(code)) == NULL)
         reason_phrase="";
@@ -210,7 +212,7 @@ restconf_reply_send(void  *req0,
     /* Write a body if cbuf is nonzero */
     if (cb != NULL){
         if (!head && cbuf_len(cb)){
-            FCGX_FPrintF(req->out, "%s", cbuf_get(cb));
+            FCGX_PutStr(cbuf_get(cb), cbuf_len(cb), req->out); /* May be binary, eg CBOR */
             FCGX_FPrintF(req->out, "\r\n");
         }
         cbuf_free(cb);
@@ -221,6 +223,38 @@ restconf_reply_send(void  *req0,
     return retval;
 }
 
+/*! Send HTTP reply with a body produced in parts
+ *
+ * With FCGI the whole body is produced before it is sent
+ * @param[in]  req    Fastcgi request handle
+ * @param[in]  code   Status code
+ * @param[in]  fn     Body producer
+ * @param[in]  arg    Producer argument, consumed and freed by freefn
+ * @param[in]  freefn Free producer argument
+ * @param[in]  head   Only send headers, dont send body. 
+ * @see restconf_reply_send
+ */
+int
+restconf_reply_send_stream(void                  *req,
+                           int                    code,
+                           restconf_body_fn      *fn,
+                           void                  *arg,
+                           restconf_body_free_fn *freefn,
+                           int                    head)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if (restconf_reply_stream_drain(fn, arg, &cb) < 0)
+        goto done;
+    if (restconf_reply_send(req, code, cb, head) < 0)
+        goto done;
+    retval = 0;
+ done:
+    freefn(arg);
+    return retval;
+}
+
 /*! Get input data from http request, eg such as curl -X PUT http://... <indata>
  * @param[in]  req        Fastcgi request handle
  * @retval     indata     
@@ -237,6 +271,6 @@ restconf_get_indata(void *req0)
     if ((cb = cbuf_new()) == NULL)
         return NULL;
     while ((c = FCGX_GetChar(req->in)) != -1)
-        cprintf(cb, "%c", c);
+        cbuf_append(cb, c); /* May be binary, eg CBOR */
     return cb;
 }
@@ -59,10 +59,13 @@
 
 /* clicon */
 #include <clixon/clixon.h>
+#include <clixon/clixon_probe.h>
 
 #include "restconf_lib.h"
+#include "restconf_handle.h"
 #include "restconf_api.h"  /* Virtual api */
 #include "restconf_native.h"
+#include "restconf_compress.h"
 
 /*! Add HTTP header field name and value to reply
  * @param[in]  req   request handle
@@ -120,6 +123,73 @@ restconf_reply_header(void       *req0,
     return retval;
 }
 
+/*! Choose content coding of reply body and add reply headers for it
+ *
+ * Compression is enabled per socket by compression-level, and the coding is negotiated
+ * with the Accept-Encoding request header.
+ * A strong entity-tag identifies the uncompressed representation, so it is made weak if the
+ * reply is compressed, see RFC 9110 Sec 8.8.1
+ * A body with Content-Encoding already set is not compressed again
+ * @param[in]  sd       Restconf stream data
+ * @param[in]  compress Body may be compressed, eg not HEAD and large enough
+ * @param[out] enc      Content coding, RESTCONF_ENC_IDENTITY if not compressed
+ * @param[out] level    Compression level
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+restconf_reply_encoding(restconf_stream_data *sd,
+                        int                   compress,
+                        restconf_encoding    *enc,
+                        int                  *level)
+{
+    int            retval = -1;
+    restconf_conn *rc;
+    cg_var        *cv;
+    char          *etag;
+    char          *weak = NULL;
+    size_t         len;
+
+    *enc = RESTCONF_ENC_IDENTITY;
+    if ((rc = sd->sd_conn) == NULL ||
+        rc->rc_socket == NULL ||
+        rc->rc_socket->rs_compress_level == 0)
+        goto ok;
+    if (cvec_find(sd->sd_outp_hdrs, "Vary") == NULL &&
+        restconf_reply_header(sd, "Vary", "Accept-Encoding") < 0)
+        goto done;
+    if (!compress)
+        goto ok;
+    /* Already encoded, eg precompressed http-data file */
+    if (cvec_find(sd->sd_outp_hdrs, "Content-Encoding") != NULL)
+        goto ok;
+    *level = rc->rc_socket->rs_compress_level;
+    if ((*enc = restconf_accept_encoding(restconf_param_get(rc->rc_h, "HTTP_ACCEPT_ENCODING"))) == RESTCONF_ENC_IDENTITY)
+        goto ok;
+    clicon_debug(1, "%s %s", __FUNCTION__, restconf_encoding_int2str(*enc));
+    if (restconf_reply_header(sd, "Content-Encoding", "%s", restconf_encoding_int2str(*enc)) < 0)
+        goto done;
+    if ((cv = cvec_find(sd->sd_outp_hdrs, "ETag")) != NULL &&
+        (etag = cv_string_get(cv)) != NULL && *etag == '"'){
+        len = strlen(etag) + 3;
+        if ((weak = malloc(len)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        snprintf(weak, len, "W/%s", etag);
+        if (cv_string_set(cv, weak) == NULL){
+            clicon_err(OE_UNIX, errno, "cv_string_set");
+            goto done;
+        }
+    }
+ ok:
+    retval = 0;
+ done:
+    if (weak)
+        free(weak);
+    return retval;
+}
+
 /*! Send HTTP reply with potential message body
  * @param[in]     req   http request handle
  * @param[in]     code  Status code
@@ -136,8 +206,12 @@ restconf_reply_send(void  *req0,
 {
     int                   retval = -1;
     restconf_stream_data *sd = (restconf_stream_data *)req0;
+    restconf_encoding     enc;
+    int                   level = 0;
+    cbuf                 *cbz = NULL;
 
     clicon_debug(1, "%s code:%d", __FUNCTION__, code);
+    CLIXON_PROBE2(restconf_reply, code, cb?cbuf_len(cb):0);
     if (sd == NULL){
         clicon_err(OE_CFG, EINVAL, "sd is NULL");
         goto done;
@@ -145,6 +219,16 @@ restconf_reply_send(void  *req0,
     sd->sd_code = code;
     if (cb != NULL){
         if (cbuf_len(cb)){
+            /* Compress body, see compression-level */
+            if (restconf_reply_encoding(sd, !head && cbuf_len(cb) >= RESTCONF_COMPRESS_MIN_SIZE,
+                                        &enc, &level) < 0)
+                goto done;
+            if (enc != RESTCONF_ENC_IDENTITY){
+                if (restconf_compress_cbuf(enc, level, cb, &cbz) < 0)
+                    goto done;
+                cbuf_free(cb);
+                cb = cbz;
+            }
             sd->sd_body_len = cbuf_len(cb); 
             if (head){
                 cbuf_free(cb);
@@ -163,6 +247,86 @@ restconf_reply_send(void  *req0,
         sd->sd_body_len = 0; 
     retval = 0;
  done:
+    if (retval < 0 && cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Send HTTP reply with a body produced in parts
+ *
+ * With HTTP/2 and CLICON_RESTCONF_STREAM_CHUNK set, the body is produced by the data provider
+ * as DATA frames are sent, see restconf_sd_read. Then HTTP/2 flow control throttles the
+ * production and there is no Content-Length.
+ * Otherwise, eg HTTP/1 or HEAD, the whole body is produced here, see restconf_reply_send
+ * If the reply is compressed, the compressor is a producer wrapping fn, see compression-level
+ * @param[in]  req    http request handle
+ * @param[in]  code   Status code
+ * @param[in]  fn     Body producer
+ * @param[in]  arg    Producer argument, consumed and freed by freefn
+ * @param[in]  freefn Free producer argument
+ * @param[in]  head   Only send headers, dont send body. 
+ */
+int
+restconf_reply_send_stream(void                  *req0,
+                           int                    code,
+                           restconf_body_fn      *fn,
+                           void                  *arg,
+                           restconf_body_free_fn *freefn,
+                           int                    head)
+{
+    int                   retval = -1;
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+    restconf_conn        *rc;
+    cbuf                 *cb = NULL;
+    restconf_encoding     enc;
+    int                   level = 0;
+    void                 *cs = NULL;
+    int                   ret;
+
+    clicon_debug(1, "%s code:%d", __FUNCTION__, code);
+    if (sd == NULL){
+        clicon_err(OE_CFG, EINVAL, "sd is NULL");
+        goto done;
+    }
+    rc = sd->sd_conn;
+    if (head || rc == NULL || rc->rc_proto != HTTP_2 ||
+        clicon_option_int(rc->rc_h, "CLICON_RESTCONF_STREAM_CHUNK") == 0){
+        if (restconf_reply_stream_drain(fn, arg, &cb) < 0)
+            goto done;
+        if (restconf_reply_send(req0, code, cb, head) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Compress body in parts as it is produced, see compression-level */
+    if (restconf_reply_encoding(sd, 1, &enc, &level) < 0)
+        goto done;
+    if (enc != RESTCONF_ENC_IDENTITY){
+        ret = restconf_compress_stream_new(enc, level, fn, arg, freefn, &cs);
+        arg = NULL; /* consumed */
+        if (ret < 0)
+            goto done;
+        fn = restconf_compress_stream_next;
+        arg = cs;
+        freefn = restconf_compress_stream_free;
+    }
+    sd->sd_code = code;
+    if (sd->sd_body)
+        cbuf_free(sd->sd_body);
+    if ((sd->sd_body = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    sd->sd_body_offset = 0;
+    sd->sd_body_len = 0; /* Unknown, no Content-Length */
+    sd->sd_body_fn = fn;
+    sd->sd_body_arg = arg;
+    sd->sd_body_free = freefn;
+    arg = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (arg)
+        freefn(arg);
     return retval;
 }
 
@@ -0,0 +1,492 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Compression of restconf reply bodies with HTTP Content-Encoding, RFC 9110 Sec 8.4
+  * The coding is negotiated with the Accept-Encoding request header. A reply body is either
+  * compressed all at once, or in parts as it is produced by a streamed reply producer, in
+  * which case the compressor itself is a producer wrapping the original one.
+  * Requires zlib for gzip and deflate, and zstd for zstd, see configure --with-zlib and --with-zstd
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <syslog.h>
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+#include "restconf_lib.h"
+#include "restconf_compress.h"
+
+/* Size of compressor output buffer, appended to reply body when full */
+#define RESTCONF_COMPRESS_BUFLEN 16384
+
+/* Content codings and their HTTP names, RFC 9110 Sec 8.4.1 */
+static const map_str2int http_encoding_map[] = {
+    {"identity",  RESTCONF_ENC_IDENTITY},
+    {"gzip",      RESTCONF_ENC_GZIP},
+    {"deflate",   RESTCONF_ENC_DEFLATE},
+    {"zstd",      RESTCONF_ENC_ZSTD},
+    {NULL,        -1}
+};
+
+/* Content codings in order of preference if the client gives them the same weight */
+static const restconf_encoding encoding_pref[] = {
+    RESTCONF_ENC_ZSTD,
+    RESTCONF_ENC_GZIP,
+    RESTCONF_ENC_DEFLATE
+};
+
+/*! Compressor state of one reply body
+ */
+struct restconf_compress_stream{
+    restconf_encoding      cs_enc;    /* Content coding */
+    restconf_body_fn      *cs_fn;     /* Producer of uncompressed body, or NULL */
+    void                  *cs_arg;    /* Producer argument */
+    restconf_body_free_fn *cs_free;   /* Free producer argument */
+    cbuf                  *cs_in;     /* Uncompressed body part from producer */
+    int                    cs_end;    /* Producer has produced all of body */
+#ifdef HAVE_LIBZ
+    z_stream               cs_z;      /* gzip and deflate */
+    int                    cs_zinit;  /* cs_z is initialized */
+#endif
+#ifdef HAVE_LIBZSTD
+    ZSTD_CCtx             *cs_zstd;   /* zstd */
+#endif
+};
+typedef struct restconf_compress_stream restconf_compress_stream;
+
+/*! Translate from content coding to HTTP name, eg RESTCONF_ENC_GZIP -> "gzip"
+ */
+const char *
+restconf_encoding_int2str(restconf_encoding enc)
+{
+    return clicon_int2str(http_encoding_map, enc);
+}
+
+/*! Check if a content coding is compiled in
+ */
+static int
+restconf_encoding_supported(restconf_encoding enc)
+{
+    switch (enc){
+#ifdef HAVE_LIBZ
+    case RESTCONF_ENC_GZIP:
+    case RESTCONF_ENC_DEFLATE:
+        return 1;
+#endif
+#ifdef HAVE_LIBZSTD
+    case RESTCONF_ENC_ZSTD:
+        return 1;
+#endif
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*! Choose content coding of reply from Accept-Encoding request header
+ *
+ * Each coding may have a weight, eg "gzip;q=0.5, zstd", where no weight is 1 and 0 means
+ * not acceptable. "*" is any coding not given. The supported coding with highest weight is
+ * chosen, with ties broken by encoding_pref.
+ * @param[in]  accept  Value of Accept-Encoding header, or NULL
+ * @retval     enc     Content coding, RESTCONF_ENC_IDENTITY if no compression
+ * @see RFC 9110 Sec 12.5.3
+ */
+restconf_encoding
+restconf_accept_encoding(const char *accept)
+{
+    restconf_encoding enc;
+    restconf_encoding best = RESTCONF_ENC_IDENTITY;
+    int               qv[RESTCONF_ENC_ZSTD+1]; /* Weight*1000 per coding, -1 if not given */
+    int               starq = -1;              /* Weight*1000 of "*" */
+    int               bestq = 0;
+    int               q;
+    const char       *s;
+    const char       *e;
+    const char       *p;
+    const char       *name;
+    size_t            len;
+    int               i;
+
+    if (accept == NULL)
+        return RESTCONF_ENC_IDENTITY;
+    for (i=0; i<=RESTCONF_ENC_ZSTD; i++)
+        qv[i] = -1;
+    s = accept;
+    while (*s != '\0'){
+        while (*s == ' ' || *s == '\t' || *s == ',')
+            s++;
+        if (*s == '\0')
+            break;
+        if ((e = strchr(s, ',')) == NULL)
+            e = s + strlen(s);
+        for (len=0; s+len < e && s[len] != ';' && s[len] != ' ' && s[len] != '\t'; len++);
+        q = 1000;
+        if ((p = memchr(s, ';', e-s)) != NULL &&
+            (p = strstr(p, "q=")) != NULL && p < e)
+            q = (int)(strtod(p+2, NULL)*1000);
+        if (len == 1 && *s == '*')
+            starq = q;
+        else for (i=0; i<=RESTCONF_ENC_ZSTD; i++){
+                if ((name = restconf_encoding_int2str(i)) != NULL &&
+                    strlen(name) == len && strncasecmp(s, name, len) == 0)
+                    qv[i] = q;
+            }
+        s = e;
+    }
+    for (i=0; i<sizeof(encoding_pref)/sizeof(encoding_pref[0]); i++){
+        enc = encoding_pref[i];
+        q = qv[enc] != -1 ? qv[enc] : starq;
+        if (restconf_encoding_supported(enc) && q > bestq){
+            best = enc;
+            bestq = q;
+        }
+    }
+    return best;
+}
+
+/*! Create compressor
+ *
+ * @param[in]  enc    Content coding
+ * @param[in]  level  Compression level, 1-9
+ * @retval     cs     Compressor, free with restconf_compress_stream_free
+ * @retval     NULL   Error
+ */
+static restconf_compress_stream *
+compress_stream_init(restconf_encoding enc,
+                     int               level)
+{
+    restconf_compress_stream *cs = NULL;
+
+    if (!restconf_encoding_supported(enc)){
+        clicon_err(OE_RESTCONF, EINVAL, "Content coding %s not supported",
+                   restconf_encoding_int2str(enc));
+        goto done;
+    }
+    if ((cs = malloc(sizeof(*cs))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(cs, 0, sizeof(*cs));
+    cs->cs_enc = enc;
+    switch (enc){
+#ifdef HAVE_LIBZ
+    case RESTCONF_ENC_GZIP:
+    case RESTCONF_ENC_DEFLATE:
+        /* Window bits 15, plus 16 for gzip header and trailer instead of zlib */
+        if (deflateInit2(&cs->cs_z, level, Z_DEFLATED,
+                         enc == RESTCONF_ENC_GZIP ? 15+16 : 15,
+                         8, Z_DEFAULT_STRATEGY) != Z_OK){
+            clicon_err(OE_RESTCONF, 0, "deflateInit2: %s", cs->cs_z.msg?cs->cs_z.msg:"");
+            goto err;
+        }
+        cs->cs_zinit = 1;
+        break;
+#endif
+#ifdef HAVE_LIBZSTD
+    case RESTCONF_ENC_ZSTD:
+        if ((cs->cs_zstd = ZSTD_createCCtx()) == NULL){
+            clicon_err(OE_RESTCONF, ENOMEM, "ZSTD_createCCtx");
+            goto err;
+        }
+        if (ZSTD_isError(ZSTD_CCtx_setParameter(cs->cs_zstd, ZSTD_c_compressionLevel, level))){
+            clicon_err(OE_RESTCONF, EINVAL, "ZSTD_CCtx_setParameter");
+            goto err;
+        }
+        break;
+#endif
+    default:
+        break;
+    }
+ done:
+    return cs;
+#if defined(HAVE_LIBZ) || defined(HAVE_LIBZSTD)
+ err:
+    restconf_compress_stream_free(cs);
+    cs = NULL;
+    goto done;
+#endif
+}
+
+/*! Compress a part of body and append compressed data to cbuf
+ *
+ * @param[in]  cs     Compressor
+ * @param[in]  buf    Uncompressed data
+ * @param[in]  buflen Length of buf
+ * @param[in]  end    Last part of body, write end of compressed stream
+ * @param[out] cbout  Compressed data is appended
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+compress_stream_buf(restconf_compress_stream *cs,
+                    char                     *buf,
+                    size_t                    buflen,
+                    int                       end,
+                    cbuf                     *cbout)
+{
+    int            retval = -1;
+#if defined(HAVE_LIBZ) || defined(HAVE_LIBZSTD)
+    unsigned char  out[RESTCONF_COMPRESS_BUFLEN];
+#endif
+#ifdef HAVE_LIBZ
+    z_stream      *z;
+#endif
+#ifdef HAVE_LIBZSTD
+    ZSTD_inBuffer  zin = {buf, buflen, 0};
+    ZSTD_outBuffer zout;
+    size_t         remaining;
+#endif
+
+    switch (cs->cs_enc){
+#ifdef HAVE_LIBZ
+    case RESTCONF_ENC_GZIP:
+    case RESTCONF_ENC_DEFLATE:
+        z = &cs->cs_z;
+        z->next_in = (Bytef*)buf;
+        z->avail_in = buflen;
+        do {
+            z->next_out = out;
+            z->avail_out = sizeof(out);
+            if (deflate(z, end?Z_FINISH:Z_NO_FLUSH) == Z_STREAM_ERROR){
+                clicon_err(OE_RESTCONF, 0, "deflate: %s", z->msg?z->msg:"");
+                goto done;
+            }
+            if (cbuf_append_buf(cbout, out, sizeof(out) - z->avail_out) < 0){
+                clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+        } while (z->avail_out == 0);
+        break;
+#endif
+#ifdef HAVE_LIBZSTD
+    case RESTCONF_ENC_ZSTD:
+        do {
+            zout.dst = out;
+            zout.size = sizeof(out);
+            zout.pos = 0;
+            remaining = ZSTD_compressStream2(cs->cs_zstd, &zout, &zin, end?ZSTD_e_end:ZSTD_e_continue);
+            if (ZSTD_isError(remaining)){
+                clicon_err(OE_RESTCONF, 0, "ZSTD_compressStream2: %s", ZSTD_getErrorName(remaining));
+                goto done;
+            }
+            if (cbuf_append_buf(cbout, out, zout.pos) < 0){
+                clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+        } while (end ? remaining != 0 : zin.pos < zin.size);
+        break;
+#endif
+    default:
+        clicon_err(OE_RESTCONF, EINVAL, "Content coding %s not supported",
+                   restconf_encoding_int2str(cs->cs_enc));
+        goto done;
+        break;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Compress a whole reply body
+ *
+ * @param[in]  enc    Content coding
+ * @param[in]  level  Compression level, 1-9
+ * @param[in]  cbin   Uncompressed body
+ * @param[out] cbout  Compressed body, free with cbuf_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+restconf_compress_cbuf(restconf_encoding enc,
+                       int               level,
+                       cbuf             *cbin,
+                       cbuf            **cbout)
+{
+    int                       retval = -1;
+    restconf_compress_stream *cs = NULL;
+    cbuf                     *cb = NULL;
+
+    if ((cs = compress_stream_init(enc, level)) == NULL)
+        goto done;
+    if ((cb = cbuf_new_alloc(cbuf_len(cbin)/4+64)) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
+        goto done;
+    }
+    if (compress_stream_buf(cs, cbuf_get(cbin), cbuf_len(cbin), 1, cb) < 0)
+        goto done;
+    *cbout = cb;
+    cb = NULL;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (cs)
+        restconf_compress_stream_free(cs);
+    return retval;
+}
+
+/*! Create compressor of a streamed reply body, itself a body producer
+ *
+ * @param[in]  enc    Content coding
+ * @param[in]  level  Compression level, 1-9
+ * @param[in]  fn     Producer of uncompressed body
+ * @param[in]  arg    Producer argument, consumed and freed by freefn also on error
+ * @param[in]  freefn Free producer argument
+ * @param[out] csp    Compressor, producer argument of restconf_compress_stream_next
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see restconf_reply_send_stream
+ */
+int
+restconf_compress_stream_new(restconf_encoding      enc,
+                             int                    level,
+                             restconf_body_fn      *fn,
+                             void                  *arg,
+                             restconf_body_free_fn *freefn,
+                             void                 **csp)
+{
+    int                       retval = -1;
+    restconf_compress_stream *cs = NULL;
+
+    if ((cs = compress_stream_init(enc, level)) == NULL)
+        goto done;
+    if ((cs->cs_in = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cs->cs_fn = fn;
+    cs->cs_arg = arg;
+    cs->cs_free = freefn;
+    arg = NULL;
+    *csp = cs;
+    cs = NULL;
+    retval = 0;
+ done:
+    if (arg)
+        freefn(arg);
+    if (cs)
+        restconf_compress_stream_free(cs);
+    return retval;
+}
+
+/*! Produce next part of compressed body, see restconf_body_fn
+ *
+ * Uncompressed parts are produced and compressed until at least len compressed bytes are
+ * appended, since compressed data is buffered by the compressor
+ * @param[in]  arg   Compressor
+ * @param[out] cb    Compressed body data is appended
+ * @param[in]  len   Minimum number of bytes to append (if not end), 0 means all
+ * @retval     1     OK, more data
+ * @retval     0     OK, end of body
+ * @retval    -1     Error
+ */
+int
+restconf_compress_stream_next(void  *arg,
+                              cbuf  *cb,
+                              size_t len)
+{
+    int                       retval = -1;
+    restconf_compress_stream *cs = (restconf_compress_stream *)arg;
+    size_t                    start;
+    int                       ret;
+
+    start = cbuf_len(cb);
+    while (1){
+        cbuf_reset(cs->cs_in);
+        if (!cs->cs_end){
+            if ((ret = cs->cs_fn(cs->cs_arg, cs->cs_in, len)) < 0)
+                goto done;
+            if (ret == 0)
+                cs->cs_end = 1;
+        }
+        if (compress_stream_buf(cs, cbuf_get(cs->cs_in), cbuf_len(cs->cs_in),
+                                cs->cs_end, cb) < 0)
+            goto done;
+        if (cs->cs_end){
+            retval = 0;
+            break;
+        }
+        if (len && cbuf_len(cb) - start >= len){
+            retval = 1;
+            break;
+        }
+    }
+ done:
+    return retval;
+}
+
+/*! Free compressor and the producer argument it wraps
+ *
+ * @param[in]  arg   Compressor
+ */
+int
+restconf_compress_stream_free(void *arg)
+{
+    restconf_compress_stream *cs = (restconf_compress_stream *)arg;
+
+    if (cs == NULL)
+        return 0;
+    if (cs->cs_free && cs->cs_arg)
+        cs->cs_free(cs->cs_arg);
+#ifdef HAVE_LIBZ
+    if (cs->cs_zinit)
+        deflateEnd(&cs->cs_z);
+#endif
+#ifdef HAVE_LIBZSTD
+    if (cs->cs_zstd)
+        ZSTD_freeCCtx(cs->cs_zstd);
+#endif
+    if (cs->cs_in)
+        cbuf_free(cs->cs_in);
+    free(cs);
+    return 0;
+}
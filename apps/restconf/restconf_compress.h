@@ -0,0 +1,65 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Compression of restconf reply bodies with HTTP Content-Encoding, RFC 9110 Sec 8.4
+ * Requires zlib for gzip and deflate, and zstd for zstd, see configure --with-zlib and --with-zstd
+ */
+#ifndef _RESTCONF_COMPRESS_H_
+#define _RESTCONF_COMPRESS_H_
+
+/*
+ * Types
+ */
+/*! Content coding of reply body
+ */
+enum restconf_encoding{
+    RESTCONF_ENC_IDENTITY = 0, /* No compression */
+    RESTCONF_ENC_GZIP,
+    RESTCONF_ENC_DEFLATE,
+    RESTCONF_ENC_ZSTD
+};
+typedef enum restconf_encoding restconf_encoding;
+
+/*
+ * Prototypes
+ */
+const char       *restconf_encoding_int2str(restconf_encoding enc);
+restconf_encoding restconf_accept_encoding(const char *accept);
+int               restconf_compress_cbuf(restconf_encoding enc, int level, cbuf *cbin, cbuf **cbout);
+int               restconf_compress_stream_new(restconf_encoding enc, int level,
+                                               restconf_body_fn *fn, void *arg,
+                                               restconf_body_free_fn *freefn, void **csp);
+int               restconf_compress_stream_next(void *arg, cbuf *cb, size_t len);
+int               restconf_compress_stream_free(void *arg);
+
+#endif  /* _RESTCONF_COMPRESS_H_ */
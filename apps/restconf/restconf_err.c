@@ -306,6 +306,11 @@ api_return_err(clicon_handle  h,
             cprintf(cb, "}\r\n");
         }
         break;
+    case YANG_DATA_CBOR:
+        clicon_debug(1, "%s code:%d", __FUNCTION__, code);
+        if (clixon_xml2cbor_member(cb, "ietf-restconf:errors", xerr) < 0)
+            goto done;
+        break;
     default: /* Just ignore the body so that there is a reply */
         clicon_err(OE_YANG, EINVAL, "Invalid media type %d", media);
         goto done;
@@ -0,0 +1,2889 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * gNMI over gRPC on the native HTTP/2 server, see CLICON_RESTCONF_GNMI
+ * The gNMI service RPCs are requests on GNMI_SERVICE_PATH<rpc> with protobuf messages in
+ * gRPC framing. Protobuf is encoded and decoded here for the gNMI messages only.
+ *   - Capabilities: the modules of the yang spec
+ *   - Get:          get of the backend, one update per selected node
+ *   - Set:          one edit-config with autocommit of all deletes, replaces and updates
+ *   - Subscribe:    ONCE and STREAM. STREAM subscriptions with SAMPLE are periodic and with
+ *                   ON_CHANGE or TARGET_DEFINED on-change datastore-push of the backend,
+ *                   one backend session per subscription
+ * Leaves have typed values, other nodes JSON_IETF (RFC 7951) values.
+ * Not supported: POLL, heartbeats, suppress_redundant, wildcard path elements, compressed
+ * messages, and paths of the deprecated element field. Path origin and target are ignored.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/time.h>
+
+#include <openssl/ssl.h>
+
+#ifdef HAVE_LIBNGHTTP2
+#include <nghttp2/nghttp2.h>
+#endif
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+/* restconf */
+#include "restconf_lib.h"
+#include "restconf_handle.h"
+#include "restconf_api.h"
+#include "restconf_err.h"
+#include "restconf_native.h"
+#include "restconf_gnmi.h"
+
+/* gNMI version of the service */
+#define GNMI_VERSION "0.7.0"
+
+/* Period of SAMPLE subscriptions without sample_interval, in centiseconds */
+#define GNMI_SAMPLE_DEFAULT 100
+
+/* gRPC status codes */
+#define GRPC_OK                  0
+#define GRPC_UNKNOWN             2
+#define GRPC_INVALID_ARGUMENT    3
+#define GRPC_NOT_FOUND           5
+#define GRPC_ALREADY_EXISTS      6
+#define GRPC_PERMISSION_DENIED   7
+#define GRPC_RESOURCE_EXHAUSTED  8
+#define GRPC_FAILED_PRECONDITION 9
+#define GRPC_ABORTED            10
+#define GRPC_UNIMPLEMENTED      12
+#define GRPC_UNAVAILABLE        14
+#define GRPC_UNAUTHENTICATED    16
+
+/* gNMI Encoding */
+#define GNMI_ENC_JSON      0
+#define GNMI_ENC_PROTO     2
+#define GNMI_ENC_JSON_IETF 4
+
+/* gNMI SubscriptionList Mode */
+#define GNMI_STREAM 0
+#define GNMI_ONCE   1
+#define GNMI_POLL   2
+
+/* gNMI SubscriptionMode */
+#define GNMI_SAMPLE 2
+
+/* gNMI UpdateResult Operation */
+#define GNMI_OP_DELETE  1
+#define GNMI_OP_REPLACE 2
+#define GNMI_OP_UPDATE  3
+
+/* Protobuf wire types */
+#define PB_VARINT  0
+#define PB_FIXED64 1
+#define PB_BYTES   2
+#define PB_FIXED32 5
+
+/*! Map NETCONF error-tag to gRPC status
+ */
+static const map_str2int gnmi_errtag_map[] = {
+    {"access-denied",           GRPC_PERMISSION_DENIED},
+    {"data-missing",            GRPC_NOT_FOUND},
+    {"data-exists",             GRPC_ALREADY_EXISTS},
+    {"in-use",                  GRPC_ABORTED},
+    {"lock-denied",             GRPC_ABORTED},
+    {"resource-denied",         GRPC_RESOURCE_EXHAUSTED},
+    {"operation-not-supported", GRPC_UNIMPLEMENTED},
+    {"operation-failed",        GRPC_FAILED_PRECONDITION},
+    {"invalid-value",           GRPC_INVALID_ARGUMENT},
+    {"too-big",                 GRPC_INVALID_ARGUMENT},
+    {"missing-attribute",       GRPC_INVALID_ARGUMENT},
+    {"bad-attribute",           GRPC_INVALID_ARGUMENT},
+    {"unknown-attribute",       GRPC_INVALID_ARGUMENT},
+    {"missing-element",         GRPC_INVALID_ARGUMENT},
+    {"bad-element",             GRPC_INVALID_ARGUMENT},
+    {"unknown-element",         GRPC_INVALID_ARGUMENT},
+    {"unknown-namespace",       GRPC_INVALID_ARGUMENT},
+    {"malformed-message",       GRPC_INVALID_ARGUMENT},
+    {NULL,                      -1}
+};
+
+/* Reader of a protobuf message */
+typedef struct {
+    uint8_t *pr_p;    /* Next field */
+    uint8_t *pr_end;  /* End of message */
+    int      pr_err;  /* Malformed message */
+} pb_reader;
+
+/* Path of a request translated to yang, and to XPath or XML */
+typedef struct {
+    yang_stmt *gw_yspec;  /* Yang spec */
+    yang_stmt *gw_y;      /* Yang of last element, NULL if no elements */
+    cxobj     *gw_x;      /* XML of last element, or of its parent if leaf, if building XML */
+    cbuf      *gw_xpath;  /* XPath, if not building XML */
+    cvec      *gw_nsc;    /* Namespace context of XPath */
+    int        gw_elems;  /* Number of elements */
+    cbuf      *gw_err;    /* Reason if invalid */
+} gnmi_walk;
+
+struct gnmi_stream;
+
+/* STREAM subscription with its own backend session */
+typedef struct {
+    qelem_t             gb_qelem;  /* List header */
+    struct gnmi_stream *gb_stream; /* Backpointer to subscribe stream */
+    int                 gb_s;      /* Backend session socket of datastore-push, -1 if closed */
+    char               *gb_xpath;  /* XPath of subscription path */
+    cvec               *gb_nsc;    /* Namespace context of XPath */
+} gnmi_sub;
+
+/* Subscribe RPC, the reply body producer of its HTTP/2 stream */
+typedef struct gnmi_stream {
+    clicon_handle         gs_h;        /* Clixon handle */
+    restconf_stream_data *gs_sd;       /* HTTP/2 stream, NULL if closed */
+    gnmi_sub             *gs_subs;     /* List of STREAM subscriptions */
+    cbuf                 *gs_queue;    /* Framed responses not yet produced */
+    int                   gs_encoding; /* gNMI encoding of values */
+    int                   gs_end;      /* End stream when queue is produced */
+    int                   gs_busy;     /* In backend callback, defer free */
+    int                   gs_removed;  /* Closed while busy, free when not busy */
+} gnmi_stream;
+
+/*! Initialize protobuf reader of a message
+ */
+static void
+pb_reader_init(pb_reader *pr,
+               uint8_t   *p,
+               size_t     len)
+{
+    pr->pr_p = p;
+    pr->pr_end = p + len;
+    pr->pr_err = 0;
+}
+
+/*! Read a varint
+ *
+ * @retval  1  OK
+ * @retval  0  Malformed, pr_err set
+ */
+static int
+pb_varint_get(pb_reader *pr,
+              uint64_t  *val)
+{
+    uint64_t v = 0;
+    int      shift;
+
+    for (shift = 0; shift < 64 && pr->pr_p < pr->pr_end; shift += 7){
+        v |= (uint64_t)(*pr->pr_p & 0x7f) << shift;
+        if ((*pr->pr_p++ & 0x80) == 0){
+            *val = v;
+            return 1;
+        }
+    }
+    pr->pr_err = 1;
+    return 0;
+}
+
+/*! Read next field of a protobuf message
+ *
+ * @param[in]  pr     Protobuf reader
+ * @param[out] field  Field number
+ * @param[out] val    Value of varint and fixed fields
+ * @param[out] data   Data of length-delimited fields, eg strings and messages, else NULL
+ * @param[out] len    Length of data
+ * @retval     1      Field read
+ * @retval     0      End of message, or malformed message if pr_err is set
+ */
+static int
+pb_next(pb_reader *pr,
+        uint32_t  *field,
+        uint64_t  *val,
+        uint8_t  **data,
+        size_t    *len)
+{
+    uint64_t tag;
+    uint64_t n;
+    int      i;
+
+    *val = 0;
+    *data = NULL;
+    *len = 0;
+    if (pr->pr_err || pr->pr_p >= pr->pr_end)
+        return 0;
+    if (pb_varint_get(pr, &tag) == 0)
+        return 0;
+    *field = tag >> 3;
+    switch (tag & 0x7){
+    case PB_VARINT:
+        return pb_varint_get(pr, val);
+        break;
+    case PB_FIXED64:
+    case PB_FIXED32: /* Little-endian */
+        n = (tag & 0x7) == PB_FIXED64 ? 8 : 4;
+        if ((uint64_t)(pr->pr_end - pr->pr_p) < n)
+            break;
+        for (i=n-1; i>=0; i--)
+            *val = (*val << 8) | pr->pr_p[i];
+        pr->pr_p += n;
+        return 1;
+        break;
+    case PB_BYTES:
+        if (pb_varint_get(pr, &n) == 0)
+            return 0;
+        if ((uint64_t)(pr->pr_end - pr->pr_p) < n)
+            break;
+        *data = pr->pr_p;
+        *len = n;
+        pr->pr_p += n;
+        return 1;
+        break;
+    default:
+        break;
+    }
+    pr->pr_err = 1;
+    return 0;
+}
+
+/*! Copy protobuf string as a null-terminated string, free with free
+ */
+static char *
+pb_strdup(uint8_t *data,
+          size_t   len)
+{
+    char *str;
+
+    if ((str = malloc(len + 1)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memcpy(str, data, len);
+    str[len] = '\0';
+    return str;
+}
+
+/*! Append bytes to a protobuf message
+ */
+static int
+pb_append(cbuf   *cb,
+          void   *data,
+          size_t  len)
+{
+    if (len && cbuf_append_buf(cb, data, len) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Append a varint to a protobuf message
+ */
+static int
+pb_varint(cbuf    *cb,
+          uint64_t v)
+{
+    uint8_t b[10];
+    int     i = 0;
+
+    do {
+        b[i] = v & 0x7f;
+        if ((v >>= 7) != 0)
+            b[i] |= 0x80;
+        i++;
+    } while (v);
+    return pb_append(cb, b, i);
+}
+
+/*! Append a varint field, eg an integer, bool or enum, to a protobuf message
+ */
+static int
+pb_uint(cbuf    *cb,
+        uint32_t field,
+        uint64_t v)
+{
+    if (pb_varint(cb, (field << 3) | PB_VARINT) < 0)
+        return -1;
+    return pb_varint(cb, v);
+}
+
+/*! Append a double field to a protobuf message
+ */
+static int
+pb_double(cbuf    *cb,
+          uint32_t field,
+          double   d)
+{
+    uint64_t u;
+    uint8_t  b[8];
+    int      i;
+
+    memcpy(&u, &d, sizeof(u));
+    for (i=0; i<8; i++)
+        b[i] = (u >> (8*i)) & 0xff;
+    if (pb_varint(cb, (field << 3) | PB_FIXED64) < 0)
+        return -1;
+    return pb_append(cb, b, 8);
+}
+
+/*! Append a length-delimited field, eg a string or message, to a protobuf message
+ */
+static int
+pb_bytes(cbuf    *cb,
+         uint32_t field,
+         void    *data,
+         size_t   len)
+{
+    if (pb_varint(cb, (field << 3) | PB_BYTES) < 0)
+        return -1;
+    if (pb_varint(cb, len) < 0)
+        return -1;
+    return pb_append(cb, data, len);
+}
+
+/*! Append a string field to a protobuf message
+ */
+static int
+pb_str(cbuf    *cb,
+       uint32_t field,
+       char    *str)
+{
+    return pb_bytes(cb, field, str, strlen(str));
+}
+
+/*! Append a message field to a protobuf message
+ */
+static int
+pb_msg(cbuf    *cb,
+       uint32_t field,
+       cbuf    *cbm)
+{
+    return pb_bytes(cb, field, cbuf_get(cbm), cbuf_len(cbm));
+}
+
+/*! Append a protobuf message to a reply in gRPC framing
+ *
+ * @param[in]  cb   Reply body
+ * @param[in]  cbm  Protobuf message
+ */
+static int
+gnmi_frame(cbuf *cb,
+           cbuf *cbm)
+{
+    uint8_t hdr[5];
+    size_t  len = cbuf_len(cbm);
+
+    hdr[0] = 0; /* Not compressed */
+    hdr[1] = (len >> 24) & 0xff;
+    hdr[2] = (len >> 16) & 0xff;
+    hdr[3] = (len >> 8) & 0xff;
+    hdr[4] = len & 0xff;
+    if (pb_append(cb, hdr, sizeof(hdr)) < 0)
+        return -1;
+    return pb_append(cb, cbuf_get(cbm), len);
+}
+
+/*! Get first gRPC message of request
+ *
+ * @param[in]  sd         Restconf stream data
+ * @param[out] msg        Protobuf message
+ * @param[out] len        Length of message
+ * @param[out] compressed Message is compressed
+ * @retval     1          OK
+ * @retval     0          No complete message received
+ */
+static int
+gnmi_request_msg(restconf_stream_data *sd,
+                 uint8_t             **msg,
+                 size_t               *len,
+                 int                  *compressed)
+{
+    cbuf    *cb = sd->sd_indata;
+    uint8_t *p;
+    size_t   n;
+
+    if (cb == NULL || cbuf_len(cb) < 5)
+        return 0;
+    p = (uint8_t*)cbuf_get(cb);
+    n = ((size_t)p[1] << 24) | ((size_t)p[2] << 16) | ((size_t)p[3] << 8) | p[4];
+    if (cbuf_len(cb) - 5 < n)
+        return 0;
+    *msg = p + 5;
+    *len = n;
+    *compressed = p[0];
+    return 1;
+}
+
+/*! Nanoseconds since the epoch, timestamp of gNMI notifications
+ */
+static uint64_t
+gnmi_now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec*1000000000ULL + (uint64_t)tv.tv_usec*1000ULL;
+}
+
+/*! Set gRPC status of stream, sent as trailer fields after the reply body
+ *
+ * @param[in]  sd       Restconf stream data
+ * @param[in]  status   gRPC status code
+ * @param[in]  message  Error message, or NULL
+ */
+static int
+gnmi_status(restconf_stream_data *sd,
+            int                   status,
+            char                 *message)
+{
+    int   retval = -1;
+    char *enc = NULL;
+    char  str[8];
+
+    cvec_reset(sd->sd_outp_trailers);
+    snprintf(str, sizeof(str), "%d", status);
+    if (cvec_add_string(sd->sd_outp_trailers, "grpc-status", str) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_add_string");
+        goto done;
+    }
+    if (message && strlen(message)){
+        /* Percent-encoded according to the gRPC HTTP/2 protocol */
+        if (uri_percent_encode(&enc, "%s", message) < 0)
+            goto done;
+        if (cvec_add_string(sd->sd_outp_trailers, "grpc-message", enc) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (enc)
+        free(enc);
+    return retval;
+}
+
+/*! Send reply of a unary gNMI RPC, with body only if OK
+ *
+ * @param[in]  sd       Restconf stream data
+ * @param[in]  cb       Reply body of framed messages, consumed, or NULL
+ * @param[in]  status   gRPC status code
+ * @param[in]  message  Error message, or NULL
+ */
+static int
+gnmi_reply(restconf_stream_data *sd,
+           cbuf                 *cb,
+           int                   status,
+           char                 *message)
+{
+    if (sd->sd_body)
+        cbuf_free(sd->sd_body);
+    sd->sd_body = cb;
+    sd->sd_body_offset = 0;
+    sd->sd_body_len = 0; /* No Content-Length */
+    sd->sd_code = 200;
+    return gnmi_status(sd, status, message);
+}
+
+/*! Translate NETCONF rpc-error of backend to gRPC status
+ *
+ * @param[in]  xerr    XML with rpc-error
+ * @param[out] status  gRPC status code
+ * @param[out] cberr   Error message
+ */
+static int
+gnmi_rpc_error(cxobj *xerr,
+               int   *status,
+               cbuf  *cberr)
+{
+    cxobj *xe;
+    char  *tag = NULL;
+    char  *msg = NULL;
+
+    if ((xe = xpath_first(xerr, NULL, "//rpc-error")) != NULL){
+        tag = xml_find_body(xe, "error-tag");
+        msg = xml_find_body(xe, "error-message");
+    }
+    if (tag == NULL || (*status = clicon_str2int(gnmi_errtag_map, tag)) < 0)
+        *status = GRPC_UNKNOWN;
+    cprintf(cberr, "%s", msg ? msg : tag ? tag : "Backend error");
+    return 0;
+}
+
+/*! Check encoding of values of a request
+ *
+ * Leaves have typed values with all supported encodings
+ * @retval  1  Supported
+ * @retval  0  Not supported, status set
+ */
+static int
+gnmi_encoding_check(int   encoding,
+                    int  *status,
+                    cbuf *cberr)
+{
+    switch (encoding){
+    case GNMI_ENC_JSON:
+    case GNMI_ENC_PROTO:
+    case GNMI_ENC_JSON_IETF:
+        return 1;
+    default:
+        break;
+    }
+    *status = GRPC_UNIMPLEMENTED;
+    cprintf(cberr, "Unsupported encoding %d", encoding);
+    return 0;
+}
+
+/*! Initialize path walk
+ *
+ * @param[in]  gw     Path walk
+ * @param[in]  yspec  Yang spec
+ * @param[in]  xtop   Build XML of path under this node, if NULL build XPath
+ */
+static int
+gnmi_walk_init(gnmi_walk *gw,
+               yang_stmt *yspec,
+               cxobj     *xtop)
+{
+    memset(gw, 0, sizeof(*gw));
+    gw->gw_yspec = yspec;
+    gw->gw_x = xtop;
+    if ((gw->gw_err = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        return -1;
+    }
+    if (xtop == NULL){
+        if ((gw->gw_xpath = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            return -1;
+        }
+        if ((gw->gw_nsc = xml_nsctx_init(NULL, NULL)) == NULL)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Free path walk
+ */
+static void
+gnmi_walk_free(gnmi_walk *gw)
+{
+    if (gw->gw_err)
+        cbuf_free(gw->gw_err);
+    if (gw->gw_xpath)
+        cbuf_free(gw->gw_xpath);
+    if (gw->gw_nsc)
+        xml_nsctx_free(gw->gw_nsc);
+}
+
+/*! Check if a yang node is a leaf or leaf-list
+ */
+static int
+gnmi_yang_leaf(yang_stmt *y)
+{
+    return y != NULL &&
+        (yang_keyword_get(y) == Y_LEAF || yang_keyword_get(y) == Y_LEAF_LIST);
+}
+
+/*! Check if a yang list has a key
+ */
+static int
+gnmi_yang_key(yang_stmt *y,
+              char      *name)
+{
+    cg_var *cvk = NULL;
+
+    while ((cvk = cvec_each(yang_cvec_get(y), cvk)) != NULL)
+        if (strcmp(cv_string_get(cvk), name) == 0)
+            return 1;
+    return 0;
+}
+
+/*! Walk a gNMI PathElem
+ *
+ * The name of an element may be prefixed with a module name, "<module>:<name>", else
+ * elements at the top are looked up in all modules.
+ * In XPath mode, missing and "*" keys are wildcards.
+ * In XML mode, the keys must be complete. Existing nodes are reused, and the last element
+ * is not created if it is a leaf or leaf-list.
+ * @param[in]  gw     Path walk
+ * @param[in]  data   PathElem message
+ * @param[in]  len    Length of message
+ * @retval     1      OK
+ * @retval     0      Invalid element, reason in gw_err
+ * @retval    -1      Error
+ */
+static int
+gnmi_walk_elem(gnmi_walk *gw,
+               uint8_t   *data,
+               size_t     len)
+{
+    int        retval = -1;
+    pb_reader  pr;
+    pb_reader  pe;
+    uint32_t   field;
+    uint64_t   val;
+    uint8_t   *d;
+    size_t     dlen;
+    cvec      *keys = NULL;
+    char      *name = NULL;
+    char      *kname = NULL;
+    char      *kval = NULL;
+    char      *mod;
+    char      *id;
+    char      *ns;
+    char      *pfx;
+    char      *str;
+    int        quote;
+    int        match;
+    yang_stmt *y = NULL;
+    yang_stmt *ymod;
+    cg_var    *cv;
+    cg_var    *cvk;
+    cxobj     *x;
+    cxobj     *xc;
+
+    if ((keys = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    pb_reader_init(&pr, data, len);
+    while (pb_next(&pr, &field, &val, &d, &dlen)){
+        if (field == 1 && d != NULL){
+            if (name)
+                free(name);
+            if ((name = pb_strdup(d, dlen)) == NULL)
+                goto done;
+        }
+        else if (field == 2 && d != NULL){ /* map<string, string> key */
+            pb_reader_init(&pe, d, dlen);
+            while (pb_next(&pe, &field, &val, &d, &dlen)){
+                if (d == NULL)
+                    continue;
+                if (field == 1){
+                    if (kname)
+                        free(kname);
+                    if ((kname = pb_strdup(d, dlen)) == NULL)
+                        goto done;
+                }
+                else if (field == 2){
+                    if (kval)
+                        free(kval);
+                    if ((kval = pb_strdup(d, dlen)) == NULL)
+                        goto done;
+                }
+            }
+            if (pe.pr_err || kname == NULL)
+                pr.pr_err = 1;
+            else if (cvec_add_string(keys, kname, kval ? kval : "") == NULL){
+                clicon_err(OE_UNIX, errno, "cvec_add_string");
+                goto done;
+            }
+            if (kname){
+                free(kname);
+                kname = NULL;
+            }
+            if (kval){
+                free(kval);
+                kval = NULL;
+            }
+        }
+    }
+    if (pr.pr_err || name == NULL){
+        cprintf(gw->gw_err, "Malformed path element");
+        goto fail;
+    }
+    if ((id = strchr(name, ':')) != NULL){
+        *id++ = '\0';
+        mod = name;
+    }
+    else {
+        id = name;
+        mod = NULL;
+    }
+    if (strcmp(id, "*") == 0 || strcmp(id, "...") == 0){
+        cprintf(gw->gw_err, "Wildcard path element %s not supported", id);
+        goto fail;
+    }
+    if (gw->gw_y == NULL){
+        ymod = NULL;
+        while ((ymod = yn_each(gw->gw_yspec, ymod)) != NULL){
+            if (yang_keyword_get(ymod) != Y_MODULE)
+                continue;
+            if (mod && strcmp(mod, yang_argument_get(ymod)) != 0)
+                continue;
+            if ((y = yang_find_datanode(ymod, id)) != NULL)
+                break;
+        }
+    }
+    else if (gnmi_yang_leaf(gw->gw_y)){
+        cprintf(gw->gw_err, "Path continues after leaf %s", yang_argument_get(gw->gw_y));
+        goto fail;
+    }
+    else
+        y = yang_find_datanode(gw->gw_y, id);
+    if (y == NULL){
+        cprintf(gw->gw_err, "Unknown path element %s", id);
+        goto fail;
+    }
+    cv = NULL;
+    while ((cv = cvec_each(keys, cv)) != NULL){
+        if (yang_keyword_get(y) != Y_LIST || !gnmi_yang_key(y, cv_name_get(cv))){
+            cprintf(gw->gw_err, "Unknown key %s of path element %s", cv_name_get(cv), id);
+            goto fail;
+        }
+    }
+    ns = yang_find_mynamespace(y);
+    if (gw->gw_xpath){
+        pfx = yang_find_myprefix(y);
+        if (xml_nsctx_get(gw->gw_nsc, pfx) == NULL &&
+            xml_nsctx_add(gw->gw_nsc, pfx, ns) < 0)
+            goto done;
+        cprintf(gw->gw_xpath, "/%s:%s", pfx, id);
+        if (yang_keyword_get(y) == Y_LIST){
+            cvk = NULL;
+            while ((cvk = cvec_each(yang_cvec_get(y), cvk)) != NULL){
+                if ((str = cvec_find_str(keys, cv_string_get(cvk))) == NULL ||
+                    strcmp(str, "*") == 0)
+                    continue;
+                quote = strchr(str, '\'') ? '"' : '\'';
+                cprintf(gw->gw_xpath, "[%s:%s=%c%s%c]", pfx, cv_string_get(cvk), quote, str, quote);
+            }
+        }
+    }
+    else if (!gnmi_yang_leaf(y)){ /* Leaves are created from values by the caller */
+        if (yang_keyword_get(y) == Y_LIST){
+            cvk = NULL;
+            while ((cvk = cvec_each(yang_cvec_get(y), cvk)) != NULL){
+                if ((str = cvec_find_str(keys, cv_string_get(cvk))) == NULL ||
+                    strcmp(str, "*") == 0){
+                    cprintf(gw->gw_err, "Wildcard or missing key %s of path element %s",
+                            cv_string_get(cvk), id);
+                    goto fail;
+                }
+            }
+        }
+        x = NULL;
+        xc = NULL;
+        while ((xc = xml_child_each(gw->gw_x, xc, CX_ELMNT)) != NULL){
+            if (xml_spec(xc) != y)
+                continue;
+            match = 1;
+            cvk = NULL;
+            while (yang_keyword_get(y) == Y_LIST &&
+                   (cvk = cvec_each(yang_cvec_get(y), cvk)) != NULL){
+                if ((str = xml_find_body(xc, cv_string_get(cvk))) == NULL ||
+                    strcmp(str, cvec_find_str(keys, cv_string_get(cvk))) != 0){
+                    match = 0;
+                    break;
+                }
+            }
+            if (match){
+                x = xc;
+                break;
+            }
+        }
+        if (x == NULL){
+            if ((x = xml_new(id, gw->gw_x, CX_ELMNT)) == NULL)
+                goto done;
+            xml_spec_set(x, y);
+            if (gw->gw_y == NULL || strcmp(ns, yang_find_mynamespace(gw->gw_y)) != 0){
+                if (xmlns_set(x, NULL, ns) < 0)
+                    goto done;
+            }
+            cvk = NULL;
+            while (yang_keyword_get(y) == Y_LIST &&
+                   (cvk = cvec_each(yang_cvec_get(y), cvk)) != NULL){
+                if ((xc = xml_new_body(cv_string_get(cvk), x,
+                                       cvec_find_str(keys, cv_string_get(cvk)))) == NULL)
+                    goto done;
+                xml_spec_set(xc, yang_find(y, Y_LEAF, cv_string_get(cvk)));
+            }
+        }
+        gw->gw_x = x;
+    }
+    gw->gw_y = y;
+    gw->gw_elems++;
+    retval = 1;
+ done:
+    if (kname)
+        free(kname);
+    if (kval)
+        free(kval);
+    if (name)
+        free(name);
+    if (keys)
+        cvec_free(keys);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Walk a gNMI Path
+ *
+ * @param[in]  gw     Path walk
+ * @param[in]  data   Path message, or NULL
+ * @param[in]  len    Length of message
+ * @retval     1      OK
+ * @retval     0      Invalid path, reason in gw_err
+ * @retval    -1      Error
+ */
+static int
+gnmi_walk_path(gnmi_walk *gw,
+               uint8_t   *data,
+               size_t     len)
+{
+    pb_reader pr;
+    uint32_t  field;
+    uint64_t  val;
+    uint8_t  *d;
+    size_t    dlen;
+    int       ret;
+
+    if (data == NULL)
+        return 1;
+    pb_reader_init(&pr, data, len);
+    while (pb_next(&pr, &field, &val, &d, &dlen)){
+        if (field == 3 && d != NULL){
+            if ((ret = gnmi_walk_elem(gw, d, dlen)) <= 0)
+                return ret;
+        }
+        else if (field == 1){
+            cprintf(gw->gw_err, "Deprecated path element field not supported");
+            return 0;
+        }
+    }
+    if (pr.pr_err){
+        cprintf(gw->gw_err, "Malformed path");
+        return 0;
+    }
+    return 1;
+}
+
+/*! Translate prefix and path of a request to XPath
+ *
+ * @param[in]  yspec   Yang spec
+ * @param[in]  prefix  Path prefix message, or NULL
+ * @param[in]  plen    Length of prefix
+ * @param[in]  path    Path message, or NULL
+ * @param[in]  len     Length of path
+ * @param[out] xpathp  XPath, "/" if no elements, free with free
+ * @param[out] nscp    Namespace context of XPath, free with xml_nsctx_free
+ * @param[out] cberr   Reason if invalid
+ * @retval     1       OK
+ * @retval     0       Invalid path
+ * @retval    -1       Error
+ */
+static int
+gnmi_xpath(yang_stmt *yspec,
+           uint8_t   *prefix,
+           size_t     plen,
+           uint8_t   *path,
+           size_t     len,
+           char     **xpathp,
+           cvec     **nscp,
+           cbuf      *cberr)
+{
+    int       retval = -1;
+    gnmi_walk gw;
+    int       ret;
+
+    if (gnmi_walk_init(&gw, yspec, NULL) < 0)
+        goto done;
+    if ((ret = gnmi_walk_path(&gw, prefix, plen)) < 0)
+        goto done;
+    if (ret == 1 && (ret = gnmi_walk_path(&gw, path, len)) < 0)
+        goto done;
+    if (ret == 0){
+        cprintf(cberr, "%s", cbuf_get(gw.gw_err));
+        goto fail;
+    }
+    if ((*xpathp = strdup(gw.gw_elems ? cbuf_get(gw.gw_xpath) : "/")) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    *nscp = gw.gw_nsc;
+    gw.gw_nsc = NULL;
+    retval = 1;
+ done:
+    gnmi_walk_free(&gw);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Select data nodes of XPath, or the top-level nodes if XPath is "/"
+ */
+static int
+gnmi_xpath_vec(cxobj   *xt,
+               char    *xpath,
+               cvec    *nsc,
+               cxobj ***vec,
+               size_t  *veclen)
+{
+    if (strcmp(xpath, "/") == 0)
+        return xpath_vec(xt, nsc, "/*", vec, veclen);
+    return xpath_vec(xt, nsc, "%s", vec, veclen, xpath);
+}
+
+/*! Append PathElem of a data node and its ancestors to a Path message
+ *
+ * Element names are prefixed with the module name at the top and where the module changes,
+ * as in JSON_IETF
+ */
+static int
+gnmi_path_elem(cbuf      *cb,
+               cxobj     *x,
+               yang_stmt *yspec)
+{
+    int        retval = -1;
+    cxobj     *xp;
+    yang_stmt *y;
+    yang_stmt *yp = NULL;
+    yang_stmt *ymod;
+    cbuf      *cbe = NULL;
+    cbuf      *cbk = NULL;
+    cbuf      *cbn = NULL;
+    cg_var    *cvk;
+    char      *ns;
+    char      *key;
+
+    if ((xp = xml_parent(x)) != NULL && (yp = xml_spec(xp)) != NULL)
+        if (gnmi_path_elem(cb, xp, yspec) < 0)
+            goto done;
+    y = xml_spec(x);
+    if ((cbe = cbuf_new()) == NULL ||
+        (cbk = cbuf_new()) == NULL ||
+        (cbn = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    ns = yang_find_mynamespace(y);
+    if (ns && (yp == NULL || clicon_strcmp(ns, yang_find_mynamespace(yp)) != 0) &&
+        (ymod = yang_find_module_by_namespace(yspec, ns)) != NULL)
+        cprintf(cbn, "%s:", yang_argument_get(ymod));
+    cprintf(cbn, "%s", xml_name(x));
+    if (pb_str(cbe, 1, cbuf_get(cbn)) < 0)
+        goto done;
+    cvk = NULL;
+    while (yang_keyword_get(y) == Y_LIST &&
+           (cvk = cvec_each(yang_cvec_get(y), cvk)) != NULL){
+        key = cv_string_get(cvk);
+        cbuf_reset(cbk);
+        if (pb_str(cbk, 1, key) < 0)
+            goto done;
+        if (pb_str(cbk, 2, xml_find_body(x, key) ? xml_find_body(x, key) : "") < 0)
+            goto done;
+        if (pb_msg(cbe, 2, cbk) < 0)
+            goto done;
+    }
+    if (pb_msg(cb, 3, cbe) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cbe)
+        cbuf_free(cbe);
+    if (cbk)
+        cbuf_free(cbk);
+    if (cbn)
+        cbuf_free(cbn);
+    return retval;
+}
+
+/*! Append the gNMI Path of a data node as a field of a message
+ *
+ * @param[in]  cb     Protobuf message
+ * @param[in]  field  Field number of Path
+ * @param[in]  x      Data node bound to yang, its data ancestors are elements of the path
+ * @param[in]  yspec  Yang spec
+ */
+static int
+gnmi_path_encode(cbuf      *cb,
+                 uint32_t   field,
+                 cxobj     *x,
+                 yang_stmt *yspec)
+{
+    int   retval = -1;
+    cbuf *cbp = NULL;
+
+    if ((cbp = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (xml_spec(x) != NULL && gnmi_path_elem(cbp, x, yspec) < 0)
+        goto done;
+    if (pb_msg(cb, field, cbp) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cbp)
+        cbuf_free(cbp);
+    return retval;
+}
+
+/*! Append typed scalar of a leaf value to a TypedValue message
+ *
+ * @param[in]  cbv   TypedValue message
+ * @param[in]  y     Yang leaf or leaf-list
+ * @param[in]  body  Value, or NULL
+ */
+static int
+gnmi_scalar_encode(cbuf      *cbv,
+                   yang_stmt *y,
+                   char      *body)
+{
+    int        retval = -1;
+    char      *origtype = NULL;
+    yang_stmt *yrestype = NULL;
+    char      *restype = NULL;
+
+    if (yang_type_get(y, &origtype, &yrestype, NULL, NULL, NULL, NULL, NULL) < 0)
+        goto done;
+    if (yrestype)
+        restype = yang_argument_get(yrestype);
+    if (restype && strcmp(restype, "empty") == 0)
+        retval = pb_str(cbv, 11, "[null]");              /* json_ietf_val */
+    else if (restype == NULL || body == NULL)
+        retval = pb_str(cbv, 1, body ? body : "");       /* string_val */
+    else if (strncmp(restype, "int", 3) == 0 && isdigit(restype[3]))
+        retval = pb_uint(cbv, 2, (uint64_t)strtoll(body, NULL, 10)); /* int_val */
+    else if (strncmp(restype, "uint", 4) == 0)
+        retval = pb_uint(cbv, 3, strtoull(body, NULL, 10)); /* uint_val */
+    else if (strcmp(restype, "boolean") == 0)
+        retval = pb_uint(cbv, 4, strcmp(body, "true") == 0); /* bool_val */
+    else if (strcmp(restype, "decimal64") == 0)
+        retval = pb_double(cbv, 14, strtod(body, NULL)); /* double_val */
+    else
+        retval = pb_str(cbv, 1, body);                   /* string_val */
+ done:
+    if (origtype)
+        free(origtype);
+    return retval;
+}
+
+/*! Append JSON value of a non-leaf data node to a TypedValue message
+ *
+ * The value is the JSON of the node without its member name, as in RFC 7951
+ * @param[in]  cbv       TypedValue message
+ * @param[in]  x         Data node
+ * @param[in]  encoding  gNMI encoding, json_val if JSON, else json_ietf_val
+ */
+static int
+gnmi_json_encode(cbuf  *cbv,
+                 cxobj *x,
+                 int    encoding)
+{
+    int   retval = -1;
+    cbuf *cbj = NULL;
+    char *s;
+    char *p;
+    char *e;
+
+    if ((cbj = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* {"<name>":<value>} or {"<name>":[<value>]} if list */
+    if (clixon_json2cbuf(cbj, x, 0, 0, 0) < 0)
+        goto done;
+    s = cbuf_get(cbj);
+    e = s + cbuf_len(cbj) - 1;
+    if ((p = strstr(s, "\":")) == NULL || *e != '}'){
+        clicon_err(OE_JSON, EINVAL, "Unexpected JSON of %s", xml_name(x));
+        goto done;
+    }
+    p += 2;
+    if (xml_spec(x) && yang_keyword_get(xml_spec(x)) == Y_LIST && *p == '[' && e[-1] == ']'){
+        p++;
+        e--;
+    }
+    if (e < p){
+        clicon_err(OE_JSON, EINVAL, "Unexpected JSON of %s", xml_name(x));
+        goto done;
+    }
+    if (pb_bytes(cbv, encoding == GNMI_ENC_JSON ? 10 : 11, p, e - p) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cbj)
+        cbuf_free(cbj);
+    return retval;
+}
+
+/*! Append the TypedValue of a data node as a field of a message
+ *
+ * @param[in]  cb        Protobuf message
+ * @param[in]  field     Field number of TypedValue
+ * @param[in]  x         Data node bound to yang
+ * @param[in]  encoding  gNMI encoding of non-leaf nodes
+ */
+static int
+gnmi_val_encode(cbuf    *cb,
+                uint32_t field,
+                cxobj   *x,
+                int      encoding)
+{
+    int   retval = -1;
+    cbuf *cbv = NULL;
+
+    if ((cbv = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (gnmi_yang_leaf(xml_spec(x))){
+        if (gnmi_scalar_encode(cbv, xml_spec(x), xml_body(x)) < 0)
+            goto done;
+    }
+    else if (gnmi_json_encode(cbv, x, encoding) < 0)
+        goto done;
+    if (pb_msg(cb, field, cbv) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cbv)
+        cbuf_free(cbv);
+    return retval;
+}
+
+/*! Append updates of data nodes to a Notification message
+ *
+ * One update per node, except that consecutive entries of a leaf-list are one update with
+ * a leaflist_val
+ * @param[in]  cbn       Notification message
+ * @param[in]  vec       Data nodes bound to yang
+ * @param[in]  veclen    Length of vec
+ * @param[in]  encoding  gNMI encoding
+ * @param[in]  yspec     Yang spec
+ */
+static int
+gnmi_updates(cbuf      *cbn,
+             cxobj    **vec,
+             size_t     veclen,
+             int        encoding,
+             yang_stmt *yspec)
+{
+    int        retval = -1;
+    cbuf      *cbu = NULL;
+    cbuf      *cbv = NULL;
+    cbuf      *cba = NULL;
+    cxobj     *x;
+    yang_stmt *y;
+    size_t     i;
+    size_t     j;
+
+    if ((cbu = cbuf_new()) == NULL ||
+        (cbv = cbuf_new()) == NULL ||
+        (cba = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (i=0; i<veclen; i=j){
+        x = vec[i];
+        j = i + 1;
+        if ((y = xml_spec(x)) == NULL)
+            continue;
+        cbuf_reset(cbu);
+        if (gnmi_path_encode(cbu, 1, x, yspec) < 0)
+            goto done;
+        if (yang_keyword_get(y) == Y_LEAF_LIST){
+            cbuf_reset(cba);
+            for (j=i; j<veclen && xml_spec(vec[j]) == y && xml_parent(vec[j]) == xml_parent(x); j++)
+                if (gnmi_val_encode(cba, 1, vec[j], encoding) < 0) /* ScalarArray element */
+                    goto done;
+            cbuf_reset(cbv);
+            if (pb_msg(cbv, 8, cba) < 0) /* leaflist_val */
+                goto done;
+            if (pb_msg(cbu, 3, cbv) < 0)
+                goto done;
+        }
+        else if (gnmi_val_encode(cbu, 3, x, encoding) < 0)
+            goto done;
+        if (pb_msg(cbn, 4, cbu) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (cbu)
+        cbuf_free(cbu);
+    if (cbv)
+        cbuf_free(cbv);
+    if (cba)
+        cbuf_free(cba);
+    return retval;
+}
+
+/*! Get data nodes selected by XPath from backend
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  xpath   XPath
+ * @param[in]  nsc     Namespace context of XPath
+ * @param[in]  content Config, state or all data
+ * @param[out] xretp   Data tree, free with xml_free
+ * @param[out] vecp    Selected nodes, free with free
+ * @param[out] veclenp Length of vec
+ * @param[out] status  gRPC status if failed
+ * @param[out] cberr   Error message if failed
+ * @retval     1       OK
+ * @retval     0       Failed
+ * @retval    -1       Error
+ */
+static int
+gnmi_select(clicon_handle     h,
+            char             *xpath,
+            cvec             *nsc,
+            netconf_content   content,
+            cxobj           **xretp,
+            cxobj          ***vecp,
+            size_t           *veclenp,
+            int              *status,
+            cbuf             *cberr)
+{
+    if (clicon_rpc_get(h, xpath, nsc, content, -1, NULL, xretp) < 0){
+        *status = GRPC_UNAVAILABLE;
+        cprintf(cberr, "%s", clicon_err_reason);
+        clicon_err_reset();
+        return 0;
+    }
+    if (xpath_first(*xretp, NULL, "//rpc-error") != NULL){
+        gnmi_rpc_error(*xretp, status, cberr);
+        return 0;
+    }
+    if (gnmi_xpath_vec(*xretp, xpath, nsc, vecp, veclenp) < 0)
+        return -1;
+    return 1;
+}
+
+/*! gNMI Capabilities RPC
+ *
+ * @param[in]  h      Clixon handle
+ * @param[out] cbout  Framed CapabilityResponse
+ */
+static int
+gnmi_capabilities(clicon_handle h,
+                  cbuf         *cbout)
+{
+    int        retval = -1;
+    cbuf      *cbr = NULL;
+    cbuf      *cbm = NULL;
+    yang_stmt *yspec;
+    yang_stmt *ymod;
+    yang_stmt *ys;
+
+    yspec = clicon_dbspec_yang(h);
+    if ((cbr = cbuf_new()) == NULL ||
+        (cbm = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    ymod = NULL;
+    while ((ymod = yn_each(yspec, ymod)) != NULL){
+        if (yang_keyword_get(ymod) != Y_MODULE)
+            continue;
+        cbuf_reset(cbm);
+        if (pb_str(cbm, 1, yang_argument_get(ymod)) < 0)
+            goto done;
+        if ((ys = yang_find(ymod, Y_ORGANIZATION, NULL)) != NULL &&
+            pb_str(cbm, 2, yang_argument_get(ys)) < 0)
+            goto done;
+        if ((ys = yang_find(ymod, Y_REVISION, NULL)) != NULL &&
+            pb_str(cbm, 3, yang_argument_get(ys)) < 0)
+            goto done;
+        if (pb_msg(cbr, 1, cbm) < 0) /* supported_models */
+            goto done;
+    }
+    if (pb_uint(cbr, 2, GNMI_ENC_JSON) < 0 ||  /* supported_encodings */
+        pb_uint(cbr, 2, GNMI_ENC_PROTO) < 0 ||
+        pb_uint(cbr, 2, GNMI_ENC_JSON_IETF) < 0)
+        goto done;
+    if (pb_str(cbr, 3, GNMI_VERSION) < 0)
+        goto done;
+    if (gnmi_frame(cbout, cbr) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cbr)
+        cbuf_free(cbr);
+    if (cbm)
+        cbuf_free(cbm);
+    return retval;
+}
+
+/*! gNMI Get RPC
+ *
+ * One notification per path, with one update per selected node
+ * @param[in]  h      Clixon handle
+ * @param[in]  msg    GetRequest
+ * @param[in]  len    Length of msg
+ * @param[out] cbout  Framed GetResponse if OK
+ * @param[out] status gRPC status
+ * @param[out] cberr  Error message if not OK
+ */
+static int
+gnmi_get(clicon_handle h,
+         uint8_t      *msg,
+         size_t        len,
+         cbuf         *cbout,
+         int          *status,
+         cbuf         *cberr)
+{
+    int             retval = -1;
+    yang_stmt      *yspec;
+    pb_reader       pr;
+    uint32_t        field;
+    uint64_t        val;
+    uint8_t        *d;
+    size_t          dlen;
+    uint8_t        *prefix = NULL;
+    size_t          plen = 0;
+    int             encoding = GNMI_ENC_JSON;
+    netconf_content content = CONTENT_ALL;
+    char           *xpath = NULL;
+    cvec           *nsc = NULL;
+    cxobj          *xret = NULL;
+    cxobj         **vec = NULL;
+    size_t          veclen;
+    cbuf           *cbr = NULL;
+    cbuf           *cbn = NULL;
+    int             ret;
+
+    yspec = clicon_dbspec_yang(h);
+    pb_reader_init(&pr, msg, len);
+    while (pb_next(&pr, &field, &val, &d, &dlen)){
+        switch (field){
+        case 1: /* prefix */
+            prefix = d;
+            plen = dlen;
+            break;
+        case 3: /* type */
+            content = val == 1 ? CONTENT_CONFIG : val == 0 ? CONTENT_ALL : CONTENT_NONCONFIG;
+            break;
+        case 5: /* encoding */
+            encoding = val;
+            break;
+        default:
+            break;
+        }
+    }
+    if (pr.pr_err){
+        *status = GRPC_INVALID_ARGUMENT;
+        cprintf(cberr, "Malformed GetRequest");
+        goto ok;
+    }
+    if (gnmi_encoding_check(encoding, status, cberr) == 0)
+        goto ok;
+    if ((cbr = cbuf_new()) == NULL ||
+        (cbn = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    pb_reader_init(&pr, msg, len);
+    while (pb_next(&pr, &field, &val, &d, &dlen)){
+        if (field != 2) /* path */
+            continue;
+        if ((ret = gnmi_xpath(yspec, prefix, plen, d, dlen, &xpath, &nsc, cberr)) < 0)
+            goto done;
+        if (ret == 0){
+            *status = GRPC_INVALID_ARGUMENT;
+            goto ok;
+        }
+        if ((ret = gnmi_select(h, xpath, nsc, content, &xret, &vec, &veclen, status, cberr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+        if (veclen == 0){
+            *status = GRPC_NOT_FOUND;
+            cprintf(cberr, "Path not found: %s", xpath);
+            goto ok;
+        }
+        cbuf_reset(cbn);
+        if (pb_uint(cbn, 1, gnmi_now()) < 0) /* timestamp */
+            goto done;
+        if (gnmi_updates(cbn, vec, veclen, encoding, yspec) < 0)
+            goto done;
+        if (pb_msg(cbr, 1, cbn) < 0) /* notification */
+            goto done;
+        free(vec);
+        vec = NULL;
+        xml_free(xret);
+        xret = NULL;
+        free(xpath);
+        xpath = NULL;
+        xml_nsctx_free(nsc);
+        nsc = NULL;
+    }
+    if (gnmi_frame(cbout, cbr) < 0)
+        goto done;
+    *status = GRPC_OK;
+ ok:
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    if (xret)
+        xml_free(xret);
+    if (xpath)
+        free(xpath);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (cbr)
+        cbuf_free(cbr);
+    if (cbn)
+        cbuf_free(cbn);
+    return retval;
+}
+
+/*! Decode a scalar TypedValue as a string
+ *
+ * @param[in]  data   TypedValue message
+ * @param[in]  len    Length of message
+ * @param[out] strp   Value, free with free
+ * @retval     1      OK
+ * @retval     0      Not a supported scalar value
+ * @retval    -1      Error
+ */
+static int
+gnmi_scalar_decode(uint8_t *data,
+                   size_t   len,
+                   char   **strp)
+{
+    pb_reader pr;
+    uint32_t  field;
+    uint64_t  val;
+    uint8_t  *d;
+    size_t    dlen;
+    pb_reader pe;
+    int64_t   digits = 0;
+    uint64_t  prec = 0;
+    uint64_t  div = 1;
+    uint64_t  absd;
+    int       i;
+    uint32_t  u32;
+    float     f;
+    double    dbl;
+    char      str[64];
+
+    pb_reader_init(&pr, data, len);
+    if (pb_next(&pr, &field, &val, &d, &dlen) == 0)
+        return 0;
+    switch (field){
+    case 1:  /* string_val */
+    case 12: /* ascii_val */
+        if (d == NULL)
+            return 0;
+        return (*strp = pb_strdup(d, dlen)) == NULL ? -1 : 1;
+        break;
+    case 2:  /* int_val */
+        snprintf(str, sizeof(str), "%" PRId64, (int64_t)val);
+        break;
+    case 3:  /* uint_val */
+        snprintf(str, sizeof(str), "%" PRIu64, val);
+        break;
+    case 4:  /* bool_val */
+        snprintf(str, sizeof(str), "%s", val ? "true" : "false");
+        break;
+    case 6:  /* float_val */
+        u32 = val;
+        memcpy(&f, &u32, sizeof(f));
+        snprintf(str, sizeof(str), "%.9g", f);
+        break;
+    case 14: /* double_val */
+        memcpy(&dbl, &val, sizeof(dbl));
+        snprintf(str, sizeof(str), "%.17g", dbl);
+        break;
+    case 7:  /* decimal_val: digits / 10^precision */
+        if (d == NULL)
+            return 0;
+        pb_reader_init(&pe, d, dlen);
+        while (pb_next(&pe, &field, &val, &d, &dlen)){
+            if (field == 1)
+                digits = (int64_t)val;
+            else if (field == 2)
+                prec = val;
+        }
+        if (pe.pr_err || prec > 18)
+            return 0;
+        for (i=0; i<prec; i++)
+            div *= 10;
+        absd = digits < 0 ? -(uint64_t)digits : (uint64_t)digits;
+        if (prec == 0)
+            snprintf(str, sizeof(str), "%s%" PRIu64, digits<0?"-":"", absd);
+        else
+            snprintf(str, sizeof(str), "%s%" PRIu64 ".%0*" PRIu64, digits<0?"-":"",
+                     absd / div, (int)prec, absd % div);
+        break;
+    default:
+        return 0;
+        break;
+    }
+    return (*strp = strdup(str)) == NULL ? -1 : 1;
+}
+
+/*! Get JSON value of a TypedValue
+ *
+ * @param[in]  data   TypedValue message
+ * @param[in]  len    Length of message
+ * @param[out] jsonp  JSON, free with free, or NULL if not JSON
+ * @param[out] array  Leaflist_val message, or NULL
+ * @param[out] alen   Length of array
+ */
+static int
+gnmi_val_decode(uint8_t  *data,
+                size_t    len,
+                char    **jsonp,
+                uint8_t **array,
+                size_t   *alen)
+{
+    pb_reader pr;
+    uint32_t  field;
+    uint64_t  val;
+    uint8_t  *d;
+    size_t    dlen;
+
+    *jsonp = NULL;
+    *array = NULL;
+    pb_reader_init(&pr, data, len);
+    if (pb_next(&pr, &field, &val, &d, &dlen) == 0 || d == NULL)
+        return 0;
+    if (field == 10 || field == 11){ /* json_val, json_ietf_val */
+        if ((*jsonp = pb_strdup(d, dlen)) == NULL)
+            return -1;
+    }
+    else if (field == 8){ /* leaflist_val */
+        *array = d;
+        *alen = dlen;
+    }
+    return 0;
+}
+
+/*! Set operation of node of a Set request
+ *
+ * @retval  1  OK
+ * @retval  0  Node already has an operation
+ */
+static int
+gnmi_set_op(cxobj *x,
+            char  *op)
+{
+    if (xml_find_type(x, NETCONF_BASE_PREFIX, "operation", CX_ATTR) != NULL)
+        return 0;
+    if (xml_add_attr(x, "operation", op, NETCONF_BASE_PREFIX, NULL) < 0)
+        return -1;
+    return 1;
+}
+
+/*! Add leaf or leaf-list nodes of a Set request, with value or operation
+ *
+ * @param[in]  gw    Path walk in XML mode, gw_x is parent and gw_y the leaf
+ * @param[in]  op    NETCONF operation
+ * @param[in]  val   TypedValue message, or NULL if delete
+ * @param[in]  vlen  Length of val
+ * @retval     1     OK
+ * @retval     0     Invalid value, reason in gw_err
+ * @retval    -1     Error
+ */
+static int
+gnmi_set_leaf(gnmi_walk *gw,
+              char      *op,
+              uint8_t   *val,
+              size_t     vlen)
+{
+    int        retval = -1;
+    yang_stmt *y = gw->gw_y;
+    yang_stmt *ymod;
+    cxobj     *xp = gw->gw_x;
+    cxobj     *x;
+    cxobj     *xerr = NULL;
+    char      *name = yang_argument_get(y);
+    char      *ns;
+    char      *json = NULL;
+    char      *str = NULL;
+    uint8_t   *array = NULL;
+    size_t     alen = 0;
+    uint8_t   *d;
+    size_t     dlen;
+    uint32_t   field;
+    uint64_t   u;
+    pb_reader  pr;
+    cbuf      *cbj = NULL;
+    int        i;
+    int        n0;
+    int        ret;
+
+    n0 = xml_child_nr(xp);
+    ns = yang_find_mynamespace(y);
+    if (val != NULL && gnmi_val_decode(val, vlen, &json, &array, &alen) < 0)
+        goto done;
+    if (json){ /* Parse {"<module>:<name>":<json>} as child of parent */
+        if ((cbj = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if ((ymod = yang_find_module_by_namespace(gw->gw_yspec, ns)) == NULL){
+            clicon_err(OE_YANG, ENOENT, "No module of namespace %s", ns);
+            goto done;
+        }
+        cprintf(cbj, "{\"%s:%s\":%s}", yang_argument_get(ymod), name, json);
+        if ((ret = clixon_json_parse_string(cbuf_get(cbj), 1,
+                                            xml_spec(xp) ? YB_PARENT : YB_MODULE,
+                                            gw->gw_yspec, &xp, &xerr)) < 0){
+            cprintf(gw->gw_err, "Invalid JSON value of %s: %s", name, clicon_err_reason);
+            clicon_err_reset();
+            goto fail;
+        }
+        if (ret == 0){
+            cprintf(gw->gw_err, "Invalid JSON value of %s", name);
+            goto fail;
+        }
+    }
+    else if (array){
+        pb_reader_init(&pr, array, alen);
+        while (pb_next(&pr, &field, &u, &d, &dlen)){
+            if (field != 1 || d == NULL)
+                continue;
+            if ((ret = gnmi_scalar_decode(d, dlen, &str)) < 0)
+                goto done;
+            if (ret == 0){
+                cprintf(gw->gw_err, "Unsupported value of %s", name);
+                goto fail;
+            }
+            if ((x = xml_new_body(name, xp, str)) == NULL)
+                goto done;
+            xml_spec_set(x, y);
+            free(str);
+            str = NULL;
+        }
+    }
+    else {
+        if (val != NULL){
+            if ((ret = gnmi_scalar_decode(val, vlen, &str)) < 0)
+                goto done;
+            if (ret == 0){
+                cprintf(gw->gw_err, "Unsupported value of %s", name);
+                goto fail;
+            }
+        }
+        if ((x = str ? xml_new_body(name, xp, str) : xml_new(name, xp, CX_ELMNT)) == NULL)
+            goto done;
+        xml_spec_set(x, y);
+    }
+    /* Namespace and operation of new nodes */
+    for (i=n0; i<xml_child_nr(xp); i++){
+        x = xml_child_i(xp, i);
+        if (xml_type(x) != CX_ELMNT)
+            continue;
+        if ((xml_spec(xp) == NULL || strcmp(ns, yang_find_mynamespace(xml_spec(xp))) != 0) &&
+            xmlns_set(x, NULL, ns) < 0)
+            goto done;
+        if (gnmi_set_op(x, op) < 0)
+            goto done;
+    }
+    retval = 1;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    if (str)
+        free(str);
+    if (json)
+        free(json);
+    if (cbj)
+        cbuf_free(cbj);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Add a node of a Set request, with value and operation
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  xtop   Config of edit-config
+ * @param[in]  prefix Path prefix message, or NULL
+ * @param[in]  plen   Length of prefix
+ * @param[in]  path   Path message
+ * @param[in]  len    Length of path
+ * @param[in]  op     NETCONF operation
+ * @param[in]  val    TypedValue message, or NULL if delete
+ * @param[in]  vlen   Length of val
+ * @param[out] cberr  Reason if invalid
+ * @retval     1      OK
+ * @retval     0      Invalid path or value
+ * @retval    -1      Error
+ */
+static int
+gnmi_set_node(clicon_handle h,
+              cxobj        *xtop,
+              uint8_t      *prefix,
+              size_t        plen,
+              uint8_t      *path,
+              size_t        len,
+              char         *op,
+              uint8_t      *val,
+              size_t        vlen,
+              cbuf         *cberr)
+{
+    int        retval = -1;
+    gnmi_walk  gw;
+    yang_stmt *yspec;
+    yang_stmt *y;
+    cxobj     *x;
+    cxobj     *xerr = NULL;
+    cxobj     *xk;
+    cxobj     *xk1;
+    cg_var    *cvk;
+    char      *json = NULL;
+    uint8_t   *array;
+    size_t     alen;
+    int        ret;
+
+    yspec = clicon_dbspec_yang(h);
+    if (gnmi_walk_init(&gw, yspec, xtop) < 0)
+        goto done;
+    if ((ret = gnmi_walk_path(&gw, prefix, plen)) < 0)
+        goto done;
+    if (ret == 1 && (ret = gnmi_walk_path(&gw, path, len)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (gw.gw_elems == 0){
+        cprintf(gw.gw_err, "Set of root not supported");
+        goto fail;
+    }
+    if (gnmi_yang_leaf(gw.gw_y)){
+        if ((ret = gnmi_set_leaf(&gw, op, val, vlen)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        goto ok;
+    }
+    x = gw.gw_x;
+    y = gw.gw_y;
+    if ((ret = gnmi_set_op(x, op)) < 0)
+        goto done;
+    if (ret == 0){
+        cprintf(gw.gw_err, "Conflicting operations on path %s", xml_name(x));
+        goto fail;
+    }
+    if (val == NULL)
+        goto ok;
+    if (gnmi_val_decode(val, vlen, &json, &array, &alen) < 0)
+        goto done;
+    if (json == NULL){
+        cprintf(gw.gw_err, "JSON value expected of %s", xml_name(x));
+        goto fail;
+    }
+    /* Members of the JSON object are children of the node */
+    if ((ret = clixon_json_parse_string(json, 1, YB_PARENT, yspec, &x, &xerr)) < 0){
+        cprintf(gw.gw_err, "Invalid JSON value of %s: %s", xml_name(x), clicon_err_reason);
+        clicon_err_reset();
+        goto fail;
+    }
+    if (ret == 0){
+        cprintf(gw.gw_err, "Invalid JSON value of %s", xml_name(x));
+        goto fail;
+    }
+    /* Keys of list entry may also be in value */
+    cvk = NULL;
+    while (yang_keyword_get(y) == Y_LIST &&
+           (cvk = cvec_each(yang_cvec_get(y), cvk)) != NULL){
+        if ((xk = xml_find_type(x, NULL, cv_string_get(cvk), CX_ELMNT)) == NULL)
+            continue;
+        xk1 = xk;
+        while ((xk1 = xml_child_each(x, xk1, CX_ELMNT)) != NULL){
+            if (strcmp(xml_name(xk1), xml_name(xk)) != 0)
+                continue;
+            if (clicon_strcmp(xml_body(xk1), xml_body(xk)) != 0){
+                cprintf(gw.gw_err, "Key %s of value does not match path", xml_name(xk));
+                goto fail;
+            }
+            if (xml_purge(xk1) < 0)
+                goto done;
+            break;
+        }
+    }
+ ok:
+    retval = 1;
+ done:
+    if (retval == 0)
+        cprintf(cberr, "%s", cbuf_get(gw.gw_err));
+    gnmi_walk_free(&gw);
+    if (xerr)
+        xml_free(xerr);
+    if (json)
+        free(json);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! gNMI Set RPC
+ *
+ * All deletes, replaces and updates are one transaction, an edit-config with autocommit
+ * @param[in]  h      Clixon handle
+ * @param[in]  msg    SetRequest
+ * @param[in]  len    Length of msg
+ * @param[out] cbout  Framed SetResponse if OK
+ * @param[out] status gRPC status
+ * @param[out] cberr  Error message if not OK
+ */
+static int
+gnmi_set(clicon_handle h,
+         uint8_t      *msg,
+         size_t        len,
+         cbuf         *cbout,
+         int          *status,
+         cbuf         *cberr)
+{
+    int        retval = -1;
+    pb_reader  pr;
+    pb_reader  pu;
+    uint32_t   field;
+    uint32_t   f;
+    uint64_t   val;
+    uint8_t   *d;
+    size_t     dlen;
+    uint8_t   *d1;
+    size_t     dlen1;
+    uint8_t   *prefix = NULL;
+    size_t     plen = 0;
+    uint8_t   *path;
+    size_t     pathlen;
+    uint8_t   *tv;
+    size_t     tvlen;
+    cxobj     *xtop = NULL;
+    cxobj     *xret = NULL;
+    cbuf      *cbx = NULL;
+    cbuf      *cbr = NULL;
+    cbuf      *cbu = NULL;
+    char      *username;
+    int        pass;
+    int        ret;
+
+    pb_reader_init(&pr, msg, len);
+    while (pb_next(&pr, &field, &val, &d, &dlen)){
+        if (field == 1){ /* prefix */
+            prefix = d;
+            plen = dlen;
+        }
+        else if (field == 6){ /* union_replace */
+            *status = GRPC_UNIMPLEMENTED;
+            cprintf(cberr, "union_replace not supported");
+            goto ok;
+        }
+    }
+    if (pr.pr_err){
+        *status = GRPC_INVALID_ARGUMENT;
+        cprintf(cberr, "Malformed SetRequest");
+        goto ok;
+    }
+    if ((xtop = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if ((cbr = cbuf_new()) == NULL ||
+        (cbu = cbuf_new()) == NULL ||
+        (cbx = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (prefix && pb_bytes(cbr, 1, prefix, plen) < 0)
+        goto done;
+    /* Deletes, then replaces, then updates */
+    for (pass=2; pass<=4; pass++){
+        pb_reader_init(&pr, msg, len);
+        while (pb_next(&pr, &field, &val, &d, &dlen)){
+            if (field != pass || d == NULL)
+                continue;
+            path = NULL;
+            pathlen = 0;
+            tv = NULL;
+            tvlen = 0;
+            if (field == 2){ /* delete */
+                path = d;
+                pathlen = dlen;
+            }
+            else { /* Update */
+                pb_reader_init(&pu, d, dlen);
+                while (pb_next(&pu, &f, &val, &d1, &dlen1)){
+                    if (f == 1){
+                        path = d1;
+                        pathlen = dlen1;
+                    }
+                    else if (f == 3){
+                        tv = d1;
+                        tvlen = dlen1;
+                    }
+                }
+                if (pu.pr_err || path == NULL || tv == NULL){
+                    *status = GRPC_INVALID_ARGUMENT;
+                    cprintf(cberr, "Path and val of update expected");
+                    goto ok;
+                }
+            }
+            if ((ret = gnmi_set_node(h, xtop, prefix, plen, path, pathlen,
+                                     field == 2 ? "remove" : field == 3 ? "replace" : "merge",
+                                     tv, tvlen, cberr)) < 0)
+                goto done;
+            if (ret == 0){
+                *status = GRPC_INVALID_ARGUMENT;
+                goto ok;
+            }
+            cbuf_reset(cbu);
+            if (pb_bytes(cbu, 2, path, pathlen) < 0)
+                goto done;
+            if (pb_uint(cbu, 4, field == 2 ? GNMI_OP_DELETE : field == 3 ? GNMI_OP_REPLACE : GNMI_OP_UPDATE) < 0)
+                goto done;
+            if (pb_msg(cbr, 2, cbu) < 0)  /* response */
+                goto done;
+        }
+    }
+    /* See api_data_write */
+    cprintf(cbx, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cbx, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cbx, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cbx, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cbx, " %s", NETCONF_MESSAGE_ID_ATTR);
+    cprintf(cbx, ">");
+    cprintf(cbx, "<edit-config");
+    cprintf(cbx, " %s:autocommit=\"true\" xmlns:%s=\"%s\"",
+            CLIXON_LIB_PREFIX, CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    cprintf(cbx, "><target><candidate /></target>");
+    cprintf(cbx, "<default-operation>none</default-operation>");
+    if (clixon_xml2cbuf(cbx, xtop, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    cprintf(cbx, "</edit-config></rpc>");
+    clicon_debug(1, "%s xml: %s", __FUNCTION__, cbuf_get(cbx));
+    if (clicon_rpc_netconf(h, cbuf_get(cbx), &xret, NULL) < 0){
+        *status = GRPC_UNAVAILABLE;
+        cprintf(cberr, "%s", clicon_err_reason);
+        clicon_err_reset();
+        goto ok;
+    }
+    if (xpath_first(xret, NULL, "//rpc-error") != NULL){
+        gnmi_rpc_error(xret, status, cberr);
+        goto ok;
+    }
+    if (pb_uint(cbr, 4, gnmi_now()) < 0) /* timestamp */
+        goto done;
+    if (gnmi_frame(cbout, cbr) < 0)
+        goto done;
+    *status = GRPC_OK;
+ ok:
+    retval = 0;
+ done:
+    if (xtop)
+        xml_free(xtop);
+    if (xret)
+        xml_free(xret);
+    if (cbx)
+        cbuf_free(cbx);
+    if (cbr)
+        cbuf_free(cbr);
+    if (cbu)
+        cbuf_free(cbu);
+    return retval;
+}
+
+/*! Free a STREAM subscription and close its backend session
+ *
+ * The backend removes the datastore-push subscription when the session is closed
+ */
+static void
+gnmi_sub_free(gnmi_sub *gb)
+{
+    if (gb->gb_s != -1){
+        clixon_event_unreg_fd(gb->gb_s, NULL);
+        close(gb->gb_s);
+    }
+    if (gb->gb_xpath)
+        free(gb->gb_xpath);
+    if (gb->gb_nsc)
+        xml_nsctx_free(gb->gb_nsc);
+    free(gb);
+}
+
+/*! Free subscribe stream and its subscriptions
+ */
+static void
+gnmi_stream_free1(gnmi_stream *gs)
+{
+    gnmi_sub *gb;
+
+    while ((gb = gs->gs_subs) != NULL){
+        DELQ(gb, gs->gs_subs, gnmi_sub *);
+        gnmi_sub_free(gb);
+    }
+    if (gs->gs_queue)
+        cbuf_free(gs->gs_queue);
+    free(gs);
+}
+
+/*! Free subscribe stream when its HTTP/2 stream is closed
+ *
+ * Free function of the reply body producer, see restconf_stream_free
+ * @param[in]  arg   Subscribe stream
+ */
+static int
+gnmi_stream_free(void *arg)
+{
+    gnmi_stream *gs = (gnmi_stream *)arg;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    gs->gs_sd = NULL;
+    if (gs->gs_busy)
+        gs->gs_removed = 1;
+    else
+        gnmi_stream_free1(gs);
+    return 0;
+}
+
+/*! Produce next part of Subscribe reply from queue
+ *
+ * @param[in]  arg   Subscribe stream
+ * @param[out] cb    Framed responses are appended
+ * @param[in]  len   Not used, all queued responses are appended
+ * @retval     2     OK, no more responses for now
+ * @retval     0     OK, end of stream
+ * @see restconf_reply_send_stream
+ */
+static int
+gnmi_stream_next(void  *arg,
+                 cbuf  *cb,
+                 size_t len)
+{
+    gnmi_stream *gs = (gnmi_stream *)arg;
+
+    if (pb_append(cb, cbuf_get(gs->gs_queue), cbuf_len(gs->gs_queue)) < 0)
+        return -1;
+    cbuf_reset(gs->gs_queue);
+    return gs->gs_end ? 0 : 2;
+}
+
+/*! End subscribe stream with status when its queue is produced, and end its subscriptions
+ *
+ * @param[in]  gs      Subscribe stream
+ * @param[in]  status  gRPC status
+ * @param[in]  message Error message, or NULL
+ * @param[in]  drop    Drop queued responses
+ */
+static int
+gnmi_stream_end(gnmi_stream *gs,
+                int          status,
+                char        *message,
+                int          drop)
+{
+    gnmi_sub *gb;
+
+    if (gs->gs_end)
+        return 0;
+    gs->gs_end = 1;
+    if (drop)
+        cbuf_reset(gs->gs_queue);
+    while ((gb = gs->gs_subs) != NULL){
+        DELQ(gb, gs->gs_subs, gnmi_sub *);
+        gnmi_sub_free(gb);
+    }
+    if (gs->gs_sd == NULL)
+        return 0;
+    if (gnmi_status(gs->gs_sd, status, message) < 0)
+        return -1;
+    if (restconf_stream_resume(gs->gs_sd) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Queue a SubscribeResponse to subscribe stream
+ *
+ * If the queue is full, the stream is ended with RESOURCE_EXHAUSTED, see
+ * CLICON_RESTCONF_STREAM_HWM
+ * @param[in]  gs   Subscribe stream
+ * @param[in]  cbr  SubscribeResponse
+ */
+static int
+gnmi_stream_queue(gnmi_stream *gs,
+                  cbuf        *cbr)
+{
+    uint32_t hwm;
+
+    if (gs->gs_end)
+        return 0;
+    hwm = clicon_option_int(gs->gs_h, "CLICON_RESTCONF_STREAM_HWM");
+    if (hwm && cbuf_len(gs->gs_queue) + cbuf_len(cbr) + 5 > hwm){
+        clicon_log(LOG_WARNING, "%s: gNMI subscriber queue full, disconnecting", __PROGRAM__);
+        return gnmi_stream_end(gs, GRPC_RESOURCE_EXHAUSTED, "Subscriber queue full", 1);
+    }
+    if (gnmi_frame(gs->gs_queue, cbr) < 0)
+        return -1;
+    if (gs->gs_sd && restconf_stream_resume(gs->gs_sd) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Make the gNMI value of a change of a yang-patch
+ *
+ * The value of the change is moved to the node of its target, and bound to yang
+ * @param[in]  h     Clixon handle
+ * @param[in]  xbot  Node of target api-path, bound to yang
+ * @param[in]  xv    Value node of edit
+ */
+static int
+gnmi_change_value(clicon_handle h,
+                  cxobj        *xbot,
+                  cxobj        *xv)
+{
+    int        retval = -1;
+    yang_stmt *y = xml_spec(xbot);
+    cxobj     *xc;
+    cxobj     *xerr = NULL;
+    cxobj     *xb;
+    int        i;
+
+    if (gnmi_yang_leaf(y)){
+        if (xml_body(xbot) == NULL && xml_body(xv) != NULL){
+            if ((xb = xml_new("body", xbot, CX_BODY)) == NULL)
+                goto done;
+            if (xml_value_set(xb, xml_body(xv)) < 0)
+                goto done;
+        }
+        goto ok;
+    }
+    i = 0;
+    while ((xc = xml_child_i(xv, i)) != NULL){
+        if ((xml_type(xc) == CX_ATTR &&
+             clicon_strcmp(xml_prefix(xc), "xmlns") != 0) || /* Only prefix declarations */
+            (xml_type(xc) == CX_ELMNT && yang_keyword_get(y) == Y_LIST &&
+             gnmi_yang_key(y, xml_name(xc)))){              /* Keys are set from target */
+            i++;
+            continue;
+        }
+        if (xml_addsub(xbot, xc) < 0)
+            goto done;
+    }
+    if (xml_bind_yang(h, xbot, YB_PARENT, NULL, &xerr) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! Append updates and deletes of a push-change-update notification to a Notification
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  cbn  Notification message
+ * @param[in]  xu   push-change-update
+ * @param[in]  enc  gNMI encoding
+ */
+static int
+gnmi_changes(clicon_handle h,
+             cbuf         *cbn,
+             cxobj        *xu,
+             int           enc)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    yang_stmt *ybot;
+    cxobj    **vec = NULL;
+    size_t     veclen;
+    cxobj     *xtop = NULL;
+    cxobj     *xbot;
+    cxobj     *xerr = NULL;
+    cxobj     *xv;
+    cbuf      *cbu = NULL;
+    char      *op;
+    char      *target;
+    size_t     i;
+    int        ret;
+
+    yspec = clicon_dbspec_yang(h);
+    if ((cbu = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (xpath_vec(xu, NULL, "datastore-changes/yang-patch/edit", &vec, &veclen) < 0)
+        goto done;
+    for (i=0; i<veclen; i++){
+        if ((op = xml_find_body(vec[i], "operation")) == NULL ||
+            (target = xml_find_body(vec[i], "target")) == NULL)
+            continue;
+        if ((xtop = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        if ((ret = api_path2xml(target, yspec, xtop, YC_DATANODE, 1, &xbot, &ybot, &xerr)) < 0)
+            goto done;
+        if (ret == 0 || xml_spec(xbot) == NULL){
+            clicon_debug(1, "%s skip %s", __FUNCTION__, target);
+        }
+        else if (strcmp(op, "delete") == 0){
+            if (gnmi_path_encode(cbn, 5, xbot, yspec) < 0) /* delete */
+                goto done;
+        }
+        else if ((xv = xpath_first(vec[i], NULL, "value")) != NULL &&
+                 (xv = xml_child_i_type(xv, 0, CX_ELMNT)) != NULL){
+            if (gnmi_change_value(h, xbot, xv) < 0)
+                goto done;
+            cbuf_reset(cbu);
+            if (gnmi_path_encode(cbu, 1, xbot, yspec) < 0)
+                goto done;
+            if (gnmi_val_encode(cbu, 3, xbot, enc) < 0)
+                goto done;
+            if (pb_msg(cbn, 4, cbu) < 0) /* update */
+                goto done;
+        }
+        xml_free(xtop);
+        xtop = NULL;
+        if (xerr){
+            xml_free(xerr);
+            xerr = NULL;
+        }
+    }
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    if (xtop)
+        xml_free(xtop);
+    if (xerr)
+        xml_free(xerr);
+    if (cbu)
+        cbuf_free(cbu);
+    return retval;
+}
+
+/*! Translate datastore-push notification of a subscription to a SubscribeResponse
+ *
+ * @param[in]  gb   STREAM subscription
+ * @param[in]  xn   Notification
+ */
+static int
+gnmi_sub_notify(gnmi_sub *gb,
+                cxobj    *xn)
+{
+    int           retval = -1;
+    gnmi_stream  *gs = gb->gb_stream;
+    clicon_handle h = gs->gs_h;
+    yang_stmt    *yspec;
+    cxobj        *xu;
+    cxobj        *xc = NULL;
+    cxobj        *xerr = NULL;
+    cxobj       **vec = NULL;
+    size_t        veclen = 0;
+    cbuf         *cbn = NULL;
+    cbuf         *cbr = NULL;
+    size_t        len0;
+
+    yspec = clicon_dbspec_yang(h);
+    if ((cbn = cbuf_new()) == NULL ||
+        (cbr = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (pb_uint(cbn, 1, gnmi_now()) < 0) /* timestamp */
+        goto done;
+    len0 = cbuf_len(cbn);
+    if ((xu = xpath_first(xn, NULL, "push-update")) != NULL){
+        /* Sample of selected nodes from the top */
+        if ((xc = xpath_first(xu, NULL, "datastore-contents")) == NULL)
+            goto ok;
+        if (xml_rm(xc) < 0)
+            goto done;
+        if (xml_bind_yang(h, xc, YB_MODULE, yspec, &xerr) < 0)
+            goto done;
+        if (gnmi_xpath_vec(xc, gb->gb_xpath, gb->gb_nsc, &vec, &veclen) < 0)
+            goto done;
+        if (gnmi_updates(cbn, vec, veclen, gs->gs_encoding, yspec) < 0)
+            goto done;
+    }
+    else if ((xu = xpath_first(xn, NULL, "push-change-update")) != NULL){
+        if (gnmi_changes(h, cbn, xu, gs->gs_encoding) < 0)
+            goto done;
+    }
+    if (cbuf_len(cbn) == len0) /* No updates */
+        goto ok;
+    if (pb_msg(cbr, 1, cbn) < 0) /* update */
+        goto done;
+    if (gnmi_stream_queue(gs, cbr) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    if (xc)
+        xml_free(xc);
+    if (xerr)
+        xml_free(xerr);
+    if (cbn)
+        cbuf_free(cbn);
+    if (cbr)
+        cbuf_free(cbr);
+    return retval;
+}
+
+/*! Callback when datastore-push notifications of a subscription arrive from backend
+ *
+ * @param[in]  s    Backend session socket
+ * @param[in]  arg  STREAM subscription
+ */
+static int
+gnmi_sub_cb(int   s,
+            void *arg)
+{
+    int                retval = -1;
+    gnmi_sub          *gb = (gnmi_sub *)arg;
+    gnmi_stream       *gs = gb->gb_stream;
+    struct clicon_msg *reply = NULL;
+    cxobj             *xtop = NULL;
+    cxobj             *xn;
+    int                eof;
+    int                ret;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (clicon_msg_rcv(s, NULL, 0, &reply, &eof) < 0)
+        goto done;
+    gs->gs_busy++;
+    if (eof){
+        clixon_event_unreg_fd(s, gnmi_sub_cb);
+        close(s);
+        gb->gb_s = -1;
+        if (gnmi_stream_end(gs, GRPC_UNAVAILABLE, "Subscription ended by backend", 0) < 0)
+            goto busy;
+        goto ok;
+    }
+    if ((ret = clicon_msg_decode(reply, NULL, NULL, &xtop, NULL)) < 0)
+        goto busy;
+    if (ret == 0){
+        clicon_err(OE_XML, EFAULT, "Invalid notification");
+        goto busy;
+    }
+    if ((xn = xpath_first(xtop, NULL, "notification")) != NULL &&
+        gnmi_sub_notify(gb, xn) < 0)
+        goto busy;
+ ok:
+    retval = 0;
+ busy:
+    if (--gs->gs_busy == 0 && gs->gs_removed)
+        gnmi_stream_free1(gs);
+ done:
+    clicon_debug(1, "%s retval: %d", __FUNCTION__, retval);
+    if (xtop != NULL)
+        xml_free(xtop);
+    if (reply)
+        free(reply);
+    return retval;
+}
+
+/*! Make STREAM subscription with datastore-push in its own backend session
+ *
+ * @param[in]  gs      Subscribe stream
+ * @param[in]  xpath   XPath of subscription path, consumed
+ * @param[in]  nsc     Namespace context of XPath, consumed
+ * @param[in]  period  Period in centiseconds if SAMPLE, 0 if on-change
+ * @param[out] status  gRPC status if failed
+ * @param[out] cberr   Error message if failed
+ * @retval     1       OK
+ * @retval     0       Failed
+ * @retval    -1       Error
+ */
+static int
+gnmi_sub_push(gnmi_stream *gs,
+              char        *xpath,
+              cvec        *nsc,
+              uint32_t     period,
+              int         *status,
+              cbuf        *cberr)
+{
+    int        retval = -1;
+    clicon_handle h = gs->gs_h;
+    gnmi_sub  *gb = NULL;
+    cbuf      *cb = NULL;
+    cxobj     *xret = NULL;
+    char      *username;
+    int        s = -1;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s>", NETCONF_MESSAGE_ID_ATTR);
+    cprintf(cb, "<datastore-push xmlns=\"%s\"><datastore-xpath-filter", CLIXON_LIB_NS);
+    if (xml_nsctx_cbuf(cb, nsc) < 0)
+        goto done;
+    cprintf(cb, ">");
+    xml_chardata_cbuf_append(cb, xpath);
+    cprintf(cb, "</datastore-xpath-filter>");
+    if (period)
+        cprintf(cb, "<period>%u</period>", period);
+    cprintf(cb, "</datastore-push></rpc>");
+    if (clicon_rpc_netconf(h, cbuf_get(cb), &xret, &s) < 0){
+        *status = GRPC_UNAVAILABLE;
+        cprintf(cberr, "%s", clicon_err_reason);
+        clicon_err_reset();
+        goto fail;
+    }
+    if (xpath_first(xret, NULL, "rpc-reply/rpc-error") != NULL){
+        gnmi_rpc_error(xret, status, cberr);
+        goto fail;
+    }
+    if ((gb = malloc(sizeof(*gb))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(gb, 0, sizeof(*gb));
+    gb->gb_stream = gs;
+    gb->gb_s = s;
+    gb->gb_xpath = xpath;
+    gb->gb_nsc = nsc;
+    xpath = NULL;
+    nsc = NULL;
+    s = -1;
+    ADDQ(gb, gs->gs_subs);
+    if (clixon_event_reg_fd(gb->gb_s, gnmi_sub_cb, gb, "gnmi subscribe socket") < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (s != -1)
+        close(s);
+    if (xpath)
+        free(xpath);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (xret)
+        xml_free(xret);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! gNMI Subscribe RPC
+ *
+ * The initial updates and sync_response are queued, and the reply body is produced from the
+ * queue. ONCE ends the stream after sync_response, STREAM subscriptions are datastore-push
+ * subscriptions until the client closes the stream.
+ * Only the first SubscribeRequest of the stream is handled.
+ * @param[in]  h        Clixon handle
+ * @param[in]  sd       Restconf stream data
+ * @param[in]  msg      SubscribeRequest
+ * @param[in]  len      Length of msg
+ * @param[out] status   gRPC status
+ * @param[out] cberr    Error message if not OK
+ * @param[out] streamed Reply is a streamed body
+ */
+static int
+gnmi_subscribe(clicon_handle         h,
+               restconf_stream_data *sd,
+               uint8_t              *msg,
+               size_t                len,
+               int                  *status,
+               cbuf                 *cberr,
+               int                  *streamed)
+{
+    int          retval = -1;
+    yang_stmt   *yspec;
+    pb_reader    pr;
+    pb_reader    ps;
+    uint32_t     field;
+    uint64_t     val;
+    uint8_t     *d;
+    size_t       dlen;
+    uint8_t     *list = NULL;
+    size_t       listlen = 0;
+    uint8_t     *prefix = NULL;
+    size_t       plen = 0;
+    uint8_t     *path;
+    size_t       pathlen;
+    int          mode = GNMI_STREAM;
+    int          submode;
+    uint64_t     interval;
+    uint32_t     period;
+    int          encoding = GNMI_ENC_JSON;
+    int          updates_only = 0;
+    gnmi_stream *gs = NULL;
+    char        *xpath = NULL;
+    cvec        *nsc = NULL;
+    cxobj       *xret = NULL;
+    cxobj      **vec = NULL;
+    size_t       veclen;
+    cbuf        *cbr = NULL;
+    cbuf        *cbn = NULL;
+    int          ret;
+
+    yspec = clicon_dbspec_yang(h);
+    pb_reader_init(&pr, msg, len);
+    while (pb_next(&pr, &field, &val, &d, &dlen)){
+        if (field == 1){
+            list = d;
+            listlen = dlen;
+        }
+        else if (field == 3){
+            *status = GRPC_UNIMPLEMENTED;
+            cprintf(cberr, "Poll not supported");
+            goto ok;
+        }
+    }
+    if (pr.pr_err || list == NULL){
+        *status = GRPC_INVALID_ARGUMENT;
+        cprintf(cberr, "SubscriptionList expected");
+        goto ok;
+    }
+    pb_reader_init(&pr, list, listlen);
+    while (pb_next(&pr, &field, &val, &d, &dlen)){
+        switch (field){
+        case 1:
+            prefix = d;
+            plen = dlen;
+            break;
+        case 5:
+            mode = val;
+            break;
+        case 8:
+            encoding = val;
+            break;
+        case 9:
+            updates_only = val != 0;
+            break;
+        default:
+            break;
+        }
+    }
+    if (pr.pr_err){
+        *status = GRPC_INVALID_ARGUMENT;
+        cprintf(cberr, "Malformed SubscriptionList");
+        goto ok;
+    }
+    if (mode != GNMI_STREAM && mode != GNMI_ONCE){
+        *status = GRPC_UNIMPLEMENTED;
+        cprintf(cberr, "Subscription list mode %d not supported", mode);
+        goto ok;
+    }
+    if (gnmi_encoding_check(encoding, status, cberr) == 0)
+        goto ok;
+    if ((cbr = cbuf_new()) == NULL ||
+        (cbn = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((gs = malloc(sizeof(*gs))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(gs, 0, sizeof(*gs));
+    gs->gs_h = h;
+    gs->gs_sd = sd;
+    gs->gs_encoding = encoding;
+    if ((gs->gs_queue = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    pb_reader_init(&pr, list, listlen);
+    while (pb_next(&pr, &field, &val, &d, &dlen)){
+        if (field != 2 || d == NULL) /* subscription */
+            continue;
+        path = NULL;
+        pathlen = 0;
+        submode = 0;
+        interval = 0;
+        pb_reader_init(&ps, d, dlen);
+        while (pb_next(&ps, &field, &val, &d, &dlen)){
+            if (field == 1){
+                path = d;
+                pathlen = dlen;
+            }
+            else if (field == 2)
+                submode = val;
+            else if (field == 3)
+                interval = val;
+        }
+        if (ps.pr_err){
+            *status = GRPC_INVALID_ARGUMENT;
+            cprintf(cberr, "Malformed Subscription");
+            goto ok;
+        }
+        if ((ret = gnmi_xpath(yspec, prefix, plen, path, pathlen, &xpath, &nsc, cberr)) < 0)
+            goto done;
+        if (ret == 0){
+            *status = GRPC_INVALID_ARGUMENT;
+            goto ok;
+        }
+        if (!updates_only){
+            if ((ret = gnmi_select(h, xpath, nsc, CONTENT_ALL, &xret, &vec, &veclen, status, cberr)) < 0)
+                goto done;
+            if (ret == 0)
+                goto ok;
+            if (veclen){
+                cbuf_reset(cbn);
+                cbuf_reset(cbr);
+                if (pb_uint(cbn, 1, gnmi_now()) < 0) /* timestamp */
+                    goto done;
+                if (gnmi_updates(cbn, vec, veclen, encoding, yspec) < 0)
+                    goto done;
+                if (pb_msg(cbr, 1, cbn) < 0) /* update */
+                    goto done;
+                if (gnmi_frame(gs->gs_queue, cbr) < 0)
+                    goto done;
+            }
+            free(vec);
+            vec = NULL;
+            xml_free(xret);
+            xret = NULL;
+        }
+        if (mode == GNMI_STREAM){
+            period = 0;
+            if (submode == GNMI_SAMPLE){ /* Nanoseconds to centiseconds */
+                if (interval == 0)
+                    period = GNMI_SAMPLE_DEFAULT;
+                else if ((period = interval / 10000000ULL) == 0)
+                    period = 1;
+            }
+            ret = gnmi_sub_push(gs, xpath, nsc, period, status, cberr);
+            xpath = NULL; /* consumed */
+            nsc = NULL;
+            if (ret < 0)
+                goto done;
+            if (ret == 0)
+                goto ok;
+        }
+        else {
+            free(xpath);
+            xpath = NULL;
+            xml_nsctx_free(nsc);
+            nsc = NULL;
+        }
+    }
+    cbuf_reset(cbr);
+    if (pb_uint(cbr, 3, 1) < 0) /* sync_response */
+        goto done;
+    if (gnmi_frame(gs->gs_queue, cbr) < 0)
+        goto done;
+    gs->gs_end = (mode == GNMI_ONCE);
+    /* The reply body is produced from the queue */
+    if (gnmi_status(sd, GRPC_OK, NULL) < 0)
+        goto done;
+    if (sd->sd_body)
+        cbuf_free(sd->sd_body);
+    if ((sd->sd_body = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    sd->sd_code = 200;
+    sd->sd_body_offset = 0;
+    sd->sd_body_len = 0; /* Unknown, no Content-Length */
+    sd->sd_body_fn = gnmi_stream_next;
+    sd->sd_body_arg = gs;
+    sd->sd_body_free = gnmi_stream_free;
+    gs = NULL;
+    *streamed = 1;
+    *status = GRPC_OK;
+ ok:
+    retval = 0;
+ done:
+    if (gs)
+        gnmi_stream_free1(gs);
+    if (vec)
+        free(vec);
+    if (xret)
+        xml_free(xret);
+    if (xpath)
+        free(xpath);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (cbr)
+        cbuf_free(cbr);
+    if (cbn)
+        cbuf_free(cbn);
+    return retval;
+}
+
+/*! Check if uri path denotes a gNMI RPC
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     1    Yes, a gNMI path and CLICON_RESTCONF_GNMI is set
+ * @retval     0    No
+ */
+int
+api_path_is_gnmi(clicon_handle h)
+{
+    int   retval = 0;
+    char *path = NULL;
+
+    if (!clicon_option_bool(h, "CLICON_RESTCONF_GNMI"))
+        goto done;
+    if ((path = restconf_uripath(h)) == NULL)
+        goto done;
+    if (strncmp(path, GNMI_SERVICE_PATH, strlen(GNMI_SERVICE_PATH)) != 0)
+        goto done;
+    retval = 1;
+ done:
+    if (path)
+        free(path);
+    return retval;
+}
+
+/*! Check if the first gRPC message of a request is received
+ *
+ * A bidirectional stream, such as Subscribe, is replied to before the end of the request
+ * @param[in]  sd   Restconf stream data
+ * @retval     1    Yes
+ * @retval     0    No
+ */
+int
+gnmi_request_ready(restconf_stream_data *sd)
+{
+    uint8_t *msg;
+    size_t   len;
+    int      compressed;
+
+    return gnmi_request_msg(sd, &msg, &len, &compressed);
+}
+
+/*! Process a gNMI RPC request over HTTP/2
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  req   Generic Www handle, restconf stream data
+ * The gRPC status is sent in trailers, and the reply has a body only if OK.
+ * Errors of HTTP, such as method and content-type, are HTTP status codes.
+ */
+int
+api_gnmi(clicon_handle h,
+         void         *req)
+{
+    int                   retval = -1;
+    restconf_stream_data *sd = (restconf_stream_data *)req;
+    char                 *method;
+    char                 *ctype;
+    char                 *rpc;
+    uint8_t              *msg;
+    size_t                len;
+    int                   compressed;
+    int                   status = GRPC_OK;
+    int                   streamed = 0;
+    cbuf                 *cbout = NULL;
+    cbuf                 *cberr = NULL;
+    int                   ret;
+
+    clicon_debug(1, "%s %s", __FUNCTION__, sd->sd_path);
+    method = restconf_param_get(h, "REQUEST_METHOD");
+    if (method == NULL || strcmp(method, "POST") != 0){
+        if (restconf_method_notallowed(h, req, "POST", 0, YANG_DATA_JSON) < 0)
+            goto done;
+        goto ok;
+    }
+    ctype = restconf_param_get(h, "HTTP_CONTENT_TYPE");
+    if (ctype == NULL || strncmp(ctype, "application/grpc", strlen("application/grpc")) != 0){
+        if (restconf_unsupported_media(h, req, 0, YANG_DATA_JSON) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((cbout = cbuf_new()) == NULL ||
+        (cberr = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* If present, check credentials. See "plugin_credentials" in plugin */
+    if ((ret = restconf_authentication_cb(h, req, 0, YANG_DATA_JSON)) < 0)
+        goto done;
+    if (ret == 0){ /* Replace restconf error reply */
+        cvec_reset(sd->sd_outp_hdrs);
+        status = GRPC_UNAUTHENTICATED;
+        cprintf(cberr, "The requested URL was unauthorized");
+    }
+    /* Header field names are lowercase in HTTP/2 */
+    if (restconf_reply_header(sd, "content-type", "application/grpc") < 0)
+        goto done;
+    if (status != GRPC_OK)
+        goto reply;
+    if (gnmi_request_msg(sd, &msg, &len, &compressed) == 0){
+        status = GRPC_INVALID_ARGUMENT;
+        cprintf(cberr, "Incomplete gRPC message");
+        goto reply;
+    }
+    if (compressed){
+        status = GRPC_UNIMPLEMENTED;
+        cprintf(cberr, "Compressed gRPC messages not supported");
+        goto reply;
+    }
+    rpc = sd->sd_path + strlen(GNMI_SERVICE_PATH);
+    if (strcmp(rpc, "Capabilities") == 0){
+        if (gnmi_capabilities(h, cbout) < 0)
+            goto done;
+    }
+    else if (strcmp(rpc, "Get") == 0){
+        if (gnmi_get(h, msg, len, cbout, &status, cberr) < 0)
+            goto done;
+    }
+    else if (strcmp(rpc, "Set") == 0){
+        if (gnmi_set(h, msg, len, cbout, &status, cberr) < 0)
+            goto done;
+    }
+    else if (strcmp(rpc, "Subscribe") == 0){
+        if (gnmi_subscribe(h, sd, msg, len, &status, cberr, &streamed) < 0)
+            goto done;
+        if (streamed)
+            goto ok;
+    }
+    else {
+        status = GRPC_UNIMPLEMENTED;
+        cprintf(cberr, "Unknown gNMI RPC %s", rpc);
+    }
+ reply:
+    if (gnmi_reply(sd, status == GRPC_OK ? cbout : NULL, status, cbuf_get(cberr)) < 0)
+        goto done;
+    if (status == GRPC_OK)
+        cbout = NULL; /* consumed */
+ ok:
+    retval = 0;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (cbout)
+        cbuf_free(cbout);
+    if (cberr)
+        cbuf_free(cberr);
+    return retval;
+}
@@ -0,0 +1,52 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * gNMI over gRPC on the native HTTP/2 server, see CLICON_RESTCONF_GNMI
+ */
+#ifndef _RESTCONF_GNMI_H_
+#define _RESTCONF_GNMI_H_
+
+/*
+ * Constants
+ */
+/* Path prefix of gNMI service RPCs, followed by the RPC name, eg /gnmi.gNMI/Get */
+#define GNMI_SERVICE_PATH "/gnmi.gNMI/"
+
+/*
+ * Prototypes
+ */
+int api_path_is_gnmi(clicon_handle h);
+int gnmi_request_ready(restconf_stream_data *sd);
+int api_gnmi(clicon_handle h, void *req);
+
+#endif  /* _RESTCONF_GNMI_H_ */
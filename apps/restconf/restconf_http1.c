@@ -42,6 +42,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <strings.h>
 #include <inttypes.h>
 #include <syslog.h>
 #include <errno.h>
@@ -64,6 +65,8 @@
 #include "restconf_native.h"
 #include "restconf_api.h"
 #include "restconf_err.h"
+#include "restconf_stream.h"
+#include "restconf_metrics.h"
 #include "clixon_http1_parse.h"
 #include "restconf_http1.h"
 #include "clixon_http_data.h"
@@ -292,6 +295,53 @@ http1_upgrade_http2(clicon_handle         h,
 }
 #endif /* HAVE_LIBNGHTTP2 */
 
+/*! Check if an option is in a comma-separated Connection header value
+ *
+ * @param[in]  val   Connection header value
+ * @param[in]  opt   Connection option, eg close
+ * @retval     1     Option found
+ * @retval     0     Option not found
+ */
+static int
+http1_connection_option(const char *val,
+                        const char *opt)
+{
+    size_t len = strlen(opt);
+
+    while (*val != '\0'){
+        while (*val == ',' || *val == ' ' || *val == '\t')
+            val++;
+        if (strncasecmp(val, opt, len) == 0 &&
+            (val[len] == '\0' || val[len] == ',' || val[len] == ' ' || val[len] == '\t'))
+            return 1;
+        while (*val != '\0' && *val != ',')
+            val++;
+    }
+    return 0;
+}
+
+/*! Check if an HTTP/1 connection is persistent after this request
+ *
+ * HTTP/1.1 connections are persistent unless the client sends "Connection: close".
+ * HTTP/1.0 connections are persistent only if the client sends "Connection: keep-alive"
+ * @param[in]  h    Clixon handle
+ * @param[in]  rc   Restconf connection
+ * @retval     1    Keep connection open after the reply
+ * @retval     0    Close connection after the reply
+ * @see RFC 7230 Sec 6.3
+ */
+static int
+http1_keepalive(clicon_handle  h,
+                restconf_conn *rc)
+{
+    char *val;
+
+    val = restconf_param_get(h, "HTTP_CONNECTION");
+    if (rc->rc_proto == HTTP_10)
+        return val != NULL && http1_connection_option(val, "keep-alive");
+    return val == NULL || !http1_connection_option(val, "close");
+}
+
 /*! Construct an HTTP/1 reply (dont actually send it)
  */
 static int
@@ -308,16 +358,23 @@ restconf_http1_reply(restconf_conn        *rc,
      * server MUST NOT send a Content-Length header field in any 2xx
      * (Successful) response to a CONNECT request (Section 4.3.6 of
      * [RFC7231]).
+     * Nor in a 304 (Not Modified) since there is no body, see api_data_get_conditional
+     * Nor if the body is streamed, then it ends when the connection is closed
      */
-    if (sd->sd_code != 204 && sd->sd_code > 199)
+    if (sd->sd_code != 204 && sd->sd_code != 304 && sd->sd_code > 199 && sd->sd_body_fn == NULL)
         if (restconf_reply_header(sd, "Content-Length", "%zu", sd->sd_body_len) < 0)
             goto done;  
     /* Create reply and write headers */
-#if 0 /* XXX need some keep-alive logic here */
-    /* protocol is HTTP/1.0 and clients wants to keep established */
-    if (restconf_reply_header(sd, "Connection", "keep-alive") < 0)
-        goto done;
-#endif
+    /* Persistent connections, see http1_keepalive */
+    if (sd->sd_code > 199){
+        if (rc->rc_close || rc->rc_exit){
+            if (restconf_reply_header(sd, "Connection", "close") < 0)
+                goto done;
+        }
+        else if (rc->rc_proto == HTTP_10)
+            if (restconf_reply_header(sd, "Connection", "keep-alive") < 0)
+                goto done;
+    }
     cprintf(sd->sd_outp_buf, "HTTP/%u.%u %u %s\r\n",
             rc->rc_proto_d1,
             rc->rc_proto_d2,
@@ -328,15 +385,8 @@ restconf_http1_reply(restconf_conn        *rc,
     while ((cv = cvec_each(sd->sd_outp_hdrs, cv)) != NULL)
         cprintf(sd->sd_outp_buf, "%s: %s\r\n", cv_name_get(cv), cv_string_get(cv));
     cprintf(sd->sd_outp_buf, "\r\n");
-    /* Write a body */
-    if (sd->sd_body){
-        if (cbuf_append_buf(sd->sd_outp_buf, cbuf_get(sd->sd_body), cbuf_len(sd->sd_body)) < 0){
-            clicon_err(OE_RESTCONF, errno, "cbuf_append_buf");
-            goto done;
-        }
-        cbuf_free(sd->sd_body);
-        sd->sd_body = NULL;
-    }
+    /* The body is not appended, it is written from sd_body after the headers, see
+     * native_reply_write */
     retval = 0;
  done:
     return retval;
@@ -360,6 +410,9 @@ restconf_http1_path_root(clicon_handle  h,
 #ifdef HAVE_LIBNGHTTP2
     int                   ret;
 #endif
+#ifdef RESTCONF_METRICS
+    restconf_native_handle *rn;
+#endif
     
     clicon_debug(1, "------------");
     pretty = restconf_pretty_get(h);
@@ -401,6 +454,7 @@ restconf_http1_path_root(clicon_handle  h,
         rc->rc_proto = HTTP_10;
     else if (rc->rc_proto_d2 == 1 && rc->rc_proto != HTTP_10)
         rc->rc_proto = HTTP_11;
+    rc->rc_close = !http1_keepalive(h, rc);
     if (rc->rc_ssl != NULL){
         /* Slightly awkward way of taking SSL cert subject and CN and add it to restconf parameters
          * instead of accessing it directly 
@@ -430,18 +484,29 @@ restconf_http1_path_root(clicon_handle  h,
     /* Matching algorithm:
      * 1. try well-known
      * 2. try /restconf
-     * 3. try /data
-     * 4. call restconf anyway (because it handles errors a la restconf)
+     * 3. try /streams
+     * 4. try /data
+     * 5. call restconf anyway (because it handles errors a la restconf)
      * This is for the situation where data is / and /restconf is more specific
      */
     if (strcmp(sd->sd_path, RESTCONF_WELL_KNOWN) == 0){
         if (api_well_known(h, sd) < 0)
             goto done;
     }
+#ifdef RESTCONF_METRICS
+    else if (strcmp(sd->sd_path, RESTCONF_METRICS_PATH) == 0){
+        if (api_metrics(h, sd, (rn = restconf_native_handle_get(h)) ? rn->rn_worker : 0) < 0)
+            goto done;
+    }
+#endif
     else if (api_path_is_restconf(h)){
         if (api_root_restconf(h, sd, sd->sd_qvec) < 0)
             goto done;
     }
+    else if (api_path_is_stream(h)){
+        if (api_stream(h, sd, sd->sd_qvec, NULL) < 0)
+            goto done;
+    }
     else if (api_path_is_data(h)){
         if (api_http_data(h, sd, sd->sd_qvec) < 0)
             goto done;
@@ -449,8 +514,12 @@ restconf_http1_path_root(clicon_handle  h,
     else
         sd->sd_code = 404; /* catch all without body/media */
  fail:
+    if (restconf_metrics_end(h, sd) < 0)
+        goto done;
    if (restconf_param_del_all(h) < 0)
         goto done;
+    /* Free pooled objects beyond what the requests since the last trim needed */
+    clixon_pool_trim();
 #ifdef HAVE_LIBNGHTTP2
  upgrade:
 #endif
@@ -64,8 +64,8 @@
 /* clicon */
 #include <clixon/clixon.h>
 
-#include "restconf_api.h"
 #include "restconf_lib.h"
+#include "restconf_api.h"
 #include "restconf_err.h"
 #include "restconf_handle.h"
 
@@ -208,6 +208,7 @@ static const map_str2int http_media_map[] = {
     {"application/yang-patch+xml",       YANG_PATCH_XML},
     {"application/yang-patch+json",      YANG_PATCH_JSON},
     {"application/yang-data+xml-list",  YANG_PAGINATION_XML},  /* draft-wwlh-netconf-list-pagination-rc-02 */
+    {"application/yang-data+cbor",       YANG_DATA_CBOR},       /* RFC 9254 */
     {NULL,                            -1}
 };
 
@@ -277,6 +278,35 @@ restconf_content_type(clicon_handle h)
     return m;
 }
 
+/*! Parse input data of request in YANG-CBOR
+ *
+ * The data is binary and its length is given by RESTCONF_INDATA_LEN, see api_root_restconf
+ * @param[in]     h     Clixon handle
+ * @param[in]     data  Input data
+ * @param[in]     yb    How to bind yang to XML top-level when parsing
+ * @param[in]     yspec Yang specification
+ * @param[in,out] xt    Pointer to XML parse tree. If empty will be created.
+ * @param[out]    xerr  Reason for invalid returned as netconf err msg
+ * @retval        1     OK and valid
+ * @retval        0     Invalid
+ * @retval       -1     Error with clicon_err called
+ * @see clixon_cbor_parse_buf
+ */
+int
+restconf_cbor_parse(clicon_handle h,
+                    char         *data,
+                    yang_bind     yb,
+                    yang_stmt    *yspec,
+                    cxobj       **xt,
+                    cxobj       **xerr)
+{
+    int len;
+
+    if ((len = clicon_data_int_get(h, RESTCONF_INDATA_LEN)) < 0)
+        len = strlen(data);
+    return clixon_cbor_parse_buf(data, len, yb, yspec, xt, xerr);
+}
+
 /*! Translate http header by capitalizing, prepend w HTTP_ and - -> _
  *
  * Example: Host -> HTTP_HOST 
@@ -374,7 +404,13 @@ restconf_terminate(clicon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xmldb_snapshot_exit(h);
+    xpath_cache_exit();
+    api_path_cache_exit();
+    xml_nsid_exit();
+    nacm_ruleset_free(h);
     restconf_handle_exit(h);
+    clixon_pool_exit();
     clixon_err_exit();
     clicon_debug(1, "%s pid:%u done", __FUNCTION__, getpid());
     clicon_log_exit(); /* Must be after last clicon_debug */
@@ -824,6 +860,7 @@ restconf_config_init(clicon_handle h,
  * @param[in]  port      TCP port
  * @param[in]  backlog  Listen backlog, queie of pending connections
  * @param[in]  flags    Socket flags OR:ed in with the socket(2) type parameter
+ * @param[in]  reuseport If set, several worker processes bind the same address with SO_REUSEPORT
  * @param[out] ss        Server socket (bound for accept)
  */
 int
@@ -833,6 +870,7 @@ restconf_socket_init(const char   *netns0,
                      uint16_t      port,
                      int           backlog,
                      int           flags,
+                     int           reuseport,
                      int          *ss)
 {
     int                 retval = -1;
@@ -849,7 +887,7 @@ restconf_socket_init(const char   *netns0,
         netns = netns0;
     if (clixon_inet2sin(addrtype, addrstr, port, sa, &sa_len) < 0)
         goto done;
-    if (clixon_netns_socket(netns, sa, sa_len, backlog, flags, addrstr, ss) < 0)
+    if (clixon_netns_socket(netns, sa, sa_len, backlog, flags, reuseport, addrstr, ss) < 0)
         goto done;
     clicon_debug(1, "%s ss=%d", __FUNCTION__, *ss);
     retval = 0;
@@ -858,3 +896,34 @@ restconf_socket_init(const char   *netns0,
     return retval;
 }
 
+/*! Produce the whole body of a streamed reply
+ *
+ * Used by restconf_reply_send_stream when the reply is not streamed, eg HTTP/1 or FCGI
+ * @param[in]  fn     Body producer
+ * @param[in]  arg    Producer argument
+ * @param[out] cbp    Body as a cbuf, free with cbuf_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+restconf_reply_stream_drain(restconf_body_fn *fn,
+                            void             *arg,
+                            cbuf            **cbp)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (fn(arg, cb, 0) < 0)
+        goto done;
+    *cbp = cb;
+    cb = NULL;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
@@ -41,6 +41,12 @@ extern "C" {
 #ifndef _RESTCONF_LIB_H_
 #define _RESTCONF_LIB_H_
 
+/*
+ * Constants
+ */
+/* Handle data: length of input data of request, binary data such as CBOR may contain NUL */
+#define RESTCONF_INDATA_LEN "restconf-indata-len"
+
 /*
  * Types
  */
@@ -54,6 +60,7 @@ enum restconf_media{
     YANG_PATCH_JSON, /* "application/yang-patch+json" */
     YANG_PATCH_XML,  /* "application/yang-patch+xml" */
     YANG_PAGINATION_XML, /* draft-wwlh-netconf-list-pagination-rc-02.txt */
+    YANG_DATA_CBOR,  /* "application/yang-data+cbor", RFC 9254 */
 };
 typedef enum restconf_media restconf_media;
 
@@ -76,7 +83,25 @@ enum restconf_http_proto{
     HTTP_2
 };
 typedef enum restconf_http_proto restconf_http_proto;
-    
+
+/*! Producer of the body of a streamed reply
+ *
+ * @param[in]  arg   Producer argument
+ * @param[out] cb    Cligen buffer to append body data to
+ * @param[in]  len   Minimum number of bytes to append (if not end), 0 means all
+ * @retval     2     OK, no more data for now, producer resumes the reply (native only)
+ * @retval     1     OK, more data
+ * @retval     0     OK, end of body
+ * @retval    -1     Error
+ * @see restconf_reply_send_stream
+ * @see restconf_stream_resume
+ */
+typedef int (restconf_body_fn)(void *arg, cbuf *cb, size_t len);
+
+/*! Free producer argument of a streamed reply
+ */
+typedef int (restconf_body_free_fn)(void *arg);
+
 /*
  * Prototypes
  */
@@ -87,6 +112,7 @@ const char *restconf_media_int2str(restconf_media media);
 int   restconf_str2proto(char *str);
 const char *restconf_proto2str(int proto);
 restconf_media restconf_content_type(clicon_handle h);
+int   restconf_cbor_parse(clicon_handle h, char *data, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
 int   restconf_convert_hdr(clicon_handle h, char *name, char *val);
 int   get_user_cookie(char *cookiestr, char  *attribute, char **val);
 int   restconf_terminate(clicon_handle h);
@@ -96,7 +122,8 @@ char *restconf_uripath(clicon_handle h);
 int   restconf_drop_privileges(clicon_handle h);
 int   restconf_authentication_cb(clicon_handle h, void *req, int pretty, restconf_media media_out);
 int   restconf_config_init(clicon_handle h, cxobj *xrestconf);
-int   restconf_socket_init(const char *netns0, const char *addrstr, const char *addrtype, uint16_t port, int backlog, int flags, int *ss);
+int   restconf_socket_init(const char *netns0, const char *addrstr, const char *addrtype, uint16_t port, int backlog, int flags, int reuseport, int *ss);
+int   restconf_reply_stream_drain(restconf_body_fn *fn, void *arg, cbuf **cbp);
 
 #endif /* _RESTCONF_LIB_H_ */
 
@@ -126,16 +126,25 @@ fcgi_params_set(clicon_handle h,
 }
 
 /*! Try to get config: inline, config-file or query backend
+ *
+ * @param[in]  h             Clixon handle
+ * @param[in]  yspec         Yang spec
+ * @param[in]  inline_config Restconf config given with -R, or NULL
+ * @param[out] workers       Number of worker processes
+ * @retval     0             OK
+ * @retval    -1             Error
  */
 static int
 restconf_main_config(clicon_handle h,
                      yang_stmt    *yspec,
-                     const char   *inline_config)
+                     const char   *inline_config,
+                     int          *workers)
 {
     int            retval = -1;
     struct passwd *pw;
     cxobj         *xconfig = NULL;   
     cxobj         *xrestconf = NULL;
+    cxobj         *x;
     uint32_t       id = 0;
     cxobj         *xerr = NULL;
     int            configure_done = 0; /* First try local then backend */
@@ -198,6 +207,9 @@ restconf_main_config(clicon_handle h,
         clicon_err(OE_DAEMON, EFAULT, "Restconf daemon config not found or disabled");
         goto done;
     }
+    *workers = 1;
+    if ((x = xpath_first(xrestconf, NULL, "workers")) != NULL)
+        *workers = atoi(xml_body(x));
     retval = 0;
  done:
     if (nsc)
@@ -217,14 +229,23 @@ static clicon_handle _CLICON_HANDLE = NULL;
  */
 static int _MYSOCK;
 
+/* Worker process pids, only set in the supervisor process, see restconf_fcgi_workers */
+static pid_t *_restconf_workers = NULL;
+static int    _restconf_nworkers = 0;
+
 /*! Signall terminates process
  */
 static void
 restconf_sig_term(int arg)
 {
     static int i=0;
+    int        w;
 
     clicon_debug(1, "%s", __FUNCTION__);
+    /* Supervisor forwards the signal to its workers */
+    for (w=0; w<_restconf_nworkers; w++)
+        if (_restconf_workers[w] > 0)
+            kill(_restconf_workers[w], SIGTERM);
     if (i++ == 0)
         clicon_log(LOG_NOTICE, "%s: %s: pid: %u Signal %d", 
                    __PROGRAM__, __FUNCTION__, getpid(), arg);
@@ -254,6 +275,131 @@ restconf_sig_child(int arg)
         stream_child_free(_CLICON_HANDLE, pid);
 }
 
+/*! Fork a fastcgi worker process
+ *
+ * The worker does not share the backend connection of the supervisor. A new connection and
+ * session is made by the first request of the worker to the backend, and is kept for
+ * the following requests.
+ * @param[in]  h      Clicon handle
+ * @param[in]  w      Index of worker
+ * @retval     1      Worker process, continue with accept loop
+ * @retval     0      Supervisor process, pid of worker stored in _restconf_workers
+ * @retval    -1      Error
+ */
+static int
+restconf_fcgi_worker_fork(clicon_handle h,
+                          int           w)
+{
+    pid_t pid;
+    int   s;
+
+    if ((pid = fork()) < 0){
+        clicon_err(OE_UNIX, errno, "fork");
+        return -1;
+    }
+    if (pid == 0){ /* Worker */
+        free(_restconf_workers);
+        _restconf_workers = NULL;
+        _restconf_nworkers = 0;
+        if ((s = clicon_client_socket_get(h)) >= 0){
+            close(s);
+            clicon_client_socket_set(h, -1);
+        }
+        clicon_session_id_del(h);
+        /* Reap stream children of this worker */
+        if (set_signal(SIGCHLD, restconf_sig_child, NULL) < 0){
+            clicon_err(OE_DAEMON, errno, "Setting signal");
+            return -1;
+        }
+        clicon_debug(1, "%s worker %d pid %u", __FUNCTION__, w, getpid());
+        return 1;
+    }
+    _restconf_workers[w] = pid;
+    return 0;
+}
+
+/*! Fork fastcgi worker processes and supervise them
+ *
+ * All workers accept requests on the same fastcgi socket, each with its own backend
+ * connection. The yang spec and configuration are loaded before the workers are forked.
+ * The supervisor does not serve any requests. It waits for the workers, restarts a worker
+ * that is killed by a signal, and forwards termination to the workers, see restconf_sig_term
+ * @param[in]  h        Clicon handle
+ * @param[in]  workers  Number of worker processes
+ * @retval     1        Worker process, continue with accept loop
+ * @retval     0        Supervisor process, all workers have exited
+ * @retval    -1        Error
+ * @see restconf_native_workers  Same for native restconf
+ */
+static int
+restconf_fcgi_workers(clicon_handle h,
+                      int           workers)
+{
+    int   retval = -1;
+    pid_t pid;
+    int   status;
+    int   nalive = 0;
+    int   w;
+    int   ret;
+
+    clicon_debug(1, "%s %d", __FUNCTION__, workers);
+    /* Supervisor waits for workers itself */
+    if (set_signal(SIGCHLD, SIG_DFL, NULL) < 0){
+        clicon_err(OE_DAEMON, errno, "Setting signal");
+        goto done;
+    }
+    if ((_restconf_workers = calloc(workers, sizeof(pid_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    _restconf_nworkers = workers;
+    for (w=0; w<workers; w++){
+        if ((ret = restconf_fcgi_worker_fork(h, w)) < 0)
+            goto done;
+        if (ret == 1)
+            return 1;
+        nalive++;
+    }
+    while (nalive > 0){
+        if ((pid = waitpid(-1, &status, 0)) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "waitpid");
+            goto done;
+        }
+        for (w=0; w<workers; w++)
+            if (_restconf_workers[w] == pid)
+                break;
+        if (w == workers)
+            continue;
+        _restconf_workers[w] = 0;
+        nalive--;
+        if (WIFSIGNALED(status) && !clixon_exit_get()){
+            clicon_log(LOG_WARNING, "%s: worker %d pid %u killed by signal %d, restarting",
+                       __PROGRAM__, w, pid, WTERMSIG(status));
+            if ((ret = restconf_fcgi_worker_fork(h, w)) < 0)
+                goto done;
+            if (ret == 1)
+                return 1;
+            nalive++;
+        }
+        else
+            clicon_log(LOG_NOTICE, "%s: worker %d pid %u exited", __PROGRAM__, w, pid);
+    }
+    retval = 0;
+ done:
+    clicon_debug(1, "%s %d", __FUNCTION__, retval);
+    /* Supervisor: terminate remaining workers on error */
+    for (w=0; w<_restconf_nworkers; w++)
+        if (_restconf_workers[w] > 0)
+            kill(_restconf_workers[w], SIGTERM);
+    if (_restconf_workers)
+        free(_restconf_workers);
+    _restconf_workers = NULL;
+    _restconf_nworkers = 0;
+    return retval;
+}
+
 /*! Usage help routine
  * @param[in]  argv0  command line
  * @param[in]  h      Clicon handle
@@ -310,12 +456,15 @@ main(int    argc,
     size_t         cligen_buflen;
     size_t         cligen_bufthreshold;
     int            dbg = 0;
+    int            cached;
     cxobj         *xerr = NULL;
     char          *wwwuser;
     char          *inline_config = NULL;
     size_t         sz;
     int           config_dump = 0;
     enum format_enum config_dump_format = FORMAT_XML;
+    int            workers = 1;
+    int            ret;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__PROGRAM__, LOG_INFO, logdst); 
@@ -450,6 +599,11 @@ main(int    argc,
 
     if ((sz = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clicon_log_string_limit_set(sz);
+    if ((sz = clicon_option_int(h, "CLICON_LOG_RATE_LIMIT")) != 0)
+        clicon_log_rate_limit_set(sz);
+    if (clicon_option_bool(h, "CLICON_LOG_ASYNC") &&
+        clicon_log_async(1) < 0)
+        goto done;
     
     /* Set default namespace according to CLICON_NAMESPACE_NETCONF_DEFAULT */
     xml_nsctx_namespace_netconf_default(h);
@@ -482,6 +636,9 @@ main(int    argc,
         goto done;
     clixon_plugin_api_get(cp)->ca_extension = restconf_main_extension_cb;
 
+    /* Load yang spec from cache if valid, then the modules below are already loaded */
+    if ((cached = yang_spec_cache_load(h, "restconf", yspec)) < 0)
+        goto done;
     /* Load Yang modules
      * 1. Load a yang module as a specific absolute filename */
     if ((str = clicon_yang_main_file(h)) != NULL){
@@ -529,6 +686,9 @@ main(int    argc,
         yang_spec_parse_module(h, "clixon-rfc5277", NULL, yspec)< 0)
         goto done;
 
+    if (cached == 0 &&
+        yang_spec_cache_save(h, "restconf", yspec) < 0)
+        goto done;
     /* Here all modules are loaded 
      * Compute and set canonical namespace context
      */
@@ -551,7 +711,7 @@ main(int    argc,
         goto done;
 
     /* Try to get config: inline, config-file or query backend */
-    if (restconf_main_config(h, yspec, inline_config) < 0)
+    if (restconf_main_config(h, yspec, inline_config, &workers) < 0)
         goto done;
     if ((sockpath = restconf_fcgi_socket_get(h)) == NULL){
         clicon_err(OE_CFG, 0, "No restconf fcgi-socket (have you set FEATURE fcgi in config?)");
@@ -596,7 +756,14 @@ main(int    argc,
      * @see clicon_hello_req
      */
     clicon_data_set(h, "session-transport", "cl:restconf");
-    
+
+    /* Fork worker processes, the supervisor returns here when all workers have exited */
+    if (workers > 1){
+        if ((ret = restconf_fcgi_workers(h, workers)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
     if (FCGX_InitRequest(req, sock, 0) != 0){
         clicon_err(OE_CFG, errno, "FCGX_InitRequest");
         goto done;
@@ -665,6 +832,7 @@ main(int    argc,
         }
         if (restconf_param_del_all(h) < 0)
             goto done;
+        clixon_pool_trim();
         if (finish)
             FCGX_Finish_r(req);
         else if (clixon_exit_get()){
@@ -120,12 +120,14 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <inttypes.h>
 #include <syslog.h>
 #include <pwd.h>
 #include <ctype.h>
 #include <signal.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
+#include <sys/wait.h>
 #include <arpa/inet.h>
 #include <sys/resource.h>
 
@@ -133,6 +135,11 @@
 #include <openssl/rand.h>
 #include <openssl/err.h>
 #include <openssl/x509v3.h>
+#include <openssl/hmac.h>
+#include <openssl/evp.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
 
 #ifdef HAVE_LIBNGHTTP2
 #include <nghttp2/nghttp2.h>
@@ -151,6 +158,9 @@
 #include "restconf_err.h"
 #include "restconf_root.h"
 #include "restconf_native.h"   /* Restconf-openssl mode specific headers*/
+#include "restconf_stream.h"
+#include "clixon_http_data.h"
+#include "restconf_metrics.h"
 #ifdef HAVE_LIBNGHTTP2
 #include "restconf_nghttp2.h"  /* http/2 */
 #endif
@@ -176,8 +186,18 @@
 /* Cert verify depth: dont know what to set here? */
 #define VERIFY_DEPTH 5
 
+/* Length of session ticket key name, see SSL_CTX_set_tlsext_ticket_key_cb(3) */
+#define TICKET_KEY_NAME_LEN 16
+
 static int             session_id_context = 1;
 
+/* Worker process pids, only set in the supervisor process, see restconf_native_workers */
+static pid_t          *_restconf_workers = NULL;
+static int             _restconf_nworkers = 0;
+
+/* Restconf native handle for logging stats in signal handler, see restconf_sig_stats */
+static restconf_native_handle *_restconf_native = NULL;
+
 /*! Set restconf native handle
  *
  * @param[in]  h     Clicon handle
@@ -438,7 +458,6 @@ restconf_ssl_context_configure(clixon_handle h,
 
     SSL_CTX_set_session_id_context(ctx, (void *)&session_id_context, sizeof(session_id_context));
     SSL_CTX_set_app_data(ctx, h);
-    SSL_CTX_set_session_cache_mode(ctx, 0);
 
     /* Set the key and cert */
     if (SSL_CTX_use_certificate_chain_file(ctx, server_cert_path) != 1) {
@@ -458,6 +477,245 @@ restconf_ssl_context_configure(clixon_handle h,
     return retval;
 }
 
+/*! Derive session ticket key name, AES key and HMAC key of a key epoch
+ *
+ * The keys are derived from the ticket secret with HMAC-SHA256 of the epoch and a label.
+ * The secret is made before the worker processes are forked, so that all workers derive the same
+ * keys, and a ticket issued by one worker can resume a session in another worker.
+ * @param[in]  rn      Restconf native handle
+ * @param[in]  epoch   Key epoch, ie time divided by key lifetime
+ * @param[out] name    Key name, TICKET_KEY_NAME_LEN bytes
+ * @param[out] aeskey  AES-256 key, 32 bytes
+ * @param[out] hmackey HMAC-SHA256 key, 32 bytes
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+restconf_ticket_key_derive(restconf_native_handle *rn,
+                           uint64_t                epoch,
+                           unsigned char          *name,
+                           unsigned char          *aeskey,
+                           unsigned char          *hmackey)
+{
+    unsigned char data[9];
+    unsigned char md[EVP_MAX_MD_SIZE];
+    unsigned int  mdlen;
+    int           i;
+
+    for (i=0; i<8; i++)
+        data[i+1] = (epoch >> (8*(7-i))) & 0xff;
+    data[0] = 'n';
+    if (HMAC(EVP_sha256(), rn->rn_ticket_secret, sizeof(rn->rn_ticket_secret),
+             data, sizeof(data), md, &mdlen) == NULL)
+        return -1;
+    memcpy(name, md, TICKET_KEY_NAME_LEN);
+    data[0] = 'a';
+    if (HMAC(EVP_sha256(), rn->rn_ticket_secret, sizeof(rn->rn_ticket_secret),
+             data, sizeof(data), aeskey, &mdlen) == NULL)
+        return -1;
+    data[0] = 'h';
+    if (HMAC(EVP_sha256(), rn->rn_ticket_secret, sizeof(rn->rn_ticket_secret),
+             data, sizeof(data), hmackey, &mdlen) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Session ticket key callback, encrypt a new ticket or find the key of a received ticket
+ *
+ * New tickets are encrypted with the key of the current epoch. A received ticket is decrypted if
+ * its key is of the current or the previous epoch, in the latter case the ticket is renewed.
+ * @param[in]  ssl     SSL connection
+ * @param[in]  name    Key name, set if enc, otherwise key name of received ticket
+ * @param[in]  iv      Initialization vector, set if enc
+ * @param[in]  ectx    Cipher context to initialize
+ * @param[in]  hctx    HMAC context to initialize
+ * @param[in]  enc     1: encrypt new ticket, 0: decrypt received ticket
+ * @retval     2       Ticket decrypted but should be renewed (decrypt)
+ * @retval     1       OK
+ * @retval     0       Key of received ticket not found, make full handshake (decrypt)
+ * @retval    -1       Error
+ * @see SSL_CTX_set_tlsext_ticket_key_evp_cb(3)
+ */
+static int
+restconf_ticket_key_cb(SSL            *ssl,
+                       unsigned char  *name,
+                       unsigned char  *iv,
+                       EVP_CIPHER_CTX *ectx,
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+                       EVP_MAC_CTX    *hctx,
+#else
+                       HMAC_CTX       *hctx,
+#endif
+                       int             enc)
+{
+    clicon_handle           h;
+    restconf_native_handle *rn;
+    uint64_t                epoch;
+    unsigned char           keyname[TICKET_KEY_NAME_LEN];
+    unsigned char           aeskey[32];
+    unsigned char           hmackey[32];
+    int                     i;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    OSSL_PARAM              params[3];
+#endif
+
+    h = SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl));
+    if ((rn = restconf_native_handle_get(h)) == NULL ||
+        rn->rn_ticket_lifetime == 0)
+        return -1;
+    epoch = time(NULL) / rn->rn_ticket_lifetime;
+    if (enc){
+        if (restconf_ticket_key_derive(rn, epoch, keyname, aeskey, hmackey) < 0)
+            return -1;
+        if (RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1)
+            return -1;
+        memcpy(name, keyname, TICKET_KEY_NAME_LEN);
+        i = 0;
+    }
+    else{
+        for (i=0; i<2; i++){
+            if (restconf_ticket_key_derive(rn, epoch - i, keyname, aeskey, hmackey) < 0)
+                return -1;
+            if (memcmp(name, keyname, TICKET_KEY_NAME_LEN) == 0)
+                break;
+        }
+        if (i == 2) /* Unknown or expired key */
+            return 0;
+    }
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    params[0] = OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, hmackey, sizeof(hmackey));
+    params[1] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, "SHA256", 0);
+    params[2] = OSSL_PARAM_construct_end();
+    if (EVP_MAC_CTX_set_params(hctx, params) != 1)
+        return -1;
+#else
+    if (HMAC_Init_ex(hctx, hmackey, sizeof(hmackey), EVP_sha256(), NULL) != 1)
+        return -1;
+#endif
+    if (enc){
+        if (EVP_EncryptInit_ex(ectx, EVP_aes_256_cbc(), NULL, aeskey, iv) != 1)
+            return -1;
+        rn->rn_tls_tickets++;
+        return 1;
+    }
+    if (EVP_DecryptInit_ex(ectx, EVP_aes_256_cbc(), NULL, aeskey, iv) != 1)
+        return -1;
+    return i == 0 ? 1 : 2;
+}
+
+/*! Configure TLS session resumption: session cache and session tickets
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  ctx       SSL context
+ * @param[in]  xrestconf XML tree containing restconf config
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @see clixon-restconf.yang tls-session-cache, tls-session-tickets
+ */
+static int
+restconf_ssl_session_configure(clixon_handle h,
+                               SSL_CTX      *ctx,
+                               cxobj        *xrestconf)
+{
+    int                     retval = -1;
+    restconf_native_handle *rn;
+    cxobj                  *x;
+    uint32_t                cachesize = 0;
+    uint32_t                timeout = 300;
+    uint32_t                lifetime = 3600;
+    int                     tickets = 1;
+
+    if ((rn = restconf_native_handle_get(h)) == NULL){
+        clicon_err(OE_XML, EFAULT, "No openssl handle");
+        goto done;
+    }
+    if ((x = xpath_first(xrestconf, NULL, "tls-session-cache")) != NULL)
+        cachesize = strtoul(xml_body(x), NULL, 10);
+    if ((x = xpath_first(xrestconf, NULL, "tls-session-timeout")) != NULL)
+        timeout = strtoul(xml_body(x), NULL, 10);
+    if ((x = xpath_first(xrestconf, NULL, "tls-session-tickets")) != NULL)
+        tickets = strcmp(xml_body(x), "true") == 0;
+    if ((x = xpath_first(xrestconf, NULL, "tls-ticket-key-lifetime")) != NULL)
+        lifetime = strtoul(xml_body(x), NULL, 10);
+    clicon_debug(1, "%s cache:%u timeout:%u tickets:%d lifetime:%u", __FUNCTION__,
+                 cachesize, timeout, tickets, lifetime);
+    SSL_CTX_set_timeout(ctx, timeout);
+    if (cachesize){
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_sess_set_cache_size(ctx, cachesize);
+    }
+    else
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+    if (tickets && lifetime){
+        rn->rn_ticket_lifetime = lifetime;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, restconf_ticket_key_cb);
+#else
+        SSL_CTX_set_tlsext_ticket_key_cb(ctx, restconf_ticket_key_cb);
+#endif
+    }
+    else{
+        rn->rn_ticket_lifetime = 0;
+        SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+        SSL_CTX_set_num_tickets(ctx, 0);
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Log restconf stats of this process: TLS handshakes, session resumption and connection reuse
+ *
+ * @param[in]  rn   Restconf native handle
+ * @see restconf_sig_stats
+ */
+static void
+restconf_native_stats(restconf_native_handle *rn)
+{
+    SSL_CTX *ctx = rn->rn_ctx;
+    uint64_t nr = 0;
+    size_t   sz = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t nbackend = 0;
+    uint64_t nsub = 0;
+    uint64_t events = 0;
+    uint64_t disconnected = 0;
+    uint64_t fnr = 0;
+    size_t   fsz = 0;
+    uint64_t fhits = 0;
+    uint64_t fmisses = 0;
+    uint64_t chnr = 0;
+    uint64_t connects = 0;
+    uint64_t fails = 0;
+    uint64_t usec = 0;
+    uint64_t max = 0;
+
+    api_path_cache_stats(&nr, &sz, &hits, &misses);
+    http_data_cache_stats(&fnr, &fsz, &fhits, &fmisses);
+    restconf_stream_stats(&nbackend, &nsub, &events, &disconnected);
+    restconf_callhome_stats(rn, &chnr, &connects, &fails, &usec, &max);
+    clicon_log(LOG_NOTICE, "%s: worker %d pid %u tls handshakes:%" PRIu64 " resumed:%" PRIu64 " tickets:%" PRIu64
+               " session cache hits:%ld misses:%ld timeouts:%ld sessions:%ld"
+               " http/1 requests:%" PRIu64 " reused connection:%" PRIu64
+               " api-path cache nr:%" PRIu64 " size:%zu hits:%" PRIu64 " misses:%" PRIu64
+               " stream subscriptions:%" PRIu64 " subscribers:%" PRIu64 " events:%" PRIu64 " disconnected:%" PRIu64
+               " http-data cache nr:%" PRIu64 " size:%zu hits:%" PRIu64 " misses:%" PRIu64
+               " callhome nr:%" PRIu64 " connects:%" PRIu64 " fails:%" PRIu64 " avg usec:%" PRIu64 " max usec:%" PRIu64,
+               __PROGRAM__, rn->rn_worker, getpid(),
+               rn->rn_tls_handshakes, rn->rn_tls_resumed, rn->rn_tls_tickets,
+               ctx?SSL_CTX_sess_hits(ctx):0,
+               ctx?SSL_CTX_sess_misses(ctx):0,
+               ctx?SSL_CTX_sess_timeouts(ctx):0,
+               ctx?SSL_CTX_sess_number(ctx):0,
+               rn->rn_http1_requests, rn->rn_http1_reused,
+               nr, sz, hits, misses,
+               nbackend, nsub, events, disconnected,
+               fnr, fsz, fhits, fmisses,
+               chnr, connects, fails, connects?usec/connects:0, max);
+    restconf_metrics_log(rn->rn_worker);
+}
+
 #if 0 /* debug */
 /*! Debug print all loaded certs
  */
@@ -543,6 +801,8 @@ restconf_accept_client(int   fd,
     socklen_t               len;
     char                   *name = NULL;
     void                   *addr;
+    restconf_conn          *rc = NULL;
+    int                     ret;
 
     clicon_debug(1, "%s %d", __FUNCTION__, fd);
     if ((rsock = (restconf_socket *)arg) == NULL){
@@ -587,8 +847,13 @@ restconf_accept_client(int   fd,
                  rsock->rs_port);
     clicon_data_set(h, "session-source-host", rsock->rs_from_addr);
     /* Accept SSL */
-    if (restconf_ssl_accept_client(h, s, rsock, NULL) < 0)
+    if ((ret = restconf_ssl_accept_client(h, s, rsock, &rc)) < 0)
         goto done;
+    /* ret == 0 means already closed */
+    if (ret == 1 && rsock->rs_idle_timeout){
+        if (restconf_idle_timer(rc) < 0)
+            goto done;
+    }
     retval = 0;
  done:
     clicon_debug(1, "%s retval %d", __FUNCTION__, retval);
@@ -614,8 +879,9 @@ restconf_native_terminate(clicon_handle h)
                     clixon_event_unreg_fd(rc->rc_s, restconf_connection);
                     close(rc->rc_s);
                 }
-                DELQ(rc, rsock->rs_conns, restconf_conn *);
-                restconf_close_ssl_socket(rc, __FUNCTION__, 0);
+                /* rc is removed from rs_conns when freed, only remove here on error */
+                if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
+                    DELQ(rc, rsock->rs_conns, restconf_conn *);
             }
             if (rsock->rs_callhome){
                 restconf_callhome_timer_unreg(rsock);
@@ -635,6 +901,9 @@ restconf_native_terminate(clicon_handle h)
                 free(rsock->rs_from_addr);
             free(rsock);
         }
+        stream_child_freeall(h);
+        http_data_cache_exit();
+        restconf_metrics_exit();
         if (rn->rn_ctx)
             SSL_CTX_free(rn->rn_ctx);
         free(rn);
@@ -736,6 +1005,7 @@ openssl_init_socket(clicon_handle h,
     restconf_native_handle *rn = NULL;
     restconf_socket *rsock = NULL; /* openssl per socket struct */
     struct timeval   now;
+    cxobj           *x;
 
     clicon_debug(1, "%s", __FUNCTION__);
     /*
@@ -750,6 +1020,10 @@ openssl_init_socket(clicon_handle h,
     rsock->rs_h = h;
     gettimeofday(&now, NULL);
     rsock->rs_start = now.tv_sec;
+    if ((rn = restconf_native_handle_get(h)) == NULL){
+        clicon_err(OE_XML, EFAULT, "No openssl handle");
+        goto done;
+    }
     /* Extract socket parameters from single socket config: ns, addr, port, ssl */
     if (restconf_socket_extract(h, xs, nsc, rsock, &netns, &address, &addrtype, &port) < 0)
         goto done;
@@ -758,8 +1032,18 @@ openssl_init_socket(clicon_handle h,
             clicon_err(OE_SSL, EINVAL, "Restconf callhome requires SSL");
             goto done;
         }
+        /* Only the first worker calls home, otherwise there would be one call-home per worker */
+        if (rn->rn_workers > 1 && rn->rn_worker != 0){
+            if (rsock->rs_description)
+                free(rsock->rs_description);
+            free(rsock);
+            goto ok;
+        }
     }
     else { /* listen/accept */
+        /* Idle timeout of persistent client connections */
+        if ((x = xpath_first(xml_parent(xs), nsc, "idle-timeout")) != NULL)
+            rsock->rs_idle_timeout = atoi(xml_body(x));
         /* Open restconf socket and bind for later accept */
         if (restconf_socket_init(netns, address, addrtype, port,
                              SOCKET_LISTEN_BACKLOG,
@@ -768,14 +1052,11 @@ openssl_init_socket(clicon_handle h,
 #else /* blocking */
                                  0,
 #endif
+                                 rn->rn_workers > 1, /* SO_REUSEPORT */
                                  &ss
                                  ) < 0)
             goto done;
     }
-    if ((rn = restconf_native_handle_get(h)) == NULL){
-        clicon_err(OE_XML, EFAULT, "No openssl handle");
-        goto done;
-    }
     if ((rsock->rs_addrstr = strdup(address)) == NULL){
         clicon_err(OE_UNIX, errno, "strdup");
         goto done;
@@ -799,6 +1080,7 @@ openssl_init_socket(clicon_handle h,
         if (clixon_event_reg_fd(rsock->rs_ss, restconf_accept_client, rsock, "restconf socket") < 0) 
             goto done;
     }
+ ok:
     retval = 0;
  done:
     return retval;
@@ -881,6 +1163,8 @@ restconf_openssl_init(clicon_handle h,
                 goto done;
         if (restconf_ssl_context_configure(h, ctx, server_cert_path, server_key_path, server_ca_cert_path) < 0)
             goto done;
+        if (restconf_ssl_session_configure(h, ctx, xrestconf) < 0)
+            goto done;
     }
     rn = restconf_native_handle_get(h);
     rn->rn_ctx = ctx;
@@ -934,6 +1218,7 @@ restconf_clixon_init(clicon_handle h,
     cxobj         *xrestconf = NULL;
     cxobj         *xerr = NULL;
     int            ret;
+    int            cached;
     size_t         sz;
 
     /* Set default namespace according to CLICON_NAMESPACE_NETCONF_DEFAULT */
@@ -946,6 +1231,11 @@ restconf_clixon_init(clicon_handle h,
 
     if ((sz = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clicon_log_string_limit_set(sz);
+    if ((sz = clicon_option_int(h, "CLICON_LOG_RATE_LIMIT")) != 0)
+        clicon_log_rate_limit_set(sz);
+    if (clicon_option_bool(h, "CLICON_LOG_ASYNC") &&
+        clicon_log_async(1) < 0)
+        goto done;
 
     /* Add (hardcoded) netconf features in case ietf-netconf loaded here
      * Otherwise it is loaded in netconf_module_load below
@@ -971,6 +1261,9 @@ restconf_clixon_init(clicon_handle h,
         goto done;
     clixon_plugin_api_get(cp)->ca_extension = restconf_main_extension_cb;
 
+    /* Load yang spec from cache if valid, then the modules below are already loaded */
+    if ((cached = yang_spec_cache_load(h, "restconf", yspec)) < 0)
+        goto done;
     /* Load Yang modules
      * 1. Load a yang module as a specific absolute filename */
     if ((str = clicon_yang_main_file(h)) != NULL){
@@ -1016,6 +1309,9 @@ restconf_clixon_init(clicon_handle h,
         yang_spec_parse_module(h, "clixon-rfc5277", NULL, yspec)< 0)
         goto done;
 
+    if (cached == 0 &&
+        yang_spec_cache_save(h, "restconf", yspec) < 0)
+        goto done;
     /* Here all modules are loaded 
      * Compute and set canonical namespace context
      */
@@ -1089,8 +1385,14 @@ restconf_sig_term(int arg)
 {
     static int i=0;
 
+    int        w;
+
     clicon_log(LOG_NOTICE, "%s: %s: pid: %u Signal %d", 
                __PROGRAM__, __FUNCTION__, getpid(), arg);
+    /* Supervisor forwards the signal to its workers */
+    for (w=0; w<_restconf_nworkers; w++)
+        if (_restconf_workers[w] > 0)
+            kill(_restconf_workers[w], SIGTERM);
     if (i++ > 0) /* Allow one sigterm before proper exit */
         exit(-1);
     /* This should ensure no more accepts or incoming packets are processed because next time eventloop
@@ -1100,6 +1402,147 @@ restconf_sig_term(int arg)
     clixon_exit_set(1); 
 }
 
+/*! Signal logs restconf stats
+ *
+ * The supervisor forwards the signal to its workers, each worker logs its own stats
+ * @see restconf_native_stats
+ */
+static void
+restconf_sig_stats(int arg)
+{
+    int w;
+
+    if (_restconf_nworkers){
+        for (w=0; w<_restconf_nworkers; w++)
+            if (_restconf_workers[w] > 0)
+                kill(_restconf_workers[w], arg);
+    }
+    else if (_restconf_native)
+        restconf_native_stats(_restconf_native);
+}
+
+/*! Fork a restconf worker process
+ *
+ * The worker does not share the backend connection of the supervisor. A new connection and
+ * session is made by the first request of the worker to the backend.
+ * @param[in]  h      Clicon handle
+ * @param[in]  rn     Restconf native handle
+ * @param[in]  w      Index of worker
+ * @retval     1      Worker process, continue with sockets and event loop
+ * @retval     0      Supervisor process, pid of worker stored in _restconf_workers
+ * @retval    -1      Error
+ */
+static int
+restconf_native_worker_fork(clicon_handle           h,
+                            restconf_native_handle *rn,
+                            int                     w)
+{
+    pid_t pid;
+    int   s;
+
+    if ((pid = fork()) < 0){
+        clicon_err(OE_UNIX, errno, "fork");
+        return -1;
+    }
+    if (pid == 0){ /* Worker */
+        free(_restconf_workers);
+        _restconf_workers = NULL;
+        _restconf_nworkers = 0;
+        rn->rn_worker = w;
+        if ((s = clicon_client_socket_get(h)) >= 0){
+            close(s);
+            clicon_client_socket_set(h, -1);
+        }
+        clicon_session_id_del(h);
+        clicon_debug(1, "%s worker %d pid %u", __FUNCTION__, w, getpid());
+        return 1;
+    }
+    _restconf_workers[w] = pid;
+    return 0;
+}
+
+/*! Fork restconf worker processes and supervise them
+ *
+ * Each worker opens its own listening sockets with SO_REUSEPORT and the kernel distributes
+ * incoming connections between them. Each worker has its own event loop and backend connection.
+ * The supervisor does not serve any requests. It waits for the workers, restarts a worker
+ * that is killed by a signal, and forwards termination to the workers, see restconf_sig_term
+ * @param[in]  h        Clicon handle
+ * @param[in]  workers  Number of worker processes
+ * @retval     1        Worker process, continue with sockets and event loop
+ * @retval     0        Supervisor process, all workers have exited
+ * @retval    -1        Error
+ */
+static int
+restconf_native_workers(clicon_handle h,
+                        int           workers)
+{
+    int                     retval = -1;
+    restconf_native_handle *rn;
+    pid_t                   pid;
+    int                     status;
+    int                     nalive = 0;
+    int                     w;
+    int                     ret;
+
+    clicon_debug(1, "%s %d", __FUNCTION__, workers);
+    if ((rn = restconf_native_handle_get(h)) == NULL){
+        clicon_err(OE_XML, EFAULT, "No openssl handle");
+        goto done;
+    }
+    rn->rn_workers = workers;
+    if ((_restconf_workers = calloc(workers, sizeof(pid_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    _restconf_nworkers = workers;
+    for (w=0; w<workers; w++){
+        if ((ret = restconf_native_worker_fork(h, rn, w)) < 0)
+            goto done;
+        if (ret == 1)
+            return 1;
+        nalive++;
+    }
+    while (nalive > 0){
+        if ((pid = waitpid(-1, &status, 0)) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "waitpid");
+            goto done;
+        }
+        for (w=0; w<workers; w++)
+            if (_restconf_workers[w] == pid)
+                break;
+        if (w == workers)
+            continue;
+        _restconf_workers[w] = 0;
+        nalive--;
+        if (WIFSIGNALED(status) && !clixon_exit_get()){
+            clicon_log(LOG_WARNING, "%s: worker %d pid %u killed by signal %d, restarting",
+                       __PROGRAM__, w, pid, WTERMSIG(status));
+            if ((ret = restconf_native_worker_fork(h, rn, w)) < 0)
+                goto done;
+            if (ret == 1)
+                return 1;
+            nalive++;
+        }
+        else
+            clicon_log(LOG_NOTICE, "%s: worker %d pid %u exited", __PROGRAM__, w, pid);
+    }
+    retval = 0;
+ done:
+    clicon_debug(1, "%s %d", __FUNCTION__, retval);
+    /* Supervisor: terminate remaining workers on error */
+    for (w=0; w<_restconf_nworkers; w++)
+        if (_restconf_workers[w] > 0)
+            kill(_restconf_workers[w], SIGTERM);
+    if (_restconf_workers)
+        free(_restconf_workers);
+    _restconf_workers = NULL;
+    _restconf_nworkers = 0;
+    return retval;
+}
+
 /*! Usage help routine
  *
  * @param[in]  argv0  command line
@@ -1149,6 +1592,8 @@ main(int    argc,
     char           *inline_config = NULL;
     int           config_dump = 0;
     enum format_enum config_dump_format = FORMAT_XML;
+    cxobj          *x;
+    int             workers;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__PROGRAM__, LOG_INFO, logdst);
@@ -1223,6 +1668,10 @@ main(int    argc,
         clicon_err(OE_DAEMON, errno, "Setting signal");
         goto done;
     }
+    if (set_signal(SIGUSR1, restconf_sig_stats, NULL) < 0){
+        clicon_err(OE_DAEMON, errno, "Setting signal");
+        goto done;
+    }
     yang_init(h);
     /* Find and read configfile */
     if (clicon_options_main(h) < 0)
@@ -1327,6 +1776,20 @@ main(int    argc,
     memset(rn, 0, sizeof *rn);
     if (restconf_native_handle_set(h, rn) < 0)
         goto done;
+    _restconf_native = rn;
+    /* Ticket secret is made before forking workers so that all workers share ticket keys */
+    if (RAND_bytes(rn->rn_ticket_secret, sizeof(rn->rn_ticket_secret)) != 1){
+        clicon_err(OE_SSL, 0, "RAND_bytes");
+        goto done;
+    }
+    /* Fork worker processes, the supervisor returns here when all workers have exited */
+    if ((x = xpath_first(xrestconf, NULL, "workers")) != NULL &&
+        (workers = atoi(xml_body(x))) > 1){
+        if ((ret = restconf_native_workers(h, workers)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
     /* Openssl inits */ 
     if (restconf_openssl_init(h, dbg, xrestconf) < 0)
         goto done;
@@ -1350,6 +1813,7 @@ main(int    argc,
     clicon_debug(1, "restconf_main_openssl done");
     if (xrestconf)
         xml_free(xrestconf);
+    _restconf_native = NULL;
     restconf_native_terminate(h);
     restconf_terminate(h);
     return retval;
@@ -349,6 +349,20 @@ api_data_write(clicon_handle h,
             goto ok;
         }
         break;
+    case YANG_DATA_CBOR:
+        if ((ret = restconf_cbor_parse(h, data, yb, yspec, &xdata0, &xerr)) < 0){
+            if (netconf_malformed_message_xml(&xerr, clicon_err_reason) < 0)
+                goto done;
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        if (ret == 0){
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        break;
     default:
         restconf_unsupported_media(h, req, pretty, media_out);
         goto ok;
@@ -502,7 +516,7 @@ api_data_write(clicon_handle h,
     /* For internal XML protocol: add username attribute for access control
      */
     /* Create text buffer for transfer to backend */
-    if ((cbx = cbuf_new()) == NULL)
+    if ((cbx = clixon_cbuf_get()) == NULL)
         goto done;
     cprintf(cbx, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
     cprintf(cbx, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
@@ -573,7 +587,7 @@ api_data_write(clicon_handle h,
     if (xdata0)
         xml_free(xdata0);
      if (cbx)
-        cbuf_free(cbx); 
+        clixon_cbuf_put(cbx); 
    return retval;
 } /* api_data_write */
 
@@ -664,13 +678,14 @@ api_data_patch(clicon_handle h,
     switch (media_in){
     case YANG_DATA_XML:
     case YANG_DATA_JSON:        /* plain patch */
+    case YANG_DATA_CBOR:
         ret = api_data_write(h, req, api_path0, pi, qvec, data, pretty,
                              media_in, media_out, 1, ds);
         break;
     case YANG_PATCH_JSON:       /* RFC 8072 patch */
     case YANG_PATCH_XML:
 #ifdef CLIXON_YANG_PATCH
-        ret = api_data_yang_patch(h, req, api_path0, pcvec, pi, qvec, data, pretty,
+        ret = api_data_yang_patch(h, req, api_path0, pi, qvec, data, pretty,
                                   media_in, media_out, ds);
 #else
         ret = restconf_notimplemented(h, req, pretty, media_out);
@@ -750,7 +765,7 @@ api_data_delete(clicon_handle h,
     if (xml_namespace_change(xa, NETCONF_BASE_NAMESPACE, NETCONF_BASE_PREFIX) < 0)
         goto done;
 
-    if ((cbx = cbuf_new()) == NULL)
+    if ((cbx = clixon_cbuf_get()) == NULL)
         goto done;
     /* For internal XML protocol: add username attribute for access control
      */
@@ -798,7 +813,7 @@ api_data_delete(clicon_handle h,
     retval = 0;
  done:
     if (cbx)
-        cbuf_free(cbx); 
+        clixon_cbuf_put(cbx); 
     if (xret)
         xml_free(xret);
     if (xretcom)
@@ -38,6 +38,8 @@
 #ifdef HAVE_CONFIG_H
 #include "clixon_config.h" /* generated by config & autoconf */
 #endif
+
+#define _GNU_SOURCE /* strptime, timegm */
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -48,6 +50,7 @@
 #include <time.h>
 #include <signal.h>
 #include <limits.h>
+#include <inttypes.h>
 #include <sys/time.h>
 #include <sys/wait.h>
 
@@ -64,8 +67,241 @@
 #include "restconf_methods_get.h"
 
 /* Forward */
+
+/*! Produce next part of JSON reply body, see restconf_reply_send_stream
+ */
+static int
+api_data_json_stream_next(void   *arg,
+                          cbuf   *cb,
+                          size_t  len)
+{
+    return clixon_json_stream_next((clixon_json_stream *)arg, cb, len);
+}
+
+/*! Free JSON stream of reply body, see restconf_reply_send_stream
+ */
+static int
+api_data_json_stream_free(void *arg)
+{
+    return clixon_json_stream_free((clixon_json_stream *)arg);
+}
 static int api_data_pagination(clicon_handle h, void *req, char *api_path, int pi, cvec *qvec, int pretty, restconf_media media_out);
 
+/*! Conditional GET of configuration data using the version of the running datastore
+ *
+ * The entity-tag is made of the datastore version and the output media, and the last
+ * modified time is the time the datastore was last written. Only the version is requested
+ * from the backend, so that a client polling for changes does not get all data every time.
+ * See RFC 8040 Sec 3.4.1.2 and 3.4.1.3, RFC 7232 Sec 3.2 and 3.3
+ * @param[in]  h         Clixon handle
+ * @param[in]  req       Generic Www handle
+ * @param[in]  media_out Output media
+ * @param[in]  head      If 1 is HEAD, otherwise GET
+ * @param[out] etag      Entity-tag, free with free() if retval is 0
+ * @param[out] mtime     Last modified time of running
+ * @retval     1         Not modified, 304 reply sent
+ * @retval     0         Modified, or no condition, send reply with etag and mtime
+ * @retval    -1         Error
+ * @note Only one datastore version exists, not per subtree, so any change of running also
+ *       changes the entity-tag of all resources
+ */
+static int
+api_data_get_conditional(clicon_handle   h,
+                         void           *req,
+                         restconf_media  media_out,
+                         int             head,
+                         char          **etag,
+                         struct timeval *mtime)
+{
+    int        retval = -1;
+    uint64_t   version;
+    cbuf      *cb = NULL;
+    char      *str;
+    struct tm  tm = {0,};
+    char      *p;
+
+    if (clicon_rpc_datastore_version(h, "running", &version, mtime) < 0)
+        goto done;
+    if ((cb = clixon_cbuf_get()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "\"%" PRIu64 "-%s\"", version, restconf_media_int2str(media_out));
+    if ((*etag = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    /* If-None-Match has precedence over If-Modified-Since, RFC 7232 Sec 3.3 */
+    if ((str = restconf_param_get(h, "HTTP_IF_NONE_MATCH")) != NULL){
+        if (strcmp(str, "*") != 0 && strstr(str, *etag) == NULL)
+            goto modified;
+    }
+    else if ((str = restconf_param_get(h, "HTTP_IF_MODIFIED_SINCE")) != NULL){
+        if ((p = strptime(str, "%a, %d %b %Y %H:%M:%S GMT", &tm)) == NULL || *p != '\0')
+            goto modified; /* Invalid date is ignored */
+        if (timegm(&tm) < mtime->tv_sec)
+            goto modified;
+    }
+    else
+        goto modified;
+    clicon_debug(1, "%s not modified %s", __FUNCTION__, *etag);
+    if (restconf_reply_header(req, "ETag", "%s", *etag) < 0)
+        goto done;
+    if (restconf_reply_send(req, 304, NULL, head) < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (retval != 0 && *etag){
+        free(*etag);
+        *etag = NULL;
+    }
+    if (cb)
+        clixon_cbuf_put(cb);
+    return retval;
+ modified:
+    retval = 0;
+    goto done;
+}
+
+/*! Parse a fields query parameter into api-paths of the selected nodes
+ *
+ * RFC 8040 4.8.3:
+ *   fields-expr = path "(" fields-expr ")" / path ";" fields-expr / path
+ *   path        = api-identifier [ "/" path ]
+ * Example: "a(b;c/d);e" gives <prefix>/a/b, <prefix>/a/c/d and <prefix>/e
+ * @param[in,out] sp      Fields expression, on return after parsed part
+ * @param[in]     prefix  Api-path of parent of the fields
+ * @param[in]     cvv     Api-paths of selected nodes are added here
+ * @retval        1       OK
+ * @retval        0       Invalid fields expression
+ * @retval       -1       Error
+ */
+static int
+api_data_fields_parse(char      **sp,
+                      const char *prefix,
+                      cvec       *cvv)
+{
+    int     retval = -1;
+    char   *s = *sp;
+    size_t  len;
+    cbuf   *cb = NULL;
+    int     ret;
+
+    while (1){
+        if ((len = strcspn(s, "();")) == 0)
+            goto fail;
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cb, "%s/%.*s", prefix, (int)len, s);
+        s += len;
+        if (*s == '('){
+            s++;
+            if ((ret = api_data_fields_parse(&s, cbuf_get(cb), cvv)) < 0)
+                goto done;
+            if (ret == 0 || *s != ')')
+                goto fail;
+            s++;
+        }
+        else if (cvec_add_string(cvv, NULL, cbuf_get(cb)) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+        cbuf_free(cb);
+        cb = NULL;
+        if (*s != ';')
+            break;
+        s++;
+    }
+    *sp = s;
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Translate a fields query parameter to an xpath selecting the fields of a target
+ *
+ * The xpath is a union of the paths of the selected nodes, and the backend copies only
+ * these nodes and their ancestors of the target, instead of the complete target.
+ * @param[in]     fields    Fields query parameter, see RFC 8040 4.8.3
+ * @param[in]     api_path  Api-path of target, or NULL for data root
+ * @param[in]     yspec     Yang spec
+ * @param[out]    cbxpath   Xpath of selected nodes
+ * @param[in,out] nscp      Namespace context, namespaces of selected nodes are added
+ * @param[out]    xerr      Netconf error message if retval is 0
+ * @retval        1         OK
+ * @retval        0         Invalid fields parameter, xerr set
+ * @retval       -1         Error
+ */
+static int
+api_data_fields(char       *fields,
+                char       *api_path,
+                yang_stmt  *yspec,
+                cbuf       *cbxpath,
+                cvec      **nscp,
+                cxobj     **xerr)
+{
+    int     retval = -1;
+    cvec   *cvv = NULL;
+    cg_var *cv = NULL;
+    cg_var *cvn;
+    char   *s = fields;
+    char   *xpath = NULL;
+    cvec   *nsc = NULL;
+    int     ret;
+
+    if ((cvv = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if ((ret = api_data_fields_parse(&s, api_path?api_path:"", cvv)) < 0)
+        goto done;
+    if (ret == 0 || *s != '\0'){
+        if (netconf_invalid_value_xml(xerr, "application", "Invalid fields parameter") < 0)
+            goto done;
+        goto fail;
+    }
+    while ((cv = cvec_each(cvv, cv)) != NULL){
+        if ((ret = api_path2xpath(cv_string_get(cv), yspec, &xpath, &nsc, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        cprintf(cbxpath, "%s%s", cbuf_len(cbxpath)?" | ":"", xpath);
+        free(xpath);
+        xpath = NULL;
+        if (*nscp == NULL){
+            *nscp = nsc;
+            nsc = NULL;
+            continue;
+        }
+        cvn = NULL;
+        while ((cvn = cvec_each(nsc, cvn)) != NULL)
+            if (xml_nsctx_get(*nscp, cv_name_get(cvn)) == NULL &&
+                xml_nsctx_add(*nscp, cv_name_get(cvn), cv_string_get(cvn)) < 0)
+                goto done;
+        xml_nsctx_free(nsc);
+        nsc = NULL;
+    }
+    retval = 1;
+ done:
+    if (xpath)
+        free(xpath);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (cvv)
+        cvec_free(cvv);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Generic GET (both HEAD and GET)
  * According to restconf 
  * @param[in]  h        Clixon handle
@@ -93,6 +329,8 @@ static int api_data_pagination(clicon_handle h, void *req, char *api_path, int p
  * "400 Bad Request" status-line MUST be returned by the server.
  * Netconf: <get-config>, <get>                        
  * @note there is an ad-hoc method to determine json pagination request instead of regular GET
+ * @note With the fields parameter only the selected nodes are requested from the backend, the
+ *       target is then the ancestor of the selected nodes
  */
 static int
 api_data_get2(clicon_handle  h,
@@ -125,12 +363,20 @@ api_data_get2(clicon_handle  h,
     yang_stmt *y = NULL;
     char      *defaults = NULL;
     cvec      *nscd = NULL;
+    clixon_json_stream *js = NULL;
+    int        stream;
+    char      *etag = NULL;
+    struct timeval mtime = {0,};
+    char       timestr[32];
+    cbuf      *cbf = NULL;  /* Xpath of fields */
     
     clicon_debug(1, "%s", __FUNCTION__);
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_FATAL, 0, "No DB_SPEC");
         goto done;
     }
+    /* Translate JSON reply body in parts as it is sent, see CLICON_RESTCONF_STREAM_CHUNK */
+    stream = !head && clicon_option_int(h, "CLICON_RESTCONF_STREAM_CHUNK") != 0;
     /* strip /... from start */
     for (i=0; i<pi; i++)
         api_path = index(api_path+1, '/');
@@ -199,9 +445,31 @@ api_data_get2(clicon_handle  h,
         clicon_debug(1, "%s with_defaults=%s", __FUNCTION__, attr);
         defaults = attr;
     }
+    /* Check for fields attribute: get selected nodes only */
+    if ((attr = cvec_find_str(qvec, "fields")) != NULL){
+        clicon_debug(1, "%s fields=%s", __FUNCTION__, attr);
+        if ((cbf = clixon_cbuf_get()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if ((ret = api_data_fields(attr, api_path, yspec, cbf, &nsc, &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+    }
 
-    clicon_debug(1, "%s path:%s", __FUNCTION__, xpath);
-    ret = clicon_rpc_get(h, xpath, nsc, content, depth, defaults, &xret);
+    /* State data may change at any time, only config data has a version */
+    if (content == CONTENT_CONFIG){
+        if ((ret = api_data_get_conditional(h, req, media_out, head, &etag, &mtime)) < 0)
+            goto done;
+        if (ret == 1)
+            goto ok;
+    }
+    clicon_debug(1, "%s path:%s", __FUNCTION__, cbf?cbuf_get(cbf):xpath);
+    ret = clicon_rpc_get(h, cbf?cbuf_get(cbf):xpath, nsc, content, depth, defaults, &xret);
 
     if (ret < 0){
         if (netconf_operation_failed_xml(&xerr, "protocol", clicon_err_reason) < 0)
@@ -235,7 +503,16 @@ api_data_get2(clicon_handle  h,
                 goto done;
             break;
         case YANG_DATA_JSON:
-            if (clixon_json2cbuf(cbx, xret, pretty, 0, 0) < 0)
+            if (stream){
+                if ((js = clixon_json_stream_new(xret, pretty)) == NULL)
+                    goto done;
+                xret = NULL; /* consumed by stream */
+            }
+            else if (clixon_json2cbuf(cbx, xret, pretty, 0, 0) < 0)
+                goto done;
+            break;
+        case YANG_DATA_CBOR:
+            if (clixon_xml2cbor_cbuf(cbx, xret, 0) < 0)
                 goto done;
             break;
         default:
@@ -283,7 +560,15 @@ api_data_get2(clicon_handle  h,
             /* In: <x xmlns="urn:example:clixon">0</x>
              * Out: {"example:x": {"0"}}
              */
-            if (xml2json_cbuf_vec(cbx, xvec, xlen, pretty, 0) < 0)
+            if (stream){
+                if ((js = clixon_json_stream_new_vec(xvec, xlen, pretty)) == NULL)
+                    goto done;
+            }
+            else if (xml2json_cbuf_vec(cbx, xvec, xlen, pretty, 0) < 0)
+                goto done;
+            break;
+        case YANG_DATA_CBOR:
+            if (clixon_xml2cbor_cbuf_vec(cbx, xvec, xlen, 0) < 0)
                 goto done;
             break;
         default:
@@ -295,6 +580,22 @@ api_data_get2(clicon_handle  h,
         goto done;
     if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
         goto done;
+    if (etag){
+        if (restconf_reply_header(req, "ETag", "%s", etag) < 0)
+            goto done;
+        if (strftime(timestr, sizeof(timestr), "%a, %d %b %Y %H:%M:%S GMT",
+                     gmtime(&mtime.tv_sec)) > 0 &&
+            restconf_reply_header(req, "Last-Modified", "%s", timestr) < 0)
+            goto done;
+    }
+    if (js != NULL){
+        ret = restconf_reply_send_stream(req, 200, api_data_json_stream_next, js,
+                                         api_data_json_stream_free, head);
+        js = NULL; /* consumed */
+        if (ret < 0)
+            goto done;
+        goto ok;
+    }
     if (restconf_reply_send(req, 200, cbx, head) < 0)
         goto done;
     cbx = NULL;
@@ -318,6 +619,12 @@ api_data_get2(clicon_handle  h,
         xml_free(xerr);
     if (xvec)
         free(xvec);
+    if (js)
+        clixon_json_stream_free(js);
+    if (etag)
+        free(etag);
+    if (cbf)
+        clixon_cbuf_put(cbf);
     return retval;
 }
 
@@ -652,6 +959,7 @@ api_data_get(clicon_handle h,
     switch (media_out){
     case YANG_DATA_XML:
     case YANG_DATA_JSON: /* ad-hoc algorithm in get to determine if a paginated request */
+    case YANG_DATA_CBOR:
         if (api_data_get2(h, req, api_path, pi, qvec, pretty, media_out, 0) < 0)
             goto done;
         break;
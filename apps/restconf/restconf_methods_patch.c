@@ -69,6 +69,9 @@
 
 #ifdef CLIXON_YANG_PATCH
 
+/* Namespace of YANG patch status reply */
+#define YANG_PATCH_NAMESPACE "urn:ietf:params:xml:ns:yang:ietf-yang-patch"
+
 enum yang_patch_op{
     YANG_PATCH_OP_CREATE,
     YANG_PATCH_OP_DELETE,
@@ -93,632 +96,562 @@ static const map_str2int yang_patch_op_map[] = {
     {NULL,         -1}
 };
 
-static const yang_patch_op_t
+/* Edit of a YANG patch translated to netconf
+ * All edits of a patch are sent in as few edit-configs as possible. An edit-config carries
+ * edits that do not conflict, and all edit-configs are made in candidate and committed once.
+ */
+struct yang_patch_edit{
+    char  *pe_id;    /* edit-id, pointer into yang patch */
+    cxobj *pe_xc;    /* Edit as netconf <config> tree */
+    cxobj *pe_xerr;  /* Error of edit on the form <rpc-reply><rpc-error>, or NULL */
+    int    pe_batch; /* Edit-config carrying the edit */
+};
+
+static int
 yang_patch_op2int(char *op)
 {
     return clicon_str2int(yang_patch_op_map, op);
 }
 
-/*! Add square brackets after the surrounding curly brackets in JSON
-  * Needed, in order to modify the result of clixon_json2cbuf() to be valid input
-  * to api_data_post() and api_data_write()
-  * @param[in]  x_simple_patch  a cxobj to pass to clixon_json2cbuf()
-  * @retva      cbuf            With the modified json
-  * @retva      NULL            Error
-  */
-static cbuf*
-yang_patch_xml2json_modified_cbuf(cxobj *x_simple_patch)
-{
-    cbuf *json_simple_patch = NULL;
-    cbuf *cb = NULL;
-    char *json_simple_patch_tmp;
-    int   brace_count = 0;
-    size_t len;
-        
-    json_simple_patch = cbuf_new();
-    if (json_simple_patch == NULL)
-        return NULL;
-    cb = cbuf_new();
-    if (clixon_json2cbuf(cb, x_simple_patch, 0, 0) < 0)
-        goto done;
-
-    // Insert a '[' after the first '{' to get the JSON to match what api_data_post/write() expect
-    json_simple_patch_tmp = cbuf_get(cb);
-    len = strlen(json_simple_patch_tmp);
-    for (int l = 0; l < len; l++) {
-        char c = json_simple_patch_tmp[l];
-        if (c == '{') {
-            brace_count++;
-            if (brace_count == 2) { // We've reached the second brace, insert a '[' before it
-                cbuf_append(json_simple_patch,(int)'[');
-            }
-        }
-        cbuf_append(json_simple_patch,(int)c);
-    }
-
-    // Insert a ']' before the last '}' to get the JSON to match what api_data_post() expects
-    for (int l = cbuf_len(json_simple_patch) - 1; l >= 0; l--) {
-        char c = cbuf_get(json_simple_patch)[l];
-        if (c == '}') {
-            // Truncate and add a string, as there is not a function to insert a char into a cbuf
-            cbuf_trunc(json_simple_patch, l);
-            cbuf_append_str(json_simple_patch, "]}");
-            break;
-        }
-    }
-    cbuf_free(cb);
-    return json_simple_patch;
-}
-
-/*!yang_patch_strip_after_last_slash 
+/*! Parse the value of a yang patch edit and replace the target node with it
  *
- * Strip /... from end  of val
- * so that e.g. "/interface=eth2" becomes "/"
- * or "/interface_list=mylist/interface=eth2" becomes "/interface_list=mylist/"
- *
- * @param[in]  val     value to strip
- * @retval     cbuf    with the stripped string
- * @retval     NULL    error
- */
-static cbuf*
-yang_patch_strip_after_last_slash(char* val)
-{
-    cbuf *cb;
-    cbuf *val_tmp;
-    int   idx;
-    
-    cb = cbuf_new();
-    val_tmp = cbuf_new();
-    cbuf_append_str(val_tmp, val);
-    idx = cbuf_len(val_tmp);
-    for (int l = cbuf_len(val_tmp) - 1; l>= 0; l--) {
-        if (cbuf_get(val_tmp)[l] == '/') {
-            idx = l;
-            break;
-        }
-    }
-    if (idx == cbuf_len(val_tmp)) // Didn't find a slash in the loop above
-        return NULL;
-    cbuf_trunc(val_tmp, idx + 1);
-    if (cbuf_append_str(cb, cbuf_get(val_tmp)) < 0)
-        return NULL;
-    cbuf_free(val_tmp);
-    return cb;
-}
-
-/*! YANG PATCH replace method
- * @param[in]  h         Clixon handle
- * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  qvec      Vector of query string (QUERY_STRING)
- * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out Output media
- * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simplepatch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  target_val       value in "target" field of edit in YANG patch
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
+ * The value is translated to JSON with the module of the target, and parsed with the parent
+ * of the target as context, in the same way as the data of a plain PUT of the target
+ * @param[in]  yspec   Yang spec
+ * @param[in]  xvalue  XML value element of edit
+ * @param[in]  xbot    Target node of edit, replaced by the value
+ * @param[in]  ybot    Yang spec of target node
+ * @param[out] xdatap  Value in the place of xbot
+ * @param[out] xerr    Netconf error message if retval=0
+ * @retval     1       OK
+ * @retval     0       Invalid value, netconf error in xerr
+ * @retval    -1       Error
+ * @see api_data_write
  */
 static int
-yang_patch_do_replace(clicon_handle  h,
-                      void          *req,
-                      int            pi,
-                      cvec          *qvec,
-                      int            pretty,
-                      restconf_media media_out,
-                      ietf_ds_t      ds,
-                      cbuf          *simple_patch_request_uri,
-                      char          *target_val,       
-                      int            value_vec_len,
-                      cxobj        **value_vec,
-                      cxobj         *x_simple_patch
-                      )
+yang_patch_value(yang_stmt *yspec,
+                 cxobj     *xvalue,
+                 cxobj     *xbot,
+                 yang_stmt *ybot,
+                 cxobj    **xdatap,
+                 cxobj    **xerr)
 {
-    int    retval = -1;
-    cxobj *value_vec_tmp = NULL;
-    cbuf  *delete_req_uri = NULL;
-    cbuf  *post_req_uri = NULL;
-    cbuf  *json_simple_patch = NULL;
-    
-    if ((delete_req_uri = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
+    int        retval = -1;
+    cxobj     *xv;
+    cxobj     *xs = NULL;     /* Value with module name of target */
+    cxobj     *xdata0 = NULL; /* Copy of parent of target with parsed value */
+    cxobj     *xdata;
+    cxobj     *xparent;
+    cxobj     *x;
+    cxobj     *xa;
+    cxobj     *xk;
+    cxobj     *xdk;
+    yang_stmt *ymod;
+    cbuf      *cb = NULL;
+    cvec      *cvk;
+    cg_var    *cvi;
+    char      *keyname;
+    yang_bind  yb;
+    int        ret;
+
+    if ((xv = xml_child_i_type(xvalue, 0, CX_ELMNT)) == NULL){
+        if (netconf_missing_element_xml(xerr, "protocol", "value", "Edit value has no data node") < 0)
+            goto done;
+        goto fail;
     }
-    if ((json_simple_patch = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    // Make delete_req_uri something like "/restconf/data/ietf-interfaces:interfaces"
-    if (cbuf_append_str(delete_req_uri, cbuf_get(simple_patch_request_uri)) < 0){
-        clicon_err(OE_UNIX, errno, "cbuf_append_str");
+    if (ys_real_module(ybot, &ymod) < 0)
         goto done;
-    }
-
-    // Add the target to delete_req_uri,
-    // so it's something like "/restconf/data/ietf-interfaces:interfaces/interface=eth2"
-    if (cbuf_append_str(delete_req_uri, target_val) <  0){
-        clicon_err(OE_UNIX, errno, "cbuf_append_str");
+    cprintf(cb, "%s:%s", yang_argument_get(ymod), xml_name(xv));
+    if ((xs = xml_new(cbuf_get(cb), NULL, CX_ELMNT)) == NULL)
         goto done;
+    x = NULL;
+    while ((x = xml_child_each(xv, x, -1)) != NULL) {
+        if (xml_type(x) == CX_ATTR)
+            continue;
+        if ((xk = xml_dup(x)) == NULL)
+            goto done;
+        if (xml_addsub(xs, xk) < 0)
+            goto done;
     }
-
-    // Delete the object with the old values
-    if (api_data_delete(h, req, cbuf_get(delete_req_uri), pi, pretty, YANG_DATA_JSON, ds) < 0)
+    cbuf_reset(cb);
+    if (clixon_json2cbuf(cb, xs, 0, 0, 0) < 0)
         goto done;
-
-    // Now set up for the post request.
-    // Strip /... from end  of target val
-    // so that e.g. "/interface=eth2" becomes "/"
-    // or "/interface_list=mylist/interface=eth2" becomes "/interface_list=mylist/"
-    if ((post_req_uri = yang_patch_strip_after_last_slash(target_val)) == NULL)
+    /* Copy parent of target without children to hook in the parsed value */
+    xparent = xml_parent(xbot);
+    if ((xdata0 = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
         goto done;
-
-    // Make post_req_uri something like "/restconf/data/ietf-interfaces:interfaces"
-    if (cbuf_append_str(simple_patch_request_uri, cbuf_get(post_req_uri)) < 0){
-        clicon_err(OE_UNIX, errno, "cbuf_append_str");
+    if (xml_copy_one(xparent, xdata0) < 0)
         goto done;
+    xa = NULL;
+    while ((xa = xml_child_each(xparent, xa, CX_ATTR)) != NULL) {
+        if ((x = xml_new(xml_name(xa), xdata0, CX_ATTR)) == NULL)
+            goto done;
+        if (xml_copy(xa, x) < 0)
+            goto done;
+    }
+    yb = xml_spec(xdata0) ? YB_PARENT : YB_MODULE;
+    if ((ret = clixon_json_parse_string(cbuf_get(cb), 1, yb, yspec, &xdata0, xerr)) < 0){
+        if (netconf_malformed_message_xml(xerr, clicon_err_reason) < 0)
+            goto done;
+        goto fail;
+    }
+    if (ret == 0)
+        goto fail;
+    if (xml_child_nr_type(xdata0, CX_ELMNT) != 1){
+        if (netconf_malformed_message_xml(xerr, "The edit value MUST contain exactly one instance of the target data resource") < 0)
+            goto done;
+        goto fail;
     }
-    // Now insert the new values into the data
-    // (which will include the key value and all other mandatory values)
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
+    xdata = xml_child_i_type(xdata0, 0, CX_ELMNT);
+    if (strcmp(xml_name(xdata), xml_name(xbot)) != 0){
+        if (netconf_bad_element_xml(xerr, "application", xml_name(xdata),
+                                    "Data element does not match edit target") < 0)
+            goto done;
+        goto fail;
+    }
+    /* Keys of target may be omitted in value, but not changed */
+    if (yang_keyword_get(ybot) == Y_LIST){
+        cvk = yang_cvec_get(ybot);
+        cvi = NULL;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+            keyname = cv_string_get(cvi);
+            if ((xk = xml_find_type(xbot, NULL, keyname, CX_ELMNT)) == NULL)
+                continue;
+            if ((xdk = xml_find_type(xdata, NULL, keyname, CX_ELMNT)) != NULL){
+                if (clicon_strcmp(xml_body(xk), xml_body(xdk)) != 0){
+                    if (netconf_operation_failed_xml(xerr, "protocol", "api-path keys do not match data keys") < 0)
+                        goto done;
+                    goto fail;
+                }
+                continue;
+            }
+            if ((xdk = xml_dup(xk)) == NULL)
+                goto done;
+            if (xml_addsub(xdata, xdk) < 0)
+                goto done;
         }
+        if (xml_sort(xdata) < 0)
+            goto done;
     }
-    // Convert the data to json
-    if (clixon_json2cbuf(json_simple_patch, x_simple_patch, 0, 0) < 0)
+    if (xml_purge(xbot) < 0)
         goto done;
-
-    // Send the POST request
-    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri), pi, qvec, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, ds ) < 0)
+    if (xml_addsub(xparent, xdata) < 0)
         goto done;
-    retval = 0;
+    *xdatap = xdata;
+    retval = 1;
  done:
-    if (post_req_uri)
-        cbuf_free(post_req_uri);
-    if (delete_req_uri)
-        cbuf_free(delete_req_uri);
-    if (json_simple_patch)
-        cbuf_free(json_simple_patch);
-    if (value_vec_tmp)
-        xml_free(value_vec_tmp);
+    if (cb)
+        clixon_cbuf_put(cb);
+    if (xs)
+        xml_free(xs);
+    if (xdata0)
+        xml_free(xdata0);
     return retval;
+ fail:
+    retval = 0;
+    goto done;
 }
 
-/*! YANG PATCH create method
- * @param[in]  h         Clixon handle
- * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  qvec      Vector of query string (QUERY_STRING)
- * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out Output media
- * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simplepatch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
+/*! Translate a yang patch edit to a netconf edit-config <config> tree
+ *
+ * The target of the edit is given a netconf operation attribute: create, merge, replace,
+ * delete or remove. Insert is create with yang insert attributes, move is not supported.
+ * @param[in]  yspec     Yang spec
+ * @param[in]  xn        XML edit element
+ * @param[in]  api_path  api-path of patch resource, or NULL
+ * @param[out] pe        Edit with <config> tree in pe_xc, or error in pe_xerr
+ * @retval     1         OK
+ * @retval     0         Invalid edit, netconf error in pe_xerr
+ * @retval    -1         Error
  */
 static int
-yang_patch_do_create(clicon_handle  h,
-                     void          *req,
-                     int            pi,
-                     cvec          *qvec,
-                     int            pretty,
-                     restconf_media media_out,
-                     ietf_ds_t      ds,
-                     cbuf          *simple_patch_request_uri,
-                     int            value_vec_len,
-                     cxobj        **value_vec,
-                     cxobj         *x_simple_patch
-                     )
+yang_patch_edit2xml(yang_stmt              *yspec,
+                    cxobj                  *xn,
+                    char                   *api_path,
+                    struct yang_patch_edit *pe)
 {
-    int    retval = -1;
-    cxobj *value_vec_tmp = NULL;
-    cbuf  *cb = NULL;
-    
-    // Send the POST request
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
+    int                 retval = -1;
+    char               *target;
+    char               *opstr;
+    char               *where = NULL;
+    char               *point = NULL;
+    enum operation_type op;
+    cxobj              *xc = NULL;
+    cxobj              *xbot = NULL;
+    cxobj              *xdata = NULL;
+    cxobj              *xvalue;
+    yang_stmt          *ybot = NULL;
+    cbuf               *cb = NULL;
+    cvec               *qvec = NULL;
+    cg_var             *cv;
+    char               *xpath = NULL;
+    cvec               *nsc = NULL;
+    int                 ret;
+
+    clicon_debug_xml(1, xn, "%s xn:", __FUNCTION__);
+    pe->pe_id = xml_find_body(xn, "edit-id");
+    if ((target = xml_find_body(xn, "target")) == NULL){
+        if (netconf_missing_element_xml(&pe->pe_xerr, "protocol", "target", NULL) < 0)
+            goto done;
+        goto fail;
+    }
+    if ((opstr = xml_find_body(xn, "operation")) == NULL){
+        if (netconf_missing_element_xml(&pe->pe_xerr, "protocol", "operation", NULL) < 0)
+            goto done;
+        goto fail;
     }
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            if ((value_vec_tmp = xml_dup(value_vec[k])) == NULL)
+    switch (yang_patch_op2int(opstr)){
+    case YANG_PATCH_OP_CREATE:
+        op = OP_CREATE;
+        break;
+    case YANG_PATCH_OP_DELETE:
+        op = OP_DELETE;
+        break;
+    case YANG_PATCH_OP_INSERT:
+        op = OP_CREATE;
+        where = xml_find_body(xn, "where");
+        point = xml_find_body(xn, "point");
+        if (where == NULL){
+            if (netconf_missing_element_xml(&pe->pe_xerr, "protocol", "where", NULL) < 0)
                 goto done;
-            xml_addsub(x_simple_patch, value_vec_tmp);
+            goto fail;
         }
+        if (point == NULL &&
+            (strcmp(where, "before") == 0 || strcmp(where, "after") == 0)){
+            if (netconf_missing_element_xml(&pe->pe_xerr, "protocol", "point", NULL) < 0)
+                goto done;
+            goto fail;
+        }
+        break;
+    case YANG_PATCH_OP_MERGE:
+        op = OP_MERGE;
+        break;
+    case YANG_PATCH_OP_REPLACE:
+        op = OP_REPLACE;
+        break;
+    case YANG_PATCH_OP_REMOVE:
+        op = OP_REMOVE;
+        break;
+    case YANG_PATCH_OP_MOVE: /* Existing entries are not moved by netconf insert */
+        if (netconf_operation_not_supported_xml(&pe->pe_xerr, "protocol", "YANG patch move operation not supported") < 0)
+            goto done;
+        goto fail;
+        break;
+    default:
+        if (netconf_invalid_value_xml(&pe->pe_xerr, "protocol", "Invalid YANG patch operation") < 0)
+            goto done;
+        goto fail;
+        break;
     }
-    if (clixon_json2cbuf(cb, x_simple_patch, 0, 0) < 0)
-        goto done;
-    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri),
-                      pi, qvec,
-                      cbuf_get(cb), pretty, YANG_DATA_JSON, media_out, ds) < 0)
-        goto done;
-     retval = 0;
- done:
-     if (cb)
-         cbuf_free(cb);
-    return retval;
-}
-
-/*! YANG PATCH insert method
- * @param[in]  h         Clixon handle
- * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out Output media
- * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simple_patch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
- * @param[in]  where_val       value in "where" field of edit in YANG patch
- * @param[in]  api_path        full API path, e.g. "/restconf/data/example-jukebox:jukebox/playlist=Foo-One" 
- * @param[in]  point_val       value in "point" field of edit in YANG patch
- */
-static int
-yang_patch_do_insert(clicon_handle  h,
-                     void          *req,
-                     int            pi,
-                     int            pretty,
-                     restconf_media media_out,
-                     ietf_ds_t      ds,
-                     cbuf          *simple_patch_request_uri,
-                     int            value_vec_len,
-                     cxobj        **value_vec,
-                     cxobj         *x_simple_patch,
-                     char          *where_val,
-                     char          *api_path,
-                     char          *point_val
-                     )
-{
-    int     retval = -1;
-    cxobj  *value_vec_tmp = NULL;
-    cbuf   *json_simple_patch;
-    cg_var *cv;
-    cbuf   *point_str = NULL;
-    cvec   *qvec_tmp = NULL;
-    
-    if ((point_str = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    if ((qvec_tmp = cvec_new(0)) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
+    cprintf(cb, "%s%s", api_path?api_path:"", target);
+    if ((xc = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    xbot = xc;
+    if ((ret = api_path2xml(cbuf_get(cb), yspec, xc, YC_DATANODE, 1, &xbot, &ybot, &pe->pe_xerr)) < 0)
         goto done;
+    if (ret == 0)
+        goto fail;
+    if (xbot == xc || ybot == NULL){
+        if (netconf_invalid_value_xml(&pe->pe_xerr, "protocol", "Edit target is not a data resource") < 0)
+            goto done;
+        goto fail;
     }
-    // Loop through the XML, and get each value
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
+    if (op == OP_DELETE || op == OP_REMOVE)
+        xdata = xbot;
+    else {
+        if ((xvalue = xml_find_type(xn, NULL, "value", CX_ELMNT)) == NULL){
+            if (netconf_missing_element_xml(&pe->pe_xerr, "protocol", "value", NULL) < 0)
+                goto done;
+            goto fail;
         }
+        if ((ret = yang_patch_value(yspec, xvalue, xbot, ybot, &xdata, &pe->pe_xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
     }
-    if ((json_simple_patch = yang_patch_xml2json_modified_cbuf(x_simple_patch)) == NULL)
-        goto done;
-
-    // Set the insert attributes
-    if ((cv = cvec_add(qvec_tmp, CGV_STRING)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_add");
-        goto done;
+    if (where){
+        /* Translate to restconf insert/point query parameters */
+        if ((qvec = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if ((cv = cvec_add(qvec, CGV_STRING)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_add");
+            goto done;
+        }
+        cv_name_set(cv, "insert");
+        cv_string_set(cv, where);
+        if (point){
+            cbuf_reset(cb);
+            cprintf(cb, "%s%s", api_path?api_path:"", point);
+            if ((ret = api_path2xpath(cbuf_get(cb), yspec, &xpath, &nsc, &pe->pe_xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+            if ((cv = cvec_add(qvec, CGV_STRING)) == NULL){
+                clicon_err(OE_UNIX, errno, "cvec_add");
+                goto done;
+            }
+            cv_name_set(cv, "point");
+            cv_string_set(cv, cbuf_get(cb));
+        }
+        if (restconf_insert_attributes(xdata, qvec) < 0)
+            goto done;
     }
-    cv_name_set(cv, "insert");
-    if (where_val)
-        cv_string_set(cv, where_val);
-    cbuf_append_str(point_str, api_path);
-    if (point_val)
-        cbuf_append_str(point_str, point_val);
-    if ((cv = cvec_add(qvec_tmp, CGV_STRING)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_add");
+    if (xml_add_attr(xdata, "operation", xml_operation2str(op), NETCONF_BASE_PREFIX, NULL) < 0)
         goto done;
-    }
-    cv_name_set(cv, "point");
-    cv_string_set(cv, cbuf_get(point_str));
-
-    // Send the POST request
-    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri), pi, qvec_tmp, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, ds)<  0)
+    if (xml_sort_recurse(xc) < 0)
         goto done;
-    retval = 0;
+    pe->pe_xc = xc;
+    xc = NULL;
+    retval = 1;
  done:
-    if (qvec_tmp)
-        cvec_free(qvec_tmp);
-    if (point_str)
-        cbuf_free(point_str);
-    if (json_simple_patch)
-        cbuf_free(json_simple_patch);
+    if (xpath)
+        free(xpath);
+    if (nsc)
+        cvec_free(nsc);
+    if (qvec)
+        cvec_free(qvec);
+    if (cb)
+        clixon_cbuf_put(cb);
+    if (xc)
+        xml_free(xc);
     return retval;
+ fail:
+    retval = 0;
+    goto done;
 }
 
-/*! YANG PATCH merge method
- * @param[in]  h         Clixon handle
- * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  qvec      Vector of query string (QUERY_STRING)
- * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out Output media
- * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simple_patch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. "<ietf-interfaces:interface/>"
- * @param[in]  where_val       value in "where" field of edit in YANG patch
- * @param[in]  key_xn          XML with key tag and value, e.g. "<name>Foo-One</name>"
+/*! Send edits of a yang patch to candidate in one netconf edit-config
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  xc      Edits as <config> tree
+ * @param[in]  ds      0 if "data" resource, 1 if rfc8527 "ds" resource
+ * @param[in]  commit  Set if candidate is committed with the edit, ie the last of a patch
+ * @param[out] xret    Reply from backend, free with xml_free
+ * @retval     0       OK, reply may be an rpc-error
+ * @retval    -1       Error
+ * @see api_data_delete
  */
 static int
-yang_patch_do_merge(clicon_handle  h,
-                    void          *req,
-                    int            pi,
-                    cvec          *qvec,
-                    int            pretty,
-                    restconf_media media_out,
-                    ietf_ds_t      ds,
-                    cbuf          *simple_patch_request_uri,
-                    int            value_vec_len,
-                    cxobj        **value_vec,
-                    cxobj         *x_simple_patch,
-                    cxobj         *key_xn
-                    )
+yang_patch_edit_config(clicon_handle h,
+                       cxobj        *xc,
+                       ietf_ds_t     ds,
+                       int           commit,
+                       cxobj       **xret)
 {
-    int    retval = -1;
-    cxobj *value_vec_tmp = NULL;
-    cbuf  *cb = NULL;
-    cbuf  *json_simple_patch = NULL;
-        
-    if ((cb = cbuf_new()) == NULL){
+    int        retval = -1;
+    cbuf      *cbx = NULL;
+    char      *username;
+    yang_stmt *yspec;
+
+    yspec = clicon_dbspec_yang(h);
+    if ((cbx = clixon_cbuf_get()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    if (key_xn != NULL)
-        xml_addsub(x_simple_patch, key_xn);
-    
-    // Loop through the XML, create JSON from each one, and submit a simple patch
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
-        }
-        cbuf_reset(cb); /* reuse cb */
-        if (clixon_json2cbuf(cb, x_simple_patch, 0, 0) < 0)
-            goto done;
-
-        if ((json_simple_patch = yang_patch_xml2json_modified_cbuf(x_simple_patch)) == NULL)
-            goto done;
-        // Send the simple patch request
-        if (api_data_write(h, req, cbuf_get(simple_patch_request_uri), pi, qvec, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, 1, ds ) < 0)
-            goto done;
-        if (json_simple_patch){
-            cbuf_free(json_simple_patch);
-            json_simple_patch = NULL;
+    /* For internal XML protocol: add username attribute for access control
+     */
+    cprintf(cbx, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cbx, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cbx, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cbx, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cbx, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cbx, ">");
+    cprintf(cbx, "<edit-config");
+    if (commit){
+        /* RFC8040 Sec 1.4: update startup after running, see api_data_write */
+        if ((IETF_DS_NONE == ds) &&
+            if_feature(yspec, "ietf-netconf", "startup") &&
+            !clicon_option_bool(h, "CLICON_RESTCONF_STARTUP_DONTUPDATE")){
+            cprintf(cbx, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+            cprintf(cbx, " %s:copystartup=\"true\"", CLIXON_LIB_PREFIX);
         }
+        cprintf(cbx, " %s:autocommit=\"true\" xmlns:%s=\"%s\"",
+                CLIXON_LIB_PREFIX, CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
+    cprintf(cbx, "><target><candidate /></target>");
+    cprintf(cbx, "<default-operation>none</default-operation>");
+    if (clixon_xml2cbuf(cbx, xc, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    cprintf(cbx, "</edit-config></rpc>");
+    if (clicon_rpc_netconf(h, cbuf_get(cbx), xret, NULL) < 0)
+        goto done;
     retval = 0;
  done:
-    if (cb)
-        cbuf_free(cb);
-    if (json_simple_patch)
-        cbuf_free(json_simple_patch);
+    if (cbx)
+        clixon_cbuf_put(cbx);
     return retval;
 }
 
-/*! Process a single yang patch "edit/value" element
+/*! Find the edit of a yang patch that failed an edit-config
  *
- * @param[in]  xn        XML value element
- * @retval     0         OK
- * @retval    -1         Error
+ * Changes in candidate are first discarded. If the failed edit-config carried several edits,
+ * the edits up to and including it are made again one by one in candidate until one fails,
+ * and are then discarded. This is only made on error.
+ * @param[in]  h       Clixon handle
+ * @param[in]  pe      Edits
+ * @param[in]  nedits  Number of edits
+ * @param[in]  batch   Failed edit-config
+ * @param[in]  xret    Reply of failed edit-config, consumed if edit found
+ * @param[out] ip      Index of failed edit, its pe_xerr is set
+ * @retval     1       Edit found
+ * @retval     0       Not found, eg commit validation error, xret is a global error
+ * @retval    -1       Error
  */
 static int
-yang_patch_do_value(clicon_handle  h,
-                    void          *req,
-                    int            pi,
-                    cvec          *qvec,
-                    int            pretty,
-                    restconf_media media_out,
-                    ietf_ds_t      ds,
-                    cxobj         *xn,
-                    char          *modname,
-                    yang_patch_op_t operation,
-                    char          *where_val,
-                    char          *point_val,
-                    cbuf          *simple_patch_request_uri,
-                    char          *target_val,
-                    char          *api_path,
-                    cxobj         *key_xn
-                    )
+yang_patch_edit_find(clicon_handle           h,
+                     struct yang_patch_edit *pe,
+                     int                     nedits,
+                     int                     batch,
+                     cxobj                 **xret,
+                     int                    *ip)
 {
-    int     retval = -1;
-    cxobj **values_child_vec;
-    char   *key_node_id;
-    cbuf   *patch_header = NULL;
-    cxobj  *x_simple_patch = NULL;
-    int     value_vec_len;
-    cxobj **value_vec;
+    int    retval = -1;
+    int    i;
+    int    n = 0;
+    cxobj *xr = NULL;
 
-    values_child_vec = xml_childvec_get(xn);
-    key_node_id = xml_name(*values_child_vec);
-    /* Create cbufs:s */
-    if ((patch_header = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
+    if (clicon_rpc_discard_changes(h) < 0)
         goto done;
+    for (i=0; i<nedits; i++)
+        if (pe[i].pe_batch == batch){
+            *ip = i;
+            n++;
+        }
+    if (n == 1){
+        pe[*ip].pe_xerr = *xret;
+        *xret = NULL;
+        goto found;
     }
-    cprintf(patch_header, "%s:%s", modname, key_node_id);
-    if ((x_simple_patch = xml_new(cbuf_get(patch_header), NULL, CX_ELMNT)) == NULL)
-        goto done;
-    value_vec_len = xml_child_nr(*values_child_vec);
-    value_vec = xml_childvec_get(*values_child_vec);
-    switch (operation){
-    case YANG_PATCH_OP_REPLACE:
-        if (yang_patch_do_replace(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, target_val, value_vec_len, value_vec, x_simple_patch) < 0)
-            goto done;
-        break;
-    case YANG_PATCH_OP_CREATE:
-        if (yang_patch_do_create(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch) < 0)
+    for (i=0; i<nedits && pe[i].pe_batch <= batch; i++){
+        if (yang_patch_edit_config(h, pe[i].pe_xc, IETF_DS_NONE, 0, &xr) < 0)
             goto done;
-        break;
-    case YANG_PATCH_OP_INSERT:
-        if (yang_patch_do_insert(h, req, pi, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch, where_val, api_path, point_val) < 0)
-            goto done;
-        break;
-    case YANG_PATCH_OP_MERGE:
-        if (yang_patch_do_merge(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch, key_xn) < 0)
-            goto done;
-        break;
-    default:
-        break;
-    }
-    retval = 0;
+        if (xpath_first(xr, NULL, "//rpc-error") != NULL)
+            break;
+        xml_free(xr);
+        xr = NULL;
+    }
+    if (clicon_rpc_discard_changes(h) < 0)
+        goto done;
+    if (xr == NULL)
+        goto notfound;
+    pe[i].pe_xerr = xr;
+    xr = NULL;
+    *ip = i;
+ found:
+    retval = 1;
  done:
-    if (x_simple_patch)
-        xml_free(x_simple_patch);
-    if (patch_header)
-        cbuf_free(patch_header);
+    if (xr)
+        xml_free(xr);
     return retval;
+ notfound:
+    retval = 0;
+    goto done;
 }
 
-/*! Process a single yang patch "edit" element
+/*! Reply to a yang patch with yang-patch-status, RFC 8072 Sec 2.3
  *
  * @param[in]  h         Clixon handle
  * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  qvec      Vector of query string (QUERY_STRING)
+ * @param[in]  patch_id  patch-id of yang patch
+ * @param[in]  edit_id   edit-id of failed edit, or NULL if global error or OK
+ * @param[in]  xerr      Error on the form <rpc-reply><rpc-error>, or NULL if OK
  * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
  * @param[in]  media_out Output media
- * @param[in]  xn        XML edit element
  * @retval     0         OK
  * @retval    -1         Error
  */
 static int
-yang_patch_do_edit(clicon_handle  h,
-                   void          *req,
-                   int            pi,
-                   cvec          *qvec,
-                   int            pretty,
-                   restconf_media media_out,
-                   ietf_ds_t      ds,
-                   yang_stmt     *yspec,
-                   cxobj         *xn,
-                   char          *uripath0,
-                   char          *api_path
-                   )
+yang_patch_status_reply(clicon_handle  h,
+                        void          *req,
+                        char          *patch_id,
+                        char          *edit_id,
+                        cxobj         *xerr,
+                        int            pretty,
+                        restconf_media media_out)
 {
-    int        retval = -1;
-    cxobj    **vec = NULL;
-    size_t     veclen = 0;
-    int        ret;
-    cxobj     *xerr = NULL;    /* malloced must be freed */
-    cxobj     *xtop; 
-    cxobj     *xbot = NULL;
-    yang_patch_op_t operation;
-    char      *where_val = NULL;
-    char      *point_val = NULL;
-    char      *target_val = NULL;
-    char      *modname;
-    cxobj    **key_vec = NULL;
-    cxobj     *key_xn = NULL;
-    int        i;
-    cxobj     *x; /* general purpose xml-tree pointer */
-    cbuf      *simple_patch_request_uri = NULL;
-    cbuf      *api_path_target = NULL;
-    yang_stmt *ybot = NULL;
-    yang_stmt *ymod;
+    int    retval = -1;
+    int    xml;
+    int    code = 200;
+    cxobj *xs = NULL;
+    cxobj *xp;
+    cxobj *xe;
+    cxobj *x;
+    cbuf  *cb = NULL;
+    char  *tag;
 
-    clicon_debug_xml(1, xn, "%s %d xn:", __FUNCTION__, __LINE__);
-    /* Create cbufs:s */
-    if ((simple_patch_request_uri = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
+    xml = (media_out == YANG_DATA_XML || media_out == YANG_PATCH_XML);
+    /* Module name as prefix of JSON top-level member */
+    if ((xs = xml_new(xml?"yang-patch-status":"ietf-yang-patch:yang-patch-status", NULL, CX_ELMNT)) == NULL)
         goto done;
-    }
-    if ((api_path_target = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
+    if (xml && xml_add_attr(xs, "xmlns", YANG_PATCH_NAMESPACE, NULL, NULL) < 0)
         goto done;
-    }
-    if ((x = xpath_first(xn, NULL, "target")) == NULL){
-        clicon_err(OE_YANG, 0, "target mandatory element not found");
+    if (xml_new_body("patch-id", xs, patch_id?patch_id:"") == NULL)
         goto done;
+    if (xerr == NULL){
+        if (xml_new("ok", xs, CX_ELMNT) == NULL)
+            goto done;
     }
-    target_val = xml_body(x);
-    if ((x = xpath_first(xn, NULL, "operation")) == NULL){
-        clicon_err(OE_YANG, 0, "operation mandatory element not found");
-        goto done;
+    else {
+        if ((xe = xpath_first(xerr, NULL, "//rpc-error")) == NULL){
+            clicon_err(OE_XML, 0, "Expected rpc-error");
+            goto done;
+        }
+        if ((tag = xml_find_body(xe, "error-tag")) == NULL ||
+            (code = restconf_err2code(tag)) < 0)
+            code = 500; /* internal server error */
+        xp = xs;
+        if (edit_id){
+            if ((xp = xml_new("edit-status", xp, CX_ELMNT)) == NULL)
+                goto done;
+            if ((xp = xml_new("edit", xp, CX_ELMNT)) == NULL)
+                goto done;
+            if (xml_new_body("edit-id", xp, edit_id) == NULL)
+                goto done;
+        }
+        if ((xp = xml_new("errors", xp, CX_ELMNT)) == NULL)
+            goto done;
+        if ((x = xml_dup(xe)) == NULL)
+            goto done;
+        if (xml_name_set(x, "error") < 0)
+            goto done;
+        if (xml_addsub(xp, x) < 0)
+            goto done;
     }
-    operation = yang_patch_op2int(xml_body(x));
-    /* target and operation are mandatory */
-    if (target_val == NULL){
-        clicon_err(OE_YANG, 0, "operation/target: mandatory element not found");
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    if (operation == YANG_PATCH_OP_INSERT){
-        if ((x = xpath_first(xn, NULL, "point")) != NULL)
-            point_val = xml_body(x);
-        if ((x = xpath_first(xn, NULL, "where")) != NULL)
-            where_val = xml_body(x);
-        if (point_val == NULL || where_val == NULL){
-            clicon_err(OE_YANG, 0, "point/where: expected element not found");
+    if (xml){
+        if (clixon_xml2cbuf(cb, xs, 0, pretty, NULL, -1, 0) < 0)
             goto done;
-        }       
-    }
-    // Construct request URI
-    cprintf(simple_patch_request_uri, "%s", uripath0);
-    cprintf(api_path_target, "%s", api_path);
-    if (operation == YANG_PATCH_OP_MERGE) {
-        cbuf_append_str(api_path_target, target_val);
-        cbuf_append_str(simple_patch_request_uri, target_val);
     }
-
-    if ((xtop = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+    else if (clixon_json2cbuf(cb, xs, pretty, 0, 0) < 0)
         goto done;
-
-    // Get key field
-    /* Translate api_path to xml in the form of xtop/xbot */
-    xbot = xtop;
-    if ((ret = api_path2xml(cbuf_get(api_path_target), yspec, xtop, YC_DATANODE, 1, &xbot, &ybot, &xerr)) < 0)
+    cprintf(cb, "\r\n");
+    if (restconf_reply_header(req, "Content-Type", "%s",
+                              restconf_media_int2str(xml?YANG_DATA_XML:YANG_DATA_JSON)) < 0)
         goto done;
-    if (ret == 0){ /* validation failed */
-        if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
-            goto done;
-        goto ok;
-    }
-    /* Get module name */
-    if (ys_real_module(ybot, &ymod) < 0)
+    if (restconf_reply_send(req, code, cb, 0) < 0)
         goto done;
-    modname = yang_argument_get(ymod);
-    // XXX this seems to be hardcoded to a yang list?
-    if ((key_vec = xml_childvec_get(xbot)) != NULL)
-        key_xn = key_vec[0];
-    // Get values (for "delete" and "remove", there are no values)
-    xpath_vec(xn, NULL, "value", &vec, &veclen);
-
-    // Loop through the values
-    for (i = 0; i < veclen; i++) {
-        if (yang_patch_do_value(h, req, pi, qvec, pretty, media_out, ds,
-                                vec[i], modname,
-                                operation, where_val, point_val, simple_patch_request_uri, target_val,
-                                api_path, key_xn) < 0)
-            goto done;
-    }
-    if (operation == YANG_PATCH_OP_DELETE ||
-        operation == YANG_PATCH_OP_REMOVE){
-        cbuf_append_str(simple_patch_request_uri, target_val);
-        if (operation == YANG_PATCH_OP_DELETE) {
-            // TODO - send error
-        } else {
-            // TODO - do not send error
-        }
-        api_data_delete(h, req, cbuf_get(simple_patch_request_uri), pi, pretty, YANG_DATA_JSON, ds); 
-    }
- ok:
+    cb = NULL;
     retval = 0;
  done:
-    if (vec)
-        free(vec);
-    if (simple_patch_request_uri)
-        cbuf_free(simple_patch_request_uri);
-    if (api_path_target)
-        cbuf_free(api_path_target);
-    if (xtop)
-        xml_free(xtop);
-    if (xerr)
-        xml_free(xerr);
+    if (cb)
+        cbuf_free(cb);
+    if (xs)
+        xml_free(xs);
     return retval;
 }
 
@@ -735,10 +668,14 @@ yang_patch_do_edit(clicon_handle  h,
  * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
  * @retval     0         OK
  * @retval    -1         Error
- * Netconf:  <edit-config> (nc:operation="merge")
+ * Netconf:  <edit-config> with nc:operation of each edit
  * @see RFC8072
  * YANG patch can be used to "create", "delete", "insert", "merge", "move", "replace", and/or
    "remove" a resource within the target resource.
+ * All edits are translated before any is sent. Edits that do not conflict are combined in one
+ * edit-config, in the common case all edits of the patch. The edit-configs are made in
+ * candidate, and the last commits the patch, so that the patch is applied in one commit or
+ * not at all. The reply is a yang-patch-status with the failed edit if any.
  * Currently "move" not supported
  */
 int
@@ -753,16 +690,24 @@ api_data_yang_patch(clicon_handle  h,
                     restconf_media media_out,
                     ietf_ds_t      ds)
 {
-    int            retval = -1;
-    int            i;
-    cxobj         *xpatch = NULL; 
-    yang_stmt     *yspec;
-    char          *api_path;
-    cxobj         *xerr = NULL;    /* malloced must be freed */
-    int            ret;
-    char          *uripath0 = NULL;
-    size_t         veclen;
-    cxobj        **vec = NULL;
+    int                     retval = -1;
+    int                     i;
+    cxobj                  *xpatch = NULL;
+    cxobj                  *xyp;
+    yang_stmt              *yspec;
+    char                   *api_path;
+    char                   *patch_id;
+    cxobj                  *xerr = NULL;    /* malloced must be freed */
+    int                     ret;
+    size_t                  veclen = 0;
+    cxobj                 **vec = NULL;
+    struct yang_patch_edit *pe = NULL;
+    cxobj                 **xbatch = NULL;  /* Combined edits of each edit-config */
+    int                     nbatch = 0;
+    int                     b;
+    cxobj                  *xd = NULL;
+    cxobj                  *xret = NULL;
+    char                   *reason = NULL;
 
     clicon_debug(1, "%s api_path:\"%s\"",  __FUNCTION__, api_path0);
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
@@ -805,35 +750,103 @@ api_data_yang_patch(clicon_handle  h,
             goto done;
         goto ok;
     }
-    /* 
+    /*
      * RFC 8072 2.1: The message-body MUST identify exactly one resource instance
      */
-    if (xml_child_nr_type(xpatch, CX_ELMNT) != 1){
+    if (xml_child_nr_type(xpatch, CX_ELMNT) != 1 ||
+        (xyp = xpath_first(xpatch, NULL, "yang-patch")) == NULL){
         if (netconf_malformed_message_xml(&xerr, "The message-body MUST contain exactly one instance of the expected data resource") < 0)
             goto done;
         if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
             goto done;
         goto ok;
     }
-    /* Save original uripath (will be changed by sub-calls) */
-    if ((uripath0 = restconf_uripath(h)) == NULL)
+    patch_id = xml_find_body(xyp, "patch-id");
+    if (xpath_vec(xyp, NULL, "edit", &vec, &veclen) < 0)
         goto done;
-    /* Find all edit operations and loop over them
-     */    
-    if (xpath_vec(xpatch, NULL, "yang-patch/edit", &vec, &veclen) < 0)
+    if (veclen &&
+        ((pe = calloc(veclen, sizeof(*pe))) == NULL ||
+         (xbatch = calloc(veclen, sizeof(*xbatch))) == NULL)){
+        clicon_err(OE_UNIX, errno, "calloc");
         goto done;
+    }
+    /* Translate all edits before any is sent, an invalid edit fails the patch */
+    for (i = 0; i < veclen; i++) {
+        if ((ret = yang_patch_edit2xml(yspec, vec[i], api_path, &pe[i])) < 0)
+            goto done;
+        if (ret == 0){
+            if (yang_patch_status_reply(h, req, patch_id, pe[i].pe_id, pe[i].pe_xerr, pretty, media_out) < 0)
+                goto done;
+            goto ok;
+        }
+    }
+    /* Combine each edit with the previous edits unless they conflict */
     for (i = 0; i < veclen; i++) {
-        if (yang_patch_do_edit(h, req, pi, qvec, pretty, media_out, ds,
-                               yspec,
-                               vec[i],
-                               uripath0, api_path) < 0)
+        ret = 1;
+        if (nbatch &&
+            (ret = xml_edit_conflict(xbatch[nbatch-1], pe[i].pe_xc)) < 0)
             goto done;
+        if ((xd = xml_dup(pe[i].pe_xc)) == NULL)
+            goto done;
+        if (ret == 1) /* New edit-config */
+            xbatch[nbatch++] = xd;
+        else {
+            if ((ret = xml_merge(xbatch[nbatch-1], xd, yspec, &reason)) < 0)
+                goto done;
+            if (ret == 0){
+                clicon_err(OE_XML, 0, "%s", reason);
+                goto done;
+            }
+            xml_free(xd);
+        }
+        xd = NULL;
+        pe[i].pe_batch = nbatch-1;
+    }
+    clicon_debug(1, "%s edits:%zu edit-configs:%d", __FUNCTION__, veclen, nbatch);
+    for (b = 0; b < nbatch; b++){
+        if (yang_patch_edit_config(h, xbatch[b], ds, b==nbatch-1, &xret) < 0)
+            goto done;
+        if (xpath_first(xret, NULL, "//rpc-error") != NULL)
+            break;
+        xml_free(xret);
+        xret = NULL;
     }
+    if (b < nbatch){ /* Edit-config b failed */
+        if ((ret = yang_patch_edit_find(h, pe, veclen, b, &xret, &i)) < 0)
+            goto done;
+        if (ret == 1){
+            if (yang_patch_status_reply(h, req, patch_id, pe[i].pe_id, pe[i].pe_xerr, pretty, media_out) < 0)
+                goto done;
+        }
+        else if (yang_patch_status_reply(h, req, patch_id, NULL, xret, pretty, media_out) < 0)
+            goto done;
+        goto ok;
+    }
+    if (yang_patch_status_reply(h, req, patch_id, NULL, NULL, pretty, media_out) < 0)
+        goto done;
  ok:
     retval = 0;
  done:
-    if (uripath0)
-        free(uripath0);
+    if (pe){
+        for (i = 0; i < veclen; i++){
+            if (pe[i].pe_xc)
+                xml_free(pe[i].pe_xc);
+            if (pe[i].pe_xerr)
+                xml_free(pe[i].pe_xerr);
+        }
+        free(pe);
+    }
+    if (xbatch){
+        for (b = 0; b < nbatch; b++)
+            xml_free(xbatch[b]);
+        free(xbatch);
+    }
+    if (xd)
+        xml_free(xd);
+    if (xret)
+        xml_free(xret);
+    if (reason)
+        free(reason);
     if (vec)
         free(vec);
     if (xerr)
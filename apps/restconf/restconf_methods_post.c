@@ -87,7 +87,7 @@ http_location_header(clicon_handle h,
     if ((request_uri = restconf_uripath(h)) == NULL)
         goto done;
     if (xobj != NULL){
-        if ((cb = cbuf_new()) == NULL){
+        if ((cb = clixon_cbuf_get()) == NULL){
             clicon_err(OE_UNIX, 0, "cbuf_new");
             goto done;
         }
@@ -109,7 +109,7 @@ http_location_header(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (request_uri)
         free(request_uri);
     return retval;
@@ -263,6 +263,20 @@ api_data_post(clicon_handle h,
             goto ok;
         }
         break;
+    case YANG_DATA_CBOR:
+        if ((ret = restconf_cbor_parse(h, data, yb, yspec, &xbot, &xerr)) < 0){
+            if (netconf_malformed_message_xml(&xerr, clicon_err_reason) < 0)
+                goto done;
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        if (ret == 0){
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        break;
     default:
         restconf_unsupported_media(h, req, pretty, media_out);
         goto ok;
@@ -330,7 +344,7 @@ api_data_post(clicon_handle h,
 #endif
 
     /* Create text buffer for transfer to backend */
-    if ((cbx = cbuf_new()) == NULL){
+    if ((cbx = clixon_cbuf_get()) == NULL){
         clicon_err(OE_UNIX, 0, "cbuf_new");
         goto done;
     }
@@ -392,7 +406,7 @@ api_data_post(clicon_handle h,
     if (xtop)
         xml_free(xtop);
      if (cbx)
-        cbuf_free(cbx); 
+        clixon_cbuf_put(cbx); 
    return retval;
 } /* api_data_post */
 
@@ -437,7 +451,7 @@ api_operations_post_input(clicon_handle h,
     restconf_media media_in;
 
     clicon_debug(1, "%s %s", __FUNCTION__, data);
-    if ((cbret = cbuf_new()) == NULL){
+    if ((cbret = clixon_cbuf_get()) == NULL){
         clicon_err(OE_UNIX, 0, "cbuf_new");
         goto done;
     }
@@ -476,6 +490,20 @@ api_operations_post_input(clicon_handle h,
             goto fail;
         }
         break;
+    case YANG_DATA_CBOR:
+        if ((ret = restconf_cbor_parse(h, data, YB_NONE, yspec, &xdata, &xerr)) < 0){
+            if (netconf_malformed_message_xml(&xerr, clicon_err_reason) < 0)
+                goto done;
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto fail;
+        }
+        if (ret == 0){
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto fail;
+        }
+        break;
     default:
         restconf_unsupported_media(h, req, pretty, media_out);
         goto fail;
@@ -517,7 +545,7 @@ api_operations_post_input(clicon_handle h,
  done:
     clicon_debug(1, "%s retval: %d", __FUNCTION__, retval);
     if (cbret)
-        cbuf_free(cbret);
+        clixon_cbuf_put(cbret);
     if (xerr)
         xml_free(xerr);
     if (xdata)
@@ -880,6 +908,10 @@ api_operations_post(clicon_handle h,
             goto done;
         /* xoutput should now look: {"example:output": {"x":0,"y":42}} */
         break;
+    case YANG_DATA_CBOR:
+        if (clixon_xml2cbor_cbuf(cbret, xoutput, 0) < 0)
+            goto done;
+        break;
     default:
         break;
     }
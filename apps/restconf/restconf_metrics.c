@@ -0,0 +1,451 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Latency histograms and counters of native restconf requests, see RESTCONF_METRICS
+ * Per method and status code:
+ *   - Latency from request headers received until the reply is ready to be sent
+ *   - Time of the latency spent waiting for the backend, see clicon_rpc_stats
+ *   - Bytes of request and reply bodies
+ * Per process:
+ *   - TLS handshake latency
+ *   - HTTP/1 request header parsing time
+ * Metrics are per worker process. They are logged on SIGUSR1 and sent in Prometheus
+ * text format on GET of RESTCONF_METRICS_PATH of each worker.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <syslog.h>
+#include <inttypes.h>
+#include <sys/time.h>
+
+#include <openssl/ssl.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+/* restconf */
+#include "restconf_lib.h"
+#include "restconf_handle.h"
+#include "restconf_api.h"
+#include "restconf_err.h"
+#include "restconf_native.h"
+#include "restconf_metrics.h"
+
+/* Upper bounds of latency histogram buckets in microseconds, last bucket is +Inf */
+static const uint64_t metrics_bounds[] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000
+};
+#define METRICS_NBUCKETS (sizeof(metrics_bounds)/sizeof(metrics_bounds[0]))
+
+/* Methods with their own metrics, other methods are counted as "other" */
+static const char *metrics_methods[] = {
+    "GET", "HEAD", "POST", "PUT", "PATCH", "DELETE", "OPTIONS", NULL
+};
+
+/* Latency histogram */
+typedef struct {
+    uint64_t mh_buckets[METRICS_NBUCKETS+1]; /* Not cumulative, last is +Inf */
+    uint64_t mh_count;
+    uint64_t mh_usec;  /* Sum of latencies */
+} metrics_hist;
+
+/* Metrics of requests of one method and status code */
+typedef struct {
+    qelem_t      me_qelem;      /* List header */
+    const char  *me_method;     /* One of metrics_methods or "other" */
+    uint16_t     me_code;       /* Status code */
+    metrics_hist me_latency;    /* Request latency */
+    uint64_t     me_backend_usec; /* Time waiting for backend */
+    uint64_t     me_rpcs;       /* Backend RPCs */
+    uint64_t     me_bytes_in;   /* Request body bytes */
+    uint64_t     me_bytes_out;  /* Reply body bytes */
+} metrics_entry;
+
+#ifdef RESTCONF_METRICS
+static metrics_entry *_metrics = NULL;          /* List of entries by method and code */
+static metrics_hist   _metrics_tls;             /* TLS handshakes */
+static uint64_t       _metrics_parse_nr = 0;    /* HTTP/1 headers parsed */
+static uint64_t       _metrics_parse_usec = 0;  /* HTTP/1 header parse time */
+#endif
+
+#ifdef RESTCONF_METRICS
+/*! Add latency to histogram
+ */
+static void
+metrics_hist_add(metrics_hist *mh,
+                 uint64_t      usec)
+{
+    int i;
+
+    for (i=0; i<METRICS_NBUCKETS; i++)
+        if (usec <= metrics_bounds[i])
+            break;
+    mh->mh_buckets[i]++;
+    mh->mh_count++;
+    mh->mh_usec += usec;
+}
+
+/*! Microseconds since t0
+ */
+static uint64_t
+metrics_usec(struct timeval *t0)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    timersub(&t, t0, &t);
+    if (t.tv_sec < 0)
+        return 0;
+    return (uint64_t)t.tv_sec*1000000 + t.tv_usec;
+}
+
+/*! Find or create metrics entry of method and status code
+ */
+static metrics_entry *
+metrics_entry_get(char    *method0,
+                  uint16_t code)
+{
+    metrics_entry *me;
+    const char    *method = "other";
+    int            i;
+
+    for (i=0; method0 && metrics_methods[i]; i++)
+        if (strcmp(method0, metrics_methods[i]) == 0){
+            method = metrics_methods[i];
+            break;
+        }
+    if ((me = _metrics) != NULL){
+        do {
+            if (me->me_method == method && me->me_code == code)
+                return me;
+            me = NEXTQ(metrics_entry *, me);
+        } while (me && me != _metrics);
+    }
+    if ((me = malloc(sizeof(*me))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(me, 0, sizeof(*me));
+    me->me_method = method;
+    me->me_code = code;
+    ADDQ(me, _metrics);
+    return me;
+}
+#endif /* RESTCONF_METRICS */
+
+/*! Start measuring a request, when its headers are received
+ *
+ * @param[in]  sd   Restconf stream data
+ * @retval     0    OK
+ */
+int
+restconf_metrics_begin(restconf_stream_data *sd)
+{
+#ifdef RESTCONF_METRICS
+    gettimeofday(&sd->sd_t0, NULL);
+    clicon_rpc_stats(&sd->sd_rpc_nr0, &sd->sd_rpc_usec0);
+#endif
+    return 0;
+}
+
+/*! Stop measuring a request, when its reply is ready to be sent
+ *
+ * Call before request parameters are cleared
+ * @param[in]  h    Clixon handle
+ * @param[in]  sd   Restconf stream data
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+restconf_metrics_end(clicon_handle         h,
+                     restconf_stream_data *sd)
+{
+#ifdef RESTCONF_METRICS
+    metrics_entry *me;
+    uint64_t       nr = 0;
+    uint64_t       usec = 0;
+
+    if (!timerisset(&sd->sd_t0))
+        return 0;
+    if ((me = metrics_entry_get(restconf_param_get(h, "REQUEST_METHOD"), sd->sd_code)) == NULL)
+        return -1;
+    metrics_hist_add(&me->me_latency, metrics_usec(&sd->sd_t0));
+    clicon_rpc_stats(&nr, &usec);
+    me->me_rpcs += nr - sd->sd_rpc_nr0;
+    me->me_backend_usec += usec - sd->sd_rpc_usec0;
+    if (sd->sd_indata)
+        me->me_bytes_in += cbuf_len(sd->sd_indata);
+    me->me_bytes_out += sd->sd_body_len;
+    timerclear(&sd->sd_t0);
+#endif
+    return 0;
+}
+
+/*! Add latency of a TLS handshake
+ *
+ * @param[in]  t0   Time when handshake started
+ * @retval     0    OK
+ */
+int
+restconf_metrics_tls(struct timeval *t0)
+{
+#ifdef RESTCONF_METRICS
+    metrics_hist_add(&_metrics_tls, metrics_usec(t0));
+#endif
+    return 0;
+}
+
+/*! Add time of parsing HTTP/1 request headers
+ *
+ * @param[in]  t0   Time when parsing started
+ * @retval     0    OK
+ */
+int
+restconf_metrics_parse(struct timeval *t0)
+{
+#ifdef RESTCONF_METRICS
+    _metrics_parse_nr++;
+    _metrics_parse_usec += metrics_usec(t0);
+#endif
+    return 0;
+}
+
+/*! Log metrics of this process, one line per method and status code
+ *
+ * @param[in]  worker  Index of worker process
+ * @retval     0       OK
+ * @see restconf_native_stats
+ */
+int
+restconf_metrics_log(int worker)
+{
+#ifdef RESTCONF_METRICS
+    metrics_entry *me;
+
+    clicon_log(LOG_NOTICE, "%s: worker %d metrics tls handshakes:%" PRIu64 " usec:%" PRIu64
+               " http/1 header parse:%" PRIu64 " usec:%" PRIu64,
+               __PROGRAM__, worker, _metrics_tls.mh_count, _metrics_tls.mh_usec,
+               _metrics_parse_nr, _metrics_parse_usec);
+    if ((me = _metrics) != NULL){
+        do {
+            clicon_log(LOG_NOTICE, "%s: worker %d metrics %s %u requests:%" PRIu64 " usec:%" PRIu64
+                       " backend rpcs:%" PRIu64 " usec:%" PRIu64
+                       " bytes in:%" PRIu64 " out:%" PRIu64,
+                       __PROGRAM__, worker, me->me_method, me->me_code,
+                       me->me_latency.mh_count, me->me_latency.mh_usec,
+                       me->me_rpcs, me->me_backend_usec,
+                       me->me_bytes_in, me->me_bytes_out);
+            me = NEXTQ(metrics_entry *, me);
+        } while (me && me != _metrics);
+    }
+#endif
+    return 0;
+}
+
+#ifdef RESTCONF_METRICS
+/*! Print histogram in Prometheus text format
+ *
+ * @param[in]  cb     Output buffer
+ * @param[in]  name   Metric name
+ * @param[in]  labels Labels without braces, eg worker="0"
+ * @param[in]  mh     Histogram
+ */
+static void
+metrics_hist_print(cbuf         *cb,
+                   const char   *name,
+                   const char   *labels,
+                   metrics_hist *mh)
+{
+    uint64_t n = 0;
+    int      i;
+
+    for (i=0; i<METRICS_NBUCKETS; i++){
+        n += mh->mh_buckets[i];
+        cprintf(cb, "%s_bucket{%s,le=\"%" PRIu64 ".%06" PRIu64 "\"} %" PRIu64 "\n",
+                name, labels, metrics_bounds[i]/1000000, metrics_bounds[i]%1000000, n);
+    }
+    n += mh->mh_buckets[i];
+    cprintf(cb, "%s_bucket{%s,le=\"+Inf\"} %" PRIu64 "\n", name, labels, n);
+    cprintf(cb, "%s_sum{%s} %" PRIu64 ".%06" PRIu64 "\n",
+            name, labels, mh->mh_usec/1000000, mh->mh_usec%1000000);
+    cprintf(cb, "%s_count{%s} %" PRIu64 "\n", name, labels, mh->mh_count);
+}
+
+/*! Print metrics of this process in Prometheus text format
+ */
+static int
+metrics_print(cbuf *cb,
+              int   worker)
+{
+    metrics_entry *me;
+    char           labels[64];
+
+    snprintf(labels, sizeof(labels), "worker=\"%d\"", worker);
+    cprintf(cb, "# HELP clixon_restconf_tls_handshake_seconds TLS handshake latency\n");
+    cprintf(cb, "# TYPE clixon_restconf_tls_handshake_seconds histogram\n");
+    metrics_hist_print(cb, "clixon_restconf_tls_handshake_seconds", labels, &_metrics_tls);
+    cprintf(cb, "# HELP clixon_restconf_http1_parse_seconds HTTP/1 request header parsing time\n");
+    cprintf(cb, "# TYPE clixon_restconf_http1_parse_seconds summary\n");
+    cprintf(cb, "clixon_restconf_http1_parse_seconds_sum{%s} %" PRIu64 ".%06" PRIu64 "\n",
+            labels, _metrics_parse_usec/1000000, _metrics_parse_usec%1000000);
+    cprintf(cb, "clixon_restconf_http1_parse_seconds_count{%s} %" PRIu64 "\n", labels, _metrics_parse_nr);
+    if (_metrics == NULL)
+        return 0;
+    cprintf(cb, "# HELP clixon_restconf_request_seconds Request latency until reply is ready\n");
+    cprintf(cb, "# TYPE clixon_restconf_request_seconds histogram\n");
+    me = _metrics;
+    do {
+        snprintf(labels, sizeof(labels), "worker=\"%d\",method=\"%s\",code=\"%u\"",
+                 worker, me->me_method, me->me_code);
+        metrics_hist_print(cb, "clixon_restconf_request_seconds", labels, &me->me_latency);
+        me = NEXTQ(metrics_entry *, me);
+    } while (me && me != _metrics);
+    cprintf(cb, "# HELP clixon_restconf_backend_seconds_total Request time waiting for backend\n");
+    cprintf(cb, "# TYPE clixon_restconf_backend_seconds_total counter\n");
+    do {
+        snprintf(labels, sizeof(labels), "worker=\"%d\",method=\"%s\",code=\"%u\"",
+                 worker, me->me_method, me->me_code);
+        cprintf(cb, "clixon_restconf_backend_seconds_total{%s} %" PRIu64 ".%06" PRIu64 "\n",
+                labels, me->me_backend_usec/1000000, me->me_backend_usec%1000000);
+        me = NEXTQ(metrics_entry *, me);
+    } while (me && me != _metrics);
+    cprintf(cb, "# HELP clixon_restconf_backend_rpcs_total Backend RPCs of requests\n");
+    cprintf(cb, "# TYPE clixon_restconf_backend_rpcs_total counter\n");
+    do {
+        snprintf(labels, sizeof(labels), "worker=\"%d\",method=\"%s\",code=\"%u\"",
+                 worker, me->me_method, me->me_code);
+        cprintf(cb, "clixon_restconf_backend_rpcs_total{%s} %" PRIu64 "\n", labels, me->me_rpcs);
+        me = NEXTQ(metrics_entry *, me);
+    } while (me && me != _metrics);
+    cprintf(cb, "# HELP clixon_restconf_request_bytes_total Request body bytes\n");
+    cprintf(cb, "# TYPE clixon_restconf_request_bytes_total counter\n");
+    do {
+        snprintf(labels, sizeof(labels), "worker=\"%d\",method=\"%s\",code=\"%u\"",
+                 worker, me->me_method, me->me_code);
+        cprintf(cb, "clixon_restconf_request_bytes_total{%s} %" PRIu64 "\n", labels, me->me_bytes_in);
+        me = NEXTQ(metrics_entry *, me);
+    } while (me && me != _metrics);
+    cprintf(cb, "# HELP clixon_restconf_response_bytes_total Reply body bytes\n");
+    cprintf(cb, "# TYPE clixon_restconf_response_bytes_total counter\n");
+    do {
+        snprintf(labels, sizeof(labels), "worker=\"%d\",method=\"%s\",code=\"%u\"",
+                 worker, me->me_method, me->me_code);
+        cprintf(cb, "clixon_restconf_response_bytes_total{%s} %" PRIu64 "\n", labels, me->me_bytes_out);
+        me = NEXTQ(metrics_entry *, me);
+    } while (me && me != _metrics);
+    return 0;
+}
+#endif /* RESTCONF_METRICS */
+
+/*! Get metrics of this worker process in Prometheus text format
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  req     Generic Www handle
+ * @param[in]  worker  Index of worker process
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @note Metrics are per worker process, a request is served by any worker
+ * @see RESTCONF_METRICS_PATH
+ */
+int
+api_metrics(clicon_handle h,
+            void         *req,
+            int           worker)
+{
+    int   retval = -1;
+    char *request_method;
+    cbuf *cb = NULL;
+    int   head;
+    int   ret;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    request_method = restconf_param_get(h, "REQUEST_METHOD");
+    head = strcmp(request_method, "HEAD") == 0;
+    if (!head && strcmp(request_method, "GET") != 0){
+        if (restconf_method_notallowed(h, req, "GET,HEAD", restconf_pretty_get(h), YANG_DATA_JSON) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Metrics are not public, authenticate as restconf */
+    if ((ret = restconf_authentication_cb(h, req, restconf_pretty_get(h), YANG_DATA_JSON)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+#ifdef RESTCONF_METRICS
+    if (metrics_print(cb, worker) < 0)
+        goto done;
+#endif
+    if (restconf_reply_header(req, "Content-Type", "text/plain; version=0.0.4") < 0)
+        goto done;
+    if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
+        goto done;
+    ret = restconf_reply_send(req, 200, cb, head);
+    cb = NULL; /* consumed by reply-send */
+    if (ret < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Free all metrics
+ */
+void
+restconf_metrics_exit(void)
+{
+#ifdef RESTCONF_METRICS
+    metrics_entry *me;
+
+    while ((me = _metrics) != NULL){
+        DELQ(me, _metrics, metrics_entry *);
+        free(me);
+    }
+#endif
+}
@@ -0,0 +1,56 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Latency histograms and counters of native restconf requests, see RESTCONF_METRICS
+ */
+#ifndef _RESTCONF_METRICS_H_
+#define _RESTCONF_METRICS_H_
+
+/*
+ * Constants
+ */
+/* Path of metrics of this worker process in Prometheus text format */
+#define RESTCONF_METRICS_PATH "/.well-known/clixon-metrics"
+
+/*
+ * Prototypes
+ */
+int  restconf_metrics_begin(restconf_stream_data *sd);
+int  restconf_metrics_end(clicon_handle h, restconf_stream_data *sd);
+int  restconf_metrics_tls(struct timeval *t0);
+int  restconf_metrics_parse(struct timeval *t0);
+int  restconf_metrics_log(int worker);
+int  api_metrics(clicon_handle h, void *req, int worker);
+void restconf_metrics_exit(void);
+
+#endif  /* _RESTCONF_METRICS_H_ */
@@ -44,9 +44,11 @@
 #include <syslog.h>
 #include <pwd.h>
 #include <ctype.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <arpa/inet.h>
 #include <sys/resource.h>
 
@@ -69,6 +71,7 @@
 #include "restconf_handle.h"
 #include "restconf_err.h"
 #include "restconf_native.h"    /* Restconf-openssl mode specific headers*/
+#include "restconf_metrics.h"
 #ifdef HAVE_LIBNGHTTP2
 #include <nghttp2/nghttp2.h>
 #include "restconf_nghttp2.h"  /* http/2 */
@@ -97,19 +100,24 @@ restconf_stream_data_new(restconf_conn *rc,
     memset(sd, 0, sizeof(restconf_stream_data));
     sd->sd_stream_id = stream_id;
     sd->sd_fd = -1;
-    if ((sd->sd_inbuf = cbuf_new()) == NULL){
+    /* Buffers of streams are recycled between requests */
+    if ((sd->sd_inbuf = clixon_cbuf_get()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         return NULL;
     }
-    if ((sd->sd_indata = cbuf_new()) == NULL){
+    if ((sd->sd_indata = clixon_cbuf_get()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         return NULL;
     }
-    if ((sd->sd_outp_hdrs = cvec_new(0)) == NULL){
+    if ((sd->sd_outp_hdrs = clixon_cvec_get()) == NULL){
         clicon_err(OE_UNIX, errno, "cvec_new");
         return NULL;
     }
-    if ((sd->sd_outp_buf = cbuf_new()) == NULL){
+    if ((sd->sd_outp_trailers = clixon_cvec_get()) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        return NULL;
+    }
+    if ((sd->sd_outp_buf = clixon_cbuf_get()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         return NULL;
     }
@@ -147,15 +155,19 @@ restconf_stream_free(restconf_stream_data *sd)
         close(sd->sd_fd);
     }
     if (sd->sd_inbuf)
-        cbuf_free(sd->sd_inbuf);
+        clixon_cbuf_put(sd->sd_inbuf);
     if (sd->sd_indata)
-        cbuf_free(sd->sd_indata);
+        clixon_cbuf_put(sd->sd_indata);
     if (sd->sd_outp_hdrs)
-        cvec_free(sd->sd_outp_hdrs);
+        clixon_cvec_put(sd->sd_outp_hdrs);
+    if (sd->sd_outp_trailers)
+        clixon_cvec_put(sd->sd_outp_trailers);
     if (sd->sd_outp_buf)
-        cbuf_free(sd->sd_outp_buf);
+        clixon_cbuf_put(sd->sd_outp_buf);
     if (sd->sd_body)
-        cbuf_free(sd->sd_body);
+        clixon_cbuf_put(sd->sd_body);
+    if (sd->sd_body_arg && sd->sd_body_free)
+        sd->sd_body_free(sd->sd_body_arg);
     if (sd->sd_path)
         free(sd->sd_path);
     if (sd->sd_settings2)
@@ -203,7 +215,6 @@ restconf_conn_free(restconf_conn *rc)
     int                   retval = -1;
     restconf_stream_data *sd;
     restconf_socket      *rsock;
-    restconf_conn        *rc1;
 
     clicon_debug(1, "%s", __FUNCTION__);
     if (rc == NULL){
@@ -220,17 +231,10 @@ restconf_conn_free(restconf_conn *rc)
         if (sd)
             restconf_stream_free(sd);
     }
-    /* Free connect from server sock */
-    if ((rsock = rc->rc_socket) != NULL &&
-        (rc1 = rsock->rs_conns) != NULL){
-        do {
-            if (rc == rc1){
-                DELQ(rc, rsock->rs_conns, restconf_conn *);
-                break;
-            }
-            rc1 = NEXTQ(restconf_conn *, rc1);
-        } while (rc1 && rc1 != rsock->rs_conns);
-    }
+    /* Free connect from server sock, rc is always in the list of its socket, see
+     * restconf_conn_new */
+    if ((rsock = rc->rc_socket) != NULL && rsock->rs_conns != NULL)
+        DELQ(rc, rsock->rs_conns, restconf_conn *);
     free(rc);
     retval = 0;
  done:
@@ -367,27 +371,29 @@ restconf_connection_sanity(clicon_handle         h,
     return retval;
 }
 
-/* Write buf to socket
- * see also this function in restcont_api_openssl.c
+/*! Write io vector to socket
+ *
+ * With plain sockets the vector is written with writev, eg reply headers and body without
+ * first copying them into one buffer. With SSL each element is written with SSL_write
  * @param[in]  h        Clixon handle
- * @param[in]  buf      Buffer to write
- * @param[in]  buflen   Length of buffer
+ * @param[in]  iov      I/O vector to write, modified
+ * @param[in]  iovcnt   Number of elements in iov
  * @param[in]  rc       Connection struct
  * @param[in]  callfn   For debug
  * @retval  1  OK
  * @retval  0  OK, but socket write returned error, caller should close rc
  * @retval -1  Error
+ * @see native_buf_write
  */
 static int
-native_buf_write(clicon_handle    h,
-                 char            *buf,
-                 size_t           buflen,
+native_iov_write(clicon_handle    h,
+                 struct iovec    *iov,
+                 int              iovcnt,
                  restconf_conn   *rc,
-                 const char      *callfn)                
+                 const char      *callfn)
 {
     int     retval = -1;
     ssize_t len;
-    ssize_t totlen = 0;
     int     er;
     SSL    *ssl;
 
@@ -400,22 +406,27 @@ native_buf_write(clicon_handle    h,
      * 1. they are not "strings" in the sense they are not NULL-terminated
      * 2. they are often very long
      */
-    if (clicon_debug_get()) { 
+    if (clicon_debug_get() && iovcnt > 0) {
         char *dbgstr = NULL;
         size_t sz;
-        sz = buflen>256?256:buflen; /* Truncate to 256 */
+        sz = iov->iov_len>256?256:iov->iov_len; /* Truncate to 256 */
         if ((dbgstr = malloc(sz+1)) == NULL){
             clicon_err(OE_UNIX, errno, "malloc");
             goto done;
         }
-        memcpy(dbgstr, buf, sz);
+        memcpy(dbgstr, iov->iov_base, sz);
         dbgstr[sz] = '\0';
-        clicon_debug(1, "%s %s buflen:%zu buf:\n%s", __FUNCTION__, callfn, buflen, dbgstr);
+        clicon_debug(1, "%s %s buflen:%zu buf:\n%s", __FUNCTION__, callfn, iov->iov_len, dbgstr);
         free(dbgstr);
     }
-    while (totlen < buflen){
+    while (iovcnt > 0){
+        if (iov->iov_len == 0){
+            iov++;
+            iovcnt--;
+            continue;
+        }
         if (ssl){
-            if ((len = SSL_write(ssl, buf+totlen, buflen-totlen)) <= 0){
+            if ((len = SSL_write(ssl, iov->iov_base, iov->iov_len)) <= 0){
                 er = errno;
                 switch (SSL_get_error(ssl, len)){
                 case SSL_ERROR_SYSCALL:              /* 5 */
@@ -442,7 +453,7 @@ native_buf_write(clicon_handle    h,
             }
         }
         else{
-            if ((len = write(rc->rc_s, buf+totlen, buflen-totlen)) < 0){
+            if ((len = writev(rc->rc_s, iov, iovcnt)) < 0){
                 switch (errno){
                 case EAGAIN:     /* Operation would block */
                     clicon_debug(1, "%s write EAGAIN", __FUNCTION__);
@@ -455,13 +466,22 @@ native_buf_write(clicon_handle    h,
                     goto closed; /* Close socket and ssl */
                     break;
                 default:
-                    clicon_err(OE_UNIX, errno, "write %d", errno);
+                    clicon_err(OE_UNIX, errno, "writev %d", errno);
                     goto done;
                     break;
                 }
             }
         }
-        totlen += len;
+        /* Advance vector past written bytes */
+        while (iovcnt > 0 && len >= iov->iov_len){
+            len -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0){
+            iov->iov_base = (char*)iov->iov_base + len;
+            iov->iov_len -= len;
+        }
     } /* while */
     retval = 1;
  done:
@@ -472,6 +492,280 @@ native_buf_write(clicon_handle    h,
     goto done;
 }
 
+/* Write buf to socket
+ * see also this function in restcont_api_openssl.c
+ * @param[in]  h        Clixon handle
+ * @param[in]  buf      Buffer to write
+ * @param[in]  buflen   Length of buffer
+ * @param[in]  rc       Connection struct
+ * @param[in]  callfn   For debug
+ * @retval  1  OK
+ * @retval  0  OK, but socket write returned error, caller should close rc
+ * @retval -1  Error
+ */
+static int
+native_buf_write(clicon_handle    h,
+                 char            *buf,
+                 size_t           buflen,
+                 restconf_conn   *rc,
+                 const char      *callfn)
+{
+    struct iovec iov;
+
+    iov.iov_base = buf;
+    iov.iov_len = buflen;
+    return native_iov_write(h, &iov, 1, rc, callfn);
+}
+
+#ifdef HAVE_HTTP1
+/*! Write HTTP/1 reply headers and body to socket, and reset them
+ *
+ * The body is not appended to the headers in sd_outp_buf but written from sd_body,
+ * see restconf_http1_reply
+ * @param[in]  h        Clixon handle
+ * @param[in]  sd       Restconf stream data
+ * @param[in]  rc       Connection struct
+ * @param[in]  callfn   For debug
+ * @retval  1  OK
+ * @retval  0  OK, but socket write returned error, caller should close rc
+ * @retval -1  Error
+ */
+static int
+native_reply_write(clicon_handle         h,
+                   restconf_stream_data *sd,
+                   restconf_conn        *rc,
+                   const char           *callfn)
+{
+    int          retval;
+    struct iovec iov[2];
+    int          iovcnt = 1;
+
+    iov[0].iov_base = cbuf_get(sd->sd_outp_buf);
+    iov[0].iov_len = cbuf_len(sd->sd_outp_buf);
+    if (sd->sd_body){
+        iov[1].iov_base = cbuf_get(sd->sd_body);
+        iov[1].iov_len = cbuf_len(sd->sd_body);
+        iovcnt++;
+    }
+    retval = native_iov_write(h, iov, iovcnt, rc, callfn);
+    cvec_reset(sd->sd_outp_hdrs);
+    cbuf_reset(sd->sd_outp_buf);
+    if (sd->sd_body){
+        clixon_cbuf_put(sd->sd_body);
+        sd->sd_body = NULL;
+    }
+    return retval;
+}
+
+/*! Write to socket without blocking
+ *
+ * Used for streamed HTTP/1 reply bodies, where the socket is non-blocking, see
+ * restconf_http1_stream_start
+ * @param[in]  rc   Connection struct
+ * @param[in]  buf  Buffer to write
+ * @param[in]  len  Length of buffer
+ * @param[out] np   Number of bytes written, 0 if the write would block
+ * @retval  1  OK
+ * @retval  0  OK, but socket write returned error, caller should close rc
+ * @retval -1  Error
+ */
+static int
+native_write_nonblock(restconf_conn *rc,
+                      char          *buf,
+                      size_t         len,
+                      size_t        *np)
+{
+    ssize_t n;
+    int     er;
+
+    *np = 0;
+    if (rc->rc_ssl){
+        if ((n = SSL_write(rc->rc_ssl, buf, len)) <= 0){
+            er = errno;
+            switch (SSL_get_error(rc->rc_ssl, n)){
+            case SSL_ERROR_WANT_WRITE:
+            case SSL_ERROR_WANT_READ:
+                return 1;
+            case SSL_ERROR_SYSCALL:
+                if (er == EAGAIN || er == EWOULDBLOCK || er == EINTR)
+                    return 1;
+                return 0;
+            default:
+                return 0;
+            }
+        }
+    }
+    else if ((n = send(rc->rc_s, buf, len, MSG_DONTWAIT)) < 0){
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return 1;
+        if (errno == ECONNRESET || errno == EPIPE)
+            return 0;
+        clicon_err(OE_UNIX, errno, "send");
+        return -1;
+    }
+    *np = n;
+    return 1;
+}
+
+static int restconf_http1_stream_write_cb(int fd, void *arg);
+
+/*! Write streamed HTTP/1 reply body as it is produced, without blocking
+ *
+ * The body is written until the producer has no more data for now, or the socket would
+ * block, in which case the rest is written when the socket is writable. 
+ * The body is delimited by closing the connection.
+ * @param[in]  rc   Connection struct
+ * @param[in]  sd   Restconf stream data (for http1 only stream 0)
+ * @retval  1  OK
+ * @retval  0  OK, connection closed and rc freed
+ * @retval -1  Error
+ * @see restconf_stream_resume
+ */
+static int
+restconf_http1_stream_write(restconf_conn        *rc,
+                            restconf_stream_data *sd)
+{
+    int    retval = -1;
+    cbuf  *cb;
+    size_t n;
+    int    ret;
+
+    if (sd->sd_body == NULL && (sd->sd_body = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cb = sd->sd_body;
+    while (1){
+        if (sd->sd_body_offset == cbuf_len(cb)){
+            cbuf_reset(cb);
+            sd->sd_body_offset = 0;
+            if (sd->sd_body_fn == NULL) /* End of body */
+                goto closed;
+            if ((ret = sd->sd_body_fn(sd->sd_body_arg, cb, 0)) < 0)
+                goto done;
+            if (ret == 0){
+                sd->sd_body_free(sd->sd_body_arg);
+                sd->sd_body_arg = NULL;
+                sd->sd_body_fn = NULL;
+            }
+            else if (ret == 2 && cbuf_len(cb) == 0) /* No data for now */
+                break;
+            continue;
+        }
+        if ((ret = native_write_nonblock(rc, cbuf_get(cb) + sd->sd_body_offset,
+                                         cbuf_len(cb) - sd->sd_body_offset, &n)) < 0)
+            goto done;
+        if (ret == 0)
+            goto closed;
+        if (n == 0)
+            break;
+        sd->sd_body_offset += n;
+        gettimeofday(&rc->rc_t, NULL); /* activity timer */
+    }
+    if (sd->sd_body_offset < cbuf_len(cb)){
+        if (!sd->sd_body_wait){
+            if (clixon_event_reg_fd_write(rc->rc_s, restconf_http1_stream_write_cb, rc,
+                                          "restconf streamed reply") < 0)
+                goto done;
+            sd->sd_body_wait = 1;
+        }
+    }
+    else if (sd->sd_body_wait){
+        clixon_event_unreg_fd_write(rc->rc_s, restconf_http1_stream_write_cb);
+        sd->sd_body_wait = 0;
+    }
+    retval = 1;
+ done:
+    return retval;
+ closed:
+    if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
+        goto done;
+    retval = 0;
+    goto done;
+}
+
+/*! Socket of a streamed HTTP/1 reply is writable
+ *
+ * @param[in]  fd   Connection socket
+ * @param[in]  arg  Restconf connection
+ */
+static int
+restconf_http1_stream_write_cb(int   fd,
+                               void *arg)
+{
+    restconf_conn        *rc = (restconf_conn *)arg;
+    restconf_stream_data *sd;
+
+    if ((sd = restconf_stream_find(rc, 0)) == NULL){
+        clicon_err(OE_RESTCONF, EINVAL, "restconf stream not found");
+        return -1;
+    }
+    if (restconf_http1_stream_write(rc, sd) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Start writing a streamed HTTP/1 reply body after its headers are written
+ *
+ * The socket is made non-blocking, since the body may be unbounded, eg an event stream, and a
+ * slow peer must not block other connections.
+ * @param[in]  rc   Connection struct
+ * @param[in]  sd   Restconf stream data (for http1 only stream 0)
+ * @retval  1  OK
+ * @retval  0  OK, connection closed and rc freed
+ * @retval -1  Error
+ */
+static int
+restconf_http1_stream_start(restconf_conn        *rc,
+                            restconf_stream_data *sd)
+{
+    int flags;
+
+    if ((flags = fcntl(rc->rc_s, F_GETFL, 0)) < 0 ||
+        fcntl(rc->rc_s, F_SETFL, flags | O_NONBLOCK) < 0){
+        clicon_err(OE_UNIX, errno, "fcntl");
+        return -1;
+    }
+    if (rc->rc_ssl)
+        SSL_set_mode(rc->rc_ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    return restconf_http1_stream_write(rc, sd);
+}
+#endif /* HAVE_HTTP1 */
+
+/*! More data of a streamed reply body is available from its producer
+ *
+ * Called by the producer when it earlier had no data, eg a notification of an event stream
+ * @param[in]  sd   Restconf stream data
+ * @retval  1  OK
+ * @retval  0  OK, connection closed and sd freed
+ * @retval -1  Error
+ * @see restconf_stream_native.c
+ */
+int
+restconf_stream_resume(restconf_stream_data *sd)
+{
+    restconf_conn *rc = sd->sd_conn;
+
+    switch (rc->rc_proto){
+#ifdef HAVE_HTTP1
+    case HTTP_10:
+    case HTTP_11:
+        if (sd->sd_body_wait) /* Written when socket is writable */
+            return 1;
+        return restconf_http1_stream_write(rc, sd);
+        break;
+#endif
+#ifdef HAVE_LIBNGHTTP2
+    case HTTP_2:
+        return http2_stream_resume(rc, sd->sd_stream_id);
+        break;
+#endif
+    default:
+        break;
+    }
+    return 1;
+}
+
 /*! Send early handcoded bad request reply before actual packet received, just after accept
  * @param[in]  h    Clixon handle
  * @param[in]  media
@@ -539,6 +833,22 @@ http1_native_clear_input(clicon_handle         h,
  done:
     return retval;
 }
+
+/*! Get Content-Length of HTTP/1 request, 0 if not present
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     len  Content-Length
+ * @see http1_check_content_length
+ */
+static size_t
+http1_native_content_length(clicon_handle h)
+{
+    char *val;
+
+    if ((val = restconf_param_get(h, "HTTP_CONTENT_LENGTH")) == NULL)
+        return 0;
+    return strtoul(val, NULL, 10);
+}
 #endif
 
 /*! Read HTTP from SSL socket
@@ -646,6 +956,9 @@ read_regular(restconf_conn *rc,
  * @param[in]  buf          Input buffer
  * @param[in]  n            Length of data in input buffer
  * @param[out] readmore     If set, read data again, do not continue processing
+ * A request ends after its headers and Content-Length bytes of body. Any bytes after that are
+ * the start of the next pipelined request, which is processed after the reply is written.
+ * Persistent connections are kept open after the reply, see http1_keepalive
  * @retval     -1           Error
  * @retval     0            Socket closed, quit
  * @retval     1            OK
@@ -662,12 +975,23 @@ restconf_http1_process(restconf_conn *rc,
     int                   ret;
     int                   status;
     cbuf                 *cberr = NULL;
-    
+    char                 *hdrs;
+    char                 *body = NULL;
+    char                  c = '\0';
+    size_t                len;
+    char                 *extra = NULL; /* Bytes after this request, ie pipelined requests */
+    size_t                extralen = 0;
+    restconf_native_handle *rn;
+    struct timeval        tparse;
+
     h = rc->rc_h;
     if ((sd = restconf_stream_find(rc, 0)) == NULL){
         clicon_err(OE_RESTCONF, EINVAL, "restconf stream not found");
         goto done;
     }
+    /* Reply body is streamed until the connection is closed, eg event stream: ignore input */
+    if (sd->sd_body_fn != NULL)
+        goto ok;
     /* Two states for reading:
      * 1) Initial reading of headers, parse from start
      * 2) Headers are read / body started, dont parse, just append body
@@ -683,6 +1007,16 @@ restconf_http1_process(restconf_conn *rc,
     if ((ret = http1_check_content_length(h, sd, &status)) < 0)
         goto done;
     if (status == 1){   /* Next read: keep header state and only append inbody */
+        len = http1_native_content_length(h) - cbuf_len(sd->sd_indata);
+        if (n > len){ /* Next request */
+            if ((extra = malloc(n - len)) == NULL){
+                clicon_err(OE_UNIX, errno, "malloc");
+                goto done;
+            }
+            extralen = n - len;
+            memcpy(extra, buf + len, extralen);
+            n = len;
+        }
         if (cbuf_append_buf(sd->sd_indata, buf, n) < 0){
             clicon_err(OE_UNIX, errno, "cbuf_append");
             goto done;
@@ -696,7 +1030,41 @@ restconf_http1_process(restconf_conn *rc,
             clicon_err(OE_UNIX, errno, "cbuf_append");
             goto done;
         }
-        if (clixon_http1_parse_string(h, rc, cbuf_get(sd->sd_inbuf)) < 0){
+        /* Parse request-line and headers only, the body may be binary, eg CBOR, and is
+         * appended to sd_indata as is. Headers are text, ie the end of headers is found
+         * before any NUL in the body */
+        hdrs = cbuf_get(sd->sd_inbuf);
+        if ((body = strstr(hdrs, "\r\n\r\n")) == NULL){
+            /* Request line and headers not complete, wait for more data */
+            if (rc->rc_ssl && SSL_pending(rc->rc_ssl) > 0)
+                (*readmore)++;
+            goto ok;
+        }
+        body += 4;
+        c = *body;
+        *body = '\0';
+        gettimeofday(&tparse, NULL);
+        ret = clixon_http1_parse_string(h, rc, hdrs);
+        *body = c;
+        restconf_metrics_parse(&tparse);
+        if (ret == 0){
+            restconf_metrics_begin(sd);
+            len = cbuf_len(sd->sd_inbuf) - (body - hdrs);
+            if (len > http1_native_content_length(h)){ /* Next request */
+                extralen = len - http1_native_content_length(h);
+                len -= extralen;
+                if ((extra = malloc(extralen)) == NULL){
+                    clicon_err(OE_UNIX, errno, "malloc");
+                    goto done;
+                }
+                memcpy(extra, body + len, extralen);
+            }
+            if (cbuf_append_buf(sd->sd_indata, body, len) < 0){
+                clicon_err(OE_UNIX, errno, "cbuf_append");
+                goto done;
+            }
+        }
+        if (ret < 0){
             /* XXX This does not work for SSL */
             if (rc->rc_ssl){
                 ret = SSL_pending(rc->rc_ssl);
@@ -732,11 +1100,8 @@ restconf_http1_process(restconf_conn *rc,
         if ((ret = http1_check_expect(h, rc, sd)) < 0)
             goto done;
         if (ret == 1){
-            if ((ret = native_buf_write(h, cbuf_get(sd->sd_outp_buf), cbuf_len(sd->sd_outp_buf),
-                                        rc, __FUNCTION__)) < 0)
+            if ((ret = native_reply_write(h, sd, rc, __FUNCTION__)) < 0)
                 goto done;
-            cvec_reset(sd->sd_outp_hdrs);
-            cbuf_reset(sd->sd_outp_buf);
             if (ret == 0){
                 if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
                     goto done;
@@ -763,30 +1128,47 @@ restconf_http1_process(restconf_conn *rc,
     if (rc->rc_ssl)
         if (restconf_param_set(h, "HTTPS", "https") < 0)
             goto done;
+    if ((rn = restconf_native_handle_get(h)) != NULL){
+        rn->rn_http1_requests++;
+        if (rc->rc_nrequests > 0)
+            rn->rn_http1_reused++;
+    }
+    rc->rc_nrequests++;
     /* main restconf processing */
     if (restconf_http1_path_root(h, rc) < 0)
         goto done;
-    if ((ret = native_buf_write(h, cbuf_get(sd->sd_outp_buf), cbuf_len(sd->sd_outp_buf),
-                                rc, __FUNCTION__)) < 0)
+    if ((ret = native_reply_write(h, sd, rc, __FUNCTION__)) < 0)
         goto done;
-    cvec_reset(sd->sd_outp_hdrs); /* Can be done in native_send_reply */
-    cbuf_reset(sd->sd_outp_buf);
     cbuf_reset(sd->sd_inbuf);
     cbuf_reset(sd->sd_indata);
-    if (sd->sd_body)
-        cbuf_reset(sd->sd_body);
     if (sd->sd_qvec){
         cvec_free(sd->sd_qvec);
         sd->sd_qvec = NULL;
     }
-    if (ret == 0 || rc->rc_exit){  /* Server-initiated exit */
+    if (ret == 1 && sd->sd_body_fn != NULL){ /* Streamed body, no pipelined requests */
+        if ((ret = restconf_http1_stream_start(rc, sd)) < 0)
+            goto done;
+        if (ret == 0)
+            goto closed;
+        goto ok;
+    }
+    if (ret == 0 || rc->rc_exit || rc->rc_close){  /* Server-initiated exit or not persistent */
         if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
             goto done;
         goto closed;
     }
+    /* Pipelined request */
+    if (extralen > 0){
+        retval = restconf_http1_process(rc, extra, extralen, readmore);
+        goto done;
+    }
+    if (rc->rc_ssl && SSL_pending(rc->rc_ssl) > 0)
+        (*readmore)++;
  ok:
     retval = 1;
  done:
+    if (extra)
+        free(extra);
     if (cberr)
         cbuf_free(cberr);
     return retval;
@@ -1047,10 +1429,13 @@ restconf_connection_close1(restconf_conn *rc)
         goto done;
     }
     clixon_event_unreg_fd(rc->rc_s, restconf_connection);
+#ifdef HAVE_HTTP1
+    clixon_event_unreg_fd_write(rc->rc_s, restconf_http1_stream_write_cb);
+#endif
+    if (rsock->rs_idle_timeout && (!rc->rc_callhome || rsock->rs_periodic))
+        restconf_idle_timer_unreg(rc);
     /* re-set timer */
     if (rc->rc_callhome){
-        if (rsock->rs_periodic)
-            restconf_idle_timer_unreg(rc);
         if (restconf_callhome_timer(rsock, 1) < 0)
             goto done;
     }
@@ -1222,8 +1607,10 @@ restconf_ssl_accept_client(clicon_handle    h,
     const unsigned char    *alpn = NULL;
     unsigned int            alpnlen = 0;
     restconf_http_proto     proto = HTTP_11;  /* Non-SSL negotiation NYI */
+    struct timeval          t0;
 
     clicon_debug(1, "%s", __FUNCTION__);
+    gettimeofday(&t0, NULL);
 #ifdef HAVE_LIBNGHTTP2
 #ifndef HAVE_HTTP1
     proto = HTTP_2;     /* If nghttp2 only let default be 2.0  */
@@ -1337,6 +1724,10 @@ restconf_ssl_accept_client(clicon_handle    h,
                 }
             } /* SSL_accept */
         } /* while(readmore) */
+        rn->rn_tls_handshakes++;
+        restconf_metrics_tls(&t0);
+        if (SSL_session_reused(rc->rc_ssl))
+            rn->rn_tls_resumed++;
         /* Sets data and len to point to the client's requested protocol for this connection. */
 #ifndef OPENSSL_NO_NEXTPROTONEG
         SSL_get0_next_proto_negotiated(rc->rc_ssl, &alpn, &alpnlen);
@@ -1475,8 +1866,30 @@ restconf_idle_timer_set(struct timeval t,
     return retval;
 }
 
+/*! Check if a reply body of a connection is streamed, eg an event stream
+ *
+ * Such a connection is not idle even if no data has been sent for a while
+ * @param[in]  rc  Restconf connection
+ * @retval     1   Yes, a reply body is streamed
+ * @retval     0   No
+ */
+static int
+restconf_conn_streaming(restconf_conn *rc)
+{
+    restconf_stream_data *sd;
+
+    if ((sd = rc->rc_streams) != NULL) {
+        do {
+            if (sd->sd_body_fn != NULL)
+                return 1;
+            sd = NEXTQ(restconf_stream_data *, sd);
+        } while (sd && sd != rc->rc_streams);
+    }
+    return 0;
+}
+
 /*! idle timeout timer callback
- * @param[in]  rc  restconf connection, more specifically: callhome connection
+ * @param[in]  rc  restconf connection: periodic callhome or persistent client connection
  *
  * t0        tp          t1                   tn
  * |---------|-----------|--------------------|
@@ -1510,10 +1923,10 @@ restconf_idle_cb(int   fd,
         goto done;
     }
     clicon_debug(1, "%s \"%s\"", __FUNCTION__, rsock->rs_description);
-    if (rc->rc_callhome && rsock->rs_periodic && rc->rc_s > 0 && rsock->rs_idle_timeout){
+    if ((!rc->rc_callhome || rsock->rs_periodic) && rc->rc_s > 0 && rsock->rs_idle_timeout){
         gettimeofday(&now, NULL);
         timersub(&now, &rc->rc_t, &td); /* Last packet timestamp */
-        if (td.tv_sec >= rsock->rs_idle_timeout){
+        if (td.tv_sec >= rsock->rs_idle_timeout && !restconf_conn_streaming(rc)){
             if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
                 goto done;
         }
@@ -1537,8 +1950,8 @@ restconf_idle_timer_unreg(restconf_conn *rc)
     return clixon_event_unreg_timeout(restconf_idle_cb, rc);
 }
 
-/*! Set callhome periodic idle-timeout
- * 1) If callhome and periodic, set timer for t0+idle-timeout(ti)
+/*! Set idle-timeout of callhome periodic or persistent client connection
+ * 1) If callhome and periodic, or client connection, set timer for t0+idle-timeout(ti)
  * 2) Timestamp any data passing on the socket(td)
  * 3) At timeout (ti) check if ti = td+idle-timeout (for first timeout same as t0=td), 
  *    if so close socket
@@ -1556,13 +1969,13 @@ restconf_idle_timer(restconf_conn *rc)
     struct timeval   to = {0, 0};
     restconf_socket *rsock;
 
-    if (rc == NULL || !rc->rc_callhome){
-        clicon_err(OE_RESTCONF, EINVAL, "rc is NULL or not callhome");
+    if (rc == NULL){
+        clicon_err(OE_RESTCONF, EINVAL, "rc is NULL");
         goto done;
     }    
     rsock = rc->rc_socket;
-    if (rsock == NULL || !rsock->rs_periodic || rsock->rs_idle_timeout==0){
-        clicon_err(OE_YANG, EINVAL, "rsock is NULL or not periodic");
+    if (rsock == NULL || (rc->rc_callhome && !rsock->rs_periodic) || rsock->rs_idle_timeout==0){
+        clicon_err(OE_YANG, EINVAL, "rsock is NULL, callhome not periodic or no idle-timeout");
         goto done;
     }    
     clicon_debug(1, "%s \"%s\" register", __FUNCTION__, rsock->rs_description);
@@ -1576,27 +1989,179 @@ restconf_idle_timer(restconf_conn *rc)
     return retval;
 }
     
+static int restconf_callhome_connect_cb(int s, void *arg);
+static int restconf_callhome_hello_cb(int s, void *arg);
+static int restconf_callhome_connect_timeout(int fd, void *arg);
+
+/*! Random time in [0, d) used to spread callhome connects of many sockets
+ *
+ * @param[in]  d    Interval in us
+ * @retval     usec Random time in us
+ */
+static uint64_t
+restconf_callhome_jitter(uint64_t d)
+{
+    uint32_t r;
+
+    if (d == 0)
+        return 0;
+    if (RAND_bytes((unsigned char *)&r, sizeof(r)) != 1)
+        r = (uint32_t)random();
+    return r % d;
+}
+
+/*! A pending callhome connect failed or timed out, count it and try again
+ *
+ * @param[in]  rsock  restconf_socket
+ */
+static int
+restconf_callhome_fail(restconf_socket *rsock)
+{
+    clicon_debug(1, "%s \"%s\"", __FUNCTION__, rsock->rs_description);
+    if (rsock->rs_ss != -1){
+        clixon_event_unreg_fd_write(rsock->rs_ss, restconf_callhome_connect_cb);
+        clixon_event_unreg_fd(rsock->rs_ss, restconf_callhome_hello_cb);
+        close(rsock->rs_ss);
+        rsock->rs_ss = -1;
+    }
+    clixon_event_unreg_timeout(restconf_callhome_connect_timeout, rsock);
+    rsock->rs_connect_fails++;
+    if (rsock->rs_attempts < UINT8_MAX)
+        rsock->rs_attempts++;
+    /* Fail: Initiate new timer */
+    return restconf_callhome_timer(rsock, 0);
+}
+
+/*! Pending callhome connect timed out
+ *
+ * @param[in]  fd   No-op
+ * @param[in]  arg  restconf_socket
+ */
+static int
+restconf_callhome_connect_timeout(int   fd,
+                                  void *arg)
+{
+    restconf_socket *rsock = (restconf_socket *)arg;
+
+    clicon_debug(1, "%s \"%s\"", __FUNCTION__, rsock->rs_description);
+    return restconf_callhome_fail(rsock);
+}
+
+/*! Manager sent data (ie TLS client hello) on callhome socket, make TLS accept
+ *
+ * Accept is deferred to here so that the event loop is not blocked while waiting for
+ * the manager to start TLS.
+ * @param[in]  s    Connected callhome socket
+ * @param[in]  arg  restconf_socket
+ */
+static int
+restconf_callhome_hello_cb(int   s,
+                           void *arg)
+{
+    int              retval = -1;
+    restconf_socket *rsock = (restconf_socket *)arg;
+    restconf_conn   *rc = NULL;
+    int              ret;
+
+    clicon_debug(1, "%s \"%s\"", __FUNCTION__, rsock->rs_description);
+    clixon_event_unreg_fd(s, restconf_callhome_hello_cb);
+    clixon_event_unreg_timeout(restconf_callhome_connect_timeout, rsock);
+    rsock->rs_ss = -1;
+    if ((ret = restconf_ssl_accept_client(rsock->rs_h, s, rsock, &rc)) < 0)
+        goto done;
+    /* ret == 0 means already closed */
+    if (ret == 1 && rsock->rs_periodic && rsock->rs_idle_timeout){
+        if (restconf_idle_timer(rc) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Callhome TCP connect is established, update counters and wait for manager
+ *
+ * The socket is set back to blocking as expected by the TLS and HTTP code
+ * @param[in]  rsock  restconf_socket
+ * @param[in]  s      Connected callhome socket
+ */
+static int
+restconf_callhome_connected(restconf_socket *rsock,
+                            int              s)
+{
+    int            retval = -1;
+    struct timeval now;
+    struct timeval td;
+    uint64_t       usec;
+    int            flags;
+
+    gettimeofday(&now, NULL);
+    timersub(&now, &rsock->rs_connect_t0, &td);
+    usec = td.tv_sec*1000000ULL + td.tv_usec;
+    clicon_debug(1, "%s connect %hu OK %" PRIu64 "us", __FUNCTION__, rsock->rs_port, usec);
+    rsock->rs_connects++;
+    rsock->rs_connect_usec += usec;
+    if (usec > rsock->rs_connect_max)
+        rsock->rs_connect_max = usec;
+    rsock->rs_attempts = 0;
+    if ((flags = fcntl(s, F_GETFL, 0)) < 0 ||
+        fcntl(s, F_SETFL, flags & ~O_NONBLOCK) < 0){
+        clicon_err(OE_UNIX, errno, "fcntl");
+        goto done;
+    }
+    rsock->rs_ss = s;
+    if (clixon_event_reg_fd(s, restconf_callhome_hello_cb, rsock, "restconf callhome hello") < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Pending non-blocking callhome connect is done, check result
+ *
+ * @param[in]  s    Callhome socket
+ * @param[in]  arg  restconf_socket
+ */
+static int
+restconf_callhome_connect_cb(int   s,
+                             void *arg)
+{
+    restconf_socket *rsock = (restconf_socket *)arg;
+    int              err = 0;
+    socklen_t        len = sizeof(err);
+
+    clixon_event_unreg_fd_write(s, restconf_callhome_connect_cb);
+    if (getsockopt(s, SOL_SOCKET, SO_ERROR, &err, &len) < 0)
+        err = errno;
+    if (err != 0){
+        clicon_debug(1, "%s connect %hu fail:%d %s", __FUNCTION__, rsock->rs_port, err, strerror(err));
+        return restconf_callhome_fail(rsock);
+    }
+    rsock->rs_ss = -1;
+    return restconf_callhome_connected(rsock, s);
+}
+
 /*! Callhome timer callback
  *
+ * Start a non-blocking connect to the callhome client. The connect, and thereafter
+ * the TLS client hello, is waited for in the event loop, bounded by
+ * RESTCONF_CALLHOME_CONNECT_TIMEOUT
  * @param[in]  fd   No-op
  * @param[in]  arg  restconf_socket
  * Can be called directly, but typically call wrapper restconf_callhome_timer instead
- * the reason is that this function may continue with SSL accept handling whereas the wrapper always
- * returns directly.
  */
 static int
 restconf_callhome_cb(int   fd,
                      void *arg)
 {
     int              retval = -1;
-    clicon_handle    h;
     restconf_socket *rsock = NULL;
     struct sockaddr_in6 sin6 = {0,}; // because its larger than sin and sa
     struct sockaddr *sa = (struct sockaddr *)&sin6;
     size_t           sa_len;
     int              s;
-    restconf_conn   *rc = NULL;
-    int              ret;
+    struct timeval   t;
+    struct timeval   t1 = {RESTCONF_CALLHOME_CONNECT_TIMEOUT, 0};
 
     rsock = (restconf_socket *)arg;
     if (rsock == NULL || !rsock->rs_callhome){
@@ -1604,47 +2169,65 @@ restconf_callhome_cb(int   fd,
         goto done;
     }
     clicon_debug(1, "%s \"%s\"", __FUNCTION__, rsock->rs_description);
-    h = rsock->rs_h;
+    if (rsock->rs_ss != -1)
+        goto ok; /* Connect already pending */
     /* Already computed in restconf_socket_init, could be saved in rsock? */
     if (clixon_inet2sin(rsock->rs_addrtype, rsock->rs_addrstr, rsock->rs_port, sa, &sa_len) < 0)
         goto done;
-    if ((s = socket(sa->sa_family, SOCK_STREAM, 0)) < 0) {
+    if ((s = socket(sa->sa_family, SOCK_STREAM | SOCK_NONBLOCK, 0)) < 0) {
         clicon_err(OE_UNIX, errno, "socket");
         goto done;
     }
-    if (connect(s, sa, sa_len) < 0){
-        clicon_debug(1, "%s connect %hu fail:%d %s", __FUNCTION__, rsock->rs_port, errno, strerror(errno));
-        close(s);
-        rsock->rs_attempts++;
-        /* Fail: Initiate new timer */
-        if (restconf_callhome_timer(rsock, 0) < 0)
+    gettimeofday(&rsock->rs_connect_t0, NULL);
+    if (connect(s, sa, sa_len) == 0){
+        if (restconf_callhome_connected(rsock, s) < 0)
+            goto done;
+    }
+    else if (errno == EINPROGRESS){
+        rsock->rs_ss = s;
+        if (clixon_event_reg_fd_write(s, restconf_callhome_connect_cb, rsock, "restconf callhome connect") < 0)
             goto done;
     }
     else {
-        clicon_debug(1, "%s connect %hu OK", __FUNCTION__, rsock->rs_port);
-        rsock->rs_attempts = 0;
-        if ((ret = restconf_ssl_accept_client(h, s, rsock, &rc)) < 0)
+        clicon_debug(1, "%s connect %hu fail:%d %s", __FUNCTION__, rsock->rs_port, errno, strerror(errno));
+        close(s);
+        if (restconf_callhome_fail(rsock) < 0)
             goto done;
-        /* ret == 0 means already closed */
-        if (ret == 1 && rsock->rs_periodic && rsock->rs_idle_timeout){
-            if (restconf_idle_timer(rc) < 0)
-                goto done;
-        }
+        goto ok;
     }
+    timeradd(&rsock->rs_connect_t0, &t1, &t);
+    if (clixon_event_reg_timeout(t, restconf_callhome_connect_timeout, rsock,
+                                 "restconf callhome connect timeout") < 0)
+        goto done;
+ ok:
     retval = 0;
  done:
     return retval;
 }
 
+/*! Unregister callhome timer and close pending connect, if any
+ *
+ * @param[in]  rsock  restconf_socket
+ */
 int
 restconf_callhome_timer_unreg(restconf_socket *rsock)
 {
+    if (rsock->rs_ss != -1){
+        clixon_event_unreg_fd_write(rsock->rs_ss, restconf_callhome_connect_cb);
+        clixon_event_unreg_fd(rsock->rs_ss, restconf_callhome_hello_cb);
+        close(rsock->rs_ss);
+        rsock->rs_ss = -1;
+    }
+    clixon_event_unreg_timeout(restconf_callhome_connect_timeout, rsock);
     return clixon_event_unreg_timeout(restconf_callhome_cb, rsock);
 }
 
 /*! Set callhome timer, which tries to connect to callhome client
  *
  * Implement callhome re-connect strategies in ietf-restconf-server.yang
+ * Re-connects are made with exponential backoff up to RESTCONF_CALLHOME_BACKOFF_MAX,
+ * and are jittered, as is the start of a new period, so that many callhome sockets
+ * do not connect in bursts
  * NYI: start-with, anchor-time
  * @param[in]  rsock  restconf_socket
  * @param[in]  new    if periodic: 1: Force a new period
@@ -1659,6 +2242,7 @@ restconf_callhome_timer(restconf_socket *rsock,
     struct timeval t;
     struct timeval t1 = {0, 0};
     cbuf          *cb = NULL;
+    uint64_t       usec;
     
     if (rsock == NULL || !rsock->rs_callhome){
         clicon_err(OE_YANG, EINVAL, "rsock is NULL or not callhome");
@@ -1668,22 +2252,28 @@ restconf_callhome_timer(restconf_socket *rsock,
     if (!rsock->rs_callhome)
         goto ok; /* shouldnt happen */
     gettimeofday(&now, NULL);
-    if (rsock->rs_periodic){
-        if ((status == 1) || rsock->rs_attempts >= rsock->rs_max_attempts){
-            rsock->rs_period_nr++;
-            rsock->rs_attempts = 0;
-            t1.tv_sec = rsock->rs_start + rsock->rs_period_nr*rsock->rs_period;
-            while (t1.tv_sec < now.tv_sec)
-                t1.tv_sec += rsock->rs_period;
-            t = t1;
-        }
-        else {
-            t1.tv_sec = 1;
-            timeradd(&now, &t1, &t);
-        }
-    }
-    else{ /* persistent: try again: attempts? */
-        t1.tv_sec = 1;
+    if (rsock->rs_periodic &&
+        ((status == 1) || rsock->rs_attempts >= rsock->rs_max_attempts)){
+        rsock->rs_period_nr++;
+        rsock->rs_attempts = 0;
+        t1.tv_sec = rsock->rs_start + rsock->rs_period_nr*rsock->rs_period;
+        while (t1.tv_sec < now.tv_sec)
+            t1.tv_sec += rsock->rs_period;
+        /* Jitter within the first tenth of the period */
+        usec = restconf_callhome_jitter((uint64_t)rsock->rs_period*100000);
+        t.tv_sec = usec/1000000;
+        t.tv_usec = usec%1000000;
+        timeradd(&t1, &t, &t);
+    }
+    else { /* persistent, or periodic attempt within period: try again with backoff */
+        usec = 1000000;
+        if (rsock->rs_attempts < 16)
+            usec <<= rsock->rs_attempts;
+        if (rsock->rs_attempts >= 16 || usec > RESTCONF_CALLHOME_BACKOFF_MAX*1000000ULL)
+            usec = RESTCONF_CALLHOME_BACKOFF_MAX*1000000ULL;
+        usec = usec/2 + restconf_callhome_jitter(usec/2);
+        t1.tv_sec = usec/1000000;
+        t1.tv_usec = usec%1000000;
         timeradd(&now, &t1, &t);
     }
     if ((cb = cbuf_new()) == NULL){
@@ -1709,6 +2299,41 @@ restconf_callhome_timer(restconf_socket *rsock,
     return retval;
 }
 
+/*! Sum callhome connect counters of all callhome sockets
+ *
+ * @param[in]  rn        Restconf native handle
+ * @param[out] nr        Number of callhome sockets
+ * @param[out] connects  Successful connects
+ * @param[out] fails     Failed or timed out connects
+ * @param[out] usec      Accumulated connect latency in us
+ * @param[out] max       Max connect latency in us
+ */
+int
+restconf_callhome_stats(restconf_native_handle *rn,
+                        uint64_t               *nr,
+                        uint64_t               *connects,
+                        uint64_t               *fails,
+                        uint64_t               *usec,
+                        uint64_t               *max)
+{
+    restconf_socket *rsock;
+
+    *nr = *connects = *fails = *usec = *max = 0;
+    if ((rsock = rn->rn_sockets) != NULL)
+        do {
+            if (rsock->rs_callhome){
+                (*nr)++;
+                *connects += rsock->rs_connects;
+                *fails += rsock->rs_connect_fails;
+                *usec += rsock->rs_connect_usec;
+                if (rsock->rs_connect_max > *max)
+                    *max = rsock->rs_connect_max;
+            }
+            rsock = NEXTQ(restconf_socket *, rsock);
+        } while (rsock && rsock != rn->rn_sockets);
+    return 0;
+}
+
 /*! Extract socket info from backend config 
  * @param[in]  h         Clicon handle
  * @param[in]  xs        socket config
@@ -1813,6 +2438,17 @@ restconf_socket_extract(clicon_handle    h,
             goto done;
         }
     }
+    if ((x = xpath_first(xs, nsc, "compression-level")) != NULL &&
+        (str = xml_body(x)) != NULL){
+        if ((ret = parse_uint8(str, &rsock->rs_compress_level, &reason)) < 0){
+            clicon_err(OE_XML, errno, "parse_uint8");
+            goto done;
+        }
+        if (ret == 0){
+            clicon_err(OE_XML, EINVAL, "Unrecognized value of compression-level: %s", str);
+            goto done;
+        }
+    }
     if (xpath_first(xs, nsc, "call-home") != NULL){
         rsock->rs_callhome = 1;
         if (xpath_first(xs, nsc, "call-home/connection-type/persistent") != NULL){
@@ -78,10 +78,15 @@ typedef struct  {
     int32_t               sd_stream_id;
     int                   sd_fd;        /* XXX Is this used? */
     cvec                 *sd_outp_hdrs; /* List of output headers */
+    cvec                 *sd_outp_trailers; /* HTTP/2: trailer fields sent after body, eg gRPC */
     cbuf                 *sd_outp_buf;  /* Output buffer */
     cbuf                 *sd_body;      /* http output body as cbuf terminated with \r\n */
     size_t                sd_body_len;  /* Content-Length, note for HEAD body body can be NULL and this non-zero */
     size_t                sd_body_offset; /* Offset into body */
+    int                 (*sd_body_fn)(void *, cbuf *, size_t); /* Body producer of streamed reply */
+    void                 *sd_body_arg;  /* Body producer argument */
+    int                 (*sd_body_free)(void *); /* Free body producer argument */
+    int                   sd_body_wait; /* HTTP/1: streamed body waits for socket to be writable */
     cbuf                 *sd_inbuf;     /* Receive/input buf (whole message) */
     cbuf                 *sd_indata;    /* Receive/input data body */
     char                 *sd_path;      /* Uri path, uri-encoded, without args (eg ?) */
@@ -92,6 +97,9 @@ typedef struct  {
     void                 *sd_req;       /* Lib-specific request */
     int                   sd_upgrade2;  /* Upgrade to http/2 */
     uint8_t              *sd_settings2; /* Settings for upgrade to http/2 request */
+    struct timeval        sd_t0;        /* Request headers received, see restconf_metrics_begin */
+    uint64_t              sd_rpc_nr0;   /* Backend RPCs when request received */
+    uint64_t              sd_rpc_usec0; /* Backend RPC time when request received */
 } restconf_stream_data;
 
 typedef struct restconf_socket restconf_socket;
@@ -113,6 +121,8 @@ typedef struct restconf_conn {
     SSL                  *rc_ssl;       /* Structure for SSL connection */
     restconf_stream_data *rc_streams; /* List of http/2 session streams */
     int                   rc_exit;    /* Set to close socket server-side */
+    int                   rc_close;   /* HTTP/1: close connection after reply */
+    uint32_t              rc_nrequests; /* HTTP/1: nr of requests on this connection */
     /* Decision to keep lib-specific data here, otherwise new struct necessary
      * drawback is specific includes need to go everywhere */
 #ifdef HAVE_LIBNGHTTP2
@@ -136,8 +146,8 @@ typedef struct restconf_socket{
     char         *rs_description; /* Description */
     int           rs_callhome;  /* 0: listen, 1: callhome */
     int           rs_ss;        /* Listen: Server socket, ready for accept
-                                 * XXXCallhome: connect socket (same as restconf_conn->rc_s) 
-                                 * Callhome: No-op, see restconf_conn->rc_s
+                                 * Callhome: pending non-blocking connect socket, or -1
+                                 * Established callhome connection, see restconf_conn->rc_s
                                  */
     int           rs_ssl;       /* 0: Not SSL socket, 1:SSL socket */
     char         *rs_addrtype;  /* Address type according to ietf-inet-types:
@@ -147,13 +157,19 @@ typedef struct restconf_socket{
     int           rs_periodic;  /* 0: persistent, 1: periodic (if callhome) */
     uint32_t      rs_period;    /* Period in s (if callhome & periodic) */
     uint8_t       rs_max_attempts;  /* max connect attempts (if callhome) */
-    uint16_t      rs_idle_timeout; /* Max underlying TCP session remains idle (if callhome and periodic) (in seconds)*/
+    uint16_t      rs_idle_timeout; /* Max underlying TCP session remains idle (if callhome and periodic, or listen) (in seconds)*/
+    uint8_t       rs_compress_level; /* Compression level of reply bodies, 0: no compression */
     uint64_t      rs_start;     /* First period start, next is start+periods*period */
     uint64_t      rs_period_nr; /* Dynamic succeeding or timed out periods. 
                                    Set in restconf_callhome_timer*/
     uint8_t       rs_attempts;  /* Dynamic connect attempts in this round (if callhome) 
                                  * Set in restconf_callhome_cb
                                  */
+    struct timeval rs_connect_t0; /* Start of pending connect (if callhome) */
+    uint64_t      rs_connects;  /* Successful connects (if callhome) */
+    uint64_t      rs_connect_fails; /* Failed or timed out connects (if callhome) */
+    uint64_t      rs_connect_usec; /* Accumulated connect latency in us (if callhome) */
+    uint64_t      rs_connect_max; /* Max connect latency in us (if callhome) */
     restconf_conn *rs_conns;  /* List of transient connect sockets */
     char          *rs_from_addr; /* From IP address as seen by accept (mv to rc?) */
 
@@ -166,6 +182,15 @@ typedef struct {
     SSL_CTX         *rn_ctx;       /* SSL context */
     restconf_socket *rn_sockets;   /* List of restconf server (ready for accept) sockets */
     void            *rn_arg;       /* Packet specific handle */
+    int              rn_workers;   /* Number of worker processes, see restconf workers */
+    int              rn_worker;    /* Index of this worker process (if rn_workers > 1) */
+    uint32_t         rn_ticket_lifetime; /* Ticket key lifetime in s, 0 if no tickets */
+    unsigned char    rn_ticket_secret[32]; /* Ticket key secret shared by workers */
+    uint64_t         rn_tls_handshakes; /* Successful TLS handshakes, see restconf_native_stats */
+    uint64_t         rn_tls_resumed;    /* Resumed TLS sessions of rn_tls_handshakes */
+    uint64_t         rn_tls_tickets;    /* Issued TLS session tickets */
+    uint64_t         rn_http1_requests; /* HTTP/1 requests */
+    uint64_t         rn_http1_reused;   /* HTTP/1 requests on a reused connection */
 } restconf_native_handle;
 
 /*
@@ -174,6 +199,7 @@ typedef struct {
 restconf_stream_data *restconf_stream_data_new(restconf_conn *rc, int32_t stream_id);
 restconf_stream_data *restconf_stream_find(restconf_conn *rc, int32_t id);
 int               restconf_stream_free(restconf_stream_data *sd);
+int               restconf_stream_resume(restconf_stream_data *sd);
 restconf_conn    *restconf_conn_new(clicon_handle h, int s, restconf_socket *socket);
 int               ssl_x509_name_oneline(SSL *ssl, char **oneline);
 
@@ -186,6 +212,8 @@ int               restconf_idle_timer_unreg(restconf_conn *rc);
 int               restconf_idle_timer(restconf_conn *rc);
 int               restconf_callhome_timer_unreg(restconf_socket *rsock);
 int               restconf_callhome_timer(restconf_socket *rsock, int status);
+int               restconf_callhome_stats(restconf_native_handle *rn, uint64_t *nr, uint64_t *connects,
+                                          uint64_t *fails, uint64_t *usec, uint64_t *max);
 int               restconf_socket_extract(clicon_handle h, cxobj *xs, cvec *nsc, restconf_socket *rsock,
                                           char **namespace, char **address, char **addrtype, uint16_t *port);
     
@@ -84,9 +84,12 @@
 #include "restconf_api.h"       /* generic not shared with plugins */
 #include "restconf_err.h"
 #include "restconf_root.h"
+#include "restconf_stream.h"
+#include "restconf_metrics.h"
 #include "restconf_native.h"    /* Restconf-openssl mode specific headers*/
 #ifdef HAVE_LIBNGHTTP2          /* Ends at end-of-file */
 #include "restconf_nghttp2.h"   /* Restconf-openssl mode specific headers*/
+#include "restconf_gnmi.h"
 #include "clixon_http_data.h"
 
 #define ARRLEN(x) (sizeof(x) / sizeof(x[0]))
@@ -288,6 +291,9 @@ restconf_nghttp2_path(restconf_stream_data *sd)
     char          *oneline = NULL;
     cvec          *cvv = NULL;
     char          *cn;
+#ifdef RESTCONF_METRICS
+    restconf_native_handle *rn;
+#endif
     
     clicon_debug(1, "------------");
     rc = sd->sd_conn;
@@ -316,19 +322,35 @@ restconf_nghttp2_path(restconf_stream_data *sd)
     if (!rc->rc_exit){
         /* Matching algorithm:
          * 1. try well-known
-         * 2. try /restconf
-         * 3. try /data
-         * 4. call restconf anyway (because it handles errors)
+         * 2. try /gnmi.gNMI
+         * 3. try /restconf
+         * 4. try /streams
+         * 5. try /data
+         * 6. call restconf anyway (because it handles errors)
          * This is for the situation where data is / and /restconf is more specific
          */
         if (strcmp(sd->sd_path, RESTCONF_WELL_KNOWN) == 0){
             if (api_well_known(h, sd) < 0)
                 goto done;
         }
+#ifdef RESTCONF_METRICS
+        else if (strcmp(sd->sd_path, RESTCONF_METRICS_PATH) == 0){
+            if (api_metrics(h, sd, (rn = restconf_native_handle_get(h)) ? rn->rn_worker : 0) < 0)
+                goto done;
+        }
+#endif
+        else if (api_path_is_gnmi(h)){
+            if (api_gnmi(h, sd) < 0)
+                goto done;
+        }
         else if (api_path_is_restconf(h)){
             if (api_root_restconf(h, sd, sd->sd_qvec) < 0)
                 goto done;          
         }
+        else if (api_path_is_stream(h)){
+            if (api_stream(h, sd, sd->sd_qvec, NULL) < 0)
+                goto done;
+        }
         else if (api_path_is_data(h)){
             if (api_http_data(h, sd, sd->sd_qvec) < 0)
                 goto done;
@@ -339,6 +361,8 @@ restconf_nghttp2_path(restconf_stream_data *sd)
     /* Clear (fcgi) paramaters from this request */
     if (restconf_param_del_all(h) < 0)
         goto done;
+    /* Free pooled objects beyond what the requests since the last trim needed */
+    clixon_pool_trim();
     retval = 0;
  done:
     clicon_debug(1, "%s %d", __FUNCTION__, retval);
@@ -349,19 +373,60 @@ restconf_nghttp2_path(restconf_stream_data *sd)
     return retval; /* void */
 }
 
-/*! data callback, just pass pointer to cbuf
+/*! Data callback of a streamed reply, pull body data from the producer
+ *
+ * The producer is called when the previously produced data has been sent, so that at most
+ * one part is buffered per stream. The callback is only called when the HTTP/2 flow control
+ * window allows sending data.
+ * If the producer has no data for now, eg an event stream, the data is deferred until the
+ * producer resumes the stream.
+ * @see restconf_reply_send_stream
+ */
+static ssize_t
+restconf_sd_read_stream(restconf_stream_data *sd,
+                        uint8_t              *buf,
+                        size_t                length,
+                        uint32_t             *data_flags)
+{
+    cbuf   *cb = sd->sd_body;
+    size_t  len;
+    size_t  chunk;
+    int     ret;
+
+    if (sd->sd_body_offset == cbuf_len(cb) && sd->sd_body_fn != NULL){
+        cbuf_reset(cb);
+        sd->sd_body_offset = 0;
+        chunk = clicon_option_int(sd->sd_conn->rc_h, "CLICON_RESTCONF_STREAM_CHUNK");
+        if ((ret = sd->sd_body_fn(sd->sd_body_arg, cb, chunk>length?chunk:length)) < 0)
+            return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+        if (ret == 0){ /* End of body */
+            sd->sd_body_free(sd->sd_body_arg);
+            sd->sd_body_arg = NULL;
+            sd->sd_body_fn = NULL;
+        }
+        else if (ret == 2 && cbuf_len(cb) == 0) /* No data for now, see http2_stream_resume */
+            return NGHTTP2_ERR_DEFERRED;
+    }
+    len = cbuf_len(cb) - sd->sd_body_offset;
+    if (len > length)
+        len = length;
+    memcpy(buf, cbuf_get(cb) + sd->sd_body_offset, len);
+    sd->sd_body_offset += len;
+    if (sd->sd_body_fn == NULL && sd->sd_body_offset == cbuf_len(cb))
+        *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+    clicon_debug(1, "%s retval:%zu", __FUNCTION__, len);
+    return len;
+}
+
+/*! Pass body data from cbuf, or from the producer of a streamed reply
  * XXX handle several chunks with cbuf 
  */
 static ssize_t
-restconf_sd_read(nghttp2_session     *session,
-                 int32_t              stream_id,
-                 uint8_t             *buf,
-                 size_t               length,
-                 uint32_t            *data_flags,
-                 nghttp2_data_source *source,
-                 void                *user_data)
+restconf_sd_read_body(restconf_stream_data *sd,
+                      uint8_t              *buf,
+                      size_t                length,
+                      uint32_t             *data_flags)
 {
-    restconf_stream_data *sd = (restconf_stream_data *)source->ptr;
     cbuf                 *cb;
     size_t                len = 0;
     size_t                remain;
@@ -370,6 +435,8 @@ restconf_sd_read(nghttp2_session     *session,
         *data_flags |= NGHTTP2_DATA_FLAG_EOF;
         return 0;
     }
+    if (sd->sd_body_fn != NULL || sd->sd_body_len == 0)
+        return restconf_sd_read_stream(sd, buf, length, data_flags);
 #if 0
     if (cbuf_len(cb) <= length){
         len = remain;
@@ -404,6 +471,77 @@ restconf_sd_read(nghttp2_session     *session,
     return len;
 }
 
+/*! Submit trailer fields of stream, which then ends the stream after the body
+ *
+ * @param[in]  session    nghttp2 session
+ * @param[in]  stream_id  HTTP/2 stream
+ * @param[in]  sd         Restconf stream data with sd_outp_trailers
+ * @retval     0          OK
+ * @retval    -1          Error
+ */
+static int
+restconf_submit_trailer(nghttp2_session      *session,
+                        int32_t               stream_id,
+                        restconf_stream_data *sd)
+{
+    int           retval = -1;
+    nghttp2_error ngerr;
+    cg_var       *cv;
+    nghttp2_nv   *hdrs = NULL;
+    nghttp2_nv   *hdr;
+    int           i = 0;
+
+    if ((hdrs = (nghttp2_nv*)calloc(cvec_len(sd->sd_outp_trailers), sizeof(nghttp2_nv))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    cv = NULL;
+    while ((cv = cvec_each(sd->sd_outp_trailers, cv)) != NULL){
+        hdr = &hdrs[i++];
+        hdr->name = (uint8_t*)cv_name_get(cv);
+        clicon_debug(1, "%s trailer: %s", __FUNCTION__, hdr->name);
+        hdr->value = (uint8_t*)cv_string_get(cv);
+        hdr->namelen = strlen(cv_name_get(cv));
+        hdr->valuelen = strlen(cv_string_get(cv));
+        hdr->flags = 0;
+    }
+    if ((ngerr = nghttp2_submit_trailer(session, stream_id, hdrs, i)) < 0){
+        clicon_err(OE_NGHTTP2, ngerr, "nghttp2_submit_trailer");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (hdrs)
+        free(hdrs);
+    return retval;
+}
+
+/*! data callback, just pass pointer to cbuf
+ *
+ * If the stream has trailer fields, they are sent after the body and end the stream
+ */
+static ssize_t
+restconf_sd_read(nghttp2_session     *session,
+                 int32_t              stream_id,
+                 uint8_t             *buf,
+                 size_t               length,
+                 uint32_t            *data_flags,
+                 nghttp2_data_source *source,
+                 void                *user_data)
+{
+    restconf_stream_data *sd = (restconf_stream_data *)source->ptr;
+    ssize_t               len;
+
+    if ((len = restconf_sd_read_body(sd, buf, length, data_flags)) < 0)
+        return len;
+    if ((*data_flags & NGHTTP2_DATA_FLAG_EOF) && cvec_len(sd->sd_outp_trailers)){
+        if (restconf_submit_trailer(session, stream_id, sd) < 0)
+            return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+        *data_flags |= NGHTTP2_DATA_FLAG_NO_END_STREAM;
+    }
+    return len;
+}
+
 static int
 restconf_submit_response(nghttp2_session      *session,
                          restconf_conn        *rc,
@@ -478,7 +616,12 @@ http2_exec(restconf_conn        *rc,
         goto done;
     sd->sd_proto = HTTP_2; /* XXX is this necessary? */
     if (strcmp(sd->sd_path, RESTCONF_WELL_KNOWN) == 0
+#ifdef RESTCONF_METRICS
+        || strcmp(sd->sd_path, RESTCONF_METRICS_PATH) == 0
+#endif
+        || api_path_is_gnmi(rc->rc_h)
         || api_path_is_restconf(rc->rc_h)
+        || api_path_is_stream(rc->rc_h)
         || api_path_is_data(rc->rc_h)){
         if (restconf_nghttp2_path(sd) < 0)
             goto done;
@@ -486,6 +629,8 @@ http2_exec(restconf_conn        *rc,
     else{
         sd->sd_code = 404;    /* not found */
     }
+    if (restconf_metrics_end(rc->rc_h, sd) < 0)
+        goto done;
     if (restconf_param_del_all(rc->rc_h) < 0) // XXX
         goto done;
 
@@ -537,6 +682,9 @@ on_frame_recv_callback(nghttp2_session     *session,
              */
             if ((sd = nghttp2_session_get_stream_user_data(session, frame->hd.stream_id)) == NULL)
                 return 0;
+            /* Replied before end of request, eg gNMI Subscribe */
+            if (sd->sd_code != 0)
+                return 0;
             /* Query vector, ie the ?a=x&b=y stuff */
             query = restconf_param_get(rc->rc_h, "REQUEST_URI");
             if ((query = index(query, '?')) != NULL){
@@ -548,6 +696,15 @@ on_frame_recv_callback(nghttp2_session     *session,
             if (http2_exec(rc, sd, session, frame->hd.stream_id) < 0)
                 goto done;
         }
+        /* A bidirectional gRPC stream is replied to when its first message is received */
+        else if (frame->hd.type == NGHTTP2_DATA &&
+                 (sd = nghttp2_session_get_stream_user_data(session, frame->hd.stream_id)) != NULL &&
+                 sd->sd_code == 0 &&
+                 gnmi_request_ready(sd) &&
+                 api_path_is_gnmi(rc->rc_h)){
+            if (http2_exec(rc, sd, session, frame->hd.stream_id) < 0)
+                goto done;
+        }
         break;
     default:
         break;
@@ -640,9 +797,16 @@ on_stream_close_callback(nghttp2_session   *session,
                          nghttp2_error_code error_code,
                          void              *user_data)
 {
-    //    restconf_conn *rc = (restconf_conn *)user_data;
+    restconf_stream_data *sd;
 
     clicon_debug(1, "%s %d %s", __FUNCTION__, error_code, nghttp2_strerror(error_code));
+    /* Stop producing a streamed reply body, eg the peer closed an event stream */
+    if ((sd = nghttp2_session_get_stream_user_data(session, stream_id)) != NULL &&
+        sd->sd_body_arg != NULL && sd->sd_body_free != NULL){
+        sd->sd_body_free(sd->sd_body_arg);
+        sd->sd_body_arg = NULL;
+        sd->sd_body_fn = NULL;
+    }
 #if 0 // NOTNEEDED /* XXX think this is not necessary? */
     if (error_code){
         if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
@@ -667,6 +831,8 @@ on_begin_headers_callback(nghttp2_session     *session,
         frame->headers.cat == NGHTTP2_HCAT_REQUEST) {
         sd = restconf_stream_data_new(rc, frame->hd.stream_id);
         nghttp2_session_set_stream_user_data(session, frame->hd.stream_id, sd);
+        if (sd)
+            restconf_metrics_begin(sd);
     }
     return 0;
 }
@@ -938,6 +1104,44 @@ http2_recv(restconf_conn       *rc,
     goto done;
 }
 
+/*! Resume a streamed reply whose producer earlier had no data, and send it
+ *
+ * @param[in] rc         Restconf connection
+ * @param[in] stream_id  HTTP/2 stream
+ * @retval    1          OK
+ * @retval    0          OK, sending failed and connection closed
+ * @retval   -1          Fatal error
+ * @see restconf_sd_read_stream
+ */
+int
+http2_stream_resume(restconf_conn *rc,
+                    int32_t        stream_id)
+{
+    int           retval = -1;
+    nghttp2_error ngerr;
+
+    clicon_debug(1, "%s %d", __FUNCTION__, stream_id);
+    if (rc->rc_ngsession == NULL){
+        clicon_err(OE_RESTCONF, EINVAL, "No nghttp2 session"); 
+        goto done;
+    }
+    /* Fails if the data is not deferred, then it is sent anyway */
+    (void)nghttp2_session_resume_data(rc->rc_ngsession, stream_id);
+    clicon_err_reset();
+    if ((ngerr = nghttp2_session_send(rc->rc_ngsession)) != 0){
+        if (clicon_errno)
+            goto done;
+        if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
+    retval = 1;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    return retval;
+}
+
 /* Send HTTP/2 client connection header, which includes 24 bytes
    magic octets and SETTINGS frame */
 int
@@ -59,6 +59,7 @@
 
 /* clicon */
 #include <clixon/clixon.h>
+#include <clixon/clixon_probe.h>
 
 /* restconf */
 #include "restconf_lib.h"
@@ -212,6 +213,10 @@ api_root_restconf_exact(clicon_handle  h,
         if (clixon_json2cbuf(cb, xt, pretty, 0, 0) < 0)
             goto done;
         break;
+    case YANG_DATA_CBOR:
+        if (clixon_xml2cbor_cbuf(cb, xt, 0) < 0)
+            goto done;
+        break;
     default:
         break;
     }
@@ -296,6 +301,10 @@ api_yang_library_version(clicon_handle h,
         if (clixon_json2cbuf(cb, xt, pretty, 0, 0) < 0)
             goto done;
         break;
+    case YANG_DATA_CBOR:
+        if (clixon_xml2cbor_cbuf(cb, xt, 0) < 0)
+            goto done;
+        break;
     default:
         break;
     }
@@ -474,6 +483,7 @@ api_root_restconf(clicon_handle        h,
     request_method = restconf_param_get(h, "REQUEST_METHOD");
     if ((path = restconf_uripath(h)) == NULL)
         goto done;
+    CLIXON_PROBE2(restconf_request_start, request_method?request_method:"", path);
     pretty = restconf_pretty_get(h);
     /* Get media for output (proactive negotiation) RFC7231 by using
      * Accept:. This is for methods that have output, such as GET, 
@@ -535,6 +545,8 @@ api_root_restconf(clicon_handle        h,
         goto done;
     indata = cbuf_get(cb);
     clicon_debug(1, "%s DATA=%s", __FUNCTION__, indata);
+    if (clicon_data_int_set(h, RESTCONF_INDATA_LEN, cbuf_len(cb)) < 0)
+        goto done;
 
     /* If present, check credentials. See "plugin_credentials" in plugin  
      * retvals:
@@ -624,8 +636,10 @@ api_root_restconf(clicon_handle        h,
         cvec_free(pcvec);
     if (pvec)
         free(pvec);
-    if (path)
+    if (path){
+        CLIXON_PROBE3(restconf_request_done, request_method?request_method:"", path, retval);
         free(path);
+    }
     return retval;
 }
 
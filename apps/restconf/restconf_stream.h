@@ -44,5 +44,6 @@ int api_path_is_stream(clicon_handle h);
 int stream_child_free(clicon_handle h, int pid);
 int stream_child_freeall(clicon_handle h);
 int api_stream(clicon_handle h, void *req, cvec *qvec, int *finish);
+int restconf_stream_stats(uint64_t *nbackend, uint64_t *nsub, uint64_t *events, uint64_t *disconnected);
 
 #endif /* _RESTCONF_STREAM_H_ */
@@ -0,0 +1,835 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  Restconf event streams of native restconf
+  See RFC 8040  RESTCONF Protocol Sections 3.8, 6, 9.3
+  Server-Sent Events subscriptions on GET /<CLICON_STREAM_PATH>/<stream>, HTTP/1 and HTTP/2
+
+  Data structures:
+
+  +-------------------+ sb_subs  +-------------------+ su_sd  +----------------------+
+  | stream_backend    |--------->| stream_sub        |------->| restconf_stream_data |
+  +-------------------+    n     +-------------------+        +----------------------+
+  One backend subscription       One HTTP subscriber           HTTP/1 connection or
+  per stream, filter and user    with queue of events          HTTP/2 stream
+
+  A notification from the backend is serialized once as an event and queued to all
+  subscribers of the backend subscription. The event is shared and reference counted.
+  The queue of a subscriber is the producer of its reply body, see restconf_reply_send_stream,
+  and is written as the peer reads it: with HTTP/2 flow control, with HTTP/1 on a non-blocking
+  socket. If a subscriber queues more than CLICON_RESTCONF_STREAM_HWM bytes, its event stream
+  is ended, so that a slow subscriber does not hold memory or delay others.
+  Subscriptions with start-time or stop-time are replays and not shared.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <syslog.h>
+#include <inttypes.h>
+#include <sys/time.h>
+
+#include <openssl/ssl.h>
+
+#ifdef HAVE_LIBNGHTTP2
+#include <nghttp2/nghttp2.h>
+#endif
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+/* restconf */
+#include "restconf_lib.h"
+#include "restconf_handle.h"
+#include "restconf_api.h"
+#include "restconf_err.h"
+#include "restconf_native.h"
+#include "restconf_stream.h"
+
+/* Notification serialized as an event, shared by subscribers */
+typedef struct {
+    int    se_refcnt;  /* Number of subscriber queues referencing event */
+    cbuf  *se_cb;      /* Event as "data:" lines ending with empty line */
+} stream_event;
+
+/* Queued event of a subscriber */
+struct stream_qentry {
+    qelem_t       sq_qelem; /* List header */
+    stream_event *sq_ev;
+};
+
+struct stream_backend;
+
+/* HTTP subscriber of a backend subscription */
+typedef struct {
+    qelem_t                su_qelem;   /* List header */
+    struct stream_backend *su_backend; /* Backpointer to backend subscription */
+    restconf_stream_data  *su_sd;      /* HTTP stream, NULL if closed */
+    struct stream_qentry  *su_queue;   /* Events not yet produced */
+    size_t                 su_queued;  /* Bytes in su_queue */
+    int                    su_end;     /* End event stream when queue is produced */
+    int                    su_removed; /* Closed while backend busy, see stream_backend_sweep */
+} stream_sub;
+
+/* Backend subscription, shared by subscribers of the same stream, filter and user */
+typedef struct stream_backend {
+    qelem_t       sb_qelem;    /* List header */
+    clicon_handle sb_h;        /* Clixon handle */
+    char         *sb_stream;   /* Stream name */
+    char         *sb_filter;   /* XPath filter, or NULL */
+    char         *sb_username; /* User of subscription, or NULL */
+    int           sb_shared;   /* Shared by new subscribers, 0 if replay */
+    int           sb_s;        /* Notification socket, -1 if closed */
+    int           sb_busy;     /* Events are sent to subscribers, defer their removal */
+    stream_sub   *sb_subs;     /* List of subscribers */
+} stream_backend;
+
+/* List of backend subscriptions of this process
+ */
+static stream_backend *STREAM_BACKEND = NULL;
+
+/* Stats, see restconf_stream_stats */
+static uint64_t _stream_events = 0;       /* Notifications received */
+static uint64_t _stream_disconnected = 0; /* Subscribers ended since queue was full */
+
+/*! Check if uri path denotes a stream/notification path
+ *
+ * @retval     0    No, not a stream path
+ * @retval     1    Yes, a stream path
+ */
+int
+api_path_is_stream(clicon_handle h)
+{
+    int    retval = 0;
+    char  *path = NULL;
+    char  *stream_path;
+
+   if ((path = restconf_uripath(h)) == NULL)
+       goto done;
+   if ((stream_path = clicon_option_str(h, "CLICON_STREAM_PATH")) == NULL)
+       goto done;
+   if (strlen(path) < 1 + strlen(stream_path)) /* "/" + stream */
+       goto done;
+   if (path[0] != '/')
+       goto done;
+   if (strncmp(path+1, stream_path, strlen(stream_path)) != 0)
+       goto done;
+    retval = 1;
+ done:
+    if (path)
+        free(path);
+    return retval;
+}
+
+/*! Release a reference of an event, free it if not referenced
+ */
+static void
+stream_event_unref(stream_event *se)
+{
+    if (--se->se_refcnt <= 0){
+        if (se->se_cb)
+            cbuf_free(se->se_cb);
+        free(se);
+    }
+}
+
+/*! Serialize notification as a Server-Sent Event
+ *
+ * Each line of the notification is a "data:" field
+ * @param[in]  xn   XML notification
+ * @retval     se   Event, not referenced
+ * @retval     NULL Error
+ */
+static stream_event *
+stream_event_new(cxobj *xn)
+{
+    stream_event *se = NULL;
+    cbuf         *cb = NULL;
+    char         *str;
+    char         *nl;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, xn, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    if ((se = malloc(sizeof(*se))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(se, 0, sizeof(*se));
+    if ((se->se_cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        free(se);
+        se = NULL;
+        goto done;
+    }
+    str = cbuf_get(cb);
+    while ((nl = strchr(str, '\n')) != NULL){
+        *nl = '\0';
+        cprintf(se->se_cb, "data: %s\r\n", str);
+        str = nl + 1;
+    }
+    cprintf(se->se_cb, "data: %s\r\n\r\n", str);
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return se;
+}
+
+/*! Drop all queued events of a subscriber
+ */
+static void
+stream_sub_flush(stream_sub *su)
+{
+    struct stream_qentry *sq;
+
+    while ((sq = su->su_queue) != NULL){
+        DELQ(sq, su->su_queue, struct stream_qentry *);
+        stream_event_unref(sq->sq_ev);
+        free(sq);
+    }
+    su->su_queued = 0;
+}
+
+/*! Free a backend subscription without subscribers, and close its notification socket
+ *
+ * The backend removes the subscription when the socket is closed
+ */
+static int
+stream_backend_free(stream_backend *sb);
+
+/*! Remove subscribers closed while the backend subscription was busy
+ *
+ * @param[in]  sb   Backend subscription
+ * @retval     1    OK
+ * @retval     0    OK, no subscribers left and sb freed
+ */
+static int
+stream_backend_sweep(stream_backend *sb)
+{
+    stream_sub *su;
+    stream_sub *next;
+    int         i;
+    int         n;
+
+    n = 0;
+    if ((su = sb->sb_subs) != NULL){
+        do {
+            n++;
+            su = NEXTQ(stream_sub *, su);
+        } while (su && su != sb->sb_subs);
+    }
+    su = sb->sb_subs;
+    for (i=0; i<n; i++){
+        next = NEXTQ(stream_sub *, su);
+        if (su->su_removed){
+            DELQ(su, sb->sb_subs, stream_sub *);
+            free(su);
+        }
+        su = next;
+    }
+    if (sb->sb_subs == NULL){
+        stream_backend_free(sb);
+        return 0;
+    }
+    return 1;
+}
+
+/*! Free subscriber when its HTTP stream is closed
+ *
+ * Free function of the reply body producer, see restconf_stream_free
+ * @param[in]  arg   Subscriber
+ */
+static int
+stream_sub_free(void *arg)
+{
+    stream_sub     *su = (stream_sub *)arg;
+    stream_backend *sb = su->su_backend;
+
+    clicon_debug(1, "%s %s", __FUNCTION__, sb->sb_stream);
+    su->su_sd = NULL;
+    stream_sub_flush(su);
+    su->su_removed = 1;
+    if (!sb->sb_busy)
+        stream_backend_sweep(sb);
+    return 0;
+}
+
+/*! Produce next part of an event stream from the queue of a subscriber
+ *
+ * @param[in]  arg   Subscriber
+ * @param[out] cb    Events are appended
+ * @param[in]  len   Minimum number of bytes to append, 0 means all queued
+ * @retval     2     OK, no more events for now
+ * @retval     1     OK, more events
+ * @retval     0     OK, end of event stream
+ * @see restconf_reply_send_stream
+ */
+static int
+stream_sub_next(void  *arg,
+                cbuf  *cb,
+                size_t len)
+{
+    stream_sub           *su = (stream_sub *)arg;
+    struct stream_qentry *sq;
+    stream_event         *se;
+
+    while ((sq = su->su_queue) != NULL && (len == 0 || cbuf_len(cb) < len)){
+        se = sq->sq_ev;
+        if (cbuf_append_buf(cb, cbuf_get(se->se_cb), cbuf_len(se->se_cb)) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            return -1;
+        }
+        su->su_queued -= cbuf_len(se->se_cb);
+        DELQ(sq, su->su_queue, struct stream_qentry *);
+        stream_event_unref(se);
+        free(sq);
+    }
+    if (su->su_queue != NULL)
+        return 1;
+    if (su->su_end)
+        return 0;
+    return 2;
+}
+
+/*! End the event stream of a subscriber when its queue is written
+ *
+ * @param[in]  su    Subscriber
+ * @param[in]  drop  Drop queued events
+ * @retval     0     OK, su may be closed
+ * @retval    -1     Error
+ */
+static int
+stream_sub_end(stream_sub *su,
+               int         drop)
+{
+    su->su_end = 1;
+    if (drop)
+        stream_sub_flush(su);
+    if (su->su_sd && restconf_stream_resume(su->su_sd) < 0)
+        return -1;
+    return 0;
+}
+
+static int
+stream_backend_free(stream_backend *sb)
+{
+    clicon_debug(1, "%s %s", __FUNCTION__, sb->sb_stream);
+    DELQ(sb, STREAM_BACKEND, stream_backend *);
+    if (sb->sb_s != -1){
+        clixon_event_unreg_fd(sb->sb_s, NULL);
+        close(sb->sb_s);
+    }
+    if (sb->sb_stream)
+        free(sb->sb_stream);
+    if (sb->sb_filter)
+        free(sb->sb_filter);
+    if (sb->sb_username)
+        free(sb->sb_username);
+    free(sb);
+    return 0;
+}
+
+/*! Queue a notification to all subscribers of a backend subscription
+ *
+ * @param[in]  sb    Backend subscription
+ * @param[in]  xn    XML notification
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+stream_backend_fanout(stream_backend *sb,
+                      cxobj          *xn)
+{
+    int                   retval = -1;
+    stream_event         *se = NULL;
+    stream_sub           *su;
+    struct stream_qentry *sq;
+    uint32_t              hwm;
+    size_t                len;
+
+    if ((se = stream_event_new(xn)) == NULL)
+        goto done;
+    se->se_refcnt = 1; /* Held during fan-out */
+    len = cbuf_len(se->se_cb);
+    hwm = clicon_option_int(sb->sb_h, "CLICON_RESTCONF_STREAM_HWM");
+    _stream_events++;
+    /* Queue first, resume after, since resume may close subscribers */
+    if ((su = sb->sb_subs) != NULL){
+        do {
+            if (su->su_sd && !su->su_end){
+                if (hwm && su->su_queued + len > hwm){
+                    clicon_log(LOG_WARNING, "%s: event stream %s subscriber queue full, disconnecting",
+                               __PROGRAM__, sb->sb_stream);
+                    _stream_disconnected++;
+                    su->su_end = 1;
+                    stream_sub_flush(su);
+                }
+                else {
+                    if ((sq = malloc(sizeof(*sq))) == NULL){
+                        clicon_err(OE_UNIX, errno, "malloc");
+                        goto done;
+                    }
+                    memset(sq, 0, sizeof(*sq));
+                    sq->sq_ev = se;
+                    se->se_refcnt++;
+                    ADDQ(sq, su->su_queue);
+                    su->su_queued += len;
+                }
+            }
+            su = NEXTQ(stream_sub *, su);
+        } while (su && su != sb->sb_subs);
+    }
+    if ((su = sb->sb_subs) != NULL){
+        do {
+            if (su->su_sd && restconf_stream_resume(su->su_sd) < 0)
+                goto done;
+            su = NEXTQ(stream_sub *, su);
+        } while (su && su != sb->sb_subs);
+    }
+    retval = 0;
+ done:
+    if (se)
+        stream_event_unref(se);
+    return retval;
+}
+
+/*! Callback when stream notifications arrive from backend
+ *
+ * @param[in]  s    Notification socket
+ * @param[in]  arg  Backend subscription
+ * @see restconf_stream_cb of fcgi
+ */
+static int
+stream_backend_cb(int   s,
+                  void *arg)
+{
+    int                retval = -1;
+    stream_backend    *sb = (stream_backend *)arg;
+    int                eof;
+    struct clicon_msg *reply = NULL;
+    cxobj             *xtop = NULL;
+    cxobj             *xn;
+    stream_sub        *su;
+    int                ret;
+
+    clicon_debug(1, "%s %s", __FUNCTION__, sb->sb_stream);
+    if (clicon_msg_rcv(s, NULL, 0, &reply, &eof) < 0)
+        goto done;
+    sb->sb_busy++;
+    if (eof){
+        /* End all event streams of this subscription, no new subscribers */
+        clicon_debug(1, "%s eof", __FUNCTION__);
+        clixon_event_unreg_fd(s, stream_backend_cb);
+        close(s);
+        sb->sb_s = -1;
+        if ((su = sb->sb_subs) != NULL){
+            do {
+                if (stream_sub_end(su, 0) < 0)
+                    goto busy;
+                su = NEXTQ(stream_sub *, su);
+            } while (su && su != sb->sb_subs);
+        }
+        goto ok;
+    }
+    if ((ret = clicon_msg_decode(reply, NULL, NULL, &xtop, NULL)) < 0)
+        goto busy;
+    if (ret == 0){
+        clicon_err(OE_XML, EFAULT, "Invalid notification");
+        goto busy;
+    }
+    if ((xn = xpath_first(xtop, NULL, "notification")) != NULL &&
+        stream_backend_fanout(sb, xn) < 0)
+        goto busy;
+ ok:
+    retval = 0;
+ busy:
+    sb->sb_busy--;
+    stream_backend_sweep(sb);
+ done:
+    clicon_debug(1, "%s retval: %d", __FUNCTION__, retval);
+    if (xtop != NULL)
+        xml_free(xtop);
+    if (reply)
+        free(reply);
+    return retval;
+}
+
+/*! Append string XML-encoded as an attribute value
+ */
+static void
+stream_attr_cbuf_append(cbuf *cb,
+                        char *str)
+{
+    for (; *str; str++)
+        switch (*str){
+        case '&':
+            cprintf(cb, "&amp;");
+            break;
+        case '<':
+            cprintf(cb, "&lt;");
+            break;
+        case '"':
+            cprintf(cb, "&quot;");
+            break;
+        default:
+            cbuf_append(cb, *str);
+            break;
+        }
+}
+
+/*! Get a backend subscription of a stream, and make one if not shared
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  name   Stream name
+ * @param[in]  filter XPath filter, or NULL
+ * @param[in]  start  Start-time of replay, or NULL
+ * @param[in]  stop   Stop-time, or NULL
+ * @param[out] sbp    Backend subscription
+ * @param[out] xerrp  Backend error if retval = 0
+ * @retval     1      OK, sbp set
+ * @retval     0      Subscription failed, error in xerrp
+ * @retval    -1      Error
+ */
+static int
+stream_backend_get(clicon_handle    h,
+                   char            *name,
+                   char            *filter,
+                   char            *start,
+                   char            *stop,
+                   stream_backend **sbp,
+                   cxobj          **xerrp)
+{
+    int             retval = -1;
+    stream_backend *sb = NULL;
+    char           *username;
+    cbuf           *cb = NULL;
+    cxobj          *xret = NULL;
+    cxobj          *xe;
+    int             s = -1;
+    int             shared;
+
+    username = clicon_username_get(h);
+    shared = (start == NULL && stop == NULL);
+    if (shared && (sb = STREAM_BACKEND) != NULL){
+        do {
+            if (sb->sb_shared && sb->sb_s != -1 &&
+                strcmp(sb->sb_stream, name) == 0 &&
+                clicon_strcmp(sb->sb_filter, filter) == 0 &&
+                clicon_strcmp(sb->sb_username, username) == 0){
+                clicon_debug(1, "%s %s shared", __FUNCTION__, name);
+                *sbp = sb;
+                goto ok;
+            }
+            sb = NEXTQ(stream_backend *, sb);
+        } while (sb && sb != STREAM_BACKEND);
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* For internal XML protocol: add username attribute for access control
+     */
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    if (username){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s>", NETCONF_MESSAGE_ID_ATTR);
+    cprintf(cb, "<create-subscription xmlns=\"%s\"><stream>", EVENT_RFC5277_NAMESPACE);
+    xml_chardata_cbuf_append(cb, name);
+    cprintf(cb, "</stream>");
+    if (filter){
+        cprintf(cb, "<filter type=\"xpath\" select=\"");
+        stream_attr_cbuf_append(cb, filter);
+        cprintf(cb, "\"/>");
+    }
+    if (start){
+        cprintf(cb, "<startTime>");
+        xml_chardata_cbuf_append(cb, start);
+        cprintf(cb, "</startTime>");
+    }
+    if (stop){
+        cprintf(cb, "<stopTime>");
+        xml_chardata_cbuf_append(cb, stop);
+        cprintf(cb, "</stopTime>");
+    }
+    cprintf(cb, "</create-subscription></rpc>");
+    if (clicon_rpc_netconf(h, cbuf_get(cb), &xret, &s) < 0)
+        goto done;
+    if ((xe = xpath_first(xret, NULL, "rpc-reply/rpc-error")) != NULL){
+        if (s != -1)
+            close(s);
+        *xerrp = xret;
+        xret = NULL;
+        goto fail;
+    }
+    if ((sb = malloc(sizeof(*sb))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(sb, 0, sizeof(*sb));
+    sb->sb_h = h;
+    sb->sb_s = s;
+    sb->sb_shared = shared;
+    ADDQ(sb, STREAM_BACKEND);
+    if ((sb->sb_stream = strdup(name)) == NULL ||
+        (filter && (sb->sb_filter = strdup(filter)) == NULL) ||
+        (username && (sb->sb_username = strdup(username)) == NULL)){
+        clicon_err(OE_UNIX, errno, "strdup");
+        stream_backend_free(sb);
+        goto done;
+    }
+    if (clixon_event_reg_fd(s, stream_backend_cb, sb, "restconf stream socket") < 0){
+        stream_backend_free(sb);
+        goto done;
+    }
+    clicon_debug(1, "%s %s new backend subscription", __FUNCTION__, name);
+    *sbp = sb;
+ ok:
+    retval = 1;
+ done:
+    if (xret)
+        xml_free(xret);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Process a stream request, make the reply an event stream
+ *
+ * @param[in]  h          Clicon handle
+ * @param[in]  req        Generic Www handle, restconf stream data
+ * @param[in]  qvec       Query parameters, ie the ?<id>=<val>&<id>=<val> stuff
+ * @param[out] finish     Not used
+ * RFC 8040 Sec 6.3: GET of the location of a stream with "start-time", "stop-time" and
+ * "filter" query parameters
+ */
+int
+api_stream(clicon_handle h,
+           void         *req,
+           cvec         *qvec,
+           int          *finish)
+{
+    int                   retval = -1;
+    restconf_stream_data *sd = (restconf_stream_data *)req;
+    char                 *path = NULL;
+    char                 *method;
+    char                **pvec = NULL;
+    int                   pn;
+    int                   pretty;
+    restconf_media        media_out = YANG_DATA_XML;
+    cxobj                *xerr = NULL;
+    cxobj                *xe;
+    char                 *streampath;
+    char                 *filter = NULL;
+    char                 *start = NULL;
+    char                 *stop = NULL;
+    cg_var               *cv;
+    char                 *vname;
+    stream_backend       *sb = NULL;
+    stream_sub           *su = NULL;
+    int                   ret;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    streampath = clicon_option_str(h, "CLICON_STREAM_PATH");
+    if ((path = restconf_uripath(h)) == NULL)
+        goto done;
+    pretty = restconf_pretty_get(h);
+    if ((pvec = clicon_strsep(path, "/", &pn)) == NULL)
+        goto done;
+    /* Sanity check of path. Should be /stream/<name> */
+    if (pn != 3 || strlen(pvec[0]) != 0 || strcmp(pvec[1], streampath) ||
+        pvec[2] == NULL || strlen(pvec[2]) == 0){
+        if (netconf_invalid_value_xml(&xerr, "protocol", "Invalid path, /stream/<name> expected") < 0)
+            goto done;
+        if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    method = restconf_param_get(h, "REQUEST_METHOD");
+    if (method == NULL || strcmp(method, "GET") != 0){
+        if (restconf_method_notallowed(h, req, "GET", pretty, media_out) < 0)
+            goto done;
+        goto ok;
+    }
+    /* If present, check credentials. See "plugin_credentials" in plugin
+     * See RFC 8040 section 2.5
+     */
+    if ((ret = restconf_authentication_cb(h, req, pretty, media_out)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
+    cv = NULL;
+    while ((cv = cvec_each(qvec, cv)) != NULL){
+        vname = cv_name_get(cv);
+        if (strcmp(vname, "start-time") == 0)
+            start = cv_string_get(cv);
+        else if (strcmp(vname, "stop-time") == 0)
+            stop = cv_string_get(cv);
+        else if (strcmp(vname, "filter") == 0)
+            filter = cv_string_get(cv);
+        else {
+            if (netconf_invalid_value_xml(&xerr, "protocol", "Invalid query parameter of stream") < 0)
+                goto done;
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+    }
+    if ((ret = stream_backend_get(h, pvec[2], filter, start, stop, &sb, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        if ((xe = xpath_first(xerr, NULL, "rpc-reply/rpc-error")) != NULL &&
+            api_return_err(h, req, xe, pretty, media_out, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((su = malloc(sizeof(*su))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(su, 0, sizeof(*su));
+    su->su_backend = sb;
+    su->su_sd = sd;
+    ADDQ(su, sb->sb_subs);
+    /* The reply body is the event stream, produced from the queue of the subscriber */
+    if (restconf_reply_header(req, "Content-Type", "text/event-stream") < 0)
+        goto done;
+    if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
+        goto done;
+    if (sd->sd_conn->rc_proto != HTTP_2)
+        sd->sd_conn->rc_close = 1; /* HTTP/1 body ends when connection is closed */
+    if (sd->sd_body)
+        cbuf_free(sd->sd_body);
+    if ((sd->sd_body = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    sd->sd_code = 200;
+    sd->sd_body_offset = 0;
+    sd->sd_body_len = 0; /* Unknown, no Content-Length */
+    sd->sd_body_fn = stream_sub_next;
+    sd->sd_body_arg = su;
+    sd->sd_body_free = stream_sub_free;
+    su = NULL;
+ ok:
+    retval = 0;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (su)
+        stream_sub_free(su);
+    else if (sb && sb->sb_subs == NULL)
+        stream_backend_free(sb);
+    if (xerr)
+        xml_free(xerr);
+    if (pvec)
+        free(pvec);
+    if (path)
+        free(path);
+    return retval;
+}
+
+/*! Free all event streams and backend subscriptions
+ *
+ * Typically called on restconf exit, after connections are closed
+ */
+int
+stream_child_freeall(clicon_handle h)
+{
+    stream_backend *sb;
+    stream_sub     *su;
+
+    while ((sb = STREAM_BACKEND) != NULL){
+        while ((su = sb->sb_subs) != NULL){
+            DELQ(su, sb->sb_subs, stream_sub *);
+            if (su->su_sd){
+                su->su_sd->sd_body_fn = NULL;
+                su->su_sd->sd_body_arg = NULL;
+            }
+            stream_sub_flush(su);
+            free(su);
+        }
+        stream_backend_free(sb);
+    }
+    return 0;
+}
+
+/*! Get stats of event streams of this process
+ *
+ * @param[out] nbackend     Backend subscriptions
+ * @param[out] nsub         HTTP subscribers
+ * @param[out] events       Notifications received from backend
+ * @param[out] disconnected Subscribers ended since their queue was full
+ */
+int
+restconf_stream_stats(uint64_t *nbackend,
+                      uint64_t *nsub,
+                      uint64_t *events,
+                      uint64_t *disconnected)
+{
+    stream_backend *sb;
+    stream_sub     *su;
+
+    *nbackend = 0;
+    *nsub = 0;
+    if ((sb = STREAM_BACKEND) != NULL){
+        do {
+            (*nbackend)++;
+            if ((su = sb->sb_subs) != NULL){
+                do {
+                    (*nsub)++;
+                    su = NEXTQ(stream_sub *, su);
+                } while (su && su != sb->sb_subs);
+            }
+            sb = NEXTQ(stream_backend *, sb);
+        } while (sb && sb != STREAM_BACKEND);
+    }
+    *events = _stream_events;
+    *disconnected = _stream_disconnected;
+    return 0;
+}
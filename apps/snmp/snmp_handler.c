@@ -38,11 +38,14 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <pwd.h>
 #include <syslog.h>
 #include <errno.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <signal.h>
 
 /* net-snmp */
@@ -374,7 +377,227 @@ snmp_yang2xml(cxobj     *xtop,
     return retval;
 }
 
+/*! Handle-stored pending edits of one SNMP SET PDU
+ *
+ * The varbinds of all registrations of a SET PDU are translated in RESERVE2 and collected in one
+ * tree, which is sent to the backend in one edit-config and validated in the first ACTION, and
+ * committed in the first COMMIT.
+ */
+#define SNMP_SET_BATCH_NAME "snmp-set-batch"
+
+enum snmp_set_state {
+    SNMP_SET_COLLECT, /* Edits are collected */
+    SNMP_SET_SENT,    /* Edits are sent to candidate and validated */
+    SNMP_SET_DONE,    /* Edits are committed, or there were no edits */
+    SNMP_SET_FAILED   /* Validate or commit failed, candidate is discarded */
+};
+
+struct snmp_set_batch {
+    long                ssb_reqid; /* SNMP request-id of PDU */
+    cxobj              *ssb_xt;    /* Edits as edit-config config tree, or NULL */
+    enum snmp_set_state ssb_state;
+};
+
+/*! Free pending edits of SET PDU, eg after commit, undo or on exit
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+snmp_set_batch_free(clicon_handle h)
+{
+    struct snmp_set_batch *ssb = NULL;
+
+    if (clicon_ptr_get(h, SNMP_SET_BATCH_NAME, (void**)&ssb) < 0 || ssb == NULL)
+        return 0;
+    if (ssb->ssb_xt)
+        xml_free(ssb->ssb_xt);
+    free(ssb);
+    clicon_ptr_del(h, SNMP_SET_BATCH_NAME);
+    return 0;
+}
+
+/*! Start collecting edits of a SET PDU, unless already started by another registration
+ *
+ * @param[in]  h        Clixon handle
+ * @param[in]  reqinfo  Agent transaction request structure
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+snmp_set_batch_start(clicon_handle               h,
+                     netsnmp_agent_request_info *reqinfo)
+{
+    struct snmp_set_batch *ssb = NULL;
+    long                   reqid = -1;
+
+    if (reqinfo->asp && reqinfo->asp->pdu)
+        reqid = reqinfo->asp->pdu->reqid;
+    clicon_ptr_get(h, SNMP_SET_BATCH_NAME, (void**)&ssb);
+    if (ssb && ssb->ssb_reqid == reqid && ssb->ssb_state == SNMP_SET_COLLECT)
+        return 0;
+    snmp_set_batch_free(h);
+    if ((ssb = malloc(sizeof(*ssb))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memset(ssb, 0, sizeof(*ssb));
+    ssb->ssb_reqid = reqid;
+    ssb->ssb_state = SNMP_SET_COLLECT;
+    if (clicon_ptr_set(h, SNMP_SET_BATCH_NAME, ssb) < 0){
+        free(ssb);
+        return -1;
+    }
+    return 0;
+}
+
+/*! Add an edit to the pending edits of the SET PDU
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  xtop   Edit as edit-config config tree, nodes may be moved from it
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[in]  xpath  If set, remove earlier pending edit of this node, eg a deleted row
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+snmp_set_batch_add(clicon_handle h,
+                   cxobj        *xtop,
+                   cvec         *nsc,
+                   char         *xpath)
+{
+    int                    retval = -1;
+    struct snmp_set_batch *ssb = NULL;
+    yang_stmt             *yspec;
+    cxobj                 *x;
+    char                  *reason = NULL;
+    int                    ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_FATAL, 0, "No DB_SPEC");
+        goto done;
+    }
+    clicon_ptr_get(h, SNMP_SET_BATCH_NAME, (void**)&ssb);
+    if (ssb == NULL){
+        clicon_err(OE_SNMP, 0, "No SET PDU started");
+        goto done;
+    }
+    if (ssb->ssb_xt == NULL &&
+        (ssb->ssb_xt = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xpath && (x = xpath_first(ssb->ssb_xt, nsc, "%s", xpath)) != NULL)
+        if (xml_purge(x) < 0)
+            goto done;
+    if ((ret = xml_merge(ssb->ssb_xt, xtop, yspec, &reason)) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_err(OE_SNMP, 0, "%s", reason);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    return retval;
+}
+
+/*! Send pending edits of the SET PDU to candidate in one edit-config and validate
+ *
+ * Only the first ACTION of the PDU sends the edits.
+ * There does not seem to be a separate validation action and commit does not return an error.
+ * Therefore validation is done here directly as well as discard if it fails.
+ * @param[in]  h        Clixon handle
+ * @param[in]  request  The netsnmp request info structure, error is set if failed
+ * @retval     1        OK
+ * @retval     0        Validation failed, candidate is discarded
+ * @retval    -1        Error
+ */
+static int
+snmp_set_batch_send(clicon_handle         h,
+                    netsnmp_request_info *request)
+{
+    int                    retval = -1;
+    struct snmp_set_batch *ssb = NULL;
+    cbuf                  *cb = NULL;
+    int                    ret;
+
+    clicon_ptr_get(h, SNMP_SET_BATCH_NAME, (void**)&ssb);
+    if (ssb == NULL || ssb->ssb_state == SNMP_SET_SENT || ssb->ssb_state == SNMP_SET_DONE)
+        goto ok;
+    if (ssb->ssb_state == SNMP_SET_FAILED)
+        goto fail;
+    if (ssb->ssb_xt == NULL || xml_child_nr_type(ssb->ssb_xt, CX_ELMNT) == 0){
+        ssb->ssb_state = SNMP_SET_DONE; /* Eg only rowstatus cache */
+        goto ok;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, ssb->ssb_xt, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    clicon_debug(1, "%s %s", __FUNCTION__, cbuf_get(cb));
+    if (clicon_rpc_edit_config(h, "candidate", OP_MERGE, cbuf_get(cb)) < 0)
+        goto done;
+    if ((ret = clicon_rpc_validate(h, "candidate")) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_rpc_discard_changes(h);
+        ssb->ssb_state = SNMP_SET_FAILED;
+        goto fail;
+    }
+    ssb->ssb_state = SNMP_SET_SENT;
+ ok:
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+    retval = 0;
+    goto done;
+}
+
+/*! Commit pending edits of the SET PDU sent to candidate
+ *
+ * Only the first COMMIT of the PDU commits
+ * @param[in]  h        Clixon handle
+ * @param[in]  request  The netsnmp request info structure, error is set if failed
+ * @retval     1        OK
+ * @retval     0        Commit failed, candidate is discarded
+ * @retval    -1        Error
+ */
+static int
+snmp_set_batch_commit(clicon_handle         h,
+                      netsnmp_request_info *request)
+{
+    struct snmp_set_batch *ssb = NULL;
+    int                    ret;
+
+    clicon_ptr_get(h, SNMP_SET_BATCH_NAME, (void**)&ssb);
+    if (ssb == NULL || ssb->ssb_state != SNMP_SET_SENT)
+        return 1;
+    if ((ret = clicon_rpc_commit(h, 0, 0, 0, NULL, NULL)) < 0)
+        return -1;
+    /* Tables may have changed */
+    snmp_table_cache_free(h);
+    if (ret == 0){
+        /* Note that error given in commit is not propagated to the snmp client,
+         * therefore validation is in the ACTION instead
+         */
+        clicon_rpc_discard_changes(h);
+        ssb->ssb_state = SNMP_SET_FAILED;
+        netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+        return 0;
+    }
+    ssb->ssb_state = SNMP_SET_DONE;
+    return 1;
+}
+
 /*! Scalar handler, get a value from clixon 
+ *
+ * The value is added to the pending edits of the SET PDU, see snmp_set_batch_send
  * @param[in]  h          Clixon handle
  * @param[in]  ys         Yang node
  * @param[in]  cvk        Vector of index/Key variables, if any
@@ -399,10 +622,8 @@ snmp_scalar_set(clicon_handle               h,
     cxobj     *xb;
     int        ret;
     char      *valstr = NULL;
-    cbuf      *cb = NULL;
     netsnmp_variable_list *requestvb = request->requestvb;
     int        asn1_type;
-    enum operation_type op = OP_MERGE;
 
     clicon_debug(1, "%s", __FUNCTION__);
     if ((xtop = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
@@ -426,19 +647,11 @@ snmp_scalar_set(clicon_handle               h,
         if (xml_value_set(xb, valstr) < 0)
             goto done;
     }
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    if (clixon_xml2cbuf(cb, xtop, 0, 0, NULL, -1, 0) < 0)
-        goto done;
-    if (clicon_rpc_edit_config(h, "candidate", op, cbuf_get(cb)) < 0)
+    if (snmp_set_batch_add(h, xtop, NULL, NULL) < 0)
         goto done;
  ok:
     retval = 0;
  done:
-    if (cb)
-        cbuf_free(cb);
     if (xtop)
         xml_free(xtop);
     if (valstr)
@@ -449,6 +662,7 @@ snmp_scalar_set(clicon_handle               h,
 /* Make cache row operation: move to backend, remove altogether
  *
  * Remove row from cache, then make merge or delete operation on backend.
+ * The operation is added to the pending edits of the SET PDU, see snmp_set_batch_send
  * @param[in]  h     Clixon handle
  * @param[in]  yp    Yang statement of list / parent of leaf
  * @param[in]  cvk   Vector of index/Key variables
@@ -465,10 +679,9 @@ snmp_cache_row_op(clicon_handle h,
                   int           rpc)
 {
     int    retval = -1;
-    char  *xpath;
+    char  *xpath = NULL;
     cxobj *xrow = NULL;
     cvec  *nsc = NULL;
-    cbuf  *cb = NULL;
     cxobj *xtop = NULL;
     cxobj *xbot = NULL;
     cxobj *xa;
@@ -496,13 +709,8 @@ snmp_cache_row_op(clicon_handle h,
                 goto done;
             if (xml_addsub(xbot, xrow) < 0)
                 goto done;
-            if ((cb = cbuf_new()) == NULL){
-                clicon_err(OE_UNIX, errno, "cbuf_new");
-                goto done;
-            }   
-            if (clixon_xml2cbuf(cb, xtop, 0, 0, NULL, -1, 0) < 0)
-                goto done;
-            if (clicon_rpc_edit_config(h, "candidate", OP_NONE, cbuf_get(cb)) < 0)
+            /* Replaces earlier pending edits of the row */
+            if (snmp_set_batch_add(h, xtop, nsc, xpath) < 0)
                 goto done;
         }
         else
@@ -514,8 +722,6 @@ snmp_cache_row_op(clicon_handle h,
         xml_nsctx_free(nsc);
     if (xtop)
         xml_free(xtop);
-    if (cb)
-        cbuf_free(cb);
     if (xpath)
         free(xpath);
     return retval;
@@ -748,38 +954,29 @@ clixon_snmp_scalar_handler1(netsnmp_mib_handler          *handler,
         }
         break;
     case MODE_SET_RESERVE2: /* 1 */
-        break;
-    case MODE_SET_ACTION:   /* 2 */
+        /* Collect edits of all varbinds of the PDU */
+        if (snmp_set_batch_start(sh->sh_h, reqinfo) < 0)
+            goto done;
         if (snmp_scalar_set(sh->sh_h, sh->sh_ys, NULL, NULL, reqinfo, request) < 0)
             goto done;
-        /*
-         * There does not seem to be a separate validation action and commit does not 
-         * return an error.
-         * Therefore validation is done here directly as well as discard if it fails.
-         */
-        if ((ret = clicon_rpc_validate(sh->sh_h, "candidate")) < 0)
+        break;
+    case MODE_SET_ACTION:   /* 2 */
+        if ((ret = snmp_set_batch_send(sh->sh_h, request)) < 0)
             goto done;
-        if (ret == 0){
-            clicon_rpc_discard_changes(sh->sh_h);
-            netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+        if (ret == 0)
             goto done;
-        }
         break;
     case MODE_SET_COMMIT:   /* 3 */
-        if ((ret = clicon_rpc_commit(sh->sh_h, 0, 0, 0, NULL, NULL)) < 0)
+        if ((ret = snmp_set_batch_commit(sh->sh_h, request)) < 0)
             goto done;
-        if (ret == 0){
-            /* Note that error given in commit is not propagated to the snmp client,
-             * therefore validation is in the ACTION instead
-             */
-            clicon_rpc_discard_changes(sh->sh_h);
-            netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+        if (ret == 0)
             goto done;
-        }
         break;
     case MODE_SET_FREE:     /* 4 */
+        snmp_set_batch_free(sh->sh_h);
         break;
     case MODE_SET_UNDO:     /* 5 */
+        snmp_set_batch_free(sh->sh_h);
         if (clicon_rpc_discard_changes(sh->sh_h) < 0)
             goto done;  
         break;
@@ -823,15 +1020,101 @@ clixon_snmp_scalar_handler(netsnmp_mib_handler          *handler,
     return retval;
 }
 
+/*! Get yang of column leaf from first part of OID using columns of registered table
+ *
+ * @param[in]  sh       Clixon snmp handle of registered table
+ * @param[in]  oids     OID of ultimate scalar value
+ * @param[in]  oidslen  OID length of scalar
+ * @retval     ys       Yang leaf of column
+ * @retval     NULL     No leaf with matching OID
+ * @see mibyang_table_register where the columns are computed
+ */
+static yang_stmt *
+snmp_table_column(clixon_snmp_handle *sh,
+                  oid                *oids,
+                  size_t              oidslen)
+{
+    clixon_snmp_column *scol;
+    int                 i;
+
+    for (i=0; i<sh->sh_ncols; i++){
+        scol = &sh->sh_cols[i];
+        if (sh->sh_oid2len + 1 != scol->scol_oidlen) /* Indexes may be from other OID scope, skip those */
+            continue;
+        if (oidslen >= scol->scol_oidlen &&
+            oids[scol->scol_oidlen-1] == scol->scol_oid[scol->scol_oidlen-1])
+            return scol->scol_ys;
+    }
+    return NULL;
+}
+
+/*! Create key values from later part of OID
+ *
+ * Inverse of snmp_str2oid
+ * @param[in]  sh       Clixon snmp handle of registered table
+ * @param[in]  oids     OID of ultimate scalar value, first part is column
+ * @param[in]  oidslen  OID length of scalar
+ * @param[out] cvkp     Key values, free with cvec_free
+ * @retval     1        OK
+ * @retval     0        Too long OID
+ * @retval    -1        Error
+ */
+static int
+snmp_table_keys(clixon_snmp_handle *sh,
+                oid                *oids,
+                size_t              oidslen,
+                cvec              **cvkp)
+{
+    int     retval = -1;
+    cvec   *cvk_orig;
+    cvec   *cvk_val = NULL;
+    oid    *oidi;
+    size_t  oidilen;
+    int     i;
+
+    if ((cvk_orig = yang_cvec_get(sh->sh_ys)) == NULL){
+        clicon_err(OE_YANG, 0, "No keys");
+        goto done;
+    }
+    if (cvec_len(cvk_orig) != sh->sh_nkeys){
+        clicon_err(OE_YANG, 0, "Table %s has %d keys, expected %d",
+                   yang_argument_get(sh->sh_ys), cvec_len(cvk_orig), sh->sh_nkeys);
+        goto done;
+    }
+    if ((cvk_val = cvec_dup(cvk_orig)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_dup");
+        goto done;
+    }
+    /* read through keys and create cvk */
+    oidilen = oidslen-(sh->sh_oid2len+1);
+    oidi = oids+sh->sh_oid2len+1;
+    /* Add keys */
+    for (i=0; i<cvec_len(cvk_val); i++){
+        if (snmp_oid2str(&oidi, &oidilen, sh->sh_keys[i], cvec_i(cvk_val, i)) < 0) 
+            goto done;
+    }
+    if (oidilen != 0){
+        clicon_err(OE_YANG, 0, "Expected oidlen 0 but is %zu", oidilen);
+        goto fail;
+    }
+    *cvkp = cvk_val;
+    cvk_val = NULL;
+    retval = 1;
+ done:
+    if (cvk_val)
+        cvec_free(cvk_val);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Create xpath from YANG table OID + 1 + n + cvk/key = requestvb->name 
  *
  * Get yang of leaf from first part of OID
  * Create xpath with right keys from later part of OID
  * Query clixon if object exists, if so return value
- * @param[in]  h        Clixon handle
- * @param[in]  yt       Yang of table (of list type)
- * @param[in]  oidt     OID of registered top container object (above list), may be different from yt
- * @param[in]  oidtlen  OID length of list object OID
+ * @param[in]  sh       Clixon snmp handle of registered table
  * @param[in]  oids     OID of ultimate scalar value
  * @param[in]  oidslen  OID length of scalar
  * @param[in]  reqinfo  Agent transaction request structure
@@ -841,47 +1124,20 @@ clixon_snmp_scalar_handler(netsnmp_mib_handler          *handler,
  * @retval     1        OK
  */
 static int
-snmp_table_get(clicon_handle               h,
-               yang_stmt                  *yt,
-               oid                        *oidt,
-               size_t                      oidtlen,
+snmp_table_get(clixon_snmp_handle         *sh,
                oid                        *oids,
                size_t                      oidslen,
                netsnmp_agent_request_info *reqinfo,
                netsnmp_request_info       *request)
 {
     int        retval = -1;
-    oid        oidleaf[MAX_OID_LEN] = {0,}; /* Leaf */
-    size_t     oidleaflen = MAX_OID_LEN;
-    oid       *oidi;
-    size_t     oidilen;
     yang_stmt *ys;
-    yang_stmt *yk;
-    char      *xpath = NULL;
-    cvec      *cvk_orig;
     cvec      *cvk_val = NULL;
-    int        i;
-    cg_var    *cv;
     char      *defaultval = NULL;
     int        ret;
 
     /* Get yang of leaf from first part of OID */
-    ys = NULL;
-    while ((ys = yn_each(yt, ys)) != NULL) {
-        if (yang_keyword_get(ys) != Y_LEAF)
-            continue;
-        /* reset oid */
-        oidleaflen = MAX_OID_LEN;
-        if ((ret = yangext_oid_get(ys, oidleaf, &oidleaflen, NULL)) < 0)
-            goto done;
-        if (ret == 0)
-            continue;
-        if (oidtlen + 1 != oidleaflen) /* Indexes may be from other OID scope, skip those */
-            continue;
-        if (oids[oidleaflen-1] == oidleaf[oidleaflen-1])
-            break;
-    }
-    if (ys == NULL){
+    if ((ys = snmp_table_column(sh, oids, oidslen)) == NULL){
         /* No leaf with matching OID */
         goto fail;
     }
@@ -889,37 +1145,13 @@ snmp_table_get(clicon_handle               h,
      */
     if (yang_extension_value_opt(ys, "smiv2:defval", NULL, &defaultval) < 0)
         goto done;
-    
-    /* Create xpath with right keys from later part of OID 
-     * Inverse of snmp_str2oid
-     */
-    if ((cvk_orig = yang_cvec_get(yt)) == NULL){
-        clicon_err(OE_YANG, 0, "No keys");
-        goto done;
-    }
-    if ((cvk_val = cvec_dup(cvk_orig)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_dup");
+    /* Create keys from later part of OID */
+    if ((ret = snmp_table_keys(sh, oids, oidslen, &cvk_val)) < 0)
         goto done;
-    }
-    /* read through keys and create cvk */
-    oidilen = oidslen-(oidtlen+1);
-    oidi = oids+oidtlen+1;
-    /* Add keys */
-    for (i=0; i<cvec_len(cvk_val); i++){
-        cv = cvec_i(cvk_val, i); 
-        if ((yk = yang_find(yt, Y_LEAF, cv_string_get(cv))) == NULL){
-            clicon_err(OE_YANG, 0, "List key %s not found", cv_string_get(cv));
-            goto done;
-        }
-        if (snmp_oid2str(&oidi, &oidilen, yk, cv) < 0) 
-            goto done;
-    }
-    if (oidilen != 0){
-        clicon_err(OE_YANG, 0, "Expected oidlen 0 but is %zu", oidilen);
+    if (ret == 0)
         goto fail;
-    }
     /* Get scalar value */
-    if (snmp_scalar_get(h, ys, cvk_val,
+    if (snmp_scalar_get(sh->sh_h, ys, cvk_val,
                         defaultval,
                         reqinfo,
                         request) < 0)
@@ -929,8 +1161,6 @@ snmp_table_get(clicon_handle               h,
  done:
     if (cvk_val)
         cvec_free(cvk_val);
-    if (xpath)
-        free(xpath);
     return retval;
  fail:
     retval = 0;
@@ -941,8 +1171,7 @@ snmp_table_get(clicon_handle               h,
  * Get yang of leaf from first part of OID
  * Create xpath with right keys from later part of OID
  * Query clixon if object exists, if so return value
- * @param[in]  h        Clixon handle
- * @param[in]  yt       Yang of table (of list type)
+ * @param[in]  sh       Clixon snmp handle of registered table
  * @param[in]  oids     OID of ultimate scalar value
  * @param[in]  oidslen  OID length of scalar
  * @param[in]  reqinfo  Agent transaction request structure
@@ -953,8 +1182,7 @@ snmp_table_get(clicon_handle               h,
  * @retval     1        OK
  */
 static int
-snmp_table_set(clicon_handle               h,
-               yang_stmt                  *yt,
+snmp_table_set(clixon_snmp_handle         *sh,
                oid                        *oids,
                size_t                      oidslen,
                netsnmp_agent_request_info *reqinfo,
@@ -962,53 +1190,28 @@ snmp_table_set(clicon_handle               h,
                int                        *err)
 {
     int        retval = -1;
-    oid        oidt[MAX_OID_LEN] = {0,}; /* Table / list oid */
-    size_t     oidtlen = MAX_OID_LEN;
-    oid        oidleaf[MAX_OID_LEN] = {0,}; /* Leaf */
-    size_t     oidleaflen = MAX_OID_LEN;
-    oid       *oidi;
-    size_t     oidilen;
+    clicon_handle h = sh->sh_h;
     yang_stmt *yi;
     yang_stmt *ys;
     yang_stmt *yrowst;
-    yang_stmt *yk;
     yang_stmt *yrestype = NULL;
-    char      *xpath = NULL;
-    cvec      *cvk_orig;
     cvec      *cvk_val = NULL;
     int        i;
-    cg_var    *cv;
     int        ret;
     int        asn1_type;
     netsnmp_variable_list  *requestvb;
     int        rowstatus = 0;
-    char      *origtype;
+    char      *origtype = NULL;
 
-    /* Get OID from table /list  */
-    if ((ret = yangext_oid_get(yt, oidt, &oidtlen, NULL)) < 0)
-        goto done;
-    if (ret == 0)
-        goto done;
     /* Get yang of leaf from first part of OID
      * and also leaf with rowstatus type
      */
-    ys = NULL;
+    ys = snmp_table_column(sh, oids, oidslen);
     yrowst = NULL;
-    yi = NULL;
-    while ((yi = yn_each(yt, yi)) != NULL) {
-        if (yang_keyword_get(yi) != Y_LEAF)
-            continue;
-        /* reset oid */
-        oidleaflen = MAX_OID_LEN;
-        if ((ret = yangext_oid_get(yi, oidleaf, &oidleaflen, NULL)) < 0)
-            goto done;
-        if (ret == 0)
-            continue;
-        if (oidtlen + 1 != oidleaflen) /* Indexes may be from other OID scope, skip those */
+    for (i=0; i<sh->sh_ncols; i++){
+        yi = sh->sh_cols[i].scol_ys;
+        if (sh->sh_oid2len + 1 != sh->sh_cols[i].scol_oidlen)
             continue;
-        if (oids[oidleaflen-1] == oidleaf[oidleaflen-1]){
-            ys = yi;
-        }
         origtype = NULL;
         if (snmp_yang_type_get(yi, NULL, &origtype, &yrestype, NULL) < 0)
             goto done;
@@ -1053,32 +1256,10 @@ snmp_table_set(clicon_handle               h,
             goto ok;
         }
     }
-    /* Create xpath with right keys from later part of OID 
-     * Inverse of snmp_str2oid
-     */
-    if ((cvk_orig = yang_cvec_get(yt)) == NULL){
-        clicon_err(OE_YANG, 0, "No keys");
-        goto done;
-    }
-    if ((cvk_val = cvec_dup(cvk_orig)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_dup");
+    /* Create keys from later part of OID */
+    if ((ret = snmp_table_keys(sh, oids, oidslen, &cvk_val)) < 0)
         goto done;
-    }
-    /* read through keys and create cvk */
-    oidilen = oidslen-(oidtlen+1);
-    oidi = oids+oidtlen+1;
-    /* Add keys */
-    for (i=0; i<cvec_len(cvk_val); i++){
-        cv = cvec_i(cvk_val, i); 
-        if ((yk = yang_find(yt, Y_LEAF, cv_string_get(cv))) == NULL){
-            clicon_err(OE_YANG, 0, "List key %s not found", cv_string_get(cv));
-            goto done;
-        }
-        if (snmp_oid2str(&oidi, &oidilen, yk, cv) < 0) 
-            goto done;
-    }
-    if (oidilen != 0){
-        clicon_err(OE_YANG, 0, "Expected oidlen 0 but is %zu", oidilen);
+    if (ret == 0){
         *err = SNMP_NOSUCHOBJECT;
         goto fail;
     }
@@ -1141,8 +1322,6 @@ snmp_table_set(clicon_handle               h,
  done:
     if (cvk_val)
         cvec_free(cvk_val);
-    if (xpath)
-        free(xpath);
     if (origtype)
         free(origtype);
     return retval;
@@ -1151,27 +1330,94 @@ snmp_table_set(clicon_handle               h,
     goto done;
 }
 
-/*! Find "next" object from oids minus key and return that.
- * @param[in]  h        Clixon handle
- * @param[in]  ylist    Yang of table (of list type)
- * @param[in]  oids     OID of ultimate scalar value
- * @param[in]  oidslen  OID length of scalar
- * @param[in]  reqinfo  Agent transaction request structure
- * @param[in]  request The netsnmp request info structure.
- * @retval     1        OK
- * @retval     0        Failed
- * @retval    -1        Error
- * XXX: merge with cache
+/*! Handle-stored row cache of SNMP tables, see CLICON_SNMP_TABLE_CACHE_TTL
+ */
+#define SNMP_TABLE_CACHE_NAME "snmp-table-cache"
+
+/* One column value of a table row, with its full OID */
+struct snmp_table_cell {
+    oid       *sc_oid;    /* Column OID + key OID */
+    size_t     sc_oidlen;
+    cxobj     *sc_xcol;   /* Leaf in stc_xt */
+    yang_stmt *sc_ycol;
+};
+
+/* Cells of one table sorted by OID */
+struct snmp_table_cache {
+    qelem_t                 stc_qelem; /* List header */
+    yang_stmt              *stc_ylist; /* Yang of table (list) */
+    cxobj                  *stc_xt;    /* Table as got from backend */
+    struct snmp_table_cell *stc_cells; /* Sorted by OID */
+    size_t                  stc_len;
+    struct timeval          stc_time;  /* When got from backend */
+    long                    stc_reqid; /* SNMP request-id of PDU that got it */
+};
+
+/*! Free one table cache entry
  */
 static int
-snmp_table_getnext(clicon_handle               h,
-                   yang_stmt                  *ylist,
-                   oid                        *oids,
-                   size_t                      oidslen,
-                   netsnmp_agent_request_info *reqinfo,
-                   netsnmp_request_info       *request)
+snmp_table_cache_free1(struct snmp_table_cache *stc)
+{
+    size_t i;
+
+    for (i=0; i<stc->stc_len; i++)
+        if (stc->stc_cells[i].sc_oid)
+            free(stc->stc_cells[i].sc_oid);
+    if (stc->stc_cells)
+        free(stc->stc_cells);
+    if (stc->stc_xt)
+        xml_free(stc->stc_xt);
+    free(stc);
+    return 0;
+}
+
+/*! Free row cache of all tables, eg after commit or on exit
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+snmp_table_cache_free(clicon_handle h)
+{
+    struct snmp_table_cache *head = NULL;
+    struct snmp_table_cache *stc;
+
+    if (clicon_ptr_get(h, SNMP_TABLE_CACHE_NAME, (void**)&head) < 0)
+        return 0;
+    while ((stc = head) != NULL){
+        DELQ(stc, head, struct snmp_table_cache *);
+        snmp_table_cache_free1(stc);
+    }
+    clicon_ptr_del(h, SNMP_TABLE_CACHE_NAME);
+    return 0;
+}
+
+/*! Qsort function of table cells in OID order
+ */
+static int
+snmp_table_cell_cmp(const void *arg1,
+                    const void *arg2)
+{
+    const struct snmp_table_cell *sc1 = arg1;
+    const struct snmp_table_cell *sc2 = arg2;
+
+    return oid_eq(sc1->sc_oid, sc1->sc_oidlen, sc2->sc_oid, sc2->sc_oidlen);
+}
+
+/*! Get table from backend and make its cells sorted by OID
+ *
+ * @param[in]  sh     Clixon snmp handle of registered table
+ * @param[in]  stc    Table cache entry, cells are (re)filled
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+snmp_table_cache_fill(clixon_snmp_handle      *sh,
+                      struct snmp_table_cache *stc)
 {
     int        retval = -1;
+    clicon_handle h = sh->sh_h;
+    yang_stmt *ylist = sh->sh_ys;
     cvec      *nsc = NULL;
     char      *xpath = NULL;
     cxobj     *xt = NULL;
@@ -1185,16 +1431,15 @@ snmp_table_getnext(clicon_handle               h,
     cvec      *cvk_name;
     oid        oidc[MAX_OID_LEN] = {0,}; /* Table / list oid */
     size_t     oidclen = MAX_OID_LEN;
+    clixon_snmp_column *scol;
+    int        i;
     oid        oidk[MAX_OID_LEN] = {0,}; /* Key oid */
     size_t     oidklen = MAX_OID_LEN;
-    oid        oidnext[MAX_OID_LEN] = {0x7fffffff,}; /* Next oid: start with high value */
-    size_t     oidnextlen = MAX_OID_LEN;
-    int        found = 0; 
-    cxobj     *xnext = NULL;
-    yang_stmt *ynext = NULL;
-    cbuf      *cb = NULL;
-
-    clicon_debug(1, "%s", __FUNCTION__);
+    struct snmp_table_cell *cells = NULL;
+    size_t     len = 0;
+    size_t     max = 0;
+    struct snmp_table_cell *sc;
+    
     if ((ys = yang_parent_get(ylist)) == NULL ||
         yang_keyword_get(ys) != Y_CONTAINER){
         clicon_err(OE_YANG, EINVAL, "ylist parent is not list");
@@ -1219,7 +1464,7 @@ snmp_table_getnext(clicon_handle               h,
         xrow = NULL;
         while ((xrow = xml_child_each(xtable, xrow, CX_ELMNT)) != NULL) {
             /* Get key part of OID from XML list entry */
-            if ((ret = snmp_xmlkey2val_oid(xrow, cvk_name, NULL, /*&cvk_oid,*/ oidk, &oidklen)) < 0)
+            if ((ret = snmp_xmlkey2val_oid(xrow, cvk_name, NULL, oidk, &oidklen)) < 0)
                 goto done;
             if (ret == 0)
                 continue; /* skip row, not all indexes */
@@ -1229,45 +1474,196 @@ snmp_table_getnext(clicon_handle               h,
                     continue;
                 if (yang_keyword_get(ycol) != Y_LEAF)
                     continue;
-                if ((ret = yangext_oid_get(ycol, oidc, &oidclen, NULL)) < 0)
-                    goto done;
-                if (ret == 0)
+                /* Column OID from registration */
+                for (i=0; i<sh->sh_ncols; i++)
+                    if (sh->sh_cols[i].scol_ys == ycol)
+                        break;
+                if (i == sh->sh_ncols)
                     continue;
+                scol = &sh->sh_cols[i];
+                memcpy(oidc, scol->scol_oid, scol->scol_oidlen*sizeof(*oidc));
+                oidclen = scol->scol_oidlen;
                 /* Append key oid */
                 if (oid_append(oidc, &oidclen, oidk, oidklen) < 0)
                     goto done;
-                /* Get smallest larger */
-                if (oid_eq(oidc, oidclen, oids, oidslen) > 0 &&
-                    oid_eq(oidc, oidclen, oidnext, oidnextlen) < 0){
-                    memcpy(oidnext, oidc, oidclen*sizeof(*oidnext));
-                    oidnextlen = oidclen;
-                    xnext = xcol;
-                    ynext = ycol;
-                    found++;
+                if (len == max){
+                    max = max ? 2*max : 64;
+                    if ((sc = realloc(cells, max*sizeof(*cells))) == NULL){
+                        clicon_err(OE_UNIX, errno, "realloc");
+                        goto done;
+                    }
+                    cells = sc;
+                }
+                sc = &cells[len];
+                if ((sc->sc_oid = malloc(oidclen*sizeof(*oidc))) == NULL){
+                    clicon_err(OE_UNIX, errno, "malloc");
+                    goto done;
                 }
+                memcpy(sc->sc_oid, oidc, oidclen*sizeof(*oidc));
+                sc->sc_oidlen = oidclen;
+                sc->sc_xcol = xcol;
+                sc->sc_ycol = ycol;
+                len++;
             } /* while xcol */
         } /* while xrow */
     }
-    if (found){
-        if (snmp_scalar_return(xnext, ynext, oidnext, oidnextlen, reqinfo, request) < 0)
+    if (len)
+        qsort(cells, len, sizeof(*cells), snmp_table_cell_cmp);
+    /* Replace old cells */
+    while (stc->stc_len)
+        free(stc->stc_cells[--stc->stc_len].sc_oid);
+    if (stc->stc_cells)
+        free(stc->stc_cells);
+    if (stc->stc_xt)
+        xml_free(stc->stc_xt);
+    stc->stc_cells = cells;
+    cells = NULL;
+    stc->stc_len = len;
+    stc->stc_xt = xt;
+    xt = NULL;
+    clicon_debug(1, "%s %s %zu cells", __FUNCTION__, yang_argument_get(ylist), len);
+    retval = 0;
+ done:
+    if (cells){
+        while (len)
+            free(cells[--len].sc_oid);
+        free(cells);
+    }
+    if (xpath)
+        free(xpath);
+    if (xt)
+        xml_free(xt);
+    if (nsc)
+        xml_nsctx_free(nsc);    
+    return retval;
+}
+
+/*! Get row cache of a table, get table from backend if not cached or too old
+ *
+ * The cache is valid within the same SNMP request, eg all repetitions of a GETBULK,
+ * or for CLICON_SNMP_TABLE_CACHE_TTL milliseconds
+ * @param[in]  sh     Clixon snmp handle of registered table
+ * @param[in]  reqinfo  Agent transaction request structure
+ * @param[out] stcp   Table cache entry
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+snmp_table_cache_get(clixon_snmp_handle         *sh,
+                     netsnmp_agent_request_info *reqinfo,
+                     struct snmp_table_cache   **stcp)
+{
+    int                      retval = -1;
+    clicon_handle            h = sh->sh_h;
+    yang_stmt               *ylist = sh->sh_ys;
+    struct snmp_table_cache *head = NULL;
+    struct snmp_table_cache *stc;
+    struct timeval           now;
+    struct timeval           td;
+    long                     reqid = -1;
+    uint32_t                 ttl;
+
+    if (reqinfo->asp && reqinfo->asp->pdu)
+        reqid = reqinfo->asp->pdu->reqid;
+    gettimeofday(&now, NULL);
+    clicon_ptr_get(h, SNMP_TABLE_CACHE_NAME, (void**)&head);
+    if ((stc = head) != NULL){
+        do {
+            if (stc->stc_ylist == ylist)
+                break;
+            stc = NEXTQ(struct snmp_table_cache *, stc);
+        } while (stc && stc != head);
+        if (stc == head && stc->stc_ylist != ylist)
+            stc = NULL;
+    }
+    if (stc != NULL){
+        ttl = clicon_option_int(h, "CLICON_SNMP_TABLE_CACHE_TTL");
+        timersub(&now, &stc->stc_time, &td);
+        if ((reqid != -1 && stc->stc_reqid == reqid) ||
+            td.tv_sec*1000 + td.tv_usec/1000 < ttl)
+            goto ok;
+    }
+    else {
+        if ((stc = malloc(sizeof(*stc))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(stc, 0, sizeof(*stc));
+        stc->stc_ylist = ylist;
+        ADDQ(stc, head);
+        if (clicon_ptr_set(h, SNMP_TABLE_CACHE_NAME, head) < 0)
+            goto done;
+    }
+    if (snmp_table_cache_fill(sh, stc) < 0)
+        goto done;
+    stc->stc_time = now;
+    stc->stc_reqid = reqid;
+ ok:
+    *stcp = stc;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Find "next" object from oids minus key and return that.
+ *
+ * Successor lookup in the sorted row cache of the table
+ * @param[in]  sh       Clixon snmp handle of registered table
+ * @param[in]  oids     OID of ultimate scalar value
+ * @param[in]  oidslen  OID length of scalar
+ * @param[in]  reqinfo  Agent transaction request structure
+ * @param[in]  request The netsnmp request info structure.
+ * @retval     1        OK
+ * @retval     0        Failed
+ * @retval    -1        Error
+ * @see snmp_table_cache_get
+ */
+static int
+snmp_table_getnext(clixon_snmp_handle         *sh,
+                   oid                        *oids,
+                   size_t                      oidslen,
+                   netsnmp_agent_request_info *reqinfo,
+                   netsnmp_request_info       *request)
+{
+    int                      retval = -1;
+    struct snmp_table_cache *stc = NULL;
+    struct snmp_table_cell  *sc;
+    size_t                   low;
+    size_t                   upper;
+    size_t                   mid;
+    int                      found = 0; 
+    cbuf                    *cb = NULL;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (snmp_table_cache_get(sh, reqinfo, &stc) < 0)
+        goto done;
+    /* Binary search for first cell larger than oids */
+    low = 0;
+    upper = stc->stc_len;
+    while (low < upper){
+        mid = (low + upper) / 2;
+        sc = &stc->stc_cells[mid];
+        if (oid_eq(sc->sc_oid, sc->sc_oidlen, oids, oidslen) > 0)
+            upper = mid;
+        else
+            low = mid + 1;
+    }
+    if (low < stc->stc_len){
+        sc = &stc->stc_cells[low];
+        if (snmp_scalar_return(sc->sc_xcol, sc->sc_ycol, sc->sc_oid, sc->sc_oidlen, reqinfo, request) < 0)
             goto done;
         if ((cb = cbuf_new()) == NULL){
             clicon_err(OE_UNIX, errno, "cbuf_new");
             goto done;
         }
-        oid_cbuf(cb, oidnext, oidnextlen);
+        oid_cbuf(cb, sc->sc_oid, sc->sc_oidlen);
         clicon_debug(1, "%s next: %s", __FUNCTION__, cbuf_get(cb));
+        found++;
     }
     retval = found;
  done:
     if (cb)
         cbuf_free(cb);
-    if (xpath)
-        free(xpath);
-    if (xt)
-        xml_free(xt);
-    if (nsc)
-        xml_nsctx_free(nsc);    
     return retval;
 }
 
@@ -1305,9 +1701,7 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
     case MODE_GET: // 160
         /* Create xpath from YANG table OID + 1 + n + cvk/key = requestvb->name 
          */
-        if ((ret = snmp_table_get(sh->sh_h, sh->sh_ys,
-                                  sh->sh_oid2, sh->sh_oid2len, 
-                                  requestvb->name, requestvb->name_length,
+        if ((ret = snmp_table_get(sh, requestvb->name, requestvb->name_length,
                                   reqinfo, request)) < 0)
             goto done;
         if (ret == 0){
@@ -1320,8 +1714,7 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
         break;
     case MODE_GETNEXT: // 161
         /* Register table sub-oid:s of existing entries in clixon */
-        if ((ret = snmp_table_getnext(sh->sh_h, sh->sh_ys,
-                                      requestvb->name, requestvb->name_length,
+        if ((ret = snmp_table_getnext(sh, requestvb->name, requestvb->name_length,
                                       reqinfo, request)) < 0)
             goto done;
         if (ret == 0){
@@ -1341,10 +1734,10 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
         // Check types: compare type in requestvb to yang type (or do later)
         break;
     case MODE_SET_RESERVE2: // 1
-        break;
-    case MODE_SET_ACTION:   // 2
-        if ((ret = snmp_table_set(sh->sh_h, sh->sh_ys,
-                                  requestvb->name, requestvb->name_length,
+        /* Collect edits of all varbinds of the PDU, errors are set per varbind */
+        if (snmp_set_batch_start(sh->sh_h, reqinfo) < 0)
+            goto done;
+        if ((ret = snmp_table_set(sh, requestvb->name, requestvb->name_length,
                                   reqinfo, request, &err)) < 0)
             goto done;
         if (ret == 0){
@@ -1354,31 +1747,24 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
             }
             clicon_debug(1, "%s Nosuchinstance", __FUNCTION__);
         }
-        /*
-         * There does not seem to be a separate validation action and commit does not 
-         * return an error.
-         * Therefore validation is done here directly as well as discard if it fails.
-         */
-        if ((ret = clicon_rpc_validate(sh->sh_h, "candidate")) < 0)
+        break;
+    case MODE_SET_ACTION:   // 2
+        if ((ret = snmp_set_batch_send(sh->sh_h, request)) < 0)
             goto done;
-        if (ret == 0){
-            clicon_rpc_discard_changes(sh->sh_h);
-            netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+        if (ret == 0)
             goto done;
-        }
         break;
     case MODE_SET_COMMIT:   // 3
-        if ((ret = clicon_rpc_commit(sh->sh_h, 0, 0, 0, NULL, NULL)) < 0)
+        if ((ret = snmp_set_batch_commit(sh->sh_h, request)) < 0)
             goto done;
-        if (ret == 0){
-            clicon_rpc_discard_changes(sh->sh_h);
-            netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+        if (ret == 0)
             goto done;
-        }
         break;
     case MODE_SET_FREE:     // 4
+        snmp_set_batch_free(sh->sh_h);
         break;
     case MODE_SET_UNDO  :   // 5
+        snmp_set_batch_free(sh->sh_h);
         if (clicon_rpc_discard_changes(sh->sh_h) < 0)
             goto done;  
         break;
@@ -52,6 +52,8 @@ int clixon_snmp_scalar_handler(netsnmp_mib_handler          *handler,
                                netsnmp_handler_registration *nhreg,
                                netsnmp_agent_request_info   *reqinfo,
                                netsnmp_request_info         *requests);
+int snmp_table_cache_free(clicon_handle h);
+int snmp_set_batch_free(clicon_handle h);
 
 #endif /* _SNMP_HANDLER_H_ */
 
@@ -549,6 +549,10 @@ snmp_handle_free(void *arg)
     if (sh != NULL){
         if (sh->sh_cvk_orig)
             cvec_free(sh->sh_cvk_orig);
+        if (sh->sh_cols)
+            free(sh->sh_cols);
+        if (sh->sh_keys)
+            free(sh->sh_keys);
         if (sh->sh_table_info){
             if (sh->sh_table_info->indexes){
                 snmp_free_varbind(sh->sh_table_info->indexes);
@@ -62,6 +62,16 @@ extern "C" {
 /*
  * Types 
  */
+/* Column of a table with its OID, precomputed at registration
+ * @see mibyang_table_register
+ */
+struct clixon_snmp_column {
+    yang_stmt    *scol_ys;              /* Leaf of column */
+    oid           scol_oid[MAX_OID_LEN]; /* OID of column leaf */
+    size_t        scol_oidlen;
+};
+typedef struct clixon_snmp_column clixon_snmp_column;
+
 /* Userdata to pass around in netsmp callbacks
  */
 struct clixon_snmp_handle {
@@ -73,6 +83,10 @@ struct clixon_snmp_handle {
     size_t        sh_oid2len;           
     char         *sh_default;          /* MIB default value leaf only */
     cvec         *sh_cvk_orig;         /* Index/Key variable values (original) */
+    clixon_snmp_column *sh_cols;       /* Table only: columns with OID in yang order */
+    int           sh_ncols;            /* Length of sh_cols */
+    yang_stmt   **sh_keys;             /* Table only: key leafs in key order */
+    int           sh_nkeys;            /* Length of sh_keys */
     netsnmp_table_registration_info *sh_table_info; /* To mimic table-handler in libnetsnmp code 
                                                      * save only to free properly */
 };
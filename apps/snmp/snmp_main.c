@@ -68,6 +68,7 @@
 
 #include "snmp_lib.h"
 #include "snmp_register.h"
+#include "snmp_handler.h"
 
 /* Command line options to be passed to getopt(3) */
 #define SNMP_OPTS "hD:f:l:C:o:z"
@@ -117,6 +118,8 @@ snmp_terminate(clicon_handle h)
         xml_free(x);
         x = NULL;
     }
+    snmp_table_cache_free(h);
+    snmp_set_batch_free(h);
     clicon_rpc_close_session(h);
     if ((yspec = clicon_dbspec_yang(h)) != NULL)
         ys_free(yspec);
@@ -127,8 +130,13 @@ snmp_terminate(clicon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xpath_cache_exit();
+    api_path_cache_exit();
+    xml_nsid_exit();
+    nacm_ruleset_free(h);
     clixon_event_exit();
     clicon_handle_exit(h);
+    clixon_pool_exit();
     clixon_err_exit();
     clicon_log_exit();
     if (pidfile)
@@ -475,6 +483,8 @@ main(int    argc,
 
     if ((sz = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clicon_log_string_limit_set(sz);
+    if ((sz = clicon_option_int(h, "CLICON_LOG_RATE_LIMIT")) != 0)
+        clicon_log_rate_limit_set(sz);
 
     /* Set default namespace according to CLICON_NAMESPACE_NETCONF_DEFAULT */
     xml_nsctx_namespace_netconf_default(h);
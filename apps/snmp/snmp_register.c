@@ -236,6 +236,7 @@ mibyang_table_register(clicon_handle h,
     int                              asn1type;
     yang_stmt                       *ys;
     char                            *name;
+    clixon_snmp_column              *scol;
     
     if ((ys = yang_parent_get(ylist)) == NULL ||
         yang_keyword_get(ys) != Y_CONTAINER){
@@ -289,6 +290,10 @@ mibyang_table_register(clicon_handle h,
         clicon_err(OE_YANG, 0, "No keys");
         goto done;
     }
+    if ((sh->sh_keys = calloc(cvec_len(cvk), sizeof(*sh->sh_keys))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
     cvi = NULL;
     /* Iterate over individual keys  */
     while ((cvi = cvec_each(cvk, cvi)) != NULL) {
@@ -298,6 +303,7 @@ mibyang_table_register(clicon_handle h,
                        yang_argument_get(ylist), keyname);
             goto done;
         }
+        sh->sh_keys[sh->sh_nkeys++] = yleaf;
         if (type_yang2asn1(yleaf, &asn1type, 0) < 0)
             //      goto done;
             goto ok; // XXX skip
@@ -313,7 +319,8 @@ mibyang_table_register(clicon_handle h,
     }
     table_info->min_column = 1;
 
-    /* Count columns */
+    /* Count columns and save their OIDs, so that requests need not parse the
+     * OID extensions of the leafs */
     yleaf = NULL;
     table_info->max_column = 0;   
     while ((yleaf = yn_each(ylist, yleaf)) != NULL) {
@@ -322,6 +329,25 @@ mibyang_table_register(clicon_handle h,
 
         table_info->max_column++;    
     }
+    if (table_info->max_column &&
+        (sh->sh_cols = calloc(table_info->max_column, sizeof(*sh->sh_cols))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    yleaf = NULL;
+    while ((yleaf = yn_each(ylist, yleaf)) != NULL &&
+           sh->sh_ncols < table_info->max_column) {
+        if (yang_keyword_get(yleaf) != Y_LEAF)
+            continue;
+        scol = &sh->sh_cols[sh->sh_ncols];
+        scol->scol_oidlen = MAX_OID_LEN;
+        if ((ret = yangext_oid_get(yleaf, scol->scol_oid, &scol->scol_oidlen, NULL)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        scol->scol_ys = yleaf;
+        sh->sh_ncols++;
+    }
     if ((ret = netsnmp_register_table(nhreg, table_info)) != SNMPERR_SUCCESS){
         clicon_err(OE_SNMP, ret, "netsnmp_register_table");
         goto done;
@@ -70,7 +70,7 @@
 #include <clixon/clixon_backend.h> 
 
 /* Command line options to be passed to getopt(3) */
-#define BACKEND_EXAMPLE_OPTS "a:m:M:nrsS:x:iuUtV:"
+#define BACKEND_EXAMPLE_OPTS "a:m:M:nrsS:x:iuUtV:C:w:T:"
 
 /* Enabling this improves performance in tests, but there may trigger the "double XPath"
  * problem.
@@ -166,6 +166,24 @@ static int _general_upgrade = 0;
  */
 static int _transaction_log = 0;
 
+/*! Schema node whose changes are logged on commit, using the change iterator
+ *
+ * Start backend with -- -C <schema-nodeid>, eg -C /ex:x/ex:y
+ */
+static char *_change_nodeid = NULL;
+
+/*! Milliseconds each commit callback sleeps, to make tests with slow commits
+ *
+ * Start backend with -- -w <ms>
+ */
+static int _commit_wait = 0;
+
+/*! Subtree whose changes the transaction callbacks are called on, NULL-terminated
+ *
+ * Start backend with -- -T <schema-nodeid>, eg -T /ex:x
+ */
+static char *_trans_subtree[] = {NULL, NULL};
+
 /*! Variable to trigger validation/commit errors (synthetic errors) for tests
  *
  * XPath to trigger validation error, ie if the XPath matches, then validate fails
@@ -221,6 +239,53 @@ main_complete(clicon_handle    h,
     return 0;
 }
 
+/*! Log the changes of a schema node and below, using the change iterator
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  td      Transaction data
+ * @param[in]  nodeid  Absolute schema node id
+ */
+static int
+example_changes_log(clicon_handle    h,
+                    transaction_data td,
+                    char            *nodeid)
+{
+    int                          retval = -1;
+    yang_stmt                   *ys = NULL;
+    transaction_change_it        it;
+    enum transaction_change_kind kind;
+    cxobj                       *x0;
+    cxobj                       *x1;
+    cbuf                        *cb = NULL;
+    char                        *kstr[] = {"delete", "add", "change"};
+
+    if (yang_abs_schema_nodeid(clicon_dbspec_yang(h), nodeid, &ys) < 0)
+        goto done;
+    if (ys == NULL){
+        clicon_err(OE_YANG, ENOENT, "Schema node %s not found", nodeid);
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (transaction_change_it_init(td, &it, ys) < 0)
+        goto done;
+    while (transaction_change_it_next(&it, &kind, &x0, &x1) == 1){
+        cbuf_reset(cb);
+        if (x0 && clixon_xml2cbuf(cb, x0, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+        if (x1 && clixon_xml2cbuf(cb, x1, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+        clicon_log(LOG_NOTICE, "%s %s: %s", __FUNCTION__, kstr[kind], cbuf_get(cb));
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! This is called on commit. Identify modifications and adjust machine state
  */
 int
@@ -235,6 +300,11 @@ main_commit(clicon_handle    h,
 
     if (_transaction_log)
         transaction_log(h, td, LOG_NOTICE, __FUNCTION__);
+    if (_change_nodeid &&
+        example_changes_log(h, td, _change_nodeid) < 0)
+        return -1;
+    if (_commit_wait)
+        usleep(_commit_wait*1000);
     if (_validate_fail_xpath){
         if (_validate_fail_toggle==1 &&
             xpath_first(transaction_target(td), NULL, "%s", _validate_fail_xpath)){
@@ -450,6 +520,7 @@ example_action_reset(clicon_handle h,            /* Clicon handle */
          }
        }
  * This yang snippet is present in clixon-example.yang for example.
+ * State is built with the xml_build_* functions, bound to yang, instead of parsing XML text.
  * @see example_statefile  where state is read from file and also pagination
  */
 int 
@@ -461,19 +532,24 @@ example_statedata(clicon_handle   h,
     int        retval = -1;
     cxobj    **xvec = NULL;
     size_t     xlen = 0;
-    cbuf      *cb = NULL;
     int        i;
     cxobj     *xt = NULL;
-    char      *name;
+    cxobj     *xifs;
+    cxobj     *xi;
+    cxobj     *xs;
+    cxobj     *xe;
     cvec      *nsc1 = NULL;
     yang_stmt *yspec = NULL;
+    yang_stmt *ymod;
+    yang_stmt *yc;
+    int        opv[] = {42, 41, 43}; /* should not be ordered */
+    struct {
+        char    *name;
+        uint32_t count;
+    } evv[] = {{"interface-down", 90}, {"interface-up", 77}};
 
     if (!_state)
         goto ok;
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
     yspec = clicon_dbspec_yang(h);
     /* Example of statedata, in this case merging state data with 
      * state information. In this case adding dummy interface operation state
@@ -486,40 +562,49 @@ example_statedata(clicon_handle   h,
     if (xpath_vec(xt, nsc1, "/interfaces/interface/name", &xvec, &xlen) < 0)
         goto done;
     if (xlen){
-        cprintf(cb, "<interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">");
+        if ((xifs = xml_build_path(yspec, xstate, "/if:interfaces")) == NULL)
+            goto done;
+        if (xml_childvec_reserve(xifs, xlen) < 0)
+            goto done;
         for (i=0; i<xlen; i++){
-            name = xml_body(xvec[i]);
-            cprintf(cb, "<interface xmlns:ex=\"urn:example:clixon\"><name>%s</name><type>ex:eth</type><oper-status>up</oper-status>", name);
-            cprintf(cb, "<ex:my-status><ex:int>42</ex:int><ex:str>foo</ex:str></ex:my-status>");
-            cprintf(cb, "</interface>");
+            if ((xi = xml_build_child(xifs, "interface")) == NULL)
+                goto done;
+            /* Prefix of identity and of augmented nodes */
+            if (xmlns_set(xi, "ex", "urn:example:clixon") < 0)
+                goto done;
+            if (xml_build_str(xi, "name", xml_body(xvec[i])) == NULL ||
+                xml_build_str(xi, "type", "ex:eth") == NULL ||
+                xml_build_str(xi, "oper-status", "up") == NULL)
+                goto done;
+            if ((xs = xml_build_child(xi, "my-status")) == NULL ||
+                xml_build_int(xs, "int", 42) == NULL ||
+                xml_build_str(xs, "str", "foo") == NULL)
+                goto done;
         }
-        cprintf(cb, "</interfaces>");
-        if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xstate, NULL) < 0)
-            goto done;
     }
     /* State in test_yang.sh , test_restconf.sh and test_order.sh */
-    if (yang_find_module_by_namespace(yspec, "urn:example:clixon") != NULL){
-        if (clixon_xml_parse_string("<state xmlns=\"urn:example:clixon\">"
-                                    "<op>42</op>"
-                                    "<op>41</op>"
-                                    "<op>43</op>" /* should not be ordered */
-                                    "</state>",
-                                    YB_NONE,
-                                    NULL, &xstate, NULL) < 0)
-            goto done; /* For the case when urn:example:clixon is not loaded */
+    if ((ymod = yang_find_module_by_namespace(yspec, "urn:example:clixon")) != NULL &&
+        (yc = yang_find(ymod, Y_CONTAINER, "state")) != NULL){
+        if ((xs = xml_build_top(xstate, yc)) == NULL)
+            goto done;
+        for (i=0; i<sizeof(opv)/sizeof(opv[0]); i++)
+            if (xml_build_int(xs, "op", opv[i]) == NULL)
+                goto done;
     }
     /* Event state from RFC8040 Appendix B.3.1 
      * Note: (1) order is by-system so is different, 
      *       (2) event-count is XOR on name, so is not 42 and 4
      */
-    if (yang_find_module_by_namespace(yspec, "urn:example:events") != NULL){
-        cbuf_reset(cb);
-        cprintf(cb, "<events xmlns=\"urn:example:events\">");
-        cprintf(cb, "<event><name>interface-down</name><event-count>90</event-count></event>");
-        cprintf(cb, "<event><name>interface-up</name><event-count>77</event-count></event>");
-        cprintf(cb, "</events>");
-        if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xstate, NULL) < 0)
+    if ((ymod = yang_find_module_by_namespace(yspec, "urn:example:events")) != NULL &&
+        (yc = yang_find(ymod, Y_CONTAINER, "events")) != NULL){
+        if ((xs = xml_build_top(xstate, yc)) == NULL)
             goto done;
+        for (i=0; i<sizeof(evv)/sizeof(evv[0]); i++){
+            if ((xe = xml_build_child(xs, "event")) == NULL ||
+                xml_build_str(xe, "name", evv[i].name) == NULL ||
+                xml_build_uint(xe, "event-count", evv[i].count) == NULL)
+                goto done;
+        }
     }
  ok:
     retval = 0;
@@ -528,8 +613,6 @@ example_statedata(clicon_handle   h,
         xml_nsctx_free(nsc1);
     if (xt)
         xml_free(xt);
-    if (cb)
-        cbuf_free(cb);
     if (xvec)
         free(xvec);
     return retval;
@@ -1475,6 +1558,16 @@ clixon_plugin_init(clicon_handle h)
         case 'V': /* validate fail */
             _validate_fail_xpath = optarg;
             break;
+        case 'C': /* log changes of schema node on commit */
+            _change_nodeid = optarg;
+            break;
+        case 'w': /* commit wait */
+            _commit_wait = atoi(optarg);
+            break;
+        case 'T': /* transaction callbacks only on changes of subtree */
+            _trans_subtree[0] = optarg;
+            api.ca_trans_subtree = _trans_subtree;
+            break;
         }
     if ((_mount_yang && !_mount_namespace) || (!_mount_yang && _mount_namespace)){
         clicon_err(OE_PLUGIN, EINVAL, "Both -m and -M must be given for mounts");
@@ -61,12 +61,31 @@
 #undef IDENTITYREF_KLUDGE
 
 /*! Optimize special list key searches in XPATH finds
- * Identify xpaths that search for exactly a list key, eg: "y[k='3']" and then call
- * binary search. This only works if "y" has proper yang binding and is sorted by system
- * Dont optimize on "hierarchical" lists such as: a/y[k='3'], where a is another list.
+ * Identify xpaths that search for list keys, eg: "y[k='3']", "y[k2='4' and k1='3']" or 
+ * leaf-list values "ll[.='x']" and then call binary search. This only works if "y" has proper
+ * yang binding and is sorted by system
+ * Each step is optimized, also "hierarchical" lists such as: a[k='1']/y[k='3']
  */
 #define XPATH_LIST_OPTIMIZE
 
+/*! Cache parsed xpaths evaluated with xpath_vec_ctx, xpath_first, xpath_vec, etc
+ * The same xpaths are evaluated repeatedly, eg NACM paths, when/must conditions and leafrefs.
+ * Least recently used xpaths are evicted when the cache is larger than XPATH_CACHE_SIZE bytes.
+ * @see xpath_cache_stats
+ */
+#define XPATH_CACHE
+#define XPATH_CACHE_SIZE (1024*1024)
+
+/*! Cache resolved api-path templates translated to xpath by api_path2xpath
+ * RESTCONF clients use the same api-paths with different key values, eg /ex:a/b=42. The
+ * template without key values, eg /ex:a/b=, is resolved once against the yang spec, then
+ * only the keys are substituted.
+ * Least recently used templates are evicted when the cache is larger than API_PATH_CACHE_SIZE bytes.
+ * @see api_path_cache_stats
+ */
+#define API_PATH_CACHE
+#define API_PATH_CACHE_SIZE (256*1024)
+
 /*! Add explicit search indexes, so that binary search can be made for non-key list indexes
  * This also applies if there are multiple keys and you want to search on only the second for 
  * example.
@@ -75,6 +94,63 @@
  */
 #define XML_EXPLICIT_INDEX
 
+/*! Use hash indexes for exact key lookup in large YANG lists
+ * An index is created on demand for config lists whose keys are strings, or also integers
+ * with XML_KEY_ENCODE, the first time a list is searched under a parent with at least
+ * XML_KEY_INDEX_THRESHOLD children.
+ * Other searches use binary search.
+ * @see clixon_xml_index.c
+ */
+#define XML_KEY_INDEX
+#define XML_KEY_INDEX_THRESHOLD 256
+
+/*! Use order-statistic indexes for positions in large ordered-by user lists
+ * An index is created on demand, the first time a position is looked up, eg an insert
+ * "before", "after" or "last", in a list under a parent with at least
+ * XML_ORDER_INDEX_THRESHOLD children. Otherwise the child vector is searched linearly.
+ * @see clixon_xml_order.c
+ */
+#define XML_ORDER_INDEX
+#define XML_ORDER_INDEX_THRESHOLD 1024
+
+/*! Parse integer, boolean and decimal64 leaf values once when yang is bound
+ * The typed value is kept in the XML node and used by sorting, xpath comparisons and
+ * validation until the value changes. Costs a cligen variable per such leaf.
+ * @see xml_bind_value
+ */
+#define XML_BIND_VALUE
+
+/*! Use hash indexes for yang_find, yang_find_datanode and yang_find_schemanode
+ * An index is built after yang_parse_post for yang statements with at least
+ * YANG_INDEX_THRESHOLD children or data nodes (through choice/case). Other statements are
+ * searched linearly.
+ * @see clixon_yang_index.c
+ */
+#define YANG_INDEX
+#define YANG_INDEX_THRESHOLD 16
+
+/*! Number of new children above which they are inserted with one sort and merge
+ * Applies to edit-config (text_modify) and xml_merge, below the threshold each new child
+ * is inserted with xml_insert
+ * @see xml_insert_bulk
+ */
+#define XML_INSERT_BULK_THRESHOLD 64
+
+/*! Thresholds for parallel sorting of XML trees, if CLICON_XML_SORT_THREADS is larger than 1
+ * A child vector with at least XML_SORT_PARALLEL_THRESHOLD children is sorted in chunks by
+ * several threads and then merged.
+ * Subtrees are sorted in parallel once there are XML_SORT_PARALLEL_FANOUT subtrees per thread.
+ * @see xml_sort_recurse_parallel
+ */
+#define XML_SORT_PARALLEL_THRESHOLD 8192
+#define XML_SORT_PARALLEL_FANOUT 4
+
+/*! Compression level of datastore files, if CLICON_XMLDB_COMPRESS is zstd
+ * Lower is faster, higher compresses better. zstd levels are 1-19, its default is 3
+ * @see clixon_datastore_compress.c
+ */
+#define XMLDB_COMPRESS_LEVEL 3
+
 /*! Let state data be ordered-by system
  * RFC 7950 is cryptic about this
  * It says in 7.7.7:
@@ -99,6 +175,16 @@
  */
 #define HTTP_DATA_INTERNAL_REDIRECT "index.html"
 
+/*! Cache contents of http-data files in memory
+ * A cached file is validated by lstat() on each request and read again if its modification
+ * time, change time, size or inode has changed.
+ * Least recently used files are evicted when the cache is larger than HTTP_DATA_CACHE_SIZE
+ * bytes. A file larger than the cache is read on each request.
+ * @see http_data_cache_stats
+ */
+#define HTTP_DATA_CACHE
+#define HTTP_DATA_CACHE_SIZE (16*1024*1024)
+
 /*! Set a temporary parent for use in special case "when" xpath calls
  * Problem is when changing an existing (candidate) in-memory datastore that yang "when" conditionals
  * should be changed in clixon_datastore_write.c:text_modify().
@@ -190,3 +276,192 @@
  * Plan is to remove this (undef:d) in next release
  */
 #undef RESTCONF_INLINE
+
+/*! Use epoll in the event loop, if available
+ *
+ * If set and sys/epoll.h is found by configure, file descriptors registered with
+ * clixon_event_reg_fd are polled with epoll, otherwise with select, which limits them to
+ * FD_SETSIZE.
+ */
+#define EVENT_EPOLL
+
+/*! Max number of ready file descriptors dispatched per event loop iteration
+ *
+ * Remaining ready file descriptors are dispatched in the next iteration, after expired timers
+ */
+#define EVENT_POLL_MAX 64
+
+/*! Max number of bytes written from the output queue of a backend client per event loop iteration
+ *
+ * Clients with queued output are written round-robin, so that one client reading a large
+ * reply does not delay the others, see CLICON_BACKEND_OUTPUT_HWM
+ */
+#define BACKEND_OUTPUT_QUANTUM 65536
+
+/*! Min size in bytes of a restconf reply body to compress it
+ *
+ * Smaller bodies are sent uncompressed, since compression would gain little at the cost of
+ * a compressor each. Bodies produced in parts are always compressed.
+ * @see compression-level in clixon-restconf.yang
+ */
+#define RESTCONF_COMPRESS_MIN_SIZE 1024
+
+/*! Latency histograms and counters of native restconf requests
+ * Per method and status code, latency, time waiting for backend and body bytes. Also TLS
+ * handshake latency. Metrics of each worker are logged on SIGUSR1 and sent in Prometheus text
+ * format on GET /.well-known/clixon-metrics, which requires restconf authentication.
+ * @see restconf_metrics.c
+ */
+#define RESTCONF_METRICS
+
+/*! Max number of queued events of a published stream, see stream_publish
+ *
+ * If the publish server is slow or unreachable, the oldest event is dropped when the queue is
+ * full. Only if configured with --enable-publish
+ */
+#define PUBLISH_QUEUE_MAX 1024
+
+/*! Max number of events of a published stream sent in one POST, separated by newline
+ */
+#define PUBLISH_BATCH_MAX 64
+
+/*! Backoff of retried POST of published stream events, doubled for each failure
+ *
+ * Min in milliseconds, max in seconds. Max is also the connect timeout
+ */
+#define PUBLISH_BACKOFF_MIN 100
+#define PUBLISH_BACKOFF_MAX 30
+
+/*! Max number of cached expansions of datastore values in the CLI, see expand_dbvar
+ *
+ * Values are cached per datastore and xpath, and only re-read if the content version of the
+ * datastore has changed. The least recently used expansion is removed when the cache is full.
+ */
+#define CLI_EXPAND_CACHE_MAX 32
+
+/*! Compact datastore caches when the number of XML objects has dropped by this many
+ *
+ * Checked in the backend between RPCs, eg after a large delete has been committed. Child
+ * vectors and values are then shrunk to their used size, see xmldb_cache_compact.
+ * Compaction can also be requested with the clixon-lib compact RPC.
+ */
+#define XMLDB_COMPACT_NODES 100000
+
+/*! Min number of XML nodes of a tree validated in worker processes
+ *
+ * Smaller trees are validated in the calling process also if CLICON_VALIDATE_WORKERS is set,
+ * since the cost of forking workers is then larger than the gain.
+ */
+#define VALIDATE_WORKERS_NODES 10000
+
+/*! Number of levels of two trees split into tasks by xml_diff_threads
+ *
+ * Two levels split both top-level nodes and the entries of lists below top-level containers
+ */
+#define XML_DIFF_SPLIT_DEPTH 2
+
+/*! Min number of tasks for xml_diff_threads to use threads, fewer are diffed in the caller
+ */
+#define XML_DIFF_THREADS_TASKS 1024
+
+/*! Max length of a message handled by the commit reader, longer are left to the backend
+ * @see CLICON_BACKEND_COMMIT_READER
+ */
+#define COMMIT_READER_MSGLEN 65536
+
+/*! Number of messages in the log ring of asynchronous logging
+ *
+ * Messages logged when the ring is full are dropped and counted
+ * @see CLICON_LOG_ASYNC
+ */
+#define LOG_ASYNC_SLOTS 4096
+
+/*! Size of the table of call sites with rate limited logging
+ *
+ * Call sites hashed to the same entry share its rate limit state
+ * @see CLICON_LOG_RATE_LIMIT
+ */
+#define LOG_RATE_SITES 256
+
+/*! Seconds a stopped or restarted process has to exit after SIGTERM before it is sent SIGKILL
+ *
+ * @see clixon_process_sched
+ */
+#define PROC_STOP_TIMEOUT 5
+
+/*! Seconds a restconf callhome connect may be pending before it is counted as failed
+ *
+ * Covers both the TCP connect and waiting for the TLS client hello of the manager
+ * @see restconf_callhome_cb
+ */
+#define RESTCONF_CALLHOME_CONNECT_TIMEOUT 10
+
+/*! Max seconds between restconf callhome re-connect attempts
+ *
+ * The interval starts at one second and doubles for each failed attempt up to this value.
+ * It is randomly jittered so that many callhome sockets do not connect at the same time.
+ * 1 means no backoff, increase for many callhome sockets toward managers that may be down
+ * @see restconf_callhome_timer
+ */
+#define RESTCONF_CALLHOME_BACKOFF_MAX 1
+
+/*! Body and attribute values of at least this length are shared between copies
+ *
+ * Large values, such as base64 binary leafs, are stored as a refcounted immutable buffer
+ * when the node is copied, eg by xml_dup or in the datastore cache, instead of copying
+ * the value. The buffer is copied on write. Values are compared by hash in xml_diff.
+ * Undefine to always copy values
+ * @see xml_value_cmp
+ */
+#define XML_VALUE_SHARE 4096
+
+/*! Number of xpaths whose global defaults are cached, for each of config and state
+ *
+ * The part of the global defaults tree that matches the xpath and namespace context of a
+ * get with defaults is kept and copied into later replies with the same xpath.
+ * The oldest xpath is replaced when full
+ * @see xml_global_defaults
+ */
+#define XML_DEFAULTS_CACHE_SIZE 32
+
+/*! Skip subtrees whose yang cannot contain the name in descendant xpath queries, eg //name
+ *
+ * The names of all descendant data nodes of a yang node are kept in a bloom filter, computed
+ * on first use. Subtrees of unbound nodes, anydata and mount-points are always searched.
+ * Undefine to search all subtrees
+ * @see yang_bloom_descendant
+ */
+#define XPATH_SCHEMA_PRUNE
+
+/*! Number of free buffers, namespace contexts and tree slabs kept for reuse between requests
+ *
+ * Short-lived objects of requests in the backend, restconf and netconf are taken from and
+ * put back in pools of the main thread, and pools are trimmed to what was used at the end of
+ * each request. Undefine to allocate and free each time
+ * @see clixon_cbuf_get
+ */
+#define CLIXON_POOL_SIZE 64
+
+/*! Buffers larger than this are freed instead of kept in a pool, see CLIXON_POOL_SIZE
+ */
+#define CLIXON_POOL_TRIM 65536
+
+/*! Find children by name with binary search in yang order in wide XML nodes
+ *
+ * Sorted children of a bound XML node are ordered by the yang order of their specs, see
+ * struct xml. xml_find and xml_find_type look up the yang child by name and search its
+ * position if the node has at least this number of children, otherwise the children are
+ * scanned. Undefine to always scan
+ * @see xml_sorted
+ */
+#define XML_FIND_YANG_THRESHOLD 16
+
+/*! Encode the keys of list entries as order-preserving byte strings, cached in the entries
+ *
+ * String and integer keys of an entry are encoded once in key order, so that entries are
+ * compared with memcmp by key lookups from api-paths, xpath predicates and cursors, by the
+ * hash indexes of XML_KEY_INDEX and by binary search. Costs the encoded key per looked up
+ * entry. Undefine to compare key leafs at each comparison
+ * @see xml_key_encode
+ */
+#define XML_KEY_ENCODE
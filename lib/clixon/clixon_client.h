@@ -41,6 +41,12 @@
  */
 typedef void *clixon_handle;
 typedef void *clixon_client_handle;
+typedef void *clixon_client_result; /* Result set of a batch request */
+
+/* Completion callback of an asynchronous batch request
+ * cr is NULL if the reply is an error. cr is freed after the callback returns
+ */
+typedef int (clixon_client_cb)(clixon_client_handle ch, clixon_client_result cr, void *arg);
 
 /* Connection type as parameter to connect 
  */
@@ -83,6 +89,17 @@ int   clixon_client_get_uint8(clixon_client_handle ch, uint8_t *rval, const char
 int   clixon_client_get_uint16(clixon_client_handle ch, uint16_t *rval, const char *xnamespace, const char *xpath);
 int   clixon_client_get_uint32(clixon_client_handle ch, uint32_t *rval, const char *xnamespace, const char *xpath);
 int   clixon_client_get_uint64(clixon_client_handle ch, uint64_t *rval, const char *xnamespace, const char *xpath);
+int   clixon_client_get_batch(clixon_client_handle ch, const char *xnamespace, const char **xpaths, int n, clixon_client_result *crp);
+int   clixon_client_get_batch_async(clixon_client_handle ch, const char *xnamespace, const char **xpaths, int n, clixon_client_cb *fn, void *arg);
+int   clixon_client_async_dispatch(clixon_client_handle ch);
+int   clixon_client_async_pending(clixon_client_handle ch);
+int   clixon_client_cache_enable(clixon_client_handle ch);
+int   clixon_client_cache_disable(clixon_client_handle ch);
+
+/* Result set functions */
+int   clixon_client_result_len(clixon_client_result cr);
+char *clixon_client_result_str(clixon_client_result cr, int i);
+int   clixon_client_result_free(clixon_client_result cr);
     
 /* Access functions */
 int   clixon_client_socket_get(clixon_client_handle ch);
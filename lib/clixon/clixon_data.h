@@ -57,6 +57,13 @@ typedef struct {
     cxobj    *de_xml;      /* cache */
     int       de_modified; /* Dirty since loaded/copied/committed/etc XXX:nocache? */
     int       de_empty;    /* Empty on read from file, xmldb_readfile and xmldb_put sets it */
+    uint64_t  de_gen;      /* Generation, unique for all databases, new when entry is set */
+    uint64_t  de_base;     /* Generation of source when cache was last copied, see xmldb_delta */
+    uint64_t  de_version;  /* Content version, new when content changes, see xmldb_version_get */
+    struct timeval de_mtime;    /* Time of last content change */
+    uint64_t  de_atime;    /* Last cache access, sequence number, see xmldb_cache_touch */
+    size_t    de_size;     /* Size of cache in bytes, valid if de_sizegen is de_gen */
+    uint64_t  de_sizegen;  /* Generation when de_size was computed */
 } db_elmnt;
 
 /*
@@ -44,6 +44,8 @@
  */
 /* Internal functions */
 int xmldb_db2file(clicon_handle h, const char *db, char **filename);
+int xmldb_db2dir(clicon_handle h, const char *db, char **dir);
+int xmldb_copy_cache(clicon_handle h, const char *from, const char *to);
 
 /* API */
 int xmldb_connect(clicon_handle h);
@@ -53,6 +55,13 @@ int xmldb_get(clicon_handle h, const char *db, cvec *nsc, char *xpath, cxobj **x
 int xmldb_get0(clicon_handle h, const char *db, yang_bind yb,
                cvec *nsc, const char *xpath, int copy, withdefaults_type wdef,
                cxobj **xtop, modstate_diff_t *msd, cxobj **xerr); 
+int xmldb_get_page(clicon_handle h, const char *db, cvec *nsc, const char *xpath,
+                   cxobj *xcursor, uint32_t offset, uint32_t limit, withdefaults_type wdef,
+                   cxobj **xret, cxobj **xerr);
+int xmldb_get_depth(clicon_handle h, const char *db, cvec *nsc, const char *xpath,
+                    int32_t depth, withdefaults_type wdef, cxobj **xret, cxobj **xerr);
+int xmldb_get_cbuf(clicon_handle h, const char *db, cvec *nsc, const char *xpath,
+                   withdefaults_type wdef, cbuf *cb, cxobj **xerr);
 int xmldb_get0_clear(clicon_handle h, cxobj *x);
 int xmldb_get0_free(clicon_handle h, cxobj **xp);
 int xmldb_put(clicon_handle h, const char *db, enum operation_type op, cxobj *xt, char *username, cbuf *cbret); /* in clixon_datastore_write.[ch] */
@@ -70,12 +79,47 @@ int xmldb_create(clicon_handle h, const char *db);
 int xmldb_db_reset(clicon_handle h, const char *db);
 
 cxobj *xmldb_cache_get(clicon_handle h, const char *db);
+int xmldb_cache_touch(db_elmnt *de);
+int xmldb_cache_size(clicon_handle h, const char *db, size_t *size);
+int xmldb_cache_stats(clicon_handle h, size_t *size, uint64_t *evictions);
+int xmldb_cache_evict(clicon_handle h);
+int xmldb_cache_compact(clicon_handle h, size_t *szp);
 
 int xmldb_modified_get(clicon_handle h, const char *db);
 int xmldb_modified_set(clicon_handle h, const char *db, int value);
+int xmldb_delta_get(clicon_handle h, const char *db, const char *base);
+int xmldb_delta_set(clicon_handle h, const char *db, const char *base);
 int xmldb_empty_get(clicon_handle h, const char *db);
+int xmldb_version_bump(clicon_handle h, const char *db);
+int xmldb_version_get(clicon_handle h, const char *db, uint64_t *version, struct timeval *mtime);
 int xmldb_dump(clicon_handle h, FILE *f, cxobj *xt);
 int xmldb_print(clicon_handle h, FILE *f);
 int xmldb_rename(clicon_handle h, const char *db, const char *newdb, const char *suffix);
+/* in clixon_datastore_journal.[ch] */
+int xmldb_journal_record(clicon_handle h, cxobj **dvec, int dlen, cxobj **avec, int alen,
+                         cxobj **scvec, cxobj **tcvec, int clen, cxobj **xrec);
+int xmldb_journal_changes(clicon_handle h, cxobj **dvec, int dlen, cxobj **avec, int alen,
+                          cxobj **scvec, cxobj **tcvec, int clen, cxobj **xrec);
+int xmldb_journal_inverse(clicon_handle h, cxobj **dvec, int dlen, cxobj **avec, int alen,
+                          cxobj **scvec, cxobj **tcvec, int clen, cxobj **xrec);
+int xmldb_journal_revert(clicon_handle h, const char *db, cxobj **vec, int len, int file, cbuf *cbret);
+int xmldb_journal_commit(clicon_handle h, const char *from, const char *to, cxobj *xrec);
+/* in clixon_datastore_async.c */
+int xmldb_async_copy(clicon_handle h, const char *from, const char *to);
+int xmldb_async_barrier(clicon_handle h, const char *db);
+uint64_t xmldb_async_queued(clicon_handle h);
+int xmldb_async_fd(clicon_handle h);
+int xmldb_async_poll(clicon_handle h, uint64_t *durable);
+int xmldb_async_exit(clicon_handle h);
+int xmldb_compress_wrap(clicon_handle h, const char *mode, FILE **fp);
+/* in clixon_datastore_snapshot.c */
+int xmldb_snapshot_write(clicon_handle h, const char *db);
+int xmldb_snapshot_read(clicon_handle h, cxobj **xtp);
+int xmldb_snapshot_get(clicon_handle h, cvec *nsc, const char *xpath, withdefaults_type wdef, cxobj **xret);
+int xmldb_snapshot_exit(clicon_handle h);
+/* in clixon_datastore_prefetch.c */
+int xmldb_prefetch_start(clicon_handle h, const char *db);
+int xmldb_prefetch_take(clicon_handle h, const char *db, cxobj **xp);
+int xmldb_prefetch_exit(clicon_handle h);
 
 #endif /* _CLIXON_DATASTORE_H */
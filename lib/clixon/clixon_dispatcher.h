@@ -97,6 +97,14 @@ struct _dispatcher_entry {
      * End-user argument
      */
     void *arg;
+
+    /*
+     * hash index of children list by node name, open addressing
+     * size is a power of two, or 0 if no children
+     */
+    dispatcher_entry_t **child_tab;
+    size_t               child_tabsize;
+    size_t               child_nr;
 };
 
 /*
@@ -104,6 +112,7 @@ struct _dispatcher_entry {
  */
 int dispatcher_register_handler(dispatcher_entry_t **root, dispatcher_definition *x);
 int dispatcher_call_handlers(dispatcher_entry_t *root, void *handle, char *path, void *user_args);
+int dispatcher_call_subtree(dispatcher_entry_t *root, void *handle, char *path, void *user_args);
 int dispatcher_free(dispatcher_entry_t *root);
 int dispatcher_print(FILE *f, int level, dispatcher_entry_t *root);
 
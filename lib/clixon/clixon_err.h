@@ -106,6 +106,8 @@ extern char clicon_err_reason[ERR_STRLEN];
 /*
  * Prototypes
  */
+int   clicon_err_thread(int on);
+int   clicon_err_thread_owner(void);
 int   clicon_err_reset(void);
 int   clicon_err_fn(const char *fn, const int line, int category, int err, const char *format, ...) __attribute__ ((format (printf, 5, 6)));
 char *clicon_strerror(int err);
@@ -59,6 +59,10 @@ int clixon_event_reg_fd(int fd, int (*fn)(int, void*), void *arg, char *str);
 
 int clixon_event_unreg_fd(int s, int (*fn)(int, void*));
 
+int clixon_event_reg_fd_write(int fd, int (*fn)(int, void*), void *arg, char *str);
+
+int clixon_event_unreg_fd_write(int s, int (*fn)(int, void*));
+
 int clixon_event_reg_timeout(struct timeval t,  int (*fn)(int, void*), 
                              void *arg, char *str);
 
@@ -66,6 +70,20 @@ int clixon_event_unreg_timeout(int (*fn)(int, void*), void *arg);
 
 int clixon_event_poll(int fd);
 
+void clixon_event_wakeup(struct timespec *t);
+
+int clixon_event_yield_reg(int (*fn)(int, void*), int (*yfn)(int, void*));
+
+void clixon_event_yield_interval(uint64_t us);
+
+int clixon_event_yield_begin(void);
+
+void clixon_event_yield_end(void);
+
+int clixon_event_yield(void);
+
+void clixon_event_yield_stats(uint64_t *sectionsp, uint64_t *yieldsp, uint64_t *timep, uint64_t *maxgapp);
+
 int clixon_event_loop(clicon_handle h);
 
 int clixon_event_exit(void);
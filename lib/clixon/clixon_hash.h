@@ -38,8 +38,10 @@
 #ifndef _CLIXON_HASH_H_
 #define _CLIXON_HASH_H_
 
+/*! Hash entry
+ * A hash table is a clicon_hash_t * handle returned by clicon_hash_init
+ */
 struct clicon_hash {
-    qelem_t     h_qelem;
     char       *h_key;
     size_t      h_vlen;
     void       *h_val;
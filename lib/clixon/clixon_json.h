@@ -40,12 +40,23 @@
 #ifndef _CLIXON_JSON_H
 #define _CLIXON_JSON_H
 
+/*
+ * Types
+ */
+typedef struct clixon_json_stream clixon_json_stream;
+
 /*
  * Prototypes
  */
+int clixon_json_parse_scanner(int val);
 int json2xml_decode(cxobj *x, cxobj **xerr);
+int xml2json_encode_identityref(cxobj *xb, char *body, yang_stmt *yp, cbuf *cb);
 int clixon_json2cbuf(cbuf *cb, cxobj *x, int pretty, int skiptop, int autocliext);
 int xml2json_cbuf_vec(cbuf *cb, cxobj **vec, size_t veclen, int pretty, int skiptop);
+clixon_json_stream *clixon_json_stream_new(cxobj *xt, int pretty);
+clixon_json_stream *clixon_json_stream_new_vec(cxobj **vec, size_t veclen, int pretty);
+int clixon_json_stream_next(clixon_json_stream *js, cbuf *cb, size_t len);
+int clixon_json_stream_free(clixon_json_stream *js);
 int clixon_json2file(FILE *f, cxobj *x, int pretty, clicon_output_cb *fn, int skiptop, int autocliext);
 int json_print(FILE *f, cxobj *x);
 int xml2json_vec(FILE *f, cxobj **vec, size_t veclen, int pretty, clicon_output_cb *fn, int skiptop);
@@ -64,6 +64,10 @@ int clicon_log_opt(char c);
 int clicon_log_file(char *filename);
 int clicon_log_string_limit_set(size_t sz);
 size_t clicon_log_string_limit_get(void);
+int clicon_log_rate_limit_set(int rate);
+int clicon_log_rate_check(const char *fn, int line);
+uint64_t clicon_log_dropped(void);
+int clicon_log_async(int enable);
 int clicon_get_logflags(void);
 int clicon_log_str(int level, char *msg);
 int clicon_log(int level, const char *format, ...) __attribute__ ((format (printf, 2, 3)));
@@ -71,6 +75,9 @@ int clicon_debug(int dbglevel, const char *format, ...) __attribute__ ((format (
 int clicon_debug_init(int dbglevel, FILE *f);
 int clicon_debug_get(void);
 
+/* Debug level is checked before arguments are evaluated and formatted */
+#define clicon_debug(l, _fmt, args...) ((((l) & clicon_debug_get()) == 0) ? 0 : clicon_debug((l), _fmt , ##args))
+
 char *mon2name(int md);
 
 #endif  /* _CLIXON_LOG_H_ */
@@ -37,6 +37,12 @@
 #ifndef _CLIXON_NACM_H
 #define _CLIXON_NACM_H
 
+/*
+ * Constants
+ */
+/* NACM namespace for use with xml namespace contexts and xpath */
+#define NACM_NS "urn:ietf:params:xml:ns:yang:ietf-netconf-acm"
+
 /*
  * Types
  */
@@ -63,6 +69,8 @@ int nacm_datanode_write(clicon_handle h, cxobj *xr, cxobj *xt,
                         enum nacm_access access,
                         char *username, cxobj *xnacm, cbuf *cbret);
 int nacm_access_pre(clicon_handle h, char *peername, char *username, cxobj **xnacmp);
+int nacm_access_pre_tree(clicon_handle h, cxobj *xt, char *peername, char *username, cxobj **xnacmp);
+int nacm_ruleset_free(clicon_handle h);
 int verify_nacm_user(clicon_handle h, enum nacm_credentials_t cred, char *peername, char *nacmname, cbuf *cbret);
 
 #endif /* _CLIXON_NACM_H */
@@ -158,6 +158,9 @@ typedef enum withdefaults_type withdefaults_type;
  */
 char *withdefaults_int2str(int keyword);
 int withdefaults_str2int(char *str);
+cxobj *netconf_error_new(cxobj **xret, const char *type, const char *tag);
+int netconf_error_add(cxobj *xerr, const char *name, const char *body);
+int netconf_error_info_add(cxobj *xerr, const char *name, const char *ns, const char *body);
 int netconf_in_use(cbuf *cb, char *type, char *message);
 int netconf_invalid_value(cbuf *cb, char *type, char *message);
 int netconf_invalid_value_xml(cxobj **xret, char *type, char *message);
@@ -44,5 +44,6 @@
 int netconf_monitoring_state_get(clicon_handle h, yang_stmt *yspec, char *xpath, cvec *nsc, cxobj **xret, cxobj **xerr);
 int netconf_monitoring_statistics_init(clicon_handle h);
 int netconf_monitoring_counter_inc(clicon_handle h, char *name);
+int netconf_monitoring_schemas_free(void);
 
 #endif  /* _CLIXON_NETCONF_MONITORING_H_ */
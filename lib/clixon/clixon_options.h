@@ -93,12 +93,38 @@ enum datastore_cache{
     DATASTORE_CACHE_ZEROCOPY
 };
 
+/*! Running datastore write mode on commit, see clixon_datastore_async.c
+ * See config option type xmldb_async_mode in clixon-config.yang
+ */
+enum xmldb_async_mode{
+    XMLDB_ASYNC_SYNC,
+    XMLDB_ASYNC_REPLY_BEFORE,
+    XMLDB_ASYNC_REPLY_AFTER
+};
+
+/*! Datastore file compression, see clixon_datastore_compress.c
+ * See config option type xmldb_compress in clixon-config.yang
+ */
+enum xmldb_compress{
+    XMLDB_COMPRESS_NONE,
+    XMLDB_COMPRESS_ZSTD
+};
+
+/*! Handling of notifications to a client whose output queue is full
+ * See config option type output_policy in clixon-config.yang
+ */
+enum backend_output_policy{
+    BACKEND_OUTPUT_DROP,
+    BACKEND_OUTPUT_DISCONNECT
+};
+
 /*! yang clixon regexp engine
  * @see regexp_mode in clixon-config.yang
  */
 enum regexp_mode{
     REGEXP_POSIX,
-    REGEXP_LIBXML2
+    REGEXP_LIBXML2,
+    REGEXP_PCRE2
 };
 
 /*
@@ -202,6 +228,9 @@ enum priv_mode_t clicon_restconf_privileges_mode(clicon_handle h);
 enum nacm_credentials_t clicon_nacm_credentials(clicon_handle h);
 
 enum datastore_cache clicon_datastore_cache(clicon_handle h);
+enum xmldb_async_mode clicon_xmldb_async(clicon_handle h);
+enum xmldb_compress clicon_xmldb_compress(clicon_handle h);
+enum backend_output_policy clicon_backend_output_policy(clicon_handle h);
 enum regexp_mode clicon_yang_regexp(clicon_handle h);
 /*-- Specific option access functions for non-yang options --*/
 int clicon_quiet_mode(clicon_handle h);
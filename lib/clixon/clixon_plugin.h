@@ -222,6 +222,8 @@ typedef int (plgreset_t)(clicon_handle h, const char *db);
  *
  * @note The system will make an xpath check and filter out non-matching trees
  * @note The system does not validate the xml, unless CLICON_VALIDATE_STATE_XML is set
+ * @note If ca_statedata_trusted is set, the xml is not sorted or validated, only bound to yang
+ * @note If xtop is built with xml_build_path and other xml_build_* functions, it is not bound again
  * @see clixon_pagination_cb_register for special paginated state data callback
  */
 typedef int (plgstatedata_t)(clicon_handle h, cvec *nsc, char *xpath, cxobj *xtop);
@@ -232,6 +234,13 @@ typedef int (plgstatedata_t)(clicon_handle h, cvec *nsc, char *xpath, cxobj *xto
  */
 typedef void *pagination_data;
 
+/* Compiled state data filter type, given to subtree state providers
+ * @see statedata_filter_t for full structure
+ * @see clixon_statedata_subtree_register
+ * @see statedata_filter_key() and other accessor functions
+ */
+typedef void *statedata_filter;
+
 /*! Lock database status has changed status
  *
  * @param[in]  h    Clixon handle
@@ -329,6 +338,23 @@ enum startup_status{
 struct clixon_plugin_api;
 typedef struct clixon_plugin_api* (plginit2_t)(clicon_handle);    /* Clixon plugin Init */
 
+/* Parallel backend callbacks
+ * The commit callback of a plugin that sets ca_trans_parallel, and the start callback of a
+ * plugin that sets ca_start_parallel, may run in a thread concurrently with callbacks of other
+ * plugins, see CLICON_PLUGIN_COMMIT_THREADS and CLICON_PLUGIN_START_THREADS.
+ * Meanwhile clixon serializes string interning, including creating XML and yang nodes, and
+ * xpath parsing and evaluation (xpath_first, xpath_vec, etc). Errors and logs (clicon_err,
+ * clicon_log, clicon_debug) of other threads than the main thread are dropped: a failing
+ * callback returns -1 and clixon reports which plugin failed.
+ * Not allowed in a parallel callback:
+ * - Modifying the transaction trees, or other XML trees and yang specs shared with other plugins
+ * - Accessing shared XML trees other than with xpath functions and plain getters. Sort, search
+ *   and compare functions (xml_sort, xml_find*, xml_cmp, binary search) write cached values
+ * - Changing the handle, options or clicon_data, datastore access and backend RPCs
+ * - Sending notifications, timers, signals and the event loop (clixon_event_reg_*)
+ * Private XML trees and state of the plugin may be used freely, except for the above.
+ */
+
 struct clixon_plugin_api{
     /*--- Common fields.  ---*/
     char              ca_name[MAXPATHLEN]; /* Name of plugin (given by plugin) */
@@ -365,6 +391,14 @@ struct clixon_plugin_api{
             trans_cb_t       *cb_trans_end;      /* Transaction completed  */
             trans_cb_t       *cb_trans_abort;    /* Transaction aborted */
             datastore_upgrade_t *cb_datastore_upgrade; /* General-purpose datastore upgrade */
+            int               cb_trans_parallel; /* Commit callback may run in parallel, see above */
+            char            **cb_trans_after;    /* NULL-terminated names of plugins committed before */
+            uint32_t          cb_statedata_ttl;  /* Cache state data this many ms, 0: no cache */
+            int               cb_statedata_parallel; /* State callback may run in a worker process */
+            int               cb_statedata_trusted;  /* State is valid and sorted: bind only */
+            int               cb_start_parallel; /* Start callback may run in parallel, see above */
+            char            **cb_start_after;    /* NULL-terminated names of plugins started before */
+            char            **cb_trans_subtree;  /* NULL-terminated schema node paths of changes handled, NULL: all */
         } cau_backend;
     } u;
 };
@@ -387,6 +421,14 @@ struct clixon_plugin_api{
 #define ca_trans_end      u.cau_backend.cb_trans_end
 #define ca_trans_abort    u.cau_backend.cb_trans_abort
 #define ca_datastore_upgrade  u.cau_backend.cb_datastore_upgrade
+#define ca_trans_parallel u.cau_backend.cb_trans_parallel
+#define ca_trans_after    u.cau_backend.cb_trans_after
+#define ca_statedata_ttl  u.cau_backend.cb_statedata_ttl
+#define ca_statedata_parallel u.cau_backend.cb_statedata_parallel
+#define ca_statedata_trusted  u.cau_backend.cb_statedata_trusted
+#define ca_start_parallel u.cau_backend.cb_start_parallel
+#define ca_start_after    u.cau_backend.cb_start_after
+#define ca_trans_subtree  u.cau_backend.cb_trans_subtree
 
 /*
  * Macros
@@ -415,14 +457,42 @@ typedef struct plugin_context plugin_context_t;
  * 
  * When namespace and name match, the callback is made
  */
+/* Call statistics of a plugin or RPC callback, see clixon_plugin_stats_get
+ */
+typedef struct {
+    uint64_t      pcs_count;    /* Number of calls */
+    uint64_t      pcs_total;    /* Sum of durations in microseconds */
+    uint64_t      pcs_max;      /* Longest duration in microseconds */
+} clixon_call_stats;
+
 typedef struct {
     qelem_t       rc_qelem;     /* List header */
     clicon_rpc_cb rc_callback;  /* RPC Callback */
     void         *rc_arg;       /* Application specific argument to cb */
     char         *rc_namespace;/* Namespace to combine with name tag */
     char         *rc_name;      /* Xml/json tag/name */
+    clixon_call_stats rc_stats; /* Call statistics */
 } rpc_callback_t;
 
+/* Plugin API callbacks with call statistics, see clixon_plugin_call_stats
+ * Transaction callbacks are timed by the backend commit statistics
+ */
+enum clixon_plugin_call {
+    PC_START,
+    PC_EXIT,
+    PC_AUTH,
+    PC_EXTENSION,
+    PC_DATASTORE_UPGRADE,
+    PC_YANG_MOUNT,
+    PC_YANG_PATCH,
+    PC_RESET,
+    PC_PRE_DAEMON,
+    PC_DAEMON,
+    PC_STATEDATA,
+    PC_LOCKDB,
+    PC_NR
+};
+
 /*
  * Prototypes
  */
@@ -452,6 +522,17 @@ int clixon_pseudo_plugin(clicon_handle h, const char *name, clixon_plugin_t **cp
 
 int plugin_context_check(clicon_handle h, void **wh, const char *name, const char *fn);
 
+uint64_t clixon_plugin_call_start(void);
+void clixon_plugin_slow_log(clicon_handle h, const char *name, const char *callback, uint64_t us);
+void clixon_plugin_call_stats(clicon_handle h, clixon_plugin_t *cp, enum clixon_plugin_call call, uint64_t t0);
+int clixon_plugin_stats_get(clicon_handle h, cbuf *cb);
+void *clixon_plugin_malloc(size_t size);
+void *clixon_plugin_calloc(size_t nmemb, size_t size);
+void *clixon_plugin_realloc(void *ptr, size_t size);
+char *clixon_plugin_strdup(const char *str);
+void  clixon_plugin_free(void *ptr);
+void  clixon_plugin_mem_stats(uint64_t *nr, size_t *size);
+
 int clixon_plugin_start_one(clixon_plugin_t *cp, clicon_handle h);
 int clixon_plugin_start_all(clicon_handle h);
 
@@ -0,0 +1,86 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Static tracepoints (USDT) of provider "clixon"
+ * Enabled with configure --enable-usdt, otherwise the probes are compiled out and their
+ * arguments are never evaluated. An enabled probe is a single nop instruction when not traced.
+ * Example, latency histogram of backend messages per rpc name:
+ *   bpftrace -e 'usdt:/usr/local/sbin/clixon_backend:clixon:backend_msg_start { @s[tid] = nsecs; }
+ *     usdt:/usr/local/sbin/clixon_backend:clixon:backend_msg_done /@s[tid]/ {
+ *       @us[str(arg1)] = hist((nsecs - @s[tid])/1000); delete(@s[tid]); }'
+ * Probes:
+ *   backend_msg_start(session-id, length)       Backend receives internal message
+ *   backend_rpc(session-id, rpc)                Backend calls rpc of message
+ *   backend_msg_done(session-id, rpc, retval)   Backend has handled message
+ *   commit_phase(phase, us)                     End of validate or commit phase, see commit-stats
+ *   transaction_callback(plugin, callback, us)  End of plugin transaction callback
+ *   plugin_callback(plugin, callback, us)       End of plugin api or rpc callback
+ *   xmldb_get_start(db, xpath)                  Start of datastore read
+ *   xmldb_get_done(db, retval)                  End of datastore read
+ *   xmldb_put_start(db, op)                     Start of datastore write
+ *   xmldb_put_done(db, retval)                  End of datastore write
+ *   xml_parse_start(length)                     Start of XML string parse
+ *   xml_parse_done(retval)                      End of XML string parse
+ *   xml2cbuf_start(length)                      Start of XML serialize, length of buffer
+ *   xml2cbuf_done(length)                       End of XML serialize, length of buffer
+ *   netconf_frame(length)                       Netconf frame received
+ *   restconf_request_start(method, path)        Restconf request
+ *   restconf_request_done(method, path, retval) Restconf request handled
+ *   restconf_reply(code, length)                Restconf reply sent
+ * @note Include after clixon_config.h, the probes are compiled out if HAVE_SYS_SDT_H is not set
+ */
+
+#ifndef _CLIXON_PROBE_H_
+#define _CLIXON_PROBE_H_
+
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+
+#define CLIXON_PROBE0(name)          DTRACE_PROBE(clixon, name)
+#define CLIXON_PROBE1(name, a)       DTRACE_PROBE1(clixon, name, a)
+#define CLIXON_PROBE2(name, a, b)    DTRACE_PROBE2(clixon, name, a, b)
+#define CLIXON_PROBE3(name, a, b, c) DTRACE_PROBE3(clixon, name, a, b, c)
+
+#else  /* HAVE_SYS_SDT_H */
+
+/* Arguments are referenced to avoid unused warnings, but never evaluated */
+#define CLIXON_PROBE0(name)          do { } while (0)
+#define CLIXON_PROBE1(name, a)       do { if (0) { (void)(a); } } while (0)
+#define CLIXON_PROBE2(name, a, b)    do { if (0) { (void)(a); (void)(b); } } while (0)
+#define CLIXON_PROBE3(name, a, b, c) do { if (0) { (void)(a); (void)(b); (void)(c); } } while (0)
+
+#endif /* HAVE_SYS_SDT_H */
+
+#endif  /* _CLIXON_PROBE_H_ */
@@ -51,6 +51,9 @@ struct clicon_msg {
     char        op_body[0]; /* rest of message, actual data */
 };
 
+/* op_id of a reply fragment followed by more fragments, see send_msg_reply_part */
+#define CLICON_MSG_ID_MORE 0xffffffff
+
 /*
  * Prototypes
  */ 
@@ -58,6 +61,8 @@ char *format_int2str(enum format_enum showas);
 enum format_enum format_str2int(char *str);
 
 struct clicon_msg *clicon_msg_encode(uint32_t id, const char *format, ...) __attribute__ ((format (printf, 2, 3)));
+
+struct clicon_msg *clicon_msg_encode_buf(uint32_t id, char *data, uint32_t datalen);
 int clicon_msg_decode(struct clicon_msg *msg, yang_stmt *yspec, uint32_t *id, cxobj **xml, cxobj **xerr);
 
 int clicon_connect_unix(clicon_handle h, char *sockpath);
@@ -78,6 +83,8 @@ int clicon_rpc1(int sock, const char *descr, cbuf *msgin, cbuf *msgret, int *eof
 
 int clicon_msg_send(int s, const char *descr, struct clicon_msg *msg);
 
+int clicon_msg_send_buf(int s, const char *descr, uint32_t id, char *data, uint32_t datalen);
+
 int clicon_msg_send1(int s, const char *descr, cbuf *cb);
 
 int clicon_msg_rcv(int s, const char *descr, int intr, struct clicon_msg **msg, int *eof);
@@ -88,6 +95,8 @@ int send_msg_notify_xml(clicon_handle h, int s, const char *descr, cxobj *xev);
 
 int send_msg_reply(int s, const char *descr, char *data, uint32_t datalen);
 
+int send_msg_reply_part(int s, const char *descr, char *data, uint32_t datalen, int more);
+
 int detect_endtag(char *tag, char  ch, int  *state);
 
 int clixon_inet2sin(const char *addrtype, const char *addrstr, uint16_t port, struct sockaddr *sa, size_t *sa_len);
@@ -42,12 +42,34 @@
 #ifndef _CLIXON_PROTO_CLIENT_H_
 #define _CLIXON_PROTO_CLIENT_H_
 
+/*
+ * Types
+ */
+/*! Reply callback of an asynchronous request
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  xret  Reply, freed after the callback, or NULL if the backend closed the connection
+ * @param[in]  arg   Argument given in clicon_rpc_async_send
+ * @retval     0     OK
+ * @retval    -1     Error, terminates the event loop
+ */
+typedef int (clicon_rpc_cb_t)(clicon_handle h, cxobj *xret, void *arg);
+
+typedef struct clicon_rpc_async clicon_rpc_async_t; /* Asynchronous backend connection */
+
+/*
+ * Prototypes
+ */
+
 int clicon_rpc_connect(clicon_handle h, int *sock0);
 int clicon_rpc_msg(clicon_handle h, struct clicon_msg *msg, cxobj **xret0);
 int clicon_rpc_msg_persistent(clicon_handle h, struct clicon_msg *msg, cxobj **xret0, int *sock0);
+int clicon_rpc_stats(uint64_t *nr, uint64_t *usec);
 int clicon_rpc_netconf(clicon_handle h, char *xmlst, cxobj **xret, int *sp);
 int clicon_rpc_netconf_xml(clicon_handle h, cxobj *xml, cxobj **xret, int *sp);
 int clicon_rpc_get_config(clicon_handle h, char *username, char *db, char *xpath, cvec *nsc, char *defaults, cxobj **xret);
+int clicon_rpc_get_config_page(clicon_handle h, char *db, char *xpath, cvec *nsc, char *defaults,
+                               char *cursor, uint32_t limit, cxobj **xt);
 int clicon_rpc_edit_config(clicon_handle h, char *db, enum operation_type op, 
                            char *xml);
 int clicon_rpc_copy_config(clicon_handle h, char *db1, char *db2);
@@ -69,7 +91,15 @@ int clicon_rpc_discard_changes(clicon_handle h);
 int clicon_rpc_create_subscription(clicon_handle h, char *stream, char *filter, int *s);
 int clicon_rpc_debug(clicon_handle h, int level);
 int clicon_rpc_restconf_debug(clicon_handle h, int level);
+int clicon_rpc_datastore_version(clicon_handle h, const char *db, uint64_t *version, struct timeval *mtime);
+int clicon_rpc_datastore_values(clicon_handle h, const char *db, char *xpath, cvec *nsc, char *prefix,
+                                uint64_t *version, cvec **values, cxobj **xerr);
+int clicon_rpc_datastore_diff(clicon_handle h, const char *db1, const char *db2, cxobj **xt1, cxobj **xt2);
 int clicon_hello_req(clicon_handle h, char *transport, char *source_host, uint32_t *id);
 int clicon_rpc_restart_plugin(clicon_handle h, char *plugin);
+clicon_rpc_async_t *clicon_rpc_async_open(clicon_handle h);
+int clicon_rpc_async_send(clicon_rpc_async_t *ra, char *xmlstr, clicon_rpc_cb_t *fn, void *arg);
+int clicon_rpc_async_pending(clicon_rpc_async_t *ra);
+int clicon_rpc_async_close(clicon_rpc_async_t *ra);
 
 #endif  /* _CLIXON_PROTO_CLIENT_H_ */
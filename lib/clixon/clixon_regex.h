@@ -42,6 +42,8 @@
  * Prototypes
  */ 
 int regexp_xsd2posix(char *xsd, char **posix);
+int regexp_xsd2pcre2(char *xsd, char **pcre);
+int regex_pcre2_free(void *recomp);
 int regex_compile(clicon_handle h, char *regexp, void **recomp);
 int regex_exec(clicon_handle h, void *recomp, char *string);
 int regex_free(clicon_handle h, void *recomp);
@@ -41,6 +41,14 @@
 /*
  * Constants
  */
+/* Internal stream of datastore-changed notifications after commit, see CLICON_STREAM_DATASTORE */
+#define CLIXON_DATASTORE_STREAM "CLIXON-DATASTORE"
+
+/* Internal stream of journal records after commit for standby backends, see CLICON_STREAM_JOURNAL */
+#define CLIXON_JOURNAL_STREAM "CLIXON-JOURNAL"
+
+/* Internal stream of commit-job-done notifications of asynchronous commits, see CLICON_STREAM_COMMIT */
+#define CLIXON_COMMIT_STREAM "CLIXON-COMMIT"
 
 /*
  * Types
@@ -54,21 +62,33 @@
  */
 typedef int (*stream_fn_t)(clicon_handle h, int op, cxobj *event, void *arg);
 
+/* Subscription filter, shared by all subscriptions of a stream with the same xpath
+ * Parsed once at subscription and evaluated once per event
+ */
+struct stream_filter{
+    qelem_t                     sf_q;      /* queue header */
+    char                       *sf_xpath;  /* Filter selector as xpath */
+    struct xpath_tree          *sf_xptree; /* Parsed xpath */
+    int                         sf_refs;   /* Nr of subscriptions using filter */
+    int                         sf_match;  /* Set if current event matches filter */
+};
+
 struct stream_subscription{
     qelem_t                     ss_q;   /* queue header */
     char                       *ss_stream; /* Name of associated stream */
     char                       *ss_xpath;  /* Filter selector as xpath */
+    struct stream_filter       *ss_filter; /* Shared parsed filter, or NULL if no filter */
     struct timeval              ss_starttime; /* Replay starttime */
     struct timeval              ss_stoptime; /* Replay stoptime */
     stream_fn_t                 ss_fn;     /* Callback when event occurs */
     void                       *ss_arg;    /* Callback argument */
 };
 
-/* Replay time-series */
+/* Replay time-series, entry of ring ordered by time */
 struct stream_replay{
-    qelem_t        r_q;   /* queue header */
     struct timeval r_tv;  /* time index */
-    cxobj         *r_xml; /* event in xml form */
+    char          *r_str; /* event serialized as xml string */
+    size_t         r_len; /* length of r_str */
 };
 
 /* See RFC8040 9.3, stream list, no replay support for now
@@ -78,9 +98,15 @@ struct event_stream{
     char                *es_name; /* name of notification event stream */
     char                *es_description;
     struct stream_subscription *es_subscription;
+    struct stream_filter *es_filter; /* Distinct filters of subscriptions */
     int                  es_replay_enabled; /* set if replay is enables */
     struct timeval       es_retention; /* replay retention - how much to save */
-    struct stream_replay *es_replay;
+    size_t               es_retention_bytes; /* replay retention in bytes, 0 is unlimited */
+    struct stream_replay *es_replay; /* Ring of replay entries, oldest at es_replay_head */
+    size_t               es_replay_size;  /* Allocated entries in ring */
+    size_t               es_replay_head;  /* Index of oldest entry */
+    size_t               es_replay_nr;    /* Number of entries */
+    size_t               es_replay_bytes; /* Sum of serialized entries */
 
 };
 typedef struct event_stream event_stream_t;
@@ -92,6 +118,7 @@ event_stream_t *stream_find(clicon_handle h, const char *name);
 int stream_add(clicon_handle h, const char *name, const char *description, int replay_enabled, struct timeval *retention);
 int stream_delete_all(clicon_handle h, int force);
 int stream_get_xml(clicon_handle h, int access, cbuf *cb);
+int stream_build_xml(clicon_handle h, int access, cxobj *xp);
 int stream_timer_setup(int fd, void *arg);
 /* Subscriptions */
 struct stream_subscription *stream_ss_add(clicon_handle h, char *stream,
@@ -105,10 +132,12 @@ int stream_ss_delete(clicon_handle h, char *name, stream_fn_t fn, void *arg);
 
 int stream_notify_xml(clicon_handle h, char *stream, cxobj *xml);
 int stream_notify(clicon_handle h, char *stream, const char *event, ...)  __attribute__ ((format (printf, 3, 4)));
+int stream_notify_cbuf(cxobj *event, cbuf **cbp);
 
 /* Replay */
 int stream_replay_add(event_stream_t *es, struct timeval *tv, cxobj *xv);
 int stream_replay_trigger(clicon_handle h, char *stream, stream_fn_t fn, void *arg);
+void stream_replay_stats(event_stream_t *es, uint64_t *nr, size_t *size);
 
 /* Experimental publish streams using SSE. CLIXON_PUBLISH_STREAMS should be set */
 int stream_publish(clicon_handle h, char *stream);
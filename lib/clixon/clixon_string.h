@@ -107,6 +107,10 @@ char  *clixon_trim(char *str);
 char  *clixon_trim2(char *str, char *trims);
 int    clicon_strcmp(char *s1, char *s2);
 int    clixon_unicode2utf8(char *ucstr, char *utfstr, size_t utflen);
+int    clixon_string_intern_lock(int on);
+char  *clixon_string_intern(const char *str);
+int    clixon_string_unintern(char *str);
+int    clixon_string_intern_stats(uint64_t *nrp, size_t *szp);
 
 #ifndef HAVE_STRNDUP
 char *clicon_strndup (const char *, size_t);
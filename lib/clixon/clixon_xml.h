@@ -178,6 +178,20 @@ typedef int (xml_applyfn_t)(cxobj *x, void *arg);
 
 typedef struct clixon_xml_vec clixon_xvec; /* struct defined in clicon_xml_vec.c */
 
+/*! External iterator over the children of an XML node
+ *
+ * Allocated by the caller, typically on the stack. The iteration state is kept here and
+ * not in the tree, so iterations may be nested, interleaved or run concurrently on a
+ * read-only tree. Fields are internal.
+ * @see xml_child_it_init
+ */
+struct xml_child_it {
+    cxobj           *xi_parent; /* Node whose children are iterated */
+    int              xi_i;      /* Index of next child to examine */
+    enum cxobj_type  xi_type;   /* Child type, or CX_ERROR (-1) for any type */
+};
+typedef struct xml_child_it xml_child_it;
+
 /* Alternative tree formats,
  * @see format_int2str, format_str2int
  */
@@ -202,13 +216,22 @@ enum format_enum{
 #define XML_FLAG_DEFAULT   0x40 /* Added when a value is set as default @see xml_default */
 #define XML_FLAG_TOP       0x80 /* Top datastore symbol */
 #define XML_FLAG_BODYKEY  0x100 /* Text parsing key to be translated from body to key */
+#define XML_FLAG_DIRTY    0x200 /* Node or descendant edited since datastore was equal to its
+                                 * base, see CLICON_XMLDB_CANDIDATE_DELTA */
+#define XML_FLAG_WDTAG    0x400 /* Default node of with-defaults report-all-tagged, printed with
+                                 * a wd:default="true" attribute, see xml_add_default_tag */
+#define XML_FLAG_SORTED   0x800 /* Children are known to be sorted, see xml_sorted */
 
 /*
  * Prototypes
  */
 char     *xml_type2str(enum cxobj_type type);
 int       xml_stats_global(uint64_t *nr);
+int       xml_stats_arena_global(uint64_t *nrp, uint64_t *slabnrp, size_t *szp);
+int       xml_stats_arena(cxobj *x, uint64_t *nodesp, uint64_t *slabnrp, size_t *szp, size_t *usedp);
+int       xml_stats_nodesize(size_t *elmntp, size_t *bodyp, size_t *extp, uint64_t *extnrp);
 int       xml_stats(cxobj *xt, uint64_t *nrp, size_t *szp);
+int       xml_compact(cxobj *xt, size_t *szp);
 char     *xml_name(cxobj *xn);
 int       xml_name_set(cxobj *xn, char *name);
 char     *xml_prefix(cxobj *xn);
@@ -229,6 +252,11 @@ int       xml_parent_candidate_set(cxobj *xn, cxobj *parent);
 uint16_t  xml_flag(cxobj *xn, uint16_t flag);
 int       xml_flag_set(cxobj *xn, uint16_t flag);
 int       xml_flag_reset(cxobj *xn, uint16_t flag);
+uint16_t  xml_flag_sub(cxobj *xn, uint16_t flag);
+int       xml_flag_sub_reset(cxobj *xn, uint16_t flag);
+int       xml_flag_reset_rec(cxobj *xt, uint16_t flag);
+int       xml_sorted(cxobj *xn);
+int       xml_sorted_set(cxobj *xn);
 
 int       xml_creator_add(cxobj *xn, char *name);
 int       xml_creator_rm(cxobj *xn, char *name);
@@ -240,6 +268,10 @@ int       xml_creator_print(FILE *f, cxobj *xn);
 char     *xml_value(cxobj *xn);
 int       xml_value_set(cxobj *xn, char *val);
 int       xml_value_append(cxobj *xn, char *val);
+int       xml_value_cmp(cxobj *x0, cxobj *x1);
+char     *xml_lazy(cxobj *x);
+int       xml_lazy_set(cxobj *x, const char *raw, size_t len);
+int       xml_lazy_expand(cxobj *x);
 enum cxobj_type xml_type(cxobj *xn);
 
 int       xml_child_nr(cxobj *xn);
@@ -251,16 +283,24 @@ cxobj    *xml_child_i_set(cxobj *xt, int i, cxobj *xc);
 int       xml_child_order(cxobj *xn, cxobj *xc);
 cxobj    *xml_child_each(cxobj *xparent, cxobj *xprev,  enum cxobj_type type);
 cxobj    *xml_child_each_attr(cxobj *xparent, cxobj *xprev);
+int       xml_child_it_init(xml_child_it *it, cxobj *xparent, enum cxobj_type type);
+cxobj    *xml_child_it_next(xml_child_it *it);
 int       xml_child_insert_pos(cxobj *x, cxobj *xc, int i);
+int       xml_child_insert_vec(cxobj *xp, cxobj **vec, int *posv, int len);
 int       xml_childvec_set(cxobj *x, int len);
+int       xml_childvec_reserve(cxobj *x, int n);
 cxobj   **xml_childvec_get(cxobj *x);
 int       clixon_child_xvec_append(cxobj *x, clixon_xvec *xv);
 cxobj    *xml_new(char *name, cxobj *xn_parent, enum cxobj_type type);
+cxobj    *xml_new_arena(char *name, enum cxobj_type type);
 cxobj    *xml_new_body(char *name, cxobj *parent, char *val);
 yang_stmt *xml_spec(cxobj *x);
 int       xml_spec_set(cxobj *x, yang_stmt *spec);
+uint16_t  xml_nsid(cxobj *x);
+int       xml_nsid_set(cxobj *x, uint16_t id);
 cg_var   *xml_cv(cxobj *x);
 int       xml_cv_set(cxobj *x, cg_var *cv);
+int       xml_cv_native(enum cv_type type);
 cxobj    *xml_find(cxobj *xn_parent, char *name);
 int       xml_addsub(cxobj *xp, cxobj *xc);
 cxobj    *xml_wrap_all(cxobj *xp, char *tag);
@@ -277,6 +317,7 @@ int       xml_enumerate_get(cxobj *x);
 
 char     *xml_body(cxobj *xn);
 cxobj    *xml_body_get(cxobj *xn);
+int       xml_body_cmp(cxobj *x0, cxobj *x1);
 char     *xml_find_type_value(cxobj *xn_parent, const char *prefix,
                               const char *name, enum cxobj_type type);
 cxobj    *xml_find_type(cxobj *xn_parent, const char *prefix, const char *name, enum cxobj_type type);
@@ -288,6 +329,7 @@ int       xml_free(cxobj *xn);
 
 int       xml_copy_one(cxobj *xn0, cxobj *xn1);
 int       xml_copy(cxobj *x0, cxobj *x1);
+int       xml_sync(cxobj *x0, cxobj *x1);
 cxobj    *xml_dup(cxobj *x0);
 
 int       cxvec_dup(cxobj **vec0, int len0, cxobj ***vec1, int *len1);
@@ -312,6 +354,7 @@ int       xml_search_index_p(cxobj *x);
 int       xml_search_vector_get(cxobj *x, char *name, clixon_xvec **xvec);
 int       xml_search_child_insert(cxobj *xp, cxobj *x);
 int       xml_search_child_rm(cxobj *xp, cxobj *x);
+int       xml_search_index_build(cxobj *xp, yang_stmt *yc, char *name);
 cxobj    *xml_child_index_each(cxobj *xparent, char *name, cxobj *xprev, enum cxobj_type type);
 
 #endif
@@ -47,6 +47,7 @@ int xml_bind_yang_unknown_anydata(int val);
 int xml_bind_netconf_message_id_optional(int val);
 int xml_bind_yang_rpc(clicon_handle h, cxobj *xrpc, yang_stmt *yspec, cxobj **xerr);
 int xml_bind_yang_rpc_reply(clicon_handle h, cxobj *xrpc, char *name, yang_stmt *yspec, cxobj **xerr);
+int xml_bind_value(cxobj *xt);
 int xml_bind_yang0(clicon_handle h, cxobj *xt, yang_bind yb, yang_stmt *yspec, cxobj **xerr);
 int xml_bind_yang(clicon_handle h, cxobj *xt, yang_bind yb, yang_stmt *yspec, cxobj **xerr);
 int xml_bind_special(cxobj *xd, yang_stmt *yspec, char *schema_nodeid);
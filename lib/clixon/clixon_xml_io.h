@@ -48,6 +48,8 @@ int   xml_print(FILE *f, cxobj *xn);
 int   xml_dump(FILE  *f, cxobj *x);
 int   clixon_xml2cbuf(cbuf *cb, cxobj *x, int level, int prettyprint, char *prefix, int32_t depth, int skiptop);
 int   xmltree2cbuf(cbuf *cb, cxobj *x, int level);
+int   clixon_xml_parse_scanner(int val);
+int   clixon_xml_parse_lazy(int val);
 int   clixon_xml_parse_file(FILE *f, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
 int   clixon_xml_parse_string(const char *str, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
 int   clixon_xml_parse_va(yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr, 
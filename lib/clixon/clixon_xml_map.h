@@ -57,6 +57,15 @@ int xml_diff(cxobj *x0, cxobj *x1,
              cxobj ***first, int *firstlen, 
              cxobj ***second, int *secondlen, 
              cxobj ***changed_x0, cxobj ***changed_x1, int *changedlen);
+int xml_diff_threads(cxobj *x0, cxobj *x1, int nthreads,
+                     cxobj ***first, int *firstlen, 
+                     cxobj ***second, int *secondlen, 
+                     cxobj ***changed_x0, cxobj ***changed_x1, int *changedlen);
+int xml_diff_dirty(cxobj *x0, cxobj *x1,     
+                   cxobj ***first, int *firstlen, 
+                   cxobj ***second, int *secondlen, 
+                   cxobj ***changed_x0, cxobj ***changed_x1, int *changedlen);
+int xml_sync_dirty(cxobj *x0, cxobj *x1);
 int xml_tree_equal(cxobj *x0, cxobj *x1);
 int xml_tree_prune_flagged_sub(cxobj *xt, int flag, int test, int *upmark);
 int xml_tree_prune_flagged(cxobj *xt, int flag, int test);
@@ -67,6 +76,7 @@ int xml_non_config_data(cxobj *xt, cxobj **xerr);
 int assign_namespace_element(cxobj *x0, cxobj *x1, cxobj *x1p);
 int assign_namespace_body(cxobj *x0, cxobj *x1);
 int xml_merge(cxobj *x0, cxobj *x1, yang_stmt *yspec, char **reason);
+int xml_edit_conflict(cxobj *x0, cxobj *x1);
 int yang_valstr2enum(yang_stmt *ytype, char *valstr, char **enumstr);
 int yang_enum2valstr(yang_stmt *ytype, char *enumstr, char **valstr);
 int yang_enum_int_value(cxobj *node, int32_t *val);
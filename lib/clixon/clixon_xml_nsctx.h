@@ -51,6 +51,9 @@
  * Prototypes
  */
 int     xml_nsctx_namespace_netconf_default(clicon_handle h);
+uint16_t xml_nsid_register(const char *ns);
+char   *xml_nsid2ns(uint16_t id);
+void    xml_nsid_exit(void);
 cvec   *xml_nsctx_init(char *prefix, char *ns);
 int     xml_nsctx_free(cvec *nsc);
 char   *xml_nsctx_get(cvec *nsc, char *prefix);
@@ -41,10 +41,15 @@
 /*
  * Prototypes
  */
+int xml_cv_parse(cxobj *x, int native, cg_var **cvp, char **reason);
+int xml_cv_cache(cxobj *x, cg_var **cvp);
+int xml_cv_cache_clear(cxobj *xt);
 int xml_cmp(cxobj *x1, cxobj *x2, int same, int skip1, char *expl);
 int xml_sort(cxobj *x0);
 int xml_sort_recurse(cxobj *xn);
+int xml_sort_recurse_parallel(cxobj *xn, int nthreads);
 int xml_insert(cxobj *xp, cxobj *xc, enum insert_type ins, char *key_val, cvec *nsckey);
+int xml_insert_bulk(cxobj *xp, cxobj **vec, int len);
 int xml_sort_verify(cxobj *x, void *arg);
 #ifdef XML_EXPLICIT_INDEX
 int xml_search_indexvar_binary_pos(cxobj *xp, char *indexvar, clixon_xvec *xvec,
@@ -54,5 +59,8 @@ int match_base_child(cxobj *x0, cxobj *x1c, yang_stmt *yc, cxobj **x0cp);
 int clixon_xml_find_index(cxobj *xp, yang_stmt *yp, char *ns, char *name,
                           cvec *cvk, clixon_xvec *xvec);
 int clixon_xml_find_pos(cxobj *xp, yang_stmt *yc, uint32_t pos, clixon_xvec *xvec);
+int xml_list_range(cxobj *xp, yang_stmt *yc, int *firstp, int *nrp);
+int clixon_xml_find_page(cxobj *xp, yang_stmt *yc, cxobj *xcursor,
+                         uint32_t offset, uint32_t limit, clixon_xvec *xvec);
 
 #endif /* _CLIXON_XML_SORT_H */
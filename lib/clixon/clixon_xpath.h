@@ -120,6 +120,13 @@ struct xpath_tree{
 };
 typedef struct xpath_tree xpath_tree;
 
+/*! Callback for each node of an xpath nodeset, see xpath_foreach
+ * @retval  1  OK, stop
+ * @retval  0  OK, continue with next node
+ * @retval -1  Error, stop
+ */
+typedef int (xpath_foreach_fn_t)(cxobj *x, void *arg);
+
 /*
  * Prototypes
  */
@@ -132,10 +139,14 @@ int   xpath_tree2cbuf(xpath_tree *xs, cbuf *xpathcb);
 int   xpath_tree_eq(xpath_tree *xt1, xpath_tree *xt2, xpath_tree ***vec, size_t *len);
 xpath_tree *xpath_tree_traverse(xpath_tree *xt, ...);
 int   xpath_tree_free(xpath_tree *xs);
+int   xpath_lock(int on);
 int   xpath_parse(const char *xpath, xpath_tree **xptree);
+int   xpath_cache_stats(uint64_t *nr, size_t *sz, uint64_t *hits, uint64_t *misses);
+void  xpath_cache_exit(void);
 int   xpath_vec_ctx(cxobj *xcur, cvec *nsc, const char *xpath, int localonly, xp_ctx  **xrp);
 
 int    xpath_vec_bool(cxobj *xcur, cvec *nsc, const char *xpformat, ...) __attribute__ ((format (printf, 3, 4)));
+int    xpath_vec_bool_tree(cxobj *xcur, cvec *nsc, xpath_tree *xptree);
 int    xpath_vec_flag(cxobj *xcur, cvec *nsc, const char *xpformat, uint16_t flags, 
                    cxobj ***vec, size_t *veclen, ...) __attribute__ ((format (printf, 3, 7)));
 
@@ -146,6 +157,7 @@ int    xpath_vec_flag(cxobj *xcur, cvec *nsc, const char *xpformat, uint16_t fla
  */
 cxobj *xpath_first(cxobj *xcur, cvec *nsc, const char *xpformat,  ...) __attribute__ ((format (printf, 3, 4)));
 cxobj *xpath_first_localonly(cxobj *xcur, const char *xpformat,  ...) __attribute__ ((format (printf, 2, 3)));
+int    xpath_foreach(cxobj *xcur, cvec *nsc, const char *xpath, xpath_foreach_fn_t *fn, void *arg);
 int    xpath_vec(cxobj *xcur, cvec *nsc, const char *xpformat, cxobj ***vec, size_t *veclen, ...) __attribute__ ((format (printf, 3, 6)));
 
 int xpath2canonical(const char *xpath0, cvec *nsc0, yang_stmt *yspec, char **xpath1, cvec **nsc1, cbuf **cbreason);
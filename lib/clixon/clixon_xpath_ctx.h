@@ -78,6 +78,7 @@ struct xp_ctx{
     cxobj         **xc_nodeset; /* if type XT_NODESET */
     int             xc_size;    /* Length of nodeset */
     int             xc_position;
+    int             xc_ctxsize; /* Context size in predicates, see last() */
     int             xc_bool;    /* if xc_type XT_BOOL */
     double          xc_number;  /* if xc_type XT_NUMBER */
     char           *xc_string;  /* if xc_type XT_STRING */
@@ -43,5 +43,7 @@ int  xpath_list_optimize_stats(int *hits);
 int  xpath_list_optimize_set(int enable); 
 void xpath_optimize_exit(void);
 int  xpath_optimize_check(xpath_tree *xs, cxobj *xv, cxobj ***xvec0, int *xlen0);
+int  xpath_optimize_range(xpath_tree *xs, cxobj *xv, cvec *nsc, int localonly,
+                          int *firstp, int *nrp);
 
 #endif /* _CLIXON_XPATH_OPTIMIZE_H */
@@ -83,6 +83,14 @@
                                       *     leaf z;
                                       *  }
                                       */
+#ifdef XML_EXPLICIT_INDEX
+#define YANG_FLAG_INDEX_LIST  0x100  /* This list has (extra) index children, see YANG_FLAG_INDEX */
+#endif
+#define YANG_FLAG_WHEN_CACHE  0x200  /* Descendant when cache is active */
+#define YANG_FLAG_WHEN_BELOW  0x400  /* Descendant when cache value: a descendant has a when
+                                      * condition, see xml_diff_dirty */
+#define YANG_FLAG_ARG_INTERN  0x800  /* Argument is an interned string, shared between the copies
+                                      * of a statement made at uses expansion, see ys_cp */
 
 /*
  * Types
@@ -180,6 +188,7 @@ enum yang_class{
 typedef enum yang_class yang_class;
 
 struct xml;
+struct xpath_tree;
 
 /* This is the external handle type exposed in the API.
  * The internal struct is defined in clixon_yang_internal.h */
@@ -194,6 +203,68 @@ typedef struct yang_stmt yang_stmt;
  */
 typedef int (yang_applyfn_t)(yang_stmt *ys, void *arg);
 
+/*! Class of a list key or leaf-list value, determines how two values are compared
+ * @see ys_populate_keycmp
+ */
+enum yang_key_class{
+    YK_GENERIC = 0,     /* Compare parsed cligen values, eg decimal64, enumeration, union */
+    YK_STRING,          /* Compare strings */
+    YK_INT,             /* Compare as signed integers */
+    YK_UINT,            /* Compare as unsigned integers */
+};
+
+/*! Precompiled comparator of a YANG list or leaf-list
+ * Created when the YANG is populated, used when sorting and searching XML
+ * @see ys_populate_keycmp
+ */
+struct yang_keycmp{
+    int                 yk_len;      /* Number of keys, 1 for leaf-list */
+    struct {
+        char               *yk_name;  /* Interned key name, or NULL for leaf-list value */
+        enum yang_key_class yk_class; /* How to compare key values */
+    }                   yk_keys[];
+};
+typedef struct yang_keycmp yang_keycmp;
+
+/*! Precomputed JSON member name of a YANG data node
+ * Created on first use by the JSON encoder
+ * @see yang_json_get
+ */
+struct yang_json{
+    char *yj_module;  /* Module name as encoded in JSON (ietf-netconf is ietf-restconf) */
+    char *yj_qname;   /* Module-qualified member name: <module>:<name> */
+};
+typedef struct yang_json yang_json;
+
+/* Size of bloom filter of descendant names in 64-bit words */
+#define YANG_BLOOM_WORDS 8
+
+/*! Bloom filter of the names of all descendant data nodes of a YANG node
+ * Created on first use by descendant xpath queries
+ * @see yang_bloom_descendant
+ */
+struct yang_bloom{
+    uint32_t yb_gen;                     /* Generation of yang tree when computed */
+    int      yb_all;                     /* Any name, eg below anydata or mount-point */
+    uint64_t yb_bits[YANG_BLOOM_WORDS];
+};
+typedef struct yang_bloom yang_bloom;
+
+/*! Resolved member type of a union
+ * Cached in the type cache of the union type at first validation, nested unions are flattened
+ * @see ys_cv_validate_union
+ */
+struct yang_type_member{
+    int           ym_index;    /* Position of top-level member type of the union */
+    yang_stmt    *ym_resolved; /* Resolved type */
+    enum cv_type  ym_cvtype;   /* CLIgen type of resolved type, CGV_ERR if leafref */
+    int           ym_options;  /* See YANG_OPTIONS_* */
+    cvec         *ym_cvv;      /* Range and length restrictions, not owned */
+    cvec         *ym_regexps;  /* Compiled regexps, the regexps are owned by the member type */
+    uint8_t       ym_fraction; /* Fraction digits for decimal64 */
+};
+typedef struct yang_type_member yang_type_member;
+
 /* Validation level at commit */
 enum validate_level_t {
     VL_FULL = 0, /* Do full RFC 7950 validation , 0 : backward-compatible */
@@ -233,6 +304,7 @@ cg_var    *yang_cv_get(yang_stmt *ys);
 int        yang_cv_set(yang_stmt *ys, cg_var *cv);
 cvec      *yang_cvec_get(yang_stmt *ys);
 int        yang_cvec_set(yang_stmt *ys, cvec *cvv);
+yang_keycmp *yang_keycmp_get(yang_stmt *ys);
 cg_var    *yang_cvec_add(yang_stmt *ys, enum cv_type type, char *name);
 uint16_t   yang_flag_get(yang_stmt *ys, uint16_t flag);
 int        yang_flag_set(yang_stmt *ys, uint16_t flag);
@@ -241,6 +313,11 @@ char      *yang_when_xpath_get(yang_stmt *ys);
 int        yang_when_xpath_set(yang_stmt *ys, char *xpath);
 cvec      *yang_when_nsc_get(yang_stmt *ys);
 int        yang_when_nsc_set(yang_stmt *ys, cvec *nsc);
+int        yang_xpath_get(yang_stmt *ys, struct xpath_tree **xptree, cvec **nsc);
+int        yang_nsctx_get(yang_stmt *ys, cvec **nsc);
+uint16_t   yang_nsid_get(yang_stmt *ys);
+yang_json *yang_json_get(yang_stmt *ys);
+int        yang_bloom_descendant(yang_stmt *ys, const char *name);
 const char *yang_filename_get(yang_stmt *ys);
 int        yang_filename_set(yang_stmt *ys, const char *filename);
 int        yang_linenum_get(yang_stmt *ys);
@@ -303,6 +380,9 @@ int        yang_type_cache_get(yang_stmt *ytype, yang_stmt **resolved, int *opti
                    cvec **cvv, cvec *patterns, int *rxmode, cvec *regexps, uint8_t *fraction);
 int        yang_type_cache_set(yang_stmt *ys, yang_stmt *resolved, int options, cvec *cvv,
                                cvec *patterns, uint8_t fraction);
+int        yang_type_cache_members_get(yang_stmt *ytype, yang_type_member **members, int *len);
+int        yang_type_cache_members_set(yang_stmt *ytype, yang_type_member *members, int len);
+int        yang_type_members_free(yang_type_member *members, int len);
 yang_stmt *yang_anydata_add(yang_stmt *yp, char *name);
 int        yang_extension_value(yang_stmt *ys, char *name, char *ns, int *exist, char **value);
 int        yang_sort_subelements(yang_stmt *ys);
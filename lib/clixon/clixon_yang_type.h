@@ -60,6 +60,7 @@ int        yang2cv_type(char *ytype, enum cv_type *cv_type);
 char      *cv2yang_type(enum cv_type cv_type);
 yang_stmt *yang_find_identity(yang_stmt *ys, char *identity);
 yang_stmt *yang_find_identity_nsc(yang_stmt *yspec, char *identity, cvec *nsc);
+int        yang_identity_derived(yang_stmt *ybaseid, const char *idref);
 int        ys_cv_validate(clicon_handle h, cg_var *cv, yang_stmt *ys, yang_stmt **ysub, char **reason);
 int        clicon_type2cv(char *type, char *rtype, yang_stmt *ys, enum cv_type *cvtype);
 int        yang_type_get(yang_stmt *ys, char **otype, yang_stmt **restype, 
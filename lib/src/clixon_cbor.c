@@ -0,0 +1,1365 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * YANG-CBOR encoding of XML trees, name-based variant of RFC 9254
+ * Used as datastore format (CLICON_XMLDB_FORMAT = cbor) and as RESTCONF media type
+ * application/yang-data+cbor
+ *
+ * The encoding follows the JSON encoding of RFC 7951 with CBOR items instead of text:
+ * - Member names are text strings, qualified with module name as in JSON
+ * - Lists and leaf-lists are arrays, containers are maps
+ * - Integer types, including 64-bit, are CBOR integers (major type 0 and 1)
+ * - decimal64 is a decimal fraction (tag 4), boolean is true/false, empty is null
+ * - binary is a byte string, other types are text strings
+ * Maps and arrays are encoded with definite length. The decoder also accepts indefinite
+ * lengths, and builds the same tree as the JSON parser, after which module names are
+ * translated and yang is bound as for JSON, see json_parse_bind
+ * The SID-based variant of RFC 9254 is not supported.
+ * @see RFC 8949 CBOR
+ * @see RFC 9254 Encoding of Data Modeled with YANG in CBOR
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_options.h"
+#include "clixon_yang_type.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xml_bind.h"
+#include "clixon_json.h"
+#include "clixon_json_parse.h"
+#include "clixon_cbor.h"
+
+/*
+ * Constants
+ */
+/* CBOR major types, RFC 8949 Sec 3.1 */
+#define CBOR_UINT    0
+#define CBOR_NINT    1
+#define CBOR_BYTES   2
+#define CBOR_TEXT    3
+#define CBOR_ARRAY   4
+#define CBOR_MAP     5
+#define CBOR_TAG     6
+#define CBOR_SIMPLE  7
+
+/* Additional information */
+#define CBOR_FALSE   20
+#define CBOR_TRUE    21
+#define CBOR_NULL    22
+#define CBOR_INDEF   31  /* Indefinite length, or break if major type 7 */
+#define CBOR_BREAK   0xff
+
+#define CBOR_TAG_DECFRAC 4  /* Decimal fraction [exponent, mantissa] */
+
+/* Max nesting of decoded items */
+#define CBOR_DEPTH_MAX 1024
+
+/*! CBOR decoder state, a memory buffer such as a mapped file
+ */
+struct cbor_dec {
+    const uint8_t *cd_buf;   /* Buffer, eg mapped file */
+    size_t         cd_len;   /* Length of buffer */
+    size_t         cd_pos;   /* Current position */
+    int            cd_depth; /* Current nesting of items */
+};
+
+static const char *cbor_b64 =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*! Append a CBOR head: major type and argument, in shortest form
+ *
+ * @param[in]  cb     CLIgen buffer
+ * @param[in]  major  Major type
+ * @param[in]  val    Argument: value, length or number of items
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+cbor_head(cbuf    *cb,
+          int      major,
+          uint64_t val)
+{
+    uint8_t buf[9];
+    size_t  len;
+    int     n;
+    int     i;
+
+    if (val < 24){
+        buf[0] = (major << 5) | val;
+        n = 0;
+    }
+    else if (val <= UINT8_MAX){
+        buf[0] = (major << 5) | 24;
+        n = 1;
+    }
+    else if (val <= UINT16_MAX){
+        buf[0] = (major << 5) | 25;
+        n = 2;
+    }
+    else if (val <= UINT32_MAX){
+        buf[0] = (major << 5) | 26;
+        n = 4;
+    }
+    else{
+        buf[0] = (major << 5) | 27;
+        n = 8;
+    }
+    for (i=0; i<n; i++)
+        buf[n-i] = (val >> (8*i)) & 0xff;
+    len = n + 1;
+    if (cbuf_append_buf(cb, buf, len) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Append a CBOR text or byte string
+ */
+static int
+cbor_string(cbuf       *cb,
+            int         major,
+            const char *str,
+            size_t      len)
+{
+    if (cbor_head(cb, major, len) < 0)
+        return -1;
+    if (len && cbuf_append_buf(cb, (void*)str, len) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Decode base64 string
+ *
+ * @param[in]  str   Base64 encoded string, whitespace is ignored
+ * @param[out] cb    Decoded bytes
+ * @retval     1     OK
+ * @retval     0     Not valid base64
+ * @retval    -1     Error
+ */
+static int
+cbor_base64_decode(const char *str,
+                   cbuf       *cb)
+{
+    const char *p;
+    const char *s;
+    uint32_t    acc = 0;
+    int         n = 0;
+    int         pad = 0;
+    uint8_t     c;
+
+    for (s = str; *s; s++){
+        if (isspace(*s))
+            continue;
+        if (*s == '='){
+            pad++;
+            continue;
+        }
+        if (pad || (p = strchr(cbor_b64, *s)) == NULL)
+            return 0;
+        acc = (acc << 6) | (p - cbor_b64);
+        if (++n == 4){
+            c = acc >> 16;
+            if (cbuf_append(cb, c) < 0)
+                goto err;
+            c = acc >> 8;
+            if (cbuf_append(cb, c) < 0)
+                goto err;
+            c = acc;
+            if (cbuf_append(cb, c) < 0)
+                goto err;
+            acc = 0;
+            n = 0;
+        }
+    }
+    /* Remaining 2 or 3 characters are 1 or 2 bytes */
+    if (n == 1 || (n == 0 && pad) || (n && pad && n + pad != 4))
+        return 0;
+    if (n >= 2 && cbuf_append(cb, (acc >> (n==2?4:10)) & 0xff) < 0)
+        goto err;
+    if (n == 3 && cbuf_append(cb, (acc >> 2) & 0xff) < 0)
+        goto err;
+    return 1;
+ err:
+    clicon_err(OE_XML, errno, "cbuf_append");
+    return -1;
+}
+
+/*! Encode bytes as base64 string
+ *
+ * @param[in]  buf   Bytes
+ * @param[in]  len   Number of bytes
+ * @param[out] cb    Base64 encoded string
+ */
+static void
+cbor_base64_encode(const uint8_t *buf,
+                   size_t         len,
+                   cbuf          *cb)
+{
+    size_t   i;
+    uint32_t acc;
+
+    for (i=0; i+2<len; i+=3){
+        acc = (buf[i] << 16) | (buf[i+1] << 8) | buf[i+2];
+        cprintf(cb, "%c%c%c%c", cbor_b64[acc>>18], cbor_b64[(acc>>12)&0x3f],
+                cbor_b64[(acc>>6)&0x3f], cbor_b64[acc&0x3f]);
+    }
+    if (len - i == 1){
+        acc = buf[i] << 16;
+        cprintf(cb, "%c%c==", cbor_b64[acc>>18], cbor_b64[(acc>>12)&0x3f]);
+    }
+    else if (len - i == 2){
+        acc = (buf[i] << 16) | (buf[i+1] << 8);
+        cprintf(cb, "%c%c%c=", cbor_b64[acc>>18], cbor_b64[(acc>>12)&0x3f],
+                cbor_b64[(acc>>6)&0x3f]);
+    }
+}
+
+/*! Encode an integer type value as CBOR integer
+ *
+ * @param[in]  cb       CLIgen buffer
+ * @param[in]  body     Value as string
+ * @param[in]  issigned Signed integer type
+ * @retval     1        OK
+ * @retval     0        Not an integer, not encoded
+ * @retval    -1        Error
+ */
+static int
+cbor_encode_int(cbuf *cb,
+                char *body,
+                int   issigned)
+{
+    char    *end = NULL;
+    int64_t  i;
+    uint64_t u;
+
+    errno = 0;
+    if (issigned){
+        i = strtoll(body, &end, 10);
+        if (errno || end == body || *end != '\0')
+            return 0;
+        if (i < 0){
+            if (cbor_head(cb, CBOR_NINT, (uint64_t)(-1 - i)) < 0)
+                return -1;
+        }
+        else if (cbor_head(cb, CBOR_UINT, i) < 0)
+            return -1;
+    }
+    else {
+        if (!isdigit(*body))
+            return 0;
+        u = strtoull(body, &end, 10);
+        if (errno || *end != '\0')
+            return 0;
+        if (cbor_head(cb, CBOR_UINT, u) < 0)
+            return -1;
+    }
+    return 1;
+}
+
+/*! Encode a decimal64 value as a CBOR decimal fraction
+ *
+ * Example: 12.50 -> 4([-2, 1250])
+ * @param[in]  cb       CLIgen buffer
+ * @param[in]  body     Value as string
+ * @retval     1        OK
+ * @retval     0        Not a decimal number, not encoded
+ * @retval    -1        Error
+ * @see RFC 9254 Sec 6.3
+ */
+static int
+cbor_encode_dec64(cbuf *cb,
+                  char *body)
+{
+    char     digits[20];
+    char    *s = body;
+    int      nd = 0;
+    int      frac = 0;
+    int      dot = 0;
+    int      neg = 0;
+    uint64_t m;
+
+    if (*s == '-'){
+        neg++;
+        s++;
+    }
+    for (; *s; s++){
+        if (*s == '.' && !dot){
+            dot++;
+            continue;
+        }
+        if (!isdigit(*s) || nd == sizeof(digits)-1)
+            return 0;
+        digits[nd++] = *s;
+        if (dot)
+            frac++;
+    }
+    if (nd == 0)
+        return 0;
+    digits[nd] = '\0';
+    errno = 0;
+    m = strtoull(digits, NULL, 10);
+    if (errno)
+        return 0;
+    if (cbor_head(cb, CBOR_TAG, CBOR_TAG_DECFRAC) < 0 ||
+        cbor_head(cb, CBOR_ARRAY, 2) < 0)
+        return -1;
+    if (frac){
+        if (cbor_head(cb, CBOR_NINT, frac - 1) < 0)
+            return -1;
+    }
+    else if (cbor_head(cb, CBOR_UINT, 0) < 0)
+        return -1;
+    if (neg && m){
+        if (cbor_head(cb, CBOR_NINT, m - 1) < 0)
+            return -1;
+    }
+    else if (cbor_head(cb, CBOR_UINT, m) < 0)
+        return -1;
+    return 1;
+}
+
+/*! Encode value of leaf or leaf-list, or body of other node
+ *
+ * @param[in]  cb   CLIgen buffer
+ * @param[in]  x    XML leaf node
+ * @param[in]  y    Yang spec of x, or NULL
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml2json_encode_leafs  JSON variant
+ */
+static int
+cbor_encode_leaf(cbuf      *cb,
+                 cxobj     *x,
+                 yang_stmt *y)
+{
+    int           retval = -1;
+    cxobj        *xb;
+    char         *body;
+    yang_stmt    *ytype = NULL;
+    char         *restype = NULL;
+    char         *origtype = NULL;
+    cbuf         *cbv = NULL;
+    int           ret = 0;
+
+    xb = xml_body_get(x);
+    body = xb?xml_value(xb):NULL;
+    if (y == NULL ||
+        (yang_keyword_get(y) != Y_LEAF && yang_keyword_get(y) != Y_LEAF_LIST)){
+        if (body){
+            if (cbor_string(cb, CBOR_TEXT, body, strlen(body)) < 0)
+                goto done;
+        }
+        else if (cbor_head(cb, CBOR_MAP, 0) < 0) /* As {} in JSON */
+            goto done;
+        goto ok;
+    }
+    if (yang_type_get(y, &origtype, &ytype, NULL, NULL, NULL, NULL, NULL) < 0)
+        goto done;
+    restype = ytype?yang_argument_get(ytype):NULL;
+    if (body == NULL){
+        if (restype && strcmp(restype, "empty") == 0)
+            ret = cbor_head(cb, CBOR_SIMPLE, CBOR_NULL);
+        else
+            ret = cbor_string(cb, CBOR_TEXT, "", 0);
+        if (ret < 0)
+            goto done;
+        goto ok;
+    }
+    ret = 0;
+    switch (yang_type2cv(y)){
+    case CGV_INT8:
+    case CGV_INT16:
+    case CGV_INT32:
+    case CGV_INT64:
+        ret = cbor_encode_int(cb, body, 1);
+        break;
+    case CGV_UINT8:
+    case CGV_UINT16:
+    case CGV_UINT32:
+    case CGV_UINT64:
+        ret = cbor_encode_int(cb, body, 0);
+        break;
+    case CGV_DEC64:
+        ret = cbor_encode_dec64(cb, body);
+        break;
+    case CGV_BOOL:
+        if (strcmp(body, "true") == 0 || strcmp(body, "false") == 0){
+            if (cbor_head(cb, CBOR_SIMPLE,
+                          strcmp(body, "true")==0?CBOR_TRUE:CBOR_FALSE) < 0)
+                goto done;
+            ret = 1;
+        }
+        break;
+    default:
+        if (restype == NULL)
+            break;
+        if ((cbv = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        if (strcmp(restype, "identityref") == 0){
+            if (xml2json_encode_identityref(xb, body, y, cbv) < 0)
+                goto done;
+            if (cbor_string(cb, CBOR_TEXT, cbuf_get(cbv), cbuf_len(cbv)) < 0)
+                goto done;
+            ret = 1;
+        }
+        else if (strcmp(restype, "binary") == 0){
+            if ((ret = cbor_base64_decode(body, cbv)) == 1 &&
+                cbor_string(cb, CBOR_BYTES, cbuf_get(cbv), cbuf_len(cbv)) < 0)
+                goto done;
+        }
+        break;
+    }
+    if (ret < 0)
+        goto done;
+    if (ret == 0 && /* Not encoded as type, eg invalid value */
+        cbor_string(cb, CBOR_TEXT, body, strlen(body)) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (origtype)
+        free(origtype);
+    if (cbv)
+        cbuf_free(cbv);
+    return retval;
+}
+
+/*! Check if two sibling elements have same name and namespace, ie are in same array
+ *
+ * @see array_eval  JSON variant
+ */
+static int
+cbor_same(cxobj *x1,
+          cxobj *x2)
+{
+    char *ns1;
+    char *ns2;
+
+    if (strcmp(xml_name(x1), xml_name(x2)) != 0)
+        return 0;
+    ns1 = xml_find_type_value(x1, NULL, "xmlns", CX_ATTR);
+    ns2 = xml_find_type_value(x2, NULL, "xmlns", CX_ATTR);
+    if (ns1 == NULL || ns2 == NULL)
+        return ns1 == ns2;
+    return strcmp(ns1, ns2) == 0;
+}
+
+/*! Encode member name, qualified with module name if different from parent
+ *
+ * @param[in]  cb       CLIgen buffer
+ * @param[in]  x        XML element
+ * @param[in]  modname0 Module name of ancestor, or NULL
+ * @param[out] modname  Module name passed to children of x
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+cbor_encode_name(cbuf  *cb,
+                 cxobj *x,
+                 char  *modname0,
+                 char **modname)
+{
+    yang_stmt *ys;
+    yang_stmt *ymod;
+    char      *mod = NULL;
+    char      *name;
+
+    name = xml_name(x);
+    if ((ys = xml_spec(x)) != NULL){
+        if (ys_real_module(ys, &ymod) < 0)
+            return -1;
+        mod = yang_argument_get(ymod);
+        /* Special case for ietf-netconf -> ietf-restconf translation, see xml2json1_cbuf */
+        if (strcmp(mod, "ietf-netconf") == 0)
+            mod = "ietf-restconf";
+    }
+    if (mod && (modname0 == NULL || strcmp(mod, modname0) != 0)){
+        if (cbor_head(cb, CBOR_TEXT, strlen(mod) + 1 + strlen(name)) < 0)
+            return -1;
+        cprintf(cb, "%s:%s", mod, name);
+    }
+    else if (cbor_string(cb, CBOR_TEXT, name, strlen(name)) < 0)
+        return -1;
+    *modname = mod?mod:modname0;
+    return 0;
+}
+
+static int cbor_encode_members(cbuf *cb, cxobj *xp, char *modname0);
+
+/*! Encode value of XML element: map of children or leaf value
+ *
+ * @param[in]  cb       CLIgen buffer
+ * @param[in]  x        XML element
+ * @param[in]  modname0 Module name of x
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see nullchild  JSON variant for elements without children
+ */
+static int
+cbor_encode_value(cbuf  *cb,
+                  cxobj *x,
+                  char  *modname0)
+{
+    yang_stmt *y;
+
+    if (xml_child_nr_type(x, CX_ELMNT) > 0)
+        return cbor_encode_members(cb, x, modname0);
+    y = xml_spec(x);
+    if (xml_body_get(x) != NULL ||
+        (y && (yang_keyword_get(y) == Y_LEAF || yang_keyword_get(y) == Y_LEAF_LIST)))
+        return cbor_encode_leaf(cb, x, y);
+    return cbor_head(cb, CBOR_MAP, 0);
+}
+
+/*! Encode element children as a CBOR map
+ *
+ * Consecutive siblings with same name and namespace are encoded as one array member,
+ * as are single list and leaf-list entries
+ * Attributes, including metadata, are not encoded
+ * @param[in]  cb       CLIgen buffer
+ * @param[in]  xp       XML parent
+ * @param[in]  modname0 Module name of parent, or NULL
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+cbor_encode_members(cbuf  *cb,
+                    cxobj *xp,
+                    char  *modname0)
+{
+    cxobj     *xc;
+    cxobj     *xn;
+    cxobj     *x;
+    yang_stmt *y;
+    char      *modname;
+    uint64_t   n = 0;
+    uint64_t   nr;
+    uint64_t   i;
+
+    /* Count members: groups of equal siblings */
+    x = NULL;
+    xc = NULL;
+    while ((xc = xml_child_each(xp, xc, CX_ELMNT)) != NULL){
+        if (x == NULL || !cbor_same(x, xc))
+            n++;
+        x = xc;
+    }
+    if (cbor_head(cb, CBOR_MAP, n) < 0)
+        return -1;
+    xc = xml_child_each(xp, NULL, CX_ELMNT);
+    while (xc != NULL){
+        nr = 1;
+        xn = xc;
+        while ((xn = xml_child_each(xp, xn, CX_ELMNT)) != NULL && cbor_same(xc, xn))
+            nr++;
+        if (cbor_encode_name(cb, xc, modname0, &modname) < 0)
+            return -1;
+        y = xml_spec(xc);
+        if (nr > 1 ||
+            (y && (yang_keyword_get(y) == Y_LIST || yang_keyword_get(y) == Y_LEAF_LIST)))
+            if (cbor_head(cb, CBOR_ARRAY, nr) < 0)
+                return -1;
+        x = xc;
+        for (i=0; i<nr; i++){
+            if (cbor_encode_value(cb, x, modname) < 0)
+                return -1;
+            x = xml_child_each(xp, x, CX_ELMNT);
+        }
+        xc = xn;
+    }
+    return 0;
+}
+
+/*! Translate an XML tree to YANG-CBOR in a CLIgen buffer
+ *
+ * Same structure as JSON, the top object is a map, see clixon_json2cbuf
+ * @param[in,out] cb      CLIgen buffer to write to
+ * @param[in]     xt      XML tree, assume yang bound
+ * @param[in]     skiptop 0: Include top object 1: Skip top-object, only children
+ * @retval        0       OK
+ * @retval       -1       Error
+ * @see clixon_cbor_parse_buf
+ */
+int
+clixon_xml2cbor_cbuf(cbuf  *cb,
+                     cxobj *xt,
+                     int    skiptop)
+{
+    yang_stmt *y;
+    char      *modname;
+
+    if (cb == NULL || xt == NULL){
+        clicon_err(OE_XML, EINVAL, "arg is NULL");
+        return -1;
+    }
+    if (skiptop)
+        return cbor_encode_members(cb, xt, NULL);
+    if (cbor_head(cb, CBOR_MAP, 1) < 0)
+        return -1;
+    if (cbor_encode_name(cb, xt, NULL, &modname) < 0)
+        return -1;
+    if ((y = xml_spec(xt)) != NULL &&
+        (yang_keyword_get(y) == Y_LIST || yang_keyword_get(y) == Y_LEAF_LIST))
+        if (cbor_head(cb, CBOR_ARRAY, 1) < 0)
+            return -1;
+    return cbor_encode_value(cb, xt, modname);
+}
+
+/*! Translate an XML tree to a YANG-CBOR map of one member with given name
+ *
+ * Example: name "ietf-restconf:errors" and xt <errors>..</errors>: {"ietf-restconf:errors": ..}
+ * @param[in,out] cb      CLIgen buffer to write to
+ * @param[in]     name    Member name, qualified with module name
+ * @param[in]     xt      XML tree, value of member, encoded as clixon_xml2cbor_cbuf
+ * @retval        0       OK
+ * @retval       -1       Error
+ */
+int
+clixon_xml2cbor_member(cbuf       *cb,
+                       const char *name,
+                       cxobj      *xt)
+{
+    if (cbor_head(cb, CBOR_MAP, 1) < 0 ||
+        cbor_string(cb, CBOR_TEXT, name, strlen(name)) < 0)
+        return -1;
+    return clixon_xml2cbor_cbuf(cb, xt, 0);
+}
+
+/*! Translate a vector of XML objects to YANG-CBOR in a CLIgen buffer
+ *
+ * The objects are members of one top map.
+ * @param[out] cb      CLIgen buffer to write to
+ * @param[in]  vec     Vector of XML objects
+ * @param[in]  veclen  Length of vector
+ * @param[in]  skiptop 0: Include top object 1: Skip top-object, only children
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see xml2json_cbuf_vec  JSON variant
+ */
+int
+clixon_xml2cbor_cbuf_vec(cbuf   *cb,
+                         cxobj **vec,
+                         size_t  veclen,
+                         int     skiptop)
+{
+    int    retval = -1;
+    cxobj *xp = NULL;
+    cxobj *xc0;
+    cxobj *xc;
+    cxobj *x;
+    cvec  *nsc = NULL;
+    int    i;
+
+    if ((xp = xml_new("xml2cbor", NULL, CX_ELMNT)) == NULL)
+        goto done;
+    /* Make a copy of old and graft it into new top-object, also copy namespace context */
+    for (i=0; i<veclen; i++){
+        xc0 = vec[i];
+        if (xml_nsctx_node(xc0, &nsc) < 0)
+            goto done;
+        if (skiptop){
+            x = NULL;
+            while ((x = xml_child_each(xc0, x, CX_ELMNT)) != NULL) {
+                if ((xc = xml_dup(x)) == NULL)
+                    goto done;
+                xml_addsub(xp, xc);
+                xmlns_set_all(xc, nsc);
+            }
+            cvec_free(nsc);
+        }
+        else {
+            if ((xc = xml_dup(xc0)) == NULL)
+                goto done;
+            xml_addsub(xp, xc);
+            nscache_replace(xc, nsc);
+        }
+        nsc = NULL; /* nsc consumed */
+    }
+    if (cbor_encode_members(cb, xp, NULL) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (xp)
+        xml_free(xp);
+    return retval;
+}
+
+/*! Write an XML tree in YANG-CBOR to a file
+ *
+ * @param[in]  f    Output file
+ * @param[in]  xt   XML tree, typically a datastore top-level
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon_cbor_parse_file
+ */
+int
+clixon_xml2cbor_file(FILE  *f,
+                     cxobj *xt)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if (f == NULL || xt == NULL){
+        clicon_err(OE_XML, EINVAL, "arg is NULL");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbor_cbuf(cb, xt, 0) < 0)
+        goto done;
+    if (fwrite(cbuf_get(cb), 1, cbuf_len(cb), f) != cbuf_len(cb)){
+        clicon_err(OE_UNIX, errno, "fwrite");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Read a CBOR head with bounds check
+ *
+ * @param[in]  cd     Decoder state
+ * @param[out] major  Major type
+ * @param[out] info   Additional information, CBOR_INDEF for indefinite length
+ * @param[out] val    Argument: value, length or number of items
+ * @retval     0      OK
+ * @retval    -1      Error, malformed
+ */
+static int
+cbor_get_head(struct cbor_dec *cd,
+              int             *major,
+              int             *info,
+              uint64_t        *val)
+{
+    uint8_t b;
+    int     n;
+    int     i;
+
+    if (cd->cd_pos >= cd->cd_len)
+        goto eof;
+    b = cd->cd_buf[cd->cd_pos++];
+    *major = b >> 5;
+    *info = b & 0x1f;
+    *val = 0;
+    if (*info < 24)
+        *val = *info;
+    else if (*info < 28){
+        n = 1 << (*info - 24);
+        if (n > cd->cd_len - cd->cd_pos)
+            goto eof;
+        for (i=0; i<n; i++)
+            *val = (*val << 8) | cd->cd_buf[cd->cd_pos++];
+    }
+    else if (*info != CBOR_INDEF ||
+             *major == CBOR_UINT || *major == CBOR_NINT || *major == CBOR_TAG){
+        clicon_err(OE_XML, EFAULT, "CBOR malformed head 0x%02x at %zu", b, cd->cd_pos - 1);
+        return -1;
+    }
+    return 0;
+ eof:
+    clicon_err(OE_XML, EFAULT, "CBOR unexpected end of data at %zu", cd->cd_pos);
+    return -1;
+}
+
+/*! Check for and skip break of indefinite length item
+ *
+ * @retval  1  Break, skipped
+ * @retval  0  Not break
+ */
+static int
+cbor_break(struct cbor_dec *cd)
+{
+    if (cd->cd_pos < cd->cd_len && cd->cd_buf[cd->cd_pos] == CBOR_BREAK){
+        cd->cd_pos++;
+        return 1;
+    }
+    return 0;
+}
+
+/*! Read text or byte string, given its head, definite or indefinite length
+ *
+ * @param[in]  cd     Decoder state
+ * @param[in]  major  Major type: text or bytes
+ * @param[in]  info   Additional information of head
+ * @param[in]  len    Length of definite string
+ * @param[out] cb     String, appended
+ * @retval     0      OK
+ * @retval    -1      Error, malformed
+ */
+static int
+cbor_get_string(struct cbor_dec *cd,
+                int              major,
+                int              info,
+                uint64_t         len,
+                cbuf            *cb)
+{
+    int      m;
+    int      i;
+
+    if (info == CBOR_INDEF){ /* Sequence of definite chunks until break */
+        while (!cbor_break(cd)){
+            if (cbor_get_head(cd, &m, &i, &len) < 0)
+                return -1;
+            if (m != major || i == CBOR_INDEF){
+                clicon_err(OE_XML, EFAULT, "CBOR malformed indefinite string at %zu", cd->cd_pos);
+                return -1;
+            }
+            if (cbor_get_string(cd, major, i, len, cb) < 0)
+                return -1;
+        }
+        return 0;
+    }
+    if (len > cd->cd_len - cd->cd_pos){
+        clicon_err(OE_XML, EFAULT, "CBOR unexpected end of data at %zu", cd->cd_pos);
+        return -1;
+    }
+    if (len && cbuf_append_buf(cb, (void*)(cd->cd_buf + cd->cd_pos), len) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        return -1;
+    }
+    cd->cd_pos += len;
+    return 0;
+}
+
+/*! Read a CBOR integer that fits in int64
+ */
+static int
+cbor_get_int(struct cbor_dec *cd,
+             int64_t         *ip)
+{
+    int      major;
+    int      info;
+    uint64_t val;
+
+    if (cbor_get_head(cd, &major, &info, &val) < 0)
+        return -1;
+    if ((major != CBOR_UINT && major != CBOR_NINT) || val > INT64_MAX){
+        clicon_err(OE_XML, EFAULT, "CBOR expected integer at %zu", cd->cd_pos);
+        return -1;
+    }
+    *ip = major == CBOR_UINT ? (int64_t)val : -1 - (int64_t)val;
+    return 0;
+}
+
+/*! Add body to XML element, as json_current_body
+ *
+ * @param[in]  x      XML element
+ * @param[in]  value  Body value, or NULL for null
+ */
+static int
+cbor_body(cxobj *x,
+          char  *value)
+{
+    cxobj *xb;
+
+    if ((xb = xml_new("body", x, CX_BODY)) == NULL)
+        return -1;
+    if (value && xml_value_append(xb, value) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Read a decimal fraction and add it as body, eg 4([-2, 1250]) -> 12.50
+ *
+ * @see cbor_encode_dec64
+ */
+static int
+cbor_decode_decfrac(struct cbor_dec *cd,
+                    cxobj           *x)
+{
+    int      retval = -1;
+    int      major;
+    int      info;
+    uint64_t val;
+    int64_t  e;
+    int64_t  m;
+    char     digits[24];
+    int      nd;
+    int      i;
+    cbuf    *cb = NULL;
+
+    if (cbor_get_head(cd, &major, &info, &val) < 0)
+        goto done;
+    if (major != CBOR_ARRAY || val != 2 || info == CBOR_INDEF){
+        clicon_err(OE_XML, EFAULT, "CBOR malformed decimal fraction at %zu", cd->cd_pos);
+        goto done;
+    }
+    if (cbor_get_int(cd, &e) < 0 ||
+        cbor_get_int(cd, &m) < 0)
+        goto done;
+    if (e < -18 || e > 18){
+        clicon_err(OE_XML, EFAULT, "CBOR decimal fraction exponent %" PRId64 " out of range", e);
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (m < 0)
+        cprintf(cb, "-");
+    nd = snprintf(digits, sizeof(digits), "%" PRIu64,
+                  m < 0 ? (uint64_t)(-(m + 1)) + 1 : (uint64_t)m);
+    if (e >= 0){
+        cprintf(cb, "%s", digits);
+        for (i=0; i<e; i++)
+            cprintf(cb, "0");
+    }
+    else if (nd <= -e){
+        cprintf(cb, "0.");
+        for (i=0; i<-e-nd; i++)
+            cprintf(cb, "0");
+        cprintf(cb, "%s", digits);
+    }
+    else
+        cprintf(cb, "%.*s.%s", (int)(nd + e), digits, digits + nd + e);
+    if (cbor_body(x, cbuf_get(cb)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+static int cbor_decode_map(struct cbor_dec *cd, cxobj *xp, int info, uint64_t n, clixon_json_yacc *jy);
+
+/*! Decode a CBOR item as value of an XML element
+ *
+ * Scalar values are added as body, maps as child elements.
+ * @param[in]  cd     Decoder state
+ * @param[in]  x      XML element
+ * @retval     0      OK
+ * @retval    -1      Error, malformed or not YANG-CBOR
+ */
+static int
+cbor_decode_item(struct cbor_dec *cd,
+                 cxobj           *x)
+{
+    int      retval = -1;
+    int      major;
+    int      info;
+    uint64_t val;
+    char     str[24];
+    cbuf    *cb = NULL;
+    cbuf    *cb64 = NULL;
+
+    if (++cd->cd_depth > CBOR_DEPTH_MAX){
+        clicon_err(OE_XML, EFAULT, "CBOR nesting exceeds %d", CBOR_DEPTH_MAX);
+        goto done;
+    }
+    if (cbor_get_head(cd, &major, &info, &val) < 0)
+        goto done;
+    switch (major){
+    case CBOR_UINT:
+        snprintf(str, sizeof(str), "%" PRIu64, val);
+        if (cbor_body(x, str) < 0)
+            goto done;
+        break;
+    case CBOR_NINT: /* -1 - val */
+        if (val == UINT64_MAX)
+            snprintf(str, sizeof(str), "-18446744073709551616");
+        else
+            snprintf(str, sizeof(str), "-%" PRIu64, val + 1);
+        if (cbor_body(x, str) < 0)
+            goto done;
+        break;
+    case CBOR_BYTES: /* As yang binary type */
+    case CBOR_TEXT:
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        if (cbor_get_string(cd, major, info, val, cb) < 0)
+            goto done;
+        if (major == CBOR_BYTES){
+            if ((cb64 = cbuf_new()) == NULL){
+                clicon_err(OE_XML, errno, "cbuf_new");
+                goto done;
+            }
+            cbor_base64_encode((uint8_t*)cbuf_get(cb), cbuf_len(cb), cb64);
+            if (cbor_body(x, cbuf_get(cb64)) < 0)
+                goto done;
+        }
+        else if (cbor_body(x, cbuf_get(cb)) < 0)
+            goto done;
+        break;
+    case CBOR_MAP:
+        if (cbor_decode_map(cd, x, info, val, NULL) < 0)
+            goto done;
+        break;
+    case CBOR_TAG:
+        if (val == CBOR_TAG_DECFRAC){
+            if (cbor_decode_decfrac(cd, x) < 0)
+                goto done;
+        }
+        else if (cbor_decode_item(cd, x) < 0) /* Other tags are ignored */
+            goto done;
+        break;
+    case CBOR_SIMPLE:
+        if (info == CBOR_FALSE || info == CBOR_TRUE){
+            if (cbor_body(x, info == CBOR_TRUE ? "true" : "false") < 0)
+                goto done;
+        }
+        else if (info == CBOR_NULL){
+            if (cbor_body(x, NULL) < 0)
+                goto done;
+        }
+        else {
+            clicon_err(OE_XML, EFAULT, "CBOR unsupported simple value or float at %zu", cd->cd_pos);
+            goto done;
+        }
+        break;
+    default: /* CBOR_ARRAY */
+        clicon_err(OE_XML, EFAULT, "CBOR array in array is not YANG-CBOR at %zu", cd->cd_pos);
+        goto done;
+        break;
+    }
+    cd->cd_depth--;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (cb64)
+        cbuf_free(cb64);
+    return retval;
+}
+
+/*! Create element for member name, as json_current_new
+ *
+ * @param[in]  xp   XML parent
+ * @param[in]  key  Member name: <module>:<name> or <name>
+ * @param[in]  jy   Top-level: add created element to jy_xvec, or NULL
+ * @param[out] xret Created element
+ */
+static int
+cbor_element(cxobj            *xp,
+             char             *key,
+             clixon_json_yacc *jy,
+             cxobj           **xret)
+{
+    int    retval = -1;
+    cxobj *x;
+    char  *prefix = NULL;
+    char  *id = NULL;
+
+    if (nodeid_split(key, &prefix, &id) < 0)
+        goto done;
+    if ((x = xml_new(id, xp, CX_ELMNT)) == NULL)
+        goto done;
+    if (xml_prefix_set(x, prefix) < 0)
+        goto done;
+    if (jy && cxvec_append(x, &jy->jy_xvec, &jy->jy_xlen) < 0)
+        goto done;
+    *xret = x;
+    retval = 0;
+ done:
+    if (prefix)
+        free(prefix);
+    if (id)
+        free(id);
+    return retval;
+}
+
+/*! Decode map members as child elements, given the head of the map
+ *
+ * An array member is decoded as one element per array item, as in JSON
+ * @param[in]  cd     Decoder state
+ * @param[in]  xp     XML parent
+ * @param[in]  info   Additional information of map head
+ * @param[in]  n      Number of members of definite length map
+ * @param[in]  jy     Top-level: add created elements to jy_xvec, or NULL
+ * @retval     0      OK
+ * @retval    -1      Error, malformed or not YANG-CBOR
+ */
+static int
+cbor_decode_map(struct cbor_dec  *cd,
+                cxobj            *xp,
+                int               info,
+                uint64_t          n,
+                clixon_json_yacc *jy)
+{
+    int      retval = -1;
+    cbuf    *cbk = NULL;
+    cxobj   *x;
+    int      major;
+    int      ainfo;
+    uint64_t an;
+    uint64_t i;
+    uint64_t j;
+
+    if ((cbk = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    for (i=0; info == CBOR_INDEF || i<n; i++){
+        if (info == CBOR_INDEF && cbor_break(cd))
+            break;
+        if (cbor_get_head(cd, &major, &ainfo, &an) < 0)
+            goto done;
+        if (major != CBOR_TEXT){
+            clicon_err(OE_XML, EFAULT, "CBOR member name is not a text string at %zu", cd->cd_pos);
+            goto done;
+        }
+        cbuf_reset(cbk);
+        if (cbor_get_string(cd, major, ainfo, an, cbk) < 0)
+            goto done;
+        if (cd->cd_pos < cd->cd_len && (cd->cd_buf[cd->cd_pos] >> 5) == CBOR_ARRAY){
+            if (cbor_get_head(cd, &major, &ainfo, &an) < 0)
+                goto done;
+            for (j=0; ainfo == CBOR_INDEF || j<an; j++){
+                if (ainfo == CBOR_INDEF && cbor_break(cd))
+                    break;
+                if (cbor_element(xp, cbuf_get(cbk), jy, &x) < 0)
+                    goto done;
+                if (cbor_decode_item(cd, x) < 0)
+                    goto done;
+            }
+            if (j == 0 && /* Empty array */
+                cbor_element(xp, cbuf_get(cbk), jy, &x) < 0)
+                goto done;
+        }
+        else {
+            if (cbor_element(xp, cbuf_get(cbk), jy, &x) < 0)
+                goto done;
+            if (cbor_decode_item(cd, x) < 0)
+                goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (cbk)
+        cbuf_free(cbk);
+    return retval;
+}
+
+/*! Parse a buffer in YANG-CBOR and return an XML tree
+ *
+ * Semantics as clixon_json_parse_string: if *xt is NULL, a top-level node is created
+ * and the members of the top map are added as children.
+ * @param[in]     buf   Buffer in CBOR, eg a mapped file or a RESTCONF request body
+ * @param[in]     len   Length of buffer
+ * @param[in]     yb    How to bind yang to XML top-level when parsing
+ * @param[in]     yspec Yang specification, or NULL
+ * @param[in,out] xt    Pointer to XML parse tree. If empty will be created.
+ * @param[out]    xerr  Reason for failure (yang assignment not made) if retval = 0
+ * @retval        1     Parse OK and all yang assignment made
+ * @retval        0     Parse OK but yang assigment not made (or only partial), xerr is set
+ * @retval       -1     Error with clicon_err called. Includes malformed buffer
+ * @see clixon_json_parse_string
+ */
+int
+clixon_cbor_parse_buf(const char *buf,
+                      size_t      len,
+                      yang_bind   yb,
+                      yang_stmt  *yspec,
+                      cxobj     **xt,
+                      cxobj     **xerr)
+{
+    int              retval = -1;
+    struct cbor_dec  cd = {0,};
+    clixon_json_yacc jy = {0,};
+    int              major;
+    int              info;
+    uint64_t         n;
+    int              created = 0;
+    int              ret;
+
+    if (xt == NULL || buf == NULL){
+        clicon_err(OE_XML, EINVAL, "arg is NULL");
+        return -1;
+    }
+    if (yb != YB_NONE && yspec == NULL){
+        clicon_err(OE_XML, EINVAL, "yspec is required if yb is not none");
+        return -1;
+    }
+    if (*xt == NULL){
+        if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        created++;
+    }
+    cd.cd_buf = (const uint8_t*)buf;
+    cd.cd_len = len;
+    if (cbor_get_head(&cd, &major, &info, &n) < 0)
+        goto done;
+    if (major != CBOR_MAP){
+        clicon_err(OE_XML, EFAULT, "CBOR top-level item is not a map");
+        goto done;
+    }
+    jy.jy_xtop = *xt;
+    jy.jy_current = *xt;
+    jy.jy_yspec = yspec;
+    jy.jy_rfc7951 = yspec?1:0;
+    jy.jy_yb = yb;
+    if (cbor_decode_map(&cd, *xt, info, n, &jy) < 0)
+        goto done;
+    if (cd.cd_pos != cd.cd_len){
+        clicon_err(OE_XML, EFAULT, "CBOR trailing data at %zu", cd.cd_pos);
+        goto done;
+    }
+    /* Translate module names to namespaces and bind yang, as JSON */
+    if ((ret = json_parse_bind(&jy, 0, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    retval = 1;
+ done:
+    if (retval < 0 && created && *xt){
+        xml_free(*xt);
+        *xt = NULL;
+    }
+    if (jy.jy_xvec)
+        free(jy.jy_xvec);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Read an XML tree in YANG-CBOR from a file
+ *
+ * A regular file is mapped into memory and decoded directly.
+ * Other streams, eg pipes or decompressing streams, are first read to a buffer.
+ * @param[in]     f     File in CBOR, eg written by clixon_xml2cbor_file
+ * @param[in]     yb    How to bind yang to XML top-level when parsing
+ * @param[in]     yspec Yang specification, or NULL
+ * @param[in,out] xt    Pointer to XML parse tree. If empty will be created.
+ * @param[out]    xerr  Reason for failure (yang assignment not made) if retval = 0
+ * @retval        1     Parse OK and all yang assignment made
+ * @retval        0     Parse OK but yang assigment not made (or only partial), xerr is set
+ * @retval       -1     Error with clicon_err called. Includes malformed file
+ * @see clixon_binary_parse_file
+ */
+int
+clixon_cbor_parse_file(FILE      *f,
+                       yang_bind  yb,
+                       yang_stmt *yspec,
+                       cxobj    **xt,
+                       cxobj    **xerr)
+{
+    int          retval = -1;
+    struct stat  st;
+    void        *buf = MAP_FAILED;
+    cbuf        *cbr = NULL;
+    char         rbuf[BUFSIZ];
+    size_t       n;
+    int          regular = 0;
+
+    if (xt == NULL || f == NULL){
+        clicon_err(OE_XML, EINVAL, "arg is NULL");
+        return -1;
+    }
+    if (fileno(f) >= 0){
+        if (fstat(fileno(f), &st) < 0){
+            clicon_err(OE_UNIX, errno, "fstat");
+            goto done;
+        }
+        regular = S_ISREG(st.st_mode);
+    }
+    if (!regular){
+        /* Not a regular file, eg a pipe or decompressing stream: read it to a buffer */
+        if ((cbr = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        while ((n = fread(rbuf, 1, sizeof(rbuf), f)) > 0)
+            if (cbuf_append_buf(cbr, rbuf, n) < 0){
+                clicon_err(OE_XML, errno, "cbuf_append_buf");
+                goto done;
+            }
+        if (ferror(f)){
+            clicon_err(OE_UNIX, errno, "fread");
+            goto done;
+        }
+        if (cbuf_len(cbr) == 0)
+            goto empty;
+        retval = clixon_cbor_parse_buf(cbuf_get(cbr), cbuf_len(cbr), yb, yspec, xt, xerr);
+    }
+    else {
+        if (st.st_size == 0) /* Empty file, eg newly created datastore */
+            goto empty;
+        if ((buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0)) == MAP_FAILED){
+            clicon_err(OE_UNIX, errno, "mmap");
+            goto done;
+        }
+        retval = clixon_cbor_parse_buf(buf, st.st_size, yb, yspec, xt, xerr);
+    }
+ done:
+    if (buf != MAP_FAILED)
+        munmap(buf, st.st_size);
+    if (cbr)
+        cbuf_free(cbr);
+    return retval;
+ empty:
+    if (*xt == NULL &&
+        (*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    retval = 1;
+    goto done;
+}
@@ -37,6 +37,7 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <syslog.h>
 #include <string.h>
@@ -57,6 +58,7 @@
 #include "clixon_err.h"
 #include "clixon_yang.h"
 #include "clixon_options.h"
+#include "clixon_event.h"
 #include "clixon_proc.h"
 #include "clixon_xml.h"
 #include "clixon_xml_nsctx.h"
@@ -64,6 +66,7 @@
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
 #include "clixon_netconf_lib.h"
+#include "clixon_stream.h"
 #include "clixon_proto.h"
 #include "clixon_proto_client.h"
 #include "clixon_client.h"
@@ -89,6 +92,40 @@ struct clixon_client_handle{
     char              *cch_descr;  /* Description of socket / peer for logging  XXX NYI */
     int                cch_pid;    /* Sub-process-id Only applies for NETCONF/SSH */
     int                cch_locked; /* State variable: 1 means locked */
+    struct clixon_client_pending *cch_pending; /* Outstanding asynchronous requests, in send order */
+    cbuf              *cch_rbuf;   /* Received data of asynchronous replies not yet dispatched */
+    clicon_handle      cch_h;      /* Clixon handle of connect */
+    char              *cch_dest;   /* Destination of connect, if any */
+    clicon_hash_t     *cch_cache;  /* Read cache of values, key is namespace and xpath */
+    struct clixon_client_handle *cch_cache_sub; /* Session subscribed to datastore changes */
+};
+
+/*! Cached value of an xpath, stored by value in the read cache
+ */
+struct clixon_client_cached{
+    char              *cc_top;     /* Name of top-level node of value */
+    char              *cc_value;   /* Cached body value */
+};
+
+/*! Outstanding asynchronous batch request waiting for its reply
+ */
+struct clixon_client_pending{
+    qelem_t            cp_qelem;   /* List header */
+    char              *cp_namespace; /* Default namespace of xpaths */
+    char             **cp_xpaths;  /* Vector of xpaths */
+    int                cp_n;       /* Length of xpath vector */
+    clixon_client_cb  *cp_fn;      /* Completion callback */
+    void              *cp_arg;     /* Callback argument */
+};
+
+/*! Result set of a batch request
+ *
+ * The data tree is the reply, the vector points to the values in it
+ */
+struct clixon_client_result{
+    cxobj            *cr_xdata;    /* Returned data tree */
+    cxobj           **cr_vec;      /* Bottom node of each xpath, NULL if not found */
+    int               cr_len;      /* Length of vector, same as xpaths of request */
 };
 
 /*! Check struct magic number for sanity checks
@@ -339,6 +376,27 @@ clixon_client_connect_ssh(clicon_handle                h,
     return retval;
 }
 
+/*! Free an asynchronous request
+ *
+ * @param[in]  cp   Pending request
+ */
+static int
+clixon_client_pending_free(struct clixon_client_pending *cp)
+{
+    int i;
+
+    if (cp->cp_namespace)
+        free(cp->cp_namespace);
+    if (cp->cp_xpaths){
+        for (i=0; i<cp->cp_n; i++)
+            if (cp->cp_xpaths[i])
+                free(cp->cp_xpaths[i]);
+        free(cp->cp_xpaths);
+    }
+    free(cp);
+    return 0;
+}
+
 /*! Connect client to clixon backend according to config and return a socket
  *
  * @param[in]  h        Clixon handle
@@ -364,6 +422,11 @@ clixon_client_connect(clicon_handle      h,
     memset(cch, 0, sz);
     cch->cch_magic   = CLIXON_CLIENT_MAGIC;
     cch->cch_type = socktype;
+    cch->cch_h = h;
+    if (dest && (cch->cch_dest = strdup(dest)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto err;
+    }
     switch (socktype){
     case CLIXON_CLIENT_IPC:
         if (clicon_rpc_connect(h, &cch->cch_socket) < 0)
@@ -404,8 +467,9 @@ clixon_client_connect(clicon_handle      h,
 int
 clixon_client_disconnect(clixon_client_handle ch)
 {
-    int                          retval = -1;
-    struct clixon_client_handle *cch = chandle(ch);
+    int                           retval = -1;
+    struct clixon_client_handle  *cch = chandle(ch);
+    struct clixon_client_pending *cp;
     
     clicon_debug(1, "%s", __FUNCTION__);
     if (cch == NULL){
@@ -427,6 +491,16 @@ clixon_client_disconnect(clixon_client_handle ch)
             goto done;
         break;
     }
+    while ((cp = cch->cch_pending) != NULL){
+        DELQ(cp, cch->cch_pending, struct clixon_client_pending *);
+        clixon_client_pending_free(cp);
+    }
+    if (cch->cch_rbuf)
+        cbuf_free(cch->cch_rbuf);
+    if (cch->cch_cache)
+        (void)clixon_client_cache_disable(ch);
+    if (cch->cch_dest)
+        free(cch->cch_dest);
     free(cch);
     retval = 0;
  done:
@@ -467,42 +541,24 @@ clixon_xml_bottom(cxobj  *xtop,
     return retval;
 }
 
-/*! Internal function to construct a get-config and query a value from the backend
+/*! Internal function to construct a get-config message
  *
- * @param[in]  sock      Socket
- * @param[in]  descr     Description of peer for logging
+ * @param[in]  msg       Message buffer
  * @param[in]  namespace Default namespace used for non-prefixed entries in xpath. (Alt use nsc)
  * @param[in]  xpath     XPath
- * @param[out] xdata     XML data tree (may or may not include the intended data)
  * @retval     0         OK
  * @retval    -1         Error
  * @note configurable netconf framing type, now hardwired to 0
  */
 static int
-clixon_client_get_xdata(int         sock,
-                        const char *descr,
-                        const char *namespace,
-                        const char *xpath,
-                        cxobj     **xdata)
+clixon_client_get_msg(cbuf       *msg,
+                      const char *namespace,
+                      const char *xpath)
 {
     int          retval = -1;
-    cxobj       *xret = NULL;
-    cxobj       *xd;
-    cbuf        *msg = NULL;
-    cbuf        *msgret = NULL;
     const char  *db = "running";
     cvec        *nsc = NULL; 
-    int          eof = 0;
-    
-    clicon_debug(1, "%s", __FUNCTION__);
-    if ((msg = cbuf_new()) == NULL){
-        clicon_err(OE_PLUGIN, errno, "cbuf_new");
-        goto done;
-    }
-    if ((msgret = cbuf_new()) == NULL){
-        clicon_err(OE_PLUGIN, errno, "cbuf_new");
-        goto done;
-    }
+
     cprintf(msg, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
     cprintf(msg, " xmlns:%s=\"%s\"",
             NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
@@ -522,21 +578,33 @@ clixon_client_get_xdata(int         sock,
     cprintf(msg, "</get-config></rpc>");
     if (netconf_output_encap(0, msg) < 0) // XXX configurable session
         goto done;
-    if (clicon_msg_send1(sock, descr, msg) < 0)
-        goto done;
-    if (clicon_msg_rcv1(sock, descr, msgret, &eof) < 0)
-        goto done;
-    if (eof){
-        close(sock);
-        clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
-        goto done;
-    }
-    if (clixon_xml_parse_string(cbuf_get(msgret), YB_NONE, NULL, &xret, NULL) < 0)
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Internal function to parse a get-config reply and extract the data
+ *
+ * @param[in]  reply     Reply string without framing
+ * @param[out] xdata     XML data tree, free with xml_free
+ * @retval     1         OK
+ * @retval     0         Reply is an rpc-error, error is logged
+ * @retval    -1         Error
+ */
+static int
+clixon_client_get_reply(const char *reply,
+                        cxobj     **xdata)
+{
+    int          retval = -1;
+    cxobj       *xret = NULL;
+    cxobj       *xd;
+
+    if (clixon_xml_parse_string(reply, YB_NONE, NULL, &xret, NULL) < 0)
         goto done;
     if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error")) != NULL){
         xd = xml_parent(xd); /* point to rpc-reply */
         clixon_netconf_error(xd, "Get config", NULL);
-        goto done; /* Not fatal */
+        goto fail;
     }
     else if ((xd = xpath_first(xret, NULL, "/rpc-reply/data")) == NULL){
         if ((xd = xml_new(NETCONF_OUTPUT_DATA, NULL, CX_ELMNT)) == NULL)
@@ -547,11 +615,66 @@ clixon_client_get_xdata(int         sock,
             goto done;
     }
     *xdata = xd;
-    retval = 0;
+    retval = 1;
  done:
-    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
     if (xret)
         xml_free(xret);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Internal function to construct a get-config and query a value from the backend
+ *
+ * @param[in]  sock      Socket
+ * @param[in]  descr     Description of peer for logging
+ * @param[in]  namespace Default namespace used for non-prefixed entries in xpath. (Alt use nsc)
+ * @param[in]  xpath     XPath
+ * @param[out] xdata     XML data tree (may or may not include the intended data)
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+clixon_client_get_xdata(int         sock,
+                        const char *descr,
+                        const char *namespace,
+                        const char *xpath,
+                        cxobj     **xdata)
+{
+    int          retval = -1;
+    cbuf        *msg = NULL;
+    cbuf        *msgret = NULL;
+    int          eof = 0;
+    int          ret;
+    
+    clicon_debug(1, "%s", __FUNCTION__);
+    if ((msg = cbuf_new()) == NULL){
+        clicon_err(OE_PLUGIN, errno, "cbuf_new");
+        goto done;
+    }
+    if ((msgret = cbuf_new()) == NULL){
+        clicon_err(OE_PLUGIN, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_client_get_msg(msg, namespace, xpath) < 0)
+        goto done;
+    if (clicon_msg_send1(sock, descr, msg) < 0)
+        goto done;
+    if (clicon_msg_rcv1(sock, descr, msgret, &eof) < 0)
+        goto done;
+    if (eof){
+        close(sock);
+        clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        goto done;
+    }
+    if ((ret = clixon_client_get_reply(cbuf_get(msgret), xdata)) < 0)
+        goto done;
+    if (ret == 0)
+        goto done; /* Not fatal */
+    retval = 0;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
     if (msg)
         cbuf_free(msg);
     if (msgret)
@@ -559,33 +682,289 @@ clixon_client_get_xdata(int         sock,
     return retval;
 }
 
+/*! Internal function to read available data of framed messages from a socket
+ *
+ * @param[in]  s         Socket
+ * @param[in]  rbuf      Buffer of received data, appended to
+ * @retval     1         OK, data read or none available
+ * @retval     0         Socket closed
+ * @retval    -1         Error
+ * @see clixon_client_frame_get  to get complete messages
+ */
+static int
+clixon_client_frame_read(int   s,
+                         cbuf *rbuf)
+{
+    char    buf[BUFSIZ];
+    ssize_t len;
+
+    if ((len = read(s, buf, sizeof(buf))) < 0){
+        if (errno == EAGAIN || errno == EINTR)
+            return 1;
+        clicon_err(OE_UNIX, errno, "read");
+        return -1;
+    }
+    if (len == 0)
+        return 0;
+    if (cbuf_append_buf(rbuf, buf, len) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 1;
+}
+
+/*! Internal function to get and remove the first complete message of a receive buffer
+ *
+ * @param[in]  rbuf      Buffer of received data
+ * @param[out] msg       Message without framing, free with free
+ * @retval     1         OK, message returned
+ * @retval     0         No complete message in buffer
+ * @retval    -1         Error
+ * @note configurable netconf framing type, now hardwired to 0
+ */
+static int
+clixon_client_frame_get(cbuf  *rbuf,
+                        char **msg)
+{
+    int   retval = -1;
+    char *str;
+    char *rest = NULL;
+
+    if ((str = strstr(cbuf_get(rbuf), "]]>]]>")) == NULL)
+        return 0;
+    *str = '\0';
+    if ((rest = strdup(str + strlen("]]>]]>"))) == NULL ||
+        (*msg = strdup(cbuf_get(rbuf))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    cbuf_reset(rbuf);
+    cprintf(rbuf, "%s", rest);
+    retval = 1;
+ done:
+    if (rest)
+        free(rest);
+    return retval;
+}
+
+/*! Internal function to remove values from the read cache
+ *
+ * @param[in]  cch       Clixon client handle
+ * @param[in]  top       Remove values of this top-level node, or all if NULL
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+clixon_client_cache_invalidate(struct clixon_client_handle *cch,
+                               const char                  *top)
+{
+    int                          retval = -1;
+    char                       **keys = NULL;
+    size_t                       nkeys = 0;
+    struct clixon_client_cached *cc;
+    int                          i;
+
+    if (clicon_hash_keys(cch->cch_cache, &keys, &nkeys) < 0)
+        goto done;
+    for (i=0; i<nkeys; i++){
+        if ((cc = clicon_hash_value(cch->cch_cache, keys[i], NULL)) == NULL)
+            continue;
+        if (top && strcmp(top, cc->cc_top) != 0)
+            continue;
+        clicon_debug(1, "%s %s", __FUNCTION__, keys[i]);
+        free(cc->cc_top);
+        free(cc->cc_value);
+        if (clicon_hash_del(cch->cch_cache, keys[i]) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Internal function to look up a value in the read cache
+ *
+ * @param[in]  cch       Clixon client handle
+ * @param[in]  key       Namespace and xpath
+ * @param[out] val       Cached value, valid until invalidated
+ * @retval     1         Found
+ * @retval     0         Not found
+ */
+static int
+clixon_client_cache_get(struct clixon_client_handle *cch,
+                        const char                  *key,
+                        char                       **val)
+{
+    struct clixon_client_cached *cc;
+
+    if ((cc = clicon_hash_value(cch->cch_cache, key, NULL)) == NULL)
+        return 0;
+    *val = cc->cc_value;
+    return 1;
+}
+
+/*! Internal function to add a value to the read cache
+ *
+ * @param[in]     cch    Clixon client handle
+ * @param[in]     key    Namespace and xpath
+ * @param[in]     top    Name of top-level node of value
+ * @param[in,out] val    Value, replaced with the cached copy
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+clixon_client_cache_add(struct clixon_client_handle *cch,
+                        const char                  *key,
+                        const char                  *top,
+                        char                       **val)
+{
+    struct clixon_client_cached cc = {NULL, NULL};
+
+    if ((cc.cc_top = strdup(top)) == NULL ||
+        (cc.cc_value = strdup(*val)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto err;
+    }
+    if (clicon_hash_add(cch->cch_cache, key, &cc, sizeof(cc)) == NULL)
+        goto err;
+    *val = cc.cc_value;
+    return 0;
+ err:
+    if (cc.cc_top)
+        free(cc.cc_top);
+    if (cc.cc_value)
+        free(cc.cc_value);
+    return -1;
+}
+
+/*! Internal function to invalidate cached values from a datastore-changed notification
+ *
+ * Each subtree of the notification is a changed top-level node on the form /module:name
+ * @param[in]  cch       Clixon client handle
+ * @param[in]  msg       Notification message
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+clixon_client_cache_notify(struct clixon_client_handle *cch,
+                           const char                  *msg)
+{
+    int     retval = -1;
+    cxobj  *xt = NULL;
+    cxobj **vec = NULL;
+    size_t  veclen = 0;
+    char   *subtree;
+    char   *top;
+    int     i;
+
+    if (clixon_xml_parse_string(msg, YB_NONE, NULL, &xt, NULL) < 0)
+        goto done;
+    if (xpath_vec(xt, NULL, "notification/datastore-changed/subtree", &vec, &veclen) < 0)
+        goto done;
+    for (i=0; i<veclen; i++){
+        if ((subtree = xml_body(vec[i])) == NULL)
+            continue;
+        if ((top = strchr(subtree, ':')) != NULL)
+            top++; /* else unknown format, remove all */
+        if (clixon_client_cache_invalidate(cch, top) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Internal function to read datastore-changed notifications and invalidate the read cache
+ *
+ * Reads without blocking all notifications received so far. If the subscription session is
+ * closed, the cache is disabled and values are read from the server.
+ * @param[in]  cch       Clixon client handle
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+clixon_client_cache_sync(struct clixon_client_handle *cch)
+{
+    int                          retval = -1;
+    struct clixon_client_handle *sub = cch->cch_cache_sub;
+    char                        *msg = NULL;
+    int                          ret;
+
+    while ((ret = clixon_event_poll(sub->cch_socket)) > 0){
+        if ((ret = clixon_client_frame_read(sub->cch_socket, sub->cch_rbuf)) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_log(LOG_WARNING, "%s: datastore subscription closed, cache disabled", __FUNCTION__);
+            if (clixon_client_cache_disable(cch) < 0)
+                goto done;
+            break;
+        }
+        while ((ret = clixon_client_frame_get(sub->cch_rbuf, &msg)) == 1){
+            if (clixon_client_cache_notify(cch, msg) < 0)
+                goto done;
+            free(msg);
+            msg = NULL;
+        }
+        if (ret < 0)
+            goto done;
+    }
+    if (ret < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
+    return retval;
+}
+
 /*! Generic get value of body
  *
- * @param[in]  sock      Open socket
- * @param[in]  descr     Description of peer for logging
+ * If the read cache is enabled, the value is looked up in, or added to, the cache
+ * @param[in]  cch       Clixon client handle
  * @param[in]  namespace Default namespace used for non-prefixed entries in xpath.
  * @param[in]  xpath     XPath
  * @param[out] val       Output value
  * @retval     0         OK
  * @retval    -1         Error
+ * @see clixon_client_cache_enable
  */
 static int
-clixon_client_get_body_val(int         sock,
-                           const char *descr,
-                           const char *namespace,
-                           const char *xpath,
-                           char      **val)
+clixon_client_get_body_val(struct clixon_client_handle *cch,
+                           const char                  *namespace,
+                           const char                  *xpath,
+                           char                       **val)
 {
     int    retval = -1;
     cxobj *xdata = NULL;
     cxobj *xobj = NULL;
+    cbuf  *key = NULL;
+    int    ret;
     
     clicon_debug(1, "%s", __FUNCTION__);
     if (val == NULL){
         clicon_err(OE_XML, EINVAL, "Expected val");
         goto done;
     }
-    if (clixon_client_get_xdata(sock, descr, namespace, xpath, &xdata) < 0)
+    if (cch->cch_cache && clixon_client_cache_sync(cch) < 0)
+        goto done;
+    if (cch->cch_cache){ /* May be disabled by sync */
+        if ((key = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(key, "%s %s", namespace, xpath);
+        if ((ret = clixon_client_cache_get(cch, cbuf_get(key), val)) < 0)
+            goto done;
+        if (ret == 1)
+            goto ok;
+    }
+    if (clixon_client_get_xdata(cch->cch_socket, cch->cch_descr, namespace, xpath, &xdata) < 0)
         goto done;
     if (xdata == NULL){
         clicon_err(OE_XML, EINVAL, "No xml obj found"); 
@@ -603,9 +982,21 @@ clixon_client_get_body_val(int         sock,
         goto done;
     }
     *val = xml_body(xobj);
+    if (cch->cch_cache && *val != NULL){
+        if (clixon_client_cache_add(cch, cbuf_get(key),
+                                    xml_name(xml_child_i_type(xdata, 0, CX_ELMNT)), val) < 0)
+            goto done;
+        xml_free(xdata);
+        xdata = NULL;
+    }
+ ok:
     retval = 0;
  done:
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (key)
+        cbuf_free(key);
+    if (retval < 0 && xdata)
+        xml_free(xdata);
     return retval;
 }
 
@@ -632,8 +1023,7 @@ clixon_client_get_bool(clixon_client_handle ch,
     uint8_t                      val0=0;
     
     clicon_debug(1, "%s", __FUNCTION__);
-    if (clixon_client_get_body_val(cch->cch_socket, cch->cch_descr,
-                                   namespace, xpath, &val) < 0)
+    if (clixon_client_get_body_val(cch, namespace, xpath, &val) < 0)
         goto done;
     if ((ret = parse_bool(val, &val0, &reason)) < 0){
         clicon_err(OE_XML, errno, "parse_bool"); 
@@ -673,8 +1063,7 @@ clixon_client_get_str(clixon_client_handle ch,
     char                        *val = NULL;
     
     clicon_debug(1, "%s", __FUNCTION__);
-    if (clixon_client_get_body_val(cch->cch_socket, cch->cch_descr,
-                                   namespace, xpath, &val) < 0)
+    if (clixon_client_get_body_val(cch, namespace, xpath, &val) < 0)
         goto done;
     strncpy(rval, val, n-1);
     rval[n-1]= '\0';
@@ -705,8 +1094,7 @@ clixon_client_get_uint8(clixon_client_handle ch,
     int                          ret;
     
     clicon_debug(1, "%s", __FUNCTION__);
-    if (clixon_client_get_body_val(cch->cch_socket, cch->cch_descr,
-                                   namespace, xpath, &val) < 0)
+    if (clixon_client_get_body_val(cch, namespace, xpath, &val) < 0)
         goto done;
     if ((ret = parse_uint8(val, rval, &reason)) < 0){
         clicon_err(OE_XML, errno, "parse_bool"); 
@@ -745,8 +1133,7 @@ clixon_client_get_uint16(clixon_client_handle ch,
     int                          ret;
     
     clicon_debug(1, "%s", __FUNCTION__);
-    if (clixon_client_get_body_val(cch->cch_socket, cch->cch_descr,
-                                   namespace, xpath, &val) < 0)
+    if (clixon_client_get_body_val(cch, namespace, xpath, &val) < 0)
         goto done;
     if ((ret = parse_uint16(val, rval, &reason)) < 0){
         clicon_err(OE_XML, errno, "parse_bool"); 
@@ -785,8 +1172,7 @@ clixon_client_get_uint32(clixon_client_handle ch,
     int                          ret;
 
     clicon_debug(1, "%s", __FUNCTION__);
-    if (clixon_client_get_body_val(cch->cch_socket, cch->cch_descr,
-                                   namespace, xpath, &val) < 0)
+    if (clixon_client_get_body_val(cch, namespace, xpath, &val) < 0)
         goto done;
     if (val == NULL){
         clicon_err(OE_XML, EFAULT, "val is NULL"); 
@@ -830,8 +1216,7 @@ clixon_client_get_uint64(clixon_client_handle  ch,
     int                          ret;
     
     clicon_debug(1, "%s", __FUNCTION__);
-    if (clixon_client_get_body_val(cch->cch_socket, cch->cch_descr,
-                                   namespace, xpath, &val) < 0)
+    if (clixon_client_get_body_val(cch, namespace, xpath, &val) < 0)
         goto done;
     if ((ret = parse_uint64(val, rval, &reason)) < 0){
         clicon_err(OE_XML, errno, "parse_bool"); 
@@ -848,6 +1233,487 @@ clixon_client_get_uint64(clixon_client_handle  ch,
     return retval;
 }
 
+/*! Internal function to join xpaths of a batch to one union xpath
+ *
+ * @param[in]  xpaths    Vector of xpaths
+ * @param[in]  n         Length of xpath vector
+ * @param[out] cb        Union xpath, eg "a | b"
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+clixon_client_batch_xpath(const char **xpaths,
+                          int          n,
+                          cbuf        *cb)
+{
+    int i;
+
+    if (n <= 0){
+        clicon_err(OE_XML, EINVAL, "Expected at least one xpath");
+        return -1;
+    }
+    for (i=0; i<n; i++){
+        if (xpaths[i] == NULL || strlen(xpaths[i]) == 0){
+            clicon_err(OE_XML, EINVAL, "Expected xpath %d", i);
+            return -1;
+        }
+        cprintf(cb, "%s%s", i?" | ":"", xpaths[i]);
+    }
+    return 0;
+}
+
+/*! Internal function to create a result set from the data of a batch reply
+ *
+ * Each xpath is evaluated on the data tree of the reply.
+ * @param[in]  xdata     XML data tree, consumed by the result also on error
+ * @param[in]  namespace Default namespace used for non-prefixed entries in xpath.
+ * @param[in]  xpaths    Vector of xpaths
+ * @param[in]  n         Length of xpath vector
+ * @param[out] crp       Result set, free with clixon_client_result_free
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+clixon_client_result_new(cxobj                        *xdata,
+                         const char                   *namespace,
+                         const char                  **xpaths,
+                         int                           n,
+                         struct clixon_client_result **crp)
+{
+    int                          retval = -1;
+    struct clixon_client_result *cr = NULL;
+    cvec                        *nsc = NULL;
+    cxobj                       *x;
+    int                          i;
+
+    if ((cr = malloc(sizeof(*cr))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        xml_free(xdata);
+        goto done;
+    }
+    memset(cr, 0, sizeof(*cr));
+    cr->cr_xdata = xdata;
+    if ((cr->cr_vec = calloc(n, sizeof(cxobj *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    cr->cr_len = n;
+    if ((nsc = xml_nsctx_init(NULL, (char*)namespace)) == NULL)
+        goto done;
+    for (i=0; i<n; i++){
+        if ((x = xpath_first(xdata, nsc, "%s", xpaths[i])) == NULL)
+            continue;
+        if (clixon_xml_bottom(x, &cr->cr_vec[i]) < 0)
+            goto done;
+    }
+    *crp = cr;
+    cr = NULL;
+    retval = 0;
+ done:
+    if (cr)
+        clixon_client_result_free(cr);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+}
+
+/*! Client-api get many values in one request
+ *
+ * All xpaths are requested in one get-config and the values are looked up in the reply.
+ * An xpath not matching any data gives a NULL value in the result set.
+ * @param[in]  ch        Clixon client handle
+ * @param[in]  namespace Default namespace used for non-prefixed entries in xpaths.
+ * @param[in]  xpaths    Vector of xpaths
+ * @param[in]  n         Length of xpath vector
+ * @param[out] crp       Result set, free with clixon_client_result_free
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @code
+ *   const char          *xpaths[] = {"/table/parameter[name='a']/value", "/table/parameter[name='b']/value"};
+ *   clixon_client_result cr = NULL;
+ *
+ *   if (clixon_client_get_batch(ch, "urn:example:clixon-client", xpaths, 2, &cr) < 0)
+ *      err;
+ *   printf("%s\n", clixon_client_result_str(cr, 1));
+ *   clixon_client_result_free(cr);
+ * @endcode
+ * @see clixon_client_get_batch_async  Asynchronous variant
+ */
+int
+clixon_client_get_batch(clixon_client_handle  ch,
+                        const char           *namespace,
+                        const char          **xpaths,
+                        int                   n,
+                        clixon_client_result *crp)
+{
+    int                          retval = -1;
+    struct clixon_client_handle *cch = chandle(ch);
+    cbuf                        *cb = NULL;
+    cxobj                       *xdata = NULL;
+    
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (cch->cch_pending != NULL){
+        clicon_err(OE_PROTO, EBUSY, "Asynchronous requests pending");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_client_batch_xpath(xpaths, n, cb) < 0)
+        goto done;
+    if (clixon_client_get_xdata(cch->cch_socket, cch->cch_descr,
+                                namespace, cbuf_get(cb), &xdata) < 0)
+        goto done;
+    if (clixon_client_result_new(xdata, namespace, xpaths, n,
+                                 (struct clixon_client_result **)crp) < 0)
+        goto done;
+    retval = 0;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Client-api send a batch request without waiting for the reply
+ *
+ * The reply is received by clixon_client_async_dispatch when the socket of the client
+ * (see clixon_client_socket_get) is readable, which calls fn with the result set.
+ * Several requests may be outstanding, replies are dispatched in send order.
+ * @param[in]  ch        Clixon client handle
+ * @param[in]  namespace Default namespace used for non-prefixed entries in xpaths.
+ * @param[in]  xpaths    Vector of xpaths, copied
+ * @param[in]  n         Length of xpath vector
+ * @param[in]  fn        Completion callback
+ * @param[in]  arg       Argument to callback
+ * @retval     0         OK, request sent
+ * @retval    -1         Error
+ * @see clixon_client_get_batch  Synchronous variant
+ */
+int
+clixon_client_get_batch_async(clixon_client_handle ch,
+                              const char          *namespace,
+                              const char         **xpaths,
+                              int                  n,
+                              clixon_client_cb    *fn,
+                              void                *arg)
+{
+    int                           retval = -1;
+    struct clixon_client_handle  *cch = chandle(ch);
+    struct clixon_client_pending *cp = NULL;
+    cbuf                         *cb = NULL;
+    cbuf                         *msg = NULL;
+    int                           i;
+    
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (namespace == NULL || fn == NULL){
+        clicon_err(OE_XML, EINVAL, "Expected namespace and callback");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL ||
+        (msg = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_client_batch_xpath(xpaths, n, cb) < 0)
+        goto done;
+    if ((cp = malloc(sizeof(*cp))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(cp, 0, sizeof(*cp));
+    cp->cp_fn = fn;
+    cp->cp_arg = arg;
+    if ((cp->cp_namespace = strdup(namespace)) == NULL ||
+        (cp->cp_xpaths = calloc(n, sizeof(char *))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    cp->cp_n = n;
+    for (i=0; i<n; i++)
+        if ((cp->cp_xpaths[i] = strdup(xpaths[i])) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    if (cch->cch_rbuf == NULL &&
+        (cch->cch_rbuf = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_client_get_msg(msg, namespace, cbuf_get(cb)) < 0)
+        goto done;
+    if (clicon_msg_send1(cch->cch_socket, cch->cch_descr, msg) < 0)
+        goto done;
+    ADDQ(cp, cch->cch_pending);
+    cp = NULL;
+    retval = 0;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (cp)
+        clixon_client_pending_free(cp);
+    if (cb)
+        cbuf_free(cb);
+    if (msg)
+        cbuf_free(msg);
+    return retval;
+}
+
+/*! Client-api read and dispatch replies of asynchronous requests
+ *
+ * Call when the socket of the client is readable. Reads what is available on the socket
+ * and calls the callback of each completed request. If the reply is an error, the callback
+ * is called with a NULL result set.
+ * @param[in]  ch        Clixon client handle
+ * @retval     n         Number of dispatched replies, may be 0 if a reply is not complete
+ * @retval    -1         Error, including error of a callback
+ */
+int
+clixon_client_async_dispatch(clixon_client_handle ch)
+{
+    int                           retval = -1;
+    struct clixon_client_handle  *cch = chandle(ch);
+    struct clixon_client_pending *cp = NULL;
+    clixon_client_result          cr;
+    cxobj                        *xdata;
+    char                         *msg = NULL;
+    int                           nr = 0;
+    int                           ret;
+    
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (cch->cch_pending == NULL){
+        clicon_err(OE_PROTO, EINVAL, "No asynchronous request pending");
+        goto done;
+    }
+    if ((ret = clixon_client_frame_read(cch->cch_socket, cch->cch_rbuf)) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        goto done;
+    }
+    while (cch->cch_pending != NULL &&
+           (ret = clixon_client_frame_get(cch->cch_rbuf, &msg)) == 1){
+        clicon_debug(CLIXON_DBG_MSG, "Recv [%s]: %s", cch->cch_descr, msg);
+        cp = cch->cch_pending;
+        DELQ(cp, cch->cch_pending, struct clixon_client_pending *);
+        cr = NULL;
+        xdata = NULL;
+        if ((ret = clixon_client_get_reply(msg, &xdata)) < 0)
+            goto done;
+        free(msg);
+        msg = NULL;
+        if (ret == 1 &&
+            clixon_client_result_new(xdata, cp->cp_namespace, (const char **)cp->cp_xpaths,
+                                     cp->cp_n, (struct clixon_client_result **)&cr) < 0)
+            goto done;
+        ret = cp->cp_fn(ch, cr, cp->cp_arg);
+        if (cr)
+            clixon_client_result_free(cr);
+        if (ret < 0)
+            goto done;
+        clixon_client_pending_free(cp);
+        cp = NULL;
+        nr++;
+    }
+    if (ret < 0)
+        goto done;
+    retval = nr;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (cp)
+        clixon_client_pending_free(cp);
+    if (msg)
+        free(msg);
+    return retval;
+}
+
+/*! Client-api number of asynchronous requests waiting for reply
+ *
+ * @param[in]  ch     Clixon client handle
+ * @retval     n      Number of pending requests
+ */
+int
+clixon_client_async_pending(clixon_client_handle ch)
+{
+    struct clixon_client_handle  *cch = chandle(ch);
+    struct clixon_client_pending *cp;
+    int                           n = 0;
+
+    if ((cp = cch->cch_pending) != NULL)
+        do {
+            n++;
+            cp = NEXTQ(struct clixon_client_pending *, cp);
+        } while (cp && cp != cch->cch_pending);
+    return n;
+}
+
+/*! Client-api enable the read cache of a client session
+ *
+ * Values read with the clixon_client_get_* functions are cached in the client and read
+ * from local memory the next time. A second session subscribes to the CLIXON-DATASTORE
+ * stream of the server. Cached values of a changed top-level node are removed when its
+ * datastore-changed notification is received.
+ * Notifications are read at each get, a change is therefore seen as soon as its
+ * notification has arrived, ie shortly after the commit.
+ * The server must have CLICON_STREAM_DATASTORE set.
+ * @param[in]  ch        Clixon client handle
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @note clixon_client_get_batch and its asynchronous variant do not use the cache
+ * @see clixon_client_cache_disable
+ */
+int
+clixon_client_cache_enable(clixon_client_handle ch)
+{
+    int                          retval = -1;
+    struct clixon_client_handle *cch = chandle(ch);
+    struct clixon_client_handle *sub = NULL;
+    cbuf                        *msg = NULL;
+    char                        *reply = NULL;
+    cxobj                       *xret = NULL;
+    cxobj                       *xd;
+    int                          ret;
+    
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (cch->cch_cache != NULL)
+        goto ok;
+    if ((sub = clixon_client_connect(cch->cch_h, cch->cch_type, cch->cch_dest)) == NULL)
+        goto done;
+    if (cch->cch_type != CLIXON_CLIENT_IPC &&
+        clixon_client_hello(sub->cch_socket, sub->cch_descr, 0) < 0)
+        goto done;
+    if ((msg = cbuf_new()) == NULL ||
+        (sub->cch_rbuf = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(msg, "<rpc xmlns=\"%s\" %s>"
+            "<create-subscription xmlns=\"%s\"><stream>%s</stream></create-subscription></rpc>",
+            NETCONF_BASE_NAMESPACE,
+            NETCONF_MESSAGE_ID_ATTR,
+            EVENT_RFC5277_NAMESPACE,
+            CLIXON_DATASTORE_STREAM);
+    if (netconf_output_encap(0, msg) < 0) // XXX configurable session
+        goto done;
+    if (clicon_msg_send1(sub->cch_socket, sub->cch_descr, msg) < 0)
+        goto done;
+    while ((ret = clixon_client_frame_get(sub->cch_rbuf, &reply)) == 0){
+        if ((ret = clixon_client_frame_read(sub->cch_socket, sub->cch_rbuf)) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+            goto done;
+        }
+    }
+    if (ret < 0)
+        goto done;
+    if (clixon_xml_parse_string(reply, YB_NONE, NULL, &xret, NULL) < 0)
+        goto done;
+    if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error")) != NULL){
+        xd = xml_parent(xd); /* point to rpc-reply */
+        clixon_netconf_error(xd, "Create subscription", NULL);
+        goto done;
+    }
+    if ((cch->cch_cache = clicon_hash_init()) == NULL)
+        goto done;
+    cch->cch_cache_sub = sub;
+    sub = NULL;
+ ok:
+    retval = 0;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (sub)
+        clixon_client_disconnect(sub);
+    if (xret)
+        xml_free(xret);
+    if (reply)
+        free(reply);
+    if (msg)
+        cbuf_free(msg);
+    return retval;
+}
+
+/*! Client-api disable the read cache of a client session
+ *
+ * Cached values are removed and the subscription session is closed
+ * @param[in]  ch        Clixon client handle
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @see clixon_client_cache_enable
+ */
+int
+clixon_client_cache_disable(clixon_client_handle ch)
+{
+    int                          retval = -1;
+    struct clixon_client_handle *cch = chandle(ch);
+    
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (cch->cch_cache == NULL)
+        goto ok;
+    if (clixon_client_cache_invalidate(cch, NULL) < 0)
+        goto done;
+    clicon_hash_free(cch->cch_cache);
+    cch->cch_cache = NULL;
+    if (cch->cch_cache_sub){
+        if (clixon_client_disconnect(cch->cch_cache_sub) < 0)
+            goto done;
+        cch->cch_cache_sub = NULL;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/* Result set functions */
+/*! Number of values in a result set, same as number of xpaths of the request
+ *
+ * @param[in]  cr     Result set
+ * @retval     n      Number of values
+ */
+int
+clixon_client_result_len(clixon_client_result cr)
+{
+    return ((struct clixon_client_result *)cr)->cr_len;
+}
+
+/*! Value of an xpath in a result set
+ *
+ * @param[in]  cr     Result set
+ * @param[in]  i      Index of xpath in request
+ * @retval     str    Value, valid until result set is freed
+ * @retval     NULL   No data matching xpath, or index out of range
+ */
+char *
+clixon_client_result_str(clixon_client_result cr,
+                         int                  i)
+{
+    struct clixon_client_result *r = (struct clixon_client_result *)cr;
+
+    if (i < 0 || i >= r->cr_len || r->cr_vec[i] == NULL)
+        return NULL;
+    return xml_body(r->cr_vec[i]);
+}
+
+/*! Free a result set
+ *
+ * @param[in]  cr     Result set
+ */
+int
+clixon_client_result_free(clixon_client_result cr)
+{
+    struct clixon_client_result *r = (struct clixon_client_result *)cr;
+
+    if (r == NULL)
+        return 0;
+    if (r->cr_xdata)
+        xml_free(r->cr_xdata);
+    if (r->cr_vec)
+        free(r->cr_vec);
+    free(r);
+    return 0;
+}
+
 /* Access functions */
 /*! Client-api get uint64
  *
@@ -77,6 +77,9 @@
 #include "clixon_xpath.h"
 #include "clixon_data.h"
 
+/* Last generation of database elements, unique for all databases, see clicon_db_elmnt_set */
+static uint64_t _db_elmnt_gen = 0;
+
 /*! Get generic clixon data on the form <name>=<val> where <val> is string
  * @param[in]  h    Clicon handle
  * @param[in]  name Data name
@@ -847,6 +850,8 @@ clicon_db_elmnt_get(clicon_handle h,
 }
 
 /*! Set xml database element including id, xml cache, empty on startup and dirty bit
+ *
+ * The element gets a new generation, see de_gen
  * @param[in] h   Clicon handle
  * @param[in] db  Name of database
  * @param[in] de  Database element
@@ -861,6 +866,7 @@ clicon_db_elmnt_set(clicon_handle h,
 {
     clicon_hash_t  *cdat = clicon_db_elmnt(h);
 
+    de->de_gen = ++_db_elmnt_gen;
     if (clicon_hash_add(cdat, db, de, sizeof(*de))==NULL)
         return -1;
     return 0;
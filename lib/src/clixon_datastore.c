@@ -71,6 +71,7 @@
 #include "clixon_file.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
+#include "clixon_xml_map.h"
 #include "clixon_yang_module.h"
 #include "clixon_plugin.h"
 #include "clixon_options.h"
@@ -79,7 +80,17 @@
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
+#include "clixon_datastore_journal.h"
+#include "clixon_datastore_split.h"
 
+/* Last content version of datastores, see xmldb_version_bump */
+static uint64_t _xmldb_version = 0;
+
+/* Last cache access sequence number, see xmldb_cache_touch */
+static uint64_t _xmldb_cache_atime = 0;
+
+/* Number of evicted datastore caches, see xmldb_cache_evict */
+static uint64_t _xmldb_cache_evictions = 0;
 
 /*! Translate from symbolic database name to actual filename in file-system
  *
@@ -122,6 +133,44 @@ xmldb_db2file(clicon_handle  h,
     return retval;
 }
 
+/*! Translate from symbolic database name to split datastore directory
+ *
+ * The directory contains one file per top-level YANG module, see CLICON_XMLDB_SPLIT
+ * @param[in]   h        Clicon handle
+ * @param[in]   db       Symbolic database name, eg "candidate", "running"
+ * @param[out]  dir      Directory name, free after use
+ * @retval      0        OK
+ * @retval     -1        Error
+ */
+int
+xmldb_db2dir(clicon_handle  h, 
+             const char    *db,
+             char         **dir)
+{
+    int   retval = -1;
+    char *dbfile = NULL;
+    cbuf *cb = NULL;
+
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s.d", dbfile);
+    if ((*dir = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (dbfile)
+        free(dbfile);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Connect to a datastore plugin, allocate resources to be used in API calls
  *
  * @param[in]  h    Clicon handle
@@ -149,6 +198,13 @@ xmldb_disconnect(clicon_handle h)
     int       i;
     db_elmnt *de;
     
+    /* Pending writes are made durable before the cache is freed */
+    if (xmldb_async_exit(h) < 0)
+        clicon_log(LOG_WARNING, "%s: %s", __FUNCTION__, clicon_err_reason);
+    if (xmldb_snapshot_exit(h) < 0)
+        clicon_log(LOG_WARNING, "%s: %s", __FUNCTION__, clicon_err_reason);
+    if (xmldb_prefetch_exit(h) < 0)
+        clicon_log(LOG_WARNING, "%s: %s", __FUNCTION__, clicon_err_reason);
     if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
         goto done;
     for(i = 0; i < klen; i++) 
@@ -165,29 +221,27 @@ xmldb_disconnect(clicon_handle h)
     return retval;
 }
 
-/*! Copy database from db1 to db2
+/*! Copy in-memory cache of database from db1 to db2, not the file itself
  *
  * @param[in]  h     Clicon handle
  * @param[in]  from  Source database
  * @param[in]  to    Destination database
  * @retval     0     OK
  * @retval    -1     Error
-  */
-int 
-xmldb_copy(clicon_handle h, 
-           const char   *from, 
-           const char   *to)
+ * @see xmldb_copy
+ */
+int
+xmldb_copy_cache(clicon_handle h, 
+                 const char   *from, 
+                 const char   *to)
 {
     int                 retval = -1;
-    char               *fromfile = NULL;
-    char               *tofile = NULL;
     db_elmnt           *de1 = NULL; /* from */
     db_elmnt           *de2 = NULL; /* to */
     db_elmnt            de0 = {0,};
     cxobj              *x1 = NULL;  /* from */
     cxobj              *x2 = NULL;  /* to */
 
-    clicon_debug(1, "%s %s %s", __FUNCTION__, from, to);
     /* XXX lock */
     if (clicon_datastore_cache(h) != DATASTORE_NOCACHE){
         /* Copy in-memory cache */
@@ -210,13 +264,15 @@ xmldb_copy(clicon_handle h,
             if (xml_copy(x1, x2) < 0) 
                 goto done;
         }
-        else{ /* copy x1 to x2 */
-            xml_free(x2);
-            if ((x2 = xml_new(xml_name(x1), NULL, CX_ELMNT)) == NULL)
+        else if (xmldb_delta_get(h, to, from) == 1 ||
+                 xmldb_delta_get(h, from, to) == 1){ /* only edited parts differ */
+            if (xml_sync_dirty(x1, x2) < 0)
                 goto done;
-            xml_flag_set(x2, XML_FLAG_TOP);
-            if (xml_copy(x1, x2) < 0) 
+        }
+        else{ /* copy x1 to x2, keeping unchanged parts of x2 */
+            if (xml_sync(x1, x2) < 0)
                 goto done;
+            xml_flag_set(x2, XML_FLAG_TOP);
         }
         /* always set cache although not strictly necessary in case 1
          * above, but logic gets complicated due to differences with
@@ -224,9 +280,42 @@ xmldb_copy(clicon_handle h,
         if (de2)
             de0 = *de2;
         de0.de_xml = x2; /* The new tree */
+        de0.de_base = x2 ? de1->de_gen : 0;
+        xmldb_cache_touch(&de0);
     }
     clicon_db_elmnt_set(h, to, &de0);
+    if (xmldb_version_bump(h, to) < 0)
+        goto done;
+    if (xmldb_snapshot_write(h, to) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
 
+/*! Copy database from db1 to db2
+ *
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database
+ * @param[in]  to    Destination database
+ * @retval     0     OK
+ * @retval    -1     Error
+  */
+int 
+xmldb_copy(clicon_handle h, 
+           const char   *from, 
+           const char   *to)
+{
+    int                 retval = -1;
+    char               *fromfile = NULL;
+    char               *tofile = NULL;
+
+    clicon_debug(1, "%s %s %s", __FUNCTION__, from, to);
+    if (xmldb_async_barrier(h, from) < 0 ||
+        xmldb_async_barrier(h, to) < 0)
+        goto done;
+    if (xmldb_copy_cache(h, from, to) < 0)
+        goto done;
     /* Copy the files themselves (above only in-memory cache) */
     if (xmldb_db2file(h, from, &fromfile) < 0)
         goto done;
@@ -234,6 +323,10 @@ xmldb_copy(clicon_handle h,
         goto done;
     if (clicon_file_copy(fromfile, tofile) < 0)
         goto done;
+    if (xmldb_split_copy(h, from, to) < 0)
+        goto done;
+    if (xmldb_journal_copy(h, from, to) < 0)
+        goto done;
     retval = 0;
  done:
     if (fromfile)
@@ -442,6 +535,8 @@ xmldb_delete(clicon_handle h,
     struct stat         sb;
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s %s", __FUNCTION__, db);
+    if (xmldb_async_barrier(h, db) < 0)
+        goto done;
     if (xmldb_clear(h, db) < 0)
         goto done;
     if (xmldb_db2file(h, db, &filename) < 0)
@@ -451,6 +546,14 @@ xmldb_delete(clicon_handle h,
             clicon_err(OE_DB, errno, "truncate %s", filename);
             goto done;
         }
+    if (xmldb_split_remove(h, db) < 0)
+        goto done;
+    if (xmldb_journal_reset(h, db) < 0)
+        goto done;
+    if (xmldb_version_bump(h, db) < 0)
+        goto done;
+    if (xmldb_snapshot_write(h, db) < 0)
+        goto done;
     retval = 0;
  done:
     if (filename)
@@ -482,6 +585,8 @@ xmldb_create(clicon_handle h,
             de->de_xml = NULL;
         }
     }
+    if (xmldb_async_barrier(h, db) < 0)
+        goto done;
     if (xmldb_db2file(h, db, &filename) < 0)
         goto done;
     if ((fd = open(filename, O_CREAT|O_WRONLY, S_IRWXU)) == -1) {
@@ -535,6 +640,209 @@ xmldb_cache_get(clicon_handle h,
     return de->de_xml;
 }
 
+/*! Mark datastore cache as recently used
+ *
+ * @param[in]  de   Datastore element
+ * @retval     0    OK
+ * @see xmldb_cache_evict
+ */
+int
+xmldb_cache_touch(db_elmnt *de)
+{
+    de->de_atime = ++_xmldb_cache_atime;
+    return 0;
+}
+
+/*! Get size of a datastore cache, compute it if changed since last time
+ *
+ * @param[in]  de    Datastore element with cache
+ * @param[out] size  Size of cache in bytes
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xmldb_cache_de_size(db_elmnt *de,
+                    size_t   *size)
+{
+    uint64_t nr = 0;
+    size_t   sz = 0;
+
+    if (de->de_sizegen != de->de_gen){
+        if (xml_stats(de->de_xml, &nr, &sz) < 0)
+            return -1;
+        de->de_size = sz;
+        de->de_sizegen = de->de_gen;
+    }
+    *size = de->de_size;
+    return 0;
+}
+
+/*! Get size of the cache of one datastore
+ *
+ * The size is only computed if the cache has changed since last call
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Name of database
+ * @param[out] size  Size of cache in bytes, 0 if not cached
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_cache_stats  for all datastores
+ */
+int
+xmldb_cache_size(clicon_handle h,
+                 const char   *db,
+                 size_t       *size)
+{
+    db_elmnt *de;
+
+    *size = 0;
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL || de->de_xml == NULL)
+        return 0;
+    return xmldb_cache_de_size(de, size);
+}
+
+/*! Get datastore cache statistics
+ *
+ * Sizes of caches changed since last call are computed
+ * @param[in]  h          Clicon handle
+ * @param[out] size       Total size of datastore caches in bytes
+ * @param[out] evictions  Number of evicted datastore caches since start
+ * @retval     0          OK
+ * @retval    -1          Error
+ */
+int
+xmldb_cache_stats(clicon_handle h,
+                  size_t       *size,
+                  uint64_t     *evictions)
+{
+    int       retval = -1;
+    char    **keys = NULL;
+    size_t    klen;
+    db_elmnt *de;
+    size_t    sz;
+    int       i;
+
+    *size = 0;
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i = 0; i < klen; i++){
+        if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) == NULL ||
+            de->de_xml == NULL)
+            continue;
+        if (xmldb_cache_de_size(de, &sz) < 0)
+            goto done;
+        *size += sz;
+    }
+    if (evictions)
+        *evictions = _xmldb_cache_evictions;
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Free least recently used datastore caches while they exceed the memory budget
+ *
+ * Running and modified datastores are not evicted. An evicted datastore is read from
+ * file at next access.
+ * Call when no datastore trees are referenced, such as between RPCs.
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see CLICON_DATASTORE_CACHE_BUDGET
+ */
+int
+xmldb_cache_evict(clicon_handle h)
+{
+    int       retval = -1;
+    size_t    budget;
+    size_t    total;
+    char    **keys = NULL;
+    size_t    klen;
+    db_elmnt *de;
+    db_elmnt *delru;
+    char     *dblru;
+    int       i;
+
+    if ((budget = (size_t)clicon_option_int(h, "CLICON_DATASTORE_CACHE_BUDGET")*1024) == 0 ||
+        clicon_datastore_cache(h) == DATASTORE_NOCACHE)
+        goto ok;
+    if (xmldb_cache_stats(h, &total, NULL) < 0)
+        goto done;
+    if (total <= budget)
+        goto ok;
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    while (total > budget){
+        delru = NULL;
+        dblru = NULL;
+        for (i = 0; i < klen; i++){
+            if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) == NULL ||
+                de->de_xml == NULL ||
+                de->de_modified ||
+                strcmp(keys[i], "running") == 0)
+                continue;
+            if (delru == NULL || de->de_atime < delru->de_atime){
+                delru = de;
+                dblru = keys[i];
+            }
+        }
+        if (delru == NULL)
+            break;
+        clicon_debug(CLIXON_DBG_DEFAULT, "%s %s %zu bytes", __FUNCTION__, dblru, delru->de_size);
+        xml_free(delru->de_xml);
+        delru->de_xml = NULL;
+        total -= delru->de_size;
+        _xmldb_cache_evictions++;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Compact all datastore caches, eg after large deletes
+ *
+ * Shrink vectors and buffers of cached trees to their used size, see xml_compact
+ * Call when no datastore trees are referenced, such as between RPCs.
+ * @param[in]  h     Clicon handle
+ * @param[out] szp   Reclaimed bytes (if not NULL)
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+xmldb_cache_compact(clicon_handle h,
+                    size_t       *szp)
+{
+    int       retval = -1;
+    char    **keys = NULL;
+    size_t    klen;
+    db_elmnt *de;
+    size_t    sz = 0;
+    int       i;
+
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i = 0; i < klen; i++){
+        if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) == NULL ||
+            de->de_xml == NULL)
+            continue;
+        if (xml_compact(de->de_xml, &sz) < 0)
+            goto done;
+        de->de_sizegen = 0; /* Recompute size, see xmldb_cache_stats */
+    }
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s %zu bytes", __FUNCTION__, sz);
+    if (szp)
+        *szp = sz;
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
 /*! Get modified flag from datastore
  *
  * @param[in]  h     Clicon handle
@@ -558,6 +866,154 @@ xmldb_modified_get(clicon_handle h,
     return de->de_modified;
 }
 
+/*! Set a new content version and modification time of a datastore
+ *
+ * Called when the content of a datastore changes, eg by commit, copy, edit or delete.
+ * Versions are unique for all datastores and increasing, also across restarts since the first
+ * version is the time in microseconds.
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Database name
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_version_get
+ */
+int
+xmldb_version_bump(clicon_handle h,
+                   const char   *db)
+{
+    db_elmnt      *de;
+    db_elmnt       de0 = {0,};
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    if (_xmldb_version == 0)
+        _xmldb_version = (uint64_t)tv.tv_sec*1000000 + tv.tv_usec;
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL){
+        /* No cache or lock: create element, this changes its generation */
+        if (clicon_db_elmnt_set(h, db, &de0) < 0)
+            return -1;
+        if ((de = clicon_db_elmnt_get(h, db)) == NULL){
+            clicon_err(OE_CFG, EFAULT, "datastore %s does not exist", db);
+            return -1;
+        }
+    }
+    /* Modify in place to keep generation, see xmldb_delta_get */
+    de->de_version = ++_xmldb_version;
+    de->de_mtime = tv;
+    return 0;
+}
+
+/*! Get content version and modification time of a datastore
+ *
+ * The version is changed whenever the content of the datastore changes, it can be used as an
+ * entity-tag of the datastore, see RFC 8040 Sec 3.5.2
+ * @param[in]  h       Clicon handle
+ * @param[in]  db      Database name
+ * @param[out] version Content version
+ * @param[out] mtime   Time of last content change (or NULL)
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see xmldb_version_bump
+ */
+int
+xmldb_version_get(clicon_handle   h,
+                  const char     *db,
+                  uint64_t       *version,
+                  struct timeval *mtime)
+{
+    db_elmnt *de;
+
+    /* Not changed since start: the content is as of start */
+    if (((de = clicon_db_elmnt_get(h, db)) == NULL || de->de_version == 0) &&
+        xmldb_version_bump(h, db) < 0)
+        return -1;
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL){
+        clicon_err(OE_CFG, EFAULT, "datastore %s does not exist", db);
+        return -1;
+    }
+    *version = de->de_version;
+    if (mtime)
+        *mtime = de->de_mtime;
+    return 0;
+}
+
+/*! Check if the cache of a datastore is an edited copy of the cache of a base datastore
+ *
+ * This is the case if the cache was copied from base, eg candidate from running, and base
+ * has not been changed since. Nodes edited since then, and their ancestors, are marked
+ * with XML_FLAG_DIRTY, other nodes are equal to base.
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Database name, eg candidate
+ * @param[in]  base  Base database name, eg running
+ * @retval     1     Only nodes marked XML_FLAG_DIRTY of db differ from base
+ * @retval     0     No, or CLICON_XMLDB_CANDIDATE_DELTA is not set
+ * @see xml_diff_dirty
+ */
+int
+xmldb_delta_get(clicon_handle h,
+                const char   *db,
+                const char   *base)
+{
+    db_elmnt *de;
+    db_elmnt *deb;
+
+    if (!clicon_option_bool(h, "CLICON_XMLDB_CANDIDATE_DELTA") ||
+        clicon_datastore_cache(h) == DATASTORE_NOCACHE)
+        return 0;
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL || de->de_xml == NULL ||
+        de->de_base == 0)
+        return 0;
+    if ((deb = clicon_db_elmnt_get(h, base)) == NULL || deb->de_xml == NULL)
+        return 0;
+    return de->de_base == deb->de_gen;
+}
+
+/*! Reset edit marks in an xml tree, only where set
+ * @param[in]  x    XML tree
+ */
+static void
+xmldb_delta_reset(cxobj *x)
+{
+    cxobj *xc = NULL;
+
+    xml_flag_reset(x, XML_FLAG_DIRTY);
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+        if (xml_flag(xc, XML_FLAG_DIRTY))
+            xmldb_delta_reset(xc);
+}
+
+/*! Declare the cache of a datastore equal to the cache of a base datastore
+ *
+ * Reset edit marks of db, eg when candidate has been committed to running
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Database name, eg candidate
+ * @param[in]  base  Base database name, eg running
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_delta_get
+ */
+int
+xmldb_delta_set(clicon_handle h,
+                const char   *db,
+                const char   *base)
+{
+    db_elmnt *de;
+    db_elmnt *deb;
+
+    if (!clicon_option_bool(h, "CLICON_XMLDB_CANDIDATE_DELTA") ||
+        clicon_datastore_cache(h) == DATASTORE_NOCACHE)
+        return 0;
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL || de->de_xml == NULL)
+        return 0;
+    if ((deb = clicon_db_elmnt_get(h, base)) == NULL || deb->de_xml == NULL){
+        de->de_base = 0;
+        return 0;
+    }
+    xmldb_delta_reset(de->de_xml);
+    de->de_base = deb->de_gen;
+    return 0;
+}
+
 /*! Get empty flag from datastore (the datastore was empty ON LOAD)
  *
  * @param[in]  h     Clicon handle
@@ -658,6 +1114,10 @@ xmldb_rename(clicon_handle h,
         goto done;
     if (newdb == NULL && suffix == NULL)        // no-op
         goto done;
+    if (xmldb_async_barrier(h, db) < 0)
+        goto done;
+    if (xmldb_journal_compact(h, db) < 0)
+        goto done;
     if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
@@ -666,6 +1126,8 @@ xmldb_rename(clicon_handle h,
     if (suffix)
         cprintf(cb, "%s", suffix);
     fname = cbuf_get(cb);
+    if (xmldb_split_rename(h, db, fname) < 0)
+        goto done;
     if ((rename(old, fname)) < 0) {
         clicon_err(OE_UNIX, errno, "rename: %s", strerror(errno));
         goto done;
@@ -0,0 +1,560 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Asynchronous running datastore writer, see CLICON_XMLDB_ASYNC
+  * On commit, the in-memory cache is updated synchronously. The source datastore file
+  * (and journal) is copied to a temporary file in the main thread, after which a single
+  * background writer thread makes fsync, rename and directory fsync in FIFO (commit) order.
+  * Jobs are numbered by a sequence number, and the writer signals completion of each job
+  * on a pipe, which the backend may register in its event loop to defer commit replies
+  * until durable.
+  * The writer thread only uses system calls, no clixon functions: errors are recorded
+  * and reported in the main thread by xmldb_async_barrier and xmldb_async_poll.
+  * Any other access to a datastore file waits for its pending writes, see
+  * xmldb_async_barrier.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <syslog.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_yang_module.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_options.h"
+#include "clixon_data.h"
+#include "clixon_file.h"
+#include "clixon_datastore.h"
+#include "clixon_datastore_journal.h"
+
+#ifdef HAVE_LIBPTHREAD
+
+/*! A pending datastore write, owned by the writer queue
+ */
+struct async_job{
+    qelem_t   aj_qelem;  /* Queue, must be first */
+    uint64_t  aj_seq;    /* Sequence number, increasing in commit order */
+    char     *aj_db;     /* Name of destination database */
+    char     *aj_tmp;    /* Temporary copy of source datastore file */
+    char     *aj_file;   /* Destination datastore file */
+    char     *aj_jtmp;   /* Temporary copy of source journal, or NULL if none */
+    char     *aj_jfile;  /* Destination journal file */
+};
+
+/*! Writer state, one per process
+ * The fields below aw_mutex are protected by it
+ */
+struct async_writer{
+    int               aw_running; /* Writer thread started */
+    pthread_t         aw_tid;     /* Writer thread */
+    int               aw_pipe[2]; /* Completion notification, read end in main thread */
+    uint64_t          aw_queued;  /* Last queued sequence number (main thread only) */
+    pthread_mutex_t   aw_mutex;
+    pthread_cond_t    aw_cond;    /* Signalled on new job or exit */
+    pthread_cond_t    aw_done;    /* Signalled when a job is done */
+    struct async_job *aw_jobs;    /* Pending jobs, the first is being written */
+    uint64_t          aw_durable; /* Last durable sequence number */
+    int               aw_exit;    /* Writer thread should exit when queue is empty */
+    int               aw_errno;   /* First error of a failed job, 0 if none */
+    char             *aw_errfile; /* File of failed job */
+};
+
+static struct async_writer _aw = {0, };
+
+static void
+async_job_free(struct async_job *aj)
+{
+    if (aj->aj_db)
+        free(aj->aj_db);
+    if (aj->aj_tmp)
+        free(aj->aj_tmp);
+    if (aj->aj_file)
+        free(aj->aj_file);
+    if (aj->aj_jtmp)
+        free(aj->aj_jtmp);
+    if (aj->aj_jfile)
+        free(aj->aj_jfile);
+    free(aj);
+}
+
+/*! Sync a file and rename it to its final name, then sync the directory
+ *
+ * Called in writer thread
+ * @param[in]  tmp   Temporary file
+ * @param[in]  file  Destination file
+ * @retval     0     OK
+ * @retval     err   errno of failed system call
+ */
+static int
+async_file_commit(const char *tmp,
+                  const char *file)
+{
+    int   err = 0;
+    int   fd = -1;
+    char *dir = NULL;
+    char *p;
+
+    if ((fd = open(tmp, O_RDONLY)) < 0 ||
+        fsync(fd) < 0 ||
+        rename(tmp, file) < 0){
+        err = errno;
+        goto done;
+    }
+    close(fd);
+    fd = -1;
+    if ((dir = strdup(file)) == NULL){
+        err = errno;
+        goto done;
+    }
+    if ((p = strrchr(dir, '/')) != NULL)
+        *p = '\0';
+    else
+        strcpy(dir, ".");
+    if ((fd = open(dir, O_RDONLY)) < 0 ||
+        fsync(fd) < 0){
+        err = errno;
+        goto done;
+    }
+ done:
+    if (fd != -1)
+        close(fd);
+    if (dir)
+        free(dir);
+    return err;
+}
+
+/*! Make one job durable
+ *
+ * Called in writer thread
+ * @param[in]  aj    Job
+ * @retval     0     OK
+ * @retval     err   errno of failed system call
+ */
+static int
+async_job_run(struct async_job *aj)
+{
+    int err;
+
+    if ((err = async_file_commit(aj->aj_tmp, aj->aj_file)) != 0)
+        return err;
+    /* The datastore file is durable, now the journal is replaced or removed */
+    if (aj->aj_jtmp)
+        return async_file_commit(aj->aj_jtmp, aj->aj_jfile);
+    if (unlink(aj->aj_jfile) < 0 && errno != ENOENT)
+        return errno;
+    return 0;
+}
+
+/*! Writer thread, write jobs in FIFO order until told to exit
+ */
+static void *
+async_writer_thread(void *arg)
+{
+    struct async_writer *aw = (struct async_writer *)arg;
+    struct async_job    *aj;
+    int                  err;
+
+    pthread_mutex_lock(&aw->aw_mutex);
+    while (1){
+        while (aw->aw_jobs == NULL && !aw->aw_exit)
+            pthread_cond_wait(&aw->aw_cond, &aw->aw_mutex);
+        if ((aj = aw->aw_jobs) == NULL)
+            break;
+        /* Keep job in queue while writing so that barriers wait for it */
+        pthread_mutex_unlock(&aw->aw_mutex);
+        err = async_job_run(aj);
+        pthread_mutex_lock(&aw->aw_mutex);
+        DELQ(aj, aw->aw_jobs, struct async_job *);
+        if (err && aw->aw_errno == 0){
+            aw->aw_errno = err;
+            aw->aw_errfile = aj->aj_file;
+            aj->aj_file = NULL;
+        }
+        aw->aw_durable = aj->aj_seq;
+        pthread_cond_broadcast(&aw->aw_done);
+        if (write(aw->aw_pipe[1], "", 1) < 0)
+            ; /* Pipe full: reader polls durable sequence number anyway */
+        async_job_free(aj);
+    }
+    pthread_mutex_unlock(&aw->aw_mutex);
+    return NULL;
+}
+
+/*! Start writer thread, if not already started
+ *
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+async_writer_start(clicon_handle h)
+{
+    struct async_writer *aw = &_aw;
+
+    if (aw->aw_running)
+        return 0;
+    if (pipe(aw->aw_pipe) < 0){
+        clicon_err(OE_UNIX, errno, "pipe");
+        return -1;
+    }
+    if (fcntl(aw->aw_pipe[0], F_SETFL, O_NONBLOCK) < 0 ||
+        fcntl(aw->aw_pipe[1], F_SETFL, O_NONBLOCK) < 0){
+        clicon_err(OE_UNIX, errno, "fcntl");
+        goto err;
+    }
+    pthread_mutex_init(&aw->aw_mutex, NULL);
+    pthread_cond_init(&aw->aw_cond, NULL);
+    pthread_cond_init(&aw->aw_done, NULL);
+    aw->aw_exit = 0;
+    if (pthread_create(&aw->aw_tid, NULL, async_writer_thread, aw) != 0){
+        clicon_err(OE_UNIX, errno, "pthread_create");
+        pthread_mutex_destroy(&aw->aw_mutex);
+        pthread_cond_destroy(&aw->aw_cond);
+        pthread_cond_destroy(&aw->aw_done);
+        goto err;
+    }
+    aw->aw_running = 1;
+    return 0;
+ err:
+    close(aw->aw_pipe[0]);
+    close(aw->aw_pipe[1]);
+    return -1;
+}
+
+/*! Report and clear a recorded writer error, mutex held
+ *
+ * @retval     0     No error
+ * @retval    -1     A job failed, clicon_err set
+ */
+static int
+async_writer_error(struct async_writer *aw)
+{
+    if (aw->aw_errno == 0)
+        return 0;
+    clicon_err(OE_DB, aw->aw_errno, "Asynchronous write of %s",
+               aw->aw_errfile?aw->aw_errfile:"datastore");
+    aw->aw_errno = 0;
+    if (aw->aw_errfile){
+        free(aw->aw_errfile);
+        aw->aw_errfile = NULL;
+    }
+    return -1;
+}
+
+/*! Check if there is a pending job for a database, mutex held
+ */
+static int
+async_pending(struct async_writer *aw,
+              const char          *db)
+{
+    struct async_job *aj;
+
+    if ((aj = aw->aw_jobs) == NULL)
+        return 0;
+    if (db == NULL)
+        return 1;
+    do {
+        if (strcmp(aj->aj_db, db) == 0)
+            return 1;
+        aj = NEXTQ(struct async_job *, aj);
+    } while (aj && aj != aw->aw_jobs);
+    return 0;
+}
+#endif /* HAVE_LIBPTHREAD */
+
+/*! Copy database from db1 to db2, making the destination file durable asynchronously
+ *
+ * The in-memory cache and temporary copies of the source files are made before return.
+ * The destination file is written by the background writer.
+ * If CLICON_XMLDB_ASYNC is sync, CLICON_XMLDB_SPLIT is set, or there is no cache, this is
+ * the same as xmldb_copy.
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database
+ * @param[in]  to    Destination database
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_async_queued  for the sequence number of the write
+ */
+int
+xmldb_async_copy(clicon_handle h,
+                 const char   *from,
+                 const char   *to)
+{
+#ifdef HAVE_LIBPTHREAD
+    int                  retval = -1;
+    struct async_writer *aw = &_aw;
+    struct async_job    *aj = NULL;
+    char                *fromfile = NULL;
+    char                *jfromfile = NULL;
+    cbuf                *cb = NULL;
+    struct stat          st = {0,};
+
+    /* Split datastore copies only link module files */
+    if (clicon_xmldb_async(h) == XMLDB_ASYNC_SYNC ||
+        clicon_option_bool(h, "CLICON_XMLDB_SPLIT") ||
+        clicon_datastore_cache(h) == DATASTORE_NOCACHE ||
+        xmldb_cache_get(h, from) == NULL)
+        return xmldb_copy(h, from, to);
+    clicon_debug(1, "%s %s %s", __FUNCTION__, from, to);
+    if (async_writer_start(h) < 0)
+        goto done;
+    /* The source file may be pending itself */
+    if (xmldb_async_barrier(h, from) < 0)
+        goto done;
+    if (xmldb_copy_cache(h, from, to) < 0)
+        goto done;
+    if ((aj = malloc(sizeof(*aj))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(aj, 0, sizeof(*aj));
+    aj->aj_seq = aw->aw_queued + 1;
+    if ((aj->aj_db = strdup(to)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (xmldb_db2file(h, from, &fromfile) < 0)
+        goto done;
+    if (xmldb_db2file(h, to, &aj->aj_file) < 0)
+        goto done;
+    if (xmldb_journal_file(h, to, &aj->aj_jfile) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    /* Temporary file names are unique per job since earlier jobs may still be pending */
+    cprintf(cb, "%s.%" PRIu64 ".tmp", aj->aj_file, aj->aj_seq);
+    if ((aj->aj_tmp = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (clicon_file_copy(fromfile, aj->aj_tmp) < 0)
+        goto done;
+    if (xmldb_journal_file(h, from, &jfromfile) < 0)
+        goto done;
+    if (stat(jfromfile, &st) == 0){
+        cbuf_reset(cb);
+        cprintf(cb, "%s.%" PRIu64 ".tmp", aj->aj_jfile, aj->aj_seq);
+        if ((aj->aj_jtmp = strdup(cbuf_get(cb))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        if (clicon_file_copy(jfromfile, aj->aj_jtmp) < 0)
+            goto done;
+    }
+    pthread_mutex_lock(&aw->aw_mutex);
+    ADDQ(aj, aw->aw_jobs);
+    pthread_cond_signal(&aw->aw_cond);
+    pthread_mutex_unlock(&aw->aw_mutex);
+    aw->aw_queued = aj->aj_seq;
+    aj = NULL;
+    retval = 0;
+ done:
+    if (aj){
+        if (aj->aj_tmp)
+            unlink(aj->aj_tmp);
+        if (aj->aj_jtmp)
+            unlink(aj->aj_jtmp);
+        async_job_free(aj);
+    }
+    if (cb)
+        cbuf_free(cb);
+    if (fromfile)
+        free(fromfile);
+    if (jfromfile)
+        free(jfromfile);
+    return retval;
+#else
+    return xmldb_copy(h, from, to);
+#endif
+}
+
+/*! Wait until all pending writes of a database are durable
+ *
+ * Called before any other access of a datastore file, and as durability barrier
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Name of database, or NULL for all databases
+ * @retval     0     OK, no pending writes
+ * @retval    -1     Error, an asynchronous write has failed
+ */
+int
+xmldb_async_barrier(clicon_handle h,
+                    const char   *db)
+{
+#ifdef HAVE_LIBPTHREAD
+    struct async_writer *aw = &_aw;
+    int                  retval;
+
+    if (!aw->aw_running)
+        return 0;
+    pthread_mutex_lock(&aw->aw_mutex);
+    while (async_pending(aw, db))
+        pthread_cond_wait(&aw->aw_done, &aw->aw_mutex);
+    retval = async_writer_error(aw);
+    pthread_mutex_unlock(&aw->aw_mutex);
+    return retval;
+#else
+    return 0;
+#endif
+}
+
+/*! Get sequence number of the last queued asynchronous write
+ *
+ * @param[in]  h     Clicon handle
+ * @retval     seq   Sequence number, 0 if nothing has been queued
+ */
+uint64_t
+xmldb_async_queued(clicon_handle h)
+{
+#ifdef HAVE_LIBPTHREAD
+    return _aw.aw_queued;
+#else
+    return 0;
+#endif
+}
+
+/*! Get completion notification socket of the asynchronous writer
+ *
+ * The socket is readable when a write is done, use xmldb_async_poll to check
+ * @param[in]  h     Clicon handle
+ * @retval     fd    File descriptor to register in event loop
+ * @retval    -1     No asynchronous writes, or error
+ */
+int
+xmldb_async_fd(clicon_handle h)
+{
+#ifdef HAVE_LIBPTHREAD
+    if (clicon_xmldb_async(h) == XMLDB_ASYNC_SYNC)
+        return -1;
+    if (async_writer_start(h) < 0)
+        return -1;
+    return _aw.aw_pipe[0];
+#else
+    return -1;
+#endif
+}
+
+/*! Read completion notifications and get last durable write
+ *
+ * @param[in]  h        Clicon handle
+ * @param[out] durable  Sequence number of last durable write
+ * @retval     0        OK
+ * @retval    -1        Error, an asynchronous write has failed
+ */
+int
+xmldb_async_poll(clicon_handle h,
+                 uint64_t     *durable)
+{
+#ifdef HAVE_LIBPTHREAD
+    struct async_writer *aw = &_aw;
+    char                 buf[64];
+    int                  retval;
+
+    if (!aw->aw_running){
+        *durable = aw->aw_queued;
+        return 0;
+    }
+    while (read(aw->aw_pipe[0], buf, sizeof(buf)) > 0)
+        ;
+    pthread_mutex_lock(&aw->aw_mutex);
+    *durable = aw->aw_durable;
+    retval = async_writer_error(aw);
+    pthread_mutex_unlock(&aw->aw_mutex);
+    return retval;
+#else
+    *durable = 0;
+    return 0;
+#endif
+}
+
+/*! Make all pending writes durable and stop the writer thread
+ *
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ * @retval    -1     Error, an asynchronous write has failed
+ */
+int
+xmldb_async_exit(clicon_handle h)
+{
+#ifdef HAVE_LIBPTHREAD
+    struct async_writer *aw = &_aw;
+    int                  retval;
+
+    if (!aw->aw_running)
+        return 0;
+    pthread_mutex_lock(&aw->aw_mutex);
+    aw->aw_exit = 1;
+    pthread_cond_signal(&aw->aw_cond);
+    pthread_mutex_unlock(&aw->aw_mutex);
+    pthread_join(aw->aw_tid, NULL);
+    retval = async_writer_error(aw);
+    close(aw->aw_pipe[0]);
+    close(aw->aw_pipe[1]);
+    pthread_mutex_destroy(&aw->aw_mutex);
+    pthread_cond_destroy(&aw->aw_cond);
+    pthread_cond_destroy(&aw->aw_done);
+    aw->aw_running = 0;
+    return retval;
+#else
+    return 0;
+#endif
+}
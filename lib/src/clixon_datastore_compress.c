@@ -0,0 +1,334 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+
+  * Compressed datastore files, see CLICON_XMLDB_COMPRESS
+  * A datastore file stream is wrapped in a stream that compresses on write or decompresses
+  * on read, so that the datastore formats are written and parsed as usual, without the
+  * whole file in memory.
+  * Compressed files are recognized by the zstd frame magic number when read.
+  * Requires zstd and fopencookie(3), see configure --with-zstd
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#ifdef HAVE_FOPENCOOKIE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/types.h>
+#if defined(HAVE_LIBZSTD) && defined(HAVE_FOPENCOOKIE)
+#include <zstd.h>
+#endif
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_options.h"
+#include "clixon_yang_module.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_data.h"
+#include "clixon_datastore.h"
+
+/* zstd frame magic number, little endian */
+static const unsigned char xmldb_zstd_magic[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+#if defined(HAVE_LIBZSTD) && defined(HAVE_FOPENCOOKIE)
+
+/*! State of a compressing or decompressing datastore stream
+ */
+struct xmldb_zstd {
+    FILE          *xz_f;      /* Underlying file */
+    ZSTD_CCtx     *xz_cctx;   /* Compression context if written */
+    ZSTD_DCtx     *xz_dctx;   /* Decompression context if read */
+    char          *xz_buf;    /* Compressed data buffer */
+    size_t         xz_buflen;
+    ZSTD_inBuffer  xz_in;     /* Read: compressed data not yet decompressed */
+    size_t         xz_hint;   /* Read: 0 if at end of a frame */
+};
+
+static void
+zstd_free(struct xmldb_zstd *xz)
+{
+    if (xz->xz_cctx)
+        ZSTD_freeCCtx(xz->xz_cctx);
+    if (xz->xz_dctx)
+        ZSTD_freeDCtx(xz->xz_dctx);
+    if (xz->xz_buf)
+        free(xz->xz_buf);
+    free(xz);
+}
+
+/*! fopencookie read function: decompress into buf
+ *
+ * @retval  n   Number of bytes read, 0 on end of file
+ * @retval -1   Error, errno set
+ */
+static ssize_t
+zstd_read(void  *cookie,
+          char  *buf,
+          size_t size)
+{
+    struct xmldb_zstd *xz = (struct xmldb_zstd *)cookie;
+    ZSTD_outBuffer     out = {buf, size, 0};
+    size_t             n;
+
+    while (out.pos == 0){
+        if (xz->xz_in.pos == xz->xz_in.size){
+            if ((n = fread(xz->xz_buf, 1, xz->xz_buflen, xz->xz_f)) == 0){
+                if (ferror(xz->xz_f))
+                    return -1;
+                if (xz->xz_hint != 0){ /* Truncated frame */
+                    errno = EIO;
+                    return -1;
+                }
+                break;
+            }
+            xz->xz_in.src = xz->xz_buf;
+            xz->xz_in.size = n;
+            xz->xz_in.pos = 0;
+        }
+        xz->xz_hint = ZSTD_decompressStream(xz->xz_dctx, &out, &xz->xz_in);
+        if (ZSTD_isError(xz->xz_hint)){
+            errno = EIO;
+            return -1;
+        }
+    }
+    return out.pos;
+}
+
+/*! fopencookie write function: compress buf and write to file
+ *
+ * @retval  size  All bytes written
+ * @retval -1     Error, errno set
+ */
+static ssize_t
+zstd_write(void       *cookie,
+           const char *buf,
+           size_t      size)
+{
+    struct xmldb_zstd *xz = (struct xmldb_zstd *)cookie;
+    ZSTD_inBuffer      in = {buf, size, 0};
+    ZSTD_outBuffer     out;
+    size_t             ret;
+
+    while (in.pos < in.size){
+        out.dst = xz->xz_buf;
+        out.size = xz->xz_buflen;
+        out.pos = 0;
+        ret = ZSTD_compressStream2(xz->xz_cctx, &out, &in, ZSTD_e_continue);
+        if (ZSTD_isError(ret)){
+            errno = EIO;
+            return -1;
+        }
+        if (out.pos && fwrite(xz->xz_buf, 1, out.pos, xz->xz_f) != out.pos)
+            return -1;
+    }
+    return size;
+}
+
+/*! fopencookie close function: end frame if written, and close file
+ *
+ * @retval  0   OK
+ * @retval -1   Error, errno set
+ */
+static int
+zstd_close(void *cookie)
+{
+    int                retval = -1;
+    struct xmldb_zstd *xz = (struct xmldb_zstd *)cookie;
+    ZSTD_inBuffer      in = {NULL, 0, 0};
+    ZSTD_outBuffer     out;
+    size_t             remaining = 1;
+
+    while (xz->xz_cctx && remaining != 0){
+        out.dst = xz->xz_buf;
+        out.size = xz->xz_buflen;
+        out.pos = 0;
+        remaining = ZSTD_compressStream2(xz->xz_cctx, &out, &in, ZSTD_e_end);
+        if (ZSTD_isError(remaining)){
+            errno = EIO;
+            goto done;
+        }
+        if (out.pos && fwrite(xz->xz_buf, 1, out.pos, xz->xz_f) != out.pos)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (fclose(xz->xz_f) != 0)
+        retval = -1;
+    zstd_free(xz);
+    return retval;
+}
+
+/*! Wrap a file in a zstd stream
+ *
+ * @param[in]  f     Open file
+ * @param[in]  mode  "r" or "w"
+ * @retval     fz    Stream owning f
+ * @retval     NULL  Error
+ */
+static FILE *
+zstd_fopen(FILE       *f,
+           const char *mode)
+{
+    FILE                 *fz = NULL;
+    struct xmldb_zstd    *xz = NULL;
+    cookie_io_functions_t io = {0,};
+    size_t                ret;
+
+    if ((xz = calloc(1, sizeof(*xz))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    xz->xz_f = f;
+    if (*mode == 'r'){
+        if ((xz->xz_dctx = ZSTD_createDCtx()) == NULL){
+            clicon_err(OE_XML, ENOMEM, "ZSTD_createDCtx");
+            goto done;
+        }
+        xz->xz_buflen = ZSTD_DStreamInSize();
+        io.read = zstd_read;
+    }
+    else {
+        if ((xz->xz_cctx = ZSTD_createCCtx()) == NULL){
+            clicon_err(OE_XML, ENOMEM, "ZSTD_createCCtx");
+            goto done;
+        }
+        ret = ZSTD_CCtx_setParameter(xz->xz_cctx, ZSTD_c_compressionLevel, XMLDB_COMPRESS_LEVEL);
+        if (ZSTD_isError(ret)){
+            clicon_err(OE_XML, EINVAL, "ZSTD_CCtx_setParameter: %s", ZSTD_getErrorName(ret));
+            goto done;
+        }
+        xz->xz_buflen = ZSTD_CStreamOutSize();
+        io.write = zstd_write;
+    }
+    io.close = zstd_close;
+    if ((xz->xz_buf = malloc(xz->xz_buflen)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    if ((fz = fopencookie(xz, mode, io)) == NULL){
+        clicon_err(OE_UNIX, errno, "fopencookie");
+        goto done;
+    }
+    xz = NULL;
+ done:
+    if (xz)
+        zstd_free(xz);
+    return fz;
+}
+#endif /* HAVE_LIBZSTD && HAVE_FOPENCOOKIE */
+
+/*! Wrap an open datastore file in a compressing or decompressing stream if needed
+ *
+ * On read, the stream is decompressed if the file starts with a zstd frame, regardless of
+ * CLICON_XMLDB_COMPRESS. On write, the stream is compressed if CLICON_XMLDB_COMPRESS is set.
+ * If wrapped, the new stream owns the file: fclose the new stream, not the file.
+ * Check the return value of fclose of a written stream, since the end of the compressed
+ * data is written at close.
+ * @param[in]     h     Clicon handle
+ * @param[in]     mode  "r" or "w", as the file was opened
+ * @param[in,out] fp    Open file, replaced with the new stream if wrapped
+ * @retval        0     OK
+ * @retval       -1     Error, *fp is not changed
+ * @code
+ *   if ((f = fopen(file, "r")) == NULL)
+ *      err;
+ *   if (xmldb_compress_wrap(h, "r", &f) < 0){
+ *      fclose(f);
+ *      err;
+ *   }
+ *   clixon_xml_parse_file(f, ...);
+ *   fclose(f);
+ * @endcode
+ */
+int
+xmldb_compress_wrap(clicon_handle h,
+                    const char   *mode,
+                    FILE        **fp)
+{
+    int           retval = -1;
+    FILE         *f = *fp;
+    unsigned char magic[sizeof(xmldb_zstd_magic)];
+    size_t        n;
+    int           compressed;
+
+    if (*mode == 'r'){
+        n = fread(magic, 1, sizeof(magic), f);
+        if (ferror(f)){
+            clicon_err(OE_UNIX, errno, "fread");
+            goto done;
+        }
+        if (fseek(f, 0, SEEK_SET) < 0){
+            clicon_err(OE_UNIX, errno, "fseek");
+            goto done;
+        }
+        compressed = (n == sizeof(magic) && memcmp(magic, xmldb_zstd_magic, n) == 0);
+    }
+    else
+        compressed = (clicon_xmldb_compress(h) == XMLDB_COMPRESS_ZSTD);
+    if (!compressed)
+        goto ok;
+#if defined(HAVE_LIBZSTD) && defined(HAVE_FOPENCOOKIE)
+    if ((*fp = zstd_fopen(f, mode)) == NULL){
+        *fp = f;
+        goto done;
+    }
+#else
+    clicon_err(OE_CFG, ENOTSUP, "Compressed datastore requires zstd, see configure --with-zstd");
+    goto done;
+#endif
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
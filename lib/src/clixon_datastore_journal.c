@@ -0,0 +1,870 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Datastore journal, see CLICON_XMLDB_JOURNAL
+  * Instead of rewriting the whole running datastore file at every commit, the changes of
+  * the commit are appended as a record to a journal file, eg running_db.journal.
+  * A record is an edit tree with nc:operation attributes:
+  *   - Removed nodes have operation "remove", only list keys or leaf-list values are kept
+  *   - Added and changed nodes are merged
+  * The ancestors of changed nodes, with list keys, are included as in an edit-config.
+  * Replaying a record is idempotent.
+  * Each record is preceeded by a header line with its length: "#<len>\n<record>\n"
+  * The journal is replayed when the datastore file is read and removed when the full
+  * datastore file is written. It is copied along with the datastore file.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_bind.h"
+#include "clixon_options.h"
+#include "clixon_data.h"
+#include "clixon_yang_module.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_xml_map.h"
+#include "clixon_xml_io.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_file.h"
+#include "clixon_datastore.h"
+#include "clixon_datastore_read.h"
+#include "clixon_datastore_write.h"
+#include "clixon_datastore_journal.h"
+
+/*! Get journal filename of a datastore
+ *
+ * @param[in]  h        Clicon handle
+ * @param[in]  db       Name of database
+ * @param[out] filename Filename, free after use
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+int
+xmldb_journal_file(clicon_handle h,
+                   const char   *db,
+                   char        **filename)
+{
+    int   retval = -1;
+    char *dbfile = NULL;
+    cbuf *cb = NULL;
+
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s.journal", dbfile);
+    if ((*filename = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (dbfile)
+        free(dbfile);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Check if added node is an entry of an ordered-by user list or leaf-list
+ *
+ * Merging such an entry does not keep its position
+ */
+static int
+journal_ordered_by_user(cxobj *x)
+{
+    yang_stmt *y;
+
+    if ((y = xml_spec(x)) == NULL)
+        return 0;
+    if (yang_keyword_get(y) != Y_LIST && yang_keyword_get(y) != Y_LEAF_LIST)
+        return 0;
+    return yang_find(y, Y_ORDERED_BY, "user") != NULL;
+}
+
+/*! Copy an element without children but with its namespace declarations and list keys
+ *
+ * @param[in]  xp   Parent in journal record
+ * @param[in]  x    Original node
+ * @param[in]  keys Also copy list keys and leaf-list value
+ * @param[out] xnp  New node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+journal_node_copy(cxobj  *xp,
+                  cxobj  *x,
+                  int     keys,
+                  cxobj **xnp)
+{
+    int        retval = -1;
+    cxobj     *xn;
+    cxobj     *xa;
+    cxobj     *xk;
+    cxobj     *xc;
+    yang_stmt *y;
+    cg_var    *cvi;
+    char      *prefix;
+
+    if ((xn = xml_new(xml_name(x), xp, CX_ELMNT)) == NULL)
+        goto done;
+    if ((prefix = xml_prefix(x)) != NULL && xml_prefix_set(xn, prefix) < 0)
+        goto done;
+    xml_spec_set(xn, xml_spec(x));
+    xa = NULL;
+    while ((xa = xml_child_each_attr(x, xa)) != NULL){
+        prefix = xml_prefix(xa);
+        if (prefix && strcmp(prefix, "xmlns") == 0){
+            if (xmlns_set(xn, xml_name(xa), xml_value(xa)) < 0)
+                goto done;
+        }
+        else if (prefix == NULL && strcmp(xml_name(xa), "xmlns") == 0){
+            if (xmlns_set(xn, NULL, xml_value(xa)) < 0)
+                goto done;
+        }
+    }
+    if (keys && (y = xml_spec(x)) != NULL){
+        if (yang_keyword_get(y) == Y_LIST){
+            cvi = NULL;
+            while ((cvi = cvec_each(yang_cvec_get(y), cvi)) != NULL) {
+                if ((xk = xml_find_type(x, NULL, cv_string_get(cvi), CX_ELMNT)) == NULL)
+                    continue;
+                if ((xc = xml_dup(xk)) == NULL)
+                    goto done;
+                if (xml_addsub(xn, xc) < 0)
+                    goto done;
+            }
+        }
+        else if (yang_keyword_get(y) == Y_LEAF_LIST && xml_body(x)){
+            if ((xc = xml_new("body", xn, CX_BODY)) == NULL)
+                goto done;
+            if (xml_value_set(xc, xml_body(x)) < 0)
+                goto done;
+        }
+    }
+    *xnp = xn;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add all namespace declarations in scope of x to a top-level node in a journal record
+ */
+static int
+journal_nsc_set(cxobj *xn,
+                cxobj *x)
+{
+    int   retval = -1;
+    cvec *nsc = NULL;
+
+    if (xml_nsctx_node(x, &nsc) < 0)
+        goto done;
+    if (xmlns_set_all(xn, nsc) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (nsc)
+        cvec_free(nsc);
+    return retval;
+}
+
+/*! Find an ancestor already added to a journal record
+ *
+ * Match on yang spec and list keys, skip nodes with an operation
+ */
+static cxobj *
+journal_child_find(cxobj *xr,
+                   cxobj *x)
+{
+    cxobj     *xc = NULL;
+    yang_stmt *y;
+    cg_var    *cvi;
+    char      *b0;
+    char      *b1;
+
+    y = xml_spec(x);
+    while ((xc = xml_child_each(xr, xc, CX_ELMNT)) != NULL){
+        if (xml_spec(xc) != y || strcmp(xml_name(xc), xml_name(x)) != 0)
+            continue;
+        if (xml_find_type(xc, NETCONF_BASE_PREFIX, "operation", CX_ATTR) != NULL)
+            continue;
+        if (y == NULL || yang_keyword_get(y) != Y_LIST)
+            break;
+        cvi = NULL;
+        while ((cvi = cvec_each(yang_cvec_get(y), cvi)) != NULL) {
+            b0 = xml_find_body(xc, cv_string_get(cvi));
+            b1 = xml_find_body(x, cv_string_get(cvi));
+            if (b0 == NULL || b1 == NULL || strcmp(b0, b1) != 0)
+                break;
+        }
+        if (cvi == NULL) /* All keys match */
+            break;
+    }
+    return xc;
+}
+
+/*! Get or create the ancestors of a changed node in a journal record
+ *
+ * @param[in]  xrec  Journal record, top-level NETCONF_INPUT_CONFIG
+ * @param[in]  x     Changed node in datastore tree
+ * @param[out] xpp   Parent of x in the journal record
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+journal_ancestors(cxobj  *xrec,
+                  cxobj  *x,
+                  cxobj **xpp)
+{
+    int     retval = -1;
+    cxobj **vec = NULL;
+    int     veclen = 0;
+    cxobj  *xa;
+    cxobj  *xr;
+    cxobj  *xn;
+    int     i;
+
+    xa = x;
+    while ((xa = xml_parent(xa)) != NULL && xml_parent(xa) != NULL)
+        if (cxvec_append(xa, &vec, &veclen) < 0)
+            goto done;
+    xr = xrec;
+    for (i=veclen-1; i>=0; i--){
+        xa = vec[i];
+        if ((xn = journal_child_find(xr, xa)) == NULL){
+            if (journal_node_copy(xr, xa, 1, &xn) < 0)
+                goto done;
+            if (xr == xrec && journal_nsc_set(xn, xa) < 0)
+                goto done;
+        }
+        xr = xn;
+    }
+    *xpp = xr;
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Add a removed node to a journal record
+ */
+static int
+journal_remove(cxobj *xrec,
+               cxobj *x)
+{
+    int    retval = -1;
+    cxobj *xp;
+    cxobj *xn;
+
+    if (journal_ancestors(xrec, x, &xp) < 0)
+        goto done;
+    if (journal_node_copy(xp, x, 1, &xn) < 0)
+        goto done;
+    if (xp == xrec && journal_nsc_set(xn, x) < 0)
+        goto done;
+    if (xml_add_attr(xn, "operation", "remove", NETCONF_BASE_PREFIX, NULL) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add an added or changed node to a journal record, without default values
+ */
+static int
+journal_merge(cxobj *xrec,
+              cxobj *x)
+{
+    int    retval = -1;
+    cxobj *xp;
+    cxobj *xn;
+
+    if (journal_ancestors(xrec, x, &xp) < 0)
+        goto done;
+    if ((xn = xml_dup(x)) == NULL)
+        goto done;
+    if (xml_addsub(xp, xn) < 0)
+        goto done;
+    if (xml_tree_prune_flagged(xn, XML_FLAG_DEFAULT, 1) < 0)
+        goto done;
+    if (xp == xrec && journal_nsc_set(xn, x) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Make a record of removed, added and changed nodes
+ *
+ * @param[out] xrec   Record, or NULL if there are added entries of ordered-by user lists
+ * @see xmldb_journal_record
+ */
+static int
+journal_record(cxobj **dvec,
+               int     dlen,
+               cxobj **avec,
+               int     alen,
+               cxobj **scvec,
+               cxobj **tcvec,
+               int     clen,
+               cxobj **xrec)
+{
+    int    retval = -1;
+    cxobj *xr = NULL;
+    int    i;
+
+    *xrec = NULL;
+    for (i=0; i<alen; i++)
+        if (journal_ordered_by_user(avec[i]))
+            goto ok;
+    if ((xr = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xmlns_set(xr, NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE) < 0)
+        goto done;
+    /* Removes before merges, the same node may be removed and added, eg in a choice */
+    for (i=0; i<dlen; i++){
+        if (xml_flag(dvec[i], XML_FLAG_DEFAULT))
+            continue;
+        if (journal_remove(xr, dvec[i]) < 0)
+            goto done;
+    }
+    for (i=0; i<clen; i++){
+        if (xml_flag(tcvec[i], XML_FLAG_DEFAULT) && !xml_flag(scvec[i], XML_FLAG_DEFAULT))
+            if (journal_remove(xr, scvec[i]) < 0)
+                goto done;
+    }
+    for (i=0; i<alen; i++){
+        if (xml_flag(avec[i], XML_FLAG_DEFAULT))
+            continue;
+        if (journal_merge(xr, avec[i]) < 0)
+            goto done;
+    }
+    for (i=0; i<clen; i++){
+        if (!xml_flag(tcvec[i], XML_FLAG_DEFAULT))
+            if (journal_merge(xr, tcvec[i]) < 0)
+                goto done;
+    }
+    *xrec = xr;
+    xr = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (xr)
+        xml_free(xr);
+    return retval;
+}
+
+/*! Make a journal record from the changes of a commit transaction
+ *
+ * Must be called before default values are removed from the trees of the transaction
+ * @param[in]  h      Clicon handle
+ * @param[in]  dvec   Removed nodes
+ * @param[in]  dlen   Length of dvec
+ * @param[in]  avec   Added nodes
+ * @param[in]  alen   Length of avec
+ * @param[in]  scvec  Changed nodes, original values
+ * @param[in]  tcvec  Changed nodes, new values
+ * @param[in]  clen   Length of scvec and tcvec
+ * @param[out] xrec   Journal record, or NULL if changes can not be journaled. Free with xml_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @note No record is made if CLICON_XMLDB_JOURNAL is not set, there is no datastore cache,
+ *       or if there are added entries of ordered-by user lists
+ * @see xmldb_journal_commit
+ */
+int
+xmldb_journal_record(clicon_handle h,
+                     cxobj       **dvec,
+                     int           dlen,
+                     cxobj       **avec,
+                     int           alen,
+                     cxobj       **scvec,
+                     cxobj       **tcvec,
+                     int           clen,
+                     cxobj       **xrec)
+{
+    *xrec = NULL;
+    if (!clicon_option_bool(h, "CLICON_XMLDB_JOURNAL") ||
+        clicon_datastore_cache(h) == DATASTORE_NOCACHE)
+        return 0;
+    return journal_record(dvec, dlen, avec, alen, scvec, tcvec, clen, xrec);
+}
+
+/*! Make a record of the changes of a commit transaction regardless of CLICON_XMLDB_JOURNAL
+ *
+ * As xmldb_journal_record, used by other consumers of changes, eg a standby backend
+ * @param[in]  h      Clicon handle
+ * @param[in]  dvec   Removed nodes
+ * @param[in]  dlen   Length of dvec
+ * @param[in]  avec   Added nodes
+ * @param[in]  alen   Length of avec
+ * @param[in]  scvec  Changed nodes, original values
+ * @param[in]  tcvec  Changed nodes, new values
+ * @param[in]  clen   Length of scvec and tcvec
+ * @param[out] xrec   Record, or NULL if there are added entries of ordered-by user lists.
+ *                    Free with xml_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+xmldb_journal_changes(clicon_handle h,
+                      cxobj       **dvec,
+                      int           dlen,
+                      cxobj       **avec,
+                      int           alen,
+                      cxobj       **scvec,
+                      cxobj       **tcvec,
+                      int           clen,
+                      cxobj       **xrec)
+{
+    return journal_record(dvec, dlen, avec, alen, scvec, tcvec, clen, xrec);
+}
+
+/*! Make a record that reverts the changes of a commit transaction
+ *
+ * As xmldb_journal_record, but removed nodes are merged, added nodes are removed and
+ * changed nodes get their original values. Made regardless of CLICON_XMLDB_JOURNAL.
+ * Must be called before default values are removed from the trees of the transaction
+ * @param[in]  h      Clicon handle
+ * @param[in]  dvec   Removed nodes
+ * @param[in]  dlen   Length of dvec
+ * @param[in]  avec   Added nodes
+ * @param[in]  alen   Length of avec
+ * @param[in]  scvec  Changed nodes, original values
+ * @param[in]  tcvec  Changed nodes, new values
+ * @param[in]  clen   Length of scvec and tcvec
+ * @param[out] xrec   Inverse record, or NULL if removed entries of ordered-by user lists
+ *                    can not be restored in position. Free with xml_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xmldb_journal_revert
+ */
+int
+xmldb_journal_inverse(clicon_handle h,
+                      cxobj       **dvec,
+                      int           dlen,
+                      cxobj       **avec,
+                      int           alen,
+                      cxobj       **scvec,
+                      cxobj       **tcvec,
+                      int           clen,
+                      cxobj       **xrec)
+{
+    return journal_record(avec, alen, dvec, dlen, tcvec, scvec, clen, xrec);
+}
+
+/*! Revert commits of a datastore cache by applying their inverse records, latest first
+ *
+ * Reverted nodes are marked as edited, see xmldb_delta_get
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Datastore with cache, eg a copy of running
+ * @param[in]  vec    Inverse records from xmldb_journal_inverse, in commit order
+ * @param[in]  len    Length of vec
+ * @param[in]  file   Also write the datastore file
+ * @param[out] cbret  Initialized cligen buffer. On exit contains XML if retval == 0
+ * @retval     1      OK
+ * @retval     0      Failed, cbret contains error xml message
+ * @retval    -1      Error
+ */
+int
+xmldb_journal_revert(clicon_handle h,
+                     const char   *db,
+                     cxobj       **vec,
+                     int           len,
+                     int           file,
+                     cbuf         *cbret)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *xt;
+    int        i;
+    int        ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((xt = xmldb_cache_get(h, db)) == NULL){
+        clicon_err(OE_DB, ENOENT, "No cache of datastore %s", db);
+        goto done;
+    }
+    for (i=len-1; i>=0; i--){
+        if ((ret = xmldb_modify_tree(h, xt, vec[i], yspec, OP_MERGE, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    if (file){
+        if (xmldb_write_file(h, db, xt, NULL) < 0)
+            goto done;
+        if (xmldb_journal_reset(h, db) < 0)
+            goto done;
+    }
+    if (xmldb_version_bump(h, db) < 0)
+        goto done;
+    if (xmldb_snapshot_write(h, db) < 0)
+        goto done;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Commit a datastore by appending a journal record instead of copying the datastore file
+ *
+ * The in-memory cache of "from" is copied to "to" and the record is appended to the journal
+ * of "to".
+ * If there is no record, or if the journal would be larger than CLICON_XMLDB_JOURNAL_MAX,
+ * the datastore is copied with xmldb_async_copy which writes the full file and removes the
+ * journal, in the background if CLICON_XMLDB_ASYNC is set.
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database, eg candidate
+ * @param[in]  to    Target database, eg running
+ * @param[in]  xrec  Journal record from xmldb_journal_record, or NULL
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+xmldb_journal_commit(clicon_handle h,
+                     const char   *from,
+                     const char   *to,
+                     cxobj        *xrec)
+{
+    int         retval = -1;
+    char       *filename = NULL;
+    cbuf       *cb = NULL;
+    FILE       *f = NULL;
+    struct stat st = {0,};
+
+    if (xrec == NULL)
+        return xmldb_async_copy(h, from, to);
+    /* Appending to a journal that is being replaced by a pending write is not possible */
+    if (xmldb_async_barrier(h, to) < 0)
+        goto done;
+    if (xmldb_journal_file(h, to, &filename) < 0)
+        goto done;
+    if (stat(filename, &st) < 0 && errno != ENOENT){
+        clicon_err(OE_UNIX, errno, "stat(%s)", filename);
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, xrec, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    if (st.st_size + cbuf_len(cb) > clicon_option_int(h, "CLICON_XMLDB_JOURNAL_MAX")){
+        clicon_debug(CLIXON_DBG_DEFAULT, "%s %s journal full, write datastore file", __FUNCTION__, to);
+        retval = xmldb_async_copy(h, from, to);
+        goto done;
+    }
+    if (xml_child_nr_type(xrec, CX_ELMNT) > 0){
+        if ((f = fopen(filename, "a")) == NULL){
+            clicon_err(OE_UNIX, errno, "fopen(%s)", filename);
+            goto done;
+        }
+        if (fprintf(f, "#%zu\n%s\n", cbuf_len(cb), cbuf_get(cb)) < 0 ||
+            fflush(f) != 0 ||
+            fsync(fileno(f)) < 0){
+            clicon_err(OE_UNIX, errno, "write(%s)", filename);
+            goto done;
+        }
+    }
+    if (xmldb_copy_cache(h, from, to) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (cb)
+        cbuf_free(cb);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Remove the journal of a datastore, if any
+ *
+ * Called when the full datastore file has been written
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Name of database
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+xmldb_journal_reset(clicon_handle h,
+                    const char   *db)
+{
+    int   retval = -1;
+    char *filename = NULL;
+
+    if (xmldb_async_barrier(h, db) < 0)
+        goto done;
+    if (xmldb_journal_file(h, db, &filename) < 0)
+        goto done;
+    if (unlink(filename) < 0 && errno != ENOENT){
+        clicon_err(OE_UNIX, errno, "unlink(%s)", filename);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Copy the journal of a datastore along with the datastore file
+ *
+ * If the source has no journal, the journal of the destination is removed
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database
+ * @param[in]  to    Destination database
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_copy
+ */
+int
+xmldb_journal_copy(clicon_handle h,
+                   const char   *from,
+                   const char   *to)
+{
+    int         retval = -1;
+    char       *fromfile = NULL;
+    char       *tofile = NULL;
+    struct stat st;
+
+    if (xmldb_journal_file(h, from, &fromfile) < 0)
+        goto done;
+    if (stat(fromfile, &st) < 0){
+        if (xmldb_journal_reset(h, to) < 0)
+            goto done;
+    }
+    else {
+        if (xmldb_journal_file(h, to, &tofile) < 0)
+            goto done;
+        if (clicon_file_copy(fromfile, tofile) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (fromfile)
+        free(fromfile);
+    if (tofile)
+        free(tofile);
+    return retval;
+}
+
+/*! Write the full datastore file if it has a journal, and remove the journal
+ *
+ * Called before the datastore file is used directly, eg renamed
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Name of database
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+xmldb_journal_compact(clicon_handle h,
+                      const char   *db)
+{
+    int         retval = -1;
+    char       *filename = NULL;
+    struct stat st;
+    cxobj      *xt;
+    cxobj      *x0 = NULL;
+    cxobj      *xerr = NULL;
+    int         ret;
+
+    if (xmldb_journal_file(h, db, &filename) < 0)
+        goto done;
+    if (stat(filename, &st) < 0 || st.st_size == 0)
+        goto ok;
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s %s", __FUNCTION__, db);
+    if ((xt = xmldb_cache_get(h, db)) == NULL){
+        /* The journal is replayed when read */
+        if ((ret = xmldb_readfile(h, db, YB_MODULE, clicon_dbspec_yang(h), &x0, NULL, NULL, &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            clixon_netconf_error(xerr, "Compact datastore journal", NULL);
+            goto ok;
+        }
+        xt = x0;
+    }
+    if (xmldb_write_file(h, db, xt, NULL) < 0)
+        goto done;
+    if (xmldb_journal_reset(h, db) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (x0)
+        xml_free(x0);
+    if (xerr)
+        xml_free(xerr);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Replay the journal of a datastore on a tree read from the datastore file
+ *
+ * A truncated last record, eg after a crash while appending, is ignored.
+ * Records are applied in order as merge operations.
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Name of database
+ * @param[in]  yspec Yang spec
+ * @param[in]  x0    Datastore tree, top-level is DATASTORE_TOP_SYMBOL
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+xmldb_journal_replay(clicon_handle h,
+                     const char   *db,
+                     yang_stmt    *yspec,
+                     cxobj        *x0)
+{
+    int     retval = -1;
+    char   *filename = NULL;
+    FILE   *f = NULL;
+    char    hdr[32];
+    char   *buf = NULL;
+    size_t  len;
+    cxobj  *xt = NULL;
+    cxobj  *xrec;
+    cxobj  *xerr = NULL;
+    cbuf   *cbret = NULL;
+    int     nr = 0;
+    int     ret;
+
+    if (xmldb_journal_file(h, db, &filename) < 0)
+        goto done;
+    if ((f = fopen(filename, "r")) == NULL){
+        if (errno == ENOENT)
+            goto ok;
+        clicon_err(OE_UNIX, errno, "fopen(%s)", filename);
+        goto done;
+    }
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    while (fgets(hdr, sizeof(hdr), f) != NULL){
+        if (hdr[0] != '#'){
+            clicon_log(LOG_WARNING, "%s: malformed record %d", filename, nr);
+            break;
+        }
+        len = strtoul(hdr+1, NULL, 10);
+        if ((buf = malloc(len+1)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        if (fread(buf, 1, len, f) != len){
+            clicon_log(LOG_WARNING, "%s: truncated record %d ignored", filename, nr);
+            break;
+        }
+        buf[len] = '\0';
+        (void)fgetc(f); /* newline */
+        if (clixon_xml_parse_string(buf, YB_NONE, NULL, &xt, NULL) < 0)
+            goto done;
+        free(buf);
+        buf = NULL;
+        if ((xrec = xml_child_i_type(xt, 0, CX_ELMNT)) == NULL ||
+            strcmp(xml_name(xrec), NETCONF_INPUT_CONFIG) != 0){
+            clicon_log(LOG_WARNING, "%s: malformed record %d", filename, nr);
+            break;
+        }
+        if ((ret = xml_bind_yang(h, xrec, YB_MODULE, yspec, &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            clixon_netconf_error(xerr, "Datastore journal", NULL);
+            goto done;
+        }
+        /* Records are not sorted, operations are applied in record order */
+        cbuf_reset(cbret);
+        if ((ret = xmldb_modify_tree(h, x0, xrec, yspec, OP_MERGE, cbret)) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_err(OE_DB, 0, "%s: record %d: %s", filename, nr, cbuf_get(cbret));
+            goto done;
+        }
+        xml_free(xt);
+        xt = NULL;
+        nr++;
+    }
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s %s: %d records", __FUNCTION__, db, nr);
+ ok:
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (buf)
+        free(buf);
+    if (xt)
+        xml_free(xt);
+    if (xerr)
+        xml_free(xerr);
+    if (cbret)
+        cbuf_free(cbret);
+    if (filename)
+        free(filename);
+    return retval;
+}
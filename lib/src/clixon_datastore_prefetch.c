@@ -0,0 +1,260 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Parse a datastore file in a background thread, see CLICON_XMLDB_PREFETCH
+  * The backend starts the thread on the startup datastore before loading plugins and YANG,
+  * and the unbound tree is taken by the first read of the datastore, instead of parsing the
+  * file again. Only XML format is prefetched.
+  * The thread does not use the handle. Errors in the thread are not reported: the
+  * datastore is then read again in the main thread which reports them.
+  * The tree is not used if the file has changed since the thread was started.
+  * While the thread runs, the string intern table is locked and error and log state is
+  * owned by the main thread, see clixon_string_intern_lock and clicon_err_thread.
+  * The XML arena needs no lock: it is per tree, and only the owner thread recycles slabs.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_string.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_yang_module.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_options.h"
+#include "clixon_data.h"
+#include "clixon_datastore.h"
+#include "clixon_datastore_read.h"
+
+#ifdef HAVE_LIBPTHREAD
+
+/*! Prefetch state, one per process
+ * The fields below pf_tid are written by the thread and read after join
+ */
+struct xmldb_prefetch{
+    int          pf_running; /* Thread started and not joined */
+    char        *pf_db;      /* Name of database */
+    char        *pf_file;    /* Datastore file */
+    struct stat  pf_st;      /* File status when thread was started */
+    pthread_t    pf_tid;     /* Parser thread */
+    cxobj       *pf_xt;      /* Parsed tree with top-level DATASTORE_TOP_SYMBOL */
+    int          pf_ret;     /* 0 if parsed OK, -1 on error */
+};
+
+static struct xmldb_prefetch _pf = {0, };
+
+/*! Parse datastore file, called in prefetch thread
+ */
+static void *
+prefetch_thread(void *arg)
+{
+    struct xmldb_prefetch *pf = (struct xmldb_prefetch *)arg;
+    FILE                  *fp;
+    cxobj                 *xerr = NULL;
+
+    pf->pf_ret = -1;
+    if ((fp = fopen(pf->pf_file, "r")) == NULL)
+        return NULL;
+    /* Decompress does not use the handle when reading */
+    if (xmldb_compress_wrap(NULL, "r", &fp) == 0 &&
+        xmldb_parse_file_format("xml", fp, NULL, &pf->pf_xt, &xerr) == 0)
+        pf->pf_ret = 0;
+    fclose(fp);
+    if (xerr)
+        xml_free(xerr);
+    return NULL;
+}
+
+/*! Join prefetch thread, if started
+ */
+static void
+prefetch_join(struct xmldb_prefetch *pf)
+{
+    if (!pf->pf_running)
+        return;
+    pthread_join(pf->pf_tid, NULL);
+    pf->pf_running = 0;
+    clixon_string_intern_lock(0);
+    clicon_err_thread(0);
+}
+
+static void
+prefetch_free(struct xmldb_prefetch *pf)
+{
+    if (pf->pf_db)
+        free(pf->pf_db);
+    if (pf->pf_file)
+        free(pf->pf_file);
+    if (pf->pf_xt)
+        xml_free(pf->pf_xt);
+    memset(pf, 0, sizeof(*pf));
+}
+#endif /* HAVE_LIBPTHREAD */
+
+/*! Start parsing a datastore file in a background thread
+ *
+ * Nothing is done if the datastore format is not XML, or the file is empty or missing
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Symbolic database name, eg "startup"
+ * @retval     0     OK, thread started or nothing to prefetch
+ * @retval    -1     Error
+ * @see xmldb_prefetch_take
+ */
+int
+xmldb_prefetch_start(clicon_handle h,
+                     const char   *db)
+{
+#ifdef HAVE_LIBPTHREAD
+    int                    retval = -1;
+    struct xmldb_prefetch *pf = &_pf;
+    char                  *format;
+
+    if (pf->pf_running)
+        return 0;
+    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL ||
+        strcmp(format, "xml") != 0)
+        goto ok;
+    if (xmldb_db2file(h, db, &pf->pf_file) < 0)
+        goto done;
+    if (stat(pf->pf_file, &pf->pf_st) < 0 ||
+        !S_ISREG(pf->pf_st.st_mode) ||
+        pf->pf_st.st_size == 0)
+        goto ok;
+    if ((pf->pf_db = strdup(db)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    clicon_err_thread(1);
+    clixon_string_intern_lock(1);
+    if (pthread_create(&pf->pf_tid, NULL, prefetch_thread, pf) != 0){
+        clixon_string_intern_lock(0);
+        clicon_err_thread(0);
+        clicon_err(OE_UNIX, errno, "pthread_create");
+        goto done;
+    }
+    pf->pf_running = 1;
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s %s", __FUNCTION__, pf->pf_file);
+ ok:
+    retval = 0;
+ done:
+    if (!pf->pf_running)
+        prefetch_free(pf);
+    return retval;
+#else
+    return 0;
+#endif
+}
+
+/*! Take tree parsed by prefetch thread, if any
+ *
+ * Waits for the thread to finish. The tree is only returned once.
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Symbolic database name
+ * @param[out] xp    Unbound XML tree with top-level DATASTORE_TOP_SYMBOL, free with xml_free
+ * @retval     1     OK, tree returned in xp
+ * @retval     0     No prefetched tree of db, or the file has changed, parse the file
+ * @retval    -1     Error
+ * @see xmldb_parse_file
+ */
+int
+xmldb_prefetch_take(clicon_handle h,
+                    const char   *db,
+                    cxobj       **xp)
+{
+#ifdef HAVE_LIBPTHREAD
+    int                    retval = 0;
+    struct xmldb_prefetch *pf = &_pf;
+    struct stat            st;
+
+    if (!pf->pf_running || strcmp(db, pf->pf_db) != 0)
+        return 0;
+    prefetch_join(pf);
+    if (pf->pf_ret == 0 &&
+        stat(pf->pf_file, &st) == 0 &&
+        st.st_ino == pf->pf_st.st_ino &&
+        st.st_size == pf->pf_st.st_size &&
+        st.st_mtim.tv_sec == pf->pf_st.st_mtim.tv_sec &&
+        st.st_mtim.tv_nsec == pf->pf_st.st_mtim.tv_nsec){
+        *xp = pf->pf_xt;
+        pf->pf_xt = NULL;
+        retval = 1;
+    }
+    clicon_debug(CLIXON_DBG_DEFAULT, "%s %s %s", __FUNCTION__, db, retval?"taken":"not used");
+    prefetch_free(pf);
+    return retval;
+#else
+    return 0;
+#endif
+}
+
+/*! Wait for prefetch thread and free the tree if not taken
+ *
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ */
+int
+xmldb_prefetch_exit(clicon_handle h)
+{
+#ifdef HAVE_LIBPTHREAD
+    struct xmldb_prefetch *pf = &_pf;
+
+    prefetch_join(pf);
+    prefetch_free(pf);
+#endif
+    return 0;
+}
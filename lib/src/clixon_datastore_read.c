@@ -71,7 +71,11 @@
 #include "clixon_data.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
+#include "clixon_xpath_yang.h"
+#include "clixon_xml_vec.h"
 #include "clixon_json.h"
+#include "clixon_xml_binary.h"
+#include "clixon_cbor.h"
 #include "clixon_nacm.h"
 #include "clixon_path.h"
 #include "clixon_netconf_lib.h"
@@ -83,6 +87,9 @@
 #include "clixon_xml_nsctx.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_read.h"
+#include "clixon_datastore_journal.h"
+#include "clixon_datastore_split.h"
+#include "clixon_probe.h"
 
 #define handle(xh) (assert(text_handle_check(xh)==0),(struct text_handle *)(xh))
 
@@ -207,15 +214,93 @@ xml_copy_bottom_recurse(cxobj  *x0t,
     return retval;
 }
 
+/*! Copy an XML tree down to a given depth
+ *
+ * Below the depth, ie when depth is 0, a node is copied without element children, except
+ * the keys of a list entry and the children of a non-presence container. This is enough
+ * to decide if a node is an empty non-presence container in the same way as in a complete
+ * copy, see xml_defaults_nopresence, and to merge state data into list entries.
+ * @param[in]  x0     Original tree
+ * @param[in]  x1     Copy, created before the call
+ * @param[in]  depth  Nr of levels of element children to copy
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xml_copy  for a complete copy
+ */
+static int
+xml_copy_depth(cxobj  *x0,
+               cxobj  *x1,
+               int32_t depth)
+{
+    int        retval = -1;
+    yang_stmt *y;
+    cxobj     *x;
+    cxobj     *xcopy;
+    cg_var    *cv;
+    cg_var    *cvi;
+    int        np = 0;
+
+    if (xml_copy_one(x0, x1) < 0)
+        goto done;
+    y = xml_spec(x0);
+    if (depth == 0 && y && yang_keyword_get(y) == Y_CONTAINER &&
+        yang_find(y, Y_PRESENCE, NULL) == NULL)
+        np = 1;
+    x = NULL;
+    while ((x = xml_child_each(x0, x, -1)) != NULL) {
+        if (xml_type(x) == CX_ELMNT && depth == 0 && !np)
+            continue;
+        if ((xcopy = xml_new(xml_name(x), x1, xml_type(x))) == NULL)
+            goto done;
+        if (xml_type(x) != CX_ELMNT){
+            if (xml_copy(x, xcopy) < 0)
+                goto done;
+        }
+        else if (xml_copy_depth(x, xcopy, depth?depth-1:0) < 0) /* recursion */
+            goto done;
+    }
+    /* Key nodes in lists are copied also below the depth */
+    if (depth == 0 && y && yang_keyword_get(y) == Y_LIST){
+        cvi = NULL;
+        while ((cvi = cvec_each(yang_cvec_get(y), cvi)) != NULL) {
+            if ((x = xml_find_type(x0, NULL, cv_string_get(cvi), CX_ELMNT)) != NULL){
+                if ((xcopy = xml_new(xml_name(x), x1, CX_ELMNT)) == NULL)
+                    goto done;
+                if (xml_copy(x, xcopy) < 0) 
+                    goto done;
+            }
+        }
+    }
+    /* Copy typed value after body, since setting the body clears it */
+    if ((cv = xml_cv(x0)) != NULL && xml_cv_native(cv_type_get(cv))){
+        if ((cv = cv_dup(cv)) == NULL){
+            clicon_err(OE_UNIX, errno, "cv_dup");
+            goto done;
+        }
+        if (xml_cv_set(x1, cv) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Copy an XML tree bottom-up
  *
- * @retval     0    OK
- * @retval    -1    General error, check specific clicon_errno, clicon_suberrno
+ * @param[in]  x0t    Top of original tree
+ * @param[in]  x0     Node in original tree to copy with ancestors
+ * @param[in]  x1t    Top of copy
+ * @param[in]  depth  Nr of levels below x0t to copy of x0, -1 is all, see xml_copy_depth
+ * @param[out] x1p    Copy of x0, if not NULL
+ * @retval     0      OK
+ * @retval    -1      General error, check specific clicon_errno, clicon_suberrno
  */
 static int
 xml_copy_from_bottom(cxobj  *x0t, 
                      cxobj  *x0,
-                     cxobj  *x1t)
+                     cxobj  *x1t,
+                     int32_t depth,
+                     cxobj **x1p0)
 {
     int        retval = -1;
     cxobj     *x1p    = NULL;
@@ -236,15 +321,63 @@ xml_copy_from_bottom(cxobj  *x0t,
     if (x1 == NULL){ /* If not, create it and copy complete tree */
         if ((x1 = xml_new(xml_name(x0), x1p, CX_ELMNT)) == NULL)
             goto done;
-        if (xml_copy(x0, x1) < 0)
-            goto done;
+        if (depth < 0){
+            if (xml_copy(x0, x1) < 0)
+                goto done;
+        }
+        else {
+            /* Levels of x0 itself and its ancestors are not counted as copied */
+            for (x0p = xml_parent(x0); x0p && x0p != x0t; x0p = xml_parent(x0p))
+                depth--;
+            if (xml_copy_depth(x0, x1, depth>0?depth:0) < 0)
+                goto done;
+        }
     }
+    if (x1p0)
+        *x1p0 = x1;
  ok:
     retval = 0;
  done:
     return retval;
 }
 
+/*! Check if two module-sets have the same modules and revisions in the same order
+ *
+ * @param[in]  xmod1  Module-set or modules-state
+ * @param[in]  xmod2  Module-set or modules-state
+ * @retval     1      Equal
+ * @retval     0      Not equal
+ */
+static int
+modstate_equal(cxobj *xmod1,
+               cxobj *xmod2)
+{
+    cxobj *x1 = NULL;
+    cxobj *x2 = NULL;
+    char  *b1;
+    char  *b2;
+
+    while (1){
+        while ((x1 = xml_child_each(xmod1, x1, CX_ELMNT)) != NULL &&
+               strcmp(xml_name(x1), "module") != 0)
+            ;
+        while ((x2 = xml_child_each(xmod2, x2, CX_ELMNT)) != NULL &&
+               strcmp(xml_name(x2), "module") != 0)
+            ;
+        if (x1 == NULL || x2 == NULL)
+            break;
+        if ((b1 = xml_find_body(x1, "name")) == NULL ||
+            (b2 = xml_find_body(x2, "name")) == NULL ||
+            strcmp(b1, b2) != 0)
+            return 0;
+        if ((b1 = xml_find_body(x1, "revision")) == NULL ||
+            (b2 = xml_find_body(x2, "revision")) == NULL ||
+            strcmp(b1, b2) != 0)
+            return 0;
+    }
+    return x1 == NULL && x2 == NULL;
+}
+
 /*! Read module-state in an XML tree
  *
  * @param[in]  th     Datastore text handle
@@ -271,6 +404,8 @@ xml_copy_from_bottom(cxobj  *x0t,
  *    3c) File module-state does not match system -> add to list mark as CHANGE
  * 4) For each module state s in the system
  *    4a) If there is no such module in the file -> add to list mark as ADD
+ * If the file lists the same modules and revisions as the system, in the same order, 3) and 4)
+ * are skipped. Otherwise, modules are looked up by name in hash tables.
  */
 static int
 text_read_modstate(clicon_handle       h,
@@ -291,6 +426,9 @@ text_read_modstate(clicon_handle       h,
     char  *frev;              /* file revision */
     char  *srev;              /* system revision */
     int    rfc7895=0;         /* backward-compatible: old version */
+    clicon_hash_t *hsys = NULL;  /* system module name -> xs */
+    clicon_hash_t *hfile = NULL; /* file module names */
+    void  *val;
 
     /* Read module-state as computed at startup, see startup_module_state() */
     if ((xmodcache = clicon_modst_cache_get(h, 1)) != NULL)
@@ -312,32 +450,42 @@ text_read_modstate(clicon_handle       h,
         if (xml_rootchild(msdiff->md_diff, 0, &msdiff->md_diff) < 0) 
             goto done;
 
-        if (!rfc7895){
-            if ((xf = xpath_first(xt, NULL, "yang-library/content-id")) != NULL){
-                if (xml_body(xf) && (msdiff->md_content_id = strdup(xml_body(xf))) == NULL){
-                    clicon_err(OE_UNIX, errno, "strdup");
-                    goto done;
-                }
-            }
+        if (!rfc7895)
+            xf = xpath_first(xt, NULL, "yang-library/content-id");
+        else
+            xf = xml_find_type(xmodfile, NULL, "module-set-id", CX_ELMNT);
+        if (xf && xml_body(xf) && (msdiff->md_content_id = strdup(xml_body(xf))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        /* Fast path: same modules and revisions as the system */
+        if (modstate_equal(xmodfile, xmodsystem))
+            goto purge;
+        if ((hsys = clicon_hash_init()) == NULL ||
+            (hfile = clicon_hash_init()) == NULL)
+            goto done;
+        xs = NULL;
+        while ((xs = xml_child_each(xmodsystem, xs, CX_ELMNT)) != NULL) {
+            if (strcmp(xml_name(xs), "module"))
+                continue;
+            if ((name = xml_find_body(xs, "name")) == NULL)
+                continue;
+            /* First module of a name, as xpath lookup */
+            if (clicon_hash_lookup(hsys, name) == NULL &&
+                clicon_hash_add(hsys, name, &xs, sizeof(xs)) == NULL)
+                goto done;
         }
         /* 3) For each module state m in the file */
         xf = NULL;
         while ((xf = xml_child_each(xmodfile, xf, CX_ELMNT)) != NULL) {
-            if (rfc7895){
-                if (strcmp(xml_name(xf), "module-set-id") == 0){
-                    if (xml_body(xf) && (msdiff->md_content_id = strdup(xml_body(xf))) == NULL){
-                        clicon_err(OE_UNIX, errno, "strdup");
-                        goto done;
-                    }
-                    continue;
-                }
-            }
             if (strcmp(xml_name(xf), "module"))
                 continue; /* ignore other tags, such as module-set-id */
             if ((name = xml_find_body(xf, "name")) == NULL)
                 continue;
+            if (clicon_hash_add(hfile, name, NULL, 0) == NULL)
+                goto done;
             /* 3a) There is no such module in the system */
-            if ((xs = xpath_first(xmodsystem, NULL, "module[name=\"%s\"]", name)) == NULL){
+            if ((val = clicon_hash_value(hsys, name, NULL)) == NULL){
                 if ((xf2 = xml_dup(xf)) == NULL)          /* Make a copy of this modstate */
                     goto done;
                 if (xml_addsub(msdiff->md_diff, xf2) < 0)   /* Add it to modstatediff */
@@ -345,6 +493,7 @@ text_read_modstate(clicon_handle       h,
                 xml_flag_set(xf2, XML_FLAG_DEL);
                 continue;
             }
+            xs = *(cxobj **)val;
             /* These two shouldnt happen since revision is key, just ignore */
             if ((frev = xml_find_body(xf, "revision")) == NULL)
                 continue;
@@ -367,7 +516,7 @@ text_read_modstate(clicon_handle       h,
             if ((name = xml_find_body(xs, "name")) == NULL)
                 continue;
             /* 4a) If there is no such module in the file -> add to list mark as ADD */     
-            if ((xf = xpath_first(xmodfile, NULL, "module[name=\"%s\"]", name)) == NULL){
+            if (clicon_hash_lookup(hfile, name) == NULL){
                 if ((xs2 = xml_dup(xs)) == NULL)          /* Make a copy of this modstate */
                     goto done;
                 if (xml_addsub(msdiff->md_diff, xs2) < 0)   /* Add it to modstatediff */
@@ -377,6 +526,7 @@ text_read_modstate(clicon_handle       h,
             }
         }
     }
+ purge:
     /* The module-state is removed from the input XML tree. This is done
      * in all cases, whether CLICON_XMLDB_MODSTATE is on or not.
      * Clixon systems with CLICON_XMLDB_MODSTATE disabled ignores it
@@ -392,6 +542,10 @@ text_read_modstate(clicon_handle       h,
                 goto done;
     retval = 0;
  done:
+    if (hsys)
+        clicon_hash_free(hsys);
+    if (hfile)
+        clicon_hash_free(hfile);
     return retval;
 }
 
@@ -442,32 +596,125 @@ disable_nacm_on_empty(cxobj     *xt,
     return retval;
 }
 
-/*! Common read function that reads an XML tree from file
+/*! Parse a datastore file of a given format into an XML tree with top-level DATASTORE_TOP_SYMBOL
  *
- * @param[in]  th     Datastore text handle
- * @param[in]  db     Symbolic database name, eg "candidate", "running"
- * @param[in]  yb     How to bind yang to XML top-level when parsing
+ * The tree is not bound to YANG. Does not use the handle and may be called from a thread
+ * @param[in]  format Datastore format, see CLICON_XMLDB_FORMAT
+ * @param[in]  fp     Open datastore file
+ * @param[in]  yspec  Top-level yang spec, or NULL
+ * @param[out] xp     XML tree, free with xml_free
+ * @param[out] xerr   XML error
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xmldb_prefetch_start
+ */
+int
+xmldb_parse_file_format(const char *format,
+                        FILE       *fp,
+                        yang_stmt  *yspec,
+                        cxobj     **xp,
+                        cxobj     **xerr)
+{
+    int    retval = -1;
+    cxobj *x0 = NULL;
+
+    /* ret == 0 should not happen with YB_NONE. Binding is done later */
+    if (strcmp(format, "json")==0){
+        if (clixon_json_parse_file(fp, 1, YB_NONE, yspec, &x0, xerr) < 0) 
+            goto done;
+    }
+    else if (strcmp(format, "binary")==0){
+        if (clixon_binary_parse_file(fp, YB_NONE, yspec, &x0, xerr) < 0)
+            goto done;
+    }
+    else if (strcmp(format, "cbor")==0){
+        if (clixon_cbor_parse_file(fp, YB_NONE, yspec, &x0, xerr) < 0)
+            goto done;
+    }
+    else {
+        if (clixon_xml_parse_file(fp, YB_NONE, yspec, &x0, xerr) < 0){
+            goto done;
+        }
+    }
+    /* Always assert a top-level called "config". 
+     * To ensure that, deal with two cases:
+     * 1. File is empty <top/> -> rename top-level to "config" 
+     */
+    if (xml_child_nr(x0) == 0){ 
+        if (xml_name_set(x0, DATASTORE_TOP_SYMBOL) < 0)
+            goto done;     
+    }
+    /* 2. File is not empty <top><config>...</config></top> -> replace root */
+    else{ 
+        /* There should only be one element and called config */
+        if (singleconfigroot(x0, &x0) < 0)
+            goto done;
+    }
+    *xp = x0;
+    x0 = NULL;
+    retval = 0;
+ done:
+    if (x0)
+        xml_free(x0);
+    return retval;
+}
+
+/*! Parse a datastore file into an XML tree with top-level DATASTORE_TOP_SYMBOL
+ *
+ * The tree is not bound to YANG, the format is given by CLICON_XMLDB_FORMAT
+ * @param[in]  h      Clicon handle
+ * @param[in]  fp     Open datastore file
  * @param[in]  yspec  Top-level yang spec
- * @param[out] xp     XML tree read from file
- * @param[out] de     If set, return db-element status (eg empty flag)
- * @param[out] msdiff If set, return modules-state differences
- * @param[out] xerr   XML error if retval is 0
- * @retval     1      OK
- * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
- * @retval    -1      General error, check specific clicon_errno, clicon_suberrno
- * @note Use of 1 for OK
- * @note retval 0 is NYI because calling functions cannot handle it yet
- * XXX if this code pass tests this code can be rewritten, esp the modstate stuff
+ * @param[out] xp     XML tree, free with xml_free
+ * @param[out] xerr   XML error
+ * @retval     0      OK
+ * @retval    -1      Error
  */
 int
-xmldb_readfile(clicon_handle    h,
-               const char      *db,
-               yang_bind        yb,
-               yang_stmt       *yspec,
-               cxobj          **xp,
-               db_elmnt        *de,
-               modstate_diff_t *msdiff0,
-               cxobj          **xerr)
+xmldb_parse_file(clicon_handle h,
+                 FILE         *fp,
+                 yang_stmt    *yspec,
+                 cxobj       **xp,
+                 cxobj       **xerr)
+{
+    char *format;
+
+    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
+        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
+        return -1;
+    }
+    return xmldb_parse_file_format(format, fp, yspec, xp, xerr);
+}
+
+/*! Read an XML tree from file, with only some of the modules of a split datastore
+ *
+ * @param[in]  th      Datastore text handle
+ * @param[in]  db      Symbolic database name, eg "candidate", "running"
+ * @param[in]  yb      How to bind yang to XML top-level when parsing
+ * @param[in]  yspec   Top-level yang spec
+ * @param[in]  modules Only read these module files of a split datastore, or NULL for all
+ * @param[out] xp      XML tree read from file
+ * @param[out] de      If set, return db-element status (eg empty flag)
+ * @param[out] msdiff  If set, return modules-state differences
+ * @param[out] xerr    XML error if retval is 0
+ * @retval     1       OK
+ * @retval     0       Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval    -1       General error, check specific clicon_errno, clicon_suberrno
+ * @note If modules is set, the tree is partial and should not be cached, and de is not
+ *       meaningful
+ * XXX if this code pass tests this code can be rewritten, esp the modstate stuff
+ * @see xmldb_readfile
+ */
+static int
+xmldb_readfile_modules(clicon_handle    h,
+                       const char      *db,
+                       yang_bind        yb,
+                       yang_stmt       *yspec,
+                       cvec            *modules,
+                       cxobj          **xp,
+                       db_elmnt        *de,
+                       modstate_diff_t *msdiff0,
+                       cxobj          **xerr)
 {
     int              retval = -1;
     cxobj           *x0 = NULL;
@@ -485,11 +732,15 @@ xmldb_readfile(clicon_handle    h,
     cxobj           *xmodfile = NULL;
     cxobj           *x;
     yang_stmt       *yspec1 = NULL;
+    char            *jfile = NULL;
+    struct stat      st;
 
     if (yb != YB_MODULE && yb != YB_NONE){
         clicon_err(OE_XML, EINVAL, "yb is %d but should be module or none", yb);
         goto done;
     }
+    if (xmldb_async_barrier(h, db) < 0)
+        goto done;
     if (xmldb_db2file(h, db, &dbfile) < 0)
         goto done;
     if (dbfile==NULL){
@@ -501,40 +752,37 @@ xmldb_readfile(clicon_handle    h,
         goto done;
     }
     clicon_debug(CLIXON_DBG_DEFAULT, "Reading datastore %s using %s", dbfile, format);
-    /* Parse file into internal XML tree from different formats */
-    if ((fp = fopen(dbfile, "r")) == NULL) {
-        clicon_err(OE_UNIX, errno, "open(%s)", dbfile);
+    /* Take the tree if already parsed by a background thread, see xmldb_prefetch_start */
+    if ((ret = xmldb_prefetch_take(h, db, &x0)) < 0)
         goto done;
-    }    
-    /* Read whole datastore file on the form:
-     * <config>
-     *   modstate*  # this is analyzed, stripped and returned as msdiff in text_read_modstate
-     *   config*
-     * </config>
-     * ret == 0 should not happen with YB_NONE. Binding is done later */
-    if (strcmp(format, "json")==0){
-        if (clixon_json_parse_file(fp, 1, YB_NONE, yspec, &x0, xerr) < 0) 
+    if (ret == 0){
+        /* Parse file into internal XML tree from different formats */
+        if ((fp = fopen(dbfile, "r")) == NULL) {
+            clicon_err(OE_UNIX, errno, "open(%s)", dbfile);
             goto done;
-    }
-    else {
-        if (clixon_xml_parse_file(fp, YB_NONE, yspec, &x0, xerr) < 0){
+        }    
+        /* Decompress if compressed, see CLICON_XMLDB_COMPRESS */
+        if (xmldb_compress_wrap(h, "r", &fp) < 0)
+            goto done;
+        /* Read whole datastore file on the form:
+         * <config>
+         *   modstate*  # this is analyzed, stripped and returned as msdiff in text_read_modstate
+         *   config*
+         * </config>
+         */
+        if (xmldb_parse_file(h, fp, yspec, &x0, xerr) < 0)
             goto done;
-        }
-    }
-    /* Always assert a top-level called "config". 
-     * To ensure that, deal with two cases:
-     * 1. File is empty <top/> -> rename top-level to "config" 
-     */
-    if (xml_child_nr(x0) == 0){ 
-        if (xml_name_set(x0, DATASTORE_TOP_SYMBOL) < 0)
-            goto done;     
     }
-    /* 2. File is not empty <top><config>...</config></top> -> replace root */
-    else{ 
-        /* There should only be one element and called config */
-        if (singleconfigroot(x0, &x0) < 0)
+    /* A journal may change any module, then read all */
+    if (modules){
+        if (xmldb_journal_file(h, db, &jfile) < 0)
             goto done;
+        if (stat(jfile, &st) == 0)
+            modules = NULL;
     }
+    /* Add the module files of a split datastore, see CLICON_XMLDB_SPLIT */
+    if (xmldb_split_read(h, db, yspec, modules, x0, xerr) < 0)
+        goto done;
     /* Purge all top-level body objects */
     x = NULL;
     while ((x = xml_find_type(x0, NULL, "body", CX_BODY)) != NULL)
@@ -629,7 +877,10 @@ xmldb_readfile(clicon_handle    h,
             goto done;
         if (ret == 0)
             goto fail;
-        if (xml_sort_recurse(x0) < 0)
+        if (xml_sort_recurse_parallel(x0, clicon_option_int(h, "CLICON_XML_SORT_THREADS")) < 0)
+            goto done;
+        /* Apply commits made after the datastore file was written, see CLICON_XMLDB_JOURNAL */
+        if (xmldb_journal_replay(h, db, yspec1?yspec1:yspec, x0) < 0)
             goto done;
     }
     if (xp){
@@ -651,6 +902,8 @@ xmldb_readfile(clicon_handle    h,
         modstate_diff_free(msdiff);
     if (fp)
         fclose(fp);
+    if (jfile)
+        free(jfile);
     if (dbfile)
         free(dbfile);
     if (x0)
@@ -661,60 +914,65 @@ xmldb_readfile(clicon_handle    h,
     goto done;
 }
 
-/*! Get content of database using xpath. return a set of matching sub-trees
+/*! Common read function that reads an XML tree from file
  *
- * The function returns a minimal tree that includes all sub-trees that match
- * xpath.
- * This is a clixon datastore plugin of the the xmldb api
- * @param[in]  h      Clicon handle
- * @param[in]  db     Name of database to search in (filename including dir path
+ * @param[in]  th     Datastore text handle
+ * @param[in]  db     Symbolic database name, eg "candidate", "running"
  * @param[in]  yb     How to bind yang to XML top-level when parsing
- * @param[in]  nsc    External XML namespace context, or NULL
- * @param[in]  xpath  String with XPATH syntax. or NULL for all
- * @param[in]  wdef   With-defaults parameter, see RFC 6243
- * @param[out] xret   Single return XML tree. Free with xml_free()
+ * @param[in]  yspec  Top-level yang spec
+ * @param[out] xp     XML tree read from file
+ * @param[out] de     If set, return db-element status (eg empty flag)
  * @param[out] msdiff If set, return modules-state differences
  * @param[out] xerr   XML error if retval is 0
  * @retval     1      OK
  * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
  * @retval    -1      General error, check specific clicon_errno, clicon_suberrno
  * @note Use of 1 for OK
- * @see xmldb_get  the generic API function
+ * @note retval 0 is NYI because calling functions cannot handle it yet
  */
-static int
-xmldb_get_nocache(clicon_handle    h,
-                  const char      *db, 
-                  yang_bind        yb,
-                  cvec            *nsc,
-                  const char      *xpath,
-                  withdefaults_type wdef,
-                  cxobj          **xtop,
-                  modstate_diff_t *msdiff,
-                  cxobj          **xerr)
+int
+xmldb_readfile(clicon_handle    h,
+               const char      *db,
+               yang_bind        yb,
+               yang_stmt       *yspec,
+               cxobj          **xp,
+               db_elmnt        *de,
+               modstate_diff_t *msdiff,
+               cxobj          **xerr)
+{
+    return xmldb_readfile_modules(h, db, yb, yspec, NULL, xp, de, msdiff, xerr);
+}
+
+/*! Filter a datastore tree read from file with xpath and add default values
+ *
+ * Nodes not matching xpath are removed and default values are added and removed according
+ * to with-defaults, as when reading a datastore without cache
+ * @param[in]  h      Clicon handle
+ * @param[in]  xt     Datastore tree <config>...</config>, modified
+ * @param[in]  yb     How the tree is bound to yang, no defaults are added if YB_NONE
+ * @param[in]  yspec  Top-level yang spec
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPATH syntax. or NULL for all
+ * @param[in]  wdef   With-defaults parameter, see RFC 6243
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xmldb_snapshot_get
+ */
+int
+xmldb_get_filter(clicon_handle     h,
+                 cxobj            *xt,
+                 yang_bind         yb,
+                 yang_stmt        *yspec,
+                 cvec             *nsc,
+                 const char       *xpath,
+                 withdefaults_type wdef)
 {
     int        retval = -1;
-    yang_stmt *yspec;
-    cxobj     *xt = NULL;
     cxobj     *x;
-    int        fd = -1;
     cxobj    **xvec = NULL;
     size_t     xlen;
     int        i;
-    int        ret;
-    db_elmnt   de0 = {0,};
 
-    if ((yspec = clicon_dbspec_yang(h)) == NULL){
-        clicon_err(OE_YANG, ENOENT, "No yang spec");
-        goto done;
-    }
-    /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
-    if ((ret = xmldb_readfile(h, db, yb, yspec, &xt, &de0, msdiff, xerr)) < 0)
-        goto done;
-    if (ret == 0)
-        goto fail;
-    clicon_db_elmnt_set(h, db, &de0); /* Content is copied */    
-    
-    /* Here xt looks like: <config>...</config> */
     /* Given the xpath, return a vector of matches in xvec */
     if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
         goto done;
@@ -733,7 +991,7 @@ xmldb_get_nocache(clicon_handle    h,
         if (xml_tree_prune_flagged_sub(xt, XML_FLAG_MARK, 1, NULL) < 0)
             goto done;
     /* reset flag */
-    if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
+    if (xml_flag_reset_rec(xt, XML_FLAG_MARK) < 0)
         goto done;
 
     if (yb != YB_NONE){
@@ -798,27 +1056,11 @@ xmldb_get_nocache(clicon_handle    h,
         if (disable_nacm_on_empty(xt, yspec) < 0)
             goto done;
     }
-#if 0 /* debug */
-    if (xml_apply0(xt, -1, xml_sort_verify, NULL) < 0)
-        clicon_log(LOG_NOTICE, "%s: sort verify failed #2", __FUNCTION__);
-#endif
-    if (clicon_debug_get()>1)
-        if (clixon_xml2file(stderr, xt, 0, 1, NULL, fprintf, 0, 0) < 0)
-            goto done;
-    *xtop = xt;
-    xt = NULL;
-    retval = 1;
+    retval = 0;
  done:
-    if (xt)
-        xml_free(xt);
     if (xvec)
         free(xvec);
-    if (fd != -1)
-        close(fd);
     return retval;
- fail:
-    retval = 0;
-    goto done;
 }
 
 /*! Get content of database using xpath. return a set of matching sub-trees
@@ -832,7 +1074,7 @@ xmldb_get_nocache(clicon_handle    h,
  * @param[in]  nsc    External XML namespace context, or NULL
  * @param[in]  xpath  String with XPATH syntax. or NULL for all
  * @param[in]  wdef   With-defaults parameter, see RFC 6243
- * @param[out] xtop   Single return XML tree. Free with xml_free()
+ * @param[out] xret   Single return XML tree. Free with xml_free()
  * @param[out] msdiff If set, return modules-state differences
  * @param[out] xerr   XML error if retval is 0
  * @retval     1      OK
@@ -842,33 +1084,171 @@ xmldb_get_nocache(clicon_handle    h,
  * @see xmldb_get  the generic API function
  */
 static int
-xmldb_get_cache(clicon_handle     h,
-                const char       *db, 
-                yang_bind         yb,
-                cvec             *nsc,
-                const char       *xpath,
-                withdefaults_type wdef,
-                cxobj           **xtop,
-                modstate_diff_t  *msdiff,
-                cxobj           **xerr)
+xmldb_get_nocache(clicon_handle    h,
+                  const char      *db, 
+                  yang_bind        yb,
+                  cvec            *nsc,
+                  const char      *xpath,
+                  withdefaults_type wdef,
+                  cxobj          **xtop,
+                  modstate_diff_t *msdiff,
+                  cxobj          **xerr)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *xt = NULL;
+    int        fd = -1;
+    int        ret;
+    db_elmnt   de0 = {0,};
+    cvec      *modules = NULL;
 
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    /* Only read the module files of a split datastore that the xpath selects */
+    if (yb == YB_MODULE && clicon_option_bool(h, "CLICON_XMLDB_SPLIT"))
+        if (xmldb_split_modules(h, nsc, xpath, &modules) < 0)
+            goto done;
+    /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
+    if ((ret = xmldb_readfile_modules(h, db, yb, yspec, modules, &xt,
+                                      modules?NULL:&de0, msdiff, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (modules == NULL) /* Partial tree says nothing of db-element */
+        clicon_db_elmnt_set(h, db, &de0); /* Content is copied */
+    
+    /* Here xt looks like: <config>...</config> */
+    if (xmldb_get_filter(h, xt, yb, yspec, nsc, xpath, wdef) < 0)
+        goto done;
+#if 0 /* debug */
+    if (xml_apply0(xt, -1, xml_sort_verify, NULL) < 0)
+        clicon_log(LOG_NOTICE, "%s: sort verify failed #2", __FUNCTION__);
+#endif
+    if (clicon_debug_get()>1)
+        if (clixon_xml2file(stderr, xt, 0, 1, NULL, fprintf, 0, 0) < 0)
+            goto done;
+    *xtop = xt;
+    xt = NULL;
+    retval = 1;
+ done:
+    if (xt)
+        xml_free(xt);
+    if (modules)
+        cvec_free(modules);
+    if (fd != -1)
+        close(fd);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Page of a list for list pagination, see xmldb_get_page
+ */
+struct xmldb_page {
+    char      *pg_parent;   /* Xpath of parent of list */
+    yang_stmt *pg_ylist;    /* Yang list or leaf-list */
+    cxobj     *pg_cursor;   /* Page starts after this entry, or NULL */
+    uint32_t   pg_offset;
+    uint32_t   pg_limit;
+    int        pg_notfound; /* Set if cursor entry of ordered-by user list not found */
+};
+
+/*! Find entries of a page of a list in the cache
+ *
+ * @param[in]  x0t    Cached top of tree
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  pg     Page
+ * @param[out] xvecp  Entries of the page, free with free()
+ * @param[out] xlenp  Number of entries
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+xmldb_page_vec(cxobj             *x0t,
+               cvec              *nsc,
+               struct xmldb_page *pg,
+               cxobj           ***xvecp,
+               size_t            *xlenp)
+{
+    int          retval = -1;
+    cxobj      **pvec = NULL;
+    size_t       plen;
+    clixon_xvec *xv = NULL;
+    int          len;
+    int          i;
+    int          ret;
+
+    if (xpath_vec(x0t, nsc, "%s", &pvec, &plen, pg->pg_parent) < 0)
+        goto done;
+    if ((xv = clixon_xvec_new()) == NULL)
+        goto done;
+    /* Pagination is per list instance */
+    for (i=0; i<plen; i++){
+        if ((ret = clixon_xml_find_page(pvec[i], pg->pg_ylist, pg->pg_cursor,
+                                        pg->pg_offset, pg->pg_limit, xv)) < 0)
+            goto done;
+        if (ret == 0)
+            pg->pg_notfound = 1;
+    }
+    if (clixon_xvec_extract(xv, xvecp, &len, NULL) < 0)
+        goto done;
+    *xlenp = len;
+    retval = 0;
+ done:
+    if (xv)
+        clixon_xvec_free(xv);
+    if (pvec)
+        free(pvec);
+    return retval;
+}
+
+/*! Get the cached tree of a database, read it from file on a cache miss
+ *
+ * The tree is bound to yang and, unless the xpath does not depend on default values,
+ * default values are added to it
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Name of database
+ * @param[in]  yb     How to bind yang to XML top-level when parsing
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPATH syntax. or NULL for all
+ * @param[out] x0tp   Cached top of tree
+ * @param[out] dfltp  Set if default values are not added, see xml_defaults_xpath
+ * @param[out] msdiff If set, return modules-state differences
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     1      OK
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval    -1      General error, check specific clicon_errno, clicon_suberrno
+ * @see xmldb_get_cache
+ */
+static int
+xmldb_cache_tree(clicon_handle     h,
+                 const char       *db, 
+                 yang_bind         yb,
+                 cvec             *nsc,
+                 const char       *xpath,
+                 cxobj           **x0tp,
+                 int              *dfltp,
+                 modstate_diff_t  *msdiff,
+                 cxobj           **xerr)
 {
     int        retval = -1;
     yang_stmt *yspec;
     cxobj     *x0t = NULL; /* (cached) top of tree */
-    cxobj     *x0;
-    cxobj    **xvec = NULL;
-    size_t     xlen;
-    int        i;
     db_elmnt  *de = NULL;
-    cxobj     *x1t = NULL;
     db_elmnt   de0 = {0,};
     int        ret;
+    int        dflt = 0; /* Add default values to copy, not to cache */
 
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_YANG, ENOENT, "No yang spec");
         goto done;
     }
+    if (yb == YB_MODULE &&
+        (dflt = xml_defaults_xpath(yspec, nsc, xpath)) < 0)
+        goto done;
     de = clicon_db_elmnt_get(h, db);
     if (de == NULL || de->de_xml == NULL){ /* Cache miss, read XML from file */
         /* If there is no xml x0 tree (in cache), then read it from file */
@@ -881,19 +1261,27 @@ xmldb_get_cache(clicon_handle     h,
          * No, argument against: we may want to have a semantically wrong file and wish to edit?
          */
         de0.de_xml = x0t;
-        if (de)
+        if (de){
             de0.de_id = de->de_id;
+            /* Keep state of an evicted cache, see xmldb_cache_evict */
+            de0.de_modified = de->de_modified;
+            de0.de_version = de->de_version;
+            de0.de_mtime = de->de_mtime;
+        }
+        xmldb_cache_touch(&de0);
         clicon_db_elmnt_set(h, db, &de0); /* Content is copied */
     } /* x0t == NULL */
-    else
+    else{
         x0t = de->de_xml;
+        xmldb_cache_touch(de);
+    }
 
     if (yb == YB_MODULE && !xml_spec(x0t)){
         if ((ret = xml_bind_yang(h, x0t, YB_MODULE, yspec, xerr)) < 0)
             goto done;
         if (ret == 0)
             ; /* XXX */
-        else {
+        else if (!dflt) {
             /* Add default global values (to make xpath below include defaults) */
             if (xml_global_defaults(h, x0t, nsc, xpath, yspec, 0) < 0)
                 goto done;
@@ -902,6 +1290,72 @@ xmldb_get_cache(clicon_handle     h,
                 goto done;
         }
     }
+    *x0tp = x0t;
+    *dfltp = dflt;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get content of database using xpath. return a set of matching sub-trees
+ *
+ * The function returns a minimal tree that includes all sub-trees that match
+ * xpath.
+ * This is a clixon datastore plugin of the the xmldb api
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Name of database to search in (filename including dir path
+ * @param[in]  yb     How to bind yang to XML top-level when parsing
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPATH syntax. or NULL for all
+ * @param[in]  pg     Page of list given by xpath, or NULL for all matches of xpath
+ * @param[in]  depth  Nr of levels of data nodes to copy, -1 is all, see xmldb_get_depth
+ * @param[in]  wdef   With-defaults parameter, see RFC 6243
+ * @param[out] xtop   Single return XML tree. Free with xml_free()
+ * @param[out] msdiff If set, return modules-state differences
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     1      OK
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval    -1      General error, check specific clicon_errno, clicon_suberrno
+ * @note Use of 1 for OK
+ * @see xmldb_get  the generic API function
+ */
+static int
+xmldb_get_cache(clicon_handle     h,
+                const char       *db, 
+                yang_bind         yb,
+                cvec             *nsc,
+                const char       *xpath,
+                struct xmldb_page *pg,
+                int32_t           depth,
+                withdefaults_type wdef,
+                cxobj           **xtop,
+                modstate_diff_t  *msdiff,
+                cxobj           **xerr)
+
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *x0t = NULL; /* (cached) top of tree */
+    cxobj     *x0;
+    cxobj    **xvec = NULL;
+    size_t     xlen;
+    int        i;
+    cxobj     *x1t = NULL;
+    cxobj     *x1;
+    int        ret;
+    int        dflt = 0; /* Add default values to copy, not to cache */
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((ret = xmldb_cache_tree(h, db, yb, nsc, xpath, &x0t, &dflt, msdiff, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
     /* Here x0t looks like: <config>...</config> */
     /* Given the xpath, return a vector of matches in xvec 
      * Can we do everything in one go?
@@ -911,23 +1365,43 @@ xmldb_get_cache(clicon_handle     h,
      *   a) for every node that is found, copy to new tree
      *   b) if config dont dont state data
      */
-    if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+    if (pg){
+        if (xmldb_page_vec(x0t, nsc, pg, &xvec, &xlen) < 0)
+            goto done;
+    }
+    else if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
         goto done;
 
-    /* Make new tree by copying top-of-tree from x0t to x1t */
-    if ((x1t = xml_new(xml_name(x0t), NULL, CX_ELMNT)) == NULL)
+    /* Make new tree by copying top-of-tree from x0t to x1t
+     * The copy is allocated from an arena since it is typically short-lived */
+    if ((x1t = xml_new_arena(xml_name(x0t), CX_ELMNT)) == NULL)
         goto done;
     xml_flag_set(x1t, XML_FLAG_TOP);    
     xml_spec_set(x1t, xml_spec(x0t));
     
-    if (xlen < 1000){
+    if (dflt){
+        /* The xpath does not depend on default values: add them to the copies of the
+         * matching nodes and not to the cache */
+        for (i=0; i<xlen; i++){
+            x0 = xvec[i];
+            x1 = NULL;
+            if (xml_copy_from_bottom(x0t, x0, x1t, depth, &x1) < 0) /* config */
+                goto done;
+            if (x1 && xml_default_recurse(x1, 0) < 0)
+                goto done;
+        }
+        if (xml_global_defaults(h, x1t, nsc, xpath, yspec, 0) < 0)
+            goto done;
+    }
+    else if (xlen < 1000 || depth >= 0){
         /* This is optimized for the case when the tree is large and xlen is small
          * If the tree is large and xlen too, then the other is better.
          * This only works if yang bind
+         * The other copies complete subtrees and is not used if depth is limited
          */
         for (i=0; i<xlen; i++){
             x0 = xvec[i];
-            if (xml_copy_from_bottom(x0t, x0, x1t) < 0) /* config */
+            if (xml_copy_from_bottom(x0t, x0, x1t, depth, NULL) < 0) /* config */
                 goto done;
         }
     }
@@ -943,13 +1417,13 @@ xmldb_get_cache(clicon_handle     h,
         }
         if (xml_copy_marked(x0t, x1t) < 0) /* config */
             goto done;
-        if (xml_apply(x0t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
+        if (xml_flag_reset_rec(x0t, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
             goto done;
-        if (xml_apply(x1t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
+        if (xml_flag_reset_rec(x1t, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
             goto done;
     }
     /* Original tree: Remove global defaults and empty non-presence containers */
-    if (xml_defaults_nopresence(x0t, 2) < 0)
+    if (!dflt && xml_defaults_nopresence(x0t, 2) < 0)
         goto done;
     switch (wdef){
     case WITHDEFAULTS_REPORT_ALL:
@@ -1070,12 +1544,20 @@ xmldb_get_zerocopy(clicon_handle    h,
          * No, argument against: we may want to have a semantically wrong file and wish to edit?
          */
         de0.de_xml = x0t;
-        if (de)
+        if (de){
             de0.de_id = de->de_id;
+            /* Keep state of an evicted cache, see xmldb_cache_evict */
+            de0.de_modified = de->de_modified;
+            de0.de_version = de->de_version;
+            de0.de_mtime = de->de_mtime;
+        }
+        xmldb_cache_touch(&de0);
         clicon_db_elmnt_set(h, db, &de0);
     } /* x0t == NULL */
-    else
+    else{
         x0t = de->de_xml;
+        xmldb_cache_touch(de);
+    }
 
     /* Here xt looks like: <config>...</config> */
     if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
@@ -1258,6 +1740,7 @@ xmldb_get0(clicon_handle    h,
 {
     int               retval = -1;
 
+    CLIXON_PROBE2(xmldb_get_start, db, xpath?xpath:"");
     if (xret == NULL){
         clicon_err(OE_DB, EINVAL, "xret is NULL");
         goto done;
@@ -1285,13 +1768,378 @@ xmldb_get0(clicon_handle    h,
          * Add default values in copy, return copy
          * Copy deleted by xmldb_free
          */
-        retval = xmldb_get_cache(h, db, yb, nsc, xpath, wdef, xret, msdiff, xerr);
+        retval = xmldb_get_cache(h, db, yb, nsc, xpath, NULL, -1, wdef, xret, msdiff, xerr);
         break;
     }
  done:
+    CLIXON_PROBE2(xmldb_get_done, db, retval);
     return retval;
 }
 
+/*! Get a page of a list or leaf-list in a database, for list pagination
+ *
+ * As xmldb_get0 with copy. If there is a datastore cache, see CLICON_DATASTORE_CACHE, and
+ * the last step of xpath has no predicate, the entries of the page are found in the cache
+ * with binary search, see clixon_xml_find_page. Otherwise a positional predicate is appended
+ * to xpath and evaluated over the whole list, and a cursor is not supported.
+ * @param[in]  h        Clicon handle
+ * @param[in]  db       Name of datastore, eg "running"
+ * @param[in]  nsc      External XML namespace context, or NULL
+ * @param[in]  xpath    Xpath of list or leaf-list
+ * @param[in]  xcursor  Entry that the page starts after, or NULL
+ * @param[in]  offset   Number of entries to skip
+ * @param[in]  limit    Max number of entries, 0 is unbounded
+ * @param[in]  wdef     With-defaults parameter, see RFC 6243
+ * @param[out] xret     Single return XML tree. Free with xml_free()
+ * @param[out] xerr     XML error if retval is 0
+ * @retval     1        OK
+ * @retval     0        Invalid, eg cursor not found, xerr set
+ * @retval    -1        General error, check specific clicon_errno, clicon_suberrno
+ */
+int
+xmldb_get_page(clicon_handle     h,
+               const char       *db, 
+               cvec             *nsc,
+               const char       *xpath,
+               cxobj            *xcursor,
+               uint32_t          offset,
+               uint32_t          limit,
+               withdefaults_type wdef,
+               cxobj           **xret,
+               cxobj           **xerr)
+{
+    int               retval = -1;
+    struct xmldb_page pg = {0,};
+    yang_stmt        *yspec;
+    char             *last;
+    cbuf             *cb = NULL;
+    int               ret;
+
+    if (xret == NULL || xpath == NULL){
+        clicon_err(OE_DB, EINVAL, "xret or xpath is NULL");
+        goto done;
+    }
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if (yang_path_arg(yspec, xpath, &pg.pg_ylist) < 0)
+        goto done;
+    if (pg.pg_ylist == NULL ||
+        (yang_keyword_get(pg.pg_ylist) != Y_LIST && yang_keyword_get(pg.pg_ylist) != Y_LEAF_LIST)){
+        clicon_err(OE_DB, EINVAL, "%s is not a list or leaf-list", xpath);
+        goto done;
+    }
+    /* Parent is xpath without last step */
+    if ((pg.pg_parent = strdup(xpath)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (clicon_datastore_cache(h) == DATASTORE_NOCACHE ||
+        (last = strrchr(pg.pg_parent, '/')) == NULL ||
+        strpbrk(last+1, "[]()") != NULL ||
+        (last > pg.pg_parent && *(last-1) == '/')){
+        if (xcursor){
+            clicon_err(OE_DB, ENOTSUP, "List pagination cursor requires a datastore cache and that the last step of %s has no predicate", xpath);
+            goto done;
+        }
+        /* Positional predicate, eg [position() < limit] */
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cb, "%s", xpath);
+        if (offset){
+            cprintf(cb, "[%u <= position()", offset);
+            if (limit)
+                cprintf(cb, " and position() < %u", limit+offset);
+            cprintf(cb, "]");
+        }
+        else if (limit)
+            cprintf(cb, "[position() < %u]", limit);
+        retval = xmldb_get0(h, db, YB_MODULE, nsc, cbuf_get(cb), 1, wdef, xret, NULL, xerr);
+        goto done;
+    }
+    if (last == pg.pg_parent)
+        *(last+1) = '\0';
+    else
+        *last = '\0';
+    pg.pg_cursor = xcursor;
+    pg.pg_offset = offset;
+    pg.pg_limit = limit;
+    if ((ret = xmldb_get_cache(h, db, YB_MODULE, nsc, xpath, &pg, -1, wdef, xret, NULL, xerr)) < 0)
+        goto done;
+    if (ret == 1 && pg.pg_notfound){
+        if (netconf_invalid_value_xml(xerr, "application", "list-pagination cursor entry not found") < 0)
+            goto done;
+        xml_free(*xret);
+        *xret = NULL;
+        ret = 0;
+    }
+    retval = ret;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (pg.pg_parent)
+        free(pg.pg_parent);
+    return retval;
+}
+
+/*! Get content of a database down to a given depth
+ *
+ * As xmldb_get0 with copy, but only the nodes needed to print the result with a given
+ * depth are copied: data nodes down to depth, where a top-level node is at level 1, and
+ * at the level below, nodes without descendants except list keys and the content of
+ * non-presence containers, see xml_copy_depth.
+ * Without a datastore cache, see CLICON_DATASTORE_CACHE, the complete result is returned.
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Name of datastore, eg "running"
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPATH syntax. or NULL for all
+ * @param[in]  depth  Nr of levels of data nodes to copy, -1 is all
+ * @param[in]  wdef   With-defaults parameter, see RFC 6243
+ * @param[out] xret   Single return XML tree. Free with xml_free()
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     1      OK
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval    -1      General error, check specific clicon_errno, clicon_suberrno
+ * @note Nodes below depth are not copied, and an xpath evaluated on the result may
+ *       therefore not match if it has predicates referring to nodes below depth
+ * @see xmldb_get0
+ */
+int
+xmldb_get_depth(clicon_handle     h,
+                const char       *db, 
+                cvec             *nsc,
+                const char       *xpath,
+                int32_t           depth,
+                withdefaults_type wdef,
+                cxobj           **xret,
+                cxobj           **xerr)
+{
+    if (depth < 0 || clicon_datastore_cache(h) == DATASTORE_NOCACHE)
+        return xmldb_get0(h, db, YB_MODULE, nsc, xpath, 1, wdef, xret, NULL, xerr);
+    if (xret == NULL){
+        clicon_err(OE_DB, EINVAL, "xret is NULL");
+        return -1;
+    }
+    return xmldb_get_cache(h, db, YB_MODULE, nsc, xpath, NULL, depth, wdef, xret, NULL, xerr);
+}
+
+/*! Print marked nodes of a cached tree, see xmldb_get_cbuf
+ *
+ * Same nodes as copied by xml_copy_marked: a node marked with XML_FLAG_MARK is printed with
+ * all descendants, a node marked with XML_FLAG_CHANGE is an ancestor of a marked node and is
+ * printed with its attributes, list keys and marked children only.
+ * With explicit, default leaves and empty non-presence containers are not printed, as if
+ * purged with xml_defaults_nopresence
+ * @param[in]  cb       Cligen buffer to write to
+ * @param[in]  x        XML node, marked or ancestor of marked node
+ * @param[in]  all      If set, print all descendants
+ * @param[in]  explicit If set, skip default leaves and empty non-presence containers
+ * @retval     1        Printed
+ * @retval     0        Not printed
+ * @retval    -1        Error
+ */
+static int
+xml_print_marked(cbuf  *cb,
+                 cxobj *x,
+                 int    all,
+                 int    explicit)
+{
+    int        retval = -1;
+    yang_stmt *y;
+    cxobj     *xc;
+    cg_var    *cvi;
+    char      *prefix;
+    size_t     len0;
+    size_t     len1;
+    int        np = 0;
+    int        iskey;
+
+    y = xml_spec(x);
+    if (explicit && y != NULL){
+        if (yang_keyword_get(y) == Y_LEAF && xml_flag(x, XML_FLAG_DEFAULT))
+            goto skip;
+        np = yang_keyword_get(y) == Y_CONTAINER && yang_find(y, Y_PRESENCE, NULL) == NULL;
+    }
+    if (xml_flag(x, XML_FLAG_MARK))
+        all = 1;
+    /* Complete subtree if nothing in it may be skipped */
+    if (all && !np && (!explicit || xml_child_nr_type(x, CX_ELMNT) == 0)){
+        if (clixon_xml2cbuf(cb, x, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    len0 = cbuf_len(cb);
+    cbuf_append_str(cb, "<");
+    if ((prefix = xml_prefix(x)) != NULL){
+        cbuf_append_str(cb, prefix);
+        cbuf_append_str(cb, ":");
+    }
+    cbuf_append_str(cb, xml_name(x));
+    xc = NULL;
+    while ((xc = xml_child_each_attr(x, xc)) != NULL)
+        if (clixon_xml2cbuf(cb, xc, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+    cbuf_append_str(cb, ">");
+    len1 = cbuf_len(cb);
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL) {
+        if (!all && !xml_flag(xc, XML_FLAG_MARK|XML_FLAG_CHANGE)){
+            /* Key nodes in lists are printed if any node in list is marked */
+            if (y == NULL || yang_keyword_get(y) != Y_LIST)
+                continue;
+            iskey = 0;
+            cvi = NULL;
+            while ((cvi = cvec_each(yang_cvec_get(y), cvi)) != NULL)
+                if (strcmp(xml_name(xc), cv_string_get(cvi)) == 0){
+                    iskey = 1;
+                    break;
+                }
+            if (!iskey)
+                continue;
+            if (clixon_xml2cbuf(cb, xc, 0, 0, NULL, -1, 0) < 0)
+                goto done;
+            continue;
+        }
+        if (xml_print_marked(cb, xc, all, explicit) < 0)
+            goto done;
+    }
+    if (cbuf_len(cb) == len1){ /* No children printed */
+        if (np){
+            cbuf_trunc(cb, len0);
+            goto skip;
+        }
+        cbuf_trunc(cb, len1-1);
+        cbuf_append_str(cb, "/>");
+    }
+    else {
+        cbuf_append_str(cb, "</");
+        if (prefix){
+            cbuf_append_str(cb, prefix);
+            cbuf_append_str(cb, ":");
+        }
+        cbuf_append_str(cb, xml_name(x));
+        cbuf_append_str(cb, ">");
+    }
+ ok:
+    retval = 1;
+ done:
+    return retval;
+ skip:
+    retval = 0;
+    goto done;
+}
+
+/*! Get content of database using xpath and print it from the datastore cache
+ *
+ * Same result as xmldb_get0 with copy, printed as <data>...</data>, but the selected nodes
+ * are marked in the cached tree and printed from it instead of copied.
+ * The backend handles one request at a time, so the cache is not modified while printed.
+ * Without a datastore cache, see CLICON_DATASTORE_CACHE, with other with-defaults modes
+ * than explicit and report-all, or if CLICON_NACM_DISABLED_ON_EMPTY is set, the selected
+ * nodes are copied and the copy is printed.
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Name of datastore, eg "running"
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPATH syntax. or NULL for all
+ * @param[in]  wdef   With-defaults parameter, see RFC 6243
+ * @param[out] cb     Cligen buffer to write <data> element to
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     1      OK
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval    -1      General error, check specific clicon_errno, clicon_suberrno
+ * @note There is no NACM read access control of the printed nodes
+ * @see xmldb_get0
+ */
+int
+xmldb_get_cbuf(clicon_handle     h,
+               const char       *db, 
+               cvec             *nsc,
+               const char       *xpath,
+               withdefaults_type wdef,
+               cbuf             *cb,
+               cxobj           **xerr)
+{
+    int     retval = -1;
+    cxobj  *x0t = NULL;
+    cxobj  *xt = NULL;
+    cxobj **xvec = NULL;
+    size_t  xlen = 0;
+    cxobj  *x;
+    size_t  len;
+    int     dflt = 0;
+    int     explicit;
+    int     i;
+    int     ret;
+
+    explicit = (wdef == WITHDEFAULTS_EXPLICIT);
+    if (clicon_datastore_cache(h) == DATASTORE_NOCACHE ||
+        (!explicit && wdef != WITHDEFAULTS_REPORT_ALL) ||
+        clicon_option_bool(h, "CLICON_NACM_DISABLED_ON_EMPTY"))
+        goto copy;
+    if ((ret = xmldb_cache_tree(h, db, YB_MODULE, nsc, xpath, &x0t, &dflt, NULL, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* Default values of selected nodes are not in the cache, only explicit may skip them */
+    if (dflt && !explicit)
+        goto copy;
+    if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+        goto done;
+    for (i=0; i<xlen; i++){
+        xml_flag_set(xvec[i], XML_FLAG_MARK);
+        xml_apply_ancestor(xvec[i], (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+    }
+    cbuf_append_str(cb, "<" NETCONF_OUTPUT_DATA ">");
+    len = cbuf_len(cb);
+    x = NULL;
+    while ((x = xml_child_each(x0t, x, CX_ELMNT)) != NULL) {
+        if (!xml_flag(x0t, XML_FLAG_MARK) &&
+            !xml_flag(x, XML_FLAG_MARK|XML_FLAG_CHANGE))
+            continue;
+        if (xml_print_marked(cb, x, xml_flag(x0t, XML_FLAG_MARK), explicit) < 0)
+            goto done;
+    }
+    if (cbuf_len(cb) == len){
+        cbuf_trunc(cb, len-1);
+        cbuf_append_str(cb, "/>");
+    }
+    else
+        cbuf_append_str(cb, "</" NETCONF_OUTPUT_DATA ">");
+    /* Unmark selected nodes and their ancestors only, not the whole tree */
+    for (i=0; i<xlen; i++){
+        xml_flag_reset(xvec[i], XML_FLAG_MARK);
+        xml_apply_ancestor(xvec[i], (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_CHANGE);
+    }
+    xml_flag_reset(x0t, XML_FLAG_CHANGE);
+    /* Original tree: Remove global defaults and empty non-presence containers */
+    if (!dflt && xml_defaults_nopresence(x0t, 2) < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (xvec)
+        free(xvec);
+    if (xt)
+        xml_free(xt);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+ copy:
+    if ((ret = xmldb_get0(h, db, YB_MODULE, nsc, xpath, 1, wdef, &xt, NULL, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (xml_name_set(xt, NETCONF_OUTPUT_DATA) < 0)
+        goto done;
+    if (clixon_xml2cbuf(cb, xt, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    retval = 1;
+    goto done;
+}
+
 /*! Clear cached xml tree obtained with xmldb_get0, if zerocopy
  *
  * @param[in]  h    Clicon handle
@@ -1316,8 +2164,8 @@ xmldb_get0_clear(clicon_handle    h,
     if (xml_tree_prune_flagged(x, XML_FLAG_TRANSIENT, 1) < 0)
         goto done;
     /* clear mark and change */
-    xml_apply0(x, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-               (void*)(XML_FLAG_MARK|XML_FLAG_ADD|XML_FLAG_CHANGE));
+    xml_flag_reset(x, XML_FLAG_MARK|XML_FLAG_ADD|XML_FLAG_CHANGE);
+    xml_flag_reset_rec(x, XML_FLAG_MARK|XML_FLAG_ADD|XML_FLAG_CHANGE);
  ok:
     retval = 0;
  done:
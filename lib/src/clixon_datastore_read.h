@@ -41,7 +41,11 @@
 /*
  * Prototypes
  */
+int xmldb_parse_file_format(const char *format, FILE *fp, yang_stmt *yspec, cxobj **xp, cxobj **xerr);
+int xmldb_parse_file(clicon_handle h, FILE *fp, yang_stmt *yspec, cxobj **xp, cxobj **xerr);
 int xmldb_readfile(clicon_handle h, const char *db, yang_bind yb, yang_stmt *yspec,
                    cxobj **xp, db_elmnt *de, modstate_diff_t *msd, cxobj **xerr);
+int xmldb_get_filter(clicon_handle h, cxobj *xt, yang_bind yb, yang_stmt *yspec,
+                     cvec *nsc, const char *xpath, withdefaults_type wdef);
 
 #endif /* _CLIXON_DATASTORE_READ_H */
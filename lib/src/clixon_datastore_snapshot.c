@@ -0,0 +1,480 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Read-only snapshot of the running datastore for local frontends, see CLICON_XMLDB_SNAPSHOT
+  * The backend writes the running cache in binary format to a snapshot file each time the
+  * cache of running changes, eg on commit. The file is written to a temporary file and
+  * renamed, so that a reader always sees a complete snapshot. Each snapshot has a header
+  * with a generation number incremented by each write.
+  * A frontend maps the file and parses it once per generation. It then answers get-config
+  * of running from the parsed tree without a round-trip to the backend, see
+  * clicon_rpc_get_config. NACM is applied by the frontend.
+  * Snapshot format:
+  *   "CLXS" | version (32 bits) | generation (64 bits) | binary XML, see clixon_xml_binary.c
+  * Numbers are in network byte order.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <syslog.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <arpa/inet.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_uid.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_io.h"
+#include "clixon_xml_bind.h"
+#include "clixon_xml_binary.h"
+#include "clixon_xml_map.h"
+#include "clixon_yang_module.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_options.h"
+#include "clixon_data.h"
+#include "clixon_datastore.h"
+#include "clixon_datastore_read.h"
+
+#define XMLDB_SNAPSHOT_MAGIC   "CLXS"
+#define XMLDB_SNAPSHOT_VERSION 1
+#define XMLDB_SNAPSHOT_HDRLEN  16
+
+/* Handle data name of snapshot state */
+#define XMLDB_SNAPSHOT_NAME "xmldb-snapshot"
+
+/*! Snapshot state of a backend (writer) or a frontend (reader)
+ */
+struct xmldb_snapshot{
+    int      ss_writer; /* This process has written the snapshot file */
+    uint64_t ss_gen;    /* Generation of last written or parsed snapshot */
+    dev_t    ss_dev;    /* Reader: device of parsed snapshot file */
+    ino_t    ss_ino;    /* Reader: inode of parsed snapshot file */
+    cxobj   *ss_xt;     /* Reader: parsed snapshot <config> tree */
+};
+
+/*! Get snapshot state of handle, create if not found
+ *
+ * @param[in]  h    Clicon handle
+ * @retval     ss   Snapshot state
+ * @retval     NULL Error
+ */
+static struct xmldb_snapshot *
+snapshot_state(clicon_handle h)
+{
+    struct xmldb_snapshot *ss = NULL;
+
+    if (clicon_ptr_get(h, XMLDB_SNAPSHOT_NAME, (void**)&ss) == 0 && ss != NULL)
+        return ss;
+    if ((ss = calloc(1, sizeof(*ss))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    if (clicon_ptr_set(h, XMLDB_SNAPSHOT_NAME, ss) < 0){
+        free(ss);
+        return NULL;
+    }
+    return ss;
+}
+
+/*! Get filename of snapshot of a datastore
+ *
+ * @param[in]  h        Clicon handle
+ * @param[in]  db       Symbolic database name, eg "running"
+ * @param[out] filename Snapshot filename, free after use
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+snapshot_file(clicon_handle h,
+              const char   *db,
+              char        **filename)
+{
+    int   retval = -1;
+    char *dbfile = NULL;
+    cbuf *cb = NULL;
+
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s.snapshot", dbfile);
+    if ((*filename = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (dbfile)
+        free(dbfile);
+    return retval;
+}
+
+/*! Decode snapshot header
+ *
+ * @param[in]  buf  Snapshot
+ * @param[in]  len  Length of snapshot
+ * @param[out] gen  Generation
+ * @retval     1    OK
+ * @retval     0    Not a snapshot or other version
+ */
+static int
+snapshot_header(const char *buf,
+                size_t      len,
+                uint64_t   *gen)
+{
+    uint32_t n[3];
+
+    if (len < XMLDB_SNAPSHOT_HDRLEN ||
+        memcmp(buf, XMLDB_SNAPSHOT_MAGIC, strlen(XMLDB_SNAPSHOT_MAGIC)) != 0)
+        return 0;
+    memcpy(n, buf + strlen(XMLDB_SNAPSHOT_MAGIC), sizeof(n));
+    if (ntohl(n[0]) != XMLDB_SNAPSHOT_VERSION)
+        return 0;
+    *gen = ((uint64_t)ntohl(n[1]) << 32) | ntohl(n[2]);
+    return 1;
+}
+
+/*! Read generation of an existing snapshot file, so that generations increase across restarts
+ *
+ * @param[in]  filename  Snapshot file
+ * @retval     gen       Generation, 0 if no snapshot
+ */
+static uint64_t
+snapshot_file_gen(const char *filename)
+{
+    char     buf[XMLDB_SNAPSHOT_HDRLEN];
+    int      fd;
+    uint64_t gen = 0;
+
+    if ((fd = open(filename, O_RDONLY)) < 0)
+        return 0;
+    if (read(fd, buf, sizeof(buf)) != sizeof(buf) ||
+        snapshot_header(buf, sizeof(buf), &gen) == 0)
+        gen = 0;
+    close(fd);
+    return gen;
+}
+
+/*! Write snapshot of the running datastore cache, if enabled
+ *
+ * Called when the cache of a datastore changes, a no-op unless db is running,
+ * CLICON_XMLDB_SNAPSHOT is set and a datastore cache is used.
+ * Default values are removed as when writing the datastore file.
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Database that has changed
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+xmldb_snapshot_write(clicon_handle h,
+                     const char   *db)
+{
+    int                    retval = -1;
+    struct xmldb_snapshot *ss;
+    cxobj                 *x;
+    cxobj                 *xt = NULL;
+    cbuf                  *cb = NULL;
+    char                  *filename = NULL;
+    char                  *tmpfile = NULL;
+    int                    fd = -1;
+    uint32_t               n[3];
+    char                  *group;
+    gid_t                  gid;
+    size_t                 len;
+
+    if (strcmp(db, "running") != 0 ||
+        !clicon_option_bool(h, "CLICON_XMLDB_SNAPSHOT") ||
+        clicon_datastore_cache(h) == DATASTORE_NOCACHE)
+        return 0;
+    if ((ss = snapshot_state(h)) == NULL)
+        goto done;
+    if (snapshot_file(h, db, &filename) < 0)
+        goto done;
+    if (!ss->ss_writer)
+        ss->ss_gen = snapshot_file_gen(filename);
+    if ((x = xmldb_cache_get(h, db)) == NULL){
+        /* Load the cache, eg when running has been deleted */
+        if (xmldb_get0(h, db, YB_MODULE, NULL, "/", 1, WITHDEFAULTS_EXPLICIT, &xt, NULL, NULL) < 0)
+            goto done;
+        xmldb_get0_free(h, &xt);
+        if ((x = xmldb_cache_get(h, db)) == NULL){
+            clicon_err(OE_DB, ENOENT, "No cache of datastore %s", db);
+            goto done;
+        }
+    }
+    if ((xt = xml_dup(x)) == NULL)
+        goto done;
+    if (xml_tree_prune_flagged(xt, XML_FLAG_DEFAULT, 1) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    n[0] = htonl(XMLDB_SNAPSHOT_VERSION);
+    n[1] = htonl((uint32_t)((ss->ss_gen + 1) >> 32));
+    n[2] = htonl((uint32_t)(ss->ss_gen + 1));
+    if (cbuf_append_buf(cb, XMLDB_SNAPSHOT_MAGIC, strlen(XMLDB_SNAPSHOT_MAGIC)) < 0 ||
+        cbuf_append_buf(cb, n, sizeof(n)) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
+    if (clixon_xml2binary_cbuf(cb, xt) < 0)
+        goto done;
+    /* Write complete snapshot to temporary file and rename */
+    if ((tmpfile = malloc(strlen(filename) + 5)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    sprintf(tmpfile, "%s.tmp", filename);
+    if ((fd = open(tmpfile, O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR)) < 0){
+        clicon_err(OE_UNIX, errno, "open(%s)", tmpfile);
+        goto done;
+    }
+    /* Readable by frontends of the socket group */
+    if ((group = clicon_sock_group(h)) != NULL &&
+        group_name2gid(group, &gid) == 0 &&
+        fchown(fd, -1, gid) == 0)
+        fchmod(fd, S_IRUSR|S_IWUSR|S_IRGRP);
+    len = cbuf_len(cb);
+    if (write(fd, cbuf_get(cb), len) != (ssize_t)len){
+        clicon_err(OE_UNIX, errno, "write(%s)", tmpfile);
+        goto done;
+    }
+    close(fd);
+    fd = -1;
+    if (rename(tmpfile, filename) < 0){
+        clicon_err(OE_UNIX, errno, "rename(%s)", filename);
+        goto done;
+    }
+    ss->ss_gen++;
+    ss->ss_writer = 1;
+    clicon_debug(CLIXON_DBG_DETAIL, "%s %s generation %" PRIu64, __FUNCTION__, filename, ss->ss_gen);
+    retval = 0;
+ done:
+    if (fd != -1){
+        close(fd);
+        unlink(tmpfile);
+    }
+    if (tmpfile)
+        free(tmpfile);
+    if (filename)
+        free(filename);
+    if (cb)
+        cbuf_free(cb);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Get parsed snapshot of running, parse it if the backend has written a new one
+ *
+ * @param[in]  h     Clicon handle
+ * @param[out] xtp   Snapshot <config> tree, owned by the handle, do not modify or free
+ * @retval     1     OK, xtp is set
+ * @retval     0     No snapshot or it does not match the yang spec of the frontend
+ * @retval    -1     Error
+ */
+int
+xmldb_snapshot_read(clicon_handle h,
+                    cxobj       **xtp)
+{
+    int                    retval = -1;
+    struct xmldb_snapshot *ss;
+    char                  *filename = NULL;
+    int                    fd = -1;
+    struct stat            st;
+    char                  *buf = MAP_FAILED;
+    uint64_t               gen = 0;
+    yang_stmt             *yspec;
+    cxobj                 *xt = NULL;
+    cxobj                 *xerr = NULL;
+    int                    ret;
+
+    if ((ss = snapshot_state(h)) == NULL)
+        goto done;
+    if (snapshot_file(h, "running", &filename) < 0)
+        goto done;
+    if ((fd = open(filename, O_RDONLY)) < 0 ||
+        fstat(fd, &st) < 0)
+        goto fail;
+    if ((buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+        goto fail;
+    if (snapshot_header(buf, st.st_size, &gen) == 0)
+        goto fail;
+    if (ss->ss_xt == NULL ||
+        ss->ss_dev != st.st_dev || ss->ss_ino != st.st_ino || ss->ss_gen != gen){
+        if ((yspec = clicon_dbspec_yang(h)) == NULL){
+            clicon_err(OE_YANG, ENOENT, "No yang spec");
+            goto done;
+        }
+        if (clixon_binary_parse_buf(buf + XMLDB_SNAPSHOT_HDRLEN,
+                                    st.st_size - XMLDB_SNAPSHOT_HDRLEN,
+                                    YB_NONE, yspec, &xt, NULL) < 0)
+            goto done;
+        if (xml_rootchild(xt, 0, &xt) < 0)
+            goto done;
+        if ((ret = xml_bind_yang(h, xt, YB_MODULE, yspec, &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_debug(CLIXON_DBG_DEFAULT, "%s: snapshot does not match yang", __FUNCTION__);
+            goto fail;
+        }
+        xml_flag_set(xt, XML_FLAG_TOP);
+        if (ss->ss_xt)
+            xml_free(ss->ss_xt);
+        ss->ss_xt = xt;
+        xt = NULL;
+        ss->ss_dev = st.st_dev;
+        ss->ss_ino = st.st_ino;
+        ss->ss_gen = gen;
+    }
+    *xtp = ss->ss_xt;
+    retval = 1;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    if (xt)
+        xml_free(xt);
+    if (buf != MAP_FAILED)
+        munmap(buf, st.st_size);
+    if (fd != -1)
+        close(fd);
+    if (filename)
+        free(filename);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get content of running from snapshot using xpath
+ *
+ * As xmldb_get0 of running with a copy, but from the snapshot written by the backend
+ * @param[in]  h      Clicon handle
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPATH syntax. or NULL for all
+ * @param[in]  wdef   With-defaults parameter, see RFC 6243
+ * @param[out] xret   Single return XML tree <config>. Free with xml_free()
+ * @retval     1      OK
+ * @retval     0      No snapshot, get from backend
+ * @retval    -1      Error
+ * @see xmldb_get0
+ */
+int
+xmldb_snapshot_get(clicon_handle     h,
+                   cvec             *nsc,
+                   const char       *xpath,
+                   withdefaults_type wdef,
+                   cxobj           **xret)
+{
+    int        retval = -1;
+    cxobj     *x = NULL;
+    cxobj     *xt = NULL;
+    int        ret;
+
+    if ((ret = xmldb_snapshot_read(h, &x)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if ((xt = xml_dup(x)) == NULL)
+        goto done;
+    if (xmldb_get_filter(h, xt, YB_MODULE, clicon_dbspec_yang(h), nsc, xpath, wdef) < 0)
+        goto done;
+    *xret = xt;
+    xt = NULL;
+    retval = 1;
+ done:
+    if (xt)
+        xml_free(xt);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Free snapshot state, and remove the snapshot file if written by this process
+ *
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+xmldb_snapshot_exit(clicon_handle h)
+{
+    int                    retval = -1;
+    struct xmldb_snapshot *ss = NULL;
+    char                  *filename = NULL;
+
+    if (clicon_ptr_get(h, XMLDB_SNAPSHOT_NAME, (void**)&ss) < 0 || ss == NULL)
+        return 0;
+    if (ss->ss_writer){
+        if (snapshot_file(h, "running", &filename) < 0)
+            goto done;
+        unlink(filename);
+    }
+    retval = 0;
+ done:
+    clicon_ptr_del(h, XMLDB_SNAPSHOT_NAME);
+    if (ss->ss_xt)
+        xml_free(ss->ss_xt);
+    free(ss);
+    if (filename)
+        free(filename);
+    return retval;
+}
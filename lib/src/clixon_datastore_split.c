@@ -0,0 +1,1277 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Split datastores, see CLICON_XMLDB_SPLIT
+  * Each top-level YANG module subtree of a datastore is stored in its own file in a
+  * directory next to the datastore file, eg:
+  *   running_db                  # Module state only
+  *   running_db.d/ietf-interfaces_db
+  *   running_db.d/clixon-example_db
+  * Only the module files of modules in an edit are rewritten.
+  * Module files are never modified in place: a new file is written and renamed, so that
+  * copying a datastore, eg at commit, hard links the module files and only the files that
+  * differ (not same inode) are replaced.
+  * If also CLICON_XMLDB_SPLIT_MOUNT is set, the content of each schema mount-point instance
+  * is stored in its own shard file in a directory next to its module file, eg:
+  *   running_db.d/clixon-example_db.d/5c3b3b2f8d0a9e17_db
+  * where the name is a hash of the xpath of the mount-point. In the module file, the
+  * mount-point has no children but a cl:shard attribute with the name.
+  * Only the shards of mount-points in an edit are rewritten.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <syslog.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_options.h"
+#include "clixon_data.h"
+#include "clixon_yang_module.h"
+#include "clixon_yang_schema_mount.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xpath_ctx.h"
+#include "clixon_xpath.h"
+#include "clixon_file.h"
+#include "clixon_datastore.h"
+#include "clixon_datastore_read.h"
+#include "clixon_datastore_write.h"
+#include "clixon_datastore_split.h"
+
+/*! Schema mount-point of a module while its module file is written
+ *
+ * @see CLICON_XMLDB_SPLIT_MOUNT
+ */
+struct split_shard {
+    cxobj *ss_x;     /* Mount-point node */
+    cxobj *ss_xt;    /* Shard tree, holds the children of the mount-point while written */
+    cxobj *ss_attr;  /* cl:shard attribute of the mount-point */
+};
+
+static int split_rmdir(const char *dir);
+
+/*! Get name of the module a top-level datastore node belongs to
+ *
+ * @param[in]  yspec  Top-level yang spec
+ * @param[in]  x      Top-level node
+ * @retval     name   Module name, or node name if no module found
+ */
+static char *
+split_module(yang_stmt *yspec,
+             cxobj     *x)
+{
+    yang_stmt *y;
+    yang_stmt *ymod;
+    char      *ns = NULL;
+
+    if ((y = xml_spec(x)) != NULL &&
+        (ymod = ys_module(y)) != NULL)
+        return yang_argument_get(ymod);
+    if (yspec &&
+        xml2ns(x, xml_prefix(x), &ns) == 0 && ns != NULL &&
+        (ymod = yang_find_module_by_namespace(yspec, ns)) != NULL)
+        return yang_argument_get(ymod);
+    return xml_name(x);
+}
+
+/*! Get module file name
+ *
+ * @param[in]  dir     Split datastore directory
+ * @param[in]  module  Module name
+ * @param[in]  suffix  Suffix, eg for temporary file, or ""
+ * @param[out] cb      Module file name
+ */
+static void
+split_file(const char *dir,
+           const char *module,
+           const char *suffix,
+           cbuf       *cb)
+{
+    cbuf_reset(cb);
+    cprintf(cb, "%s/%s_db%s", dir, module, suffix);
+}
+
+/*! Get shard directory of a module
+ *
+ * @param[in]  dir     Split datastore directory
+ * @param[in]  module  Module name
+ * @param[out] cb      Shard directory name
+ */
+static void
+split_shard_dir(const char *dir,
+                const char *module,
+                cbuf       *cb)
+{
+    cbuf_reset(cb);
+    cprintf(cb, "%s/%s_db.d", dir, module);
+}
+
+/*! Get shard file name
+ *
+ * @param[in]  dir     Split datastore directory
+ * @param[in]  module  Module name
+ * @param[in]  id      Shard name, see split_shard_id
+ * @param[in]  suffix  Suffix, eg for temporary file, or ""
+ * @param[out] cb      Shard file name
+ */
+static void
+split_shard_file(const char *dir,
+                 const char *module,
+                 const char *id,
+                 const char *suffix,
+                 cbuf       *cb)
+{
+    cbuf_reset(cb);
+    cprintf(cb, "%s/%s_db.d/%s_db%s", dir, module, id, suffix);
+}
+
+/*! Get shard name of a mount-point: FNV-1a 64-bit hash of its xpath
+ *
+ * @param[in]  x     XML mount-point node, bound to YANG
+ * @param[out] cb    Shard name
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+split_shard_id(cxobj *x,
+               cbuf  *cb)
+{
+    char    *xpath = NULL;
+    char    *s;
+    uint64_t hv = 14695981039346656037ULL;
+
+    if (xml2xpath(x, NULL, 1, 0, &xpath) < 0)
+        return -1;
+    for (s = xpath; *s; s++){
+        hv ^= (uint8_t)*s;
+        hv *= 1099511628211ULL;
+    }
+    cbuf_reset(cb);
+    cprintf(cb, "%016" PRIx64, hv);
+    free(xpath);
+    return 0;
+}
+
+/*! Write a tree to a new file and rename it to its final name
+ *
+ * The file gets a new inode, since it may be hard linked to other datastores
+ * @param[in]  h       Clicon handle
+ * @param[in]  tmp     Temporary file name
+ * @param[in]  file    File name
+ * @param[in]  xt      Tree, top-level is DATASTORE_TOP_SYMBOL
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+split_tree_write(clicon_handle h,
+                 const char   *tmp,
+                 const char   *file,
+                 cxobj        *xt)
+{
+    int   retval = -1;
+    FILE *f = NULL;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s write %s", __FUNCTION__, file);
+    if ((f = fopen(tmp, "w")) == NULL){
+        clicon_err(OE_CFG, errno, "Creating file %s", tmp);
+        goto done;
+    }
+    if (xmldb_compress_wrap(h, "w", &f) < 0)
+        goto done;
+    if (xmldb_tree2file(h, f, xt) < 0)
+        goto done;
+    if (fclose(f) != 0){
+        f = NULL;
+        clicon_err(OE_UNIX, errno, "fclose(%s)", tmp);
+        goto done;
+    }
+    f = NULL;
+    if (rename(tmp, file) < 0){
+        clicon_err(OE_UNIX, errno, "rename(%s)", file);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    return retval;
+}
+
+/*! Find outermost schema mount-points with content in a tree
+ *
+ * @param[in]     x     XML tree, bound to YANG
+ * @param[in,out] vec   Mount-points, free with free
+ * @param[in,out] len   Length of vec
+ * @retval        0     OK
+ * @retval       -1     Error
+ */
+static int
+split_shard_find(cxobj               *x,
+                 struct split_shard **vec,
+                 int                 *len)
+{
+    cxobj     *xc;
+    yang_stmt *y;
+    int        ret;
+
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+        if ((y = xml_spec(xc)) == NULL ||
+            (yang_keyword_get(y) != Y_CONTAINER && yang_keyword_get(y) != Y_LIST))
+            continue;
+        if ((ret = yang_schema_mount_point(y)) < 0)
+            return -1;
+        if (ret == 0){
+            if (split_shard_find(xc, vec, len) < 0)
+                return -1;
+            continue;
+        }
+        if (xml_child_nr_type(xc, CX_ELMNT) == 0)
+            continue;
+        if ((*vec = realloc(*vec, (*len+1)*sizeof(struct split_shard))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        memset(&(*vec)[*len], 0, sizeof(struct split_shard));
+        (*vec)[(*len)++].ss_x = xc;
+    }
+    return 0;
+}
+
+/*! Move the content of mount-points back from their shard trees
+ *
+ * @param[in]  vec   Mount-points
+ * @param[in]  len   Length of vec
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see split_shard_write
+ */
+static int
+split_shard_restore(struct split_shard *vec,
+                    int                 len)
+{
+    struct split_shard *ss;
+    cxobj              *xc;
+    int                 i;
+
+    for (i=0; i<len; i++){
+        ss = &vec[i];
+        if (ss->ss_attr){
+            xml_purge(ss->ss_attr);
+            ss->ss_attr = NULL;
+        }
+        if (ss->ss_xt == NULL)
+            continue;
+        while ((xc = xml_child_i_type(ss->ss_xt, 0, CX_ELMNT)) != NULL)
+            if (xml_addsub(ss->ss_x, xc) < 0)
+                return -1;
+        xml_free(ss->ss_xt);
+        ss->ss_xt = NULL;
+    }
+    return 0;
+}
+
+/*! Write the mount-point shard files of a module, and leave only references in its tree
+ *
+ * The children of each outermost mount-point are moved to a shard tree, and a cl:shard
+ * attribute is added to the mount-point, until restored by split_shard_restore.
+ * Shards that exist are only rewritten if their mount-point is marked as edited, unless
+ * dirty is NULL. Shards of mount-points no longer in the tree are removed.
+ * @param[in]  h       Clicon handle
+ * @param[in]  dir     Split datastore directory
+ * @param[in]  module  Module name
+ * @param[in]  xt      Module tree, top-level is DATASTORE_TOP_SYMBOL
+ * @param[in]  dirty   Names of modified modules, NULL if any may be modified
+ * @param[out] vecp    Mount-points, restore with split_shard_restore and free with free
+ * @param[out] lenp    Length of vecp
+ * @retval     0       OK
+ * @retval    -1       Error, restore anyway
+ * @see text_modify_dirty  Marks edited nodes and their ancestors
+ */
+static int
+split_shard_write(clicon_handle        h,
+                  const char          *dir,
+                  const char          *module,
+                  cxobj               *xt,
+                  cvec                *dirty,
+                  struct split_shard **vecp,
+                  int                 *lenp)
+{
+    int                 retval = -1;
+    struct split_shard *ss;
+    cxobj              *xc;
+    char               *ns;
+    char               *ns1;
+    cvec               *ids = NULL;
+    cbuf               *cbid = NULL;
+    cbuf               *cbf = NULL;
+    cbuf               *cbt = NULL;
+    struct dirent      *dp = NULL;
+    int                 ndp;
+    struct stat         st;
+    int                 i;
+
+    if ((cbid = cbuf_new()) == NULL ||
+        (cbf = cbuf_new()) == NULL ||
+        (cbt = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((ids = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if (split_shard_find(xt, vecp, lenp) < 0)
+        goto done;
+    split_shard_dir(dir, module, cbf);
+    if (*lenp == 0){
+        retval = split_rmdir(cbuf_get(cbf));
+        goto done;
+    }
+    if (stat(cbuf_get(cbf), &st) < 0 && mkdir(cbuf_get(cbf), S_IRWXU) < 0){
+        clicon_err(OE_UNIX, errno, "mkdir(%s)", cbuf_get(cbf));
+        goto done;
+    }
+    if (xmlns_set(xt, CLIXON_LIB_PREFIX, CLIXON_LIB_NS) < 0)
+        goto done;
+    for (i=0; i<*lenp; i++){
+        ss = &(*vecp)[i];
+        if (split_shard_id(ss->ss_x, cbid) < 0)
+            goto done;
+        if (cvec_add_string(ids, cbuf_get(cbid), NULL) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+        if ((ss->ss_xt = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        while ((xc = xml_child_i_type(ss->ss_x, 0, CX_ELMNT)) != NULL){
+            if (xml2ns(xc, xml_prefix(xc), &ns) < 0)
+                goto done;
+            if (xml_addsub(ss->ss_xt, xc) < 0)
+                goto done;
+            /* Namespace may have been declared by an ancestor */
+            if (ns != NULL){
+                if (xml2ns(xc, xml_prefix(xc), &ns1) < 0)
+                    goto done;
+                if (ns1 == NULL && xmlns_set(xc, xml_prefix(xc), ns) < 0)
+                    goto done;
+            }
+        }
+        if ((ss->ss_attr = xml_new("shard", ss->ss_x, CX_ATTR)) == NULL)
+            goto done;
+        if (xml_prefix_set(ss->ss_attr, CLIXON_LIB_PREFIX) < 0)
+            goto done;
+        if (xml_value_set(ss->ss_attr, cbuf_get(cbid)) < 0)
+            goto done;
+        split_shard_file(dir, module, cbuf_get(cbid), "", cbf);
+        if (dirty && xml_flag(ss->ss_x, XML_FLAG_DIRTY) == 0 &&
+            stat(cbuf_get(cbf), &st) == 0)
+            continue; /* Not edited */
+        split_shard_file(dir, module, cbuf_get(cbid), ".tmp", cbt);
+        if (split_tree_write(h, cbuf_get(cbt), cbuf_get(cbf), ss->ss_xt) < 0)
+            goto done;
+    }
+    /* Remove shards of mount-points no longer in the tree */
+    split_shard_dir(dir, module, cbt);
+    if ((ndp = clicon_file_dirent(cbuf_get(cbt), &dp, "(_db)$", S_IFREG)) < 0)
+        goto done;
+    for (i = 0; i < ndp; i++){
+        cbuf_reset(cbid);
+        cprintf(cbid, "%.*s", (int)(strlen(dp[i].d_name) - strlen("_db")), dp[i].d_name);
+        if (cvec_find(ids, cbuf_get(cbid)) != NULL)
+            continue;
+        split_shard_file(dir, module, cbuf_get(cbid), "", cbf);
+        if (unlink(cbuf_get(cbf)) < 0 && errno != ENOENT){
+            clicon_err(OE_UNIX, errno, "unlink(%s)", cbuf_get(cbf));
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (dp)
+        free(dp);
+    if (ids)
+        cvec_free(ids);
+    if (cbid)
+        cbuf_free(cbid);
+    if (cbf)
+        cbuf_free(cbf);
+    if (cbt)
+        cbuf_free(cbt);
+    return retval;
+}
+
+/*! Read the mount-point shards referenced in a tree read from a module file
+ *
+ * The children of the shard are added to its mount-point, and the cl:shard attribute
+ * is removed. The nodes are not bound to YANG nor sorted.
+ * @param[in]  h       Clicon handle
+ * @param[in]  dir     Split datastore directory
+ * @param[in]  module  Module name
+ * @param[in]  yspec   Top-level yang spec
+ * @param[in]  x       XML tree
+ * @param[in]  cb      Buffer for file names
+ * @param[out] xerr    XML error
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+split_shard_read(clicon_handle h,
+                 const char   *dir,
+                 const char   *module,
+                 yang_stmt    *yspec,
+                 cxobj        *x,
+                 cbuf         *cb,
+                 cxobj       **xerr)
+{
+    int    retval = -1;
+    cxobj *xc;
+    cxobj *xa;
+    cxobj *xs = NULL;
+    cxobj *xsc;
+    FILE  *f = NULL;
+
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+        if ((xa = xml_find_type(xc, CLIXON_LIB_PREFIX, "shard", CX_ATTR)) == NULL){
+            if (split_shard_read(h, dir, module, yspec, xc, cb, xerr) < 0)
+                goto done;
+            continue;
+        }
+        split_shard_file(dir, module, xml_value(xa), "", cb);
+        if ((f = fopen(cbuf_get(cb), "r")) == NULL){
+            clicon_err(OE_UNIX, errno, "open(%s)", cbuf_get(cb));
+            goto done;
+        }
+        if (xmldb_compress_wrap(h, "r", &f) < 0)
+            goto done;
+        if (xmldb_parse_file(h, f, yspec, &xs, xerr) < 0)
+            goto done;
+        fclose(f);
+        f = NULL;
+        while ((xsc = xml_child_i_type(xs, 0, CX_ELMNT)) != NULL)
+            if (xml_addsub(xc, xsc) < 0)
+                goto done;
+        xml_free(xs);
+        xs = NULL;
+        xml_purge(xa);
+    }
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (xs)
+        xml_free(xs);
+    return retval;
+}
+
+/*! Get modules of the top-level nodes of an edit
+ *
+ * @param[in]  h      Clicon handle
+ * @param[in]  x1     Edit tree, top-level is NETCONF_INPUT_CONFIG
+ * @param[out] dirty  Module names, or NULL if it cannot be determined. Free with cvec_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+xmldb_split_dirty(clicon_handle h,
+                  cxobj        *x1,
+                  cvec        **dirty)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *x;
+    char      *name;
+    cvec      *cvv = NULL;
+
+    yspec = clicon_dbspec_yang(h);
+    if ((cvv = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    x = NULL;
+    while ((x = xml_child_each(x1, x, CX_ELMNT)) != NULL){
+        if (xml_spec(x) == NULL){ /* Not known, rewrite all */
+            cvec_free(cvv);
+            cvv = NULL;
+            break;
+        }
+        name = split_module(yspec, x);
+        if (cvec_find(cvv, name) == NULL &&
+            cvec_add_string(cvv, name, NULL) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    }
+    *dirty = cvv;
+    cvv = NULL;
+    retval = 0;
+ done:
+    if (cvv)
+        cvec_free(cvv);
+    return retval;
+}
+
+/*! Add module(s) of a top-level name in an xpath to a module set
+ *
+ * @param[in]  yspec   Top-level yang spec
+ * @param[in]  nsc     XML namespace context, or NULL
+ * @param[in]  xnode   XPATH nodetest
+ * @param[in]  cvv     Module names
+ * @retval     1       OK
+ * @retval     0       Module(s) cannot be determined
+ * @retval    -1       Error
+ */
+static int
+split_xpath_node(yang_stmt  *yspec,
+                 cvec       *nsc,
+                 xpath_tree *xnode,
+                 cvec       *cvv)
+{
+    yang_stmt *ymod;
+    char      *ns;
+    char      *myns;
+    char      *name;
+
+    if (xnode == NULL || xnode->xs_type != XP_NODE ||
+        xnode->xs_s1 == NULL || strcmp(xnode->xs_s1, "*") == 0)
+        return 0;
+    ns = nsc ? xml_nsctx_get(nsc, xnode->xs_s0) : NULL;
+    ymod = NULL;
+    while ((ymod = yn_each(yspec, ymod)) != NULL) {
+        if (yang_keyword_get(ymod) != Y_MODULE)
+            continue;
+        if (ns != NULL){
+            if ((myns = yang_find_mynamespace(ymod)) == NULL || strcmp(ns, myns) != 0)
+                continue;
+        }
+        else if (yang_find_datanode(ymod, xnode->xs_s1) == NULL)
+            continue;
+        name = yang_argument_get(ymod);
+        if (cvec_find(cvv, name) == NULL &&
+            cvec_add_string(cvv, name, NULL) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            return -1;
+        }
+    }
+    return 1;
+}
+
+/*! Get the modules of the first steps of absolute location paths in an xpath
+ *
+ * @param[in]  yspec   Top-level yang spec
+ * @param[in]  nsc     XML namespace context, or NULL
+ * @param[in]  xs      XPATH tree
+ * @param[in]  cvv     Module names
+ * @retval     1       OK
+ * @retval     0       Module(s) cannot be determined
+ * @retval    -1       Error
+ */
+static int
+split_xpath(yang_stmt  *yspec,
+            cvec       *nsc,
+            xpath_tree *xs,
+            cvec       *cvv)
+{
+    int ret;
+
+    /* Skip expressions without operators down to the location path */
+    while (xs != NULL &&
+           (xs->xs_type == XP_EXP || xs->xs_type == XP_AND || xs->xs_type == XP_RELEX ||
+            xs->xs_type == XP_ADD || xs->xs_type == XP_UNION || xs->xs_type == XP_PATHEXPR) &&
+           xs->xs_int == A_NAN && xs->xs_c1 == NULL)
+        xs = xs->xs_c0;
+    if (xs == NULL)
+        return 0;
+    if (xs->xs_type == XP_UNION && xs->xs_int == XO_UNION){
+        if ((ret = split_xpath(yspec, nsc, xs->xs_c0, cvv)) <= 0)
+            return ret;
+        return split_xpath(yspec, nsc, xs->xs_c1, cvv);
+    }
+    if (xs->xs_type != XP_LOCPATH || (xs = xs->xs_c0) == NULL)
+        return 0;
+    if (xs->xs_type != XP_ABSPATH || xs->xs_int != A_ROOT || (xs = xs->xs_c0) == NULL)
+        return 0;
+    /* First step of relative location path */
+    while (xs != NULL && xs->xs_type == XP_RELLOCPATH && xs->xs_c1 != NULL)
+        xs = xs->xs_c0;
+    if (xs == NULL || xs->xs_type != XP_RELLOCPATH ||
+        (xs = xs->xs_c0) == NULL || xs->xs_type != XP_STEP || xs->xs_int != A_CHILD)
+        return 0;
+    return split_xpath_node(yspec, nsc, xs->xs_c0, cvv);
+}
+
+/*! Get the modules whose top-level nodes an xpath may select
+ *
+ * Only absolute location paths, and unions of them, where the first step is a name are
+ * recognized, eg /if:interfaces/if:interface[if:name='eth0'] or /a:x | /b:y
+ * The main datastore file is always read in addition to the module files.
+ * @param[in]  h        Clicon handle
+ * @param[in]  nsc      XML namespace context, or NULL
+ * @param[in]  xpath    XPATH
+ * @param[out] modules  Module names, or NULL if they cannot be determined. Free with cvec_free
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see xmldb_split_read
+ */
+int
+xmldb_split_modules(clicon_handle h,
+                    cvec         *nsc,
+                    const char   *xpath,
+                    cvec        **modules)
+{
+    int         retval = -1;
+    yang_stmt  *yspec;
+    xpath_tree *xptree = NULL;
+    cvec       *cvv = NULL;
+    int         ret;
+
+    *modules = NULL;
+    if ((yspec = clicon_dbspec_yang(h)) == NULL ||
+        xpath == NULL || strlen(xpath) == 0)
+        goto ok;
+    if (xpath_parse(xpath, &xptree) < 0)
+        goto done;
+    if ((cvv = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if ((ret = split_xpath(yspec, nsc, xptree, cvv)) < 0)
+        goto done;
+    if (ret == 1){
+        *modules = cvv;
+        cvv = NULL;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (cvv)
+        cvec_free(cvv);
+    if (xptree)
+        xpath_tree_free(xptree);
+    return retval;
+}
+
+/*! Write module files of a datastore tree to the split datastore directory
+ *
+ * The nodes of a module are temporarily moved to a new top-level node while written,
+ * and then moved back to their positions. Files of modules not in the tree are removed.
+ * If CLICON_XMLDB_SPLIT_MOUNT is set, the content of mount-points is written to shard
+ * files, see split_shard_write.
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Name of datastore
+ * @param[in]  x0     Datastore tree, top-level is DATASTORE_TOP_SYMBOL
+ * @param[in]  dirty  Names of modified modules, NULL if any may be modified
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+xmldb_split_write(clicon_handle h,
+                  const char   *db,
+                  cxobj        *x0,
+                  cvec         *dirty)
+{
+    int            retval = -1;
+    yang_stmt     *yspec;
+    char          *dir = NULL;
+    cvec          *modules = NULL;
+    cg_var        *cv;
+    cxobj         *x;
+    cxobj         *xt = NULL;
+    cxobj        **vec = NULL;
+    int           *pos = NULL;
+    int            len;
+    int            i;
+    int            n;
+    char          *name;
+    cbuf          *cbf = NULL;
+    cbuf          *cbt = NULL;
+    struct dirent *dp = NULL;
+    int            ndp;
+    struct stat    st;
+    int            shard;
+    char          *format;
+    struct split_shard *svec = NULL;
+    int            slen = 0;
+
+    yspec = clicon_dbspec_yang(h);
+    /* Shard references are attributes, only in XML */
+    format = clicon_option_str(h, "CLICON_XMLDB_FORMAT");
+    shard = clicon_option_bool(h, "CLICON_XMLDB_SPLIT_MOUNT") &&
+        format && strcmp(format, "xml") == 0;
+    if (xmldb_db2dir(h, db, &dir) < 0)
+        goto done;
+    if (stat(dir, &st) < 0 && mkdir(dir, S_IRWXU) < 0){
+        clicon_err(OE_UNIX, errno, "mkdir(%s)", dir);
+        goto done;
+    }
+    if ((cbf = cbuf_new()) == NULL ||
+        (cbt = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    len = xml_child_nr_type(x0, CX_ELMNT);
+    if ((vec = calloc(len+1, sizeof(cxobj *))) == NULL ||
+        (pos = calloc(len+1, sizeof(int))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Modules of the tree, in tree order */
+    if ((modules = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    x = NULL;
+    while ((x = xml_child_each(x0, x, CX_ELMNT)) != NULL){
+        name = split_module(yspec, x);
+        if (cvec_find(modules, name) == NULL &&
+            cvec_add_string(modules, name, NULL) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    }
+    cv = NULL;
+    while ((cv = cvec_each(modules, cv)) != NULL){
+        name = cv_name_get(cv);
+        if (dirty && cvec_find(dirty, name) == NULL)
+            continue;
+        /* Collect nodes of module and their positions */
+        n = 0;
+        for (i=0; i<xml_child_nr(x0); i++){
+            x = xml_child_i(x0, i);
+            if (xml_type(x) != CX_ELMNT || strcmp(split_module(yspec, x), name) != 0)
+                continue;
+            vec[n] = x;
+            pos[n++] = i;
+        }
+        if ((xt = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        for (i=0; i<n; i++)
+            if (xml_addsub(xt, vec[i]) < 0)
+                goto done;
+        if (shard && split_shard_write(h, dir, name, xt, dirty, &svec, &slen) < 0)
+            goto restore;
+        split_file(dir, name, ".tmp", cbt);
+        split_file(dir, name, "", cbf);
+        if (split_tree_write(h, cbuf_get(cbt), cbuf_get(cbf), xt) < 0)
+            goto restore;
+        if (split_shard_restore(svec, slen) < 0)
+            goto done;
+        if (svec){
+            free(svec);
+            svec = NULL;
+        }
+        slen = 0;
+        /* Shards of the module are written inline */
+        if (!shard){
+            split_shard_dir(dir, name, cbt);
+            if (split_rmdir(cbuf_get(cbt)) < 0)
+                goto restore;
+        }
+        /* Move nodes back to their positions, in increasing order */
+        for (i=0; i<n; i++){
+            if (xml_rm(vec[i]) < 0)
+                goto done;
+            if (xml_child_insert_pos(x0, vec[i], pos[i]) < 0)
+                goto done;
+            xml_parent_set(vec[i], x0);
+        }
+        xml_free(xt);
+        xt = NULL;
+    }
+    /* Remove files of modules no longer in the tree */
+    if ((ndp = clicon_file_dirent(dir, &dp, "(_db)$", S_IFREG)) < 0)
+        goto done;
+    for (i = 0; i < ndp; i++){
+        cbuf_reset(cbt);
+        cprintf(cbt, "%.*s", (int)(strlen(dp[i].d_name) - strlen("_db")), dp[i].d_name);
+        if (cvec_find(modules, cbuf_get(cbt)) != NULL)
+            continue;
+        split_file(dir, cbuf_get(cbt), "", cbf);
+        if (unlink(cbuf_get(cbf)) < 0 && errno != ENOENT){
+            clicon_err(OE_UNIX, errno, "unlink(%s)", cbuf_get(cbf));
+            goto done;
+        }
+        split_shard_dir(dir, cbuf_get(cbt), cbf);
+        if (split_rmdir(cbuf_get(cbf)) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (svec)
+        free(svec);
+    if (dp)
+        free(dp);
+    if (xt)
+        xml_free(xt);
+    if (vec)
+        free(vec);
+    if (pos)
+        free(pos);
+    if (modules)
+        cvec_free(modules);
+    if (cbf)
+        cbuf_free(cbf);
+    if (cbt)
+        cbuf_free(cbt);
+    if (dir)
+        free(dir);
+    return retval;
+ restore: /* Move nodes back before freeing xt on error */
+    if (split_shard_restore(svec, slen) < 0)
+        goto done;
+    for (i=0; i<n; i++){
+        if (xml_rm(vec[i]) < 0)
+            goto done;
+        if (xml_child_insert_pos(x0, vec[i], pos[i]) < 0)
+            goto done;
+        xml_parent_set(vec[i], x0);
+    }
+    goto done;
+}
+
+/*! Read module files of a split datastore and add their nodes to a tree
+ *
+ * Read-ahead of all module files is requested before parsing, so that the files are
+ * read from storage in parallel. Mount-point shards referenced by a module file are
+ * read with it.
+ * The nodes are not bound to YANG nor sorted.
+ * @param[in]  h        Clicon handle
+ * @param[in]  db       Name of datastore
+ * @param[in]  yspec    Top-level yang spec
+ * @param[in]  modules  Only read files of these modules, or NULL for all
+ * @param[in]  x0       Datastore tree, top-level is DATASTORE_TOP_SYMBOL
+ * @param[out] xerr     XML error
+ * @retval     0        OK, also if there is no split datastore directory
+ * @retval    -1        Error
+ * @see xmldb_split_modules
+ */
+int
+xmldb_split_read(clicon_handle h,
+                 const char   *db,
+                 yang_stmt    *yspec,
+                 cvec         *modules,
+                 cxobj        *x0,
+                 cxobj       **xerr)
+{
+    int            retval = -1;
+    char          *dir = NULL;
+    struct dirent *dp = NULL;
+    int            ndp = 0;
+    FILE         **fvec = NULL;
+    cxobj         *xt = NULL;
+    cxobj         *x;
+    cbuf          *cb = NULL;
+    struct stat    st;
+    cg_var        *cv;
+    char          *name;
+    int            i;
+
+    if (xmldb_db2dir(h, db, &dir) < 0)
+        goto done;
+    if (stat(dir, &st) < 0)
+        goto ok;
+    if (modules)
+        ndp = cvec_len(modules);
+    else if ((ndp = clicon_file_dirent(dir, &dp, "(_db)$", S_IFREG)) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((fvec = calloc(ndp+1, sizeof(FILE *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i = 0; i < ndp; i++){
+        if (modules){
+            cv = cvec_i(modules, i);
+            split_file(dir, cv_name_get(cv), "", cb);
+        }
+        else{
+            cbuf_reset(cb);
+            cprintf(cb, "%s/%s", dir, dp[i].d_name);
+        }
+        if ((fvec[i] = fopen(cbuf_get(cb), "r")) == NULL){
+            if (modules && errno == ENOENT) /* No data of module */
+                continue;
+            clicon_err(OE_UNIX, errno, "open(%s)", cbuf_get(cb));
+            goto done;
+        }
+#ifdef POSIX_FADV_WILLNEED
+        (void)posix_fadvise(fileno(fvec[i]), 0, 0, POSIX_FADV_WILLNEED);
+#endif
+        if (xmldb_compress_wrap(h, "r", &fvec[i]) < 0)
+            goto done;
+    }
+    for (i = 0; i < ndp; i++){
+        if (fvec[i] == NULL)
+            continue;
+        if (xmldb_parse_file(h, fvec[i], yspec, &xt, xerr) < 0)
+            goto done;
+        /* Add the content of mount-points, see CLICON_XMLDB_SPLIT_MOUNT */
+        if (modules)
+            name = cv_name_get(cvec_i(modules, i));
+        else {
+            dp[i].d_name[strlen(dp[i].d_name) - strlen("_db")] = '\0';
+            name = dp[i].d_name;
+        }
+        if (split_shard_read(h, dir, name, yspec, xt, cb, xerr) < 0)
+            goto done;
+        while ((x = xml_child_i_type(xt, 0, CX_ELMNT)) != NULL)
+            if (xml_addsub(x0, x) < 0)
+                goto done;
+        xml_free(xt);
+        xt = NULL;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    if (fvec){
+        for (i = 0; i < ndp; i++)
+            if (fvec[i])
+                fclose(fvec[i]);
+        free(fvec);
+    }
+    if (dp)
+        free(dp);
+    if (cb)
+        cbuf_free(cb);
+    if (dir)
+        free(dir);
+    return retval;
+}
+
+/*! Copy the files and shard directories of a split datastore directory
+ *
+ * Files are hard linked. Files that are already the same (same inode) are not touched,
+ * files and directories not in the source are removed.
+ * @param[in]  fromdir  Source directory
+ * @param[in]  todir    Destination directory
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+split_copy_dir(const char *fromdir,
+               const char *todir)
+{
+    int            retval = -1;
+    struct dirent *dp = NULL;
+    int            ndp;
+    cbuf          *cbf = NULL;
+    cbuf          *cbt = NULL;
+    cbuf          *cbtmp = NULL;
+    struct stat    st0;
+    struct stat    st1;
+    int            i;
+
+    if (stat(todir, &st1) < 0 && mkdir(todir, S_IRWXU) < 0){
+        clicon_err(OE_UNIX, errno, "mkdir(%s)", todir);
+        goto done;
+    }
+    if ((cbf = cbuf_new()) == NULL ||
+        (cbt = cbuf_new()) == NULL ||
+        (cbtmp = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((ndp = clicon_file_dirent(fromdir, &dp, "(_db)$", S_IFREG)) < 0)
+        goto done;
+    for (i = 0; i < ndp; i++){
+        cbuf_reset(cbf);
+        cprintf(cbf, "%s/%s", fromdir, dp[i].d_name);
+        cbuf_reset(cbt);
+        cprintf(cbt, "%s/%s", todir, dp[i].d_name);
+        if (stat(cbuf_get(cbf), &st0) < 0){
+            clicon_err(OE_UNIX, errno, "stat(%s)", cbuf_get(cbf));
+            goto done;
+        }
+        if (stat(cbuf_get(cbt), &st1) == 0 &&
+            st0.st_dev == st1.st_dev && st0.st_ino == st1.st_ino)
+            continue; /* Not modified */
+        cbuf_reset(cbtmp);
+        cprintf(cbtmp, "%s.tmp", cbuf_get(cbt));
+        unlink(cbuf_get(cbtmp));
+        if (link(cbuf_get(cbf), cbuf_get(cbtmp)) < 0 &&
+            clicon_file_copy(cbuf_get(cbf), cbuf_get(cbtmp)) < 0)
+            goto done;
+        if (rename(cbuf_get(cbtmp), cbuf_get(cbt)) < 0){
+            clicon_err(OE_UNIX, errno, "rename(%s)", cbuf_get(cbt));
+            goto done;
+        }
+    }
+    free(dp);
+    dp = NULL;
+    /* Remove files not in source */
+    if ((ndp = clicon_file_dirent(todir, &dp, "(_db)$", S_IFREG)) < 0)
+        goto done;
+    for (i = 0; i < ndp; i++){
+        cbuf_reset(cbf);
+        cprintf(cbf, "%s/%s", fromdir, dp[i].d_name);
+        if (stat(cbuf_get(cbf), &st0) == 0)
+            continue;
+        cbuf_reset(cbt);
+        cprintf(cbt, "%s/%s", todir, dp[i].d_name);
+        if (unlink(cbuf_get(cbt)) < 0 && errno != ENOENT){
+            clicon_err(OE_UNIX, errno, "unlink(%s)", cbuf_get(cbt));
+            goto done;
+        }
+    }
+    free(dp);
+    dp = NULL;
+    /* Shard directories of modules, see CLICON_XMLDB_SPLIT_MOUNT */
+    if ((ndp = clicon_file_dirent(fromdir, &dp, "(_db\\.d)$", S_IFDIR)) < 0)
+        goto done;
+    for (i = 0; i < ndp; i++){
+        cbuf_reset(cbf);
+        cprintf(cbf, "%s/%s", fromdir, dp[i].d_name);
+        cbuf_reset(cbt);
+        cprintf(cbt, "%s/%s", todir, dp[i].d_name);
+        if (split_copy_dir(cbuf_get(cbf), cbuf_get(cbt)) < 0)
+            goto done;
+    }
+    free(dp);
+    dp = NULL;
+    if ((ndp = clicon_file_dirent(todir, &dp, "(_db\\.d)$", S_IFDIR)) < 0)
+        goto done;
+    for (i = 0; i < ndp; i++){
+        cbuf_reset(cbf);
+        cprintf(cbf, "%s/%s", fromdir, dp[i].d_name);
+        if (stat(cbuf_get(cbf), &st0) == 0)
+            continue;
+        cbuf_reset(cbt);
+        cprintf(cbt, "%s/%s", todir, dp[i].d_name);
+        if (split_rmdir(cbuf_get(cbt)) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (dp)
+        free(dp);
+    if (cbf)
+        cbuf_free(cbf);
+    if (cbt)
+        cbuf_free(cbt);
+    if (cbtmp)
+        cbuf_free(cbtmp);
+    return retval;
+}
+
+/*! Copy the module files of a split datastore
+ *
+ * Module and shard files are hard linked. Files that are already the same (same inode)
+ * are not touched, files not in the source are removed.
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database
+ * @param[in]  to    Destination database
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_copy
+ */
+int
+xmldb_split_copy(clicon_handle h,
+                 const char   *from,
+                 const char   *to)
+{
+    int         retval = -1;
+    char       *fromdir = NULL;
+    char       *todir = NULL;
+    struct stat st;
+
+    if (xmldb_db2dir(h, from, &fromdir) < 0)
+        goto done;
+    if (stat(fromdir, &st) < 0){
+        retval = xmldb_split_remove(h, to);
+        goto done;
+    }
+    if (xmldb_db2dir(h, to, &todir) < 0)
+        goto done;
+    retval = split_copy_dir(fromdir, todir);
+ done:
+    if (fromdir)
+        free(fromdir);
+    if (todir)
+        free(todir);
+    return retval;
+}
+
+/*! Remove a split datastore directory and its files and shard directories
+ *
+ * @param[in]  dir   Split datastore directory
+ * @retval     0     OK, also if it does not exist
+ * @retval    -1     Error
+ */
+static int
+split_rmdir(const char *dir)
+{
+    int            retval = -1;
+    struct dirent *dp = NULL;
+    int            ndp;
+    cbuf          *cb = NULL;
+    struct stat    st;
+    int            i;
+
+    if (stat(dir, &st) < 0)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((ndp = clicon_file_dirent(dir, &dp, NULL, S_IFREG)) < 0)
+        goto done;
+    for (i = 0; i < ndp; i++){
+        cbuf_reset(cb);
+        cprintf(cb, "%s/%s", dir, dp[i].d_name);
+        if (unlink(cbuf_get(cb)) < 0 && errno != ENOENT){
+            clicon_err(OE_UNIX, errno, "unlink(%s)", cbuf_get(cb));
+            goto done;
+        }
+    }
+    free(dp);
+    dp = NULL;
+    if ((ndp = clicon_file_dirent(dir, &dp, "(_db\\.d)$", S_IFDIR)) < 0)
+        goto done;
+    for (i = 0; i < ndp; i++){
+        cbuf_reset(cb);
+        cprintf(cb, "%s/%s", dir, dp[i].d_name);
+        if (split_rmdir(cbuf_get(cb)) < 0)
+            goto done;
+    }
+    if (rmdir(dir) < 0){
+        clicon_err(OE_UNIX, errno, "rmdir(%s)", dir);
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (dp)
+        free(dp);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Remove the split datastore directory of a datastore, if any
+ *
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Name of database
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+xmldb_split_remove(clicon_handle h,
+                   const char   *db)
+{
+    int   retval = -1;
+    char *dir = NULL;
+
+    if (xmldb_db2dir(h, db, &dir) < 0)
+        goto done;
+    retval = split_rmdir(dir);
+ done:
+    if (dir)
+        free(dir);
+    return retval;
+}
+
+/*! Rename the split datastore directory along with the datastore file
+ *
+ * @param[in]  h        Clicon handle
+ * @param[in]  db       Name of database
+ * @param[in]  newfile  New name of datastore file, the directory is <newfile>.d
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see xmldb_rename
+ */
+int
+xmldb_split_rename(clicon_handle h,
+                   const char   *db,
+                   const char   *newfile)
+{
+    int         retval = -1;
+    char       *dir = NULL;
+    cbuf       *cb = NULL;
+    struct stat st;
+
+    if (xmldb_db2dir(h, db, &dir) < 0)
+        goto done;
+    if (stat(dir, &st) < 0)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s.d", newfile);
+    if (split_rmdir(cbuf_get(cb)) < 0)
+        goto done;
+    if (rename(dir, cbuf_get(cb)) < 0){
+        clicon_err(OE_UNIX, errno, "rename(%s)", cbuf_get(cb));
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (dir)
+        free(dir);
+    return retval;
+}
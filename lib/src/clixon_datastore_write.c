@@ -78,11 +78,17 @@
 #include "clixon_yang_schema_mount.h"
 #include "clixon_xml_nsctx.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_binary.h"
+#include "clixon_cbor.h"
 #include "clixon_xml_default.h"
+#include "clixon_xml_vec.h"
 #include "clixon_xml_map.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
+#include "clixon_datastore_journal.h"
+#include "clixon_datastore_split.h"
+#include "clixon_probe.h"
 
 /*! Given an attribute name and its expected namespace, find its value
  * 
@@ -428,6 +434,109 @@ choice_delete_other(cxobj     *x0,
     return retval;
 }
 
+/*! Check if an existing node can be replaced in place instead of removed and re-created
+ *
+ * Not if the node is anyxml/anydata, or if it has ordered-by user list or leaf-list
+ * children, since their order is then given by the replacing tree
+ * @param[in]  y0      Yang spec of node
+ * @retval     1       Replace in place, see text_modify_replace_rest
+ * @retval     0       Remove and re-create
+ */
+static int
+text_modify_replace_inplace(yang_stmt *y0)
+{
+    yang_stmt *yc;
+
+    switch (yang_keyword_get(y0)){
+    case Y_ANYXML:
+    case Y_ANYDATA:
+        return 0;
+    default:
+        break;
+    }
+    yc = NULL;
+    while ((yc = yn_each(y0, yc)) != NULL){
+        switch (yang_keyword_get(yc)){
+        case Y_LIST:
+        case Y_LEAF_LIST:
+            if (yang_find(yc, Y_ORDERED_BY, "user") != NULL)
+                return 0;
+            break;
+        case Y_CHOICE:
+        case Y_CASE:
+            if (text_modify_replace_inplace(yc) == 0)
+                return 0;
+            break;
+        default:
+            break;
+        }
+    }
+    return 1;
+}
+
+/*! Collect children of x0 that are not matched by the replacing tree
+ *
+ * @param[in]  x0      Base tree node replaced in place
+ * @param[in]  x0vec   Children of x0 matching children of the replacing tree, or NULL
+ * @param[in]  len     Length of x0vec
+ * @param[out] xvp     Vector of unmatched element children of x0, free with free()
+ * @param[out] lenp    Length of xvp
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see text_modify_replace_inplace
+ */
+static int
+text_modify_replace_rest(cxobj   *x0,
+                         cxobj  **x0vec,
+                         int      len,
+                         cxobj ***xvp,
+                         int     *lenp)
+{
+    int    retval = -1;
+    char  *matched = NULL;
+    cxobj *x0c;
+    int    n;
+    int    i;
+
+    *lenp = 0;
+    if ((n = xml_child_nr(x0)) == 0)
+        goto ok;
+    if ((matched = calloc(n, sizeof(char))) == NULL ||
+        (*xvp = calloc(n, sizeof(cxobj *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    xml_enumerate_children(x0);
+    for (i=0; i<len; i++)
+        if (x0vec[i] != NULL)
+            matched[xml_enumerate_get(x0vec[i])] = 1;
+    x0c = NULL;
+    while ((x0c = xml_child_each(x0, x0c, CX_ELMNT)) != NULL)
+        if (!matched[xml_enumerate_get(x0c)])
+            (*xvp)[(*lenp)++] = x0c;
+ ok:
+    retval = 0;
+ done:
+    if (matched)
+        free(matched);
+    return retval;
+}
+
+/*! Mark a node and its ancestors as edited
+ *
+ * Ancestors of an edited node are also marked, so stop at the first marked ancestor
+ * @param[in]  x    XML node, can be NULL
+ * @see CLICON_XMLDB_CANDIDATE_DELTA
+ */
+static void
+text_modify_dirty(cxobj *x)
+{
+    while (x != NULL && xml_flag(x, XML_FLAG_DIRTY) == 0){
+        xml_flag_set(x, XML_FLAG_DIRTY);
+        x = xml_parent(x);
+    }
+}
+
 /*! Modify a base tree x0 with x1 with yang spec y according to operation op
  *
  * @param[in]  h        Clicon handle
@@ -442,10 +551,13 @@ choice_delete_other(cxobj     *x0,
  * @param[in]  xnacm    NACM XML tree (only if !permit)
  * @param[in]  permit   If set, no NACM tests using xnacm required
  * @param[out] cbret    Initialized cligen buffer. Contains return XML if retval is 0.
+ * @param[in]  xvnew    If set, new x0 nodes are appended here instead of inserted into x0p
  * @retval     1        OK
  * @retval     0        Failed (cbret set)
  * @retval    -1        Error
  * Assume x0 and x1 are same on entry and that y is the spec
+ * If xvnew is set, the caller inserts the new nodes with xml_insert_bulk. This is not done
+ * for ordered-by user, since later siblings may be inserted relative to them.
  * @see text_modify_top
  * RFC 7950 Sec 7.7.9(leaf-list), 7.8.6(lists)
  * In an "ordered-by user" list, the attributes "insert" and "key" in
@@ -464,7 +576,8 @@ text_modify(clicon_handle       h,
             char               *username,
             cxobj              *xnacm,
             int                 permit,
-            cbuf               *cbret)
+            cbuf               *cbret,
+            clixon_xvec        *xvnew)
 {
     int        retval = -1;
     char      *opstr = NULL;
@@ -491,11 +604,20 @@ text_modify(clicon_handle       h,
     int        ismount = 0;
     yang_stmt *mount_yspec = NULL;
     char      *creator = NULL;
+    clixon_xvec *xvc = NULL;  /* New children of x0 to insert in bulk */
+    cxobj    **xv = NULL;
+    int        xlen = 0;
+    int        userorder = 0;
+    int        inplace = 0;  /* Replace existing node in place */
+    cxobj    **xrest = NULL; /* Children of x0 not in replacing tree */
+    int        xrestlen = 0;
 
     if (x1 == NULL){
         clicon_err(OE_XML, EINVAL, "x1 is missing");
         goto done;
     }
+    /* Children of x0p may be changed below */
+    text_modify_dirty(x0p);
     if ((ret = check_when_condition(x0p, x1, y0, cbret)) < 0)
         goto done;
     if (ret == 0)
@@ -554,6 +676,7 @@ text_modify(clicon_handle       h,
          */
         if (yang_keyword_get(y0) == Y_LEAF_LIST &&
             yang_find(y0, Y_ORDERED_BY, "user") != NULL){
+            userorder++;
             if ((ret = attr_ns_value(x1,
                                      "insert", YANG_XML_NAMESPACE,
                                      cbret, &instr)) < 0)
@@ -598,11 +721,14 @@ text_modify(clicon_handle       h,
                 }
                 /* XXX: Note, if there is an error in adding the object later, the
                  * original object is not reverted.
+                 * A replaced leaf keeps its place, only its value is set below
                  */
-                if (x0){
+                if (x0 && (op != OP_REPLACE || userorder)){
                     xml_purge(x0);
                     x0 = NULL;
                 }
+                else if (x0 && xml_flag(x0, XML_FLAG_DEFAULT)) /* Now explicitly set */
+                    xml_flag_reset(x0, XML_FLAG_DEFAULT);
             } /* OP_MERGE & insert */
         case OP_NONE: /* fall thru */
             if (x0==NULL){
@@ -701,7 +827,12 @@ text_modify(clicon_handle       h,
                     goto done;
             }
             if (changed){ 
-                if (xml_insert(x0p, x0, insert, valstr, NULL) < 0) 
+                if (xvnew && !userorder){
+                    if (clixon_xvec_append(xvnew, x0) < 0)
+                        goto done;
+                    changed = 0; /* Owned by xvnew */
+                }
+                else if (xml_insert(x0p, x0, insert, valstr, NULL) < 0) 
                     goto done;
             }
             break;
@@ -749,6 +880,7 @@ text_modify(clicon_handle       h,
          */
         if (yang_keyword_get(y0) == Y_LIST &&
             yang_find(y0, Y_ORDERED_BY, "user") != NULL){
+            userorder++;
             if ((ret = attr_ns_value(x1,
                                      "insert", YANG_XML_NAMESPACE,
                                      cbret, &instr)) < 0)
@@ -798,8 +930,14 @@ text_modify(clicon_handle       h,
                 }
                 /* XXX: Note, if there is an error in adding the object later, the
                  * original object is not reverted.
+                 * A replaced node is kept and only its differences are applied: matching
+                 * children are replaced recursively and the rest are removed below
                  */
-                if (x0){
+                if (x0 && op == OP_REPLACE && !userorder && text_modify_replace_inplace(y0)){
+                    inplace++;
+                    xml_flag_reset(x0, XML_FLAG_DEFAULT); /* Now explicitly set */
+                }
+                else if (x0){
                     xml_purge(x0);
                     x0 = NULL;
                 }
@@ -829,6 +967,7 @@ text_modify(clicon_handle       h,
                     goto done;
                 if (xml_copy(x1, x0) < 0)
                     goto done;
+                text_modify_dirty(x0);
                 break;
             } /* anyxml, anydata */
             if (x0==NULL){
@@ -861,6 +1000,8 @@ text_modify(clicon_handle       h,
                 if (op==OP_NONE)
                     xml_flag_set(x0, XML_FLAG_NONE); /* Mark for potential deletion */
             }
+            /* x0 may be new or its children may be replaced */
+            text_modify_dirty(x0);
             /* First pass: Loop through children of the x1 modification tree 
              * collect matching nodes from x0 in x0vec (no changes to x0 children)
              */
@@ -911,10 +1052,18 @@ text_modify(clicon_handle       h,
                     goto done;
                 x0vec[i++] = x0c; /* != NULL if x0c is matching x1c */
             }
+            /* Existing children not in the replacing tree are removed after second pass */
+            if (inplace &&
+                text_modify_replace_rest(x0, x0vec, i, &xrest, &xrestlen) < 0)
+                goto done;
             /* Second pass: Loop through children of the x1 modification tree again
              * Now potentially modify x0:s children 
              * Here x0vec contains one-to-one matching nodes of x1:s children.
+             * If many, new children are collected in xvc and inserted in bulk.
              */
+            if (i >= XML_INSERT_BULK_THRESHOLD &&
+                (xvc = clixon_xvec_new()) == NULL)
+                goto done;
             x1c = NULL;
             i = 0;
             while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) {
@@ -934,18 +1083,30 @@ text_modify(clicon_handle       h,
                     else{
                         if ((ret = text_modify(h, x0c, x0, x0t, x1c, x1t,
                                                yc, op,
-                                               username, xnacm, permit, cbret)) < 0)
+                                               username, xnacm, permit, cbret, xvc)) < 0)
                             goto done;
                     }
                 }
                 else if ((ret = text_modify(h, x0c, x0, x0t, x1c, x1t,
                                             yc, op,
-                                            username, xnacm, permit, cbret)) < 0)
+                                            username, xnacm, permit, cbret, xvc)) < 0)
                     goto done;
                 /* If xml return - ie netconf error xml tree, then stop and return OK */
                 if (ret == 0)
-                    goto fail;
+                    break;
+            }
+            /* Insert also on error, to keep the partial modification as without bulk */
+            if (xvc){
+                if (clixon_xvec_extract(xvc, &xv, &xlen, NULL) < 0)
+                    goto done;
+                if (xml_insert_bulk(x0, xv, xlen) < 0)
+                    goto done;
             }
+            if (ret == 0)
+                goto fail;
+            for (i=0; i<xrestlen; i++)
+                if (xml_purge(xrest[i]) < 0)
+                    goto done;
             if (creator){
                 if (xml_creator_add(x0, creator) < 0)
                     goto done;
@@ -954,7 +1115,12 @@ text_modify(clicon_handle       h,
 #ifdef XML_PARENT_CANDIDATE
                 xml_parent_candidate_set(x0, NULL);
 #endif
-                if (xml_insert(x0p, x0, insert, keystr, nscx1) < 0)
+                if (xvnew && !userorder){
+                    if (clixon_xvec_append(xvnew, x0) < 0)
+                        goto done;
+                    changed = 0; /* Owned by xvnew */
+                }
+                else if (xml_insert(x0p, x0, insert, keystr, nscx1) < 0)
                     goto done;
 
             }
@@ -1002,6 +1168,18 @@ text_modify(clicon_handle       h,
         xml_purge(x0);
     if (x0vec)
         free(x0vec);
+    /* Remove dangling new children, if not yet inserted */
+    if (xvc){
+        if (xv == NULL){
+            for (i=0; i<clixon_xvec_len(xvc); i++)
+                xml_free(clixon_xvec_i(xvc, i));
+        }
+        clixon_xvec_free(xvc);
+    }
+    if (xv)
+        free(xv);
+    if (xrest)
+        free(xrest);
     return retval;
  fail: /* cbret set */
     retval = 0;
@@ -1045,6 +1223,7 @@ text_modify_top(clicon_handle       h,
     int        ret;
     char      *createstr = NULL;
     
+    text_modify_dirty(x0t);
     /* Check for operations embedded in tree according to netconf */
     if ((ret = attr_ns_value(x1t,
                              "operation", NETCONF_BASE_NAMESPACE,
@@ -1155,7 +1334,7 @@ text_modify_top(clicon_handle       h,
         }
         if ((ret = text_modify(h, x0c, x0t, x0t, x1c, x1t,
                                yc, op,
-                               username, xnacm, permit, cbret)) < 0)
+                               username, xnacm, permit, cbret, NULL)) < 0)
             goto done;
         /* If xml return - ie netconf error xml tree, then stop and return OK */
         if (ret == 0)
@@ -1174,6 +1353,182 @@ text_modify_top(clicon_handle       h,
     goto done;
 } /* text_modify_top */
 
+/*! Print a datastore tree to an open file in the CLICON_XMLDB_FORMAT format
+ *
+ * @param[in]  h      Clicon handle
+ * @param[in]  f      Open file
+ * @param[in]  xt     Datastore tree, top-level is DATASTORE_TOP_SYMBOL
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+xmldb_tree2file(clicon_handle h,
+                FILE         *f,
+                cxobj        *xt)
+{
+    int   retval = -1;
+    char *format;
+    int   pretty;
+
+    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
+        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
+        goto done;
+    }
+    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
+    if (strcmp(format,"json")==0){
+        if (clixon_json2file(f, xt, pretty, fprintf, 0, 0) < 0)
+            goto done;
+    }
+    else if (strcmp(format,"binary")==0){
+        if (clixon_xml2binary_file(f, xt) < 0)
+            goto done;
+    }
+    else if (strcmp(format,"cbor")==0){
+        if (clixon_xml2cbor_file(f, xt) < 0)
+            goto done;
+    }
+    else if (clixon_xml2file(f, xt, 0, pretty, NULL, fprintf, 0, 0) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Write a datastore tree to the datastore file in the CLICON_XMLDB_FORMAT format
+ *
+ * Module state is added before writing, if CLICON_XMLDB_MODSTATE is set
+ * If CLICON_XMLDB_SPLIT is set, the module subtrees are written to the module files of
+ * the split datastore directory, and the datastore file only contains module state.
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Name of datastore
+ * @param[in]  x0     Datastore tree, top-level is DATASTORE_TOP_SYMBOL
+ * @param[in]  dirty  Split datastore: names of modified modules, NULL if any may be modified
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xmldb_dump
+ * @see xmldb_split_write
+ */
+int
+xmldb_write_file(clicon_handle h,
+                 const char   *db,
+                 cxobj        *x0,
+                 cvec         *dirty)
+{
+    int    retval = -1;
+    char  *dbfile = NULL;
+    FILE  *f = NULL;
+    cxobj *xmodst = NULL;
+    cxobj *x;
+    cxobj *xt = NULL;
+    cxobj *xw;
+
+    if (xmldb_async_barrier(h, db) < 0)
+        goto done;
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if (dbfile==NULL){
+        clicon_err(OE_XML, 0, "dbfile NULL");
+        goto done;
+    }
+    if (clicon_option_bool(h, "CLICON_XMLDB_SPLIT")){
+        if (xmldb_split_write(h, db, x0, dirty) < 0)
+            goto done;
+        if ((xt = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        xw = xt;
+    }
+    else {
+        /* Remove module files from when CLICON_XMLDB_SPLIT was set */
+        if (xmldb_split_remove(h, db) < 0)
+            goto done;
+        xw = x0;
+    }
+    /* Add module revision info before writing to file)
+     * Only if CLICON_XMLDB_MODSTATE is set
+     */
+    if ((x = clicon_modst_cache_get(h, 1)) != NULL){
+        if ((xmodst = xml_dup(x)) == NULL)
+            goto done;
+        if (xml_addsub(xw, xmodst) < 0)
+            goto done;
+    }
+    if ((f = fopen(dbfile, "w")) == NULL){
+        clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
+        goto done;
+    }
+    /* Compress if CLICON_XMLDB_COMPRESS is set */
+    if (xmldb_compress_wrap(h, "w", &f) < 0)
+        goto done;
+    if (xmldb_tree2file(h, f, xw) < 0)
+        goto done;
+    /* A compressed stream is ended at close */
+    if (fclose(f) != 0){
+        f = NULL;
+        clicon_err(OE_UNIX, errno, "fclose(%s)", dbfile);
+        goto done;
+    }
+    f = NULL;
+    /* Remove modules state after writing to file
+     */
+    if (xmodst && xml_purge(xmodst) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    if (f != NULL)
+        fclose(f);
+    if (dbfile)
+        free(dbfile);
+    return retval;
+}
+
+/*! Modify a datastore tree with an edit tree without NACM and without writing to file
+ *
+ * Same as the modification part of xmldb_put, used when replaying a datastore journal
+ * @param[in]  h      Clicon handle
+ * @param[in]  x0     Datastore tree, top-level is DATASTORE_TOP_SYMBOL
+ * @param[in]  x1     Edit tree, top-level is NETCONF_INPUT_CONFIG, may contain operation attributes
+ * @param[in]  yspec  Yang spec
+ * @param[in]  op     Top-level operation, can be superceded by other op in tree
+ * @param[out] cbret  Initialized cligen buffer. On exit contains XML if retval == 0
+ * @retval     1      OK
+ * @retval     0      Failed, cbret contains error xml message
+ * @retval    -1      Error
+ * @see xmldb_put
+ */
+int
+xmldb_modify_tree(clicon_handle       h,
+                  cxobj              *x0,
+                  cxobj              *x1,
+                  yang_stmt          *yspec,
+                  enum operation_type op,
+                  cbuf               *cbret)
+{
+    int retval = -1;
+    int ret;
+
+    clicon_data_del(h, "objectexisted");
+    if ((ret = text_modify_top(h, x0, x1, yspec, op, NULL, NULL, 1, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* Remove NONE nodes if all subs recursively are also NONE */
+    if (xml_tree_prune_flagged_sub(x0, XML_FLAG_NONE, 0, NULL) <0)
+        goto done;
+    if (xml_flag_reset_rec(x0, XML_FLAG_NONE|XML_FLAG_MARK) < 0)
+        goto done;
+    /* Remove global defaults and empty non-presence containers */
+    if (xml_defaults_nopresence(x0, 2) < 0)
+        goto done;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Modify database given an xml tree and an operation
  *
  * @param[in]  h      CLICON handle
@@ -1207,23 +1562,19 @@ xmldb_put(clicon_handle       h,
           cbuf               *cbret)
 {
     int         retval = -1;
-    char       *dbfile = NULL;
-    FILE       *f = NULL;
     cbuf       *cb = NULL;
     yang_stmt  *yspec;
     cxobj      *x0 = NULL;
     db_elmnt   *de = NULL;
     int         ret;
     cxobj      *xnacm = NULL;
-    cxobj      *xmodst = NULL;
-    cxobj      *x;
     int         permit = 0; /* nacm permit all */
-    char       *format;
     cvec       *nsc = NULL; /* nacm namespace context */
     int         firsttime = 0;
-    int         pretty;
     cxobj      *xerr = NULL;
+    cvec       *dirty = NULL;
 
+    CLIXON_PROBE2(xmldb_put_start, db, xml_operation2str(op));
     if (cbret == NULL){
         clicon_err(OE_XML, EINVAL, "cbret is NULL");
         goto done;
@@ -1281,14 +1632,16 @@ xmldb_put(clicon_handle       h,
             xml_free(x0);
             x0 = NULL;
         }
+        /* The cache may be partially modified: new generation, see xmldb_delta */
+        else if (de != NULL && clicon_datastore_cache(h) != DATASTORE_NOCACHE)
+            clicon_db_elmnt_set(h, db, de);
         goto fail;
     }
 
     /* Remove NONE nodes if all subs recursively are also NONE */
     if (xml_tree_prune_flagged_sub(x0, XML_FLAG_NONE, 0, NULL) <0)
         goto done;
-    if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, 
-                  (void*)(XML_FLAG_NONE|XML_FLAG_MARK)) < 0)
+    if (xml_flag_reset_rec(x0, XML_FLAG_NONE|XML_FLAG_MARK) < 0)
         goto done;
     /* Remove global defaults and empty non-presence containers */
     if (xml_defaults_nopresence(x0, 2) < 0)
@@ -1306,56 +1659,36 @@ xmldb_put(clicon_handle       h,
         if (de0.de_xml == NULL)
             de0.de_xml = x0;
         de0.de_empty = (xml_child_nr(de0.de_xml) == 0);
+        xmldb_cache_touch(&de0);
         clicon_db_elmnt_set(h, db, &de0);
     }
-    if (xmldb_db2file(h, db, &dbfile) < 0)
+    /* Split datastore: only modules in the edit are rewritten, unless all is replaced */
+    if (clicon_option_bool(h, "CLICON_XMLDB_SPLIT") &&
+        x1 && (op == OP_MERGE || op == OP_NONE) &&
+        xmldb_split_dirty(h, x1, &dirty) < 0)
         goto done;
-    if (dbfile==NULL){
-        clicon_err(OE_XML, 0, "dbfile NULL");
-        goto done;
-    }
-    /* Add module revision info before writing to file)
-     * Only if CLICON_XMLDB_MODSTATE is set
-     */
-    if ((x = clicon_modst_cache_get(h, 1)) != NULL){
-        if ((xmodst = xml_dup(x)) == NULL)
-            goto done;
-        if (xml_addsub(x0, xmodst) < 0)
-            goto done;
-    }
-    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
-        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
+    if (xmldb_write_file(h, db, x0, dirty) < 0)
         goto done;
-    }
-    if ((f = fopen(dbfile, "w")) == NULL){
-        clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
+    /* The file is now a complete snapshot */
+    if (xmldb_journal_reset(h, db) < 0)
         goto done;
-    } 
-    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
-    if (strcmp(format,"json")==0){
-        if (clixon_json2file(f, x0, pretty, fprintf, 0, 0) < 0)
-            goto done;
-    }
-    else if (clixon_xml2file(f, x0, 0, pretty, NULL, fprintf, 0, 0) < 0)
+    if (xmldb_version_bump(h, db) < 0)
         goto done;
-    /* Remove modules state after writing to file
-     */
-    if (xmodst && xml_purge(xmodst) < 0)
+    if (xmldb_snapshot_write(h, db) < 0)
         goto done;
     retval = 1;
  done:
-    if (f != NULL)
-        fclose(f);
+    if (dirty)
+        cvec_free(dirty);
     if (xerr)
         xml_free(xerr);
     if (nsc)
         xml_nsctx_free(nsc);
-    if (dbfile)
-        free(dbfile);
     if (cb)
         cbuf_free(cb);
     if (x0 && clicon_datastore_cache(h) == DATASTORE_NOCACHE)
         xml_free(x0);
+    CLIXON_PROBE2(xmldb_put_done, db, retval);
     return retval;
  fail:
     retval = 0;
@@ -1372,8 +1705,6 @@ xmldb_dump(clicon_handle   h,
     int    retval = -1;
     cxobj *x;
     cxobj *xmodst = NULL;
-    char  *format;
-    int    pretty;
     
     /* clear XML tree of defaults */
     if (xml_tree_prune_flagged(xt, XML_FLAG_DEFAULT, 1) < 0)
@@ -1385,16 +1716,7 @@ xmldb_dump(clicon_handle   h,
         if (xml_child_insert_pos(xt, xmodst, 0) < 0)
             goto done;
     }
-    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
-        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
-        goto done;
-    }
-    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
-    if (strcmp(format,"json")==0){
-        if (clixon_json2file(f, xt, pretty, fprintf, 0, 0) < 0)
-            goto done;
-    }
-    else if (clixon_xml2file(f, xt, 0, pretty, NULL, fprintf, 0, 0) < 0)
+    if (xmldb_tree2file(h, f, xt) < 0)
         goto done;
     retval = 0;
  done:
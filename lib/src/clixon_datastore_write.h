@@ -46,5 +46,8 @@
  * Prototypes
  */
 int xmldb_put(clicon_handle h, const char *db, enum operation_type op, cxobj *xt, char *username, cbuf *cbret);
+int xmldb_tree2file(clicon_handle h, FILE *f, cxobj *xt);
+int xmldb_write_file(clicon_handle h, const char *db, cxobj *x0, cvec *dirty);
+int xmldb_modify_tree(clicon_handle h, cxobj *x0, cxobj *x1, yang_stmt *yspec, enum operation_type op, cbuf *cbret);
 
 #endif /* _CLIXON_DATASTORE_WRITE_H */
@@ -68,10 +68,22 @@
  *          [b=]
  *          [b]
  *
- * NOTE 2: there is no attempt to optimize list searching here, sorry. I
- * do not think that the known use cases will get big enough to make the
- * tree get too large. I do not recommend that you encode every possible
- * path, just top level key handlers.
+ * an element may also be registered with a key (/a/b=c or /a/b[k='c']),
+ * this entry only matches the element with exactly that key, or as "*"
+ * which matches any element:
+ *
+ *  [/]
+ *      [a]
+ *          [b=c]
+ *          [b]
+ *          [*]
+ *
+ * children of each entry are indexed by name in a hash table and the
+ * path is parsed in place, so a lookup costs O(path depth) independent
+ * of the number of registered paths.
+ * When several entries match an element, call_handlers follows the
+ * most specific: key, then name, then wildcard, while call_subtree
+ * follows all of them.
  *
  * there are 2 functions to the API:
  * clixon_register_handler(): build the dispatcher table
@@ -180,34 +192,178 @@ split_path_free(char **list,
     free(list);
 }
 
-/*! Find a peer of this node by name
- * search through the list pointed at by peer
+/*! Get next element of a path, without copying
  *
- * @param[in] node       Pointer to a node in the peer list
- * @param[in] node_name  Name of node we're looking for
- * @retval    pointer    Pointer to found node or NULL
- * @retval    NULL
+ * @param[in,out] pp    Position in path, updated to after the element
+ * @param[out]    elem  Start of element
+ * @param[out]    len   Length of element, including key
+ * @param[out]    nlen  Length of name of element, without key
+ * @retval        1     Element found
+ * @retval        0     End of path
  */
-static dispatcher_entry_t *
-find_peer(dispatcher_entry_t *node, char *node_name)
+static int
+path_next(const char **pp,
+          const char **elem,
+          size_t      *len,
+          size_t      *nlen)
 {
-    dispatcher_entry_t *i;
+    const char *p = *pp;
     
-    if ((node == NULL) || (node_name == NULL)) {
-        /*  protect against idiot users */
+    while (*p == '/')
+        p++;
+    if (*p == '\0')
+        return 0;
+    *elem = p;
+    while (*p != '\0' && *p != '/')
+        p++;
+    *len = p - *elem;
+    *nlen = strcspn(*elem, "=[]");
+    if (*nlen > *len)
+        *nlen = *len;
+    *pp = p;
+    return 1;
+}
+
+/*! Hash of a name, FNV-1a
+ */
+static size_t
+name_hash(const char *name,
+          size_t      len)
+{
+    size_t h = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        h = (h ^ (unsigned char)name[i]) * 16777619u;
+    return h;
+}
+
+/*! Find a child of a node by name in the child index
+ *
+ * @param[in] node  Parent node
+ * @param[in] name  Name of child, not necessarily null-terminated
+ * @param[in] len   Length of name
+ * @retval    child Found child node
+ * @retval    NULL  Not found
+ */
+static dispatcher_entry_t *
+find_child(dispatcher_entry_t *node,
+           const char         *name,
+           size_t              len)
+{
+    dispatcher_entry_t *c;
+    size_t              i;
+
+    if (node == NULL || node->child_tabsize == 0)
         return NULL;
+    i = name_hash(name, len) & (node->child_tabsize - 1);
+    while ((c = node->child_tab[i]) != NULL){
+        if (strncmp(c->node_name, name, len) == 0 && c->node_name[len] == '\0')
+            return c;
+        i = (i + 1) & (node->child_tabsize - 1);
     }
+    return NULL;
+}
 
-    i = node->peer_head;
-
-    while (i != NULL) {
-        if (strcmp(node_name, i->node_name) == 0) {
-            break;
+/*! Add a child node to the child index of its parent, grow index if needed
+ *
+ * @param[in] node   Parent node
+ * @param[in] child  Child node, not already in index
+ * @retval    0      OK
+ * @retval   -1      Error
+ */
+static int
+index_child(dispatcher_entry_t *node,
+            dispatcher_entry_t *child)
+{
+    dispatcher_entry_t **tab;
+    dispatcher_entry_t  *c;
+    size_t               size;
+    size_t               i;
+    size_t               j;
+
+    if ((node->child_nr + 1) * 2 > node->child_tabsize){
+        size = node->child_tabsize ? node->child_tabsize * 2 : 8;
+        if ((tab = calloc(size, sizeof(*tab))) == NULL)
+            return -1;
+        for (i = 0; i < node->child_tabsize; i++){
+            if ((c = node->child_tab[i]) == NULL)
+                continue;
+            j = name_hash(c->node_name, strlen(c->node_name)) & (size - 1);
+            while (tab[j] != NULL)
+                j = (j + 1) & (size - 1);
+            tab[j] = c;
         }
-        i = i->peer;
+        if (node->child_tab)
+            free(node->child_tab);
+        node->child_tab = tab;
+        node->child_tabsize = size;
     }
+    j = name_hash(child->node_name, strlen(child->node_name)) & (node->child_tabsize - 1);
+    while (node->child_tab[j] != NULL)
+        j = (j + 1) & (node->child_tabsize - 1);
+    node->child_tab[j] = child;
+    node->child_nr++;
+    return 0;
+}
 
-    return i;
+/*! Find matching children of a node given a path element
+ *
+ * @param[in]  node   Parent node
+ * @param[in]  elem   Path element
+ * @param[in]  len    Length of element
+ * @param[in]  nlen   Length of name of element
+ * @param[out] match  Vector of up to 3 matches: key, name and wildcard, most specific first
+ * @retval     n      Number of matches
+ */
+static int
+match_children(dispatcher_entry_t *node,
+               const char         *elem,
+               size_t              len,
+               size_t              nlen,
+               dispatcher_entry_t *match[3])
+{
+    int n = 0;
+
+    if (nlen < len && (match[n] = find_child(node, elem, len)) != NULL)
+        n++;
+    if ((match[n] = find_child(node, elem, nlen)) != NULL)
+        n++;
+    if ((nlen != 1 || *elem != '*') &&
+        (match[n] = find_child(node, "*", 1)) != NULL)
+        n++;
+    return n;
+}
+
+/*! Find first entry of a top-level peer list matching a path
+ *
+ * @param[in]     root  Dispatcher tree, top-level peer list
+ * @param[in,out] pp    Position in path, updated to after first element
+ * @retval        entry Matching top-level entry
+ * @retval        NULL  No match
+ */
+static dispatcher_entry_t *
+match_top(dispatcher_entry_t *root,
+          const char        **pp)
+{
+    dispatcher_entry_t *i;
+    const char         *elem;
+    size_t              len;
+    size_t              nlen;
+
+    if (root == NULL)
+        return NULL;
+    if (**pp == '/'){
+        elem = "/";
+        nlen = 1;
+        (*pp)++;
+    }
+    else if (path_next(pp, &elem, &len, &nlen) == 0)
+        return NULL;
+    for (i = root->peer_head; i != NULL; i = i->peer)
+        if (strncmp(i->node_name, elem, nlen) == 0 && i->node_name[nlen] == '\0')
+            return i;
+    return NULL;
 }
 
 /*! Add a node as the last node in peer list
@@ -244,6 +400,7 @@ add_peer_node(dispatcher_entry_t *node,
         eptr = node->peer_head;
         while (eptr->peer != NULL) {
             if (strcmp(eptr->node_name, name) == 0) {
+                free(new_node);
                 return eptr;
             }
             eptr = eptr->peer;
@@ -251,6 +408,7 @@ add_peer_node(dispatcher_entry_t *node,
 
         // if eptr->node_name == name, we done
         if (strcmp(eptr->node_name, name) == 0) {
+            free(new_node);
             return eptr;
         }
 
@@ -283,60 +441,50 @@ add_child_node(dispatcher_entry_t *node,
 {
     dispatcher_entry_t *child_ptr;
 
+    if ((child_ptr = find_child(node, name, strlen(name))) != NULL)
+        return child_ptr;
     if ((child_ptr = add_peer_node(node->children, name)) == NULL)
         return NULL;
     node->children = child_ptr->peer_head;
-
+    if (index_child(node, child_ptr) < 0)
+        return NULL;
     return child_ptr;
 }
 
-/**
+/*! Get the closest entry with a handler on a path
  *
- * @param root
- * @param path
- * @retval
- * @retval NULL Error
+ * When several entries match an element, the most specific is followed: key, name, wildcard
+ * @param[in]  root  Dispatcher tree
+ * @param[in]  path  Path
+ * @retval     entry Closest entry with handler, or root
+ * @retval     NULL  Empty tree
  */
 static dispatcher_entry_t *
 get_entry(dispatcher_entry_t *root,
           char               *path)
 {
-    char              **split_path_list = NULL;
-    size_t              split_path_len = 0;
-    dispatcher_entry_t *ptr = root;
+    dispatcher_entry_t *ptr;
     dispatcher_entry_t *best = root;
-
-    /* cut the path up into individual elements */
-    if (split_path(path, &split_path_list, &split_path_len) < 0)
-        return NULL;
-
-    /* some elements may have keys defined, strip them off */
-    for (int i = 0; i < split_path_len; i++) {
-        char *kptr = split_path_list[i];
-        strsep(&kptr, "=[]");
-    }
-
+    dispatcher_entry_t *match[3];
+    const char         *p = path;
+    const char         *elem;
+    size_t              len;
+    size_t              nlen;
+
+    if ((ptr = match_top(root, &p)) == NULL)
+        return best;
+    if (ptr->handler != NULL)
+        best = ptr;
     /* search down the tree */
-    for (int i = 0; i < split_path_len; i++) {
-
-        char *query = split_path_list[i];
-        if ((ptr = find_peer(ptr, query)) == NULL) {
-            split_path_free(split_path_list, split_path_len);
-            /* we ran out of matches, use last found handler */
-            return best;
-        }
+    while (path_next(&p, &elem, &len, &nlen) == 1){
+        if (match_children(ptr, elem, len, nlen, match) == 0)
+            break; /* we ran out of matches, use last found handler */
+        ptr = match[0];
         if (ptr->handler != NULL) {
             /* if handler is defined, save it */
             best = ptr;
         }
-
-        /* skip to next element */
-        ptr = ptr->children;
     }
-
-    /* clean up */
-    split_path_free(split_path_list, split_path_len);
-    
     return best;
 }
 
@@ -367,6 +515,75 @@ call_handler_helper(dispatcher_entry_t *entry,
     return 1;
 }
 
+/*! Call all handlers of the entries in a peer list and their descendants
+ *
+ * @param[in]  entry      Pointer to an entry of the peer list
+ * @param[in]  handle
+ * @param[in]  path
+ * @param[in]  user_args
+ * @retval     0          OK
+ * @retval    -1          A handler returned error
+ */
+static int
+call_subtree_helper(dispatcher_entry_t *entry,
+                    void               *handle,
+                    char               *path,
+                    void               *user_args)
+{
+    dispatcher_entry_t *i;
+
+    for (i = entry->peer_head; i != NULL; i = i->peer) {
+        if (i->handler != NULL &&
+            (i->handler)(handle, path, user_args, i->arg) < 0)
+            return -1;
+        if (i->children != NULL &&
+            call_subtree_helper(i->children, handle, path, user_args) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Call handler of an entry matching a path element, and of the entries matching the rest
+ *
+ * At end of path, all handlers below the entry are called
+ * @param[in]  entry      Entry matching an element of path
+ * @param[in]  p          Rest of path after the element
+ * @param[in]  handle
+ * @param[in]  path       Complete path
+ * @param[in]  user_args
+ * @retval     0          OK
+ * @retval    -1          A handler returned error
+ */
+static int
+call_subtree_match(dispatcher_entry_t *entry,
+                   const char         *p,
+                   void               *handle,
+                   char               *path,
+                   void               *user_args)
+{
+    dispatcher_entry_t *match[3];
+    const char         *elem;
+    size_t              len;
+    size_t              nlen;
+    int                 n;
+    int                 i;
+
+    if (entry->handler != NULL &&
+        (entry->handler)(handle, path, user_args, entry->arg) < 0)
+        return -1;
+    if (path_next(&p, &elem, &len, &nlen) == 0){
+        if (entry->children != NULL &&
+            call_subtree_helper(entry->children, handle, path, user_args) < 0)
+            return -1;
+        return 0;
+    }
+    n = match_children(entry, elem, len, nlen, match);
+    for (i = 0; i < n; i++)
+        if (call_subtree_match(match[i], p, handle, path, user_args) < 0)
+            return -1;
+    return 0;
+}
+
 /*
  * ===== PUBLIC API FUNCTIONS =====
  */
@@ -435,7 +652,7 @@ dispatcher_register_handler(dispatcher_entry_t   **root,
  *
  * @param[in]  handle
  * @param[in]  root
- * @param[in]  path   Note must be on the form: /a/b (no keys)
+ * @param[in]  path   On the form: /a/b, keys match only if registered with key
  * @retval     1      OK
  * @retval     0      Invalid
  * @retval    -1      Error
@@ -462,6 +679,34 @@ dispatcher_call_handlers(dispatcher_entry_t *root,
     return ret;
 }
 
+/*! Call the handlers of all entries whose path intersects a path
+ *
+ * That is, the handlers on the path itself, from the top, and all handlers below it.
+ * Unlike dispatcher_call_handlers, handlers on a diverging branch are not called, and all
+ * handlers on the path are called, not only the closest.
+ * The first handler returning error stops the call.
+ *
+ * @param[in]  root       Dispatcher tree
+ * @param[in]  handle
+ * @param[in]  path       On the form: /a/b, keys match only if registered with key, "/" is all handlers
+ * @param[in]  user_args  Per-call user arguments
+ * @retval     0          OK
+ * @retval    -1          Error, a handler returned error
+ */
+int
+dispatcher_call_subtree(dispatcher_entry_t *root,
+                        void               *handle,
+                        char               *path,
+                        void               *user_args)
+{
+    dispatcher_entry_t *ptr;
+    const char         *p = path;
+
+    if ((ptr = match_top(root, &p)) == NULL)
+        return 0;
+    return call_subtree_match(ptr, p, handle, path, user_args);
+}
+
 /*! Free a dispatcher tree
  */
 int
@@ -475,6 +720,8 @@ dispatcher_free(dispatcher_entry_t *root)
         dispatcher_free(root->peer);
     if (root->node_name)
         free(root->node_name);
+    if (root->child_tab)
+        free(root->child_tab);
     free(root);
     return 0;
 }
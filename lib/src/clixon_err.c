@@ -54,6 +54,7 @@
 #include <syslog.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 #include <sys/time.h>
 #include <sys/types.h>
 
@@ -101,6 +102,10 @@ int  clicon_errno         = 0; /* See enum clicon_err XXX: hide this and change
 int  clicon_suberrno      = 0; /* Corresponds to errno.h XXX: change to errno */
 char clicon_err_reason[ERR_STRLEN] = {0, };
 
+/* Owner of error and log state while other threads run, see clicon_err_thread */
+static pthread_t _err_owner;
+static int       _err_threads = 0;
+
 /*
  * Error descriptions. Must stop with NULL element.
  */
@@ -141,6 +146,41 @@ clicon_strerror1(int           err,
     return ev?(ev->ev_str?ev->ev_str:"unknown"):"CLICON unknown error";
 }
 
+/*! Restrict error and log state to the calling thread while other threads run
+ *
+ * Error variables, log rate limits and log destinations are not thread-safe. Call from the
+ * main thread before creating a thread that may report errors, and again with off after
+ * the thread is joined. Errors and logs of other threads are dropped in between, the
+ * thread needs to signal failure by other means. Calls may be nested.
+ * errno itself is per thread.
+ * @param[in]  on    1: calling thread owns error state, 0: undo a previous call
+ * @retval     0     OK
+ * @see clicon_err_thread_owner
+ */
+int
+clicon_err_thread(int on)
+{
+    if (on){
+        if (_err_threads++ == 0)
+            _err_owner = pthread_self();
+    }
+    else if (_err_threads > 0)
+        _err_threads--;
+    return 0;
+}
+
+/*! Check if calling thread may use error and log state
+ *
+ * @retval     1     Yes, no other threads registered or calling thread is owner
+ * @retval     0     No, calling thread is not owner
+ * @see clicon_err_thread
+ */
+int
+clicon_err_thread_owner(void)
+{
+    return _err_threads == 0 || pthread_equal(_err_owner, pthread_self());
+}
+
 /*! Clear error state and continue.
  *
  * Clear error state and get on with it, typically non-fatal error and you wish to continue.
@@ -148,6 +188,8 @@ clicon_strerror1(int           err,
 int
 clicon_err_reset(void)
 {
+    if (!clicon_err_thread_owner())
+        return 0;
     clicon_errno = 0;
     clicon_suberrno = 0;
     memset(clicon_err_reason, 0, ERR_STRLEN);
@@ -214,6 +256,9 @@ clicon_err_fn(const char *fn,
     int     retval = -1;
     struct clixon_err_cats *cec;
     
+    /* Drop errors of other threads, see clicon_err_thread */
+    if (!clicon_err_thread_owner())
+        return 0;
     /* Set the global variables */
     clicon_errno    = category;
     clicon_suberrno = suberr;
@@ -238,6 +283,9 @@ clicon_err_fn(const char *fn,
     }
     va_end(args);
     strncpy(clicon_err_reason, msg, ERR_STRLEN-1);
+    /* Error is set but not logged if rate limit of call site is exceeded */
+    if (clicon_log_rate_check(fn, line) == 0)
+        goto ok;
     /* Check category callbacks as defined in clixon_err_cat_reg */
     if ((cec = find_category(category)) != NULL &&
         cec->cec_logfn){
@@ -291,6 +339,7 @@ clicon_err_fn(const char *fn,
                        clicon_strerror(category),
                        msg);
     }
+ ok:
     retval = 0;
  done:
     if (msg)
@@ -50,8 +50,14 @@
 #include <string.h>
 #include <signal.h>
 #include <syslog.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 
 #include <cligen/cligen.h>
 
@@ -69,29 +75,106 @@
  */
 #define EVENT_STRLEN 32
 
+/* Max number of callbacks that may be called at safe points, see clixon_event_yield_reg */
+#define EVENT_YIELD_MAX 8
+
+/* Number of safe points between checks of the clock, see clixon_event_yield */
+#define EVENT_YIELD_SKIP 64
+
+/* Events polled on a file descriptor */
+#define EVENT_IN  0x01 /* Ready for reading */
+#define EVENT_OUT 0x02 /* Ready for writing */
+
+#if defined(EVENT_EPOLL) && defined(HAVE_SYS_EPOLL_H)
+#define EVENT_POLL_EPOLL
+#endif
+
+#ifdef EVENT_POLL_EPOLL
+#define EVENT_POLL_NAME "epoll_wait"
+#else
+#define EVENT_POLL_NAME "select"
+#endif
+
 /*
  * Types
  */
 struct event_data{
-    struct event_data *e_next;     /* next in list */
+    struct event_data *e_next;     /* next in fd list or timeout hash bucket */
     int (*e_fn)(int, void*);            /* function */
     enum {EVENT_FD, EVENT_TIME} e_type;        /* type of event */
     int e_fd;                      /* File descriptor */
     struct timeval e_time;         /* Timeout */
+    uint64_t e_seq;                /* Timeout registration order */
+    int e_heapi;                   /* Timeout index in heap */
     void *e_arg;                   /* function argument */
     char e_string[EVENT_STRLEN];             /* string for debugging */
 };
 
+/* File descriptor entry, indexed by file descriptor */
+struct event_fd{
+    struct event_data *ef_events;  /* Callbacks registered on fd for input */
+    struct event_data *ef_wevents; /* Callbacks registered on fd for output */
+    int                ef_mask;    /* Events polled, EVENT_IN and/or EVENT_OUT */
+    int                ef_nopoll;  /* Set if fd cannot be polled, always ready, eg regular file */
+};
+
 /*
  * Internal variables
  * XXX consider use handle variables instead of global
  */
-static struct event_data *ee = NULL;
-static struct event_data *ee_timers = NULL;
+static struct event_fd   *ee_fds = NULL;    /* Vector of fd entries indexed by fd */
+static int                ee_fdlen = 0;     /* Length of ee_fds */
 
-/* Set if element in ee is deleted (clixon_event_unreg_fd). Check in ee loops */
+/* Timeouts in a binary min-heap ordered by time, and in a hash on fn and arg for
+ * deregistration. Both have ee_heaplen entries, the hash is rebuilt when the heap grows.
+ */
+static struct event_data **ee_heap = NULL;
+static int                 ee_heaplen = 0;
+static int                 ee_heapnr = 0;   /* Number of timeouts */
+static struct event_data **ee_thash = NULL;
+static int                 ee_thashlen = 0;
+static uint64_t            ee_tseq = 0;     /* Next timeout registration number */
+
+#ifdef EVENT_POLL_EPOLL
+/* Epoll instance, and process creating it: a child process creates its own */
+static int   _ee_epfd = -1;
+static pid_t _ee_eppid = 0;
+/* Number of fds that cannot be polled with epoll */
+static int   _ee_nopoll = 0;
+#else
+/* Registered fds for input and output, and highest registered fd */
+static fd_set _ee_fdset;
+static fd_set _ee_wfdset;
+static int    _ee_fdmax = -1;
+/* Next fd to scan for ready fds, for fairness if more than EVENT_POLL_MAX are ready */
+static int    _ee_fdscan = 0;
+#endif
+
+/* Monotonic time when ready fds were last returned by the poller, see clixon_event_wakeup */
+static struct timespec _ee_wakeup = {0,};
+
+/* Set if an fd callback is deleted (clixon_event_unreg_fd). Check in dispatch loops */
 static int _ee_unreg = 0;
 
+/* Callbacks that may be called at safe points of a preemptible section, and how */
+static struct {
+    int (*ey_fn)(int, void*);   /* Registered fd or timeout callback */
+    int (*ey_yfn)(int, void*);  /* Called instead at safe points */
+} _ee_yield[EVENT_YIELD_MAX];
+static int             _ee_yieldnr = 0;
+static uint64_t        _ee_yield_interval = 0; /* Microseconds, 0 means no preemption */
+static int             _ee_yield_section = 0;  /* Set in a preemptible section */
+static int             _ee_yield_busy = 0;     /* Set while callbacks of a safe point run */
+static int             _ee_yield_skip = 0;     /* Safe points until clock is checked */
+static pid_t           _ee_yield_pid = 0;      /* Process and thread of section */
+static pthread_t       _ee_yield_thread;
+static struct timespec _ee_yield_last;         /* Start of section or last poll */
+/* Scheduler statistics, see clixon_event_yield_stats */
+static uint64_t        _ee_yield_sections = 0;
+static uint64_t        _ee_yields = 0;
+static uint64_t        _ee_yield_time = 0;
+static uint64_t        _ee_yield_maxgap = 0;
+
 /* If set (eg by signal handler) exit select loop on next run and return 0 */
 static int _clicon_exit = 0;
 
@@ -161,6 +244,297 @@ clicon_sig_ignore_get(void)
     return _clicon_sig_ignore;
 }
 
+#ifdef EVENT_POLL_EPOLL
+/*! Set events polled on fd in epoll instance: add, modify or delete it
+ *
+ * @param[in]  fd    File descriptor
+ * @param[in]  mask  EVENT_IN and/or EVENT_OUT, or 0 to delete
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+event_epoll_ctl(int fd,
+                int mask)
+{
+    struct epoll_event ev = {0,};
+    struct event_fd   *ef = &ee_fds[fd];
+    int                op;
+
+    if (mask == 0)
+        op = EPOLL_CTL_DEL;
+    else if (ef->ef_mask == 0)
+        op = EPOLL_CTL_ADD;
+    else
+        op = EPOLL_CTL_MOD;
+    /* level-triggered */
+    ev.events = ((mask & EVENT_IN)?EPOLLIN:0) | ((mask & EVENT_OUT)?EPOLLOUT:0);
+    ev.data.fd = fd;
+    if (epoll_ctl(_ee_epfd, op, fd, &ev) == 0 ||
+        /* fd reused without deregistering, or closed and reused */
+        (op == EPOLL_CTL_ADD && errno == EEXIST &&
+         epoll_ctl(_ee_epfd, EPOLL_CTL_MOD, fd, &ev) == 0) ||
+        (op == EPOLL_CTL_MOD && errno == ENOENT &&
+         epoll_ctl(_ee_epfd, EPOLL_CTL_ADD, fd, &ev) == 0)){
+        ef->ef_mask = mask;
+        return 0;
+    }
+    if (op == EPOLL_CTL_DEL || errno == EBADF){
+        /* fd may be closed before deregistered */
+        if (ef->ef_nopoll){
+            ef->ef_nopoll = 0;
+            _ee_nopoll--;
+        }
+        ef->ef_mask = mask;
+        return 0;
+    }
+    if (errno == EPERM){ /* Eg regular file, always ready as with select */
+        if (!ef->ef_nopoll){
+            ef->ef_nopoll = 1;
+            _ee_nopoll++;
+        }
+        ef->ef_mask = mask;
+        return 0;
+    }
+    clicon_err(OE_EVENTS, errno, "epoll_ctl");
+    return -1;
+}
+
+/*! Get epoll instance of this process, create it and add registered fds if needed
+ *
+ * An epoll instance inherited over fork is shared with the parent, the child creates its own
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+event_epoll_init(void)
+{
+    int fd;
+
+    if (_ee_epfd != -1 && _ee_eppid == getpid())
+        return 0;
+    if (_ee_epfd != -1)
+        close(_ee_epfd);
+    _ee_nopoll = 0;
+    if ((_ee_epfd = epoll_create1(EPOLL_CLOEXEC)) < 0){
+        clicon_err(OE_EVENTS, errno, "epoll_create1");
+        return -1;
+    }
+    _ee_eppid = getpid();
+    for (fd=0; fd<ee_fdlen; fd++){
+        ee_fds[fd].ef_nopoll = 0;
+        ee_fds[fd].ef_mask = 0;
+    }
+    for (fd=0; fd<ee_fdlen; fd++)
+        if ((ee_fds[fd].ef_events || ee_fds[fd].ef_wevents) &&
+            event_epoll_ctl(fd, (ee_fds[fd].ef_events?EVENT_IN:0) |
+                            (ee_fds[fd].ef_wevents?EVENT_OUT:0)) < 0)
+            return -1;
+    return 0;
+}
+#endif /* EVENT_POLL_EPOLL */
+
+/*! Poll a file descriptor for the events it has callbacks registered for
+ *
+ * Called when a callback is registered or deregistered. Stop polling fd if it has none.
+ * @param[in]  fd  File descriptor
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+event_poller_set(int fd)
+{
+    struct event_fd *ef = &ee_fds[fd];
+    int              mask;
+
+    mask = (ef->ef_events?EVENT_IN:0) | (ef->ef_wevents?EVENT_OUT:0);
+#ifdef EVENT_POLL_EPOLL
+    if (_ee_epfd == -1 || _ee_eppid != getpid())
+        return mask?event_epoll_init():0; /* Adds all registered fds */
+    return event_epoll_ctl(fd, mask);
+#else
+    if (mask && fd >= FD_SETSIZE){
+        clicon_err(OE_EVENTS, EINVAL, "fd %d larger than FD_SETSIZE %d", fd, FD_SETSIZE);
+        return -1;
+    }
+    if (mask & EVENT_IN)
+        FD_SET(fd, &_ee_fdset);
+    else if (fd < FD_SETSIZE)
+        FD_CLR(fd, &_ee_fdset);
+    if (mask & EVENT_OUT)
+        FD_SET(fd, &_ee_wfdset);
+    else if (fd < FD_SETSIZE)
+        FD_CLR(fd, &_ee_wfdset);
+    ef->ef_mask = mask;
+    if (mask && fd > _ee_fdmax)
+        _ee_fdmax = fd;
+    while (_ee_fdmax >= 0 && ee_fds[_ee_fdmax].ef_mask == 0)
+        _ee_fdmax--;
+    return 0;
+#endif
+}
+
+/*! Wait for registered file descriptors to be ready for reading or writing
+ *
+ * At most EVENT_POLL_MAX ready fds are returned, the others are returned in later calls.
+ * An fd with an error or hangup is returned as ready for both.
+ * @param[in]  t      Relative timeout, NULL to wait indefinitely
+ * @param[out] ready  Vector of ready fds, length EVENT_POLL_MAX
+ * @param[out] rmask  Vector of ready events of fds, EVENT_IN and/or EVENT_OUT
+ * @retval     n      Number of ready fds, 0 on timeout
+ * @retval    -1      Error, errno set, eg EINTR
+ */
+static int
+event_poller_wait(struct timeval *t,
+                  int            *ready,
+                  int            *rmask)
+{
+    int                n;
+    int                i;
+#ifdef EVENT_POLL_EPOLL
+    struct epoll_event evs[EVENT_POLL_MAX];
+    int                ms = -1;
+    int                fd;
+
+    if (event_epoll_init() < 0)
+        return -1;
+    if (_ee_nopoll)
+        ms = 0;
+    else if (t)  /* Round up to not wake up before timeout */
+        ms = t->tv_sec*1000 + (t->tv_usec+999)/1000;
+    if ((n = epoll_wait(_ee_epfd, evs, EVENT_POLL_MAX, ms)) < 0)
+        return -1;
+    for (i=0; i<n; i++){
+        ready[i] = evs[i].data.fd;
+        rmask[i] = 0;
+        if (evs[i].events & (EPOLLIN|EPOLLERR|EPOLLHUP))
+            rmask[i] |= EVENT_IN;
+        if (evs[i].events & (EPOLLOUT|EPOLLERR|EPOLLHUP))
+            rmask[i] |= EVENT_OUT;
+    }
+    /* Fds that cannot be polled are always ready */
+    for (fd=0; _ee_nopoll && fd<ee_fdlen && n<EVENT_POLL_MAX; fd++)
+        if (ee_fds[fd].ef_nopoll){
+            rmask[n] = ee_fds[fd].ef_mask;
+            ready[n++] = fd;
+        }
+#else
+    fd_set             fdset;
+    fd_set             wfdset;
+    int                fd;
+
+    fdset = _ee_fdset;
+    wfdset = _ee_wfdset;
+    if ((n = select(_ee_fdmax+1, &fdset, &wfdset, NULL, t)) <= 0)
+        return n;
+    /* Scan from where the last scan stopped, if more than EVENT_POLL_MAX are ready */
+    if (_ee_fdscan > _ee_fdmax)
+        _ee_fdscan = 0;
+    n = 0;
+    for (i=0; i<=_ee_fdmax && n<EVENT_POLL_MAX; i++){
+        fd = (_ee_fdscan + i) % (_ee_fdmax+1);
+        rmask[n] = (FD_ISSET(fd, &fdset)?EVENT_IN:0) | (FD_ISSET(fd, &wfdset)?EVENT_OUT:0);
+        if (rmask[n])
+            ready[n++] = fd;
+    }
+    _ee_fdscan = (_ee_fdscan + i) % (_ee_fdmax+1);
+#endif
+    return n;
+}
+
+/*! Register a callback function on input or output on a file descriptor
+ *
+ * @param[in]  fd   File descriptor
+ * @param[in]  fn   Function to call when fd is ready
+ * @param[in]  arg  Argument to function fn
+ * @param[in]  str  Describing string for logging
+ * @param[in]  out  Call fn when fd is ready for writing, not reading
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+event_reg_fd(int   fd, 
+             int (*fn)(int, void*), 
+             void *arg, 
+             char *str,
+             int   out)
+{
+    struct event_data  *e;
+    struct event_fd    *vec;
+    struct event_data **ep;
+    int                 len;
+
+    if (fd < 0){
+        clicon_err(OE_EVENTS, EINVAL, "fd %d", fd);
+        return -1;
+    }
+    if (fd >= ee_fdlen){
+        len = ee_fdlen?2*ee_fdlen:64;
+        while (len <= fd)
+            len *= 2;
+        if ((vec = realloc(ee_fds, len*sizeof(struct event_fd))) == NULL){
+            clicon_err(OE_EVENTS, errno, "realloc");
+            return -1;
+        }
+        memset(&vec[ee_fdlen], 0, (len-ee_fdlen)*sizeof(struct event_fd));
+        ee_fds = vec;
+        ee_fdlen = len;
+    }
+    if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
+        clicon_err(OE_EVENTS, errno, "malloc");
+        return -1;
+    }
+    memset(e, 0, sizeof(struct event_data));
+    strncpy(e->e_string, str, EVENT_STRLEN-1);
+    e->e_fd = fd;
+    e->e_fn = fn;
+    e->e_arg = arg;
+    e->e_type = EVENT_FD;
+    ep = out?&ee_fds[fd].ef_wevents:&ee_fds[fd].ef_events;
+    e->e_next = *ep;
+    *ep = e;
+    if (event_poller_set(fd) < 0){
+        *ep = e->e_next;
+        free(e);
+        return -1;
+    }
+    clicon_debug(CLIXON_DBG_DETAIL, "%s, registering %s", __FUNCTION__, e->e_string);
+    return 0;
+}
+
+/*! Deregister a file descriptor callback on input or output
+ *
+ * @param[in]  s    File descriptor
+ * @param[in]  fn   Function registered
+ * @param[in]  out  Callback registered on output
+ * @retval     0    OK
+ * @retval    -1    Not found
+ */
+static int
+event_unreg_fd(int   s, 
+               int (*fn)(int, void*),
+               int   out)
+{
+    struct event_data *e, **e_prev;
+    int found = 0;
+
+    if (s < 0 || s >= ee_fdlen)
+        return -1;
+    e_prev = out?&ee_fds[s].ef_wevents:&ee_fds[s].ef_events;
+    for (e = *e_prev; e; e = e->e_next){
+        if (fn == e->e_fn) {
+            found++;
+            *e_prev = e->e_next;
+            _ee_unreg++;
+            free(e);
+            break;
+        }
+        e_prev = &e->e_next;
+    }
+    if (found && *(out?&ee_fds[s].ef_wevents:&ee_fds[s].ef_events) == NULL)
+        event_poller_set(s);
+    return found?0:-1;
+}
+
 /*! Register a callback function to be called on input on a file descriptor.
  *
  * @param[in]  fd  File descriptor
@@ -173,6 +547,7 @@ clicon_sig_ignore_get(void)
  * clixon_event_reg_fd(fd, fn, (void*)42, "call fn on input on fd");
  * @endcode 
  * @see clixon_event_unreg_fd
+ * @see clixon_event_reg_fd_write
  */
 int
 clixon_event_reg_fd(int   fd, 
@@ -180,28 +555,14 @@ clixon_event_reg_fd(int   fd,
                     void *arg, 
                     char *str)
 {
-    struct event_data *e;
-
-    if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
-        clicon_err(OE_EVENTS, errno, "malloc");
-        return -1;
-    }
-    memset(e, 0, sizeof(struct event_data));
-    strncpy(e->e_string, str, EVENT_STRLEN-1);
-    e->e_fd = fd;
-    e->e_fn = fn;
-    e->e_arg = arg;
-    e->e_type = EVENT_FD;
-    e->e_next = ee;
-    ee = e;
-    clicon_debug(CLIXON_DBG_DETAIL, "%s, registering %s", __FUNCTION__, e->e_string);
-    return 0;
+    return event_reg_fd(fd, fn, arg, str, 0);
 }
 
 /*! Deregister a file descriptor callback
  * @param[in]  s   File descriptor
  * @param[in]  fn  Function to call when input available on fd
  * Note: deregister when exactly function and socket match, not argument
+ * The fd is found by index, only callbacks registered on the same fd are searched
  * @see clixon_event_reg_fd
  * @see clixon_event_unreg_timeout
  */
@@ -209,21 +570,164 @@ int
 clixon_event_unreg_fd(int   s, 
                       int (*fn)(int, void*))
 {
-    struct event_data *e, **e_prev;
-    int found = 0;
+    return event_unreg_fd(s, fn, 0);
+}
 
-    e_prev = &ee;
-    for (e = ee; e; e = e->e_next){
-        if (fn == e->e_fn && s == e->e_fd) {
-            found++;
+/*! Register a callback function to be called when a file descriptor is ready for writing
+ *
+ * Polling is level-triggered: deregister the callback when there is nothing more to write.
+ * In an event loop iteration, callbacks on input of a fd are called before callbacks on
+ * output.
+ * @param[in]  fd  File descriptor
+ * @param[in]  fn  Function to call when fd is ready for writing
+ * @param[in]  arg Argument to function fn
+ * @param[in]  str Describing string for logging
+ * @see clixon_event_unreg_fd_write
+ */
+int
+clixon_event_reg_fd_write(int   fd, 
+                          int (*fn)(int, void*), 
+                          void *arg, 
+                          char *str)
+{
+    return event_reg_fd(fd, fn, arg, str, 1);
+}
+
+/*! Deregister a file descriptor callback on output
+ *
+ * @param[in]  s   File descriptor
+ * @param[in]  fn  Function registered with clixon_event_reg_fd_write
+ * @see clixon_event_reg_fd_write
+ */
+int
+clixon_event_unreg_fd_write(int   s, 
+                            int (*fn)(int, void*))
+{
+    return event_unreg_fd(s, fn, 1);
+}
+
+/*! Check if timeout e0 is before e1, equal timeouts in registration order
+ */
+static int
+timeout_before(struct event_data *e0,
+               struct event_data *e1)
+{
+    if (timercmp(&e0->e_time, &e1->e_time, <))
+        return 1;
+    if (timercmp(&e0->e_time, &e1->e_time, >))
+        return 0;
+    return e0->e_seq < e1->e_seq;
+}
+
+/*! Set timeout at heap index i
+ */
+static void
+timeout_heap_set(int                i,
+                 struct event_data *e)
+{
+    ee_heap[i] = e;
+    e->e_heapi = i;
+}
+
+/*! Move timeout at heap index i up or down until heap is ordered
+ */
+static void
+timeout_heap_fix(int i)
+{
+    struct event_data *e = ee_heap[i];
+    int                p;
+    int                c;
+
+    while (i > 0 && timeout_before(e, ee_heap[p = (i-1)/2])){
+        timeout_heap_set(i, ee_heap[p]);
+        i = p;
+    }
+    while ((c = 2*i+1) < ee_heapnr){
+        if (c+1 < ee_heapnr && timeout_before(ee_heap[c+1], ee_heap[c]))
+            c++;
+        if (!timeout_before(ee_heap[c], e))
+            break;
+        timeout_heap_set(i, ee_heap[c]);
+        i = c;
+    }
+    timeout_heap_set(i, e);
+}
+
+/*! Hash bucket of timeouts with fn and arg
+ */
+static struct event_data **
+timeout_bucket(int (*fn)(int, void*),
+               void *arg)
+{
+    uintptr_t k;
+
+    k = (uintptr_t)fn ^ ((uintptr_t)arg * 0x9e3779b1U);
+    k ^= k >> 16;
+    return &ee_thash[k & (ee_thashlen-1)];
+}
+
+/*! Grow timeout heap and hash if full
+ *
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+timeout_grow(void)
+{
+    struct event_data **vec;
+    struct event_data **hash;
+    struct event_data **eb;
+    struct event_data  *e;
+    int                 len;
+    int                 i;
+
+    if (ee_heapnr < ee_heaplen)
+        return 0;
+    len = ee_heaplen?2*ee_heaplen:64;
+    if ((hash = calloc(len, sizeof(struct event_data *))) == NULL){
+        clicon_err(OE_EVENTS, errno, "calloc");
+        return -1;
+    }
+    if ((vec = realloc(ee_heap, len*sizeof(struct event_data *))) == NULL){
+        clicon_err(OE_EVENTS, errno, "realloc");
+        free(hash);
+        return -1;
+    }
+    ee_heap = vec;
+    ee_heaplen = len;
+    /* Rehash all timeouts, all are in the heap */
+    if (ee_thash)
+        free(ee_thash);
+    ee_thash = hash;
+    ee_thashlen = len;
+    for (i=0; i<ee_heapnr; i++){
+        e = ee_heap[i];
+        eb = timeout_bucket(e->e_fn, e->e_arg);
+        e->e_next = *eb;
+        *eb = e;
+    }
+    return 0;
+}
+
+/*! Remove timeout from heap and hash, do not free it
+ */
+static void
+timeout_rm(struct event_data *e)
+{
+    struct event_data **e_prev;
+    struct event_data  *e1;
+    int                 i;
+
+    for (e_prev = timeout_bucket(e->e_fn, e->e_arg); (e1 = *e_prev) != NULL; e_prev = &e1->e_next)
+        if (e1 == e){
             *e_prev = e->e_next;
-            _ee_unreg++;
-            free(e);
             break;
         }
-        e_prev = &e->e_next;
+    i = e->e_heapi;
+    if (--ee_heapnr > i){
+        timeout_heap_set(i, ee_heap[ee_heapnr]);
+        timeout_heap_fix(i);
     }
-    return found?0:-1;
 }
 
 /*! Call a callback function at an absolute time
@@ -245,6 +749,7 @@ clixon_event_unreg_fd(int   s,
  * @note  The timestamp is an absolute timestamp, not relative.
  * @note  The callback is not periodic, you need to make a new registration for each period, see example.
  * @note  The first argument to fn is a dummy, just to get the same signature as for file-descriptor callbacks.
+ * @note  Timeouts are kept in a heap, registering is O(log n)
  * @see clixon_event_reg_fd
  * @see clixon_event_unreg_timeout
  */
@@ -256,8 +761,7 @@ clixon_event_reg_timeout(struct timeval t,
 {
     int                 retval = -1;
     struct event_data  *e;
-    struct event_data  *e1;
-    struct event_data **e_prev;
+    struct event_data **eb;
 
     if (str == NULL || fn == NULL){
         clicon_err(OE_CFG, EINVAL, "str or fn is NULL");
@@ -273,15 +777,16 @@ clixon_event_reg_timeout(struct timeval t,
     e->e_arg = arg;
     e->e_type = EVENT_TIME;
     e->e_time = t;
-    /* Sort into right place */
-    e_prev = &ee_timers;
-    for (e1=ee_timers; e1; e1=e1->e_next){
-        if (timercmp(&e->e_time, &e1->e_time, <))
-            break;
-        e_prev = &e1->e_next;
+    e->e_seq = ee_tseq++;
+    if (timeout_grow() < 0){
+        free(e);
+        goto done;
     }
-    e->e_next = e1;
-    *e_prev = e;
+    eb = timeout_bucket(fn, arg);
+    e->e_next = *eb;
+    *eb = e;
+    timeout_heap_set(ee_heapnr++, e);
+    timeout_heap_fix(e->e_heapi);
     clicon_debug(CLIXON_DBG_DETAIL, "%s: %s", __FUNCTION__, str); 
     retval = 0;
  done:
@@ -292,6 +797,7 @@ clixon_event_reg_timeout(struct timeval t,
  * Note: deregister when exactly function and function arguments match, not time. So you
  * cannot have same function and argument callback on different timeouts. This is a little
  * different from clixon_event_unreg_fd.
+ * The timeout is found by hash on fn and arg, and removed from the heap in O(log n)
  * @param[in]  fn   Function to call at time t
  * @param[in]  arg  Argument to function fn
  * @retval     0    OK, timeout unregistered
@@ -303,20 +809,21 @@ int
 clixon_event_unreg_timeout(int (*fn)(int, void*), 
                            void *arg)
 {
-    struct event_data *e, **e_prev;
-    int found = 0;
+    struct event_data *e;
+    struct event_data *e1 = NULL;
 
-    e_prev = &ee_timers;
-    for (e = ee_timers; e; e = e->e_next){
-        if (fn == e->e_fn && arg == e->e_arg) {
-            found++;
-            *e_prev = e->e_next;
-            free(e);
-            break;
-        }
-        e_prev = &e->e_next;
-    }
-    return found?0:-1;
+    if (ee_heapnr == 0)
+        return -1;
+    /* If several, the first to expire */
+    for (e = *timeout_bucket(fn, arg); e; e = e->e_next)
+        if (fn == e->e_fn && arg == e->e_arg &&
+            (e1 == NULL || timeout_before(e, e1)))
+            e1 = e;
+    if (e1 == NULL)
+        return -1;
+    timeout_rm(e1);
+    free(e1);
+    return 0;
 }
 
 /*! Poll to see if there is any data available on this file descriptor.
@@ -328,25 +835,295 @@ clixon_event_unreg_timeout(int (*fn)(int, void*),
 int 
 clixon_event_poll(int fd)
 {
-    int            retval = -1;
-    fd_set         fdset;
-    struct timeval tnull = {0,};
+    int           retval = -1;
+    struct pollfd pfd = {0,};
 
-    FD_ZERO(&fdset);
-    FD_SET(fd, &fdset);
-    if ((retval = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull)) < 0)
-        clicon_err(OE_EVENTS, errno, "select");
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    if ((retval = poll(&pfd, 1, 0)) < 0)
+        clicon_err(OE_EVENTS, errno, "poll");
     return retval;
 }
 
+/*! Get the time when the fds of the current event loop iteration were found ready
+ *
+ * A callback may use this to compute how long its fd waited for earlier callbacks of the
+ * same iteration, eg the queue wait of a request.
+ * @param[out] t  Monotonic time of last poller wakeup, zero if none
+ */
+void
+clixon_event_wakeup(struct timespec *t)
+{
+    *t = _ee_wakeup;
+}
+
+/*! Call callbacks of expired timeouts
+ *
+ * Only timeouts expired when called are handled, not timeouts registered by the callbacks,
+ * so that a callback registering a new timeout at the current time does not starve fds.
+ * @retval    0  OK
+ * @retval   -1  Error in callback
+ */
+static int
+clixon_event_timeouts(void)
+{
+    struct event_data *e;
+    struct timeval     t0;
+    uint64_t           seq = ee_tseq;
+
+    if (ee_heapnr == 0)
+        return 0;
+    gettimeofday(&t0, NULL);
+    while (ee_heapnr > 0 &&
+           (e = ee_heap[0])->e_seq < seq &&
+           !timercmp(&e->e_time, &t0, >)){
+        if (clixon_exit_get() == 1)
+            break;
+        timeout_rm(e);
+        clicon_debug(CLIXON_DBG_DETAIL, "%s timeout: %s", __FUNCTION__, e->e_string);
+        if ((*e->e_fn)(0, e->e_arg) < 0){
+            free(e);
+            return -1;
+        }
+        free(e);
+    }
+    return 0;
+}
+
+/*! Register a callback that may be called at safe points of a preemptible section
+ *
+ * When an fd registered with fn is ready, or a timeout registered with fn expires, at a
+ * safe point, yfn is called with the same arguments instead. yfn may be fn itself, or
+ * a variant that only handles what cannot interfere with the preempted callback, and
+ * leaves the rest to the event loop. Fds ready for output and other callbacks are
+ * handled by the event loop after the preempted callback.
+ * @param[in]  fn   Callback registered with clixon_event_reg_fd or clixon_event_reg_timeout
+ * @param[in]  yfn  Function to call at safe points
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon_event_yield
+ */
+int
+clixon_event_yield_reg(int (*fn)(int, void*),
+                       int (*yfn)(int, void*))
+{
+    if (_ee_yieldnr >= EVENT_YIELD_MAX){
+        clicon_err(OE_EVENTS, ENOSPC, "Max %d yield callbacks", EVENT_YIELD_MAX);
+        return -1;
+    }
+    _ee_yield[_ee_yieldnr].ey_fn = fn;
+    _ee_yield[_ee_yieldnr].ey_yfn = yfn;
+    _ee_yieldnr++;
+    return 0;
+}
+
+/*! Set the interval between polls at safe points of preemptible sections
+ *
+ * @param[in]  us  Interval in microseconds, 0 means that sections are not preempted
+ */
+void
+clixon_event_yield_interval(uint64_t us)
+{
+    _ee_yield_interval = us;
+}
+
+/*! Microseconds from t0 to t
+ */
+static uint64_t
+event_yield_us(struct timespec *t0,
+               struct timespec *t)
+{
+    return (t->tv_sec - t0->tv_sec)*1000000 + (t->tv_nsec - t0->tv_nsec)/1000;
+}
+
+/*! Start a preemptible section, eg a long RPC, in the calling process and thread
+ *
+ * Sections do not nest, a section started in a section is part of it.
+ * @retval     1    Section started, end it with clixon_event_yield_end
+ * @retval     0    Already in a section, or no interval set
+ */
+int
+clixon_event_yield_begin(void)
+{
+    if (_ee_yield_interval == 0 || _ee_yield_section)
+        return 0;
+    _ee_yield_section = 1;
+    _ee_yield_skip = 0;
+    _ee_yield_pid = getpid();
+    _ee_yield_thread = pthread_self();
+    clock_gettime(CLOCK_MONOTONIC, &_ee_yield_last);
+    _ee_yield_sections++;
+    return 1;
+}
+
+/*! End a preemptible section started with clixon_event_yield_begin
+ */
+void
+clixon_event_yield_end(void)
+{
+    struct timespec t;
+    uint64_t        us;
+
+    if (!_ee_yield_section)
+        return;
+    _ee_yield_section = 0;
+    if (getpid() != _ee_yield_pid) /* Forked in section */
+        return;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    if ((us = event_yield_us(&_ee_yield_last, &t)) > _ee_yield_maxgap)
+        _ee_yield_maxgap = us;
+}
+
+/*! Find the function to call at safe points for a callback
+ */
+static int (*event_yield_fn(int (*fn)(int, void*)))(int, void*)
+{
+    int i;
+
+    for (i=0; i<_ee_yieldnr; i++)
+        if (_ee_yield[i].ey_fn == fn)
+            return _ee_yield[i].ey_yfn;
+    return NULL;
+}
+
+/*! Call yield callbacks of expired timeouts
+ *
+ * Other expired timeouts are left to the event loop
+ * @retval    0  OK
+ * @retval   -1  Error in callback
+ */
+static int
+event_yield_timeouts(void)
+{
+    struct event_data *e;
+    struct timeval     t0;
+    uint64_t           seq = ee_tseq;
+    int              (*yfn)(int, void*);
+    int                i;
+    int                ret;
+
+    gettimeofday(&t0, NULL);
+    for (i=0; i<ee_heapnr; i++){
+        e = ee_heap[i];
+        if (e->e_seq >= seq ||
+            timercmp(&e->e_time, &t0, >) ||
+            (yfn = event_yield_fn(e->e_fn)) == NULL)
+            continue;
+        timeout_rm(e);
+        clicon_debug(CLIXON_DBG_DETAIL, "%s timeout: %s", __FUNCTION__, e->e_string);
+        ret = (*yfn)(0, e->e_arg);
+        free(e);
+        if (ret < 0)
+            return -1;
+        i = -1; /* The heap is reordered, start over */
+    }
+    return 0;
+}
+
+/*! Safe point of a preemptible section: call yield callbacks of ready fds and timeouts
+ *
+ * Call this where a long operation may be interrupted, eg between subtrees of a large
+ * tree. Nothing is made outside a section, in other processes or threads than the one
+ * starting the section, or if the interval since the last poll has not passed. The clock
+ * is only read every EVENT_YIELD_SKIP safe points.
+ * Only the callbacks registered with clixon_event_yield_reg are called, other ready fds
+ * are polled again by the event loop after the section.
+ * @retval    0  OK
+ * @retval   -1  Error in callback or poller
+ * @see clixon_event_yield_begin
+ */
+int
+clixon_event_yield(void)
+{
+    int                retval = -1;
+    struct timespec    t;
+    struct timespec    t1;
+    struct timeval     tnull = {0,};
+    uint64_t           us;
+    int                ready[EVENT_POLL_MAX];
+    int                rmask[EVENT_POLL_MAX];
+    int                n;
+    int                i;
+    struct event_data *e;
+    struct event_data *e_next;
+    int              (*yfn)(int, void*);
+
+    if (!_ee_yield_section || _ee_yield_busy ||
+        !pthread_equal(_ee_yield_thread, pthread_self()))
+        return 0;
+    if (_ee_yield_skip-- > 0)
+        return 0;
+    _ee_yield_skip = EVENT_YIELD_SKIP;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    if ((us = event_yield_us(&_ee_yield_last, &t)) < _ee_yield_interval ||
+        getpid() != _ee_yield_pid)
+        return 0;
+    if (us > _ee_yield_maxgap)
+        _ee_yield_maxgap = us;
+    _ee_yields++;
+    _ee_yield_busy = 1;
+    if (event_yield_timeouts() < 0)
+        goto done;
+    if ((n = event_poller_wait(&tnull, ready, rmask)) < 0){
+        if (errno != EINTR){
+            clicon_err(OE_EVENTS, errno, "%s", EVENT_POLL_NAME);
+            goto done;
+        }
+        n = 0; /* Signals are handled by the event loop */
+    }
+    for (i=0; i<n && !_ee_unreg; i++){
+        if ((rmask[i] & EVENT_IN) == 0 || ready[i] >= ee_fdlen)
+            continue;
+        for (e=ee_fds[ready[i]].ef_events; e; e=e_next){
+            e_next = e->e_next;
+            if ((yfn = event_yield_fn(e->e_fn)) == NULL)
+                continue;
+            clicon_debug(CLIXON_DBG_DETAIL, "%s: ready: %s", __FUNCTION__, e->e_string);
+            if ((*yfn)(e->e_fd, e->e_arg) < 0)
+                goto done;
+            if (_ee_unreg) /* Also stops the dispatch of the event loop */
+                break;
+        }
+    }
+    retval = 0;
+ done:
+    _ee_yield_busy = 0;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    _ee_yield_time += event_yield_us(&t, &t1);
+    _ee_yield_last = t1;
+    return retval;
+}
+
+/*! Get scheduler statistics of preemptible sections since start
+ *
+ * @param[out] sectionsp  Number of sections
+ * @param[out] yieldsp    Number of safe points where other fds were polled
+ * @param[out] timep      Microseconds in yield callbacks
+ * @param[out] maxgapp    Longest microseconds in a section without polling
+ */
+void
+clixon_event_yield_stats(uint64_t *sectionsp,
+                         uint64_t *yieldsp,
+                         uint64_t *timep,
+                         uint64_t *maxgapp)
+{
+    *sectionsp = _ee_yield_sections;
+    *yieldsp = _ee_yields;
+    *timep = _ee_yield_time;
+    *maxgapp = _ee_yield_maxgap;
+}
+
 /*! Dispatch file descriptor events (and timeouts) by invoking callbacks.
  *
+ * File descriptors are polled with epoll if available, otherwise with select, see EVENT_EPOLL.
+ * In each iteration, expired timeouts are handled first, then at most EVENT_POLL_MAX ready
+ * file descriptors. Polling is level-triggered: a fd that is not emptied by its callback is
+ * ready again in next iteration, but does not starve timeouts or other fds.
+ * A fd ready for both reading and writing has its input callbacks called before its output
+ * callbacks, see clixon_event_reg_fd_write.
  * @param[in] h  Clixon handle
  * @retval    0  OK
  * @retval   -1  Error: eg select, callback, timer, 
- * @note There is an issue with fairness between timeouts and events
- *       Currently a socket that is not read/emptied properly starve timeouts.
- *       One could try to poll the file descriptors after a timeout?
  */
 int
 clixon_event_loop(clicon_handle h)
@@ -354,33 +1131,33 @@ clixon_event_loop(clicon_handle h)
     struct event_data *e;
     struct event_data *e_next;
     int                n;
+    int                i;
+    int                fd;
     struct timeval     t;
     struct timeval     t0;
+    struct timeval    *tp;
     struct timeval     tnull = {0,};
-    fd_set             fdset;
+    int                ready[EVENT_POLL_MAX];
+    int                rmask[EVENT_POLL_MAX];
+    int                out;
     int                retval = -1;
 
     while (clixon_exit_get() != 1){
-        FD_ZERO(&fdset);
         if (clicon_sig_child_get()){
             /* Go through processes and wait for child processes */
             if (clixon_process_waitpid(h) < 0)
                 goto err;
             clicon_sig_child_set(0);
         }
-        for (e=ee; e; e=e->e_next)
-            if (e->e_type == EVENT_FD)
-                FD_SET(e->e_fd, &fdset);
-        if (ee_timers != NULL){
+        tp = NULL;
+        if (ee_heapnr > 0){
             gettimeofday(&t0, NULL);
-            timersub(&ee_timers->e_time, &t0, &t); 
+            timersub(&ee_heap[0]->e_time, &t0, &t); 
             if (t.tv_sec < 0)
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull); 
-            else
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &t); 
+                t = tnull;
+            tp = &t;
         }
-        else
-            n = select(FD_SETSIZE, &fdset, NULL, NULL, NULL);
+        n = event_poller_wait(tp, ready, rmask);
         if (clixon_exit_get() == 1){
             break;
         }
@@ -396,9 +1173,9 @@ clixon_event_loop(clicon_handle h)
                  *     New select loop is called
                  * (3) Other signals result in an error and return -1.
                  */
-                clicon_debug(1, "%s select: %s", __FUNCTION__, strerror(errno));
+                clicon_debug(1, "%s %s: %s", __FUNCTION__, EVENT_POLL_NAME, strerror(errno));
                 if (clixon_exit_get() == 1){
-                    clicon_err(OE_EVENTS, errno, "select");
+                    clicon_err(OE_EVENTS, errno, "%s", EVENT_POLL_NAME);
                     retval = 0;
                 }
                 else if (clicon_sig_child_get()){
@@ -413,37 +1190,40 @@ clixon_event_loop(clicon_handle h)
                     continue;
                 }
                 else
-                    clicon_err(OE_EVENTS, errno, "select");
+                    clicon_err(OE_EVENTS, errno, "%s", EVENT_POLL_NAME);
             }
             else
-                clicon_err(OE_EVENTS, errno, "select");
+                clicon_err(OE_EVENTS, errno, "%s", EVENT_POLL_NAME);
             goto err;
         }
-        if (n==0){ /* Timeout */
-            e = ee_timers;
-            ee_timers = ee_timers->e_next;
-            clicon_debug(CLIXON_DBG_DETAIL, "%s timeout: %s", __FUNCTION__, e->e_string);
-            if ((*e->e_fn)(0, e->e_arg) < 0){
-                free(e);
-                goto err;
-            }
-            free(e);
-        }
+        if (n > 0)
+            clock_gettime(CLOCK_MONOTONIC, &_ee_wakeup);
         _ee_unreg = 0;
-        for (e=ee; e; e=e_next){
-            if (clixon_exit_get() == 1){
-                break;
-            }
-            e_next = e->e_next;
-            if(e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset)){
-                clicon_debug(CLIXON_DBG_DETAIL, "%s: FD_ISSET: %s", __FUNCTION__, e->e_string);
-                if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
-                    clicon_debug(1, "%s Error in: %s", __FUNCTION__, e->e_string);
-                    goto err;
-                }
-                if (_ee_unreg){
-                    _ee_unreg = 0;
-                    break;
+        if (clixon_event_timeouts() < 0)
+            goto err;
+        /* A callback deregistered by a timeout may have been ready, its fd reused */
+        if (_ee_unreg)
+            n = 0;
+        for (i=0; i<n && !_ee_unreg; i++){
+            fd = ready[i];
+            if (fd >= ee_fdlen)
+                continue;
+            /* Input callbacks first, then output callbacks */
+            for (out=0; out<2 && !_ee_unreg; out++){
+                if ((rmask[i] & (out?EVENT_OUT:EVENT_IN)) == 0)
+                    continue;
+                for (e=out?ee_fds[fd].ef_wevents:ee_fds[fd].ef_events; e; e=e_next){
+                    if (clixon_exit_get() == 1){
+                        break;
+                    }
+                    e_next = e->e_next;
+                    clicon_debug(CLIXON_DBG_DETAIL, "%s: ready: %s", __FUNCTION__, e->e_string);
+                    if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
+                        clicon_debug(1, "%s Error in: %s", __FUNCTION__, e->e_string);
+                        goto err;
+                    }
+                    if (_ee_unreg)
+                        break;
                 }
             }
         }
@@ -463,18 +1243,44 @@ int
 clixon_event_exit(void)
 {
     struct event_data *e, *e_next;
-    
-    e_next = ee;
-    while ((e = e_next) != NULL){
-        e_next = e->e_next;
-        free(e);
-    }
-    ee = NULL;
-    e_next = ee_timers;
-    while ((e = e_next) != NULL){
-        e_next = e->e_next;
-        free(e);
+    int                fd;
+
+    for (fd=0; fd<ee_fdlen; fd++){
+        e_next = ee_fds[fd].ef_events;
+        while ((e = e_next) != NULL){
+            e_next = e->e_next;
+            free(e);
+        }
+        e_next = ee_fds[fd].ef_wevents;
+        while ((e = e_next) != NULL){
+            e_next = e->e_next;
+            free(e);
+        }
     }
-    ee_timers = NULL;
+    if (ee_fds)
+        free(ee_fds);
+    ee_fds = NULL;
+    ee_fdlen = 0;
+#ifdef EVENT_POLL_EPOLL
+    if (_ee_epfd != -1 && _ee_eppid == getpid())
+        close(_ee_epfd);
+    _ee_epfd = -1;
+    _ee_nopoll = 0;
+#else
+    FD_ZERO(&_ee_fdset);
+    FD_ZERO(&_ee_wfdset);
+    _ee_fdmax = -1;
+    _ee_fdscan = 0;
+#endif
+    while (ee_heapnr > 0)
+        free(ee_heap[--ee_heapnr]);
+    if (ee_heap)
+        free(ee_heap);
+    ee_heap = NULL;
+    ee_heaplen = 0;
+    if (ee_thash)
+        free(ee_thash);
+    ee_thash = NULL;
+    ee_thashlen = 0;
     return 0;
 }
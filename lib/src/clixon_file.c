@@ -38,6 +38,10 @@
 #include "clixon_config.h"
 #endif
 
+#ifdef HAVE_COPY_FILE_RANGE
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -51,6 +55,10 @@
 #include <unistd.h>
 #include <netinet/in.h>
 #include <stddef.h>
+#ifdef HAVE_LINUX_FS_H
+#include <sys/ioctl.h>
+#include <linux/fs.h>  /* FICLONE */
+#endif
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -263,6 +271,9 @@ quit:
 
 /*! Make a copy of file src. Overwrite existing
  *
+ * The copy is made by the file system if possible, without reading the file into user
+ * space: first as a reflink (FICLONE) that shares the data blocks until modified, eg on
+ * btrfs and xfs, then with copy_file_range(2), and last with read and write.
  * @param[in]  src     Source filename
  * @param[out] target  Destination filename
  * @retval     0       OK
@@ -275,9 +286,13 @@ clicon_file_copy(char *src,
     int         retval = -1;
     int         inF = 0, ouF = 0;
     int         err = 0;
-    char        line[512];
+    char        line[16384];
     int         bytes;
     struct stat st;
+#ifdef HAVE_COPY_FILE_RANGE
+    ssize_t     n = 0;
+    off_t       copied = 0;
+#endif
 
     if (stat(src, &st) != 0){
         clicon_err(OE_UNIX, errno, "stat");
@@ -292,12 +307,36 @@ clicon_file_copy(char *src,
         err = errno;
         goto error;
     }
+#if defined(HAVE_LINUX_FS_H) && defined(FICLONE)
+    if (ioctl(ouF, FICLONE, inF) == 0)
+        goto ok;
+#endif
+#ifdef HAVE_COPY_FILE_RANGE
+    while (copied < st.st_size &&
+           (n = copy_file_range(inF, NULL, ouF, NULL, st.st_size - copied, 0)) > 0)
+        copied += n;
+    /* Not supported fails at first call, then or if the file has grown copy the rest
+     * below from the file offsets */
+    if (n < 0 && copied > 0){
+        clicon_err(OE_UNIX, errno, "copy_file_range(%s)", src);
+        err = errno;
+        goto error;
+    }
+#endif
     while((bytes = read(inF, line, sizeof(line))) > 0)
         if (write(ouF, line, bytes) < 0){
             clicon_err(OE_UNIX, errno, "write(%s)", src);
             err = errno;
             goto error;
         }
+    if (bytes < 0){
+        clicon_err(OE_UNIX, errno, "read(%s)", src);
+        err = errno;
+        goto error;
+    }
+#if defined(HAVE_LINUX_FS_H) && defined(FICLONE)
+ ok:
+#endif
     retval = 0;
   error:
     close(inF);
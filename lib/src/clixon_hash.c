@@ -41,6 +41,13 @@
  * are always strings while values can be some arbitrary data referenced
  * by void*.
  *
+ * The table uses open addressing with linear probing in a power of two sized slot
+ * array, which is doubled when it becomes more than 3/4 full. Deletion shifts
+ * following entries back, so there are no tombstones.
+ * Keys are hashed with SipHash-1-3. The 64-bit hash of each entry is stored in
+ * its slot, so that probing and resizing do not need to compare or rehash keys.
+ * Entries are allocated separately and do not move when the table is resized.
+ *
  * XXX: functions such as hash_keys(), hash_value() etc are currently returning
  * pointers to the actual data storage. Should probably make copies.
  *
@@ -94,23 +101,144 @@
 #include <cligen/cligen.h>
 
 /* clixon */
-#include "clixon_queue.h"
 #include "clixon_err.h"
 #include "clixon_hash.h"
 
-#define HASH_SIZE       1031    /* Number of hash buckets. Should be a prime */ 
+#define HASH_SIZE_INIT  16      /* Initial number of slots. Must be a power of two */
+#define HASH_FULL(n)    ((n)/4*3) /* Max number of entries in n slots before resize */
 #define align4(s) (((s)/4)*4 + 4)
 
-/*! A very simplistic algorithm to calculate a hash bucket index
+/* SipHash key. Fixed so that the order of keys is the same in all processes */
+#define HASH_K0  0x0706050403020100ULL
+#define HASH_K1  0x0f0e0d0c0b0a0908ULL
+
+#define ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+#define SIPROUND(v0, v1, v2, v3)                        \
+    do {                                                \
+        v0 += v1; v1 = ROTL(v1, 13); v1 ^= v0; v0 = ROTL(v0, 32); \
+        v2 += v3; v3 = ROTL(v3, 16); v3 ^= v2;          \
+        v0 += v3; v3 = ROTL(v3, 21); v3 ^= v0;          \
+        v2 += v1; v1 = ROTL(v1, 17); v1 ^= v2; v2 = ROTL(v2, 32); \
+    } while (0)
+
+/*! Hash table slot, empty if hs_entry is NULL
+ */
+struct hash_slot {
+    uint64_t      hs_hash;   /* Hash of key of entry */
+    clicon_hash_t hs_entry;  /* Entry */
+};
+
+/*! Hash table
+ *
+ * The API uses clicon_hash_t * as handle, which is a cast of this struct
  */
-static uint32_t
-hash_bucket(const char *str)
+struct hash_table {
+    struct hash_slot *ht_slots; /* Slot vector */
+    size_t            ht_size;  /* Number of slots, a power of two */
+    size_t            ht_count; /* Number of entries */
+};
+#define HT(hash) ((struct hash_table *)(hash))
+
+/*! SipHash-1-3 of a string
+ *
+ * @param[in]  str  String
+ * @param[in]  len  Length of string
+ * @retval     h    64-bit hash
+ * @see https://www.aumasson.jp/siphash/siphash.pdf
+ */
+static uint64_t
+hash_siphash(const char *str,
+             size_t      len)
 {
-    uint32_t n = 0;
+    const uint8_t *p = (const uint8_t *)str;
+    const uint8_t *end = p + (len & ~(size_t)7);
+    uint64_t       v0 = 0x736f6d6570736575ULL ^ HASH_K0;
+    uint64_t       v1 = 0x646f72616e646f6dULL ^ HASH_K1;
+    uint64_t       v2 = 0x6c7967656e657261ULL ^ HASH_K0;
+    uint64_t       v3 = 0x7465646279746573ULL ^ HASH_K1;
+    uint64_t       m;
+    uint64_t       b = ((uint64_t)len) << 56;
+    int            i;
+
+    for (; p != end; p += 8){
+        m = 0;
+        for (i=7; i>=0; i--) /* little-endian regardless of host */
+            m = (m << 8) | p[i];
+        v3 ^= m;
+        SIPROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    for (i=(len & 7)-1; i>=0; i--)
+        b |= ((uint64_t)p[i]) << (8*i);
+    v3 ^= b;
+    SIPROUND(v0, v1, v2, v3);
+    v0 ^= b;
+    v2 ^= 0xff;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
 
-    while(*str)
-        n += (uint32_t)*str++;
-    return n % HASH_SIZE;
+/*! Find slot of key, or the empty slot where it should be added
+ *
+ * @param[in]  ht    Hash table
+ * @param[in]  key   Variable name
+ * @param[in]  hv    Hash of key
+ * @retval     i     Slot index, check hs_entry if found
+ */
+static size_t
+hash_slot_find(struct hash_table *ht,
+               const char        *key,
+               uint64_t           hv)
+{
+    size_t            mask = ht->ht_size - 1;
+    size_t            i;
+    struct hash_slot *hs;
+
+    for (i = hv & mask; ; i = (i+1) & mask){
+        hs = &ht->ht_slots[i];
+        if (hs->hs_entry == NULL)
+            break;
+        if (hs->hs_hash == hv && strcmp(hs->hs_entry->h_key, key) == 0)
+            break;
+    }
+    return i;
+}
+
+/*! Resize hash table and insert all entries in new slot vector
+ *
+ * @param[in]  ht    Hash table
+ * @param[in]  size  New number of slots, a power of two larger than number of entries
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+hash_resize(struct hash_table *ht,
+            size_t             size)
+{
+    struct hash_slot *slots;
+    struct hash_slot *hs;
+    size_t            mask = size - 1;
+    size_t            i;
+    size_t            j;
+
+    if ((slots = calloc(size, sizeof(*slots))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return -1;
+    }
+    for (i = 0; i < ht->ht_size; i++) {
+        hs = &ht->ht_slots[i];
+        if (hs->hs_entry == NULL)
+            continue;
+        for (j = hs->hs_hash & mask; slots[j].hs_entry != NULL; j = (j+1) & mask)
+            ;
+        slots[j] = *hs;
+    }
+    free(ht->ht_slots);
+    ht->ht_slots = slots;
+    ht->ht_size = size;
+    return 0;
 }
 
 /*! Initialize hash table.
@@ -122,14 +250,20 @@ hash_bucket(const char *str)
 clicon_hash_t *
 clicon_hash_init(void)
 {
-  clicon_hash_t *hash;
-
-  if ((hash = (clicon_hash_t *)malloc(sizeof(clicon_hash_t) * HASH_SIZE)) == NULL){
-      clicon_err(OE_UNIX, errno, "malloc");
-      return NULL;
-  }
-  memset(hash, 0, sizeof(clicon_hash_t)*HASH_SIZE);
-  return hash;
+    struct hash_table *ht;
+
+    if ((ht = malloc(sizeof(*ht))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(ht, 0, sizeof(*ht));
+    if ((ht->ht_slots = calloc(HASH_SIZE_INIT, sizeof(*ht->ht_slots))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        free(ht);
+        return NULL;
+    }
+    ht->ht_size = HASH_SIZE_INIT;
+    return (clicon_hash_t *)ht;
 }
 
 /*! Free hash table.
@@ -141,18 +275,20 @@ clicon_hash_init(void)
 int
 clicon_hash_free(clicon_hash_t *hash)
 {
-    int i;
-    clicon_hash_t tmp;
-    for (i = 0; i < HASH_SIZE; i++) {
-        while (hash[i]) {
-            tmp = hash[i];
-            DELQ(tmp, hash[i], clicon_hash_t);
-            free(tmp->h_key);
-            free(tmp->h_val);
-            free(tmp);
-        }
+    struct hash_table *ht = HT(hash);
+    clicon_hash_t      h;
+    size_t             i;
+
+    for (i = 0; i < ht->ht_size; i++) {
+        if ((h = ht->ht_slots[i].hs_entry) == NULL)
+            continue;
+        free(h->h_key);
+        if (h->h_val)
+            free(h->h_val);
+        free(h);
     }
-    free(hash);
+    free(ht->ht_slots);
+    free(ht);
     return 0;
 }
 
@@ -167,19 +303,11 @@ clicon_hash_t
 clicon_hash_lookup(clicon_hash_t *hash, 
                    const char    *key)
 {
-    uint32_t      bkt;
-    clicon_hash_t h;
+    struct hash_table *ht = HT(hash);
+    size_t             i;
 
-    bkt = hash_bucket(key);
-    h = hash[bkt];
-    if (h) {
-        do {
-            if (!strcmp(h->h_key, key))
-                return h;
-            h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
-    }
-    return NULL;
+    i = hash_slot_find(ht, key, hash_siphash(key, strlen(key)));
+    return ht->ht_slots[i].hs_entry;
 }
 
 /*! Get value of hash
@@ -225,9 +353,12 @@ clicon_hash_add(clicon_hash_t *hash,
                 void          *val, 
                 size_t         vlen)
 {
-    void         *newval = NULL;
-    clicon_hash_t h;
-    clicon_hash_t new = NULL;
+    struct hash_table *ht = HT(hash);
+    void              *newval = NULL;
+    clicon_hash_t      h;
+    clicon_hash_t      new = NULL;
+    uint64_t           hv;
+    size_t             i;
     
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
@@ -240,7 +371,9 @@ clicon_hash_add(clicon_hash_t *hash,
         goto catch;
     }
     /* If variable exist, don't allocate a new. just replace value */
-    h = clicon_hash_lookup(hash, key);
+    hv = hash_siphash(key, strlen(key));
+    i = hash_slot_find(ht, key, hv);
+    h = ht->ht_slots[i].hs_entry;
     if (h == NULL) {
         if ((new = (clicon_hash_t)malloc(sizeof(*new))) == NULL){
             clicon_err(OE_UNIX, errno, "malloc");
@@ -267,19 +400,29 @@ clicon_hash_add(clicon_hash_t *hash,
         memcpy(newval, val, vlen);
     }
     
+    /* Resize before anything is changed, so that an error leaves the table as it was */
+    if (new && ht->ht_count + 1 > HASH_FULL(ht->ht_size)){
+        if (hash_resize(ht, ht->ht_size*2) < 0)
+            goto catch;
+        i = hash_slot_find(ht, key, hv);
+    }
     /* Free old value if existing variable */
     if (h->h_val)
         free(h->h_val);
     h->h_val = newval;
     h->h_vlen =  vlen;
 
-    /* Add to list only if new variable */
-    if (new)
-        INSQ(h, hash[hash_bucket(key)]);
-
+    /* Add to table only if new variable */
+    if (new){
+        ht->ht_slots[i].hs_hash = hv;
+        ht->ht_slots[i].hs_entry = h;
+        ht->ht_count++;
+    }
     return h;
 
 catch:
+    if (newval)
+        free(newval);
     if (new) {
         if (new->h_key)
             free(new->h_key);
@@ -301,17 +444,31 @@ int
 clicon_hash_del(clicon_hash_t *hash, 
                 const char    *key)
 {
-    clicon_hash_t h;
+    struct hash_table *ht = HT(hash);
+    clicon_hash_t      h;
+    size_t             mask;
+    size_t             i;
+    size_t             j;
+    size_t             k;
 
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
-    h = clicon_hash_lookup(hash, key);
-    if (h == NULL)
+    i = hash_slot_find(ht, key, hash_siphash(key, strlen(key)));
+    if ((h = ht->ht_slots[i].hs_entry) == NULL)
         return -1;
-    
-    DELQ(h, hash[hash_bucket(key)], clicon_hash_t);
+    /* Shift back following entries whose home slot k is not cyclically in (i, j] */
+    mask = ht->ht_size - 1;
+    for (j = (i+1) & mask; ht->ht_slots[j].hs_entry != NULL; j = (j+1) & mask){
+        k = ht->ht_slots[j].hs_hash & mask;
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
+        ht->ht_slots[i] = ht->ht_slots[j];
+        i = j;
+    }
+    ht->ht_slots[i].hs_entry = NULL;
+    ht->ht_count--;
   
     free(h->h_key);
     free(h->h_val);
@@ -334,32 +491,27 @@ clicon_hash_keys(clicon_hash_t *hash,
                  char        ***vector,
                  size_t        *nkeys)
 {
-    int           retval = -1;
-    int           bkt;
-    clicon_hash_t h;
-    char        **tmp;
-    char        **keys = NULL;
+    int                retval = -1;
+    struct hash_table *ht = HT(hash);
+    clicon_hash_t      h;
+    char             **keys = NULL;
+    size_t             i;
 
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
     *nkeys = 0;
-    for (bkt = 0; bkt < HASH_SIZE; bkt++) {
-        h = hash[bkt];
-        do {
-            if (h == NULL)
-                break;
-            tmp = realloc(keys, ((*nkeys)+1) * sizeof(char *));
-            if (tmp == NULL){
-                clicon_err(OE_UNIX, errno, "realloc");
-                goto catch;
-            }
-            keys = tmp;
-            keys[*nkeys] = h->h_key;
-            (*nkeys)++;
-            h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
+    if (ht->ht_count &&
+        (keys = malloc(ht->ht_count * sizeof(char *))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto catch;
+    }
+    for (i = 0; i < ht->ht_size; i++) {
+        if ((h = ht->ht_slots[i].hs_entry) == NULL)
+            continue;
+        keys[*nkeys] = h->h_key;
+        (*nkeys)++;
     }
     if (vector){
         *vector = keys;
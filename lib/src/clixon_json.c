@@ -88,6 +88,12 @@
 /* Name of xml top object created by parse functions */
 #define JSON_TOP_SYMBOL "top"
 
+/*
+ * Local variables
+ */
+/* Parse JSON with hand-written scanner instead of lex/yacc, see CLICON_JSON_SCANNER */
+static int _json_parse_scanner = 0;
+
 enum array_element_type{
     NO_ARRAY=0,
     FIRST_ARRAY,  /* [a, */
@@ -180,6 +186,38 @@ arraytype2str(enum array_element_type lt)
     return "";
 }
 
+/*! Check if two sibling elements belong to the same JSON array
+ *
+ * If both are bound to yang, they are equal if they have the same yang spec, which implies same
+ * name and namespace. Otherwise compare name and xmlns attribute.
+ * @param[in]  x     Element
+ * @param[in]  ys    Yang spec of x, or NULL
+ * @param[in]  x2    Sibling element
+ * @retval     1     Same array
+ * @retval     0     Not same array
+ */
+static int
+array_eq(cxobj     *x,
+         yang_stmt *ys,
+         cxobj     *x2)
+{
+    yang_stmt *ys2;
+    char      *nsx; /* namespace of x */
+    char      *ns2;
+
+    ys2 = xml_spec(x2);
+    if (ys != NULL && ys2 != NULL)
+        return ys == ys2;
+    if (strcmp(xml_name(x), xml_name(x2)) != 0)
+        return 0;
+    nsx = xml_find_type_value(x, NULL, "xmlns", CX_ATTR);
+    ns2 = xml_find_type_value(x2, NULL, "xmlns", CX_ATTR);
+    if ((!nsx && !ns2)
+        || (nsx && ns2 && strcmp(nsx,ns2)==0))
+        return 1;
+    return 0;
+}
+
 /*! Check typeof x in array
  * 
  * Check if element is in an array, and if so, if it is in the start "[x,", in the middle: "[..,x,..]"
@@ -199,37 +237,23 @@ array_eval(cxobj *xprev,
     int                     eqprev=0;
     int                     eqnext=0;
     yang_stmt              *ys;
-    char                   *nsx; /* namespace of x */
-    char                   *ns2;
 
-    nsx = xml_find_type_value(x, NULL, "xmlns", CX_ATTR);
     if (xml_type(x) != CX_ELMNT){
         arraytype = BODY_ARRAY;
         goto done;
     }
-    if (xnext && 
-        xml_type(xnext)==CX_ELMNT &&
-        strcmp(xml_name(x), xml_name(xnext))==0){
-        ns2 = xml_find_type_value(xnext, NULL, "xmlns", CX_ATTR);
-        if ((!nsx && !ns2)
-            || (nsx && ns2 && strcmp(nsx,ns2)==0))
-            eqnext++;
-    }
-    if (xprev &&
-        xml_type(xprev)==CX_ELMNT &&
-        strcmp(xml_name(x),xml_name(xprev))==0){
-        ns2 = xml_find_type_value(xprev, NULL, "xmlns", CX_ATTR);
-        if ((!nsx && !ns2)
-            || (nsx && ns2 && strcmp(nsx,ns2)==0))
-            eqprev++;
-    }
+    ys = xml_spec(x);
+    if (xnext && xml_type(xnext)==CX_ELMNT)
+        eqnext = array_eq(x, ys, xnext);
+    if (xprev && xml_type(xprev)==CX_ELMNT)
+        eqprev = array_eq(x, ys, xprev);
     if (eqprev && eqnext)
         arraytype = MIDDLE_ARRAY;
     else if (eqprev)
         arraytype = LAST_ARRAY;
     else if (eqnext)
         arraytype = FIRST_ARRAY;
-    else if ((ys = xml_spec(x)) != NULL) {
+    else if (ys != NULL) {
         if (yang_keyword_get(ys) == Y_LIST || yang_keyword_get(ys) == Y_LEAF_LIST)
             arraytype = SINGLE_ARRAY;
         else
@@ -243,6 +267,8 @@ array_eval(cxobj *xprev,
 
 /*! Escape a json string as well as decode xml cdata
  *
+ * Runs of characters that need no escaping are found with strcspn(3), which is vectorized
+ * in common C libraries, and appended in one copy.
  * @param[out] cb   cbuf   (encoded)
  * @param[in]  str  string (unencoded)
  */
@@ -250,40 +276,47 @@ static int
 json_str_escape_cdata(cbuf *cb,
                       char *str)
 {
-    int   retval = -1;
-    int   i;
+    int    retval = -1;
+    char  *p = str;
     size_t len;
-    
-    len = strlen(str);
-    for (i=0; i<len; i++)
-        switch (str[i]){
+
+    while (*p){
+        if ((len = strcspn(p, "\"\\\b\f\n\r\t")) > 0){
+            if (cbuf_append_buf(cb, p, len) < 0){
+                clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+            p += len;
+        }
+        switch (*p){
         case '\"':
-            cprintf(cb, "\\\"");
+            cbuf_append_str(cb, "\\\"");
             break;
         case '\\':
-            cprintf(cb, "\\\\");
+            cbuf_append_str(cb, "\\\\");
             break;
         case '\b':
-            cprintf(cb, "\\b");
+            cbuf_append_str(cb, "\\b");
             break;
         case '\f':
-            cprintf(cb, "\\f");
+            cbuf_append_str(cb, "\\f");
             break;
         case '\n':
-            cprintf(cb, "\\n");
+            cbuf_append_str(cb, "\\n");
             break;
         case '\r':
-            cprintf(cb, "\\r");
+            cbuf_append_str(cb, "\\r");
             break;
         case '\t':
-            cprintf(cb, "\\t");
-            break;
-        default: /* fall thru */
-            cprintf(cb, "%c", str[i]);
+            cbuf_append_str(cb, "\\t");
             break;
+        default: /* End of string */
+            continue;
         }
+        p++;
+    }
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
@@ -453,8 +486,9 @@ json2xml_decode(cxobj     *x,
  * @param[in]     body body string
  * @param[in]     ys   Yang spec of parent
  * @param[out]    cb   Encoded string
+ * @note Also used for CBOR, see RFC 9254 Sec 6.10
  */
-static int
+int
 xml2json_encode_identityref(cxobj     *xb,
                             char      *body,
                             yang_stmt *yp,
@@ -790,81 +824,67 @@ xml2json_encode_attr(cxobj     *xa,
     return retval;
 }
 
-/*! Do the actual work of translating XML to JSON 
+/*! State of the translation of one XML node to JSON
  *
- * @param[out]   cb        Cligen text buffer containing json on exit
- * @param[in]    x         XML tree structure containing XML to translate
- * @param[in]    arraytype Does x occur in a array (of its parent) and how?
- * @param[in]    level     Indentation level
- * @param[in]    pretty    Pretty-print output (2 means debug)
- * @param[in]    flat      Dont print NO_ARRAY object name (for _vec call)
- * @param[in]    modname0
- * @param[out]   metacbp   Meta encoding of attribute
+ * The translation of a node is split in a head, the children and a tail, so that it can be
+ * done recursively by xml2json1_cbuf, or resumed between calls, see clixon_json_stream_next
+ */
+typedef struct {
+    cxobj                  *jf_x;         /* XML node */
+    enum array_element_type jf_arraytype; /* Does x occur in a array (of its parent) and how? */
+    int                     jf_level;     /* Indentation level */
+    int                     jf_flat;      /* Dont print NO_ARRAY object name */
+    char                   *jf_modname0;  /* Ancestor module name, after head: passed to children */
+    char                   *jf_modname;   /* Module name if printed */
+    yang_stmt              *jf_ys;        /* YANG spec of x */
+    enum childtype          jf_childt;    /* Child type of x */
+    cbuf                   *jf_metacbp;   /* Meta encoding of parent */
+    cbuf                   *jf_metacbc;   /* Meta encoding of children */
+    int                     jf_i;         /* Index of next child */
+    int                     jf_commas;    /* Remaining commas between children */
+} xml2json_frame;
+
+/*! Translate XML node to JSON: print head before children
  *
- * @note Does not work with XML attributes
- * The following matrix explains how the mapping is done.
- * You need to understand what arraytype means (no/first/middle/last)
- * and what childtype is (null,body,any)
-  +----------+--------------+--------------+--------------+
-  |array,leaf| null         | body         | any          |
-  +----------+--------------+--------------+--------------+
-  |no        | <a/>         |<a>1</a>      |<a><b/></a>   |
-  |          |              |              |              |
-  |  json:   |\ta:null      |\ta:          |\ta:{\n       |
-  |          |              |              |\n}           |
-  +----------+--------------+--------------+--------------+
-  |first     |<a/><a..      |<a>1</a><a..  |<a><b/></a><a.|
-  |          |              |              |              |
-  |  json:   |\ta:[\n\tnull |\ta:[\n\t     |\ta:[\n\t{\n  |
-  |          |              |              |\n\t}         |
-  +----------+--------------+--------------+--------------+
-  |middle    |..a><a/><a..  |.a><a>1</a><a.|              |
-  |          |              |              |              |
-  |  json:   |\tnull        |\t            |\t{a          |
-  |          |              |              |\n\t}         |
-  +----------+--------------+--------------+--------------+
-  |last      |..a></a>      |..a><a>1</a>  |              |
-  |          |              |              |              |
-  |  json:   |\tnull        |\t            |\t{a          |
-  |          |\n\t]         |\n\t]         |\n\t}\t]      |
-  +----------+--------------+--------------+--------------+
+ * @param[out]   cb        Cligen text buffer
+ * @param[in,out] jf       Translation state, jf_x, jf_arraytype, jf_level, jf_flat, jf_modname0
+ *                         and jf_metacbp are set by caller
+ * @param[in]    pretty    Pretty-print output (2 means debug)
+ * @retval       0         OK
+ * @retval      -1         Error
+ * @see xml2json1_cbuf
  */
-static int 
-xml2json1_cbuf(cbuf                   *cb,
-               cxobj                  *x,
-               enum array_element_type arraytype,
-               int                     level,
-               int                     pretty,
-               int                     flat,
-               char                   *modname0,
-               cbuf                   *metacbp)
+static int
+xml2json1_head(cbuf           *cb,
+               xml2json_frame *jf,
+               int             pretty)
 {
     int              retval = -1;
-    int              i;
-    cxobj           *xc;
-    cxobj           *xp;
+    cxobj           *x = jf->jf_x;
+    enum array_element_type arraytype = jf->jf_arraytype;
+    int              level = jf->jf_level;
+    char            *modname0 = jf->jf_modname0;
     enum childtype   childt;
-    enum array_element_type xc_arraytype;
     yang_stmt       *ys;
-    yang_stmt       *ymod = NULL; /* yang module */
-    int              commas;
+    yang_json       *yj = NULL; /* precomputed JSON name */
     char            *modname = NULL;
-    cbuf            *metacbc = NULL;
+    char            *name;
 
+    name = xml_name(x);
     if ((ys = xml_spec(x)) != NULL){
-        if (ys_real_module(ys, &ymod) < 0)
-            goto done;
-        modname = yang_argument_get(ymod);
-        /* Special case for ietf-netconf -> ietf-restconf translation 
-         * A special case is for return data on the form {"data":...}
+        /* Module name is precomputed, including the special case for ietf-netconf -> 
+         * ietf-restconf translation for return data on the form {"data":...}
          * See also json_xmlns_translate()
          */
-        if (strcmp(modname, "ietf-netconf") == 0)
-            modname = "ietf-restconf";
-        if (modname0 && strcmp(modname, modname0) == 0)
+        if ((yj = yang_json_get(ys)) == NULL)
+            goto done;
+        modname = yj->yj_module;
+        if (modname0 && (modname0 == modname || strcmp(modname, modname0) == 0))
             modname=NULL;
-        else
+        else{
             modname0 = modname; /* modname0 is ancestor ns passed to child */
+            name = yj->yj_qname;
+        }
     }
     childt = child_type(x);
     if (pretty==2)
@@ -872,17 +892,16 @@ xml2json1_cbuf(cbuf                   *cb,
                 arraytype2str(arraytype),
                 childtype2str(childt));
     switch(arraytype){
-    case BODY_ARRAY: /* Only place in fn where body is printed (except nullchild) */
-        xp = xml_parent(x);
+    case BODY_ARRAY:{ /* Only place in fn where body is printed (except nullchild) */
+        cxobj *xp = xml_parent(x);
         if (xml2json_encode_leafs(x, xp, xml_spec(xp), cb) < 0)
             goto done;
         break;
+    }
     case NO_ARRAY:
-        if (!flat){
-            cprintf(cb, "%*s\"", pretty?(level*PRETTYPRINT_INDENT):0, "");
-            if (modname) 
-                cprintf(cb, "%s:", modname);
-            cprintf(cb, "%s\":%s", xml_name(x), pretty?" ":"");
+        if (!jf->jf_flat){
+            cprintf(cb, "%*s\"%s\":%s", pretty?(level*PRETTYPRINT_INDENT):0, "",
+                    name, pretty?" ":"");
         }
         switch (childt){
         case NULL_CHILD:
@@ -900,10 +919,8 @@ xml2json1_cbuf(cbuf                   *cb,
         break;
     case FIRST_ARRAY:
     case SINGLE_ARRAY:
-        cprintf(cb, "%*s\"", pretty?(level*PRETTYPRINT_INDENT):0, "");
-        if (modname)
-            cprintf(cb, "%s:", modname);
-        cprintf(cb, "%s\":%s", xml_name(x), pretty?" ":"");
+        cprintf(cb, "%*s\"%s\":%s", pretty?(level*PRETTYPRINT_INDENT):0, "",
+                name, pretty?" ":"");
         level++;
         cprintf(cb, "[%s%*s", 
                 pretty?"\n":"",
@@ -944,46 +961,106 @@ xml2json1_cbuf(cbuf                   *cb,
     default:
         break;
     }
-    if ((metacbc = cbuf_new()) == NULL){
+    if ((jf->jf_metacbc = cbuf_new()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
+    jf->jf_level = level;
+    jf->jf_modname0 = modname0;
+    jf->jf_modname = modname;
+    jf->jf_ys = ys;
+    jf->jf_childt = childt;
+    jf->jf_i = 0;
     /* Check for typed sub-body if:
      * arraytype=* but child-type is BODY_CHILD 
      * This is code for writing <a>42</a> as "a":42 and not "a":"42"
      */
-    commas = xml_child_nr_notype(x, CX_ATTR) - 1;
-    for (i=0; i<xml_child_nr(x); i++){
+    jf->jf_commas = xml_child_nr_notype(x, CX_ATTR) - 1;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Translate XML node to JSON: get next child to translate
+ *
+ * Attributes are encoded in the meta encoding of the parent
+ * @param[in,out] jf       Translation state
+ * @param[in]    pretty    Pretty-print output
+ * @param[out]   xcp       Next child, or NULL if no more children
+ * @param[out]   arraytype Does the child occur in an array and how?
+ * @retval       0         OK
+ * @retval      -1         Error
+ */
+static int
+xml2json1_child(xml2json_frame          *jf,
+                int                      pretty,
+                cxobj                  **xcp,
+                enum array_element_type *arraytype)
+{
+    cxobj *x = jf->jf_x;
+    cxobj *xc;
+    int    i;
+
+    *xcp = NULL;
+    /* Default node of report-all-tagged, see xml_add_default_tag */
+    if (jf->jf_i == 0 && jf->jf_metacbp && jf->jf_ys && xml_flag(x, XML_FLAG_WDTAG))
+        json_metadata_encoding(jf->jf_metacbp, x, jf->jf_level, pretty,
+                               jf->jf_modname, xml_name(x),
+                               "ietf-netconf-with-defaults", "default", "true",
+                               yang_keyword_get(jf->jf_ys) == Y_LEAF_LIST ||
+                               yang_keyword_get(jf->jf_ys) == Y_LIST);
+    while ((i = jf->jf_i) < xml_child_nr(x)){
+        jf->jf_i++;
         xc = xml_child_i(x, i);
         if (xml_type(xc) == CX_ATTR){
-            if (metacbp &&
-                xml2json_encode_attr(xc, x, ys, level, pretty, modname, metacbp) < 0)
-                goto done;
+            if (jf->jf_metacbp &&
+                xml2json_encode_attr(xc, x, jf->jf_ys, jf->jf_level, pretty, jf->jf_modname, jf->jf_metacbp) < 0)
+                return -1;
             continue;
         }
-        xc_arraytype = array_eval(i?xml_child_i(x,i-1):NULL, 
+        *arraytype = array_eval(i?xml_child_i(x,i-1):NULL, 
                                 xc, 
                                 xml_child_i(x, i+1));
-        if (xml2json1_cbuf(cb, 
-                           xc, 
-                           xc_arraytype,
-                           level+1, pretty, 0, modname0,
-                           metacbc) < 0)
-            goto done;
-        if (commas > 0) {
-            cprintf(cb, ",%s", pretty?"\n":"");
-            --commas;
-        }
+        *xcp = xc;
+        break;
     }
-    if (cbuf_len(metacbc)){
-        cprintf(cb, "%s", cbuf_get(metacbc));
+    return 0;
+}
+
+/*! Translate XML node to JSON: print comma after a child
+ */
+static void
+xml2json1_comma(cbuf           *cb,
+                xml2json_frame *jf,
+                int             pretty)
+{
+    if (jf->jf_commas > 0) {
+        cprintf(cb, ",%s", pretty?"\n":"");
+        --jf->jf_commas;
     }
+}
 
-    switch (arraytype){
+/*! Translate XML node to JSON: print tail after children
+ *
+ * @param[out]   cb        Cligen text buffer
+ * @param[in,out] jf       Translation state
+ * @param[in]    pretty    Pretty-print output
+ */
+static void
+xml2json1_tail(cbuf           *cb,
+               xml2json_frame *jf,
+               int             pretty)
+{
+    int level = jf->jf_level;
+
+    if (cbuf_len(jf->jf_metacbc)){
+        cprintf(cb, "%s", cbuf_get(jf->jf_metacbc));
+    }
+    switch (jf->jf_arraytype){
     case BODY_ARRAY:
         break;
     case NO_ARRAY:
-        switch (childt){
+        switch (jf->jf_childt){
         case NULL_CHILD:
         case BODY_CHILD:
             break;
@@ -999,7 +1076,7 @@ xml2json1_cbuf(cbuf                   *cb,
         break;
     case FIRST_ARRAY:
     case MIDDLE_ARRAY:
-        switch (childt){
+        switch (jf->jf_childt){
         case NULL_CHILD:
         case BODY_CHILD:
             break;
@@ -1015,7 +1092,7 @@ xml2json1_cbuf(cbuf                   *cb,
         break;
     case SINGLE_ARRAY:
     case LAST_ARRAY:
-        switch (childt){
+        switch (jf->jf_childt){
         case NULL_CHILD:
         case BODY_CHILD:
             cprintf(cb, "%s",pretty?"\n":"");
@@ -1036,10 +1113,88 @@ xml2json1_cbuf(cbuf                   *cb,
     default:
         break;
     }
+}
+
+/*! Do the actual work of translating XML to JSON 
+ *
+ * @param[out]   cb        Cligen text buffer containing json on exit
+ * @param[in]    x         XML tree structure containing XML to translate
+ * @param[in]    arraytype Does x occur in a array (of its parent) and how?
+ * @param[in]    level     Indentation level
+ * @param[in]    pretty    Pretty-print output (2 means debug)
+ * @param[in]    flat      Dont print NO_ARRAY object name (for _vec call)
+ * @param[in]    modname0
+ * @param[out]   metacbp   Meta encoding of attribute
+ *
+ * @note Does not work with XML attributes
+ * The following matrix explains how the mapping is done.
+ * You need to understand what arraytype means (no/first/middle/last)
+ * and what childtype is (null,body,any)
+  +----------+--------------+--------------+--------------+
+  |array,leaf| null         | body         | any          |
+  +----------+--------------+--------------+--------------+
+  |no        | <a/>         |<a>1</a>      |<a><b/></a>   |
+  |          |              |              |              |
+  |  json:   |\ta:null      |\ta:          |\ta:{\n       |
+  |          |              |              |\n}           |
+  +----------+--------------+--------------+--------------+
+  |first     |<a/><a..      |<a>1</a><a..  |<a><b/></a><a.|
+  |          |              |              |              |
+  |  json:   |\ta:[\n\tnull |\ta:[\n\t     |\ta:[\n\t{\n  |
+  |          |              |              |\n\t}         |
+  +----------+--------------+--------------+--------------+
+  |middle    |..a><a/><a..  |.a><a>1</a><a.|              |
+  |          |              |              |              |
+  |  json:   |\tnull        |\t            |\t{a          |
+  |          |              |              |\n\t}         |
+  +----------+--------------+--------------+--------------+
+  |last      |..a></a>      |..a><a>1</a>  |              |
+  |          |              |              |              |
+  |  json:   |\tnull        |\t            |\t{a          |
+  |          |\n\t]         |\n\t]         |\n\t}\t]      |
+  +----------+--------------+--------------+--------------+
+ */
+static int 
+xml2json1_cbuf(cbuf                   *cb,
+               cxobj                  *x,
+               enum array_element_type arraytype,
+               int                     level,
+               int                     pretty,
+               int                     flat,
+               char                   *modname0,
+               cbuf                   *metacbp)
+{
+    int                     retval = -1;
+    cxobj                  *xc;
+    enum array_element_type xc_arraytype;
+    xml2json_frame          jf = {0,};
+
+    jf.jf_x = x;
+    jf.jf_arraytype = arraytype;
+    jf.jf_level = level;
+    jf.jf_flat = flat;
+    jf.jf_modname0 = modname0;
+    jf.jf_metacbp = metacbp;
+    if (xml2json1_head(cb, &jf, pretty) < 0)
+        goto done;
+    while (1){
+        if (xml2json1_child(&jf, pretty, &xc, &xc_arraytype) < 0)
+            goto done;
+        if (xc == NULL)
+            break;
+        if (xml2json1_cbuf(cb, 
+                           xc, 
+                           xc_arraytype,
+                           jf.jf_level+1, pretty, 0, jf.jf_modname0,
+                           jf.jf_metacbc) < 0)
+            goto done;
+        xml2json1_comma(cb, &jf, pretty);
+    }
+    xml2json1_tail(cb, &jf, pretty);
     retval = 0;
  done:
-    if (metacbc)
-        cbuf_free(metacbc);
+    if (jf.jf_metacbc)
+        cbuf_free(jf.jf_metacbc);
     return retval;
 }
 
@@ -1160,30 +1315,22 @@ clixon_json2cbuf(cbuf  *cb,
     return retval;
 }
 
-/*! Translate a vector of xml objects to JSON Cligen buffer.
+/*! Make a top pseudo-object with copies of a vector of xml objects
  *
- * This is done by adding a top pseudo-object, and add the vector as subs,
- * and then not printing the top pseudo-object using the 'flat' option.
- * @param[out] cb     Cligen buffer to write to
- * @param[in]  vec    Vector of xml objecst
- * @param[in]  veclen Length of vector
- * @param[in]  pretty Set if output is pretty-printed (2 for debug)
+ * @param[in]  vec     Vector of xml objecst
+ * @param[in]  veclen  Length of vector
  * @param[in]  skiptop 0: Include top object 1: Skip top-object, only children, 
- * @retval     0      OK
- * @retval    -1      Error
- * @note This only works if the vector is uniform, ie same object name.
- * Example: <b/><c/> --> <a><b/><c/></a> --> {"b" : null,"c" : null}
- * @see clixon_json2cbuf
+ * @param[out] xpp     Top pseudo-object, free with xml_free
+ * @retval     0       OK
+ * @retval    -1       Error
  */
-int 
-xml2json_cbuf_vec(cbuf      *cb, 
-                  cxobj    **vec,
-                  size_t     veclen,
-                  int        pretty,
-                  int        skiptop)
+static int
+xml2json_vec_top(cxobj    **vec,
+                 size_t     veclen,
+                 int        skiptop,
+                 cxobj    **xpp)
 {
     int    retval = -1;
-    int    level = 0;
     cxobj *xp = NULL;
     int    i;
     cxobj *xc0;
@@ -1216,6 +1363,45 @@ xml2json_cbuf_vec(cbuf      *cb,
             }
         nsc = NULL; /* nsc consumed */
     }
+    *xpp = xp;
+    xp = NULL;
+    retval = 0;
+ done:
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (xp)
+        xml_free(xp);
+    return retval;
+}
+
+/*! Translate a vector of xml objects to JSON Cligen buffer.
+ *
+ * This is done by adding a top pseudo-object, and add the vector as subs,
+ * and then not printing the top pseudo-object using the 'flat' option.
+ * @param[out] cb     Cligen buffer to write to
+ * @param[in]  vec    Vector of xml objecst
+ * @param[in]  veclen Length of vector
+ * @param[in]  pretty Set if output is pretty-printed (2 for debug)
+ * @param[in]  skiptop 0: Include top object 1: Skip top-object, only children, 
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @note This only works if the vector is uniform, ie same object name.
+ * Example: <b/><c/> --> <a><b/><c/></a> --> {"b" : null,"c" : null}
+ * @see clixon_json2cbuf
+ */
+int 
+xml2json_cbuf_vec(cbuf      *cb, 
+                  cxobj    **vec,
+                  size_t     veclen,
+                  int        pretty,
+                  int        skiptop)
+{
+    int    retval = -1;
+    int    level = 0;
+    cxobj *xp = NULL;
+
+    if (xml2json_vec_top(vec, veclen, skiptop, &xp) < 0)
+        goto done;
     if (0){
         cprintf(cb, "[%s", pretty?"\n":" ");
         level++;
@@ -1236,13 +1422,216 @@ xml2json_cbuf_vec(cbuf      *cb,
     }
     retval = 0;
  done:
-    if (nsc)
-        xml_nsctx_free(nsc);
     if (xp)
         xml_free(xp);
     return retval;
 }
 
+/*! Incremental translation of an XML tree to JSON
+ *
+ * Instead of translating the whole tree at once, the JSON text is produced in parts by
+ * clixon_json_stream_next, eg as the data of a reply are sent. The output is the same as
+ * of clixon_json2cbuf or xml2json_cbuf_vec.
+ * The translation state is a stack of frames, one per XML node from the top to the current node
+ */
+struct clixon_json_stream {
+    cxobj          *js_xt;      /* XML tree, owned by the stream */
+    int             js_pretty;  /* Pretty-print output */
+    int             js_flat;    /* Vector: dont print top pseudo-object and braces */
+    int             js_started; /* Top object has been started */
+    int             js_eof;     /* All has been translated */
+    xml2json_frame *js_stack;   /* Stack of translation frames */
+    int             js_len;     /* Length of stack */
+    int             js_max;     /* Allocated length of stack */
+};
+
+/*! Create a stream translating an XML tree to JSON, same as clixon_json2cbuf
+ *
+ * @param[in]  xt      XML tree. Consumed by the stream, freed by clixon_json_stream_free
+ * @param[in]  pretty  Set if output is pretty-printed
+ * @retval     js      JSON stream, free with clixon_json_stream_free
+ * @retval     NULL    Error
+ * @code
+ *   if ((js = clixon_json_stream_new(xt, 0)) == NULL)
+ *     err;
+ *   while ((ret = clixon_json_stream_next(js, cb, 4096)) == 1)
+ *     write and reset cb
+ *   clixon_json_stream_free(js);
+ * @endcode
+ * @see clixon_json2cbuf with skiptop=0 and autocliext=0
+ */
+clixon_json_stream *
+clixon_json_stream_new(cxobj *xt,
+                       int    pretty)
+{
+    clixon_json_stream *js;
+
+    if ((js = malloc(sizeof(*js))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(js, 0, sizeof(*js));
+    js->js_xt = xt;
+    js->js_pretty = pretty;
+    return js;
+}
+
+/*! Create a stream translating a vector of XML objects to JSON, same as xml2json_cbuf_vec
+ *
+ * @param[in]  vec     Vector of xml objects, copied
+ * @param[in]  veclen  Length of vector
+ * @param[in]  pretty  Set if output is pretty-printed
+ * @retval     js      JSON stream, free with clixon_json_stream_free
+ * @retval     NULL    Error
+ * @see xml2json_cbuf_vec with skiptop=0
+ */
+clixon_json_stream *
+clixon_json_stream_new_vec(cxobj  **vec,
+                           size_t   veclen,
+                           int      pretty)
+{
+    clixon_json_stream *js;
+    cxobj              *xp = NULL;
+
+    if (xml2json_vec_top(vec, veclen, 0, &xp) < 0)
+        return NULL;
+    if ((js = clixon_json_stream_new(xp, pretty)) == NULL){
+        xml_free(xp);
+        return NULL;
+    }
+    js->js_flat = 1;
+    return js;
+}
+
+/*! Push a translation frame and print its head
+ *
+ * @param[in]  js        JSON stream
+ * @param[out] cb        Cligen buffer to write to
+ * @param[in]  x         XML node
+ * @param[in]  arraytype Does x occur in a array (of its parent) and how?
+ * @param[in]  level     Indentation level
+ * @param[in]  flat      Dont print NO_ARRAY object name
+ * @param[in]  modname0  Ancestor module name
+ * @param[in]  metacbp   Meta encoding of parent
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+json_stream_push(clixon_json_stream     *js,
+                 cbuf                   *cb,
+                 cxobj                  *x,
+                 enum array_element_type arraytype,
+                 int                     level,
+                 int                     flat,
+                 char                   *modname0,
+                 cbuf                   *metacbp)
+{
+    xml2json_frame *jf;
+
+    if (js->js_len == js->js_max){
+        js->js_max = js->js_max?2*js->js_max:8;
+        if ((jf = realloc(js->js_stack, js->js_max*sizeof(*jf))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        js->js_stack = jf;
+    }
+    jf = &js->js_stack[js->js_len++];
+    memset(jf, 0, sizeof(*jf));
+    jf->jf_x = x;
+    jf->jf_arraytype = arraytype;
+    jf->jf_level = level;
+    jf->jf_flat = flat;
+    jf->jf_modname0 = modname0;
+    jf->jf_metacbp = metacbp;
+    return xml2json1_head(cb, jf, js->js_pretty);
+}
+
+/*! Translate next part of XML tree to JSON
+ *
+ * Translation continues until at least len bytes have been added to cb, or the end is reached
+ * @param[in]  js      JSON stream
+ * @param[out] cb      Cligen buffer to append to
+ * @param[in]  len     Minimum number of bytes to add (if not end), 0 means translate all
+ * @retval     1       OK, more to translate
+ * @retval     0       OK, end of translation
+ * @retval    -1       Error
+ */
+int
+clixon_json_stream_next(clixon_json_stream *js,
+                        cbuf               *cb,
+                        size_t              len)
+{
+    size_t                  len0 = cbuf_len(cb);
+    int                     pretty = js->js_pretty;
+    xml2json_frame         *jf;
+    cxobj                  *xc;
+    enum array_element_type arraytype;
+    yang_stmt              *y;
+
+    while (!js->js_eof && (len == 0 || cbuf_len(cb) - len0 < len)){
+        if (!js->js_started){
+            js->js_started++;
+            if (js->js_flat){
+                if (json_stream_push(js, cb, js->js_xt, NO_ARRAY, 0, 1, NULL, NULL) < 0)
+                    return -1;
+            }
+            else{
+                /* See xml2json_cbuf1 */
+                cprintf(cb, "{%s", pretty?"\n":"");
+                arraytype = NO_ARRAY;
+                if ((y = xml_spec(js->js_xt)) != NULL &&
+                    (yang_keyword_get(y) == Y_LIST || yang_keyword_get(y) == Y_LEAF_LIST))
+                    arraytype = SINGLE_ARRAY;
+                if (json_stream_push(js, cb, js->js_xt, arraytype, 1, 0, NULL, NULL) < 0)
+                    return -1;
+            }
+            continue;
+        }
+        jf = &js->js_stack[js->js_len-1];
+        if (xml2json1_child(jf, pretty, &xc, &arraytype) < 0)
+            return -1;
+        if (xc != NULL){
+            if (json_stream_push(js, cb, xc, arraytype, jf->jf_level+1, 0,
+                                 jf->jf_modname0, jf->jf_metacbc) < 0)
+                return -1;
+            continue;
+        }
+        xml2json1_tail(cb, jf, pretty);
+        cbuf_free(jf->jf_metacbc);
+        jf->jf_metacbc = NULL;
+        js->js_len--;
+        if (js->js_len > 0)
+            xml2json1_comma(cb, &js->js_stack[js->js_len-1], pretty);
+        else{
+            if (!js->js_flat)
+                cprintf(cb, "%s}%s", pretty?"\n":"", pretty?"\n":"");
+            js->js_eof++;
+        }
+    }
+    return js->js_eof?0:1;
+}
+
+/*! Free JSON stream and its XML tree
+ *
+ * @param[in]  js      JSON stream
+ */
+int
+clixon_json_stream_free(clixon_json_stream *js)
+{
+    int i;
+
+    for (i=0; i<js->js_len; i++)
+        if (js->js_stack[i].jf_metacbc)
+            cbuf_free(js->js_stack[i].jf_metacbc);
+    if (js->js_stack)
+        free(js->js_stack);
+    if (js->js_xt)
+        xml_free(js->js_xt);
+    free(js);
+    return 0;
+}
+
 /*! Translate from xml tree to JSON and print to file using a callback
  *
  * @param[in]  f       File to print to
@@ -1408,80 +1797,77 @@ json_xmlns_translate(yang_stmt *yspec,
     goto done;
 }
 
-/*! Parse a string containing JSON and return an XML tree
+/*! Kludge to set JSON scanner option in JSON parsing
  *
- * Parsing using yacc according to JSON syntax. Names with <prefix>:<id>
- * are split and interpreted as in RFC7951
+ * This is because clicon-handle is not passed to the JSON parse functions
+ * @param[in] val  If set, parse JSON with hand-written scanner, see CLICON_JSON_SCANNER
+ * @retval    0    OK
+ */
+int
+clixon_json_parse_scanner(int val)
+{
+    _json_parse_scanner = val;
+    return 0;
+}
+
+/*! Check, translate and bind the top-level objects created when parsing
  *
- * @param[in]  str    Input string containing JSON
- * @param[in]  rfc7951 Do sanity checks according to RFC 7951 JSON Encoding of Data Modeled with YANG
- * @param[in]  yb     How to bind yang to XML top-level when parsing (if rfc7951)
- * @param[in]  yspec  Yang specification (if rfc 7951)
- * @param[out] xt     XML top of tree typically w/o children on entry (but created)
- * @param[out] xerr   Reason for invalid returned as netconf err msg 
- * 
- * @see _xml_parse for XML variant
- * @retval        1   OK and valid
- * @retval        0   Invalid (only if yang spec)
- * @retval       -1   Error with clicon_err called
- * @see http://www.ecma-international.org/publications/files/ECMA-ST/ECMA-404.pdf
- * @see RFC 7951
+ * Names with <prefix>:<id> are split when parsing, here module names are translated to
+ * namespaces, yang is bound and identityref values decoded, as in RFC7951
+ * Used after parsing JSON, and CBOR which has the same names, see RFC 9254
+ * @param[in]  jy      Parse state: jy_xvec, jy_xlen, jy_xtop, jy_rfc7951, jy_yb, jy_yspec
+ * @param[in]  scanned Parsed by hand-written scanner, see jy_unqualified and jy_translated
+ * @param[out] xerr    Reason for invalid returned as netconf err msg
+ * @retval     1       OK and valid
+ * @retval     0       Invalid (only if yang spec)
+ * @retval    -1       Error with clicon_err called
  */
-static int 
-_json_parse(char      *str, 
-            int        rfc7951,
-            yang_bind  yb,
-            yang_stmt *yspec,
-            cxobj     *xt,
-            cxobj    **xerr)
+int
+json_parse_bind(clixon_json_yacc *jy,
+                int               scanned,
+                cxobj           **xerr)
 {
-    int              retval = -1;
-    clixon_json_yacc jy = {0,};
-    int              ret;
-    cxobj           *x;
-    cbuf            *cberr = NULL;
-    int              i;
-    int              failed = 0; /* yang assignment */
-    
-    clicon_debug(1, "%s %d %s", __FUNCTION__, yb, str);
-    jy.jy_parse_string = str;
-    jy.jy_linenum = 1;
-    jy.jy_current = xt;
-    jy.jy_xtop = xt;
-    if (json_scan_init(&jy) < 0)
-        goto done;
-    if (json_parse_init(&jy) < 0)
-        goto done;
-    if (clixon_json_parseparse(&jy) != 0) { /* yacc returns 1 on error */
-        clicon_log(LOG_NOTICE, "JSON error: line %d", jy.jy_linenum);
-        if (clicon_errno == 0)
-            clicon_err(OE_JSON, 0, "JSON parser error with no error code (should not happen)");
-        goto done;
-    }
+    int        retval = -1;
+    int        rfc7951 = jy->jy_rfc7951;
+    yang_bind  yb = jy->jy_yb;
+    yang_stmt *yspec = jy->jy_yspec;
+    int        ret;
+    cxobj     *x;
+    cbuf      *cberr = NULL;
+    int        i;
+    int        failed = 0; /* yang assignment */
+    int        unqualified;
+
     /* Traverse new objects */
-    for (i = 0; i < jy.jy_xlen; i++) {
-        x = jy.jy_xvec[i];
+    for (i = 0; i < jy->jy_xlen; i++) {
+        x = jy->jy_xvec[i];
         /* RFC 7951 Section 4: A namespace-qualified member name MUST be used for all 
          * members of a top-level JSON object 
+         * XXX: Except for top-level config file
          */
-        if (rfc7951 && xml_prefix(x) == NULL){
-            /* XXX: For top-level config file: */
-            if (yb != YB_NONE || strcmp(xml_name(x),DATASTORE_TOP_SYMBOL)!=0){
-                if ((cberr = cbuf_new()) == NULL){
-                    clicon_err(OE_UNIX, errno, "cbuf_new");
-                    goto done;
-                }
-                cprintf(cberr, "Top-level JSON object %s is not qualified with namespace which is a MUST according to RFC 7951", xml_name(x));
-                if (xerr && netconf_malformed_message_xml(xerr, cbuf_get(cberr)) < 0)
-                    goto done;
-                goto fail;
+        if (scanned) /* Checked by scanner before module names are translated */
+            unqualified = (x == jy->jy_unqualified);
+        else
+            unqualified = rfc7951 && xml_prefix(x) == NULL &&
+                (yb != YB_NONE || strcmp(xml_name(x),DATASTORE_TOP_SYMBOL)!=0);
+        if (unqualified){
+            if ((cberr = cbuf_new()) == NULL){
+                clicon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
             }
-        }
-        /* Names are split into name/prefix, but now add namespace info */
-        if ((ret = json_xmlns_translate(yspec, x, xerr)) < 0)
-            goto done;
-        if (ret == 0)
+            cprintf(cberr, "Top-level JSON object %s is not qualified with namespace which is a MUST according to RFC 7951", xml_name(x));
+            if (xerr && netconf_malformed_message_xml(xerr, cbuf_get(cberr)) < 0)
+                goto done;
             goto fail;
+        }
+        /* Names are split into name/prefix, but now add namespace info,
+         * unless translated by scanner */
+        if (!scanned || !jy->jy_translated){
+            if ((ret = json_xmlns_translate(yspec, x, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
         /* Now assign yang stmts to each XML node 
          * XXX should be xml_bind_yang0_parent() sometimes.
          */
@@ -1525,21 +1911,83 @@ _json_parse(char      *str,
     /* Sort the complete tree after parsing. Sorting is not really meaningful if Yang 
        not bound */
     if (yb != YB_NONE)
-        if (xml_sort_recurse(xt) < 0)
+        if (xml_sort_recurse(jy->jy_xtop) < 0)
             goto done;
     retval = 1;
  done:
-    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
     if (cberr)
         cbuf_free(cberr);
+    return retval;
+ fail: /* invalid */
+    retval = 0;
+    goto done;
+}
+
+/*! Parse a string containing JSON and return an XML tree
+ *
+ * Parsing using yacc according to JSON syntax. Names with <prefix>:<id>
+ * are split and interpreted as in RFC7951
+ *
+ * @param[in]  str    Input string containing JSON
+ * @param[in]  rfc7951 Do sanity checks according to RFC 7951 JSON Encoding of Data Modeled with YANG
+ * @param[in]  yb     How to bind yang to XML top-level when parsing (if rfc7951)
+ * @param[in]  yspec  Yang specification (if rfc 7951)
+ * @param[out] xt     XML top of tree typically w/o children on entry (but created)
+ * @param[out] xerr   Reason for invalid returned as netconf err msg 
+ * 
+ * @see _xml_parse for XML variant
+ * @retval        1   OK and valid
+ * @retval        0   Invalid (only if yang spec)
+ * @retval       -1   Error with clicon_err called
+ * @see http://www.ecma-international.org/publications/files/ECMA-ST/ECMA-404.pdf
+ * @see RFC 7951
+ */
+static int 
+_json_parse(char      *str, 
+            int        rfc7951,
+            yang_bind  yb,
+            yang_stmt *yspec,
+            cxobj     *xt,
+            cxobj    **xerr)
+{
+    int              retval = -1;
+    clixon_json_yacc jy = {0,};
+    
+    clicon_debug(1, "%s %d %s", __FUNCTION__, yb, str);
+    jy.jy_parse_string = str;
+    jy.jy_linenum = 1;
+    jy.jy_current = xt;
+    jy.jy_xtop = xt;
+    jy.jy_yspec = yspec;
+    jy.jy_rfc7951 = rfc7951;
+    jy.jy_yb = yb;
+    if (_json_parse_scanner){
+        if (clixon_json_scan(&jy) < 0){
+            clicon_log(LOG_NOTICE, "JSON error: line %d", jy.jy_linenum);
+            goto done;
+        }
+    }
+    else {
+        if (json_scan_init(&jy) < 0)
+            goto done;
+        if (json_parse_init(&jy) < 0)
+            goto done;
+        if (clixon_json_parseparse(&jy) != 0) { /* yacc returns 1 on error */
+            clicon_log(LOG_NOTICE, "JSON error: line %d", jy.jy_linenum);
+            if (clicon_errno == 0)
+                clicon_err(OE_JSON, 0, "JSON parser error with no error code (should not happen)");
+            goto done;
+        }
+    }
+    retval = json_parse_bind(&jy, _json_parse_scanner, xerr);
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
     json_parse_exit(&jy);
-    json_scan_exit(&jy);
+    if (jy.jy_lexbuf)
+        json_scan_exit(&jy);
     if (jy.jy_xvec)
         free(jy.jy_xvec);
     return retval; 
- fail: /* invalid */
-    retval = 0;
-    goto done;
 }
 
 /*! Parse string containing JSON and return an XML tree
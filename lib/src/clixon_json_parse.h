@@ -49,6 +49,11 @@ struct clixon_json_yacc {
     cxobj    **jy_xvec;         /* Vector of created top-level nodes (to know which are created) */
     int        jy_xlen;         /* Length of jy_xvec */
     cbuf      *jy_cbuf_str;     /* cbuf used for strings, if error needs to be deallocated */
+    yang_stmt *jy_yspec;        /* Translate module names using this yang spec */
+    int        jy_rfc7951;      /* Check top-level names according to RFC 7951 */
+    yang_bind  jy_yb;           /* Yang binding of top-level nodes */
+    cxobj     *jy_unqualified;  /* Scanner: first top-level element failing RFC 7951 check */
+    int        jy_translated;   /* Scanner: all module names translated to namespaces */
 };
 typedef struct clixon_json_yacc clixon_json_yacc;
 
@@ -70,4 +75,8 @@ int clixon_json_parselex(void *);
 int clixon_json_parseparse(void *);
 void clixon_json_parseerror(void *, char*);
 
+int clixon_json_scan(clixon_json_yacc *jy);
+
+int json_parse_bind(clixon_json_yacc *jy, int scanned, cxobj **xerr);
+
 #endif  /* _CLIXON_JSON_PARSE_H_ */
@@ -0,0 +1,567 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+ *
+ * Hand-written JSON scanner, alternative to the lex/yacc parser of clixon_json_parse.[ly]
+ * Selected at runtime with CLICON_JSON_SCANNER, see clixon_json_parse_scanner()
+ *
+ * The scanner builds the same tree as the lex/yacc parser for all documents the latter
+ * accepts, and rejects the same documents:
+ * - Numbers are as in the lex parser, eg an exponent must have a sign
+ * - Strings may not contain raw \b \f \n \r \t, \uXXXX is translated to UTF-8
+ * - Values of an array are added to clones of the current element
+ * Strings are scanned in runs with strcspn(3), which is vectorized in common C libraries,
+ * instead of token by token.
+ * In addition, module names of member names are translated to namespaces when the element
+ * is created, instead of in a separate pass, see json_xmlns_translate, and the RFC 7951
+ * check of top-level member names is made before the translation.
+ * @see RFC 7951
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_yang_module.h"
+#include "clixon_xml_map.h"
+#include "clixon_json_parse.h"
+
+/* Max nesting of objects and arrays */
+#define JSON_SCAN_DEPTH_MAX 10000
+
+/*! JSON scanner state
+ */
+struct json_scan {
+    clixon_json_yacc *js_jy;
+    char             *js_str;     /* Start of parse string, for line numbers */
+    char             *js_p;       /* Current position */
+    cbuf             *js_cb;      /* Decoded string */
+    char             *js_modname; /* Module name of last translation */
+    char             *js_ns;      /* Namespace of last translation */
+};
+
+#define jscan_space(c) ((c)==' ' || (c)=='\t' || (c)=='\n' || (c)=='\r')
+#define jscan_digit(c) ((c)>='0' && (c)<='9')
+#define jscan_hex(c)   (jscan_digit(c) || ((c)>='a' && (c)<='f') || ((c)>='A' && (c)<='F'))
+
+static int jscan_value(struct json_scan *js, cxobj **xp, char *name, int depth);
+
+/*! Report scanner syntax error, with line number as the lex/yacc parser
+ */
+static int
+jscan_error(struct json_scan *js,
+            char             *reason)
+{
+    char *s;
+
+    js->js_jy->jy_linenum = 1;
+    for (s = js->js_str; s < js->js_p; s++)
+        if (*s == '\n')
+            js->js_jy->jy_linenum++;
+    clicon_err(OE_JSON, 0, "json_parse: line %d: %s at or before: '%.16s'",
+               js->js_jy->jy_linenum, reason, js->js_p);
+    return -1;
+}
+
+/*! Skip whitespace between tokens */
+static inline void
+jscan_skip(struct json_scan *js)
+{
+    while (jscan_space(*js->js_p))
+        js->js_p++;
+}
+
+/*! Translate module name of a new element to namespace, as json_xmlns_translate
+ *
+ * If the module is not found, the element is left as is and json_xmlns_translate reports it
+ * @param[in]  js   Scanner
+ * @param[in]  x    Element with module name as prefix
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+jscan_translate(struct json_scan *js,
+                cxobj            *x)
+{
+    clixon_json_yacc *jy = js->js_jy;
+    char             *modname = xml_prefix(x);
+    yang_stmt        *ymod;
+
+    if (strcmp(modname, "ietf-restconf") == 0)
+        modname = "ietf-netconf";
+    if (js->js_modname == NULL || strcmp(js->js_modname, modname) != 0){
+        if (jy->jy_yspec == NULL ||
+            (ymod = yang_find_module_by_name(jy->jy_yspec, modname)) == NULL){
+            jy->jy_translated = 0;
+            return 0;
+        }
+        if (js->js_modname)
+            free(js->js_modname);
+        if ((js->js_modname = strdup(modname)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            return -1;
+        }
+        js->js_ns = yang_find_mynamespace(ymod);
+    }
+    return xml_namespace_change(x, js->js_ns, NULL);
+}
+
+/*! Create element from member name, split into module name and name as in RFC 7951
+ *
+ * @param[in]  js    Scanner
+ * @param[in]  xp    Parent, or NULL
+ * @param[in]  name  Member name, [<module>:]<name>
+ * @param[out] xn    Created element
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+jscan_node(struct json_scan *js,
+           cxobj            *xp,
+           char             *name,
+           cxobj           **xn)
+{
+    clixon_json_yacc *jy = js->js_jy;
+    cxobj            *x;
+    char             *id;
+
+    if ((id = strchr(name, ':')) != NULL)
+        *id = '\0';
+    x = xml_new(id?id+1:name, xp, CX_ELMNT);
+    if (x != NULL && id && xml_prefix_set(x, name) < 0)
+        x = NULL;
+    if (id)
+        *id = ':';
+    if (x == NULL)
+        return -1;
+    /* If topmost, add to top-list created list */
+    if (xp == jy->jy_xtop){
+        if (cxvec_append(x, &jy->jy_xvec, &jy->jy_xlen) < 0)
+            return -1;
+        /* RFC 7951 Section 4, checked before the module name is translated */
+        if (jy->jy_rfc7951 && jy->jy_unqualified == NULL && id == NULL &&
+            (jy->jy_yb != YB_NONE || strcmp(name, DATASTORE_TOP_SYMBOL) != 0))
+            jy->jy_unqualified = x;
+    }
+    if (id && xp && jscan_translate(js, x) < 0)
+        return -1;
+    *xn = x;
+    return 0;
+}
+
+/*! Create body of element
+ *
+ * @param[in]  xp     Element, or NULL
+ * @param[in]  value  Value, or NULL for JSON null
+ */
+static int
+jscan_body(cxobj *xp,
+           char  *value)
+{
+    cxobj *xb;
+
+    if (xp == NULL)
+        return 0;
+    if ((xb = xml_new("body", xp, CX_BODY)) == NULL)
+        return -1;
+    if (value && xml_value_append(xb, value) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Scan string after '"' and decode it into the string buffer
+ */
+static int
+jscan_string(struct json_scan *js)
+{
+    char   *p;
+    size_t  len;
+    char    hex[5];
+    char    utf[5];
+    char    c;
+
+    cbuf_reset(js->js_cb);
+    for (;;){
+        p = js->js_p;
+        len = strcspn(p, "\"\\\b\f\n\r\t");
+        if (len && cbuf_append_buf(js->js_cb, p, len) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            return -1;
+        }
+        js->js_p += len;
+        if (*js->js_p == '"')
+            break;
+        if (*js->js_p != '\\')
+            return jscan_error(js, "syntax error");
+        js->js_p++;
+        switch (*js->js_p){
+        case '"': case '\\': case '/':
+            c = *js->js_p;
+            break;
+        case 'b':
+            c = '\b';
+            break;
+        case 'f':
+            c = '\f';
+            break;
+        case 'n':
+            c = '\n';
+            break;
+        case 'r':
+            c = '\r';
+            break;
+        case 't':
+            c = '\t';
+            break;
+        case 'u':
+            p = js->js_p + 1;
+            if (!jscan_hex(p[0]) || !jscan_hex(p[1]) || !jscan_hex(p[2]) || !jscan_hex(p[3]))
+                return jscan_error(js, "syntax error");
+            memcpy(hex, p, 4);
+            hex[4] = '\0';
+            if (clixon_unicode2utf8(hex, utf, sizeof(utf)) < 0)
+                return -1;
+            if (cbuf_append_str(js->js_cb, utf) < 0){
+                clicon_err(OE_UNIX, errno, "cbuf_append_str");
+                return -1;
+            }
+            js->js_p += 5;
+            continue;
+        default:
+            return jscan_error(js, "syntax error");
+        }
+        if (cbuf_append(js->js_cb, c) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append");
+            return -1;
+        }
+        js->js_p++;
+    }
+    js->js_p++;
+    return 0;
+}
+
+/*! Scan number as the lex parser: -?({integer}|{real}|{exp}), exp requires a sign
+ *
+ * @param[in]  js   Scanner, at '-' or digit or '.'
+ * @retval     len  Length of number
+ * @retval     0    Not a number
+ */
+static size_t
+jscan_number(struct json_scan *js)
+{
+    char  *p = js->js_p;
+    char  *p0;
+    int    digits = 0;
+
+    if (*p == '-')
+        p++;
+    for (; jscan_digit(*p); p++)
+        digits++;
+    if (*p == '.'){
+        p0 = p++;
+        for (; jscan_digit(*p); p++)
+            digits++;
+        if (digits == 0)
+            p = p0;
+    }
+    if (digits == 0)
+        return 0;
+    if ((p[0] == 'e' || p[0] == 'E') && (p[1] == '+' || p[1] == '-') && jscan_digit(p[2]))
+        for (p += 2; jscan_digit(*p); p++);
+    return p - js->js_p;
+}
+
+/*! Scan array after '['
+ *
+ * Each value after the first is added to a clone of the current element, a sibling with
+ * the same name
+ * @param[in]     js     Scanner
+ * @param[in,out] xp     Current element, changed to last clone
+ * @param[in]     name   Member name of current element, or NULL to use its XML name
+ * @param[in]     depth  Nesting depth
+ */
+static int
+jscan_array(struct json_scan *js,
+            cxobj           **xp,
+            char             *name,
+            int               depth)
+{
+    int    retval = -1;
+    cxobj *xparent;
+    cbuf  *cb = NULL;
+
+    jscan_skip(js);
+    if (*js->js_p == ']'){
+        js->js_p++;
+        return 0;
+    }
+    for (;;){
+        if (jscan_value(js, xp, name, depth) < 0)
+            goto done;
+        jscan_skip(js);
+        if (*js->js_p == ']'){
+            js->js_p++;
+            break;
+        }
+        if (*js->js_p != ','){
+            jscan_error(js, "syntax error");
+            goto done;
+        }
+        js->js_p++;
+        /* Clone current element, as json_current_clone */
+        if (*xp == NULL){
+            jscan_error(js, "YYERROR stack?");
+            goto done;
+        }
+        if ((xparent = xml_parent(*xp)) == NULL)
+            *xp = NULL;
+        else {
+            if (name == NULL){
+                if ((cb = cbuf_new()) == NULL){
+                    clicon_err(OE_UNIX, errno, "cbuf_new");
+                    goto done;
+                }
+                if (xml_prefix(*xp))
+                    cprintf(cb, "%s:", xml_prefix(*xp));
+                cprintf(cb, "%s", xml_name(*xp));
+                name = cbuf_get(cb);
+            }
+            if (jscan_node(js, xparent, name, xp) < 0)
+                goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Scan object after '{', members are created as children of the current element
+ *
+ * @param[in]  js     Scanner
+ * @param[in]  xp     Current element, or NULL
+ * @param[in]  depth  Nesting depth
+ */
+static int
+jscan_object(struct json_scan *js,
+             cxobj            *xp,
+             int               depth)
+{
+    int    retval = -1;
+    cxobj *x;
+    cxobj *xorphan;
+    char  *name = NULL;
+
+    jscan_skip(js);
+    if (*js->js_p == '}'){
+        js->js_p++;
+        return 0;
+    }
+    for (;;){
+        if (*js->js_p != '"'){
+            jscan_error(js, "syntax error");
+            goto done;
+        }
+        js->js_p++;
+        if (jscan_string(js) < 0)
+            goto done;
+        jscan_skip(js);
+        if (*js->js_p != ':'){
+            jscan_error(js, "syntax error");
+            goto done;
+        }
+        js->js_p++;
+        jscan_skip(js);
+        /* Member name is needed for clones of an array value */
+        if (*js->js_p == '[' &&
+            (name = strdup(cbuf_get(js->js_cb))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        if (jscan_node(js, xp, cbuf_get(js->js_cb), &x) < 0)
+            goto done;
+        xorphan = xp ? NULL : x;
+        if (jscan_value(js, &x, name, depth) < 0){
+            if (xorphan)
+                xml_free(xorphan);
+            goto done;
+        }
+        if (xorphan)
+            xml_free(xorphan);
+        if (name){
+            free(name);
+            name = NULL;
+        }
+        jscan_skip(js);
+        if (*js->js_p == '}'){
+            js->js_p++;
+            break;
+        }
+        if (*js->js_p != ','){
+            jscan_error(js, "syntax error");
+            goto done;
+        }
+        js->js_p++;
+        jscan_skip(js);
+    }
+    retval = 0;
+ done:
+    if (name)
+        free(name);
+    return retval;
+}
+
+/*! Scan value into current element
+ *
+ * @param[in]     js     Scanner
+ * @param[in,out] xp     Current element, or NULL if value is not kept. Changed by arrays
+ * @param[in]     name   Member name of current element, or NULL
+ * @param[in]     depth  Nesting depth
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+jscan_value(struct json_scan *js,
+            cxobj           **xp,
+            char             *name,
+            int               depth)
+{
+    char   *p;
+    size_t  len;
+
+    jscan_skip(js);
+    p = js->js_p;
+    switch (*p){
+    case '{':
+    case '[':
+        if (depth >= JSON_SCAN_DEPTH_MAX)
+            return jscan_error(js, "memory exhausted");
+        js->js_p++;
+        if (*p == '{')
+            return jscan_object(js, *xp, depth+1);
+        return jscan_array(js, xp, name, depth+1);
+    case '"':
+        js->js_p++;
+        if (jscan_string(js) < 0)
+            return -1;
+        return jscan_body(*xp, cbuf_get(js->js_cb));
+    case 't':
+        if (strncmp(p, "true", 4) != 0)
+            break;
+        js->js_p += 4;
+        return jscan_body(*xp, "true");
+    case 'f':
+        if (strncmp(p, "false", 5) != 0)
+            break;
+        js->js_p += 5;
+        return jscan_body(*xp, "false");
+    case 'n':
+        if (strncmp(p, "null", 4) != 0)
+            break;
+        js->js_p += 4;
+        return jscan_body(*xp, NULL);
+    default:
+        if ((len = jscan_number(js)) == 0)
+            break;
+        /* Input may be constant, copy number to terminate it */
+        cbuf_reset(js->js_cb);
+        if (cbuf_append_buf(js->js_cb, p, len) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            return -1;
+        }
+        js->js_p += len;
+        return jscan_body(*xp, cbuf_get(js->js_cb));
+    }
+    return jscan_error(js, "syntax error");
+}
+
+/*! Scan JSON string into the top element of a parser struct
+ *
+ * Same interface as the lex/yacc parser: created top-level elements are added to jy_xvec.
+ * If jy_yspec is set, module names are translated to namespaces and jy_translated is set
+ * if all were found. If jy_rfc7951 is set, jy_unqualified is set to the first top-level
+ * element without module name, see _json_parse.
+ * @param[in]  jy   JSON parser struct
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon_json_parseparse
+ */
+int
+clixon_json_scan(clixon_json_yacc *jy)
+{
+    int              retval = -1;
+    struct json_scan js = {0,};
+    cxobj           *x = jy->jy_xtop;
+
+    js.js_jy = jy;
+    js.js_str = js.js_p = jy->jy_parse_string;
+    jy->jy_translated = 1;
+    if ((js.js_cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (jscan_value(&js, &x, NULL, 0) < 0)
+        goto done;
+    jscan_skip(&js);
+    if (*js.js_p != '\0'){
+        jscan_error(&js, "syntax error");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (js.js_modname)
+        free(js.js_modname);
+    if (js.js_cb)
+        cbuf_free(js.js_cb);
+    return retval;
+}
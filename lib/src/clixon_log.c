@@ -35,6 +35,11 @@
 
  *
  * Regular logging and debugging. Syslog using levels.
+ * With asynchronous logging, see clicon_log_async, messages are put in a ring of fixed
+ * size and written by a background thread, so that a blocking syslog does not block the
+ * caller. Messages that do not fit in the ring are dropped and counted.
+ * Errors of a call site of clicon_err may in addition be rate limited,
+ * see clicon_log_rate_limit_set
  */
 
 #ifdef HAVE_CONFIG_H
@@ -44,6 +49,8 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <syslog.h>
@@ -52,6 +59,9 @@
 #include <errno.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -60,6 +70,9 @@
 #include "clixon_err.h"
 #include "clixon_log.h"
 
+/* clicon_debug is a macro checking the debug level, the function is defined here */
+#undef clicon_debug
+
 /* The global debug level. 0 means no debug 
  * @note There are pros and cons in having the debug state as a global variable. The 
  * alternative to bind it to the clicon handle (h) was considered but it limits its
@@ -76,6 +89,55 @@ static FILE *_logfile = NULL;
 /* Truncate debug strings to this length. 0 means unlimited */
 static int _clixon_log_trunc = 0;
 
+/* Max log messages per second of a call site, 0 means unlimited */
+static int _clixon_log_rate = 0;
+
+/* Number of messages dropped by rate limit or full log ring */
+static uint64_t _clixon_log_dropped = 0;
+
+/*! Rate limit state of a call site, in a table hashed on function and line
+ */
+struct log_site{
+    const char *ls_fn;         /* Function name of call site */
+    int         ls_line;       /* Line of call site */
+    time_t      ls_sec;        /* Current one-second window */
+    int         ls_count;      /* Messages in window */
+    int         ls_suppressed; /* Suppressed messages in window */
+};
+
+static struct log_site _log_sites[LOG_RATE_SITES] = {{0,}};
+
+#ifdef HAVE_LIBPTHREAD
+static pthread_mutex_t _log_site_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*! A message in the log ring
+ */
+struct log_entry{
+    int            le_level;   /* Log level */
+    struct timeval le_tv;      /* Time of log call */
+    char          *le_msg;     /* Message, malloced */
+};
+
+/*! Log ring of asynchronous logging, one per process
+ * The fields below lr_mutex are protected by it
+ */
+struct log_ring{
+    int              lr_enabled;  /* Asynchronous logging enabled */
+    int              lr_atfork;   /* Fork handlers registered */
+    pthread_mutex_t  lr_mutex;
+    pthread_cond_t   lr_cond;     /* Signalled on new message or exit */
+    int              lr_running;  /* Writer thread started in this process */
+    pthread_t        lr_tid;      /* Writer thread */
+    struct log_entry lr_vec[LOG_ASYNC_SLOTS];
+    int              lr_head;     /* Oldest message */
+    int              lr_len;      /* Number of messages in ring */
+    int              lr_exit;     /* Writer thread should exit when ring is empty */
+    uint64_t         lr_dropped;  /* Dropped since last reported by writer */
+};
+
+static struct log_ring _lr = {0, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, };
+#endif /* HAVE_LIBPTHREAD */
+
 /*! Initialize system logger.
  *
  * Make syslog(3) calls with specified ident and gates calls of level upto specified level (upto).
@@ -109,6 +171,7 @@ clicon_log_init(char         *ident,
 int
 clicon_log_exit(void)
 {
+    clicon_log_async(0); /* Flush log ring */
     if (_logfile)
         fclose(_logfile);
     closelog(); /* optional */
@@ -188,16 +251,89 @@ clicon_log_string_limit_get(void)
     return _clixon_log_trunc;
 }
 
+/*! Set max log messages per second of a call site
+ *
+ * Applies to clicon_err. Suppressed messages are counted and reported with the next
+ * message of the call site
+ * @param[in]  rate  Messages per second, 0 means unlimited
+ */
+int
+clicon_log_rate_limit_set(int rate)
+{
+    _clixon_log_rate = rate;
+    return 0;
+}
+
+/*! Get number of log messages dropped by rate limit or full log ring
+ */
+uint64_t
+clicon_log_dropped(void)
+{
+    return _clixon_log_dropped;
+}
+
+/*! Check rate limit of a call site
+ *
+ * @param[in]  fn    Function name of call site
+ * @param[in]  line  Line of call site
+ * @retval     1     Log the message
+ * @retval     0     Rate limit exceeded, drop the message
+ * @see clicon_log_rate_limit_set
+ */
+int
+clicon_log_rate_check(const char *fn,
+                      int         line)
+{
+    struct log_site *ls;
+    struct timespec  ts;
+    int              suppressed = 0;
+    int              ok = 1;
+
+    if (_clixon_log_rate == 0 || fn == NULL)
+        return 1;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#ifdef HAVE_LIBPTHREAD
+    pthread_mutex_lock(&_log_site_mutex);
+#endif
+    ls = &_log_sites[((uintptr_t)fn + line) % LOG_RATE_SITES];
+    if (ls->ls_fn != fn || ls->ls_line != line){
+        memset(ls, 0, sizeof(*ls));
+        ls->ls_fn = fn;
+        ls->ls_line = line;
+        ls->ls_sec = ts.tv_sec;
+    }
+    else if (ls->ls_sec != ts.tv_sec){
+        suppressed = ls->ls_suppressed;
+        ls->ls_sec = ts.tv_sec;
+        ls->ls_count = 0;
+        ls->ls_suppressed = 0;
+    }
+    if (ls->ls_count++ >= _clixon_log_rate){
+        ls->ls_suppressed++;
+        _clixon_log_dropped++;
+        ok = 0;
+    }
+#ifdef HAVE_LIBPTHREAD
+    pthread_mutex_unlock(&_log_site_mutex);
+#endif
+    if (suppressed)
+        clicon_log(LOG_WARNING, "%s: %d: %d messages suppressed by rate limit",
+                   fn, line, suppressed);
+    return ok;
+}
+
 /*! Mimic syslog and print a time on file f
+ *
+ * @param[in]  f   File
+ * @param[in]  tv  Time of log call
  */
 static int
-flogtime(FILE *f)
+flogtime(FILE           *f,
+         struct timeval *tv)
 {
-    struct timeval tv;
     struct tm tm;
 
-    gettimeofday(&tv, NULL);
-    localtime_r((time_t*)&tv.tv_sec, &tm);
+    localtime_r((time_t*)&tv->tv_sec, &tm);
     fprintf(f, "%s %2d %02d:%02d:%02d: ", 
             mon2name(tm.tm_mon), tm.tm_mday,
             tm.tm_hour, tm.tm_min, tm.tm_sec);
@@ -230,17 +366,19 @@ slogtime(void)
 }
 #endif
 
-/*! Make a logging call to syslog (or stderr).
+/*! Write a log message to syslog (or stderr).
  *
+ * This is the _only_ place the actual syslog (or stderr) logging is made in clicon,..
+ * Called by clicon_log_str, or by the writer thread of asynchronous logging
  * @param[in]   level log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG. Thisis OR:d with facility == LOG_USER
+ * @param[in]   tv    Time of log call
  * @param[in]   msg   Message to print as argv.
- * This is the _only_ place the actual syslog (or stderr) logging is made in clicon,..
  * @note syslog makes its own filtering, but if log to stderr we do it here
- * @see  clicon_debug
  */
-int
-clicon_log_str(int           level, 
-               char         *msg)
+static int
+clicon_log_write(int             level,
+                 struct timeval *tv,
+                 const char     *msg)
 {
     if (_logflags & CLICON_LOG_SYSLOG)
         syslog(LOG_MAKEPRI(LOG_USER, level), "%s", msg); // XXX this may block
@@ -250,15 +388,15 @@ clicon_log_str(int           level,
     if (_clixon_debug == 0 && level >= LOG_DEBUG)
         goto done;
     if (_logflags & CLICON_LOG_STDERR){
-        flogtime(stderr);
+        flogtime(stderr, tv);
         fprintf(stderr, "%s\n", msg);
     }
     if (_logflags & CLICON_LOG_STDOUT){
-        flogtime(stdout);
+        flogtime(stdout, tv);
         fprintf(stdout, "%s\n", msg);
     }
     if ((_logflags & CLICON_LOG_FILE) && _logfile){
-        flogtime(_logfile);
+        flogtime(_logfile, tv);
         fprintf(_logfile, "%s\n", msg);
         fflush(_logfile);
     }
@@ -269,6 +407,198 @@ clicon_log_str(int           level,
     return 0;
 }
 
+#ifdef HAVE_LIBPTHREAD
+/*! Writer thread of asynchronous logging, write messages in order until told to exit
+ */
+static void *
+log_ring_thread(void *arg)
+{
+    struct log_ring *lr = (struct log_ring *)arg;
+    struct log_entry le;
+    uint64_t         dropped;
+    char             buf[64];
+
+    pthread_mutex_lock(&lr->lr_mutex);
+    while (1){
+        while (lr->lr_len == 0 && !lr->lr_exit)
+            pthread_cond_wait(&lr->lr_cond, &lr->lr_mutex);
+        if (lr->lr_len == 0)
+            break;
+        le = lr->lr_vec[lr->lr_head];
+        lr->lr_head = (lr->lr_head + 1) % LOG_ASYNC_SLOTS;
+        lr->lr_len--;
+        dropped = lr->lr_dropped;
+        lr->lr_dropped = 0;
+        pthread_mutex_unlock(&lr->lr_mutex);
+        clicon_log_write(le.le_level, &le.le_tv, le.le_msg);
+        free(le.le_msg);
+        if (dropped){
+            snprintf(buf, sizeof(buf), "%" PRIu64 " log messages dropped", dropped);
+            clicon_log_write(LOG_WARNING, &le.le_tv, buf);
+        }
+        pthread_mutex_lock(&lr->lr_mutex);
+    }
+    pthread_mutex_unlock(&lr->lr_mutex);
+    return NULL;
+}
+
+/*! Put a message in the log ring, start writer thread if not started in this process
+ *
+ * @param[in]   level log level
+ * @param[in]   tv    Time of log call
+ * @param[in]   msg   Message, copied
+ * @retval      1     Message is put in ring, or dropped if ring is full
+ * @retval      0     Not put in ring, the caller writes it
+ */
+static int
+log_ring_put(int             level,
+             struct timeval *tv,
+             const char     *msg)
+{
+    struct log_ring  *lr = &_lr;
+    struct log_entry *le;
+    char             *str;
+
+    if ((str = strdup(msg)) == NULL)
+        return 0;
+    pthread_mutex_lock(&lr->lr_mutex);
+    if (!lr->lr_running){
+        lr->lr_exit = 0;
+        if (pthread_create(&lr->lr_tid, NULL, log_ring_thread, lr) != 0){
+            pthread_mutex_unlock(&lr->lr_mutex);
+            free(str);
+            return 0;
+        }
+        lr->lr_running = 1;
+    }
+    if (lr->lr_len == LOG_ASYNC_SLOTS){
+        lr->lr_dropped++;
+        _clixon_log_dropped++;
+        pthread_mutex_unlock(&lr->lr_mutex);
+        free(str);
+        return 1;
+    }
+    le = &lr->lr_vec[(lr->lr_head + lr->lr_len) % LOG_ASYNC_SLOTS];
+    le->le_level = level;
+    le->le_tv = *tv;
+    le->le_msg = str;
+    lr->lr_len++;
+    pthread_cond_signal(&lr->lr_cond);
+    pthread_mutex_unlock(&lr->lr_mutex);
+    return 1;
+}
+
+/*! Fork handlers: the writer thread does not survive fork
+ *
+ * The ring is locked during fork. Messages of the parent are left to the parent, and
+ * the child starts its own writer at its first message
+ */
+static void
+log_ring_prepare(void)
+{
+    pthread_mutex_lock(&_log_site_mutex);
+    pthread_mutex_lock(&_lr.lr_mutex);
+}
+
+static void
+log_ring_parent(void)
+{
+    pthread_mutex_unlock(&_lr.lr_mutex);
+    pthread_mutex_unlock(&_log_site_mutex);
+}
+
+static void
+log_ring_child(void)
+{
+    struct log_ring *lr = &_lr;
+
+    while (lr->lr_len > 0){
+        free(lr->lr_vec[lr->lr_head].le_msg);
+        lr->lr_head = (lr->lr_head + 1) % LOG_ASYNC_SLOTS;
+        lr->lr_len--;
+    }
+    lr->lr_running = 0;
+    lr->lr_dropped = 0;
+    pthread_mutex_init(&lr->lr_mutex, NULL);
+    pthread_cond_init(&lr->lr_cond, NULL);
+    pthread_mutex_init(&_log_site_mutex, NULL);
+}
+#endif /* HAVE_LIBPTHREAD */
+
+/*! Enable or disable asynchronous logging
+ *
+ * If enabled, messages are written by a background thread, started at the first message.
+ * If disabled, queued messages are written before return.
+ * @param[in]   enable  1: enable, 0: disable
+ * @retval      0       OK
+ * @retval     -1       Error, not supported without threads
+ * @note Messages that are queued when the process exits without clicon_log_exit are lost
+ */
+int
+clicon_log_async(int enable)
+{
+#ifdef HAVE_LIBPTHREAD
+    struct log_ring *lr = &_lr;
+    int              running;
+
+    if (enable){
+        if (!lr->lr_atfork){
+            if (pthread_atfork(log_ring_prepare, log_ring_parent, log_ring_child) != 0){
+                fprintf(stderr, "pthread_atfork: %s\n", strerror(errno)); /* dont use clicon_err here due to recursion */
+                return -1;
+            }
+            lr->lr_atfork = 1;
+        }
+        lr->lr_enabled = 1;
+        return 0;
+    }
+    if (!lr->lr_enabled)
+        return 0;
+    lr->lr_enabled = 0;
+    pthread_mutex_lock(&lr->lr_mutex);
+    if ((running = lr->lr_running) != 0){
+        lr->lr_exit = 1;
+        pthread_cond_signal(&lr->lr_cond);
+    }
+    pthread_mutex_unlock(&lr->lr_mutex);
+    if (running){
+        pthread_join(lr->lr_tid, NULL);
+        lr->lr_running = 0;
+    }
+    return 0;
+#else
+    if (enable){
+        fprintf(stderr, "%s: asynchronous logging requires threads\n", __FUNCTION__);
+        return -1;
+    }
+    return 0;
+#endif
+}
+
+/*! Make a logging call to syslog (or stderr).
+ *
+ * @param[in]   level log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG. Thisis OR:d with facility == LOG_USER
+ * @param[in]   msg   Message to print as argv.
+ * @see  clicon_debug
+ * @see  clicon_log_async  Written by a background thread
+ */
+int
+clicon_log_str(int           level, 
+               char         *msg)
+{
+    struct timeval tv;
+
+    /* Drop logs of other threads, see clicon_err_thread */
+    if (!clicon_err_thread_owner())
+        return 0;
+    gettimeofday(&tv, NULL);
+#ifdef HAVE_LIBPTHREAD
+    if (_lr.lr_enabled && log_ring_put(level, &tv, msg) == 1)
+        return 0;
+#endif
+    return clicon_log_write(level, &tv, msg);
+}
+
 /*! Make a logging call to syslog using variable arg syntax.
  *
  * @param[in]   level    log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG. This 
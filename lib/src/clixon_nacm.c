@@ -73,11 +73,9 @@
 #include "clixon_xml_map.h"
 #include "clixon_path.h"
 #include "clixon_xml_vec.h"
+#include "clixon_yang_schema_mount.h"
 #include "clixon_nacm.h"
 
-/* NACM namespace for use with xml namespace contexts and xpath */
-#define NACM_NS "urn:ietf:params:xml:ns:yang:ietf-netconf-acm"
-
 /*! Match nacm access operations according to RFC8341 3.4.4.  
  * Incoming RPC Message Validation Step 7 (c)
  *  The rule's "access-operations" leaf has the "exec" bit set or
@@ -315,6 +313,7 @@ nacm_rpc(char         *rpc,
 struct prepvec{
     qelem_t       pv_q;
     cxobj        *pv_xrule;
+    yang_stmt    *pv_yang;     /* Schema node of path without keys, match on xml_spec */
     clixon_xvec  *pv_xpathvec;
 };
 typedef struct prepvec prepvec;
@@ -353,45 +352,265 @@ prepvec_add(prepvec  **pv_listp,
     return pv;
 }
 
-/*! Prepare datastructures before running through XML tree
- * Save rules in a "cache"
- * These rules match:
- *  - user/group
- *  - have read access-op, etc
- * Also make instance-id lookups on top object for each rule. Assume at most one result
+/*---------------------------------------------------------------
+ * Compiled NACM ruleset
+ */
+
+/* Access operation bits of compiled rule, see match_access */
+#define NACM_RULE_READ   0x01
+#define NACM_RULE_CREATE 0x02
+#define NACM_RULE_UPDATE 0x04
+#define NACM_RULE_DELETE 0x08
+
+/* Max number of cached compiled rulesets (users), oldest is evicted */
+#define NACM_RULESET_MAX 32
+
+/* Handle data name of compiled NACM ruleset list */
+#define NACM_RULESET_NAME "nacm-ruleset"
+
+/* Initial number of buckets of schema node read decisions of a ruleset, power of 2 */
+#define NACM_SCHEMA_START 256
+
+/*! Compiled data-node rule of a user, in rule-list and rule order
+ */
+struct nacm_crule{
+    cxobj     *cr_xrule; /* Rule in copy of NACM tree of ruleset */
+    int        cr_ops;   /* Access operation bits, NACM_RULE_* */
+    char      *cr_path;  /* Trimmed path, or NULL if rule has no path */
+    yang_stmt *cr_yang;  /* Schema node of path if path has no keys, else NULL */
+    yang_stmt *cr_ytarget; /* Schema node of path, also if path has keys */
+};
+
+/* Read decision of a schema node, for all its data nodes */
+enum nacm_schema_decision{
+    NACM_SCHEMA_NOMATCH, /* No read rule matches */
+    NACM_SCHEMA_PERMIT,  /* First matching read rule permits */
+    NACM_SCHEMA_DENY,    /* First matching read rule denies */
+    NACM_SCHEMA_DATA,    /* A rule with keys may match, check data node */
+};
+
+/*! Read decision of a schema node and of its schema descendants
+ *
+ * Computed first time a data node of the schema node is read, see nacm_schema_get
+ */
+struct nacm_schema{
+    struct nacm_schema       *ns_next;
+    yang_stmt                *ns_yang;
+    enum nacm_schema_decision ns_decision;
+    int                       ns_subdeny;   /* A descendant may be denied or needs data check */
+    int                       ns_subpermit; /* A descendant may be permitted */
+};
+
+/*! Compiled data-node rules of a user
+ *
+ * Compiled from a NACM tree and yang spec, and valid as long as the NACM tree of a request
+ * has the same content as rs_xnacm. Immutable once created.
+ */
+struct nacm_ruleset{
+    struct nacm_ruleset *rs_next;
+    char                *rs_username;
+    yang_stmt           *rs_yspec;
+    cxobj               *rs_xnacm;  /* Copy of NACM tree the ruleset is compiled from */
+    size_t               rs_glen;   /* Number of groups of user */
+    struct nacm_crule   *rs_vec;    /* Rules of rule-lists of the groups of user */
+    size_t               rs_len;
+    struct nacm_schema **rs_schemavec; /* Hash buckets of schema read decisions */
+    size_t               rs_schemalen; /* Number of buckets, power of 2 */
+    size_t               rs_schemanr;  /* Number of schema read decisions */
+};
+
+/*! Free a compiled NACM ruleset
+ */
+static void
+nacm_ruleset_free1(struct nacm_ruleset *rs)
+{
+    struct nacm_schema *ns;
+    size_t              i;
+
+    if (rs->rs_schemavec){
+        for (i=0; i<rs->rs_schemalen; i++)
+            while ((ns = rs->rs_schemavec[i]) != NULL){
+                rs->rs_schemavec[i] = ns->ns_next;
+                free(ns);
+            }
+        free(rs->rs_schemavec);
+    }
+    if (rs->rs_vec){
+        for (i=0; i<rs->rs_len; i++)
+            if (rs->rs_vec[i].cr_path)
+                free(rs->rs_vec[i].cr_path);
+        free(rs->rs_vec);
+    }
+    if (rs->rs_xnacm)
+        xml_free(rs->rs_xnacm);
+    if (rs->rs_username)
+        free(rs->rs_username);
+    free(rs);
+}
+
+/*! Free all cached compiled NACM rulesets
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+nacm_ruleset_free(clicon_handle h)
+{
+    struct nacm_ruleset *rs = NULL;
+    struct nacm_ruleset *rs1;
+
+    if (clicon_ptr_get(h, NACM_RULESET_NAME, (void**)&rs) < 0 || rs == NULL)
+        return 0;
+    clicon_ptr_del(h, NACM_RULESET_NAME);
+    while ((rs1 = rs) != NULL){
+        rs = rs1->rs_next;
+        nacm_ruleset_free1(rs1);
+    }
+    return 0;
+}
+
+/*! Compare two NACM trees: names, bodies and order of all elements
+ *
+ * Yang-less compare since the NACM tree of external mode is not necessarily bound
+ * @retval  1  Equal
+ * @retval  0  Not equal
  */
 static int
-nacm_datanode_prepare(clicon_handle     h,
-                      cxobj            *xt,
-                      enum nacm_access  access,
-                      cxobj           **gvec,
-                      size_t            glen,
-                      cxobj           **rlistvec,
-                      size_t            rlistlen,
-                      cvec             *nsc,
-                      prepvec         **pv_listp)
+nacm_tree_equal(cxobj *x0,
+                cxobj *x1)
 {
-    int        retval = -1;
-    cxobj     *rlist;
-    int        i;
-    int        j;
-    int        k;
-    char      *gname;
-    cxobj    **rvec = NULL; /* rules */
-    size_t     rlen;    
-    cxobj     *xrule;
-    cxobj     *pathobj;
-    char      *access_operations;
-    char      *path0;         /* Non-canonical path */
-    char      *path=NULL;     /* Canonical path */
-    cvec      *nsc0 = NULL;   /* Non-canonical namespace context */
-    yang_stmt *yspec;
-    cxobj   **xvec = NULL;
-    int       xlen = 0;
-    int       ret;
-    prepvec *pv;
+    cxobj *x0c = NULL;
+    cxobj *x1c = NULL;
+    char  *b0;
+    char  *b1;
 
-    yspec = clicon_dbspec_yang(h);
+    if (strcmp(xml_name(x0), xml_name(x1)) != 0)
+        return 0;
+    b0 = xml_body(x0);
+    b1 = xml_body(x1);
+    if ((b0 == NULL) != (b1 == NULL) ||
+        (b0 && strcmp(b0, b1) != 0))
+        return 0;
+    for (;;){
+        x0c = xml_child_each(x0, x0c, CX_ELMNT);
+        x1c = xml_child_each(x1, x1c, CX_ELMNT);
+        if (x0c == NULL || x1c == NULL)
+            break;
+        if (!nacm_tree_equal(x0c, x1c))
+            return 0;
+    }
+    return x0c == NULL && x1c == NULL;
+}
+
+/*! Compile rule path: trim and resolve schema node if path has no keys
+ *
+ * @param[in]  yspec  YANG spec
+ * @param[in]  cr     Compiled rule
+ * @param[in]  path0  Rule path
+ * @retval     1      OK
+ * @retval     0      Path does not resolve, rule never matches
+ * @retval    -1      Error
+ */
+static int
+nacm_crule_path(yang_stmt         *yspec,
+                struct nacm_crule *cr,
+                char              *path0)
+{
+    int          retval = -1;
+    clixon_path *cplist = NULL;
+    clixon_path *cp;
+    yang_stmt   *y = NULL;
+    int          ret;
+
+    if ((cr->cr_path = strdup(clixon_trim2(path0, " \t\n"))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((ret = clixon_instance_id_parse(yspec, &cplist, NULL, "%s", cr->cr_path)) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_err_reset();
+        goto fail;
+    }
+    if ((cp = cplist) != NULL){
+        do {
+            if (cp->cp_cvk != NULL && cvec_len(cp->cp_cvk) > 0){
+                y = NULL; /* Keys: match with instance-id lookup per request */
+                break;
+            }
+            y = cp->cp_yang;
+            cp = NEXTQ(clixon_path *, cp);
+        } while (cp && cp != cplist);
+        cr->cr_ytarget = PREVQ(clixon_path *, cplist)->cp_yang;
+    }
+    cr->cr_yang = y;
+    retval = 1;
+ done:
+    if (cplist)
+        clixon_path_free(cplist);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Compile the data-node rules of a user from a NACM tree
+ *
+ * The rules are those of the rule-lists of the groups of the user, in order.
+ * Rules with rpc-name or notification-name and no path are not data-node rules and skipped.
+ * @param[in]  yspec    YANG spec
+ * @param[in]  xnacm    NACM XML tree, copied
+ * @param[in]  username User name
+ * @param[in]  nsc      NACM namespace context
+ * @param[out] rsp      Compiled ruleset, free with nacm_ruleset_free1
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+nacm_ruleset_compile(yang_stmt            *yspec,
+                     cxobj                *xnacm,
+                     char                 *username,
+                     cvec                 *nsc,
+                     struct nacm_ruleset **rsp)
+{
+    int                  retval = -1;
+    struct nacm_ruleset *rs = NULL;
+    struct nacm_crule   *cr;
+    cxobj              **gvec = NULL; /* groups */
+    size_t               glen;
+    cxobj              **rlistvec = NULL; /* rule-list */
+    size_t               rlistlen;
+    cxobj              **rvec = NULL; /* rules */
+    size_t               rlen;
+    cxobj               *rlist;
+    cxobj               *xrule;
+    cxobj               *pathobj;
+    char                *gname;
+    char                *access_operations;
+    size_t               i;
+    size_t               j;
+    int                  ret;
+
+    if ((rs = malloc(sizeof(*rs))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(rs, 0, sizeof(*rs));
+    rs->rs_yspec = yspec;
+    if ((rs->rs_username = strdup(username)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((rs->rs_xnacm = xml_dup(xnacm)) == NULL)
+        goto done;
+    /* User's group */
+    if (xpath_vec(rs->rs_xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+        goto done;
+    rs->rs_glen = glen;
+    if (glen == 0)
+        goto ok;
+    if (xpath_vec(rs->rs_xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
+        goto done;
     for (i=0; i<rlistlen; i++){         /* Loop through rule list */
         rlist = rlistvec[i];
         /* Loop through user's group to find match in this rule-list */
@@ -402,124 +621,447 @@ nacm_datanode_prepare(clicon_handle     h,
         }
         if (j==glen) /* not found */
             continue;
-        /* 6. For each rule-list entry found, process all rules, in order,
-           until a rule that matches the requested access operation is
-           found. (see 6 sub rules in nacm_rule_datanode
-        */
         if (xpath_vec(rlist, nsc, "rule", &rvec, &rlen) < 0)
             goto done;
+        if (rlen &&
+            (cr = realloc(rs->rs_vec, (rs->rs_len+rlen)*sizeof(*cr))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        else if (rlen)
+            rs->rs_vec = cr;
         for (j=0; j<rlen; j++){ /* Loop through rules */
             xrule = rvec[j];
-            /* 6c) For a "read" access operation, the rule's "access-operations"
-               leaf has the "read" bit set or has the special value "*" */
+            cr = &rs->rs_vec[rs->rs_len];
+            memset(cr, 0, sizeof(*cr));
+            cr->cr_xrule = xrule;
+            /* 6c-f) Access operations, see nacm_datanode_prepare */
             access_operations = xml_find_body(xrule, "access-operations");
-            switch (access){
-            case NACM_READ: 
-                /* 6c) For a "read" access operation, the rule's "access-operations"
-                   leaf has the "read" bit set or has the special value "*" */
-                if (!match_access(access_operations, "read", NULL))
-                    continue;
-                break;
-            case NACM_CREATE:
-                /* 6d) For a "create" access operation, the rule's "access-operations" 
-                   leaf has the "create" bit set or has the special value "*". */
-                if (!match_access(access_operations, "create", "write"))
-                    continue;
-                break;
-            case NACM_DELETE:
-                /* 6e) For a "delete" access operation, the rule's "access-operations" 
-                   leaf has the "delete" bit set or has the  special value "*". */
-                if (!match_access(access_operations, "delete", "write"))
-                    continue;
-                break;
-            case NACM_UPDATE:
-                /* 6f) For an "update" access operation, the rule's "access-operations"
-                   leaf has the "update" bit set or has the special value "*". */ 
-                if (!match_access(access_operations, "update", "write"))
-                    continue;
-                break;
-            default:
-                clicon_err(OE_XML, EINVAL, "Access %d unupported (shouldnt happen)", access);
-                goto done;
-                break;
-            }
-            /*  6b) Either (1) the rule does not have a "rule-type" defined or
-                (2) the "rule-type" is "data-node" and the "path" matches the
-                requested data node, action node, or notification node. */    
+            if (match_access(access_operations, "read", NULL))
+                cr->cr_ops |= NACM_RULE_READ;
+            if (match_access(access_operations, "create", "write"))
+                cr->cr_ops |= NACM_RULE_CREATE;
+            if (match_access(access_operations, "update", "write"))
+                cr->cr_ops |= NACM_RULE_UPDATE;
+            if (match_access(access_operations, "delete", "write"))
+                cr->cr_ops |= NACM_RULE_DELETE;
+            if (cr->cr_ops == 0)
+                continue;
             if ((pathobj = xml_find_type(xrule, NULL, "path", CX_ELMNT)) == NULL){
                 if (xml_find_body(xrule, "rpc-name") || xml_find_body(xrule, "notification-name"))
                     continue;
-                /* Here a new xrule is found, add it */
-                if (prepvec_add(pv_listp, xrule) == NULL)
-                    goto done;
             }
-            else{
-                path0 = clixon_trim2(xml_body(pathobj), " \t\n");
-                /* Get canonical namespace context for nacm paths */
-                if ((path = strdup(path0)) == NULL){
-                    clicon_err(OE_UNIX, errno, "strdup");
+            else {
+                if ((ret = nacm_crule_path(yspec, cr, xml_body(pathobj))) < 0){
+                    rs->rs_len++; /* free path */
                     goto done;
                 }
-#if 0
-                /* See https://github.com/clicon/clixon/issues/129:
-                 * If this is enabled, you are back to the problem of JSON encodings
-                 */
-                /* Create namespace context for with nacm namespace as default */
-                if (xml_nsctx_node(pathobj, &nsc0) < 0)
-                    goto done;
-                /* instance-id requires canonical paths */
-                if (xpath2canonical(path0, nsc0, yspec, &path, NULL) < 0)
-                    goto done;
-#endif
-                if ((ret = clixon_xml_find_instance_id(xt, yspec, &xvec, &xlen, "%s", path)) < 0)
-                    goto done;
-                if (ret == 0)
+                if (ret == 0){
+                    free(cr->cr_path);
                     continue;
-                /* Here a new xrule is found, add it */
-                if ((pv = prepvec_add(pv_listp, xrule)) == NULL)
-                    goto done;
-                for (k=0; k<xlen; k++){
-                    if (clixon_xvec_append(pv->pv_xpathvec, xvec[k]) < 0)
-                        goto done;
-                }
-                if (xvec){
-                    free(xvec);
-                    xvec = NULL;
-                }
-                if (nsc0){
-                    cvec_free(nsc0);
-                    nsc0 = NULL;
-                }
-                if (path){
-                    free(path);
-                    path = NULL;
                 }
             }
+            rs->rs_len++;
         }
         if (rvec){
             free(rvec);
             rvec=NULL;
-        }       
+        }
+    }
+ ok:
+    *rsp = rs;
+    rs = NULL;
+    retval = 0;
+ done:
+    if (rs)
+        nacm_ruleset_free1(rs);
+    if (gvec)
+        free(gvec);
+    if (rlistvec)
+        free(rlistvec);
+    if (rvec)
+        free(rvec);
+    return retval;
+}
+
+/*! Check if a schema node is a data ancestor-or-self of another
+ *
+ * @param[in]  ya   Ancestor candidate
+ * @param[in]  y    Schema node
+ * @retval     1    ya is y or a data ancestor of y
+ * @retval     0    No
+ */
+static int
+nacm_schema_isancestor(yang_stmt *ya,
+                       yang_stmt *y)
+{
+    enum rfc_6020 keyw;
+
+    for (; y; y = yang_parent_get(y)){
+        keyw = yang_keyword_get(y);
+        if (keyw == Y_MODULE || keyw == Y_SUBMODULE || keyw == Y_SPEC)
+            break;
+        if (y == ya)
+            return 1;
+    }
+    return 0;
+}
+
+/*! Compute read decision of a schema node from the read rules of a ruleset
+ *
+ * The rules are evaluated in order as in nacm_data_read_xrule_xml, but on schema nodes.
+ * A rule without path or with a path without keys decides for all data nodes of y.
+ * A rule with keys whose schema node is y or an ancestor of y may match only some data
+ * nodes of y, and they have to be checked one by one.
+ * @param[in]  rs   Compiled ruleset
+ * @param[in]  y    Schema node
+ * @retval     dec  Read decision
+ */
+static enum nacm_schema_decision
+nacm_schema_decision(struct nacm_ruleset *rs,
+                     yang_stmt           *y)
+{
+    struct nacm_crule *cr;
+    yang_stmt         *ymod = NULL;
+    char              *ns;
+    char              *module_pattern;
+    char              *action;
+    size_t             i;
+
+    if ((ns = yang_find_mynamespace(y)) != NULL)
+        ymod = yang_find_module_by_namespace(rs->rs_yspec, ns);
+    for (i=0; i<rs->rs_len; i++){
+        cr = &rs->rs_vec[i];
+        if ((cr->cr_ops & NACM_RULE_READ) == 0)
+            continue;
+        if ((module_pattern = xml_find_body(cr->cr_xrule, "module-name")) == NULL)
+            continue;
+        if (strcmp(module_pattern, "*") != 0){
+            if (ymod == NULL)
+                return NACM_SCHEMA_DATA;
+            if (strcmp(yang_argument_get(ymod), module_pattern) != 0)
+                continue;
+        }
+        if (cr->cr_path != NULL && cr->cr_yang == NULL){ /* keys */
+            if (cr->cr_ytarget == NULL || nacm_schema_isancestor(cr->cr_ytarget, y))
+                return NACM_SCHEMA_DATA;
+            continue;
+        }
+        if (cr->cr_yang && !nacm_schema_isancestor(cr->cr_yang, y))
+            continue;
+        if ((action = xml_find_body(cr->cr_xrule, "action")) == NULL)
+            return NACM_SCHEMA_NOMATCH;
+        if (strcmp(action, "deny") == 0)
+            return NACM_SCHEMA_DENY;
+        if (strcmp(action, "permit") == 0)
+            return NACM_SCHEMA_PERMIT;
+        return NACM_SCHEMA_NOMATCH;
+    }
+    return NACM_SCHEMA_NOMATCH;
+}
+
+static int nacm_schema_get(struct nacm_ruleset *rs, yang_stmt *y, struct nacm_schema **nsp);
+
+/*! Accumulate read decisions of schema data children of y, through choice and case
+ *
+ * @param[in]  rs   Compiled ruleset
+ * @param[in]  y    Schema node
+ * @param[in]  ns   Read decision of ancestor, sub-fields are set
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+nacm_schema_children(struct nacm_ruleset *rs,
+                     yang_stmt           *y,
+                     struct nacm_schema  *ns)
+{
+    yang_stmt          *yc = NULL;
+    struct nacm_schema *nsc;
+
+    while ((yc = yn_each(y, yc)) != NULL){
+        switch (yang_keyword_get(yc)){
+        case Y_CHOICE:
+        case Y_CASE:
+            if (nacm_schema_children(rs, yc, ns) < 0)
+                return -1;
+            break;
+        case Y_CONTAINER:
+        case Y_LIST:
+        case Y_LEAF:
+        case Y_LEAF_LIST:
+        case Y_ANYDATA:
+        case Y_ANYXML:
+            if (nacm_schema_get(rs, yc, &nsc) < 0)
+                return -1;
+            if (nsc->ns_decision == NACM_SCHEMA_DENY ||
+                nsc->ns_decision == NACM_SCHEMA_DATA ||
+                nsc->ns_subdeny)
+                ns->ns_subdeny = 1;
+            if (nsc->ns_decision == NACM_SCHEMA_PERMIT ||
+                nsc->ns_decision == NACM_SCHEMA_DATA ||
+                nsc->ns_subpermit)
+                ns->ns_subpermit = 1;
+            break;
+        default:
+            break;
+        }
+    }
+    return 0;
+}
+
+/*! Get read decision of schema node, compute and cache it in the ruleset if not found
+ *
+ * @param[in]  rs   Compiled ruleset
+ * @param[in]  y    Schema node
+ * @param[out] nsp  Read decision, owned by ruleset
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+nacm_schema_get(struct nacm_ruleset *rs,
+                yang_stmt           *y,
+                struct nacm_schema **nsp)
+{
+    struct nacm_schema  *ns;
+    struct nacm_schema **vec;
+    size_t               len;
+    size_t               i;
+    int                  ret;
+
+    if (rs->rs_schemavec == NULL){
+        if ((rs->rs_schemavec = calloc(NACM_SCHEMA_START, sizeof(*vec))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        rs->rs_schemalen = NACM_SCHEMA_START;
+    }
+    i = ((uintptr_t)y >> 4) & (rs->rs_schemalen-1);
+    for (ns = rs->rs_schemavec[i]; ns; ns = ns->ns_next)
+        if (ns->ns_yang == y){
+            *nsp = ns;
+            return 0;
+        }
+    if (rs->rs_schemanr >= rs->rs_schemalen){
+        len = 2*rs->rs_schemalen;
+        if ((vec = calloc(len, sizeof(*vec))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        for (i=0; i<rs->rs_schemalen; i++)
+            while ((ns = rs->rs_schemavec[i]) != NULL){
+                rs->rs_schemavec[i] = ns->ns_next;
+                ns->ns_next = vec[((uintptr_t)ns->ns_yang >> 4) & (len-1)];
+                vec[((uintptr_t)ns->ns_yang >> 4) & (len-1)] = ns;
+            }
+        free(rs->rs_schemavec);
+        rs->rs_schemavec = vec;
+        rs->rs_schemalen = len;
+    }
+    if ((ns = malloc(sizeof(*ns))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memset(ns, 0, sizeof(*ns));
+    ns->ns_yang = y;
+    ns->ns_decision = nacm_schema_decision(rs, y);
+    i = ((uintptr_t)y >> 4) & (rs->rs_schemalen-1);
+    ns->ns_next = rs->rs_schemavec[i];
+    rs->rs_schemavec[i] = ns;
+    rs->rs_schemanr++;
+    /* Mounted schemas are not children of mount-point: check all data nodes below */
+    if ((ret = yang_schema_mount_point(y)) < 0)
+        return -1;
+    if (ret == 1){
+        ns->ns_subdeny = 1;
+        ns->ns_subpermit = 1;
+    }
+    else if (nacm_schema_children(rs, y, ns) < 0)
+        return -1;
+    *nsp = ns;
+    return 0;
+}
+
+/*! Get compiled ruleset of a user, compile and cache it if not found or if NACM has changed
+ *
+ * A cached ruleset is valid if it was compiled from a NACM tree equal to xnacm, ie until
+ * the NACM config is changed, for example in a commit.
+ * @param[in]  h        Clixon handle
+ * @param[in]  xnacm    NACM XML tree of request
+ * @param[in]  username User name
+ * @param[in]  nsc      NACM namespace context
+ * @param[out] rsp      Compiled ruleset, owned by the cache, do not free
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+nacm_ruleset_get(clicon_handle         h,
+                 cxobj                *xnacm,
+                 char                 *username,
+                 cvec                 *nsc,
+                 struct nacm_ruleset **rsp)
+{
+    struct nacm_ruleset  *rs0 = NULL;
+    struct nacm_ruleset **rsprev;
+    struct nacm_ruleset  *rs;
+    struct nacm_ruleset  *rs1;
+    yang_stmt            *yspec;
+    int                   n = 0;
+
+    yspec = clicon_dbspec_yang(h);
+    if (clicon_ptr_get(h, NACM_RULESET_NAME, (void**)&rs0) < 0)
+        rs0 = NULL;
+    rsprev = &rs0;
+    while ((rs = *rsprev) != NULL){
+        if (strcmp(rs->rs_username, username) == 0){
+            *rsprev = rs->rs_next; /* unlink */
+            if (rs->rs_yspec == yspec && nacm_tree_equal(rs->rs_xnacm, xnacm))
+                break;
+            nacm_ruleset_free1(rs); /* stale */
+            rs = NULL;
+            continue;
+        }
+        if (++n >= NACM_RULESET_MAX){ /* evict oldest */
+            while ((rs1 = rs->rs_next) != NULL){
+                rs->rs_next = rs1->rs_next;
+                nacm_ruleset_free1(rs1);
+            }
+        }
+        rsprev = &rs->rs_next;
+    }
+    if (rs == NULL){
+        clicon_debug(1, "%s compile ruleset of %s", __FUNCTION__, username);
+        if (nacm_ruleset_compile(yspec, xnacm, username, nsc, &rs) < 0){
+            clicon_ptr_set(h, NACM_RULESET_NAME, rs0);
+            return -1;
+        }
+    }
+    /* Most recently used first */
+    rs->rs_next = rs0;
+    if (clicon_ptr_set(h, NACM_RULESET_NAME, rs) < 0){
+        nacm_ruleset_free1(rs);
+        return -1;
+    }
+    *rsp = rs;
+    return 0;
+}
+
+/*! Prepare datastructures before running through XML tree
+ * Select the compiled rules of the user that match the access.
+ * Rules with keyed paths make instance-id lookups on top object. Assume at most one result
+ * @param[in]  xt       XML tree
+ * @param[in]  access   NACM access
+ * @param[in]  rs       Compiled ruleset of user
+ * @param[in]  yspec    YANG spec
+ * @param[out] pv_listp Rules matching access, free with prepvec_free
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+nacm_datanode_prepare(cxobj               *xt,
+                      enum nacm_access     access,
+                      struct nacm_ruleset *rs,
+                      yang_stmt           *yspec,
+                      prepvec            **pv_listp)
+{
+    int                retval = -1;
+    struct nacm_crule *cr;
+    int                op;
+    size_t             i;
+    int                k;
+    cxobj            **xvec = NULL;
+    int                xlen = 0;
+    int                ret;
+    prepvec           *pv;
+
+    switch (access){
+    case NACM_READ:
+        op = NACM_RULE_READ;
+        break;
+    case NACM_CREATE:
+        op = NACM_RULE_CREATE;
+        break;
+    case NACM_DELETE:
+        op = NACM_RULE_DELETE;
+        break;
+    case NACM_UPDATE:
+        op = NACM_RULE_UPDATE;
+        break;
+    default:
+        clicon_err(OE_XML, EINVAL, "Access %d unupported (shouldnt happen)", access);
+        goto done;
+        break;
+    }
+    for (i=0; i<rs->rs_len; i++){
+        cr = &rs->rs_vec[i];
+        if ((cr->cr_ops & op) == 0)
+            continue;
+        if (cr->cr_path == NULL || cr->cr_yang != NULL){
+            if ((pv = prepvec_add(pv_listp, cr->cr_xrule)) == NULL)
+                goto done;
+            pv->pv_yang = cr->cr_yang;
+            continue;
+        }
+        /* Path with keys */
+        if ((ret = clixon_xml_find_instance_id(xt, yspec, &xvec, &xlen, "%s", cr->cr_path)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        /* Here a new xrule is found, add it */
+        if ((pv = prepvec_add(pv_listp, cr->cr_xrule)) == NULL)
+            goto done;
+        for (k=0; k<xlen; k++){
+            if (clixon_xvec_append(pv->pv_xpathvec, xvec[k]) < 0)
+                goto done;
+        }
+        if (xvec){
+            free(xvec);
+            xvec = NULL;
+        }
     }
     retval = 0;
  done:
     if (xvec)
         free(xvec);
-    if (path)
-        free(path);
-    if (nsc0)
-        cvec_free(nsc0);
     return retval;
 }
 
+/*! Check if rule path matches requested node
+ *
+ * The path matches if the node or one of its ancestors is selected by the path
+ * @param[in]  xn   XML node (requested node)
+ * @param[in]  pv   Prepared rule with path
+ * @retval     1    Match
+ * @retval     0    No match
+ */
+static int
+nacm_datanode_path_match(cxobj   *xn,
+                         prepvec *pv)
+{
+    cxobj *xp;
+    int    i;
+
+    if (pv->pv_yang){
+        for (xp = xn; xp; xp = xml_parent(xp))
+            if (xml_spec(xp) == pv->pv_yang)
+                return 1;
+        return 0;
+    }
+    for (i=0; i<clixon_xvec_len(pv->pv_xpathvec); i++){
+        xp = clixon_xvec_i(pv->pv_xpathvec, i);
+        /* Check if ancestor is xp (for every xpathvec?) */
+        if (xn == xp || xml_isancestor(xn, xp))
+            return 1;
+    }
+    return 0;
+}
+
 /*---------------------------------------------------------------
  * Datanode write
  */
 
 /*! Match specific rule to specific requested node
  * @param[in]  xn       XML node (requested node)
- * @param[in]  xrule    NACM rule
- * @param[in]  xp       Xpath match
+ * @param[in]  pv       Prepared NACM rule
  * @param[in]  yspec    YANG spec
  * @retval -1  Error
  * @retval  0  OK and rule does not match
@@ -528,16 +1070,14 @@ nacm_datanode_prepare(clicon_handle     h,
  */
 static int
 nacm_data_write_xrule_xml(cxobj       *xn,
-                          cxobj       *xrule,
-                          clixon_xvec *xpathvec,
+                          prepvec     *pv,
                           yang_stmt   *yspec)
 {
     int        retval = -1;
+    cxobj     *xrule = pv->pv_xrule;
     yang_stmt *ymod;
     char      *module_pattern; /* rule module name */
     char      *action;
-    cxobj     *xp;
-    int        i;
 
     if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
         goto nomatch;
@@ -560,14 +1100,10 @@ nacm_data_write_xrule_xml(cxobj       *xn,
             goto deny;
         goto permit;
     }
-    for (i=0; i<clixon_xvec_len(xpathvec); i++){
-        xp = clixon_xvec_i(xpathvec, i);
-        /* Check if ancestor is xp (for every xpathvec?) */
-        if (xn == xp || xml_isancestor(xn, xp)){
-            if (strcmp(action, "deny")==0)
-                goto deny;
-            goto permit;
-        }
+    if (nacm_datanode_path_match(xn, pv)){
+        if (strcmp(action, "deny")==0)
+            goto deny;
+        goto permit;
     }
     goto nomatch;
  permit:
@@ -616,7 +1152,7 @@ nacm_datanode_write_recurse(clicon_handle h,
         do {
             /* return values: -1:Error /0:no match /1: deny /2: permit
              */
-            if ((ret = nacm_data_write_xrule_xml(xn, pv->pv_xrule, pv->pv_xpathvec, yspec)) < 0) 
+            if ((ret = nacm_data_write_xrule_xml(xn, pv, yspec)) < 0) 
                 goto done;
             switch(ret){
             case 0: /* No match, continue with next rule */
@@ -683,16 +1219,12 @@ nacm_datanode_write(clicon_handle    h,
                     cxobj           *xnacm,
                     cbuf            *cbret)
 {
-    int             retval = -1;
-    cxobj         **gvec = NULL; /* groups */
-    size_t          glen;
-    cxobj         **rlistvec = NULL; /* rule-list */
-    size_t          rlistlen;
-    cxobj         **rvec = NULL; /* rules */
-    char           *write_default = NULL;
-    cvec           *nsc = NULL;
-    int             ret;
-    prepvec        *pv_list = NULL;
+    int                  retval = -1;
+    char                *write_default = NULL;
+    cvec                *nsc = NULL;
+    int                  ret;
+    prepvec             *pv_list = NULL;
+    struct nacm_ruleset *rs = NULL;
 
     /* Create namespace context for with nacm namespace as default */
     if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
@@ -711,21 +1243,19 @@ nacm_datanode_write(clicon_handle    h,
        transport layer.)               */
     if (username == NULL)
         goto step9;
-    /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    /* User's groups and rule-lists, compiled once per NACM config */
+    if (nacm_ruleset_get(h, xnacm, username, nsc, &rs) < 0)
         goto done;
     /* 4. If no groups are found, continue with step 9. */
-    if (glen == 0)
+    if (rs->rs_glen == 0)
         goto step9;
     /* 5. Process all rule-list entries, in the order they appear in the
         configuration.  If a rule-list's "group" leaf-list does not
         match any of the user's groups, proceed to the next rule-list
-        entry. */
-    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
-        goto done;
-    /* First run through rules and cache rules as well as lookup objects in xt. 
+        entry. 
+       First select the rules of the access, and lookup keyed paths in xt.
      */
-    if (nacm_datanode_prepare(h, xt, access, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
+    if (nacm_datanode_prepare(xt, access, rs, clicon_dbspec_yang(h), &pv_list) < 0)
         goto done;
     /* Then recursivelyy traverse all requested nodes */
     if ((ret = nacm_datanode_write_recurse(h, xreq, pv_list,
@@ -764,12 +1294,6 @@ nacm_datanode_write(clicon_handle    h,
         prepvec_free(pv_list);
     if (nsc)
         xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
-    if (rlistvec)
-        free(rlistvec);
-    if (rvec)
-        free(rvec);
     return retval;
  deny: /* Here, cbret must contain a netconf error msg */
     assert(cbuf_len(cbret));
@@ -807,7 +1331,7 @@ nacm_data_read_action(cxobj *xrule,
 
 /*! Match specific rule to specific requested node
  * @param[in]  xn       XML node (requested node)
- * @param[in]  xrule    NACM rule
+ * @param[in]  pv       Prepared NACM rule
  * @param[in]  yspec    YANG spec
  * @retval -1  Error
  * @retval  0  OK and rule does not match
@@ -820,15 +1344,13 @@ nacm_data_read_action(cxobj *xrule,
  */
 static int
 nacm_data_read_xrule_xml(cxobj        *xn,
-                         cxobj        *xrule,
-                         clixon_xvec  *xpathvec,
+                         prepvec      *pv,
                          yang_stmt    *yspec)
 {
     int        retval = -1;
+    cxobj     *xrule = pv->pv_xrule;
     yang_stmt *ymod;
     char      *module_pattern; /* rule module name */
-    cxobj     *xp;
-    int        i;
     
     if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
         goto nomatch;
@@ -849,14 +1371,10 @@ nacm_data_read_xrule_xml(cxobj        *xn,
             goto done;
         goto match;
     }
-    for (i=0; i<clixon_xvec_len(xpathvec); i++){
-        xp = clixon_xvec_i(xpathvec, i);
-        /* Check if ancestor is xp (for every xpathvec?) */
-        if (xn == xp || xml_isancestor(xn, xp)){
-            if (nacm_data_read_action(xrule, xn) < 0)
-                goto done;
-            goto match;
-        }
+    if (nacm_datanode_path_match(xn, pv)){
+        if (nacm_data_read_action(xrule, xn) < 0)
+            goto done;
+        goto match;
     }
  nomatch:
     retval = 0;
@@ -868,34 +1386,51 @@ nacm_data_read_xrule_xml(cxobj        *xn,
 }
 
 /*! Recursive check for NACM read rules among all XML nodes
- * @param[in]  h        Clicon handle
- * @param[in]  xn       XML node (requested node)
- * @param[in]  rulevec  Precomputed rules that apply to this user group
- * @param[in]  xpathvec Precomputed xpath results that apply to this XML tree
- * @param[in]  yspec    YANG spec
+ *
+ * If the read decision of the schema node of xn does not depend on data, it is used
+ * instead of the rules. The children are not checked if no schema descendant of xn can
+ * be denied, or have a permit mark that matters for the read-default deny pruning.
+ * @param[in]  h         Clicon handle
+ * @param[in]  xn        XML node (requested node)
+ * @param[in]  pv_list   Precomputed rules that apply to this user group
+ * @param[in]  rs        Compiled ruleset of user
+ * @param[in]  defpermit 0 if read-default deny, 1 if permit
+ * @param[in]  marked    An ancestor of xn is marked as permitted
+ * @param[in]  yspec     YANG spec
  * @retval  0  OK
  * @retval -1  Error
  */
 static int
-nacm_datanode_read_recurse(clicon_handle h,
-                           cxobj        *xn,
-                           prepvec      *pv_list,
-                           yang_stmt    *yspec)
+nacm_datanode_read_recurse(clicon_handle        h,
+                           cxobj               *xn,
+                           prepvec             *pv_list,
+                           struct nacm_ruleset *rs,
+                           int                  defpermit,
+                           int                  marked,
+                           yang_stmt           *yspec)
 {
-    int      retval = -1;
-    cxobj   *x;
-    cxobj   *xprev;
-    int      ret;
-    prepvec *pv;
+    int                 retval = -1;
+    cxobj              *x;
+    cxobj              *xprev;
+    int                 ret;
+    prepvec            *pv;
+    yang_stmt          *y;
+    struct nacm_schema *ns = NULL;
     
-    if (xml_spec(xn)){ /* Check this node */
+    if ((y = xml_spec(xn)) != NULL){ /* Check this node */
+        if (ys_spec(y) == rs->rs_yspec &&
+            nacm_schema_get(rs, y, &ns) < 0)
+            goto done;
         pv = pv_list;
-        if (pv){
+        if (ns && ns->ns_decision != NACM_SCHEMA_DATA){
+            if (ns->ns_decision == NACM_SCHEMA_DENY)
+                xml_flag_set(xn, XML_FLAG_DEL);
+            else if (ns->ns_decision == NACM_SCHEMA_PERMIT)
+                xml_flag_set(xn, XML_FLAG_MARK);
+        }
+        else if (pv){
             do {
-                if ((ret = nacm_data_read_xrule_xml(xn,
-                                                    pv->pv_xrule,
-                                                    pv->pv_xpathvec,
-                                                    yspec)) < 0) 
+                if ((ret = nacm_data_read_xrule_xml(xn, pv, yspec)) < 0) 
                     goto done;      
                 if (ret == 1)
                     break; /* stop at first match */                
@@ -911,12 +1446,17 @@ nacm_datanode_read_recurse(clicon_handle h,
 #endif
     }
 
+    if (xml_flag(xn, XML_FLAG_MARK))
+        marked = 1;
+    /* Schema descendants are neither denied nor have permit marks that matter */
+    if (ns && !ns->ns_subdeny && (marked || defpermit || !ns->ns_subpermit))
+        goto ok;
     /* If node should be purged, dont recurse and defer removal to caller */
     if (xml_flag(xn, XML_FLAG_DEL) == 0){
         x = NULL;       /* Recursively check XML */
         xprev = NULL;
         while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
-            if (nacm_datanode_read_recurse(h, x, pv_list, yspec) < 0)
+            if (nacm_datanode_read_recurse(h, x, pv_list, rs, defpermit, marked, yspec) < 0)
                 goto done;
             /* check for delayed remove */
             if (xml_flag(x, XML_FLAG_DEL)){
@@ -926,6 +1466,7 @@ nacm_datanode_read_recurse(clicon_handle h,
             }
         }
     }
+ ok:
     retval = 0;
  done:
     return retval;
@@ -987,15 +1528,12 @@ nacm_datanode_read(clicon_handle h,
                    char         *username,
                    cxobj        *xnacm)
 {
-    int             retval = -1;
-    cxobj         **gvec = NULL; /* groups */
-    size_t          glen;
-    cxobj         **rlistvec = NULL; /* rule-list */
-    size_t          rlistlen;
-    int             i;
-    char           *read_default = NULL;
-    cvec           *nsc = NULL;
-    prepvec        *pv_list = NULL;
+    int                  retval = -1;
+    int                  i;
+    char                *read_default = NULL;
+    cvec                *nsc = NULL;
+    prepvec             *pv_list = NULL;
+    struct nacm_ruleset *rs = NULL;
     
     /* Create namespace context for with nacm namespace as default */
     if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
@@ -1007,29 +1545,29 @@ nacm_datanode_read(clicon_handle h,
        transport layer.)               */
     if (username == NULL)
         goto step9;
-    /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    /* User's groups and rule-lists, compiled once per NACM config */
+    if (nacm_ruleset_get(h, xnacm, username, nsc, &rs) < 0)
         goto done;
-    /* 4. If no groups are found (glen=0), continue and check read-default 
+    /* 4. If no groups are found, continue and check read-default 
           in step 11. */
     /* 5. Process all rule-list entries, in the order they appear in the
         configuration.  If a rule-list's "group" leaf-list does not
         match any of the user's groups, proceed to the next rule-list
         entry. */
-    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
-        goto done;
     /* read-default has default permit so should never be NULL */
     if ((read_default = xml_find_body(xnacm, "read-default")) == NULL){
         clicon_err(OE_XML, EINVAL, "No nacm read-default rule");
         goto done;
     }
-    /* First run through rules and cache rules as well as lookup objects in xt. 
+    /* First select the read rules, and lookup keyed paths in xt.
      * DANGER: objects could be stale if they are removed?
      */
-    if (nacm_datanode_prepare(h, xt, NACM_READ, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
+    if (nacm_datanode_prepare(xt, NACM_READ, rs, clicon_dbspec_yang(h), &pv_list) < 0)
         goto done;
     /* Then recursivelyy traverse all nodes */
-    if (nacm_datanode_read_recurse(h, xt, pv_list, clicon_dbspec_yang(h)) < 0)
+    if (nacm_datanode_read_recurse(h, xt, pv_list, rs,
+                                   strcmp(read_default, "deny"), 0,
+                                   clicon_dbspec_yang(h)) < 0)
         goto done;
 #if 1
     /* Step 8(B) above:
@@ -1040,7 +1578,7 @@ nacm_datanode_read(clicon_handle h,
             goto done;
 #endif
     /* reset flag */
-    if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
+    if (xml_flag_reset_rec(xt, XML_FLAG_MARK) < 0)
         goto done;
 
     goto ok;
@@ -1064,10 +1602,6 @@ nacm_datanode_read(clicon_handle h,
         prepvec_free(pv_list);
     if (nsc)
         xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
-    if (rlistvec)
-        free(rlistvec);
     return retval;
 }
 
@@ -1256,6 +1790,57 @@ nacm_access_pre(clicon_handle  h,
     goto done;
 }
 
+/*! NACM intial pre- access control enforcements using NACM config of a given tree
+ *
+ * As nacm_access_pre for internal NACM mode, but NACM config is read from xt instead of
+ * running, eg from a snapshot in a frontend.
+ * @param[in]  h        Clicon handle
+ * @param[in]  xt       Config tree with NACM config including default values, or NULL
+ * @param[in]  peername Peer username if any
+ * @param[in]  username User name of requestor
+ * @param[out] xncam    NACM XML tree, set if retval=0. Free after use
+ * @retval -1  Error
+ * @retval  0  OK but not validated. Need to do NACM step using xnacm
+ * @retval  1  OK permitted. You do not need to do next NACM step.
+ * @see nacm_access_pre
+ * @see xmldb_snapshot_get
+ */
+int
+nacm_access_pre_tree(clicon_handle  h,
+                     cxobj         *xt,
+                     char          *peername,
+                     char          *username,
+                     cxobj        **xnacmp)
+{
+    int    retval = -1;
+    cxobj *x;
+    cxobj *xnacm = NULL;
+    cvec  *nsc = NULL;
+
+    if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
+        goto done;
+    /* If config does not exist then the operation is permitted(?) */
+    if (xt == NULL || (x = xpath_first(xt, nsc, "nacm")) == NULL)
+        goto permit;
+    if ((xnacm = xml_dup(x)) == NULL)
+        goto done;
+    if ((retval = nacm_access_check(h, xnacm, peername, username)) < 0)
+        goto done;
+    if (retval == 0){ /* if retval == 0 then return an xml nacm tree */
+        *xnacmp = xnacm;
+        xnacm = NULL;
+    }
+ done:
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (xnacm)
+        xml_free(xnacm);
+    return retval;
+ permit:
+    retval = 1;
+    goto done;
+}
+
 /*! Verify nacm user with  peer uid credentials
  *
  * @param[in]  h         Clixon handle
@@ -74,6 +74,7 @@
 #include "clixon_proto.h"
 #include "clixon_netconf_lib.h"
 #include "clixon_netconf_input.h"
+#include "clixon_probe.h"
 
 /*! Read from socket and append to cbuf
  *
@@ -92,8 +93,7 @@ netconf_input_read2(int            s,
 {
     int      retval = -1;
     ssize_t  len;
-    
-    memset(buf, 0, buflen);
+
     if ((len = read(s, buf, buflen)) < 0){
         if (errno == ECONNRESET)
             len = 0; /* emulate EOF */
@@ -129,6 +129,8 @@ netconf_input_read2(int            s,
  * - bufp/lenp
  * - cbmsg
  * - frame_state/frame_size
+ * Data of a chunk, and EOM-framed data up to a possible end-of-message marker, is appended to
+ * cbmsg in one piece, only framing and marker characters are tracked one by one.
  */
 int
 netconf_input_msg2(unsigned char      **bufp,
@@ -139,17 +141,55 @@ netconf_input_msg2(unsigned char      **bufp,
                    size_t              *frame_size,
                    int                 *eom)
 {
-    int       retval = -1;
-    int       i;
-    int       ret;
-    int       found = 0;
-    size_t    len;
-    char      ch;
+    int            retval = -1;
+    size_t         i;
+    size_t         n;
+    int            ret;
+    int            found = 0;
+    size_t         len;
+    unsigned char *buf;
+    unsigned char *p;
+    char           ch;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    buf = *bufp;
     len = *lenp;
-    for (i=0; i<len; i++){
-        if ((ch = (*bufp)[i]) == 0)
+    i = 0;
+    while (i<len){
+        if (framing_type == NETCONF_SSH_CHUNKED){
+            /* Inside chunk-data: append as much of the chunk as there is in one go */
+            if (*frame_state == 4 && *frame_size > 0){
+                n = len - i;
+                if (n > *frame_size)
+                    n = *frame_size;
+                if (memchr(buf + i, '\0', n) == NULL){
+                    if (cbuf_append_buf(cbmsg, buf + i, n) < 0){
+                        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                        goto done;
+                    }
+                    *frame_size -= n;
+                    i += n;
+                    continue;
+                }
+            }
+        }
+        else if (*frame_state == 0){
+            /* Append data up to a possible end-of-message marker in one go */
+            n = len - i;
+            if ((p = memchr(buf + i, ']', n)) != NULL)
+                n = p - (buf + i);
+            if ((p = memchr(buf + i, '\0', n)) != NULL)
+                n = p - (buf + i);
+            if (n > 0){
+                if (cbuf_append_buf(cbmsg, buf + i, n) < 0){
+                    clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                    goto done;
+                }
+                i += n;
+                continue;
+            }
+        }
+        if ((ch = buf[i++]) == 0)
             continue; /* Skip NULL chars (eg from terminals) */
         if (framing_type == NETCONF_SSH_CHUNKED){
             /* Track chunked framing defined in RFC6242 */
@@ -157,7 +197,7 @@ netconf_input_msg2(unsigned char      **bufp,
                 goto done;
             switch (ret){
             case 1: /* chunk-data */
-                cprintf(cbmsg, "%c", ch);
+                cbuf_append(cbmsg, ch);
                 break;
             case 2: /* end-of-data */
                 /* Somewhat complex error-handling:
@@ -170,20 +210,18 @@ netconf_input_msg2(unsigned char      **bufp,
             }
         }
         else{
-            cprintf(cbmsg, "%c", ch);
+            cbuf_append(cbmsg, ch);
             if (detect_endtag("]]>]]>", ch, frame_state)){
                 *frame_state = 0;
                 /* OK, we have an xml string from a client */
                 /* Remove trailer */
-                *(((char*)cbuf_get(cbmsg)) + cbuf_len(cbmsg) - strlen("]]>]]>")) = '\0';
+                cbuf_trunc(cbmsg, cbuf_len(cbmsg) - strlen("]]>]]>"));
                 found++;
             }
         }
-        if (found){
-            i++;
+        if (found)
             break;
-        }
-    } /* for */
+    } /* while */
     *bufp += i;
     *lenp -= i;
     *eom = found;
@@ -223,8 +261,9 @@ netconf_input_frame2(cbuf      *cb,
         goto done;
     }
     str = cbuf_get(cb);
+    CLIXON_PROBE1(netconf_frame, cbuf_len(cb));
     /* Special case: empty XML */
-    if (strlen(str) == 0){     
+    if (*str == '\0'){     
         if (netconf_operation_failed_xml(xerr, "rpc", "Empty XML")< 0)
             goto done;
         goto failed;
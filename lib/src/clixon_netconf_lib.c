@@ -59,6 +59,7 @@
 #include "clixon_queue.h"
 #include "clixon_hash.h"
 #include "clixon_string.h"
+#include "clixon_pool.h"
 #include "clixon_err.h"
 #include "clixon_handle.h"
 #include "clixon_yang.h"
@@ -69,6 +70,8 @@
 #include "clixon_xml_bind.h"
 #include "clixon_xml_map.h"
 #include "clixon_xml_io.h"
+#include "clixon_json.h"
+#include "clixon_text_syntax.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
 #include "clixon_yang_module.h"
@@ -106,6 +109,123 @@ withdefaults_str2int(char *str)
     return clicon_str2int(wdmap, str);
 }
 
+/*! Create an rpc-error XML tree with error-type and error-tag
+ *
+ * The tree is built from the fields directly, without formatting and parsing XML text.
+ * Add further fields in RFC 6241 order with netconf_error_add and netconf_error_info_add
+ * @param[in,out] xret  Existing XML tree renamed to rpc-reply, or if NULL a new rpc-reply
+ * @param[in]     type  Error type: "rpc", "application" or "protocol"
+ * @param[in]     tag   Error tag
+ * @retval        xerr  The rpc-error element
+ * @retval        NULL  Error
+ * @code
+ *  cxobj *xret = NULL;
+ *  cxobj *xerr;
+ *  if ((xerr = netconf_error_new(&xret, "application", "bad-element")) == NULL ||
+ *      netconf_error_info_add(xerr, "bad-element", NULL, "x") < 0 ||
+ *      netconf_error_add(xerr, "error-severity", "error") < 0)
+ *    err;
+ *  xml_free(xret);
+ * @endcode
+ */
+cxobj *
+netconf_error_new(cxobj     **xret,
+                  const char *type,
+                  const char *tag)
+{
+    cxobj *xerr = NULL;
+    cxobj *xa;
+
+    if (xret == NULL){
+        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
+        goto done;      
+    }
+    if (*xret == NULL){
+        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
+            goto done;
+    }
+    else if (xml_name_set(*xret, "rpc-reply") < 0)
+        goto done;
+    if ((xa = xml_find_type(*xret, NULL, "xmlns", CX_ATTR)) != NULL){
+        if (xml_value_set(xa, NETCONF_BASE_NAMESPACE) < 0)
+            goto done;
+    }
+    else if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
+        goto done;
+    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+        goto done;
+    if (netconf_error_add(xerr, "error-type", type) < 0 ||
+        netconf_error_add(xerr, "error-tag", tag) < 0){
+        xml_purge(xerr);
+        xerr = NULL;
+    }
+ done:
+    return xerr;
+}
+
+/*! Add a field with a text body to an rpc-error XML tree
+ *
+ * @param[in]  xerr  rpc-error element
+ * @param[in]  name  Field name, eg error-message
+ * @param[in]  body  Text body, not XML encoded. NULL gives an empty element
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see netconf_error_new
+ */
+int
+netconf_error_add(cxobj      *xerr,
+                  const char *name,
+                  const char *body)
+{
+    cxobj *x;
+    cxobj *xb;
+
+    if ((x = xml_new((char*)name, xerr, CX_ELMNT)) == NULL)
+        return -1;
+    if (body){
+        if ((xb = xml_new("body", x, CX_BODY)) == NULL)
+            return -1;
+        if (xml_value_set(xb, (char*)body) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Add an element to the error-info of an rpc-error XML tree
+ *
+ * The error-info element is created if it is not the last field of xerr
+ * @param[in]  xerr  rpc-error element
+ * @param[in]  name  Element name, eg bad-element
+ * @param[in]  ns    Default namespace of element, or NULL
+ * @param[in]  body  Text body, not XML encoded
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see netconf_error_new
+ */
+int
+netconf_error_info_add(cxobj      *xerr,
+                       const char *name,
+                       const char *ns,
+                       const char *body)
+{
+    cxobj *xinfo;
+    cxobj *x;
+
+    if ((xinfo = xml_child_i_type(xerr, xml_child_nr_type(xerr, CX_ELMNT)-1, CX_ELMNT)) == NULL ||
+        strcmp(xml_name(xinfo), "error-info") != 0){
+        if ((xinfo = xml_new("error-info", xerr, CX_ELMNT)) == NULL)
+            return -1;
+    }
+    if (netconf_error_add(xinfo, name, body) < 0)
+        return -1;
+    if (ns){
+        x = xml_child_i_type(xinfo, xml_child_nr_type(xinfo, CX_ELMNT)-1, CX_ELMNT);
+        if (xml_add_attr(x, "xmlns", (char*)ns, NULL, NULL) < 0)
+            return -1;
+    }
+    return 0;
+}
+
 /*! Create Netconf in-use error XML tree according to RFC 6241 Appendix A
  *
  * The request requires a resource that already is in use.
@@ -159,39 +279,16 @@ netconf_invalid_value_xml(cxobj **xret,
                           char   *message)
 {
     int    retval =-1;
-    cxobj *xerr = NULL;
-    char  *encstr = NULL;
-    
-    if (xret == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
-        goto done;      
-    }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
-        goto done;
-    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
+    cxobj *xerr;
+
+    if ((xerr = netconf_error_new(xret, type, "invalid-value")) == NULL)
         goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
         goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL,
-                            "<error-type>%s</error-type>"
-                            "<error-tag>invalid-value</error-tag>"
-                            "<error-severity>error</error-severity>", type) < 0)
+    if (message && netconf_error_add(xerr, "error-message", message) < 0)
         goto done;
-    if (message){
-        if (xml_chardata_encode(&encstr, "%s", message) < 0)
-            goto done;
-        if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL,
-                                "<error-message>%s</error-message>", encstr) < 0)
-            goto done;
-    }
     retval = 0;
  done:
-    if (encstr)
-        free(encstr);
     return retval;
 }
 
@@ -276,40 +373,19 @@ netconf_missing_attribute_xml(cxobj **xret,
                               char   *attr,
                               char   *message)
 {
-    int   retval = -1;
-    cxobj *xerr = NULL;
-    char  *encstr = NULL;
+    int    retval = -1;
+    cxobj *xerr;
 
-    if (xret == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
-        goto done;      
-    }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
+    if ((xerr = netconf_error_new(xret, type, "missing-attribute")) == NULL)
         goto done;
-    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
+    if (netconf_error_info_add(xerr, "bad-attribute", NULL, attr) < 0)
         goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
         goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-type>%s</error-type>"
-                            "<error-tag>missing-attribute</error-tag>"
-                            "<error-info><bad-attribute>%s</bad-attribute></error-info>"
-                            "<error-severity>error</error-severity>", type, attr) < 0)
+    if (message && netconf_error_add(xerr, "error-message", message) < 0)
         goto done;
-    if (message){
-        if (xml_chardata_encode(&encstr, "%s", message) < 0)
-            goto done;
-        if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-message>%s</error-message>",
-                                encstr) < 0)
-            goto done;
-    }
     retval = 0;
  done:
-    if (encstr)
-        free(encstr);
     return retval;
 }
 
@@ -385,40 +461,19 @@ netconf_bad_attribute_xml(cxobj **xret,
                           char   *info,
                           char   *message)
 {
-    int   retval = -1;
-    cxobj *xerr = NULL;
-    char  *encstr = NULL;
+    int    retval = -1;
+    cxobj *xerr;
 
-    if (xret == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
-        goto done;      
-    }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
+    if ((xerr = netconf_error_new(xret, type, "bad-attribute")) == NULL)
         goto done;
-    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
+    if (netconf_error_info_add(xerr, "bad-attribute", NULL, info) < 0)
         goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
         goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-type>%s</error-type>"
-                            "<error-tag>bad-attribute</error-tag>"
-                            "<error-info><bad-attribute>%s</bad-attribute></error-info>"
-                            "<error-severity>error</error-severity>", type, info) < 0)
+    if (message && netconf_error_add(xerr, "error-message", message) < 0)
         goto done;
-    if (message){
-        if (xml_chardata_encode(&encstr, "%s", message) < 0)
-            goto done;
-        if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-message>%s</error-message>",
-                                encstr) < 0)
-            goto done;
-    }
     retval = 0;
  done:
-    if (encstr)
-        free(encstr);
     return retval;
 }
 
@@ -482,41 +537,19 @@ netconf_common_xml(cxobj **xret,
 {
     int    retval =-1;
     cxobj *xerr;
-    char  *encstr = NULL;
     
-    if (xret == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
-        goto done;      
-    }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-        if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
+    if ((xerr = netconf_error_new(xret, type, tag)) == NULL)
         goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+    if (netconf_error_info_add(xerr, infotag, NULL, element) < 0)
         goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-type>%s</error-type>"
-                            "<error-tag>%s</error-tag>"
-                            "<error-info><%s>%s</%s></error-info>"
-                            "<error-severity>error</error-severity>",
-                            type, tag, infotag, element, infotag) < 0)
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
+        goto done;
+    if (message && netconf_error_add(xerr, "error-message", message) < 0)
         goto done;
-    if (message){
-        if (xml_chardata_encode(&encstr, "%s", message) < 0)
-            goto done;
-        if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-message>%s</error-message>",
-                                encstr) < 0)
-            goto done;
-    }
     retval = 0;
  done:
-    if (encstr)
-        free(encstr);
     return retval;
-}    
+}
 
 /*! Create Netconf missing-element error XML tree according to RFC 6241 App A
  *
@@ -535,8 +568,7 @@ netconf_missing_element(cbuf      *cb,
     int    retval = -1;
     cxobj *xret = NULL;
 
-    if (netconf_common_xml(&xret, type, "missing-element",
-                           "bad-element", element, message) < 0)
+    if (netconf_missing_element_xml(&xret, type, element, message) < 0)
         goto done;
     if (clixon_xml2cbuf(cb, xret, 0, 0, NULL, -1, 0) < 0)
         goto done;
@@ -702,18 +734,31 @@ netconf_access_denied(cbuf *cb,
                       char *type,
                       char *message)
 {
-    int    retval = -1;
-    cxobj *xret = NULL;
+    int   retval = -1;
+    char *encstr = NULL;
 
-    if (netconf_access_denied_xml(&xret, type, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, NULL, -1, 0) < 0)
-        goto done;
+    if (cprintf(cb, "<rpc-reply xmlns=\"%s\"><rpc-error>"
+                "<error-type>%s</error-type>"
+                "<error-tag>access-denied</error-tag>"
+                "<error-severity>error</error-severity>",
+                NETCONF_BASE_NAMESPACE, type) < 0)
+        goto err;
+    if (message){
+        if (xml_chardata_encode(&encstr, "%s", message) < 0)
+            goto done;
+        if (cprintf(cb, "<error-message>%s</error-message>", encstr) < 0)
+            goto err;
+    }
+    if (cprintf(cb, "</rpc-error></rpc-reply>") < 0)
+        goto err;
     retval = 0;
  done:
-    if (xret)
-        xml_free(xret);
+    if (encstr)
+        free(encstr);
     return retval;
+ err:
+    clicon_err(OE_XML, errno, "cprintf");
+    goto done;
 }
 
 /*! Create Netconf access-denied error XML tree according to RFC 6241 App A
@@ -738,37 +783,15 @@ netconf_access_denied_xml(cxobj **xret,
 {
     int    retval =-1;
     cxobj *xerr;
-    char  *encstr = NULL;
 
-    if (xret == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
-        goto done;      
-    }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
-        goto done;
-    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
+    if ((xerr = netconf_error_new(xret, type, "access-denied")) == NULL)
         goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
         goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-type>%s</error-type>"
-                            "<error-tag>access-denied</error-tag>"
-                            "<error-severity>error</error-severity>", type) < 0)
+    if (message && netconf_error_add(xerr, "error-message", message) < 0)
         goto done;
-    if (message){
-        if (xml_chardata_encode(&encstr, "%s", message) < 0)
-            goto done;
-        if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-message>%s</error-message>",
-                                encstr) < 0)
-            goto done;
-    }
     retval = 0;
  done:
-    if (encstr)
-        free(encstr);
     return retval;
 }
 
@@ -969,42 +992,17 @@ int
 netconf_data_missing_xml(cxobj **xret,
                          char   *message)
 {
-    int   retval = -1;
-    char *encstr = NULL;
+    int    retval =-1;
     cxobj *xerr;
 
-    if (xret == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
-        goto done;      
-    }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
-        goto done;
-    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
-        goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+    if ((xerr = netconf_error_new(xret, "application", "data-missing")) == NULL)
         goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, 
-                            "<error-type>application</error-type>"
-                            "<error-tag>data-missing</error-tag>") < 0)
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
         goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, 
-                            "<error-severity>error</error-severity>") < 0)
+    if (message && netconf_error_add(xerr, "error-message", message) < 0)
         goto done;
-    if (message){
-        if (xml_chardata_encode(&encstr, "%s", message) < 0)
-            goto done;
-        if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL,
-                                "<error-message>%s</error-message>", encstr) < 0)
-            goto done;
-    }
     retval = 0;
  done:
-    if (encstr)
-        free(encstr);
     return retval;
 }
 
@@ -1025,56 +1023,32 @@ netconf_missing_choice_xml(cxobj **xret,
                            char   *message)
 {
     int    retval = -1;
-    char  *encstr = NULL;
     cxobj *xerr;
     char  *path = NULL;
-    char  *encpath = NULL;
 
-    if (xret == NULL || name == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret or name is NULL");
+    if (name == NULL){
+        clicon_err(OE_NETCONF, EINVAL, "name is NULL");
         goto done;      
     }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
-        goto done;
-    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
+    if ((xerr = netconf_error_new(xret, "application", "data-missing")) == NULL)
         goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+    if (netconf_error_add(xerr, "error-app-tag", "missing-choice") < 0)
         goto done;
     /* error-path:     Path to the element with the missing choice. */
     if (xml2xpath(x, NULL, 0, 0, &path) < 0)
         goto done;
-    if (xml_chardata_encode(&encpath, "%s", path) < 0)
+    if (netconf_error_add(xerr, "error-path", path) < 0)
         goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, 
-                            "<error-type>application</error-type>"
-                            "<error-tag>data-missing</error-tag>"
-                            "<error-app-tag>missing-choice</error-app-tag>"
-                            "<error-path>%s</error-path>"
-                            "<error-info><missing-choice xmlns=\"%s\">%s</missing-choice></error-info>"
-                            "<error-severity>error</error-severity>",
-                            encpath,
-                            YANG_XML_NAMESPACE,
-                            name) < 0)
+    if (netconf_error_info_add(xerr, "missing-choice", YANG_XML_NAMESPACE, name) < 0)
+        goto done;
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
+        goto done;
+    if (message && netconf_error_add(xerr, "error-message", message) < 0)
         goto done;
-    if (message){
-        if (xml_chardata_encode(&encstr, "%s", message) < 0)
-            goto done;
-        if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL,
-                                "<error-message>%s</error-message>", encstr) < 0)
-            goto done;
-    }
     retval = 0;
  done:
     if (path)
         free(path);
-    if (encstr)
-        free(encstr);
-    if (encpath)
-        free(encpath);
     return retval;
 }
 
@@ -1098,40 +1072,17 @@ netconf_operation_not_supported_xml(cxobj **xret,
                                     char   *type,
                                     char   *message)
 {
-    int   retval =-1;
+    int    retval =-1;
     cxobj *xerr;
-    char  *encstr = NULL;
-    
-    if (xret == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
-        goto done;      
-    }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
-        goto done;
-    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
-        goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+
+    if ((xerr = netconf_error_new(xret, type, "operation-not-supported")) == NULL)
         goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-type>%s</error-type>"
-                            "<error-tag>operation-not-supported</error-tag>"
-                            "<error-severity>error</error-severity>",
-                            type) < 0)
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
         goto done;
-    if (message){
-         if (xml_chardata_encode(&encstr, "%s", message) < 0)
-             goto done;
-         if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-message>%s</error-message>",
-                                 encstr) < 0)
+    if (message && netconf_error_add(xerr, "error-message", message) < 0)
         goto done;
-    }
     retval = 0;
  done:
-    if (encstr)
-        free(encstr);
     return retval;
 }
 
@@ -1210,40 +1161,17 @@ netconf_operation_failed_xml(cxobj **xret,
                              char  *type,
                              char  *message)
 {
-    int   retval =-1;
+    int    retval =-1;
     cxobj *xerr;
-    char  *encstr = NULL;
-    
-    if (xret == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
-        goto done;      
-    }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
-        goto done;
-    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
-        goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+
+    if ((xerr = netconf_error_new(xret, type, "operation-failed")) == NULL)
         goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-type>%s</error-type>"
-                            "<error-tag>operation-failed</error-tag>"
-                            "<error-severity>error</error-severity>",
-                            type) < 0)
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
         goto done;
-    if (message){
-         if (xml_chardata_encode(&encstr, "%s", message) < 0)
-             goto done;
-         if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-message>%s</error-message>",
-                                 encstr) < 0)
+    if (message && netconf_error_add(xerr, "error-message", message) < 0)
         goto done;
-    }
     retval = 0;
  done:
-    if (encstr)
-        free(encstr);
     return retval;
 }
 
@@ -1297,37 +1225,15 @@ netconf_malformed_message_xml(cxobj **xret,
 {
     int    retval =-1;
     cxobj *xerr;
-    char  *encstr = NULL;
 
-    if (xret == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
-        goto done;      
-    }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
+    if ((xerr = netconf_error_new(xret, "rpc", "malformed-message")) == NULL)
         goto done;
-    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
         goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+    if (message && netconf_error_add(xerr, "error-message", message) < 0)
         goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-type>rpc</error-type>"
-                            "<error-tag>malformed-message</error-tag>"
-                            "<error-severity>error</error-severity>") < 0)
-        goto done;
-     if (message){
-         if (xml_chardata_encode(&encstr, "%s", message) < 0)
-             goto done;
-         if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-message>%s</error-message>",
-                                 encstr) < 0)
-             goto done;
-     }
     retval = 0;
  done:
-    if (encstr)
-        free(encstr);
     return retval;
 }
 
@@ -1377,46 +1283,29 @@ netconf_data_not_unique_xml(cxobj **xret,
     int     retval = -1;
     cg_var *cvi = NULL; 
     cxobj  *xerr;
-    cxobj  *xinfo;
     char   *path = NULL;
-    char  *encpath = NULL;
+    cbuf   *cb = NULL;
 
-    if (xret == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
-        goto done;      
-    }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
+    if ((xerr = netconf_error_new(xret, "application", "operation-failed")) == NULL)
         goto done;
-    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
+    if (netconf_error_add(xerr, "error-app-tag", "data-not-unique") < 0)
         goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
-        goto done;
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL,
-                            "<error-type>application</error-type>"
-                            "<error-tag>operation-failed</error-tag>"
-                            "<error-app-tag>data-not-unique</error-app-tag>"
-                            "<error-severity>error</error-severity>") < 0)
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
         goto done;
     /* error-info: <non-unique> Contains an instance identifier that  points to a leaf
      * that invalidates the "unique" constraint.  This element is present once for each
      * non-unique leaf. */
     if (cvec_len(cvk)){
-        if ((xinfo = xml_new("error-info", xerr, CX_ELMNT)) == NULL)
-            goto done;
         if (xml2xpath(x, NULL, 0, 0, &path) < 0)
             goto done;
-        if (xml_chardata_encode(&encpath, "%s", path) < 0)
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
             goto done;
+        }
         while ((cvi = cvec_each(cvk, cvi)) != NULL){
-            if (clixon_xml_parse_va(YB_NONE, NULL, &xinfo, NULL,
-                                    "<non-unique xmlns=\"%s\">%s/%s</non-unique>",
-                                    YANG_XML_NAMESPACE,
-                                    encpath,
-                                    cv_string_get(cvi)) < 0)
+            cbuf_reset(cb);
+            cprintf(cb, "%s/%s", path, cv_string_get(cvi));
+            if (netconf_error_info_add(xerr, "non-unique", YANG_XML_NAMESPACE, cbuf_get(cb)) < 0)
                 goto done;
         }
     }
@@ -1424,8 +1313,8 @@ netconf_data_not_unique_xml(cxobj **xret,
  done:
     if (path)
         free(path);
-    if (encpath)
-        free(encpath);
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
@@ -1448,43 +1337,31 @@ netconf_minmax_elements_xml(cxobj **xret,
     int    retval = -1;
     cxobj *xerr;
     char  *path = NULL;
-    char  *encpath = NULL;
+    cbuf  *cb = NULL;
     
-    if (xret == NULL){
-        clicon_err(OE_NETCONF, EINVAL, "xret is NULL");
-        goto done;      
-    }
-    if (*xret == NULL){
-        if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
-            goto done;
-    }
-    else if (xml_name_set(*xret, "rpc-reply") < 0)
+    if ((xerr = netconf_error_new(xret, "protocol", "operation-failed")) == NULL)
         goto done;
-    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) < 0)
+    if (netconf_error_add(xerr, "error-app-tag", max?"too-many-elements":"too-few-elements") < 0)
         goto done;
-    if ((xerr = xml_new("rpc-error", *xret, CX_ELMNT)) == NULL)
+    if (netconf_error_add(xerr, "error-severity", "error") < 0)
         goto done;
     if (xml_parent(xp)){ /* Dont include root, eg <config> */
         if (xml2xpath(xp, NULL, 0, 0, &path) < 0)
            goto done;
-        if (xml_chardata_encode(&encpath, "%s", path) < 0)
-            goto done;
     }
-    if (clixon_xml_parse_va(YB_NONE, NULL, &xerr, NULL, "<error-type>protocol</error-type>"
-                            "<error-tag>operation-failed</error-tag>"
-                            "<error-app-tag>too-%s-elements</error-app-tag>"
-                            "<error-severity>error</error-severity>"
-                            "<error-path>%s/%s</error-path>",
-                            max?"many":"few",
-                            encpath?encpath:"",
-                            name) < 0)
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s/%s", path?path:"", name);
+    if (netconf_error_add(xerr, "error-path", cbuf_get(cb)) < 0)
         goto done;
     retval = 0;
  done:
     if (path)
         free(path);
-    if (encpath)
-        free(encpath);
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
@@ -1615,6 +1492,20 @@ netconf_module_load(clicon_handle h)
     /* Make message-id attribute optional */
     if (clicon_option_bool(h, "CLICON_NETCONF_MESSAGE_ID_OPTIONAL") == 1)
         xml_bind_netconf_message_id_optional(1);
+    /* Parse XML with hand-written scanner */
+    if (clicon_option_bool(h, "CLICON_XML_SCANNER") == 1)
+        clixon_xml_parse_scanner(1);
+    /* Recycle short-lived objects of requests in this thread, see CLIXON_POOL_SIZE */
+    clixon_pool_init();
+    /* Keep anydata content unparsed until accessed */
+    if (clicon_option_bool(h, "CLICON_XML_ANYDATA_LAZY") == 1)
+        clixon_xml_parse_lazy(1);
+    /* Parse JSON with hand-written scanner */
+    if (clicon_option_bool(h, "CLICON_JSON_SCANNER") == 1)
+        clixon_json_parse_scanner(1);
+    /* Parse TEXT with hand-written scanner */
+    if (clicon_option_bool(h, "CLICON_TEXT_SCANNER") == 1)
+        clixon_text_syntax_parse_scanner(1);
     /* Load ietf list pagination */
     if (yang_spec_parse_module(h, "ietf-list-pagination", NULL, yspec)< 0)
         goto done;
@@ -1803,6 +1694,9 @@ netconf_capabilites(clicon_handle h,
     /* rfc 6241 Sec 8.7 Distinct Startup Capability */
     if (if_feature(yspec, "ietf-netconf", "startup"))
         cprintf(cb, "<capability>urn:ietf:params:netconf:capability:startup:1.0</capability>");
+    /* RFC6241 Sec 8.8.  URL Capability, edit-config of local files only */
+    if (if_feature(yspec, "ietf-netconf", "url"))
+        cprintf(cb, "<capability>urn:ietf:params:netconf:capability:url:1.0?scheme=file</capability>");
     /* RFC6241 Sec 8.9.  XPath Capability */
     cprintf(cb, "<capability>urn:ietf:params:netconf:capability:xpath:1.0</capability>");
     /* rfc6243 with-defaults capability modes */
@@ -2096,26 +1990,30 @@ int
 netconf_framing_preamble(netconf_framing_type framing,
                          cbuf                *cb)
 {
-    int   retval = -1;
-    char *body = NULL;
+    int    retval = -1;
+    char   hdr[32];
+    size_t hlen;
+    size_t len;
+    char  *buf;
 
     switch (framing){
     case NETCONF_SSH_EOM:
         break;
     case NETCONF_SSH_CHUNKED:
-        if ((body = strdup(cbuf_get(cb))) == NULL){
-            clicon_err(OE_UNIX, errno, "strdup");
+        /* Insert RFC6242 chunk header in place, by moving the body once */
+        len = cbuf_len(cb);
+        hlen = snprintf(hdr, sizeof(hdr), "\n#%zu\n", len);
+        if (cbuf_append_buf(cb, hdr, hlen) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
             goto done;
         }
-        cbuf_reset(cb);
-        cprintf(cb, "\n#%zu\n", strlen(body));     /* Add RFC6242 chunked-end */
-        cbuf_append_str(cb, body);
+        buf = cbuf_get(cb);
+        memmove(buf + hlen, buf, len);
+        memcpy(buf, hdr, hlen);
         break;
     }
     retval = 0;
  done:
-    if (body)
-        free(body);
     return retval;
 }
 
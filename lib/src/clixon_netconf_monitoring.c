@@ -128,8 +128,14 @@ netconf_monitoring_datastores(clicon_handle h,
     return retval;
 }
 
+/* Schema list XML of a yang spec, built once, see netconf_monitoring_schemas */
+static cbuf      *_schemas_cb = NULL;
+static yang_stmt *_schemas_yspec = NULL;
+static int        _schemas_len = 0;
+
 /*! Get netconf monitoring schema state
  *
+ * The schema list only changes with the yang spec and is built once
  * @param[in]     h       Clicon handle
  * @param[in]     yspec   Yang spec
  * @param[in,out] cb      CLIgen buffer
@@ -140,7 +146,7 @@ netconf_monitoring_datastores(clicon_handle h,
 static int
 netconf_monitoring_schemas(clicon_handle h,
                            yang_stmt    *yspec,
-                           cbuf         *cb)
+                           cbuf         *cb0)
 {
     int        retval = -1;
     yang_stmt *ym = NULL;
@@ -148,7 +154,16 @@ netconf_monitoring_schemas(clicon_handle h,
     char      *identifier;
     char      *revision;
     char      *dir;
+    cbuf      *cb;
 
+    if (_schemas_cb && _schemas_yspec == yspec && _schemas_len == yang_len_get(yspec))
+        goto ok;
+    netconf_monitoring_schemas_free();
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    _schemas_cb = cb;
     cprintf(cb, "<schemas>");
     while ((ym = yn_each(yspec, ym)) != NULL) {
         cprintf(cb, "<schema>");
@@ -174,11 +189,28 @@ netconf_monitoring_schemas(clicon_handle h,
         cprintf(cb, "</schema>");
     }
     cprintf(cb, "</schemas>");
+    _schemas_yspec = yspec;
+    _schemas_len = yang_len_get(yspec);
+ ok:
+    cbuf_append_str(cb0, cbuf_get(_schemas_cb));
     retval = 0;
-    //done:
+ done:
     return retval;
 }
 
+/*! Free netconf monitoring schema list
+ */
+int
+netconf_monitoring_schemas_free(void)
+{
+    if (_schemas_cb)
+        cbuf_free(_schemas_cb);
+    _schemas_cb = NULL;
+    _schemas_yspec = NULL;
+    _schemas_len = 0;
+    return 0;
+}
+
 /*! Get netconf monitoring statistics state
  *
  * @param[in]     h       Clicon handle
@@ -113,6 +113,7 @@ get_sock(int  usock,
  * @param[in]  sa_len   Length of sa. Tecynicaliyu to be independent of sockaddr sa_len
  * @param[in]  backlog  Listen backlog, queie of pending connections
  * @param[in]  flags    Socket flags Or:ed in with the socket(2) type parameter
+ * @param[in]  reuseport If set, set SO_REUSEPORT so that several sockets may bind the same address
  * @param[in]  addrstr  Address string for debug
  * @param[out] sock     Server socket (bound for accept)
  */
@@ -121,6 +122,7 @@ create_socket(struct sockaddr *sa,
               size_t           sin_len,             
               int              backlog,
               int              flags,
+              int              reuseport,
               const char      *addrstr,
               int             *sock)
 {
@@ -162,6 +164,18 @@ create_socket(struct sockaddr *sa,
         clicon_err(OE_UNIX, errno, "setsockopt SO_REUSEADDR");
         goto done;
     }
+    /* Several processes may bind the same address, the kernel distributes connections */
+    if (reuseport){
+#ifdef SO_REUSEPORT
+        if (setsockopt(s, SOL_SOCKET, SO_REUSEPORT, (void *)&on, sizeof(on)) == -1) {
+            clicon_err(OE_UNIX, errno, "setsockopt SO_REUSEPORT");
+            goto done;
+        }
+#else
+        clicon_err(OE_UNIX, ENOTSUP, "No SO_REUSEPORT support on platform");
+        goto done;
+#endif
+    }
 
     /* only bind ipv6, otherwise it may bind to ipv4 as well which is strange but seems default */
     if (sa->sa_family == AF_INET6 &&
@@ -196,6 +210,7 @@ create_socket(struct sockaddr *sa,
  * @param[in]  sa_len   Length of sa. Tecynicaliyu to be independent of sockaddr sa_len
  * @param[in]  backlog  Listen backlog, queue of pending connections
  * @param[in]  flags    Socket flags OR:ed in with the socket(2) type parameter
+ * @param[in]  reuseport If set, set SO_REUSEPORT so that several sockets may bind the same address
  * @param[in]  addrstr  Address string for debug
  * @param[out] sock     Server socket (bound for accept)
  */
@@ -205,6 +220,7 @@ fork_netns_socket(const char      *netns,
                   size_t           sin_len,                 
                   int              backlog,
                   int              flags,
+                  int              reuseport,
                   const char      *addrstr,
                   int             *sock)
 {
@@ -269,7 +285,7 @@ fork_netns_socket(const char      *netns,
 #endif
         close(fd);
         /* Create socket in this namespace */
-        if (create_socket(sa, sin_len, backlog, flags, addrstr, &s) < 0){
+        if (create_socket(sa, sin_len, backlog, flags, reuseport, addrstr, &s) < 0){
             send_sock(sp[1], sp[1]); /* Dummy to wake parent */
             exit(1); /* Dont do return here, need to exit child */
         }
@@ -306,6 +322,7 @@ fork_netns_socket(const char      *netns,
  * @param[in]  sa_len   Length of sa. Tecynicaliyu to be independent of sockaddr sa_len
  * @param[in]  backlog  Listen backlog, queie of pending connections
  * @param[in]  flags    Socket flags OR:ed in with the socket(2) type parameter
+ * @param[in]  reuseport If set, set SO_REUSEPORT so that several sockets may bind the same address
  * @param[in]  addrstr  Address string for debug
  * @param[out] sock     Server socket (bound for accept)
  */
@@ -315,6 +332,7 @@ clixon_netns_socket(const char      *netns,
                     size_t           sin_len,               
                     int              backlog,
                     int              flags,
+                    int              reuseport,
                     const char      *addrstr,
                     int             *sock)
 {
@@ -322,13 +340,13 @@ clixon_netns_socket(const char      *netns,
     
     clicon_debug(1, "%s", __FUNCTION__);
     if (netns == NULL){
-        if (create_socket(sa, sin_len, backlog, flags, addrstr, sock) < 0)
+        if (create_socket(sa, sin_len, backlog, flags, reuseport, addrstr, sock) < 0)
             goto done;
         goto ok;
     }
     else {
 #ifdef HAVE_SETNS
-        if (fork_netns_socket(netns, sa, sin_len, backlog, flags, addrstr, sock) < 0)
+        if (fork_netns_socket(netns, sa, sin_len, backlog, flags, reuseport, addrstr, sock) < 0)
             goto done;
 #else
         clicon_err(OE_UNIX, errno, "No namespace support on platform: %s", netns);
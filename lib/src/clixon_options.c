@@ -124,11 +124,37 @@ static const map_str2int datastore_cache_map[] = {
     {NULL,                    -1}
 };
 
+/* Mapping between datastore async write mode string <--> constants, 
+ * see clixon-config.yang type xmldb_async_mode */
+static const map_str2int xmldb_async_map[] = {
+    {"sync",                  XMLDB_ASYNC_SYNC},
+    {"reply-before-durable",  XMLDB_ASYNC_REPLY_BEFORE},
+    {"reply-after-durable",   XMLDB_ASYNC_REPLY_AFTER},
+    {NULL,                    -1}
+};
+
+/* Mapping between datastore compression string <--> constants, 
+ * see clixon-config.yang type xmldb_compress */
+static const map_str2int xmldb_compress_map[] = {
+    {"none",                  XMLDB_COMPRESS_NONE},
+    {"zstd",                  XMLDB_COMPRESS_ZSTD},
+    {NULL,                    -1}
+};
+
+/* Mapping between backend output policy string <--> constants, 
+ * see clixon-config.yang type output_policy */
+static const map_str2int backend_output_policy_map[] = {
+    {"drop",                  BACKEND_OUTPUT_DROP},
+    {"disconnect",            BACKEND_OUTPUT_DISCONNECT},
+    {NULL,                    -1}
+};
+
 /* Mapping between regular expression type string <--> constants, 
  * see clixon-config.yang type regexp_mode */
 static const map_str2int yang_regexp_map[] = {
     {"posix",               REGEXP_POSIX},
     {"libxml2",             REGEXP_LIBXML2},
+    {"pcre2",               REGEXP_PCRE2},
     {NULL,                 -1}
 };
 
@@ -1021,6 +1047,63 @@ clicon_datastore_cache(clicon_handle h)
         return clicon_str2int(datastore_cache_map, str);
 }
 
+/*! How to write the running datastore file on commit
+ *
+ * @param[in] h      Clicon handle
+ * @retval    mode   Datastore async write mode
+ * @see clixon-config@<date>.yang CLICON_XMLDB_ASYNC
+ */
+enum xmldb_async_mode
+clicon_xmldb_async(clicon_handle h)
+{
+    char *str;
+    int   mode;
+
+    if ((str = clicon_option_str(h, "CLICON_XMLDB_ASYNC")) == NULL)
+        return XMLDB_ASYNC_SYNC;
+    if ((mode = clicon_str2int(xmldb_async_map, str)) < 0)
+        return XMLDB_ASYNC_SYNC;
+    return mode;
+}
+
+/*! How datastore files are compressed when written
+ *
+ * @param[in] h      Clicon handle
+ * @retval    mode   Datastore compression
+ * @see clixon-config@<date>.yang CLICON_XMLDB_COMPRESS
+ */
+enum xmldb_compress
+clicon_xmldb_compress(clicon_handle h)
+{
+    char *str;
+    int   mode;
+
+    if ((str = clicon_option_str(h, "CLICON_XMLDB_COMPRESS")) == NULL)
+        return XMLDB_COMPRESS_NONE;
+    if ((mode = clicon_str2int(xmldb_compress_map, str)) < 0)
+        return XMLDB_COMPRESS_NONE;
+    return mode;
+}
+
+/*! How notifications to a client whose output queue is full are handled
+ *
+ * @param[in] h      Clicon handle
+ * @retval    policy Backend output policy
+ * @see clixon-config@<date>.yang CLICON_BACKEND_OUTPUT_POLICY
+ */
+enum backend_output_policy
+clicon_backend_output_policy(clicon_handle h)
+{
+    char *str;
+    int   policy;
+
+    if ((str = clicon_option_str(h, "CLICON_BACKEND_OUTPUT_POLICY")) == NULL)
+        return BACKEND_OUTPUT_DROP;
+    if ((policy = clicon_str2int(backend_output_policy_map, str)) < 0)
+        return BACKEND_OUTPUT_DROP;
+    return policy;
+}
+
 /*! Which Yang regexp/pattern engine to use
  *
  * @param[in] h     Clicon handle
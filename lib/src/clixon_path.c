@@ -609,6 +609,359 @@ api_path_fmt2xpath(char  *api_path_fmt,
     return retval;
 }
 
+/*! Append one api-path segment to xpath, with list keys or leaf-list value
+ *
+ * @param[in]  cv       Api-path segment, with uri-encoded value if string
+ * @param[in]  y        Yang node of segment
+ * @param[in]  xprefix  XML prefix of namespace of y, or NULL
+ * @param[in]  name     Name of y
+ * @param[in]  first    First segment, no "/" before it
+ * @param[out] xpath    XPath as cbuf, segment is appended
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see api_path2xpath_cvv
+ */
+static int
+api_path2xpath_seg(cg_var    *cv,
+                   yang_stmt *y,
+                   char      *xprefix,
+                   char      *name,
+                   int        first,
+                   cbuf      *xpath)
+{
+    int        retval = -1;
+    char      *val = NULL;
+    char     **valvec = NULL;
+    int        nvalvec;
+    int        vi;
+    cvec      *cvk;
+    cg_var    *cvi;
+    char      *val1;
+    char      *decval = NULL;
+
+    if (!first)
+        cprintf(xpath, "/");
+    if (xprefix)
+        cprintf(xpath, "%s:", xprefix);
+    cprintf(xpath, "%s", name);
+    /* Check if has value, means '=' */
+    if (cv_type_get(cv) != CGV_STRING)
+        goto ok;
+    /* val is uri percent encoded, eg x%2Cy,z */
+    if ((val = cv2str_dup(cv)) == NULL)
+        goto done;
+    switch (yang_keyword_get(y)){
+    case Y_LIST:
+        /* Transform value "a,b,c" to "a" "b" "c" (nvalvec=3)
+         * Note that vnr can be < length of cvk, due to empty or unset values
+         */
+        if ((valvec = clicon_strsep(val, ",", &nvalvec)) == NULL)
+            goto done;
+        cvk = yang_cvec_get(y); /* Use Y_LIST cache, see ys_populate_list() */
+        cvi = NULL;
+        /* Iterate over individual yang keys  */
+        vi = 0;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL && vi<nvalvec){
+            cprintf(xpath, "[");
+            if (xprefix)
+                cprintf(xpath, "%s:", xprefix);
+            val1 = valvec[vi++];
+            /* valvec is uri encoded, needs decoding */
+            if (uri_percent_decode(val1, &decval) < 0)
+                goto done;
+            cprintf(xpath, "%s='%s']", cv_string_get(cvi), decval);
+            if (decval){
+                free(decval);
+                decval = NULL;
+            }
+        }
+        break;
+    case Y_LEAF_LIST: /* XXX: LOOP? */
+        if (val)
+            cprintf(xpath, "[.='%s']", val);
+        else
+            cprintf(xpath, "[.='']");
+        break;
+    default:
+        break;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (valvec)
+        free(valvec);
+    if (val)
+        free(val);
+    return retval;
+}
+
+#ifdef API_PATH_CACHE
+/*! Resolved segment of a cached api-path template
+ */
+struct api_path_cache_seg{
+    yang_stmt *as_y;       /* Yang data node */
+    char      *as_name;    /* Name of data node */
+    char      *as_xprefix; /* XML prefix of namespace of data node, or NULL */
+};
+typedef struct api_path_cache_seg api_path_cache_seg;
+
+/*! Resolved api-path template in the api-path cache
+ * The template is the api-path without key values, eg /ex:table/parameter=
+ * Only the key values are substituted when an api-path matches the template
+ */
+struct api_path_cache_entry{
+    qelem_t             ae_qelem;  /* LRU list, most recently used first */
+    int                 ae_nseg;   /* Nr of segments */
+    api_path_cache_seg *ae_segs;   /* Vector of resolved segments */
+    cvec               *ae_nsc;    /* Namespace context of xpath */
+    size_t              ae_size;   /* Memory of entry in bytes */
+    char                ae_key[];  /* Template, also hash key */
+};
+typedef struct api_path_cache_entry api_path_cache_entry;
+
+static clicon_hash_t        *_api_path_cache_hash = NULL; /* template -> entry */
+static api_path_cache_entry *_api_path_cache_lru = NULL;  /* Circular list, last is least recently used */
+static yang_stmt            *_api_path_cache_yspec = NULL; /* Yang spec of cached entries */
+static size_t                _api_path_cache_size = 0;    /* Memory of cached entries */
+static uint64_t              _api_path_cache_nr = 0;      /* Nr of cached entries */
+static uint64_t              _api_path_cache_hits = 0;
+static uint64_t              _api_path_cache_misses = 0;
+
+/*! Free vector of resolved segments
+ */
+static int
+api_path_cache_segs_free(api_path_cache_seg *segs,
+                         int                 nseg)
+{
+    int i;
+
+    for (i=0; i<nseg; i++){
+        if (segs[i].as_name)
+            free(segs[i].as_name);
+        if (segs[i].as_xprefix)
+            free(segs[i].as_xprefix);
+    }
+    free(segs);
+    return 0;
+}
+
+/*! Free api-path cache entry
+ */
+static int
+api_path_cache_entry_free(api_path_cache_entry *ae)
+{
+    if (ae->ae_segs)
+        api_path_cache_segs_free(ae->ae_segs, ae->ae_nseg);
+    if (ae->ae_nsc)
+        cvec_free(ae->ae_nsc);
+    free(ae);
+    return 0;
+}
+
+/*! Remove entry from cache and free it
+ */
+static int
+api_path_cache_evict(api_path_cache_entry *ae)
+{
+    DELQ(ae, _api_path_cache_lru, api_path_cache_entry *);
+    clicon_hash_del(_api_path_cache_hash, ae->ae_key);
+    _api_path_cache_size -= ae->ae_size;
+    _api_path_cache_nr--;
+    api_path_cache_entry_free(ae);
+    return 0;
+}
+
+/*! Make api-path template, ie the api-path without key values
+ *
+ * @param[in]  api_path  Api-path as cvec
+ * @param[in]  offset    Offset of cvec, where api-path starts
+ * @param[out] cb        Template, eg /ex:table/parameter=
+ */
+static int
+api_path_cache_key(cvec *api_path,
+                   int   offset,
+                   cbuf *cb)
+{
+    int     i;
+    cg_var *cv;
+
+    for (i=offset; i<cvec_len(api_path); i++){
+        cv = cvec_i(api_path, i);
+        cprintf(cb, "/%s%s", cv_name_get(cv), cv_type_get(cv) == CGV_STRING ? "=" : "");
+    }
+    return 0;
+}
+
+/*! Translate api-path to xpath using a cached template
+ *
+ * @param[in]  api_path  Api-path as cvec
+ * @param[in]  offset    Offset of cvec, where api-path starts
+ * @param[in]  yspec     Yang spec
+ * @param[in]  key       Template of api-path, see api_path_cache_key
+ * @param[out] xpath     XPath as cbuf
+ * @param[out] nscp      Namespace context of xpath, if found
+ * @retval     1         Found, xpath and nscp set
+ * @retval     0         Not found
+ * @retval    -1         Error
+ */
+static int
+api_path_cache_lookup(cvec       *api_path,
+                      int         offset,
+                      yang_stmt  *yspec,
+                      const char *key,
+                      cbuf       *xpath,
+                      cvec      **nscp)
+{
+    int                   retval = -1;
+    api_path_cache_entry *ae;
+    api_path_cache_seg   *as;
+    void                 *val;
+    int                   i;
+
+    if (_api_path_cache_yspec != yspec){ /* New yang spec, cached nodes are not valid */
+        api_path_cache_exit();
+        _api_path_cache_yspec = yspec;
+    }
+    if (_api_path_cache_hash == NULL ||
+        (val = clicon_hash_value(_api_path_cache_hash, key, NULL)) == NULL){
+        _api_path_cache_misses++;
+        goto notfound;
+    }
+    ae = *(api_path_cache_entry **)val;
+    _api_path_cache_hits++;
+    if (ae != _api_path_cache_lru){ /* Move first */
+        DELQ(ae, _api_path_cache_lru, api_path_cache_entry *);
+        INSQ(ae, _api_path_cache_lru);
+    }
+    cprintf(xpath, "/");
+    for (i=0; i<ae->ae_nseg; i++){
+        as = &ae->ae_segs[i];
+        if (api_path2xpath_seg(cvec_i(api_path, offset+i), as->as_y, as->as_xprefix, as->as_name,
+                               i==0, xpath) < 0)
+            goto done;
+    }
+    if (nscp && (*nscp = cvec_dup(ae->ae_nsc)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_dup");
+        goto done;
+    }
+    retval = 1;
+ done:
+    return retval;
+ notfound:
+    retval = 0;
+    goto done;
+}
+
+/*! Add resolved api-path template to cache
+ *
+ * Least recently used entries are evicted when the cache exceeds API_PATH_CACHE_SIZE bytes.
+ * @param[in]  key    Template of api-path, see api_path_cache_key
+ * @param[in]  segs   Vector of resolved segments, consumed
+ * @param[in]  nseg   Length of segs
+ * @param[in]  nsc    Namespace context of xpath, copied
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+api_path_cache_add(const char         *key,
+                   api_path_cache_seg *segs,
+                   int                 nseg,
+                   cvec               *nsc)
+{
+    int                   retval = -1;
+    api_path_cache_entry *ae = NULL;
+    size_t                len;
+    int                   i;
+
+    len = strlen(key);
+    if ((ae = malloc(sizeof(*ae) + len + 1)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        if (segs)
+            api_path_cache_segs_free(segs, nseg);
+        goto done;
+    }
+    memset(ae, 0, sizeof(*ae));
+    memcpy(ae->ae_key, key, len + 1);
+    ae->ae_segs = segs;
+    ae->ae_nseg = nseg;
+    segs = NULL;
+    if ((ae->ae_nsc = cvec_dup(nsc)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_dup");
+        goto done;
+    }
+    ae->ae_size = sizeof(*ae) + 2*(len + 1) + nseg*sizeof(api_path_cache_seg);
+    for (i=0; i<nseg; i++){
+        ae->ae_size += strlen(ae->ae_segs[i].as_name) + 1;
+        if (ae->ae_segs[i].as_xprefix)
+            ae->ae_size += strlen(ae->ae_segs[i].as_xprefix) + 1;
+    }
+    if (ae->ae_size > API_PATH_CACHE_SIZE)
+        goto ok;
+    if (_api_path_cache_hash == NULL &&
+        (_api_path_cache_hash = clicon_hash_init()) == NULL)
+        goto done;
+    while (_api_path_cache_lru && _api_path_cache_size + ae->ae_size > API_PATH_CACHE_SIZE)
+        api_path_cache_evict(PREVQ(api_path_cache_entry *, _api_path_cache_lru));
+    if (clicon_hash_add(_api_path_cache_hash, key, &ae, sizeof(ae)) == NULL)
+        goto done;
+    INSQ(ae, _api_path_cache_lru);
+    _api_path_cache_size += ae->ae_size;
+    _api_path_cache_nr++;
+    ae = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (ae)
+        api_path_cache_entry_free(ae);
+    return retval;
+}
+#endif /* API_PATH_CACHE */
+
+/*! Get api-path cache statistics
+ *
+ * @param[out] nr      Number of cached api-path templates
+ * @param[out] sz      Memory of cached templates in bytes
+ * @param[out] hits    Number of api-paths translated using a cached template
+ * @param[out] misses  Number of api-paths resolved against the yang spec
+ * @retval     0       OK
+ * @see XPATH_CACHE
+ */
+int
+api_path_cache_stats(uint64_t *nr,
+                     size_t   *sz,
+                     uint64_t *hits,
+                     uint64_t *misses)
+{
+#ifdef API_PATH_CACHE
+    *nr = _api_path_cache_nr;
+    *sz = _api_path_cache_size;
+    *hits = _api_path_cache_hits;
+    *misses = _api_path_cache_misses;
+#else
+    *nr = 0;
+    *sz = 0;
+    *hits = 0;
+    *misses = 0;
+#endif
+    return 0;
+}
+
+/*! Free all cached api-path templates
+ */
+void
+api_path_cache_exit(void)
+{
+#ifdef API_PATH_CACHE
+    while (_api_path_cache_lru)
+        api_path_cache_evict(_api_path_cache_lru);
+    if (_api_path_cache_hash){
+        clicon_hash_free(_api_path_cache_hash);
+        _api_path_cache_hash = NULL;
+    }
+    _api_path_cache_yspec = NULL;
+#endif
+}
+
 /*! Translate from restconf api-path(cvv) to xml xpath(cbuf) and namespace context
  * 
  * @param[in]     api_path URI-encoded path expression" (RFC8040 3.5.3) as cvec
@@ -660,22 +1013,38 @@ api_path2xpath_cvv(cvec       *api_path,
     char      *prefix = NULL;  /* api-path (module) prefix */
     char      *xprefix = NULL; /* xml xpath prefix */
     char      *name = NULL;
-    cvec      *cvk = NULL; /* vector of index keys */
     yang_stmt *y = NULL;
     yang_stmt *ymod = NULL;
-    char      *val;
-    cg_var    *cvi;
-    char     **valvec = NULL;
-    int        vi;
-    int        nvalvec;
     cbuf      *cberr = NULL;
     char      *namespace = NULL;
     cvec      *nsc = NULL;
-    char      *val1;
-    char      *decval;
     int        ret;
     int        root;
-                        
+#ifdef API_PATH_CACHE
+    cbuf               *cbkey = NULL;
+    api_path_cache_seg *segs = NULL;
+    int                 nseg = 0;
+    int                 cache = 1; /* Resolution may be cached, not if mountpoint */
+#endif
+
+#ifdef API_PATH_CACHE
+    if ((cbkey = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    api_path_cache_key(api_path, offset, cbkey);
+    if ((ret = api_path_cache_lookup(api_path, offset, yspec, cbuf_get(cbkey), xpath, nscp)) < 0)
+        goto done;
+    if (ret == 1){
+        retval = 1;
+        goto done;
+    }
+    if ((nseg = cvec_len(api_path) - offset) > 0 &&
+        (segs = calloc(nseg, sizeof(*segs))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+#endif
     cprintf(xpath, "/");
     /* Initialize namespace context */
     if ((nsc = xml_nsctx_init(NULL, NULL)) == NULL)
@@ -733,81 +1102,27 @@ api_path2xpath_cvv(cvec       *api_path,
             if (xml_nsctx_add(nsc, xprefix, namespace) < 0)
                 goto done;
         }
-        /* Check if has value, means '=' */
-        if (cv_type_get(cv) == CGV_STRING){
-            /* val is uri percent encoded, eg x%2Cy,z */
-            if ((val = cv2str_dup(cv)) == NULL)
-                goto done;
-            switch (yang_keyword_get(y)){
-            case Y_LIST:
-                /* Transform value "a,b,c" to "a" "b" "c" (nvalvec=3)
-                 * Note that vnr can be < length of cvk, due to empty or unset values
-                 */
-                if (valvec){ /* loop, valvec may have been used before */
-                    free(valvec);
-                    valvec = NULL;
-                }
-                if ((valvec = clicon_strsep(val, ",", &nvalvec)) == NULL)
-                    goto done;
-                cvk = yang_cvec_get(y); /* Use Y_LIST cache, see ys_populate_list() */
-                cvi = NULL;
-                /* Iterate over individual yang keys  */
-                if (i != offset)
-                    cprintf(xpath, "/");
-                if (xprefix)
-                    cprintf(xpath, "%s:", xprefix);
-                cprintf(xpath, "%s", name);
-                vi = 0;
-                while ((cvi = cvec_each(cvk, cvi)) != NULL && vi<nvalvec){
-                    cprintf(xpath, "[");
-                    if (xprefix)
-                        cprintf(xpath, "%s:", xprefix);
-                    val1 = valvec[vi++];
-                    /* valvec is uri encoded, needs decoding */
-                    if (uri_percent_decode(val1, &decval) < 0)
-                        goto done;
-                    cprintf(xpath, "%s='%s']", cv_string_get(cvi), decval);
-                    if (decval){
-                        free(decval);
-                        decval = NULL;
-                    }
-                }
-                break;
-            case Y_LEAF_LIST: /* XXX: LOOP? */
-                if (i != offset)
-                    cprintf(xpath, "/");
-                if (xprefix)
-                    cprintf(xpath, "%s:", xprefix);
-                cprintf(xpath, "%s", name);
-                if (val)
-                    cprintf(xpath, "[.='%s']", val);
-                else
-                    cprintf(xpath, "[.='']");
-                break;
-            default:
-                if (i != offset)
-                    cprintf(xpath, "/");
-                if (xprefix)
-                    cprintf(xpath, "%s:", xprefix);
-                cprintf(xpath, "%s", name);
-                break;
-            }
-            if (val)
-                free(val);
+        if (api_path2xpath_seg(cv, y, xprefix, name, i == offset, xpath) < 0)
+            goto done;
+#ifdef API_PATH_CACHE
+        segs[i-offset].as_y = y;
+        if ((segs[i-offset].as_name = strdup(name)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
         }
-        else{
-            if (i != offset)
-                cprintf(xpath, "/");
-            if (xprefix)
-                cprintf(xpath, "%s:", xprefix);
-            cprintf(xpath, "%s", name);
+        if (xprefix && (segs[i-offset].as_xprefix = strdup(xprefix)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
         }
-
+#endif
         /* If x/y is mountpoint, pass moint yspec to children */
         if ((ret = yang_schema_mount_point(y)) < 0)
             goto done;
         if (ret == 1){
             yang_stmt *y1 = NULL;
+#ifdef API_PATH_CACHE
+            cache = 0; /* Mounted yang spec depends on the keys of the path */
+#endif
             if (xml_nsctx_yangspec(yspec, &nsc) < 0)
                 goto done;                
             if (yang_mount_get(y, cbuf_get(xpath), &y1) < 0)
@@ -828,17 +1143,28 @@ api_path2xpath_cvv(cvec       *api_path,
             name = NULL;
         }
     } /* for */
-    retval = 1; /* OK */
+#ifdef API_PATH_CACHE
+    if (cache){
+        if (api_path_cache_add(cbuf_get(cbkey), segs, nseg, nsc) < 0)
+            goto done;
+        segs = NULL;
+    }
+#endif
     if (nscp){
         *nscp = nsc;
         nsc = NULL;
     }
+    retval = 1; /* OK */
  done:
     clicon_debug(CLIXON_DBG_DETAIL, "%s retval:%d", __FUNCTION__, retval);
+#ifdef API_PATH_CACHE
+    if (segs)
+        api_path_cache_segs_free(segs, nseg);
+    if (cbkey)
+        cbuf_free(cbkey);
+#endif
     if (cberr)
         cbuf_free(cberr);
-    if (valvec)
-        free(valvec);
     if (prefix)
         free(prefix);
     if (nsc)
@@ -1463,6 +1789,63 @@ api_path_resolve(clixon_path *cplist,
     goto done;
 }
 
+/*! Order instance-id key predicates as the keys of the yang list
+ *
+ * Key predicates of an instance-id may be given in any order, but an indexed search of a list
+ * requires them in the order of the yang keys, see clixon_xml_find_index.
+ * Only if all keys are given, otherwise the keys are left as is.
+ * @param[in]     yc  Yang list
+ * @param[in,out] cp  Clixon path of the list, cp_cvk may be replaced
+ * @retval        0   OK
+ * @retval       -1   Error
+ */
+static int
+instance_id_keys_order(yang_stmt   *yc,
+                       clixon_path *cp)
+{
+    int     retval = -1;
+    cvec   *ycvk;
+    cvec   *cvk = NULL;
+    cg_var *ycv;
+    cg_var *cv;
+    int     i;
+
+    ycvk = yang_cvec_get(yc);
+    if (ycvk == NULL || cvec_len(ycvk) != cvec_len(cp->cp_cvk))
+        goto ok;
+    for (i=0; i<cvec_len(ycvk); i++){
+        ycv = cvec_i(ycvk, i);
+        if ((cv = cvec_i(cp->cp_cvk, i)) == NULL || cv_name_get(cv) == NULL)
+            goto ok;
+        if (strcmp(cv_name_get(cv), cv_string_get(ycv)) != 0)
+            break;
+    }
+    if (i == cvec_len(ycvk)) /* Already in order */
+        goto ok;
+    if ((cvk = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    ycv = NULL;
+    while ((ycv = cvec_each(ycvk, ycv)) != NULL){
+        if ((cv = cvec_find(cp->cp_cvk, cv_string_get(ycv))) == NULL)
+            goto ok; /* Not all keys */
+        if (cvec_append_var(cvk, cv) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_append_var");
+            goto done;
+        }
+    }
+    cvec_free(cp->cp_cvk);
+    cp->cp_cvk = cvk;
+    cvk = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (cvk)
+        cvec_free(cvk);
+    return retval;
+}
+
 /*! Resolve instance-id prefix:names to yang statements
  * @param[in]  cplist   Lisp of clixon-path
  * @param[in]  yt       Yang statement of top symbol (can be yang-spec if top-level)
@@ -1540,6 +1923,9 @@ instance_id_resolve(clixon_path *cplist,
                         
                     }
                 }
+                /* Put keys in yang order so that they can be searched with key index */
+                if (instance_id_keys_order(yc, cp) < 0)
+                    goto done;
                 break;
             case Y_LEAF_LIST:
                 break;
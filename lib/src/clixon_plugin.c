@@ -41,8 +41,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 #include <signal.h>
 #include <dlfcn.h>
 #include <dirent.h>
@@ -71,6 +73,7 @@
 #include "clixon_netconf_lib.h"
 #include "clixon_validate.h"
 #include "clixon_plugin.h"
+#include "clixon_probe.h"
 
 /*
  * Private types
@@ -85,6 +88,20 @@ struct plugin_context {
     struct termios   pc_termios;           /* See termios(3) */
 };
 
+/*! Header of memory allocated with clixon_plugin_malloc, keeps the size for accounting
+ * Aligned as malloc(3)
+ */
+typedef union {
+    size_t      pm_size;
+    long double pm_ld;
+    long long   pm_ll;
+    void       *pm_ptr;
+} plugin_mem_hdr;
+
+/* Memory allocated by plugins with clixon_plugin_malloc et al, see clixon_plugin_mem_stats */
+static uint64_t _plugin_mem_nr = 0;
+static size_t   _plugin_mem_size = 0;
+
 /* Internal plugin structure with dlopen() handle and plugin_api
  * This is an internal type, not exposed in the API
  * The external type is "clixon_plugin_t" defined in clixon_plugin.h
@@ -94,6 +111,23 @@ struct clixon_plugin{
     char              cp_name[MAXPATHLEN]; /* Plugin filename. Note api ca_name is given by plugin itself */
     plghndl_t         cp_handle;  /* Handle to plugin using dlopen(3) */
     clixon_plugin_api cp_api;
+    clixon_call_stats cp_calls[PC_NR]; /* Call statistics of api callbacks */
+};
+
+/* Names of plugin api callbacks in call statistics */
+static const char *plugin_call_names[PC_NR] = {
+    "start",
+    "exit",
+    "auth",
+    "extension",
+    "datastore-upgrade",
+    "yang-mount",
+    "yang-patch",
+    "reset",
+    "pre-daemon",
+    "daemon",
+    "statedata",
+    "lockdb"
 };
 
 /*
@@ -115,7 +149,9 @@ typedef struct {
  */
 struct plugin_module_struct {
     clixon_plugin_t    *ms_plugin_list;
-    rpc_callback_t     *ms_rpc_callbacks;
+    rpc_callback_t     *ms_rpc_callbacks;     /* All rpc callbacks in registration order */
+    clicon_hash_t      *ms_rpc_hash;          /* rpc callback vectors keyed on "<ns> <name>" */
+    cbuf               *ms_rpc_key;           /* Reused buffer for rpc hash lookup key */
     upgrade_callback_t *ms_upgrade_callbacks;
 };
 typedef struct plugin_module_struct plugin_module_struct;
@@ -153,6 +189,36 @@ plugin_module_struct_set(clicon_handle         h,
     return 0;
 }
 
+/*! Find the rpc callbacks of a namespace and name in the rpc hash
+ *
+ * A namespace or a name cannot contain space, so "<ns> <name>" is a unique key
+ * @param[in]  ms    Plugin module struct
+ * @param[in]  ns    Namespace of rpc
+ * @param[in]  name  Name of rpc
+ * @param[out] nr    Number of callbacks in the returned vector
+ * @retval     vec   Vector of callbacks in registration order, not to be freed
+ * @retval     NULL  No callbacks registered (or error)
+ */
+static rpc_callback_t **
+rpc_callback_lookup(plugin_module_struct *ms,
+                    const char           *ns,
+                    const char           *name,
+                    size_t               *nr)
+{
+    rpc_callback_t **vec;
+    size_t           vlen = 0;
+
+    if (ms->ms_rpc_hash == NULL || ms->ms_rpc_key == NULL)
+        return NULL;
+    cbuf_reset(ms->ms_rpc_key);
+    if (cprintf(ms->ms_rpc_key, "%s %s", ns, name) < 0)
+        return NULL;
+    if ((vec = clicon_hash_value(ms->ms_rpc_hash, cbuf_get(ms->ms_rpc_key), &vlen)) == NULL)
+        return NULL;
+    *nr = vlen / sizeof(rpc_callback_t *);
+    return vec;
+}
+
 /* Access functions */
 
 /*! Get plugin api 
@@ -670,6 +736,277 @@ plugin_context_check(clicon_handle h,
     goto done;
 }
 
+/*! Get start time of a plugin callback
+ *
+ * @retval  t0  Monotonic time in microseconds
+ * @see clixon_plugin_call_stats
+ */
+uint64_t
+clixon_plugin_call_start(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec*1000000 + t.tv_nsec/1000;
+}
+
+/*! Log a plugin callback that took longer than CLICON_PLUGIN_SLOW_LOG
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  name      Name of plugin or rpc
+ * @param[in]  callback  Name of callback
+ * @param[in]  us        Duration in microseconds
+ */
+void
+clixon_plugin_slow_log(clicon_handle h,
+                       const char   *name,
+                       const char   *callback,
+                       uint64_t      us)
+{
+    uint32_t ms;
+
+    if (us < 1000) /* Shortcut: any threshold is at least 1ms */
+        return;
+    if ((ms = clicon_option_int(h, "CLICON_PLUGIN_SLOW_LOG")) == 0)
+        return;
+    if (us >= (uint64_t)ms*1000)
+        clicon_log(LOG_WARNING, "Slow %s callback in %s: %" PRIu64 " ms",
+                   callback, name, us/1000);
+}
+
+/*! Add duration of a callback to call statistics
+ */
+static void
+plugin_call_stats_add(clicon_handle      h,
+                      clixon_call_stats *pcs,
+                      const char        *name,
+                      const char        *callback,
+                      uint64_t           t0)
+{
+    uint64_t us;
+
+    us = clixon_plugin_call_start() - t0;
+    CLIXON_PROBE3(plugin_callback, name, callback, us);
+    pcs->pcs_count++;
+    pcs->pcs_total += us;
+    if (us > pcs->pcs_max)
+        pcs->pcs_max = us;
+    clixon_plugin_slow_log(h, name, callback, us);
+}
+
+/*! Record the duration of a plugin api callback
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  cp    Plugin
+ * @param[in]  call  Callback
+ * @param[in]  t0    Start time of callback, see clixon_plugin_call_start
+ * @code
+ *   t0 = clixon_plugin_call_start();
+ *   ret = fn(h);
+ *   clixon_plugin_call_stats(h, cp, PC_START, t0);
+ * @endcode
+ */
+void
+clixon_plugin_call_stats(clicon_handle           h,
+                         clixon_plugin_t        *cp,
+                         enum clixon_plugin_call call,
+                         uint64_t                t0)
+{
+    plugin_call_stats_add(h, &cp->cp_calls[call], cp->cp_name, plugin_call_names[call], t0);
+}
+
+/*! Print call statistics as XML
+ */
+static void
+plugin_call_stats2cbuf(cbuf              *cb,
+                       clixon_call_stats *pcs)
+{
+    cprintf(cb, "<count>%" PRIu64 "</count>", pcs->pcs_count);
+    cprintf(cb, "<total>%" PRIu64 "</total>", pcs->pcs_total);
+    cprintf(cb, "<max>%" PRIu64 "</max>", pcs->pcs_max);
+}
+
+/*! Get call statistics of plugin api and rpc callbacks as XML for the stats rpc
+ *
+ * Callbacks that have not been called are not included.
+ * Several callbacks of the same rpc are added together
+ * @param[in]  h   Clixon handle
+ * @param[out] cb  CLIgen buf, plugin-calls container is appended
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+clixon_plugin_stats_get(clicon_handle h,
+                        cbuf         *cb)
+{
+    plugin_module_struct *ms = plugin_module_struct_get(h);
+    clixon_plugin_t      *cp = NULL;
+    rpc_callback_t       *rc;
+    rpc_callback_t      **vec;
+    size_t                vlen;
+    clixon_call_stats     pcs;
+    int                   i;
+
+    cprintf(cb, "<plugin-calls xmlns=\"%s\">", CLIXON_LIB_NS);
+    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
+        for (i=0; i<PC_NR; i++)
+            if (cp->cp_calls[i].pcs_count)
+                break;
+        if (i == PC_NR)
+            continue;
+        cprintf(cb, "<plugin><name>%s</name>", cp->cp_name);
+        for (i=0; i<PC_NR; i++){
+            if (cp->cp_calls[i].pcs_count == 0)
+                continue;
+            cprintf(cb, "<callback><name>%s</name>", plugin_call_names[i]);
+            plugin_call_stats2cbuf(cb, &cp->cp_calls[i]);
+            cprintf(cb, "</callback>");
+        }
+        cprintf(cb, "</plugin>");
+    }
+    if (ms && (rc = ms->ms_rpc_callbacks) != NULL)
+        do {
+            /* Only the first callback of each rpc, the others are added to it */
+            if ((vec = rpc_callback_lookup(ms, rc->rc_namespace, rc->rc_name, &vlen)) == NULL ||
+                vec[0] != rc)
+                goto next;
+            memset(&pcs, 0, sizeof(pcs));
+            for (i=0; i<vlen; i++){
+                pcs.pcs_count += vec[i]->rc_stats.pcs_count;
+                pcs.pcs_total += vec[i]->rc_stats.pcs_total;
+                if (vec[i]->rc_stats.pcs_max > pcs.pcs_max)
+                    pcs.pcs_max = vec[i]->rc_stats.pcs_max;
+            }
+            if (pcs.pcs_count == 0)
+                goto next;
+            cprintf(cb, "<rpc><namespace>%s</namespace><name>%s</name>",
+                    rc->rc_namespace, rc->rc_name);
+            plugin_call_stats2cbuf(cb, &pcs);
+            cprintf(cb, "</rpc>");
+        next:
+            rc = NEXTQ(rpc_callback_t *, rc);
+        } while (rc != ms->ms_rpc_callbacks);
+    cprintf(cb, "</plugin-calls>");
+    return 0;
+}
+
+/*! Allocate memory in a plugin with memory accounting
+ *
+ * Same as malloc(3), but the memory is included in the plugin memory of the stats rpc.
+ * Free with clixon_plugin_free
+ * @param[in]  size  Size in bytes
+ * @retval     ptr   Allocated memory
+ * @retval     NULL  Error, errno set
+ * @see clixon_plugin_mem_stats
+ */
+void *
+clixon_plugin_malloc(size_t size)
+{
+    plugin_mem_hdr *pm;
+
+    if ((pm = malloc(sizeof(*pm) + size)) == NULL)
+        return NULL;
+    pm->pm_size = size;
+    __atomic_add_fetch(&_plugin_mem_nr, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&_plugin_mem_size, size, __ATOMIC_RELAXED);
+    return pm + 1;
+}
+
+/*! Allocate zeroed memory in a plugin with memory accounting, see calloc(3)
+ *
+ * @param[in]  nmemb Number of elements
+ * @param[in]  size  Size in bytes of element
+ * @retval     ptr   Allocated memory, free with clixon_plugin_free
+ * @retval     NULL  Error, errno set
+ */
+void *
+clixon_plugin_calloc(size_t nmemb,
+                     size_t size)
+{
+    void *p;
+
+    if (size && nmemb > SIZE_MAX / size){
+        errno = ENOMEM;
+        return NULL;
+    }
+    if ((p = clixon_plugin_malloc(nmemb * size)) != NULL)
+        memset(p, 0, nmemb * size);
+    return p;
+}
+
+/*! Change size of memory allocated with clixon_plugin_malloc, see realloc(3)
+ *
+ * @param[in]  ptr   Memory from clixon_plugin_malloc, or NULL
+ * @param[in]  size  New size in bytes
+ * @retval     ptr   Reallocated memory, free with clixon_plugin_free
+ * @retval     NULL  Error, errno set, ptr is unchanged
+ */
+void *
+clixon_plugin_realloc(void  *ptr,
+                      size_t size)
+{
+    plugin_mem_hdr *pm;
+    size_t          oldsize;
+
+    if (ptr == NULL)
+        return clixon_plugin_malloc(size);
+    pm = (plugin_mem_hdr *)ptr - 1;
+    oldsize = pm->pm_size;
+    if ((pm = realloc(pm, sizeof(*pm) + size)) == NULL)
+        return NULL;
+    pm->pm_size = size;
+    __atomic_add_fetch(&_plugin_mem_size, size, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&_plugin_mem_size, oldsize, __ATOMIC_RELAXED);
+    return pm + 1;
+}
+
+/*! Duplicate a string in a plugin with memory accounting, see strdup(3)
+ *
+ * @param[in]  str   String
+ * @retval     dup  Copy of string, free with clixon_plugin_free
+ * @retval     NULL  Error, errno set
+ */
+char *
+clixon_plugin_strdup(const char *str)
+{
+    size_t len = strlen(str) + 1;
+    char  *dup;
+
+    if ((dup = clixon_plugin_malloc(len)) != NULL)
+        memcpy(dup, str, len);
+    return dup;
+}
+
+/*! Free memory allocated with clixon_plugin_malloc et al
+ *
+ * @param[in]  ptr   Memory, or NULL
+ */
+void
+clixon_plugin_free(void *ptr)
+{
+    plugin_mem_hdr *pm;
+
+    if (ptr == NULL)
+        return;
+    pm = (plugin_mem_hdr *)ptr - 1;
+    __atomic_sub_fetch(&_plugin_mem_nr, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&_plugin_mem_size, pm->pm_size, __ATOMIC_RELAXED);
+    free(pm);
+}
+
+/*! Get memory currently allocated by plugins with clixon_plugin_malloc et al
+ *
+ * @param[out] nr    Number of allocations
+ * @param[out] size  Size in bytes, not including malloc overhead
+ */
+void
+clixon_plugin_mem_stats(uint64_t *nr,
+                        size_t   *size)
+{
+    *nr = __atomic_load_n(&_plugin_mem_nr, __ATOMIC_RELAXED);
+    *size = __atomic_load_n(&_plugin_mem_size, __ATOMIC_RELAXED);
+}
+
 /*! Call single plugin start callback
  * @param[in]  cp      Plugin handle
  * @param[in]  h       Clixon handle
@@ -682,13 +1019,20 @@ clixon_plugin_start_one(clixon_plugin_t *cp,
 {
     int         retval = -1;
     plgstart_t *fn;          /* Plugin start */
+    uint64_t    t0;
+    int         ret;
     void       *wh = NULL;
 
     if ((fn = cp->cp_api.ca_start) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, cp->cp_name, __FUNCTION__) < 0)
             goto done;
-        if (fn(h) < 0) {
+        t0 = clixon_plugin_call_start();
+        ret = fn(h);
+        clixon_plugin_call_stats(h, cp, PC_START, t0);
+        clicon_debug(1, "%s: %s started in %" PRIu64 " ms", __FUNCTION__,
+                     cp->cp_name, (clixon_plugin_call_start()-t0)/1000);
+        if (ret < 0) {
             if (clicon_errno < 0) 
                 clicon_log(LOG_WARNING, "%s: Internal error: Start callback in plugin: %s returned -1 but did not make a clicon_err call",
                            __FUNCTION__, cp->cp_name);
@@ -736,13 +1080,18 @@ clixon_plugin_exit_one(clixon_plugin_t *cp,
     int         retval = -1;
     char       *error;
     plgexit_t  *fn;
+    uint64_t    t0;
+    int         ret;
     void       *wh = NULL;
         
     if ((fn = cp->cp_api.ca_exit) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, cp->cp_name, __FUNCTION__) < 0)
             goto done;
-        if (fn(h) < 0) {
+        t0 = clixon_plugin_call_start();
+        ret = fn(h);
+        clixon_plugin_call_stats(h, cp, PC_EXIT, t0);
+        if (ret < 0) {
             if (clicon_errno < 0) 
                 clicon_log(LOG_WARNING, "%s: Internal error: Exit callback in plugin: %s returned -1 but did not make a clicon_err call",
                            __FUNCTION__, cp->cp_name);
@@ -808,13 +1157,17 @@ clixon_plugin_auth_one(clixon_plugin_t     *cp,
     int        retval = -1; 
     plgauth_t *fn;          /* Plugin auth */
     void      *wh = NULL;
+    uint64_t   t0;
 
     clicon_debug(1, "%s", __FUNCTION__);
     if ((fn = cp->cp_api.ca_auth) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, cp->cp_name, __FUNCTION__) < 0)
             goto done;
-        if ((retval = fn(h, req, auth_type, authp)) < 0) {
+        t0 = clixon_plugin_call_start();
+        retval = fn(h, req, auth_type, authp);
+        clixon_plugin_call_stats(h, cp, PC_AUTH, t0);
+        if (retval < 0) {
             if (clicon_errno < 0) 
                 clicon_log(LOG_WARNING, "%s: Internal error: Auth callback in plugin: %s returned -1 but did not make a clicon_err call",
                            __FUNCTION__, cp->cp_name);
@@ -891,13 +1244,18 @@ clixon_plugin_extension_one(clixon_plugin_t *cp,
 {
     int             retval = 1;
     plgextension_t *fn;          /* Plugin extension fn */
+    uint64_t        t0;
+    int             ret;
     void           *wh = NULL;
     
     if ((fn = cp->cp_api.ca_extension) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, cp->cp_name, __FUNCTION__) < 0)
             goto done;
-        if (fn(h, yext, ys) < 0) {
+        t0 = clixon_plugin_call_start();
+        ret = fn(h, yext, ys);
+        clixon_plugin_call_stats(h, cp, PC_EXTENSION, t0);
+        if (ret < 0) {
             if (clicon_errno < 0) 
                 clicon_log(LOG_WARNING, "%s: Internal error: Extension callback in plugin: %s returned -1 but did not make a clicon_err call",
                            __FUNCTION__, cp->cp_name);
@@ -961,13 +1319,18 @@ clixon_plugin_datastore_upgrade_one(clixon_plugin_t   *cp,
 {
     int                  retval = -1;
     datastore_upgrade_t *fn;
+    uint64_t             t0;
+    int                  ret;
     void                *wh = NULL;
     
     if ((fn = cp->cp_api.ca_datastore_upgrade) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, cp->cp_name, __FUNCTION__) < 0)
             goto done;
-        if (fn(h, db, xt, msd) < 0) {
+        t0 = clixon_plugin_call_start();
+        ret = fn(h, db, xt, msd);
+        clixon_plugin_call_stats(h, cp, PC_DATASTORE_UPGRADE, t0);
+        if (ret < 0) {
             if (clicon_errno < 0) 
                 clicon_log(LOG_WARNING, "%s: Internal error: Datastore upgrade callback in plugin: %s returned -1 but did not make a clicon_err call",
                            __FUNCTION__, cp->cp_name);
@@ -1032,13 +1395,18 @@ clixon_plugin_yang_mount_one(clixon_plugin_t *cp,
 {
     int           retval = -1;
     yang_mount_t *fn;
+    uint64_t      t0;
+    int           ret;
     void         *wh = NULL;
     
     if ((fn = cp->cp_api.ca_yang_mount) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, cp->cp_name, __FUNCTION__) < 0)
             goto done;
-        if (fn(h, xt, config, vl, yanglib) < 0) {
+        t0 = clixon_plugin_call_start();
+        ret = fn(h, xt, config, vl, yanglib);
+        clixon_plugin_call_stats(h, cp, PC_YANG_MOUNT, t0);
+        if (ret < 0) {
             if (clicon_errno < 0) 
                 clicon_log(LOG_WARNING, "%s: Internal error: Yang mount callback in plugin: %s returned -1 but did not make a clicon_err call",
                            __FUNCTION__, cp->cp_name);
@@ -1100,13 +1468,18 @@ clixon_plugin_yang_patch_one(clixon_plugin_t *cp,
 {
     int           retval = -1;
     yang_patch_t *fn;
+    uint64_t      t0;
+    int           ret;
     void         *wh = NULL;
     
     if ((fn = cp->cp_api.ca_yang_patch) != NULL){
         wh = NULL;
         if (plugin_context_check(h, &wh, cp->cp_name, __FUNCTION__) < 0)
             goto done;
-        if (fn(h, ymod) < 0) {
+        t0 = clixon_plugin_call_start();
+        ret = fn(h, ymod);
+        clixon_plugin_call_stats(h, cp, PC_YANG_PATCH, t0);
+        if (ret < 0) {
             if (clicon_errno < 0) 
                 clicon_log(LOG_WARNING, "%s: Internal error: Yang patch callback in plugin: %s returned -1 but did not make a clicon_err call",
                            __FUNCTION__, cp->cp_name);
@@ -1166,6 +1539,8 @@ rpc_callback_dump(clicon_handle h)
 
 /*! Register a RPC callback by appending a new RPC to a global list
  *
+ * The callback is also appended to the vector of callbacks of the same namespace and
+ * name in the rpc hash, which is used for dispatch in rpc_callback_call
  * @param[in]  h         clicon handle
  * @param[in]  cb        Callback called 
  * @param[in]  arg       Domain-specific argument to send to callback 
@@ -1182,8 +1557,11 @@ rpc_callback_register(clicon_handle  h,
                       const char    *ns,
                       const char    *name)
 {
-    rpc_callback_t *rc = NULL;
+    rpc_callback_t       *rc = NULL;
     plugin_module_struct *ms = plugin_module_struct_get(h);
+    rpc_callback_t      **vec0;
+    rpc_callback_t      **vec = NULL;
+    size_t                nr = 0;
 
     clicon_debug(1, "%s %s", __FUNCTION__, name);
     if (ms == NULL){
@@ -1203,9 +1581,36 @@ rpc_callback_register(clicon_handle  h,
     rc->rc_arg  = arg;
     rc->rc_namespace  = strdup(ns);
     rc->rc_name  = strdup(name);
+    if (rc->rc_namespace == NULL || rc->rc_name == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (ms->ms_rpc_hash == NULL &&
+        (ms->ms_rpc_hash = clicon_hash_init()) == NULL)
+        goto done;
+    if (ms->ms_rpc_key == NULL &&
+        (ms->ms_rpc_key = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* Hash value is copied, so extend a copy of the vector of existing callbacks */
+    if ((vec0 = rpc_callback_lookup(ms, ns, name, &nr)) == NULL)
+        nr = 0;
+    if ((vec = malloc((nr+1)*sizeof(*vec))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    if (nr)
+        memcpy(vec, vec0, nr*sizeof(*vec));
+    vec[nr++] = rc;
+    if (clicon_hash_add(ms->ms_rpc_hash, cbuf_get(ms->ms_rpc_key), vec, nr*sizeof(*vec)) == NULL)
+        goto done;
+    free(vec);
     ADDQ(rc, ms->ms_rpc_callbacks);
     return 0;
  done:
+    if (vec)
+        free(vec);
     if (rc){
         if (rc->rc_namespace)
             free(rc->rc_namespace);
@@ -1224,20 +1629,31 @@ rpc_callback_delete_all(clicon_handle h)
     rpc_callback_t *rc;
     plugin_module_struct *ms = plugin_module_struct_get(h);
 
-    if (ms != NULL)
-        while((rc = ms->ms_rpc_callbacks) != NULL) {
-            DELQ(rc, ms->ms_rpc_callbacks, rpc_callback_t *);
-            if (rc->rc_namespace)
-                free(rc->rc_namespace);
-            if (rc->rc_name)
-                free(rc->rc_name);
-            free(rc);
-        }
+    if (ms == NULL)
+        return 0;
+    while((rc = ms->ms_rpc_callbacks) != NULL) {
+        DELQ(rc, ms->ms_rpc_callbacks, rpc_callback_t *);
+        if (rc->rc_namespace)
+            free(rc->rc_namespace);
+        if (rc->rc_name)
+            free(rc->rc_name);
+        free(rc);
+    }
+    if (ms->ms_rpc_hash){
+        clicon_hash_free(ms->ms_rpc_hash);
+        ms->ms_rpc_hash = NULL;
+    }
+    if (ms->ms_rpc_key){
+        cbuf_free(ms->ms_rpc_key);
+        ms->ms_rpc_key = NULL;
+    }
     return 0;
 }
 
 /*! Search RPC callbacks and invoke if XML match with tag
  *
+ * The callbacks are found with one rpc hash lookup on namespace and name, and are
+ * called in registration order
  * @param[in]   h       clicon handle
  * @param[in]   xn      Sub-tree (under xorig) at child of rpc: <rpc><xn></rpc>.
  * @param[in]   arg     Domain-speific arg (eg client_entry)
@@ -1260,6 +1676,9 @@ rpc_callback_call(clicon_handle h,
 {
     int                   retval = -1;
     rpc_callback_t       *rc;
+    rpc_callback_t      **vec;
+    size_t                vlen = 0;
+    size_t                i;
     char                 *name;
     char                 *prefix;
     char                 *ns;
@@ -1267,6 +1686,7 @@ rpc_callback_call(clicon_handle h,
     plugin_module_struct *ms = plugin_module_struct_get(h);
     void                 *wh;
     int                   ret;
+    uint64_t              t0;
 
     if (ms == NULL){
         clicon_err(OE_PLUGIN, EINVAL, "plugin module not initialized");
@@ -1275,26 +1695,28 @@ rpc_callback_call(clicon_handle h,
     name = xml_name(xe);
     prefix = xml_prefix(xe);
     xml2ns(xe, prefix, &ns);
-    if ((rc = ms->ms_rpc_callbacks) != NULL)
-        do {
-            if (strcmp(rc->rc_name, name) == 0 &&
-                ns && rc->rc_namespace &&
-                strcmp(rc->rc_namespace, ns) == 0){
-                wh = NULL;
-                if (plugin_context_check(h, &wh, rc->rc_name, __FUNCTION__) < 0)
-                    goto done;
-                if (rc->rc_callback(h, xe, cbret, arg, rc->rc_arg) < 0){
-                    clicon_debug(1, "%s Error in: %s", __FUNCTION__, rc->rc_name);
-                    if (plugin_context_check(h, &wh, rc->rc_name, __FUNCTION__) < 0)
-                        goto done;
-                    goto done;
-                }
-                nr++;
-                if (plugin_context_check(h, &wh, rc->rc_name, __FUNCTION__) < 0)
-                    goto done;
-            }
-            rc = NEXTQ(rpc_callback_t *, rc);
-        } while (rc != ms->ms_rpc_callbacks);
+    if (ns == NULL ||
+        (vec = rpc_callback_lookup(ms, ns, name, &vlen)) == NULL)
+        vlen = 0;
+    /* Note: callbacks may not register rpcs, that would replace vec */
+    for (i=0; i<vlen; i++){
+        rc = vec[i];
+        wh = NULL;
+        if (plugin_context_check(h, &wh, rc->rc_name, __FUNCTION__) < 0)
+            goto done;
+        t0 = clixon_plugin_call_start();
+        ret = rc->rc_callback(h, xe, cbret, arg, rc->rc_arg);
+        plugin_call_stats_add(h, &rc->rc_stats, rc->rc_name, "rpc", t0);
+        if (ret < 0){
+            clicon_debug(1, "%s Error in: %s", __FUNCTION__, rc->rc_name);
+            if (plugin_context_check(h, &wh, rc->rc_name, __FUNCTION__) < 0)
+                goto done;
+            goto done;
+        }
+        nr++;
+        if (plugin_context_check(h, &wh, rc->rc_name, __FUNCTION__) < 0)
+            goto done;
+    }
     /* action reply checked in action_callback_call */
     if (nr && !xml_rpc_isaction(xe)){
         if ((ret = rpc_reply_check(h, name, cbret)) < 0)
@@ -0,0 +1,388 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Pools of short-lived objects recycled between requests, see CLIXON_POOL_SIZE
+ * Requests in the backend, restconf and netconf allocate many buffers, namespace contexts
+ * and small trees that are freed at the end of the request. Instead of malloc and free
+ * each time, freed objects are kept in pools and reused by later requests.
+ * - Pools are only used by the thread that called clixon_pool_init, other threads, eg
+ *   datastore writer and sort threads, allocate and free as usual.
+ * - Objects from a pool may be freed as usual, and objects not from a pool may be put
+ *   in a pool.
+ * - At the end of a request, clixon_pool_trim frees the objects that were not needed,
+ *   ie beyond the high-water mark of objects in use since the last trim.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_pool.h"
+
+#ifdef CLIXON_POOL_SIZE
+
+/*! Pool of free objects of one kind
+ */
+struct clixon_pool{
+    void   *pl_vec[CLIXON_POOL_SIZE]; /* Free objects */
+    int     pl_len;     /* Number of free objects */
+    int     pl_used;    /* Objects taken and not yet put back */
+    int     pl_hwm;     /* Max of pl_used since last trim */
+    size_t  pl_size;    /* Size of blocks, block pool only */
+    void  (*pl_free)(void *); /* Free an object */
+};
+
+static void pool_cbuf_free(void *p) { cbuf_free((cbuf*)p); }
+static void pool_cvec_free(void *p) { cvec_free((cvec*)p); }
+
+static struct clixon_pool _pool_cbuf = {.pl_free = pool_cbuf_free};
+static struct clixon_pool _pool_cvec = {.pl_free = pool_cvec_free};
+static struct clixon_pool _pool_block = {.pl_free = free};
+
+/* Thread using pools, see clixon_pool_init */
+static pthread_t _pool_owner;
+static int       _pool_enabled = 0;
+
+/* Statistics, see clixon_pool_stats */
+static uint64_t _pool_hits = 0;
+static uint64_t _pool_misses = 0;
+
+/*! Take a free object from pool
+ *
+ * @param[in]  pl   Pool
+ * @retval     p    Free object
+ * @retval     NULL Pool is empty, allocate a new object
+ */
+static void *
+pool_take(struct clixon_pool *pl)
+{
+    if (++pl->pl_used > pl->pl_hwm)
+        pl->pl_hwm = pl->pl_used;
+    if (pl->pl_len == 0){
+        _pool_misses++;
+        return NULL;
+    }
+    _pool_hits++;
+    return pl->pl_vec[--pl->pl_len];
+}
+
+/*! Put an object in pool, or free it if the pool is full
+ *
+ * @param[in]  pl   Pool
+ * @param[in]  p    Object
+ */
+static void
+pool_give(struct clixon_pool *pl,
+          void               *p)
+{
+    if (pl->pl_used > 0)
+        pl->pl_used--;
+    if (pl->pl_len < CLIXON_POOL_SIZE)
+        pl->pl_vec[pl->pl_len++] = p;
+    else
+        pl->pl_free(p);
+}
+
+/*! Free the free objects of a pool beyond its high-water mark
+ *
+ * @param[in]  pl   Pool
+ * @param[in]  keep Number of free objects to keep
+ */
+static void
+pool_trim(struct clixon_pool *pl,
+          int                 keep)
+{
+    while (pl->pl_len > keep)
+        pl->pl_free(pl->pl_vec[--pl->pl_len]);
+}
+#endif /* CLIXON_POOL_SIZE */
+
+/*! Use pools in the calling thread
+ *
+ * Call once in the main thread of a daemon, before requests are handled. Before this call,
+ * and in other threads, objects are allocated and freed as usual.
+ * @retval     0    OK
+ */
+int
+clixon_pool_init(void)
+{
+#ifdef CLIXON_POOL_SIZE
+    _pool_owner = pthread_self();
+    _pool_enabled = 1;
+#endif
+    return 0;
+}
+
+/*! Check if pools are used by the calling thread
+ *
+ * @retval     1    Yes, the caller may use pools
+ * @retval     0    No, allocate and free as usual
+ */
+int
+clixon_pool_owner(void)
+{
+#ifdef CLIXON_POOL_SIZE
+    return _pool_enabled && pthread_equal(_pool_owner, pthread_self());
+#else
+    return 0;
+#endif
+}
+
+/*! Get an empty cbuf, from the pool if possible
+ *
+ * Same as cbuf_new, free with clixon_cbuf_put or cbuf_free
+ * @retval     cb   Empty cbuf
+ * @retval     NULL Error, errno set
+ * @code
+ *   cbuf *cb;
+ *   if ((cb = clixon_cbuf_get()) == NULL){
+ *      clicon_err(OE_UNIX, errno, "cbuf_new");
+ *      goto done;
+ *   }
+ *   ...
+ *   clixon_cbuf_put(cb);
+ * @endcode
+ */
+cbuf *
+clixon_cbuf_get(void)
+{
+#ifdef CLIXON_POOL_SIZE
+    cbuf *cb;
+
+    if (clixon_pool_owner() && (cb = pool_take(&_pool_cbuf)) != NULL)
+        return cb;
+#endif
+    return cbuf_new();
+}
+
+/*! Put a cbuf in the pool when it is no longer used, or free it
+ *
+ * A cbuf whose buffer has grown larger than CLIXON_POOL_TRIM is freed.
+ * @param[in]  cb   cbuf, from clixon_cbuf_get or cbuf_new, or NULL
+ * @retval     0    OK
+ */
+int
+clixon_cbuf_put(cbuf *cb)
+{
+    if (cb == NULL)
+        return 0;
+#ifdef CLIXON_POOL_SIZE
+    if (clixon_pool_owner()){
+        if (cbuf_buflen(cb) > CLIXON_POOL_TRIM){
+            if (_pool_cbuf.pl_used > 0)
+                _pool_cbuf.pl_used--;
+            cbuf_free(cb);
+        }
+        else {
+            cbuf_reset(cb);
+            pool_give(&_pool_cbuf, cb);
+        }
+        return 0;
+    }
+#endif
+    cbuf_free(cb);
+    return 0;
+}
+
+/*! Get an empty cvec, eg a namespace context, from the pool if possible
+ *
+ * Same as cvec_new(0), free with clixon_cvec_put or cvec_free
+ * @retval     cvv  Empty cvec
+ * @retval     NULL Error, errno set
+ * @see xml_nsctx_init
+ */
+cvec *
+clixon_cvec_get(void)
+{
+#ifdef CLIXON_POOL_SIZE
+    cvec *cvv;
+
+    if (clixon_pool_owner() && (cvv = pool_take(&_pool_cvec)) != NULL)
+        return cvv;
+#endif
+    return cvec_new(0);
+}
+
+/*! Put a cvec in the pool when it is no longer used, or free it
+ *
+ * @param[in]  cvv  cvec, from clixon_cvec_get or cvec_new, or NULL
+ * @retval     0    OK
+ * @see xml_nsctx_free
+ */
+int
+clixon_cvec_put(cvec *cvv)
+{
+    if (cvv == NULL)
+        return 0;
+#ifdef CLIXON_POOL_SIZE
+    if (clixon_pool_owner()){
+        cvec_reset(cvv);
+        pool_give(&_pool_cvec, cvv);
+        return 0;
+    }
+#endif
+    cvec_free(cvv);
+    return 0;
+}
+
+/*! Get a memory block, from the pool if possible
+ *
+ * The pool keeps blocks of one size, the size of the first block put. Used for the slabs
+ * of XML arenas, ie the nodes of short-lived trees.
+ * @param[in]  size Size of block
+ * @retval     p    Block, not zeroed, free with clixon_block_put or free
+ * @retval     NULL Error, errno set
+ */
+void *
+clixon_block_get(size_t size)
+{
+#ifdef CLIXON_POOL_SIZE
+    void *p;
+
+    if (clixon_pool_owner() && size == _pool_block.pl_size &&
+        (p = pool_take(&_pool_block)) != NULL)
+        return p;
+#endif
+    return malloc(size);
+}
+
+/*! Put a memory block in the pool when it is no longer used, or free it
+ *
+ * @param[in]  p    Block, or NULL
+ * @param[in]  size Size of block
+ * @retval     0    OK
+ */
+int
+clixon_block_put(void  *p,
+                 size_t size)
+{
+    if (p == NULL)
+        return 0;
+#ifdef CLIXON_POOL_SIZE
+    if (clixon_pool_owner()){
+        if (_pool_block.pl_size == 0)
+            _pool_block.pl_size = size;
+        if (size == _pool_block.pl_size){
+            pool_give(&_pool_block, p);
+            return 0;
+        }
+    }
+#endif
+    free(p);
+    return 0;
+}
+
+/*! Trim pools to the high-water mark of objects in use since the last trim
+ *
+ * Call at the end of a request. Objects in pools beyond what was needed are freed, so that
+ * pools shrink after a large request
+ * @retval     0    OK
+ */
+int
+clixon_pool_trim(void)
+{
+#ifdef CLIXON_POOL_SIZE
+    struct clixon_pool *pools[] = {&_pool_cbuf, &_pool_cvec, &_pool_block};
+    struct clixon_pool *pl;
+    int                 i;
+
+    if (!clixon_pool_owner())
+        return 0;
+    for (i=0; i<sizeof(pools)/sizeof(pools[0]); i++){
+        pl = pools[i];
+        pool_trim(pl, pl->pl_hwm - pl->pl_used);
+        pl->pl_hwm = pl->pl_used;
+    }
+#endif
+    return 0;
+}
+
+/*! Get statistics of pools
+ *
+ * @param[out] hitsp    Number of objects taken from pools
+ * @param[out] missesp  Number of objects allocated since pools were empty
+ * @param[out] szp      Approximate memory of free objects in pools
+ * @retval     0        OK
+ */
+int
+clixon_pool_stats(uint64_t *hitsp,
+                  uint64_t *missesp,
+                  size_t   *szp)
+{
+    size_t sz = 0;
+#ifdef CLIXON_POOL_SIZE
+    int    i;
+
+    for (i=0; i<_pool_cbuf.pl_len; i++)
+        sz += cbuf_buflen((cbuf*)_pool_cbuf.pl_vec[i]);
+    sz += _pool_block.pl_len * _pool_block.pl_size;
+    *hitsp = _pool_hits;
+    *missesp = _pool_misses;
+#else
+    *hitsp = 0;
+    *missesp = 0;
+#endif
+    *szp = sz;
+    return 0;
+}
+
+/*! Free all objects in pools, and stop using pools
+ *
+ * Call at exit, eg after clixon_err_exit
+ * @retval     0    OK
+ */
+int
+clixon_pool_exit(void)
+{
+#ifdef CLIXON_POOL_SIZE
+    pool_trim(&_pool_cbuf, 0);
+    pool_trim(&_pool_cvec, 0);
+    pool_trim(&_pool_block, 0);
+    _pool_enabled = 0;
+#endif
+    return 0;
+}
@@ -77,6 +77,11 @@
           |                 restart|  | restart
           |                        v  |
           wait(stop) ------- EXITING(dying pid) <----> kill after timeout
+
+  Reaping:
+     On Linux a pidfd of each started process is registered in the event loop, and the process
+     is waited for directly when it exits. If pidfd is not available, SIGCHLD triggers a wait of
+     all processes. A process not exiting PROC_STOP_TIMEOUT seconds after SIGTERM gets SIGKILL.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -107,6 +112,9 @@
 #include <sys/user.h>
 #include <sys/time.h>
 #include <sys/resource.h>
+#ifdef __linux__
+#include <sys/syscall.h> /* pidfd_open */
+#endif
 
 #include <cligen/cligen.h>
 
@@ -156,10 +164,14 @@ struct process_entry_t {
     pid_t          pe_exit_status;/* Status on exit as defined in waitpid */
     struct timeval pe_starttime; /* Start time */
     proc_cb_t     *pe_callback;  /* Wrapper function, may be called from process_operation  */
+    int            pe_pidfd;     /* Process file descriptor of pid registered in event loop, or -1 */
+    struct timeval pe_killtime;  /* Time of first SIGTERM when stopped or restarted */
 };
 
 /* Forward declaration */
 static int clixon_process_sched_register(clicon_handle h, int delay);
+static int clixon_process_pidfd_open(process_entry_t *pe);
+static int clixon_process_pidfd_close(process_entry_t *pe);
 
 static void
 clixon_proc_sigint(int sig)
@@ -514,6 +526,7 @@ clixon_process_register(clicon_handle h,
         }
     }
     pe->pe_callback = callback;
+    pe->pe_pidfd = -1;
     clicon_debug(1, "%s %s ----> %s", __FUNCTION__,
                  pe->pe_name, 
                  clicon_int2str(proc_state_map, PROC_STATE_STOPPED)
@@ -530,6 +543,7 @@ clixon_process_delete_only(process_entry_t *pe)
 {
     char           **pa;
 
+    clixon_process_pidfd_close(pe);
     if (pe->pe_name)
         free(pe->pe_name);
     if (pe->pe_description)
@@ -677,6 +691,7 @@ clixon_process_operation(clicon_handle  h,
                         clicon_log(LOG_NOTICE, "Killing old process %s with pid: %d",
                                    pe->pe_name, pe->pe_pid); /* XXX pid may be 0 */
                         kill(pe->pe_pid, SIGTERM);
+                        gettimeofday(&pe->pe_killtime, NULL);
                         delay = 1;
                     }
                     clicon_debug(1, "%s %s(%d) %s --%s--> %s", __FUNCTION__,
@@ -833,6 +848,8 @@ clixon_process_sched(int           fd,
     process_entry_t *pe;
     int              isrunning; /* Process is actually running */
     int              sched = 0;
+    struct timeval   now;
+    struct timeval   td;
 
     clicon_debug(1, "%s",__FUNCTION__);
     if (_proc_entry_list == NULL)
@@ -852,9 +869,17 @@ clixon_process_sched(int           fd,
                     if (proc_op_run(pe->pe_pid, &isrunning) < 0)
                         goto done;                  
                     if (isrunning) {
-                        clicon_log(LOG_NOTICE, "Killing old process %s with pid: %d",
-                                   pe->pe_name, pe->pe_pid); /* XXX pid may be 0 */
-                        kill(pe->pe_pid, SIGTERM);
+                        gettimeofday(&now, NULL);
+                        if (!timerisset(&pe->pe_killtime))
+                            pe->pe_killtime = now;
+                        timersub(&now, &pe->pe_killtime, &td);
+                        if (td.tv_sec >= PROC_STOP_TIMEOUT){
+                            clicon_log(LOG_NOTICE, "Process %s with pid: %d did not exit in %ds, sending SIGKILL",
+                                       pe->pe_name, pe->pe_pid, PROC_STOP_TIMEOUT);
+                            kill(pe->pe_pid, SIGKILL);
+                        }
+                        else
+                            kill(pe->pe_pid, SIGTERM);
                         sched++; /* Not immediate: wait timeout */
                     }
                 default:
@@ -869,11 +894,14 @@ clixon_process_sched(int           fd,
                     isrunning = 0;
                     if (proc_op_run(pe->pe_pid, &isrunning) < 0)
                         goto done;
-                    if (!isrunning)
+                    if (!isrunning){
                         if (clixon_proc_background(pe->pe_argv, pe->pe_netns,
                                                    pe->pe_uid, pe->pe_gid, pe->pe_fdkeep,
                                                    &pe->pe_pid) < 0)
                             goto done;
+                        if (clixon_process_pidfd_open(pe) < 0)
+                            goto done;
+                    }
                     clicon_debug(1, "%s %s(%d) %s --%s--> %s", __FUNCTION__,
                                  pe->pe_name, pe->pe_pid,
                                  clicon_int2str(proc_state_map, pe->pe_state),
@@ -901,6 +929,8 @@ clixon_process_sched(int           fd,
                                                pe->pe_uid, pe->pe_gid, pe->pe_fdkeep,
                                                &pe->pe_pid) < 0)
                         goto done;
+                    if (clixon_process_pidfd_open(pe) < 0)
+                        goto done;
                     clicon_debug(1, "%s %s(%d) %s --%s--> %s", __FUNCTION__,
                                  pe->pe_name, pe->pe_pid,
                                  clicon_int2str(proc_state_map, pe->pe_state),
@@ -956,9 +986,143 @@ clixon_process_sched_register(clicon_handle h,
     return retval;
 }
 
+/*! Process state transition after a process has been waited for
+ *
+ * @param[in]  pe      Process entry
+ * @param[in]  status  Exit status as returned by waitpid
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+clixon_process_reap(process_entry_t *pe,
+                    int              status)
+{
+    int retval = -1;
+
+    clicon_debug(1, "%s waitpid(%d) waited", __FUNCTION__, pe->pe_pid);
+    clixon_process_pidfd_close(pe);
+    pe->pe_exit_status = status;
+    timerclear(&pe->pe_killtime);
+    switch (pe->pe_operation){
+    case PROC_OP_NONE: /* Spontaneous / External termination */
+    case PROC_OP_STOP:
+        clicon_debug(1, "%s %s(%d) %s --%s--> %s", __FUNCTION__,
+                     pe->pe_name, pe->pe_pid,
+                     clicon_int2str(proc_state_map, pe->pe_state),
+                     clicon_int2str(proc_operation_map, pe->pe_operation),
+                     clicon_int2str(proc_state_map, PROC_STATE_STOPPED)
+                     );
+        pe->pe_state = PROC_STATE_STOPPED;
+        pe->pe_pid = 0;       
+        timerclear(&pe->pe_starttime);
+        break;
+    case PROC_OP_RESTART:
+        /* This is the case where there is an existing process running.
+         * it was killed above but still runs and needs to be reaped */
+        if (clixon_proc_background(pe->pe_argv, pe->pe_netns,
+                                   pe->pe_uid, pe->pe_gid, pe->pe_fdkeep,
+                                   &pe->pe_pid) < 0)
+            goto done;
+        if (clixon_process_pidfd_open(pe) < 0)
+            goto done;
+        clicon_debug(1, "%s %s(%d) %s --%s--> %s", __FUNCTION__,
+                     pe->pe_name, pe->pe_pid,
+                     clicon_int2str(proc_state_map, pe->pe_state),
+                     clicon_int2str(proc_operation_map, pe->pe_operation),
+                     clicon_int2str(proc_state_map, PROC_STATE_RUNNING)
+                     );
+        pe->pe_state = PROC_STATE_RUNNING;
+        gettimeofday(&pe->pe_starttime, NULL);
+        break;
+    default:
+        break;
+    }
+    pe->pe_operation = PROC_OP_NONE;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Process file descriptor readable: the process has exited, wait for it
+ *
+ * @param[in]  fd   Process file descriptor
+ * @param[in]  arg  Process entry
+ * @see clixon_process_pidfd_open
+ */
+static int
+clixon_process_pidfd_cb(int   fd,
+                        void *arg)
+{
+    int              retval = -1;
+    process_entry_t *pe = (process_entry_t *)arg;
+    int              status = 0;
+    pid_t            wpid;
+
+    clicon_debug(1, "%s %s(%d)", __FUNCTION__, pe->pe_name, pe->pe_pid);
+    if ((wpid = waitpid(pe->pe_pid, &status, WNOHANG)) == pe->pe_pid){
+        if (clixon_process_reap(pe, status) < 0)
+            goto done;
+    }
+    else if (wpid < 0){
+        /* Already waited for elsewhere, fall back to SIGCHLD */
+        clicon_debug(1, "%s waitpid(%d): %s", __FUNCTION__, pe->pe_pid, strerror(errno));
+        clixon_process_pidfd_close(pe);
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Open a process file descriptor of a started process and register it in the event loop
+ *
+ * A process with a pidfd is waited for when it exits, without a scan of all processes.
+ * If pidfd is not supported, pe_pidfd is left as -1 and the process is waited for on SIGCHLD
+ * @param[in]  pe   Process entry with pe_pid set
+ * @retval     0    OK, also if pidfd is not supported
+ * @retval    -1    Error
+ * @see clixon_process_waitpid  Fallback
+ */
+static int
+clixon_process_pidfd_open(process_entry_t *pe)
+{
+#ifdef SYS_pidfd_open
+    int fd;
+
+    clixon_process_pidfd_close(pe);
+    if (pe->pe_pid == 0)
+        return 0;
+    if ((fd = syscall(SYS_pidfd_open, pe->pe_pid, 0)) < 0){
+        clicon_debug(1, "%s pidfd_open(%d): %s", __FUNCTION__, pe->pe_pid, strerror(errno));
+        return 0;
+    }
+    if (clixon_event_reg_fd(fd, clixon_process_pidfd_cb, pe, "process pidfd") < 0){
+        close(fd);
+        return -1;
+    }
+    pe->pe_pidfd = fd;
+#endif /* SYS_pidfd_open */
+    return 0;
+}
+
+/*! Unregister and close the process file descriptor of a process, if any
+ *
+ * @param[in]  pe   Process entry
+ */
+static int
+clixon_process_pidfd_close(process_entry_t *pe)
+{
+    if (pe->pe_pidfd != -1){
+        clixon_event_unreg_fd(pe->pe_pidfd, clixon_process_pidfd_cb);
+        close(pe->pe_pidfd);
+        pe->pe_pidfd = -1;
+    }
+    return 0;
+}
+
 /*! Go through processes and wait for child processes
  * Typically we know a child has been killed by SIGCHLD, but we do not know which process it is
  * Traverse all known processes and reap them, eg call waitpid() to avoid zombies.
+ * Processes with a pidfd are skipped, they are waited for in clixon_process_pidfd_cb
  * @param[in]  h  Clixon handle
  */
 int
@@ -978,48 +1142,13 @@ clixon_process_waitpid(clicon_handle h)
                      pe->pe_name, pe->pe_pid,
                      clicon_int2str(proc_state_map, pe->pe_state),
                      clicon_int2str(proc_operation_map, pe->pe_operation));
-        if (pe->pe_pid != 0
+        if (pe->pe_pid != 0 && pe->pe_pidfd == -1
             && (pe->pe_state == PROC_STATE_RUNNING || pe->pe_state == PROC_STATE_EXITING)
-            //      && (pe->pe_operation == PROC_OP_STOP || pe->pe_operation == PROC_OP_RESTART)
             ){
             clicon_debug(1, "%s %s waitpid(%d)", __FUNCTION__, pe->pe_name, pe->pe_pid);
             if ((wpid = waitpid(pe->pe_pid, &status, WNOHANG)) == pe->pe_pid){
-                clicon_debug(1, "%s waitpid(%d) waited", __FUNCTION__, pe->pe_pid);
-                pe->pe_exit_status = status;
-                switch (pe->pe_operation){
-                case PROC_OP_NONE: /* Spontaneous / External termination */
-                case PROC_OP_STOP:
-                    clicon_debug(1, "%s %s(%d) %s --%s--> %s", __FUNCTION__,
-                                 pe->pe_name, pe->pe_pid,
-                                 clicon_int2str(proc_state_map, pe->pe_state),
-                                 clicon_int2str(proc_operation_map, pe->pe_operation),
-                                 clicon_int2str(proc_state_map, PROC_STATE_STOPPED)
-                                 );
-                    pe->pe_state = PROC_STATE_STOPPED;
-                    pe->pe_pid = 0;       
-                    timerclear(&pe->pe_starttime);
-                    break;
-                case PROC_OP_RESTART:
-                    /* This is the case where there is an existing process running.
-                     * it was killed above but still runs and needs to be reaped */
-                    if (clixon_proc_background(pe->pe_argv, pe->pe_netns,
-                                               pe->pe_uid, pe->pe_gid, pe->pe_fdkeep,
-                                               &pe->pe_pid) < 0)
-                        goto done;
-                    gettimeofday(&pe->pe_starttime, NULL);
-                    clicon_debug(1, "%s %s(%d) %s --%s--> %s", __FUNCTION__,
-                                 pe->pe_name, pe->pe_pid,
-                                 clicon_int2str(proc_state_map, pe->pe_state),
-                                 clicon_int2str(proc_operation_map, pe->pe_operation),
-                                 clicon_int2str(proc_state_map, PROC_STATE_RUNNING)
-                                 );
-                    pe->pe_state = PROC_STATE_RUNNING;
-                    gettimeofday(&pe->pe_starttime, NULL);
-                    break;
-                default:
-                    break;
-                }
-                pe->pe_operation = PROC_OP_NONE;
+                if (clixon_process_reap(pe, status) < 0)
+                    goto done;
                 break; /* pid is unique */
             }
             else
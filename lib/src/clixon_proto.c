@@ -56,6 +56,7 @@
 #include <sys/time.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <sys/un.h>
 #include <arpa/inet.h>
@@ -74,6 +75,8 @@
 #include "clixon_sig.h"
 #include "clixon_xml.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_bind.h"
+#include "clixon_xml_binary.h"
 #include "clixon_netconf_lib.h"
 #include "clixon_options.h"
 #include "clixon_proto.h"
@@ -173,8 +176,41 @@ clicon_msg_encode(uint32_t      id,
     return msg;
 }
 
+/*! Encode a clicon message with a body of given length, eg binary
+ *
+ * @param[in] id      Session id of client, or CLICON_MSG_ID_MORE
+ * @param[in] data    Body, copied
+ * @param[in] datalen Length of body, including terminating null byte if any
+ * @retval    msg     Clicon message to send to eg clicon_msg_send(). Free with free()
+ * @retval    NULL    Error
+ * @see clicon_msg_encode  for XML strings
+ */
+struct clicon_msg *
+clicon_msg_encode_buf(uint32_t id,
+                      char    *data,
+                      uint32_t datalen)
+{
+    struct clicon_msg *msg = NULL;
+    uint32_t           len;
+
+    len = sizeof(*msg) + datalen;
+    /* Extra null byte for debug printing of bodies that are not null-terminated */
+    if ((msg = (struct clicon_msg *)malloc(len+1)) == NULL){
+        clicon_err(OE_PROTO, errno, "malloc");
+        return NULL;
+    }
+    memset(msg, 0, len+1);
+    msg->op_len = htonl(len);
+    msg->op_id = htonl(id);
+    if (datalen > 0)
+        memcpy(msg->op_body, data, datalen);
+    return msg;
+}
+
 /*! Decode a clicon netconf message
  *
+ * The body is either a null-terminated XML string, or a binary encoding followed by a null
+ * byte, see clixon_xml2binary_cbuf and CLICON_PROTO_BINARY
  * @param[in]  msg    Clixon msg
  * @param[in]  yspec  Yang specification, (can be NULL)
  * @param[out] id     Session id
@@ -191,9 +227,10 @@ clicon_msg_decode(struct clicon_msg *msg,
                   cxobj            **xml,
                   cxobj            **xerr)
 {
-    int    retval = -1;
-    char  *xmlstr;
-    int    ret;
+    int      retval = -1;
+    char    *xmlstr;
+    uint32_t len;
+    int      ret;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
     /* hdr */
@@ -201,8 +238,14 @@ clicon_msg_decode(struct clicon_msg *msg,
         *id = ntohl(msg->op_id);
     /* body */
     xmlstr = msg->op_body;
+    len = ntohl(msg->op_len) - sizeof(*msg);
     // XXX    clicon_debug(CLIXON_DBG_MSG, "Recv: %s", xmlstr);
-    if ((ret = clixon_xml_parse_string(xmlstr, yspec?YB_RPC:YB_NONE, yspec, xml, xerr)) < 0)
+    if (len > strlen(XML_BINARY_MAGIC) &&
+        memcmp(xmlstr, XML_BINARY_MAGIC, strlen(XML_BINARY_MAGIC)) == 0){
+        if ((ret = clixon_binary_parse_buf(xmlstr, len-1, yspec?YB_RPC:YB_NONE, yspec, xml, xerr)) < 0)
+            goto done;
+    }
+    else if ((ret = clixon_xml_parse_string(xmlstr, yspec?YB_RPC:YB_NONE, yspec, xml, xerr)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -301,6 +344,59 @@ atomicio(ssize_t (*fn) (int, void *, size_t),
     return (pos);
 }
 
+/*! Ensure all of an io vector is written to socket
+ *
+ * As atomicio for write, but the vector is written with writev without first copying it
+ * into one buffer. The vector is modified.
+ * @param[in]  fd     File descriptor, eg socket
+ * @param[in]  iov    I/O vector, modified
+ * @param[in]  iovcnt Number of elements of iov
+ * @retval     n      Number of bytes written, less than length of iov on closed socket
+ * @retval    -1      Error
+ * @see atomicio
+ */
+static ssize_t
+atomicio_writev(int           fd,
+                struct iovec *iov,
+                int           iovcnt)
+{
+    ssize_t res;
+    ssize_t pos = 0;
+
+    while (iovcnt > 0) {
+        if (iov->iov_len == 0){
+            iov++;
+            iovcnt--;
+            continue;
+        }
+        _atomicio_sig = 0;
+        if ((res = writev(fd, iov, iovcnt)) < 0){
+            if (errno == EINTR){
+                if (_atomicio_sig == 0)
+                    continue;
+            }
+            else if (errno == EAGAIN)
+                continue;
+            else if (errno == ECONNRESET || errno == EPIPE || errno == EBADF)
+                return pos;
+            return -1;
+        }
+        if (res == 0)
+            return pos;
+        pos += res;
+        while (iovcnt > 0 && res >= iov->iov_len){
+            res -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0){
+            iov->iov_base = (char*)iov->iov_base + res;
+            iov->iov_len -= res;
+        }
+    }
+    return pos;
+}
+
 /*! Log message as hex on debug.
  *
  * @param[in]  dbglevel Debug level
@@ -382,46 +478,80 @@ clicon_msg_send(int                s,
     return retval;
 }
 
-/*! Receive a Clixon message using IPC message struct
+/*! Send a Clixon message given as header fields and body, without copying the body
  *
- * XXX: timeout? and signals?
- * There is rudimentary code for turning on signals and handling them 
- * so that they can be interrupted by ^C. But the problem is that this
- * is a library routine and such things should be set up in the cli 
- * application for example: a daemon calling this function will want another 
- * behaviour.
- * Now, ^C will interrupt the whole process, and this may not be what you want.
+ * The header and body are written with one writev(2) call if possible, instead of first
+ * encoding them in one message as clicon_msg_encode_buf
+ * @param[in]  s       Socket (unix or inet) to communicate with backend
+ * @param[in]  descr   Description of peer for logging
+ * @param[in]  id      Session id of client, or CLICON_MSG_ID_MORE
+ * @param[in]  data    Body
+ * @param[in]  datalen Length of body, including terminating null byte if any
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clicon_msg_send
+ */
+int
+clicon_msg_send_buf(int         s,
+                    const char *descr,
+                    uint32_t    id,
+                    char       *data,
+                    uint32_t    datalen)
+{
+    int               retval = -1;
+    struct clicon_msg hdr;
+    struct iovec      iov[2];
+    int               e;
+
+    hdr.op_len = htonl(sizeof(hdr) + datalen);
+    hdr.op_id = htonl(id);
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: send msg len=%zu", __FUNCTION__, sizeof(hdr) + datalen);
+    if (id != CLICON_MSG_ID_MORE && datalen){ /* Only last fragment is null-terminated */
+        if (descr)
+            clicon_debug(CLIXON_DBG_MSG, "Send [%s]: %s", descr, data);
+        else
+            clicon_debug(CLIXON_DBG_MSG, "Send: %s", data);
+    }
+    msg_hex(CLIXON_DBG_EXTRA, (char*)&hdr, sizeof(hdr), __FUNCTION__);
+    msg_hex(CLIXON_DBG_EXTRA, data, datalen, __FUNCTION__);
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = data;
+    iov[1].iov_len = datalen;
+    if (atomicio_writev(s, iov, 2) < 0){
+        e = errno;
+        clicon_err(OE_CFG, e, "atomicio_writev");
+        clicon_log(LOG_WARNING, "%s: writev: %s len:%u", __FUNCTION__,
+                   strerror(e), datalen);
+        goto done;
+    }
+    retval = 0;
+  done:
+    return retval;
+}
+
+/*! Receive one Clixon message frame
  *
  * @param[in]   s     Socket (unix or inet) to communicate with backend
- * @param[in]   descr Description of peer for logging
  * @param[in]   intr  If set, make a ^C cause an error   
- * @param[out]  msg   Clixon msg data reply structure. Free with free()
+ * @param[out]  msg   Clixon msg frame. Free with free()
  * @param[out]  eof   Set if eof encountered
  * @retval      0     OK
  * @retval     -1     Error
- * Note: caller must ensure that s is closed if eof is set after call.
- * @see clicon_msg_rcv1 using plain NETCONF
+ * @see clicon_msg_rcv
  */
-int
-clicon_msg_rcv(int                 s,
-               const char         *descr,
-               int                 intr,
-               struct clicon_msg **msg,
-               int                *eof)
+static int
+msg_rcv_frame(int                 s,
+              int                 intr,
+              struct clicon_msg **msg,
+              int                *eof)
 { 
     int               retval = -1;
     struct clicon_msg hdr;
     int               hlen;
     ssize_t           len2;
-    sigfn_t           oldhandler;
     uint32_t          mlen;
 
-    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
-    *eof = 0;
-    if (intr){
-        clicon_signal_unblock(SIGINT);
-        set_signal_flags(SIGINT, 0, atomicio_sig_handler, &oldhandler);
-    }
     if ((hlen = atomicio(read, s, &hdr, sizeof(hdr))) < 0){ 
         if (intr && _atomicio_sig)
             ;
@@ -464,6 +594,77 @@ clicon_msg_rcv(int                 s,
         *eof = 1;
         goto ok;
     }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Receive a Clixon message using IPC message struct
+ *
+ * A reply streamed in fragments, see send_msg_reply_part, is received as one message.
+ * XXX: timeout? and signals?
+ * There is rudimentary code for turning on signals and handling them 
+ * so that they can be interrupted by ^C. But the problem is that this
+ * is a library routine and such things should be set up in the cli 
+ * application for example: a daemon calling this function will want another 
+ * behaviour.
+ * Now, ^C will interrupt the whole process, and this may not be what you want.
+ *
+ * @param[in]   s     Socket (unix or inet) to communicate with backend
+ * @param[in]   descr Description of peer for logging
+ * @param[in]   intr  If set, make a ^C cause an error   
+ * @param[out]  msg   Clixon msg data reply structure. Free with free()
+ * @param[out]  eof   Set if eof encountered
+ * @retval      0     OK
+ * @retval     -1     Error
+ * Note: caller must ensure that s is closed if eof is set after call.
+ * @see clicon_msg_rcv1 using plain NETCONF
+ */
+int
+clicon_msg_rcv(int                 s,
+               const char         *descr,
+               int                 intr,
+               struct clicon_msg **msg,
+               int                *eof)
+{ 
+    int                retval = -1;
+    sigfn_t            oldhandler;
+    struct clicon_msg *frame = NULL;
+    struct clicon_msg *m;
+    uint32_t           mlen;
+    uint32_t           flen;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    *eof = 0;
+    if (intr){
+        clicon_signal_unblock(SIGINT);
+        set_signal_flags(SIGINT, 0, atomicio_sig_handler, &oldhandler);
+    }
+    if (msg_rcv_frame(s, intr, msg, eof) < 0)
+        goto done;
+    /* Append fragments of a streamed reply to the first */
+    while (!*eof && ntohl((*msg)->op_id) == CLICON_MSG_ID_MORE){
+        if (msg_rcv_frame(s, intr, &frame, eof) < 0)
+            goto done;
+        if (*eof)
+            break;
+        mlen = ntohl((*msg)->op_len);
+        flen = ntohl(frame->op_len) - sizeof(*frame);
+        if ((m = realloc(*msg, mlen + flen + 1)) == NULL){
+            clicon_err(OE_PROTO, errno, "realloc");
+            goto done;
+        }
+        *msg = m;
+        memcpy((char*)m + mlen, frame->op_body, flen);
+        m->op_len = htonl(mlen + flen);
+        m->op_id = frame->op_id;
+        free(frame);
+        frame = NULL;
+    }
+    if (*eof)
+        goto ok;
+    mlen = ntohl((*msg)->op_len);
     if (((char*)*msg)[mlen-1] != '\0'){
         clicon_err(OE_PROTO, 0, "body not NULL terminated");
         *eof = 1;
@@ -477,6 +678,8 @@ clicon_msg_rcv(int                 s,
     retval = 0;
  done:
     clicon_debug(CLIXON_DBG_DETAIL, "%s retval:%d", __FUNCTION__, retval);
+    if (frame)
+        free(frame);
     if (intr){
         set_signal(SIGINT, oldhandler, NULL);
         clicon_signal_block(SIGINT);
@@ -778,24 +981,31 @@ send_msg_reply(int         s,
                char       *data, 
                uint32_t    datalen)
 {
-    int                retval = -1;
-    struct clicon_msg *reply = NULL;
-    uint32_t           len;
+    return send_msg_reply_part(s, descr, data, datalen, 0);
+}
 
-    len = sizeof(*reply) + datalen;
-    if ((reply = (struct clicon_msg *)malloc(len)) == NULL)
-        goto done;
-    memset(reply, 0, len);
-    reply->op_len = htonl(len);
-    if (datalen > 0)
-      memcpy(reply->op_body, data, datalen);
-    if (clicon_msg_send(s, descr, reply) < 0)
-        goto done;
-    retval = 0;
-  done:
-    if (reply)
-        free(reply);
-    return retval;
+/*! Send a fragment of a reply streamed in several clicon_msg messages
+ *
+ * All fragments except the last have op_id CLICON_MSG_ID_MORE and their bodies are not
+ * null-terminated. The last is sent as send_msg_reply. clicon_msg_rcv receives the
+ * fragments as one message.
+ * @param[in]  s       Socket to communicate with client
+ * @param[in]  descr   Description of peer for logging
+ * @param[in]  data    Fragment of reply
+ * @param[in]  datalen Length of fragment, including null byte if last
+ * @param[in]  more    More fragments follow
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_PROTO_STREAM_CHUNK
+ */
+int 
+send_msg_reply_part(int         s, 
+                    const char *descr,
+                    char       *data, 
+                    uint32_t    datalen,
+                    int         more)
+{
+    return clicon_msg_send_buf(s, descr, more?CLICON_MSG_ID_MORE:0, data, datalen);
 }
 
 /*! Send a clicon_msg NOTIFY message asynchronously to client
@@ -47,11 +47,13 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <assert.h>
 #include <unistd.h>
 #include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <sys/syslog.h>
 
 /* cligen */
@@ -69,6 +71,7 @@
 #include "clixon_yang_module.h"
 #include "clixon_plugin.h"
 #include "clixon_string.h"
+#include "clixon_pool.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
 #include "clixon_proto.h"
@@ -81,12 +84,19 @@
 #include "clixon_xml_sort.h"
 #include "clixon_xml_io.h"
 #include "clixon_netconf_lib.h"
+#include "clixon_uid.h"
+#include "clixon_nacm.h"
+#include "clixon_datastore.h"
 #include "clixon_proto_client.h"
 
 #define PERSIST_ID_XML_FMT "<persist-id>%s</persist-id>"
 #define PERSIST_XML_FMT "<persist>%s</persist>"
 #define TIMEOUT_XML_FMT "<confirm-timeout>%u</confirm-timeout>"
 
+/* RPC stats of this process, see clicon_rpc_stats */
+static uint64_t _rpc_nr = 0;   /* Nr of RPCs sent to backend */
+static uint64_t _rpc_usec = 0; /* Time waiting for replies from backend */
+
 /*! Connect to internal netconf socket
  *
  * @param[in]  h     Clixon handle
@@ -139,10 +149,11 @@ clicon_rpc_connect(clicon_handle h,
     
 /*! Connect to backend or use cached socket and send RPC
  *
+ * The reply is either XML text or, if negotiated in hello, binary, see clicon_msg_decode
  * @param[in]  h        Clixon handle
  * @param[in]  msg      Encoded message
  * @param[in]  cache    Use cached (client) socket, otherwise generate new socket
- * @param[out] retdate  Returned data as string
+ * @param[out] xret     Returned data as xml tree without yang binding, unless eof
  * @param[out] eof      Set if eof encountered
  * @param[out] sp       Returned socket
  * @retval     0        OK
@@ -152,13 +163,17 @@ static int
 clicon_rpc_msg_once(clicon_handle      h,
                     struct clicon_msg *msg, 
                     int                cache,
-                    char             **retdata,
+                    cxobj            **xret,
                     int               *eof,
                     int               *sp)
 {
-    int retval = -1;
-    int s;
+    int                retval = -1;
+    int                s;
+    struct clicon_msg *reply = NULL;
+    struct timeval     t0;
+    struct timeval     t1;
     
+    gettimeofday(&t0, NULL);
     if (cache){
         if ((s = clicon_client_socket_get(h)) < 0){
             if (clicon_rpc_connect(h, &s) < 0)
@@ -168,20 +183,51 @@ clicon_rpc_msg_once(clicon_handle      h,
     }
     else if (clicon_rpc_connect(h, &s) < 0)
         goto done;
-    if (clicon_rpc(s, clicon_sock_str(h), msg, retdata, eof) < 0){
+    if (clicon_msg_send(s, clicon_sock_str(h), msg) < 0 ||
+        clicon_msg_rcv(s, clicon_sock_str(h), 0, &reply, eof) < 0){
         /* 2. check socket shutdown AFTER rpc */
         close(s);
         s = -1;
         clicon_client_socket_set(h, -1);
         goto done;
     }
+    /* Cannot populate xret here because need to know RPC name (eg "lock") in order to associate yang
+     * to reply.
+     */
+    if (!*eof && clicon_msg_decode(reply, NULL, NULL, xret, NULL) < 0)
+        goto done;
     if (sp)
         *sp = s;
     retval = 0;
  done:
+    gettimeofday(&t1, NULL);
+    timersub(&t1, &t0, &t1);
+    _rpc_nr++;
+    _rpc_usec += t1.tv_sec*1000000 + t1.tv_usec;
+    if (reply)
+        free(reply);
     return retval;
 }
 
+/*! Get RPC stats of this process
+ *
+ * Used by clients to measure the time of a request spent in the backend, by taking
+ * the difference before and after the request
+ * @param[out] nr    Nr of RPCs sent to backend
+ * @param[out] usec  Total time waiting for replies, including connect, in microseconds
+ * @retval     0     OK
+ */
+int
+clicon_rpc_stats(uint64_t *nr,
+                 uint64_t *usec)
+{
+    if (nr)
+        *nr = _rpc_nr;
+    if (usec)
+        *usec = _rpc_usec;
+    return 0;
+}
+
 /*! Send internal netconf rpc from client to backend
  *
  * @param[in]    h      Clixon handle
@@ -200,7 +246,6 @@ clicon_rpc_msg(clicon_handle      h,
                cxobj            **xret0)
 {
     int     retval = -1;
-    char   *retdata = NULL;
     cxobj  *xret = NULL;
     int     s = -1;
     int     eof = 0;
@@ -210,7 +255,7 @@ clicon_rpc_msg(clicon_handle      h,
     assert(strstr(msg->op_body, "username")!=NULL); /* XXX */
 #endif
     /* Create a socket and connect to it, either UNIX, IPv4 or IPv6 per config options */
-    if (clicon_rpc_msg_once(h, msg, 1, &retdata, &eof, &s) < 0)
+    if (clicon_rpc_msg_once(h, msg, 1, &xret, &eof, &s) < 0)
         goto done;
     if (eof){
         /* 2. check socket shutdown AFTER rpc */
@@ -219,7 +264,7 @@ clicon_rpc_msg(clicon_handle      h,
         clicon_client_socket_set(h, -1);
 #ifdef PROTO_RESTART_RECONNECT
         if (!clixon_exit_get()) { /* May be part of termination */
-            if (clicon_rpc_msg_once(h, msg, 1, &retdata, &eof, NULL) < 0)
+            if (clicon_rpc_msg_once(h, msg, 1, &xret, &eof, NULL) < 0)
                 goto done;
             if (eof){
                 close(s);
@@ -239,14 +284,6 @@ clicon_rpc_msg(clicon_handle      h,
         goto done;
 #endif
     }
-
-    if (retdata){
-        /* Cannot populate xret here because need to know RPC name (eg "lock") in order to associate yang
-         * to reply.
-         */
-        if (clixon_xml_parse_string(retdata, YB_NONE, NULL, &xret, NULL) < 0)
-            goto done;
-    }
     if (xret0){
         *xret0 = xret;
         xret = NULL;
@@ -254,8 +291,6 @@ clicon_rpc_msg(clicon_handle      h,
     retval = 0;
  done:
     clicon_debug(CLIXON_DBG_DETAIL, "%s %d", __FUNCTION__, retval);
-    if (retdata)
-        free(retdata);
     if (xret)
         xml_free(xret);
     return retval;
@@ -279,7 +314,6 @@ clicon_rpc_msg_persistent(clicon_handle      h,
                           int               *sock0)
 {
     int     retval = -1;
-    char   *retdata = NULL;
     cxobj  *xret = NULL;
     int     s = -1;
     int     eof = 0;
@@ -293,7 +327,7 @@ clicon_rpc_msg_persistent(clicon_handle      h,
 #endif
     clicon_debug(1, "%s request:%s", __FUNCTION__, msg->op_body);
     /* Create a socket and connect to it, either UNIX, IPv4 or IPv6 per config options */
-    if (clicon_rpc_msg_once(h, msg, 0, &retdata, &eof, &s) < 0)
+    if (clicon_rpc_msg_once(h, msg, 0, &xret, &eof, &s) < 0)
         goto done;
     if (eof){
         /* 2. check socket shutdown AFTER rpc */
@@ -306,15 +340,7 @@ clicon_rpc_msg_persistent(clicon_handle      h,
         clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
         goto done;
     }
-    clicon_debug(1, "%s retdata:%s", __FUNCTION__, retdata);
-
-    if (retdata){
-        /* Cannot populate xret here because need to know RPC name (eg "lock") in order to associate yang
-         * to reply.
-         */
-        if (clixon_xml_parse_string(retdata, YB_NONE, NULL, &xret, NULL) < 0)
-            goto done;
-    }
+    clicon_debug_xml(1, xret, "%s retdata:", __FUNCTION__);
     if (xret0){
         *xret0 = xret;
         xret = NULL;
@@ -326,8 +352,6 @@ clicon_rpc_msg_persistent(clicon_handle      h,
  done:
     if (s >= 0)
         close(s);
-    if (retdata)
-        free(retdata);
     if (xret)
         xml_free(xret);
     return retval;
@@ -442,7 +466,7 @@ clicon_rpc_netconf_xml(clicon_handle  h,
     cxobj     *xerr = NULL;
     int        ret;
 
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -478,8 +502,127 @@ clicon_rpc_netconf_xml(clicon_handle  h,
     if (xerr)
         xml_free(xerr);
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
+    return retval;
+}
+
+/*! Get running config from the snapshot written by the backend, see CLICON_XMLDB_SNAPSHOT
+ *
+ * NACM is applied as by the backend for internal NACM mode. If there is no snapshot, or if
+ * the request needs anything but read access, eg a NACM error reply, it is sent to the backend
+ * @param[in]  h        Clixon handle
+ * @param[in]  username NACM username, or NULL
+ * @param[in]  xpath    XPath (or "")
+ * @param[in]  nsc      Namespace context for filter
+ * @param[in]  defaults Value of the with-defaults mode, rfc6243, or NULL
+ * @param[out] xt       XML tree <data>. Free with xml_free.
+ * @retval     1        OK, xt is set
+ * @retval     0        Not served locally, send to backend
+ * @retval    -1        Error
+ * @see clicon_rpc_get_config
+ */
+static int
+rpc_get_config_snapshot(clicon_handle h,
+                        char         *username,
+                        char         *xpath,
+                        cvec         *nsc,
+                        char         *defaults,
+                        cxobj       **xt)
+{
+    int               retval = -1;
+    char             *mode;
+    char             *peername = NULL;
+    cxobj            *xnacm = NULL;
+    cxobj            *xn = NULL;
+    cxobj            *xd = NULL;
+    cvec             *nscn = NULL;
+    cvec             *nscd = NULL;
+    cxobj           **xvec = NULL;
+    size_t            xlen;
+    int               wdef = WITHDEFAULTS_EXPLICIT;
+    yang_stmt        *yspec;
+    cbuf             *cbret = NULL;
+    int               ret;
+
+    if (!clicon_option_bool(h, "CLICON_XMLDB_SNAPSHOT"))
+        goto fail;
+    if (defaults != NULL && (wdef = withdefaults_str2int(defaults)) < 0)
+        goto fail;
+    /* External NACM trees are only known by the backend */
+    if ((mode = clicon_option_str(h, "CLICON_NACM_MODE")) != NULL &&
+        strcmp(mode, "external") == 0)
+        goto fail;
+    if ((cbret = clixon_cbuf_get()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (mode != NULL && strcmp(mode, "internal") == 0){
+        if ((nscn = xml_nsctx_init(NULL, NACM_NS)) == NULL)
+            goto done;
+        if ((ret = xmldb_snapshot_get(h, nscn, "nacm", WITHDEFAULTS_REPORT_ALL, &xn)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (uid2name(getuid(), &peername) < 0)
+            goto done;
+        if ((ret = nacm_access_pre_tree(h, xn, peername, username, &xnacm)) < 0)
+            goto done;
+        if (ret == 0){
+            if ((ret = verify_nacm_user(h, clicon_nacm_credentials(h), peername, username, cbret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+            if ((ret = nacm_rpc("get-config", "ietf-netconf", username, xnacm, cbret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+    }
+    if ((ret = xmldb_snapshot_get(h, nsc, xpath, wdef, &xd)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (xnacm != NULL){
+        if (xpath_vec(xd, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+            goto done;
+        if (nacm_datanode_read(h, xd, xvec, xlen, username, xnacm) < 0)
+            goto done;
+    }
+    if (xml_name_set(xd, NETCONF_OUTPUT_DATA) < 0)
+        goto done;
+    yspec = clicon_dbspec_yang(h);
+    if (xml_bind_special(xd, yspec, "/nc:get-config/output/data") < 0)
+        goto done;
+    /* Sync namespaces, ie explicitly set all xmlns attributes to xd */
+    if (xml_nsctx_node(xd, &nscd) < 0)
+        goto done;
+    if (xmlns_set_all(xd, nscd) < 0)
+        goto done;
+    xml_sort(xd); /* Ensure attr is first */
+    *xt = xd;
+    xd = NULL;
+    retval = 1;
+ done:
+    if (xvec)
+        free(xvec);
+    if (nscd)
+        cvec_free(nscd);
+    if (xd)
+        xml_free(xd);
+    if (xnacm)
+        xml_free(xnacm);
+    if (xn)
+        xml_free(xn);
+    if (nscn)
+        xml_nsctx_free(nscn);
+    if (peername)
+        free(peername);
+    if (cbret)
+        clixon_cbuf_put(cbret);
     return retval;
+ fail:
+    retval = 0;
+    goto done;
 }
 
 /*! Get database configuration
@@ -534,13 +677,20 @@ clicon_rpc_get_config(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if (username == NULL)
+        username = clicon_username_get(h);
+    /* Read running from the backend snapshot, if any */
+    if (strcmp(db, "running") == 0 && xt != NULL){
+        if ((ret = rpc_get_config_snapshot(h, username, xpath, nsc, defaults, xt)) < 0)
+            goto done;
+        if (ret == 1)
+            goto ok;
+    }
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
     cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
-    if (username == NULL)
-        username = clicon_username_get(h);
     if (username != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
@@ -603,12 +753,145 @@ clicon_rpc_get_config(clicon_handle h,
         xml_sort(xd); /* Ensure attr is first */
         *xt = xd;
     }
+ ok:
+    retval = 0;
+  done:
+    if (nscd)
+        cvec_free(nscd);
+    if (cb)
+        clixon_cbuf_put(cb);
+    if (xerr)
+        xml_free(xerr);
+    if (xret)
+        xml_free(xret);
+    if (msg)
+        free(msg);
+    return retval;
+}
+
+/*! Get one page of a config list or leaf-list of a database
+ *
+ * The page starts after the entry given by cursor, or at the first entry if cursor is NULL.
+ * Uses list-pagination with the clixon cursor attribute, which requires a datastore cache.
+ * @param[in]  h        Clixon handle
+ * @param[in]  db       Name of database
+ * @param[in]  xpath    XPath of list or leaf-list, last step without predicate
+ * @param[in]  nsc      Namespace context for filter
+ * @param[in]  defaults Value of the with-defaults mode, rfc6243, or NULL
+ * @param[in]  cursor   Comma-separated and percent-encoded keys of previous entry, or NULL
+ * @param[in]  limit    Max number of entries in page, 0 means unbounded
+ * @param[out] xt       XML tree. Free with xml_free. 
+ *                      Either <config> or <rpc-error>. 
+ * @retval     0        OK
+ * @retval    -1        Error, fatal or xml
+ * @see clicon_rpc_get_config
+ * @see clicon_rpc_get_pageable_list  Offset based pagination of running
+ */
+int
+clicon_rpc_get_config_page(clicon_handle h, 
+                           char         *db, 
+                           char         *xpath,
+                           cvec         *nsc,
+                           char         *defaults,
+                           char         *cursor,
+                           uint32_t      limit,
+                           cxobj       **xt)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    cbuf              *cb = NULL;
+    cxobj             *xret = NULL;
+    cxobj             *xerr = NULL;    
+    cxobj             *xd = NULL;
+    char              *username;
+    uint32_t           session_id;
+    int                ret;
+    yang_stmt         *yspec;
+    cvec              *nscd = NULL;
+    
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = clixon_cbuf_get()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    if ((username = clicon_username_get(h)) != NULL)
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+    cprintf(cb, " xmlns:%s=\"%s\"",
+            NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, "><get-config");
+    if (cursor){
+        cprintf(cb, " %s:cursor=\"", CLIXON_LIB_PREFIX);
+        if (xml_chardata_cbuf_append(cb, cursor) < 0)
+            goto done;
+        cprintf(cb, "\"");
+    }
+    cprintf(cb, "><source><%s/></source>", db);
+    cprintf(cb, "<%s:filter %s:type=\"xpath\" %s:select=\"%s\"",
+            NETCONF_BASE_PREFIX, NETCONF_BASE_PREFIX, NETCONF_BASE_PREFIX,
+            xpath);
+    if (xml_nsctx_cbuf(cb, nsc) < 0)
+        goto done;
+    cprintf(cb, "/>");
+    if (defaults != NULL)
+        cprintf(cb, "<with-defaults xmlns=\"%s\">%s</with-defaults>",
+                IETF_NETCONF_WITH_DEFAULTS_YANG_NAMESPACE,
+                defaults);
+    cprintf(cb, "<list-pagination xmlns=\"%s\">", IETF_PAGINATON_NC_NAMESPACE);
+    if (limit != 0)
+        cprintf(cb, "<limit>%u</limit>", limit);
+    cprintf(cb, "</list-pagination>");
+    cprintf(cb, "</get-config></rpc>");
+    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+        goto done;
+    if (clicon_rpc_msg(h, msg, &xret) < 0)
+        goto done;
+    yspec = clicon_dbspec_yang(h);
+    /* Send xml error back: first check error, then ok */
+    if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error")) != NULL)
+        xd = xml_parent(xd); /* point to rpc-reply */
+    else if ((xd = xpath_first(xret, NULL, "/rpc-reply/data")) == NULL){
+        if ((xd = xml_new(NETCONF_OUTPUT_DATA, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        if (xml_bind_special(xd, yspec, "/nc:get-config/output/data") < 0)
+            goto done;
+    }
+    else{
+        if (xml_bind_special(xd, yspec, "/nc:get-config/output/data") < 0)
+            goto done;
+        if ((ret = xml_bind_yang(h, xd, YB_MODULE, yspec, &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            if (clixon_netconf_internal_error(xerr,
+                                              ". Internal error, backend returned invalid XML.",
+                                              NULL) < 0)
+                goto done;
+            if ((xd = xpath_first(xerr, NULL, "rpc-error")) == NULL){
+                clicon_err(OE_XML, ENOENT, "Expected rpc-error tag but none found(internal)");
+                goto done;
+            }
+        }
+    }
+    if (xt && xd){
+        /* Sync namespaces, ie explicitly set all xmlns attributes to xd */
+        if (xml_nsctx_node(xd, &nscd) < 0)
+            goto done;
+        if (xml_rm(xd) < 0)
+            goto done;
+        if (xmlns_set_all(xd, nscd) < 0)
+            goto done;
+        xml_sort(xd); /* Ensure attr is first */
+        *xt = xd;
+    }
     retval = 0;
   done:
     if (nscd)
         cvec_free(nscd);
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xerr)
         xml_free(xerr);
     if (xret)
@@ -649,7 +932,7 @@ clicon_rpc_edit_config(clicon_handle       h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -679,7 +962,7 @@ clicon_rpc_edit_config(clicon_handle       h,
     if (xret)
         xml_free(xret);
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (msg)
         free(msg);
     return retval;
@@ -714,7 +997,7 @@ clicon_rpc_copy_config(clicon_handle h,
 
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -739,7 +1022,7 @@ clicon_rpc_copy_config(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xret)
         xml_free(xret);
     if (msg)
@@ -772,7 +1055,7 @@ clicon_rpc_delete_config(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -797,7 +1080,7 @@ clicon_rpc_delete_config(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xret)
         xml_free(xret);
     if (msg)
@@ -826,7 +1109,7 @@ clicon_rpc_lock(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -851,7 +1134,7 @@ clicon_rpc_lock(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xret)
         xml_free(xret);
     if (msg)
@@ -880,7 +1163,7 @@ clicon_rpc_unlock(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -905,7 +1188,7 @@ clicon_rpc_unlock(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xret)
         xml_free(xret);
     if (msg)
@@ -1022,7 +1305,7 @@ clicon_rpc_get2(clicon_handle   h,
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1109,7 +1392,7 @@ clicon_rpc_get2(clicon_handle   h,
     if (nscd)
         cvec_free(nscd);
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xerr)
         xml_free(xerr);
     if (xret)
@@ -1174,7 +1457,7 @@ clicon_rpc_get_pageable_list(clicon_handle   h,
     }
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1275,7 +1558,7 @@ clicon_rpc_get_pageable_list(clicon_handle   h,
     if (nscd)
         cvec_free(nscd);
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xerr)
         xml_free(xerr);
     if (xret)
@@ -1307,7 +1590,7 @@ clicon_rpc_close_session(clicon_handle h)
 
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1336,7 +1619,7 @@ clicon_rpc_close_session(clicon_handle h)
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xret)
         xml_free(xret);
     if (msg)
@@ -1365,7 +1648,7 @@ clicon_rpc_kill_session(clicon_handle h,
     
     if (session_id_check(h, &my_session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1390,7 +1673,7 @@ clicon_rpc_kill_session(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xret)
         xml_free(xret);
     if (msg)
@@ -1421,7 +1704,7 @@ clicon_rpc_validate(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1447,7 +1730,7 @@ clicon_rpc_validate(clicon_handle h,
     retval = 1;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (msg)
         free(msg);
     if (xret)
@@ -1516,7 +1799,7 @@ clicon_rpc_commit(clicon_handle h,
     if (session_id_check(h, &session_id) < 0)
         goto done;
 
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1554,7 +1837,7 @@ clicon_rpc_commit(clicon_handle h,
     retval = 1;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xret)
         xml_free(xret);
     if (msg)
@@ -1587,7 +1870,7 @@ clicon_rpc_discard_changes(clicon_handle h)
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1612,7 +1895,7 @@ clicon_rpc_discard_changes(clicon_handle h)
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xret)
         xml_free(xret);
     if (msg)
@@ -1646,7 +1929,7 @@ clicon_rpc_create_subscription(clicon_handle    h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1677,7 +1960,7 @@ clicon_rpc_create_subscription(clicon_handle    h,
     retval = 0;
   done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (xret)
         xml_free(xret);
     if (msg)
@@ -1706,7 +1989,7 @@ clicon_rpc_debug(clicon_handle h,
 
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1736,7 +2019,7 @@ clicon_rpc_debug(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (msg)
         free(msg);
     if (xret)
@@ -1744,32 +2027,36 @@ clicon_rpc_debug(clicon_handle h,
     return retval;
 }
 
-/*! Send a debug request to backend server to set restconf debug
+/*! Get content version and last modification time of a datastore from backend
  *
- * @param[in] h        Clixon handle
- * @param[in] level    Debug level
- * @retval    0        OK
- * @retval   -1        Error and logged to syslog
- * @note The following must hold:
- *  1. clixon-restconf.yang is used (so that debug config can be set)
- *  2. AND the <restconf> XML is in running db not in clixon-config (so that restconf reads the new config from backend)
- *  3 CLICON_BACKEND_RESTCONF_PROCESS is true (so that backend restarts restconf)
+ * Cheap way for a client to check if a datastore has changed without getting its content
+ * @param[in]  h        Clixon handle
+ * @param[in]  db       Name of datastore, eg "running"
+ * @param[out] version  Content version, changes on every modification of db
+ * @param[out] mtime    Time of last modification of db
+ * @retval     0        OK
+ * @retval    -1        Error and logged to syslog
  */
 int
-clicon_rpc_restconf_debug(clicon_handle h, 
-                          int           level)
+clicon_rpc_datastore_version(clicon_handle   h,
+                             const char     *db,
+                             uint64_t       *version,
+                             struct timeval *mtime)
 {
     int                retval = -1;
     struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
+    cxobj             *x;
     char              *username;
     uint32_t           session_id;
     cbuf              *cb = NULL;
-    
+    char              *reason = NULL;
+    int                ret;
+
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1781,29 +2068,45 @@ clicon_rpc_restconf_debug(clicon_handle h,
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
     cprintf(cb, ">");
-    cprintf(cb, "<edit-config><target><candidate/></target><config>");
-    cprintf(cb, "<restconf xmlns=\"%s\"><debug>%d</debug></restconf>",
-            CLIXON_RESTCONF_NS,
-            level);
-    cprintf(cb, "</config></edit-config>");
+    cprintf(cb, "<datastore-version xmlns=\"%s\"><datastore>%s</datastore></datastore-version>",
+            CLIXON_LIB_NS, db);
     cprintf(cb, "</rpc>");
     if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
         goto done;
     if (clicon_rpc_msg(h, msg, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
-        clixon_netconf_error(xerr, "Debug", NULL);
+        clixon_netconf_error(xerr, "Datastore-version", NULL);
         goto done;
     }
-    if (xpath_first(xret, NULL, "//rpc-reply/ok") == NULL){
-        clicon_err(OE_XML, 0, "rpc error"); /* XXX extract info from rpc-error */
+    if ((x = xpath_first(xret, NULL, "//rpc-reply/version")) == NULL ||
+        xml_body(x) == NULL){
+        clicon_err(OE_XML, 0, "rpc error: no version");
         goto done;
     }
-    if ((retval = clicon_rpc_commit(h, 0, 0, 0, NULL, NULL)) < 1)
+    if ((ret = parse_uint64(xml_body(x), version, &reason)) < 0){
+        clicon_err(OE_XML, errno, "parse_uint64");
         goto done;
+    }
+    if (ret == 0){
+        clicon_err(OE_XML, 0, "version: %s", reason);
+        goto done;
+    }
+    if ((x = xpath_first(xret, NULL, "//rpc-reply/last-modified")) == NULL ||
+        xml_body(x) == NULL){
+        clicon_err(OE_XML, 0, "rpc error: no last-modified");
+        goto done;
+    }
+    if (str2time(xml_body(x), mtime) < 0){
+        clicon_err(OE_XML, errno, "str2time");
+        goto done;
+    }
+    retval = 0;
  done:
+    if (reason)
+        free(reason);
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (msg)
         free(msg);
     if (xret)
@@ -1811,92 +2114,471 @@ clicon_rpc_restconf_debug(clicon_handle h,
     return retval;
 }
 
-/*! Send a hello request to the backend server on INTERNAL netconf connection
+/*! Get values of leaf and leaf-list nodes selected by an xpath in a datastore from backend
  *
- * @param[in]  h           Clixon handle
- * @param[in]  transport   RFC 6022 transport.
- * @param[in]  source_host RFC 6022 source-host
- * @param[out] id          Session id returned by backend
- * @retval     0           OK
- * @retval    -1           Error and logged to syslog
- * @note this is internal netconf to backend, not northbound to user client
- * @note this deviates from RFC6241 slightly in that it waits for a reply, the RFC does not
- *       stipulate that.
- * @note transport is an identity defined in RFC6022 with added values in clixon-lib.yang for clixon,
- *       and should in those cases be prefixed with the localname "cl:", 
- *       Example: cl:cli, cl:restconf, cl:netconf
+ * If version is the current content version of the datastore, no values are sent.
+ * @param[in]     h        Clixon handle
+ * @param[in]     db       Name of datastore, eg "running"
+ * @param[in]     xpath    XPath selecting leaf or leaf-list nodes
+ * @param[in]     nsc      Namespace context of xpath
+ * @param[in]     prefix   Only get values starting with prefix, or NULL
+ * @param[in,out] version  In: version of previous values or 0. Out: current version
+ * @param[out]    values   Values as string cvec, NULL if unchanged. Free with cvec_free
+ * @param[out]    xerr     Netconf error of backend, if set values is NULL. Free with xml_free
+ * @retval        0        OK, or netconf error in xerr
+ * @retval       -1        Error and logged to syslog
+ * @code
+ *   uint64_t version = 0;
+ *   cvec    *values = NULL;
+ *   cxobj   *xerr = NULL;
+ *   if (clicon_rpc_datastore_values(h, "running", "/ex:table/ex:parameter/ex:name", nsc, NULL,
+ *                                   &version, &values, &xerr) < 0)
+ *      err;
+ * @endcode
+ * @see clicon_rpc_datastore_version
  */
 int
-clicon_hello_req(clicon_handle h,
-                 char         *transport,
-                 char         *source_host,
-                 uint32_t     *id)
+clicon_rpc_datastore_values(clicon_handle h,
+                            const char   *db,
+                            char         *xpath,
+                            cvec         *nsc,
+                            char         *prefix,
+                            uint64_t     *version,
+                            cvec        **values,
+                            cxobj       **xerr)
 {
     int                retval = -1;
     struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
-    cxobj             *xerr;
+    cxobj             *xe;
     cxobj             *x;
+    cxobj             *xv;
     char              *username;
-    char              *b;
-    int                ret;
+    uint32_t           session_id;
     cbuf              *cb = NULL;
-    int                clixon_lib = 0;
-    char              *ns = NULL;
-    char              *prefix = NULL;
+    cvec              *cvv = NULL;
+    char              *reason = NULL;
+    int                ret;
 
-    if ((cb = cbuf_new()) == NULL){
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
-    cprintf(cb, "<hello xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
-        clixon_lib++;
-    }
-    /* RFC 6022 session parameters transport and source-host */
-    clicon_data_get(h, "session-namespace", &ns);
-    clicon_data_get(h, "session-namespace-prefix", &prefix);
-    if (transport == NULL)
-        clicon_data_get(h, "session-transport", &transport);
-    if (transport){
-        cprintf(cb, " %s:transport=\"%s\"", CLIXON_LIB_PREFIX, transport);
-        clixon_lib++;
-    }
-    if (source_host == NULL)
-        clicon_data_get(h, "session-source-host", &source_host);
-    if (source_host){
-        cprintf(cb, " %s:source-host=\"%s\"", CLIXON_LIB_PREFIX, source_host);
-        clixon_lib++;
-    }
-    if (clixon_lib)
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
     cprintf(cb, ">");
-    cprintf(cb, "<capabilities><capability>%s</capability></capabilities>",
-            NETCONF_BASE_CAPABILITY_1_1);
-    cprintf(cb, "</hello>");
-
-    if ((msg = clicon_msg_encode(0, "%s", cbuf_get(cb))) == NULL)
+    cprintf(cb, "<datastore-values xmlns=\"%s\"><datastore>%s</datastore>", CLIXON_LIB_NS, db);
+    cprintf(cb, "<xpath");
+    if (xml_nsctx_cbuf(cb, nsc) < 0)
+        goto done;
+    cprintf(cb, ">");
+    if (xml_chardata_cbuf_append(cb, xpath) < 0)
+        goto done;
+    cprintf(cb, "</xpath>");
+    if (prefix){
+        cprintf(cb, "<prefix>");
+        if (xml_chardata_cbuf_append(cb, prefix) < 0)
+            goto done;
+        cprintf(cb, "</prefix>");
+    }
+    if (*version)
+        cprintf(cb, "<version>%" PRIu64 "</version>", *version);
+    cprintf(cb, "</datastore-values>");
+    cprintf(cb, "</rpc>");
+    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+        goto done;
+    if (clicon_rpc_msg(h, msg, &xret) < 0)
+        goto done;
+    *values = NULL;
+    if ((xe = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        if (xerr && (*xerr = xml_dup(xe)) == NULL)
+            goto done;
+        retval = 0;
+        goto done;
+    }
+    if ((x = xpath_first(xret, NULL, "//rpc-reply/version")) == NULL ||
+        xml_body(x) == NULL){
+        clicon_err(OE_XML, 0, "rpc error: no version");
+        goto done;
+    }
+    if ((ret = parse_uint64(xml_body(x), version, &reason)) < 0){
+        clicon_err(OE_XML, errno, "parse_uint64");
+        goto done;
+    }
+    if (ret == 0){
+        clicon_err(OE_XML, 0, "version: %s", reason);
+        goto done;
+    }
+    if (xpath_first(xret, NULL, "//rpc-reply/unchanged") == NULL){
+        if ((cvv = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if ((x = xpath_first(xret, NULL, "//rpc-reply/values")) != NULL){
+            xv = NULL;
+            while ((xv = xml_child_each(x, xv, CX_ELMNT)) != NULL)
+                if (cvec_add_string(cvv, NULL, xml_body(xv)?xml_body(xv):"") < 0){
+                    clicon_err(OE_UNIX, errno, "cvec_add_string");
+                    goto done;
+                }
+        }
+        *values = cvv;
+        cvv = NULL;
+    }
+    retval = 0;
+ done:
+    if (cvv)
+        cvec_free(cvv);
+    if (reason)
+        free(reason);
+    if (cb)
+        clixon_cbuf_put(cb);
+    if (msg)
+        free(msg);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Bind and detach one of the configuration trees of a datastore-diff reply
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  xret  Reply
+ * @param[in]  name  Name of tree: config1 or config2
+ * @param[out] xt    Tree with top symbol data. Free with xml_free
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+rpc_datastore_diff_tree(clicon_handle h,
+                        cxobj        *xret,
+                        char         *name,
+                        cxobj       **xt)
+{
+    int        retval = -1;
+    cxobj     *xd;
+    cxobj     *xerr = NULL;
+    cvec      *nscd = NULL;
+    yang_stmt *yspec;
+    int        ret;
+
+    yspec = clicon_dbspec_yang(h);
+    if ((xd = xml_find_type(xpath_first(xret, NULL, "/rpc-reply"), NULL, name, CX_ELMNT)) == NULL){
+        if ((xd = xml_new(NETCONF_OUTPUT_DATA, NULL, CX_ELMNT)) == NULL)
+            goto done;
+    }
+    else {
+        /* Sync namespaces, ie explicitly set all xmlns attributes to xd */
+        if (xml_nsctx_node(xd, &nscd) < 0)
+            goto done;
+        if (xml_rm(xd) < 0)
+            goto done;
+        if (xml_name_set(xd, NETCONF_OUTPUT_DATA) < 0)
+            goto done;
+        if (xmlns_set_all(xd, nscd) < 0)
+            goto done;
+        xml_sort(xd);
+    }
+    if (xml_bind_special(xd, yspec, "/nc:get-config/output/data") < 0)
+        goto done;
+    if ((ret = xml_bind_yang(h, xd, YB_MODULE, yspec, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        clixon_netconf_error(xerr, "Datastore-diff", NULL);
+        xml_free(xd);
+        goto done;
+    }
+    *xt = xd;
+    retval = 0;
+ done:
+    if (nscd)
+        cvec_free(nscd);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! Get differences between the configuration of two datastores from backend
+ *
+ * Only the nodes that differ are sent, with ancestors and list keys
+ * @param[in]  h    Clixon handle
+ * @param[in]  db1  Name of first datastore, eg "running"
+ * @param[in]  db2  Name of second datastore, eg "candidate"
+ * @param[out] xt1  Nodes only in db1 and changed nodes with db1 values. Free with xml_free
+ * @param[out] xt2  Nodes only in db2 and changed nodes with db2 values. Free with xml_free
+ * @retval     0    OK
+ * @retval    -1    Error and logged to syslog
+ * @see clixon_xml_diff2cbuf  Render the trees as a diff
+ */
+int
+clicon_rpc_datastore_diff(clicon_handle h,
+                          const char   *db1,
+                          const char   *db2,
+                          cxobj       **xt1,
+                          cxobj       **xt2)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    cxobj             *xret = NULL;
+    cxobj             *xerr;
+    cxobj             *x1 = NULL;
+    char              *username;
+    uint32_t           session_id;
+    cbuf              *cb = NULL;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = clixon_cbuf_get()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, ">");
+    cprintf(cb, "<datastore-diff xmlns=\"%s\"><datastore1>%s</datastore1><datastore2>%s</datastore2></datastore-diff>",
+            CLIXON_LIB_NS, db1, db2);
+    cprintf(cb, "</rpc>");
+    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
         goto done;
     if (clicon_rpc_msg(h, msg, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
-        clixon_netconf_error(xerr, "Hello", NULL);
+        clixon_netconf_error(xerr, "Datastore-diff", NULL);
+        goto done;
+    }
+    if (rpc_datastore_diff_tree(h, xret, "config1", &x1) < 0)
+        goto done;
+    if (rpc_datastore_diff_tree(h, xret, "config2", xt2) < 0)
+        goto done;
+    *xt1 = x1;
+    x1 = NULL;
+    retval = 0;
+ done:
+    if (x1)
+        xml_free(x1);
+    if (cb)
+        clixon_cbuf_put(cb);
+    if (msg)
+        free(msg);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Send a debug request to backend server to set restconf debug
+ *
+ * @param[in] h        Clixon handle
+ * @param[in] level    Debug level
+ * @retval    0        OK
+ * @retval   -1        Error and logged to syslog
+ * @note The following must hold:
+ *  1. clixon-restconf.yang is used (so that debug config can be set)
+ *  2. AND the <restconf> XML is in running db not in clixon-config (so that restconf reads the new config from backend)
+ *  3 CLICON_BACKEND_RESTCONF_PROCESS is true (so that backend restarts restconf)
+ */
+int
+clicon_rpc_restconf_debug(clicon_handle h, 
+                          int           level)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    cxobj             *xret = NULL;
+    cxobj             *xerr;
+    char              *username;
+    uint32_t           session_id;
+    cbuf              *cb = NULL;
+    
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = clixon_cbuf_get()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, ">");
+    cprintf(cb, "<edit-config><target><candidate/></target><config>");
+    cprintf(cb, "<restconf xmlns=\"%s\"><debug>%d</debug></restconf>",
+            CLIXON_RESTCONF_NS,
+            level);
+    cprintf(cb, "</config></edit-config>");
+    cprintf(cb, "</rpc>");
+    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+        goto done;
+    if (clicon_rpc_msg(h, msg, &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        clixon_netconf_error(xerr, "Debug", NULL);
+        goto done;
+    }
+    if (xpath_first(xret, NULL, "//rpc-reply/ok") == NULL){
+        clicon_err(OE_XML, 0, "rpc error"); /* XXX extract info from rpc-error */
         goto done;
     }
+    if ((retval = clicon_rpc_commit(h, 0, 0, 0, NULL, NULL)) < 1)
+        goto done;
+ done:
+    if (cb)
+        clixon_cbuf_put(cb);
+    if (msg)
+        free(msg);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Encode a hello request on INTERNAL netconf connection
+ *
+ * @param[in]  h           Clixon handle
+ * @param[in]  transport   RFC 6022 transport, or NULL
+ * @param[in]  source_host RFC 6022 source-host, or NULL
+ * @param[in]  binary      Request binary replies, see CLICON_PROTO_BINARY
+ * @retval     msg         Encoded message, free with free
+ * @retval     NULL        Error
+ * @note Streamed replies are requested if CLICON_PROTO_STREAM_CHUNK is set, they are
+ *       received by clicon_msg_rcv
+ * @see clicon_hello_req
+ */
+static struct clicon_msg *
+hello_msg_encode(clicon_handle h,
+                 char         *transport,
+                 char         *source_host,
+                 int           binary)
+{
+    struct clicon_msg *msg = NULL;
+    char              *username;
+    cbuf              *cb = NULL;
+    int                clixon_lib = 0;
+    char              *ns = NULL;
+    char              *prefix = NULL;
+
+    if ((cb = clixon_cbuf_get()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<hello xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        clixon_lib++;
+    }
+    /* RFC 6022 session parameters transport and source-host */
+    clicon_data_get(h, "session-namespace", &ns);
+    clicon_data_get(h, "session-namespace-prefix", &prefix);
+    if (transport == NULL)
+        clicon_data_get(h, "session-transport", &transport);
+    if (transport){
+        cprintf(cb, " %s:transport=\"%s\"", CLIXON_LIB_PREFIX, transport);
+        clixon_lib++;
+    }
+    if (source_host == NULL)
+        clicon_data_get(h, "session-source-host", &source_host);
+    if (source_host){
+        cprintf(cb, " %s:source-host=\"%s\"", CLIXON_LIB_PREFIX, source_host);
+        clixon_lib++;
+    }
+    if (binary){
+        cprintf(cb, " %s:encoding=\"binary\"", CLIXON_LIB_PREFIX);
+        clixon_lib++;
+    }
+    if (clicon_option_int(h, "CLICON_PROTO_STREAM_CHUNK") > 0){
+        cprintf(cb, " %s:stream=\"true\"", CLIXON_LIB_PREFIX);
+        clixon_lib++;
+    }
+    if (clixon_lib)
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    cprintf(cb, ">");
+    cprintf(cb, "<capabilities><capability>%s</capability></capabilities>",
+            NETCONF_BASE_CAPABILITY_1_1);
+    cprintf(cb, "</hello>");
+    msg = clicon_msg_encode(0, "%s", cbuf_get(cb));
+ done:
+    if (cb)
+        clixon_cbuf_put(cb);
+    return msg;
+}
+
+/*! Get session id from hello reply
+ *
+ * @param[in]  xret  Hello reply
+ * @param[out] id    Session id returned by backend
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+hello_reply_id(cxobj    *xret,
+               uint32_t *id)
+{
+    cxobj *xerr;
+    cxobj *x;
+    char  *b;
+
+    if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        clixon_netconf_error(xerr, "Hello", NULL);
+        return -1;
+    }
     if ((x = xpath_first(xret, NULL, "hello/session-id")) == NULL){
         clicon_err(OE_XML, 0, "hello session-id");
-        goto done;
+        return -1;
     }
     b = xml_body(x);
-    if ((ret = parse_uint32(b, id, NULL)) <= 0){
+    if (parse_uint32(b, id, NULL) <= 0){
         clicon_err(OE_XML, errno, "parse_uint32"); 
-        goto done;
+        return -1;
     }
+    return 0;
+}
+
+/*! Send a hello request to the backend server on INTERNAL netconf connection
+ *
+ * @param[in]  h           Clixon handle
+ * @param[in]  transport   RFC 6022 transport.
+ * @param[in]  source_host RFC 6022 source-host
+ * @param[out] id          Session id returned by backend
+ * @retval     0           OK
+ * @retval    -1           Error and logged to syslog
+ * @note this is internal netconf to backend, not northbound to user client
+ * @note this deviates from RFC6241 slightly in that it waits for a reply, the RFC does not
+ *       stipulate that.
+ * @note transport is an identity defined in RFC6022 with added values in clixon-lib.yang for clixon,
+ *       and should in those cases be prefixed with the localname "cl:", 
+ *       Example: cl:cli, cl:restconf, cl:netconf
+ */
+int
+clicon_hello_req(clicon_handle h,
+                 char         *transport,
+                 char         *source_host,
+                 uint32_t     *id)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    cxobj             *xret = NULL;
+
+    if ((msg = hello_msg_encode(h, transport, source_host,
+                                clicon_option_bool(h, "CLICON_PROTO_BINARY"))) == NULL)
+        goto done;
+    if (clicon_rpc_msg(h, msg, &xret) < 0)
+        goto done;
+    if (hello_reply_id(xret, id) < 0)
+        goto done;
     retval = 0;
  done:
-    if (cb)
-        cbuf_free(cb);
     if (msg)
         free(msg);
     if (xret)
@@ -1925,7 +2607,7 @@ clicon_rpc_restart_plugin(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clixon_cbuf_get()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1955,10 +2637,307 @@ clicon_rpc_restart_plugin(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clixon_cbuf_put(cb);
     if (msg)
         free(msg);
     if (xret)
         xml_free(xret);
     return retval;
 }
+
+/*! Outstanding request on an asynchronous backend connection
+ */
+struct rpc_async_req {
+    struct rpc_async_req *rr_next;
+    char                 *rr_id;   /* message-id of request, or NULL */
+    clicon_rpc_cb_t      *rr_fn;   /* Reply callback */
+    void                 *rr_arg;  /* Argument to callback */
+};
+
+/*! Asynchronous connection to backend with pipelined requests
+ *
+ * Replies are correlated with requests by message-id if the reply has one, otherwise by
+ * order: the backend sends replies in the order of requests on a connection.
+ */
+struct clicon_rpc_async {
+    clicon_handle          ra_h;
+    int                    ra_s;      /* Socket, or -1 if closed */
+    uint32_t               ra_id;     /* Session id of connection */
+    struct rpc_async_req  *ra_reqs;   /* Outstanding requests in send order */
+    struct rpc_async_req **ra_last;   /* Last next pointer of ra_reqs */
+    int                    ra_nr;     /* Number of outstanding requests */
+};
+
+/*! Get message-id attribute value from start tag of rpc
+ *
+ * @param[in]  xmlstr  XML rpc as string
+ * @param[out] id      Malloced message-id, or NULL if no message-id
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+rpc_async_message_id(const char *xmlstr,
+                     char      **id)
+{
+    const char *end;
+    const char *p;
+    const char *q;
+
+    *id = NULL;
+    if ((end = strchr(xmlstr, '>')) == NULL)
+        return 0;
+    for (p = xmlstr; (p = strstr(p, "message-id=")) != NULL && p < end; p += 11){
+        if (p[-1] != ' ' || (p[11] != '"' && p[11] != '\''))
+            continue;
+        if ((q = strchr(p+12, p[11])) == NULL || q > end)
+            return 0;
+        if ((*id = strndup(p+12, q-p-12)) == NULL){
+            clicon_err(OE_UNIX, errno, "strndup");
+            return -1;
+        }
+        break;
+    }
+    return 0;
+}
+
+/*! Remove outstanding request, call its callback and free it
+ *
+ * @param[in]  ra    Asynchronous connection
+ * @param[in]  rr_prev  Pointer to request
+ * @param[in]  xret  Reply, or NULL if connection is closed
+ * @retval     0     OK
+ * @retval    -1     Error in callback
+ */
+static int
+rpc_async_req_done(clicon_rpc_async_t    *ra,
+                   struct rpc_async_req **rr_prev,
+                   cxobj                 *xret)
+{
+    struct rpc_async_req *rr = *rr_prev;
+    int                   ret;
+
+    if ((*rr_prev = rr->rr_next) == NULL)
+        ra->ra_last = rr_prev;
+    ra->ra_nr--;
+    ret = rr->rr_fn(ra->ra_h, xret, rr->rr_arg);
+    if (rr->rr_id)
+        free(rr->rr_id);
+    free(rr);
+    return ret;
+}
+
+/*! Reply has arrived on asynchronous connection, call callback of its request
+ *
+ * On eof, callbacks of all outstanding requests are called with NULL reply and the
+ * connection is closed, but not freed
+ * @param[in]  s    Socket
+ * @param[in]  arg  Asynchronous connection
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+rpc_async_input(int   s,
+                void *arg)
+{
+    int                    retval = -1;
+    clicon_rpc_async_t    *ra = (clicon_rpc_async_t *)arg;
+    struct clicon_msg     *reply = NULL;
+    struct rpc_async_req **rr_prev;
+    cxobj                 *xret = NULL;
+    cxobj                 *xr;
+    char                  *id = NULL;
+    int                    eof = 0;
+
+    if (clicon_msg_rcv(s, clicon_sock_str(ra->ra_h), 0, &reply, &eof) < 0)
+        goto done;
+    if (eof){
+        clixon_event_unreg_fd(ra->ra_s, rpc_async_input);
+        close(ra->ra_s);
+        ra->ra_s = -1;
+        while (ra->ra_reqs)
+            if (rpc_async_req_done(ra, &ra->ra_reqs, NULL) < 0)
+                goto done;
+        goto ok;
+    }
+    if (clixon_xml_parse_string(reply->op_body, YB_NONE, NULL, &xret, NULL) < 0)
+        goto done;
+    if ((xr = xml_find_type(xret, NULL, "rpc-reply", CX_ELMNT)) != NULL)
+        id = xml_find_value(xr, "message-id");
+    rr_prev = &ra->ra_reqs;
+    if (id)
+        for (; *rr_prev; rr_prev = &(*rr_prev)->rr_next)
+            if ((*rr_prev)->rr_id && strcmp((*rr_prev)->rr_id, id) == 0)
+                break;
+    if (*rr_prev == NULL){
+        clicon_log(LOG_WARNING, "%s: reply without request, message-id:%s", __FUNCTION__, id?id:"");
+        goto ok;
+    }
+    if (rpc_async_req_done(ra, rr_prev, xret) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (reply)
+        free(reply);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Open an asynchronous connection to the backend for pipelined requests
+ *
+ * The connection is a separate session, with its own session-id and locks. Replies are
+ * received in the event loop, see clicon_rpc_async_send.
+ * @param[in]  h    Clixon handle
+ * @retval     ra   Asynchronous connection, close with clicon_rpc_async_close
+ * @retval     NULL Error
+ */
+clicon_rpc_async_t *
+clicon_rpc_async_open(clicon_handle h)
+{
+    clicon_rpc_async_t *ra = NULL;
+    struct clicon_msg  *msg = NULL;
+    char               *retdata = NULL;
+    cxobj              *xret = NULL;
+    int                 eof = 0;
+
+    if ((ra = malloc(sizeof(*ra))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(ra, 0, sizeof(*ra));
+    ra->ra_h = h;
+    ra->ra_last = &ra->ra_reqs;
+    if (clicon_rpc_connect(h, &ra->ra_s) < 0){
+        ra->ra_s = -1;
+        goto fail;
+    }
+    /* Hello, before any request is outstanding */
+    if ((msg = hello_msg_encode(h, NULL, NULL, 0)) == NULL)
+        goto fail;
+    if (clicon_rpc(ra->ra_s, clicon_sock_str(h), msg, &retdata, &eof) < 0)
+        goto fail;
+    if (eof){
+        clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        goto fail;
+    }
+    if (clixon_xml_parse_string(retdata, YB_NONE, NULL, &xret, NULL) < 0)
+        goto fail;
+    if (hello_reply_id(xret, &ra->ra_id) < 0)
+        goto fail;
+    if (clixon_event_reg_fd(ra->ra_s, rpc_async_input, ra, "backend async rpc") < 0)
+        goto fail;
+ done:
+    if (msg)
+        free(msg);
+    if (retdata)
+        free(retdata);
+    if (xret)
+        xml_free(xret);
+    return ra;
+ fail:
+    if (ra->ra_s != -1)
+        close(ra->ra_s);
+    free(ra);
+    ra = NULL;
+    goto done;
+}
+
+/*! Send a request on an asynchronous connection without waiting for its reply
+ *
+ * Several requests may be outstanding. When the reply arrives, fn is called from the event
+ * loop with the reply as XML tree, which is freed when fn returns. If the connection is
+ * closed by the backend, fn is called with NULL reply.
+ * @param[in]  ra      Asynchronous connection
+ * @param[in]  xmlstr  XML rpc as string, should have a message-id unique on the connection
+ * @param[in]  fn      Reply callback
+ * @param[in]  arg     Argument to fn
+ * @retval     0       OK, fn is called when reply arrives
+ * @retval    -1       Error, fn is not called
+ * @code
+ *   int reply_cb(clicon_handle h, cxobj *xret, void *arg){
+ *   }
+ *   if (clicon_rpc_async_send(ra, "<rpc xmlns=\"urn:ietf:params:xml:ns:netconf:base:1.0\" message-id=\"1\"><get/></rpc>",
+ *                             reply_cb, arg) < 0)
+ *      err;
+ * @endcode
+ */
+int
+clicon_rpc_async_send(clicon_rpc_async_t *ra,
+                      char               *xmlstr,
+                      clicon_rpc_cb_t    *fn,
+                      void               *arg)
+{
+    int                   retval = -1;
+    struct clicon_msg    *msg = NULL;
+    struct rpc_async_req *rr = NULL;
+
+    if (ra->ra_s == -1){
+        clicon_err(OE_PROTO, ESHUTDOWN, "Asynchronous backend connection is closed");
+        goto done;
+    }
+    if ((rr = malloc(sizeof(*rr))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(rr, 0, sizeof(*rr));
+    rr->rr_fn = fn;
+    rr->rr_arg = arg;
+    if (rpc_async_message_id(xmlstr, &rr->rr_id) < 0)
+        goto done;
+    if ((msg = clicon_msg_encode(ra->ra_id, "%s", xmlstr)) == NULL)
+        goto done;
+    if (clicon_msg_send(ra->ra_s, clicon_sock_str(ra->ra_h), msg) < 0)
+        goto done;
+    *ra->ra_last = rr;
+    ra->ra_last = &rr->rr_next;
+    ra->ra_nr++;
+    rr = NULL;
+    retval = 0;
+ done:
+    if (rr){
+        if (rr->rr_id)
+            free(rr->rr_id);
+        free(rr);
+    }
+    if (msg)
+        free(msg);
+    return retval;
+}
+
+/*! Get number of outstanding requests on an asynchronous connection
+ *
+ * @param[in]  ra  Asynchronous connection
+ * @retval     nr  Number of requests sent whose reply has not arrived
+ */
+int
+clicon_rpc_async_pending(clicon_rpc_async_t *ra)
+{
+    return ra->ra_nr;
+}
+
+/*! Close and free an asynchronous connection
+ *
+ * Callbacks of outstanding requests are not called
+ * @param[in]  ra  Asynchronous connection
+ * @retval     0   OK
+ * @note Not to be called from a reply callback of the connection
+ */
+int
+clicon_rpc_async_close(clicon_rpc_async_t *ra)
+{
+    struct rpc_async_req *rr;
+
+    if (ra->ra_s != -1){
+        clixon_event_unreg_fd(ra->ra_s, rpc_async_input);
+        close(ra->ra_s);
+    }
+    while ((rr = ra->ra_reqs) != NULL){
+        ra->ra_reqs = rr->rr_next;
+        if (rr->rr_id)
+            free(rr->rr_id);
+        free(rr);
+    }
+    free(ra);
+    return 0;
+}
@@ -37,7 +37,7 @@
   *
   * Clixon regular expression code for Yang type patterns following XML Schema
   * regex. 
-  * Two modes: libxml2 and posix-translation
+  * Three modes: libxml2, posix-translation and pcre2-translation
  * @see http://www.w3.org/TR/2004/REC-xmlschema-2-20041028
  */
 
@@ -52,6 +52,10 @@
 #include <errno.h>
 #include <regex.h>
 #include <ctype.h>
+#ifdef HAVE_LIBPCRE2_8
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+#endif
 
 #include <cligen/cligen.h>
 
@@ -366,6 +370,200 @@ regexp_xsd2posix(char  *xsd,
     return retval;
 }
 
+/*-------------------------- PCRE2 translation -------------------------*/
+
+/*! Transform from XSD regex to PCRE2
+ *
+ * PCRE2 supports most of XSD regex natively, including \p{X} categories. The differences
+ * handled here are:
+ * - XSD regexps are implicitly anchored at both ends
+ * - ^ and $ are not metacharacters in XSD (except ^ first in a bracket)
+ * - \i, \I, \c and \C are XSD specific multi-character escapes
+ * Character class subtraction, eg [a-z-[aeiou]], is not translated
+ * @param[in]  xsd    Input regex string according XSD
+ * @param[out] pcre   Output (malloced) string according to PCRE2
+ * @see regexp_xsd2posix
+ */
+int
+regexp_xsd2pcre2(char  *xsd,
+                 char **pcre)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    char   x;
+    int    i;
+    int    bracket = 0;
+    size_t len;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "^(?:");
+    len = strlen(xsd);
+    for (i=0; i<len; i++){
+        x = xsd[i];
+        if (x == '\\' && i+1 < len){
+            x = xsd[++i];
+            switch (x){
+            case 'i': /* initial */
+                cprintf(cb, bracket?"a-zA-Z_:":"[a-zA-Z_:]");
+                break;
+            case 'I':
+                if (bracket)
+                    cprintf(cb, "\\I");
+                else
+                    cprintf(cb, "[^a-zA-Z_:]");
+                break;
+            case 'c': /* xml namechar */
+                cprintf(cb, bracket?"0-9a-zA-Z._:\\-":"[0-9a-zA-Z._:\\-]");
+                break;
+            case 'C':
+                if (bracket)
+                    cprintf(cb, "\\C");
+                else
+                    cprintf(cb, "[^0-9a-zA-Z._:\\-]");
+                break;
+            default:
+                cprintf(cb, "\\%c", x);
+                break;
+            }
+        }
+        else if (bracket == 0 && (x == '$' || x == '^'))
+            cprintf(cb, "\\%c", x);
+        else if (x == '['){
+            bracket++;
+            cprintf(cb, "[");
+            if (i+1 < len && xsd[i+1] == '^'){
+                cprintf(cb, "^");
+                i++;
+            }
+        }
+        else if (x == ']' && bracket){
+            bracket--;
+            cprintf(cb, "]");
+        }
+        else
+            cprintf(cb, "%c", x);
+    }
+    cprintf(cb, ")$");
+    if ((*pcre = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+#ifdef HAVE_LIBPCRE2_8
+/* Compiled PCRE2 regexp with match data, allocated once per pattern */
+struct regex_pcre2 {
+    pcre2_code       *rp_code;
+    pcre2_match_data *rp_md;
+};
+
+/*! Compile XSD regexp with PCRE2, and JIT compile it if supported
+ * @param[in]   regexp  Regular expression string in XSD regex format
+ * @param[out]  recomp  Compiled regular expression, free with regex_pcre2_free
+ * @retval      1       OK
+ * @retval      0       Invalid regular expression
+ * @retval     -1       Error
+ */
+static int
+regex_pcre2_compile(char  *regexp,
+                    void **recomp)
+{
+    int                 retval = -1;
+    char               *pcre = NULL;
+    struct regex_pcre2 *rp = NULL;
+    int                 errcode;
+    PCRE2_SIZE          erroffset;
+
+    if (regexp_xsd2pcre2(regexp, &pcre) < 0)
+        goto done;
+    if ((rp = malloc(sizeof(*rp))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(rp, 0, sizeof(*rp));
+    if ((rp->rp_code = pcre2_compile((PCRE2_SPTR)pcre, PCRE2_ZERO_TERMINATED,
+                                     PCRE2_UTF | PCRE2_UCP | PCRE2_DOLLAR_ENDONLY,
+                                     &errcode, &erroffset, NULL)) == NULL){
+        clicon_debug(1, "%s %s: error %d at offset %zu", __FUNCTION__, pcre,
+                     errcode, (size_t)erroffset);
+        retval = 0;
+        goto done;
+    }
+    /* Falls back to the interpreter if JIT is not supported on this platform */
+    (void)pcre2_jit_compile(rp->rp_code, PCRE2_JIT_COMPLETE);
+    if ((rp->rp_md = pcre2_match_data_create(1, NULL)) == NULL){
+        clicon_err(OE_UNIX, errno, "pcre2_match_data_create");
+        goto done;
+    }
+    *recomp = rp;
+    rp = NULL;
+    retval = 1;
+ done:
+    if (rp)
+        regex_pcre2_free(rp);
+    if (pcre)
+        free(pcre);
+    return retval;
+}
+
+/*! Match string with compiled PCRE2 regexp
+ * @param[in]  recomp  Compiled regular expression 
+ * @param[in]  string  Content string to match
+ * @retval     1       Match
+ * @retval     0       No match, also if string is not valid UTF-8
+ * @retval    -1       Error
+ * @note Not reentrant: the match data is shared by all matches of a pattern
+ */
+static int
+regex_pcre2_exec(void *recomp,
+                 char *string)
+{
+    struct regex_pcre2 *rp = (struct regex_pcre2 *)recomp;
+    int                 rc;
+
+    rc = pcre2_match(rp->rp_code, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED,
+                     0, 0, rp->rp_md, NULL);
+    if (rc >= 0)
+        return 1;
+    if (rc == PCRE2_ERROR_NOMATCH ||
+        (rc <= PCRE2_ERROR_UTF8_ERR1 && rc >= PCRE2_ERROR_UTF8_ERR21))
+        return 0;
+    clicon_err(OE_REGEX, 0, "pcre2_match: %d", rc);
+    return -1;
+}
+#endif /* HAVE_LIBPCRE2_8 */
+
+/*! Free compiled PCRE2 regexp
+ *
+ * Does not need a clicon handle, eg when freeing yang type caches
+ * @param[in]  recomp  Compiled regular expression 
+ * @retval     0       OK
+ */
+int
+regex_pcre2_free(void *recomp)
+{
+#ifdef HAVE_LIBPCRE2_8
+    struct regex_pcre2 *rp = (struct regex_pcre2 *)recomp;
+
+    if (rp == NULL)
+        return 0;
+    if (rp->rp_md)
+        pcre2_match_data_free(rp->rp_md);
+    if (rp->rp_code)
+        pcre2_code_free(rp->rp_code);
+    free(rp);
+#endif
+    return 0;
+}
+
 /*-------------------------- Generic API functions ------------------------*/
 
 /*! Compilation of regular expression / pattern
@@ -396,6 +594,13 @@ regex_compile(clicon_handle h,
     case REGEXP_LIBXML2:
         retval = cligen_regex_libxml2_compile(regexp, recomp);
         break;
+    case REGEXP_PCRE2:
+#ifdef HAVE_LIBPCRE2_8
+        retval = regex_pcre2_compile(regexp, recomp);
+#else
+        clicon_err(OE_CFG, 0, "CLICON_YANG_REGEXP set to pcre2, but HAVE_LIBPCRE2_8 not set");
+#endif
+        break;
     default:
         clicon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d", clicon_yang_regexp(h));
         break;
@@ -426,6 +631,13 @@ regex_exec(clicon_handle h,
     case REGEXP_LIBXML2:
         retval = cligen_regex_libxml2_exec(recomp, string);
         break;
+    case REGEXP_PCRE2:
+#ifdef HAVE_LIBPCRE2_8
+        retval = regex_pcre2_exec(recomp, string);
+#else
+        clicon_err(OE_CFG, 0, "CLICON_YANG_REGEXP set to pcre2, but HAVE_LIBPCRE2_8 not set");
+#endif
+        break;
     default:
         clicon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d",
                    clicon_yang_regexp(h));
@@ -453,6 +665,9 @@ regex_free(clicon_handle h,
     case REGEXP_LIBXML2:
         retval = cligen_regex_libxml2_free(recomp);
         break;
+    case REGEXP_PCRE2:
+        retval = regex_pcre2_free(recomp);
+        break;
     default:
         clicon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d", clicon_yang_regexp(h));
         goto done;
@@ -80,6 +80,8 @@
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xml_build.h"
 #include "clixon_netconf_lib.h"
 #include "clixon_options.h"
 #include "clixon_data.h"
@@ -90,6 +92,123 @@
 /* Go through and timeout subscription timers [s] */
 #define STREAM_TIMER_TIMEOUT_S 5
 
+/* Initial number of entries of a replay ring, doubled when full */
+#define STREAM_REPLAY_SIZE0 64
+
+/*! Get replay entry i, where 0 is the oldest
+ */
+static inline struct stream_replay *
+stream_replay_i(event_stream_t *es,
+                size_t          i)
+{
+    return &es->es_replay[(es->es_replay_head + i) % es->es_replay_size];
+}
+
+/*! Drop oldest replay entry
+ */
+static void
+stream_replay_drop(event_stream_t *es)
+{
+    struct stream_replay *r;
+
+    r = &es->es_replay[es->es_replay_head];
+    es->es_replay_bytes -= r->r_len;
+    if (r->r_str)
+        free(r->r_str);
+    r->r_str = NULL;
+    es->es_replay_head = (es->es_replay_head + 1) % es->es_replay_size;
+    es->es_replay_nr--;
+}
+
+/*! Binary search for first replay entry with timestamp at or after tv
+ *
+ * @param[in]  es  Stream
+ * @param[in]  tv  Timestamp
+ * @retval     i   Index of entry, or es_replay_nr if none
+ */
+static size_t
+stream_replay_seek(event_stream_t *es,
+                   struct timeval *tv)
+{
+    size_t lo = 0;
+    size_t hi = es->es_replay_nr;
+    size_t mid;
+
+    while (lo < hi){
+        mid = lo + (hi - lo)/2;
+        if (timercmp(&stream_replay_i(es, mid)->r_tv, tv, <))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Event currently notified to subscribers and its lazily serialized form
+ * @see stream_notify_cbuf
+ */
+static cxobj *_stream_event = NULL;
+static cbuf  *_stream_event_cb = NULL;
+
+/*! Get a shared filter of a stream, parse and add it if not found
+ *
+ * @param[in]  es     Stream
+ * @param[in]  xpath  Filter selector as xpath
+ * @retval     sf     Filter, reference counted
+ * @retval     NULL   Error, eg xpath parse error
+ */
+static struct stream_filter *
+stream_filter_get(event_stream_t *es,
+                  char           *xpath)
+{
+    struct stream_filter *sf;
+
+    if ((sf = es->es_filter) != NULL)
+        do {
+            if (strcmp(sf->sf_xpath, xpath) == 0){
+                sf->sf_refs++;
+                return sf;
+            }
+            sf = NEXTQ(struct stream_filter *, sf);
+        } while (sf && sf != es->es_filter);
+    if ((sf = malloc(sizeof(*sf))) == NULL){
+        clicon_err(OE_CFG, errno, "malloc");
+        return NULL;
+    }
+    memset(sf, 0, sizeof(*sf));
+    if ((sf->sf_xpath = strdup(xpath)) == NULL){
+        clicon_err(OE_CFG, errno, "strdup");
+        free(sf);
+        return NULL;
+    }
+    if (xpath_parse(xpath, &sf->sf_xptree) < 0){
+        free(sf->sf_xpath);
+        free(sf);
+        return NULL;
+    }
+    sf->sf_refs = 1;
+    ADDQ(sf, es->es_filter);
+    return sf;
+}
+
+/*! Release a shared filter of a stream, free it if no subscription uses it
+ *
+ * @param[in]  es  Stream
+ * @param[in]  sf  Filter
+ */
+static void
+stream_filter_put(event_stream_t       *es,
+                  struct stream_filter *sf)
+{
+    if (--sf->sf_refs > 0)
+        return;
+    DELQ(sf, es->es_filter, struct stream_filter *);
+    if (sf->sf_xptree)
+        xpath_tree_free(sf->sf_xptree);
+    free(sf->sf_xpath);
+    free(sf);
+}
+
 /*! Find an event notification stream given name
  *
  * @param[in]  h    Clicon handle
@@ -150,6 +269,8 @@ stream_add(clicon_handle   h,
     es->es_replay_enabled = replay_enabled;
     if (retention)
         es->es_retention = *retention;
+    if (clicon_option_exists(h, "CLICON_STREAM_RETENTION_BYTES"))
+        es->es_retention_bytes = clicon_option_int(h, "CLICON_STREAM_RETENTION_BYTES");
     clicon_stream_append(h, es);
  ok:
     retval = 0;
@@ -166,7 +287,6 @@ int
 stream_delete_all(clicon_handle h,
                   int           force)
 {
-    struct stream_replay *r;
     struct stream_subscription *ss;
     event_stream_t       *es;
     event_stream_t       *head = clicon_stream(h);
@@ -180,12 +300,10 @@ stream_delete_all(clicon_handle h,
             free(es->es_description);
         while ((ss = es->es_subscription) != NULL)
             stream_ss_rm(h, es, ss, force); /* XXX in some cases leaks memory due to DONT clause in stream_ss_rm() */
-        while ((r = es->es_replay) != NULL){
-            DELQ(r, es->es_replay, struct stream_replay *);
-            if (r->r_xml)
-                xml_free(r->r_xml);
-            free(r);
-        }
+        while (es->es_replay_nr)
+            stream_replay_drop(es);
+        if (es->es_replay)
+            free(es->es_replay);
         free(es);
     }
     return 0;
@@ -234,6 +352,79 @@ stream_get_xml(clicon_handle h,
     return 0;
 }
 
+/*! Add stream definition state to a tree bound to yang, supporting RFC 8040 and RFC5277
+ *
+ * Same as stream_get_xml but nodes are created directly, see xml_build_child
+ * @param[in]  h      Clicon handle
+ * @param[in]  access If set, include access/location
+ * @param[in]  xp     Bound parent of streams, ie netconf or restconf-state
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+stream_build_xml(clicon_handle h,
+                 int           access,
+                 cxobj        *xp)
+{
+    int             retval = -1;
+    event_stream_t *es = NULL;
+    cxobj          *xs;
+    cxobj          *x;
+    cxobj          *xa;
+    cbuf           *cb = NULL;
+
+    if ((xs = xml_build_child(xp, "streams")) == NULL)
+        goto done;
+    if ((es = clicon_stream(h)) != NULL){
+        do {
+            if ((x = xml_build_child(xs, "stream")) == NULL)
+                goto done;
+            if (xml_build_str(x, "name", es->es_name) == NULL)
+                goto done;
+            if (es->es_description &&
+                xml_build_str(x, "description", es->es_description) == NULL)
+                goto done;
+            if (xml_build_bool(x, "replay-support", es->es_replay_enabled) == NULL)
+                goto done;
+            if (access){
+                if (cb == NULL && (cb = cbuf_new()) == NULL){
+                    clicon_err(OE_UNIX, errno, "cbuf_new");
+                    goto done;
+                }
+                cbuf_reset(cb);
+                cprintf(cb, "%s/%s/%s", clicon_option_str(h, "CLICON_STREAM_URL"),
+                        clicon_option_str(h, "CLICON_STREAM_PATH"), es->es_name);
+                if ((xa = xml_build_child(x, "access")) == NULL ||
+                    xml_build_str(xa, "encoding", "xml") == NULL ||
+                    xml_build_str(xa, "location", cbuf_get(cb)) == NULL)
+                    goto done;
+            }
+            es = NEXTQ(struct event_stream *, es);
+        } while (es && es != clicon_stream(h));
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Get memory of the replay buffer of a stream
+ *
+ * Maintained as the replay buffer changes, no traversal
+ * @param[in]  es    Event stream
+ * @param[out] nr    Number of replay entries
+ * @param[out] size  Size in bytes of replay ring and serialized entries
+ */
+void
+stream_replay_stats(event_stream_t *es,
+                    uint64_t       *nr,
+                    size_t         *size)
+{
+    *nr = es->es_replay_nr;
+    *size = es->es_replay_size * sizeof(struct stream_replay) + es->es_replay_bytes;
+}
+
 /*! Check all stream subscription stop timers, set up new timer
  *
  * @param[in] fd   No-op
@@ -253,8 +444,6 @@ stream_timer_setup(int   fd,
     event_stream_t              *es;
     struct stream_subscription  *ss;
     struct stream_subscription  *ss1;
-    struct stream_replay        *r;
-    struct stream_replay        *r1;
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
     /* Go thru callbacks and see if any have timed out, if so remove them 
@@ -282,21 +471,11 @@ stream_timer_setup(int   fd,
                         ss = NEXTQ(struct stream_subscription *, ss);
                 } while (ss && ss != es->es_subscription);
   /* 2) Go throughreplay buffer and remove entries with passed retention time */
-            if (timerisset(&es->es_retention) &&
-                (r = es->es_replay) != NULL){
+            if (timerisset(&es->es_retention)){
                 timersub(&now, &es->es_retention, &tret);
-                do {
-                    if (timercmp(&r->r_tv, &tret, <)){
-                        r1 = NEXTQ(struct stream_replay *, r);
-                        DELQ(r, es->es_replay, struct stream_replay *);
-                        if (r->r_xml)
-                            xml_free(r->r_xml);
-                        free(r);
-                        r = r1;
-                    }
-                    else
-                        r = NEXTQ(struct stream_replay *, r);
-                } while (r && r!=es->es_replay);
+                while (es->es_replay_nr &&
+                       timercmp(&stream_replay_i(es, 0)->r_tv, &tret, <))
+                    stream_replay_drop(es);
             }
             es = NEXTQ(struct event_stream *, es);
         } while (es && es != clicon_stream(h));
@@ -333,8 +512,8 @@ stream_del()
  * @param[in]  stoptime If set, dont continue past this time
  * @param[in]  fn       Callback when event occurs
  * @param[in]  arg      Argument to use with callback. Also handle when deleting
- * @retval     0        OK
- * @retval    -1        Error, ie no such stream 
+ * @retval     ss       Subscription
+ * @retval     NULL     Error, ie no such stream or invalid xpath
  */
 struct stream_subscription *
 stream_ss_add(clicon_handle     h,
@@ -370,13 +549,22 @@ stream_ss_add(clicon_handle     h,
         clicon_err(OE_CFG, errno, "strdup");
         goto done;
     }
+    /* Parse filter once, shared with other subscriptions with same filter */
+    if (xpath && strlen(xpath) &&
+        (ss->ss_filter = stream_filter_get(es, xpath)) == NULL)
+        goto done;
     ss->ss_fn     = fn;
     ss->ss_arg    = arg;
     ADDQ(ss, es->es_subscription);
     return ss;
   done:
-    if (ss)
+    if (ss){
+        if (ss->ss_stream)
+            free(ss->ss_stream);
+        if (ss->ss_xpath)
+            free(ss->ss_xpath);
         free(ss);
+    }
     return NULL;
 }
 
@@ -397,6 +585,10 @@ stream_ss_rm(clicon_handle                h,
 {
     clicon_debug(1, "%s", __FUNCTION__);
     DELQ(ss, es->es_subscription, struct stream_subscription *);
+    if (ss->ss_filter){
+        stream_filter_put(es, ss->ss_filter);
+        ss->ss_filter = NULL;
+    }
     /* Remove from upper layers - close socket etc. */
     (*ss->ss_fn)(h, 1, NULL, ss->ss_arg);
     if (force){
@@ -495,6 +687,8 @@ stream_ss_delete(clicon_handle     h,
 
 /*! Stream notify event and distribute to all registered callbacks
  *
+ * Each distinct filter of the stream is evaluated once, and the event is serialized at
+ * most once for all subscribers, see stream_notify_cbuf
  * @param[in]  h       Clicon handle
  * @param[in]  stream  Name of event stream. CLICON is predefined as LOG stream
  * @param[in]  tv      Timestamp. Dont notify if subscription has stoptime<tv
@@ -512,8 +706,24 @@ stream_notify1(clicon_handle   h,
 {
     int                         retval = -1;
     struct stream_subscription *ss;
+    struct stream_filter       *sf;
+    cxobj                      *x0;
+    cbuf                       *cb0;
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    if (es->es_subscription == NULL)
+        return 0;
+    /* Evaluate each distinct filter once */
+    if ((sf = es->es_filter) != NULL)
+        do {
+            sf->sf_match = xpath_vec_bool_tree(xevent, NULL, sf->sf_xptree) > 0;
+            sf = NEXTQ(struct stream_filter *, sf);
+        } while (sf && sf != es->es_filter);
+    /* Callbacks may notify other events */
+    x0 = _stream_event;
+    cb0 = _stream_event_cb;
+    _stream_event = xevent;
+    _stream_event_cb = NULL;
     /* Go thru all subscriptions and find matches */
     if ((ss = es->es_subscription) != NULL)
         do {
@@ -527,9 +737,7 @@ stream_notify1(clicon_handle   h,
                 ss = ss1;
             }
             else{  /* xpath match */
-                if (ss->ss_xpath == NULL ||
-                    strlen(ss->ss_xpath)==0 ||
-                    xpath_first(xevent, NULL, "%s", ss->ss_xpath) != NULL)
+                if (ss->ss_filter == NULL || ss->ss_filter->sf_match)
                     if ((*ss->ss_fn)(h, 0, xevent, ss->ss_arg) < 0)
                         goto done;
                 ss = NEXTQ(struct stream_subscription *, ss);
@@ -537,9 +745,76 @@ stream_notify1(clicon_handle   h,
         } while (es->es_subscription && ss != es->es_subscription);
     retval = 0;
   done:
+    if (_stream_event_cb)
+        cbuf_free(_stream_event_cb);
+    _stream_event = x0;
+    _stream_event_cb = cb0;
     return retval;
 }
 
+/*! Get event serialized as XML, shared by all subscribers of the event
+ *
+ * Use in a stream callback to avoid serializing the same event for each subscriber.
+ * The event is serialized at most once per notification.
+ * @param[in]  event  Event as given to stream callback
+ * @param[out] cbp    Serialized event, do not free or modify
+ * @retval     1      OK, cbp set
+ * @retval     0      Event is not being notified, eg a replay, serialize it yourself
+ * @retval    -1      Error
+ * @see stream_fn_t
+ */
+int
+stream_notify_cbuf(cxobj *event,
+                   cbuf **cbp)
+{
+    if (event == NULL || event != _stream_event)
+        return 0;
+    if (_stream_event_cb == NULL){
+        if ((_stream_event_cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            return -1;
+        }
+        if (clixon_xml2cbuf(_stream_event_cb, event, 0, 0, NULL, -1, 0) < 0){
+            cbuf_free(_stream_event_cb);
+            _stream_event_cb = NULL;
+            return -1;
+        }
+    }
+    *cbp = _stream_event_cb;
+    return 1;
+}
+
+/*! Create RFC5277 notification envelope with event time, without parsing
+ *
+ * @param[in]  tv    Event time
+ * @retval     xn    Notification element, add event as child. Free with xml_free
+ * @retval     NULL  Error
+ */
+static cxobj *
+stream_notification_new(struct timeval *tv)
+{
+    cxobj *xret = NULL;
+    cxobj *xn = NULL;
+    char   timestr[28];
+
+    if (time2str(tv, timestr, sizeof(timestr)) < 0){
+        clicon_err(OE_UNIX, errno, "time2str");
+        goto done;
+    }
+    if ((xn = xml_new("notification", NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xmlns_set(xn, NULL, NETCONF_NOTIFICATION_NAMESPACE) < 0)
+        goto done;
+    if (xml_new_body("eventTime", xn, timestr) == NULL)
+        goto done;
+    xret = xn;
+    xn = NULL;
+ done:
+    if (xn)
+        xml_free(xn);
+    return xret;
+}
+
 /*! Stream notify event and distribute to all registered callbacks
  *
  * @param[in]  h       Clicon handle
@@ -562,10 +837,7 @@ stream_notify(clicon_handle h,
     va_list         args;
     int             len;
     cxobj          *xev = NULL;
-    yang_stmt      *yspec = NULL;
     char           *str = NULL;
-    cbuf           *cb = NULL;
-    char            timestr[28];
     struct timeval  tv;
     event_stream_t *es;
 
@@ -583,25 +855,11 @@ stream_notify(clicon_handle h,
     va_start(args, event);
     len = vsnprintf(str, len, event, args) + 1;
     va_end(args);
-    if ((yspec = clicon_dbspec_yang(h)) == NULL){
-        clicon_err(OE_YANG, 0, "No yang spec");
-        goto done;
-    }
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
     gettimeofday(&tv, NULL);
-    if (time2str(&tv, timestr, sizeof(timestr)) < 0){
-        clicon_err(OE_UNIX, errno, "time2str");
-        goto done;
-    }
     /* From RFC5277 */
-    cprintf(cb, "<notification xmlns=\"%s\"><eventTime>%s</eventTime>%s</notification>",
-            NETCONF_NOTIFICATION_NAMESPACE, timestr, str);
-    if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, &xev, NULL) < 0)
+    if ((xev = stream_notification_new(&tv)) == NULL)
         goto done;
-    if (xml_rootchild(xev, 0, &xev) < 0)
+    if (clixon_xml_parse_string(str, YB_NONE, NULL, &xev, NULL) < 0)
         goto done;
     if (stream_notify1(h, es, &tv, xev) < 0)
         goto done;
@@ -613,8 +871,6 @@ stream_notify(clicon_handle h,
  ok:
     retval = 0;
   done:
-    if (cb)
-        cbuf_free(cb);
     if (xev)
         xml_free(xev);
     if (str)
@@ -636,38 +892,17 @@ stream_notify_xml(clicon_handle h,
                   char         *stream, 
                   cxobj        *xml)
 {
-    int        retval = -1;
-    cxobj     *xev = NULL;
-    cxobj     *xml2; /* copy */
-    yang_stmt *yspec = NULL;
-    char      *str = NULL; /* XXX: never set */
-    cbuf      *cb = NULL;
-    char       timestr[28];
-    struct timeval tv;
+    int             retval = -1;
+    cxobj          *xev = NULL;
+    cxobj          *xml2; /* copy */
+    struct timeval  tv;
     event_stream_t *es;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
     if ((es = stream_find(h, stream)) == NULL)
         goto ok;
-    if ((yspec = clicon_dbspec_yang(h)) == NULL){
-        clicon_err(OE_YANG, 0, "No yang spec");
-        goto done;
-    }
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
     gettimeofday(&tv, NULL);
-    if (time2str(&tv, timestr, sizeof(timestr)) < 0){
-        clicon_err(OE_UNIX, errno, "time2str");
-        goto done;
-    }
-    cprintf(cb, "<notification xmlns=\"%s\"><eventTime>%s</eventTime>NULL</notification>",
-            NETCONF_NOTIFICATION_NAMESPACE,
-            timestr); /* XXX str is always NULL */
-    if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, yspec, &xev, NULL) < 0)
-        goto done;
-    if (xml_rootchild(xev, 0, &xev) < 0)
+    if ((xev = stream_notification_new(&tv)) == NULL)
         goto done;
     if ((xml2 = xml_dup(xml)) == NULL)
         goto done;
@@ -683,12 +918,8 @@ stream_notify_xml(clicon_handle h,
  ok:
     retval = 0;
   done:
-    if (cb)
-        cbuf_free(cb);
     if (xev)
         xml_free(xev);
-    if (str)
-        free(str);
     return retval;
 }
 
@@ -718,6 +949,7 @@ stream_notify_xml(clicon_handle h,
          zones.
          
  * Assume no future sample timestamps.
+ * The start entry is found by binary search, entries are parsed one at a time when sent
  */
 static int
 stream_replay_notify(clicon_handle               h,
@@ -726,43 +958,48 @@ stream_replay_notify(clicon_handle               h,
 {
     int                   retval = -1;
     struct stream_replay *r;
+    size_t                i;
+    cxobj                *xt = NULL;
 
     /* If <startTime> is not present, this is not a replay */
     if (!timerisset(&ss->ss_starttime))
         goto ok;
     if (!es->es_replay_enabled)
         goto ok;
-    /* Get replay linked list */
-    if ((r = es->es_replay) == NULL)
-        goto ok;
-    /* First loop to skip until start */
-    do {
-        if (timercmp(&r->r_tv, &ss->ss_starttime, >=))
-            break;
-        r = NEXTQ(struct stream_replay *, r);
-    } while (r && r!=es->es_replay);
-    if (r == NULL)
-        goto ok; /* No samples to replay */
-    /* Then notify until stop */
-    do {
+    /* Seek to start, then notify until stop */
+    for (i = stream_replay_seek(es, &ss->ss_starttime); i < es->es_replay_nr; i++){
+        r = stream_replay_i(es, i);
         if (timerisset(&ss->ss_stoptime) &&
             timercmp(&r->r_tv, &ss->ss_stoptime, >))
             break;
-        if ((*ss->ss_fn)(h, 0, r->r_xml, ss->ss_arg) < 0)
+        if (clixon_xml_parse_string(r->r_str, YB_NONE, NULL, &xt, NULL) < 0)
             goto done;
-        r = NEXTQ(struct stream_replay *, r);
-    } while (r && r!=es->es_replay);
+        if (xml_rootchild(xt, 0, &xt) < 0)
+            goto done;
+        if (ss->ss_filter == NULL ||
+            xpath_vec_bool_tree(xt, NULL, ss->ss_filter->sf_xptree) > 0)
+            if ((*ss->ss_fn)(h, 0, xt, ss->ss_arg) < 0)
+                goto done;
+        xml_free(xt);
+        xt = NULL;
+    }
  ok:
     retval = 0;
  done:
+    if (xt)
+        xml_free(xt);
     return retval;
 }
 
 /*! Add replay sample to stream with timestamp
  *
+ * The event is serialized and stored last in the replay ring of the stream, entries older
+ * than retention time, or exceeding retention bytes, are dropped.
  * @param[in] es   Stream
  * @param[in] tv   Timestamp
- * @param[in] xv   XML
+ * @param[in] xv   XML, consumed by this function if OK
+ * @retval    0    OK
+ * @retval   -1    Error
  */
 int
 stream_replay_add(event_stream_t *es,
@@ -770,18 +1007,63 @@ stream_replay_add(event_stream_t *es,
                   cxobj          *xv)
 {
     int                   retval = -1;
-    struct stream_replay *new;
+    cbuf                 *cb = NULL;
+    struct stream_replay *ring;
+    struct stream_replay *r;
+    struct timeval        tret;
+    size_t                size;
+    size_t                i;
 
-    if ((new = malloc(sizeof *new)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    memset(new, 0, (sizeof *new));
-    new->r_tv = *tv;
-    new->r_xml = xv;
-    ADDQ(new, es->es_replay);
+    if (clixon_xml2cbuf(cb, xv, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    /* Grow ring if full, oldest entry first in new ring */
+    if (es->es_replay_nr == es->es_replay_size){
+        size = es->es_replay_size ? 2*es->es_replay_size : STREAM_REPLAY_SIZE0;
+        if ((ring = calloc(size, sizeof(*ring))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        for (i = 0; i < es->es_replay_nr; i++)
+            ring[i] = *stream_replay_i(es, i);
+        if (es->es_replay)
+            free(es->es_replay);
+        es->es_replay = ring;
+        es->es_replay_size = size;
+        es->es_replay_head = 0;
+    }
+    r = &es->es_replay[(es->es_replay_head + es->es_replay_nr) % es->es_replay_size];
+    if ((r->r_str = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    r->r_len = cbuf_len(cb);
+    r->r_tv = *tv;
+    /* Keep time index ordered, eg if clock is adjusted backwards */
+    if (es->es_replay_nr &&
+        timercmp(tv, &stream_replay_i(es, es->es_replay_nr-1)->r_tv, <))
+        r->r_tv = stream_replay_i(es, es->es_replay_nr-1)->r_tv;
+    es->es_replay_nr++;
+    es->es_replay_bytes += r->r_len;
+    /* Retention, but keep the new entry */
+    if (timerisset(&es->es_retention)){
+        timersub(tv, &es->es_retention, &tret);
+        while (es->es_replay_nr > 1 &&
+               timercmp(&stream_replay_i(es, 0)->r_tv, &tret, <))
+            stream_replay_drop(es);
+    }
+    while (es->es_retention_bytes &&
+           es->es_replay_nr > 1 &&
+           es->es_replay_bytes > es->es_retention_bytes)
+        stream_replay_drop(es);
+    xml_free(xv);
     retval = 0;
  done:
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
@@ -872,6 +1154,8 @@ stream_replay_trigger(clicon_handle h,
 /* SSE support using Nginx Nchan. This code needs to be enabled at configure 
  * time using: --enable-publish configure option
  * It uses CURL and autoconf needs to set that dependency
+ * Events are queued per stream and posted in batches by a curl multi handle driven by the
+ * clixon event loop, so that a slow or unreachable publish server does not block the backend.
  */
 
 #include <curl/curl.h>
@@ -879,103 +1163,301 @@ stream_replay_trigger(clicon_handle h,
 /*
  * Types (curl)
  */
-struct curlbuf{
-    size_t b_len;
-    char  *b_buf;
+/* Queued event of a published stream */
+struct publish_event{
+    qelem_t  pe_q;      /* queue header */
+    cbuf    *pe_cb;     /* Serialized event */
+};
+
+/* Publisher of one stream */
+struct publisher{
+    qelem_t               pb_q;        /* queue header */
+    char                 *pb_stream;   /* Name of stream */
+    char                 *pb_url;      /* Publish url: CLICON_STREAM_PUB/<stream> */
+    CURL                 *pb_curl;     /* Easy handle, re-used to keep connection */
+    struct publish_event *pb_events;   /* Queue of events not yet posted */
+    int                   pb_nevents;  /* Length of event queue */
+    cbuf                 *pb_body;     /* Batch being posted, or waiting for retry */
+    int                   pb_nbody;    /* Nr of events in batch */
+    int                   pb_busy;     /* Post in progress or retry timer set */
+    int                   pb_retries;  /* Nr of failed posts of batch */
+    char                  pb_err[CURL_ERROR_SIZE];
+    uint64_t              pb_sent;     /* Events posted */
+    uint64_t              pb_dropped;  /* Events dropped due to full queue */
+    uint64_t              pb_failed;   /* Failed posts, each retried */
 };
 
 /*
- * For the asynchronous case. I think we must handle the case where of many of these
- * come in before we can handle them in the upper-level polling routine.
- * realloc. Therefore, we append new data to the userdata buffer.
+ * Internal variables
+ * XXX consider use handle variables instead of global
+ */
+static CURLM            *_publish_multi = NULL;
+static struct publisher *_publishers = NULL;
+static int               _publish_timer = 0;
+
+static int publish_action(curl_socket_t s, int ev);
+
+/*! Discard reply data of publish server
  */
 static size_t
-curl_get_cb(void *ptr, 
-            size_t size, 
-            size_t nmemb, 
-            void *userdata)
+publish_write_cb(void  *ptr, 
+                 size_t size, 
+                 size_t nmemb, 
+                 void  *userdata)
+{
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: %.*s", __FUNCTION__, (int)(size*nmemb), (char*)ptr);
+    return size*nmemb;
+}
+
+/*! Socket readable, called from event loop
+ */
+static int
+publish_fd_in(int   s,
+              void *arg)
+{
+    return publish_action(s, CURL_CSELECT_IN);
+}
+
+/*! Socket writable, called from event loop
+ */
+static int
+publish_fd_out(int   s,
+               void *arg)
+{
+    return publish_action(s, CURL_CSELECT_OUT);
+}
+
+/*! Curl multi timeout expired, called from event loop
+ */
+static int
+publish_timeout(int   fd,
+                void *arg)
+{
+    _publish_timer = 0;
+    return publish_action(CURL_SOCKET_TIMEOUT, 0);
+}
+
+/*! Curl multi socket callback: register or deregister socket in event loop
+ *
+ * @param[in]  socketp  Events registered on socket, as assigned by curl_multi_assign
+ * @see CURLMOPT_SOCKETFUNCTION
+ */
+static int
+publish_socket_cb(CURL         *easy,
+                  curl_socket_t s,
+                  int           what,
+                  void         *userp,
+                  void         *socketp)
+{
+    intptr_t old = (intptr_t)socketp;
+    intptr_t new = 0x4; /* assigned */
+
+    if (what == CURL_POLL_IN || what == CURL_POLL_INOUT)
+        new |= CURL_POLL_IN;
+    if (what == CURL_POLL_OUT || what == CURL_POLL_INOUT)
+        new |= CURL_POLL_OUT;
+    if ((old & CURL_POLL_IN) && !(new & CURL_POLL_IN))
+        clixon_event_unreg_fd(s, publish_fd_in);
+    if ((old & CURL_POLL_OUT) && !(new & CURL_POLL_OUT))
+        clixon_event_unreg_fd_write(s, publish_fd_out);
+    if (!(old & CURL_POLL_IN) && (new & CURL_POLL_IN) &&
+        clixon_event_reg_fd(s, publish_fd_in, NULL, "stream publish") < 0)
+        return -1;
+    if (!(old & CURL_POLL_OUT) && (new & CURL_POLL_OUT) &&
+        clixon_event_reg_fd_write(s, publish_fd_out, NULL, "stream publish") < 0)
+        return -1;
+    curl_multi_assign(_publish_multi, s, what == CURL_POLL_REMOVE ? NULL : (void*)new);
+    return 0;
+}
+
+/*! Curl multi timer callback: set or cancel timeout in event loop
+ *
+ * @see CURLMOPT_TIMERFUNCTION
+ */
+static int
+publish_timer_cb(CURLM *multi,
+                 long   timeout_ms,
+                 void  *userp)
 {
-    struct curlbuf *buf = (struct curlbuf *)userdata;
-    int len;
+    struct timeval t;
+    struct timeval d;
 
-    len = size*nmemb;
-    if ((buf->b_buf = realloc(buf->b_buf, buf->b_len+len+1)) == NULL)
+    if (_publish_timer){
+        clixon_event_unreg_timeout(publish_timeout, NULL);
+        _publish_timer = 0;
+    }
+    if (timeout_ms < 0)
         return 0;
-    memcpy(buf->b_buf+buf->b_len, ptr, len);
-    buf->b_len += len;
-    buf->b_buf[buf->b_len] = '\0';
-    return len;
+    gettimeofday(&t, NULL);
+    d.tv_sec = timeout_ms/1000;
+    d.tv_usec = (timeout_ms%1000)*1000;
+    timeradd(&t, &d, &t);
+    if (clixon_event_reg_timeout(t, publish_timeout, NULL, "stream publish curl") < 0)
+        return -1;
+    _publish_timer = 1;
+    return 0;
+}
+
+/*! Post batch of a publisher
+ */
+static int
+publish_post(struct publisher *pb)
+{
+    curl_easy_setopt(pb->pb_curl, CURLOPT_POSTFIELDS, cbuf_get(pb->pb_body));
+    curl_easy_setopt(pb->pb_curl, CURLOPT_POSTFIELDSIZE, (long)cbuf_len(pb->pb_body));
+    if (curl_multi_add_handle(_publish_multi, pb->pb_curl) != CURLM_OK){
+        clicon_err(OE_UNIX, 0, "curl_multi_add_handle");
+        return -1;
+    }
+    pb->pb_busy = 1;
+    return 0;
 }
 
-/*! Send a curl POST request
+/*! Start post of next batch of queued events, unless a post is in progress
  *
- * @retval   1   ok
- * @retval   0   expect set but did not expected return or other non-fatal error
- * @retval  -1   fatal error
- * Note: curl_easy_perform blocks
- * Note: New handle is created every time, the handle can be re-used for better TCP performance
- * @see same function (url_post) in grideye_curl.c
+ * Events of a batch are separated by newline
  */
 static int
-url_post(char *url, 
-         char *postfields, 
-         char **getdata)
+publish_start(struct publisher *pb)
 {
-    int            retval = -1;
-    CURL          *curl = NULL;
-    char          *err = NULL;
-    struct curlbuf cb = {0, };
-    CURLcode       errcode;
-
-    /* Try it with  curl -X PUT -d '*/
-    clicon_debug(1, "%s:  curl -X POST -d '%s' %s",
-        __FUNCTION__, postfields, url);
-    /* Set up curl for doing the communication with the controller */
-    if ((curl = curl_easy_init()) == NULL) {
-        clicon_debug(1, "curl_easy_init");
-        goto done;
+    struct publish_event *pe;
+    int                   n = 0;
+
+    if (pb->pb_busy || pb->pb_events == NULL)
+        return 0;
+    cbuf_reset(pb->pb_body);
+    while ((pe = pb->pb_events) != NULL && n < PUBLISH_BATCH_MAX){
+        if (n)
+            cprintf(pb->pb_body, "\n");
+        if (cbuf_append_buf(pb->pb_body, cbuf_get(pe->pe_cb), cbuf_len(pe->pe_cb)) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            return -1;
+        }
+        DELQ(pe, pb->pb_events, struct publish_event *);
+        cbuf_free(pe->pe_cb);
+        free(pe);
+        pb->pb_nevents--;
+        n++;
     }
-    if ((err = malloc(CURL_ERROR_SIZE)) == NULL) {
-        clicon_debug(1, "%s: malloc", __FUNCTION__);
-        goto done;
+    pb->pb_nbody = n;
+    pb->pb_retries = 0;
+    return publish_post(pb);
+}
+
+/*! Retry post of batch after backoff
+ */
+static int
+publish_retry(int   fd,
+              void *arg)
+{
+    struct publisher *pb = (struct publisher *)arg;
+
+    return publish_post(pb);
+}
+
+/*! Post of batch is done: start next batch, or retry with exponential backoff on failure
+ */
+static int
+publish_done(struct publisher *pb,
+             CURLcode          result)
+{
+    long           code = 0;
+    struct timeval t;
+    struct timeval d;
+    uint64_t       ms;
+
+    curl_multi_remove_handle(_publish_multi, pb->pb_curl);
+    pb->pb_busy = 0;
+    if (result == CURLE_OK)
+        curl_easy_getinfo(pb->pb_curl, CURLINFO_RESPONSE_CODE, &code);
+    if (result == CURLE_OK && code >= 200 && code < 300){
+        pb->pb_sent += pb->pb_nbody;
+        pb->pb_nbody = 0;
+        return publish_start(pb);
     }
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_get_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &cb);
-    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, err);
-    curl_easy_setopt(curl, CURLOPT_POST, 1);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postfields);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, strlen(postfields));
+    pb->pb_failed++;
+    if (result != CURLE_OK)
+        clicon_debug(1, "%s: %s: curl: %s(%d)", __FUNCTION__, pb->pb_url, pb->pb_err, result);
+    else
+        clicon_debug(1, "%s: %s: HTTP status %ld", __FUNCTION__, pb->pb_url, code);
+    ms = (uint64_t)PUBLISH_BACKOFF_MIN << (pb->pb_retries < 16 ? pb->pb_retries : 16);
+    if (ms > (uint64_t)PUBLISH_BACKOFF_MAX*1000)
+        ms = (uint64_t)PUBLISH_BACKOFF_MAX*1000;
+    pb->pb_retries++;
+    gettimeofday(&t, NULL);
+    d.tv_sec = ms/1000;
+    d.tv_usec = (ms%1000)*1000;
+    timeradd(&t, &d, &t);
+    if (clixon_event_reg_timeout(t, publish_retry, pb, "stream publish retry") < 0)
+        return -1;
+    pb->pb_busy = 1;
+    return 0;
+}
 
-    if (clicon_debug_get())
-        curl_easy_setopt(curl, CURLOPT_VERBOSE, 1);   
-    if ((errcode = curl_easy_perform(curl)) != CURLE_OK){
-        clicon_debug(1, "%s: curl: %s(%d)", __FUNCTION__, err, errcode);
-        retval = 0;
-        goto done; 
+/*! Let curl act on socket or timeout and handle completed posts
+ *
+ * @param[in]  s   Socket, or CURL_SOCKET_TIMEOUT
+ * @param[in]  ev  CURL_CSELECT_IN or CURL_CSELECT_OUT, or 0
+ */
+static int
+publish_action(curl_socket_t s,
+               int           ev)
+{
+    int               running = 0;
+    int               left;
+    CURLMsg          *msg;
+    struct publisher *pb = NULL;
+
+    if (curl_multi_socket_action(_publish_multi, s, ev, &running) != CURLM_OK){
+        clicon_err(OE_UNIX, 0, "curl_multi_socket_action");
+        return -1;
     }
-    if (getdata && cb.b_buf){
-        *getdata = cb.b_buf;
-        cb.b_buf = NULL;
+    while ((msg = curl_multi_info_read(_publish_multi, &left)) != NULL){
+        if (msg->msg != CURLMSG_DONE)
+            continue;
+        if (curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&pb) != CURLE_OK || pb == NULL)
+            continue;
+        if (publish_done(pb, msg->data.result) < 0)
+            return -1;
     }
-    retval = 1;
-  done:
-    if (err)
-        free(err);
-    if (cb.b_buf)
-        free(cb.b_buf);
-    if (curl)
-        curl_easy_cleanup(curl);   /* cleanup */ 
-    return retval;
+    return 0;
+}
+
+/*! Free a publisher
+ */
+static void
+publisher_free(struct publisher *pb)
+{
+    struct publish_event *pe;
+
+    if (pb->pb_busy){
+        clixon_event_unreg_timeout(publish_retry, pb);
+        curl_multi_remove_handle(_publish_multi, pb->pb_curl);
+    }
+    if (pb->pb_curl)
+        curl_easy_cleanup(pb->pb_curl);
+    while ((pe = pb->pb_events) != NULL){
+        DELQ(pe, pb->pb_events, struct publish_event *);
+        cbuf_free(pe->pe_cb);
+        free(pe);
+    }
+    if (pb->pb_body)
+        cbuf_free(pb->pb_body);
+    if (pb->pb_url)
+        free(pb->pb_url);
+    if (pb->pb_stream)
+        free(pb->pb_stream);
+    free(pb);
 }
 
 /*! Stream callback for example stream notification 
  *
- * Push via curl_post to publish stream event
+ * Queue the event for publishing and start a post if none is in progress.
+ * If the queue is full, the oldest event is dropped.
  * @param[in]  h     Clicon handle
  * @param[in]  op    Operation: 0 OK, 1 Close
  * @param[in]  event Event as XML
- * @param[in]  arg   Extra argument provided in stream_ss_add
+ * @param[in]  arg   Publisher, provided in stream_ss_add
  * @see stream_ss_add
  */
 static int 
@@ -984,65 +1466,122 @@ stream_publish_cb(clicon_handle h,
                   cxobj        *event,
                   void         *arg)
 {
-    int   retval = -1;
-    cbuf *u = NULL; /* stream pub (push) url */
-    cbuf *d = NULL; /* (XML) data to push */
-    char *pub_prefix;
-    char *result = NULL;
-    char *stream = (char*)arg;
+    int                   retval = -1;
+    struct publisher     *pb = (struct publisher *)arg;
+    struct publish_event *pe = NULL;
+    cbuf                 *cb;
+    int                   ret;
 
     clicon_debug(1, "%s", __FUNCTION__); 
     if (op != 0)
         goto ok;
-    /* Create pub url */
-    if ((u = cbuf_new()) == NULL){
-        clicon_err(OE_XML, errno, "cbuf_new");
+    if ((pe = calloc(1, sizeof(*pe))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
         goto done;
     }
-    if ((pub_prefix = clicon_option_str(h, "CLICON_STREAM_PUB")) == NULL){
-        clicon_err(OE_CFG, ENOENT, "CLICON_STREAM_PUB not defined");
+    if ((pe->pe_cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
-    cprintf(u, "%s/%s", pub_prefix, stream);
-    /* Create XML data as string */
-    if ((d = cbuf_new()) == NULL){
-        clicon_err(OE_XML, errno, "cbuf_new");
+    /* Re-use event serialized for other subscribers if possible */
+    if ((ret = stream_notify_cbuf(event, &cb)) < 0)
         goto done;
+    if (ret == 1){
+        if (cbuf_append_buf(pe->pe_cb, cbuf_get(cb), cbuf_len(cb)) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
     }
-    if (clixon_xml2cbuf(d, event, 0, 0, NULL, -1, 0) < 0)
+    else if (clixon_xml2cbuf(pe->pe_cb, event, 0, 0, NULL, -1, 0) < 0)
         goto done;
-    if (url_post(cbuf_get(u),     /* url+stream */
-                 cbuf_get(d),     /* postfields */
-                 &result) < 0)    /* result as xml */
+    if (pb->pb_nevents >= PUBLISH_QUEUE_MAX){
+        struct publish_event *pe0 = pb->pb_events;
+
+        DELQ(pe0, pb->pb_events, struct publish_event *);
+        cbuf_free(pe0->pe_cb);
+        free(pe0);
+        pb->pb_nevents--;
+        if (pb->pb_dropped++ == 0)
+            clicon_log(LOG_WARNING, "%s: %s: queue full, dropping events", __FUNCTION__, pb->pb_url);
+    }
+    ADDQ(pe, pb->pb_events);
+    pb->pb_nevents++;
+    pe = NULL;
+    if (publish_start(pb) < 0)
         goto done;
-    if (result)
-        clicon_debug(1, "%s: %s", __FUNCTION__, result);
  ok:
     retval = 0;
  done:
-    if (u)
-        cbuf_free(u);
-    if (d)
-        cbuf_free(d);
-    if (result)
-        free(result);
+    if (pe){
+        if (pe->pe_cb)
+            cbuf_free(pe->pe_cb);
+        free(pe);
+    }
     return retval;
 }
 #endif /* CLIXON_PUBLISH_STREAMS */
 
 /*! Publish all streams on a pubsub channel, eg using SSE
+ *
+ * Events are posted to CLICON_STREAM_PUB/<stream> without blocking. Requires stream_publish_init
  */
 int
 stream_publish(clicon_handle h,
                char         *stream)
 {
 #ifdef CLIXON_PUBLISH_STREAMS
-    int retval = -1;
+    int               retval = -1;
+    struct publisher *pb = NULL;
+    char             *pub_prefix;
+    cbuf             *u = NULL;
 
-    if (stream_ss_add(h, stream, NULL, NULL, NULL, stream_publish_cb, (void*)stream) < 0)
+    if (_publish_multi == NULL){
+        clicon_err(OE_PLUGIN, EINVAL, "stream_publish_init not called");
+        goto done;
+    }
+    if ((pub_prefix = clicon_option_str(h, "CLICON_STREAM_PUB")) == NULL){
+        clicon_err(OE_CFG, ENOENT, "CLICON_STREAM_PUB not defined");
+        goto done;
+    }
+    if ((pb = calloc(1, sizeof(*pb))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
         goto done;
+    }
+    if ((u = cbuf_new()) == NULL ||
+        (pb->pb_body = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(u, "%s/%s", pub_prefix, stream);
+    if ((pb->pb_url = strdup(cbuf_get(u))) == NULL ||
+        (pb->pb_stream = strdup(stream)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((pb->pb_curl = curl_easy_init()) == NULL){
+        clicon_err(OE_UNIX, 0, "curl_easy_init");
+        goto done;
+    }
+    curl_easy_setopt(pb->pb_curl, CURLOPT_URL, pb->pb_url);
+    curl_easy_setopt(pb->pb_curl, CURLOPT_PRIVATE, pb);
+    curl_easy_setopt(pb->pb_curl, CURLOPT_WRITEFUNCTION, publish_write_cb);
+    curl_easy_setopt(pb->pb_curl, CURLOPT_ERRORBUFFER, pb->pb_err);
+    curl_easy_setopt(pb->pb_curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(pb->pb_curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(pb->pb_curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(pb->pb_curl, CURLOPT_CONNECTTIMEOUT, (long)PUBLISH_BACKOFF_MAX);
+    if (clicon_debug_get())
+        curl_easy_setopt(pb->pb_curl, CURLOPT_VERBOSE, 1L);   
+    if (stream_ss_add(h, stream, NULL, NULL, NULL, stream_publish_cb, (void*)pb) == NULL)
+        goto done;
+    ADDQ(pb, _publishers);
+    pb = NULL;
     retval = 0;
  done:
+    if (pb)
+        publisher_free(pb);
+    if (u)
+        cbuf_free(u);
     return retval;
 #else
    clicon_log(LOG_WARNING, "%s called but CLIXON_PUBLISH_STREAMS not enabled (enable with configure --enable-publish)", __FUNCTION__);
@@ -1061,6 +1600,13 @@ stream_publish_init()
         clicon_err(OE_PLUGIN, errno, "curl_global_init");
         goto done;
     }    
+    if ((_publish_multi = curl_multi_init()) == NULL){
+        clicon_err(OE_PLUGIN, 0, "curl_multi_init");
+        goto done;
+    }
+    curl_multi_setopt(_publish_multi, CURLMOPT_SOCKETFUNCTION, publish_socket_cb);
+    curl_multi_setopt(_publish_multi, CURLMOPT_TIMERFUNCTION, publish_timer_cb);
+    curl_multi_setopt(_publish_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
     retval = 0;
  done:
     return retval;
@@ -1069,10 +1615,29 @@ stream_publish_init()
 #endif
 }
 
+/*! Stop publishing, log statistics and drop queued events
+ */
 int 
 stream_publish_exit()
 {
 #ifdef CLIXON_PUBLISH_STREAMS
+    struct publisher *pb;
+
+    while ((pb = _publishers) != NULL){
+        DELQ(pb, _publishers, struct publisher *);
+        clicon_log(LOG_INFO, "%s: %s: sent:%" PRIu64 " dropped:%" PRIu64 " failed posts:%" PRIu64 " queued:%d",
+                   __FUNCTION__, pb->pb_url, pb->pb_sent, pb->pb_dropped, pb->pb_failed,
+                   pb->pb_nevents + pb->pb_nbody);
+        publisher_free(pb);
+    }
+    if (_publish_timer){
+        clixon_event_unreg_timeout(publish_timeout, NULL);
+        _publish_timer = 0;
+    }
+    if (_publish_multi){
+        curl_multi_cleanup(_publish_multi);
+        _publish_multi = NULL;
+    }
     curl_global_cleanup();
 #endif 
     return 0;
@@ -40,10 +40,12 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <ctype.h>
+#include <pthread.h>
 
 #include <cligen/cligen.h>
 
@@ -425,14 +427,9 @@ xml_chardata_encode(char      **escp,
     int     retval = -1;
     char   *str = NULL;  /* Expanded format string w stdarg */
     int     fmtlen;
-    char   *esc = NULL;
-    int     l;
-    int     len;
-    int     i, j;
-    int     cdata; /* when set, skip encoding */
     va_list args;
-    size_t  slen;
-    
+    cbuf   *cb = NULL;
+
     /* Two steps: (1) read in the complete format string */
     va_start(args, fmt); /* dryrun */
     fmtlen = vsnprintf(NULL, 0, fmt, args) + 1;
@@ -448,99 +445,29 @@ xml_chardata_encode(char      **escp,
     /* Now str is the combined fmt + ... */
 
     /* Step (2) encode and expand str --> enc */
-    /* First compute length (do nothing) */
-    len = 0; cdata = 0;
-    slen = strlen(str);
-    for (i=0; i<slen; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0)
-                cdata = 0;
-            len++;
-        }
-        else
-            switch (str[i]){
-            case '&':
-                len += strlen("&amp;");
-                break;
-            case '<':
-                if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                    len++;
-                    cdata++;
-                }
-                else
-                    len += strlen("&lt;");
-                break;
-            case '>':
-                len += strlen("&gt;");
-                break;
-            default:
-                len++;
-            }
-    }
-    len++; /* trailing \0 */
-    /* We know length, allocate encoding buffer  */
-    if ((esc = malloc(len)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc"); 
+    if ((cb = cbuf_new_alloc(fmtlen)) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
         goto done;
     }
-    memset(esc, 0, len);
-
-    /* Same code again, but now actually encode into output buffer */
-    j = 0; cdata = 0;
-    slen = strlen(str);
-    for (i=0; i<slen; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0){
-                cdata = 0;
-                esc[j++] = str[i++];
-                esc[j++] = str[i++];
-            }
-            esc[j++] = str[i];
-        }
-        else
-        switch (str[i]){
-        case '&':
-            if ((l=snprintf(&esc[j], 6, "&amp;")) < 0){
-                clicon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        case '<':
-            if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                esc[j++] = str[i];
-                cdata++;
-                break;
-            }
-            if ((l=snprintf(&esc[j], 5, "&lt;")) < 0){
-                clicon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        case '>':
-            if ((l=snprintf(&esc[j], 5, "&gt;")) < 0){
-                clicon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        default:
-            esc[j++] = str[i];
-        }
+    if (xml_chardata_cbuf_append(cb, str) < 0)
+        goto done;
+    if ((*escp = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
     }
-    *escp = esc;
     retval = 0;
  done:
     if (str)
         free(str);
-    if (retval < 0 && esc)
-        free(esc);
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
 /*! Escape characters according to XML definition and append to cbuf
  *
+ * Runs of characters that need no encoding, and CDATA sections, are found with strcspn(3)
+ * and strstr(3), which are vectorized in common C libraries, and appended in one copy.
  * @param[in]   cb     CLIgen buf
  * @param[in]   str    Not-encoded input string
  * @retdata     0      OK
@@ -550,48 +477,49 @@ int
 xml_chardata_cbuf_append(cbuf *cb,
                          char *str)
 {
-    int  retval = -1;
-    int  i;
-    int  cdata; /* when set, skip encoding */
+    int    retval = -1;
+    char  *p = str;
+    char  *q;
     size_t len;
 
-    /* The orignal of this code is in xml_chardata_encode */
-    /* Step: encode and expand str --> enc */
-    /* Same code again, but now actually encode into output buffer */
-    cdata = 0;
-
-    len = strlen(str);
-    for (i=0; i<len; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0){
-                cdata = 0;
-                cbuf_append(cb, str[i++]);
-                cbuf_append(cb, str[i++]);
+    while (*p){
+        if ((len = strcspn(p, "&<>")) > 0){
+            if (cbuf_append_buf(cb, p, len) < 0){
+                clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
             }
-            cbuf_append(cb, str[i]);
+            p += len;
         }
-        else
-        switch (str[i]){
+        switch (*p){
         case '&':
             cbuf_append_str(cb, "&amp;");
             break;
         case '<':
-            if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                cbuf_append(cb, str[i]);
-                cdata++;
-                break;
+            if (strncmp(p, "<![CDATA[", strlen("<![CDATA[")) == 0){
+                /* Not encoded until and including "]]>", or end of string */
+                if ((q = strstr(p + strlen("<![CDATA["), "]]>")) != NULL)
+                    len = q + strlen("]]>") - p;
+                else
+                    len = strlen(p);
+                if (cbuf_append_buf(cb, p, len) < 0){
+                    clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                    goto done;
+                }
+                p += len;
+                continue;
             }
             cbuf_append_str(cb, "&lt;");
             break;
         case '>':
             cbuf_append_str(cb, "&gt;");
             break;
-        default:
-            cbuf_append(cb, str[i]);
+        default: /* End of string */
+            continue;
         }
+        p++;
     }
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
@@ -1151,6 +1079,215 @@ clixon_unicode2utf8(char  *ucstr,
     return retval;
 }
 
+/*
+ * String interning
+ * A global table of reference-counted, shared strings (atoms). Equal strings are 
+ * interned to the same pointer, which means that two interned strings are equal if and 
+ * only if their pointers are equal.
+ * The table is global (not per handle) since it is accessed from low-level XML functions
+ */
+
+/* Initial number of buckets of intern table, doubles when load exceeds one */
+#define INTERN_BUCKETS_START 1024
+
+/*! Interned string atom, the string itself is placed directly after the header
+ */
+struct intern_atom{
+    struct intern_atom *ia_next;   /* Next atom in bucket */
+    uint32_t            ia_hash;   /* Full hash value of string */
+    uint32_t            ia_refcnt; /* Number of references */
+    char                ia_str[];  /* Null-terminated string */
+};
+
+static struct intern_atom **_intern_vec = NULL;  /* Hash buckets */
+static size_t               _intern_len = 0;     /* Number of buckets */
+static uint64_t             _intern_nr = 0;      /* Number of atoms */
+static size_t               _intern_size = 0;    /* Memory of atoms */
+
+/* The table is only locked while another thread may intern, such as the datastore prefetch
+ * thread, see clixon_string_intern_lock */
+static pthread_mutex_t      _intern_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int                  _intern_locked = 0;
+
+/*! FNV-1a hash of a string
+ */
+static uint32_t
+intern_hash(const char *str)
+{
+    uint32_t h = 2166136261U;
+
+    while (*str){
+        h ^= (uint8_t)*str++;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*! Double number of buckets and rehash all atoms
+ */
+static int
+intern_grow(void)
+{
+    struct intern_atom **vec;
+    struct intern_atom  *ia;
+    size_t               len;
+    size_t               i;
+    size_t               j;
+
+    len = _intern_len ? 2*_intern_len : INTERN_BUCKETS_START;
+    if ((vec = calloc(len, sizeof(*vec))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return -1;
+    }
+    for (i=0; i<_intern_len; i++){
+        while ((ia = _intern_vec[i]) != NULL){
+            _intern_vec[i] = ia->ia_next;
+            j = ia->ia_hash & (len-1);
+            ia->ia_next = vec[j];
+            vec[j] = ia;
+        }
+    }
+    if (_intern_vec)
+        free(_intern_vec);
+    _intern_vec = vec;
+    _intern_len = len;
+    return 0;
+}
+
+/*! Lock the intern table while more than one thread may intern strings
+ *
+ * Call from the main thread before creating a thread that interns strings, and again with
+ * off after the thread is joined. Calls may be nested.
+ * @param[in]  on    1: lock intern table from now on, 0: undo a previous lock call
+ * @retval     0     OK
+ */
+int
+clixon_string_intern_lock(int on)
+{
+    if (on)
+        _intern_locked++;
+    else if (_intern_locked > 0)
+        _intern_locked--;
+    return 0;
+}
+
+/*! Intern a string, return shared copy
+ *
+ * @param[in]  str   String to intern
+ * @retval     atom  Shared string with the same content as str. Do not modify
+ * @retval     NULL  Error
+ * @code
+ *   char *a;
+ *   if ((a = clixon_string_intern("foo")) == NULL)
+ *      err;
+ *   ...
+ *   clixon_string_unintern(a);
+ * @endcode
+ * @see clixon_string_unintern
+ */
+char *
+clixon_string_intern(const char *str)
+{
+    char               *atom = NULL;
+    uint32_t            h;
+    struct intern_atom *ia;
+    size_t              len;
+    size_t              i;
+    int                 locked;
+
+    if (str == NULL){
+        clicon_err(OE_UNIX, EINVAL, "str is NULL");
+        return NULL;
+    }
+    h = intern_hash(str);
+    if ((locked = _intern_locked) != 0)
+        pthread_mutex_lock(&_intern_mutex);
+    if (_intern_len){
+        for (ia = _intern_vec[h & (_intern_len-1)]; ia; ia = ia->ia_next)
+            if (ia->ia_hash == h && strcmp(ia->ia_str, str) == 0){
+                ia->ia_refcnt++;
+                atom = ia->ia_str;
+                goto done;
+            }
+    }
+    if (_intern_nr >= _intern_len && intern_grow() < 0)
+        goto done;
+    len = strlen(str) + 1;
+    if ((ia = malloc(align4(sizeof(*ia) + len))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    ia->ia_hash = h;
+    ia->ia_refcnt = 1;
+    memcpy(ia->ia_str, str, len);
+    i = h & (_intern_len-1);
+    ia->ia_next = _intern_vec[i];
+    _intern_vec[i] = ia;
+    _intern_nr++;
+    _intern_size += sizeof(*ia) + len;
+    atom = ia->ia_str;
+ done:
+    if (locked)
+        pthread_mutex_unlock(&_intern_mutex);
+    return atom;
+}
+
+/*! Release a reference to an interned string, free it if it is the last reference
+ *
+ * @param[in]  str   String returned by clixon_string_intern
+ * @retval     0     OK
+ * @see clixon_string_intern
+ */
+int
+clixon_string_unintern(char *str)
+{
+    struct intern_atom  *ia;
+    struct intern_atom **iap;
+    int                  locked;
+
+    if (str == NULL)
+        return 0;
+    ia = (struct intern_atom *)(str - offsetof(struct intern_atom, ia_str));
+    if ((locked = _intern_locked) != 0)
+        pthread_mutex_lock(&_intern_mutex);
+    if (--ia->ia_refcnt > 0)
+        goto done;
+    iap = &_intern_vec[ia->ia_hash & (_intern_len-1)];
+    while (*iap != ia)
+        iap = &(*iap)->ia_next;
+    *iap = ia->ia_next;
+    _intern_nr--;
+    _intern_size -= sizeof(*ia) + strlen(ia->ia_str) + 1;
+    free(ia);
+ done:
+    if (locked)
+        pthread_mutex_unlock(&_intern_mutex);
+    return 0;
+}
+
+/*! Get statistics of the string intern table
+ *
+ * @param[out]  nrp  Number of interned strings
+ * @param[out]  szp  Memory of interned strings, excluding hash buckets
+ * @retval      0    OK
+ */
+int
+clixon_string_intern_stats(uint64_t *nrp,
+                           size_t   *szp)
+{
+    int locked;
+
+    if ((locked = _intern_locked) != 0)
+        pthread_mutex_lock(&_intern_mutex);
+    if (nrp)
+        *nrp = _intern_nr;
+    if (szp)
+        *szp = _intern_size + _intern_len*sizeof(struct intern_atom *);
+    if (locked)
+        pthread_mutex_unlock(&_intern_mutex);
+    return 0;
+}
+
 /*! strndup() for systems without it, such as xBSD
  */
 #ifndef HAVE_STRNDUP
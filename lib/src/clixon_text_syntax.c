@@ -77,6 +77,12 @@
 
 #define TEXT_TOP_SYMBOL "top"
 
+/*
+ * Local variables
+ */
+/* Parse TEXT with hand-written scanner instead of lex/yacc parser, see CLICON_TEXT_SCANNER */
+static int _text_parse_scanner = 0;
+
 /*! x is element and has eactly one child which in turn has none 
  *
  * @see child_type in clixon_json.c
@@ -100,170 +106,8 @@ tleaf(cxobj *x)
     return (xml_child_nr_notype(xc, CX_ATTR) == 0);
 }
 
-/*! Translate XML to a "pseudo-code" textual format using a callback - internal function
- *
- * @param[in]     xn       XML object to print
- * @param[in]     fn       Callback to make print function
- * @param[in]     f        File to print to
- * @param[in]     level    Print PRETTYPRINT_INDENT spaces per level in front of each line
- * @param[in]     autocliext How to handle autocli extensions: 0: ignore 1: follow
- * @param[in,out] leafl    Leaflist state for keeping track of when [] ends
- * @param[in,out] leaflname Leaflist state for [] 
- * leaflist state:
- * 0: No leaflist
- * 1: In leaflist
- * @see text2cbuf to buffer (slower)
- */
-static int
-text2file(cxobj            *xn,
-          clicon_output_cb *fn,
-          FILE             *f, 
-          int               level,
-          int               autocliext,
-          int              *leafl,
-          char            **leaflname)
-
-{
-    cxobj     *xc = NULL;
-    int        children=0;
-    int        retval = -1;
-    int        exist = 0;
-    yang_stmt *yn;
-    char      *value;
-    cg_var    *cvi;
-    cvec      *cvk = NULL; /* vector of index keys */
-    cbuf      *cbb = NULL;
-#ifndef TEXT_SYNTAX_NOPREFIX
-    yang_stmt *yp = NULL;
-    yang_stmt *ymod;
-    yang_stmt *ypmod;
-    char      *prefix = NULL;
-#endif
-    if (xn == NULL || fn == NULL){
-        clicon_err(OE_XML, EINVAL, "xn or fn is NULL");
-        goto done;
-    }
-    if ((yn = xml_spec(xn)) != NULL){
-        if (autocliext){
-            if (yang_extension_value(yn, "hide-show", CLIXON_AUTOCLI_NS, &exist, NULL) < 0)
-                goto done;
-            if (exist)
-                goto ok;
-        }
-#ifndef TEXT_SYNTAX_NOPREFIX
-        /* Find out prefix if needed: topmost or new module a la API-PATH */
-        if (ys_real_module(yn, &ymod) < 0)
-            goto done;
-        if ((yp = yang_parent_get(yn)) != NULL &&
-            yp != ymod){
-            if (ys_real_module(yp, &ypmod) < 0)
-                goto done;
-            if (ypmod != ymod)
-                prefix = yang_argument_get(ymod);
-        }
-        else
-            prefix = yang_argument_get(ymod);
-#endif
-        if (yang_keyword_get(yn) == Y_LIST){
-            if ((cvk = yang_cvec_get(yn)) == NULL){
-                clicon_err(OE_YANG, 0, "No keys");
-                goto done;
-            }
-        }
-    }
-    if (*leafl && yn){  
-        if (yang_keyword_get(yn) == Y_LEAF_LIST && strcmp(*leaflname, yang_argument_get(yn)) == 0)
-            ;
-        else{
-            *leafl = 0;
-            *leaflname = NULL;
-            (*fn)(f, "%*s\n", PRETTYPRINT_INDENT*(level), "]");
-        }
-    }
-    xc = NULL;     /* count children (elements and bodies, not attributes) */
-    while ((xc = xml_child_each(xn, xc, -1)) != NULL)
-        if (xml_type(xc) == CX_ELMNT || xml_type(xc) == CX_BODY)
-            children++;
-    if (children == 0){ /* If no children print line */
-        switch (xml_type(xn)){
-        case CX_BODY:{
-            if ((cbb = cbuf_new()) == NULL){
-                clicon_err(OE_UNIX, errno, "cbuf_new");
-                goto done;
-            }
-            value = xml_value(xn);
-            if (index(value, ' ') != NULL)
-                cprintf(cbb, "\"%s\"", value);
-            else
-                cprintf(cbb, "%s", value);
-            if (*leafl)                            /* Skip keyword if leaflist */
-                (*fn)(f, "%*s%s\n", PRETTYPRINT_INDENT*level, "", cbuf_get(cbb));
-            else
-                (*fn)(f, "%s;\n", cbuf_get(cbb));
-            break;
-        }
-        case CX_ELMNT:
-            (*fn)(f, "%*s%s", PRETTYPRINT_INDENT*level, "", xml_name(xn));
-            cvi = NULL;             /* Lists only */
-            while ((cvi = cvec_each(cvk, cvi)) != NULL) {
-                if ((xc = xml_find_type(xn, NULL, cv_string_get(cvi), CX_ELMNT)) != NULL)
-                    (*fn)(f, " %s", xml_body(xc));
-            }
-            (*fn)(f, ";\n");
-            break;
-        default:
-            break;
-        }
-        goto ok;
-    }
-    if (*leafl == 0){
-        (*fn)(f, "%*s", PRETTYPRINT_INDENT*level, "");
-#ifndef TEXT_SYNTAX_NOPREFIX
-        if (prefix)
-            (*fn)(f, "%s:", prefix);
-#endif
-        (*fn)(f, "%s", xml_name(xn));
-    }
-    cvi = NULL;         /* Lists only */
-    while ((cvi = cvec_each(cvk, cvi)) != NULL) {
-        if ((xc = xml_find_type(xn, NULL, cv_string_get(cvi), CX_ELMNT)) != NULL)
-            (*fn)(f, " %s", xml_body(xc));
-    }
-    if (yn && yang_keyword_get(yn) == Y_LEAF_LIST && *leafl){
-        ;
-    }
-    else if (yn && yang_keyword_get(yn) == Y_LEAF_LIST && *leafl == 0){
-        *leafl = 1;
-        *leaflname = yang_argument_get(yn);
-        (*fn)(f, " [\n");
-    }
-    else if (!tleaf(xn))
-        (*fn)(f, " {\n");
-    else
-        (*fn)(f, " ");
-    xc = NULL;
-    while ((xc = xml_child_each(xn, xc, -1)) != NULL){
-        if (xml_type(xc) == CX_ELMNT || xml_type(xc) == CX_BODY){
-            if (yn && yang_key_match(yn, xml_name(xc), NULL))
-                continue; /* Skip keys, already printed */
-            if (text2file(xc, fn, f, level+1, autocliext, leafl, leaflname) < 0)
-                break;
-        }
-    }
-    /* Stop leaf-list printing (ie []) if no longer leaflist and same name */
-    if (yn && yang_keyword_get(yn) != Y_LEAF_LIST && *leafl != 0){
-        *leafl = 0;
-        (*fn)(f, "%*s\n", PRETTYPRINT_INDENT*(level+1), "]");
-    }
-    if (!tleaf(xn))
-        (*fn)(f, "%*s}\n", PRETTYPRINT_INDENT*level, "");
- ok:
-    retval = 0;
- done:
-    if (cbb)
-        cbuf_free(cbb);
-    return retval;
-}
+/* Flush buffered TEXT output to file when this size is exceeded, see clixon_text2file */
+#define TEXT_FLUSH_LEN 65536
 
 #ifndef TEXT_SYNTAX_NOPREFIX
 static char *
@@ -290,29 +134,51 @@ get_prefix(yang_stmt *yn)
 }
 #endif
 
-/*! Translate XML to a "pseudo-code" textual format using a callback - internal function
+/*! Check if name is one of the keys of a list
+ *
+ * As yang_key_match but using the cached key vector of the list
+ * @param[in]  cvk   Key vector of list, or NULL if not list
+ * @param[in]  name  Name of child
+ * @retval     1     Name is a key
+ * @retval     0     Not a key
+ */
+static int
+text_key_match(cvec *cvk,
+               char *name)
+{
+    cg_var *cvi = NULL;
+
+    while ((cvi = cvec_each(cvk, cvi)) != NULL)
+        if (strcmp(cv_string_get(cvi), name) == 0)
+            return 1;
+    return 0;
+}
+
+/*! Translate XML to a "pseudo-code" textual format to a buffer - internal function
  *
+ * @param[in]     cb       Buffer to print to
  * @param[in]     xn       XML object to print
- * @param[in]     fn       Callback to make print function
- * @param[in]     f        File to print to
  * @param[in]     level    Print PRETTYPRINT_INDENT spaces per level in front of each line
  * @param[in]     prefix   Add string to beginning of each line (or NULL)
  * @param[in]     autocliext How to handle autocli extensions: 0: ignore 1: follow
+ * @param[in]     f        If set, flush buffer with fn to file when large, see TEXT_FLUSH_LEN
+ * @param[in]     fn       Callback to make print function (if f)
  * @param[in,out] leafl    Leaflist state for keeping track of when [] ends
  * @param[in,out] leaflname Leaflist state for [] 
  * leaflist state:
  * 0: No leaflist
  * 1: In leaflist
- * @see text2file but to file (faster)
  */
 static int
-text2cbuf(cbuf  *cb,
-          cxobj *xn,
-          int    level,
-          char   *prepend,
-          int    autocliext,
-          int   *leafl,
-          char **leaflname)
+text2cbuf(cbuf             *cb,
+          cxobj            *xn,
+          int               level,
+          char             *prepend,
+          int               autocliext,
+          FILE             *f,
+          clicon_output_cb *fn,
+          int              *leafl,
+          char            **leaflname)
 
 {
     cxobj     *xc = NULL;
@@ -323,9 +189,9 @@ text2cbuf(cbuf  *cb,
     char      *value;
     cg_var    *cvi;
     cvec      *cvk = NULL; /* vector of index keys */
-    cbuf      *cbb = NULL;
     int        level1;
     char      *prefix = NULL;
+    int        leaf;
 
     if (xn == NULL || cb == NULL){
         clicon_err(OE_XML, EINVAL, "xn or cb is NULL");
@@ -362,31 +228,27 @@ text2cbuf(cbuf  *cb,
             cprintf(cb, "%*s\n", level1, "]");
         }
     }
-    xc = NULL;     /* count children (elements and bodies, not attributes) */
+    xc = NULL;     /* any children (elements and bodies, not attributes) */
     while ((xc = xml_child_each(xn, xc, -1)) != NULL)
-        if (xml_type(xc) == CX_ELMNT || xml_type(xc) == CX_BODY)
+        if (xml_type(xc) == CX_ELMNT || xml_type(xc) == CX_BODY){
             children++;
+            break;
+        }
     if (children == 0){ /* If no children print line */
         switch (xml_type(xn)){
-        case CX_BODY:{
-            if ((cbb = cbuf_new()) == NULL){
-                clicon_err(OE_UNIX, errno, "cbuf_new");
-                goto done;
-            }
+        case CX_BODY:
             value = xml_value(xn);
-            if (index(value, ' ') != NULL)
-                cprintf(cbb, "\"%s\"", value);
-            else
-                cprintf(cbb, "%s", value);
             if (*leafl){                            /* Skip keyword if leaflist */
                 if (prepend)
                     cprintf(cb, "%s", prepend);
-                cprintf(cb, "%*s%s\n", level1, "", cbuf_get(cbb));
+                cprintf(cb, "%*s", level1, "");
             }
+            if (index(value, ' ') != NULL)
+                cprintf(cb, "\"%s\"", value);
             else
-                cprintf(cb, "%s;\n", cbuf_get(cbb));
+                cbuf_append_str(cb, value);
+            cbuf_append_str(cb, *leafl?"\n":";\n");
             break;
-        }
         case CX_ELMNT:
             if (prepend)
                 cprintf(cb, "%s", prepend);
@@ -403,13 +265,14 @@ text2cbuf(cbuf  *cb,
         }
         goto ok;
     }
+    leaf = tleaf(xn);
     if (*leafl == 0){
         if (prepend)
             cprintf(cb, "%s", prepend);
         cprintf(cb, "%*s", level1, "");
         if (prefix)
             cprintf(cb, "%s:", prefix);
-        cprintf(cb, "%s", xml_name(xn));
+        cbuf_append_str(cb, xml_name(xn));
     }
     cvi = NULL;         /* Lists only */
     while ((cvi = cvec_each(cvk, cvi)) != NULL) {
@@ -424,17 +287,22 @@ text2cbuf(cbuf  *cb,
         *leaflname = yang_argument_get(yn);
         cprintf(cb, " [\n");
     }
-    else if (!tleaf(xn))
+    else if (!leaf)
         cprintf(cb, " {\n");
     else
         cprintf(cb, " ");
     xc = NULL;
     while ((xc = xml_child_each(xn, xc, -1)) != NULL){
         if (xml_type(xc) == CX_ELMNT || xml_type(xc) == CX_BODY){
-            if (yn && yang_key_match(yn, xml_name(xc), NULL))
+            if (cvk && text_key_match(cvk, xml_name(xc)))
                 continue; /* Skip keys, already printed */
-            if (text2cbuf(cb, xc, level+1, prepend, autocliext, leafl, leaflname) < 0)
+            if (text2cbuf(cb, xc, level+1, prepend, autocliext, f, fn, leafl, leaflname) < 0)
                 break;
+            /* Flush complete lines */
+            if (f && cbuf_len(cb) > TEXT_FLUSH_LEN){
+                (*fn)(f, "%s", cbuf_get(cb));
+                cbuf_reset(cb);
+            }
         }
     }
     /* Stop leaf-list printing (ie []) if no longer leaflist and same name */
@@ -444,7 +312,7 @@ text2cbuf(cbuf  *cb,
             cprintf(cb, "%s", prepend);
         cprintf(cb, "%*s\n", level1 + PRETTYPRINT_INDENT, "]");
     }
-    if (!tleaf(xn)){
+    if (!leaf){
         if (prepend)
             cprintf(cb, "%s", prepend);
         cprintf(cb, "%*s}\n", level1, "");
@@ -452,13 +320,12 @@ text2cbuf(cbuf  *cb,
  ok:
     retval = 0;
  done:
-    if (cbb)
-        cbuf_free(cbb);
     return retval;
 }
 
 /*! Translate XML to a "pseudo-code" textual format using a callback
  *
+ * The output is buffered and written with the callback in large chunks of complete lines
  * @param[in]  f        File to print to
  * @param[in]  xn       XML object to print
  * @param[in]  level    Print PRETTYPRINT_INDENT spaces per level in front of each line
@@ -480,21 +347,35 @@ clixon_text2file(FILE             *f,
     cxobj *xc;
     int    leafl = 0;
     char  *leaflname = NULL;
+    cbuf  *cb = NULL;
 
     if (fn == NULL)
         fn = fprintf;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
     if (skiptop){
         xc = NULL;
-        while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
-            if (text2file(xc, fn, f, level, autocliext, &leafl, &leaflname) < 0)
+        while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL){
+            if (text2cbuf(cb, xc, level, NULL, autocliext, f, fn, &leafl, &leaflname) < 0)
                 goto done;
+            if (cbuf_len(cb) > TEXT_FLUSH_LEN){
+                (*fn)(f, "%s", cbuf_get(cb));
+                cbuf_reset(cb);
+            }
+        }
     }
     else {
-        if (text2file(xn, fn, f, level, autocliext, &leafl, &leaflname) < 0)
+        if (text2cbuf(cb, xn, level, NULL, autocliext, f, fn, &leafl, &leaflname) < 0)
             goto done;
     }
+    if (cbuf_len(cb))
+        (*fn)(f, "%s", cbuf_get(cb));
     retval = 0;
  done:
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
@@ -521,11 +402,11 @@ clixon_text2cbuf(cbuf             *cb,
     if (skiptop){
         xc = NULL;
         while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
-            if (text2cbuf(cb, xc, level, NULL, autocliext, &leafl, &leaflname) < 0)
+            if (text2cbuf(cb, xc, level, NULL, autocliext, NULL, NULL, &leafl, &leaflname) < 0)
                 goto done;
     }
     else {
-        if (text2cbuf(cb, xn, level, NULL, autocliext, &leafl, &leaflname) < 0)
+        if (text2cbuf(cb, xn, level, NULL, autocliext, NULL, NULL, &leafl, &leaflname) < 0)
             goto done;
     }
     retval = 0;
@@ -630,7 +511,7 @@ text_diff2cbuf(cbuf  *cb,
                 cprintf(cb, " {\n");
                 nr++;
             }
-            if (text2cbuf(cb, x1c, level+1, "+", 0, &leafl, &leaflname) < 0)
+            if (text2cbuf(cb, x1c, level+1, "+", 0, NULL, NULL, &leafl, &leaflname) < 0)
                 goto done;
             x1c = xml_child_each(x1, x1c, CX_ELMNT);
             continue;
@@ -645,7 +526,7 @@ text_diff2cbuf(cbuf  *cb,
                 cprintf(cb, "{\n");
                 nr++;
             }
-            if (text2cbuf(cb, x0c, level+1, "-", 0, &leafl, &leaflname) < 0)
+            if (text2cbuf(cb, x0c, level+1, "-", 0, NULL, NULL, &leafl, &leaflname) < 0)
                 goto done;
             x0c = xml_child_each(x0, x0c, CX_ELMNT);
             continue;
@@ -665,7 +546,7 @@ text_diff2cbuf(cbuf  *cb,
                 cprintf(cb, " {\n");
                 nr++;
             }
-            if (text2cbuf(cb, x0c, level+1, "-", 0, &leafl, &leaflname) < 0)
+            if (text2cbuf(cb, x0c, level+1, "-", 0, NULL, NULL, &leafl, &leaflname) < 0)
                 goto done;
             x0c = xml_child_each(x0, x0c, CX_ELMNT);
             continue;
@@ -680,7 +561,7 @@ text_diff2cbuf(cbuf  *cb,
                 cprintf(cb, " {\n");
                 nr++;
             }
-            if (text2cbuf(cb, x1c, level+1, "+", 0, &leafl, &leaflname) < 0)
+            if (text2cbuf(cb, x1c, level+1, "+", 0, NULL, NULL, &leafl, &leaflname) < 0)
                 goto done;
             x1c = xml_child_each(x1, x1c, CX_ELMNT);
             continue;
@@ -694,9 +575,9 @@ text_diff2cbuf(cbuf  *cb,
                     cprintf(cb, "%s {\n", xml_name(x0));
                     nr++;
                 }
-                if (text2cbuf(cb, x0c, level+1, "-", 0, &leafl, &leaflname) < 0)
+                if (text2cbuf(cb, x0c, level+1, "-", 0, NULL, NULL, &leafl, &leaflname) < 0)
                     goto done;
-                if (text2cbuf(cb, x1c, level+1, "+", 0, &leafl, &leaflname) < 0)
+                if (text2cbuf(cb, x1c, level+1, "+", 0, NULL, NULL, &leafl, &leaflname) < 0)
                     goto done;
             }
             else if (yc0 && yang_keyword_get(yc0) == Y_LEAF){
@@ -803,10 +684,8 @@ text_populate_list(cxobj *xn)
             xml_spec_set(xc, yc);
             if ((xml_addsub(xc, xb)) < 0)
                 goto done;
-
         }
-        if (xml_sort(xn) < 0)
-            goto done;
+        /* Keys are sorted by the sort after parsing */
     }
     xc = NULL;
     while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL) {    
@@ -819,6 +698,18 @@ text_populate_list(cxobj *xn)
     return retval;
 }
 
+/*! Kludge to select TEXT parser, see CLICON_TEXT_SCANNER
+ *
+ * The problem with this is that its global and should be bound to a handle
+ * @param[in]  val  0: lex/yacc parser, 1: hand-written scanner, see clixon_text_syntax_scan()
+ */
+int
+clixon_text_syntax_parse_scanner(int val)
+{
+    _text_parse_scanner = val;
+    return 0;
+}
+
 /*! Parse a string containing text syntax and return an XML tree
  *
  * @param[in]  str    Input string containing JSON
@@ -857,15 +748,34 @@ _text_syntax_parse(char      *str,
     ts.ts_linenum = 1;
     ts.ts_xtop = xt;
     ts.ts_yspec = yspec;
-    if (clixon_text_syntax_parsel_init(&ts) < 0)
-        goto done;
-    if (clixon_text_syntax_parseparse(&ts) != 0) { /* yacc returns 1 on error */
-        clicon_log(LOG_NOTICE, "TEXT SYNTAX error: line %d", ts.ts_linenum);
-        if (clicon_errno == 0)
-            clicon_err(OE_JSON, 0, "TEXT SYNTAX parser error with no error code (should not happen)");
+    if (_text_parse_scanner){
+        /* Bind and sort while scanning, if the new nodes are the only children */
+        if (xml_child_nr_type(xt, CX_ELMNT) == 0)
+            ts.ts_bind = yb;
+        if (clixon_text_syntax_scan(&ts) < 0){
+            clicon_log(LOG_NOTICE, "TEXT SYNTAX error: line %d", ts.ts_linenum);
+            goto done;
+        }
+    }
+    else {
+        if (clixon_text_syntax_parsel_init(&ts) < 0)
+            goto done;
+        if (clixon_text_syntax_parseparse(&ts) != 0) { /* yacc returns 1 on error */
+            clicon_log(LOG_NOTICE, "TEXT SYNTAX error: line %d", ts.ts_linenum);
+            if (clicon_errno == 0)
+                clicon_err(OE_JSON, 0, "TEXT SYNTAX parser error with no error code (should not happen)");
+            goto done;
+        }
+    }
+    if (ts.ts_bound){ /* Bound and sorted by scanner, only top is not sorted */
+        if (xml_sort_verify(xt, NULL) == -1 &&
+            xml_sort(xt) < 0)
+            goto done;
+        if (xml_cv_cache_clear(xt) < 0)
+            goto done;
+        retval = 1;
         goto done;
     }
-
     x = NULL;
     while ((x = xml_child_each(ts.ts_xtop, x, CX_ELMNT)) != NULL) {
         /* Populate, ie associate xml nodes with yang specs 
@@ -908,7 +818,8 @@ _text_syntax_parse(char      *str,
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
     if (cberr)
         cbuf_free(cberr);
-    clixon_text_syntax_parsel_exit(&ts);
+    if (ts.ts_lexbuf)
+        clixon_text_syntax_parsel_exit(&ts);
     return retval; 
  fail: /* invalid */
     retval = 0;
@@ -942,6 +853,9 @@ clixon_text_syntax_parse_string(char      *str,
                                 cxobj    **xt,
                                 cxobj    **xerr)
 {
+    int   retval;
+    char *str1;
+
     clicon_debug(1, "%s", __FUNCTION__);
     if (xt==NULL){
         clicon_err(OE_XML, EINVAL, "xt is NULL");
@@ -951,7 +865,16 @@ clixon_text_syntax_parse_string(char      *str,
         if ((*xt = xml_new("top", NULL, CX_ELMNT)) == NULL)
             return -1;
     }
-    return _text_syntax_parse(str, yb, yspec, *xt, xerr);
+    if (!_text_parse_scanner)
+        return _text_syntax_parse(str, yb, yspec, *xt, xerr);
+    /* The scanner modifies the string while scanning */
+    if ((str1 = strdup(str)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        return -1;
+    }
+    retval = _text_syntax_parse(str1, yb, yspec, *xt, xerr);
+    free(str1);
+    return retval;
 }
 
 /*! Read a TEXT syntax definition from file and parse it into a parse-tree. 
@@ -994,11 +917,9 @@ clixon_text_syntax_parse_file(FILE      *fp,
     int       retval = -1;
     int       ret;
     char     *textbuf = NULL;
-    int       textbuflen = BUFLEN; /* start size */
-    int       oldtextbuflen;
-    char     *ptr;
-    char      ch;
-    int       len = 0;
+    size_t    textbuflen = BUFLEN; /* start size */
+    size_t    len = 0;
+    size_t    n;
 
     if (xt == NULL){
         clicon_err(OE_XML, EINVAL, "xt is NULL");
@@ -1008,38 +929,31 @@ clixon_text_syntax_parse_file(FILE      *fp,
         clicon_err(OE_XML, errno, "malloc");
         goto done;
     }
-    memset(textbuf, 0, textbuflen);
-    ptr = textbuf;
-    while (1){
-        if ((ret = fread(&ch, 1, 1, fp)) < 0){
-            clicon_err(OE_XML, errno, "read");
-            break;
-        }
-        if (ret != 0)
-            textbuf[len++] = ch;
-        if (ret == 0){
-            if (*xt == NULL)
-                if ((*xt = xml_new(TEXT_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
-                    goto done;
-            if (len){
-                if ((ret = _text_syntax_parse(ptr, yb, yspec, *xt, xerr)) < 0)
-                    goto done;
-                if (ret == 0)
-                    goto fail;
-            }
-            break;
-        }
-        if (len >= textbuflen-1){ /* Space: one for the null character */
-            oldtextbuflen = textbuflen;
+    /* Read file in chunks, one byte for the null character */
+    while ((n = fread(textbuf+len, 1, textbuflen-len-1, fp)) > 0){
+        len += n;
+        if (len >= textbuflen-1){
             textbuflen *= 2;
             if ((textbuf = realloc(textbuf, textbuflen)) == NULL){
                 clicon_err(OE_XML, errno, "realloc");
                 goto done;
             }
-            memset(textbuf+oldtextbuflen, 0, textbuflen-oldtextbuflen);
-            ptr = textbuf;
         }
     }
+    if (ferror(fp)){
+        clicon_err(OE_XML, errno, "read");
+        goto done;
+    }
+    textbuf[len] = '\0';
+    if (*xt == NULL)
+        if ((*xt = xml_new(TEXT_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+    if (len){
+        if ((ret = _text_syntax_parse(textbuf, yb, yspec, *xt, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
     retval = 1;
  done:
     if (retval < 0 && *xt){
@@ -48,6 +48,8 @@ struct clixon_text_syntax_parse_yacc {
     int        ts_xlen;         /* Length of ts_xvec */
     int        ts_lex_state;    /* lex return state */
     yang_stmt *ts_yspec;        /* Yang spec */
+    yang_bind  ts_bind;         /* If set, bind yang while parsing (scanner only) */
+    int        ts_bound;        /* Set by scanner if all new nodes are bound and sorted */
 };
 typedef struct clixon_text_syntax_parse_yacc clixon_text_syntax_yacc;
 
@@ -66,4 +68,6 @@ int clixon_text_syntax_parsel_linenr(void);
 int clixon_text_syntax_parselex(void *);
 int clixon_text_syntax_parseparse(void *);
 
+int clixon_text_syntax_scan(clixon_text_syntax_yacc *ts);
+
 #endif  /* _CLIXON_TEXT_SYNTAX_PARSE_H_ */
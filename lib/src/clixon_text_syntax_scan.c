@@ -0,0 +1,576 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+ *
+ * Hand-written TEXT (curly-brace) scanner, alternative to the lex/yacc parser of
+ * clixon_text_syntax_parse.[ly]
+ * Selected at runtime with CLICON_TEXT_SCANNER, see clixon_text_syntax_parse_scanner()
+ *
+ * The scanner builds the same tree as the lex/yacc parser:
+ * - "id v1 v2;" creates one element per value, with the value as body marked as key
+ * - "id v1 v2 { stmts }" creates one element with the values as bodies marked as key
+ * - "id [ v1 v2 ]" creates one element per value (leaf-list)
+ * - A value is a token or a "quoted string" without escapes, "#" starts a comment
+ * Tokens are scanned in runs with strcspn(3) and set in place in the input string.
+ * In addition, if ts_bind is set, elements are bound to YANG when created since the parser
+ * is top-down and the yang of the parent is known. Key bodies of lists are translated to
+ * key leafs, and children are verified as sorted or sorted, when the element is complete.
+ * Elements that are not bound as by xml_bind_yang stop binding, and the caller binds and
+ * sorts the tree after parsing as for the lex/yacc parser.
+ * @see text_populate_list
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_bind.h"
+#include "clixon_text_syntax_parse.h"
+
+/* Max nesting of statements */
+#define TEXT_SCAN_DEPTH_MAX 10000
+
+/* Number of values of a statement without allocation */
+#define TEXT_SCAN_VALUES 8
+
+/* Characters ending a token, see TOKEN in clixon_text_syntax_parse.l */
+#define TEXT_SCAN_DELIM "\n\r \t[]{};\""
+
+/*! TEXT scanner state
+ */
+struct text_scan {
+    clixon_text_syntax_yacc *tx_ts;
+    char                    *tx_str;    /* Start of parse string, for line numbers */
+    char                    *tx_p;      /* Current position */
+    int                      tx_bind;   /* Bind yang while parsing, cleared if not possible */
+    char                    *tx_prefix; /* Module name of last namespace lookup */
+    char                    *tx_ns;     /* Namespace of last lookup */
+};
+
+/*! Value of a statement, a token or the inside of a quoted string, in the input string */
+struct text_value {
+    char   *tv_str;
+    size_t  tv_len;
+};
+
+#define tscan_space(c) ((c)==' ' || (c)=='\t' || (c)=='\n' || (c)=='\r')
+#define tscan_delim(c) ((c)=='\0' || strchr(TEXT_SCAN_DELIM, (c)) != NULL)
+
+/*! Report scanner syntax error, with line number as the lex/yacc parser
+ */
+static int
+tscan_error(struct text_scan *tx,
+            char             *reason)
+{
+    char *s;
+
+    tx->tx_ts->ts_linenum = 1;
+    for (s = tx->tx_str; s < tx->tx_p; s++)
+        if (*s == '\n')
+            tx->tx_ts->ts_linenum++;
+    clicon_err(OE_XML, XMLPARSE_ERRNO, "text_syntax_parse: line %d: %s: at or before: '%.16s'",
+               tx->tx_ts->ts_linenum, reason, tx->tx_p);
+    return -1;
+}
+
+/*! Skip whitespace and comments between tokens
+ *
+ * As the lex rules, "#" starts a comment if it is not the start of a longer token
+ */
+static void
+tscan_skip(struct text_scan *tx)
+{
+    char *p = tx->tx_p;
+
+    for (;;){
+        while (tscan_space(*p))
+            p++;
+        if (*p != '#' || !tscan_delim(p[1]))
+            break;
+        if ((p = strchr(p, '\n')) == NULL){
+            p = tx->tx_p + strlen(tx->tx_p);
+            break;
+        }
+    }
+    tx->tx_p = p;
+}
+
+/*! Scan one value: token or quoted string
+ *
+ * @param[in]  tx    Scanner
+ * @param[out] tv    Value in input string
+ * @retval     1     Value found
+ * @retval     0     No value at this position
+ * @retval    -1     Error
+ */
+static int
+tscan_value(struct text_scan  *tx,
+            struct text_value *tv)
+{
+    char *p = tx->tx_p;
+    char *q;
+
+    if (*p == '"'){
+        if ((q = strchr(p+1, '"')) == NULL)
+            return tscan_error(tx, "syntax error");
+        if (q == p+1){ /* As the lex/yacc parser, whose body value is then NULL */
+            clicon_err(OE_XML, EINVAL, "value is NULL");
+            return -1;
+        }
+        tv->tv_str = p+1;
+        tv->tv_len = q-p-1;
+        tx->tx_p = q+1;
+        return 1;
+    }
+    if (tscan_delim(*p))
+        return 0;
+    tv->tv_str = p;
+    tv->tv_len = strcspn(p, TEXT_SCAN_DELIM);
+    tx->tx_p = p + tv->tv_len;
+    return 1;
+}
+
+/*! Add value as body to element, the value is terminated in place in the input string
+ *
+ * @param[in]  x     Element
+ * @param[in]  tv    Value
+ * @param[in]  key   Mark body as key, see text_mark_bodies
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+tscan_body(cxobj             *x,
+           struct text_value *tv,
+           int                key)
+{
+    cxobj *xb;
+    char   c;
+    int    ret;
+
+    if ((xb = xml_new("body", x, CX_BODY)) == NULL)
+        return -1;
+    c = tv->tv_str[tv->tv_len];
+    tv->tv_str[tv->tv_len] = '\0';
+    ret = xml_value_set(xb, tv->tv_str);
+    tv->tv_str[tv->tv_len] = c;
+    if (ret < 0)
+        return -1;
+    if (key)
+        xml_flag_set(xb, XML_FLAG_BODYKEY);
+    return 0;
+}
+
+/*! Lookup namespace of module name prefix, caching the last lookup
+ *
+ * As text_create_node, an unknown module is silently ignored
+ * @param[in]  tx     Scanner
+ * @param[in]  prefix Module name
+ * @param[out] ns     Namespace or NULL
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+tscan_namespace(struct text_scan *tx,
+                char             *prefix,
+                char            **ns)
+{
+    yang_stmt *ymod;
+
+    *ns = NULL;
+    if (tx->tx_prefix && strcmp(tx->tx_prefix, prefix) == 0){
+        *ns = tx->tx_ns;
+        return 0;
+    }
+    if (tx->tx_ts->ts_yspec == NULL ||
+        (ymod = yang_find(tx->tx_ts->ts_yspec, Y_MODULE, prefix)) == NULL)
+        return 0;
+    if ((*ns = yang_find_mynamespace(ymod)) == NULL){
+        clicon_err(OE_YANG, 0, "No namespace");
+        return -1;
+    }
+    if (tx->tx_prefix)
+        free(tx->tx_prefix);
+    if ((tx->tx_prefix = strdup(prefix)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        return -1;
+    }
+    tx->tx_ns = *ns;
+    return 0;
+}
+
+/*! Bind element to yang when created, as xml_bind_yang0 without handle
+ *
+ * Children of the top node are bound as top-level symbols or from the yang of the top node
+ * depending on bind mode, other elements from the yang of their parent.
+ * If the element is not bound as in xml_bind_yang0, binding while parsing is stopped.
+ * @param[in]  tx   Scanner
+ * @param[in]  x    Element with namespace attribute, if any
+ * @retval     0    OK, possibly binding stopped
+ * @retval    -1    Error
+ * @see scan_bind  for the same in the XML scanner
+ */
+static int
+tscan_bind(struct text_scan *tx,
+           cxobj            *x)
+{
+    clixon_text_syntax_yacc *ts = tx->tx_ts;
+    cxobj                   *xp = xml_parent(x);
+    cxobj                   *xprev;
+    yang_stmt               *yp;
+    yang_stmt               *y = NULL;
+    yang_stmt               *ymod = NULL;
+    char                    *name = xml_name(x);
+    char                    *ns = NULL;
+    char                    *nsy;
+    int                      nr;
+
+    /* As xml_bind_yang0_opt: same yang as previous sibling with same name */
+    if ((nr = xml_child_nr(xp)) > 1 &&
+        (xprev = xml_child_i(xp, nr-2)) != NULL &&
+        xml_type(xprev) == CX_ELMNT &&
+        (y = xml_spec(xprev)) != NULL &&
+        strcmp(xml_name(xprev), name) == 0 &&
+        xml_child_nr_type(xprev, CX_ATTR) == 0 &&
+        xml_child_nr_type(x, CX_ATTR) == 0){
+        xml_spec_set(x, y);
+        xml_nsid_set(x, xml_nsid(xprev));
+        return 0;
+    }
+    y = NULL;
+    if (xp == ts->ts_xtop && ts->ts_bind == YB_MODULE_NEXT)
+        return 0; /* Not bound, its children are top-level symbols */
+    if (xp == ts->ts_xtop ||
+        (ts->ts_bind == YB_MODULE_NEXT && xml_parent(xp) == ts->ts_xtop)){
+        if (ts->ts_yspec == NULL)
+            goto stop;
+        if (ys_module_by_xml(ts->ts_yspec, x, &ymod) < 0)
+            return -1;
+        if (ymod == NULL || (y = yang_find_schemanode(ymod, name)) == NULL)
+            goto stop;
+    }
+    else {
+        if ((yp = xml_spec(xp)) == NULL ||
+            yang_keyword_get(yp) == Y_ANYXML || yang_keyword_get(yp) == Y_ANYDATA ||
+            yang_find(yp, Y_ACTION, name) != NULL ||
+            (y = yang_find_datanode(yp, name)) == NULL)
+            goto stop;
+    }
+    if (xml2ns(x, NULL, &ns) < 0)
+        return -1;
+    if ((nsy = yang_find_mynamespace(y)) == NULL || ns == NULL || strcmp(ns, nsy) != 0)
+        goto stop;
+    /* Search index is updated by the bind after parsing */
+    if (yang_flag_get(y, YANG_FLAG_INDEX) != 0)
+        goto stop;
+    xml_spec_set(x, y);
+    xml_nsid_set(x, yang_nsid_get(y));
+    return 0;
+ stop:
+    tx->tx_bind = 0;
+    return 0;
+}
+
+/*! Create element of a statement, bind it if binding while parsing
+ *
+ * @param[in]  tx    Scanner
+ * @param[in]  xp    Parent
+ * @param[in]  id    Statement identifier [<module>:]<name> in input string
+ * @param[out] xn    Created element
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see text_create_node
+ */
+static int
+tscan_node(struct text_scan  *tx,
+           cxobj             *xp,
+           struct text_value *id,
+           cxobj            **xn)
+{
+    cxobj *x = NULL;
+    char  *name;
+    char  *s;
+    char  *ns = NULL;
+    char   c;
+
+    c = id->tv_str[id->tv_len];
+    id->tv_str[id->tv_len] = '\0';
+    if ((s = strchr(id->tv_str, ':')) != NULL){
+        *s = '\0';
+        name = s+1;
+        if (tscan_namespace(tx, id->tv_str, &ns) < 0)
+            goto done;
+    }
+    else
+        name = id->tv_str;
+    if ((x = xml_new(name, xp, CX_ELMNT)) == NULL)
+        goto done;
+    /* Set default namespace */
+    if (ns && xmlns_set(x, NULL, ns) < 0){
+        x = NULL;
+        goto done;
+    }
+    if (tx->tx_bind && tscan_bind(tx, x) < 0)
+        x = NULL;
+ done:
+    if (s)
+        *s = ':';
+    id->tv_str[id->tv_len] = c;
+    *xn = x;
+    return x?0:-1;
+}
+
+/*! Element is complete, translate key bodies and sort children as the bind and populate passes
+ *
+ * @param[in]  x    Element
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see text_populate_list
+ * @see scan_bind_close  for the same in the XML scanner
+ */
+static int
+tscan_close(cxobj *x)
+{
+    yang_stmt    *y;
+    enum rfc_6020 keyword;
+    cxobj        *xb;
+    cxobj        *xc;
+    cvec         *cvk;
+    cg_var       *cvi = NULL;
+    char         *namei;
+    int           ret;
+
+    if ((y = xml_spec(x)) != NULL){
+        keyword = yang_keyword_get(y);
+        if (keyword == Y_LIST || keyword == Y_CONTAINER){
+            /* As strip_body_objects: quits at marked body */
+            while ((xb = xml_find_type(x, NULL, "body", CX_BODY)) != NULL &&
+                   !xml_flag(xb, XML_FLAG_BODYKEY))
+                xml_purge(xb);
+        }
+        else if ((keyword == Y_LEAF || keyword == Y_LEAF_LIST) &&
+                 xml_bind_value(x) < 0)
+            return -1;
+        if (keyword == Y_LIST){
+            cvk = yang_cvec_get(y);
+            while ((xb = xml_find_type(x, NULL, "body", CX_BODY)) != NULL &&
+                   xml_flag(xb, XML_FLAG_BODYKEY)){
+                xml_flag_reset(xb, XML_FLAG_BODYKEY);
+                if ((cvi = cvec_next(cvk, cvi)) == NULL){
+                    clicon_err(OE_XML, 0, "text parser, key and body mismatch");
+                    return -1;
+                }
+                namei = cv_string_get(cvi);
+                if ((xc = xml_new(namei, x, CX_ELMNT)) == NULL)
+                    return -1;
+                xml_spec_set(xc, yang_find(y, Y_LEAF, namei));
+                if (xml_addsub(xc, xb) < 0)
+                    return -1;
+                if (xml_bind_value(xc) < 0)
+                    return -1;
+            }
+        }
+    }
+    if ((ret = xml_sort_verify(x, NULL)) == 1) /* Not sortable */
+        return 0;
+    if (ret == -1 && xml_sort(x) < 0)
+        return -1;
+    if (xml_cv_cache_clear(x) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Scan one statement and add its elements to parent
+ *
+ * @param[in]  tx     Scanner
+ * @param[in]  xp     Parent
+ * @param[in]  depth  Nesting depth
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see stmt in clixon_text_syntax_parse.y
+ */
+static int
+tscan_stmt(struct text_scan *tx,
+           cxobj            *xp,
+           int               depth)
+{
+    int                retval = -1;
+    struct text_value  id;
+    struct text_value  values0[TEXT_SCAN_VALUES];
+    struct text_value *values = values0;
+    struct text_value *v;
+    int                nvalues = 0;
+    int                maxvalues = TEXT_SCAN_VALUES;
+    cxobj             *x;
+    int                i;
+    int                ret;
+    int                list = 0;
+
+    if (depth > TEXT_SCAN_DEPTH_MAX){
+        tscan_error(tx, "too deep nesting");
+        goto done;
+    }
+    if (*tx->tx_p == '"' || tscan_value(tx, &id) != 1){
+        tscan_error(tx, "syntax error");
+        goto done;
+    }
+    tscan_skip(tx);
+    if (*tx->tx_p == '['){ /* id [ values ] */
+        tx->tx_p++;
+        list++;
+    }
+    for (;;){ /* values */
+        tscan_skip(tx);
+        if (nvalues == maxvalues){
+            maxvalues *= 2;
+            if (values == values0){
+                if ((v = malloc(maxvalues*sizeof(*v))) != NULL)
+                    memcpy(v, values0, sizeof(values0));
+            }
+            else
+                v = realloc(values, maxvalues*sizeof(*v));
+            if (v == NULL){
+                clicon_err(OE_UNIX, errno, "malloc");
+                goto done;
+            }
+            values = v;
+        }
+        if ((ret = tscan_value(tx, &values[nvalues])) < 0)
+            goto done;
+        if (ret == 0)
+            break;
+        nvalues++;
+    }
+    switch (*tx->tx_p){
+    case ']': /* id [ values ] */
+    case ';': /* id values ; */
+        if ((*tx->tx_p == ']') != list)
+            goto syntax;
+        tx->tx_p++;
+        for (i=0; i<nvalues; i++){
+            if (tscan_node(tx, xp, &id, &x) < 0)
+                goto done;
+            if (tscan_body(x, &values[i], !list) < 0)
+                goto done;
+            if (tx->tx_bind && tscan_close(x) < 0)
+                goto done;
+        }
+        break;
+    case '{':
+        if (list)
+            goto syntax;
+        tx->tx_p++;
+        if (tscan_node(tx, xp, &id, &x) < 0)
+            goto done;
+        for (i=0; i<nvalues; i++)
+            if (tscan_body(x, &values[i], 1) < 0)
+                goto done;
+        for (;;){
+            tscan_skip(tx);
+            if (*tx->tx_p == '}')
+                break;
+            if (*tx->tx_p == '\0')
+                goto syntax;
+            if (tscan_stmt(tx, x, depth+1) < 0)
+                goto done;
+        }
+        tx->tx_p++;
+        if (tx->tx_bind && tscan_close(x) < 0)
+            goto done;
+        break;
+    default:
+        goto syntax;
+    }
+    retval = 0;
+ done:
+    if (values != values0)
+        free(values);
+    return retval;
+ syntax:
+    tscan_error(tx, "syntax error");
+    goto done;
+}
+
+/*! Scan TEXT string into the top element of a parser struct
+ *
+ * Same interface as the lex/yacc parser: the input is one statement whose elements are
+ * added to ts_xtop
+ * @param[in]  ts   TEXT parser struct. ts_parse_string is modified during scanning
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon_text_syntax_parseparse
+ */
+int
+clixon_text_syntax_scan(clixon_text_syntax_yacc *ts)
+{
+    int              retval = -1;
+    struct text_scan tx = {0,};
+
+    tx.tx_ts = ts;
+    tx.tx_str = tx.tx_p = ts->ts_parse_string;
+    tx.tx_bind = (ts->ts_bind != YB_NONE);
+    tscan_skip(&tx);
+    if (tscan_stmt(&tx, ts->ts_xtop, 0) < 0)
+        goto done;
+    tscan_skip(&tx);
+    if (*tx.tx_p != '\0'){
+        tscan_error(&tx, "syntax error");
+        goto done;
+    }
+    ts->ts_bound = tx.tx_bind;
+    retval = 0;
+ done:
+    if (tx.tx_prefix)
+        free(tx.tx_prefix);
+    return retval;
+}
@@ -48,9 +48,11 @@
 #include <string.h>
 #include <syslog.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <arpa/inet.h>
 #include <sys/param.h>
 #include <netinet/in.h>
+#include <sys/wait.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -78,11 +80,238 @@
 #include "clixon_yang_schema_mount.h"
 #include "clixon_xml_default.h"
 #include "clixon_xml_map.h"
+#include "clixon_xml_sort.h"
 #include "clixon_xml_bind.h"
 #include "clixon_validate_minmax.h"
 #include "clixon_validate.h"
+#include "clixon_event.h"
+
+/*! Index of leafref target values, built once per validation
+ *
+ * A leafref path evaluated in a context node gives a set of target values. The set is
+ * built the first time the path is evaluated in the context, and leafrefs are then looked
+ * up in the index instead of evaluating the path and scanning its result for each of them.
+ * Only paths that select the same nodes for all leafrefs with the same context are indexed:
+ * absolute paths, where the context is the root, and paths of "../" steps followed by child
+ * steps only, where the context is the ancestor. Other paths, eg with current() or deref(),
+ * are evaluated for each leafref.
+ * The index is valid as long as the tree is not modified, it is created by the validate
+ * functions and freed when they return.
+ */
+struct leafref_entry {
+    struct leafref_entry *le_next;
+    uint32_t              le_hash;
+    yang_stmt            *le_ypath; /* Path statement */
+    yang_stmt            *le_ys;    /* Leaf, gives namespace context of path */
+    cxobj                *le_ctx;   /* Context node */
+    char                 *le_body;  /* Target value, or NULL if entry marks a built set */
+};
+
+struct leafref_index {
+    struct leafref_entry **li_vec;  /* Hash buckets */
+    size_t                 li_len;  /* Number of buckets, power of 2 */
+    size_t                 li_nr;   /* Number of entries */
+};
+
+/* Initial number of buckets of leafref index, power of 2 */
+#define LEAFREF_INDEX_START 1024
+
+/* Handle data name of leafref index of ongoing validation */
+#define LEAFREF_INDEX_NAME "leafref-index"
+
+/*! Hash of leafref path, context and value (FNV-1a)
+ */
+static uint32_t
+leafref_hash(yang_stmt *ypath,
+             yang_stmt *ys,
+             cxobj     *ctx,
+             char      *body)
+{
+    uint32_t  h = 2166136261U;
+    uintptr_t p[3];
+    uint8_t  *s;
+    size_t    i;
+
+    p[0] = (uintptr_t)ypath;
+    p[1] = (uintptr_t)ys;
+    p[2] = (uintptr_t)ctx;
+    s = (uint8_t *)p;
+    for (i=0; i<sizeof(p); i++){
+        h ^= s[i];
+        h *= 16777619U;
+    }
+    if (body)
+        for (s = (uint8_t *)body; *s; s++){
+            h ^= *s;
+            h *= 16777619U;
+        }
+    return h;
+}
+
+/*! Look up value, or built set if body is NULL, in leafref index
+ *
+ * @retval  1  Found
+ * @retval  0  Not found
+ */
+static int
+leafref_index_find(struct leafref_index *li,
+                   yang_stmt            *ypath,
+                   yang_stmt            *ys,
+                   cxobj                *ctx,
+                   char                 *body)
+{
+    struct leafref_entry *le;
+    uint32_t              h;
+
+    h = leafref_hash(ypath, ys, ctx, body);
+    for (le = li->li_vec[h & (li->li_len-1)]; le; le = le->le_next)
+        if (le->le_hash == h &&
+            le->le_ypath == ypath && le->le_ys == ys && le->le_ctx == ctx &&
+            (body == NULL ? le->le_body == NULL :
+             (le->le_body != NULL && strcmp(le->le_body, body) == 0)))
+            return 1;
+    return 0;
+}
+
+/*! Add value, or built set mark if body is NULL, to leafref index
+ *
+ * @param[in]  body  Target value, not copied: points into the validated tree
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+leafref_index_add(struct leafref_index *li,
+                  yang_stmt            *ypath,
+                  yang_stmt            *ys,
+                  cxobj                *ctx,
+                  char                 *body)
+{
+    struct leafref_entry **vec;
+    struct leafref_entry  *le;
+    size_t                 len;
+    size_t                 i;
+
+    if (li->li_nr >= li->li_len){
+        len = 2*li->li_len;
+        if ((vec = calloc(len, sizeof(*vec))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        for (i=0; i<li->li_len; i++)
+            while ((le = li->li_vec[i]) != NULL){
+                li->li_vec[i] = le->le_next;
+                le->le_next = vec[le->le_hash & (len-1)];
+                vec[le->le_hash & (len-1)] = le;
+            }
+        free(li->li_vec);
+        li->li_vec = vec;
+        li->li_len = len;
+    }
+    if ((le = malloc(sizeof(*le))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    le->le_hash = leafref_hash(ypath, ys, ctx, body);
+    le->le_ypath = ypath;
+    le->le_ys = ys;
+    le->le_ctx = ctx;
+    le->le_body = body;
+    i = le->le_hash & (li->li_len-1);
+    le->le_next = li->li_vec[i];
+    li->li_vec[i] = le;
+    li->li_nr++;
+    return 0;
+}
+
+/*! Create leafref index for a validation, unless one exists
+ *
+ * @param[in]  h        Clixon handle
+ * @param[out] created  Set if created, then free with leafref_index_end
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+leafref_index_begin(clicon_handle h,
+                    int          *created)
+{
+    struct leafref_index *li = NULL;
+
+    *created = 0;
+    if (clicon_ptr_get(h, LEAFREF_INDEX_NAME, (void**)&li) == 0 && li != NULL)
+        return 0;
+    if ((li = calloc(1, sizeof(*li))) == NULL ||
+        (li->li_vec = calloc(LEAFREF_INDEX_START, sizeof(*li->li_vec))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        if (li)
+            free(li);
+        return -1;
+    }
+    li->li_len = LEAFREF_INDEX_START;
+    if (clicon_ptr_set(h, LEAFREF_INDEX_NAME, li) < 0){
+        free(li->li_vec);
+        free(li);
+        return -1;
+    }
+    *created = 1;
+    return 0;
+}
+
+/*! Free leafref index created by leafref_index_begin
+ *
+ * @param[in]  h   Clixon handle
+ */
+static void
+leafref_index_end(clicon_handle h)
+{
+    struct leafref_index *li = NULL;
+    struct leafref_entry *le;
+    size_t                i;
+
+    if (clicon_ptr_get(h, LEAFREF_INDEX_NAME, (void**)&li) < 0 || li == NULL)
+        return;
+    clicon_ptr_del(h, LEAFREF_INDEX_NAME);
+    for (i=0; i<li->li_len; i++)
+        while ((le = li->li_vec[i]) != NULL){
+            li->li_vec[i] = le->le_next;
+            free(le);
+        }
+    free(li->li_vec);
+    free(li);
+}
+
+/*! Get context node of leafref path if its node-set is the same for all leafrefs of the context
+ *
+ * @param[in]  xt        XML leafref node
+ * @param[in]  path_arg  Leafref path
+ * @retval     ctx       Root for absolute path, or ancestor for leading "../" steps
+ * @retval     NULL      Path is not indexed
+ */
+static cxobj *
+leafref_context(cxobj *xt,
+                char  *path_arg)
+{
+    cxobj *ctx = xt;
+    char  *p = path_arg;
+
+    if (*p == '/')
+        ctx = xml_root(xt);
+    else
+        while (strncmp(p, "../", 3) == 0){
+            if ((ctx = xml_parent(ctx)) == NULL)
+                return NULL;
+            p += 3;
+        }
+    if (p == path_arg && *p != '/')
+        return NULL;
+    if (strstr(p, "..") != NULL ||
+        strstr(p, "current") != NULL ||
+        strstr(p, "deref") != NULL)
+        return NULL;
+    return ctx;
+}
 
 /*! Validate xml node of type leafref, ensure the value is one of that path's reference
+ * @param[in]  h     Clixon handle
  * @param[in]  xt    XML leaf node of type leafref
  * @param[in]  ys    Yang spec of leaf
  * @param[in]  ytype Yang type statement belonging to the XML node
@@ -112,13 +341,15 @@
  *      references the typedef. (ie ys)
  *   o  Otherwise, the context node is the node in the data tree for which
  *      the "path" statement is defined. (ie ys)
- * 
+ * If a leafref index of the validation exists, and the path is indexed, the target values
+ * are looked up in the index, see struct leafref_index
  */
 static int
-validate_leafref(cxobj     *xt,
-                 yang_stmt *ys,
-                 yang_stmt *ytype,
-                 cxobj    **xret)
+validate_leafref(clicon_handle h,
+                 cxobj        *xt,
+                 yang_stmt    *ys,
+                 yang_stmt    *ytype,
+                 cxobj       **xret)
 {
     int          retval = -1;
     yang_stmt   *ypath;
@@ -135,7 +366,9 @@ validate_leafref(cxobj     *xt,
     yang_stmt   *ymod;
     cg_var      *cv;
     int          require_instance = 1;
-    
+    struct leafref_index *li = NULL;
+    cxobj       *ctx = NULL;
+
     /* require instance */
     if ((yreqi = yang_find(ytype, Y_REQUIRE_INSTANCE, NULL)) != NULL){
         if ((cv = yang_cv_get(yreqi)) != NULL) /* shouldnt happen */
@@ -162,16 +395,37 @@ validate_leafref(cxobj     *xt,
     }
     if ((leafrefbody = xml_body(xt)) == NULL)
         goto ok;
-    if (xml_nsctx_yang(ys, &nsc) < 0)
-        goto done;
-    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, path_arg) < 0) 
-        goto done;
-    for (i = 0; i < xlen; i++) {
-        x = xvec[i];
-        if ((leafbody = xml_body(x)) == NULL)
-            continue;
-        if (strcmp(leafbody, leafrefbody) == 0)
-            break;
+    if (clicon_ptr_get(h, LEAFREF_INDEX_NAME, (void**)&li) < 0)
+        li = NULL;
+    if (li != NULL &&
+        (ctx = leafref_context(xt, path_arg)) != NULL &&
+        leafref_index_find(li, ypath, ys, ctx, NULL)){
+        if (leafref_index_find(li, ypath, ys, ctx, leafrefbody))
+            goto ok;
+        i = xlen = 0; /* Not found */
+    }
+    else {
+        if (yang_nsctx_get(ys, &nsc) < 0)
+            goto done;
+        if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, path_arg) < 0) 
+            goto done;
+        if (li != NULL && ctx != NULL){
+            /* Build set of path in context */
+            if (leafref_index_add(li, ypath, ys, ctx, NULL) < 0)
+                goto done;
+            for (i = 0; i < xlen; i++)
+                if ((leafbody = xml_body(xvec[i])) != NULL &&
+                    !leafref_index_find(li, ypath, ys, ctx, leafbody) &&
+                    leafref_index_add(li, ypath, ys, ctx, leafbody) < 0)
+                    goto done;
+        }
+        for (i = 0; i < xlen; i++) {
+            x = xvec[i];
+            if ((leafbody = xml_body(x)) == NULL)
+                continue;
+            if (strcmp(leafbody, leafrefbody) == 0)
+                break;
+        }
     }
     if (i==xlen){
         if ((cberr = cbuf_new()) == NULL){
@@ -193,8 +447,6 @@ validate_leafref(cxobj     *xt,
  done:
     if (cberr)
         cbuf_free(cberr);
-    if (nsc)
-        xml_nsctx_free(nsc);
     if (xvec)
         free(xvec);
     return retval;
@@ -240,7 +492,6 @@ validate_identityref(cxobj     *xt,
     char       *id = NULL;
     cbuf       *cberr = NULL;
     cbuf       *cb = NULL;
-    cvec       *idrefvec; /* Derived identityref list: (module:id)**/
     yang_stmt  *ymod;
     
     if ((cb = cbuf_new()) == NULL){
@@ -292,10 +543,9 @@ validate_identityref(cxobj     *xt,
     cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
     idref = cbuf_get(cb);       
     /* Here check if node is in the derived node list of the base identity 
-     * The derived node list is a cvec computed XXX
+     * The derived node list is computed in ys_populate_identity
      */
-    idrefvec = yang_cvec_get(ybaseid);
-    if (cvec_find(idrefvec, idref) == NULL){
+    if (yang_identity_derived(ybaseid, idref) == 0){
         cprintf(cberr, "Identityref validation failed, %s not derived from %s in %s.yang:%d", 
                 node,
                 yang_argument_get(ybaseid),
@@ -505,11 +755,12 @@ check_choice(cxobj     *xp,
 {
     int        retval = -1;
     cxobj     *x;
+    xml_child_it it;
     yang_stmt *y;
     yang_stmt *yp;
     
-    x = NULL; /* Find a child with same yang spec */
-    while ((x = xml_child_each(xp, x, CX_ELMNT)) != NULL) {
+    xml_child_it_init(&it, xp, CX_ELMNT); /* Find a child with same yang spec */
+    while ((x = xml_child_it_next(&it)) != NULL) {
         if (x == xt)
             continue;
         y = xml_spec(x);
@@ -813,6 +1064,7 @@ check_mandatory_case(cxobj     *xt,
 {
     int retval = 0;
     cxobj     *x;
+    xml_child_it it;
     yang_stmt *y;
     yang_stmt *ym;
     yang_stmt *ycnew;
@@ -820,8 +1072,8 @@ check_mandatory_case(cxobj     *xt,
     int        ret;
     
     ycase = NULL;
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+    xml_child_it_init(&it, xt, CX_ELMNT);
+    while ((x = xml_child_it_next(&it)) != NULL) {
         if ((y = xml_spec(x)) != NULL &&
             yang_ancestor_child(y, yc, &ym, &ycnew) != 0 &&
             yang_keyword_get(ycnew) == Y_CASE){
@@ -887,6 +1139,7 @@ check_mandatory(cxobj     *xt,
 {
     int        retval = -1;
     cxobj     *x;
+    xml_child_it it;
     yang_stmt *y;
     yang_stmt *yc;
     yang_stmt *yp;
@@ -908,8 +1161,8 @@ check_mandatory(cxobj     *xt,
         /* Choice is more complex because of choice/case structure and possibly hierarchical */
         if (yang_keyword_get(yc) == Y_CHOICE){ 
             if (yang_xml_mandatory(xt, yc)){
-                x = NULL;
-                while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+                xml_child_it_init(&it, xt, CX_ELMNT);
+                while ((x = xml_child_it_next(&it)) != NULL) {
                     if ((y = xml_spec(x)) != NULL &&
                         (yp = yang_choice(y)) != NULL &&
                         yp == yc){
@@ -942,8 +1195,8 @@ check_mandatory(cxobj     *xt,
             if (yang_config(yc)==0) 
                  break;
             /* Find a child with the mandatory yang */
-            x = NULL;
-            while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+            xml_child_it_init(&it, xt, CX_ELMNT);
+            while ((x = xml_child_it_next(&it)) != NULL) {
                 if ((y = xml_spec(x)) != NULL
                     && y==yc)
                     break; /* got it */
@@ -1005,7 +1258,9 @@ xml_yang_validate_add(clicon_handle h,
     char        *body;
     int          ret;
     cxobj       *x;
+    xml_child_it it;
     cg_var      *cv0;
+    cg_var      *cvb;
     enum cv_type cvtype;
     validate_level vl = VL_NONE;
 
@@ -1031,6 +1286,20 @@ xml_yang_validate_add(clicon_handle h,
             /* validate value against ranges, etc */
             if ((cv0 = yang_cv_get(yt)) == NULL)
                 break;
+            /* Typed value bound to the node is validated as is, see xml_bind_value */
+            if ((cvb = xml_cv(xt)) != NULL &&
+                xml_cv_native(cv_type_get(cvb)) &&
+                cv_type_get(cvb) == cv_type_get(cv0) &&
+                (cv_type_get(cvb) != CGV_DEC64 || cv_dec64_n_get(cvb) == cv_dec64_n_get(cv0))){
+                if ((ret = ys_cv_validate(h, cvb, yt, NULL, &reason)) < 0)
+                    goto done;
+                if (ret == 0){
+                    if (xret && netconf_bad_element_xml(xret, "application",  yang_argument_get(yt), reason) < 0)
+                        goto done;
+                    goto fail;
+                }
+                break;
+            }
             if ((cv = cv_dup(cv0)) == NULL){
                 clicon_err(OE_UNIX, errno, "cv_dup");
                 goto done;
@@ -1068,8 +1337,8 @@ xml_yang_validate_add(clicon_handle h,
             break;
         }
     }
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+    xml_child_it_init(&it, xt, CX_ELMNT);
+    while ((x = xml_child_it_next(&it)) != NULL) {
         if ((ret = xml_yang_validate_add(h, x, xret)) < 0)
             goto done;
         if (ret == 0)
@@ -1100,6 +1369,7 @@ xml_yang_validate_list_key_only(cxobj        *xt,
     yang_stmt *yt;   /* yang spec of xt going in */
     int        ret;
     cxobj     *x;
+    xml_child_it it;
     
     /* if not given by argument (override) use default link 
        and !Node has a config sub-statement and it is false */
@@ -1111,8 +1381,8 @@ xml_yang_validate_list_key_only(cxobj        *xt,
         if (ret == 0)
             goto fail;
     }
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+    xml_child_it_init(&it, xt, CX_ELMNT);
+    while ((x = xml_child_it_next(&it)) != NULL) {
         if ((ret = xml_yang_validate_list_key_only(x, xret)) < 0)
             goto done;
         if (ret == 0)
@@ -1152,7 +1422,7 @@ xml_yang_validate_leaf_union(clicon_handle h,
         restype = ytype?yang_argument_get(ytype):NULL;
         ret = 1; /* If not leafref/identityref it is valid on this level */
         if (strcmp(restype, "leafref") == 0){
-            if ((ret = validate_leafref(xt, yt, ytype, &xret1)) < 0) // XXX
+            if ((ret = validate_leafref(h, xt, yt, ytype, &xret1)) < 0) // XXX
                 goto done;
         }
         else if (strcmp(restype, "identityref") == 0){
@@ -1187,29 +1457,22 @@ xml_yang_validate_leaf_union(clicon_handle h,
     goto done;
 }
 
-/*! Validate a single XML node with yang specification for all (not only added) entries
- * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
- * @param[in]  xt  XML node to be validated
- * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
- * @retval     1     Validation OK
- * @retval     0     Validation failed (cbret set)
- * @retval    -1     Error
- * @code
- *   cxobj *x;
- *   cbuf *xret = NULL;
- *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
- *      err;
- *   if (ret == 0)
- *      fail;
- *   xml_free(xret);
- * @endcode
- * @see xml_yang_validate_add
- * @see xml_yang_validate_rpc
+/*! Validate a single XML node and optionally its children for all (not only added) entries
+ *
+ * @param[in]  xt       XML node to be validated
+ * @param[in]  recurse  If set, validate children recursively, otherwise only xt itself
+ *                      including min/max and unique of its children
+ * @param[out] xret     Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1        Validation OK
+ * @retval     0        Validation failed (cbret set)
+ * @retval    -1        Error
+ * @see xml_yang_validate_all
  */
-int
-xml_yang_validate_all(clicon_handle h,
-                      cxobj        *xt, 
-                      cxobj       **xret)
+static int
+xml_yang_validate_all1(clicon_handle h,
+                       cxobj        *xt,
+                       int           recurse,
+                       cxobj       **xret)
 {
     int        retval = -1;
     yang_stmt *yt;  /* yang node associated with xt */
@@ -1219,10 +1482,12 @@ xml_yang_validate_all(clicon_handle h,
     int        nr;
     int        ret;
     cxobj     *x;
+    xml_child_it it;
     cxobj     *xp;
     char      *ns = NULL;
     cbuf      *cb = NULL;
     cvec      *nsc = NULL;
+    xpath_tree *xptree = NULL;
     int        hit = 0;
     validate_level vl = VL_NONE;
 
@@ -1294,7 +1559,7 @@ xml_yang_validate_all(clicon_handle h,
             if (yang_type_get(yt, NULL, &yc, NULL, NULL, NULL, NULL, NULL) < 0)
                 goto done;
             if (strcmp(yang_argument_get(yc), "leafref") == 0){
-                if ((ret = validate_leafref(xt, yt, yc, xret)) < 0)
+                if ((ret = validate_leafref(h, xt, yt, yc, xret)) < 0)
                     goto done;
                 if (ret == 0)
                     goto fail;
@@ -1325,10 +1590,15 @@ xml_yang_validate_all(clicon_handle h,
             /* the context node is the node in the accessible tree for
              * which the "must" statement is defined. 
              * The set of namespace declarations is the set of all "import" statements' 
+             * Both are computed once and kept in the yang statement
              */
-           if (xml_nsctx_yang(yc, &nsc) < 0)
-               goto done;
-            if ((nr = xpath_vec_bool(xt, nsc, "%s", xpath)) < 0)
+            if (yang_xpath_get(yc, &xptree, &nsc) < 0)
+                goto done;
+            if (xptree)
+                nr = xpath_vec_bool_tree(xt, nsc, xptree);
+            else
+                nr = xpath_vec_bool(xt, nsc, "%s", xpath);
+            if (nr < 0)
                 goto done;
             if (!nr){
                 ye = yang_find(yc, Y_ERROR_MESSAGE, NULL);
@@ -1343,18 +1613,18 @@ xml_yang_validate_all(clicon_handle h,
                     goto done;
                 goto fail;
             }
-            if (nsc){
-                xml_nsctx_free(nsc);
-                nsc = NULL;
-            }
         }
     }
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
-        if ((ret = xml_yang_validate_all(h, x, xret)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
+    if (recurse){
+        xml_child_it_init(&it, xt, CX_ELMNT);
+        while ((x = xml_child_it_next(&it)) != NULL) {
+            if (clixon_event_yield() < 0) /* Safe point of a long RPC */
+                goto done;
+            if ((ret = xml_yang_validate_all1(h, x, 1, xret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
     }
     /* Check unique and min-max after choice test for example*/
     if (yang_config(yt) != 0){
@@ -1369,15 +1639,343 @@ xml_yang_validate_all(clicon_handle h,
  done:
     if (cb)
         cbuf_free(cb);
-    if (nsc)
-        xml_nsctx_free(nsc);
     return retval;
  fail:
     retval = 0;
     goto done;
 }
 
+/*! Validate a single XML node with yang specification for all (not only added) entries
+ * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
+ * @param[in]  xt  XML node to be validated
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (cbret set)
+ * @retval    -1     Error
+ * @code
+ *   cxobj *x;
+ *   cbuf *xret = NULL;
+ *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
+ *      err;
+ *   if (ret == 0)
+ *      fail;
+ *   xml_free(xret);
+ * @endcode
+ * @see xml_yang_validate_add
+ * @see xml_yang_validate_rpc
+ */
+int
+xml_yang_validate_all(clicon_handle h,
+                      cxobj        *xt, 
+                      cxobj       **xret)
+{
+    int retval;
+    int created;
+
+    if (leafref_index_begin(h, &created) < 0)
+        return -1;
+    retval = xml_yang_validate_all1(h, xt, 1, xret);
+    if (created)
+        leafref_index_end(h);
+    return retval;
+}
+
+/*! Range of top-level nodes validated by one worker in xml_yang_validate_all_top
+ */
+struct validate_worker {
+    int    vw_from;  /* First top-level node */
+    int    vw_to;    /* Last top-level node + 1 */
+    pid_t  vw_pid;   /* Worker process, 0 if not running */
+    int    vw_fd;    /* Read end of pipe from worker */
+    cbuf  *vw_cb;    /* Output of worker */
+};
+
+/*! Validate a range of top-level nodes in a worker process and write the result to a pipe
+ *
+ * The output is "1", or the result of the first failing node: "0" followed by the error
+ * tree as XML, or "-1" followed by the error reason.
+ * Does not return.
+ * @param[in]  h     Clixon handle
+ * @param[in]  vec   Top-level nodes
+ * @param[in]  vw    Range of nodes
+ * @param[in]  fd    Write end of pipe
+ */
+static void
+validate_worker(clicon_handle           h,
+                cxobj                 **vec,
+                struct validate_worker *vw,
+                int                     fd)
+{
+    cxobj  *xerr = NULL;
+    cbuf   *cb;
+    char   *p;
+    size_t  len;
+    ssize_t n;
+    int     ret = 1;
+    int     i;
+
+    if ((cb = cbuf_new()) == NULL)
+        _exit(1);
+    for (i=vw->vw_from; i<vw->vw_to; i++)
+        if ((ret = xml_yang_validate_all1(h, vec[i], 1, &xerr)) < 1)
+            break;
+    cprintf(cb, "%d", ret);
+    if (ret < 0)
+        cprintf(cb, "%s", clicon_err_reason);
+    else if (ret == 0 && xerr &&
+             clixon_xml2cbuf(cb, xerr, 0, 0, NULL, -1, 0) < 0)
+        _exit(1);
+    p = cbuf_get(cb);
+    len = cbuf_len(cb);
+    while (len > 0){
+        if ((n = write(fd, p, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            _exit(1);
+        }
+        p += n;
+        len -= n;
+    }
+    /* Not exit(): the exit handlers of the process are not run in the worker */
+    _exit(0);
+}
+
+/*! Read the output of a worker until it closes its pipe, and reap it
+ *
+ * @param[in]  vw    Worker
+ * @retval     0     OK, output in vw_cb
+ * @retval    -1     Error
+ */
+static int
+validate_worker_read(struct validate_worker *vw)
+{
+    int     retval = -1;
+    char    buf[BUFSIZ];
+    ssize_t n;
+    int     status = 0;
+
+    while ((n = read(vw->vw_fd, buf, sizeof(buf))) != 0){
+        if (n < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "read");
+            goto done;
+        }
+        if (cbuf_append_buf(vw->vw_cb, buf, n) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+    }
+    close(vw->vw_fd);
+    vw->vw_fd = -1;
+    if (waitpid(vw->vw_pid, &status, 0) != vw->vw_pid)
+        status = 0;
+    vw->vw_pid = 0;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || cbuf_len(vw->vw_cb) == 0){
+        clicon_err(OE_XML, 0, "Validation worker failed");
+        goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add error tree of a worker to the error tree of the validation
+ *
+ * @param[in]     str   Error tree as XML with rpc-reply top, or empty
+ * @param[in,out] xret  Error XML tree, created if NULL
+ * @retval        0     OK
+ * @retval       -1     Error
+ */
+static int
+validate_worker_error(char   *str,
+                      cxobj **xret)
+{
+    int    retval = -1;
+    cxobj *xt = NULL;
+    cxobj *xr;
+    cxobj *x;
+
+    if (*str == '\0' || xret == NULL)
+        goto ok;
+    if (clixon_xml_parse_string(str, YB_NONE, NULL, &xt, NULL) < 0)
+        goto done;
+    if ((xr = xml_find_type(xt, NULL, "rpc-reply", CX_ELMNT)) == NULL)
+        goto ok;
+    if (*xret == NULL){
+        if (xml_rm(xr) < 0)
+            goto done;
+        *xret = xr;
+        goto ok;
+    }
+    if (xml_name_set(*xret, "rpc-reply") < 0)
+        goto done;
+    while ((x = xml_child_each(xr, NULL, CX_ELMNT)) != NULL){
+        if (xml_rm(x) < 0)
+            goto done;
+        if (xml_addsub(*xret, x) < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Validate top-level nodes in worker processes
+ *
+ * The top-level nodes are split in ranges of about the same number of nodes, and each range
+ * is validated in a forked copy of the process. The workers see the whole tree, so that
+ * leafrefs and musts referring to other modules are validated as before.
+ * The result is the result of the first range that fails, so that errors are the same as if
+ * the nodes were validated one by one. Ranges of workers that cannot be started are validated
+ * in the calling process.
+ * @param[in]  h        Clixon handle
+ * @param[in]  xt       XML tree top
+ * @param[in]  workers  Max number of workers
+ * @param[out] xret     Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     1        Validation OK
+ * @retval     0        Validation failed (xret set)
+ * @retval    -1        Error
+ * @see CLICON_VALIDATE_WORKERS
+ */
+static int
+validate_workers_run(clicon_handle h,
+                     cxobj        *xt,
+                     int           workers,
+                     cxobj       **xret)
+{
+    int                     retval = -1;
+    struct validate_worker *vv = NULL;
+    struct validate_worker *vw;
+    cxobj                 **vec = NULL;
+    cxobj                  *x;
+    uint64_t               *sizes = NULL;
+    uint64_t                total = 0;
+    uint64_t                sum = 0;
+    int                     len;
+    int                     fd[2];
+    char                   *str;
+    int                     ret = 1;
+    int                     i;
+    int                     j;
+    int                     k;
+
+    if ((len = xml_child_nr_type(xt, CX_ELMNT)) == 0)
+        goto ok;
+    if ((vec = calloc(len, sizeof(*vec))) == NULL ||
+        (sizes = calloc(len, sizeof(*sizes))) == NULL ||
+        (vv = calloc(workers, sizeof(*vv))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    i = 0;
+    x = NULL;
+    while (i < len && (x = xml_child_each(xt, x, CX_ELMNT)) != NULL){
+        vec[i] = x;
+        if (xml_stats(x, &sizes[i], NULL) < 0)
+            goto done;
+        total += sizes[i++];
+    }
+    if (workers > len)
+        workers = len;
+    /* Contiguous ranges of about total/workers nodes each */
+    for (i=0, j=0; j<workers; j++){
+        vw = &vv[j];
+        vw->vw_fd = -1;
+        vw->vw_from = i;
+        while (i < len - (workers - j - 1) &&
+               (i == vw->vw_from || j == workers - 1 || sum + sizes[i] <= total*(j+1)/workers))
+            sum += sizes[i++];
+        vw->vw_to = i;
+    }
+    for (j=0; j<workers; j++){
+        vw = &vv[j];
+        if ((vw->vw_cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if (pipe(fd) < 0){
+            clicon_err(OE_UNIX, errno, "pipe");
+            goto done;
+        }
+        if ((vw->vw_pid = fork()) < 0){
+            clicon_log(LOG_WARNING, "%s: fork: %s", __FUNCTION__, strerror(errno));
+            vw->vw_pid = 0;
+            close(fd[0]);
+            close(fd[1]);
+            continue;
+        }
+        if (vw->vw_pid == 0){ /* Worker */
+            close(fd[0]);
+            for (k=0; k<j; k++)
+                if (vv[k].vw_fd != -1)
+                    close(vv[k].vw_fd);
+            validate_worker(h, vec, vw, fd[1]);
+        }
+        close(fd[1]);
+        vw->vw_fd = fd[0];
+        clicon_debug(CLIXON_DBG_DETAIL, "%s pid:%d nodes:%d-%d", __FUNCTION__,
+                     vw->vw_pid, vw->vw_from, vw->vw_to);
+    }
+    /* Results in order of the ranges, until the first that fails */
+    for (j=0; j<workers && ret == 1; j++){
+        vw = &vv[j];
+        if (vw->vw_pid == 0){
+            for (i=vw->vw_from; i<vw->vw_to; i++)
+                if ((ret = xml_yang_validate_all1(h, vec[i], 1, xret)) < 1)
+                    break;
+            continue;
+        }
+        if (validate_worker_read(vw) < 0)
+            goto done;
+        str = cbuf_get(vw->vw_cb);
+        if (*str == '1')
+            continue;
+        if (*str == '0'){
+            if (validate_worker_error(str+1, xret) < 0)
+                goto done;
+            ret = 0;
+        }
+        else {
+            clicon_err(OE_XML, 0, "%s", str+2);
+            ret = -1;
+        }
+    }
+    if (ret < 1){
+        retval = ret;
+        goto done;
+    }
+ ok:
+    retval = 1;
+ done:
+    /* Kill remaining workers, eg after the first failure */
+    if (vv){
+        for (j=0; j<workers; j++){
+            vw = &vv[j];
+            if (vw->vw_pid){
+                kill(vw->vw_pid, SIGKILL);
+                close(vw->vw_fd);
+                waitpid(vw->vw_pid, NULL, 0);
+            }
+            if (vw->vw_cb)
+                cbuf_free(vw->vw_cb);
+        }
+        free(vv);
+    }
+    if (vec)
+        free(vec);
+    if (sizes)
+        free(sizes);
+    return retval;
+}
+
 /*! Validate a single XML node with yang specification
+ *
+ * If CLICON_VALIDATE_WORKERS is set, the top-level nodes of large trees are validated in
+ * worker processes, see validate_workers_run
  * @param[out] xret    Error XML tree (if ret == 0). Free with xml_free after use
  * @retval     1     Validation OK
  * @retval     0     Validation failed (xret set)
@@ -1388,19 +1986,568 @@ xml_yang_validate_all_top(clicon_handle h,
                           cxobj        *xt, 
                           cxobj       **xret)
 {
-    int    ret;
-    cxobj *x;
+    int      retval = -1;
+    int      ret;
+    cxobj   *x;
+    xml_child_it it;
+    int      created;
+    int      workers;
+    uint64_t nr = 0;
 
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
-        if ((ret = xml_yang_validate_all(h, x, xret)) < 1)
+    if (leafref_index_begin(h, &created) < 0)
+        return -1;
+    workers = clicon_option_int(h, "CLICON_VALIDATE_WORKERS");
+    if (workers > 1 &&
+        xml_child_nr_type(xt, CX_ELMNT) > 1 &&
+        xml_stats(xt, &nr, NULL) == 0 &&
+        nr >= VALIDATE_WORKERS_NODES){
+        if ((ret = validate_workers_run(h, xt, workers, xret)) < 1){
+            retval = ret;
+            goto done;
+        }
+    }
+    else {
+        xml_child_it_init(&it, xt, CX_ELMNT);
+        while ((x = xml_child_it_next(&it)) != NULL) {
+            if ((ret = xml_yang_validate_all1(h, x, 1, xret)) < 1){
+                retval = ret;
+                goto done;
+            }
+        }
+    }
+    if ((retval = xml_yang_minmax_recurse(xt, 0, xret)) < 1)
+        goto done;
+    retval = 1;
+ done:
+    if (created)
+        leafref_index_end(h);
+    return retval;
+}
+
+/*! Check if a parsed xpath may select any of a set of node names
+ *
+ * Wildcards, node-type tests, descendant axes and deref() may select any node.
+ * @param[in]  xs     Parsed xpath
+ * @param[in]  names  Set of node names (local names without prefix)
+ * @retval     1      The xpath may select a node with a name in the set
+ * @retval     0      No
+ */
+static int
+xpath_tree_names_match(xpath_tree    *xs,
+                       clicon_hash_t *names)
+{
+    if (xs == NULL)
+        return 0;
+    switch (xs->xs_type){
+    case XP_NODE:
+        if (xs->xs_s1 == NULL ||
+            strcmp(xs->xs_s1, "*") == 0 ||
+            clicon_hash_lookup(names, xs->xs_s1) != NULL)
+            return 1;
+        break;
+    case XP_NODE_FN:
+        return 1;
+        break;
+    case XP_STEP:
+        switch (xs->xs_int){
+        case A_DESCENDANT:
+        case A_DESCENDANT_OR_SELF:
+        case A_FOLLOWING:
+        case A_PRECEDING:
+            return 1;
+            break;
+        default:
+            break;
+        }
+        break;
+    case XP_ABSPATH:
+    case XP_RELLOCPATH:
+        if (xs->xs_int == A_DESCENDANT_OR_SELF)
+            return 1;
+        break;
+    case XP_PRIME_FN:
+        if (xs->xs_s0 && strcmp(xs->xs_s0, "deref") == 0)
+            return 1;
+        break;
+    default:
+        break;
+    }
+    return xpath_tree_names_match(xs->xs_c0, names) ||
+        xpath_tree_names_match(xs->xs_c1, names);
+}
+
+/*! Check if leafref paths of a (union) type may select any of a set of node names
+ *
+ * @param[in]  ys       Yang leaf or leaf-list
+ * @param[in]  yrestype Resolved type
+ * @param[in]  names    Set of node names
+ * @retval     1        A leafref path may select a node in the set
+ * @retval     0        No
+ * @retval    -1        Error
+ */
+static int
+validate_changes_type(yang_stmt     *ys,
+                      yang_stmt     *yrestype,
+                      clicon_hash_t *names)
+{
+    yang_stmt  *ypath;
+    yang_stmt  *ytsub = NULL;
+    yang_stmt  *ytype;
+    xpath_tree *xptree;
+    cvec       *nsc;
+    int         ret;
+
+    if (yrestype == NULL)
+        return 0;
+    if (strcmp(yang_argument_get(yrestype), "leafref") == 0){
+        if ((ypath = yang_find(yrestype, Y_PATH, NULL)) == NULL)
+            return 1;
+        if (yang_xpath_get(ypath, &xptree, &nsc) < 0)
+            return -1;
+        return xptree == NULL || xpath_tree_names_match(xptree, names);
+    }
+    if (strcmp(yang_argument_get(yrestype), "union") == 0){
+        while ((ytsub = yn_each(yrestype, ytsub)) != NULL){
+            if (yang_keyword_get(ytsub) != Y_TYPE)
+                continue;
+            if (yang_type_resolve(ys, ys, ytsub, &ytype, NULL, NULL, NULL, NULL, NULL) < 0)
+                return -1;
+            if ((ret = validate_changes_type(ys, ytype, names)) != 0)
+                return ret;
+        }
+    }
+    return 0;
+}
+
+/*! Check if the must, when or leafref constraints of a yang data node may depend on changes
+ *
+ * @param[in]  ys     Yang data node
+ * @param[in]  names  Set of names of changed nodes and their ancestors
+ * @retval     1      Constraints of ys may depend on changed nodes
+ * @retval     0      No
+ * @retval    -1      Error
+ */
+static int
+validate_changes_depends(yang_stmt     *ys,
+                         clicon_hash_t *names)
+{
+    int         retval = -1;
+    yang_stmt  *yc = NULL;
+    yang_stmt  *yrestype = NULL;
+    xpath_tree *xptree = NULL;
+    cvec       *nsc;
+    char       *xpath;
+    int         ret;
+
+    while ((yc = yn_each(ys, yc)) != NULL) {
+        if (yang_keyword_get(yc) != Y_MUST && yang_keyword_get(yc) != Y_WHEN)
+            continue;
+        if (yang_xpath_get(yc, &xptree, &nsc) < 0)
+            goto done;
+        if (xptree == NULL || xpath_tree_names_match(xptree, names))
+            goto match;
+    }
+    xptree = NULL;
+    /* When of augment or uses, not cached in the yang statement */
+    if ((xpath = yang_when_xpath_get(ys)) != NULL){
+        if (xpath_parse(xpath, &xptree) < 0)
+            goto match;
+        ret = xpath_tree_names_match(xptree, names);
+        xpath_tree_free(xptree);
+        if (ret)
+            goto match;
+    }
+    if (yang_keyword_get(ys) == Y_LEAF || yang_keyword_get(ys) == Y_LEAF_LIST){
+        if (yang_type_get(ys, NULL, &yrestype, NULL, NULL, NULL, NULL, NULL) < 0)
+            goto done;
+        if ((ret = validate_changes_type(ys, yrestype, names)) < 0)
+            goto done;
+        if (ret == 1)
+            goto match;
+    }
+    retval = 0;
+ done:
+    return retval;
+ match:
+    retval = 1;
+    goto done;
+}
+
+/*! Get all instances of a yang data node in an XML tree
+ *
+ * @param[in]  xt   XML tree top (datastore top symbol)
+ * @param[in]  ys   Yang data node
+ * @param[out] vec  Vector of XML instances. Free after use
+ * @param[out] len  Length of vector
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @note ys is assumed to be a data node defined in a module, eg not in a rpc or grouping
+ */
+static int
+validate_changes_instances(cxobj      *xt,
+                           yang_stmt  *ys,
+                           cxobj    ***vec,
+                           int        *len)
+{
+    int        retval = -1;
+    yang_stmt *yp = ys;
+    cxobj    **pvec = NULL;
+    int        plen = 0;
+    cxobj     *x;
+    int        i;
+
+    do {
+        yp = yang_parent_get(yp);
+    } while (yp && (yang_keyword_get(yp) == Y_CHOICE || yang_keyword_get(yp) == Y_CASE));
+    if (yp == NULL)
+        goto ok;
+    if (yang_keyword_get(yp) == Y_MODULE || yang_keyword_get(yp) == Y_SUBMODULE){
+        if (cxvec_append(xt, &pvec, &plen) < 0)
+            goto done;
+    }
+    else if (validate_changes_instances(xt, yp, &pvec, &plen) < 0)
+        goto done;
+    for (i=0; i<plen; i++){
+        x = NULL;
+        while ((x = xml_child_each(pvec[i], x, CX_ELMNT)) != NULL)
+            if (xml_spec(x) == ys &&
+                cxvec_append(x, vec, len) < 0)
+                goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (pvec)
+        free(pvec);
+    return retval;
+}
+
+/*! Validate a node of the change set unless already validated
+ *
+ * @param[in]  x        XML node
+ * @param[in]  recurse  Validate also children recursively
+ * @param[out] vec      Vector of validated (flagged) nodes
+ * @param[out] len      Length of vector
+ * @param[out] xret     Error XML tree (if retval=0)
+ * @retval     1        Validation OK
+ * @retval     0        Validation failed
+ * @retval    -1        Error
+ */
+static int
+validate_changes_one(clicon_handle h,
+                     cxobj        *x,
+                     int           recurse,
+                     cxobj      ***vec,
+                     int          *len,
+                     cxobj       **xret)
+{
+    if (xml_flag(x, XML_FLAG_TRANSIENT))
+        return 1;
+    xml_flag_set(x, XML_FLAG_TRANSIENT);
+    if (cxvec_append(x, vec, len) < 0)
+        return -1;
+    return xml_yang_validate_all1(h, x, recurse, xret);
+}
+
+/*! Validate ancestors of a node in the change set
+ *
+ * Checks the constraints of each ancestor itself, such as must and mandatory, and min/max and
+ * unique of its children, but not the unchanged siblings of x
+ * @param[in]  x     XML node, its parent is the first node to be validated
+ * @param[out] vec   Vector of validated (flagged) nodes
+ * @param[out] len   Length of vector
+ * @param[out] xret  Error XML tree (if retval=0)
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed
+ * @retval    -1     Error
+ */
+static int
+validate_changes_ancestors(clicon_handle h,
+                           cxobj        *x,
+                           cxobj      ***vec,
+                           int          *len,
+                           cxobj       **xret)
+{
+    int ret;
+
+    for (x = xml_parent(x); x != NULL && xml_parent(x) != NULL; x = xml_parent(x)){
+        /* Ancestors of a validated ancestor are validated */
+        if (xml_flag(x, XML_FLAG_TRANSIENT))
+            break;
+        if ((ret = validate_changes_one(h, x, 0, vec, len, xret)) < 1)
             return ret;
     }
-    if ((ret = xml_yang_minmax_recurse(xt, 0, xret)) < 1)
-        return ret;
     return 1;
 }
 
+/*! Validate instances of yang data nodes whose constraints may depend on changes
+ *
+ * Instances of a data node with a must, when or leafref that may select a changed node are
+ * validated, and also the instances of its parent, for mandatory children with when and
+ * min/max.
+ * @param[in]  xt     XML tree top (datastore top symbol)
+ * @param[in]  yn     Yang module or data definition node
+ * @param[in]  names  Set of names of changed nodes and their ancestors
+ * @param[out] vec    Vector of validated (flagged) nodes
+ * @param[out] len    Length of vector
+ * @param[out] xret   Error XML tree (if retval=0)
+ * @retval     1      Validation OK
+ * @retval     0      Validation failed
+ * @retval    -1      Error
+ */
+static int
+validate_changes_yang(clicon_handle  h,
+                      cxobj         *xt,
+                      yang_stmt     *yn,
+                      clicon_hash_t *names,
+                      cxobj       ***vec,
+                      int           *len,
+                      cxobj        **xret)
+{
+    int        retval = -1;
+    yang_stmt *yc = NULL;
+    cxobj    **xvec = NULL;
+    int        xlen = 0;
+    yang_stmt *yp;
+    int        i;
+    int        ret;
+
+    while ((yc = yn_each(yn, yc)) != NULL) {
+        switch (yang_keyword_get(yc)){
+        case Y_CHOICE:
+        case Y_CASE:
+            break;
+        case Y_CONTAINER:
+        case Y_LIST:
+        case Y_LEAF:
+        case Y_LEAF_LIST:
+            if (yang_config(yc) == 0)
+                continue;
+            if ((ret = validate_changes_depends(yc, names)) < 0)
+                goto done;
+            if (ret == 0)
+                break;
+            xlen = 0;
+            if (validate_changes_instances(xt, yc, &xvec, &xlen) < 0)
+                goto done;
+            /* Also parent instances for mandatory children with when */
+            yp = yc;
+            do {
+                yp = yang_parent_get(yp);
+            } while (yp && (yang_keyword_get(yp) == Y_CHOICE || yang_keyword_get(yp) == Y_CASE));
+            if (yp && yang_datanode(yp) &&
+                validate_changes_instances(xt, yp, &xvec, &xlen) < 0)
+                goto done;
+            for (i=0; i<xlen; i++){
+                /* Added subtrees are already validated */
+                if (xml_flag(xvec[i], XML_FLAG_ADD))
+                    continue;
+                if ((ret = validate_changes_one(h, xvec[i], 0, vec, len, xret)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+            }
+            break;
+        default:
+            continue;
+            break;
+        }
+        if (yang_keyword_get(yc) == Y_LEAF || yang_keyword_get(yc) == Y_LEAF_LIST)
+            continue;
+        if ((ret = validate_changes_yang(h, xt, yc, names, vec, len, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    retval = 1;
+ done:
+    if (xvec)
+        free(xvec);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Add names of a node and its ancestors to the set of changed names
+ *
+ * @param[in]  names  Set of node names
+ * @param[in]  x      XML node, the tree top is not added
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+validate_changes_names(clicon_hash_t *names,
+                       cxobj         *x)
+{
+    for (; x != NULL && xml_parent(x) != NULL; x = xml_parent(x))
+        if (clicon_hash_add(names, xml_name(x), NULL, 0) == NULL)
+            return -1;
+    return 0;
+}
+
+/*! Find the node in another tree matching a node in a source tree
+ *
+ * @param[in]  x0t   Tree top of other tree
+ * @param[in]  x1    Node in source tree
+ * @param[out] x0p   Matching node in x0t, or NULL
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+validate_changes_match(cxobj  *x0t,
+                       cxobj  *x1,
+                       cxobj **x0p)
+{
+    cxobj *x0 = NULL;
+
+    *x0p = NULL;
+    if (xml_parent(x1) == NULL){
+        *x0p = x0t;
+        return 0;
+    }
+    if (validate_changes_match(x0t, xml_parent(x1), &x0) < 0)
+        return -1;
+    if (x0 != NULL &&
+        match_base_child(x0, x1, xml_spec(x1), x0p) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Validate the target of a transaction given its changes
+ *
+ * Same as xml_yang_validate_all_top but incrementally:
+ * 1. Added and changed nodes are validated as by xml_yang_validate_all
+ * 2. Their ancestors and the parents of deleted nodes are validated themselves, including
+ *    min/max and unique of their children, but not their unchanged children
+ * 3. Nodes with a must, when or leafref that may select a changed node are validated.
+ *    Dependencies are computed from the xpaths in the yang spec using node names only,
+ *    so that more nodes than necessary may be validated, but not less.
+ * @note Nodes in added subtrees are assumed to be flagged with XML_FLAG_ADD, as in commits
+ * @param[in]  h      Clixon handle
+ * @param[in]  xt     Target XML tree top, eg td_target
+ * @param[in]  dvec   Deleted nodes in source tree
+ * @param[in]  dlen   Length of dvec
+ * @param[in]  avec   Added nodes in target tree
+ * @param[in]  alen   Length of avec
+ * @param[in]  tcvec  Changed nodes in target tree
+ * @param[in]  clen   Length of tcvec
+ * @param[out] xret   Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     1      Validation OK
+ * @retval     0      Validation failed (xret set)
+ * @retval    -1      Error
+ * @see xml_yang_validate_all_top  Validation of the whole tree
+ * @see CLICON_VALIDATE_INCREMENTAL
+ */
+int
+xml_yang_validate_changes(clicon_handle h,
+                          cxobj        *xt,
+                          cxobj       **dvec,
+                          int           dlen,
+                          cxobj       **avec,
+                          int           alen,
+                          cxobj       **tcvec,
+                          int           clen,
+                          cxobj       **xret)
+{
+    int            retval = -1;
+    clicon_hash_t *names = NULL;
+    cxobj        **vec = NULL;
+    int            len = 0;
+    cxobj         *x;
+    yang_stmt     *yspec;
+    yang_stmt     *ymod = NULL;
+    int            i;
+    int            ret;
+    int            created = 0;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    /* Mounted yang specs are not covered by dependencies, validate all */
+    if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT"))
+        return xml_yang_validate_all_top(h, xt, xret);
+    if (leafref_index_begin(h, &created) < 0)
+        goto done;
+    if ((names = clicon_hash_init()) == NULL)
+        goto done;
+    for (i=0; i<alen; i++){
+        if ((ret = validate_changes_one(h, avec[i], 1, &vec, &len, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (validate_changes_names(names, avec[i]) < 0)
+            goto done;
+    }
+    for (i=0; i<clen; i++){
+        if ((ret = validate_changes_one(h, tcvec[i], 1, &vec, &len, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (validate_changes_names(names, tcvec[i]) < 0)
+            goto done;
+    }
+    for (i=0; i<alen; i++){
+        if ((ret = validate_changes_ancestors(h, avec[i], &vec, &len, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    for (i=0; i<clen; i++){
+        if ((ret = validate_changes_ancestors(h, tcvec[i], &vec, &len, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    for (i=0; i<dlen; i++){
+        if (validate_changes_names(names, dvec[i]) < 0)
+            goto done;
+        if (validate_changes_match(xt, xml_parent(dvec[i]), &x) < 0)
+            goto done;
+        if (x == NULL || x == xt)
+            continue;
+        if ((ret = validate_changes_one(h, x, 0, &vec, &len, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if ((ret = validate_changes_ancestors(h, x, &vec, &len, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    /* Nodes depending on changes */
+    if (dlen + alen + clen > 0){
+        while ((ymod = yn_each(yspec, ymod)) != NULL) {
+            if (yang_keyword_get(ymod) != Y_MODULE &&
+                yang_keyword_get(ymod) != Y_SUBMODULE)
+                continue;
+            if ((ret = validate_changes_yang(h, xt, ymod, names, &vec, &len, xret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+    }
+    if ((ret = xml_yang_minmax_recurse(xt, 0, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    retval = 1;
+ done:
+    for (i=0; i<len; i++)
+        xml_flag_reset(vec[i], XML_FLAG_TRANSIENT);
+    if (vec)
+        free(vec);
+    if (names)
+        clicon_hash_free(names);
+    if (created)
+        leafref_index_end(h);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Check validity of outgoing RPC
  *
  * Rewrite return message if errors
@@ -79,224 +79,254 @@
 #include "clixon_xml_bind.h"
 #include "clixon_validate_minmax.h"
 
-/*! New element last in list, check if already exists if sp return -1
- * @param[in]  vec   Vector of existing entries (new is last)
- * @param[in]  i1    The new entry is placed at vec[i1]
- * @param[in]  vlen  Length of entry
- * @param[in]  sorted Sorted by system, ie sorted by key, otherwise no assumption
- * @retval     0     OK, entry is unique
- * @retval    -1     Duplicate detected
- * @note This is currently quadratic complexity. It could be improved by inserting new element sorted and binary search.
+/*! Given a list, check if any min/max-elemants constraints apply
+ *
+ * @param[in]  xp    Parent of the xml list there are too few/many (for error)
+ * @param[in]  y     Yang spec of the failing list
+ * @param[in]  nr    Number of elements (like x) in the list
+ * @param[out] xret  Error XML tree. Free with xml_free after use
  * @retval     1     Validation OK
  * @retval     0     Validation failed (cbret set)
  * @retval    -1     Error
+ * @see RFC7950 7.7.5
+ * @note No recurse for non-presence container is made, see eg xml_yang_minmax_recurse
  */
 static int
-unique_search_xpath(cxobj  *x,
-                    char   *xpath,
-                    cvec   *nsc,
-                    char ***svec,
-                    size_t *slen)
+check_minmax(cxobj     *xp,
+             yang_stmt *y,
+             int        nr,
+             cxobj     **xret)
 {
-    int     retval = -1;
-    cxobj **xvec = NULL;
-    size_t  xveclen;
-    int     i;
-    int     s;
-    cxobj  *xi;
-    char   *bi;
-
-    /* Collect tuples */
-    if (xpath_vec(x, nsc, "%s", &xvec, &xveclen, xpath) < 0) 
-        goto done;      
-    for (i=0; i<xveclen; i++){
-        xi = xvec[i];
-        if ((bi = xml_body(xi)) == NULL)
-            break;
-        /* Check if bi is duplicate? 
-         * XXX: sort svec?
-         */
-        for (s=0; s<(*slen); s++){
-            if (strcmp(bi, (*svec)[s]) == 0){
-                goto fail;
+    int         retval = -1;
+    yang_stmt  *ymin; /* yang min */
+    yang_stmt  *ymax; /* yang max */
+    cg_var     *cv;
+    
+    if ((ymin = yang_find(y, Y_MIN_ELEMENTS, NULL)) != NULL){
+        cv = yang_cv_get(ymin);
+        if (nr < cv_uint32_get(cv)){
+            if (xret && netconf_minmax_elements_xml(xret, xp, yang_argument_get(y), 0) < 0)
+                goto done;
+            goto fail;
+        }
+    }
+    if ((ymax = yang_find(y, Y_MAX_ELEMENTS, NULL)) != NULL){
+        cv = yang_cv_get(ymax);
+        if (cv_uint32_get(cv) > 0 && /* 0 means unbounded */
+            nr > cv_uint32_get(cv)){
+            if (xret && netconf_minmax_elements_xml(xret, xp, yang_argument_get(y), 1) < 0)
+                goto done;
+            goto fail;
+        }
+    }
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Check if there is any empty list (no x elements) and check min-elements
+ * Note recurse for non-presence container 
+ * @param[in]  xt    XML node
+ * @param[in]  yt    YANG node
+ * @param[out] xret  Error XML tree. Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ */
+static int
+check_empty_list_minmax(cxobj     *xt,
+                        yang_stmt *ye,
+                        cxobj    **xret)
+{
+    int        retval = -1;
+    int        ret;
+    yang_stmt *yprev = NULL;
+
+    if (yang_config(ye) == 1){
+        if(yang_keyword_get(ye) == Y_CONTAINER &&
+           yang_find(ye, Y_PRESENCE, NULL) == NULL){
+            yprev = NULL;
+            while ((yprev = yn_each(ye, yprev)) != NULL) {
+                if ((ret = check_empty_list_minmax(xt, yprev, xret)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
             }
         }
-        (*slen) ++;
-        if (((*svec) = realloc((*svec), (*slen)*sizeof(char*))) == NULL){
-            clicon_err(OE_UNIX, errno, "realloc");
-            goto done;
+        else if (yang_keyword_get(ye) == Y_LIST ||
+                 yang_keyword_get(ye) == Y_LEAF_LIST){
+            /* Check if the list length violates min/max */
+            if ((ret = check_minmax(xt, ye, 0, xret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
         }
-        (*svec)[(*slen)-1] = bi;
-    } /* i search results */
+    }
     retval = 1;
  done:
-    if (xvec)
-        free(xvec);    
     return retval;
  fail:
     retval = 0;
     goto done;
 }
 
-/*! New element last in list, return error if already exists 
+/*! Duplicate detection of the key or one unique constraint of a list
  *
- * @param[in]  vec   Vector of existing entries (new is last)
- * @param[in]  i1    The new entry is placed at vec[i1]
- * @param[in]  vlen  Length of vec
- * @param[in]  sorted Sorted by system, ie sorted by key, otherwise no assumption
- * @retval     0     OK, entry is unique
- * @retval    -1     Duplicate detected
- * @note This is currently quadratic complexity. It could be improved by inserting new element sorted and binary search.
+ * The values of each list entry form a tuple, inserted into a hash set of the tuples of
+ * previous entries. If the list is sorted by its keys, a key tuple is only compared with the
+ * previous tuple.
+ */
+struct unique_check {
+    yang_stmt  *uc_yu;     /* Y_LIST for keys or Y_UNIQUE */
+    cvec       *uc_cvk;    /* Schema node identifiers */
+    int         uc_clen;   /* Number of values in a tuple, 0 if no check */
+    int         uc_sorted; /* Entries are sorted by tuple */
+    char       *uc_xpath;  /* Canonical xpath if single descendant id with "/", or NULL */
+    cvec       *uc_nsc;    /* Namespace context of uc_xpath */
+    char      **uc_vec;    /* Tuples, uc_clen values each */
+    int         uc_len;    /* Number of tuples */
+    int         uc_max;    /* Number of allocated tuples */
+    int        *uc_tab;    /* Open addressing hash table of tuple indexes, -1 if empty */
+    uint32_t   *uc_hash;   /* Hash values of tuples */
+    size_t      uc_tlen;   /* Size of uc_tab, power of 2 */
+};
+
+/* Initial size of unique check hash table, power of 2 */
+#define UNIQUE_TAB_START 64
+
+/*! Hash of tuple of strings (FNV-1a)
+ */
+static uint32_t
+unique_tuple_hash(char **tuple,
+                  int    clen)
+{
+    uint32_t h = 2166136261U;
+    char    *s;
+    int      v;
+
+    for (v=0; v<clen; v++){
+        for (s=tuple[v]; *s; s++){
+            h ^= (uint8_t)*s;
+            h *= 16777619U;
+        }
+        h ^= 0xff; /* Value separator */
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*! Check if two tuples of strings are equal
  */
 static int
-check_insert_duplicate(char **vec,
-                       int    i1,
-                       int    vlen,
-                       int    sorted)
+unique_tuple_eq(char **t1,
+                char **t2,
+                int    clen)
 {
-    int i;
     int v;
-    char *b;
 
-    if (sorted){
-        /* Just go look at previous element to see if it is duplicate (sorted by system) */
-        if (i1 == 0)
+    for (v=0; v<clen; v++)
+        if (strcmp(t1[v], t2[v]) != 0)
             return 0;
-        i = i1-1;
-        for (v=0; v<vlen; v++){
-            b = vec[i*vlen+v];
-            if (b == NULL || strcmp(b, vec[i1*vlen+v]))
-                return 0;
-        }
-        /* here we have passed thru all keys of previous element and they are all equal */
+    return 1;
+}
+
+/*! Insert tuple index in hash table, table is assumed to have room
+ */
+static void
+unique_tab_insert(struct unique_check *uc,
+                  int                  i)
+{
+    size_t j;
+
+    for (j = uc->uc_hash[i] & (uc->uc_tlen-1); uc->uc_tab[j] != -1; j = (j+1) & (uc->uc_tlen-1))
+        ;
+    uc->uc_tab[j] = i;
+}
+
+/*! Double size of hash table and rehash tuples
+ */
+static int
+unique_tab_grow(struct unique_check *uc)
+{
+    size_t len;
+    int   *tab;
+    int    i;
+
+    len = uc->uc_tlen ? 2*uc->uc_tlen : UNIQUE_TAB_START;
+    if ((tab = malloc(len*sizeof(int))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
         return -1;
     }
-    else{
-        for (i=0; i<i1; i++){
-            for (v=0; v<vlen; v++){
-                b = vec[i*vlen+v];
-                if (b == NULL || strcmp(b, vec[i1*vlen+v]))
-                    break;
-            }
-            if (v==vlen) /* duplicate */
-                break;
-        }
-        return i==i1?0:-1;
-    }
+    memset(tab, 0xff, len*sizeof(int)); /* -1 */
+    if (uc->uc_tab)
+        free(uc->uc_tab);
+    uc->uc_tab = tab;
+    uc->uc_tlen = len;
+    for (i=0; i<uc->uc_len; i++)
+        unique_tab_insert(uc, i);
+    return 0;
 }
 
-/*! Given a list with unique constraint, detect duplicates
- * @param[in]  x     The first element in the list (on return the last)
- * @param[in]  xt    The parent of x (a list)
- * @param[in]  y     Its yang spec (Y_LIST)
- * @param[in]  yu    A yang unique (Y_UNIQUE) for unique schema node ids or (Y_LIST) for list keys
- * @param[out] xret  Error XML tree. Free with xml_free after use
- * @retval     1     Validation OK
- * @retval     0     Validation failed (cbret set)
- * @retval    -1     Error
- * Discussion: the RFC 7950 Sec 7.8.3: "constraints on valid list entries"
- * The arguments are "descendant schema node identifiers". A direct interpretation is that
- * this is for "direct" descendants, but it does not rule out transient descendants.
- * The implementation supports two variants:
- * 1) list of direct descendants, eg "a b"
- * 2) single transient schema node identifier, eg "a/b"
- * The problem with combining (1) and (2) is that (2) results in a potential set of results, what
- * would unique "a/b c/d" mean if both a/b and c/d returns a set?
- * For (1):
- * All key leafs MUST be present for all list entries.
- * The combined values of all the leafs specified in the key are used to
- * uniquely identify a list entry.  All key leafs MUST be given values
- * when a list entry is created.
+/*! Add tuple of a list entry, check it is not a duplicate
+ *
+ * @param[in]  uc     Unique check
+ * @param[in]  tuple  Values of the entry, uc_clen values, copied
+ * @retval     1      OK, tuple is unique
+ * @retval     0      Duplicate
+ * @retval    -1      Error
  */
 static int
-check_unique_list_direct(cxobj     *x, 
-                         cxobj     *xt, 
-                         yang_stmt *y,
-                         yang_stmt *yu,
-                         cxobj    **xret)
+unique_check_add(struct unique_check *uc,
+                 char               **tuple)
 {
-    int       retval = -1;
-    cg_var    *cvi; /* unique node name */
-    cxobj     *xi;
-    char     **vec = NULL; /* 2xmatrix */
-    int        clen;
-    int        i;
-    int        v;
-    char      *bi;
-    int        sorted;
-    char      *str;
-    cvec      *cvk;
-
-    /* If list and is sorted by system, then it is assumed elements are in key-order which is optimized
-     * Other cases are "unique" constraint or list sorted by user which is quadratic in complexity
-     * This second case COULD be optimized if binary insert is made on the vec vector.
-     */
-    sorted = (yang_keyword_get(yu) == Y_LIST &&
-              yang_find(y, Y_ORDERED_BY, "user") == NULL);
-    cvk = yang_cvec_get(yu);
-    /* nr of unique elements to check */
-    if ((clen = cvec_len(cvk)) == 0){ 
-        /* No keys: no checks necessary */
-        goto ok;
+    char    **t;
+    uint32_t  h;
+    size_t    j;
+    int       i;
+
+    if (uc->uc_len == uc->uc_max){
+        uc->uc_max = uc->uc_max ? 2*uc->uc_max : UNIQUE_TAB_START;
+        if ((uc->uc_vec = realloc(uc->uc_vec, uc->uc_max*uc->uc_clen*sizeof(char*))) == NULL ||
+            (uc->uc_hash = realloc(uc->uc_hash, uc->uc_max*sizeof(uint32_t))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
     }
-    if ((vec = calloc(clen*xml_child_nr(xt), sizeof(char*))) == NULL){
-        clicon_err(OE_UNIX, errno, "calloc");
-        goto done;
+    if (uc->uc_sorted){
+        /* Just look at previous tuple to see if it is duplicate (sorted by system) */
+        if (uc->uc_len &&
+            unique_tuple_eq(&uc->uc_vec[(uc->uc_len-1)*uc->uc_clen], tuple, uc->uc_clen))
+            return 0;
     }
-    /* A vector is built with key-values, for each iteration check "backward" in the vector
-     * for duplicates
-     */
-    i = 0; /* x element index */
-    do {
-        cvi = NULL;
-        v = 0; /* index in each tuple */
-        /* XXX Quadratic if clen > 1 */
-        while ((cvi = cvec_each(cvk, cvi)) != NULL){
-            /* RFC7950: Sec 7.8.3.1: entries that do not have value for all
-             * referenced leafs are not taken into account */
-            str = cv_string_get(cvi);
-            if (index(str, '/') != NULL){
-                clicon_err(OE_YANG, 0, "Multiple descendant nodes not allowed (w /)");
-                goto done;
-            }
-            if ((xi = xml_find(x, str)) == NULL)
-                break;
-            if ((bi = xml_body(xi)) == NULL)
-                break;
-            vec[i*clen + v++] = bi;
-        }
-        if (cvi==NULL){
-            /* Last element (i) is newly inserted, see if it is already there */
-            if (check_insert_duplicate(vec, i, clen, sorted) < 0){
-                if (xret && netconf_data_not_unique_xml(xret, x, cvk) < 0)
-                    goto done;
-                goto fail;
-            }
-        }
-        x = xml_child_each(xt, x, CX_ELMNT);
-        i++;
-    } while (x && y == xml_spec(x));  /* stop if list ends, others may follow */
- ok:
-    /* It would be possible to cache vec here as an optimization */
-    retval = 1;
- done:
-    if (vec)
-        free(vec);
-    return retval;
- fail:
-    retval = 0;
-    goto done;
+    else {
+        if (2*(uc->uc_len+1) > uc->uc_tlen && unique_tab_grow(uc) < 0)
+            return -1;
+        h = unique_tuple_hash(tuple, uc->uc_clen);
+        for (j = h & (uc->uc_tlen-1); (i = uc->uc_tab[j]) != -1; j = (j+1) & (uc->uc_tlen-1))
+            if (uc->uc_hash[i] == h &&
+                unique_tuple_eq(&uc->uc_vec[i*uc->uc_clen], tuple, uc->uc_clen))
+                return 0;
+        uc->uc_hash[uc->uc_len] = h;
+    }
+    t = &uc->uc_vec[uc->uc_len*uc->uc_clen];
+    memcpy(t, tuple, uc->uc_clen*sizeof(char*));
+    if (!uc->uc_sorted)
+        unique_tab_insert(uc, uc->uc_len);
+    uc->uc_len++;
+    return 1;
 }
 
-/*! Given a list with unique constraint, detect duplicates
- * @param[in]  x     The first element in the list (on return the last)
- * @param[in]  xt    The parent of x (a list)
- * @param[in]  y     Its yang spec (Y_LIST)
- * @param[in]  yu    A yang unique (Y_UNIQUE) for unique schema node ids or (Y_LIST) for list keys
- * @param[out] xret  Error XML tree. Free with xml_free after use
- * @retval     1     Validation OK
- * @retval     0     Validation failed (xret set)
- * @retval    -1     Error
+/*! Initialize duplicate detection of keys or a unique constraint of a list
+ *
+ * @param[in]  uc   Unique check
+ * @param[in]  y    Yang spec of list (Y_LIST)
+ * @param[in]  yu   A yang unique (Y_UNIQUE) for unique schema node ids or (Y_LIST) for list keys
+ * @retval     1    OK
+ * @retval     0    Unique xpath could not be made canonical
+ * @retval    -1    Error
  * Discussion: the RFC 7950 Sec 7.8.3: "constraints on valid list entries"
  * The arguments are "descendant schema node identifiers". A direct interpretation is that
  * this is for "direct" descendants, but it does not rule out transient descendants.
@@ -312,213 +342,228 @@ check_unique_list_direct(cxobj     *x,
  * when a list entry is created.
  */
 static int
-check_unique_list(cxobj     *x, 
-                  cxobj     *xt, 
-                  yang_stmt *y,
-                  yang_stmt *yu,
-                  cxobj    **xret)
+unique_check_init(struct unique_check *uc,
+                  yang_stmt           *y,
+                  yang_stmt           *yu)
 {
-    int       retval = -1;
-    cg_var    *cvi; /* unique node name */
-    char     **svec = NULL; /* vector of search results */
-    size_t     slen = 0; 
-    char      *xpath0 = NULL;
-    char      *xpath1 = NULL;
-    int        ret;
-    cvec      *cvk;
-    cvec      *nsc0 = NULL;
-    cvec      *nsc1 = NULL;
-
-    /* Check if multiple direct children */
-    cvk = yang_cvec_get(yu);
-    if (cvec_len(cvk) > 1){
-        retval = check_unique_list_direct(x, xt, y, yu, xret);
-        goto done;
-    }
-    cvi = cvec_i(cvk, 0);
+    int     retval = -1;
+    cvec   *nsc0 = NULL;
+    char   *xpath0;
+    cg_var *cvi;
+    int     ret;
+
+    memset(uc, 0, sizeof(*uc));
+    uc->uc_yu = yu;
+    uc->uc_cvk = yang_cvec_get(yu);
+    /* nr of unique elements to check, no keys: no checks necessary */
+    if ((uc->uc_clen = cvec_len(uc->uc_cvk)) == 0)
+        goto ok;
+    /* If list and is sorted by system, then it is assumed elements are in key-order */
+    uc->uc_sorted = (yang_keyword_get(yu) == Y_LIST &&
+                     yang_find(y, Y_ORDERED_BY, "user") == NULL);
+    if (uc->uc_clen > 1)
+        goto ok;
+    cvi = cvec_i(uc->uc_cvk, 0);
     if (cvi == NULL || (xpath0 = cv_string_get(cvi)) == NULL){
         clicon_err(OE_YANG, 0, "No descendant schemanode");
         goto done;
     }
     /* Check if direct schmeanode-id , ie not xpath */
-    if (index(xpath0, '/') == NULL){ 
-        retval = check_unique_list_direct(x, xt, y, yu, xret);
-        goto done;
-    }
+    if (yang_keyword_get(yu) == Y_LIST || index(xpath0, '/') == NULL)
+        goto ok;
     /* Here proper xpath with at least one slash (can there be a descendant schemanodeid w/o slash?) */
     if (xml_nsctx_yang(yu, &nsc0) < 0)
         goto done;
     if ((ret = xpath2canonical(xpath0, nsc0, ys_spec(y),
-                               &xpath1, &nsc1, NULL)) < 0)
+                               &uc->uc_xpath, &uc->uc_nsc, NULL)) < 0)
         goto done;
     if (ret == 0)
         goto fail; // XXX set xret
-    do {
-        /* Collect search results from one */
-        if ((ret = unique_search_xpath(x, xpath1, nsc1, &svec, &slen)) < 0)
-            goto done;
-        if (ret == 0){
-            if (xret && netconf_data_not_unique_xml(xret, x, cvk) < 0)
-                goto done;
-            goto fail;
-        }
-        x = xml_child_each(xt, x, CX_ELMNT);
-    } while (x && y == xml_spec(x));  /* stop if list ends, others may follow */
-    // ok:
-    /* It would be possible to cache vec here as an optimization */
+ ok:
     retval = 1;
  done:
     if (nsc0)
         cvec_free(nsc0);
-    if (nsc1)
-        cvec_free(nsc1);
-    if (xpath1)
-        free(xpath1);
-    if (svec)
-        free(svec);
     return retval;
  fail:
     retval = 0;
     goto done;
 }
 
-/*! Given a list, check if any min/max-elemants constraints apply
+/*! Free state of unique check
+ */
+static void
+unique_check_free(struct unique_check *uc)
+{
+    if (uc->uc_xpath)
+        free(uc->uc_xpath);
+    if (uc->uc_nsc)
+        cvec_free(uc->uc_nsc);
+    if (uc->uc_vec)
+        free(uc->uc_vec);
+    if (uc->uc_tab)
+        free(uc->uc_tab);
+    if (uc->uc_hash)
+        free(uc->uc_hash);
+}
+
+/*! Add the tuple(s) of a list entry to a unique check
  *
- * @param[in]  xp    Parent of the xml list there are too few/many (for error)
- * @param[in]  y     Yang spec of the failing list
- * @param[in]  nr    Number of elements (like x) in the list
+ * If the check is a single xpath, all values selected by it are added, and they must be unique
+ * both in the entry and among entries.
+ * RFC7950: Sec 7.8.3.1: entries that do not have value for all referenced leafs are not taken
+ * into account
+ * @param[in]  uc    Unique check
+ * @param[in]  x     List entry
  * @param[out] xret  Error XML tree. Free with xml_free after use
- * @retval     1     Validation OK
- * @retval     0     Validation failed (cbret set)
+ * @retval     1     OK
+ * @retval     0     Duplicate (xret set)
  * @retval    -1     Error
- * @see RFC7950 7.7.5
- * @note No recurse for non-presence container is made, see eg xml_yang_minmax_recurse
  */
 static int
-check_minmax(cxobj     *xp,
-             yang_stmt *y,
-             int        nr,
-             cxobj     **xret)
+unique_check_entry(struct unique_check *uc,
+                   cxobj               *x,
+                   cxobj              **xret)
 {
-    int         retval = -1;
-    yang_stmt  *ymin; /* yang min */
-    yang_stmt  *ymax; /* yang max */
-    cg_var     *cv;
-    
-    if ((ymin = yang_find(y, Y_MIN_ELEMENTS, NULL)) != NULL){
-        cv = yang_cv_get(ymin);
-        if (nr < cv_uint32_get(cv)){
-            if (xret && netconf_minmax_elements_xml(xret, xp, yang_argument_get(y), 0) < 0)
+    int      retval = -1;
+    cxobj  **xvec = NULL;
+    size_t   xveclen;
+    char   **tuple = NULL;
+    cg_var  *cvi;
+    cxobj   *xi;
+    char    *str;
+    size_t   i;
+    int      v;
+    int      ret;
+
+    if (uc->uc_clen == 0)
+        goto ok;
+    if (uc->uc_xpath){
+        /* Collect tuples */
+        if (xpath_vec(x, uc->uc_nsc, "%s", &xvec, &xveclen, uc->uc_xpath) < 0)
+            goto done;
+        for (i=0; i<xveclen; i++){
+            if ((str = xml_body(xvec[i])) == NULL)
+                break;
+            if ((ret = unique_check_add(uc, &str)) < 0)
                 goto done;
-            goto fail;
+            if (ret == 0)
+                goto fail;
         }
+        goto ok;
     }
-    if ((ymax = yang_find(y, Y_MAX_ELEMENTS, NULL)) != NULL){
-        cv = yang_cv_get(ymax);
-        if (cv_uint32_get(cv) > 0 && /* 0 means unbounded */
-            nr > cv_uint32_get(cv)){
-            if (xret && netconf_minmax_elements_xml(xret, xp, yang_argument_get(y), 1) < 0)
-                goto done;
-            goto fail;
+    if ((tuple = malloc(uc->uc_clen*sizeof(char*))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    cvi = NULL;
+    v = 0; /* index in each tuple */
+    while ((cvi = cvec_each(uc->uc_cvk, cvi)) != NULL){
+        str = cv_string_get(cvi);
+        if (index(str, '/') != NULL){
+            clicon_err(OE_YANG, 0, "Multiple descendant nodes not allowed (w /)");
+            goto done;
         }
+        if ((xi = xml_find(x, str)) == NULL)
+            goto ok;
+        if ((tuple[v++] = xml_body(xi)) == NULL)
+            goto ok;
     }
+    if ((ret = unique_check_add(uc, tuple)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+ ok:
     retval = 1;
  done:
+    if (tuple)
+        free(tuple);
+    if (xvec)
+        free(xvec);
     return retval;
  fail:
+    if (xret && netconf_data_not_unique_xml(xret, x, uc->uc_cvk) < 0)
+        goto done;
     retval = 0;
     goto done;
 }
 
-/*! Check if there is any empty list (no x elements) and check min-elements
- * Note recurse for non-presence container 
- * @param[in]  xt    XML node
- * @param[in]  yt    YANG node
+/*! Check keys and unique constraints of a list and count its entries, in one pass
+ *
+ * @param[in]  x     The first element in the list
+ * @param[in]  xt    The parent of x
+ * @param[in]  y     Its yang spec (Y_LIST)
+ * @param[out] nr    Number of entries in the list
+ * @param[out] xlast The last element in the list
  * @param[out] xret  Error XML tree. Free with xml_free after use
  * @retval     1     Validation OK
  * @retval     0     Validation failed (xret set)
  * @retval    -1     Error
  */
-static int
-check_empty_list_minmax(cxobj     *xt,
-                        yang_stmt *ye,
-                        cxobj    **xret)
-{
-    int        retval = -1;
-    int        ret;
-    yang_stmt *yprev = NULL;
-
-    if (yang_config(ye) == 1){
-        if(yang_keyword_get(ye) == Y_CONTAINER &&
-           yang_find(ye, Y_PRESENCE, NULL) == NULL){
-            yprev = NULL;
-            while ((yprev = yn_each(ye, yprev)) != NULL) {
-                if ((ret = check_empty_list_minmax(xt, yprev, xret)) < 0)
-                    goto done;
-                if (ret == 0)
-                    goto fail;
-            }
-        }
-        else if (yang_keyword_get(ye) == Y_LIST ||
-                 yang_keyword_get(ye) == Y_LEAF_LIST){
-            /* Check if the list length violates min/max */
-            if ((ret = check_minmax(xt, ye, 0, xret)) < 0)
-                goto done;
-            if (ret == 0)
-                goto fail;
-        }
-    }
-    retval = 1;
- done:
-    return retval;
- fail:
-    retval = 0;
-    goto done;
-}
-
 static int
 xml_yang_minmax_newlist(cxobj     *x,
                         cxobj     *xt,
                         yang_stmt *y,
+                        int       *nr,
+                        cxobj    **xlast,
                         cxobj    **xret)
 {
-    int        retval = -1;
-    yang_stmt *yu;
-    int        ret;
-    
-    /* Here new (first element) of lists only
-     * First check unique keys direct children
-     */
-    if ((ret = check_unique_list_direct(x, xt, y, y, xret)) < 0)
+    int                  retval = -1;
+    yang_stmt           *yu;
+    struct unique_check *ucvec = NULL;
+    int                  uclen = 1;
+    int                  i;
+    int                  n = 0;
+    int                  ret;
+
+    /* Keys, and unique constraints on the list */
+    yu = NULL;
+    while ((yu = yn_each(y, yu)) != NULL)
+        if (yang_keyword_get(yu) == Y_UNIQUE)
+            uclen++;
+    if ((ucvec = calloc(uclen, sizeof(*ucvec))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    uclen = 0;
+    if ((ret = unique_check_init(&ucvec[uclen++], y, y)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
-    /* Check if there is a unique constraint on the list
-     */
     yu = NULL;
     while ((yu = yn_each(y, yu)) != NULL) {
         if (yang_keyword_get(yu) != Y_UNIQUE)
             continue;
-        /* Here is a list w unique constraints identified by:
-         * its first element x, its yang spec y, its parent xt, and 
-         * a unique yang spec yu,
-         * Two cases: 
-         * 1) multiple direct children (no prefixes), eg "a b"
-         * 2) single xpath with canonical prefixes, eg "/ex:a/ex:b"
-         */
-        if ((ret = check_unique_list(x, xt, y, yu, xret)) < 0)
+        if ((ret = unique_check_init(&ucvec[uclen++], y, yu)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
     }
+    do {
+        for (i=0; i<uclen; i++){
+            if ((ret = unique_check_entry(&ucvec[i], x, xret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+        n++;
+        *xlast = x;
+        x = xml_child_each(xt, x, CX_ELMNT);
+    } while (x && y == xml_spec(x));  /* stop if list ends, others may follow */
+    *nr = n;
     retval = 1;
  done:
+    if (ucvec){
+        for (i=0; i<uclen; i++)
+            unique_check_free(&ucvec[i]);
+        free(ucvec);
+    }
     return retval;
  fail:
     retval = 0;
     goto done;
 }
-    
+
 /*! Perform gap analysis in a child-vector interval [ye,y]
  *
  * Gap analysis here meaning if there is a list x with min-element constraint but there are no
@@ -591,7 +636,7 @@ xml_yang_minmax_gap_analysis(cxobj      *xt,
  * xml symbols share yang symbols: ie [x1..] has yang y1 and d has yd.
  *
  * Unique constraints:
- * Lists are identified, then check_unique_list is called on each list.
+ * Lists are identified, then xml_yang_minmax_newlist checks each list in one pass.
  * Example, x has an associated yang list node with list of unique constraints
  *         y-list->y-unique - "a"
  *      xt->x ->  ab
@@ -681,10 +726,10 @@ xml_yang_minmax_recurse(cxobj  *xt,
                     goto done;
             }
             nr=1;
-            /* new list check */
+            /* new list check, continue after the list */
             if (ret &&
                 keyw == Y_LIST)
-                if ((ret = xml_yang_minmax_newlist(x, xt, y, xret)) < 0)
+                if ((ret = xml_yang_minmax_newlist(x, xt, y, &nr, &x, xret)) < 0)
                     goto done;
             if (ret == 0)
                 goto fail;
@@ -714,13 +759,10 @@ xml_yang_minmax_recurse(cxobj  *xt,
                 goto fail;
             if (recurse && keyw == Y_CONTAINER &&
                 yang_find(y, Y_PRESENCE, NULL) == NULL){
-                yang_stmt *yc = NULL;
-                while ((yc = yn_each(y, yc)) != NULL) {
-                    if ((ret = xml_yang_minmax_recurse(x, recurse, xret)) < 0)
-                        goto done;
-                    if (ret == 0)
-                        goto fail;
-                }               
+                if ((ret = xml_yang_minmax_recurse(x, recurse, xret)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
             }
             yprev = y;    
         }           
@@ -60,6 +60,7 @@
 /* clixon */
 #include "clixon_err.h"
 #include "clixon_string.h"
+#include "clixon_pool.h"
 #include "clixon_queue.h"
 #include "clixon_hash.h"
 #include "clixon_handle.h"
@@ -74,6 +75,10 @@
 #include "clixon_xml_io.h"
 #include "clixon_xml_parse.h"
 #include "clixon_xml_nsctx.h"
+#include "clixon_xml_index.h"
+#include "clixon_xml_order.h"
+#include "clixon_xml_key.h"
+#include "clixon_event.h"
 
 /*
  * Constants
@@ -87,6 +92,23 @@
 #define XML_CHILDVEC_SIZE_START_ELMNT 16 
 #define XML_CHILDVEC_SIZE_THRESHOLD 65536
 
+/* Size of inline value storage of body and attribute nodes, including null termination. 
+ * Longer values are allocated from heap, see struct xmlbody
+ */
+#define XML_VALUE_INLINE 16
+
+/* Value size xb_vmax of a shared value, see struct xml_value_shared and XML_VALUE_SHARE
+ */
+#define XML_VALUE_SHARED UINT32_MAX
+
+/* Default size of an arena slab, see xml_new_arena.
+ * Allocations larger than a quarter of a slab get a dedicated slab
+ */
+#define XML_ARENA_SLABSIZE 65536
+
+/* Alignment of arena allocations */
+#define XML_ARENA_ALIGN(sz) (((sz) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
 /* Intention of these macros is to guard against access of type-specific fields 
  * As debug they can contain an assert.
  */
@@ -99,6 +121,10 @@
 
 #ifdef XML_EXPLICIT_INDEX
 static int xml_search_index_free(cxobj *x);
+static struct search_index *xml_search_index_get(cxobj *x, char *name);
+static int xml_search_child_update(cxobj *xp, cxobj *xc, int add);
+static int xml_search_value_pre(cxobj *xb, cxobj **xip);
+static int xml_search_child_insert1(cxobj *xpp, cxobj *xp, cxobj *xi, int create);
 
 /* A search index pair consisting of a name of an (index) variable and a vector of xml children
  * the variable should be a potential child of the XML node
@@ -126,6 +152,68 @@ struct search_index{
 };
 #endif
 
+/*! A single contiguous arena memory slab, allocated by bumping xs_used
+ */
+struct xml_slab{
+    struct xml_slab *xs_next;  /* Next slab in arena */
+    size_t           xs_size;  /* Size of xs_data */
+    size_t           xs_used;  /* Bytes used of xs_data */
+    char             xs_data[];
+};
+
+/*! Arena tied to an XML tree, nodes are allocated from slabs
+ *
+ * The arena is freed when the last node allocated from it is freed, which means that
+ * nodes moved to other trees keep it alive.
+ * Each arena node is preceeded by a pointer to its arena:
+ *
+ *   +-----+-------------+-----+----------------+-----
+ *   | xa  | struct xml  | xa  | struct xmlbody | ...
+ *   +-----+-------------+-----+----------------+-----
+ * @see xml_new_arena
+ */
+struct xml_arena{
+    struct xml_slab *xa_slabs;    /* List of slabs, first is current */
+    size_t           xa_slabsize; /* Size of ordinary slabs */
+    uint64_t         xa_nodes;    /* Number of live nodes allocated from arena */
+    uint64_t         xa_slabnr;   /* Number of slabs */
+    size_t           xa_size;     /* Total allocated slab memory */
+    size_t           xa_used;     /* Slab memory used */
+};
+
+/*! Rarely used fields of an XML element, allocated on demand
+ *
+ * Kept apart from struct xml to keep the size of the common node small
+ * @see xml_ext_get
+ */
+struct xml_ext{
+#ifdef XML_PARENT_CANDIDATE
+    struct xml       *xe_up_candidate; /* Candidate parent node for special cases (when+xpath) */
+#endif
+    cvec             *xe_ns_cache;   /* Cached vector of namespaces (set by bind-yang) */
+    cg_var           *xe_cv;         /* Typed value as cligen variable, see xml_bind_value */
+    cvec             *xe_creators;   /* Support clixon-lib creator annotation */
+#ifdef XML_EXPLICIT_INDEX
+    struct search_index *xe_search_index; /* explicit search index vectors */
+#endif
+#ifdef XML_KEY_INDEX
+    struct xml_key_index *xe_key_index;   /* hash indexes of list children on keys */
+#endif
+#ifdef XML_ORDER_INDEX
+    struct xml_order_index *xe_order_index; /* order indexes of ordered-by user children */
+#endif
+#ifdef XML_KEY_ENCODE
+    struct xml_key_cache *xe_key;   /* encoded key of list entry, see xml_key_encode */
+#endif
+    char             *xe_lazy;       /* Unparsed content of anydata, see xml_lazy */
+};
+
+/*! Parse unparsed content of element before its children are accessed, see xml_lazy */
+#define XML_LAZY_EXPAND(x) do {                                         \
+        if ((x)->x_ext && (x)->x_ext->xe_lazy)                          \
+            (void)xml_lazy_expand(x);                                   \
+    } while (0)
+
 /*! xml tree node, with name, type, parent, children, etc 
  * Note that this is a private type not visible from externally, use
  * access functions.
@@ -165,29 +253,29 @@ struct xml{
     char             *x_name;       /* name of node */
     char             *x_prefix;     /* namespace localname N, called prefix */
     uint16_t          x_flags;      /* Flags according to XML_FLAG_* */
+    uint8_t           x_arena;      /* Internal: allocated from arena, see xml_new_arena */
+    uint16_t          x_subflags;   /* Flags set in some descendant, see xml_flag_sub */
+    uint16_t          x_nsid;       /* Namespace id of own prefix if bound, see xml_nsid_set */
     struct xml       *x_up;         /* parent node in hierarchy if any */
-#ifdef XML_PARENT_CANDIDATE
-    struct xml       *x_up_candidate; /* Candidate parent node for special cases (when+xpath) */
-#endif
-    int              _x_vector_i;   /* internal use: xml_child_each */
+    int              _x_vector_i;   /* internal use: xml_child_each position hint */
     int              _x_i;          /* internal use for stable sorting: 
                                        see xml_enumerate and xml_cmp */
-    /*----- next is body/attribute only */
-    cbuf             *x_value_cb;  /* attribute and body nodes have values (XXX: this consumes 
-                                       memory) cv? */
-    /*----- up to here is common to all next is element only */
+    /*----- up to here is common to all next is element only, see struct xmlbody */
     struct xml      **x_childvec;   /* vector of children nodes (XXX: use clixon_vec ) */
     int               x_childvec_len;/* Number of children */
     int               x_childvec_max;/* Length of allocated vector */
-
-    cvec             *x_ns_cache;   /* Cached vector of namespaces (set by bind-yang) */
     yang_stmt        *x_spec;       /* Pointer to specification, eg yang, 
                                        by reference, dont free */
-    cg_var           *x_cv;         /* Cached value as cligen variable (set by xml_cmp) */
-    cvec             *x_creators;   /* Support clixon-lib creator annotation */
-#ifdef XML_EXPLICIT_INDEX
-    struct search_index *x_search_index; /* explicit search index vectors */
-#endif
+    struct xml_ext   *x_ext;        /* Rarely used fields, allocated on demand */
+};
+
+/* Immutable value shared by copies of body and attribute nodes, see XML_VALUE_SHARE
+ * Copied to the heap of a node when the node value is changed
+ */
+struct xml_value_shared{
+    uint32_t          xv_refs;       /* Number of nodes sharing the value */
+    uint32_t          xv_hash;       /* FNV-1a hash of value, 0 if not computed */
+    char              xv_data[];     /* Null-terminated value */
 };
 
 /* Variant of struct xml for use by non-elements to save space
@@ -198,16 +286,30 @@ struct xmlbody{
     char             *xb_name;       /* name of node */
     char             *xb_prefix;     /* namespace localname N, called prefix */
     uint16_t          xb_flags;      /* Flags according to XML_FLAG_* */
+    uint8_t           xb_arena;      /* Internal: allocated from arena, see xml_new_arena */
+    uint16_t          xb_subflags;   /* Always 0, same layout as struct xml */
+    uint16_t          xb_nsid;       /* Always 0, same layout as struct xml */
     struct xml       *xb_up;         /* parent node in hierarchy if any */
-#ifdef XML_PARENT_CANDIDATE
-    struct xml       *xb_up_candidate; /* Candidate parent node for special cases (when+xpath) */
-#endif
     int              _xb_vector_i;   /* internal use: xml_child_each */
     int              _xb_i;          /* internal use for sorting: 
                                        see xml_enumerate and xml_cmp */
-    cbuf             *xb_value_cb;  /* attribute and body nodes have values */
+    /*----- up to here is common to all next is body/attribute only */
+    uint32_t          xb_vlen;       /* Length of value, excluding null */
+    uint32_t          xb_vmax;       /* Allocated value size: 0 if no value, XML_VALUE_INLINE
+                                      * if inline, XML_VALUE_SHARED if shared, otherwise heap */
+    union {
+        char          xb_inline[XML_VALUE_INLINE]; /* Short values are stored inline */
+        char         *xb_heap;                     /* Long values are allocated */
+        struct xml_value_shared *xb_shared;        /* Large copied values are shared */
+    } xb_u;
 };
 
+/*! Access rarely used fields of an XML element, or NULL if not allocated */
+#define XE(x, f) ((x)->x_ext ? (x)->x_ext->f : NULL)
+
+/*! Access body/attribute fields of an XML node */
+#define XB(x) ((struct xmlbody *)(x))
+
 /*
  * Variables
  */
@@ -233,6 +335,10 @@ xml_type2str(enum cxobj_type type)
 
 /* Stats (too low-level to hang it on handle) */
 static uint64_t _stats_xml_nr = 0;
+static uint64_t _stats_arena_nr = 0;     /* Number of existing arenas */
+static uint64_t _stats_arena_slabnr = 0; /* Number of existing arena slabs */
+static size_t   _stats_arena_size = 0;   /* Total size of arena slabs */
+static uint64_t _stats_ext_nr = 0;       /* Number of existing element extensions */
 
 /*! Get global statistics about XML objects
  *
@@ -246,46 +352,240 @@ xml_stats_global(uint64_t *nr)
     return 0;
 }
 
+/*! Get global statistics about XML arenas
+ *
+ * @param[out]  nrp     Number of existing arenas
+ * @param[out]  slabnrp Number of existing arena slabs
+ * @param[out]  szp     Total memory of arena slabs
+ * @see xml_stats_arena  for a single arena
+ */
+int
+xml_stats_arena_global(uint64_t *nrp,
+                       uint64_t *slabnrp,
+                       size_t   *szp)
+{
+    if (nrp)
+        *nrp = _stats_arena_nr;
+    if (slabnrp)
+        *slabnrp = _stats_arena_slabnr;
+    if (szp)
+        *szp = _stats_arena_size;
+    return 0;
+}
+
+/*
+ * Arena functions
+ */
+/*! Get arena of an arena-allocated XML node
+ */
+#define XML_ARENA(x) (((struct xml_arena **)(x))[-1])
+
+/*! Create a new arena
+ * @param[in]  slabsize  Size of ordinary slabs, 0 means default
+ * @retval     xa        Arena
+ * @retval     NULL      Error
+ */
+static struct xml_arena *
+xml_arena_new(size_t slabsize)
+{
+    struct xml_arena *xa;
+
+    if ((xa = malloc(sizeof(*xa))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return NULL;
+    }
+    memset(xa, 0, sizeof(*xa));
+    xa->xa_slabsize = slabsize?slabsize:XML_ARENA_SLABSIZE;
+    __atomic_add_fetch(&_stats_arena_nr, 1, __ATOMIC_RELAXED);
+    return xa;
+}
+
+/*! Free an arena and all its slabs
+ * @param[in]  xa   Arena
+ */
+static int
+xml_arena_free(struct xml_arena *xa)
+{
+    struct xml_slab *xs;
+
+    while ((xs = xa->xa_slabs) != NULL){
+        xa->xa_slabs = xs->xs_next;
+        /* Ordinary slabs are recycled for later short-lived trees */
+        if (xs->xs_size == XML_ARENA_SLABSIZE)
+            clixon_block_put(xs, sizeof(struct xml_slab) + xs->xs_size);
+        else
+            free(xs);
+    }
+    __atomic_sub_fetch(&_stats_arena_slabnr, xa->xa_slabnr, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&_stats_arena_size, xa->xa_size, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&_stats_arena_nr, 1, __ATOMIC_RELAXED);
+    free(xa);
+    return 0;
+}
+
+/*! Allocate memory from arena, the memory is freed when the arena is freed
+ * @param[in]  xa   Arena
+ * @param[in]  sz   Size of memory
+ * @retval     p    Allocated memory (not zeroed)
+ * @retval     NULL Error
+ */
+static void *
+xml_arena_alloc(struct xml_arena *xa,
+                size_t            sz)
+{
+    struct xml_slab *xs;
+    size_t           slabsz;
+    void            *p;
+
+    sz = XML_ARENA_ALIGN(sz);
+    xs = xa->xa_slabs;
+    if (xs == NULL || xs->xs_used + sz > xs->xs_size){
+        /* Large allocations get a dedicated slab placed after the current */
+        slabsz = (sz > xa->xa_slabsize/4) ? sz : xa->xa_slabsize;
+        if ((xs = clixon_block_get(sizeof(struct xml_slab) + slabsz)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        xs->xs_size = slabsz;
+        xs->xs_used = 0;
+        if (slabsz != xa->xa_slabsize && xa->xa_slabs){
+            xs->xs_next = xa->xa_slabs->xs_next;
+            xa->xa_slabs->xs_next = xs;
+        }
+        else {
+            xs->xs_next = xa->xa_slabs;
+            xa->xa_slabs = xs;
+        }
+        xa->xa_slabnr++;
+        xa->xa_size += slabsz;
+        __atomic_add_fetch(&_stats_arena_slabnr, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&_stats_arena_size, slabsz, __ATOMIC_RELAXED);
+    }
+    p = &xs->xs_data[xs->xs_used];
+    xs->xs_used += sz;
+    xa->xa_used += sz;
+    return p;
+}
+
+/*! Get statistics of the arena an XML node is allocated from
+ *
+ * @param[in]   x       XML node
+ * @param[out]  nodesp  Number of live nodes allocated from arena
+ * @param[out]  slabnrp Number of slabs
+ * @param[out]  szp     Allocated slab memory
+ * @param[out]  usedp   Used slab memory
+ * @retval      1       OK, x is allocated from arena
+ * @retval      0       x is not allocated from an arena
+ * @see xml_stats_arena_global
+ */
+int
+xml_stats_arena(cxobj    *x,
+                uint64_t *nodesp,
+                uint64_t *slabnrp,
+                size_t   *szp,
+                size_t   *usedp)
+{
+    struct xml_arena *xa;
+
+    if (x == NULL || !x->x_arena)
+        return 0;
+    xa = XML_ARENA(x);
+    if (nodesp)
+        *nodesp = xa->xa_nodes;
+    if (slabnrp)
+        *slabnrp = xa->xa_slabnr;
+    if (szp)
+        *szp = xa->xa_size;
+    if (usedp)
+        *usedp = xa->xa_used;
+    return 1;
+}
+
+/*! Get size of XML node structs and number of element extensions
+ *
+ * Use together with xml_stats() to get the bytes per node of a tree
+ * @param[out]  elmntp  Size of an element node, excluding child vector and extension
+ * @param[out]  bodyp   Size of a body or attribute node, excluding long values
+ * @param[out]  extp    Size of an element extension, holding rarely used fields
+ * @param[out]  extnrp  Number of existing element extensions
+ * @retval      0       OK
+ */
+int
+xml_stats_nodesize(size_t   *elmntp,
+                   size_t   *bodyp,
+                   size_t   *extp,
+                   uint64_t *extnrp)
+{
+    if (elmntp)
+        *elmntp = sizeof(struct xml);
+    if (bodyp)
+        *bodyp = sizeof(struct xmlbody);
+    if (extp)
+        *extp = sizeof(struct xml_ext);
+    if (extnrp)
+        *extnrp = _stats_ext_nr;
+    return 0;
+}
+
 /*! Return the alloced memory of a single XML obj 
  * @param[in]   x    XML object
  * @param[out]  szp  Size of this XML obj
  * @retval      0    OK
- * (baseline: 96 bytes per object on x86-64)
+ * (baseline: 80 bytes per element and 72 bytes per body on x86-64)
  */
 static int
 xml_stats_one(cxobj    *x,
               size_t   *szp)
 {
-    size_t sz = 0;
+    size_t          sz = 0;
+    struct xml_ext *xe;
 
-    if (x->x_name)
-        sz += strlen(x->x_name) + 1;
-    if (x->x_prefix)
-        sz += strlen(x->x_prefix) + 1;
+    if (x->x_arena)
+        sz += sizeof(struct xml_arena *);
+    /* Names and prefixes are interned and shared, see clixon_string_intern_stats */
     switch (xml_type(x)){
     case CX_ELMNT:
         sz += sizeof(struct xml);
         sz += x->x_childvec_max*sizeof(struct xml*);
-        if (x->x_ns_cache)
-            sz += cvec_size(x->x_ns_cache);
-        if (x->x_cv)
-            sz += cv_size(x->x_cv);
+        if ((xe = x->x_ext) == NULL)
+            break;
+        sz += sizeof(struct xml_ext);
+        if (xe->xe_ns_cache)
+            sz += cvec_size(xe->xe_ns_cache);
+        if (xe->xe_cv)
+            sz += cv_size(xe->xe_cv);
 #ifdef XML_EXPLICIT_INDEX
-        if (x->x_search_index){
+        if (xe->xe_search_index){
             /* XXX: only one */
             sz += sizeof(struct search_index);
-            if (x->x_search_index->si_name)
-                sz += strlen(x->x_search_index->si_name)+1;
-            if (x->x_search_index->si_xvec)
-                sz += clixon_xvec_len(x->x_search_index->si_xvec)*sizeof(struct cxobj*);
+            if (xe->xe_search_index->si_name)
+                sz += strlen(xe->xe_search_index->si_name)+1;
+            if (xe->xe_search_index->si_xvec)
+                sz += clixon_xvec_len(xe->xe_search_index->si_xvec)*sizeof(struct cxobj*);
         }
 #endif
+#ifdef XML_KEY_INDEX
+        if (xe->xe_key_index)
+            sz += xml_key_index_size(x);
+#endif
+#ifdef XML_ORDER_INDEX
+        if (xe->xe_order_index)
+            sz += xml_order_index_size(x);
+#endif
+#ifdef XML_KEY_ENCODE
+        if (xe->xe_key)
+            sz += sizeof(struct xml_key_cache) + xe->xe_key->kc_len;
+#endif
+        if (xe->xe_lazy)
+            sz += strlen(xe->xe_lazy) + 1;
         break;
     case CX_BODY:
     case CX_ATTR:
         sz += sizeof(struct xmlbody);
-        if (x->x_value_cb)
-            sz += cbuf_buflen(x->x_value_cb);
+        if (XB(x)->xb_vmax == XML_VALUE_SHARED)
+            sz += sizeof(struct xml_value_shared) + XB(x)->xb_vlen + 1;
+        else if (XB(x)->xb_vmax > XML_VALUE_INLINE)
+            sz += XB(x)->xb_vmax;
         break;
     default:
         break;
@@ -319,8 +619,8 @@ xml_stats(cxobj    *xt,
     xml_stats_one(xt, &sz);
     if (szp)
         *szp += sz;
-    xc = NULL;
-    while ((xc = xml_child_each(xt, xc, -1)) != NULL) {
+    xc = NULL; /* Unparsed content is counted in xml_stats_one */
+    while ((xc = xml_child_each(xt, xc, xml_lazy(xt) ? CX_ATTR : -1)) != NULL) {
         sz=0;
         xml_stats(xc, nrp, &sz);
         if (szp)
@@ -331,9 +631,335 @@ xml_stats(cxobj    *xt,
     return retval;
 }
 
+/*! Shrink memory of a single XML obj
+ *
+ * @param[in]  x    XML object
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_compact
+ */
+static int
+xml_compact_one(cxobj *x)
+{
+    struct xml_ext *xe;
+    struct xmlbody *xb;
+    cxobj         **cv;
+    char           *p;
+
+    switch (xml_type(x)){
+    case CX_ELMNT:
+        /* Child vectors grow by doubling, shrink if more than half is unused */
+        if (x->x_childvec_max > 2*x->x_childvec_len + XML_CHILDVEC_SIZE_START_ELMNT){
+            if (x->x_childvec_len == 0){
+                free(x->x_childvec);
+                x->x_childvec = NULL;
+            }
+            else {
+                if ((cv = realloc(x->x_childvec, x->x_childvec_len*sizeof(cxobj*))) == NULL){
+                    clicon_err(OE_XML, errno, "realloc");
+                    return -1;
+                }
+                x->x_childvec = cv;
+            }
+            x->x_childvec_max = x->x_childvec_len;
+        }
+        if ((xe = x->x_ext) == NULL)
+            break;
+        /* Cached values and namespace contexts are recomputed on demand, typed values
+         * bound to yang are kept */
+        if (xe->xe_cv && !xml_cv_native(cv_type_get(xe->xe_cv))){
+            cv_free(xe->xe_cv);
+            xe->xe_cv = NULL;
+        }
+        if (xe->xe_ns_cache){
+            xml_nsctx_free(xe->xe_ns_cache);
+            xe->xe_ns_cache = NULL;
+        }
+        /* Indexes are created on demand above their thresholds */
+#ifdef XML_KEY_INDEX
+        if (xe->xe_key_index && x->x_childvec_len < XML_KEY_INDEX_THRESHOLD &&
+            xml_key_index_free(x) < 0)
+            return -1;
+#endif
+#ifdef XML_ORDER_INDEX
+        if (xe->xe_order_index && x->x_childvec_len < XML_ORDER_INDEX_THRESHOLD &&
+            xml_order_index_free(x) < 0)
+            return -1;
+#endif
+        if (xe->xe_creators == NULL && xe->xe_lazy == NULL
+#ifdef XML_PARENT_CANDIDATE
+            && xe->xe_up_candidate == NULL
+#endif
+#ifdef XML_EXPLICIT_INDEX
+            && xe->xe_search_index == NULL
+#endif
+#ifdef XML_KEY_INDEX
+            && xe->xe_key_index == NULL
+#endif
+#ifdef XML_ORDER_INDEX
+            && xe->xe_order_index == NULL
+#endif
+#ifdef XML_KEY_ENCODE
+            && xe->xe_key == NULL
+#endif
+            ){
+            free(xe);
+            x->x_ext = NULL;
+            __atomic_sub_fetch(&_stats_ext_nr, 1, __ATOMIC_RELAXED);
+        }
+        break;
+    case CX_BODY:
+    case CX_ATTR:
+        xb = XB(x);
+        /* Value storage grows by doubling, move short values inline */
+        if (xb->xb_vmax <= XML_VALUE_INLINE || xb->xb_vmax == XML_VALUE_SHARED ||
+            xb->xb_vlen + 1 == xb->xb_vmax)
+            break;
+        p = xb->xb_u.xb_heap;
+        if (xb->xb_vlen < XML_VALUE_INLINE){
+            memcpy(xb->xb_u.xb_inline, p, xb->xb_vlen+1);
+            free(p);
+            xb->xb_vmax = XML_VALUE_INLINE;
+        }
+        else {
+            if ((p = realloc(p, xb->xb_vlen+1)) == NULL){
+                clicon_err(OE_XML, errno, "realloc");
+                return -1;
+            }
+            xb->xb_u.xb_heap = p;
+            xb->xb_vmax = xb->xb_vlen+1;
+        }
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*! Shrink memory of an XML tree recursively, eg after large deletes
+ *
+ * Oversized child vectors and values are shrunk, cached values and namespace contexts
+ * are freed, and key and order indexes of parents below their thresholds are freed.
+ * The tree is otherwise unchanged.
+ * @param[in]     xt   XML tree
+ * @param[in,out] szp  Reclaimed bytes are added, as computed by xml_stats
+ * @retval        0    OK
+ * @retval       -1    Error
+ */
+int
+xml_compact(cxobj  *xt,
+            size_t *szp)
+{
+    size_t sz0 = 0;
+    size_t sz1 = 0;
+    cxobj *xc;
+
+    if (xt == NULL){
+        clicon_err(OE_XML, EINVAL, "xml node is NULL");
+        return -1;
+    }
+    xml_stats_one(xt, &sz0);
+    if (xml_compact_one(xt) < 0)
+        return -1;
+    xml_stats_one(xt, &sz1);
+    if (szp && sz0 > sz1)
+        *szp += sz0 - sz1;
+    xc = NULL;
+    while ((xc = xml_child_each(xt, xc, xml_lazy(xt) ? CX_ATTR : -1)) != NULL)
+        if (xml_compact(xc, szp) < 0)
+            return -1;
+    return 0;
+}
+
 /*
  * Access functions
  */
+/*! Get rarely used fields of an XML element, allocate if not present
+ *
+ * @param[in]  x    XML element
+ * @retval     xe   Extension struct of x
+ * @retval     NULL Error
+ */
+static struct xml_ext *
+xml_ext_get(cxobj *x)
+{
+    if (x->x_ext == NULL){
+        if ((x->x_ext = malloc(sizeof(struct xml_ext))) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        memset(x->x_ext, 0, sizeof(struct xml_ext));
+        /* Atomic since extensions are created by sort threads, see xml_sort_recurse_parallel */
+        __atomic_add_fetch(&_stats_ext_nr, 1, __ATOMIC_RELAXED);
+    }
+    return x->x_ext;
+}
+
+#ifdef XML_KEY_INDEX
+/*! Get hash key indexes of list children of an XML node
+ *
+ * @param[in]  xp   XML parent node
+ * @retval     ki   First key index
+ * @retval     NULL No key index
+ * @see clixon_xml_index.c
+ */
+struct xml_key_index *
+xml_key_index_get(cxobj *xp)
+{
+    if (!is_element(xp))
+        return NULL;
+    return XE(xp, xe_key_index);
+}
+
+/*! Set hash key indexes of list children of an XML node
+ *
+ * @param[in]  xp   XML parent node
+ * @param[in]  ki   First key index, or NULL to unset
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xml_key_index_set(cxobj                *xp,
+                  struct xml_key_index *ki)
+{
+    struct xml_ext *xe;
+
+    if (!is_element(xp))
+        return 0;
+    if (ki == NULL && xp->x_ext == NULL)
+        return 0;
+    if ((xe = xml_ext_get(xp)) == NULL)
+        return -1;
+    xe->xe_key_index = ki;
+    return 0;
+}
+
+/*! Notify key index of parent or grand-parent that child xc of x has changed
+ *
+ * Either x is a list entry and xc a key leaf, or x is a key leaf and xc its body
+ * @param[in]  x    XML node whose children or value has changed
+ * @param[in]  xc   Changed child of x
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_key_index_notify(cxobj *x,
+                     cxobj *xc)
+{
+    cxobj *xe;
+    cxobj *xp;
+
+    if ((xe = x->x_up) == NULL)
+        return 0;
+    if (XE(xe, xe_key_index) != NULL &&
+        xml_key_index_changed(xe, x, xc) < 0)
+        return -1;
+    if ((xp = xe->x_up) != NULL && XE(xp, xe_key_index) != NULL &&
+        xml_key_index_changed(xp, xe, x) < 0)
+        return -1;
+    return 0;
+}
+#endif /* XML_KEY_INDEX */
+
+#ifdef XML_KEY_ENCODE
+/*! Get cached encoded key of a list entry or leaf-list entry
+ *
+ * @param[in]  x    XML node
+ * @retval     kc   Encoded key
+ * @retval     NULL Not computed
+ * @see xml_key_encode
+ */
+struct xml_key_cache *
+xml_key_cache_get(cxobj *x)
+{
+    if (!is_element(x))
+        return NULL;
+    return XE(x, xe_key);
+}
+
+/*! Set cached encoded key of a list entry or leaf-list entry, free the previous
+ *
+ * @param[in]  x    XML node
+ * @param[in]  kc   Encoded key, consumed, or NULL to clear
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xml_key_cache_set(cxobj                *x,
+                  struct xml_key_cache *kc)
+{
+    struct xml_ext *xe;
+
+    if (!is_element(x))
+        return 0;
+    if (kc == NULL && x->x_ext == NULL)
+        return 0;
+    if ((xe = xml_ext_get(x)) == NULL)
+        return -1;
+    if (xe->xe_key)
+        free(xe->xe_key);
+    xe->xe_key = kc;
+    return 0;
+}
+
+/*! Clear cached encoded keys of x or its parent that may depend on changed child xc of x
+ *
+ * @param[in]  x    XML node whose children or value has changed
+ * @param[in]  xc   Changed child of x
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_key_changed
+ */
+static int
+xml_key_cache_notify(cxobj *x,
+                     cxobj *xc)
+{
+    if (XE(x, xe_key) == NULL && (x->x_up == NULL || XE(x->x_up, xe_key) == NULL))
+        return 0;
+    return xml_key_changed(x, xc);
+}
+#endif /* XML_KEY_ENCODE */
+
+#ifdef XML_ORDER_INDEX
+/*! Get order indexes of ordered-by user children of an XML node
+ *
+ * @param[in]  xp   XML parent node
+ * @retval     oi   First order index
+ * @retval     NULL No order index
+ * @see clixon_xml_order.c
+ */
+struct xml_order_index *
+xml_order_index_get(cxobj *xp)
+{
+    if (!is_element(xp))
+        return NULL;
+    return XE(xp, xe_order_index);
+}
+
+/*! Set order indexes of ordered-by user children of an XML node
+ *
+ * @param[in]  xp   XML parent node
+ * @param[in]  oi   First order index, or NULL to unset
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xml_order_index_set(cxobj                  *xp,
+                    struct xml_order_index *oi)
+{
+    struct xml_ext *xe;
+
+    if (!is_element(xp))
+        return 0;
+    if (oi == NULL && xp->x_ext == NULL)
+        return 0;
+    if ((xe = xml_ext_get(xp)) == NULL)
+        return -1;
+    xe->xe_order_index = oi;
+    return 0;
+}
+#endif /* XML_ORDER_INDEX */
+
 /*! Get name of xnode
  * @param[in]  xn    xml node
  * @retval     name of xml node
@@ -347,25 +973,27 @@ xml_name(cxobj *xn)
     return xn->x_name;
 }
 
-/*! Set name of xnode, name is copied
+/*! Set name of xnode, name is interned
  * @param[in]  xn    xml node
- * @param[in]  name  new name, null-terminated string, copied by function
+ * @param[in]  name  new name, null-terminated string, interned by function
  * @retval     0     OK
  * @retval     -1    on error with clicon-err set
+ * @note The name is shared with all nodes with the same name, do not modify it
+ * @see clixon_string_intern
  */
 int
 xml_name_set(cxobj *xn, 
              char  *name)
 {
+    if (name && xn->x_name == name) /* Same interned string */
+        return 0;
     if (xn->x_name){
-        free(xn->x_name);
+        clixon_string_unintern(xn->x_name);
         xn->x_name = NULL;
     }
     if (name){
-        if ((xn->x_name = strdup(name)) == NULL){
-            clicon_err(OE_XML, errno, "strdup");
+        if ((xn->x_name = clixon_string_intern(name)) == NULL)
             return -1;
-        }
     }
     return 0;
 }
@@ -380,9 +1008,9 @@ xml_prefix(cxobj *xn)
     return xn->x_prefix;
 }
 
-/*! Set prefix of xnode, prefix is copied
+/*! Set prefix of xnode, prefix is interned
  * @param[in]  xn      XML node
- * @param[in]  prefix  New prefix, null-terminated string, copied by function
+ * @param[in]  prefix  New prefix, null-terminated string, interned by function
  * @retval     0       OK
  * @retval     -1      Error with clicon-err set
  */
@@ -390,15 +1018,16 @@ int
 xml_prefix_set(cxobj *xn, 
                char  *prefix)
 {
+    if (prefix && xn->x_prefix == prefix) /* Same interned string */
+        return 0;
+    xn->x_nsid = 0;
     if (xn->x_prefix){
-        free(xn->x_prefix);
+        clixon_string_unintern(xn->x_prefix);
         xn->x_prefix = NULL;
     }
     if (prefix){
-        if ((xn->x_prefix = strdup(prefix)) == NULL){
-            clicon_err(OE_XML, errno, "strdup");
+        if ((xn->x_prefix = clixon_string_intern(prefix)) == NULL)
             return -1;
-        }
     }
     return 0;
 }
@@ -416,8 +1045,8 @@ nscache_get(cxobj *x,
 {
     if (!is_element(x))
         return NULL;
-    if (x->x_ns_cache != NULL)
-        return xml_nsctx_get(x->x_ns_cache, prefix);
+    if (XE(x, xe_ns_cache) != NULL)
+        return xml_nsctx_get(x->x_ext->xe_ns_cache, prefix);
     return NULL;
 }
 
@@ -435,8 +1064,8 @@ nscache_get_prefix(cxobj *x,
 {
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache != NULL)
-        return xml_nsctx_get_prefix(x->x_ns_cache, namespace, prefix);
+    if (XE(x, xe_ns_cache) != NULL)
+        return xml_nsctx_get_prefix(x->x_ext->xe_ns_cache, namespace, prefix);
     return 0;
 }
 
@@ -451,7 +1080,7 @@ nscache_get_all(cxobj *x)
 {
     if (!is_element(x))
         return NULL;
-    return x->x_ns_cache;
+    return XE(x, xe_ns_cache);
 }
 
 /*! Set cached namespace for specific namespace. Replace if necessary
@@ -467,16 +1096,19 @@ nscache_set(cxobj *x,
             char  *prefix,
             char  *namespace)
 {
-    int     retval = -1;
+    int             retval = -1;
+    struct xml_ext *xe;
 
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache == NULL){
-        if ((x->x_ns_cache = xml_nsctx_init(prefix, namespace)) == NULL)
+    if ((xe = xml_ext_get(x)) == NULL)
+        goto done;
+    if (xe->xe_ns_cache == NULL){
+        if ((xe->xe_ns_cache = xml_nsctx_init(prefix, namespace)) == NULL)
             goto done;
     }
     else 
-        return xml_nsctx_add(x->x_ns_cache, prefix, namespace);
+        return xml_nsctx_add(xe->xe_ns_cache, prefix, namespace);
     retval = 0;
  done:
     return retval;
@@ -493,17 +1125,20 @@ int
 nscache_replace(cxobj *x,
                 cvec  *nsc)
 {
-    int     retval = -1;
+    int             retval = -1;
+    struct xml_ext *xe;
 
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache != NULL){
-        xml_nsctx_free(x->x_ns_cache);
-        x->x_ns_cache = NULL;
+    if ((xe = xml_ext_get(x)) == NULL)
+        goto done;
+    if (xe->xe_ns_cache != NULL){
+        xml_nsctx_free(xe->xe_ns_cache);
+        xe->xe_ns_cache = NULL;
     }
-    x->x_ns_cache = nsc;
+    xe->xe_ns_cache = nsc;
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
@@ -520,9 +1155,9 @@ nscache_clear(cxobj *x)
 
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache != NULL){
-        xml_nsctx_free(x->x_ns_cache);
-        x->x_ns_cache = NULL;
+    if (XE(x, xe_ns_cache) != NULL){
+        xml_nsctx_free(x->x_ext->xe_ns_cache);
+        x->x_ext->xe_ns_cache = NULL;
     }
     return 0;
 }
@@ -540,6 +1175,21 @@ xml_parent(cxobj *xn)
     return xn->x_up;
 }
 
+/*! Set summary flags of a node and its ancestors
+ *
+ * Stops at the first ancestor that already has the flags, since its ancestors then also
+ * have them
+ * @param[in]  xp      xml node
+ * @param[in]  flag    Flags set in a descendant of xp
+ */
+static void
+xml_flag_sub_up(cxobj   *xp,
+                uint16_t flag)
+{
+    for (; xp && (xp->x_subflags & flag) != flag; xp = xp->x_up)
+        xp->x_subflags |= flag;
+}
+
 /*! Set parent of xml node.
  * @param[in]  xn      xml node
  * @param[in]  parent  pointer to new parent xml node
@@ -551,6 +1201,8 @@ xml_parent_set(cxobj *xn,
                cxobj *parent)
 {
     xn->x_up = parent;
+    if (parent && (xn->x_flags | xn->x_subflags))
+        xml_flag_sub_up(parent, xn->x_flags | xn->x_subflags);
     return 0;
 }
 
@@ -562,10 +1214,10 @@ xml_parent_set(cxobj *xn,
 cxobj*
 xml_parent_candidate(cxobj *xn)
 {
-    if (xn == NULL) {
+    if (xn == NULL || !is_element(xn)) {
         return NULL;
     }
-    return xn->x_up_candidate;
+    return XE(xn, xe_up_candidate);
 }
 
 /*! Set candidate parent of xml node
@@ -577,7 +1229,13 @@ int
 xml_parent_candidate_set(cxobj *xn, 
                          cxobj *parent)
 {
-    xn->x_up_candidate = parent;
+    struct xml_ext *xe;
+
+    if (!is_element(xn))
+        return 0;
+    if ((xe = xml_ext_get(xn)) == NULL)
+        return -1;
+    xe->xe_up_candidate = parent;
     return 0;
 }
 #endif /* XML_PARENT_CANDIDATE */
@@ -604,6 +1262,7 @@ xml_flag_set(cxobj   *xn,
              uint16_t flag)
 {
     xn->x_flags |= flag;
+    xml_flag_sub_up(xn->x_up, flag);
     return 0;
 }
 
@@ -620,6 +1279,125 @@ xml_flag_reset(cxobj   *xn,
     return 0;
 }
 
+/*! Get summary flags of xml node: flags that may be set in some descendant
+ *
+ * If a summary flag is not set, no descendant has it and the subtree can be skipped.
+ * A summary flag may be set even if no descendant has it any longer, since it is only
+ * cleared by a pass over the subtree, such as xml_flag_reset_rec
+ * @param[in]  xn    xml node
+ * @param[in]  flag  Flag value(s), see XML_FLAG_MARK et al
+ * @retval     flag  Summary flag value(s)
+ */
+uint16_t
+xml_flag_sub(cxobj   *xn,
+             uint16_t flag)
+{
+    return xn->x_subflags&flag;
+}
+
+/*! Reset summary flags of xml node, when no descendant has the flags
+ *
+ * @param[in]  xn      xml node
+ * @param[in]  flag    Flag value(s) to reset, see XML_FLAG_*
+ */
+int
+xml_flag_sub_reset(cxobj   *xn,
+                   uint16_t flag)
+{
+    xn->x_subflags &= ~flag;
+    return 0;
+}
+
+/*! Reset flags of all element descendants, skipping subtrees where they are not set
+ *
+ * As xml_apply(xt, CX_ELMNT, xml_flag_reset, flag), ie xt itself is not reset
+ * @param[in]  xt      xml tree
+ * @param[in]  flag    Flag value(s) to reset, see XML_FLAG_*
+ * @see xml_flag_sub
+ */
+int
+xml_flag_reset_rec(cxobj   *xt,
+                   uint16_t flag)
+{
+    cxobj *x;
+
+    if ((xt->x_subflags & flag) == 0)
+        return 0;
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        x->x_flags &= ~flag;
+        xml_flag_reset_rec(x, flag);
+    }
+    xt->x_subflags &= ~flag;
+    return 0;
+}
+
+/*! Check if children of xml node are known to be sorted
+ *
+ * Set after the children are sorted or verified, and kept while children are inserted in
+ * yang order. Cleared when a child is inserted out of yang order or rebound.
+ * @param[in]  xn    xml node
+ * @retval     1     Children are sorted
+ * @retval     0     Unknown
+ * @see xml_sorted_set
+ */
+int
+xml_sorted(cxobj *xn)
+{
+    return (xn->x_flags & XML_FLAG_SORTED) != 0;
+}
+
+/*! Mark children of xml node as sorted, see xml_sort
+ *
+ * Unlike xml_flag_set, ancestors are not changed, since sort threads call this on
+ * their own subtrees
+ * @param[in]  xn    xml node
+ * @retval     0     OK
+ * @see xml_sorted
+ */
+int
+xml_sorted_set(cxobj *xn)
+{
+    if (is_element(xn))
+        xn->x_flags |= XML_FLAG_SORTED;
+    return 0;
+}
+
+/*! Yang order of an xml child, attributes before unbound before bound children
+ *
+ * @param[in]  x     xml node
+ * @retval   >=-1    Order, see yang_order
+ * @retval    -2     Error
+ */
+static int
+xml_sorted_order(cxobj *x)
+{
+    if (xml_type(x) == CX_ATTR)
+        return -3;
+    if (xml_type(x) != CX_ELMNT)
+        return -1;
+    return yang_order(x->x_spec);
+}
+
+/*! Clear sorted mark of parent if a new child is not in yang order with its siblings
+ *
+ * @param[in]  xp    xml parent node
+ * @param[in]  i     Position of new child
+ */
+static void
+xml_sorted_check(cxobj *xp,
+                 int    i)
+{
+    int order;
+
+    if ((xp->x_flags & XML_FLAG_SORTED) == 0)
+        return;
+    if ((order = xml_sorted_order(xp->x_childvec[i])) == -2 ||
+        (i > 0 && xml_sorted_order(xp->x_childvec[i-1]) > order) ||
+        (i < xp->x_childvec_len-1 && xml_sorted_order(xp->x_childvec[i+1]) < order))
+        xp->x_flags &= ~XML_FLAG_SORTED;
+}
+
 /*! Add a creator tag
  *
  * @param[in]  xn    XML tree
@@ -631,19 +1409,22 @@ int
 xml_creator_add(cxobj *xn,
                 char  *name)
 {
-    int     retval = -1;
-    cg_var *cv;
+    int             retval = -1;
+    cg_var         *cv;
+    struct xml_ext *xe;
     
     if (!is_element(xn))
         return 0;
-    if (xn->x_creators == NULL){
-        if ((xn->x_creators = cvec_new(0)) == NULL){
+    if ((xe = xml_ext_get(xn)) == NULL)
+        goto done;
+    if (xe->xe_creators == NULL){
+        if ((xe->xe_creators = cvec_new(0)) == NULL){
             clicon_err(OE_XML, errno, "cvec_new");
             goto done;
         }
     }
-    if ((cv = cvec_find(xn->x_creators, name)) == NULL) 
-        cvec_add_string(xn->x_creators, name, NULL);
+    if ((cv = cvec_find(xe->xe_creators, name)) == NULL) 
+        cvec_add_string(xe->xe_creators, name, NULL);
     retval = 0;
  done:
     return retval;
@@ -664,9 +1445,11 @@ xml_creator_rm(cxobj *xn,
     
     if (!is_element(xn))
         return 0;
-    if ((cv = cvec_find(xn->x_creators, name)) == NULL)
+    if (XE(xn, xe_creators) == NULL)
+        return 0;
+    if ((cv = cvec_find(xn->x_ext->xe_creators, name)) == NULL)
         return 0;
-    return cvec_del(xn->x_creators, cv);
+    return cvec_del(xn->x_ext->xe_creators, cv);
 }
 
 /*! Find a creator string
@@ -682,8 +1465,8 @@ xml_creator_find(cxobj *xn,
 {
     if (!is_element(xn))
         return 0;
-    if (xn->x_creators != NULL &&
-        cvec_find(xn->x_creators, name) != NULL)
+    if (XE(xn, xe_creators) != NULL &&
+        cvec_find(xn->x_ext->xe_creators, name) != NULL)
         return 1;
     return 0;
 }
@@ -699,8 +1482,8 @@ xml_creator_len(cxobj *xn)
 {
     if (!is_element(xn))
         return 0;
-    if (xn->x_creators)
-        return cvec_len(xn->x_creators);
+    if (XE(xn, xe_creators))
+        return cvec_len(xn->x_ext->xe_creators);
     else
         return 0;
 }
@@ -716,13 +1499,17 @@ int
 xml_creator_copy(cxobj *x0, 
                  cxobj *x1)
 {
-    int retval = -1;
+    int             retval = -1;
+    struct xml_ext *xe;
     
-    if (x0->x_creators)
-        if ((x1->x_creators = cvec_dup(x0->x_creators)) == NULL){
+    if (XE(x0, xe_creators)){
+        if ((xe = xml_ext_get(x1)) == NULL)
+            goto done;
+        if ((xe->xe_creators = cvec_dup(x0->x_ext->xe_creators)) == NULL){
             clicon_err(OE_UNIX, errno, "cvec_dup");
             goto done;
         }
+    }
     retval = 0;
  done:
     return retval;
@@ -740,10 +1527,10 @@ creator_print_fn(cxobj *x,
     FILE   *f = (FILE *)arg;
     cg_var *cv;
  
-    if (x->x_creators == NULL)
+    if (XE(x, xe_creators) == NULL)
         return 0;
     cv = NULL;
-    while ((cv = cvec_each(x->x_creators, cv)) != NULL){
+    while ((cv = cvec_each(x->x_ext->xe_creators, cv)) != NULL){
         fprintf(f, "%s ", cv_name_get(cv));
     }
     fprintf(f, ":\n");
@@ -763,6 +1550,86 @@ xml_creator_print(FILE  *f,
     return xml_apply0(xn, CX_ELMNT, creator_print_fn, f);
 }
 
+/*! Get unparsed content of an element, eg anydata, see CLICON_XML_ANYDATA_LAZY
+ *
+ * Unparsed content is parsed into children when they are accessed, eg by xml_child_each,
+ * and is otherwise printed and copied as is. Attributes of the element are always parsed.
+ * @param[in]  x     XML element
+ * @retval     raw   Unparsed XML content
+ * @retval     NULL  No unparsed content
+ * @see xml_lazy_expand
+ */
+char *
+xml_lazy(cxobj *x)
+{
+    if (!is_element(x) || x->x_ext == NULL)
+        return NULL;
+    return x->x_ext->xe_lazy;
+}
+
+/*! Set unparsed content of an element, the element has no other children than attributes
+ *
+ * @param[in]  x     XML element
+ * @param[in]  raw   Well-formed XML content, not necessarily null-terminated, copied.
+ *                   NULL to clear
+ * @param[in]  len   Length of raw
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xml_lazy
+ */
+int
+xml_lazy_set(cxobj      *x,
+             const char *raw,
+             size_t      len)
+{
+    struct xml_ext *xe;
+
+    if (!is_element(x))
+        return 0;
+    if (x->x_ext && x->x_ext->xe_lazy){
+        free(x->x_ext->xe_lazy);
+        x->x_ext->xe_lazy = NULL;
+    }
+    if (raw == NULL)
+        return 0;
+    if ((xe = xml_ext_get(x)) == NULL)
+        return -1;
+    if ((xe->xe_lazy = malloc(len + 1)) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return -1;
+    }
+    memcpy(xe->xe_lazy, raw, len);
+    xe->xe_lazy[len] = '\0';
+    return 0;
+}
+
+/*! Parse unparsed content of an element into children, not bound to yang as anydata
+ *
+ * Called implicitly by the child access functions, such as xml_child_each, xml_child_nr
+ * and xml_child_i. Namespace prefixes are resolved from the ancestors of the element.
+ * @param[in]  x     XML element
+ * @retval     0     OK, or no unparsed content
+ * @retval    -1     Error, unparsed content is dropped
+ * @see xml_lazy
+ */
+int
+xml_lazy_expand(cxobj *x)
+{
+    int   retval = -1;
+    char *raw;
+
+    if ((raw = xml_lazy(x)) == NULL)
+        return 0;
+    x->x_ext->xe_lazy = NULL; /* Before children are added */
+    clicon_debug(CLIXON_DBG_DETAIL, "%s %s", __FUNCTION__, xml_name(x));
+    if (clixon_xml_parse_string(raw, YB_NONE, NULL, &x, NULL) < 0)
+        goto done;
+    retval = 0;
+ done:
+    free(raw);
+    return retval;
+}
+
 /*! Get value of xnode
  * @param[in]  xn    xml node
  * @retval     value of xml node
@@ -770,43 +1637,315 @@ xml_creator_print(FILE  *f,
 char*
 xml_value(cxobj *xn)
 {
+    struct xmlbody *xb;
+
     if (!is_bodyattr(xn))
         return NULL;
-    return xn->x_value_cb?cbuf_get(xn->x_value_cb):NULL;
+    xb = XB(xn);
+    if (xb->xb_vmax == 0)
+        return NULL;
+    if (xb->xb_vmax == XML_VALUE_INLINE)
+        return xb->xb_u.xb_inline;
+    if (xb->xb_vmax == XML_VALUE_SHARED)
+        return xb->xb_u.xb_shared->xv_data;
+    return xb->xb_u.xb_heap;
+}
+
+/*! Free value storage of body/attribute node, a shared value is freed by its last node
+ * @param[in]  xb    XML body/attr node
+ */
+static void
+xml_value_release(struct xmlbody *xb)
+{
+    if (xb->xb_vmax == XML_VALUE_SHARED){
+        if (__atomic_sub_fetch(&xb->xb_u.xb_shared->xv_refs, 1, __ATOMIC_ACQ_REL) == 0)
+            free(xb->xb_u.xb_shared);
+    }
+    else if (xb->xb_vmax > XML_VALUE_INLINE)
+        free(xb->xb_u.xb_heap);
+    xb->xb_vmax = 0;
+    xb->xb_vlen = 0;
+}
+
+/*! Ensure value storage of body/attribute node can hold a value of a certain length
+ *
+ * Short values are kept inline in the node, longer are moved to the heap. Storage is never
+ * shrunk. Existing value is kept.
+ * @param[in]  xb    XML body/attr node
+ * @param[in]  len   Length of value, excluding null
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xml_value_reserve(struct xmlbody *xb,
+                  size_t          len)
+{
+    size_t  max;
+    char   *p;
+
+    if (len >= XML_VALUE_SHARED - 1){
+        clicon_err(OE_XML, EINVAL, "value too long");
+        return -1;
+    }
+    if (xb->xb_vmax == XML_VALUE_SHARED){ /* Copy on write */
+        max = len > xb->xb_vlen ? len + 1 : xb->xb_vlen + 1;
+        if ((p = malloc(max)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            return -1;
+        }
+        memcpy(p, xb->xb_u.xb_shared->xv_data, xb->xb_vlen+1);
+        len = xb->xb_vlen;
+        xml_value_release(xb);
+        xb->xb_vlen = len;
+        xb->xb_u.xb_heap = p;
+        xb->xb_vmax = max;
+        return 0;
+    }
+    if (len < xb->xb_vmax)
+        return 0;
+    if (len < XML_VALUE_INLINE){ /* Here xb_vmax is 0 */
+        xb->xb_vmax = XML_VALUE_INLINE;
+        xb->xb_vlen = 0;
+        xb->xb_u.xb_inline[0] = '\0';
+        return 0;
+    }
+    max = xb->xb_vmax > XML_VALUE_INLINE ? 2*xb->xb_vmax : 2*XML_VALUE_INLINE;
+    if (max < len + 1)
+        max = len + 1;
+    if (max >= XML_VALUE_SHARED)
+        max = XML_VALUE_SHARED - 1;
+    if (xb->xb_vmax > XML_VALUE_INLINE){
+        if ((p = realloc(xb->xb_u.xb_heap, max)) == NULL){
+            clicon_err(OE_XML, errno, "realloc");
+            return -1;
+        }
+    }
+    else {
+        if ((p = malloc(max)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            return -1;
+        }
+        if (xb->xb_vmax == XML_VALUE_INLINE)
+            memcpy(p, xb->xb_u.xb_inline, xb->xb_vlen+1);
+        else{
+            xb->xb_vlen = 0;
+            p[0] = '\0';
+        }
+    }
+    xb->xb_u.xb_heap = p;
+    xb->xb_vmax = max;
+    return 0;
+}
+
+/*! Set value of xml node, value is copied or shared
+ * @param[in]  xn    xml node
+ * @param[in]  val   new value, null-terminated string
+ * @param[in]  xv    If set, shared value equal to val, see xml_value_share
+ * @retval     0     OK
+ * @retval     -1    on error with clicon-err set
+ */
+static int
+xml_value_set0(cxobj                   *xn, 
+               char                    *val,
+               struct xml_value_shared *xv)
+{
+    int             retval = -1;
+    struct xmlbody *xb;
+    size_t          len;
+    char           *v0;
+    size_t          offset = 0;
+    int             self = 0;
+#ifdef XML_EXPLICIT_INDEX
+    cxobj          *xi = NULL;
+#endif
+
+    if (!is_bodyattr(xn))
+        return 0;
+    if (val == NULL){
+        clicon_err(OE_XML, EINVAL, "value is NULL");
+        goto done;
+    }
+    xb = XB(xn);
+    len = strlen(val);
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_value(xn) == NULL || strcmp(xml_value(xn), val) != 0){
+        /* Remove entry from search index before value of index variable changes */
+        if (xml_search_value_pre(xn, &xi) < 0)
+            goto done;
+    }
+#endif
+#ifdef XML_KEY_INDEX
+    if (xn->x_up && (xml_value(xn) == NULL || strcmp(xml_value(xn), val) != 0) &&
+        xml_key_index_notify(xn->x_up, xn) < 0)
+        goto done;
+#endif
+#ifdef XML_KEY_ENCODE
+    if (xn->x_up && xml_key_cache_notify(xn->x_up, xn) < 0)
+        goto done;
+#endif
+    /* Typed value of parent leaf is stale, see xml_bind_value */
+    if (xn->x_up && xml_type(xn) == CX_BODY && xml_cv_set(xn->x_up, NULL) < 0)
+        goto done;
+    if (xv){
+        __atomic_add_fetch(&xv->xv_refs, 1, __ATOMIC_RELAXED);
+        xml_value_release(xb);
+        xb->xb_u.xb_shared = xv;
+        xb->xb_vmax = XML_VALUE_SHARED;
+        xb->xb_vlen = len;
+        goto ok;
+    }
+    /* Setting (part of) itself: a shared value is copied to the heap */
+    if ((v0 = xml_value(xn)) != NULL && val >= v0 && val <= v0 + xb->xb_vlen){
+        self = 1;
+        offset = val - v0;
+    }
+    if (xml_value_reserve(xb, len) < 0)
+        goto done;
+    if (self)
+        val = xml_value(xn) + offset;
+    memmove(xml_value(xn), val, len+1);
+    xb->xb_vlen = len;
+ ok:
+#ifdef XML_EXPLICIT_INDEX
+    if (xi){ /* Re-insert with new value, cached value of index var is stale */
+        if (xml_cv_set(xi, NULL) < 0)
+            goto done;
+        if (xml_search_child_insert1(xml_parent(xml_parent(xi)), xml_parent(xi), xi, 0) < 0)
+            goto done;
+    }
+#endif
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Set value of xml node, value is copied
+ * @param[in]  xn    xml node
+ * @param[in]  val   new value, null-terminated string, copied by function
+ * @retval     0     OK
+ * @retval     -1    on error with clicon-err set
+ * @note Values shorter than XML_VALUE_INLINE are stored inline in the node
+ */
+int
+xml_value_set(cxobj *xn, 
+              char  *val)
+{
+    return xml_value_set0(xn, val, NULL);
+}
+
+/*! Get shared value of xml node, large values are converted to shared on first call
+ * @param[in]  xn    xml body/attr node
+ * @param[out] xvp   Shared value, or NULL if value is too short or not set
+ * @retval     0     OK
+ * @retval     -1    Error
+ * @see XML_VALUE_SHARE
+ */
+static int
+xml_value_share(cxobj                    *xn,
+                struct xml_value_shared **xvp)
+{
+#ifdef XML_VALUE_SHARE
+    struct xmlbody          *xb = XB(xn);
+    struct xml_value_shared *xv;
+#endif
+
+    *xvp = NULL;
+#ifdef XML_VALUE_SHARE
+    if (xb->xb_vmax == XML_VALUE_SHARED){
+        *xvp = xb->xb_u.xb_shared;
+        return 0;
+    }
+    if (xb->xb_vmax == 0 || xb->xb_vlen < XML_VALUE_SHARE)
+        return 0;
+    if ((xv = malloc(sizeof(*xv) + xb->xb_vlen + 1)) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return -1;
+    }
+    xv->xv_refs = 1;
+    xv->xv_hash = 0;
+    memcpy(xv->xv_data, xml_value(xn), xb->xb_vlen + 1);
+    free(xb->xb_u.xb_heap); /* Here value is on heap since it is not short */
+    xb->xb_u.xb_shared = xv;
+    xb->xb_vmax = XML_VALUE_SHARED;
+    *xvp = xv;
+#endif
+    return 0;
+}
+
+/*! Hash of a shared value, computed on first call (FNV-1a)
+ */
+static uint32_t
+xml_value_hash(struct xml_value_shared *xv)
+{
+    uint32_t h;
+    char    *s;
+
+    if ((h = __atomic_load_n(&xv->xv_hash, __ATOMIC_RELAXED)) != 0)
+        return h;
+    h = 2166136261U;
+    for (s = xv->xv_data; *s; s++){
+        h ^= (uint8_t)*s;
+        h *= 16777619U;
+    }
+    if (h == 0)
+        h = 1;
+    __atomic_store_n(&xv->xv_hash, h, __ATOMIC_RELAXED);
+    return h;
+}
+
+/*! Compare values of two body/attribute nodes
+ *
+ * Shared values are first compared by reference and hash, see XML_VALUE_SHARE
+ * @param[in]  x0    xml body/attr node
+ * @param[in]  x1    xml body/attr node
+ * @retval     0     Equal, or both have no value
+ * @retval     1     Not equal
+ * @see xml_body_cmp
+ */
+int
+xml_value_cmp(cxobj *x0,
+              cxobj *x1)
+{
+    char           *s0;
+    char           *s1;
+    struct xmlbody *xb0;
+    struct xmlbody *xb1;
+
+    s0 = xml_value(x0);
+    s1 = xml_value(x1);
+    if (s0 == s1)
+        return 0;
+    if (s0 == NULL || s1 == NULL)
+        return 1;
+    xb0 = XB(x0);
+    xb1 = XB(x1);
+    if (xb0->xb_vlen != xb1->xb_vlen)
+        return 1;
+    if (xb0->xb_vmax == XML_VALUE_SHARED && xb1->xb_vmax == XML_VALUE_SHARED &&
+        xml_value_hash(xb0->xb_u.xb_shared) != xml_value_hash(xb1->xb_u.xb_shared))
+        return 1;
+    return memcmp(s0, s1, xb0->xb_vlen) != 0;
 }
 
-/*! Set value of xml node, value is copied
- * @param[in]  xn    xml node
- * @param[in]  val   new value, null-terminated string, copied by function
- * @retval     0     OK
- * @retval     -1    on error with clicon-err set
+/*! Compare bodies of two xml elements, eg leafs
+ * @param[in]  x0    xml element
+ * @param[in]  x1    xml element
+ * @retval     0     Equal, or both have no body
+ * @retval     1     Not equal
+ * @see xml_value_cmp
  */
 int
-xml_value_set(cxobj *xn, 
-              char  *val)
+xml_body_cmp(cxobj *x0,
+             cxobj *x1)
 {
-    int    retval = -1;
-    size_t sz;
-
-    if (!is_bodyattr(xn))
-        return 0;
-    if (val == NULL){
-        clicon_err(OE_XML, EINVAL, "value is NULL");
-        goto done;
-    }
-    sz = strlen(val)+1;
-    if (xn->x_value_cb == NULL){
-        if ((xn->x_value_cb = cbuf_new_alloc(sz)) == NULL){
-            clicon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-    }
-    else
-        cbuf_reset(xn->x_value_cb);
-    cbuf_append_str(xn->x_value_cb, val);
-    retval = 0;
- done:
-    return retval;
+    cxobj *xb0;
+    cxobj *xb1;
+
+    xb0 = xml_body_get(x0);
+    xb1 = xml_body_get(x1);
+    if (xb0 == NULL || xb1 == NULL)
+        return xml_body(x0) != xml_body(x1);
+    return xml_value_cmp(xb0, xb1);
 }
 
 /*! Append value of xnode, value is copied
@@ -819,8 +1958,15 @@ int
 xml_value_append(cxobj *xn, 
                  char  *val)
 {
-    int    retval = -1;
-    size_t sz;
+    int             retval = -1;
+    struct xmlbody *xb;
+    size_t          len;
+    char           *v0;
+    size_t          offset = 0;
+    int             self = 0;
+#ifdef XML_EXPLICIT_INDEX
+    cxobj          *xi = NULL;
+#endif
 
     if (!is_bodyattr(xn))
         return 0;
@@ -828,17 +1974,41 @@ xml_value_append(cxobj *xn,
         clicon_err(OE_XML, EINVAL, "value is NULL");
         goto done;
     }
-    sz = strlen(val)+1;
-    if (xn->x_value_cb == NULL){
-        if ((xn->x_value_cb = cbuf_new_alloc(sz)) == NULL){
-            clicon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
+    xb = XB(xn);
+    len = strlen(val);
+    /* Appending (part of) itself: keep track of offset since value may be reallocated */
+    if ((v0 = xml_value(xn)) != NULL && val >= v0 && val <= v0 + xb->xb_vlen){
+        self = 1;
+        offset = val - v0;
     }
-    if (cbuf_append_str(xn->x_value_cb, val) < 0){
-        clicon_err(OE_XML, errno, "cprintf");
+#ifdef XML_EXPLICIT_INDEX
+    if (len && xml_search_value_pre(xn, &xi) < 0)
+        goto done;
+#endif
+#ifdef XML_KEY_INDEX
+    if (len && xn->x_up && xml_key_index_notify(xn->x_up, xn) < 0)
+        goto done;
+#endif
+#ifdef XML_KEY_ENCODE
+    if (len && xn->x_up && xml_key_cache_notify(xn->x_up, xn) < 0)
+        goto done;
+#endif
+    if (len && xn->x_up && xml_type(xn) == CX_BODY && xml_cv_set(xn->x_up, NULL) < 0)
+        goto done;
+    if (xml_value_reserve(xb, xb->xb_vlen + len) < 0)
         goto done;
+    if (self)
+        val = xml_value(xn) + offset;
+    memmove(xml_value(xn) + xb->xb_vlen, val, len+1);
+    xb->xb_vlen += len;
+#ifdef XML_EXPLICIT_INDEX
+    if (xi){
+        if (xml_cv_set(xi, NULL) < 0)
+            goto done;
+        if (xml_search_child_insert1(xml_parent(xml_parent(xi)), xml_parent(xi), xi, 0) < 0)
+            goto done;
     }
+#endif
     retval = 0;
  done:
     return retval;
@@ -886,6 +2056,7 @@ xml_child_nr(cxobj *xn)
     }
     if (!is_element(xn))
         return 0;
+    XML_LAZY_EXPAND(xn);
     return xn->x_childvec_len;
 }
 
@@ -950,6 +2121,7 @@ xml_child_i(cxobj *xn,
     }
     if (!is_element(xn))
         return NULL;
+    XML_LAZY_EXPAND(xn);
     if (i < xn->x_childvec_len)
         return xn->x_childvec[i];
     return NULL;
@@ -992,8 +2164,17 @@ xml_child_i_set(cxobj *xt,
 {
     if (!is_element(xt))
         return NULL;
+#ifdef XML_KEY_INDEX
+    if (XE(xt, xe_key_index))
+        xml_key_index_free(xt);
+#endif
+#ifdef XML_ORDER_INDEX
+    if (XE(xt, xe_order_index))
+        xml_order_index_free(xt);
+#endif
     if (i < xt->x_childvec_len)
         xt->x_childvec[i] = xc;
+    xt->x_flags &= ~XML_FLAG_SORTED;
     return 0;
 }
 
@@ -1003,6 +2184,8 @@ xml_child_i_set(cxobj *xt,
  * @retval     i     The order of the child
  * @retval     -1    if no such child, or empty child
  * @see xml_child_i
+ * @note Entries of large ordered-by user lists are found with an order index, see 
+ * XML_ORDER_INDEX, other children with a linear search
  */
 int
 xml_child_order(cxobj *xp, 
@@ -1013,6 +2196,12 @@ xml_child_order(cxobj *xp,
 
     if (!is_element(xp))
         return -1;
+#ifdef XML_ORDER_INDEX
+    if (xml_parent(xc) == xp &&
+        xml_order_index_pos(xp, xc, &i) == 1)
+        return i;
+    i = 0;
+#endif
     while ((x = xml_child_each(xp, x, -1)) != NULL) {
         if (x == xc)
             return i;
@@ -1021,6 +2210,33 @@ xml_child_order(cxobj *xp,
     return -1;
 }
 
+/*! Get index in child vector to start searching from after xprev
+ *
+ * The cached position of xprev is verified, it may be stale if the child vector has
+ * been changed or if xprev was last visited by xml_child_index_each.
+ * @param[in] xparent xml tree node whose children are iterated
+ * @param[in] xprev   previous child, or NULL on init
+ * @retval    i       Index after xprev
+ * @note If xprev has been removed from xparent, continue after its last known position
+ */
+static int
+xml_child_each_start(cxobj *xparent,
+                     cxobj *xprev)
+{
+    int i;
+
+    if (xprev == NULL)
+        return 0;
+    i = xprev->_x_vector_i;
+    if (i >= 0 && i < xparent->x_childvec_len && xparent->x_childvec[i] == xprev)
+        return i+1;
+    if (xml_parent(xprev) == xparent)
+        for (i=0; i<xparent->x_childvec_len; i++)
+            if (xparent->x_childvec[i] == xprev)
+                return i+1;
+    return xprev->_x_vector_i+1;
+}
+
 /*! Iterator over xml children objects
  *
  * @param[in] xparent xml tree node whose children should be iterated
@@ -1034,10 +2250,9 @@ xml_child_order(cxobj *xp,
  *     ...
  *   }
  * @endcode
- * @note uses _x_vector_i as a shared resource: you cannot mix loops over same parent
- * Further, never manipulate the child-list during operation or using the
- * same object recursively, the function uses an internal field to remember the
- * index used. It works as long as the same object is not iterated concurrently. 
+ * @note The position of xprev is cached in xprev itself, which is written when it
+ * changes. Use xml_child_it_next for traversals of trees shared between threads.
+ * Never manipulate the child-list during operation, except as follows.
  * If you need to delete a node you can do somethhing like:
  * @code
  *   cxobj *xprev = NULL;
@@ -1054,6 +2269,7 @@ xml_child_order(cxobj *xp,
  * @endcode
  * @see xml_child_index_each
  * @see xml_child_each_attr  hardcoded for sorted list and attributes
+ * @see xml_child_it_next    external iterator without shared state
  */
 cxobj *
 xml_child_each(cxobj           *xparent, 
@@ -1067,7 +2283,9 @@ xml_child_each(cxobj           *xparent,
         return NULL;
     if (!is_element(xparent))
         return NULL;
-    for (i=xprev?xprev->_x_vector_i+1:0; i<xparent->x_childvec_len; i++){
+    if (type != CX_ATTR) /* Attributes are parsed also if content is not */
+        XML_LAZY_EXPAND(xparent);
+    for (i=xml_child_each_start(xparent, xprev); i<xparent->x_childvec_len; i++){
         xn = xparent->x_childvec[i];
         if (xn == NULL)
             continue;
@@ -1075,8 +2293,10 @@ xml_child_each(cxobj           *xparent,
             continue;
         break; /* this is next object after previous */
     }
-    if (i < xparent->x_childvec_len) /* found */
-        xn->_x_vector_i = i;
+    if (i < xparent->x_childvec_len){ /* found */
+        if (xn->_x_vector_i != i) /* Avoid writing to tree on repeated traversals */
+            xn->_x_vector_i = i;
+    }
     else
         xn = NULL;
     return xn;
@@ -1104,7 +2324,7 @@ xml_child_each_attr(cxobj           *xparent,
         return NULL;
     if (!is_element(xparent))
         return NULL;
-    for (i=xprev?xprev->_x_vector_i+1:0; i<xparent->x_childvec_len; i++){
+    for (i=xml_child_each_start(xparent, xprev); i<xparent->x_childvec_len; i++){
         xn = xparent->x_childvec[i];
         if (xn == NULL)
             continue;
@@ -1113,13 +2333,75 @@ xml_child_each_attr(cxobj           *xparent,
         }
         break; /* this is next object after previous */
     }
-    if (i < xparent->x_childvec_len) /* found */
-        xn->_x_vector_i = i;
+    if (i < xparent->x_childvec_len){ /* found */
+        if (xn->_x_vector_i != i)
+            xn->_x_vector_i = i;
+    }
     else
         xn = NULL;
     return xn;
 }
 
+/*! Initialize an external iterator over xml children objects
+ *
+ * @param[out] it      Iterator, allocated by caller
+ * @param[in]  xparent xml tree node whose children should be iterated
+ * @param[in]  type    matching type or -1 for any
+ * @retval     0       OK
+ * @code
+ *   xml_child_it it;
+ *   cxobj       *x;
+ *
+ *   xml_child_it_init(&it, x_top, CX_ELMNT);
+ *   while ((x = xml_child_it_next(&it)) != NULL) {
+ *     ...
+ *   }
+ * @endcode
+ * @note Unlike xml_child_each, the tree is not written to, and the same node may be
+ * iterated by several iterators at once, also concurrently by several threads as long
+ * as the tree is not modified.
+ * @note Do not remove children while iterating, use xml_child_each for that
+ * @see xml_child_it_next
+ */
+int
+xml_child_it_init(xml_child_it   *it,
+                  cxobj          *xparent,
+                  enum cxobj_type type)
+{
+    it->xi_parent = xparent;
+    it->xi_i = 0;
+    it->xi_type = type;
+    if (type != CX_ATTR && is_element(xparent))
+        XML_LAZY_EXPAND(xparent);
+    return 0;
+}
+
+/*! Get next child of an external xml children iterator
+ *
+ * @param[in,out] it   Iterator initialized with xml_child_it_init
+ * @retval        xn   Next XML node
+ * @retval        NULL End of list
+ * @see xml_child_it_init
+ */
+cxobj *
+xml_child_it_next(xml_child_it *it)
+{
+    cxobj *xp = it->xi_parent;
+    cxobj *xn;
+
+    if (xp == NULL || !is_element(xp))
+        return NULL;
+    while (it->xi_i < xp->x_childvec_len){
+        xn = xp->x_childvec[it->xi_i++];
+        if (xn == NULL)
+            continue;
+        if (it->xi_type != CX_ERROR && xml_type(xn) != it->xi_type)
+            continue;
+        return xn;
+    }
+    return NULL;
+}
+
 /*! Extend child vector with one and insert xml node there
  * @note does not do anything with child, you may need to set its parent, etc
  * @see xml_child_insert_pos
@@ -1133,6 +2415,8 @@ xml_child_append(cxobj *xp,
 
     if (!is_element(xp))
         return 0;
+    if (xml_type(xc) != CX_ATTR)
+        XML_LAZY_EXPAND(xp);
     start = XML_CHILDVEC_SIZE_START;
     /* Heurestics: if child is body only single child is expected, but element children may
      * have siblings
@@ -1152,6 +2436,28 @@ xml_child_append(cxobj *xp,
         }
     }
     xp->x_childvec[xp->x_childvec_len-1] = xc;
+    xml_sorted_check(xp, xp->x_childvec_len-1);
+    if (xml_type(xc) == CX_BODY && xml_cv_set(xp, NULL) < 0)
+        return -1;
+#ifdef XML_ORDER_INDEX
+    if (XE(xp, xe_order_index) &&
+        xml_order_index_insert(xp, xc, xp->x_childvec_len-1) < 0)
+        return -1;
+#endif
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_child_update(xp, xc, 1) < 0)
+        return -1;
+#endif
+#ifdef XML_KEY_INDEX
+    if (XE(xp, xe_key_index) && xml_key_index_add(xp, xc) < 0)
+        return -1;
+    if (xml_key_index_notify(xp, xc) < 0)
+        return -1;
+#endif
+#ifdef XML_KEY_ENCODE
+    if (xml_key_cache_notify(xp, xc) < 0)
+        return -1;
+#endif
     return 0;
 }
 
@@ -1169,6 +2475,7 @@ xml_child_insert_pos(cxobj *xp,
    
     if (!is_element(xp))
         return 0;
+    XML_LAZY_EXPAND(xp);
     xp->x_childvec_len++;
     if (xp->x_childvec_len > xp->x_childvec_max){
         if (xp->x_childvec_len < XML_CHILDVEC_SIZE_THRESHOLD)
@@ -1184,6 +2491,106 @@ xml_child_insert_pos(cxobj *xp,
     size = (xml_child_nr(xp) - i - 1)*sizeof(cxobj *);
     memmove(&xp->x_childvec[i+1], &xp->x_childvec[i], size);
     xp->x_childvec[i] = xc;
+    xml_sorted_check(xp, i);
+    if (xml_type(xc) == CX_BODY && xml_cv_set(xp, NULL) < 0)
+        return -1;
+#ifdef XML_ORDER_INDEX
+    if (XE(xp, xe_order_index) && xml_order_index_insert(xp, xc, i) < 0)
+        return -1;
+#endif
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_child_update(xp, xc, 1) < 0)
+        return -1;
+#endif
+#ifdef XML_KEY_INDEX
+    if (XE(xp, xe_key_index) && xml_key_index_add(xp, xc) < 0)
+        return -1;
+    if (xml_key_index_notify(xp, xc) < 0)
+        return -1;
+#endif
+#ifdef XML_KEY_ENCODE
+    if (xml_key_cache_notify(xp, xc) < 0)
+        return -1;
+#endif
+    return 0;
+}
+
+/*! Insert several children at given positions under parent xp in one pass
+ *
+ * Same as calling xml_child_insert_pos and xml_parent_set for each child, but the child
+ * vector is rebuilt once, instead of being shifted for every child.
+ * @param[in]  xp    XML parent node
+ * @param[in]  vec   Children to insert, without parents
+ * @param[in]  posv  Position of each child in the existing child vector, non-decreasing
+ * @param[in]  len   Length of vec and posv
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xml_insert_bulk which computes the positions
+ */
+int
+xml_child_insert_vec(cxobj  *xp,
+                     cxobj **vec,
+                     int    *posv,
+                     int     len)
+{
+    cxobj **cv;
+    int     nr;
+    int     max;
+    int     i;
+    int     j = 0;
+    int     k;
+
+    if (!is_element(xp) || len == 0)
+        return 0;
+    XML_LAZY_EXPAND(xp);
+    nr = xp->x_childvec_len;
+    for (k=0; k<len; k++)
+        if (posv[k] < (k?posv[k-1]:0) || posv[k] > nr){
+            clicon_err(OE_XML, EINVAL, "Position %d out of order", posv[k]);
+            return -1;
+        }
+    max = xp->x_childvec_max;
+    if (nr + len > max)
+        max = nr + len;
+    if ((cv = malloc(max*sizeof(cxobj*))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return -1;
+    }
+    i = 0;
+    for (k=0; k<len; k++){
+        while (j < posv[k])
+            cv[i++] = xp->x_childvec[j++];
+        cv[i++] = vec[k];
+    }
+    while (j < nr)
+        cv[i++] = xp->x_childvec[j++];
+    if (xp->x_childvec)
+        free(xp->x_childvec);
+    xp->x_childvec = cv;
+    xp->x_childvec_len = nr + len;
+    xp->x_childvec_max = max;
+#ifdef XML_ORDER_INDEX
+    if (XE(xp, xe_order_index) && xml_order_index_free(xp) < 0)
+        return -1;
+#endif
+    for (k=0; k<len; k++){
+        xml_sorted_check(xp, posv[k] + k);
+        xml_parent_set(vec[k], xp);
+#ifdef XML_EXPLICIT_INDEX
+        if (xml_search_child_update(xp, vec[k], 1) < 0)
+            return -1;
+#endif
+#ifdef XML_KEY_INDEX
+        if (XE(xp, xe_key_index) && xml_key_index_add(xp, vec[k]) < 0)
+            return -1;
+        if (xml_key_index_notify(xp, vec[k]) < 0)
+            return -1;
+#endif
+#ifdef XML_KEY_ENCODE
+        if (xml_key_cache_notify(xp, vec[k]) < 0)
+            return -1;
+#endif
+    }
     return 0;
 }
 
@@ -1200,8 +2607,17 @@ xml_childvec_set(cxobj *x,
 {
     if (!is_element(x))
         return 0;
+#ifdef XML_KEY_INDEX
+    if (XE(x, xe_key_index) && xml_key_index_free(x) < 0)
+        return -1;
+#endif
+#ifdef XML_ORDER_INDEX
+    if (XE(x, xe_order_index) && xml_order_index_free(x) < 0)
+        return -1;
+#endif
     x->x_childvec_len = len;
     x->x_childvec_max = len;
+    x->x_flags &= ~XML_FLAG_SORTED;
     if (x->x_childvec)
         free(x->x_childvec);
     if ((x->x_childvec = calloc(len, sizeof(cxobj*))) == NULL){
@@ -1211,6 +2627,34 @@ xml_childvec_set(cxobj *x,
     return 0;
 }
 
+/*! Allocate room for at least a number of children, eg before building a large list
+ *
+ * Children are then appended without reallocating the child vector
+ * @param[in]  x   XML node
+ * @param[in]  n   Number of children, existing included
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+xml_childvec_reserve(cxobj *x,
+                     int    n)
+{
+    cxobj **cv;
+
+    if (!is_element(x))
+        return 0;
+    XML_LAZY_EXPAND(x);
+    if (n <= x->x_childvec_max)
+        return 0;
+    if ((cv = realloc(x->x_childvec, n*sizeof(cxobj*))) == NULL){
+        clicon_err(OE_XML, errno, "realloc");
+        return -1;
+    }
+    x->x_childvec = cv;
+    x->x_childvec_max = n;
+    return 0;
+}
+
 /*! Get the children of an XML node as an XML vector
  */
 cxobj **
@@ -1218,6 +2662,7 @@ xml_childvec_get(cxobj *x)
 {
     if (!is_element(x))
         return NULL;
+    XML_LAZY_EXPAND(x);
     return x->x_childvec;
 }
 
@@ -1247,30 +2692,24 @@ clixon_child_xvec_append(cxobj       *xn,
     return retval;
 }
 
-/*! Create new xml node given a name and parent. Free with xml_free().
+/*! Create new xml node, from heap or from arena
  *
  * @param[in]  name      Name of XML node
  * @param[in]  xp        The parent where the new xml node will be appended
  * @param[in]  type      XML type
+ * @param[in]  xa        Arena to allocate from, or NULL for heap
  * @retval     xml       Created xml object if successful. Free with xml_free()
  * @retval     NULL      Error and clicon_err() called
- * @code
- *   cxobj *x;
- *   if ((x = xml_new(name, xparent, CX_ELMNT)) == NULL)
- *     err;
- *   ...
- *   xml_free(x);
- * @endcode
- * @note Differentiates between body/attribute vs element to reduce mem allocation
- * @see xml_sort_insert
  */
-cxobj *
-xml_new(char           *name, 
-        cxobj          *xp,
-        enum cxobj_type type)
+static cxobj *
+xml_new0(char             *name, 
+         cxobj            *xp,
+         enum cxobj_type   type,
+         struct xml_arena *xa)
 {
-    struct xml *x = NULL;
-    size_t      sz;
+    struct xml        *x = NULL;
+    size_t             sz;
+    struct xml_arena **xap;
     
     switch (type){
     case CX_ELMNT:
@@ -1285,11 +2724,22 @@ xml_new(char           *name,
         return NULL;
         break;
     }
-    if ((x = malloc(sz)) == NULL){
-        clicon_err(OE_XML, errno, "malloc");
-        return NULL;
+    if (xa != NULL){
+        if ((xap = xml_arena_alloc(xa, sizeof(*xap) + sz)) == NULL)
+            return NULL;
+        *xap = xa;
+        x = (struct xml *)(xap + 1);
+        memset(x, 0, sz);
+        x->x_arena = 1;
+        xa->xa_nodes++;
+    }
+    else{
+        if ((x = malloc(sz)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        memset(x, 0, sz);
     }
-    memset(x, 0, sz);
     xml_type_set(x, type);
     if (name && (xml_name_set(x, name)) < 0)
         return NULL;
@@ -1299,7 +2749,72 @@ xml_new(char           *name,
             return NULL;
         x->_x_i = xml_child_nr(xp)-1;
     }
-    _stats_xml_nr++;
+    __atomic_add_fetch(&_stats_xml_nr, 1, __ATOMIC_RELAXED);
+    return x;
+}
+
+/*! Create new xml node given a name and parent. Free with xml_free().
+ *
+ * @param[in]  name      Name of XML node
+ * @param[in]  xp        The parent where the new xml node will be appended
+ * @param[in]  type      XML type
+ * @retval     xml       Created xml object if successful. Free with xml_free()
+ * @retval     NULL      Error and clicon_err() called
+ * @code
+ *   cxobj *x;
+ *   if ((x = xml_new(name, xparent, CX_ELMNT)) == NULL)
+ *     err;
+ *   ...
+ *   xml_free(x);
+ * @endcode
+ * @note Differentiates between body/attribute vs element to reduce mem allocation
+ * @note If xp is allocated from an arena, the new node is allocated from the same arena
+ * @see xml_sort_insert
+ * @see xml_new_arena
+ */
+cxobj *
+xml_new(char           *name, 
+        cxobj          *xp,
+        enum cxobj_type type)
+{
+    return xml_new0(name, xp, type, (xp && xp->x_arena) ? XML_ARENA(xp) : NULL);
+}
+
+/*! Create new xml root node with a new arena. All nodes created with xml_new under it use the arena
+ *
+ * Nodes are allocated from contiguous slabs instead of separate mallocs. No
+ * memory is returned to the heap until the last arena node is freed, in which case all slabs
+ * are freed at once.
+ * Nodes may be moved to other trees, but they then keep the whole arena alive.
+ * Suitable for short-lived trees such as datastore read copies and replies.
+ * @param[in]  name      Name of XML node
+ * @param[in]  type      XML type
+ * @retval     xml       Created xml object if successful. Free with xml_free()
+ * @retval     NULL      Error and clicon_err() called
+ * @code
+ *   cxobj *xt;
+ *   if ((xt = xml_new_arena("top", CX_ELMNT)) == NULL)
+ *     err;
+ *   if (xml_copy(x0, xt) < 0)
+ *     err;
+ *   xml_free(xt);
+ * @endcode
+ * @see xml_stats_arena
+ */
+cxobj *
+xml_new_arena(char           *name, 
+              enum cxobj_type type)
+{
+    struct xml_arena *xa;
+    cxobj            *x;
+
+    if ((xa = xml_arena_new(0)) == NULL)
+        return NULL;
+    if ((x = xml_new0(name, NULL, type, xa)) == NULL){
+        if (xa->xa_nodes == 0)
+            xml_arena_free(xa);
+        return NULL;
+    }
     return x;
 }
 
@@ -1357,24 +2872,65 @@ xml_spec_set(cxobj     *x,
 {
     if (!is_element(x))
         return 0;
+    if (x->x_spec != spec){
+        if (xml_cv_set(x, NULL) < 0) /* Typed value depends on yang type */
+            return -1;
+#ifdef XML_KEY_ENCODE
+        if (xml_key_cache_set(x, NULL) < 0) /* Encoding depends on yang keys */
+            return -1;
+#endif
+        x->x_nsid = 0;
+        if (x->x_up) /* Yang order of x is changed */
+            x->x_up->x_flags &= ~XML_FLAG_SORTED;
+    }
     x->x_spec = spec;
     return 0;
 }
 
+/*! Get namespace id of the own prefix of an XML node
+ *
+ * @param[in]  x    XML node
+ * @retval     id   Namespace id, see xml_nsid_register
+ * @retval     0    Not known, use xml2ns
+ */
+uint16_t
+xml_nsid(cxobj *x)
+{
+    return x->x_nsid;
+}
+
+/*! Set namespace id of the own prefix of an XML element
+ *
+ * Set when binding has checked that the namespace of the node is the one of its yang.
+ * Cleared when the yang spec or prefix of the node changes
+ * @param[in]  x    XML node
+ * @param[in]  id   Namespace id, see xml_nsid_register, or 0
+ * @see xml2ns  Uses the id instead of searching ancestors
+ */
+int
+xml_nsid_set(cxobj   *x,
+             uint16_t id)
+{
+    if (is_element(x))
+        x->x_nsid = id;
+    return 0;
+}
+
 /*! Return (cached)  cligen variable value of xml node
  * @param[in]  x    XML node (body and leaf/leaf-list)
  * @retval     cv   CLIgen variable containing value of x body
  * @retval     NULL
  * Only applicable if x is body and has yang-spec and is leaf or leaf-list
- * Only accessed by xml_cv_cache as part of sorting in xml_cmp
+ * Set when yang is bound or by xml_cv_cache, and cleared when the value changes
  * @see xml_cv_cache
+ * @see xml_bind_value
  */
 cg_var *
 xml_cv(cxobj *x)
 {
     if (!is_element(x))
         return NULL;
-    return x->x_cv;
+    return XE(x, xe_cv);
 }
 
 /*! Set (cached) cligen variable value of xml node
@@ -1382,20 +2938,116 @@ xml_cv(cxobj *x)
  * @param[in]  cv  CLIgen variable containing value of x body
  * @retval     0   OK
  * Only applicable if x is body and has yang-spec and is leaf or leaf-list
- * Only accessed by xml_cv_cache as part of sorting in xml_cmp
+ * Set when yang is bound or by xml_cv_cache, and cleared when the value changes
  * @see xml_cv_cache
+ * @see xml_bind_value
  */
 int
 xml_cv_set(cxobj  *x, 
            cg_var *cv)
 {
-    if (!is_element(x))
+    struct xml_ext *xe;
+
+    if (!is_element(x))
+        return 0;
+    if (cv == NULL && x->x_ext == NULL) /* Nothing to clear, do not create extension */
+        return 0;
+    if ((xe = xml_ext_get(x)) == NULL)
+        return -1;
+    if (xe->xe_cv)
+        cv_free(xe->xe_cv);
+    xe->xe_cv = cv;
+    return 0;
+}
+
+/*! Check if values of a cligen type are kept in the XML node as typed values
+ *
+ * Integers, booleans and decimal64 are compared and range checked natively. Other types
+ * such as strings are only cached temporarily, since the body already is the value.
+ * @param[in]  type  CLIgen type of value
+ * @retval     1     Native type, cv is kept
+ * @retval     0     Not native type
+ * @see xml_bind_value
+ */
+int
+xml_cv_native(enum cv_type type)
+{
+    return cv_isint(type) || type == CGV_BOOL || type == CGV_DEC64;
+}
+
+#ifdef XML_FIND_YANG_THRESHOLD
+/*! Find element child by name using binary search in yang order of sorted children
+ *
+ * The yang child of the parent with the name is looked up, and the first child with that
+ * yang order is searched for. Attributes are first and scanned.
+ * @param[in]  xp    XML parent node
+ * @param[in]  name  Name of child
+ * @param[in]  attr  Also match attributes, as xml_find
+ * @param[out] xcp   First child with name, or NULL if there is none
+ * @retval     1     Searched, see xcp
+ * @retval     0     Not applicable: xp is not sorted, not bound, narrow or has unbound children
+ * @note Children bound to another yang node with the same name, eg augmented from modules
+ *       with different namespaces, are not found
+ */
+static int
+xml_find_yang(cxobj      *xp,
+              const char *name,
+              int         attr,
+              cxobj     **xcp)
+{
+    yang_stmt *yc;
+    cxobj     *xc;
+    int        len;
+    int        low;
+    int        upper;
+    int        mid;
+    int        order;
+    int        yi;
+
+    if ((xp->x_flags & XML_FLAG_SORTED) == 0 ||
+        xp->x_spec == NULL ||
+        (len = xp->x_childvec_len) < XML_FIND_YANG_THRESHOLD)
         return 0;
-    if (x->x_cv)
-        cv_free(x->x_cv);
-    x->x_cv = cv;
-    return 0;
+    for (low=0; low<len; low++){
+        xc = xp->x_childvec[low];
+        if (xml_type(xc) != CX_ATTR)
+            break;
+        if (attr && (name == xml_name(xc) || strcmp(name, xml_name(xc)) == 0)){
+            *xcp = xc;
+            return 1;
+        }
+    }
+    /* Unbound children are sorted first */
+    if (low < len &&
+        (xml_type(xc) != CX_ELMNT || xc->x_spec == NULL))
+        return 0;
+    if ((yc = yang_find_datanode(xp->x_spec, (char*)name)) == NULL ||
+        (yi = yang_order(yc)) < 0)
+        return 0;
+    upper = len;
+    while (low < upper){
+        mid = (low + upper) / 2;
+        if ((order = yang_order(xp->x_childvec[mid]->x_spec)) < 0)
+            return 0;
+        if (order < yi)
+            low = mid + 1;
+        else
+            upper = mid;
+    }
+    /* Cases of a choice may share order */
+    *xcp = NULL;
+    for (; low<len; low++){
+        xc = xp->x_childvec[low];
+        if (xc->x_spec == yc){
+            *xcp = xc;
+            break;
+        }
+        if (yang_order(xc->x_spec) != yi)
+            break;
+    }
+    return 1;
 }
+#endif /* XML_FIND_YANG_THRESHOLD */
 
 /*! Find an XML node matching name among a parent's children.
  *
@@ -1411,6 +3063,8 @@ xml_cv_set(cxobj  *x,
  * @note (1) Ignores prefix which means namespaces are ignored
  * @note (2) Does not differentiate between element,attributes and body. You usually want elements.
  * @note (3) Linear scalability and relies on strcmp, does not use search/key indexes
+ *           (pointer comparison is tried first since names are interned), except in sorted
+ *           bound nodes with many children, see XML_FIND_YANG_THRESHOLD
  * @note (4) Only returns first match, eg a list/leaf-list may have several children with same name
  * @see xml_find_type  A more generic function fixes (1) and (2) above
  */
@@ -1425,8 +3079,13 @@ xml_find(cxobj *xp,
     }
     if (!is_element(xp))
         return NULL;
+#ifdef XML_FIND_YANG_THRESHOLD
+    XML_LAZY_EXPAND(xp);
+    if (xml_find_yang(xp, name, 1, &x) == 1)
+        return x;
+#endif
     while ((x = xml_child_each(xp, x, -1)) != NULL) 
-        if (strcmp(name, xml_name(x)) == 0)
+        if (name == xml_name(x) || strcmp(name, xml_name(x)) == 0)
             break; /* x is set */
     return x;
 }
@@ -1483,10 +3142,6 @@ xml_addsub(cxobj *xp,
         }
         /* clear namespace context cache of child */
         nscache_clear(xc);
-#ifdef XML_EXPLICIT_INDEX
-    if (xml_search_index_p(xc))
-            xml_search_child_insert(xp, xc);
-#endif
     }
     retval = 0;
  done:
@@ -1512,6 +3167,7 @@ xml_wrap_all(cxobj *xp,
         return NULL;
     if ((xw = xml_new(tag, NULL, CX_ELMNT)) == NULL)
         goto done;
+    XML_LAZY_EXPAND(xp);
     while (xp->x_childvec_len)
         if (xml_addsub(xw, xml_child_i(xp, 0)) < 0)
             goto done;
@@ -1602,17 +3258,30 @@ xml_child_rm(cxobj *xp,
         clicon_err(OE_XML, 0, "Child not found");
         goto done;
     }
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_child_update(xp, xc, 0) < 0)
+        goto done;
+#endif
+    if (xml_type(xc) == CX_BODY && xml_cv_set(xp, NULL) < 0)
+        goto done;
     xml_parent_set(xc, NULL);
     xp->x_childvec[i] = NULL;
     xp->x_childvec_len--;
     if (i<xp->x_childvec_len)
         memmove(&xp->x_childvec[i], &xp->x_childvec[i+1], (xp->x_childvec_len-i)*sizeof(cxobj*));
-#ifdef XML_EXPLICIT_INDEX
-    if (xml_type(xc) == CX_ELMNT){
-        if (xml_search_index_p(xc))
-            xml_search_child_rm(xp, xc);
-
-    }
+#ifdef XML_ORDER_INDEX
+    if (XE(xp, xe_order_index) && xml_order_index_rm(xp, xc, i) < 0)
+        goto done;
+#endif
+#ifdef XML_KEY_INDEX
+    if (XE(xp, xe_key_index) && xml_key_index_rm(xp, xc) < 0)
+        goto done;
+    if (xml_key_index_notify(xp, xc) < 0)
+        goto done;
+#endif
+#ifdef XML_KEY_ENCODE
+    if (xml_key_cache_notify(xp, xc) < 0)
+        goto done;
 #endif
     retval = 0;
  done:
@@ -1923,6 +3592,19 @@ xml_find_type(cxobj           *xt,
     
     if (!is_element(xt))
         return NULL;
+#ifdef XML_FIND_YANG_THRESHOLD
+    if (type == CX_ELMNT && name != NULL){
+        XML_LAZY_EXPAND(xt);
+        if (xml_find_yang(xt, name, 0, &x) == 1){
+            if (x == NULL || prefix == NULL)
+                return x;
+            xprefix = xml_prefix(x);
+            if (xprefix && strcmp(prefix, xprefix) == 0)
+                return x;
+            x = NULL; /* Other prefix, scan */
+        }
+    }
+#endif
     while ((x = xml_child_each(xt, x, type)) != NULL) {
         if (prefix){
             xprefix = xml_prefix(x);
@@ -1930,7 +3612,7 @@ xml_find_type(cxobj           *xt,
         }
         else
             pmatch = 1;
-        if (pmatch && (name==NULL || strcmp(name, xml_name(x)) == 0))
+        if (pmatch && (name==NULL || name == xml_name(x) || strcmp(name, xml_name(x)) == 0))
             return x;
     }
     return NULL;
@@ -1960,7 +3642,7 @@ xml_find_value(cxobj      *xt,
     if (!is_element(xt))
         return NULL;
     while ((x = xml_child_each(xt, x, -1)) != NULL) 
-        if (strcmp(name, xml_name(x)) == 0)
+        if (name == xml_name(x) || strcmp(name, xml_name(x)) == 0)
             return xml_value(x);
     return NULL;
 }
@@ -1985,7 +3667,7 @@ xml_find_body(cxobj      *xt,
     if (!is_element(xt))
         return NULL;
     while ((x = xml_child_each(xt, x, -1)) != NULL) 
-        if (strcmp(name, xml_name(x)) == 0)
+        if (name == xml_name(x) || strcmp(name, xml_name(x)) == 0)
             return xml_body(x);
     return NULL;
 }
@@ -2015,7 +3697,7 @@ xml_find_body_obj(cxobj      *xt,
     if (!is_element(xt))
         return NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
-        if (strcmp(name, xml_name(x)))
+        if (name != xml_name(x) && strcmp(name, xml_name(x)))
             continue;
         if ((bstr = xml_body(x)) == NULL)
             continue;
@@ -2032,16 +3714,18 @@ xml_find_body_obj(cxobj      *xt,
 int
 xml_free(cxobj *x)
 {
-    int    i;
-    cxobj *xc;
+    int               i;
+    cxobj            *xc;
+    struct xml_arena *xa;
+    struct xml_ext   *xe;
 
     if (x == NULL){
         return 0;
     }
     if (x->x_name)
-        free(x->x_name);
+        clixon_string_unintern(x->x_name);
     if (x->x_prefix)
-        free(x->x_prefix);
+        clixon_string_unintern(x->x_prefix);
     switch (xml_type(x)){
     case CX_ELMNT:
         for (i=0; i<x->x_childvec_len; i++){
@@ -2052,26 +3736,47 @@ xml_free(cxobj *x)
         }
         if (x->x_childvec)
             free(x->x_childvec);
-        if (x->x_cv)
-            cv_free(x->x_cv);
-        if (x->x_ns_cache)
-            xml_nsctx_free(x->x_ns_cache);
+        if ((xe = x->x_ext) != NULL){
+            if (xe->xe_cv)
+                cv_free(xe->xe_cv);
+            if (xe->xe_ns_cache)
+                xml_nsctx_free(xe->xe_ns_cache);
 #ifdef XML_EXPLICIT_INDEX
-        xml_search_index_free(x);
+            xml_search_index_free(x);
+#endif
+#ifdef XML_KEY_INDEX
+            xml_key_index_free(x);
 #endif
-        if (x->x_creators)
-            cvec_free(x->x_creators);
+#ifdef XML_ORDER_INDEX
+            xml_order_index_free(x);
+#endif
+#ifdef XML_KEY_ENCODE
+            if (xe->xe_key)
+                free(xe->xe_key);
+#endif
+            if (xe->xe_creators)
+                cvec_free(xe->xe_creators);
+            if (xe->xe_lazy)
+                free(xe->xe_lazy);
+            free(xe);
+            __atomic_sub_fetch(&_stats_ext_nr, 1, __ATOMIC_RELAXED);
+        }
         break;
     case CX_BODY:
     case CX_ATTR:
-        if (x->x_value_cb)
-            cbuf_free(x->x_value_cb);  
+        xml_value_release(XB(x));
         break;
     default:
         break;
     }
-    free(x);
-    _stats_xml_nr--;
+    if (x->x_arena){
+        xa = XML_ARENA(x);
+        if (--xa->xa_nodes == 0)
+            xml_arena_free(xa);
+    }
+    else
+        free(x);
+    __atomic_sub_fetch(&_stats_xml_nr, 1, __ATOMIC_RELAXED);
     return 0;
 }
 
@@ -2085,18 +3790,19 @@ int
 xml_copy_one(cxobj *x0, 
              cxobj *x1)
 {
-    int   retval = -1;
-    char *s;
+    int                      retval = -1;
+    char                    *s;
+    struct xml_value_shared *xv;
     
     if (x0 == NULL || x1 == NULL){
         clicon_err(OE_XML, EINVAL, "x0 or x1 is NULL");
         goto done;
     }
     xml_type_set(x1, xml_type(x0));
-    if ((s = xml_name(x0))) /* malloced string */
+    if ((s = xml_name(x0))) /* interned string */
         if ((xml_name_set(x1, s)) < 0)
             goto done;
-    if ((s = xml_prefix(x0))) /* malloced string */
+    if ((s = xml_prefix(x0))) /* interned string */
         if ((xml_prefix_set(x1, s)) < 0)
             goto done;
     switch (xml_type(x0)){
@@ -2107,16 +3813,17 @@ xml_copy_one(cxobj *x0,
         break;
     case CX_BODY:
     case CX_ATTR:
-        if ((s = xml_value(x0))){ /* malloced string */
-            if (xml_value_set(x1, s) < 0)
+        if (xml_value_share(x0, &xv) < 0)
+            goto done;
+        if ((s = xml_value(x0))){ /* malloced or shared string */
+            if (xml_value_set0(x1, s, xv) < 0)
                 goto done;
-
         }
         break;
     default:
         break;
     }
-    xml_flag_set(x1, xml_flag(x0, XML_FLAG_DEFAULT | XML_FLAG_TOP)); /* Maybe more flags */
+    xml_flag_set(x1, xml_flag(x0, XML_FLAG_DEFAULT | XML_FLAG_TOP | XML_FLAG_DIRTY | XML_FLAG_WDTAG)); /* Maybe more flags */
     retval = 0;
  done:
     return retval;
@@ -2141,24 +3848,175 @@ int
 xml_copy(cxobj *x0, 
          cxobj *x1)
 {
-    int    retval = -1;
-    cxobj *x;
-    cxobj *xcopy;
+    int     retval = -1;
+    cxobj  *x;
+    cxobj  *xcopy;
+    cg_var *cv;
 
     if (xml_copy_one(x0, x1) <0)
         goto done;
-    x = NULL;
-    while ((x = xml_child_each(x0, x, -1)) != NULL) {
+    x = NULL; /* Unparsed content is copied as is */
+    while ((x = xml_child_each(x0, x, xml_lazy(x0) ? CX_ATTR : -1)) != NULL) {
+        if (clixon_event_yield() < 0) /* Safe point of a long RPC */
+            goto done;
         if ((xcopy = xml_new(xml_name(x), x1, xml_type(x))) == NULL)
             goto done;
         if (xml_copy(x, xcopy) < 0) /* recursion */
             goto done;
     }
+    if (xml_lazy(x0) && xml_lazy_set(x1, xml_lazy(x0), strlen(xml_lazy(x0))) < 0)
+        goto done;
+    /* Copy typed value after body, since setting the body clears it */
+    if ((cv = xml_cv(x0)) != NULL && xml_cv_native(cv_type_get(cv))){
+        if ((cv = cv_dup(cv)) == NULL){
+            clicon_err(OE_UNIX, errno, "cv_dup");
+            goto done;
+        }
+        if (xml_cv_set(x1, cv) < 0)
+            goto done;
+    }
     retval = 0;
   done:
     return retval;
 }
 
+/*! Make existing xml tree x1 equal to x0, keeping nodes of x1 that already match
+ *
+ * Alternative to free x1 and xml_copy(x0, x1) when x0 and x1 are nearly equal, such as
+ * candidate and running after a commit. Children are matched by position: where type,
+ * name and value presence agree the pair is synced recursively, otherwise the child of
+ * x1 is replaced by a copy of the child of x0. Unchanged subtrees are therefore only
+ * compared, not freed and re-allocated.
+ * @param[in]  x0  Source XML tree
+ * @param[in]  x1  Destination XML tree (must exist and be of same type as x0)
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @note Inserting or removing an entry in the middle of a list shifts the positions, and
+ *       the remaining entries of that list are then synced value by value
+ * @see xml_copy
+ */
+int
+xml_sync(cxobj *x0,
+         cxobj *x1)
+{
+    int    retval = -1;
+    int    i;
+    int    n;
+    cxobj *xc0;
+    cxobj *xc1;
+    cxobj *xcopy;
+    int    attr = 0;
+    struct xml_value_shared *xv;
+
+    if (x0 == NULL || x1 == NULL){
+        clicon_err(OE_XML, EINVAL, "x0 or x1 is NULL");
+        goto done;
+    }
+    if (xml_type(x0) != xml_type(x1)){
+        clicon_err(OE_XML, EINVAL, "type mismatch");
+        goto done;
+    }
+    if (xml_name_set(x1, xml_name(x0)) < 0)
+        goto done;
+    if (xml_prefix_set(x1, xml_prefix(x0)) < 0)
+        goto done;
+    switch (xml_type(x0)){
+    case CX_ELMNT:
+        xml_spec_set(x1, xml_spec(x0));
+        if (XE(x1, xe_creators)){
+            cvec_free(x1->x_ext->xe_creators);
+            x1->x_ext->xe_creators = NULL;
+        }
+        if (xml_creator_copy(x0, x1) < 0)
+            goto done;
+        break;
+    case CX_BODY:
+    case CX_ATTR:
+        if (xml_value(x0) == NULL || xml_value_cmp(x0, x1) == 0)
+            break;
+        if (xml_value_share(x0, &xv) < 0)
+            goto done;
+        /* Existing search index is re-sorted by xml_value_set */
+        if (xml_value_set0(x1, xml_value(x0), xv) < 0)
+            goto done;
+        break;
+    default:
+        break;
+    }
+    /* As xml_copy_one, but x1 is now equal to x0 and not dirty */
+    x1->x_flags = 0;
+    xml_flag_set(x1, xml_flag(x0, XML_FLAG_DEFAULT | XML_FLAG_TOP));
+    if (!is_element(x0))
+        goto ok;
+    if (xml_lazy(x0) || xml_lazy(x1)){ /* Unparsed content is replaced as a whole */
+        if (xml_lazy_set(x1, NULL, 0) < 0)
+            goto done;
+        while ((i = xml_child_nr(x1)) > 0){
+            xc1 = xml_child_i(x1, i-1);
+            if (xml_child_rm(x1, i-1) < 0)
+                goto done;
+            xml_free(xc1);
+        }
+        xc0 = NULL;
+        while ((xc0 = xml_child_each(x0, xc0, xml_lazy(x0) ? CX_ATTR : -1)) != NULL){
+            if ((xcopy = xml_new(xml_name(xc0), x1, xml_type(xc0))) == NULL)
+                goto done;
+            if (xml_copy(xc0, xcopy) < 0)
+                goto done;
+        }
+        if (xml_lazy(x0) && xml_lazy_set(x1, xml_lazy(x0), strlen(xml_lazy(x0))) < 0)
+            goto done;
+        nscache_clear(x1);
+        goto ok;
+    }
+    n = xml_child_nr(x0);
+    for (i=0; i<n; i++){
+        xc0 = xml_child_i(x0, i);
+        if (xml_type(xc0) == CX_ATTR)
+            attr++;
+        if ((xc1 = xml_child_i(x1, i)) != NULL &&
+            xml_type(xc1) == xml_type(xc0) &&
+            xml_name(xc1) == xml_name(xc0) && /* interned strings */
+            (xml_value(xc0) != NULL || xml_value(xc1) == NULL)){
+            if (xml_sync(xc0, xc1) < 0) /* recursion */
+                goto done;
+            continue;
+        }
+        if (xc1 != NULL){
+            if (xml_type(xc1) == CX_ATTR)
+                attr++;
+            if (xml_child_rm(x1, i) < 0)
+                goto done;
+            xml_free(xc1);
+        }
+        if ((xcopy = xml_new0(xml_name(xc0), NULL, xml_type(xc0),
+                              x1->x_arena ? XML_ARENA(x1) : NULL)) == NULL)
+            goto done;
+        if (xml_child_insert_pos(x1, xcopy, i) < 0){
+            xml_free(xcopy);
+            goto done;
+        }
+        xml_parent_set(xcopy, x1);
+        if (xml_copy(xc0, xcopy) < 0)
+            goto done;
+    }
+    while ((i = xml_child_nr(x1)) > n){
+        xc1 = xml_child_i(x1, i-1);
+        if (xml_type(xc1) == CX_ATTR)
+            attr++;
+        if (xml_child_rm(x1, i-1) < 0)
+            goto done;
+        xml_free(xc1);
+    }
+    /* Namespace declarations may have changed */
+    if (attr)
+        nscache_clear(x1);
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Create and return a copy of xml tree.
  *
  * @code
@@ -2294,7 +4152,7 @@ xml_apply(cxobj          *xn,
     cxobj     *x;
     int        ret;
 
-    if (!is_element(xn))
+    if (!is_element(xn) || xml_lazy(xn)) /* Unparsed content is not traversed */
         return 0;
     x = NULL;
     while ((x = xml_child_each(xn, x, type)) != NULL) {
@@ -2733,8 +4591,10 @@ xml_search_index_free(cxobj *x)
 {
     struct search_index *si;
 
-    while ((si = x->x_search_index) != NULL) {
-        DELQ(si, x->x_search_index, struct search_index *);
+    if (x->x_ext == NULL)
+        return 0;
+    while ((si = x->x_ext->xe_search_index) != NULL) {
+        DELQ(si, x->x_ext->xe_search_index, struct search_index *);
         if (si->si_name)
             free(si->si_name);
         if (si->si_xvec)
@@ -2755,7 +4615,10 @@ xml_search_index_add(cxobj *x,
                      char  *name)
 {
     struct search_index *si = NULL;
+    struct xml_ext      *xe;
 
+    if ((xe = xml_ext_get(x)) == NULL)
+        goto done;
     if ((si = malloc(sizeof(struct search_index))) == NULL){
         clicon_err(OE_XML, errno, "malloc");
         goto done;
@@ -2773,7 +4636,7 @@ xml_search_index_add(cxobj *x,
         si = NULL;
         goto done;
     }
-    ADDQ(si, x->x_search_index);
+    ADDQ(si, xe->xe_search_index);
  done:
     return si;
 }
@@ -2790,14 +4653,14 @@ xml_search_index_get(cxobj *x,
 {
     struct search_index *si = NULL;
 
-    if ((si = x->x_search_index) != NULL) {
+    if ((si = XE(x, xe_search_index)) != NULL) {
         do {
             if (strcmp(si->si_name, name) == 0){
                 goto done;
                 break;
             }
             si = NEXTQ(struct search_index *, si);
-        } while (si && si != x->x_search_index);
+        } while (si && si != x->x_ext->xe_search_index);
     }
  done:
     return si;
@@ -2819,48 +4682,95 @@ xml_search_vector_get(cxobj        *xp,
     struct search_index *si;
 
     *xvec = NULL;
-    if ((si = xp->x_search_index) != NULL) {
+    if ((si = XE(xp, xe_search_index)) != NULL) {
         do {
             if (strcmp(si->si_name, name) == 0){
                 *xvec = si->si_xvec;
                 break;
             }
             si = NEXTQ(struct search_index *, si);
-        } while (si && si != xp->x_search_index);
+        } while (si && si != xp->x_ext->xe_search_index);
     }
     return 0;
 }
 
-/*! Insert a new cxobj into search index vector for list for variable "name"
- * @param[in] xp XML parent object (the list element)
- * @param[in] xi XML index object (that should be added)
+/*! Find position of list entry in a search index vector
+ *
+ * Several entries may have the same index value, look for exactly xp among them
+ * @param[in]  si    Search index
+ * @param[in]  xp    XML list entry
+ * @param[out] posp  Position of xp if found, otherwise where xp should be inserted
+ * @retval     1     Found
+ * @retval     0     Not found
+ * @retval    -1     Error
  */
-int
-xml_search_child_insert(cxobj *xp,
-                        cxobj *xi)
+static int
+xml_search_index_pos(struct search_index *si,
+                     cxobj               *xp,
+                     int                 *posp)
+{
+    int    len;
+    int    pos;
+    int    eq = 0;
+    int    i;
+    cxobj *xc;
+
+    len = clixon_xvec_len(si->si_xvec);
+    if ((pos = xml_search_indexvar_binary_pos(xp, si->si_name, si->si_xvec, 0, len, len, &eq)) < 0)
+        return -1;
+    *posp = pos;
+    if (!eq)
+        return 0;
+    for (i=pos; i>=0; i--){
+        if ((xc = clixon_xvec_i(si->si_xvec, i)) == xp){
+            *posp = i;
+            return 1;
+        }
+        if (xml_cmp(xp, xc, 0, 0, si->si_name) != 0)
+            break;
+    }
+    for (i=pos+1; i<len; i++){
+        if ((xc = clixon_xvec_i(si->si_xvec, i)) == xp){
+            *posp = i;
+            return 1;
+        }
+        if (xml_cmp(xp, xc, 0, 0, si->si_name) != 0)
+            break;
+    }
+    return 0;
+}
+
+/*! Insert list entry into search index vector of its parent
+ * @param[in] xpp    XML parent of list entry, where search vector is placed
+ * @param[in] xp     XML list entry
+ * @param[in] xi     XML index object of xp
+ * @param[in] create If 0 and vector does not exist, do nothing
+ */
+static int
+xml_search_child_insert1(cxobj *xpp,
+                         cxobj *xp,
+                         cxobj *xi,
+                         int    create)
 {
     int                  retval = -1;
     char                *indexvar;
     struct search_index *si;
-    cxobj               *xpp;
     int                  i;
-    int                  len;
+    int                  ret;
     
     indexvar = xml_name(xi);
-    if ((xpp = xml_parent(xp)) == NULL)
-        goto ok;
     /* Find base vector in grandparent */
     if ((si = xml_search_index_get(xpp, indexvar)) == NULL){
+        if (!create)
+            goto ok;
         /* If not found add base vector in grand-parent */            
         if ((si = xml_search_index_add(xpp, indexvar)) == NULL)
             goto done;
     }
-    /* Find element position using binary search and then remove */
-    len = clixon_xvec_len(si->si_xvec);
-    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, NULL)) < 0)
+    /* Find element position using binary search and then insert, unless already there */
+    if ((ret = xml_search_index_pos(si, xp, &i)) < 0)
         goto done;
-    assert(clixon_xvec_i(si->si_xvec, i) != xp);
-    if (clixon_xvec_insert_pos(si->si_xvec, xp, i) < 0)
+    if (ret == 0 && clixon_xvec_insert_pos(si->si_xvec, xp, i) < 0)
         goto done;
  ok:
     retval = 0;
@@ -2868,6 +4778,50 @@ xml_search_child_insert(cxobj *xp,
     return retval;
 }
 
+/*! Remove list entry from search index vector of its parent
+ * @param[in] xpp  XML parent of list entry, where search vector is placed
+ * @param[in] xp   XML list entry
+ * @param[in] xi   XML index object of xp
+ */
+static int
+xml_search_child_rm1(cxobj *xpp,
+                     cxobj *xp,
+                     cxobj *xi)
+{
+    int                  retval = -1;
+    struct search_index *si;
+    int                  i;
+    int                  ret;
+    
+    /* Find base vector in grandparent */
+    if ((si = xml_search_index_get(xpp, xml_name(xi))) == NULL)
+        goto ok;
+    /* Find element using binary search and then remove */
+    if ((ret = xml_search_index_pos(si, xp, &i)) < 0)
+        goto done;
+    if (ret == 1 && clixon_xvec_rm_pos(si->si_xvec, i) < 0)
+        goto done;          
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Insert a new cxobj into search index vector for list for variable "name"
+ * @param[in] xp XML parent object (the list element)
+ * @param[in] xi XML index object (that should be added)
+ */
+int
+xml_search_child_insert(cxobj *xp,
+                        cxobj *xi)
+{
+    cxobj *xpp;
+
+    if ((xpp = xml_parent(xp)) == NULL)
+        return 0;
+    return xml_search_child_insert1(xpp, xp, xi, 1);
+}
+
 /*! Remove a single cxobj from search vector 
  * @param[in] xp  XML parent object (the list element)
  * @param[in] xi  XML index object (that should be added)
@@ -2876,35 +4830,157 @@ int
 xml_search_child_rm(cxobj *xp,
                     cxobj *xi)
 {
-    int                 retval = -1;
-    cxobj              *xpp;
-    char               *indexvar;
-    int                 i;
-    int                 len;
-    struct search_index *si;
-    int                  eq = 0;
-    
-    indexvar = xml_name(xi);
+    cxobj *xpp;
+
     if ((xpp = xml_parent(xp)) == NULL)
+        return 0;
+    return xml_search_child_rm1(xpp, xp, xi);
+}
+
+/* Index variable name used by xml_search_index_qsort */
+static char *_search_index_name = NULL;
+
+static int
+xml_search_index_qsort(const void* arg1, 
+                       const void* arg2)
+{
+    return xml_cmp(*(struct xml**)arg1, *(struct xml**)arg2, 0, 0, _search_index_name);
+}
+
+/*! Build search index vector of all list entries of a parent, if not already present
+ *
+ * Vectors are otherwise created when list entries are bound to yang
+ * @param[in]  xp    XML parent of list entries
+ * @param[in]  yc    Yang list
+ * @param[in]  name  Name of index variable
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+xml_search_index_build(cxobj     *xp,
+                       yang_stmt *yc,
+                       char      *name)
+{
+    int                  retval = -1;
+    struct search_index *si;
+    cxobj              **vec = NULL;
+    int                  len = 0;
+    int                  i;
+    xml_child_it         it;
+    cxobj               *xc;
+    cxobj               *xi;
+
+    if (xml_search_index_get(xp, name) != NULL)
         goto ok;
-    /* Find base vector in grandparent */
-    if ((si = xml_search_index_get(xpp, indexvar)) == NULL)
-        goto ok;
-    
-    /* Find element using binary search and then remove */
-    len = clixon_xvec_len(si->si_xvec);
-    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, &eq)) < 0)
+    if ((vec = calloc(xml_child_nr(xp)+1, sizeof(cxobj *))) == NULL){
+        clicon_err(OE_XML, errno, "calloc");
+        goto done;
+    }
+    xml_child_it_init(&it, xp, CX_ELMNT);
+    while ((xc = xml_child_it_next(&it)) != NULL){
+        if (xml_spec(xc) != yc)
+            continue;
+        if ((xi = xml_find_type(xc, NULL, name, CX_ELMNT)) == NULL ||
+            !xml_search_index_p(xi))
+            continue;
+        vec[len++] = xc;
+    }
+    _search_index_name = name;
+    qsort(vec, len, sizeof(cxobj *), xml_search_index_qsort);
+    _search_index_name = NULL;
+    if ((si = xml_search_index_add(xp, name)) == NULL)
         goto done;
-        //    if (clixon_xvec_i(si->si_xvec, i) == xp)
-    if (eq)
-        if (clixon_xvec_rm_pos(si->si_xvec, i) < 0)
-            goto done;          
+    for (i=0; i<len; i++)
+        if (clixon_xvec_append(si->si_xvec, vec[i]) < 0)
+            goto done;
  ok:
     retval = 0;
  done:
+    if (vec)
+        free(vec);
     return retval;
 }
 
+/*! Update search indexes when a child is added to or removed from a parent
+ *
+ * Either xc is a list entry whose index variables are added to or removed from the search
+ * vectors of xp, or xc is an index variable of list entry xp.
+ * This ensures the vectors never refer to entries that are not children of the parent.
+ * @param[in] xp   XML parent
+ * @param[in] xc   XML child, added to xp or about to be removed from xp
+ * @param[in] add  1: add to search vectors, 0: remove
+ * @retval    0    OK
+ * @retval   -1    Error
+ */
+static int
+xml_search_child_update(cxobj *xp,
+                        cxobj *xc,
+                        int    add)
+{
+    yang_stmt   *y;
+    xml_child_it it;
+    cxobj       *xi;
+    cxobj       *xpp;
+
+    if (xml_type(xc) != CX_ELMNT || (y = xml_spec(xc)) == NULL)
+        return 0;
+    if (yang_flag_get(y, YANG_FLAG_INDEX)){
+        if ((y = xml_spec(xp)) == NULL || yang_keyword_get(y) != Y_LIST ||
+            (xpp = xml_parent(xp)) == NULL)
+            return 0;
+        if (add)
+            return xml_search_child_insert1(xpp, xp, xc, 0);
+        return xml_search_child_rm1(xpp, xp, xc);
+    }
+    if (yang_flag_get(y, YANG_FLAG_INDEX_LIST) == 0)
+        return 0;
+    if (!add && XE(xp, xe_search_index) == NULL)
+        return 0;
+    xml_child_it_init(&it, xc, CX_ELMNT);
+    while ((xi = xml_child_it_next(&it)) != NULL){
+        if ((y = xml_spec(xi)) == NULL || yang_flag_get(y, YANG_FLAG_INDEX) == 0)
+            continue;
+        if (add){
+            if (xml_search_child_insert1(xp, xc, xi, 0) < 0)
+                return -1;
+        }
+        else if (xml_search_child_rm1(xp, xc, xi) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Check if value change of a body affects a search index, if so remove its list entry
+ *
+ * The entry is re-inserted with xml_search_child_insert after the value is changed
+ * @param[in]  xb   XML body
+ * @param[out] xip  Index variable whose entry was removed from index vector, or NULL
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_search_value_pre(cxobj  *xb,
+                     cxobj **xip)
+{
+    cxobj *xi;
+    cxobj *xp;
+    cxobj *xpp;
+
+    *xip = NULL;
+    if (xml_type(xb) != CX_BODY ||
+        (xi = xml_parent(xb)) == NULL ||
+        !xml_search_index_p(xi))
+        return 0;
+    xp = xml_parent(xi);
+    xpp = xml_parent(xp);
+    if (xml_search_index_get(xpp, xml_name(xi)) == NULL)
+        return 0;
+    if (xml_search_child_rm1(xpp, xp, xi) < 0)
+        return -1;
+    *xip = xi;
+    return 0;
+}
+
 /*! Iterator over xml children objects using (explicit) index variable
  *
  * @param[in] xparent xml tree node whose children should be iterated
@@ -0,0 +1,663 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Clixon binary XML encoding, used as datastore format (CLICON_XMLDB_FORMAT = binary)
+ * and for internal protocol replies (CLICON_PROTO_BINARY)
+ * The file is read by mapping it into memory, there is no text parsing.
+ * All integers are 32-bit unsigned in network byte order:
+ *
+ *   header:  "CLXB" <version> <nstrings> <strtab-len>
+ *   strtab:  { <len> <bytes> '\0' }*             Names and prefixes, each stored once
+ *   node:    <type:8> <name> <prefix+1>           Index into strtab, prefix 0 means none
+ *   element: <node> <nchildren> <len> <child>*    len is byte length of all children
+ *   attr/body: <node> <len> <bytes> '\0'          Value
+ *
+ * The byte length of element children makes it possible to skip a subtree without decoding it.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <arpa/inet.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_options.h"
+#include "clixon_xml_bind.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_io.h"
+#include "clixon_xml_binary.h"
+
+/*
+ * Constants
+ */
+#define XML_BINARY_HDRLEN 16 /* magic, version, nstrings, strtab-len */
+
+/*! Binary encoder state
+ */
+struct xml_binary_enc {
+    clicon_hash_t *xe_strhash; /* String -> index in string table */
+    uint32_t       xe_nstrings;
+    cbuf          *xe_strtab;  /* String table */
+    cbuf          *xe_nodes;   /* Node stream */
+};
+
+/*! Binary decoder state, a memory buffer such as a mapped file
+ */
+struct xml_binary_dec {
+    const char    *xd_buf;     /* Buffer, eg mapped file */
+    size_t         xd_len;     /* Length of buffer */
+    size_t         xd_pos;     /* Current position in node stream */
+    uint32_t       xd_nstrings;
+    const char   **xd_strings; /* Vector of strings in string table, pointing into xd_buf */
+};
+
+/*! Append a 32-bit integer in network byte order to a cbuf
+ */
+static int
+binary_put32(cbuf    *cb,
+             uint32_t u)
+{
+    uint32_t n = htonl(u);
+
+    if (cbuf_append_buf(cb, &n, sizeof(n)) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Get index of string in string table, add it if not present
+ *
+ * @param[in]  xe   Encoder state
+ * @param[in]  str  String
+ * @param[out] ip   Index in string table
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+binary_string_index(struct xml_binary_enc *xe,
+                    char                  *str,
+                    uint32_t              *ip)
+{
+    uint32_t *iv;
+    uint32_t  len;
+
+    if ((iv = clicon_hash_value(xe->xe_strhash, str, NULL)) != NULL){
+        *ip = *iv;
+        return 0;
+    }
+    *ip = xe->xe_nstrings++;
+    if (clicon_hash_add(xe->xe_strhash, str, ip, sizeof(*ip)) == NULL)
+        return -1;
+    len = strlen(str);
+    if (binary_put32(xe->xe_strtab, len) < 0)
+        return -1;
+    if (cbuf_append_buf(xe->xe_strtab, str, len+1) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Encode a default attribute of a node tagged by with-defaults report-all-tagged
+ *
+ * @param[in]  xe   Encoder state
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see XML_FLAG_WDTAG
+ */
+static int
+binary_encode_wdtag(struct xml_binary_enc *xe)
+{
+    cbuf     *cb = xe->xe_nodes;
+    uint8_t   type = CX_ATTR;
+    uint32_t  i;
+
+    if (cbuf_append_buf(cb, &type, 1) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        return -1;
+    }
+    if (binary_string_index(xe, "default", &i) < 0 ||
+        binary_put32(cb, i) < 0)
+        return -1;
+    if (binary_string_index(xe, IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX, &i) < 0 ||
+        binary_put32(cb, i+1) < 0)
+        return -1;
+    if (binary_put32(cb, strlen("true")) < 0)
+        return -1;
+    if (cbuf_append_buf(cb, "true", strlen("true")+1) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Encode an XML node and its children recursively
+ *
+ * @param[in]  xe   Encoder state
+ * @param[in]  x    XML node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+binary_encode(struct xml_binary_enc *xe,
+              cxobj                 *x)
+{
+    int       retval = -1;
+    cbuf     *cb = xe->xe_nodes;
+    uint8_t   type;
+    uint32_t  i;
+    uint32_t  n;
+    char     *prefix;
+    char     *val;
+    size_t    pos;
+    cxobj    *xc;
+
+    type = xml_type(x);
+    if (cbuf_append_buf(cb, &type, 1) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
+    if (binary_string_index(xe, xml_name(x), &i) < 0)
+        goto done;
+    if (binary_put32(cb, i) < 0)
+        goto done;
+    if ((prefix = xml_prefix(x)) == NULL)
+        i = 0;
+    else{
+        if (binary_string_index(xe, prefix, &i) < 0)
+            goto done;
+        i++;
+    }
+    if (binary_put32(cb, i) < 0)
+        goto done;
+    switch (type){
+    case CX_ELMNT:
+        if (binary_put32(cb, xml_child_nr(x) + (xml_flag(x, XML_FLAG_WDTAG)?1:0)) < 0)
+            goto done;
+        pos = cbuf_len(cb);
+        if (binary_put32(cb, 0) < 0) /* Placeholder for byte length */
+            goto done;
+        if (xml_flag(x, XML_FLAG_WDTAG) && binary_encode_wdtag(xe) < 0)
+            goto done;
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, -1)) != NULL)
+            if (binary_encode(xe, xc) < 0)
+                goto done;
+        n = htonl(cbuf_len(cb) - pos - sizeof(n));
+        memcpy(cbuf_get(cb) + pos, &n, sizeof(n));
+        break;
+    case CX_ATTR:
+    case CX_BODY:
+        if ((val = xml_value(x)) == NULL)
+            val = "";
+        n = strlen(val);
+        if (binary_put32(cb, n) < 0)
+            goto done;
+        if (cbuf_append_buf(cb, val, n+1) < 0){
+            clicon_err(OE_XML, errno, "cbuf_append_buf");
+            goto done;
+        }
+        break;
+    default:
+        break;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Append an XML tree in binary format to a cbuf
+ *
+ * The encoding may contain null bytes, use cbuf_len and not string functions on the result.
+ * @param[in]  cb   Output buffer, encoding is appended
+ * @param[in]  xn   XML tree
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon_binary_parse_buf
+ */
+int
+clixon_xml2binary_cbuf(cbuf  *cb,
+                       cxobj *xn)
+{
+    int                   retval = -1;
+    struct xml_binary_enc xe = {0,};
+
+    if (cb == NULL || xn == NULL){
+        clicon_err(OE_XML, EINVAL, "arg is NULL");
+        goto done;
+    }
+    if ((xe.xe_strhash = clicon_hash_init()) == NULL)
+        goto done;
+    if ((xe.xe_strtab = cbuf_new()) == NULL ||
+        (xe.xe_nodes = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (binary_encode(&xe, xn) < 0)
+        goto done;
+    if (cbuf_append_buf(cb, XML_BINARY_MAGIC, strlen(XML_BINARY_MAGIC)) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
+    if (binary_put32(cb, XML_BINARY_VERSION) < 0 ||
+        binary_put32(cb, xe.xe_nstrings) < 0 ||
+        binary_put32(cb, cbuf_len(xe.xe_strtab)) < 0)
+        goto done;
+    if (cbuf_append_buf(cb, cbuf_get(xe.xe_strtab), cbuf_len(xe.xe_strtab)) < 0 ||
+        cbuf_append_buf(cb, cbuf_get(xe.xe_nodes), cbuf_len(xe.xe_nodes)) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (xe.xe_strhash)
+        clicon_hash_free(xe.xe_strhash);
+    if (xe.xe_strtab)
+        cbuf_free(xe.xe_strtab);
+    if (xe.xe_nodes)
+        cbuf_free(xe.xe_nodes);
+    return retval;
+}
+
+/*! Write an XML tree in binary format to a file
+ *
+ * @param[in]  f    Output file
+ * @param[in]  xn   XML tree, typically a datastore top-level
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon_binary_parse_file
+ */
+int
+clixon_xml2binary_file(FILE  *f,
+                       cxobj *xn)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if (f == NULL || xn == NULL){
+        clicon_err(OE_XML, EINVAL, "arg is NULL");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2binary_cbuf(cb, xn) < 0)
+        goto done;
+    if (fwrite(cbuf_get(cb), 1, cbuf_len(cb), f) != cbuf_len(cb)){
+        clicon_err(OE_UNIX, errno, "fwrite");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Read a 32-bit integer in network byte order with bounds check
+ */
+static int
+binary_get32(struct xml_binary_dec *xd,
+             uint32_t              *up)
+{
+    uint32_t n;
+
+    if (xd->xd_pos + sizeof(n) > xd->xd_len){
+        clicon_err(OE_XML, EFAULT, "Binary datastore truncated at %zu", xd->xd_pos);
+        return -1;
+    }
+    memcpy(&n, xd->xd_buf + xd->xd_pos, sizeof(n)); /* May be unaligned */
+    xd->xd_pos += sizeof(n);
+    *up = ntohl(n);
+    return 0;
+}
+
+/*! Get a length-prefixed and null-terminated string with bounds check
+ *
+ * @param[in]  xd   Decoder state
+ * @param[out] sp   Pointer to string in mapped file
+ */
+static int
+binary_getstr(struct xml_binary_dec *xd,
+              const char           **sp)
+{
+    uint32_t len;
+
+    if (binary_get32(xd, &len) < 0)
+        return -1;
+    if (len >= xd->xd_len - xd->xd_pos || xd->xd_buf[xd->xd_pos + len] != '\0'){
+        clicon_err(OE_XML, EFAULT, "Binary datastore malformed string at %zu", xd->xd_pos);
+        return -1;
+    }
+    *sp = xd->xd_buf + xd->xd_pos;
+    xd->xd_pos += len + 1;
+    return 0;
+}
+
+/*! Decode an XML node and its children recursively
+ *
+ * @param[in]  xd   Decoder state
+ * @param[in]  xp   XML parent
+ * @param[out] xret Created XML node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+binary_decode(struct xml_binary_dec *xd,
+              cxobj                 *xp,
+              cxobj                **xret)
+{
+    int         retval = -1;
+    uint8_t     type;
+    uint32_t    name;
+    uint32_t    prefix;
+    uint32_t    nchildren;
+    uint32_t    len;
+    uint32_t    i;
+    size_t      end;
+    const char *val;
+    cxobj      *x = NULL;
+
+    if (xd->xd_pos >= xd->xd_len){
+        clicon_err(OE_XML, EFAULT, "Binary datastore truncated at %zu", xd->xd_pos);
+        goto done;
+    }
+    type = xd->xd_buf[xd->xd_pos++];
+    if (binary_get32(xd, &name) < 0 ||
+        binary_get32(xd, &prefix) < 0)
+        goto done;
+    if (name >= xd->xd_nstrings || prefix > xd->xd_nstrings ||
+        (type != CX_ELMNT && type != CX_ATTR && type != CX_BODY)){
+        clicon_err(OE_XML, EFAULT, "Binary datastore malformed node at %zu", xd->xd_pos);
+        goto done;
+    }
+    if ((x = xml_new((char*)xd->xd_strings[name], xp, type)) == NULL)
+        goto done;
+    if (prefix && xml_prefix_set(x, (char*)xd->xd_strings[prefix-1]) < 0)
+        goto done;
+    if (type == CX_ELMNT){
+        if (binary_get32(xd, &nchildren) < 0 ||
+            binary_get32(xd, &len) < 0)
+            goto done;
+        if (len > xd->xd_len - xd->xd_pos){
+            clicon_err(OE_XML, EFAULT, "Binary datastore truncated at %zu", xd->xd_pos);
+            goto done;
+        }
+        end = xd->xd_pos + len;
+        for (i=0; i<nchildren; i++)
+            if (binary_decode(xd, x, NULL) < 0)
+                goto done;
+        if (xd->xd_pos != end){
+            clicon_err(OE_XML, EFAULT, "Binary datastore length mismatch at %zu", xd->xd_pos);
+            goto done;
+        }
+    }
+    else {
+        if (binary_getstr(xd, &val) < 0)
+            goto done;
+        if (xml_value_set(x, (char*)val) < 0)
+            goto done;
+    }
+    if (xret)
+        *xret = x;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Parse an XML tree in binary format from a memory buffer
+ *
+ * Semantics as clixon_xml_parse_string: if *xt is NULL, a top-level node is created and the
+ * encoded tree is added as a child.
+ * @param[in]     buf   Buffer in binary format, eg written by clixon_xml2binary_cbuf
+ * @param[in]     len   Length of buffer
+ * @param[in]     yb    How to bind yang to XML top-level: YB_NONE, YB_MODULE or YB_RPC
+ * @param[in]     yspec Yang specification, or NULL
+ * @param[in,out] xt    Pointer to XML parse tree. If empty will be created.
+ * @param[out]    xerr  Reason for failure (yang assignment not made) if retval = 0
+ * @retval        1     Parse OK and all yang assignment made
+ * @retval        0     Parse OK but yang assigment not made (or only partial), xerr is set
+ * @retval       -1     Error with clicon_err called. Includes malformed buffer
+ * @see clixon_xml_parse_string
+ */
+int
+clixon_binary_parse_buf(const char *buf,
+                        size_t      len,
+                        yang_bind   yb,
+                        yang_stmt  *yspec,
+                        cxobj     **xt,
+                        cxobj     **xerr)
+{
+    int                   retval = -1;
+    struct xml_binary_dec xd = {0,};
+    uint32_t              version;
+    uint32_t              tlen;
+    uint32_t              i;
+    cxobj                *x = NULL;
+    int                   created = 0;
+    int                   ret;
+
+    if (xt == NULL || buf == NULL){
+        clicon_err(OE_XML, EINVAL, "arg is NULL");
+        return -1;
+    }
+    if (yb != YB_MODULE && yb != YB_RPC && yb != YB_NONE){
+        clicon_err(OE_XML, EINVAL, "yb is %d but should be module, rpc or none", yb);
+        return -1;
+    }
+    if (yb != YB_NONE && yspec == NULL){
+        clicon_err(OE_XML, EINVAL, "yspec is required if yb is module or rpc");
+        return -1;
+    }
+    if (*xt == NULL){
+        if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        created++;
+    }
+    xd.xd_buf = buf;
+    xd.xd_len = len;
+    if (xd.xd_len < XML_BINARY_HDRLEN ||
+        memcmp(xd.xd_buf, XML_BINARY_MAGIC, strlen(XML_BINARY_MAGIC)) != 0){
+        clicon_err(OE_XML, EFAULT, "Not a binary datastore file");
+        goto done;
+    }
+    xd.xd_pos = strlen(XML_BINARY_MAGIC);
+    if (binary_get32(&xd, &version) < 0)
+        goto done;
+    if (version != XML_BINARY_VERSION){
+        clicon_err(OE_XML, EFAULT, "Binary datastore version %u, expected %u",
+                   version, XML_BINARY_VERSION);
+        goto done;
+    }
+    if (binary_get32(&xd, &xd.xd_nstrings) < 0 ||
+        binary_get32(&xd, &tlen) < 0)
+        goto done;
+    if (tlen > xd.xd_len - xd.xd_pos || xd.xd_nstrings > tlen){
+        clicon_err(OE_XML, EFAULT, "Binary datastore malformed string table");
+        goto done;
+    }
+    if ((xd.xd_strings = calloc(xd.xd_nstrings + 1, sizeof(char*))) == NULL){
+        clicon_err(OE_XML, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<xd.xd_nstrings; i++)
+        if (binary_getstr(&xd, &xd.xd_strings[i]) < 0)
+            goto done;
+    if (binary_decode(&xd, *xt, &x) < 0)
+        goto done;
+    if (xd.xd_pos != xd.xd_len){
+        clicon_err(OE_XML, EFAULT, "Binary datastore trailing data at %zu", xd.xd_pos);
+        goto done;
+    }
+    switch (yb){
+    case YB_MODULE:
+        if ((ret = xml_bind_yang0(NULL, x, YB_MODULE, yspec, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        break;
+    case YB_RPC:
+        if ((ret = xml_bind_yang_rpc(NULL, x, yspec, xerr)) < 0)
+            goto done;
+        if (ret == 0){ /* Add message-id */
+            if (*xerr && clixon_xml_attr_copy(x, *xerr, "message-id") < 0)
+                goto done;
+            goto fail;
+        }
+        break;
+    default:
+        break;
+    }
+    if (yb != YB_NONE)
+        if (xml_sort_recurse(*xt) < 0)
+            goto done;
+    retval = 1;
+ done:
+    if (retval < 0 && created && *xt){
+        xml_free(*xt);
+        *xt = NULL;
+    }
+    if (xd.xd_strings)
+        free(xd.xd_strings);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Read an XML tree in binary format from a file
+ *
+ * The file is mapped into memory and decoded directly, as opposed to the text formats.
+ * Streams that are not regular files, eg decompressing streams, are first read to a buffer.
+ * Semantics as clixon_xml_parse_file: if *xt is NULL, a top-level node is created and the
+ * encoded tree is added as a child.
+ * @param[in]     f     File in binary format, eg written by clixon_xml2binary_file
+ * @param[in]     yb    How to bind yang to XML top-level: YB_NONE or YB_MODULE
+ * @param[in]     yspec Yang specification, or NULL
+ * @param[in,out] xt    Pointer to XML parse tree. If empty will be created.
+ * @param[out]    xerr  Reason for failure (yang assignment not made) if retval = 0
+ * @retval        1     Parse OK and all yang assignment made
+ * @retval        0     Parse OK but yang assigment not made (or only partial), xerr is set
+ * @retval       -1     Error with clicon_err called. Includes malformed file
+ * @see clixon_xml_parse_file
+ */
+int
+clixon_binary_parse_file(FILE      *f,
+                         yang_bind  yb,
+                         yang_stmt *yspec,
+                         cxobj    **xt,
+                         cxobj    **xerr)
+{
+    int          retval = -1;
+    struct stat  st;
+    void        *buf = MAP_FAILED;
+    cbuf        *cbr = NULL;
+    char         rbuf[BUFSIZ];
+    size_t       n;
+
+    if (xt == NULL || f == NULL){
+        clicon_err(OE_XML, EINVAL, "arg is NULL");
+        return -1;
+    }
+    if (yb != YB_MODULE && yb != YB_NONE){
+        clicon_err(OE_XML, EINVAL, "yb is %d but should be module or none", yb);
+        return -1;
+    }
+    if (fileno(f) < 0){
+        /* Not a regular file, eg a decompressing stream: read it to a buffer */
+        if ((cbr = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        while ((n = fread(rbuf, 1, sizeof(rbuf), f)) > 0)
+            if (cbuf_append_buf(cbr, rbuf, n) < 0){
+                clicon_err(OE_XML, errno, "cbuf_append_buf");
+                goto done;
+            }
+        if (ferror(f)){
+            clicon_err(OE_UNIX, errno, "fread");
+            goto done;
+        }
+        if (cbuf_len(cbr) == 0)
+            goto empty;
+        retval = clixon_binary_parse_buf(cbuf_get(cbr), cbuf_len(cbr), yb, yspec, xt, xerr);
+    }
+    else {
+        if (fstat(fileno(f), &st) < 0){
+            clicon_err(OE_UNIX, errno, "fstat");
+            goto done;
+        }
+        if (st.st_size == 0) /* Empty file, eg newly created datastore */
+            goto empty;
+        if ((buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0)) == MAP_FAILED){
+            clicon_err(OE_UNIX, errno, "mmap");
+            goto done;
+        }
+        retval = clixon_binary_parse_buf(buf, st.st_size, yb, yspec, xt, xerr);
+    }
+ done:
+    if (buf != MAP_FAILED)
+        munmap(buf, st.st_size);
+    if (cbr)
+        cbuf_free(cbr);
+    return retval;
+ empty:
+    if (*xt == NULL &&
+        (*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    retval = 1;
+    goto done;
+}
@@ -162,12 +162,20 @@ populate_self_parent(cxobj     *xt,
     char      *ns = NULL;    /* XML namespace of xt */
     char      *nsy = NULL;   /* Yang namespace of xt */
     cbuf      *cb = NULL;
+    uint16_t   nsid = 0;     /* Namespace id if verified */
+    char      *px;
+    char      *ps;
 
     name = xml_name(xt);
     /* optimization for massive lists - use the first element as role model */
     if (xsibling &&
         xml_child_nr_type(xt, CX_ATTR) == 0){
         y = xml_spec(xsibling);
+        px = xml_prefix(xt);
+        ps = xml_prefix(xsibling);
+        if ((px == NULL && ps == NULL) ||
+            (px != NULL && ps != NULL && strcmp(px, ps) == 0))
+            nsid = xml_nsid(xsibling);
         goto set;
     }
     xp = xml_parent(xt);
@@ -230,8 +238,11 @@ populate_self_parent(cxobj     *xt,
             goto done;
         goto fail;
     }
+    nsid = yang_nsid_get(y);
  set:
     xml_spec_set(xt, y);
+    if (nsid)
+        xml_nsid_set(xt, nsid);
 #ifdef XML_EXPLICIT_INDEX
     if (xml_search_index_p(xt))
         xml_search_child_insert(xp, xt);
@@ -340,6 +351,7 @@ populate_self_top(cxobj     *xt,
         goto fail;
     }
     xml_spec_set(xt, y);
+    xml_nsid_set(xt, yang_nsid_get(y));
     retval = 1;
  done:
     if (cb)
@@ -350,6 +362,52 @@ populate_self_top(cxobj     *xt,
     goto done;
 }
 
+/*! Bind typed value of a leaf or leaf-list to the XML node
+ *
+ * Integer, boolean and decimal64 values are parsed once and kept in the node until the
+ * value changes, so that sorting, xpath comparisons and validation use native values.
+ * Invalid values are not bound, and are reported by validation.
+ * @param[in]   xt     XML node with yang spec
+ * @retval      0      OK
+ * @retval     -1      Error
+ * @see XML_BIND_VALUE
+ * @see xml_cv_native
+ */
+int
+xml_bind_value(cxobj *xt)
+{
+#ifdef XML_BIND_VALUE
+    int        retval = -1;
+    yang_stmt *y;
+    cg_var    *cv = NULL;
+    char      *reason = NULL;
+    int        ret;
+
+    if ((y = xml_spec(xt)) == NULL ||
+        (yang_keyword_get(y) != Y_LEAF && yang_keyword_get(y) != Y_LEAF_LIST) ||
+        xml_body(xt) == NULL ||
+        xml_cv(xt) != NULL)
+        goto ok;
+    if ((ret = xml_cv_parse(xt, 1, &cv, &reason)) < 0)
+        goto done;
+    if (ret == 1 && cv != NULL){
+        if (xml_cv_set(xt, cv) < 0)
+            goto done;
+        cv = NULL;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    if (cv)
+        cv_free(cv);
+    return retval;
+#else
+    return 0;
+#endif
+}
+
 /*! Find yang spec association of tree of XML nodes
  *
  * Populate xt:s children as top-level symbols
@@ -451,6 +509,8 @@ xml_bind_yang0_opt(clicon_handle h,
     else if (ret == 2)     /* ret=2 for anyxml from parent^ */
         goto ok;
     strip_body_objects(xt);
+    if (xml_bind_value(xt) < 0)
+        goto done;
     ybc = YB_PARENT;
     if (h && clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
         yspec1 = NULL;
@@ -561,6 +621,8 @@ xml_bind_yang0(clicon_handle h,
     else if (ret == 2)     /* ret=2 for anyxml from parent^ */
         goto ok;
     strip_body_objects(xt);
+    if (xml_bind_value(xt) < 0)
+        goto done;
     xc = NULL;     /* Apply on children */
     while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL) {
         if ((ret = xml_bind_yang0_opt(h, xc, YB_PARENT, yspec, NULL, xerr)) < 0)
@@ -0,0 +1,370 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+
+ * Build state data trees bound to yang from native C values
+ * State callbacks, see plgstatedata_t, may add state to the xstate tree with these functions
+ * instead of printing XML text and parsing it. Nodes are bound to yang when they are created,
+ * and a tree built this way is not bound again by the backend.
+ * Example:
+ *   cxobj *xs;
+ *   cxobj *xi;
+ *
+ *   if ((xs = xml_build_path(yspec, xstate, "/if:interfaces-state")) == NULL)
+ *      err;
+ *   if (xml_childvec_reserve(xs, nr) < 0) // optional
+ *      err;
+ *   for (i=0; i<nr; i++){
+ *      if ((xi = xml_build_child(xs, "interface")) == NULL ||
+ *          xml_build_str(xi, "name", ifs[i].name) == NULL ||
+ *          xml_build_uint(xi, "in-octets", ifs[i].in_octets) == NULL)
+ *         err;
+ *   }
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <string.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xml_build.h"
+
+/*! Set namespace of a new node, relative to its parent
+ *
+ * If the parent has the namespace of the yang node as default, nothing is done. If a
+ * prefix of the namespace is declared, it is used as prefix of the node. Otherwise the
+ * namespace is declared as default namespace of the node.
+ * @param[in]  xp   Parent, or NULL
+ * @param[in]  x    New node
+ * @param[in]  y    Yang of new node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_build_ns(cxobj     *xp,
+             cxobj     *x,
+             yang_stmt *y)
+{
+    char *ns;
+    char *ns0 = NULL;
+    char *prefix = NULL;
+    int   ret;
+
+    if ((ns = yang_find_mynamespace(y)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No namespace of %s", yang_argument_get(y));
+        return -1;
+    }
+    if (xp != NULL){
+        if (xml2ns(xp, NULL, &ns0) < 0)
+            return -1;
+        if (ns0 && strcmp(ns0, ns) == 0)
+            return 0;
+        if ((ret = xml2prefix(xp, ns, &prefix)) < 0)
+            return -1;
+        if (ret == 1)
+            return xml_prefix_set(x, prefix);
+    }
+    return xmlns_set(x, NULL, ns);
+}
+
+/*! Create an element bound to a yang data node
+ *
+ * @param[in]  xp   Parent
+ * @param[in]  y    Yang data node
+ * @retval     x    New node
+ * @retval     NULL Error
+ */
+static cxobj *
+xml_build_node(cxobj     *xp,
+               yang_stmt *y)
+{
+    cxobj *x;
+
+    if ((x = xml_new(yang_argument_get(y), xp, CX_ELMNT)) == NULL)
+        return NULL;
+    xml_spec_set(x, y);
+    if (xml_build_ns(xp, x, y) < 0){
+        xml_purge(x);
+        return NULL;
+    }
+    return x;
+}
+
+/*! Find yang of child of a bound node
+ *
+ * @param[in]  xp   Parent bound to yang
+ * @param[in]  name Name of child
+ * @param[in]  leaf 1: child is a leaf or leaf-list, 0: container or list
+ * @retval     y    Yang of child
+ * @retval     NULL Error, not bound or not found
+ */
+static yang_stmt *
+xml_build_yang(cxobj *xp,
+               char  *name,
+               int    leaf)
+{
+    yang_stmt    *yp;
+    yang_stmt    *y;
+    enum rfc_6020 keyw;
+
+    if ((yp = xml_spec(xp)) == NULL){
+        clicon_err(OE_XML, EINVAL, "Parent %s of %s is not bound to yang", xml_name(xp), name);
+        return NULL;
+    }
+    if ((y = yang_find_datanode(yp, name)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang node %s in %s", name, yang_argument_get(yp));
+        return NULL;
+    }
+    keyw = yang_keyword_get(y);
+    if (leaf ? (keyw != Y_LEAF && keyw != Y_LEAF_LIST) : (keyw != Y_CONTAINER && keyw != Y_LIST)){
+        clicon_err(OE_YANG, EINVAL, "Yang node %s is a %s", name, yang_key2str(keyw));
+        return NULL;
+    }
+    return y;
+}
+
+/*! Find or create a container child bound to a yang container
+ *
+ * @param[in]  xp   Parent, eg top of state tree, or node bound to the yang parent of y
+ * @param[in]  y    Yang container
+ * @retval     x    Existing or new container node
+ * @retval     NULL Error
+ */
+cxobj *
+xml_build_top(cxobj     *xp,
+              yang_stmt *y)
+{
+    cxobj *x = NULL;
+
+    if (yang_keyword_get(y) != Y_CONTAINER){
+        clicon_err(OE_YANG, EINVAL, "Yang node %s is not a container", yang_argument_get(y));
+        return NULL;
+    }
+    while ((x = xml_child_each(xp, x, CX_ELMNT)) != NULL)
+        if (xml_spec(x) == y)
+            return x;
+    return xml_build_node(xp, y);
+}
+
+/*! Find or create the containers of an absolute schema node path in a state tree
+ *
+ * Containers that exist are reused, so that several calls add to the same subtree
+ * @see xml_build_top  if the yang of the container is known, faster and with no prefixes
+ * @param[in]  yspec  Yang spec
+ * @param[in]  xt     Top of state tree, eg xstate of plgstatedata_t
+ * @param[in]  path   Absolute schema node id of a container, eg /if:interfaces-state
+ * @retval     x      Container node of path
+ * @retval     NULL   Error, eg path not found or not containers
+ */
+cxobj *
+xml_build_path(yang_stmt *yspec,
+               cxobj     *xt,
+               char      *path)
+{
+    yang_stmt  *y = NULL;
+    yang_stmt  *yv[32];
+    int         n = 0;
+    cxobj      *xp = xt;
+
+    if (yang_abs_schema_nodeid(yspec, path, &y) < 0)
+        return NULL;
+    if (y == NULL){
+        clicon_err(OE_YANG, ENOENT, "Schema node %s not found", path);
+        return NULL;
+    }
+    for (; y != NULL && yang_keyword_get(y) != Y_MODULE && yang_keyword_get(y) != Y_SUBMODULE;
+         y = yang_parent_get(y)){
+        if (yang_keyword_get(y) == Y_CHOICE || yang_keyword_get(y) == Y_CASE)
+            continue;
+        if (yang_keyword_get(y) != Y_CONTAINER){
+            clicon_err(OE_YANG, EINVAL, "%s is not a path of containers", path);
+            return NULL;
+        }
+        if (n == sizeof(yv)/sizeof(yv[0])){
+            clicon_err(OE_YANG, E2BIG, "%s is too deep", path);
+            return NULL;
+        }
+        yv[n++] = y;
+    }
+    while (n--)
+        if ((xp = xml_build_top(xp, yv[n])) == NULL)
+            return NULL;
+    return xp;
+}
+
+/*! Add a container or list entry child to a bound node
+ *
+ * List keys are then added with xml_build_str and other leaf functions, first
+ * @param[in]  xp   Parent bound to yang
+ * @param[in]  name Name of container or list
+ * @retval     x    New node
+ * @retval     NULL Error
+ */
+cxobj *
+xml_build_child(cxobj *xp,
+                char  *name)
+{
+    yang_stmt *y;
+
+    if ((y = xml_build_yang(xp, name, 0)) == NULL)
+        return NULL;
+    return xml_build_node(xp, y);
+}
+
+/*! Add a leaf or leaf-list child with a string value to a bound node
+ *
+ * @param[in]  xp   Parent bound to yang
+ * @param[in]  name Name of leaf or leaf-list
+ * @param[in]  val  Value, not escaped. Prefixes of identityref values must be declared
+ * @retval     x    New node
+ * @retval     NULL Error
+ */
+cxobj *
+xml_build_str(cxobj *xp,
+              char  *name,
+              char  *val)
+{
+    yang_stmt *y;
+    cxobj     *x;
+    cxobj     *xb;
+
+    if ((y = xml_build_yang(xp, name, 1)) == NULL)
+        return NULL;
+    if ((x = xml_build_node(xp, y)) == NULL)
+        return NULL;
+    if ((xb = xml_new("body", x, CX_BODY)) == NULL ||
+        xml_value_set(xb, val) < 0){
+        xml_purge(x);
+        return NULL;
+    }
+    return x;
+}
+
+/*! Add a leaf or leaf-list child with a signed integer value to a bound node
+ *
+ * @param[in]  xp   Parent bound to yang
+ * @param[in]  name Name of leaf or leaf-list, eg of type int32
+ * @param[in]  val  Value
+ * @retval     x    New node
+ * @retval     NULL Error
+ */
+cxobj *
+xml_build_int(cxobj  *xp,
+              char   *name,
+              int64_t val)
+{
+    char buf[24];
+
+    snprintf(buf, sizeof(buf), "%" PRId64, val);
+    return xml_build_str(xp, name, buf);
+}
+
+/*! Add a leaf or leaf-list child with an unsigned integer value to a bound node
+ *
+ * @param[in]  xp   Parent bound to yang
+ * @param[in]  name Name of leaf or leaf-list, eg of type uint64 or yang:counter64
+ * @param[in]  val  Value
+ * @retval     x    New node
+ * @retval     NULL Error
+ */
+cxobj *
+xml_build_uint(cxobj   *xp,
+               char    *name,
+               uint64_t val)
+{
+    char buf[24];
+
+    snprintf(buf, sizeof(buf), "%" PRIu64, val);
+    return xml_build_str(xp, name, buf);
+}
+
+/*! Add a leaf or leaf-list child with a boolean value to a bound node
+ *
+ * @param[in]  xp   Parent bound to yang
+ * @param[in]  name Name of leaf or leaf-list of type boolean
+ * @param[in]  val  Value, 0 is false
+ * @retval     x    New node
+ * @retval     NULL Error
+ */
+cxobj *
+xml_build_bool(cxobj *xp,
+               char  *name,
+               int    val)
+{
+    return xml_build_str(xp, name, val ? "true" : "false");
+}
+
+/*! Check if all elements of a tree are bound to yang, eg built with these functions
+ *
+ * Children of anydata and anyxml nodes are not checked.
+ * @param[in]  xt   Top of tree, not checked
+ * @retval     1    All elements below xt are bound
+ * @retval     0    At least one element is not bound
+ */
+int
+xml_build_bound(cxobj *xt)
+{
+    cxobj        *x = NULL;
+    yang_stmt    *y;
+    enum rfc_6020 keyw;
+
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL){
+        if ((y = xml_spec(x)) == NULL)
+            return 0;
+        keyw = yang_keyword_get(y);
+        if (keyw == Y_ANYDATA || keyw == Y_ANYXML)
+            continue;
+        if (xml_build_bound(x) == 0)
+            return 0;
+    }
+    return 1;
+}
@@ -319,6 +319,7 @@ changelog_op(clicon_handle h,
  * @param[in]  h   Clicon handle
  * @param[in]  xt  Changelog list
  * @param[in]  xn  XML to upgrade
+ * @note The xpaths of the steps are parsed once and then found in the xpath cache, see XPATH_CACHE
  */
 static int
 changelog_iterate(clicon_handle h,
@@ -327,16 +328,14 @@ changelog_iterate(clicon_handle h,
 
 {
     int        retval = -1;
-    cxobj    **vec = NULL;
-    size_t     veclen;
+    cxobj     *xi = NULL;
     int        ret;
-    int        i;
     
-    if (xpath_vec(xch, NULL, "step", &vec, &veclen) < 0)
-        goto done;
     /* Iterate through changelog items */
-    for (i=0; i<veclen; i++){
-        if ((ret = changelog_op(h, xt, vec[i])) < 0)
+    while ((xi = xml_child_each(xch, xi, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xi), "step") != 0)
+            continue;
+        if ((ret = changelog_op(h, xt, xi)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
@@ -344,8 +343,6 @@ changelog_iterate(clicon_handle h,
     retval = 1;
  done:
     clicon_debug(1, "%s retval: %d", __FUNCTION__, retval);
-    if (vec)
-        free(vec);
     return retval;
  fail:
     retval = 0;
@@ -378,12 +375,9 @@ xml_changelog_upgrade(clicon_handle h,
 {
     int        retval = -1;
     cxobj     *xchlog; /* changelog */
-    cxobj    **vec = NULL;
     cxobj     *xch;
-    size_t     veclen;
     char      *b;
     int        ret;
-    int        i;
     uint32_t   f;
     uint32_t   t;
 
@@ -397,13 +391,14 @@ xml_changelog_upgrade(clicon_handle h,
     /* Iterate and find relevant changelog entries in the interval:
      * - find all changelogs in the interval: [from, to]
      * - note it t=0 then no changelog is applied
+     * Changelogs of other namespaces are skipped without xpath evaluation
      */
-    if (xpath_vec(xchlog, NULL, "changelog[namespace=\"%s\"]", 
-                  &vec, &veclen, ns) < 0)
-        goto done;
-    /* Get all changelogs in the interval [from,to]*/
-    for (i=0; i<veclen; i++){
-        xch = vec[i];
+    xch = NULL;
+    while ((xch = xml_child_each(xchlog, xch, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xch), "changelog") != 0 ||
+            (b = xml_find_body(xch, "namespace")) == NULL ||
+            strcmp(b, ns) != 0)
+            continue;
         f = t = 0;
         if ((b = xml_find_body(xch, "revfrom")) != NULL)
             if (ys_parse_date_arg(b, &f) < 0)
@@ -421,8 +416,6 @@ xml_changelog_upgrade(clicon_handle h,
  ok:
     retval = 1;
  done:
-    if (vec)
-        free(vec);
     return retval;
  fail:
     retval = 0;
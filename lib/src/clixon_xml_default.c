@@ -71,6 +71,7 @@
 #include "clixon_xml_sort.h"
 #include "clixon_xml_nsctx.h"
 #include "clixon_xml_map.h"
+#include "clixon_yang_module.h"
 #include "clixon_xml_default.h"
 
 /* Forward */
@@ -409,6 +410,8 @@ xml_default_recurse(cxobj *xn,
             if (!state && !yang_config(y))
                 continue;
         }
+        if (xml_lazy(x) != NULL) /* Unparsed anydata */
+            continue;
         if (xml_default_recurse(x, state) < 0)
             goto done;
     }
@@ -456,8 +459,9 @@ xml_global_defaults_create(cxobj     *xt,
  * @param[in]   state   Set if global state, otherwise config
  * @retval      0       OK
  * @retval      -1      Error
- * Uses cache?
+ * The global defaults tree, and its parts matching the most recent xpaths, are cached
  * @see xml_default_recurse
+ * @see XML_DEFAULTS_CACHE_SIZE
  */
 int
 xml_global_defaults(clicon_handle h,
@@ -478,7 +482,40 @@ xml_global_defaults(clicon_handle h,
     cxobj     *x0;
     int        ret;
     char      *key;
+    cxobj     *xparts;
+    cxobj     *xp;
+    cxobj     *xa;
+    cxobj     *xc;
+    cg_var    *cv;
+    cbuf      *cbk = NULL;
     
+    /* Parts are cached per xpath and namespace context */
+    if ((cbk = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbk, "%s", xpath?xpath:"/");
+    cv = NULL;
+    while (nsc && (cv = cvec_each(nsc, cv)) != NULL)
+        cprintf(cbk, " %s=%s", cv_name_get(cv)?cv_name_get(cv):"", cv_string_get(cv));
+    key = state ? "global-defaults-state-xpath" : "global-defaults-config-xpath";
+    if ((de = clicon_db_elmnt_get(h, key)) == NULL || de->de_xml == NULL){
+        if ((xparts = xml_new(key, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        de0.de_xml = xparts;
+        clicon_db_elmnt_set(h, key, &de0);
+    }
+    else
+        xparts = de->de_xml;
+    xp = NULL;
+    while ((xp = xml_child_each(xparts, xp, CX_ELMNT)) != NULL)
+        if (strcmp(xml_find_type_value(xp, NULL, "key", CX_ATTR), cbuf_get(cbk)) == 0)
+            break;
+    if (xp != NULL){
+        if ((xpart = xml_dup(xml_find_type(xp, NULL, DATASTORE_TOP_SYMBOL, CX_ELMNT))) == NULL)
+            goto done;
+        goto merge;
+    }
     /* Use different keys for config and state */
     key = state ? "global-defaults-state" : "global-defaults-config";
     /* First get or compute global xml tree cache */
@@ -512,15 +549,32 @@ xml_global_defaults(clicon_handle h,
         goto done;
     if (xml_copy_marked(xcache, xpart) < 0) /* config */
         goto done;
-    if (xml_apply(xcache, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
+    if (xml_flag_reset_rec(xcache, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
         goto done;
-    if (xml_apply(xpart, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
+    if (xml_flag_reset_rec(xpart, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
         goto done;
+    /* Cache a copy of the part, replace the oldest if full */
+    if (xml_child_nr_type(xparts, CX_ELMNT) >= XML_DEFAULTS_CACHE_SIZE &&
+        (xc = xml_child_i_type(xparts, 0, CX_ELMNT)) != NULL)
+        xml_purge(xc);
+    if ((xp = xml_new("part", xparts, CX_ELMNT)) == NULL)
+        goto done;
+    if ((xa = xml_new("key", xp, CX_ATTR)) == NULL)
+        goto done;
+    if (xml_value_set(xa, cbuf_get(cbk)) < 0)
+        goto done;
+    if ((xc = xml_dup(xpart)) == NULL)
+        goto done;
+    if (xml_addsub(xp, xc) < 0)
+        goto done;
+ merge:
     /* Merge global pruned tree with xt */
     if ((ret = xml_merge(xt, xpart, yspec, NULL)) < 1) /* XXX reason */
         goto done;
     retval = 0;
  done:
+    if (cbk)
+        cbuf_free(cbk);
     if (xpart)
         xml_free(xpart);
     if (xvec)
@@ -597,9 +651,11 @@ xml_defaults_nopresence(cxobj *xn,
     return retval;
 }
 
-/*! Add default attribute to node with default value.
+/*! Tag node with default value with a default attribute.
  *
  * Used in with-default code for report-all-tagged
+ * No attribute is added to the tree, the node is flagged and the attribute is generated when
+ * the tree is printed, see XML_FLAG_WDTAG
  * @param[in]   x       XML node
  * @param[in]   flags   Flags indicatiing default nodes
  * @retval      0       OK
@@ -609,16 +665,10 @@ int
 xml_add_default_tag(cxobj *x,
                     uint16_t flags)
 {
-    int retval = -1;
-
-    if (xml_flag(x, flags)) {
-        /* set default attribute */
-        if (xml_add_attr(x, "default", "true", IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX, NULL) < 0)
-            goto done;
-    }
-    retval = 0;
- done:
-    return retval;
+    if (xml_flag(x, flags) &&
+        xml_find_type(x, IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX, "default", CX_ATTR) == NULL)
+        xml_flag_set(x, XML_FLAG_WDTAG);
+    return 0;
 }
 
 /*! Set flag on node having schema default value. (non-config)
@@ -696,3 +746,222 @@ xml_flag_default_value(cxobj   *x,
   done:
     return 0;
 }
+
+/*! Check if a yang non-presence container may be created by default values
+ *
+ * @param[in]  yc   Yang container, choice or case
+ * @retval     1    There is a default leaf or leaf-list below yc, not in a list
+ * @retval     0    No
+ */
+static int
+xml_default_yang_below(yang_stmt *yc)
+{
+    yang_stmt *y;
+
+    y = NULL;
+    while ((y = yn_each(yc, y)) != NULL){
+        switch (yang_keyword_get(y)){
+        case Y_LEAF:
+        case Y_LEAF_LIST:
+            if (yang_find(y, Y_DEFAULT, NULL) != NULL)
+                return 1;
+            break;
+        case Y_CONTAINER:
+            if (yang_find(y, Y_PRESENCE, NULL) != NULL)
+                break;
+            /* fall thru */
+        case Y_CHOICE:
+        case Y_CASE:
+            if (xml_default_yang_below(y))
+                return 1;
+            break;
+        default:
+            break;
+        }
+    }
+    return 0;
+}
+
+/*! Check that an xpath predicate only tests keys of a list, or positions
+ *
+ * @param[in]  ylist  Yang list
+ * @param[in]  xs     XPATH predicate tree
+ * @retval     1      Only keys and positions
+ * @retval     0      May test other nodes
+ */
+static int
+xml_defaults_xpath_pred(yang_stmt  *ylist,
+                        xpath_tree *xs)
+{
+    int lastkey;
+
+    if (xs == NULL)
+        return 1;
+    switch (xs->xs_type){
+    case XP_ABSPATH:
+    case XP_PRIME_FN:
+    case XP_NODE_FN:
+    case XP_FILTEREXPR:
+        return 0;
+    case XP_STEP:
+        if (xs->xs_int != A_CHILD)
+            return 0;
+        break;
+    case XP_NODE:
+        if (xs->xs_s1 == NULL || yang_key_match(ylist, xs->xs_s1, &lastkey) != 1)
+            return 0;
+        break;
+    default:
+        break;
+    }
+    return xml_defaults_xpath_pred(ylist, xs->xs_c0) &&
+        xml_defaults_xpath_pred(ylist, xs->xs_c1);
+}
+
+/*! Check a step of an xpath location path, see xml_defaults_xpath
+ *
+ * @param[in]  yspec  Top-level yang spec
+ * @param[in]  nsc    XML namespace context
+ * @param[in]  xs     XPATH step
+ * @param[in]  yp     Yang of previous step, or NULL if first step
+ * @param[out] ys     Yang of this step
+ * @retval     1      Step does not select or test default nodes
+ * @retval     0      Step may select or test default nodes
+ */
+static int
+xml_defaults_xpath_step(yang_stmt  *yspec,
+                        cvec       *nsc,
+                        xpath_tree *xs,
+                        yang_stmt  *yp,
+                        yang_stmt **ys)
+{
+    xpath_tree *xnode;
+    yang_stmt  *ymod;
+    yang_stmt  *y = NULL;
+    char       *ns;
+
+    if (xs == NULL || xs->xs_type != XP_STEP || xs->xs_int != A_CHILD)
+        return 0;
+    if ((xnode = xs->xs_c0) == NULL || xnode->xs_type != XP_NODE ||
+        xnode->xs_s1 == NULL || strcmp(xnode->xs_s1, "*") == 0)
+        return 0;
+    if (yp != NULL)
+        y = yang_find_datanode(yp, xnode->xs_s1);
+    else if (nsc && (ns = xml_nsctx_get(nsc, xnode->xs_s0)) != NULL){
+        if ((ymod = yang_find_module_by_namespace(yspec, ns)) != NULL)
+            y = yang_find_datanode(ymod, xnode->xs_s1);
+    }
+    else {
+        ymod = NULL;
+        while ((ymod = yn_each(yspec, ymod)) != NULL)
+            if (yang_keyword_get(ymod) == Y_MODULE &&
+                (y = yang_find_datanode(ymod, xnode->xs_s1)) != NULL)
+                break;
+    }
+    if (y == NULL)
+        return 0;
+    switch (yang_keyword_get(y)){
+    case Y_LIST:
+        if (!xml_defaults_xpath_pred(y, xs->xs_c1))
+            return 0;
+        break;
+    case Y_CONTAINER:
+        if (xs->xs_c1 != NULL)
+            return 0;
+        /* Top-level containers are created by global defaults */
+        if (yp != NULL &&
+            yang_find(y, Y_PRESENCE, NULL) == NULL &&
+            xml_default_yang_below(y))
+            return 0;
+        break;
+    case Y_LEAF:
+    case Y_LEAF_LIST:
+        if (xs->xs_c1 != NULL || yang_find(y, Y_DEFAULT, NULL) != NULL)
+            return 0;
+        break;
+    default:
+        return 0;
+    }
+    *ys = y;
+    return 1;
+}
+
+/*! Check the steps of a relative location path, see xml_defaults_xpath
+ *
+ * @param[in]  yspec  Top-level yang spec
+ * @param[in]  nsc    XML namespace context
+ * @param[in]  xs     XPATH relative location path
+ * @param[out] ys     Yang of last step
+ * @retval     1      Steps do not select or test default nodes
+ * @retval     0      Steps may select or test default nodes
+ */
+static int
+xml_defaults_xpath_steps(yang_stmt  *yspec,
+                         cvec       *nsc,
+                         xpath_tree *xs,
+                         yang_stmt **ys)
+{
+    yang_stmt *yp = NULL;
+
+    if (xs == NULL || xs->xs_type != XP_RELLOCPATH)
+        return 0;
+    if (xs->xs_c1 == NULL)
+        return xml_defaults_xpath_step(yspec, nsc, xs->xs_c0, NULL, ys);
+    if (xs->xs_int == A_DESCENDANT_OR_SELF)
+        return 0;
+    if (xml_defaults_xpath_steps(yspec, nsc, xs->xs_c0, &yp) == 0)
+        return 0;
+    return xml_defaults_xpath_step(yspec, nsc, xs->xs_c1, yp, ys);
+}
+
+/*! Check if default values can be added to the result of an xpath instead of the tree
+ *
+ * This is the case if the xpath does not select or test nodes that may be default nodes,
+ * or non-presence containers created by default values, below the top-level. Then a tree
+ * without default values can be searched, and default values added to copies of the
+ * matching nodes with xml_default_recurse and to the result with xml_global_defaults.
+ * Conservatively, only "/" and absolute location paths of named child steps are recognized,
+ * where list predicates only test keys or positions, eg /a:x/a:y[a:k='1']/a:z
+ * @param[in]  yspec  Top-level yang spec
+ * @param[in]  nsc    XML namespace context
+ * @param[in]  xpath  XPATH, or NULL for "/"
+ * @retval     1      Default values can be added to the result
+ * @retval     0      Default values may be needed to evaluate the xpath
+ * @retval    -1      Error
+ * @see xmldb_get_cache where this is used to not add default values to the cache
+ */
+int
+xml_defaults_xpath(yang_stmt  *yspec,
+                   cvec       *nsc,
+                   const char *xpath)
+{
+    int         retval = -1;
+    xpath_tree *xptree = NULL;
+    xpath_tree *xs;
+    yang_stmt  *y = NULL;
+
+    if (xpath == NULL || strcmp(xpath, "/") == 0)
+        return 1;
+    if (xpath_parse(xpath, &xptree) < 0)
+        goto done;
+    xs = xptree;
+    /* Skip expressions without operators down to the location path */
+    while (xs != NULL &&
+           (xs->xs_type == XP_EXP || xs->xs_type == XP_AND || xs->xs_type == XP_RELEX ||
+            xs->xs_type == XP_ADD || xs->xs_type == XP_UNION || xs->xs_type == XP_PATHEXPR) &&
+           xs->xs_int == A_NAN && xs->xs_c1 == NULL)
+        xs = xs->xs_c0;
+    retval = 0;
+    if (xs == NULL || xs->xs_type != XP_LOCPATH || (xs = xs->xs_c0) == NULL)
+        goto done;
+    if (xs->xs_type != XP_ABSPATH || xs->xs_int != A_ROOT)
+        goto done;
+    if (xs->xs_c0 == NULL)
+        retval = 1;
+    else
+        retval = xml_defaults_xpath_steps(yspec, nsc, xs->xs_c0, &y);
+ done:
+    if (xptree)
+        xpath_tree_free(xptree);
+    return retval;
+}
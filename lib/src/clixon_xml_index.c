@@ -0,0 +1,809 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2020-2023 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Hash index of YANG list entries on key values
+ *
+ * Exact key lookup in large lists is otherwise made with binary search, where each
+ * comparison looks up the key leafs of the visited entry and compares them as typed values.
+ * A hash index maps the key values of an entry directly to the entry. An index is created
+ * on demand per parent and list, the first time a list with at least XML_KEY_INDEX_THRESHOLD
+ * children is searched.
+ * The index does not order anything: iteration and range search still use the
+ * sorted child vector.
+ *
+ * The index of a parent is kept up to date by the child vector primitives in clixon_xml.c:
+ * - Appended/inserted entries are put on a pending list and hashed at next lookup, when
+ *   their keys are in place.
+ * - Removed entries are removed from the index.
+ * - If a key of an already hashed entry is changed, the index is dropped and rebuilt at
+ *   next lookup.
+ * Only config lists where all keys resolve to the string type are indexed, since string
+ * equality is then the same as typed equality used by xml_cmp.
+ * With XML_KEY_ENCODE, entries are instead hashed on their encoded keys, and lists with
+ * string and integer keys are indexed. If an entry has keys that cannot be encoded, such as
+ * an integer not in canonical form, the index is disabled and binary search is used.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_yang_type.h"
+#include "clixon_xml_vec.h"
+#include "clixon_xml_index.h"
+#include "clixon_xml_key.h"
+
+#ifdef XML_KEY_INDEX
+
+/* Initial number of hash buckets, power of 2 */
+#define XML_KEY_INDEX_SIZE_START 256
+
+/*! An indexed list entry, member of a hash bucket chain
+ */
+struct xml_key_entry{
+    struct xml_key_entry *ke_next;  /* Next entry in same bucket */
+    uint32_t              ke_hash;  /* Hash value of key values */
+    cxobj                *ke_x;     /* List entry */
+};
+
+/*! Hash index of one list under one parent
+ *
+ * A parent may have several indexes, one for each list, in a linked list
+ */
+struct xml_key_index{
+    struct xml_key_index  *ki_next;    /* Next index of same parent */
+    yang_stmt             *ki_yang;    /* Yang list statement */
+    int                    ki_enabled; /* If 0, list is not indexable, use binary search */
+    struct xml_key_entry **ki_bucket;  /* Vector of hash buckets */
+    size_t                 ki_size;    /* Number of buckets, power of 2 */
+    size_t                 ki_nr;      /* Number of hashed entries */
+    clixon_xvec           *ki_pending; /* Added entries not yet hashed */
+};
+
+#ifdef XML_KEY_ENCODE
+/*! Check if all keys of a yang list can be encoded
+ *
+ * @param[in]  yc   Yang list
+ * @retval     1    All keys are strings or integers
+ * @retval     0    No, or not a keyed list
+ */
+static int
+key_index_strings(yang_stmt *yc)
+{
+    yang_keycmp *yk;
+    int          i;
+
+    if (yang_cvec_get(yc) == NULL || (yk = yang_keycmp_get(yc)) == NULL || yk->yk_len == 0)
+        return 0;
+    for (i=0; i<yk->yk_len; i++)
+        if (yk->yk_keys[i].yk_class == YK_GENERIC)
+            return 0;
+    return 1;
+}
+
+#else /* XML_KEY_ENCODE */
+/*! Check if all keys of a yang list are of string type
+ *
+ * @param[in]  yc   Yang list
+ * @retval     1    All keys are strings
+ * @retval     0    No, or not a keyed list
+ * @retval    -1    Error
+ */
+static int
+key_index_strings(yang_stmt *yc)
+{
+    cvec        *cvk;
+    cg_var      *cvi = NULL;
+    yang_stmt   *yk;
+    yang_stmt   *yrestype = NULL;
+    enum cv_type cvtype;
+
+    if ((cvk = yang_cvec_get(yc)) == NULL || cvec_len(cvk) == 0)
+        return 0;
+    while ((cvi = cvec_each(cvk, cvi)) != NULL){
+        if ((yk = yang_find(yc, Y_LEAF, cv_string_get(cvi))) == NULL)
+            return 0;
+        if (yang_type_get(yk, NULL, &yrestype, NULL, NULL, NULL, NULL, NULL) < 0)
+            return -1;
+        if (yrestype == NULL)
+            return 0;
+        yang2cv_type(yang_argument_get(yrestype), &cvtype);
+        if (cvtype != CGV_STRING)
+            return 0;
+    }
+    return 1;
+}
+#endif /* XML_KEY_ENCODE */
+
+/*! Get body of key leaf of list entry
+ */
+static char *
+key_body(cxobj *x,
+         char  *keyname)
+{
+    xml_child_it it;
+    cxobj       *xk;
+
+    xml_child_it_init(&it, x, CX_ELMNT);
+    while ((xk = xml_child_it_next(&it)) != NULL)
+        if (strcmp(keyname, xml_name(xk)) == 0)
+            return xml_body(xk);
+    return NULL;
+}
+
+#ifdef XML_KEY_ENCODE
+/*! Compute hash value of an encoded key (FNV-1a)
+ */
+static uint32_t
+key_hash_encoded(char  *key,
+                 size_t len)
+{
+    uint32_t h = 2166136261U;
+    size_t   i;
+
+    for (i=0; i<len; i++){
+        h ^= (uint8_t)key[i];
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*! Compute hash value of the encoded key of a list entry
+ *
+ * @param[in]  x      List entry
+ * @param[in]  cvk    Key names
+ * @param[out] hashp  Hash value
+ * @retval     1      OK
+ * @retval     0      Not all keys present, or not encodable
+ * @retval    -1      Error
+ */
+static int
+key_hash(cxobj    *x,
+         cvec     *cvk,
+         uint32_t *hashp)
+{
+    char  *key;
+    size_t len;
+    int    ret;
+
+    if ((ret = xml_key_encode(x, &key, &len)) <= 0)
+        return ret;
+    *hashp = key_hash_encoded(key, len);
+    return 1;
+}
+
+/*! Check if the encoded key of a list entry is equal to an encoded key
+ *
+ * Hashed entries normally have their encoded keys cached
+ */
+static int
+key_equal_encoded(cxobj *x,
+                  char  *key,
+                  size_t len)
+{
+    char  *xkey;
+    size_t xlen;
+
+    if (xml_key_encode(x, &xkey, &xlen) != 1)
+        return 0;
+    return xlen == len && memcmp(xkey, key, len) == 0;
+}
+
+/*! Check if encoded keys of two list entries are equal
+ */
+static int
+key_equal(cxobj *x1,
+          cxobj *x2,
+          cvec  *cvk)
+{
+    char  *key;
+    size_t len;
+
+    if (xml_key_encode(x1, &key, &len) != 1)
+        return 0;
+    return key_equal_encoded(x2, key, len);
+}
+
+/*! Check if all keys of a list entry are present
+ */
+static int
+key_complete(cxobj *x,
+             cvec  *cvk)
+{
+    cg_var *cvi = NULL;
+
+    while ((cvi = cvec_each(cvk, cvi)) != NULL)
+        if (key_body(x, cv_string_get(cvi)) == NULL)
+            return 0;
+    return 1;
+}
+
+#else /* XML_KEY_ENCODE */
+/*! Compute hash value of key values of a list entry (FNV-1a)
+ *
+ * @param[in]  x      List entry
+ * @param[in]  cvk    Key names
+ * @param[out] hashp  Hash value
+ * @retval     1      OK
+ * @retval     0      Not all keys present
+ */
+static int
+key_hash(cxobj    *x,
+         cvec     *cvk,
+         uint32_t *hashp)
+{
+    uint32_t h = 2166136261U;
+    cg_var  *cvi = NULL;
+    char    *body;
+    char    *p;
+
+    while ((cvi = cvec_each(cvk, cvi)) != NULL){
+        if ((body = key_body(x, cv_string_get(cvi))) == NULL)
+            return 0;
+        for (p = body; *p; p++){
+            h ^= (uint8_t)*p;
+            h *= 16777619U;
+        }
+        h *= 16777619U; /* separator, hash of '\0' */
+    }
+    *hashp = h;
+    return 1;
+}
+
+/*! Check if key values of two list entries are equal
+ */
+static int
+key_equal(cxobj *x1,
+          cxobj *x2,
+          cvec  *cvk)
+{
+    cg_var *cvi = NULL;
+    char   *b1;
+    char   *b2;
+
+    while ((cvi = cvec_each(cvk, cvi)) != NULL){
+        b1 = key_body(x1, cv_string_get(cvi));
+        b2 = key_body(x2, cv_string_get(cvi));
+        if (b1 == NULL || b2 == NULL || strcmp(b1, b2) != 0)
+            return 0;
+    }
+    return 1;
+}
+#endif /* XML_KEY_ENCODE */
+
+/*! Double the number of hash buckets and rehash
+ */
+static int
+key_index_grow(struct xml_key_index *ki)
+{
+    struct xml_key_entry **bucket;
+    struct xml_key_entry  *ke;
+    size_t                 size;
+    size_t                 i;
+
+    size = ki->ki_size ? 2*ki->ki_size : XML_KEY_INDEX_SIZE_START;
+    if ((bucket = calloc(size, sizeof(struct xml_key_entry *))) == NULL){
+        clicon_err(OE_XML, errno, "calloc");
+        return -1;
+    }
+    for (i=0; i<ki->ki_size; i++)
+        while ((ke = ki->ki_bucket[i]) != NULL){
+            ki->ki_bucket[i] = ke->ke_next;
+            ke->ke_next = bucket[ke->ke_hash & (size-1)];
+            bucket[ke->ke_hash & (size-1)] = ke;
+        }
+    if (ki->ki_bucket)
+        free(ki->ki_bucket);
+    ki->ki_bucket = bucket;
+    ki->ki_size = size;
+    return 0;
+}
+
+/*! Hash a list entry into an index
+ *
+ * @param[in]  ki   Key index
+ * @param[in]  x    List entry
+ * @retval     1    OK, entry hashed
+ * @retval     0    Not all keys present, entry not hashed
+ * @retval    -1    Error
+ */
+static int
+key_index_insert(struct xml_key_index *ki,
+                 cxobj                *x)
+{
+    struct xml_key_entry *ke;
+    uint32_t              h;
+    int                   ret;
+
+    if ((ret = key_hash(x, yang_cvec_get(ki->ki_yang), &h)) < 0)
+        return -1;
+    if (ret == 0){
+#ifdef XML_KEY_ENCODE
+        /* Keys in place but not encodable: the entry cannot be found with the index */
+        if (key_complete(x, yang_cvec_get(ki->ki_yang)))
+            ki->ki_enabled = 0;
+#endif
+        return 0;
+    }
+    if (ki->ki_nr >= ki->ki_size && key_index_grow(ki) < 0)
+        return -1;
+    if ((ke = malloc(sizeof(*ke))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return -1;
+    }
+    ke->ke_hash = h;
+    ke->ke_x = x;
+    ke->ke_next = ki->ki_bucket[h & (ki->ki_size-1)];
+    ki->ki_bucket[h & (ki->ki_size-1)] = ke;
+    ki->ki_nr++;
+    return 1;
+}
+
+/*! Add list entry to pending entries of index
+ */
+static int
+key_index_pending_add(struct xml_key_index *ki,
+                      cxobj                *x)
+{
+    if (ki->ki_pending == NULL &&
+        (ki->ki_pending = clixon_xvec_new()) == NULL)
+        return -1;
+    return clixon_xvec_append(ki->ki_pending, x);
+}
+
+/*! Find list entry among pending entries of index
+ *
+ * @retval  i   Position in pending vector
+ * @retval -1   Not found
+ */
+static int
+key_index_pending_find(struct xml_key_index *ki,
+                       cxobj                *x)
+{
+    int i;
+
+    if (ki->ki_pending == NULL)
+        return -1;
+    for (i=0; i<clixon_xvec_len(ki->ki_pending); i++)
+        if (clixon_xvec_i(ki->ki_pending, i) == x)
+            return i;
+    return -1;
+}
+
+/*! Check if an entry belongs to the list of an index
+ *
+ * Entries may not yet be bound to yang when added, then compare names
+ */
+static int
+key_index_member(struct xml_key_index *ki,
+                 cxobj                *x)
+{
+    yang_stmt *y;
+
+    if (xml_type(x) != CX_ELMNT)
+        return 0;
+    if ((y = xml_spec(x)) != NULL)
+        return y == ki->ki_yang;
+    return strcmp(xml_name(x), yang_argument_get(ki->ki_yang)) == 0;
+}
+
+/*! Hash pending entries whose keys are in place
+ *
+ * Entries that were moved, bound to another yang, are dropped. Entries with missing keys
+ * remain pending
+ */
+static int
+key_index_flush(cxobj                *xp,
+                struct xml_key_index *ki)
+{
+    int          retval = -1;
+    clixon_xvec *pending;
+    cxobj       *x;
+    int          i;
+    int          ret;
+
+    if ((pending = ki->ki_pending) == NULL)
+        return 0;
+    ki->ki_pending = NULL;
+    for (i=0; i<clixon_xvec_len(pending) && ki->ki_enabled; i++){
+        x = clixon_xvec_i(pending, i);
+        if (xml_parent(x) != xp || !key_index_member(ki, x))
+            continue;
+        if ((ret = key_index_insert(ki, x)) < 0)
+            goto done;
+        if (ret == 0 && key_index_pending_add(ki, x) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    clixon_xvec_free(pending);
+    return retval;
+}
+
+/*! Free a key index
+ */
+static int
+key_index_free1(struct xml_key_index *ki)
+{
+    struct xml_key_entry *ke;
+    size_t                i;
+
+    for (i=0; i<ki->ki_size; i++)
+        while ((ke = ki->ki_bucket[i]) != NULL){
+            ki->ki_bucket[i] = ke->ke_next;
+            free(ke);
+        }
+    if (ki->ki_bucket)
+        free(ki->ki_bucket);
+    if (ki->ki_pending)
+        clixon_xvec_free(ki->ki_pending);
+    free(ki);
+    return 0;
+}
+
+/*! Create key index of a list under a parent and hash existing entries
+ *
+ * @param[in]  xp   Parent XML node
+ * @param[in]  yc   Yang list
+ * @param[out] kip  Key index, linked to parent
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+key_index_create(cxobj                 *xp,
+                 yang_stmt             *yc,
+                 struct xml_key_index **kip)
+{
+    int                   retval = -1;
+    struct xml_key_index *ki = NULL;
+    xml_child_it          it;
+    cxobj                *x;
+    int                   ret;
+
+    if ((ki = malloc(sizeof(*ki))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        goto done;
+    }
+    memset(ki, 0, sizeof(*ki));
+    ki->ki_yang = yc;
+    /* Non-config lists may have several entries with same key */
+    if (yang_config_ancestor(yc) != 0){
+        if ((ret = key_index_strings(yc)) < 0)
+            goto done;
+        ki->ki_enabled = ret;
+    }
+    if (ki->ki_enabled){
+        xml_child_it_init(&it, xp, CX_ELMNT);
+        while ((x = xml_child_it_next(&it)) != NULL && ki->ki_enabled){
+            if (xml_spec(x) != yc)
+                continue;
+            if ((ret = key_index_insert(ki, x)) < 0)
+                goto done;
+            if (ret == 0 && key_index_pending_add(ki, x) < 0)
+                goto done;
+        }
+    }
+    ki->ki_next = xml_key_index_get(xp);
+    if (xml_key_index_set(xp, ki) < 0)
+        goto done;
+    *kip = ki;
+    ki = NULL;
+    retval = 0;
+ done:
+    if (ki)
+        key_index_free1(ki);
+    return retval;
+}
+
+/*! Get key index of a list under a parent, create it if list is large enough
+ *
+ * @param[in]  xp    Parent XML node
+ * @param[in]  yc    Yang list
+ * @param[out] kip   Key index, or NULL if list is not indexed
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+key_index_find(cxobj                 *xp,
+               yang_stmt             *yc,
+               struct xml_key_index **kip)
+{
+    struct xml_key_index *ki;
+
+    *kip = NULL;
+    if (yang_keyword_get(yc) != Y_LIST)
+        return 0;
+    for (ki = xml_key_index_get(xp); ki; ki = ki->ki_next)
+        if (ki->ki_yang == yc)
+            break;
+    if (ki == NULL){
+        if (xml_child_nr(xp) < XML_KEY_INDEX_THRESHOLD)
+            return 0;
+        if (key_index_create(xp, yc, &ki) < 0)
+            return -1;
+    }
+    if (ki->ki_enabled)
+        *kip = ki;
+    return 0;
+}
+
+/*! Search list entry using a key index of parent
+ *
+ * Index is created if list is large enough and not already present.
+ * @param[in]  xp    Parent XML node
+ * @param[in]  x1    Find an entry with same key values as this object
+ * @param[in]  yc    Yang list of x1
+ * @param[out] xvec  Matching entry is appended (may be empty)
+ * @retval     1     OK, search made, see xvec
+ * @retval     0     Index not applicable, use binary search
+ * @retval    -1     Error
+ * @see xml_search_yang
+ */
+int
+xml_key_index_search(cxobj       *xp,
+                     cxobj       *x1,
+                     yang_stmt   *yc,
+                     clixon_xvec *xvec)
+{
+    struct xml_key_index *ki;
+    struct xml_key_entry *ke;
+    cvec                 *cvk;
+    uint32_t              h;
+    int                   ret;
+
+    if (key_index_find(xp, yc, &ki) < 0)
+        return -1;
+    if (ki == NULL)
+        return 0;
+    cvk = yang_cvec_get(yc);
+    if ((ret = key_hash(x1, cvk, &h)) <= 0) /* Partial key, several entries may match */
+        return ret;
+    if (key_index_flush(xp, ki) < 0)
+        return -1;
+    if (!ki->ki_enabled)
+        return 0;
+    if (ki->ki_size == 0)
+        return 1;
+    for (ke = ki->ki_bucket[h & (ki->ki_size-1)]; ke; ke = ke->ke_next)
+        if (ke->ke_hash == h && key_equal(x1, ke->ke_x, cvk)){
+            if (clixon_xvec_append(xvec, ke->ke_x) < 0)
+                return -1;
+            break;
+        }
+    return 1;
+}
+
+#ifdef XML_KEY_ENCODE
+/*! Search list entry with an encoded key using a key index of parent
+ *
+ * Index is created if list is large enough and not already present.
+ * @param[in]  xp    Parent XML node
+ * @param[in]  yc    Yang list
+ * @param[in]  key   Encoded key values, see xml_key_encode_cvec
+ * @param[in]  len   Length of encoded key
+ * @param[out] xvec  Matching entry is appended (may be empty)
+ * @retval     1     OK, search made, see xvec
+ * @retval     0     Index not applicable, use binary search
+ * @retval    -1     Error
+ * @see xml_key_find
+ */
+int
+xml_key_index_search_key(cxobj       *xp,
+                         yang_stmt   *yc,
+                         char        *key,
+                         size_t       len,
+                         clixon_xvec *xvec)
+{
+    struct xml_key_index *ki;
+    struct xml_key_entry *ke;
+    uint32_t              h;
+
+    if (key_index_find(xp, yc, &ki) < 0)
+        return -1;
+    if (ki == NULL)
+        return 0;
+    if (key_index_flush(xp, ki) < 0)
+        return -1;
+    if (!ki->ki_enabled)
+        return 0;
+    if (ki->ki_size == 0)
+        return 1;
+    h = key_hash_encoded(key, len);
+    for (ke = ki->ki_bucket[h & (ki->ki_size-1)]; ke; ke = ke->ke_next)
+        if (ke->ke_hash == h && key_equal_encoded(ke->ke_x, key, len)){
+            if (clixon_xvec_append(xvec, ke->ke_x) < 0)
+                return -1;
+            break;
+        }
+    return 1;
+}
+#endif /* XML_KEY_ENCODE */
+
+/*! A child has been added to a parent, put it on the pending list of matching index
+ *
+ * @param[in]  xp   Parent XML node, with key index
+ * @param[in]  xc   Added child
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xml_key_index_add(cxobj *xp,
+                  cxobj *xc)
+{
+    struct xml_key_index *ki;
+
+    for (ki = xml_key_index_get(xp); ki; ki = ki->ki_next)
+        if (ki->ki_enabled && key_index_member(ki, xc))
+            return key_index_pending_add(ki, xc);
+    return 0;
+}
+
+/*! A child has been removed from a parent, remove it from matching index
+ *
+ * @param[in]  xp   Parent XML node, with key index
+ * @param[in]  xc   Removed child
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @note Relies on that the key of a hashed entry is not changed, see xml_key_index_changed
+ */
+int
+xml_key_index_rm(cxobj *xp,
+                 cxobj *xc)
+{
+    struct xml_key_index  *ki;
+    struct xml_key_entry **kep;
+    struct xml_key_entry  *ke;
+    uint32_t               h;
+    int                    i;
+    int                    ret;
+
+    if (xml_type(xc) != CX_ELMNT)
+        return 0;
+    for (ki = xml_key_index_get(xp); ki; ki = ki->ki_next){
+        if (!ki->ki_enabled)
+            continue;
+        if ((i = key_index_pending_find(ki, xc)) != -1)
+            return clixon_xvec_rm_pos(ki->ki_pending, i);
+        if (ki->ki_size == 0)
+            continue;
+        if ((ret = key_hash(xc, yang_cvec_get(ki->ki_yang), &h)) < 0)
+            return -1;
+        if (ret == 0)
+            continue;
+        for (kep = &ki->ki_bucket[h & (ki->ki_size-1)]; (ke = *kep) != NULL; kep = &ke->ke_next)
+            if (ke->ke_x == xc){
+                *kep = ke->ke_next;
+                free(ke);
+                ki->ki_nr--;
+                return 0;
+            }
+    }
+    return 0;
+}
+
+/*! A key leaf of a list entry may have changed, invalidate index if entry is hashed
+ *
+ * @param[in]  xp   Parent XML node, with key index
+ * @param[in]  xe   List entry, child of xp
+ * @param[in]  xk   Changed child of xe
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xml_key_index_changed(cxobj *xp,
+                      cxobj *xe,
+                      cxobj *xk)
+{
+    struct xml_key_index *ki;
+    struct xml_key_index *kprev = NULL;
+    cg_var               *cvi = NULL;
+
+    if (xml_type(xk) != CX_ELMNT)
+        return 0;
+    for (ki = xml_key_index_get(xp); ki; kprev = ki, ki = ki->ki_next)
+        if (ki->ki_enabled && key_index_member(ki, xe))
+            break;
+    if (ki == NULL)
+        return 0;
+    while ((cvi = cvec_each(yang_cvec_get(ki->ki_yang), cvi)) != NULL)
+        if (strcmp(xml_name(xk), cv_string_get(cvi)) == 0)
+            break;
+    if (cvi == NULL) /* Not a key */
+        return 0;
+    if (key_index_pending_find(ki, xe) != -1) /* Not yet hashed */
+        return 0;
+    /* Old key value is not known: drop index, it is rebuilt at next search */
+    if (kprev)
+        kprev->ki_next = ki->ki_next;
+    else if (xml_key_index_set(xp, ki->ki_next) < 0)
+        return -1;
+    return key_index_free1(ki);
+}
+
+/*! Free all key indexes of a parent
+ *
+ * @param[in]  xp   Parent XML node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xml_key_index_free(cxobj *xp)
+{
+    struct xml_key_index *ki;
+
+    while ((ki = xml_key_index_get(xp)) != NULL){
+        if (xml_key_index_set(xp, ki->ki_next) < 0)
+            return -1;
+        key_index_free1(ki);
+    }
+    return 0;
+}
+
+/*! Return memory used by key indexes of a parent
+ *
+ * @param[in]  xp   Parent XML node
+ * @retval     sz   Size in bytes
+ */
+size_t
+xml_key_index_size(cxobj *xp)
+{
+    struct xml_key_index *ki;
+    size_t                sz = 0;
+
+    for (ki = xml_key_index_get(xp); ki; ki = ki->ki_next){
+        sz += sizeof(struct xml_key_index);
+        sz += ki->ki_size*sizeof(struct xml_key_entry *);
+        sz += ki->ki_nr*sizeof(struct xml_key_entry);
+        if (ki->ki_pending)
+            sz += clixon_xvec_len(ki->ki_pending)*sizeof(cxobj *);
+    }
+    return sz;
+}
+
+#endif /* XML_KEY_INDEX */
@@ -0,0 +1,61 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2020-2023 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Hash index of YANG list entries on key values
+ * Internal to the XML library, see clixon_xml_index.c
+ */
+#ifndef _CLIXON_XML_INDEX_H
+#define _CLIXON_XML_INDEX_H
+
+/*
+ * Types
+ */
+struct xml_key_index; /* Opaque, see clixon_xml_index.c */
+
+/*
+ * Prototypes
+ */
+/* Accessors implemented in clixon_xml.c */
+struct xml_key_index *xml_key_index_get(cxobj *xp);
+int    xml_key_index_set(cxobj *xp, struct xml_key_index *ki);
+
+int    xml_key_index_search(cxobj *xp, cxobj *x1, yang_stmt *yc, clixon_xvec *xvec);
+int    xml_key_index_search_key(cxobj *xp, yang_stmt *yc, char *key, size_t len,
+                                clixon_xvec *xvec);
+int    xml_key_index_add(cxobj *xp, cxobj *xc);
+int    xml_key_index_rm(cxobj *xp, cxobj *xc);
+int    xml_key_index_changed(cxobj *xp, cxobj *xe, cxobj *xk);
+int    xml_key_index_free(cxobj *xp);
+size_t xml_key_index_size(cxobj *xp);
+
+#endif  /* _CLIXON_XML_INDEX_H */
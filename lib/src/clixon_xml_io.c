@@ -52,6 +52,9 @@
 #include <errno.h>
 #include <string.h>
 #include <limits.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -73,6 +76,8 @@
 #include "clixon_xml_nsctx.h"
 #include "clixon_xml_parse.h"
 #include "clixon_xml_io.h"
+#include "clixon_probe.h"
+#include "clixon_event.h"
 
 /*
  * Constants
@@ -80,6 +85,32 @@
 /* Size of xml read buffer */
 #define BUFLEN 1024  
 
+/*
+ * Local variables
+ */
+/* Parse XML with hand-written scanner instead of lex/yacc parser, see CLICON_XML_SCANNER */
+static int _xml_parse_scanner = 0;
+
+/* Keep anydata content unparsed when scanned, see CLICON_XML_ANYDATA_LAZY */
+static int _xml_parse_lazy = 0;
+
+#ifdef HAVE_LIBPTHREAD
+/* The lex/yacc parser has global state, serialize it with threads, see xmldb_prefetch_start */
+static pthread_once_t  _xml_parse_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t _xml_parse_mutex;
+
+static void
+xml_parse_mutex_init(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&_xml_parse_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+#endif
+
 /*------------------------------------------------------------------------
  * XML printing functions. Output a parse tree to file, string cligen buf
  *------------------------------------------------------------------------*/
@@ -120,7 +151,8 @@ xml2file_recurse(FILE             *f,
     int        exist = 0;
     yang_stmt *y;
     int        level1;
-        
+    char      *lazy;
+
     if (x == NULL)
         goto ok;
     level1 = level*PRETTYPRINT_INDENT;
@@ -159,6 +191,18 @@ xml2file_recurse(FILE             *f,
         hasbody = 0;
         haselement = 0;
         xc = NULL;
+        if ((lazy = xml_lazy(x)) != NULL){ /* Unparsed content is printed as is */
+            while ((xc = xml_child_each(x, xc, CX_ATTR)) != NULL)
+                if (xml2file_recurse(f, xc, level+1, pretty, prefix, fn, autocliext) <0)
+                    goto done;
+            (*fn)(f, ">%s</", lazy);
+            if (namespace)
+                (*fn)(f, "%s:", namespace);
+            (*fn)(f, "%s>", name);
+            if (pretty)
+                (*fn)(f, "\n");
+            break;
+        }
         /* print attributes only */
         while ((xc = xml_child_each(x, xc, -1)) != NULL) {
             switch (xml_type(xc)){
@@ -176,6 +220,8 @@ xml2file_recurse(FILE             *f,
                 break;
             }
         }
+        if (xml_flag(x, XML_FLAG_WDTAG))
+            (*fn)(f, " %s:default=\"true\"", IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX);
         /* Check for special case <a/> instead of <a></a>:
          * Ie, no CX_BODY or CX_ELMNT child.
          */
@@ -188,6 +234,8 @@ xml2file_recurse(FILE             *f,
             }
             xc = NULL;
             while ((xc = xml_child_each(x, xc, -1)) != NULL) {
+                if (clixon_event_yield() < 0) /* Safe point of a long RPC */
+                    goto done;
                 if (xml_type(xc) != CX_ATTR)
                     if (xml2file_recurse(f, xc, level+1, pretty, prefix, fn, autocliext) <0)
                         goto done;
@@ -348,7 +396,8 @@ clixon_xml2cbuf1(cbuf   *cb,
     char  *namespace;
     char  *val;
     int    level1;
-    
+    char  *lazy;
+
     if (depth == 0)
         goto ok;
     level1 = level*PRETTYPRINT_INDENT;
@@ -387,6 +436,24 @@ clixon_xml2cbuf1(cbuf   *cb,
         hasbody = 0;
         haselement = 0;
         xc = NULL;
+        if ((lazy = xml_lazy(x)) != NULL){ /* Unparsed content is printed as is */
+            while ((xc = xml_child_each(x, xc, CX_ATTR)) != NULL)
+                if (clixon_xml2cbuf1(cb, xc, level+1, pretty, prefix, -1) < 0)
+                    goto done;
+            cbuf_append_str(cb, ">");
+            if (depth != 1)
+                cbuf_append_str(cb, lazy);
+            cbuf_append_str(cb, "</");
+            if (namespace){
+                cbuf_append_str(cb, namespace);
+                cbuf_append_str(cb, ":");
+            }
+            cbuf_append_str(cb, name);
+            cbuf_append_str(cb, ">");
+            if (pretty)
+                cbuf_append_str(cb, "\n");
+            break;
+        }
         /* print attributes only */
         while ((xc = xml_child_each(x, xc, -1)) != NULL) 
             switch (xml_type(xc)){
@@ -403,6 +470,9 @@ clixon_xml2cbuf1(cbuf   *cb,
             default:
                 break;
             }
+        if (xml_flag(x, XML_FLAG_WDTAG)){
+            cbuf_append_str(cb, " " IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX ":default=\"true\"");
+        }
         /* Check for special case <a/> instead of <a></a> */
         if (hasbody==0 && haselement==0) 
             cbuf_append_str(cb, "/>");
@@ -473,6 +543,7 @@ clixon_xml2cbuf(cbuf   *cb,
     int    retval = -1;
     cxobj *xc;
     
+    CLIXON_PROBE1(xml2cbuf_start, cbuf_len(cb));
     if (skiptop){
         xc = NULL;
         while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
@@ -485,6 +556,7 @@ clixon_xml2cbuf(cbuf   *cb,
     }
     retval = 0;
  done:
+    CLIXON_PROBE1(xml2cbuf_done, cbuf_len(cb));
     return retval;
 }
 
@@ -530,6 +602,30 @@ xmltree2cbuf(cbuf  *cb,
 /*--------------------------------------------------------------------
  * XML parsing functions. Create XML parse tree from string and file.
  *--------------------------------------------------------------------*/
+/*! Kludge to select XML parser, see CLICON_XML_SCANNER
+ *
+ * The problem with this is that its global and should be bound to a handle
+ * @param[in]  val  0: lex/yacc parser, 1: hand-written scanner, see clixon_xml_scan()
+ */
+int
+clixon_xml_parse_scanner(int val)
+{
+    _xml_parse_scanner = val;
+    return 0;
+}
+
+/*! Kludge to keep anydata content unparsed, see CLICON_XML_ANYDATA_LAZY
+ *
+ * Only when parsed with the hand-written scanner and bound to yang while scanning
+ * @param[in]  val  If set, content of anydata and anyxml is parsed when accessed, see xml_lazy
+ */
+int
+clixon_xml_parse_lazy(int val)
+{
+    _xml_parse_lazy = val;
+    return 0;
+}
+
 /*! Common internal xml parsing function string to parse-tree
  *
  * Given a string containing XML, parse into existing XML tree and return
@@ -582,13 +678,38 @@ _xml_parse(const char *str,
         clicon_err(OE_XML, errno, "strdup");
         return -1;
     }
+    CLIXON_PROBE1(xml_parse_start, strlen(str));
     xy.xy_xtop = xt;
     xy.xy_xparent = xt;
     xy.xy_yspec = yspec;
-    if (clixon_xml_parsel_init(&xy) < 0)
-        goto done;    
-    if (clixon_xml_parseparse(&xy) != 0)  /* yacc returns 1 on error */
-        goto done;
+    if (_xml_parse_scanner){
+        /* Bind and sort while scanning, if the new nodes are the only children */
+        if ((yb == YB_MODULE || yb == YB_MODULE_NEXT || yb == YB_PARENT) &&
+            xml_child_nr_type(xt, CX_ELMNT) == 0)
+            xy.xy_bind = yb;
+        xy.xy_lazy = _xml_parse_lazy;
+        if (clixon_xml_scan(&xy) < 0)
+            goto done;
+    }
+    else {
+#ifdef HAVE_LIBPTHREAD
+        pthread_once(&_xml_parse_once, xml_parse_mutex_init);
+        pthread_mutex_lock(&_xml_parse_mutex);
+#endif
+        ret = 0;
+        if (clixon_xml_parsel_init(&xy) < 0 ||
+            clixon_xml_parseparse(&xy) != 0)  /* yacc returns 1 on error */
+            ret = -1;
+        if (xy.xy_lexbuf){
+            clixon_xml_parsel_exit(&xy);
+            xy.xy_lexbuf = NULL;
+        }
+#ifdef HAVE_LIBPTHREAD
+        pthread_mutex_unlock(&_xml_parse_mutex);
+#endif
+        if (ret < 0)
+            goto done;
+    }
     /* Purge all top-level body objects */
     x = NULL;
     while ((x = xml_find_type(xt, NULL, "body", CX_BODY)) != NULL)
@@ -599,6 +720,8 @@ _xml_parse(const char *str,
         /* Verify namespaces after parsing */
         if (xml2ns_recurse(x) < 0)
             goto done;
+        if (xy.xy_bound) /* Bound by scanner */
+            continue;
         /* Populate, ie associate xml nodes with yang specs 
          */
         switch (yb){
@@ -644,12 +767,21 @@ _xml_parse(const char *str,
         goto fail;
     /* Sort the complete tree after parsing. Sorting is not really meaningful if Yang
        not bound */
-    if (yb != YB_NONE)
+    if (xy.xy_bound){ /* Only top is not sorted by scanner */
+        if (xml_sort_verify(xt, NULL) == -1 &&
+            xml_sort(xt) < 0)
+            goto done;
+        if (xml_cv_cache_clear(xt) < 0)
+            goto done;
+    }
+    else if (yb != YB_NONE)
         if (xml_sort_recurse(xt) < 0)
             goto done;
     retval = 1;
   done:
-    clixon_xml_parsel_exit(&xy);
+    CLIXON_PROBE1(xml_parse_done, retval);
+    if (xy.xy_lexbuf)
+        clixon_xml_parsel_exit(&xy);
     if (xy.xy_parse_string != NULL)
         free(xy.xy_parse_string);
     if (xy.xy_xvec)
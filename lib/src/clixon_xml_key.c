@@ -0,0 +1,470 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+
+ * Order-preserving binary encoding of YANG list keys
+ *
+ * Keys of list entries are given in many forms: as key leafs of XML entries, and as strings
+ * from api-paths, xpath predicates, instance-identifiers, CLI variables and list-pagination
+ * cursors. Comparing them otherwise means looking up each key leaf and comparing it as a
+ * string or typed value, for every comparison.
+ * The key values of an entry are here encoded in key order as one byte string, so that two
+ * keys compare with memcmp in the same order as xml_cmp compares the entries:
+ * - A string is encoded as its bytes and a terminating null byte.
+ * - An integer is encoded as 8 bytes big-endian, with the sign bit flipped if signed.
+ * The encoding of an entry is computed on first use and cached in the node until a key
+ * value changes. Only lists and leaf-lists whose keys are strings or integers are encoded,
+ * and integers only in canonical form, otherwise the callers compare the key leafs as before.
+ * @see xml_cmp_keys  The comparison the encoding is equivalent to
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_pool.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_vec.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_index.h"
+#include "clixon_xml_key.h"
+
+#ifdef XML_KEY_ENCODE
+
+/* Length of an encoded integer key */
+#define XML_KEY_INT_LEN 8
+
+/*! Check if all keys of a precompiled key comparator can be encoded
+ */
+static int
+key_encodable(yang_keycmp *yk)
+{
+    int i;
+
+    if (yk == NULL || yk->yk_len == 0)
+        return 0;
+    for (i=0; i<yk->yk_len; i++)
+        if (yk->yk_keys[i].yk_class == YK_GENERIC)
+            return 0;
+    return 1;
+}
+
+/*! Encode an integer in canonical decimal form
+ *
+ * @param[in]  s    Integer string
+ * @param[in]  neg  If set, signed integer
+ * @param[in]  cb   Encoded integer is appended
+ * @retval     1    OK
+ * @retval     0    Not canonical (RFC 7950 9.2.2) or out of range
+ * @retval    -1    Error
+ */
+static int
+key_encode_int(char *s,
+               int   neg,
+               cbuf *cb)
+{
+    uint64_t u = 0;
+    int      minus = 0;
+    uint8_t  buf[XML_KEY_INT_LEN];
+    char    *p;
+    int      i;
+
+    if (neg && *s == '-'){
+        minus = 1;
+        s++;
+    }
+    if (*s == '\0' || (s[0] == '0' && (s[1] != '\0' || minus)))
+        return 0;
+    for (p = s; *p; p++){
+        if (*p < '0' || *p > '9')
+            return 0;
+        if (u > (UINT64_MAX - (*p - '0'))/10)
+            return 0;
+        u = 10*u + (*p - '0');
+    }
+    if (neg){
+        if (u > (uint64_t)INT64_MAX + minus)
+            return 0;
+        if (minus)
+            u = 0 - u; /* Two's complement */
+        u ^= (uint64_t)1 << 63;
+    }
+    for (i=XML_KEY_INT_LEN-1; i>=0; i--){
+        buf[i] = u & 0xff;
+        u >>= 8;
+    }
+    if (cbuf_append_buf(cb, buf, sizeof(buf)) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 1;
+}
+
+/*! Encode one key value
+ *
+ * @param[in]  ykc   Key class
+ * @param[in]  val   Key value, NULL if empty
+ * @param[in]  cb    Encoded value is appended
+ * @retval     1     OK
+ * @retval     0     Value cannot be encoded
+ * @retval    -1     Error
+ */
+static int
+key_encode_value(enum yang_key_class ykc,
+                 char               *val,
+                 cbuf               *cb)
+{
+    switch (ykc){
+    case YK_STRING:
+        if (val == NULL)
+            val = "";
+        if (cbuf_append_buf(cb, val, strlen(val)+1) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            return -1;
+        }
+        return 1;
+    case YK_INT:
+    case YK_UINT:
+        if (val == NULL)
+            return 0;
+        return key_encode_int(val, ykc == YK_INT, cb);
+    default:
+        return 0;
+    }
+}
+
+/*! Compare two encoded keys
+ */
+static int
+key_memcmp(char  *k1,
+           size_t l1,
+           char  *k2,
+           size_t l2)
+{
+    int cmp;
+
+    if ((cmp = memcmp(k1, k2, l1 < l2 ? l1 : l2)) != 0)
+        return cmp;
+    return l1 < l2 ? -1 : l1 > l2;
+}
+
+/*! Get encoded key of a list entry or leaf-list value
+ *
+ * The encoding is computed on first use and cached in the node
+ * @param[in]  x     List entry or leaf-list entry, bound to yang
+ * @param[out] keyp  Encoded key, owned by x, valid until a key of x changes
+ * @param[out] lenp  Length of encoded key
+ * @retval     1     OK, see keyp and lenp
+ * @retval     0     Not encodable, eg key missing, not canonical integer or other key type
+ * @retval    -1     Error
+ */
+int
+xml_key_encode(cxobj   *x,
+               char   **keyp,
+               size_t  *lenp)
+{
+    int                   retval = -1;
+    struct xml_key_cache *kc;
+    yang_stmt            *y;
+    yang_keycmp          *yk;
+    cbuf                 *cb = NULL;
+    cxobj                *xk;
+    char                 *keyname;
+    size_t                len;
+    int                   i;
+    int                   ret;
+
+    if ((kc = xml_key_cache_get(x)) != NULL)
+        goto ok;
+    if ((y = xml_spec(x)) == NULL || !key_encodable(yk = yang_keycmp_get(y)))
+        goto fail;
+    if ((cb = clixon_cbuf_get()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (i=0; i<yk->yk_len; i++){
+        if ((keyname = yk->yk_keys[i].yk_name) == NULL) /* leaf-list */
+            xk = x;
+        /* Interned names: pointer compare */
+        else if (((xk = xml_child_i(x, i)) == NULL || xml_name(xk) != keyname) &&
+                 (xk = xml_find(x, keyname)) == NULL)
+            goto fail;
+        if ((ret = key_encode_value(yk->yk_keys[i].yk_class, xml_body(xk), cb)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    len = cbuf_len(cb);
+    if ((kc = malloc(sizeof(*kc) + len)) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        goto done;
+    }
+    kc->kc_len = len;
+    memcpy(kc->kc_data, cbuf_get(cb), len);
+    if (xml_key_cache_set(x, kc) < 0){
+        free(kc);
+        goto done;
+    }
+ ok:
+    *keyp = kc->kc_data;
+    *lenp = kc->kc_len;
+    retval = 1;
+ done:
+    if (cb)
+        clixon_cbuf_put(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Encode key values given as strings, eg from an api-path or xpath predicate
+ *
+ * @param[in]  yc    Yang list or leaf-list
+ * @param[in]  cvk   Key names and values in key order, eg k1=foo, k2=bar. One value of leaf-list
+ * @param[in]  cb    Encoded key is appended
+ * @retval     1     OK, same encoding as xml_key_encode of an entry with these keys
+ * @retval     0     Not encodable, eg not all keys or not in key order
+ * @retval    -1     Error
+ */
+int
+xml_key_encode_cvec(yang_stmt *yc,
+                    cvec      *cvk,
+                    cbuf      *cb)
+{
+    yang_keycmp *yk;
+    cg_var      *cvi;
+    char        *name;
+    int          i;
+    int          ret;
+
+    if (!key_encodable(yk = yang_keycmp_get(yc)) || cvec_len(cvk) != yk->yk_len)
+        return 0;
+    for (i=0; i<yk->yk_len; i++){
+        cvi = cvec_i(cvk, i);
+        if (yk->yk_keys[i].yk_name &&
+            ((name = cv_name_get(cvi)) == NULL || strcmp(name, yk->yk_keys[i].yk_name) != 0))
+            return 0;
+        if ((ret = key_encode_value(yk->yk_keys[i].yk_class, cv_string_get(cvi), cb)) <= 0)
+            return ret;
+    }
+    return 1;
+}
+
+/*! Compare an encoded key with the key of a list entry
+ *
+ * @param[in]  key   Encoded key
+ * @param[in]  len   Length of encoded key
+ * @param[in]  x     List entry or leaf-list entry
+ * @param[out] cmp   <0, 0 or >0 as key is less than, equal to or greater than key of x
+ * @retval     1     OK, see cmp
+ * @retval     0     Key of x is not encodable, compare with xml_cmp
+ * @retval    -1     Error
+ */
+int
+xml_key_cmp(char   *key,
+            size_t  len,
+            cxobj  *x,
+            int    *cmp)
+{
+    char  *xkey;
+    size_t xlen;
+    int    ret;
+
+    if ((ret = xml_key_encode(x, &xkey, &xlen)) <= 0)
+        return ret;
+    *cmp = key_memcmp(key, len, xkey, xlen);
+    return 1;
+}
+
+/*! Check if an XML node is a key leaf of a list entry
+ */
+static int
+key_member(cxobj *xe,
+           cxobj *xk)
+{
+    yang_stmt   *y;
+    yang_keycmp *yk;
+    int          i;
+
+    if ((y = xml_spec(xe)) == NULL || (yk = yang_keycmp_get(y)) == NULL)
+        return 0;
+    for (i=0; i<yk->yk_len; i++)
+        if (yk->yk_keys[i].yk_name == xml_name(xk)) /* Interned names */
+            return 1;
+    return 0;
+}
+
+/*! A child of an XML node has been changed, clear encoded keys that depend on it
+ *
+ * Either x is a list entry and xc a key leaf, or x is a key leaf or leaf-list entry and xc
+ * its body
+ * @param[in]  x    XML node whose children or value has changed
+ * @param[in]  xc   Changed child of x
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xml_key_changed(cxobj *x,
+                cxobj *xc)
+{
+    cxobj *xe;
+
+    switch (xml_type(xc)){
+    case CX_BODY:
+        if (xml_key_cache_get(x) != NULL && xml_key_cache_set(x, NULL) < 0)
+            return -1;
+        if ((xe = xml_parent(x)) != NULL && xml_key_cache_get(xe) != NULL &&
+            key_member(xe, x) &&
+            xml_key_cache_set(xe, NULL) < 0)
+            return -1;
+        break;
+    case CX_ELMNT:
+        if (xml_key_cache_get(x) != NULL && key_member(x, xc) &&
+            xml_key_cache_set(x, NULL) < 0)
+            return -1;
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*! Find the list entry or leaf-list value with given keys using encoded keys
+ *
+ * The keys are encoded once and compared with the encoded keys of entries, using the hash
+ * index of the list if any, or binary search in the sorted child vector
+ * @param[in]  xp    Parent XML node
+ * @param[in]  yc    Yang list or leaf-list
+ * @param[in]  cvk   Key names and values in key order, eg k1=foo, k2=bar
+ * @param[out] xvec  Matching entry is appended (may be empty)
+ * @retval     1     OK, see xvec
+ * @retval     0     Not applicable, eg partial key or unsorted list, use xml_search_yang
+ * @retval    -1     Error
+ * @see xml_find_index_yang
+ */
+int
+xml_key_find(cxobj       *xp,
+             yang_stmt   *yc,
+             cvec        *cvk,
+             clixon_xvec *xvec)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    char  *key;
+    size_t len;
+    int    first;
+    int    nr;
+    int    low;
+    int    upper;
+    int    mid;
+    int    cmp = 1;
+    int    ret;
+
+#ifndef STATE_ORDERED_BY_SYSTEM
+    if (yang_config_ancestor(yc) == 0)
+        goto fail;
+#endif
+    if ((cb = clixon_cbuf_get()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((ret = xml_key_encode_cvec(yc, cvk, cb)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    key = cbuf_get(cb);
+    len = cbuf_len(cb);
+#ifdef XML_KEY_INDEX
+    if ((ret = xml_key_index_search_key(xp, yc, key, len, xvec)) < 0)
+        goto done;
+    if (ret == 1)
+        goto ok;
+#endif
+    if (yang_find(yc, Y_ORDERED_BY, "user") != NULL)
+        goto fail;
+    if ((ret = xml_list_range(xp, yc, &first, &nr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* First entry not less than key */
+    low = first;
+    upper = first + nr;
+    while (low < upper){
+        mid = (low + upper) / 2;
+        if ((ret = xml_key_cmp(key, len, xml_child_i(xp, mid), &cmp)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (cmp > 0)
+            low = mid + 1;
+        else
+            upper = mid;
+    }
+    if (low < first + nr){
+        if ((ret = xml_key_cmp(key, len, xml_child_i(xp, low), &cmp)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (cmp == 0 && clixon_xvec_append(xvec, xml_child_i(xp, low)) < 0)
+            goto done;
+    }
+ ok:
+    retval = 1;
+ done:
+    if (cb)
+        clixon_cbuf_put(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+#endif /* XML_KEY_ENCODE */
@@ -0,0 +1,66 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+
+ * Order-preserving binary encoding of YANG list keys
+ * Internal to the XML library, see clixon_xml_key.c
+ */
+#ifndef _CLIXON_XML_KEY_H
+#define _CLIXON_XML_KEY_H
+
+/*
+ * Types
+ */
+/*! Encoded key of a list entry or leaf-list value, cached in the XML node
+ */
+struct xml_key_cache{
+    uint32_t kc_len;     /* Length of encoded key */
+    char     kc_data[];  /* Encoded key values, compare with memcmp */
+};
+
+/*
+ * Prototypes
+ */
+/* Accessors implemented in clixon_xml.c */
+struct xml_key_cache *xml_key_cache_get(cxobj *x);
+int    xml_key_cache_set(cxobj *x, struct xml_key_cache *kc);
+
+int    xml_key_encode(cxobj *x, char **keyp, size_t *lenp);
+int    xml_key_encode_cvec(yang_stmt *yc, cvec *cvk, cbuf *cb);
+int    xml_key_cmp(char *key, size_t len, cxobj *x, int *cmp);
+int    xml_key_changed(cxobj *x, cxobj *xc);
+int    xml_key_find(cxobj *xp, yang_stmt *yc, cvec *cvk, clixon_xvec *xvec);
+
+#endif  /* _CLIXON_XML_KEY_H */
@@ -52,6 +52,9 @@
 #include <arpa/inet.h>
 #include <sys/param.h>
 #include <netinet/in.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -80,6 +83,7 @@
 #include "clixon_text_syntax.h"
 #include "clixon_xml_io.h"
 #include "clixon_xml_map.h"
+#include "clixon_event.h"
 
 /* Local types 
  */
@@ -146,6 +150,7 @@ xml2cvec(cxobj      *xt,
     char             *reason = NULL;
     int               ret;
     char             *name;
+    xml_child_it      it;
 
     xc = NULL;
     /* Tried to allocate whole cvv here, but some cg_vars may be invalid */
@@ -153,9 +158,9 @@ xml2cvec(cxobj      *xt,
         clicon_err(OE_UNIX, errno, "cvec_new");
         goto err;
     }
-    xc = NULL;
+    xml_child_it_init(&it, xt, CX_ELMNT);
     /* Go through all children of the xml tree */
-    while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL){
+    while ((xc = xml_child_it_next(&it)) != NULL){
         name = xml_name(xc);
         if ((ys = yang_find_datanode(yt, name)) == NULL){
             clicon_debug(0, "%s: yang sanity problem: %s in xml but not present in yang under %s",
@@ -274,6 +279,108 @@ cvec2xml_1(cvec   *cvv,
     return retval;
 }
 
+/*! Check if a yang node has a descendant with a when condition
+ *
+ * Such subtrees may get different default values in two trees although their nodes are
+ * equal, since a when condition may refer to nodes elsewhere.
+ * The result is cached in the yang node
+ * @param[in]  ys   Yang node
+ * @retval     1    A descendant has a when condition
+ * @retval     0    No descendant has a when condition
+ */
+static int
+yang_when_below(yang_stmt *ys)
+{
+    yang_stmt *yc = NULL;
+    int        below = 0;
+
+    if (yang_flag_get(ys, YANG_FLAG_WHEN_CACHE))
+        return yang_flag_get(ys, YANG_FLAG_WHEN_BELOW) ? 1 : 0;
+    while ((yc = yn_each(ys, yc)) != NULL) {
+        if (!yang_datanode(yc) &&
+            yang_keyword_get(yc) != Y_CHOICE &&
+            yang_keyword_get(yc) != Y_CASE)
+            continue;
+        if (yang_when_xpath_get(yc) != NULL ||
+            yang_find(yc, Y_WHEN, NULL) != NULL ||
+            yang_when_below(yc)){
+            below = 1;
+            break;
+        }
+    }
+    yang_flag_set(ys, YANG_FLAG_WHEN_CACHE);
+    if (below)
+        yang_flag_set(ys, YANG_FLAG_WHEN_BELOW);
+    return below;
+}
+
+static int xml_diff1(cxobj *x0, cxobj *x1, int dirty,
+                     cxobj ***x0vec, int *x0veclen, cxobj ***x1vec, int *x1veclen,
+                     cxobj ***changed_x0, cxobj ***changed_x1, int *changedlen);
+
+/*! Compute differences between two yang-equal xml nodes, see xml_diff1
+ *
+ * Equal means that they have the same name and keys, see xml_cmp
+ * @param[in]  x0     Node of first tree
+ * @param[in]  x1     Node of second tree
+ * @param[in]  dirty  Only compare subtrees marked with XML_FLAG_DIRTY, see xml_diff_dirty
+ * @see xml_diff1  for the other parameters
+ */
+static int
+xml_diff_pair(cxobj     *x0c,
+              cxobj     *x1c,
+              int        dirty,
+              cxobj   ***x0vec,
+              int       *x0veclen,
+              cxobj   ***x1vec,
+              int       *x1veclen,
+              cxobj   ***changed_x0,
+              cxobj   ***changed_x1,
+              int       *changedlen)
+{
+    int        retval = -1;
+    yang_stmt *yc0;
+    yang_stmt *yc1;
+
+    /* xml-spec NULL could happen with anydata children for example,
+     * if so, continute compare children but without yang
+     */
+    yc0 = xml_spec(x0c);
+    yc1 = xml_spec(x1c);
+    if (yc0 && yc1 && yc0 != yc1){ /* choice */
+        if (cxvec_append(x0c, x0vec, x0veclen) < 0) 
+            goto done;
+        if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
+            goto done;
+    }
+    else
+        if (yc0 && yang_keyword_get(yc0) == Y_LEAF){
+            /* if x0c and x1c are leafs w bodies, then they may be changed */
+            if (xml_body_cmp(x0c, x1c) != 0){
+                if (cxvec_append(x0c, changed_x0, changedlen) < 0) 
+                    goto done;
+                (*changedlen)--; /* append two vectors */
+                if (cxvec_append(x1c, changed_x1, changedlen) < 0) 
+                    goto done;
+            }
+        }
+        else if (dirty && xml_flag(x1c, XML_FLAG_DIRTY) == 0 &&
+                 (yc1 == NULL || yang_when_below(yc1) == 0))
+            ; /* Not edited */
+        else if (xml_lazy(x0c) && xml_lazy(x1c) &&
+                 strcmp(xml_lazy(x0c), xml_lazy(x1c)) == 0)
+            ; /* Equal unparsed content, attributes are not compared as for other nodes */
+        else if (xml_diff1(x0c, x1c,
+                           dirty && xml_flag(x1c, XML_FLAG_DIRTY),
+                           x0vec, x0veclen, 
+                           x1vec, x1veclen, 
+                           changed_x0, changed_x1, changedlen)< 0)
+            goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Recursive help function to compute differences between two xml trees
  * @param[in]  x0         First XML tree
  * @param[in]  x1         Second XML tree
@@ -296,11 +403,14 @@ cvec2xml_1(cvec   *cvv,
  * (*) "comparing" a&b here is made by xml_cmp() which judges equality from a structural
  *     perspective, ie both have the same yang spec, if they are lists, they have the
  *     the same keys. NOT that the values are equal!
+ * If dirty is set, equal non-leaf pairs where b is not marked with XML_FLAG_DIRTY are
+ * assumed to be equal and are skipped, see xml_diff_dirty
  * @see xml_diff  API function, this one is internal and recursive
  */
 static int
 xml_diff1(cxobj     *x0, 
           cxobj     *x1,
+          int        dirty,
           cxobj   ***x0vec,
           int       *x0veclen,
           cxobj   ***x1vec,
@@ -312,29 +422,33 @@ xml_diff1(cxobj     *x0,
     int        retval = -1;
     cxobj     *x0c = NULL; /* x0 child */
     cxobj     *x1c = NULL; /* x1 child */
-    yang_stmt *yc0;
-    yang_stmt *yc1;
-    char      *b0;
-    char      *b1;
     int        eq;
+    xml_child_it it0;
+    xml_child_it it1;
 
+    if (xml_lazy(x0) && xml_lazy(x1)) /* Unparsed content */
+        return strcmp(xml_lazy(x0), xml_lazy(x1)) != 0;
     /* Traverse x0 and x1 in lock-step */
-    x0c = x1c = NULL;    
-    x0c = xml_child_each(x0, x0c, CX_ELMNT);
-    x1c = xml_child_each(x1, x1c, CX_ELMNT);
+    xml_child_it_init(&it0, x0, CX_ELMNT);
+    xml_child_it_init(&it1, x1, CX_ELMNT);
+    x0c = xml_child_it_next(&it0);
+    x1c = xml_child_it_next(&it1);
     for (;;){
+        /* Safe point of a long RPC, see CLICON_BACKEND_YIELD_INTERVAL */
+        if (clixon_event_yield() < 0)
+            goto done;
         if (x0c == NULL && x1c == NULL)
             goto ok;
         else if (x0c == NULL){
             if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
                 goto done;
-            x1c = xml_child_each(x1, x1c, CX_ELMNT);
+            x1c = xml_child_it_next(&it1);
             continue;
         }
         else if (x1c == NULL){
             if (cxvec_append(x0c, x0vec, x0veclen) < 0) 
                 goto done;
-            x0c = xml_child_each(x0, x0c, CX_ELMNT);
+            x0c = xml_child_it_next(&it0);
             continue;
         }
         /* Both x0c and x1c exists, check if they are yang-equal. */
@@ -342,52 +456,22 @@ xml_diff1(cxobj     *x0,
         if (eq < 0){
             if (cxvec_append(x0c, x0vec, x0veclen) < 0) 
                 goto done;
-            x0c = xml_child_each(x0, x0c, CX_ELMNT);
+            x0c = xml_child_it_next(&it0);
             continue;
         }
         else if (eq > 0){
             if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
                 goto done;
-            x1c = xml_child_each(x1, x1c, CX_ELMNT);
+            x1c = xml_child_it_next(&it1);
             continue;
         }
-        else{ /* equal */
-            /* xml-spec NULL could happen with anydata children for example,
-             * if so, continute compare children but without yang
-             */
-            yc0 = xml_spec(x0c);
-            yc1 = xml_spec(x1c);
-            if (yc0 && yc1 && yc0 != yc1){ /* choice */
-                if (cxvec_append(x0c, x0vec, x0veclen) < 0) 
-                    goto done;
-                if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
-                    goto done;
-            }
-            else
-                if (yc0 && yang_keyword_get(yc0) == Y_LEAF){
-                    /* if x0c and x1c are leafs w bodies, then they may be changed */
-                    b0 = xml_body(x0c);
-                    b1 = xml_body(x1c);
-                    if (b0 == NULL && b1 == NULL)
-                        ;
-                    else if (b0 == NULL || b1 == NULL
-                             || strcmp(b0, b1) != 0 
-                             ){
-                        if (cxvec_append(x0c, changed_x0, changedlen) < 0) 
-                            goto done;
-                        (*changedlen)--; /* append two vectors */
-                        if (cxvec_append(x1c, changed_x1, changedlen) < 0) 
-                            goto done;
-                    }
-                }
-                else if (xml_diff1(x0c, x1c,   
-                                   x0vec, x0veclen, 
-                                   x1vec, x1veclen, 
-                                   changed_x0, changed_x1, changedlen)< 0)
-                    goto done;
-        }
-        x0c = xml_child_each(x0, x0c, CX_ELMNT);
-        x1c = xml_child_each(x1, x1c, CX_ELMNT);
+        else if (xml_diff_pair(x0c, x1c, dirty,
+                               x0vec, x0veclen,
+                               x1vec, x1veclen,
+                               changed_x0, changed_x1, changedlen) < 0)
+            goto done;
+        x0c = xml_child_it_next(&it0);
+        x1c = xml_child_it_next(&it1);
     }
  ok:
     retval = 0;
@@ -440,7 +524,7 @@ xml_diff(cxobj     *x0,
             goto done;
         goto ok;
     }
-    if (xml_diff1(x0, x1,
+    if (xml_diff1(x0, x1, 0,
                   first, firstlen, 
                   second, secondlen, 
                   changed_x0, changed_x1, changedlen) < 0)
@@ -451,6 +535,481 @@ xml_diff(cxobj     *x0,
     return retval;
 }
 
+#ifdef HAVE_LIBPTHREAD
+/*! A step of the lock-step traversal in xml_diff_threads
+ *
+ * Node only in the first tree (x1 NULL), only in the second (x0 NULL), or yang-equal nodes
+ */
+struct xml_diff_task {
+    cxobj *dt_x0;
+    cxobj *dt_x1;
+};
+
+/*! A range of tasks computed by one thread, with its own result vectors
+ */
+struct xml_diff_chunk {
+    int     dc_from;    /* First task */
+    int     dc_to;      /* Last task + 1 */
+    int     dc_ret;     /* 0 if OK, -1 on error */
+    cxobj **dc_x0vec;
+    int     dc_x0len;
+    cxobj **dc_x1vec;
+    int     dc_x1len;
+    cxobj **dc_ch0vec;
+    cxobj **dc_ch1vec;
+    int     dc_chlen;
+};
+
+/*! Chunks shared by a pool of diff threads
+ */
+struct xml_diff_job {
+    pthread_mutex_t        dj_mutex;
+    struct xml_diff_task  *dj_tasks;
+    struct xml_diff_chunk *dj_chunks;
+    int                    dj_len;   /* Number of chunks */
+    int                    dj_next;  /* Next chunk to take */
+};
+
+/*! Split the lock-step traversal of two trees into tasks, in document order
+ *
+ * Yang-equal non-leaf nodes are split further into tasks of their children down to depth,
+ * so that the entries of a large list below a top-level container are split as well.
+ * @param[in]     x0     First XML tree
+ * @param[in]     x1     Second XML tree
+ * @param[in]     depth  Number of levels to split
+ * @param[in,out] tv     Task vector
+ * @param[in,out] len    Number of tasks
+ * @param[in,out] max    Allocated tasks
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+xml_diff_tasks(cxobj                 *x0,
+               cxobj                 *x1,
+               int                    depth,
+               struct xml_diff_task **tv,
+               int                   *len,
+               int                   *max)
+{
+    cxobj       *x0c;
+    cxobj       *x1c;
+    yang_stmt   *yc0;
+    yang_stmt   *yc1;
+    int          eq;
+    xml_child_it it0;
+    xml_child_it it1;
+    struct xml_diff_task *t;
+
+    xml_child_it_init(&it0, x0, CX_ELMNT);
+    xml_child_it_init(&it1, x1, CX_ELMNT);
+    x0c = xml_child_it_next(&it0);
+    x1c = xml_child_it_next(&it1);
+    while (x0c != NULL || x1c != NULL){
+        if (x0c == NULL)
+            eq = 1;
+        else if (x1c == NULL)
+            eq = -1;
+        else
+            eq = xml_cmp(x0c, x1c, 0, 0, NULL);
+        if (eq == 0 && depth > 0){
+            yc0 = xml_spec(x0c);
+            yc1 = xml_spec(x1c);
+            if ((yc0 == NULL || yc1 == NULL || yc0 == yc1) &&
+                (yc0 == NULL || yang_keyword_get(yc0) != Y_LEAF)){
+                if (xml_diff_tasks(x0c, x1c, depth-1, tv, len, max) < 0)
+                    return -1;
+                x0c = xml_child_it_next(&it0);
+                x1c = xml_child_it_next(&it1);
+                continue;
+            }
+        }
+        if (*len == *max){
+            *max = *max ? 2 * *max : 64;
+            if ((t = realloc(*tv, *max * sizeof(**tv))) == NULL){
+                clicon_err(OE_UNIX, errno, "realloc");
+                return -1;
+            }
+            *tv = t;
+        }
+        t = &(*tv)[(*len)++];
+        t->dt_x0 = eq <= 0 ? x0c : NULL;
+        t->dt_x1 = eq >= 0 ? x1c : NULL;
+        if (eq <= 0)
+            x0c = xml_child_it_next(&it0);
+        if (eq >= 0)
+            x1c = xml_child_it_next(&it1);
+    }
+    return 0;
+}
+
+/*! Diff thread: take chunks from the job until no more remain
+ *
+ * The calling thread also runs this, so all chunks are computed even if no thread could
+ * be created
+ */
+static void *
+xml_diff_worker(void *arg)
+{
+    struct xml_diff_job   *dj = (struct xml_diff_job *)arg;
+    struct xml_diff_chunk *dc;
+    struct xml_diff_task  *t;
+    int                    i;
+
+    while (1){
+        pthread_mutex_lock(&dj->dj_mutex);
+        i = dj->dj_next++;
+        pthread_mutex_unlock(&dj->dj_mutex);
+        if (i >= dj->dj_len)
+            break;
+        dc = &dj->dj_chunks[i];
+        for (i=dc->dc_from; i<dc->dc_to; i++){
+            t = &dj->dj_tasks[i];
+            if (t->dt_x1 == NULL)
+                dc->dc_ret = cxvec_append(t->dt_x0, &dc->dc_x0vec, &dc->dc_x0len);
+            else if (t->dt_x0 == NULL)
+                dc->dc_ret = cxvec_append(t->dt_x1, &dc->dc_x1vec, &dc->dc_x1len);
+            else
+                dc->dc_ret = xml_diff_pair(t->dt_x0, t->dt_x1, 0,
+                                           &dc->dc_x0vec, &dc->dc_x0len,
+                                           &dc->dc_x1vec, &dc->dc_x1len,
+                                           &dc->dc_ch0vec, &dc->dc_ch1vec, &dc->dc_chlen);
+            if (dc->dc_ret < 0)
+                break;
+        }
+    }
+    return NULL;
+}
+
+/*! Append a result vector of a chunk to a result vector
+ */
+static int
+xml_diff_concat(cxobj ***vec,
+                int     *len,
+                cxobj  **vec1,
+                int      len1)
+{
+    cxobj **v;
+
+    if (len1 == 0)
+        return 0;
+    if ((v = realloc(*vec, (*len + len1) * sizeof(cxobj *))) == NULL){
+        clicon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    memcpy(&v[*len], vec1, len1 * sizeof(cxobj *));
+    *vec = v;
+    *len += len1;
+    return 0;
+}
+#endif /* HAVE_LIBPTHREAD */
+
+/*! Compute differences between two xml trees using a pool of threads
+ *
+ * As xml_diff, the result vectors are the same and in the same order.
+ * The lock-step traversal of the top levels is split in tasks, which are computed in
+ * chunks by at most nthreads threads. The results of the chunks are then appended in order.
+ * The trees must not be modified by other threads meanwhile.
+ * @param[in]  x0         First XML tree
+ * @param[in]  x1         Second XML tree
+ * @param[in]  nthreads   Number of threads including the calling thread
+ * @see xml_diff  for the other parameters
+ * @see CLICON_XML_DIFF_THREADS
+ */
+int
+xml_diff_threads(cxobj     *x0, 
+                 cxobj     *x1,
+                 int        nthreads,
+                 cxobj   ***first,
+                 int       *firstlen,
+                 cxobj   ***second,
+                 int       *secondlen,
+                 cxobj   ***changed_x0,
+                 cxobj   ***changed_x1,
+                 int       *changedlen)
+{
+#ifdef HAVE_LIBPTHREAD
+    int                    retval = -1;
+    struct xml_diff_job    dj = {0,};
+    struct xml_diff_task  *tv = NULL;
+    struct xml_diff_chunk *dc;
+    pthread_t             *tids = NULL;
+    int                    len = 0;
+    int                    max = 0;
+    int                    chlen;
+    int                    n = 0;
+    int                    i;
+
+    if (nthreads <= 1 || x0 == NULL || x1 == NULL)
+        return xml_diff(x0, x1, first, firstlen, second, secondlen,
+                        changed_x0, changed_x1, changedlen);
+    *firstlen = 0;
+    *secondlen = 0;    
+    *changedlen = 0;
+    if (xml_diff_tasks(x0, x1, XML_DIFF_SPLIT_DEPTH, &tv, &len, &max) < 0)
+        goto done;
+    if (len < XML_DIFF_THREADS_TASKS){
+        retval = xml_diff(x0, x1, first, firstlen, second, secondlen,
+                          changed_x0, changed_x1, changedlen);
+        goto done;
+    }
+    /* More chunks than threads, so that the load is shared also if tasks differ in size */
+    dj.dj_len = 4*nthreads;
+    if ((dj.dj_chunks = calloc(dj.dj_len, sizeof(*dj.dj_chunks))) == NULL ||
+        (tids = calloc(nthreads-1, sizeof(pthread_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<dj.dj_len; i++){
+        dc = &dj.dj_chunks[i];
+        dc->dc_from = (int)((int64_t)len*i/dj.dj_len);
+        dc->dc_to = (int)((int64_t)len*(i+1)/dj.dj_len);
+    }
+    dj.dj_tasks = tv;
+    pthread_mutex_init(&dj.dj_mutex, NULL);
+    /* Failing to create a thread is not an error: the remaining threads do the work */
+    for (n=0; n<nthreads-1; n++)
+        if (pthread_create(&tids[n], NULL, xml_diff_worker, &dj) != 0)
+            break;
+    xml_diff_worker(&dj);
+    while (n > 0)
+        pthread_join(tids[--n], NULL);
+    pthread_mutex_destroy(&dj.dj_mutex);
+    for (i=0; i<dj.dj_len; i++){
+        dc = &dj.dj_chunks[i];
+        if (dc->dc_ret < 0)
+            goto done;
+        chlen = *changedlen;
+        if (xml_diff_concat(first, firstlen, dc->dc_x0vec, dc->dc_x0len) < 0 ||
+            xml_diff_concat(second, secondlen, dc->dc_x1vec, dc->dc_x1len) < 0 ||
+            xml_diff_concat(changed_x0, &chlen, dc->dc_ch0vec, dc->dc_chlen) < 0 ||
+            xml_diff_concat(changed_x1, changedlen, dc->dc_ch1vec, dc->dc_chlen) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (dj.dj_chunks){
+        for (i=0; i<dj.dj_len; i++){
+            dc = &dj.dj_chunks[i];
+            if (dc->dc_x0vec)
+                free(dc->dc_x0vec);
+            if (dc->dc_x1vec)
+                free(dc->dc_x1vec);
+            if (dc->dc_ch0vec)
+                free(dc->dc_ch0vec);
+            if (dc->dc_ch1vec)
+                free(dc->dc_ch1vec);
+        }
+        free(dj.dj_chunks);
+    }
+    if (tids)
+        free(tids);
+    if (tv)
+        free(tv);
+    return retval;
+#else
+    return xml_diff(x0, x1, first, firstlen, second, secondlen,
+                    changed_x0, changed_x1, changedlen);
+#endif /* HAVE_LIBPTHREAD */
+}
+
+/*! Compute differences between a tree and an edited version of it
+ *
+ * As xml_diff, but only subtrees of x1 that are marked with XML_FLAG_DIRTY are compared.
+ * Other subtrees of x1 are assumed to be equal to x0, unless they may have different
+ * default values due to when conditions.
+ * @param[in]  x0         First XML tree
+ * @param[in]  x1         Second XML tree, x0 where edited nodes and their ancestors are marked
+ * @param[out] first      Pointervector to XML nodes existing in only first tree
+ * @param[out] firstlen   Length of first vector
+ * @param[out] second     Pointervector to XML nodes existing in only second tree
+ * @param[out] secondlen  Length of second vector
+ * @param[out] changed_x0 Pointervector to XML nodes changed orig value
+ * @param[out] changed_x1 Pointervector to XML nodes changed wanted value
+ * @param[out] changedlen Length of changed vector
+ * @retval     0          OK
+ * @retval    -1          Error
+ * @see xml_diff
+ * @see CLICON_XMLDB_CANDIDATE_DELTA
+ */
+int
+xml_diff_dirty(cxobj     *x0, 
+               cxobj     *x1,
+               cxobj   ***first,
+               int       *firstlen,
+               cxobj   ***second,
+               int       *secondlen,
+               cxobj   ***changed_x0,
+               cxobj   ***changed_x1,
+               int       *changedlen)
+{
+    *firstlen = 0;
+    *secondlen = 0;    
+    *changedlen = 0;
+    if (x0 == NULL || x1 == NULL)
+        return xml_diff(x0, x1, first, firstlen, second, secondlen,
+                        changed_x0, changed_x1, changedlen);
+    /* The tops are always compared */
+    return xml_diff1(x0, x1, 1,
+                     first, firstlen, 
+                     second, secondlen, 
+                     changed_x0, changed_x1, changedlen);
+}
+
+/*! Check if the attributes of two xml nodes are equal
+ * @param[in]  x0   XML node
+ * @param[in]  x1   XML node
+ * @retval     1    Equal
+ * @retval     0    Not equal
+ */
+static int
+xml_attr_equal(cxobj *x0,
+               cxobj *x1)
+{
+    cxobj *xa0 = NULL;
+    cxobj *xa1 = NULL;
+
+    for (;;){
+        xa0 = xml_child_each(x0, xa0, CX_ATTR);
+        xa1 = xml_child_each(x1, xa1, CX_ATTR);
+        if (xa0 == NULL || xa1 == NULL)
+            return xa0 == xa1;
+        if (xml_name(xa0) != xml_name(xa1) ||   /* interned strings */
+            xml_prefix(xa0) != xml_prefix(xa1))
+            return 0;
+        if (xml_value_cmp(xa0, xa1) != 0)
+            return 0;
+    }
+}
+
+/*! Make xml tree x1 equal to x0 where one of them has been edited
+ *
+ * As xml_sync, but only subtrees that are marked with XML_FLAG_DIRTY in x0 or x1 are
+ * synced, other subtrees of x1 are assumed to be equal to x0. Children are matched by yang
+ * as in xml_diff, except below nodes with ordered-by user children which are synced with
+ * xml_sync. Marks are reset in synced nodes of x1.
+ * @param[in]  x0  Source XML tree
+ * @param[in]  x1  Destination XML tree. Either x0 or x1 is an edited version of the other
+ *                 where edited nodes and their ancestors are marked
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see xml_sync
+ * @see xml_diff_dirty
+ */
+int
+xml_sync_dirty(cxobj *x0,
+               cxobj *x1)
+{
+    int          retval = -1;
+    cxobj       *x0c;
+    cxobj       *x1c;
+    yang_stmt   *y;
+    yang_stmt   *yc0;
+    yang_stmt   *yc1;
+    int          eq;
+    int          i;
+    xml_child_it it0;
+    xml_child_it it1;
+    cxobj      **rmvec = NULL;   /* Children of x1 to remove */
+    int          rmlen = 0;
+    cxobj      **addvec = NULL;  /* Copies of x0 children to add */
+    int          addlen = 0;
+    cxobj       *xcopy;
+
+    if ((y = xml_spec(x1)) != NULL &&
+        (yang_keyword_get(y) == Y_ANYXML || yang_keyword_get(y) == Y_ANYDATA))
+        return xml_sync(x0, x1);
+    if (!xml_attr_equal(x0, x1))
+        return xml_sync(x0, x1);
+    /* Check ordered-by user and unbound children first, they are synced by position */
+    for (i=0; i<2; i++){
+        x1c = NULL;
+        yc0 = NULL;
+        while ((x1c = xml_child_each(i?x1:x0, x1c, CX_ELMNT)) != NULL) {
+            if ((yc1 = xml_spec(x1c)) == yc0) /* Entries of the same list */
+                continue;
+            if (yc1 == NULL ||
+                ((yang_keyword_get(yc1) == Y_LIST || yang_keyword_get(yc1) == Y_LEAF_LIST) &&
+                 yang_find(yc1, Y_ORDERED_BY, "user") != NULL))
+                return xml_sync(x0, x1);
+            yc0 = yc1;
+        }
+    }
+    /* Traverse x0 and x1 in lock-step, as xml_diff1 */
+    xml_child_it_init(&it0, x0, CX_ELMNT);
+    xml_child_it_init(&it1, x1, CX_ELMNT);
+    x0c = xml_child_it_next(&it0);
+    x1c = xml_child_it_next(&it1);
+    while (x0c != NULL || x1c != NULL){
+        if (x0c == NULL)
+            eq = 1;
+        else if (x1c == NULL)
+            eq = -1;
+        else
+            eq = xml_cmp(x0c, x1c, 0, 0, NULL);
+        if (eq > 0){ /* Only in x1 */
+            if (cxvec_append(x1c, &rmvec, &rmlen) < 0) 
+                goto done;
+            x1c = xml_child_it_next(&it1);
+            continue;
+        }
+        if (eq == 0){
+            yc0 = xml_spec(x0c);
+            yc1 = xml_spec(x1c);
+            if (yc0 != yc1){ /* choice */
+                if (cxvec_append(x1c, &rmvec, &rmlen) < 0) 
+                    goto done;
+            }
+            else{
+                if (yang_keyword_get(yc0) == Y_LEAF){
+                    if (xml_flag(x0c, XML_FLAG_DIRTY) || xml_flag(x1c, XML_FLAG_DIRTY) ||
+                        xml_body_cmp(x0c, x1c) != 0)
+                        if (xml_sync(x0c, x1c) < 0)
+                            goto done;
+                }
+                else if ((xml_flag(x0c, XML_FLAG_DIRTY) || xml_flag(x1c, XML_FLAG_DIRTY)) &&
+                         xml_sync_dirty(x0c, x1c) < 0)
+                    goto done;
+                x0c = xml_child_it_next(&it0);
+                x1c = xml_child_it_next(&it1);
+                continue;
+            }
+            x1c = xml_child_it_next(&it1);
+        }
+        /* Only in x0, or other case of choice */
+        if ((xcopy = xml_dup(x0c)) == NULL)
+            goto done;
+        /* As xml_sync, the copy is equal to x0 and not dirty */
+        xml_flag_reset(xcopy, XML_FLAG_DIRTY);
+        if (xml_flag_reset_rec(xcopy, XML_FLAG_DIRTY) < 0){
+            xml_free(xcopy);
+            goto done;
+        }
+        if (cxvec_append(xcopy, &addvec, &addlen) < 0){
+            xml_free(xcopy);
+            goto done;
+        }
+        x0c = xml_child_it_next(&it0);
+    }
+    for (i=0; i<rmlen; i++)
+        if (xml_purge(rmvec[i]) < 0)
+            goto done;
+    if (addlen){
+        if (xml_insert_bulk(x1, addvec, addlen) < 0)
+            goto done;
+        addlen = 0; /* Owned by x1 */
+    }
+    xml_flag_reset(x1, XML_FLAG_DIRTY);
+    retval = 0;
+ done:
+    for (i=0; i<addlen; i++)
+        xml_free(addvec[i]);
+    if (addvec)
+        free(addvec);
+    if (rmvec)
+        free(rmvec);
+    return retval;
+}
+
 /*! Compute if two XML trees are equal or not
  *
  * @param[in]  x0   First XML tree
@@ -467,15 +1026,16 @@ xml_tree_equal(cxobj     *x0,
     int        eq;
     yang_stmt *yc0;
     yang_stmt *yc1;
-    char      *b0;
-    char      *b1;
     cxobj     *x0c = NULL; /* x0 child */
     cxobj     *x1c = NULL; /* x1 child */
+    xml_child_it it0;
+    xml_child_it it1;
     
     /* Traverse x0 and x1 in lock-step */
-    x0c = x1c = NULL;    
-    x0c = xml_child_each(x0, x0c, CX_ELMNT);
-    x1c = xml_child_each(x1, x1c, CX_ELMNT);
+    xml_child_it_init(&it0, x0, CX_ELMNT);
+    xml_child_it_init(&it1, x1, CX_ELMNT);
+    x0c = xml_child_it_next(&it0);
+    x1c = xml_child_it_next(&it1);
     for (;;){
         if (x0c == NULL && x1c == NULL)
             goto ok;
@@ -505,15 +1065,8 @@ xml_tree_equal(cxobj     *x0,
             else
                 if (yc0 && yang_keyword_get(yc0) == Y_LEAF){
                     /* if x0c and x1c are leafs w bodies, then they may be changed */
-                    b0 = xml_body(x0c);
-                    b1 = xml_body(x1c);
-                    if (b0 == NULL && b1 == NULL)
-                        ;
-                    else if (b0 == NULL || b1 == NULL
-                             || strcmp(b0, b1) != 0 
-                             ){
+                    if (xml_body_cmp(x0c, x1c) != 0)
                         goto done;
-                    }
                 }
                 else {
                     eq = xml_tree_equal(x0c, x1c);
@@ -521,8 +1074,8 @@ xml_tree_equal(cxobj     *x0,
                         goto done;
                 }
         }
-        x0c = xml_child_each(x0, x0c, CX_ELMNT);
-        x1c = xml_child_each(x1, x1c, CX_ELMNT);
+        x0c = xml_child_it_next(&it0);
+        x1c = xml_child_it_next(&it1);
     }
  ok:
     retval = 0;
@@ -581,7 +1134,10 @@ xml_tree_prune_flagged_sub(cxobj *xt,
                 continue;
             }
         }
-        if (xml_tree_prune_flagged_sub(x, flag, test, &submark) < 0)
+        /* No descendant is flagged, see xml_flag_sub */
+        if (test && xml_flag_sub(x, flag) == 0)
+            submark = 0;
+        else if (xml_tree_prune_flagged_sub(x, flag, test, &submark) < 0)
             goto done;
         /* if xt is list and submark anywhere, then key subs are also marked
          */
@@ -625,6 +1181,7 @@ xml_tree_prune_flagged_sub(cxobj *xt,
  * @code
  *    xml_tree_prune_flagged(xt, XML_FLAG_MARK, 1);
  * @endcode
+ * If test is 1, subtrees without flagged descendants are skipped, see xml_flag_sub
  */
 int
 xml_tree_prune_flagged(cxobj *xt, 
@@ -635,6 +1192,8 @@ xml_tree_prune_flagged(cxobj *xt,
     cxobj     *x;
     cxobj     *xprev;
 
+    if (test && xml_flag_sub(xt, flag) == 0)
+        goto ok;
     x = NULL;
     xprev = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
@@ -648,6 +1207,9 @@ xml_tree_prune_flagged(cxobj *xt,
             goto done;
         xprev = x;
     }
+    if (test)
+        xml_flag_sub_reset(xt, flag);
+ ok:
     retval = 0;
  done:
     return retval;
@@ -661,6 +1223,7 @@ xml_tree_prune_flagged(cxobj *xt,
  * @code
  *    xml_tree_prune_flags(xt, XML_FLAG_MARK, XML_FLAG_MARK|XML_FLAG_DEFAULT);
  * @endcode
+ * Subtrees where not all flags are set in some descendant are skipped, see xml_flag_sub
  */
 int
 xml_tree_prune_flags(cxobj *xt,
@@ -671,6 +1234,8 @@ xml_tree_prune_flags(cxobj *xt,
     cxobj     *x;
     cxobj     *xprev;
 
+    if (flags && xml_flag_sub(xt, flags) != flags)
+        goto ok;
     x = NULL;
     xprev = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
@@ -684,6 +1249,7 @@ xml_tree_prune_flags(cxobj *xt,
             goto done;
         xprev = x;
     }
+ ok:
     retval = 0;
  done:
     return retval;
@@ -782,9 +1348,10 @@ xml_non_config_data(cxobj  *xt,
     yang_stmt *y;
     int        ret;
     cbuf      *cb = NULL;
+    xml_child_it it;
     
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+    xml_child_it_init(&it, xt, CX_ELMNT);
+    while ((x = xml_child_it_next(&it)) != NULL) {
         if ((y = (yang_stmt*)xml_spec(x)) == NULL)
             goto ok;
         if (!yang_config(y)){ /* config == false means state data */
@@ -1057,6 +1624,191 @@ assign_namespace_body(cxobj *x0, /* source */
     return retval;
 }
 
+/*! Add namespace declarations to a moved node unless already bound in its new place
+ *
+ * @param[in]  x1   XML node moved from another tree
+ * @param[in]  nsc  Namespace context of x1 in its original tree
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_merge_ns(cxobj *x1,
+             cvec  *nsc)
+{
+    int     retval = -1;
+    cg_var *cv;
+    char   *ns;
+    char   *px;
+    char   *pxe;
+    int     ret;
+
+    cv = NULL;
+    while ((cv = cvec_each(nsc, cv)) != NULL){
+        px = cv_name_get(cv);
+        ns = cv_string_get(cv);
+        /* Check if namespace exists */
+        if ((ret = xml2prefix(x1, ns, &pxe)) < 0)
+            goto done;
+        if (ret == 0 ||  /* Not exist */
+            clicon_strcmp(px, pxe) != 0){ /* Exists and not equal (can be NULL) */
+            if (xmlns_set(x1, px, ns) < 0)
+                goto done;
+            xml_sort(x1);
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+static int xml_merge1(cxobj *x0, yang_stmt *y0, cxobj *x0p, cxobj *x1, char **reason);
+
+/*! Check if children of x0 and x1 can be matched by stepping through both in order
+ *
+ * @param[in]  x0   Base xml node
+ * @param[in]  x1   Modification xml node
+ * @retval     1    Both are sorted, see xml_merge_step
+ * @retval     0    Not sorted or not sortable, use match_base_child
+ */
+static int
+xml_merge_sorted(cxobj *x0,
+                 cxobj *x1)
+{
+    return xml_child_nr(x0) && xml_sort_verify(x0, NULL) == 0 && xml_sort_verify(x1, NULL) == 0;
+}
+
+/*! Find matching child in sorted base tree by stepping forward from last position
+ *
+ * Children of x1 must be bound and given in their sorted order. Entries of user-ordered
+ * lists and of state data are not sorted by key and must be looked up with match_base_child
+ * @param[in]     x0    Base tree node, sorted
+ * @param[in,out] ip    Position in children of x0, start with 0
+ * @param[in]     x1c   Modification tree child
+ * @param[in]     yc    Yang spec of x1c
+ * @param[out]    x0cp  Matching base tree child (if any)
+ * @retval        1     OK, x0cp is set
+ * @retval        0     Not applicable for x1c, use match_base_child
+ * @see xml_merge_sorted
+ */
+static int
+xml_merge_step(cxobj     *x0,
+               int       *ip,
+               cxobj     *x1c,
+               yang_stmt *yc,
+               cxobj    **x0cp)
+{
+    cxobj *x0c;
+    int    eq;
+
+    if (yc == NULL ||
+        xml_spec(x1c) != yc || /* Not bound */
+        yang_config(yc) == 0 ||
+        yang_find(yc, Y_ORDERED_BY, "user") != NULL ||
+        (yang_keyword_get(yc) == Y_LEAF_LIST && xml_body(x1c) == NULL))
+        return 0;
+    *x0cp = NULL;
+    while ((x0c = xml_child_i(x0, *ip)) != NULL){
+        if (xml_type(x0c) == CX_ELMNT){
+            if ((eq = xml_cmp(x0c, x1c, 0, 0, NULL)) == 0)
+                *x0cp = x0c;
+            if (eq >= 0)
+                break;
+        }
+        (*ip)++;
+    }
+    return 1;
+}
+
+/*! Second phase of merge: merge collected children of x1 into x0
+ *
+ * If there are many, children of x1 without a match in x0 are moved in one bulk insert,
+ * instead of one xml_insert each, the rest are merged with xml_merge1.
+ * @param[in]  x0       Base xml node
+ * @param[in]  twophase Matched x1 children from first phase
+ * @param[in]  len      Length of twophase
+ * @param[out] reason   If retval=0 a malloced string
+ * @retval     1        OK
+ * @retval     0        Yang error, reason is set
+ * @retval    -1        Error
+ * @see xml_insert_bulk
+ */
+static int
+xml_merge_twophase(cxobj          *x0,
+                   merge_twophase *twophase,
+                   int             len,
+                   char          **reason)
+{
+    int     retval = -1;
+    cxobj **xvec = NULL;
+    cvec  **nscv = NULL;
+    cxobj  *x1c;
+    int     n = 0;
+    int     nr;
+    int     ret;
+    int     i;
+    int     j;
+
+    if (len >= XML_INSERT_BULK_THRESHOLD){
+        if ((xvec = calloc(len, sizeof(cxobj *))) == NULL ||
+            (nscv = calloc(len, sizeof(cvec *))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+    }
+    for (i=0; i<len; i++){
+        assert(twophase[i].mt_x1c);
+        x1c = twophase[i].mt_x1c;
+        if (xvec != NULL && twophase[i].mt_x0c == NULL && xml_spec(x1c) != NULL){
+            /* Same as xml_merge1 with x0 == NULL, but insert below */
+            if (xml_nsctx_node(x1c, &nscv[n]) < 0)
+                goto done;
+            if (xml_rm(x1c) < 0)
+                goto done;
+            xvec[n++] = x1c;
+            continue;
+        }
+        if ((ret = xml_merge1(twophase[i].mt_x0c,
+                              twophase[i].mt_yc,
+                              x0,
+                              x1c,
+                              reason)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    if (n){
+        nr = n;
+        n = 0; /* Moved to x0 */
+        if (xml_insert_bulk(x0, xvec, nr) < 0)
+            goto done;
+        /* xml_insert_bulk reorders xvec, nscv is in twophase order */
+        j = 0;
+        for (i=0; i<len && j<nr; i++){
+            x1c = twophase[i].mt_x1c;
+            if (twophase[i].mt_x0c == NULL && xml_spec(x1c) != NULL)
+                if (xml_merge_ns(x1c, nscv[j++]) < 0)
+                    goto done;
+        }
+    }
+    retval = 1;
+ done:
+    if (nscv){
+        for (i=0; i<len; i++)
+            if (nscv[i])
+                cvec_free(nscv[i]);
+        free(nscv);
+    }
+    /* Removed from x1 but not inserted into x0 */
+    for (i=0; i<n; i++)
+        xml_free(xvec[i]);
+    if (xvec)
+        free(xvec);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Merge a base tree x0 with x1 with yang spec y
  * @param[in]  x0  Base xml tree (can be NULL in add scenarios)
  * @param[in]  y0  Yang spec corresponding to xml-node x0. NULL if x0 is NULL
@@ -1088,10 +1840,9 @@ xml_merge1(cxobj              *x0,  /* the target */
     merge_twophase *twophase = NULL;
     int             twophase_len;
     cvec           *nsc = NULL;
-    cg_var         *cv;
-    char           *ns;
-    char           *px;
-    char           *pxe;
+    xml_child_it    it;
+    int             sorted;
+    int             pos;
     
     if (x1 == NULL || xml_type(x1) != CX_ELMNT || y0 == NULL){
         clicon_err(OE_XML, EINVAL, "x1 is NULL or not XML element, or lacks yang spec");
@@ -1110,20 +1861,8 @@ xml_merge1(cxobj              *x0,  /* the target */
         else
             if (xml_insert(x0p, x1, INS_LAST, NULL, NULL) < 0)
                 goto done;
-        cv = NULL;
-        while ((cv = cvec_each(nsc, cv)) != NULL){
-            px = cv_name_get(cv);
-            ns = cv_string_get(cv);
-            /* Check if namespace exists */
-            if ((ret = xml2prefix(x1, ns, &pxe)) < 0)
-                goto done;
-            if (ret == 0 ||  /* Not exist */
-                clicon_strcmp(px, pxe) != 0){ /* Exists and not equal (can be NULL) */
-                if (xmlns_set(x1, px, ns) < 0)
-                    goto done;
-                xml_sort(x1);
-            }
-        }
+        if (xml_merge_ns(x1, nsc) < 0)
+            goto done;
         goto ok;
     }
     if (yang_keyword_get(y0) == Y_LEAF_LIST || yang_keyword_get(y0) == Y_LEAF){
@@ -1151,9 +1890,11 @@ xml_merge1(cxobj              *x0,  /* the target */
             goto done;
         }
         i = 0;
+        pos = 0;
+        sorted = xml_merge_sorted(x0, x1);
         /* Loop through children of the modification tree */
-        x1c = NULL;
-        while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) {
+        xml_child_it_init(&it, x1, CX_ELMNT);
+        while ((x1c = xml_child_it_next(&it)) != NULL) {
             x1cname = xml_name(x1c);
             /* Get yang spec of the child */
             if ((yc = yang_find_datanode(y0, x1cname)) == NULL){
@@ -1172,7 +1913,9 @@ xml_merge1(cxobj              *x0,  /* the target */
             }
             /* See if there is a corresponding node in the base tree */
             x0c = NULL;
-            if (yc && match_base_child(x0, x1c, yc, &x0c) < 0)
+            if (sorted && xml_merge_step(x0, &pos, x1c, yc, &x0c) == 1)
+                ;
+            else if (yc && match_base_child(x0, x1c, yc, &x0c) < 0)
                 goto done;
             /* If x0 already has a value, do not replace it with a default value in x1 */
             if (x0c && xml_flag(x1c, XML_FLAG_DEFAULT))
@@ -1186,19 +1929,11 @@ xml_merge1(cxobj              *x0,  /* the target */
             i++;
         } /* while */
         twophase_len = i; /* Inital length included non-elements */
-        /* Second run where actual merging is done 
-         * Loop through children of the modification tree */
-        for (i=0; i<twophase_len; i++){
-            assert(twophase[i].mt_x1c);
-            if ((ret = xml_merge1(twophase[i].mt_x0c,
-                           twophase[i].mt_yc,
-                           x0,
-                           twophase[i].mt_x1c,
-                                  reason)) < 0)
-                goto done;
-            if (ret == 0)
-                goto fail;
-        }
+        /* Second run where actual merging is done */
+        if ((ret = xml_merge_twophase(x0, twophase, twophase_len, reason)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
         if (xml_parent(x0) == NULL &&
             xml_insert(x0p, x0, INS_LAST, NULL, NULL) < 0) 
             goto done;
@@ -1219,6 +1954,9 @@ xml_merge1(cxobj              *x0,  /* the target */
 }
 
 /*! Merge XML trees x1 into x0 according to yang spec yspec
+ *
+ * If both trees are sorted, children are matched by stepping through both in order,
+ * otherwise, and for user-ordered lists, each child is looked up
  * @param[in]  x0     Base xml tree (can be NULL in add scenarios)
  * @param[in]  x1     xml tree which modifies base
  * @param[in]  yspec  Yang spec
@@ -1245,11 +1983,15 @@ xml_merge(cxobj     *x0,
     merge_twophase *twophase = NULL;
     int        twophase_len;
     int        ret;
+    xml_child_it it;
+    int        sorted;
+    int        pos = 0;
 
     if (x0 == NULL || x1 == NULL){
         clicon_err(OE_UNIX, EINVAL, "parameters x0 or x1 is NULL");
         goto done;
     }
+    sorted = xml_merge_sorted(x0, x1);
     twophase_len = xml_child_nr(x1);
     if ((twophase = calloc(twophase_len, sizeof(*twophase))) == NULL){
         clicon_err(OE_UNIX, errno, "calloc");
@@ -1257,8 +1999,8 @@ xml_merge(cxobj     *x0,
     }
     /* Loop through children of the modification tree */
     i = 0;
-    x1c = NULL;
-    while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) {
+    xml_child_it_init(&it, x1, CX_ELMNT);
+    while ((x1c = xml_child_it_next(&it)) != NULL) {
         x1cname = xml_name(x1c);
         if ((ys_module_by_xml(yspec, x1c, &ymod)) < 0)
             goto done;
@@ -1287,7 +2029,9 @@ xml_merge(cxobj     *x0,
         }
         x0c = NULL;
         /* See if there is a corresponding node (x1c) in the base tree (x0) */
-        if (yc && match_base_child(x0, x1c, yc, &x0c) < 0)
+        if (sorted && xml_merge_step(x0, &pos, x1c, yc, &x0c) == 1)
+            ;
+        else if (yc && match_base_child(x0, x1c, yc, &x0c) < 0)
             goto done;
         /* If x0 already has a value, do not replace it with a default value in x1 */
         if (x0c && xml_flag(x1c, XML_FLAG_DEFAULT))
@@ -1301,19 +2045,11 @@ xml_merge(cxobj     *x0,
         i++;
     }
     twophase_len = i; /* Inital length included non-elements */
-    /* Second run where actual merging is done 
-     * Loop through children of the modification tree */
-    for (i=0; i<twophase_len; i++){
-        assert(twophase[i].mt_x1c);
-        if ((ret = xml_merge1(twophase[i].mt_x0c,
-                              twophase[i].mt_yc,
-                              x0,
-                              twophase[i].mt_x1c,
-                              reason)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-    }
+    /* Second run where actual merging is done */
+    if ((ret = xml_merge_twophase(x0, twophase, twophase_len, reason)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
     retval = 1; /* OK */
  done:
     if (twophase)
@@ -1326,6 +2062,55 @@ xml_merge(cxobj     *x0,
     goto done;
 }
 
+/*! Check if two edits may modify the same nodes
+ *
+ * Edits conflict if they have a leaf, leaf-list, anydata or anyxml node in common, or if
+ * any of their common nodes has an operation attribute. Keys of common list entries are
+ * not conflicts.
+ * @param[in]  x0  Edit
+ * @param[in]  x1  Other edit
+ * @retval     1   Conflict
+ * @retval     0   No conflict, siblings of common containers or list entries only
+ * @retval    -1   Error
+ * @note x0 and x1 are edit trees bound to YANG and sorted, eg <config> of edit-config
+ */
+int
+xml_edit_conflict(cxobj *x0,
+                  cxobj *x1)
+{
+    cxobj        *x1c = NULL;
+    cxobj        *x0c;
+    yang_stmt    *y;
+    enum rfc_6020 keyw;
+    int           ret;
+
+    while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL){
+        if ((y = xml_spec(x1c)) == NULL)
+            return 1;
+        x0c = NULL;
+        if (match_base_child(x0, x1c, y, &x0c) < 0)
+            return -1;
+        if (x0c == NULL)
+            continue;
+        keyw = yang_keyword_get(y);
+        /* Keys of a common list entry are equal by definition */
+        if (keyw == Y_LEAF &&
+            yang_keyword_get(yang_parent_get(y)) == Y_LIST){
+            if ((ret = yang_key_match(yang_parent_get(y), xml_name(x1c), NULL)) < 0)
+                return -1;
+            if (ret == 1)
+                continue;
+        }
+        if ((keyw != Y_CONTAINER && keyw != Y_LIST) ||
+            xml_find_value(x0c, "operation") != NULL ||
+            xml_find_value(x1c, "operation") != NULL)
+            return 1;
+        if ((ret = xml_edit_conflict(x0c, x1c)) != 0)
+            return ret;
+    }
+    return 0;
+}
+
 /*! Given a YANG (enum) type node and a value, return the string containing corresponding int str
  *
  * @param[in]  ytype   YANG type noden
@@ -1468,6 +2253,7 @@ xml_copy_marked(cxobj *x0,
     yang_stmt *yt;
     char      *name;
     char      *prefix;
+    xml_child_it it;
 
     assert(x0 && x1);
     yt = xml_spec(x0); /* can be null */
@@ -1492,15 +2278,15 @@ xml_copy_marked(cxobj *x0,
      * node in list is marked
      */
     mark = 0;
-    x = NULL;
-    while ((x = xml_child_each(x0, x, CX_ELMNT)) != NULL) {
+    xml_child_it_init(&it, x0, CX_ELMNT);
+    while ((x = xml_child_it_next(&it)) != NULL) {
         if (xml_flag(x, XML_FLAG_MARK|XML_FLAG_CHANGE)){
             mark++;
             break;
         }
     }
-    x = NULL;
-    while ((x = xml_child_each(x0, x, CX_ELMNT)) != NULL) {
+    xml_child_it_init(&it, x0, CX_ELMNT);
+    while ((x = xml_child_it_next(&it)) != NULL) {
         name = xml_name(x);
         if (xml_flag(x, XML_FLAG_MARK)){
             /* (2) the complete subtree of that node is copied. */
@@ -1563,8 +2349,8 @@ yang_check_when_xpath(cxobj        *xn,
     cxobj     *x = NULL;
     int        nr = 0;
     cvec      *nsc = NULL;
+    xpath_tree *xptree = NULL;
     int        xmalloc = 0;   /* ugly help variable to clean temporary object */
-    int        nscmalloc = 0; /* ugly help variable to remove */
 
     /* First variant */
     if ((xpath = yang_when_xpath_get(yn)) != NULL){
@@ -1584,15 +2370,19 @@ yang_check_when_xpath(cxobj        *xn,
         }
         else
             x = xn;
-        if (xml_nsctx_yang(yn, &nsc) < 0)
+        /* Parsed xpath and namespace context of yn are kept in the when statement */
+        if (yang_xpath_get(yc, &xptree, &nsc) < 0)
             goto done;
-        nscmalloc++;
         *hit = 1;
     }
     else
         *hit = 0;
     if (x && xpath){
-        if ((nr = xpath_vec_bool(x, nsc, "%s", xpath)) < 0)
+        if (xptree)
+            nr = xpath_vec_bool_tree(x, nsc, xptree);
+        else
+            nr = xpath_vec_bool(x, nsc, "%s", xpath);
+        if (nr < 0)
             goto done;
     }
     if (nrp)
@@ -1603,8 +2393,6 @@ yang_check_when_xpath(cxobj        *xn,
  done:
     if (xmalloc)
         xml_purge(x);
-    if (nsc && nscmalloc)
-        xml_nsctx_free(nsc);
     return retval;
 }
 
@@ -1721,10 +2509,12 @@ xml_find_action(cxobj  *xn,
                 cxobj **xap)
 {
     int        retval = -1;
-    cxobj     *xc = NULL;
+    cxobj     *xc;
     yang_stmt *yc;
+    xml_child_it it;
 
-    while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL) {
+    xml_child_it_init(&it, xn, CX_ELMNT);
+    while ((xc = xml_child_it_next(&it)) != NULL) {
         if ((yc = xml_spec(xc)) == NULL)
             continue;
         if (!top && yang_keyword_get(yc) == Y_ACTION){
@@ -53,6 +53,7 @@
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <pthread.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -60,6 +61,7 @@
 /* clixon */
 #include "clixon_err.h"
 #include "clixon_string.h"
+#include "clixon_pool.h"
 #include "clixon_queue.h"
 #include "clixon_hash.h"
 #include "clixon_handle.h"
@@ -79,6 +81,15 @@
  * See rfc6241 3.1: urn:ietf:params:xml:ns:netconf:base:1.0.
  */
 static int _USE_NAMESPACE_NETCONF_DEFAULT = 0;
+
+/* Registered namespaces, see xml_nsid_register
+ * Namespace id n is in page (n-1)/NSID_PAGE at (n-1)%NSID_PAGE. Pages are never moved, so
+ * that xml_nsid2ns can read them without locking
+ */
+#define NSID_PAGE 256
+static char          **_nsid_pages[(UINT16_MAX+NSID_PAGE-1)/NSID_PAGE] = {NULL,};
+static int             _nsid_nr = 0;
+static pthread_mutex_t _nsid_mutex = PTHREAD_MUTEX_INITIALIZER;
             
 /*! Set if use internal default namespace mechanism or not
  *
@@ -94,6 +105,81 @@ xml_nsctx_namespace_netconf_default(clicon_handle h)
     return 0;
 }
 
+/*! Register a namespace and get its small integer id
+ *
+ * The same namespace always gets the same id. Ids are stored in bound XML nodes for a fast
+ * xml2ns, and are valid until xml_nsid_exit
+ * @param[in] ns   Namespace URI
+ * @retval    id   Namespace id, 1..UINT16_MAX
+ * @retval    0    No more ids, or error
+ * @see xml_nsid2ns
+ */
+uint16_t
+xml_nsid_register(const char *ns)
+{
+    uint16_t id = 0;
+    char   **page;
+    int      i;
+
+    pthread_mutex_lock(&_nsid_mutex);
+    for (i=0; i<_nsid_nr; i++)
+        if (strcmp(_nsid_pages[i/NSID_PAGE][i%NSID_PAGE], ns) == 0){
+            id = i+1;
+            goto done;
+        }
+    if (_nsid_nr == UINT16_MAX)
+        goto done;
+    if ((page = _nsid_pages[_nsid_nr/NSID_PAGE]) == NULL){
+        if ((page = calloc(NSID_PAGE, sizeof(char*))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        _nsid_pages[_nsid_nr/NSID_PAGE] = page;
+    }
+    if ((page[_nsid_nr%NSID_PAGE] = clixon_string_intern(ns)) == NULL)
+        goto done;
+    id = ++_nsid_nr;
+ done:
+    pthread_mutex_unlock(&_nsid_mutex);
+    return id;
+}
+
+/*! Get namespace of a namespace id
+ *
+ * @param[in] id   Namespace id from xml_nsid_register
+ * @retval    ns   Namespace URI
+ * @retval    NULL Not a registered id
+ */
+char *
+xml_nsid2ns(uint16_t id)
+{
+    char **page;
+
+    if (id == 0 || (page = _nsid_pages[(id-1)/NSID_PAGE]) == NULL)
+        return NULL;
+    return page[(id-1)%NSID_PAGE];
+}
+
+/*! Free all registered namespaces
+ *
+ * Call at exit when no XML or YANG trees exist anymore
+ */
+void
+xml_nsid_exit(void)
+{
+    int i;
+
+    pthread_mutex_lock(&_nsid_mutex);
+    for (i=0; i<_nsid_nr; i++)
+        clixon_string_unintern(_nsid_pages[i/NSID_PAGE][i%NSID_PAGE]);
+    for (i=0; i<(_nsid_nr+NSID_PAGE-1)/NSID_PAGE; i++){
+        free(_nsid_pages[i]);
+        _nsid_pages[i] = NULL;
+    }
+    _nsid_nr = 0;
+    pthread_mutex_unlock(&_nsid_mutex);
+}
+
 /*! Create and initialize XML namespace context
  *
  * @param[in] prefix    Namespace prefix, or NULL for default
@@ -116,7 +202,7 @@ xml_nsctx_init(char  *prefix,
 {
     cvec *cvv = NULL;
 
-    if ((cvv = cvec_new(0)) == NULL){
+    if ((cvv = clixon_cvec_get()) == NULL){
         clicon_err(OE_XML, errno, "cvec_new");
         goto done;
     }
@@ -139,7 +225,7 @@ xml_nsctx_free(cvec *nsc)
     cvec *cvv = (cvec*)nsc;
 
     if (cvv)
-        cvec_free(cvv);
+        clixon_cvec_put(cvv);
     return 0;
 }
 
@@ -503,7 +589,17 @@ xml2ns(cxobj *x,
     int    retval = -1;
     char  *ns = NULL;
     cxobj *xp;
+    char  *myprefix;
     
+    /* Bound node: namespace of its own prefix is the one of its yang, see xml_nsid_set */
+    if (xml_nsid(x) != 0){
+        myprefix = xml_prefix(x);
+        if ((prefix == NULL && myprefix == NULL) ||
+            (prefix != NULL && myprefix != NULL && strcmp(prefix, myprefix) == 0)){
+            if ((ns = xml_nsid2ns(xml_nsid(x))) != NULL)
+                goto ok;
+        }
+    }
     if ((ns = nscache_get(x, prefix)) != NULL)
         goto ok;
     if (prefix != NULL) /* xmlns:<prefix>="<uri>" */
@@ -564,8 +660,10 @@ xml2ns_recurse(cxobj *xt)
             if (namespace == NULL){
                 clicon_err(OE_XML, ENOENT, "No namespace associated with %s:%s", prefix, xml_name(x));
                 goto done;
-            }       
+            }
         }
+        if (xml_lazy(x) != NULL) /* Checked when parsed */
+            continue;
         if (xml2ns_recurse(x) < 0)
             goto done;
     }
@@ -607,6 +705,10 @@ xmlns_set(cxobj *x,
     /* (re)set namespace cache (as used in xml2ns) */
     if (ns && nscache_set(x, prefix, ns) < 0)
         goto done;
+    /* Namespace id may no longer be valid for own prefix */
+    if (xml_nsid(x) != 0 &&
+        (ns == NULL || strcmp(ns, xml_nsid2ns(xml_nsid(x))) != 0))
+        xml_nsid_set(x, 0);
     retval = 0;
  done:
     return retval;
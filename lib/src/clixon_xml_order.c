@@ -0,0 +1,708 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2020-2023 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+
+ * Order-statistic index of ordered-by user YANG list entries
+ *
+ * Entries of an ordered-by user list are kept in the child vector in the order they are
+ * entered, and can not be found by binary search. Finding the position of an entry, eg the
+ * anchor of an insert "before" or "after", or the end of the list for an insert "last", is
+ * otherwise made with a linear scan of the child vector.
+ * An order index is a treap (randomized binary tree) of the entries of one list under one
+ * parent, where each node holds the size of its subtree, and a pointer hash from entry to
+ * tree node. The rank of an entry in its list is then computed by walking from its node to
+ * the root, and its position in the child vector is the position of the first entry plus
+ * its rank.
+ * An index is created on demand per parent and list, the first time a position is looked
+ * up in a list with at least XML_ORDER_INDEX_THRESHOLD children.
+ *
+ * The index of a parent is kept up to date by the child vector primitives in clixon_xml.c,
+ * which call xml_order_index_insert/rm with the position of each inserted or removed child.
+ * Changes where positions are not known, such as sorting or resetting the child vector,
+ * drop the index. It is also dropped if the list entries are found not to be contiguous.
+ * Positions are always verified against the child vector before they are used.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_order.h"
+
+#ifdef XML_ORDER_INDEX
+
+/* Initial number of hash buckets, power of 2 */
+#define XML_ORDER_INDEX_SIZE_START 1024
+
+/* Subtree size of a possibly empty tree */
+#define ON_SIZE(on) ((on)?(int)(on)->on_size:0)
+
+/*! A list entry in an order index, tree node and member of a hash bucket chain
+ */
+struct xml_order_node{
+    struct xml_order_node *on_left;   /* Entries before */
+    struct xml_order_node *on_right;  /* Entries after */
+    struct xml_order_node *on_up;     /* Parent tree node */
+    struct xml_order_node *on_hnext;  /* Next node in same hash bucket */
+    cxobj                 *on_x;      /* List entry */
+    uint32_t               on_prio;   /* Random heap priority */
+    uint32_t               on_size;   /* Number of nodes in subtree including this */
+};
+
+/*! Order index of one list under one parent
+ *
+ * A parent may have several indexes, one for each list, in a linked list
+ */
+struct xml_order_index{
+    struct xml_order_index *oi_next;   /* Next index of same parent */
+    yang_stmt              *oi_yang;   /* Yang list or leaf-list statement */
+    struct xml_order_node  *oi_root;   /* Root of tree */
+    struct xml_order_node **oi_bucket; /* Vector of hash buckets */
+    size_t                  oi_size;   /* Number of buckets, power of 2 */
+    int                     oi_nr;     /* Number of entries */
+    int                     oi_first;  /* Position of first entry in child vector */
+    uint32_t                oi_seed;   /* Random state for priorities */
+};
+
+/*! Check if a yang statement is an ordered-by user list or leaf-list
+ */
+static int
+order_index_yang(yang_stmt *yc)
+{
+    if (yc == NULL)
+        return 0;
+    if (yang_keyword_get(yc) != Y_LIST && yang_keyword_get(yc) != Y_LEAF_LIST)
+        return 0;
+    return yang_find(yc, Y_ORDERED_BY, "user") != NULL;
+}
+
+/*! Check if an XML node belongs to the list of an index
+ *
+ * Entries may not yet be bound to yang when added, then compare names
+ */
+static int
+order_index_member(struct xml_order_index *oi,
+                   cxobj                  *x)
+{
+    yang_stmt *y;
+
+    if (xml_type(x) != CX_ELMNT)
+        return 0;
+    if ((y = xml_spec(x)) != NULL)
+        return y == oi->oi_yang;
+    return strcmp(xml_name(x), yang_argument_get(oi->oi_yang)) == 0;
+}
+
+/*! Next random priority (xorshift32)
+ */
+static uint32_t
+order_index_rand(struct xml_order_index *oi)
+{
+    uint32_t r = oi->oi_seed;
+
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    oi->oi_seed = r;
+    return r;
+}
+
+/*! Hash bucket of an XML node pointer
+ */
+static size_t
+order_index_hash(struct xml_order_index *oi,
+                 cxobj                  *x)
+{
+    uintptr_t p = (uintptr_t)x;
+
+    p ^= p >> 17;
+    return (size_t)((p >> 3) * 2654435761U) & (oi->oi_size-1);
+}
+
+/*! Double the number of hash buckets and rehash
+ */
+static int
+order_index_grow(struct xml_order_index *oi)
+{
+    struct xml_order_node **bucket;
+    struct xml_order_node  *on;
+    size_t                  size0 = oi->oi_size;
+    size_t                  i;
+
+    oi->oi_size = size0 ? 2*size0 : XML_ORDER_INDEX_SIZE_START;
+    if ((bucket = calloc(oi->oi_size, sizeof(struct xml_order_node *))) == NULL){
+        clicon_err(OE_XML, errno, "calloc");
+        oi->oi_size = size0;
+        return -1;
+    }
+    for (i=0; i<size0; i++)
+        while ((on = oi->oi_bucket[i]) != NULL){
+            oi->oi_bucket[i] = on->on_hnext;
+            on->on_hnext = bucket[order_index_hash(oi, on->on_x)];
+            bucket[order_index_hash(oi, on->on_x)] = on;
+        }
+    if (oi->oi_bucket)
+        free(oi->oi_bucket);
+    oi->oi_bucket = bucket;
+    return 0;
+}
+
+/*! Create a node for a list entry and add it to the hash
+ */
+static struct xml_order_node *
+order_index_node_new(struct xml_order_index *oi,
+                     cxobj                  *x)
+{
+    struct xml_order_node *on;
+    size_t                 h;
+
+    if (oi->oi_nr >= oi->oi_size && order_index_grow(oi) < 0)
+        return NULL;
+    if ((on = malloc(sizeof(*on))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return NULL;
+    }
+    memset(on, 0, sizeof(*on));
+    on->on_x = x;
+    on->on_prio = order_index_rand(oi);
+    on->on_size = 1;
+    h = order_index_hash(oi, x);
+    on->on_hnext = oi->oi_bucket[h];
+    oi->oi_bucket[h] = on;
+    oi->oi_nr++;
+    return on;
+}
+
+/*! Find node of a list entry
+ */
+static struct xml_order_node *
+order_index_lookup(struct xml_order_index *oi,
+                   cxobj                  *x)
+{
+    struct xml_order_node *on;
+
+    if (oi->oi_size == 0)
+        return NULL;
+    for (on = oi->oi_bucket[order_index_hash(oi, x)]; on; on = on->on_hnext)
+        if (on->on_x == x)
+            return on;
+    return NULL;
+}
+
+/*! Rank of a node, ie number of entries before it in the list
+ */
+static int
+order_index_rank(struct xml_order_node *on)
+{
+    struct xml_order_node *up;
+    int                    r;
+
+    r = ON_SIZE(on->on_left);
+    for (; (up = on->on_up) != NULL; on = up)
+        if (up->on_right == on)
+            r += ON_SIZE(up->on_left) + 1;
+    return r;
+}
+
+/*! Rotate a node above its parent in the tree, keeping the order
+ */
+static void
+order_index_rotate(struct xml_order_index *oi,
+                   struct xml_order_node  *on)
+{
+    struct xml_order_node *p = on->on_up;
+    struct xml_order_node *g = p->on_up;
+
+    if (p->on_left == on){
+        if ((p->on_left = on->on_right) != NULL)
+            p->on_left->on_up = p;
+        on->on_right = p;
+    }
+    else {
+        if ((p->on_right = on->on_left) != NULL)
+            p->on_right->on_up = p;
+        on->on_left = p;
+    }
+    p->on_up = on;
+    on->on_up = g;
+    if (g == NULL)
+        oi->oi_root = on;
+    else if (g->on_left == p)
+        g->on_left = on;
+    else
+        g->on_right = on;
+    on->on_size = p->on_size;
+    p->on_size = ON_SIZE(p->on_left) + ON_SIZE(p->on_right) + 1;
+}
+
+/*! Insert a new node into the tree with a given rank
+ */
+static void
+order_index_tree_insert(struct xml_order_index *oi,
+                        struct xml_order_node  *on,
+                        int                     rank)
+{
+    struct xml_order_node *p;
+
+    if ((p = oi->oi_root) == NULL){
+        oi->oi_root = on;
+        return;
+    }
+    while (1){
+        p->on_size++;
+        if (rank <= ON_SIZE(p->on_left)){
+            if (p->on_left == NULL){
+                p->on_left = on;
+                break;
+            }
+            p = p->on_left;
+        }
+        else {
+            rank -= ON_SIZE(p->on_left) + 1;
+            if (p->on_right == NULL){
+                p->on_right = on;
+                break;
+            }
+            p = p->on_right;
+        }
+    }
+    on->on_up = p;
+    while (on->on_up && on->on_prio > on->on_up->on_prio)
+        order_index_rotate(oi, on);
+}
+
+/*! Remove a node from the tree and hash and free it
+ */
+static void
+order_index_node_rm(struct xml_order_index *oi,
+                    struct xml_order_node  *on)
+{
+    struct xml_order_node  *c;
+    struct xml_order_node  *p;
+    struct xml_order_node **onp;
+
+    /* Rotate down until leaf */
+    while (on->on_left || on->on_right){
+        if (on->on_left == NULL)
+            c = on->on_right;
+        else if (on->on_right == NULL)
+            c = on->on_left;
+        else
+            c = on->on_left->on_prio > on->on_right->on_prio ? on->on_left : on->on_right;
+        order_index_rotate(oi, c);
+    }
+    if ((p = on->on_up) == NULL)
+        oi->oi_root = NULL;
+    else if (p->on_left == on)
+        p->on_left = NULL;
+    else
+        p->on_right = NULL;
+    for (; p; p = p->on_up)
+        p->on_size--;
+    for (onp = &oi->oi_bucket[order_index_hash(oi, on->on_x)]; *onp; onp = &(*onp)->on_hnext)
+        if (*onp == on){
+            *onp = on->on_hnext;
+            break;
+        }
+    oi->oi_nr--;
+    free(on);
+}
+
+/*! Compute subtree sizes after tree is built
+ */
+static uint32_t
+order_index_sizes(struct xml_order_node *on)
+{
+    if (on == NULL)
+        return 0;
+    on->on_size = order_index_sizes(on->on_left) + order_index_sizes(on->on_right) + 1;
+    return on->on_size;
+}
+
+/*! Free an order index
+ */
+static int
+order_index_free1(struct xml_order_index *oi)
+{
+    struct xml_order_node *on;
+    size_t                 i;
+
+    for (i=0; i<oi->oi_size; i++)
+        while ((on = oi->oi_bucket[i]) != NULL){
+            oi->oi_bucket[i] = on->on_hnext;
+            free(on);
+        }
+    if (oi->oi_bucket)
+        free(oi->oi_bucket);
+    free(oi);
+    return 0;
+}
+
+/*! Unlink an order index from its parent and free it
+ */
+static int
+order_index_drop(cxobj                  *xp,
+                 struct xml_order_index *oi)
+{
+    struct xml_order_index *oprev;
+
+    if ((oprev = xml_order_index_get(xp)) == oi){
+        if (xml_order_index_set(xp, oi->oi_next) < 0)
+            return -1;
+    }
+    else {
+        while (oprev->oi_next != oi)
+            oprev = oprev->oi_next;
+        oprev->oi_next = oi->oi_next;
+    }
+    return order_index_free1(oi);
+}
+
+/*! Create order index of a list under a parent from existing entries
+ *
+ * The tree is built as a cartesian tree in one pass over the entries
+ * @param[in]  xp   Parent XML node
+ * @param[in]  yc   Yang list
+ * @param[out] oip  Order index, linked to parent, or NULL if entries are not contiguous
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+order_index_create(cxobj                   *xp,
+                   yang_stmt               *yc,
+                   struct xml_order_index **oip)
+{
+    int                     retval = -1;
+    struct xml_order_index *oi = NULL;
+    struct xml_order_node **stack = NULL;
+    struct xml_order_node  *on;
+    struct xml_order_node  *last;
+    cxobj                  *x;
+    int                     sp = 0;
+    int                     first = -1;
+    int                     i;
+
+    *oip = NULL;
+    for (i=0; i<xml_child_nr(xp); i++){
+        x = xml_child_i(xp, i);
+        if (xml_spec(x) != yc)
+            continue;
+        if (first == -1)
+            first = i;
+        else if (xml_spec(xml_child_i(xp, i-1)) != yc)
+            goto ok; /* Not contiguous */
+    }
+    if (first == -1)
+        goto ok;
+    if ((oi = malloc(sizeof(*oi))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        goto done;
+    }
+    memset(oi, 0, sizeof(*oi));
+    oi->oi_yang = yc;
+    oi->oi_first = first;
+    oi->oi_seed = (uint32_t)(uintptr_t)xp | 1;
+    if ((stack = calloc(xml_child_nr(xp) - first, sizeof(*stack))) == NULL){
+        clicon_err(OE_XML, errno, "calloc");
+        goto done;
+    }
+    for (i=first; i<xml_child_nr(xp); i++){
+        x = xml_child_i(xp, i);
+        if (xml_spec(x) != yc)
+            break;
+        if ((on = order_index_node_new(oi, x)) == NULL)
+            goto done;
+        /* Nodes on the stack with lower priority become left subtree of new node */
+        last = NULL;
+        while (sp > 0 && stack[sp-1]->on_prio < on->on_prio)
+            last = stack[--sp];
+        if ((on->on_left = last) != NULL)
+            last->on_up = on;
+        if (sp > 0){
+            stack[sp-1]->on_right = on;
+            on->on_up = stack[sp-1];
+        }
+        stack[sp++] = on;
+    }
+    oi->oi_root = stack[0];
+    order_index_sizes(oi->oi_root);
+    oi->oi_next = xml_order_index_get(xp);
+    if (xml_order_index_set(xp, oi) < 0)
+        goto done;
+    *oip = oi;
+    oi = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (stack)
+        free(stack);
+    if (oi)
+        order_index_free1(oi);
+    return retval;
+}
+
+/*! Find or create order index of a list under a parent
+ *
+ * @retval     0    OK, *oip is NULL if not applicable
+ * @retval    -1    Error
+ */
+static int
+order_index_find(cxobj                   *xp,
+                 yang_stmt               *yc,
+                 struct xml_order_index **oip)
+{
+    struct xml_order_index *oi;
+
+    *oip = NULL;
+    if (!order_index_yang(yc))
+        return 0;
+    for (oi = xml_order_index_get(xp); oi; oi = oi->oi_next)
+        if (oi->oi_yang == yc){
+            *oip = oi;
+            return 0;
+        }
+    if (xml_child_nr(xp) < XML_ORDER_INDEX_THRESHOLD)
+        return 0;
+    return order_index_create(xp, yc, oip);
+}
+
+/*! Get position of a child of an ordered-by user list in the child vector of its parent
+ *
+ * Index is created if list is large enough and not already present.
+ * @param[in]  xp    Parent XML node
+ * @param[in]  xc    Child XML node
+ * @param[out] posp  Position of xc in child vector of xp
+ * @retval     1     OK, see posp
+ * @retval     0     Index not applicable, search the child vector
+ * @retval    -1     Error
+ * @see xml_child_order
+ */
+int
+xml_order_index_pos(cxobj *xp,
+                    cxobj *xc,
+                    int   *posp)
+{
+    struct xml_order_index *oi;
+    struct xml_order_node  *on;
+    int                     pos;
+
+    if (order_index_find(xp, xml_spec(xc), &oi) < 0)
+        return -1;
+    if (oi == NULL)
+        return 0;
+    if ((on = order_index_lookup(oi, xc)) == NULL)
+        return 0;
+    pos = oi->oi_first + order_index_rank(on);
+    if (xml_child_i(xp, pos) != xc){ /* Should not happen, start over */
+        if (order_index_drop(xp, oi) < 0)
+            return -1;
+        return 0;
+    }
+    *posp = pos;
+    return 1;
+}
+
+/*! Get range of the entries of an ordered-by user list in the child vector of the parent
+ *
+ * Index is created if list is large enough and not already present.
+ * @param[in]  xp      Parent XML node
+ * @param[in]  yc      Yang list or leaf-list
+ * @param[out] firstp  Position of first entry in child vector of xp
+ * @param[out] nrp     Number of entries
+ * @retval     1       OK, see firstp and nrp
+ * @retval     0       Index not applicable, search the child vector
+ * @retval    -1       Error
+ * @see clixon_xml_find_pos
+ */
+int
+xml_order_index_range(cxobj     *xp,
+                      yang_stmt *yc,
+                      int       *firstp,
+                      int       *nrp)
+{
+    struct xml_order_index *oi;
+    cxobj                  *x;
+    int                     first;
+    int                     nr;
+
+    if (order_index_find(xp, yc, &oi) < 0)
+        return -1;
+    if (oi == NULL || oi->oi_nr == 0)
+        return 0;
+    first = oi->oi_first;
+    nr = oi->oi_nr;
+    /* Verify ends of range */
+    if ((x = xml_child_i(xp, first)) == NULL || xml_spec(x) != yc ||
+        (x = xml_child_i(xp, first+nr-1)) == NULL || xml_spec(x) != yc ||
+        (first > 0 && xml_spec(xml_child_i(xp, first-1)) == yc) ||
+        ((x = xml_child_i(xp, first+nr)) != NULL && xml_spec(x) == yc)){
+        if (order_index_drop(xp, oi) < 0)
+            return -1;
+        return 0;
+    }
+    *firstp = first;
+    *nrp = nr;
+    return 1;
+}
+
+/*! A child has been inserted into the child vector of a parent, update indexes
+ *
+ * @param[in]  xp   Parent XML node, with order index
+ * @param[in]  xc   Inserted child
+ * @param[in]  pos  Position of xc in child vector
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xml_order_index_insert(cxobj *xp,
+                       cxobj *xc,
+                       int    pos)
+{
+    struct xml_order_index *oi;
+    struct xml_order_index *onext;
+    struct xml_order_node  *on;
+    int                     rank;
+
+    for (oi = xml_order_index_get(xp); oi; oi = onext){
+        onext = oi->oi_next;
+        if (oi->oi_nr == 0)
+            oi->oi_first = pos;
+        rank = pos - oi->oi_first;
+        if (order_index_member(oi, xc)){
+            if (rank < 0 || rank > oi->oi_nr){ /* Not contiguous */
+                if (order_index_drop(xp, oi) < 0)
+                    return -1;
+                continue;
+            }
+            if ((on = order_index_node_new(oi, xc)) == NULL)
+                return -1;
+            order_index_tree_insert(oi, on, rank);
+        }
+        else if (rank <= 0)
+            oi->oi_first++;
+        else if (rank < oi->oi_nr){ /* Inside list */
+            if (order_index_drop(xp, oi) < 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+/*! A child has been removed from the child vector of a parent, update indexes
+ *
+ * @param[in]  xp   Parent XML node, with order index
+ * @param[in]  xc   Removed child
+ * @param[in]  pos  Position of xc in child vector before it was removed
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xml_order_index_rm(cxobj *xp,
+                   cxobj *xc,
+                   int    pos)
+{
+    struct xml_order_index *oi;
+    struct xml_order_index *onext;
+    struct xml_order_node  *on;
+
+    for (oi = xml_order_index_get(xp); oi; oi = onext){
+        onext = oi->oi_next;
+        if ((on = order_index_lookup(oi, xc)) != NULL){
+            if (pos != oi->oi_first + order_index_rank(on)){
+                if (order_index_drop(xp, oi) < 0)
+                    return -1;
+                continue;
+            }
+            order_index_node_rm(oi, on);
+        }
+        else if (pos < oi->oi_first)
+            oi->oi_first--;
+    }
+    return 0;
+}
+
+/*! Free all order indexes of a parent
+ *
+ * @param[in]  xp   Parent XML node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xml_order_index_free(cxobj *xp)
+{
+    struct xml_order_index *oi;
+
+    while ((oi = xml_order_index_get(xp)) != NULL){
+        if (xml_order_index_set(xp, oi->oi_next) < 0)
+            return -1;
+        order_index_free1(oi);
+    }
+    return 0;
+}
+
+/*! Return memory used by order indexes of a parent
+ *
+ * @param[in]  xp   Parent XML node
+ * @retval     sz   Size in bytes
+ */
+size_t
+xml_order_index_size(cxobj *xp)
+{
+    struct xml_order_index *oi;
+    size_t                  sz = 0;
+
+    for (oi = xml_order_index_get(xp); oi; oi = oi->oi_next){
+        sz += sizeof(struct xml_order_index);
+        sz += oi->oi_size*sizeof(struct xml_order_node *);
+        sz += oi->oi_nr*sizeof(struct xml_order_node);
+    }
+    return sz;
+}
+
+#endif /* XML_ORDER_INDEX */
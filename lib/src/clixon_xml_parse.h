@@ -55,6 +55,9 @@ struct clixon_xml_parse_yacc {
     int         xy_lex_state;    /* lex return state */
     cxobj     **xy_xvec;         /* Vector of created top-level nodes (to know which are created) */
     int         xy_xlen;         /* Length of xy_xvec */
+    yang_bind   xy_bind;         /* If set, bind yang while parsing (scanner only) */
+    int         xy_bound;        /* Set by scanner if all new nodes are bound and sorted */
+    int         xy_lazy;         /* Keep bound anydata content unparsed (scanner only) */
 };
 typedef struct clixon_xml_parse_yacc clixon_xml_yacc;
 
@@ -73,4 +76,6 @@ int clixon_xml_parsel_linenr(void);
 int clixon_xml_parselex(void *);
 int clixon_xml_parseparse(void *);
 
+int clixon_xml_scan(clixon_xml_yacc *xy);
+
 #endif  /* _CLIXON_XML_PARSE_H_ */
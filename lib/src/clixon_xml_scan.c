@@ -0,0 +1,936 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Hand-written XML scanner, alternative to the lex/yacc parser of clixon_xml_parse.[ly]
+ * Selected at runtime with CLICON_XML_SCANNER, see clixon_xml_parse_scanner()
+ *
+ * The scanner builds the same tree as the lex/yacc parser for all documents the latter
+ * accepts, including its handling of comments, processing instructions, CDATA and entities:
+ * - Text of an element with element children is dropped, otherwise all text is one body
+ * - &amp; &lt; &gt; &apos; &quot; are decoded, character references are kept as is
+ * - CDATA sections are kept as is, including the <![CDATA[ ]]> markers
+ * - Attribute values are not decoded
+ * - After a comment or a processing instruction, the lex parser is in its tag state, where
+ *   whitespace is skipped and names are errors, this is emulated by SCAN_TAG mode.
+ * Text is scanned in runs with strcspn(3), strchr(3) and strstr(3), which are vectorized
+ * in common C libraries, instead of character by character, and a body is set at once from
+ * the input string instead of appended token by token.
+ * Malformed documents are rejected as by the lex/yacc parser, but with other error messages.
+ * If xy_bind is set, elements are bound to YANG when their start tag is parsed, following
+ * the parent binding, and children are sorted when the end tag is parsed. Elements that are
+ * not bound as by xml_bind_yang, eg anydata, actions and unknown elements, stop binding and
+ * the caller binds and sorts the tree after parsing.
+ * If also xy_lazy is set, the content of bound anydata and anyxml elements is only checked
+ * for matching tags and kept unparsed, see xml_lazy.
+ * @see https://www.w3.org/TR/2008/REC-xml-20081126
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_bind.h"
+#include "clixon_xml_parse.h"
+
+/* Scanner modes, corresponding to lex states STATEA and START of clixon_xml_parse.l */
+enum scan_mode{
+    SCAN_CONTENT, /* Content of element: text, entities and markup */
+    SCAN_TAG,     /* Initial, and after comment and PI: whitespace skipped, single chars */
+};
+
+/*! XML scanner state
+ */
+struct xml_scan {
+    clixon_xml_yacc *xs_xy;
+    char            *xs_str;     /* Start of parse string, for line numbers */
+    char            *xs_p;       /* Current position */
+    cxobj           *xs_x;       /* Current open element, or top */
+    int              xs_text;    /* Current element has no element children: keep its text */
+    char            *xs_seg;     /* Pending text if single segment of parse string */
+    size_t           xs_seglen;
+    cbuf            *xs_cb;      /* Pending text if several segments */
+    int              xs_cbused;
+    int              xs_prolog;  /* Document has XML declaration: one element */
+    int              xs_root;    /* Prolog: the element is parsed */
+    int              xs_bind;    /* Bind yang while parsing, cleared if not possible */
+};
+
+#define scan_namestart(c) (((c)>='A' && (c)<='Z') || ((c)>='a' && (c)<='z') || (c)=='_')
+#define scan_namechar(c)  (scan_namestart(c) || ((c)>='0' && (c)<='9') || (c)=='-' || (c)=='.')
+#define scan_space(c)     ((c)==' ' || (c)=='\t' || (c)=='\n' || (c)=='\r')
+
+/*! Report scanner syntax error, with line number as the lex/yacc parser
+ */
+static int
+scan_error(struct xml_scan *xs,
+           char            *reason)
+{
+    char *s;
+    int   linenum = 0;
+
+    for (s = xs->xs_str; s < xs->xs_p; s++)
+        if (*s == '\n')
+            linenum++;
+    clicon_err(OE_XML, XMLPARSE_ERRNO, "xml_parse: line %d: %s: at or before: %.16s",
+               linenum, reason, xs->xs_p);
+    return -1;
+}
+
+/*! Skip whitespace as in tag state */
+static inline void
+scan_skip(struct xml_scan *xs)
+{
+    while (scan_space(*xs->xs_p))
+        xs->xs_p++;
+}
+
+/*! Add text to pending body of current element
+ *
+ * @param[in]  xs   Scanner
+ * @param[in]  s    Text, not necessarily null-terminated, in parse string or constant
+ * @param[in]  len  Length of text
+ */
+static int
+scan_text(struct xml_scan *xs,
+          char            *s,
+          size_t           len)
+{
+    if (!xs->xs_text || len == 0)
+        return 0;
+    if (xs->xs_seg == NULL && !xs->xs_cbused){
+        xs->xs_seg = s;
+        xs->xs_seglen = len;
+        return 0;
+    }
+    if (!xs->xs_cbused){
+        cbuf_reset(xs->xs_cb);
+        if (cbuf_append_buf(xs->xs_cb, xs->xs_seg, xs->xs_seglen) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            return -1;
+        }
+        xs->xs_seg = NULL;
+        xs->xs_cbused = 1;
+    }
+    if (cbuf_append_buf(xs->xs_cb, s, len) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Drop pending text */
+static inline void
+scan_text_reset(struct xml_scan *xs)
+{
+    xs->xs_seg = NULL;
+    xs->xs_cbused = 0;
+}
+
+/*! Create body of current element from pending text
+ */
+static int
+scan_body(struct xml_scan *xs)
+{
+    int    retval = -1;
+    cxobj *xb;
+    char   c;
+
+    if (!xs->xs_text || (xs->xs_seg == NULL && !xs->xs_cbused))
+        goto ok;
+    if ((xb = xml_new("body", xs->xs_x, CX_BODY)) == NULL)
+        goto done;
+    if (xs->xs_cbused){
+        if (xml_value_set(xb, cbuf_get(xs->xs_cb)) < 0)
+            goto done;
+    }
+    else { /* Set from parse string, temporarily terminated */
+        c = xs->xs_seg[xs->xs_seglen];
+        xs->xs_seg[xs->xs_seglen] = '\0';
+        retval = xml_value_set(xb, xs->xs_seg);
+        xs->xs_seg[xs->xs_seglen] = c;
+        if (retval < 0)
+            goto done;
+    }
+    scan_text_reset(xs);
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Scan name: [A-Z_a-z][A-Z_a-z-.0-9]*
+ *
+ * @param[in]  xs   Scanner
+ * @retval     len  Length of name at current position, 0 if no name
+ */
+static size_t
+scan_ncname(struct xml_scan *xs)
+{
+    char *s = xs->xs_p;
+
+    if (!scan_namestart(*s))
+        return 0;
+    for (s++; scan_namechar(*s); s++)
+        ;
+    return s - xs->xs_p;
+}
+
+/*! Scan qualified name: NAME | NAME ':' NAME, whitespace allowed between tokens
+ *
+ * @param[in]  xs      Scanner
+ * @param[out] prefix  Start of prefix, or NULL
+ * @param[out] plen    Length of prefix
+ * @param[out] name    Start of name
+ * @param[out] nlen    Length of name
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+scan_qname(struct xml_scan *xs,
+           char           **prefix,
+           size_t          *plen,
+           char           **name,
+           size_t          *nlen)
+{
+    size_t len;
+
+    scan_skip(xs);
+    *prefix = NULL;
+    *plen = 0;
+    if ((len = scan_ncname(xs)) == 0)
+        return scan_error(xs, "syntax error");
+    *name = xs->xs_p;
+    *nlen = len;
+    xs->xs_p += len;
+    scan_skip(xs);
+    if (*xs->xs_p == ':'){
+        xs->xs_p++;
+        scan_skip(xs);
+        if ((len = scan_ncname(xs)) == 0)
+            return scan_error(xs, "syntax error");
+        *prefix = *name;
+        *plen = *nlen;
+        *name = xs->xs_p;
+        *nlen = len;
+        xs->xs_p += len;
+        scan_skip(xs);
+    }
+    return 0;
+}
+
+/*! Create element or attribute with name and prefix in the parse string
+ *
+ * Name and prefix are temporarily null-terminated
+ * @param[in]  xp      Parent
+ * @param[in]  prefix  Prefix in parse string, or NULL
+ * @param[in]  plen    Length of prefix
+ * @param[in]  name    Name in parse string
+ * @param[in]  nlen    Length of name
+ * @param[in]  type    CX_ELMNT or CX_ATTR
+ * @param[in]  value   Attribute value, null-terminated, if CX_ATTR
+ * @retval     x       Created or, for an existing attribute, updated node
+ * @retval     NULL    Error
+ */
+static cxobj *
+scan_node(cxobj      *xp,
+          char       *prefix,
+          size_t      plen,
+          char       *name,
+          size_t      nlen,
+          enum cxobj_type type,
+          char       *value)
+{
+    cxobj *x = NULL;
+    char   pc = 0;
+    char   nc;
+
+    if (prefix){
+        pc = prefix[plen];
+        prefix[plen] = '\0';
+    }
+    nc = name[nlen];
+    name[nlen] = '\0';
+    if (type == CX_ATTR &&
+        (x = xml_find_type(xp, prefix, name, CX_ATTR)) != NULL)
+        ;
+    else if ((x = xml_new(name, xp, type)) == NULL)
+        goto done;
+    else if (xml_prefix_set(x, prefix) < 0){
+        x = NULL;
+        goto done;
+    }
+    if (type == CX_ATTR && xml_value_set(x, value) < 0)
+        x = NULL;
+ done:
+    name[nlen] = nc;
+    if (prefix)
+        prefix[plen] = pc;
+    return x;
+}
+
+/*! Scan quoted string, attribute value or XML declaration value
+ *
+ * @param[in]  xs     Scanner, at quote
+ * @param[out] value  Start of value, null-terminated in place of the end quote
+ * @param[out] quote  End quote, restore with value[-1] after use
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+scan_string(struct xml_scan *xs,
+            char           **value,
+            char           **quote)
+{
+    char *q;
+
+    if (*xs->xs_p != '"' && *xs->xs_p != '\'')
+        return scan_error(xs, "syntax error");
+    if ((q = strchr(xs->xs_p+1, *xs->xs_p)) == NULL)
+        return scan_error(xs, "syntax error");
+    *value = xs->xs_p + 1;
+    *quote = q;
+    *q = '\0';
+    xs->xs_p = q + 1;
+    return 0;
+}
+
+/*! Bind element to yang after its start tag, as xml_bind_yang0 without handle
+ *
+ * Children of the top node are bound as top-level symbols or from the yang of the top node
+ * depending on bind mode, other elements from the yang of their parent.
+ * If the element is not bound as in xml_bind_yang0, binding while parsing is stopped.
+ * @param[in]  xs   Scanner
+ * @param[in]  x    Element with attributes
+ * @retval     0    OK, possibly binding stopped
+ * @retval    -1    Error
+ * @see populate_self_parent
+ * @see populate_self_top
+ */
+static int
+scan_bind(struct xml_scan *xs,
+          cxobj           *x)
+{
+    clixon_xml_yacc *xy = xs->xs_xy;
+    cxobj           *xp = xml_parent(x);
+    cxobj           *xprev;
+    yang_stmt       *yp;
+    yang_stmt       *y = NULL;
+    yang_stmt       *ymod = NULL;
+    char            *name = xml_name(x);
+    char            *prefix = xml_prefix(x);
+    char            *ns = NULL;
+    char            *nsy;
+    int              nr;
+
+    /* As xml_bind_yang0_opt: same yang as previous sibling with same name */
+    if ((nr = xml_child_nr(xp)) > 1 &&
+        (xprev = xml_child_i(xp, nr-2)) != NULL &&
+        xml_type(xprev) == CX_ELMNT &&
+        (y = xml_spec(xprev)) != NULL &&
+        clicon_strcmp(xml_name(xprev), name) == 0 &&
+        clicon_strcmp(xml_prefix(xprev), prefix) == 0 &&
+        xml_child_nr_type(x, CX_ATTR) == 0)
+        goto set;
+    y = NULL;
+    if (xp == xy->xy_xtop && xy->xy_bind == YB_MODULE_NEXT)
+        return 0; /* Not bound, its children are top-level symbols */
+    if (xy->xy_bind != YB_PARENT &&
+        (xp == xy->xy_xtop ||
+         (xy->xy_bind == YB_MODULE_NEXT && xml_parent(xp) == xy->xy_xtop))){
+        if (xy->xy_yspec == NULL)
+            goto stop;
+        if (ys_module_by_xml(xy->xy_yspec, x, &ymod) < 0)
+            return -1;
+        if (ymod == NULL || (y = yang_find_schemanode(ymod, name)) == NULL)
+            goto stop;
+    }
+    else {
+        if ((yp = xml_spec(xp)) == NULL ||
+            yang_keyword_get(yp) == Y_ANYXML || yang_keyword_get(yp) == Y_ANYDATA ||
+            yang_find(yp, Y_ACTION, name) != NULL ||
+            (y = yang_find_datanode(yp, name)) == NULL)
+            goto stop;
+    }
+    if (xml2ns(x, prefix, &ns) < 0)
+        return -1;
+    if ((nsy = yang_find_mynamespace(y)) == NULL || ns == NULL || strcmp(ns, nsy) != 0)
+        goto stop;
+    /* Search index is updated by the bind after parsing */
+    if (yang_flag_get(y, YANG_FLAG_INDEX) != 0)
+        goto stop;
+ set:
+    xml_spec_set(x, y);
+    return 0;
+ stop:
+    xs->xs_bind = 0;
+    return 0;
+}
+
+/*! Element is complete after its end tag, strip bodies and sort children as xml_bind_yang
+ *
+ * @param[in]  x    Element
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_sort_recurse
+ */
+static int
+scan_bind_close(cxobj *x)
+{
+    yang_stmt    *y;
+    enum rfc_6020 keyword;
+    cxobj        *xc;
+    int           ret;
+
+    if (xml_lazy(x) != NULL) /* Unparsed anydata */
+        return 0;
+    if ((y = xml_spec(x)) != NULL){
+        keyword = yang_keyword_get(y);
+        if (keyword == Y_LIST || keyword == Y_CONTAINER)
+            while ((xc = xml_find_type(x, NULL, "body", CX_BODY)) != NULL)
+                xml_purge(xc);
+        else if ((keyword == Y_LEAF || keyword == Y_LEAF_LIST) &&
+                 xml_bind_value(x) < 0)
+            return -1;
+    }
+    if ((ret = xml_sort_verify(x, NULL)) == 1) /* Not sortable */
+        return 0;
+    if (ret == -1 && xml_sort(x) < 0)
+        return -1;
+    if (xml_cv_cache_clear(x) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Skip content of current element until its end tag, and keep it unparsed
+ *
+ * Only element tags are matched, names of end tags are not checked, and comments, CDATA
+ * sections and processing instructions are skipped. The content is checked when parsed.
+ * Content without elements is parsed as usual.
+ * @param[in]  xs     Scanner, after start tag of current element
+ * @retval     1      Content is kept unparsed, at end tag of current element after "</"
+ * @retval     0      Content has no elements, not changed
+ * @retval    -1      Error
+ * @see xml_lazy
+ */
+static int
+scan_lazy(struct xml_scan *xs)
+{
+    char *s = xs->xs_p;
+    char *p;
+    int   depth = 0;
+    int   elements = 0;
+
+    for (;;){
+        if ((s = strchr(s, '<')) == NULL)
+            return scan_error(xs, "syntax error");
+        if (strncmp(s, "<!--", 4) == 0)
+            p = strstr(s+4, "-->");
+        else if (strncmp(s, "<![CDATA[", 9) == 0)
+            p = strstr(s+9, "]]>");
+        else if (s[1] == '?')
+            p = strstr(s+2, "?>");
+        else if (s[1] == '/'){
+            if (depth-- == 0)
+                break;
+            p = strchr(s+2, '>');
+        }
+        else { /* Start tag, quoted attribute values may contain '>' */
+            elements++;
+            for (p = s+1; *p && *p != '>'; p++)
+                if ((*p == '"' || *p == '\'') && (p = strchr(p+1, *p)) == NULL)
+                    break;
+            if (p == NULL || *p == '\0')
+                return scan_error(xs, "syntax error");
+            if (p[-1] != '/')
+                depth++;
+        }
+        if (p == NULL)
+            return scan_error(xs, "syntax error");
+        s = p + 1;
+    }
+    if (elements == 0)
+        return 0;
+    if (xml_lazy_set(xs->xs_x, xs->xs_p, s - xs->xs_p) < 0)
+        return -1;
+    xs->xs_p = s + 2;
+    return 1;
+}
+
+static int scan_etag(struct xml_scan *xs);
+
+/*! Scan start tag after '<', and create element with attributes
+ *
+ * @param[in]  xs     Scanner
+ * @param[out] empty  Set if empty element tag "/>"
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+scan_stag(struct xml_scan *xs,
+          int             *empty)
+{
+    int    retval = -1;
+    cxobj *x;
+    char  *prefix;
+    size_t plen;
+    char  *name;
+    size_t nlen;
+    char  *value;
+    char  *q;
+    cxobj *xa;
+    int    ret;
+
+    if (scan_qname(xs, &prefix, &plen, &name, &nlen) < 0)
+        goto done;
+    if ((x = scan_node(xs->xs_x, prefix, plen, name, nlen, CX_ELMNT, NULL)) == NULL)
+        goto done;
+    /* If topmost, add to top-list created list */
+    if (xs->xs_x == xs->xs_xy->xy_xtop &&
+        cxvec_append(x, &xs->xs_xy->xy_xvec, &xs->xs_xy->xy_xlen) < 0)
+        goto done;
+    /* Element child: text of parent is dropped */
+    xs->xs_text = 0;
+    scan_text_reset(xs);
+    for (;;){
+        scan_skip(xs);
+        if (*xs->xs_p == '>'){
+            xs->xs_p++;
+            *empty = 0;
+            break;
+        }
+        if (xs->xs_p[0] == '/' && xs->xs_p[1] == '>'){
+            xs->xs_p += 2;
+            *empty = 1;
+            break;
+        }
+        /* Attribute */
+        if (scan_qname(xs, &prefix, &plen, &name, &nlen) < 0)
+            goto done;
+        if (*xs->xs_p != '='){
+            scan_error(xs, "syntax error");
+            goto done;
+        }
+        xs->xs_p++;
+        scan_skip(xs);
+        if (scan_string(xs, &value, &q) < 0)
+            goto done;
+        xa = scan_node(x, prefix, plen, name, nlen, CX_ATTR, value);
+        *q = value[-1];
+        if (xa == NULL)
+            goto done;
+    }
+    if (xs->xs_bind){
+        if (scan_bind(xs, x) < 0)
+            goto done;
+        if (*empty && xs->xs_bind && scan_bind_close(x) < 0)
+            goto done;
+    }
+    if (*empty == 0){
+        xs->xs_x = x;
+        xs->xs_text = 1;
+        if (xs->xs_bind && xs->xs_xy->xy_lazy &&
+            xml_spec(x) != NULL &&
+            (yang_keyword_get(xml_spec(x)) == Y_ANYDATA ||
+             yang_keyword_get(xml_spec(x)) == Y_ANYXML)){
+            if ((ret = scan_lazy(xs)) < 0)
+                goto done;
+            if (ret == 1){
+                xs->xs_text = 0;
+                if (scan_etag(xs) < 0)
+                    goto done;
+            }
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Scan end tag after "</", check it matches current element, and close it
+ */
+static int
+scan_etag(struct xml_scan *xs)
+{
+    int    retval = -1;
+    cxobj *x = xs->xs_x;
+    char  *prefix;
+    size_t plen;
+    char  *name;
+    size_t nlen;
+    char  *prefix0;
+    char  *name0;
+
+    if (x == xs->xs_xy->xy_xtop){
+        scan_error(xs, "syntax error");
+        goto done;
+    }
+    if (scan_qname(xs, &prefix, &plen, &name, &nlen) < 0)
+        goto done;
+    if (*xs->xs_p != '>'){
+        scan_error(xs, "syntax error");
+        goto done;
+    }
+    prefix0 = xml_prefix(x);
+    name0 = xml_name(x);
+    if (strlen(name0) != nlen || strncmp(name0, name, nlen) != 0 ||
+        (prefix0 == NULL) != (prefix == NULL) ||
+        (prefix && (strlen(prefix0) != plen || strncmp(prefix0, prefix, plen) != 0))){
+        name[nlen] = '\0';
+        if (prefix)
+            prefix[plen] = '\0';
+        clicon_err(OE_XML, XMLPARSE_ERRNO, "Sanity check failed: %s%s%s vs %s%s%s", 
+                   prefix0?prefix0:"", prefix0?":":"", name0,
+                   prefix?prefix:"", prefix?":":"", name);
+        goto done;
+    }
+    xs->xs_p++;
+    if (scan_body(xs) < 0)
+        goto done;
+    if (xs->xs_bind && scan_bind_close(x) < 0)
+        goto done;
+    xs->xs_x = xml_parent(x);
+    xs->xs_text = 0;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Scan entity reference after '&' in content
+ */
+static int
+scan_entity(struct xml_scan *xs)
+{
+    char  *s = xs->xs_p;
+    size_t len;
+
+    if (strncmp(s, "amp;", 4) == 0){
+        xs->xs_p += 4;
+        return scan_text(xs, "&", 1);
+    }
+    if (strncmp(s, "lt;", 3) == 0){
+        xs->xs_p += 3;
+        return scan_text(xs, "<", 1);
+    }
+    if (strncmp(s, "gt;", 3) == 0){
+        xs->xs_p += 3;
+        return scan_text(xs, ">", 1);
+    }
+    if (strncmp(s, "apos;", 5) == 0){
+        xs->xs_p += 5;
+        return scan_text(xs, "'", 1);
+    }
+    if (strncmp(s, "quot;", 5) == 0){
+        xs->xs_p += 5;
+        return scan_text(xs, "\"", 1);
+    }
+    /* Character reference: kept encoded */
+    if (*s == '#'){
+        if (s[1] == 'x')
+            len = 2 + strspn(s+2, "0123456789abcdefABCDEF");
+        else
+            len = 1 + strspn(s+1, "0123456789");
+        if (len > (s[1] == 'x' ? 2 : 1) && s[len] == ';'){
+            xs->xs_p += len + 1;
+            return scan_text(xs, s-1, len + 2);
+        }
+    }
+    return scan_error(xs, "unknown entity");
+}
+
+/*! Scan comment after "<!--"
+ */
+static int
+scan_comment(struct xml_scan *xs)
+{
+    char *s;
+
+    if ((s = strstr(xs->xs_p, "-->")) == NULL)
+        return scan_error(xs, "syntax error");
+    xs->xs_p = s + 3;
+    return 0;
+}
+
+/*! Scan processing instruction after "<?": NAME [ \t] STRING? "?>"
+ */
+static int
+scan_pi(struct xml_scan *xs)
+{
+    size_t len;
+
+    if ((len = scan_ncname(xs)) == 0)
+        return scan_error(xs, "syntax error");
+    xs->xs_p += len;
+    if (*xs->xs_p != ' ' && *xs->xs_p != '\t')
+        return scan_error(xs, "syntax error");
+    xs->xs_p++;
+    xs->xs_p += strcspn(xs->xs_p, "{?>}");
+    if (xs->xs_p[0] != '?' || xs->xs_p[1] != '>')
+        return scan_error(xs, "syntax error");
+    xs->xs_p += 2;
+    return 0;
+}
+
+/*! Scan XML declaration value: keyword '=' quoted string
+ *
+ * @param[in]  xs      Scanner
+ * @param[in]  keyword version, encoding or standalone
+ * @param[out] value   Value, null-terminated, or NULL if no keyword
+ * @param[out] quote   End quote, restore with value[-1] after use
+ */
+static int
+scan_xmldecl_value(struct xml_scan *xs,
+                   char            *keyword,
+                   char           **value,
+                   char           **quote)
+{
+    size_t len = strlen(keyword);
+
+    *value = NULL;
+    scan_skip(xs);
+    if (strncmp(xs->xs_p, keyword, len) != 0)
+        return 0;
+    xs->xs_p += len;
+    scan_skip(xs);
+    if (*xs->xs_p != '=')
+        return scan_error(xs, "syntax error");
+    xs->xs_p++;
+    scan_skip(xs);
+    if (scan_string(xs, value, quote) < 0)
+        return -1;
+    if (**value == '\0')
+        return scan_error(xs, "syntax error");
+    return 0;
+}
+
+/*! Scan XML declaration after "<?xml"
+ */
+static int
+scan_xmldecl(struct xml_scan *xs)
+{
+    char *value;
+    char *q;
+    int   ret;
+
+    if (scan_xmldecl_value(xs, "version", &value, &q) < 0)
+        return -1;
+    if (value == NULL)
+        return scan_error(xs, "syntax error");
+    ret = strcmp(value, "1.0");
+    if (ret)
+        clicon_err(OE_XML, XMLPARSE_ERRNO, "Unsupported XML version: %s expected 1.0", value);
+    *q = value[-1];
+    if (ret)
+        return -1;
+    if (scan_xmldecl_value(xs, "encoding", &value, &q) < 0)
+        return -1;
+    if (value){
+        ret = strcasecmp(value, "UTF-8");
+        if (ret)
+            clicon_err(OE_XML, XMLPARSE_ERRNO, "Unsupported XML encoding: %s expected UTF-8", value);
+        *q = value[-1];
+        if (ret)
+            return -1;
+    }
+    if (scan_xmldecl_value(xs, "standalone", &value, &q) < 0)
+        return -1;
+    if (value)
+        *q = value[-1];
+    scan_skip(xs);
+    if (strncmp(xs->xs_p, "?>", 2) != 0)
+        return scan_error(xs, "syntax error");
+    xs->xs_p += 2;
+    return 0;
+}
+
+/*! Scan XML string into the top element of a parser struct
+ *
+ * Same interface as the lex/yacc parser: created top-level elements are added to xy_xvec.
+ * Top-level text is checked but not added, the lex/yacc parser adds it as bodies of the top
+ * element which are purged by the caller.
+ * @param[in]  xy   XML parser struct. xy_parse_string is modified during scanning
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon_xml_parseparse
+ */
+int
+clixon_xml_scan(clixon_xml_yacc *xy)
+{
+    int             retval = -1;
+    struct xml_scan xs = {0,};
+    enum scan_mode  mode = SCAN_TAG;
+    cxobj          *xtop = xy->xy_xtop;
+    char           *p;
+    char           *s;
+    size_t          len;
+    int             empty;
+
+    xs.xs_xy = xy;
+    xs.xs_str = xs.xs_p = xy->xy_parse_string;
+    xs.xs_x = xtop;
+    xs.xs_bind = (xy->xy_bind != YB_NONE);
+    if ((xs.xs_cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* [22] prolog ::= XMLDecl? Misc*, with a declaration the document is one element */
+    scan_skip(&xs);
+    if (strncmp(xs.xs_p, "<?xml", 5) == 0){
+        xs.xs_p += 5;
+        if (scan_xmldecl(&xs) < 0)
+            goto done;
+        xs.xs_prolog = 1;
+    }
+    for (;;){
+        p = xs.xs_p;
+        if (xs.xs_prolog && xs.xs_x == xtop){ /* Misc: whitespace, comment, PI */
+            scan_skip(&xs);
+            if (*xs.xs_p != '\0' && *xs.xs_p != '<'){
+                scan_error(&xs, "syntax error");
+                goto done;
+            }
+        }
+        else if (mode == SCAN_CONTENT){
+            len = strcspn(p, "<&\r");
+            if (scan_text(&xs, p, len) < 0)
+                goto done;
+            xs.xs_p += len;
+            if (*xs.xs_p == '\r'){ /* \r\n and \r are \n */
+                if (scan_text(&xs, "\n", 1) < 0)
+                    goto done;
+                xs.xs_p += (xs.xs_p[1] == '\n') ? 2 : 1;
+                continue;
+            }
+            if (*xs.xs_p == '&'){
+                xs.xs_p++;
+                if (scan_entity(&xs) < 0)
+                    goto done;
+                continue;
+            }
+        }
+        else { /* SCAN_TAG: whitespace is skipped, other single chars are text but names */
+            scan_skip(&xs);
+            if (*xs.xs_p != '\0' && *xs.xs_p != '<'){
+                if (scan_namestart(*xs.xs_p) || strchr(":/=>\"'", *xs.xs_p) != NULL){
+                    scan_error(&xs, "syntax error");
+                    goto done;
+                }
+                if (scan_text(&xs, xs.xs_p, 1) < 0)
+                    goto done;
+                xs.xs_p++;
+                continue;
+            }
+        }
+        if (*xs.xs_p == '\0')
+            break;
+        /* Markup */
+        p = xs.xs_p;
+        if (p[1] == '/'){
+            xs.xs_p += 2;
+            if (scan_etag(&xs) < 0)
+                goto done;
+            mode = SCAN_CONTENT;
+        }
+        else if (strncmp(p, "<!--", 4) == 0){
+            xs.xs_p += 4;
+            if (scan_comment(&xs) < 0)
+                goto done;
+            mode = SCAN_TAG;
+        }
+        else if (p[1] == '?'){
+            if (mode == SCAN_TAG && strncmp(p, "<?xml", 5) == 0){
+                scan_error(&xs, "syntax error");
+                goto done;
+            }
+            xs.xs_p += 2;
+            if (scan_pi(&xs) < 0)
+                goto done;
+            mode = SCAN_TAG;
+        }
+        else if (mode == SCAN_CONTENT && strncmp(p, "<![CDATA[", 9) == 0){
+            if ((xs.xs_prolog && xs.xs_x == xtop) ||
+                (s = strstr(p+9, "]]>")) == NULL){
+                scan_error(&xs, "syntax error");
+                goto done;
+            }
+            if (scan_text(&xs, p, s+3-p) < 0)
+                goto done;
+            xs.xs_p = s+3;
+        }
+        else {
+            if (xs.xs_prolog && xs.xs_x == xtop){
+                if (xs.xs_root){
+                    scan_error(&xs, "syntax error");
+                    goto done;
+                }
+                xs.xs_root = 1;
+            }
+            xs.xs_p++;
+            if (scan_stag(&xs, &empty) < 0)
+                goto done;
+            mode = SCAN_CONTENT;
+        }
+    }
+    if (xs.xs_x != xtop || (xs.xs_prolog && !xs.xs_root)){
+        scan_error(&xs, "syntax error");
+        goto done;
+    }
+    xy->xy_bound = xs.xs_bind;
+    retval = 0;
+ done:
+    if (xs.xs_cb)
+        cbuf_free(xs.xs_cb);
+    return retval;
+}
@@ -49,6 +49,9 @@
 #include <stdint.h>
 #include <assert.h>
 #include <syslog.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -72,20 +75,25 @@
 #include "clixon_yang_module.h"
 #include "clixon_xml_vec.h"
 #include "clixon_xml_sort.h"
+#include "clixon_xml_index.h"
+#include "clixon_xml_order.h"
+#include "clixon_xml_key.h"
 
-/*! Get xml body value as cligen variable
- * @param[in]  x   XML node (body and leaf/leaf-list)
- * @param[out] cvp Pointer to cligen variable containing value of x body
- * @retval     0   OK, cvp contains cv or NULL
- * @retval    -1   Error
- * @note only applicable if x is body and has yang-spec and is leaf or leaf-list
- * Move to clixon_xml.c?
- * As a side-effect sets the cache.
- * Clear cache with xml_cv_set(x, NULL)
+/*! Parse xml body value as cligen variable of the yang type of the node
+ *
+ * @param[in]  x       XML node (leaf/leaf-list with yang spec)
+ * @param[in]  native  Only parse types kept as typed values, see xml_cv_native
+ * @param[out] cvp     Typed value, or NULL if native and not such a type. Free with cv_free
+ * @param[out] reason  If invalid value, malloced reason (if not NULL)
+ * @retval     1       OK, cvp set
+ * @retval     0       Invalid value, see reason
+ * @retval    -1       Error
  */
-static int
-xml_cv_cache(cxobj   *x,
-             cg_var **cvp)
+int
+xml_cv_parse(cxobj   *x,
+             int      native,
+             cg_var **cvp,
+             char   **reason)
 {
     int          retval = -1;
     cg_var      *cv = NULL;
@@ -93,20 +101,17 @@ xml_cv_cache(cxobj   *x,
     yang_stmt   *yrestype;
     enum cv_type cvtype;
     int          ret;
-    char        *reason=NULL;
-    int          options = 0;
     uint8_t      fraction = 0;
     char        *body;
-                 
+
+    *cvp = NULL;
     if ((body = xml_body(x)) == NULL)
         body="";
-    if ((cv = xml_cv(x)) != NULL)
-        goto ok;
     if ((y = xml_spec(x)) == NULL){
         clicon_err(OE_XML, EFAULT, "Yang binding missing for xml symbol %s, body:%s", xml_name(x), body);
         goto done;
     }
-    if (yang_type_get(y, NULL, &yrestype, &options, NULL, NULL, NULL, &fraction) < 0)
+    if (yang_type_get(y, NULL, &yrestype, NULL, NULL, NULL, NULL, &fraction) < 0)
         goto done;
     yang2cv_type(yang_argument_get(yrestype), &cvtype);
     if (cvtype==CGV_ERR){
@@ -114,17 +119,56 @@ xml_cv_cache(cxobj   *x,
                    yang_argument_get(yrestype));
         goto done;
     }
+    if (native && !xml_cv_native(cvtype))
+        goto ok;
     if ((cv = cv_new(cvtype)) == NULL){
         clicon_err(OE_YANG, errno, "cv_new");
         goto done;
     }
     if (cvtype == CGV_DEC64)
         cv_dec64_n_set(cv, fraction);
-        
-    if ((ret = cv_parse1(body, cv, &reason)) < 0){
+    if ((ret = cv_parse1(body, cv, reason)) < 0){
         clicon_err(OE_YANG, errno, "cv_parse1");
         goto done;
     }
+    if (ret == 0)
+        goto fail;
+    *cvp = cv;
+    cv = NULL;
+ ok:
+    retval = 1;
+ done:
+    if (cv)
+        cv_free(cv);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get xml body value as cligen variable
+ *
+ * Typed values are bound when yang is bound, see xml_bind_value. Others are parsed here
+ * As a side-effect sets the cache. Clear cache with xml_cv_set(x, NULL)
+ * @param[in]  x   XML node (body and leaf/leaf-list)
+ * @param[out] cvp Pointer to cligen variable containing value of x body
+ * @retval     0   OK, cvp contains cv or NULL
+ * @retval    -1   Error
+ * @note only applicable if x is body and has yang-spec and is leaf or leaf-list
+ */
+int
+xml_cv_cache(cxobj   *x,
+             cg_var **cvp)
+{
+    int          retval = -1;
+    cg_var      *cv = NULL;
+    int          ret;
+    char        *reason=NULL;
+
+    if ((cv = xml_cv(x)) != NULL)
+        goto ok;
+    if ((ret = xml_cv_parse(x, 0, &cv, &reason)) < 0)
+        goto done;
     if (ret == 0){
         clicon_err(OE_YANG, EINVAL, "cv parse error: %s\n", reason);
         goto done;
@@ -143,20 +187,176 @@ xml_cv_cache(cxobj   *x,
     return retval;
 }
 
-static int
+/*! Clear cached values of children, typed values are kept
+ *
+ * @param[in]  xt   XML parent node
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_cv_native
+ */
+int
 xml_cv_cache_clear(cxobj *xt)
 {
-    int    retval = -1;
-    cxobj *x = NULL;
+    int     retval = -1;
+    cxobj  *x = NULL;
+    cg_var *cv;
 
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL)
-        if (xml_cv_set(x, NULL) < 0)
+        if ((cv = xml_cv(x)) != NULL && !xml_cv_native(cv_type_get(cv)) &&
+            xml_cv_set(x, NULL) < 0)
             goto done;
     retval = 0;
  done:
     return retval;
 }
 
+/*! Compare two integer strings in canonical decimal form without parsing them
+ * @param[in]  s1     String 1
+ * @param[in]  s2     String 2
+ * @param[in]  neg    If set, allow negative numbers
+ * @param[out] equal  <0, 0 or >0 as the numeric values of s1 and s2 compare
+ * @retval     1      OK, both are canonical, see equal
+ * @retval     0      Not canonical, eg leading zeros, '+' or whitespace
+ * Canonical decimal integers (RFC 7950 9.2.2) compare as their signs, lengths and digits
+ */
+static int
+xml_cmp_intstr(char *s1,
+               char *s2,
+               int   neg,
+               int  *equal)
+{
+    char  *s[2] = {s1, s2};
+    int    sign[2];
+    size_t len[2];
+    int    i;
+    
+    for (i=0; i<2; i++){
+        sign[i] = 1;
+        if (neg && *s[i] == '-'){
+            sign[i] = -1;
+            s[i]++;
+        }
+        if (s[i][0] == '0'){ /* Only "0" itself may start with 0 */
+            if (s[i][1] != '\0' || sign[i] < 0)
+                return 0;
+            len[i] = 1;
+            continue;
+        }
+        len[i] = 0;
+        while (s[i][len[i]] >= '0' && s[i][len[i]] <= '9')
+            len[i]++;
+        if (len[i] == 0 || s[i][len[i]] != '\0')
+            return 0;
+    }
+    if (sign[0] != sign[1])
+        *equal = sign[0];
+    else if (len[0] != len[1])
+        *equal = len[0] < len[1] ? -sign[0] : sign[0];
+    else
+        *equal = sign[0]*memcmp(s[0], s[1], len[0]);
+    return 1;
+}
+
+/*! Compare list entries or leaf-list values using the precompiled key comparator of their yang
+ * @param[in]  yk     Key comparator, see ys_populate_keycmp
+ * @param[in]  x1     Object 1
+ * @param[in]  x2     Object 2
+ * @param[in]  skip1  Key matching skipped for keys not in x1 (see xml_cmp)
+ * @param[out] equal  If equal, <0 if x1 is less than x2, >0 if x1 is greater than x2
+ * @retval     0      OK
+ * @retval    -1      Error
+ * Same result as comparing the cligen values of the keys with cv_cmp, but strings and
+ * canonical integers are compared directly. Key leafs are looked for first in their
+ * position as defined by the key statement, since this is how they are encoded.
+ * If both entries have cached encoded keys, see xml_key_encode, these are compared instead.
+ */
+static int
+xml_cmp_keys(yang_keycmp *yk,
+             cxobj       *x1,
+             cxobj       *x2,
+             int          skip1,
+             int         *equal)
+{
+    int     retval = -1;
+    int     i;
+    char   *keyname;
+    cxobj  *x1b;
+    cxobj  *x2b;
+    char   *b1;
+    char   *b2;
+    cg_var *cv1 = NULL; 
+    cg_var *cv2 = NULL;
+#ifdef XML_KEY_ENCODE
+    struct xml_key_cache *kc1;
+    struct xml_key_cache *kc2;
+#endif
+
+    *equal = 0;
+#ifdef XML_KEY_ENCODE
+    if ((kc1 = xml_key_cache_get(x1)) != NULL && (kc2 = xml_key_cache_get(x2)) != NULL){
+        if ((*equal = memcmp(kc1->kc_data, kc2->kc_data,
+                             kc1->kc_len < kc2->kc_len ? kc1->kc_len : kc2->kc_len)) == 0)
+            *equal = kc1->kc_len < kc2->kc_len ? -1 : kc1->kc_len > kc2->kc_len;
+        return 0;
+    }
+#endif
+    for (i=0; i<yk->yk_len; i++){
+        if ((keyname = yk->yk_keys[i].yk_name) == NULL){ /* leaf-list */
+            x1b = x1;
+            x2b = x2;
+        }
+        else{
+            /* Interned names: pointer compare */
+            if ((x1b = xml_child_i(x1, i)) == NULL || xml_name(x1b) != keyname)
+                x1b = xml_find(x1, keyname);
+            if (skip1 && x1b == NULL)
+                continue;
+            if ((x2b = xml_child_i(x2, i)) == NULL || xml_name(x2b) != keyname)
+                x2b = xml_find(x2, keyname);
+            if (x1b == NULL && x2b == NULL)
+                continue;
+            else if (x1b == NULL){
+                *equal = -1;
+                break;
+            }
+            else if (x2b == NULL){
+                *equal = 1;
+                break;
+            }
+        }
+        b1 = xml_body(x1b);
+        b2 = xml_body(x2b);
+        if (b1 == NULL && b2 == NULL)
+            continue;
+        else if (b1 == NULL)
+            *equal = -1;
+        else if (b2 == NULL)
+            *equal = 1;
+        else switch (yk->yk_keys[i].yk_class){
+            case YK_STRING:
+                *equal = strcmp(b1, b2);
+                break;
+            case YK_INT:
+            case YK_UINT:
+                if (xml_cmp_intstr(b1, b2, yk->yk_keys[i].yk_class == YK_INT, equal) == 1)
+                    break;
+                /* fall through: not canonical */
+            default:
+                if (xml_cv_cache(x1b, &cv1) < 0) /* error case */
+                    goto done;
+                if (xml_cv_cache(x2b, &cv2) < 0) /* error case */
+                    goto done;
+                *equal = cv_cmp(cv1, cv2);
+                break;
+            }
+        if (*equal)
+            break;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Help function to qsort for sorting entries in xml child vector same parent
  * @param[in]  x1    object 1
  * @param[in]  x2    object 2
@@ -220,6 +420,7 @@ xml_cmp(cxobj  *x1,
     cxobj      *x2b;
     enum cxobj_type xt1;
     enum cxobj_type xt2;
+    yang_keycmp    *yk;
 
     if (x1==NULL || x2==NULL)
         goto done; /* shouldnt happen */
@@ -278,6 +479,12 @@ xml_cmp(cxobj  *x1,
             equal = nr1-nr2;
             goto done; /* Ordered by user or state data : maintain existing order */
         }
+    if (indexvar == NULL && (yk = yang_keycmp_get(y1)) != NULL){
+        /* List or leaf-list with precompiled key comparator
+         * XXX handle errors */
+        xml_cmp_keys(yk, x1, x2, skip1, &equal);
+        goto done;
+    }
     switch (yang_keyword_get(y1)){
     case Y_LEAF_LIST: /* Match with name and value */
         b1 = xml_body(x1);
@@ -416,9 +623,15 @@ xml_sort(cxobj *x)
     /* Abort sort if non-config (=state) data */
     if ((ys = xml_spec(x)) != 0 && yang_config(ys)==0)
         return 1;
+#endif
+#ifdef XML_ORDER_INDEX
+    /* Positions are changed */
+    if (xml_order_index_get(x) && xml_order_index_free(x) < 0)
+        return -1;
 #endif
     xml_enumerate_children(x); /* This is to make sorting "stable", ie not change existing order */
     qsort(xml_childvec_get(x), xml_child_nr(x), sizeof(cxobj *), xml_cmp_qsort);
+    xml_sorted_set(x);
     return 0;
 }
 
@@ -445,6 +658,8 @@ xml_sort_recurse(cxobj *xn)
         goto done;
     x = NULL;
     while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
+        if (xml_lazy(x) != NULL) /* Unparsed anydata */
+            continue;
         if (xml_sort_recurse(x) < 0)
             goto done;
     }
@@ -454,6 +669,299 @@ xml_sort_recurse(cxobj *xn)
     return retval;
 }
 
+#ifdef HAVE_LIBPTHREAD
+/*! Work shared by a pool of sort threads
+ * Tasks are either chunks of one child vector (sj_bounds set) or subtrees (sj_bounds NULL)
+ * Only the calling thread reports errors, see clicon_err_thread. A failing task in another
+ * thread is recorded in sj_failed and reported by the calling thread after the join.
+ */
+struct xml_sort_job {
+    pthread_mutex_t sj_mutex;
+    cxobj         **sj_vec;    /* Child vector chunks or subtree vector */
+    int            *sj_bounds; /* If set, task i is sj_vec[sj_bounds[i]..sj_bounds[i+1]-1] */
+    int             sj_len;    /* Number of tasks */
+    int             sj_next;   /* Next task to take */
+    int             sj_error;  /* Set if any task failed */
+    int             sj_failed; /* First task that failed in another thread, or -1 */
+    int             sj_reported; /* Set if a failed task was reported by calling thread */
+};
+
+/*! Sort thread: take tasks from the job until no more remain
+ * The calling thread also runs this, so all tasks are done even if no thread could be created
+ */
+static void *
+xml_sort_worker(void *arg)
+{
+    struct xml_sort_job *sj = (struct xml_sort_job *)arg;
+    int                  i;
+    int                  lo;
+    int                  hi;
+    
+    while (1){
+        pthread_mutex_lock(&sj->sj_mutex);
+        if (sj->sj_error)
+            i = sj->sj_len; /* Stop early */
+        else
+            i = sj->sj_next++;
+        pthread_mutex_unlock(&sj->sj_mutex);
+        if (i >= sj->sj_len)
+            break;
+        if (sj->sj_bounds){
+            lo = sj->sj_bounds[i];
+            hi = sj->sj_bounds[i+1];
+            qsort(&sj->sj_vec[lo], hi-lo, sizeof(cxobj *), xml_cmp_qsort);
+        }
+        else if (xml_sort_recurse(sj->sj_vec[i]) < 0){
+            pthread_mutex_lock(&sj->sj_mutex);
+            sj->sj_error = 1;
+            if (clicon_err_thread_owner())
+                sj->sj_reported = 1;
+            else if (sj->sj_failed < 0)
+                sj->sj_failed = i;
+            pthread_mutex_unlock(&sj->sj_mutex);
+        }
+    }
+    return NULL;
+}
+
+/*! Run all tasks of a sort job using at most nthreads threads, return when all are done
+ * @param[in]  sj        Sort job
+ * @param[in]  nthreads  Number of threads including the calling thread
+ * @retval     0         OK
+ * @retval    -1         Error in some task
+ */
+static int
+xml_sort_job_run(struct xml_sort_job *sj,
+                 int                  nthreads)
+{
+    int        retval = -1;
+    pthread_t *tids = NULL;
+    int        n = 0;
+    
+    if (nthreads > sj->sj_len)
+        nthreads = sj->sj_len;
+    if (nthreads > 1 &&
+        (tids = malloc((nthreads-1)*sizeof(pthread_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    sj->sj_failed = -1;
+    clicon_err_thread(1);
+    clixon_string_intern_lock(1);
+    /* Failing to create a thread is not an error: the remaining threads do the work */
+    for (n=0; n<nthreads-1; n++)
+        if (pthread_create(&tids[n], NULL, xml_sort_worker, sj) != 0)
+            break;
+    xml_sort_worker(sj);
+    while (n > 0)
+        pthread_join(tids[--n], NULL);
+    clixon_string_intern_lock(0);
+    clicon_err_thread(0);
+    if (sj->sj_error){
+        if (!sj->sj_reported)
+            clicon_err(OE_XML, 0, "Sort of subtree %d of %d failed in sort thread",
+                       sj->sj_failed, sj->sj_len);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (tids)
+        free(tids);
+    return retval;
+}
+
+/*! Sort children of a large XML node by sorting chunks in parallel and merging them
+ * Same result as xml_sort, the enumeration makes both the chunk sorts and the merge stable.
+ * @param[in] x         XML node
+ * @param[in] nthreads  Number of threads
+ * @retval    -1        Error
+ * @retval     0        OK
+ * @retval     1        OK, not sortable (state data)
+ * @see xml_sort
+ */
+static int
+xml_sort_parallel(cxobj *x,
+                  int    nthreads)
+{
+    int                 retval = -1;
+    struct xml_sort_job sj = {0,};
+    cxobj             **vec;
+    cxobj             **vtmp = NULL;
+    cxobj             **src;
+    cxobj             **dst;
+    cxobj             **v;
+    int                *bounds = NULL;
+    int                 len;
+    int                 nr;
+    int                 i;
+    int                 j;
+    int                 k;
+    int                 k1;
+    int                 k2;
+    int                 lo;
+    int                 mid;
+    int                 hi;
+    int                 ret;
+#ifndef STATE_ORDERED_BY_SYSTEM
+    yang_stmt          *ys;
+    
+    if ((ys = xml_spec(x)) != 0 && yang_config(ys)==0)
+        return 1;
+#endif
+#ifdef XML_ORDER_INDEX
+    if (xml_order_index_get(x) && xml_order_index_free(x) < 0)
+        goto done;
+#endif
+    xml_enumerate_children(x);
+    vec = xml_childvec_get(x);
+    len = xml_child_nr(x);
+    if ((vtmp = malloc(len*sizeof(cxobj *))) == NULL ||
+        (bounds = malloc((nthreads+1)*sizeof(int))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    for (i=0; i<=nthreads; i++)
+        bounds[i] = (int)(((int64_t)len*i)/nthreads);
+    pthread_mutex_init(&sj.sj_mutex, NULL);
+    sj.sj_vec = vec;
+    sj.sj_bounds = bounds;
+    sj.sj_len = nthreads;
+    ret = xml_sort_job_run(&sj, nthreads);
+    pthread_mutex_destroy(&sj.sj_mutex);
+    if (ret < 0)
+        goto done;
+    /* Merge pairs of sorted chunks until one remains, alternating between vec and vtmp */
+    src = vec;
+    dst = vtmp;
+    for (nr = nthreads; nr > 1; nr = j){
+        for (i=0, j=0; i<nr; i+=2, j++){
+            lo = bounds[i];
+            mid = bounds[i+1];
+            hi = (i+1 < nr) ? bounds[i+2] : mid;
+            k = k1 = lo;
+            k2 = mid;
+            while (k1 < mid && k2 < hi){
+                if (xml_cmp_qsort(&src[k2], &src[k1]) < 0)
+                    dst[k++] = src[k2++];
+                else
+                    dst[k++] = src[k1++];
+            }
+            while (k1 < mid)
+                dst[k++] = src[k1++];
+            while (k2 < hi)
+                dst[k++] = src[k2++];
+            bounds[j] = lo;
+        }
+        bounds[j] = len;
+        v = src; src = dst; dst = v;
+    }
+    if (src != vec)
+        memcpy(vec, src, len*sizeof(cxobj *));
+    xml_sorted_set(x);
+    retval = 0;
+ done:
+    if (vtmp)
+        free(vtmp);
+    if (bounds)
+        free(bounds);
+    return retval;
+}
+#endif /* HAVE_LIBPTHREAD */
+
+/*! Recursively sort a tree using a pool of threads
+ * The upper levels are sorted by the calling thread, breadth-first, until there are enough
+ * subtrees to share between the threads. These are then sorted by xml_sort_recurse in parallel.
+ * Large child vectors are sorted in chunks in parallel, see XML_SORT_PARALLEL_THRESHOLD.
+ * Same result as xml_sort_recurse.
+ * @param[in] xn        XML tree
+ * @param[in] nthreads  Number of threads, if 1 (or no thread support) same as xml_sort_recurse
+ * @retval    0         OK
+ * @retval   -1         Error
+ * @note The threads only access the tree by the sort functions, which is why the tree and its
+ *       yang spec may not be modified by others meanwhile
+ * @see CLICON_XML_SORT_THREADS
+ */
+int
+xml_sort_recurse_parallel(cxobj *xn,
+                          int    nthreads)
+{
+    int                 retval = -1;
+#ifdef HAVE_LIBPTHREAD
+    clixon_xvec        *xv0 = NULL;
+    clixon_xvec        *xv1 = NULL;
+    clixon_xvec        *xvt;
+    struct xml_sort_job sj = {0,};
+    cxobj             **vec = NULL;
+    int                 len;
+    int                 max;
+    cxobj              *x;
+    cxobj              *xc;
+    int                 i;
+    int                 ret;
+    
+    if (nthreads <= 1)
+        return xml_sort_recurse(xn);
+    if ((xv0 = clixon_xvec_new()) == NULL ||
+        (xv1 = clixon_xvec_new()) == NULL)
+        goto done;
+    if (clixon_xvec_append(xv0, xn) < 0)
+        goto done;
+    /* Sort level by level until there are enough subtrees for all threads */
+    while (clixon_xvec_len(xv0) > 0 &&
+           clixon_xvec_len(xv0) < XML_SORT_PARALLEL_FANOUT*nthreads){
+        for (i=0; i<clixon_xvec_len(xv0); i++){
+            x = clixon_xvec_i(xv0, i);
+            ret = xml_sort_verify(x, NULL);
+            if (ret == 1) /* This node is not sortable */
+                continue;
+            if (ret == -1){ /* not sorted */
+                if (xml_child_nr(x) >= XML_SORT_PARALLEL_THRESHOLD)
+                    ret = xml_sort_parallel(x, nthreads);
+                else
+                    ret = xml_sort(x);
+                if (ret < 0)
+                    goto done;
+                if (ret == 1) /* This node is not sortable */
+                    continue;
+            }
+            if (xml_cv_cache_clear(x) < 0)
+                goto done;
+            xc = NULL;
+            while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+                if (clixon_xvec_append(xv1, xc) < 0)
+                    goto done;
+        }
+        xvt = xv0; xv0 = xv1; xv1 = xvt;
+        clixon_xvec_free(xv1);
+        if ((xv1 = clixon_xvec_new()) == NULL)
+            goto done;
+    }
+    if (clixon_xvec_len(xv0) > 0){
+        if (clixon_xvec_extract(xv0, &vec, &len, &max) < 0)
+            goto done;
+        pthread_mutex_init(&sj.sj_mutex, NULL);
+        sj.sj_vec = vec;
+        sj.sj_len = len;
+        ret = xml_sort_job_run(&sj, nthreads);
+        pthread_mutex_destroy(&sj.sj_mutex);
+        if (ret < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    if (xv0)
+        clixon_xvec_free(xv0);
+    if (xv1)
+        clixon_xvec_free(xv1);
+    return retval;
+#else  /* HAVE_LIBPTHREAD */
+    retval = xml_sort_recurse(xn);
+    return retval;
+#endif /* HAVE_LIBPTHREAD */
+}
+
 /*! Special case search for ordered-by user or state data where linear sort is used
  *
  * @param[in]  xp    Parent XML node (go through its childre)
@@ -827,11 +1335,23 @@ xml_search_yang(cxobj       *xp,
     int    upper = xml_child_nr(xp);
     int    sorted = 1;
     int    yangi;
+#ifdef XML_KEY_INDEX
+    int    ret;
+#endif
     
     if (xp == NULL){
         clicon_err(OE_XML, EINVAL, "xp is NULL");
         goto done;
     }
+#ifdef XML_KEY_INDEX
+    /* Exact key match in large list using hash index */
+    if (indexvar == NULL){
+        if ((ret = xml_key_index_search(xp, x1, yc, xvec)) < 0)
+            goto done;
+        if (ret == 1)
+            goto ok;
+    }
+#endif
     upper = xml_child_nr(xp);
     /* Assume if there are any attributes, they are first in the list, mask
        them by raising low to skip them */
@@ -850,6 +1370,7 @@ xml_search_yang(cxobj       *xp,
         goto done;
     if (xml_search_binary(xp, x1, sorted, yangi, low, upper, skip1, indexvar, xvec) < 0)
         goto done;
+ ok:
     retval = 0;
  done:
     return retval;
@@ -887,6 +1408,20 @@ xml_insert_userorder(cxobj           *xp,
     int        i;
     cxobj     *xc;
     yang_stmt *yc;
+#ifdef XML_ORDER_INDEX
+    int        first;
+    int        nr;
+    int        ret;
+
+    if (ins == INS_FIRST || ins == INS_LAST){
+        if ((ret = xml_order_index_range(xp, yn, &first, &nr)) < 0)
+            goto done;
+        if (ret == 1){
+            retval = ins==INS_FIRST?first:first+nr;
+            goto done;
+        }
+    }
+#endif
 
     switch (ins){
     case INS_FIRST:
@@ -1111,6 +1646,103 @@ xml_insert(cxobj           *xp,
     return retval;
 }
 
+/*! Qsort function for new children in system order, no enumeration is used
+ */
+static int
+xml_cmp_qsort_bulk(const void* arg1, 
+                   const void* arg2)
+{
+    return xml_cmp(*(struct xml**)arg1, *(struct xml**)arg2, 0, 0, NULL);
+}
+
+/*! Insert several new children to xp in sorted place
+ *
+ * Equivalent to calling xml_insert(xp, x, INS_LAST, NULL, NULL) for each x in vec, but
+ * the children are sorted once and the child vector of xp is rebuilt once, instead of
+ * being shifted for each child. Use this when many children are added to a large parent.
+ * Children that are ordered-by user are appended last in their list in the order of vec
+ * with xml_insert.
+ * @param[in] xp    Parent xml node
+ * @param[in] vec   Children to insert, without parent and YANG bound. Reordered on return
+ * @param[in] len   Length of vec
+ * @retval    0     OK
+ * @retval   -1     Error
+ * @see xml_insert
+ */
+int
+xml_insert_bulk(cxobj  *xp,
+                cxobj **vec,
+                int     len)
+{
+    int        retval = -1;
+    int       *posv = NULL;
+    cxobj     *xa;
+    cxobj     *x;
+    yang_stmt *y;
+    int        low;
+    int        upper;
+    int        yi;
+    int        n = 0;
+    int        i;
+
+    for (i=0; i<len; i++){
+        x = vec[i];
+        if (xml_parent(x) != NULL){
+            clicon_err(OE_XML, 0, "XML node %s should not have parent", xml_name(x));
+            goto done;
+        }
+        if ((y = xml_spec(x)) == NULL){
+            clicon_err(OE_XML, 0, "No spec found %s", xml_name(x));
+            goto done;
+        }
+#ifndef STATE_ORDERED_BY_SYSTEM
+        if (yang_config_ancestor(y)==0){
+            if (xml_insert(xp, x, INS_LAST, NULL, NULL) < 0)
+                goto done;
+            continue;
+        }
+#endif
+        if ((yang_keyword_get(y) == Y_LIST || yang_keyword_get(y) == Y_LEAF_LIST) &&
+            yang_find(y, Y_ORDERED_BY, "user") != NULL){
+            if (xml_insert(xp, x, INS_LAST, NULL, NULL) < 0)
+                goto done;
+            continue;
+        }
+        vec[n++] = x; /* Compact system-ordered children first in vec */
+    }
+    if (n == 0)
+        goto ok;
+    qsort(vec, n, sizeof(cxobj *), xml_cmp_qsort_bulk);
+    if ((posv = calloc(n, sizeof(int))) == NULL){
+        clicon_err(OE_XML, errno, "calloc");
+        goto done;
+    }
+    upper = xml_child_nr(xp);
+    /* Skip attributes, see xml_insert */
+    for (low=0; low<upper; low++)
+        if ((xa = xml_child_i(xp, low)) == NULL || xml_type(xa)!=CX_ATTR)
+            break;
+    /* Positions are non-decreasing since vec is sorted: search from previous position */
+    for (i=0; i<n; i++){
+        y = xml_spec(vec[i]);
+        if ((yi = yang_order(y)) < -1)
+            goto done;
+        if ((low = xml_insert2(xp, vec[i], y, yi, 0, INS_LAST, NULL, NULL, low, upper)) < 0)
+            goto done;
+        posv[i] = low;
+    }
+    if (xml_child_insert_vec(xp, vec, posv, n) < 0)
+        goto done;
+    for (i=0; i<n; i++)
+        nscache_clear(vec[i]);
+ ok:
+    retval = 0;
+ done:
+    if (posv)
+        free(posv);
+    return retval;
+}
+
 /*! Verify all children of XML node are sorted according to xml_sort()
  * @param[in]   x    XML node. Check its children
  * @param[in]   arg  Dummy. Ensures xml_apply can be used with this fn
@@ -1144,6 +1776,7 @@ xml_sort_verify(cxobj *x0,
             }
             xprev = x;
         }
+        xml_sorted_set(x0);
     }
     retval = 0;
  done:
@@ -1351,12 +1984,27 @@ xml_find_index_yang(cxobj       *xp,
     char      *encstr;
     int        revert = 0;
     char      *indexvar = NULL;
+#ifdef XML_KEY_ENCODE
+    int        ret;
+#endif
 
     if (xp == NULL){
         clicon_err(OE_XML, EINVAL, "xp is NULL");
         goto done;
     }
     name = yang_argument_get(yc);
+#ifdef XML_KEY_ENCODE
+    /* All keys given: compare encoded keys without building a search entry */
+    if (cvk != NULL &&
+        (yang_keyword_get(yc) == Y_LIST || yang_keyword_get(yc) == Y_LEAF_LIST)){
+        if ((ret = xml_key_find(xp, yc, cvk, xvec)) < 0)
+            goto done;
+        if (ret == 1){
+            retval = 1;
+            goto done;
+        }
+    }
+#endif
     if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
@@ -1424,6 +2072,9 @@ xml_find_index_yang(cxobj       *xp,
         cprintf(cb, "<%s><%s>%s</%s></%s>", name, iname, encstr, iname, name);
         free(encstr);
         indexvar = iname;
+        /* Search vector is created on demand if entries were not bound to yang in place */
+        if (xml_search_index_build(xp, yc, iname) < 0)
+            goto done;
     }
 #else
     if (revert)
@@ -1557,9 +2208,10 @@ clixon_xml_find_index(cxobj        *xp,
     return retval;
 }
 
-/*! Find positional parameter in xml child list, eg x/y[42]. Note, not optimized
+/*! Find positional parameter in xml child list, eg x/y[42]
  *
- * Create a temporary search object: a list (xc) with a key (xk) and call the binary search.
+ * Positions in large ordered-by user lists are looked up with an order index, see
+ * XML_ORDER_INDEX, otherwise the child list is searched linearly.
  * @param[in]  xp     Parent xml node. 
  * @param[in]  yc     Yang spec of list child
  * @param[in]  pos    Position
@@ -1577,11 +2229,26 @@ clixon_xml_find_pos(cxobj        *xp,
     cxobj     *xc = NULL;
     char      *name;
     uint32_t   u;
+#ifdef XML_ORDER_INDEX
+    int        first;
+    int        nr;
+    int        ret;
+#endif
 
     if (yc == NULL){
         clicon_err(OE_YANG, ENOENT, "yang spec not found");
         goto done;
     }
+#ifdef XML_ORDER_INDEX
+    if ((ret = xml_order_index_range(xp, yc, &first, &nr)) < 0)
+        goto done;
+    if (ret == 1){
+        if (pos < (uint32_t)nr &&
+            clixon_xvec_append(xvec, xml_child_i(xp, first+pos)) < 0)
+            goto done;
+        goto ok;
+    }
+#endif
     name = yang_argument_get(yc);
     u = 0;
     xc = NULL;
@@ -1594,7 +2261,209 @@ clixon_xml_find_pos(cxobj        *xp,
             break;
         }
     }
+#ifdef XML_ORDER_INDEX
+ ok:
+#endif
     retval = 0;
  done:
     return retval;
 }
+
+/*! Get range of the entries of a list or leaf-list in the sorted child vector of a parent
+ *
+ * Children are sorted in yang order, the first and last entry are found with binary search
+ * Used for list pagination and for counting and indexing lists in XPath
+ * @param[in]  xp      Parent XML node
+ * @param[in]  yc      Yang list or leaf-list
+ * @param[out] firstp  Position of first entry in child vector of xp
+ * @param[out] nrp     Number of entries, may be 0
+ * @retval     1       OK, see firstp and nrp
+ * @retval     0       Children are not bound to yang, search the child vector
+ * @retval    -1       Error
+ * @see xpath_optimize_range
+ */
+int
+xml_list_range(cxobj     *xp,
+               yang_stmt *yc,
+               int       *firstp,
+               int       *nrp)
+{
+    cxobj     *xc;
+    yang_stmt *y;
+    int        yangi;
+    int        yi;
+    int        n;
+    int        low;
+    int        upper;
+    int        mid;
+    int        first;
+#ifdef XML_ORDER_INDEX
+    int        ret;
+
+    if ((ret = xml_order_index_range(xp, yc, firstp, nrp)) != 0)
+        return ret;
+#endif
+    if ((yangi = yang_order(yc)) < -1)
+        return -1;
+    n = xml_child_nr(xp);
+    /* Attributes are first in the list */
+    for (low=0; low<n; low++)
+        if ((xc = xml_child_i(xp, low)) == NULL || xml_type(xc) != CX_ATTR)
+            break;
+    /* First child with yang order not less than yc */
+    upper = n;
+    while (low < upper){
+        mid = (low + upper) / 2;
+        if ((y = xml_spec(xml_child_i(xp, mid))) == NULL)
+            return 0;
+        if ((yi = yang_order(y)) < -1)
+            return -1;
+        if (yi < yangi)
+            low = mid + 1;
+        else
+            upper = mid;
+    }
+    first = low;
+    /* First child with yang order larger than yc */
+    upper = n;
+    while (low < upper){
+        mid = (low + upper) / 2;
+        if ((y = xml_spec(xml_child_i(xp, mid))) == NULL)
+            return 0;
+        if ((yi = yang_order(y)) < -1)
+            return -1;
+        if (yi <= yangi)
+            low = mid + 1;
+        else
+            upper = mid;
+    }
+    *firstp = first;
+    *nrp = low - first;
+    return 1;
+}
+
+/*! Find a page of entries of a list or leaf-list, for list pagination
+ *
+ * The page starts after the entry given by a cursor, if any, skips offset entries and has
+ * at most limit entries. The first entry is found with binary search in the sorted child
+ * vector, or with the order index of a large ordered-by user list, so that the cost depends
+ * on the size of the page rather than on the size of the list.
+ * In an ordered-by system list, the cursor entry need not exist: the page starts with the
+ * first entry after it in key order.
+ * @param[in]  xp       Parent XML node, sorted
+ * @param[in]  yc       Yang list or leaf-list
+ * @param[in]  xcursor  Entry with keys (list) or value (leaf-list) that the page starts after, or NULL
+ * @param[in]  offset   Number of entries to skip
+ * @param[in]  limit    Max number of entries, 0 is unbounded
+ * @param[out] xvec     Entries of the page
+ * @retval     1        OK, see xvec
+ * @retval     0        Cursor entry of ordered-by user list not found
+ * @retval    -1        Error
+ * @see clixon_xml_find_pos
+ */
+int
+clixon_xml_find_page(cxobj       *xp,
+                     yang_stmt   *yc,
+                     cxobj       *xcursor,
+                     uint32_t     offset,
+                     uint32_t     limit,
+                     clixon_xvec *xvec)
+{
+    cxobj   *xc = NULL;
+    int      first;
+    int      nr;
+    int      low;
+    int      upper;
+    int      mid;
+    int      pos;
+    int      found;
+    uint32_t u;
+    int      ret;
+    int      cmp;
+#ifdef XML_KEY_ENCODE
+    char    *key = NULL;
+    size_t   len = 0;
+#endif
+
+    if (yc == NULL){
+        clicon_err(OE_YANG, ENOENT, "yang spec not found");
+        return -1;
+    }
+    if ((ret = xml_list_range(xp, yc, &first, &nr)) < 0)
+        return -1;
+    if (ret == 0){ /* Not bound, search the child vector */
+        found = (xcursor == NULL);
+        u = 0;
+        while ((xc = xml_child_each(xp, xc, CX_ELMNT)) != NULL) {
+            if (strcmp(yang_argument_get(yc), xml_name(xc)))
+                continue;
+            if (!found){
+                found = (xml_cmp(xcursor, xc, 0, 0, NULL) == 0);
+                continue;
+            }
+            if (u++ < offset)
+                continue;
+            if (limit && clixon_xvec_len(xvec) >= limit)
+                break;
+            if (clixon_xvec_append(xvec, xc) < 0)
+                return -1;
+        }
+        return found;
+    }
+    low = first;
+    upper = first + nr;
+    if (xcursor){
+        if (yang_find(yc, Y_ORDERED_BY, "user") == NULL){
+#ifdef XML_KEY_ENCODE
+            /* Cursor is encoded once, entries are compared with their encoded keys */
+            if ((ret = xml_key_encode(xcursor, &key, &len)) < 0)
+                return -1;
+            if (ret == 0)
+                key = NULL;
+#endif
+            /* First entry larger than cursor */
+            while (low < upper){
+                mid = (low + upper) / 2;
+#ifdef XML_KEY_ENCODE
+                ret = 0;
+                if (key && (ret = xml_key_cmp(key, len, xml_child_i(xp, mid), &cmp)) < 0)
+                    return -1;
+                if (ret == 0)
+#endif
+                    cmp = xml_cmp(xcursor, xml_child_i(xp, mid), 0, 0, NULL);
+                if (cmp >= 0)
+                    low = mid + 1;
+                else
+                    upper = mid;
+            }
+            upper = first + nr;
+        }
+        else {
+            if (match_base_child(xp, xcursor, yc, &xc) < 0)
+                return -1;
+            if (xc == NULL)
+                return 0;
+            pos = -1;
+#ifdef XML_ORDER_INDEX
+            if ((ret = xml_order_index_pos(xp, xc, &pos)) < 0)
+                return -1;
+            if (ret == 0)
+                pos = -1;
+#endif
+            if (pos < 0)
+                for (pos=first; pos<upper; pos++)
+                    if (xml_child_i(xp, pos) == xc)
+                        break;
+            low = pos + 1;
+        }
+    }
+    if (offset >= (uint32_t)(upper - low))
+        return 1;
+    low += offset;
+    if (limit && limit < (uint32_t)(upper - low))
+        upper = low + limit;
+    for (pos=low; pos<upper; pos++)
+        if (clixon_xvec_append(xvec, xml_child_i(xp, pos)) < 0)
+            return -1;
+    return 1;
+}
@@ -76,6 +76,7 @@
 #include <syslog.h>
 #include <fcntl.h>
 #include <math.h>  /* NaN */
+#include <pthread.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -109,6 +110,12 @@
  * Variables
  */
 
+/* XPath parsing and evaluation is serialized while several threads may use xpaths, the
+ * parser, the xpath cache and the optimizer patterns are shared. See xpath_lock */
+static pthread_mutex_t _xpath_mutex;
+static pthread_once_t  _xpath_once = PTHREAD_ONCE_INIT;
+static int             _xpath_locked = 0;
+
 /* Mapping between xpath_tree node name string <--> int  
  * @see xpath_tree_int2str
  */
@@ -526,6 +533,57 @@ xpath_tree_free(xpath_tree *xs)
     return 0;
 }
 
+/*! Initialize recursive xpath mutex, xpath functions may evaluate nested xpaths
+ */
+static void
+xpath_mutex_init(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&_xpath_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+/*! Serialize xpath parsing and evaluation while more than one thread may use xpaths
+ *
+ * Call from the main thread before creating threads that use xpath functions, and again with
+ * off after the threads are joined. Calls may be nested.
+ * @param[in]  on    1: serialize xpaths from now on, 0: undo a previous lock call
+ * @retval     0     OK
+ */
+int
+xpath_lock(int on)
+{
+    pthread_once(&_xpath_once, xpath_mutex_init);
+    if (on)
+        _xpath_locked++;
+    else if (_xpath_locked > 0)
+        _xpath_locked--;
+    return 0;
+}
+
+/*! Enter xpath function, lock if serialized
+ * @retval  1  Locked, call xpath_leave
+ * @retval  0  Not locked
+ */
+static int
+xpath_enter(void)
+{
+    if (_xpath_locked == 0)
+        return 0;
+    pthread_mutex_lock(&_xpath_mutex);
+    return 1;
+}
+
+static void
+xpath_leave(int locked)
+{
+    if (locked)
+        pthread_mutex_unlock(&_xpath_mutex);
+}
+
 /*! Given xpath, parse it, and return structured xpath tree 
  * @param[in]  xpath  String with XPATH 1.0 syntax
  * @param[out] xptree XPath-tree, parsed, structured XPATH, free:xpath_tree_free
@@ -548,8 +606,10 @@ xpath_parse(const char  *xpath,
     int               retval = -1;
     clixon_xpath_yacc xpy = {0,};
     cbuf             *cb = NULL;    
+    int               locked;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    locked = xpath_enter();
     if (xpath == NULL){
         clicon_err(OE_XML, EINVAL, "XPath is NULL");
         goto done;
@@ -588,6 +648,236 @@ xpath_parse(const char  *xpath,
         cbuf_free(cb);
     if (xpy.xpy_top)
         xpath_tree_free(xpy.xpy_top);
+    xpath_leave(locked);
+    return retval;
+}
+
+#ifdef XPATH_CACHE
+/*! Parsed xpath in the xpath cache
+ * The parse tree only depends on the xpath string, the namespace context is used at evaluation
+ */
+struct xpath_cache_entry{
+    qelem_t     xe_qelem;    /* LRU list, most recently used first */
+    xpath_tree *xe_tree;     /* Parsed xpath */
+    size_t      xe_size;     /* Memory of entry in bytes */
+    int         xe_refcnt;   /* Nr of ongoing evaluations using xe_tree */
+    int         xe_evicted;  /* Not in cache, free when no longer used */
+    char        xe_xpath[];  /* XPath string, also hash key */
+};
+typedef struct xpath_cache_entry xpath_cache_entry;
+
+static clicon_hash_t     *_xpath_cache_hash = NULL; /* xpath string -> entry */
+static xpath_cache_entry *_xpath_cache_lru = NULL;  /* Circular list, last is least recently used */
+static size_t             _xpath_cache_size = 0;    /* Memory of cached entries */
+static uint64_t           _xpath_cache_nr = 0;      /* Nr of cached entries */
+static uint64_t           _xpath_cache_hits = 0;
+static uint64_t           _xpath_cache_misses = 0;
+
+/*! Memory of an xpath parse tree in bytes
+ */
+static size_t
+xpath_tree_size(xpath_tree *xs)
+{
+    size_t sz = sizeof(*xs);
+
+    if (xs->xs_strnr)
+        sz += strlen(xs->xs_strnr) + 1;
+    if (xs->xs_s0)
+        sz += strlen(xs->xs_s0) + 1;
+    if (xs->xs_s1)
+        sz += strlen(xs->xs_s1) + 1;
+    if (xs->xs_c0)
+        sz += xpath_tree_size(xs->xs_c0);
+    if (xs->xs_c1)
+        sz += xpath_tree_size(xs->xs_c1);
+    return sz;
+}
+
+/*! Free xpath cache entry
+ */
+static int
+xpath_cache_entry_free(xpath_cache_entry *xe)
+{
+    if (xe->xe_tree)
+        xpath_tree_free(xe->xe_tree);
+    free(xe);
+    return 0;
+}
+
+/*! Remove entry from cache, free it unless it is in use
+ */
+static int
+xpath_cache_evict(xpath_cache_entry *xe)
+{
+    DELQ(xe, _xpath_cache_lru, xpath_cache_entry *);
+    clicon_hash_del(_xpath_cache_hash, xe->xe_xpath);
+    _xpath_cache_size -= xe->xe_size;
+    _xpath_cache_nr--;
+    xe->xe_evicted = 1;
+    if (xe->xe_refcnt == 0)
+        xpath_cache_entry_free(xe);
+    return 0;
+}
+
+/*! Get parsed xpath from cache, parse and add it if not found
+ *
+ * Least recently used entries are evicted when the cache exceeds XPATH_CACHE_SIZE bytes.
+ * @param[in]  xpath  String with XPATH 1.0 syntax
+ * @retval     xe     Cache entry with parsed xpath in xe_tree, release with xpath_cache_release
+ * @retval     NULL   Error
+ */
+static xpath_cache_entry *
+xpath_cache_get(const char *xpath)
+{
+    xpath_cache_entry *xe = NULL;
+    xpath_cache_entry *xe1;
+    void              *val;
+    size_t             len;
+
+    if (xpath == NULL){
+        clicon_err(OE_XML, EINVAL, "XPath is NULL");
+        goto done;
+    }
+    if (_xpath_cache_hash == NULL &&
+        (_xpath_cache_hash = clicon_hash_init()) == NULL)
+        goto done;
+    if ((val = clicon_hash_value(_xpath_cache_hash, xpath, NULL)) != NULL){
+        xe = *(xpath_cache_entry **)val;
+        _xpath_cache_hits++;
+        if (xe != _xpath_cache_lru){ /* Move first */
+            DELQ(xe, _xpath_cache_lru, xpath_cache_entry *);
+            INSQ(xe, _xpath_cache_lru);
+        }
+        xe->xe_refcnt++;
+        goto done;
+    }
+    _xpath_cache_misses++;
+    len = strlen(xpath);
+    if ((xe = malloc(sizeof(*xe) + len + 1)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(xe, 0, sizeof(*xe));
+    memcpy(xe->xe_xpath, xpath, len + 1);
+    if (xpath_parse(xpath, &xe->xe_tree) < 0){
+        xpath_cache_entry_free(xe);
+        xe = NULL;
+        goto done;
+    }
+    xe->xe_size = sizeof(*xe) + len + 1 + xpath_tree_size(xe->xe_tree);
+    xe->xe_refcnt = 1;
+    if (xe->xe_size > XPATH_CACHE_SIZE){ /* Too large, use it once */
+        xe->xe_evicted = 1;
+        goto done;
+    }
+    while (_xpath_cache_lru && _xpath_cache_size + xe->xe_size > XPATH_CACHE_SIZE){
+        xe1 = PREVQ(xpath_cache_entry *, _xpath_cache_lru);
+        xpath_cache_evict(xe1);
+    }
+    if (clicon_hash_add(_xpath_cache_hash, xpath, &xe, sizeof(xe)) == NULL){
+        xpath_cache_entry_free(xe);
+        xe = NULL;
+        goto done;
+    }
+    INSQ(xe, _xpath_cache_lru);
+    _xpath_cache_size += xe->xe_size;
+    _xpath_cache_nr++;
+ done:
+    return xe;
+}
+
+/*! Release cache entry after use
+ * @param[in]  xe  Cache entry returned by xpath_cache_get
+ */
+static int
+xpath_cache_release(xpath_cache_entry *xe)
+{
+    if (--xe->xe_refcnt == 0 && xe->xe_evicted)
+        xpath_cache_entry_free(xe);
+    return 0;
+}
+#endif /* XPATH_CACHE */
+
+/*! Get xpath cache statistics
+ *
+ * @param[out] nr      Number of cached xpaths
+ * @param[out] sz      Memory of cached xpaths in bytes
+ * @param[out] hits    Number of lookups of xpaths found in cache
+ * @param[out] misses  Number of lookups of xpaths not in cache, ie parsed
+ * @retval     0       OK
+ */
+int
+xpath_cache_stats(uint64_t *nr,
+                  size_t   *sz,
+                  uint64_t *hits,
+                  uint64_t *misses)
+{
+#ifdef XPATH_CACHE
+    int locked;
+
+    locked = xpath_enter();
+    *nr = _xpath_cache_nr;
+    *sz = _xpath_cache_size;
+    *hits = _xpath_cache_hits;
+    *misses = _xpath_cache_misses;
+    xpath_leave(locked);
+#else
+    *nr = 0;
+    *sz = 0;
+    *hits = 0;
+    *misses = 0;
+#endif
+    return 0;
+}
+
+/*! Free all cached xpaths
+ */
+void
+xpath_cache_exit(void)
+{
+#ifdef XPATH_CACHE
+    while (_xpath_cache_lru)
+        xpath_cache_evict(_xpath_cache_lru);
+    if (_xpath_cache_hash){
+        clicon_hash_free(_xpath_cache_hash);
+        _xpath_cache_hash = NULL;
+    }
+#endif
+}
+
+/*! Given XML tree and parsed xpath, eval it and return xpath context
+ *
+ * @param[in]  xcur   XML-tree where to search
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xptree Parsed XPATH
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[out] xrp    Return XPATH context
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+xpath_tree_ctx(cxobj      *xcur, 
+               cvec       *nsc,
+               xpath_tree *xptree,
+               int         localonly,
+               xp_ctx    **xrp)
+{
+    int    retval = -1;
+    xp_ctx xc = {0,};
+
+    xc.xc_type = XT_NODESET;
+    xc.xc_node = xcur;
+    xc.xc_initial = xcur;
+    if (cxvec_append(xcur, &xc.xc_nodeset, &xc.xc_size) < 0)
+        goto done;
+    if (xp_eval(&xc, xptree, nsc, localonly, xrp) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (xc.xc_nodeset){
+        free(xc.xc_nodeset);
+        xc.xc_nodeset = NULL;
+    }
     return retval;
 }
 
@@ -616,31 +906,168 @@ xpath_vec_ctx(cxobj      *xcur,
               int         localonly,
               xp_ctx    **xrp)
 {
-    int         retval = -1;
-    xpath_tree *xptree = NULL;
-    xp_ctx      xc = {0,};
+    int                retval = -1;
+    xpath_tree        *xptree = NULL;
+    int                locked;
+#ifdef XPATH_CACHE
+    xpath_cache_entry *xe = NULL;
+#endif
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
-    if (xpath_parse(xpath, &xptree) < 0)
+    locked = xpath_enter();
+#ifdef XPATH_CACHE
+    if ((xe = xpath_cache_get(xpath)) == NULL)
         goto done;
-    xc.xc_type = XT_NODESET;
-    xc.xc_node = xcur;
-    xc.xc_initial = xcur;
-    if (cxvec_append(xcur, &xc.xc_nodeset, &xc.xc_size) < 0)
+    xptree = xe->xe_tree;
+#else
+    if (xpath_parse(xpath, &xptree) < 0)
         goto done;
-    if (xp_eval(&xc, xptree, nsc, localonly, xrp) < 0)
+#endif
+    if (xpath_tree_ctx(xcur, nsc, xptree, localonly, xrp) < 0)
         goto done;
     retval = 0;
  done:
-    if (xc.xc_nodeset){
-        free(xc.xc_nodeset);
-        xc.xc_nodeset = NULL;
+#ifdef XPATH_CACHE
+    if (xe)
+        xpath_cache_release(xe);
+#else
+    if (xptree)
+        xpath_tree_free(xptree);
+#endif
+    xpath_leave(locked);
+    return retval;
+}
+
+/*! Given XML tree and xpath, call a function for each node in the result, internal function
+ *
+ * @param[in]  xcur   XML tree where to search
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPATH 1.0 syntax
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[in]  fn     Callback
+ * @param[in]  arg    Argument to callback
+ * @retval     1      OK, stopped by callback
+ * @retval     0      OK, all nodes traversed
+ * @retval    -1      Error
+ * @see xpath_foreach
+ */
+static int
+xpath_foreach1(cxobj              *xcur, 
+               cvec               *nsc,
+               const char         *xpath,
+               int                 localonly,
+               xpath_foreach_fn_t *fn,
+               void               *arg)
+{
+    int                retval = -1;
+    xpath_tree        *xptree = NULL;
+    xp_ctx            *xr = NULL;
+    int                i;
+    int                ret;
+    int                locked;
+#ifdef XPATH_CACHE
+    xpath_cache_entry *xe = NULL;
+#endif
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    locked = xpath_enter();
+#ifdef XPATH_CACHE
+    if ((xe = xpath_cache_get(xpath)) == NULL)
+        goto done;
+    xptree = xe->xe_tree;
+#else
+    if (xpath_parse(xpath, &xptree) < 0)
+        goto done;
+#endif
+    if ((ret = xp_eval_foreach(xcur, xptree, nsc, localonly, fn, arg)) < 0)
+        goto done;
+    if (ret > 0){
+        retval = ret - 1;
+        goto done;
     }
+    /* Not a simple location path: evaluate the full node-set */
+    if (xpath_tree_ctx(xcur, nsc, xptree, localonly, &xr) < 0)
+        goto done;
+    if (xr->xc_type == XT_NODESET)
+        for (i=0; i<xr->xc_size; i++){
+            if ((ret = fn(xr->xc_nodeset[i], arg)) < 0)
+                goto done;
+            if (ret > 0){
+                retval = 1;
+                goto done;
+            }
+        }
+    retval = 0;
+ done:
+    if (xr)
+        ctx_free(xr);
+#ifdef XPATH_CACHE
+    if (xe)
+        xpath_cache_release(xe);
+#else
     if (xptree)
         xpath_tree_free(xptree);
+#endif
+    xpath_leave(locked);
     return retval;
 }
 
+/*! Given XML tree and xpath, call a function for each node in the resulting nodeset
+ *
+ * Nodes are visited in document order. Simple location paths, eg //interface or
+ * /a/b[k='3'], are streamed to the callback without building the nodeset in memory.
+ * If the result is not a nodeset, the callback is not called.
+ * @param[in]  xcur   XML tree where to search
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPATH 1.0 syntax
+ * @param[in]  fn     Callback, return 1 to stop, -1 on error
+ * @param[in]  arg    Argument to callback
+ * @retval     1      OK, stopped by callback
+ * @retval     0      OK, all nodes traversed
+ * @retval    -1      Error
+ * @code
+ * static int
+ * mycb(cxobj *x, void *arg)
+ * {
+ *    ...
+ *    return 0; // continue
+ * }
+ *   if (xpath_foreach(xtop, nsc, "//interface", mycb, NULL) < 0)
+ *      err;
+ * @endcode
+ * @note Do not add or remove XML nodes in the callback
+ * @see xpath_vec  for a nodeset as a vector
+ */
+int
+xpath_foreach(cxobj              *xcur, 
+              cvec               *nsc,
+              const char         *xpath,
+              xpath_foreach_fn_t *fn,
+              void               *arg)
+{
+    return xpath_foreach1(xcur, nsc, xpath, 0, fn, arg);
+}
+
+/*! Callback for xpath_first: save first node and stop
+ */
+static int
+xpath_first_fn(cxobj *x,
+               void  *arg)
+{
+    *(cxobj **)arg = x;
+    return 1;
+}
+
+/*! Callback for xpath_count: count nodes
+ */
+static int
+xpath_count_fn(cxobj *x,
+               void  *arg)
+{
+    (*(uint32_t *)arg)++;
+    return 0;
+}
+
 /*! XPath nodeset function where only the first matching entry is returned
  *
  * @param[in]  xcur      XML tree where to search
@@ -672,7 +1099,6 @@ xpath_first(cxobj      *xcur,
     va_list    ap;
     size_t     len;
     char      *xpath = NULL;
-    xp_ctx    *xr = NULL;
     
     va_start(ap, xpformat);    
     len = vsnprintf(NULL, 0, xpformat, ap);
@@ -690,13 +1116,9 @@ xpath_first(cxobj      *xcur,
         goto done;
     }
     va_end(ap);
-    if (xpath_vec_ctx(xcur, nsc, xpath, 0, &xr) < 0)
-        goto done;
-    if (xr && xr->xc_type == XT_NODESET && xr->xc_size)
-        cx = xr->xc_nodeset[0];
+    if (xpath_foreach1(xcur, nsc, xpath, 0, xpath_first_fn, &cx) < 0)
+        cx = NULL;
  done:
-    if (xr)
-        ctx_free(xr);
     if (xpath)
         free(xpath);
     return cx;
@@ -731,7 +1153,6 @@ xpath_first_localonly(cxobj      *xcur,
     va_list    ap;
     size_t     len;
     char      *xpath = NULL;
-    xp_ctx    *xr = NULL;
     
     va_start(ap, xpformat);    
     len = vsnprintf(NULL, 0, xpformat, ap);
@@ -749,13 +1170,9 @@ xpath_first_localonly(cxobj      *xcur,
         goto done;
     }
     va_end(ap);
-    if (xpath_vec_ctx(xcur, NULL, xpath, 1, &xr) < 0)
-        goto done;
-    if (xr && xr->xc_type == XT_NODESET && xr->xc_size)
-        cx = xr->xc_nodeset[0];
+    if (xpath_foreach1(xcur, NULL, xpath, 1, xpath_first_fn, &cx) < 0)
+        cx = NULL;
  done:
-    if (xr)
-        ctx_free(xr);
     if (xpath)
         free(xpath);
     return cx;
@@ -959,6 +1376,38 @@ xpath_vec_bool(cxobj      *xcur,
     return retval;
 }
 
+/*! Given XML tree and parsed xpath, returns boolean
+ *
+ * Same as xpath_vec_bool but with an already parsed xpath, eg a yang "must" expression
+ * @param[in]  xcur     xml-tree where to search
+ * @param[in]  nsc      External XML namespace context, or NULL
+ * @param[in]  xptree   Parsed XPATH
+ * @retval     1        True
+ * @retval     0        False
+ * @retval    -1        Error
+ * @see yang_xpath_get
+ */
+int
+xpath_vec_bool_tree(cxobj      *xcur, 
+                    cvec       *nsc,
+                    xpath_tree *xptree)
+{
+    int     retval = -1;
+    xp_ctx *xr = NULL;
+    int     locked;
+
+    locked = xpath_enter();
+    if (xpath_tree_ctx(xcur, nsc, xptree, 0, &xr) < 0)
+        goto done;
+    if (xr)
+        retval = ctx2boolean(xr);
+ done:
+    if (xr)
+        ctx_free(xr);
+    xpath_leave(locked);
+    return retval;
+}
+
 /*! Translate an xpath/nsc pair to a "canonical" form using yang prefixes
  *
  * @param[in]  xs      Parsed xpath - xpath_tree
@@ -1170,28 +1619,10 @@ xpath_count(cxobj      *xcur,
             const char *xpath,
             uint32_t   *count)
 {
-    int     retval = -1;
-    xp_ctx *xc = NULL;
-    cbuf   *cb = NULL;
-
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    cprintf(cb, "count(%s)", xpath);
-    if (xpath_vec_ctx(xcur, nsc, cbuf_get(cb), 0, &xc) < 0)
-        goto done;
-    if (xc && xc->xc_type == XT_NUMBER && xc->xc_number != NAN)
-        *count = (uint32_t)xc->xc_number;
-    else
-        *count = 0;
-    retval = 0;
- done:
-    if (cb)
-        cbuf_free(cb);
-    if (xc)
-        ctx_free(xc);
-    return retval;
+    *count = 0;
+    if (xpath_foreach1(xcur, nsc, xpath, 0, xpath_count_fn, count) < 0)
+        return -1;
+    return 0;
 }
 
 /*! Given an XML node, build an xpath recursively to root, internal function
@@ -109,6 +109,21 @@ const map_str2int xpopmap[] = {
     {NULL,               -1}
 };
 
+/* Max number of steps in a location path evaluated by xp_eval_foreach */
+#define XP_FOREACH_STEPS 32
+
+/* State of xp_eval_foreach */
+struct xp_foreach {
+    xpath_tree         *xf_steps[XP_FOREACH_STEPS];
+    int                 xf_nsteps;
+    int                 xf_descendant; /* Index of step preceded by "//", or -1 */
+    cxobj              *xf_initial;    /* Initial context node, see current() */
+    cvec               *xf_nsc;
+    int                 xf_localonly;
+    xpath_foreach_fn_t *xf_fn;
+    void               *xf_arg;
+};
+
 /*! Eval an XPATH nodetest
  * @retval   -1     Error  XXX: retval -1 not properly handled 
  * @retval    0     No match  
@@ -136,7 +151,7 @@ nodetest_eval_node(cxobj      *x,
     prefix2 = xs->xs_s0;
     name2 = xs->xs_s1;
     /* Before going into namespaces, check name equality and filter out noteq  */
-    if (strcmp(name1, name2) != 0){
+    if (name1 != name2 && strcmp(name1, name2) != 0){
         retval = 0; /* no match */
         goto done;
     }
@@ -200,7 +215,7 @@ nodetest_eval_node_localonly(cxobj      *x,
     }
     name2 = xs->xs_s1;
     /* Before going into namespaces, check name equality and filter out noteq  */
-    if (strcmp(name1, name2) == 0){
+    if (name1 == name2 || strcmp(name1, name2) == 0){
         retval = 1;
         goto done;
     }
@@ -248,7 +263,9 @@ nodetest_eval(cxobj      *x,
     return retval;
 }
 
-/*!
+/*! Find all descendants of a node matching a nodetest
+ *
+ * Subtrees whose yang cannot contain the name of the nodetest are skipped, see XPATH_SCHEMA_PRUNE
  * @param[in]  xn
  * @param[in]  nodetest   XPATH stack
  * @param[in]  node_type
@@ -268,13 +285,21 @@ nodetest_recursive(cxobj      *xn,
                    cxobj    ***vec0,
                    int        *vec0len)
 {
-    int     retval = -1;
-    cxobj  *xsub; 
-    cxobj **vec = *vec0;
-    int     veclen = *vec0len;
+    int          retval = -1;
+    cxobj       *xsub; 
+    cxobj      **vec = *vec0;
+    int          veclen = *vec0len;
+    xml_child_it it;
+#ifdef XPATH_SCHEMA_PRUNE
+    char        *name = NULL;
+    yang_stmt   *ys;
+    int          ret;
 
-    xsub = NULL;
-    while ((xsub = xml_child_each(xn, xsub, node_type)) != NULL) {
+    if (nodetest->xs_type == XP_NODE && nodetest->xs_s1 && strcmp(nodetest->xs_s1, "*") != 0)
+        name = nodetest->xs_s1;
+#endif
+    xml_child_it_init(&it, xn, node_type);
+    while ((xsub = xml_child_it_next(&it)) != NULL) {
         if (nodetest_eval(xsub, nodetest, nsc, localonly) == 1){
             clicon_debug(CLIXON_DBG_DETAIL, "%s %x %x", __FUNCTION__, flags, xml_flag(xsub, flags));
             if (flags==0x0 || xml_flag(xsub, flags))
@@ -282,6 +307,15 @@ nodetest_recursive(cxobj      *xn,
                     goto done;
             //      continue; /* Dont go deeper */
         }
+#ifdef XPATH_SCHEMA_PRUNE
+        /* Skip subtree if its yang has no descendant with the name, unbound nodes are searched */
+        if (name && (ys = xml_spec(xsub)) != NULL){
+            if ((ret = yang_bloom_descendant(ys, name)) < 0)
+                goto done;
+            if (ret == 0)
+                continue;
+        }
+#endif
         if (nodetest_recursive(xsub, nodetest, node_type, flags, nsc, localonly, &vec, &veclen) < 0)
             goto done;
     }
@@ -292,6 +326,50 @@ nodetest_recursive(cxobj      *xn,
     return retval;
 }
 
+/*! Skip expressions without operators down to the inner expression
+ *
+ * @param[in]  xs   XPATH expression, eg a predicate or function argument
+ * @retval     xs   Inner expression, eg location path, number or function call
+ */
+static xpath_tree *
+xp_expr_inner(xpath_tree *xs)
+{
+    while (xs != NULL &&
+           (xs->xs_type == XP_EXP || xs->xs_type == XP_AND || xs->xs_type == XP_RELEX ||
+            xs->xs_type == XP_ADD || xs->xs_type == XP_UNION || xs->xs_type == XP_PATHEXPR ||
+            xs->xs_type == XP_FILTEREXPR || xs->xs_type == XP_PRI0) &&
+           xs->xs_int == A_NAN && xs->xs_c1 == NULL)
+        xs = xs->xs_c0;
+    return xs;
+}
+
+/*! Check if a step has a single predicate that is a number or last(), eg y[3] or y[last()]
+ *
+ * Such a step selects at most one node and can be indexed directly in a sorted list
+ * @param[in]  xs   XPATH step
+ * @param[out] xep  Predicate expression of type PRIME_NR or PRIME_FN
+ * @retval     1    Yes, see xep
+ * @retval     0    No
+ */
+static int
+xp_step_index(xpath_tree  *xs,
+              xpath_tree **xep)
+{
+    xpath_tree *xp = xs->xs_c1;
+    xpath_tree *xe;
+
+    if (xp == NULL || xp->xs_type != XP_PRED || xp->xs_c1 == NULL ||
+        xp->xs_c0 == NULL || xp->xs_c0->xs_c0 != NULL || xp->xs_c0->xs_c1 != NULL)
+        return 0;
+    if ((xe = xp_expr_inner(xp->xs_c1)) == NULL)
+        return 0;
+    if (xe->xs_type != XP_PRIME_NR &&
+        (xe->xs_type != XP_PRIME_FN || xe->xs_int != XPATHFN_LAST))
+        return 0;
+    *xep = xe;
+    return 1;
+}
+
 /*! Evaluate xpath step rule of an XML tree
  *
  * @param[in]  xc0  Incoming context
@@ -323,6 +401,11 @@ xp_eval_step(xp_ctx     *xc0,
     xpath_tree *nodetest = xs->xs_c0;
     xp_ctx     *xc = NULL;
     int         ret;
+    xml_child_it it;
+    xpath_tree *xe;
+    int         first;
+    int         nr;
+    int         indexed = 0; /* Predicate is evaluated by indexing a sorted list */
     
     /* Create new xc */
     if ((xc = ctx_dup(xc0)) == NULL)
@@ -343,14 +426,28 @@ xp_eval_step(xp_ctx     *xc0,
             }
             xc->xc_descendant = 0;
         }
+        else if (xc->xc_size == 1 && xp_step_index(xs, &xe) &&
+                 (ret = xpath_optimize_range(xs, xc->xc_nodeset[0], nsc, localonly, &first, &nr)) != 0){
+            if (ret < 0)
+                goto done;
+            /* Positions are counted from 0, see xp_eval_predicate */
+            if (xe->xs_type == XP_PRIME_NR)
+                i = (xe->xs_double >= 0 && xe->xs_double < nr) ? (int)xe->xs_double : -1;
+            else
+                i = nr - 1;
+            if (i >= 0 &&
+                cxvec_append(xml_child_i(xc->xc_nodeset[0], first+i), &vec, &veclen) < 0)
+                goto done;
+            indexed++;
+        }
         else{
             for (i=0; i<xc->xc_size; i++){ 
                 xv = xc->xc_nodeset[i];
-                x = NULL; 
                 if ((ret = xpath_optimize_check(xs, xv, &vec, &veclen)) < 0)
                     goto done;
                 if (ret == 0){/* regular code, no optimization made */
-                    while ((x = xml_child_each(xv, x, CX_ELMNT)) != NULL) {
+                    xml_child_it_init(&it, xv, CX_ELMNT);
+                    while ((x = xml_child_it_next(&it)) != NULL) {
                         /* xs->xs_c0 is nodetest */
                         if (nodetest == NULL ||
                             nodetest_eval(x, nodetest, nsc, localonly) == 1){
@@ -425,7 +522,7 @@ xp_eval_step(xp_ctx     *xc0,
         goto done;
         break;
     }
-    if (xs->xs_c1){
+    if (xs->xs_c1 && !indexed){
         if (xp_eval(xc, xs->xs_c1, nsc, localonly, xrp) < 0)
             goto done;
     }
@@ -516,6 +613,7 @@ xp_eval_predicate(xp_ctx     *xc,
             xcc->xc_initial = xc->xc_initial;
             xcc->xc_node = x;
             xcc->xc_position = i;
+            xcc->xc_ctxsize = xr0->xc_size;
             /* For each node in the node-set to be filtered, the PredicateExpr is
              * evaluated with that node as the context node */
             if (cxvec_append(x, &xcc->xc_nodeset, &xcc->xc_size) < 0)
@@ -676,76 +774,6 @@ xp_numop(xp_ctx    *xc1,
     return retval;
 }
 
-/*! Get xml body value as cligen variable
- * @param[in]  x   XML node (body and leaf/leaf-list)
- * @param[out] cvp Pointer to cligen variable containing value of x body
- * @retval     0   OK, cvp contains cv or NULL
- * @retval    -1   Error
- * @note only applicable if x is body and has yang-spec and is leaf or leaf-list
- * Move to clixon_xml.c?
- * As a side-effect sets the cache.
- * Clear cache with xml_cv_set(x, NULL)
- */
-static int
-xml_cv_cache(cxobj   *x,
-             cg_var **cvp)
-{
-    int          retval = -1;
-    cg_var      *cv = NULL;
-    yang_stmt   *y;
-    yang_stmt   *yrestype;
-    enum cv_type cvtype;
-    int          ret;
-    char        *reason=NULL;
-    int          options = 0;
-    uint8_t      fraction = 0;
-    char        *body;
-                 
-    if ((body = xml_body(x)) == NULL)
-        body="";
-    if ((cv = xml_cv(x)) != NULL)
-        goto ok;
-    if ((y = xml_spec(x)) == NULL){
-        clicon_err(OE_XML, EFAULT, "Yang binding missing for xml symbol %s, body:%s", xml_name(x), body);
-        goto done;
-    }
-    if (yang_type_get(y, NULL, &yrestype, &options, NULL, NULL, NULL, &fraction) < 0)
-        goto done;
-    yang2cv_type(yang_argument_get(yrestype), &cvtype);
-    if (cvtype==CGV_ERR){
-        clicon_err(OE_YANG, errno, "yang->cligen type %s mapping failed",
-                   yang_argument_get(yrestype));
-        goto done;
-    }
-    if ((cv = cv_new(cvtype)) == NULL){
-        clicon_err(OE_YANG, errno, "cv_new");
-        goto done;
-    }
-    if (cvtype == CGV_DEC64)
-        cv_dec64_n_set(cv, fraction);
-        
-    if ((ret = cv_parse1(body, cv, &reason)) < 0){
-        clicon_err(OE_YANG, errno, "cv_parse1");
-        goto done;
-    }
-    if (ret == 0){
-        clicon_err(OE_YANG, EINVAL, "cv parse error: %s\n", reason);
-        goto done;
-    }
-    if (xml_cv_set(x, cv) < 0)
-        goto done;
- ok:
-    *cvp = cv;
-    cv = NULL;
-    retval = 0;
- done:
-    if (reason)
-        free(reason);
-    if (cv)
-        cv_free(cv);
-    return retval;
-}
-
 /*! Given two XPATH contexts, eval relational operations: <>=
  * A RelationalExpr is evaluated by comparing the objects that result from 
  * evaluating the two operands.
@@ -1126,6 +1154,7 @@ xp_eval(xp_ctx     *xc,
     xp_ctx    *xr1 = NULL;
     xp_ctx    *xr2 = NULL;
     int        use_xr0 = 0; /* In 2nd child use transitively result of 1st child */
+    xml_child_it it;
     
     // ctx_print(stderr, xc, xpath_tree_int2str(xs->xs_type));
     /* Pre-actions before check first child c0
@@ -1195,6 +1224,11 @@ xp_eval(xp_ctx     *xc,
                     goto done;
                 goto ok;
                 break;
+            case XPATHFN_LAST:
+                if (xp_function_last(xc, xs->xs_c0, nsc, localonly, xrp) < 0)
+                    goto done;
+                goto ok;
+                break;
             case XPATHFN_COUNT:
                 if (xp_function_count(xc, xs->xs_c0, nsc, localonly, xrp) < 0)
                     goto done;
@@ -1278,8 +1312,8 @@ xp_eval(xp_ctx     *xc,
             memset(xr0, 0, sizeof(*xr0));
             xr0->xc_initial = xc->xc_initial;
             xr0->xc_type = XT_NODESET;
-            x = NULL;
-            while ((x = xml_child_each(xc->xc_node, x, CX_ELMNT)) != NULL) {
+            xml_child_it_init(&it, xc->xc_node, CX_ELMNT);
+            while ((x = xml_child_it_next(&it)) != NULL) {
                 if (cxvec_append(x, &xr0->xc_nodeset, &xr0->xc_size) < 0)
                     goto done;
             }
@@ -1385,4 +1419,495 @@ xp_eval(xp_ctx     *xc,
     return retval;
 } /* xp_eval */
 
+/*! Check if an xpath tree contains a call to a function
+ *
+ * @param[in]  xs   XPATH node tree
+ * @param[in]  fn   Function, eg XPATHFN_POSITION
+ * @retval     1    Yes
+ * @retval     0    No
+ */
+static int
+xp_tree_function(xpath_tree *xs,
+                 int         fn)
+{
+    if (xs == NULL)
+        return 0;
+    if (xs->xs_type == XP_PRIME_FN && xs->xs_int == fn)
+        return 1;
+    return xp_tree_function(xs->xs_c0, fn) || xp_tree_function(xs->xs_c1, fn);
+}
+
+/*! Check if a predicate expression may depend on the position of the node in the node-set
+ *
+ * This is the case if the expression evaluates to a number, eg [3] or [count(x)], or if it
+ * calls position() or last().
+ * @param[in]  xs   XPATH predicate expression
+ * @retval     1    Yes, or not known
+ * @retval     0    No, the predicate can be evaluated for each node by itself
+ * @see xp_eval_predicate
+ */
+static int
+xp_pred_positional(xpath_tree *xs)
+{
+    if (xp_tree_function(xs, XPATHFN_POSITION) ||
+        xp_tree_function(xs, XPATHFN_LAST))
+        return 1;
+    /* Skip expressions without operators */
+    while (xs != NULL){
+        switch (xs->xs_type){
+        case XP_EXP:
+        case XP_AND:
+        case XP_RELEX:
+        case XP_ADD:
+        case XP_UNION:
+            if (xs->xs_int != A_NAN || xs->xs_c1 != NULL) /* Only arithmetic is a number */
+                return xs->xs_type == XP_ADD;
+            xs = xs->xs_c0;
+            break;
+        case XP_PATHEXPR:
+            if (xs->xs_c1 != NULL)
+                return 0;
+            xs = xs->xs_c0;
+            break;
+        case XP_FILTEREXPR:
+        case XP_PRI0:
+            xs = xs->xs_c0;
+            break;
+        case XP_LOCPATH:
+        case XP_PRIME_STR:
+            return 0;
+        case XP_PRIME_FN:
+            switch (xs->xs_int){
+            case XPATHFN_CURRENT:
+            case XPATHFN_DEREF:
+            case XPATHFN_DERIVED_FROM:
+            case XPATHFN_DERIVED_FROM_OR_SELF:
+            case XPATHFN_BIT_IS_SET:
+            case XPATHFN_CONTAINS:
+            case XPATHFN_BOOLEAN:
+            case XPATHFN_NOT:
+            case XPATHFN_TRUE:
+            case XPATHFN_FALSE:
+                return 0;
+            default:
+                return 1;
+            }
+            break;
+        default:
+            return 1;
+        }
+    }
+    return 1;
+}
+
+/*! Check if a step has any predicate that may depend on node position
+ *
+ * @param[in]  xs   XPATH step
+ * @retval     1    Yes
+ * @retval     0    No
+ */
+static int
+xp_step_positional(xpath_tree *xs)
+{
+    xpath_tree *xp;
+
+    for (xp = xs->xs_c1; xp != NULL; xp = xp->xs_c0){
+        if (xp->xs_type != XP_PRED)
+            return 1;
+        if (xp->xs_c1 && xp_pred_positional(xp->xs_c1))
+            return 1;
+    }
+    return 0;
+}
+
+/*! Check if a step has no predicates
+ *
+ * @param[in]  xs   XPATH step
+ * @retval     1    No predicates
+ * @retval     0    Predicates
+ */
+static int
+xp_step_nopred(xpath_tree *xs)
+{
+    return xs->xs_c1 == NULL ||
+        (xs->xs_c1->xs_c0 == NULL && xs->xs_c1->xs_c1 == NULL);
+}
+
+/*! Collect the steps of a relative location path in order
+ *
+ * @param[in]  xf   Foreach state
+ * @param[in]  xs   XPATH relative location path
+ * @retval     1    OK
+ * @retval     0    Not a simple path
+ */
+static int
+xp_foreach_steps(struct xp_foreach *xf,
+                 xpath_tree        *xs)
+{
+    xpath_tree *xstep;
+
+    if (xs == NULL || xs->xs_type != XP_RELLOCPATH)
+        return 0;
+    if (xs->xs_c1 == NULL)
+        xstep = xs->xs_c0;
+    else {
+        if (xp_foreach_steps(xf, xs->xs_c0) == 0)
+            return 0;
+        xstep = xs->xs_c1;
+        if (xs->xs_int == A_DESCENDANT_OR_SELF){
+            if (xf->xf_descendant != -1)
+                return 0;
+            xf->xf_descendant = xf->xf_nsteps;
+        }
+    }
+    if (xstep == NULL || xstep->xs_type != XP_STEP || xf->xf_nsteps == XP_FOREACH_STEPS)
+        return 0;
+    xf->xf_steps[xf->xf_nsteps++] = xstep;
+    return 1;
+}
+
+static int xp_foreach_step(struct xp_foreach *xf, cxobj *xv, int i);
+
+/*! Evaluate the predicates of a step for a single node and continue with the next step
+ *
+ * @param[in]  xf   Foreach state
+ * @param[in]  x    XML node matching the nodetest of step i
+ * @param[in]  i    Step index
+ * @retval     1    OK, stopped by callback
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xp_foreach_pred(struct xp_foreach *xf,
+                cxobj             *x,
+                int                i)
+{
+    int         retval = -1;
+    xpath_tree *xs = xf->xf_steps[i];
+    xp_ctx      xc = {0,};
+    xp_ctx     *xr = NULL;
+
+    if (xp_step_nopred(xs))
+        return xp_foreach_step(xf, x, i+1);
+    xc.xc_type = XT_NODESET;
+    xc.xc_node = x;
+    xc.xc_initial = xf->xf_initial;
+    if (cxvec_append(x, &xc.xc_nodeset, &xc.xc_size) < 0)
+        goto done;
+    if (xp_eval_predicate(&xc, xs->xs_c1, xf->xf_nsc, xf->xf_localonly, &xr) < 0)
+        goto done;
+    if (xr->xc_type == XT_NODESET && xr->xc_size)
+        retval = xp_foreach_step(xf, x, i+1);
+    else
+        retval = 0;
+ done:
+    if (xc.xc_nodeset)
+        free(xc.xc_nodeset);
+    if (xr)
+        ctx_free(xr);
+    return retval;
+}
+
+/*! Evaluate a step preceded by "//" on all descendants of a node in document order
+ *
+ * @param[in]  xf   Foreach state
+ * @param[in]  xv   XML context node
+ * @param[in]  i    Step index
+ * @retval     1    OK, stopped by callback
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see nodetest_recursive
+ */
+static int
+xp_foreach_descendant(struct xp_foreach *xf,
+                      cxobj             *xv,
+                      int                i)
+{
+    int          ret;
+    xpath_tree  *nodetest = xf->xf_steps[i]->xs_c0;
+    cxobj       *x;
+    xml_child_it it;
+
+    xml_child_it_init(&it, xv, CX_ELMNT);
+    while ((x = xml_child_it_next(&it)) != NULL) {
+        if (nodetest == NULL ||
+            nodetest_eval(x, nodetest, xf->xf_nsc, xf->xf_localonly) == 1){
+            if ((ret = xp_foreach_pred(xf, x, i)) != 0)
+                return ret;
+        }
+        if ((ret = xp_foreach_descendant(xf, x, i)) != 0)
+            return ret;
+    }
+    return 0;
+}
+
+/*! Evaluate step i for a context node and continue with the next step for each result
+ *
+ * When all steps are evaluated, call the callback
+ * @param[in]  xf   Foreach state
+ * @param[in]  xv   XML context node
+ * @param[in]  i    Step index
+ * @retval     1    OK, stopped by callback
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xp_foreach_step(struct xp_foreach *xf,
+                cxobj             *xv,
+                int                i)
+{
+    int          retval = -1;
+    xpath_tree  *xs;
+    xp_ctx       xc = {0,};
+    xp_ctx      *xr = NULL;
+    cxobj       *x;
+    int          j;
+    int          ret;
+    xml_child_it it;
+
+    if (i == xf->xf_nsteps){
+        if ((ret = xf->xf_fn(xv, xf->xf_arg)) < 0)
+            goto done;
+        retval = ret > 0;
+        goto done;
+    }
+    xs = xf->xf_steps[i];
+    if (i == xf->xf_descendant){
+        retval = xp_foreach_descendant(xf, xv, i);
+        goto done;
+    }
+    if (xs->xs_int == A_CHILD && xp_step_nopred(xs)){
+        xml_child_it_init(&it, xv, CX_ELMNT);
+        while ((x = xml_child_it_next(&it)) != NULL) {
+            if (xs->xs_c0 == NULL ||
+                nodetest_eval(x, xs->xs_c0, xf->xf_nsc, xf->xf_localonly) == 1){
+                if ((ret = xp_foreach_step(xf, x, i+1)) != 0){
+                    retval = ret;
+                    goto done;
+                }
+            }
+        }
+    }
+    else { /* Regular step evaluation, including list optimization */
+        xc.xc_type = XT_NODESET;
+        xc.xc_node = xv;
+        xc.xc_initial = xf->xf_initial;
+        if (cxvec_append(xv, &xc.xc_nodeset, &xc.xc_size) < 0)
+            goto done;
+        if (xp_eval_step(&xc, xs, xf->xf_nsc, xf->xf_localonly, &xr) < 0)
+            goto done;
+        if (xr->xc_type == XT_NODESET)
+            for (j=0; j<xr->xc_size; j++)
+                if ((ret = xp_foreach_step(xf, xr->xc_nodeset[j], i+1)) != 0){
+                    retval = ret;
+                    goto done;
+                }
+    }
+    retval = 0;
+ done:
+    if (xc.xc_nodeset)
+        free(xc.xc_nodeset);
+    if (xr)
+        ctx_free(xr);
+    return retval;
+}
 
+/*! Evaluate a location path on an XML tree and call a function for each resulting node
+ *
+ * The nodes are streamed to the callback in document order without building the node-set.
+ * This is made for simple location paths of child and self steps, optionally with "//" before
+ * the last step, eg //interface, /a/b[k='3']/c or a//b[c='x'].
+ * Predicates may only depend on node position in the first step.
+ * @param[in]  xcur  XML tree where to search
+ * @param[in]  xs    XPATH node tree
+ * @param[in]  nsc   XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[in]  fn    Callback, return 1 to stop
+ * @param[in]  arg   Argument to callback
+ * @retval     2     OK, stopped by callback
+ * @retval     1     OK, all nodes traversed
+ * @retval     0     Not a simple location path, use xp_eval
+ * @retval    -1     Error
+ * @see xpath_foreach
+ */
+int
+xp_eval_foreach(cxobj              *xcur,
+                xpath_tree         *xs,
+                cvec               *nsc,
+                int                 localonly,
+                xpath_foreach_fn_t *fn,
+                void               *arg)
+{
+    int               retval = -1;
+    struct xp_foreach xf = {{0,},};
+    cxobj            *x;
+    xpath_tree       *xstep;
+    int               i;
+    int               ret;
+
+    /* Skip expressions without operators down to the location path */
+    while (xs != NULL &&
+           (xs->xs_type == XP_EXP || xs->xs_type == XP_AND || xs->xs_type == XP_RELEX ||
+            xs->xs_type == XP_ADD || xs->xs_type == XP_UNION || xs->xs_type == XP_PATHEXPR) &&
+           xs->xs_int == A_NAN && xs->xs_c1 == NULL)
+        xs = xs->xs_c0;
+    if (xs == NULL || xs->xs_type != XP_LOCPATH || (xs = xs->xs_c0) == NULL)
+        goto fail;
+    xf.xf_descendant = -1;
+    x = xcur;
+    if (xs->xs_type == XP_ABSPATH){
+#ifdef XML_PARENT_CANDIDATE
+        while (xml_parent(x) != NULL || xml_parent_candidate(x) != NULL)
+            x = xml_parent(x)?xml_parent(x):xml_parent_candidate(x);
+#else
+        while (xml_parent(x) != NULL)
+            x = xml_parent(x);
+#endif
+        if (xs->xs_int == A_DESCENDANT_OR_SELF)
+            xf.xf_descendant = 0;
+        xs = xs->xs_c0;
+    }
+    if (xp_foreach_steps(&xf, xs) == 0)
+        goto fail;
+    /* "//" only before last step, since otherwise results may be out of document order */
+    if (xf.xf_descendant != -1 && xf.xf_descendant != xf.xf_nsteps-1)
+        goto fail;
+    for (i=0; i<xf.xf_nsteps; i++){
+        xstep = xf.xf_steps[i];
+        if (xstep->xs_int != A_CHILD &&
+            (xstep->xs_int != A_SELF || i == xf.xf_descendant))
+            goto fail;
+        /* After the first step there may be several context nodes */
+        if ((i > 0 || i == xf.xf_descendant) && xp_step_positional(xstep))
+            goto fail;
+    }
+    xf.xf_initial = xcur;
+    xf.xf_nsc = nsc;
+    xf.xf_localonly = localonly;
+    xf.xf_fn = fn;
+    xf.xf_arg = arg;
+    if ((ret = xp_foreach_step(&xf, x, 0)) < 0)
+        goto done;
+    retval = ret?2:1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Count the nodes of a location path ending with a list or leaf-list without building a node-set
+ *
+ * The last step, eg interface in count(interface) or count(/if:interfaces/if:interface), is
+ * counted from the range of the list in the sorted child vector of each context node. Other
+ * steps are evaluated as usual.
+ * @param[in]  xc     Incoming context
+ * @param[in]  xs     XPATH node tree, argument of count()
+ * @param[in]  nsc    XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[out] countp Number of nodes
+ * @retval     1      OK, see countp
+ * @retval     0      Not a location path ending with a step without predicates, use xp_eval
+ * @retval    -1      Error
+ * @see xpath_optimize_range
+ */
+int
+xp_eval_count(xp_ctx     *xc,
+              xpath_tree *xs,
+              cvec       *nsc,
+              int         localonly,
+              int        *countp)
+{
+    int         retval = -1;
+    xpath_tree *xstep;
+    xp_ctx      xc0 = {0,};
+    xp_ctx     *xc1 = NULL;
+    xp_ctx     *xr = NULL;
+    xp_ctx     *xr1 = NULL;
+    xp_ctx     *xcp;
+    cxobj      *x;
+    int         first;
+    int         nr;
+    int         count = 0;
+    int         i;
+    int         ret;
+
+    if (xc->xc_type != XT_NODESET || xc->xc_descendant)
+        goto fail;
+    xs = xp_expr_inner(xs);
+    if (xs == NULL || xs->xs_type != XP_LOCPATH || (xs = xs->xs_c0) == NULL)
+        goto fail;
+    xcp = xc;
+    if (xs->xs_type == XP_ABSPATH){
+        if (xs->xs_int != A_ROOT || (xs = xs->xs_c0) == NULL)
+            goto fail;
+        x = xc->xc_node;
+#ifdef XML_PARENT_CANDIDATE
+        while (xml_parent(x) != NULL || xml_parent_candidate(x) != NULL)
+            x = xml_parent(x)?xml_parent(x):xml_parent_candidate(x);
+#else
+        while (xml_parent(x) != NULL)
+            x = xml_parent(x);
+#endif
+        xc0.xc_type = XT_NODESET;
+        xc0.xc_node = x;
+        xc0.xc_initial = xc->xc_initial;
+        if (cxvec_append(x, &xc0.xc_nodeset, &xc0.xc_size) < 0)
+            goto done;
+        xcp = &xc0;
+    }
+    if (xs->xs_type != XP_RELLOCPATH || xs->xs_int == A_DESCENDANT_OR_SELF)
+        goto fail;
+    xstep = xs->xs_c1 ? xs->xs_c1 : xs->xs_c0;
+    if (xstep == NULL || xstep->xs_type != XP_STEP || xstep->xs_int != A_CHILD ||
+        !xp_step_nopred(xstep))
+        goto fail;
+    /* Evaluate all steps but the last */
+    if (xs->xs_c1){
+        if (xp_eval(xcp, xs->xs_c0, nsc, localonly, &xr) < 0)
+            goto done;
+        if (xr->xc_type != XT_NODESET)
+            goto fail;
+        xcp = xr;
+    }
+    for (i=0; i<xcp->xc_size; i++){
+        x = xcp->xc_nodeset[i];
+        if ((ret = xpath_optimize_range(xstep, x, nsc, localonly, &first, &nr)) < 0)
+            goto done;
+        if (ret == 0){ /* Regular step evaluation for this node */
+            if ((xc1 = malloc(sizeof(*xc1))) == NULL){
+                clicon_err(OE_UNIX, errno, "malloc");
+                goto done;
+            }
+            memset(xc1, 0, sizeof(*xc1));
+            xc1->xc_type = XT_NODESET;
+            xc1->xc_node = x;
+            xc1->xc_initial = xc->xc_initial;
+            if (cxvec_append(x, &xc1->xc_nodeset, &xc1->xc_size) < 0)
+                goto done;
+            if (xp_eval_step(xc1, xstep, nsc, localonly, &xr1) < 0)
+                goto done;
+            nr = xr1->xc_size;
+            ctx_free(xc1);
+            xc1 = NULL;
+            ctx_free(xr1);
+            xr1 = NULL;
+        }
+        count += nr;
+    }
+    *countp = count;
+    retval = 1;
+ done:
+    if (xc0.xc_nodeset)
+        free(xc0.xc_nodeset);
+    if (xc1)
+        ctx_free(xc1);
+    if (xr)
+        ctx_free(xr);
+    if (xr1)
+        ctx_free(xr1);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
@@ -46,5 +46,8 @@ extern const map_str2int xpopmap[];
  * Prototypes
  */
 int xp_eval(xp_ctx *xc, xpath_tree *xs, cvec *nsc, int localonly, xp_ctx **xrp);
+int xp_eval_foreach(cxobj *xcur, xpath_tree *xs, cvec *nsc, int localonly,
+                    xpath_foreach_fn_t *fn, void *arg);
+int xp_eval_count(xp_ctx *xc, xpath_tree *xs, cvec *nsc, int localonly, int *countp);
 
 #endif /* _CLIXON_XPATH_EVAL_H */
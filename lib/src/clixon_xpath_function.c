@@ -66,12 +66,16 @@
 #include "clixon_yang_type.h"
 #include "clixon_xml.h"
 #include "clixon_xml_map.h"
+#include "clixon_xml_vec.h"
+#include "clixon_xml_sort.h"
+#include "clixon_path.h"
 #include "clixon_yang_module.h"
 #include "clixon_validate.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
 #include "clixon_xpath_eval.h"
 #include "clixon_xpath_function.h"
+#include "clixon_xpath_yang.h"
 
 /*! xpath function translation table
  * @see enum clixon_xpath_function
@@ -159,6 +163,110 @@ xp_function_current(xp_ctx            *xc0,
     return retval;
 }
 
+/*! Find the node that a leafref refers to
+ *
+ * The referred node is the first node in the node-set of the path with the same value as the
+ * leafref. If the path ends with a list and its first key, eg ../x/y/k, the list entry is
+ * looked up with the key index under each parent of the list, see clixon_xml_find_index.
+ * Otherwise the node-set of the path is searched for the value.
+ * @param[in]  xv    Leafref XML node
+ * @param[in]  ys    Yang spec of xv
+ * @param[in]  path  Path argument of leafref
+ * @param[out] xrefp Referred node, or NULL if not found
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+deref_leafref(cxobj     *xv,
+              yang_stmt *ys,
+              char      *path,
+              cxobj    **xrefp)
+{
+    int           retval = -1;
+    cvec         *nsc = NULL;
+    char         *body;
+    char         *b;
+    char         *p1;       /* Start of last step */
+    char         *p2;       /* Start of list step */
+    yang_stmt    *yref = NULL;
+    yang_stmt    *ylist = NULL;
+    cg_var       *cv;
+    char         *keyname = NULL;
+    cvec         *cvk = NULL;
+    clixon_xvec  *xvec = NULL;
+    cxobj       **vec = NULL;
+    size_t        veclen = 0;
+    int           i;
+
+    *xrefp = NULL;
+    if ((body = xml_body(xv)) == NULL)
+        goto ok;
+    if (yang_nsctx_get(ys, &nsc) < 0)
+        goto done;
+    /* Check if path is <prefix>/<list>/<key> with no predicates in the last two steps */
+    if ((p1 = strrchr(path, '/')) != NULL && p1 > path){
+        for (p2 = p1-1; p2 > path && *p2 != '/'; p2--);
+        if (p2 > path && *p2 == '/' && strpbrk(p2, "[(") == NULL){
+            if (yang_path_arg(ys, path, &yref) < 0)
+                goto done;
+            if (yref != NULL &&
+                (ylist = yang_parent_get(yref)) != NULL &&
+                yang_keyword_get(ylist) == Y_LIST &&
+                (cv = cvec_i(yang_cvec_get(ylist), 0)) != NULL &&
+                strcmp(cv_string_get(cv), yang_argument_get(yref)) == 0)
+                keyname = yang_argument_get(yref);
+        }
+    }
+    if (keyname != NULL){
+        /* Parents of the list */
+        if (xpath_vec(xv, nsc, "%.*s", &vec, &veclen, (int)(p2-path), path) < 0)
+            goto done;
+        if ((cvk = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if ((cv = cvec_add(cvk, CGV_STRING)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_add");
+            goto done;
+        }
+        if (cv_name_set(cv, keyname) == NULL ||
+            cv_string_set(cv, body) == NULL){
+            clicon_err(OE_UNIX, errno, "cv_string_set");
+            goto done;
+        }
+        if ((xvec = clixon_xvec_new()) == NULL)
+            goto done;
+        for (i=0; i<veclen; i++){
+            if (clixon_xml_find_index(vec[i], yang_parent_get(ylist), NULL,
+                                      yang_argument_get(ylist), cvk, xvec) < 0)
+                goto done;
+            if (clixon_xvec_len(xvec) > 0){
+                *xrefp = xml_find_type(clixon_xvec_i(xvec, 0), NULL, keyname, CX_ELMNT);
+                break;
+            }
+        }
+    }
+    else{
+        if (xpath_vec(xv, nsc, "%s", &vec, &veclen, path) < 0)
+            goto done;
+        for (i=0; i<veclen; i++)
+            if ((b = xml_body(vec[i])) != NULL && strcmp(b, body) == 0){
+                *xrefp = vec[i];
+                break;
+            }
+    }
+ ok:
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    if (cvk)
+        cvec_free(cvk);
+    if (xvec)
+        clixon_xvec_free(xvec);
+    return retval;
+}
+
 int
 xp_function_deref(xp_ctx            *xc0,
                   struct xpath_tree *xs,
@@ -177,6 +285,10 @@ xp_function_deref(xp_ctx            *xc0,
     yang_stmt  *yt;
     yang_stmt  *ypath;
     char       *path;
+    char       *body;
+    cxobj     **xivec = NULL;
+    int         xilen = 0;
+    int         ret;
     
     /* Create new xc */
     if ((xc = ctx_dup(xc0)) == NULL)
@@ -191,19 +303,42 @@ xp_function_deref(xp_ctx            *xc0,
         if (strcmp(yang_argument_get(yt), "leafref") == 0){
             if ((ypath = yang_find(yt, Y_PATH, NULL)) != NULL){
                 path = yang_argument_get(ypath);
-                if ((xref = xpath_first(xv, nsc, "%s", path)) != NULL)
+                if (deref_leafref(xv, ys, path, &xref) < 0)
+                    goto done;
+                if (xref != NULL)
                     if (cxvec_append(xref, &vec, &veclen) < 0)
                         goto done;
             }
-            ctx_nodeset_replace(xc, vec, veclen);
+        }
+        else if (strcmp(yang_argument_get(yt), "instance-identifier") == 0){
+            /* Search with list key indexes, see clixon_path_search */
+            if ((body = xml_body(xv)) == NULL)
+                continue;
+            if ((ret = clixon_xml_find_instance_id(xml_root(xv), ys_spec(ys),
+                                                   &xivec, &xilen, "%s", body)) < 0)
+                goto done;
+            if (ret == 1 && xilen > 0)
+                if (cxvec_append(xivec[0], &vec, &veclen) < 0)
+                    goto done;
+            if (xivec){
+                free(xivec);
+                xivec = NULL;
+            }
+            xilen = 0;
         }
         else if (strcmp(yang_argument_get(yt), "identityref") == 0){
         }
     }
+    ctx_nodeset_replace(xc, vec, veclen);
+    vec = NULL;
     *xrp = xc;
     xc = NULL;
     retval = 0;
  done:
+    if (vec)
+        free(vec);
+    if (xivec)
+        free(xivec);
     if (xc)
         ctx_free(xc);
     return retval;
@@ -227,7 +362,6 @@ derived_from_one(char  *baseidentity,
     yang_stmt *ytype;
     yang_stmt *ybaseid;
     yang_stmt *ymod;
-    cvec      *idrefvec; /* Derived identityref list: (module:id)**/
     char      *node = NULL;
     char      *prefix = NULL;
     char      *id = NULL;
@@ -255,8 +389,6 @@ derived_from_one(char  *baseidentity,
     /* Just get the object corresponding to the base identity */
     if ((ybaseid = yang_find_identity_nsc(ys_spec(yleaf), baseidentity, nsc)) == NULL)
         goto nomatch;
-    /* Get its list of derived identities  */
-    idrefvec = yang_cvec_get(ybaseid);
     /* Get and split the leaf id reference */
     if ((node = xml_body(xleaf)) == NULL) /* It may not be empty */
         goto nomatch;
@@ -283,7 +415,7 @@ derived_from_one(char  *baseidentity,
             goto done;
         }
         cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
-        if (cvec_find(idrefvec, cbuf_get(cb)) == NULL)
+        if (yang_identity_derived(ybaseid, cbuf_get(cb)) == 0)
             goto nomatch;
     }
     retval = 1;
@@ -485,9 +617,40 @@ xp_function_position(xp_ctx            *xc,
     return retval;
 }
 
+/*! The last function returns a number equal to the context size from the expression evaluation context.
+ *
+ * Signature: number last()
+ * Positions are counted from 0, see xp_function_position, so that eg y[last()] is the last y
+ */
+int
+xp_function_last(xp_ctx            *xc,
+                 struct xpath_tree *xs,
+                 cvec              *nsc,
+                 int                localonly,
+                 xp_ctx           **xrp)
+{
+    int         retval = -1;
+    xp_ctx     *xr = NULL;
+    
+    if ((xr = malloc(sizeof(*xr))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(xr, 0, sizeof(*xr));
+    xr->xc_initial = xc->xc_initial;
+    xr->xc_type = XT_NUMBER;
+    xr->xc_number = xc->xc_ctxsize - 1;
+    *xrp = xr;
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! The count function returns the number of nodes in the argument node-set.
  *
  * Signature: number count(node-set)
+ * The nodes of a list or leaf-list in sorted data are counted without building the node-set,
+ * see xp_eval_count
  */
 int
 xp_function_count(xp_ctx            *xc,
@@ -499,20 +662,27 @@ xp_function_count(xp_ctx            *xc,
     int         retval = -1;
     xp_ctx     *xr = NULL;
     xp_ctx     *xr0 = NULL;
+    int         count;
+    int         ret;
     
     if (xs == NULL || xs->xs_c0 == NULL){
         clicon_err(OE_XML, EINVAL, "count expects but did not get one argument");
         goto done;
     }
-    if (xp_eval(xc, xs->xs_c0, nsc, localonly, &xr0) < 0)       
+    if ((ret = xp_eval_count(xc, xs->xs_c0, nsc, localonly, &count)) < 0)
         goto done;
+    if (ret == 0){
+        if (xp_eval(xc, xs->xs_c0, nsc, localonly, &xr0) < 0)       
+            goto done;
+        count = xr0->xc_size;
+    }
     if ((xr = malloc(sizeof(*xr))) == NULL){
         clicon_err(OE_UNIX, errno, "malloc");
         goto done;
     }
     memset(xr, 0, sizeof(*xr));
     xr->xc_type = XT_NUMBER;
-    xr->xc_number = xr0->xc_size;
+    xr->xc_number = count;
     *xrp = xr;
     retval = 0;
  done:
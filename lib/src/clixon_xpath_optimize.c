@@ -63,6 +63,7 @@
 #include "clixon_handle.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
+#include "clixon_xml_nsctx.h"
 #include "clixon_xml_vec.h"
 #include "clixon_xml_sort.h"
 #include "clixon_xpath_ctx.h"
@@ -71,8 +72,10 @@
 
 #ifdef XPATH_LIST_OPTIMIZE
 static xpath_tree *_xmtop = NULL; /* pattern match tree top */
-static xpath_tree *_xm = NULL;
-static xpath_tree *_xe = NULL;
+static xpath_tree *_xltop = NULL; /* leaf-list pattern match tree top */
+static xpath_tree *_xm = NULL;    /* step pattern: _x[...] */
+static xpath_tree *_xr = NULL;    /* equality pattern: _y='_z' */
+static xpath_tree *_xrl = NULL;   /* leaf-list equality pattern: .='_z' */
 static int _optimize_enable = 1;
 static int _optimize_hits = 0;
 #endif /* XPATH_LIST_OPTIMIZE */
@@ -106,20 +109,24 @@ xpath_optimize_exit(void)
 #ifdef XPATH_LIST_OPTIMIZE
     if (_xmtop)
         xpath_tree_free(_xmtop);
+    if (_xltop)
+        xpath_tree_free(_xltop);
+    _xmtop = _xltop = NULL;
+    _xm = _xr = _xrl = NULL;
 #endif
 }
 
 #ifdef XPATH_LIST_OPTIMIZE
-/*! Initialize xpath module
+/*! Initialize xpath optimize patterns
  * XXX move to clixon_xpath.c 
  * @see loop_preds
  */
-int
-xpath_optimize_init(xpath_tree **xm,
-                    xpath_tree **xe)
+static int
+xpath_optimize_init(void)
 {
     int         retval = -1;
     xpath_tree *xs;
+    xpath_tree *xe;
     
     if (_xm == NULL){
         /* Initialize xpath-tree */
@@ -137,29 +144,92 @@ xpath_optimize_init(xpath_tree **xm,
             goto done;
         xs->xs_match++;
         /* get expression [_y=_z] */
-        if ((_xe = xpath_tree_traverse(xs, 1, -1)) == NULL)
+        if ((xe = xpath_tree_traverse(xs, 1, -1)) == NULL)
+            goto done;
+        /* get relational expression _y=_z, below "and" */
+        if ((_xr = xpath_tree_traverse(xe, 0, 0, -1)) == NULL)
             goto done;
         /* get keyname (_y) */
-        if ((xs = xpath_tree_traverse(_xe, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1)) == NULL)
+        if ((xs = xpath_tree_traverse(_xr, 0, 0, 0, 0, 0, 0, 0, 0, -1)) == NULL)
             goto done;
-        xs->xs_match++; /* in loop_preds get name in xs_s1 XXX: leaf-list is different */
+        xs->xs_match++; /* in loop_preds get name in xs_s1 */
         /* get keyval (_z) */
-        if ((xs = xpath_tree_traverse(_xe, 0, 0, 1, 0, 0, 0, 0, -1)) == NULL)
+        if ((xs = xpath_tree_traverse(_xr, 1, 0, 0, 0, 0, -1)) == NULL)
             goto done;
         xs->xs_match++; /* in loop_preds get value in xs_s0 or xs_strnr */
+        /* Leaf-list value: .=_z */
+        if (xpath_parse("_x[.='_z']", &_xltop) < 0) 
+            goto done;
+        if ((_xrl = xpath_tree_traverse(_xltop, 0, 0, 1, 1, 0, 0, -1)) == NULL)
+            goto done;
+        if ((xs = xpath_tree_traverse(_xrl, 1, 0, 0, 0, 0, -1)) == NULL)
+            goto done;
+        xs->xs_match++;
     }
-    *xm = _xm;
-    *xe = _xe;
     retval = 0;
  done:
     return retval;
 }
 
+/*! Match a relational expression with an equality pattern, add name and value to cvk
+ *
+ * @param[in]  xr    XPath tree of type RELEX
+ * @param[out] cvk   Vector of <name>:<value> pairs, name is "." for leaf-list value
+ * @retval    -1     Error
+ * @retval     0     No match
+ * @retval     1     Match
+ */
+static int
+loop_relex(xpath_tree *xr,
+           cvec       *cvk)
+{
+    int          retval = -1;
+    int          ret;
+    xpath_tree **vec = NULL;
+    size_t       veclen = 0;
+    xpath_tree  *xv;
+    cg_var      *cvi;
+    char        *name;
+
+    if ((ret = xpath_tree_eq(_xr, xr, &vec, &veclen)) < 0)
+        goto done;
+    if (ret == 1 && veclen == 2){
+        name = vec[0]->xs_s1;
+        xv = vec[1];
+    }
+    else {
+        veclen = 0;
+        if ((ret = xpath_tree_eq(_xrl, xr, &vec, &veclen)) < 0)
+            goto done;
+        if (ret == 0 || veclen != 1)
+            goto ok;
+        name = ".";
+        xv = vec[0];
+    }
+    if ((cvi = cvec_add(cvk, CGV_STRING)) == NULL){
+        clicon_err(OE_XML, errno, "cvec_add");      
+        goto done;
+    }
+    cv_name_set(cvi, name);
+    if (xv->xs_type == XP_PRIME_NR)
+        cv_string_set(cvi, xv->xs_strnr);
+    else
+        cv_string_set(cvi, xv->xs_s0);
+    retval = 1;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+ ok: /* no match, not special case */
+    retval = 0;
+    goto done;
+}
 
 /*! Recursive function to loop over all EXPR and pattern match them
  *
- * @param[in]  xt    XPath tree of type PRED
- * @param[in]  xepat Pattern matching XPath tree of type EXPR
+ * Each predicate is an equality or several equalities combined with "and", eg
+ * [k1='a'][k2='b'] or [k2='b' and k1='a']
+ * @param[in]  xt    XPath tree of type PRED or AND
  * @param[out] cvk   Vector of <keyname>:<keyval> pairs
  * @retval    -1     Error
  * @retval     0     No match
@@ -168,43 +238,57 @@ xpath_optimize_init(xpath_tree **xm,
  */
 static int
 loop_preds(xpath_tree *xt,
-           xpath_tree *xepat,
            cvec       *cvk)
 {
     int          retval = -1;
     int          ret;
     xpath_tree  *xe;
-    xpath_tree **vec = NULL;
-    size_t       veclen = 0;
-    cg_var      *cvi;
         
-    if (xt->xs_type == XP_PRED && xt->xs_c0){
-        if ((ret = loop_preds(xt->xs_c0, xepat, cvk)) < 0)
-            goto done;
-        if (ret == 0)
+    switch (xt->xs_type){
+    case XP_PRED:
+        if (xt->xs_c0){
+            if ((ret = loop_preds(xt->xs_c0, cvk)) < 0)
+                goto done;
+            if (ret == 0)
+                goto ok;
+        }
+        if ((xe = xt->xs_c1) == NULL)
+            break;
+        /* Not "or" */
+        if (xe->xs_type != XP_EXP || xe->xs_c0 == NULL || xe->xs_c1 != NULL)
             goto ok;
-    }
-    if ((xe = xt->xs_c1) && (xe->xs_type == XP_EXP)){
-        if ((ret = xpath_tree_eq(xepat, xe, &vec, &veclen)) < 0)
+        if ((ret = loop_preds(xe->xs_c0, cvk)) < 0)
             goto done;
         if (ret == 0)
             goto ok;
-        if (veclen != 2)
+        break;
+    case XP_AND:
+        if (xt->xs_c0 == NULL)
             goto ok;
-        if ((cvi = cvec_add(cvk, CGV_STRING)) == NULL){
-            clicon_err(OE_XML, errno, "cvec_add");      
-            goto done;
+        if (xt->xs_c1 == NULL){   /* Single relational expression */
+            if ((ret = loop_relex(xt->xs_c0, cvk)) < 0)
+                goto done;
+            if (ret == 0)
+                goto ok;
+        }
+        else {
+            if (xt->xs_int != XO_AND)
+                goto ok;
+            if ((ret = loop_preds(xt->xs_c0, cvk)) < 0)
+                goto done;
+            if (ret == 0)
+                goto ok;
+            if ((ret = loop_relex(xt->xs_c1, cvk)) < 0)
+                goto done;
+            if (ret == 0)
+                goto ok;
         }
-        cv_name_set(cvi, vec[0]->xs_s1);
-        if (vec[1]->xs_type == XP_PRIME_NR)
-            cv_string_set(cvi, vec[1]->xs_strnr);
-        else
-            cv_string_set(cvi, vec[1]->xs_s0);
+        break;
+    default:
+        goto ok;
     }
     retval = 1;
  done:
-    if (vec)
-        free(vec);
     return retval;
  ok: /* no match, not special case */
     retval = 0;
@@ -216,14 +300,20 @@ loop_preds(xpath_tree *xt,
  * @param[in]  xt     XPath tree
  * @param[in]  xv     XML base node
  * @param[out] xvec   Array of found nodes
- * @param[out] xlen   Len of xvec
- * @param[out] key
- * @param[out] keyval
  * @retval    -1      Error
  * @retval     0      No match - use non-optimized lookup
  * @retval     1      Match
  *  XPath:
- *  y[k=3] # corresponds to: <name>[<keyname>=<keyval>]
+ *  y[k=3]                 # corresponds to: <name>[<keyname>=<keyval>]
+ *  y[k2=4][k1=3]          # all keys in any order
+ *  y[k1=3 and k2=4]       # keys combined with "and"
+ *  y[i=5]                 # explicit search index, see XML_EXPLICIT_INDEX
+ *  ll[.='x']              # leaf-list value
+ * The predicates are evaluated again on the result, so the result may be a superset of the
+ * matching nodes, eg if other non-key equalities are also given.
+ * The predicates must only be equalities since eg a positional predicate would be evaluated
+ * in the wrong context.
+ * Applies to each step, so that chained lists such as a[k=1]/b[k=2] are optimized.
  */
 static int
 xpath_list_optimize_fn(xpath_tree  *xt,
@@ -231,20 +321,21 @@ xpath_list_optimize_fn(xpath_tree  *xt,
                        clixon_xvec *xvec)
 {
     int          retval = -1;
-    xpath_tree  *xm = NULL;
-    xpath_tree  *xem = NULL;
     char        *name;
     yang_stmt   *yp;
     yang_stmt   *yc;
     cvec        *cvv = NULL;
     xpath_tree **vec = NULL;
     size_t       veclen = 0;
-    xpath_tree  *xtp;
     int          ret;
-    cvec        *cvk = NULL; /* vector of index keys */
+    cvec        *cvk = NULL;  /* vector of all equalities */
+    cvec        *cvk1 = NULL; /* vector of index keys in key order */
     cg_var      *cvi;
-    int          i;
-    yang_stmt   *ypp;
+    cg_var      *cvj;
+    char        *keyname;
+#ifdef XML_EXPLICIT_INDEX
+    yang_stmt   *yi;
+#endif
     
     /* revert to non-optimized if no yang */
     if ((yp = xml_spec(xv)) == NULL)
@@ -252,20 +343,11 @@ xpath_list_optimize_fn(xpath_tree  *xt,
     /* or if not config data (state data should not be ordered) */
     if (yang_config_ancestor(yp) == 0)
         goto ok;
-    /* Check that there is no "outer" list. */
-    ypp = yp;
-    do {
-        if (yang_keyword_get(ypp) == Y_LIST)
-            goto ok;
-    } while((ypp = yang_parent_get(ypp)) != NULL);
-    /* Check yang and that only a list with key as index is a special case can do bin search 
-     * That is, ONLY check optimize cases of this type:_x[_y='_z']
-     * Should we extend this simple example and have more cases (all cases?)
-     */
-    xpath_optimize_init(&xm, &xem);
+    if (xpath_optimize_init() < 0)
+        goto done;
     /* Here is where pattern is checked for equality and where variable binding is made (if
      * equal) */
-    if ((ret = xpath_tree_eq(xm, xt, &vec, &veclen)) < 0)
+    if ((ret = xpath_tree_eq(_xm, xt, &vec, &veclen)) < 0)
         goto done;
     if (ret == 0)
         goto ok; /* no match */
@@ -273,35 +355,74 @@ xpath_list_optimize_fn(xpath_tree  *xt,
         goto ok;
     name = vec[0]->xs_s1;
     /* Extract variables */
-    if ((yc = yang_find(yp, Y_LIST, name)) == NULL)
-#ifdef NOTYET /* leaf-list is not detected by xpath optimize detection */
-        if ((yc = yang_find(yp, Y_LEAF_LIST, name)) == NULL) /* XXX */
-#endif
-            goto ok; 
-    /* Validate keys */
-    if ((cvv = yang_cvec_get(yc)) == NULL)
-        goto ok;
-    xtp = vec[1];
+    if ((yc = yang_find(yp, Y_LIST, name)) == NULL &&
+        (yc = yang_find(yp, Y_LEAF_LIST, name)) == NULL)
+        goto ok; 
     if ((cvk = cvec_new(0)) == NULL){
         clicon_err(OE_YANG, errno, "cvec_new"); 
         goto done;
     }
-    if ((ret = loop_preds(xtp, xem, cvk)) < 0)
+    if ((ret = loop_preds(vec[1], cvk)) < 0)
         goto done;
-    if (ret == 0)
+    if (ret == 0 || cvec_len(cvk) == 0)
         goto ok;
-
-    if (cvec_len(cvv) != cvec_len(cvk))
-        goto ok;
-    i = 0;
-    cvi = NULL;
-    while ((cvi = cvec_each(cvk, cvi)) != NULL) {
-        if (strcmp(cv_name_get(cvi), cv_string_get(cvec_i(cvv,i))))
+    if ((cvk1 = cvec_new(0)) == NULL){
+        clicon_err(OE_YANG, errno, "cvec_new"); 
+        goto done;
+    }
+    if (yang_keyword_get(yc) == Y_LEAF_LIST){
+        /* First leaf-list value */
+        cvi = NULL;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL)
+            if (strcmp(cv_name_get(cvi), ".") == 0)
+                break;
+        if (cvi == NULL)
             goto ok;
-        i++;
+        if (cvec_append_var(cvk1, cvi) == NULL){
+            clicon_err(OE_YANG, errno, "cvec_append_var"); 
+            goto done;
+        }
+        goto search;
     }
+    /* All keys, in key order. First equality is used if a key is given more than once */
+    if ((cvv = yang_cvec_get(yc)) != NULL){
+        cvj = NULL;
+        while ((cvj = cvec_each(cvv, cvj)) != NULL) {
+            keyname = cv_string_get(cvj);
+            cvi = NULL;
+            while ((cvi = cvec_each(cvk, cvi)) != NULL)
+                if (strcmp(cv_name_get(cvi), keyname) == 0)
+                    break;
+            if (cvi == NULL)
+                break;
+            if (cvec_append_var(cvk1, cvi) == NULL){
+                clicon_err(OE_YANG, errno, "cvec_append_var"); 
+                goto done;
+            }
+        }
+        if (cvj == NULL) /* All keys found */
+            goto search;
+        cvec_reset(cvk1);
+    }
+#ifdef XML_EXPLICIT_INDEX
+    /* Equality on an explicit search index variable, eg y[i='3'] */
+    cvi = NULL;
+    while ((cvi = cvec_each(cvk, cvi)) != NULL) 
+        if ((yi = yang_find_datanode(yc, cv_name_get(cvi))) != NULL &&
+            yang_flag_get(yi, YANG_FLAG_INDEX) != 0)
+            break;
+    if (cvi != NULL){
+        if (cvec_append_var(cvk1, cvi) == NULL){
+            clicon_err(OE_YANG, errno, "cvec_append_var"); 
+            goto done;
+        }
+        goto search;
+    }
+#endif
+    goto ok;
+ search:
     /* Use 2a form since yc allready given to compute cvk */
-    if (clixon_xml_find_index(xv, yp, NULL, name, cvk, xvec) < 0)
+    if (clixon_xml_find_index(xv, yp, NULL, name, cvk1, xvec) < 0)
         goto done;
     retval = 1; /* match */
  done:
@@ -309,6 +430,8 @@ xpath_list_optimize_fn(xpath_tree  *xt,
         free(vec);
     if (cvk)
         cvec_free(cvk);
+    if (cvk1)
+        cvec_free(cvk1);
     return retval;
  ok: /* no match, not special case */
     retval = 0;
@@ -331,6 +454,7 @@ xpath_optimize_check(xpath_tree *xs,
 {
 #ifdef XPATH_LIST_OPTIMIZE
     int          ret;
+    int          i;
     clixon_xvec *xvec = NULL;
     
     if (!_optimize_enable)
@@ -341,8 +465,12 @@ xpath_optimize_check(xpath_tree *xs,
     if ((ret = xpath_list_optimize_fn(xs, xv, xvec)) < 0)
         return -1;
     if (ret == 1){
-        if (clixon_xvec_extract(xvec, xvec0, xlen0, NULL) < 0)
-            return -1;
+        /* Append, xv may be one of several context nodes, eg a/y[k='3'] where a is a list */
+        for (i=0; i<clixon_xvec_len(xvec); i++)
+            if (cxvec_append(clixon_xvec_i(xvec, i), xvec0, xlen0) < 0){
+                clixon_xvec_free(xvec);
+                return -1;
+            }
         clixon_xvec_free(xvec);
         _optimize_hits++;
         return 1; /* Optimized */
@@ -356,3 +484,62 @@ xpath_optimize_check(xpath_tree *xs,
 #endif
 }
 
+/*! Get the range of the nodes selected by a child step of a list or leaf-list
+ *
+ * The entries of a list or leaf-list are contiguous in the sorted child vector of their
+ * parent, so that the step can be counted and indexed without building a node-set.
+ * Only the nodetest of the step is considered, not its predicates.
+ * @param[in]  xs     XPath tree of type STEP, eg interface or if:interface
+ * @param[in]  xv     XML context node
+ * @param[in]  nsc    XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[out] firstp Position of first node in child vector of xv
+ * @param[out] nrp    Number of nodes, may be 0
+ * @retval     1      OK, see firstp and nrp
+ * @retval     0      Not a list or leaf-list, or not sorted: use regular code
+ * @retval    -1      Error
+ * @see xml_list_range
+ */
+int
+xpath_optimize_range(xpath_tree *xs,
+                     cxobj      *xv,
+                     cvec       *nsc,
+                     int         localonly,
+                     int        *firstp,
+                     int        *nrp)
+{
+#ifdef XPATH_LIST_OPTIMIZE
+    int          ret;
+    xpath_tree  *nodetest;
+    yang_stmt   *yp;
+    yang_stmt   *yc;
+    char        *ns;
+    char        *ns1;
+
+    if (!_optimize_enable)
+        return 0;
+    /* Namespace must be given to exclude children with same name from other modules */
+    if (localonly || nsc == NULL)
+        return 0;
+    if (xs->xs_type != XP_STEP || xs->xs_int != A_CHILD)
+        return 0;
+    if ((nodetest = xs->xs_c0) == NULL || nodetest->xs_type != XP_NODE ||
+        nodetest->xs_s1 == NULL || strcmp(nodetest->xs_s1, "*") == 0)
+        return 0;
+    /* Only config data is sorted */
+    if ((yp = xml_spec(xv)) == NULL || yang_config_ancestor(yp) == 0)
+        return 0;
+    if ((yc = yang_find(yp, Y_LIST, nodetest->xs_s1)) == NULL &&
+        (yc = yang_find(yp, Y_LEAF_LIST, nodetest->xs_s1)) == NULL)
+        return 0;
+    if ((ns = xml_nsctx_get(nsc, nodetest->xs_s0)) == NULL ||
+        (ns1 = yang_find_mynamespace(yc)) == NULL ||
+        strcmp(ns, ns1) != 0)
+        return 0;
+    if ((ret = xml_list_range(xv, yc, firstp, nrp)) == 1)
+        _optimize_hits++;
+    return ret;
+#else
+    return 0; /* use regular code */
+#endif
+}
@@ -75,6 +75,8 @@
 #include "clixon_hash.h"
 #include "clixon_xml.h"
 #include "clixon_xml_nsctx.h"
+#include "clixon_xpath_ctx.h"
+#include "clixon_xpath.h"
 #include "clixon_yang_module.h"
 #include "clixon_plugin.h"
 #include "clixon_data.h"
@@ -84,16 +86,25 @@
 #include "clixon_yang_parse_lib.h"
 #include "clixon_yang_cardinality.h"
 #include "clixon_yang_type.h"
+#include "clixon_regex.h"
 #include "clixon_yang_schema_mount.h"
 #include "clixon_yang_internal.h" /* internal included by this file only, not API*/
+#include "clixon_yang_index.h"
 
 #ifdef XML_EXPLICIT_INDEX
 static int yang_search_index_extension(clicon_handle h, yang_stmt *yext, yang_stmt *ys);
 #endif
+static yang_bloom *yang_bloom_get(yang_stmt *ys);
 
 /*
  * Local variables
  */
+/* Generation of yang trees, incremented when a yang node is added, removed or renamed.
+ * A bloom filter or order of an older generation is computed again, see yang_bloom_get
+ * and yang_order
+ */
+static uint32_t _yang_gen = 1;
+
 /* Mapping between yang keyword string <--> clixon constants 
  * Here is also the place where doc on some types store variables (cv)
  */
@@ -250,7 +261,20 @@ int
 yang_argument_set(yang_stmt *ys,
                   char      *arg)
 {
+    if (ys->ys_flags & YANG_FLAG_ARG_INTERN){
+        clixon_string_unintern(ys->ys_argument);
+        ys->ys_flags &= ~YANG_FLAG_ARG_INTERN;
+    }
     ys->ys_argument = arg; /* not strdup/copied */
+    if (ys->ys_json){ /* Computed again on next use */
+        free(ys->ys_json);
+        ys->ys_json = NULL;
+    }
+    _yang_gen++;
+#ifdef YANG_INDEX
+    if (ys->ys_parent)
+        yang_index_drop(ys->ys_parent);
+#endif
     return 0;
 }
 
@@ -309,6 +333,62 @@ yang_cvec_set(yang_stmt *ys,
     return 0;
 }
 
+/*! Get precompiled key comparator of a yang list or leaf-list
+ *
+ * @param[in] ys  Yang statement node
+ * @retval    yk  Key comparator
+ * @retval    NULL Not a list or leaf-list, or not yet populated
+ * @see ys_populate_keycmp
+ */
+yang_keycmp *
+yang_keycmp_get(yang_stmt *ys)
+{
+    return ys->ys_keycmp;
+}
+
+/*! Free key comparator
+ */
+static int
+yang_keycmp_free(yang_keycmp *yk)
+{
+    int i;
+
+    for (i=0; i<yk->yk_len; i++)
+        if (yk->yk_keys[i].yk_name)
+            clixon_string_unintern(yk->yk_keys[i].yk_name);
+    free(yk);
+    return 0;
+}
+
+/*! Copy key comparator
+ *
+ * @param[in]  yk    Key comparator
+ * @retval     yk1   New key comparator
+ * @retval     NULL  Error
+ */
+static yang_keycmp *
+yang_keycmp_dup(yang_keycmp *yk)
+{
+    yang_keycmp *yk1;
+    size_t       sz;
+    int          i;
+
+    sz = sizeof(*yk) + yk->yk_len*sizeof(yk->yk_keys[0]);
+    if ((yk1 = malloc(sz)) == NULL){
+        clicon_err(OE_YANG, errno, "malloc");
+        return NULL;
+    }
+    memcpy(yk1, yk, sz);
+    for (i=0; i<yk->yk_len; i++)
+        if (yk->yk_keys[i].yk_name &&
+            (yk1->yk_keys[i].yk_name = clixon_string_intern(yk->yk_keys[i].yk_name)) == NULL){
+            yk1->yk_len = i;
+            yang_keycmp_free(yk1);
+            return NULL;
+        }
+    return yk1;
+}
+
 /*! Add new value to yang cvec, create if not exist
  *
  * @param[in] ys    Yang statement
@@ -465,6 +545,274 @@ yang_when_nsc_set(yang_stmt *ys,
     return retval;
 }
 
+/*! Get parsed xpath and namespace context of a "must" or "when" statement
+ *
+ * The xpath argument is parsed and the namespace context is computed once, on first use,
+ * and then stored in the yang statement.
+ * The namespace context of "must" is the one of the statement itself, and of "when" the one
+ * of the data node it is defined in.
+ * @param[in]  ys      Yang "must" or "when" statement
+ * @param[out] xptree  Parsed xpath, NULL if it could not be parsed. Do not free
+ * @param[out] nsc     Namespace context. Do not free
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @note If the xpath could not be parsed, eg unimplemented functions, the error is logged once,
+ *       and xptree is NULL. Use the xpath argument string instead, which gives the same error.
+ */
+int
+yang_xpath_get(yang_stmt          *ys,
+               struct xpath_tree **xptree,
+               cvec              **nsc)
+{
+    int        retval = -1;
+    yang_stmt *yn;
+
+    if (ys->ys_xpath_nsc == NULL){
+        yn = ys;
+        if (ys->ys_keyword == Y_WHEN && ys->ys_parent != NULL)
+            yn = ys->ys_parent;
+        if (xml_nsctx_yang(yn, &ys->ys_xpath_nsc) < 0)
+            goto done;
+        if (ys->ys_argument &&
+            xpath_parse(ys->ys_argument, &ys->ys_xpath) < 0)
+            ys->ys_xpath = NULL;
+    }
+    *xptree = ys->ys_xpath;
+    *nsc = ys->ys_xpath_nsc;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get namespace context of the module or sub-module of a yang statement
+ *
+ * The context is the same as of xml_nsctx_yang, it is computed once per module on first use
+ * and then stored in the module.
+ * @param[in]  ys   Yang statement in module tree (or module itself)
+ * @param[out] nsc  Namespace context. Do not free
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_nsctx_yang  Creates a new context
+ */
+int
+yang_nsctx_get(yang_stmt *ys,
+               cvec     **nsc)
+{
+    yang_stmt *ymod;
+
+    if ((ymod = ys_module(ys)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "My yang module not found");
+        return -1;
+    }
+    if (ymod->ys_xpath_nsc == NULL &&
+        xml_nsctx_yang(ymod, &ymod->ys_xpath_nsc) < 0)
+        return -1;
+    *nsc = ymod->ys_xpath_nsc;
+    return 0;
+}
+
+/*! Get namespace id of the module of a yang statement
+ *
+ * Computed on first use and stored in the statement
+ * @param[in]  ys   Yang statement in module tree
+ * @retval     id   Namespace id, see xml_nsid_register
+ * @retval     0    No namespace
+ */
+uint16_t
+yang_nsid_get(yang_stmt *ys)
+{
+    char *ns;
+
+    if (ys->ys_nsid == 0 &&
+        (ns = yang_find_mynamespace(ys)) != NULL)
+        ys->ys_nsid = xml_nsid_register(ns);
+    return ys->ys_nsid;
+}
+
+/*! Get precomputed JSON member name of a yang data node
+ *
+ * Computed on first use and stored in the statement. The module name and the qualified name
+ * are stored in one allocated string: "<module>:<name>\0<module>\0"
+ * @param[in]  ys   Yang data node
+ * @retval     yj   JSON name. Do not free
+ * @retval     NULL Error
+ * @see xml2json1_head
+ */
+yang_json *
+yang_json_get(yang_stmt *ys)
+{
+    yang_json *yj;
+    yang_stmt *ymod = NULL;
+    char      *modname;
+    char      *name;
+    size_t     mlen;
+    size_t     nlen;
+
+    if ((yj = ys->ys_json) != NULL)
+        return yj;
+    if (ys_real_module(ys, &ymod) < 0)
+        return NULL;
+    modname = ymod?yang_argument_get(ymod):"";
+    /* Special case for ietf-netconf -> ietf-restconf translation, see json_xmlns_translate() */
+    if (strcmp(modname, "ietf-netconf") == 0)
+        modname = "ietf-restconf";
+    name = ys->ys_argument?ys->ys_argument:"";
+    mlen = strlen(modname);
+    nlen = strlen(name);
+    if ((yj = malloc(sizeof(*yj) + 2*(mlen+1) + nlen + 1)) == NULL){
+        clicon_err(OE_YANG, errno, "malloc");
+        return NULL;
+    }
+    yj->yj_qname = (char*)(yj + 1);
+    memcpy(yj->yj_qname, modname, mlen);
+    yj->yj_qname[mlen] = ':';
+    memcpy(yj->yj_qname + mlen + 1, name, nlen + 1);
+    yj->yj_module = yj->yj_qname + mlen + 1 + nlen + 1;
+    memcpy(yj->yj_module, modname, mlen + 1);
+    ys->ys_json = yj;
+    return yj;
+}
+
+/*! Add a name to a bloom filter
+ *
+ * @param[in]  yb   Bloom filter
+ * @param[in]  name Name of data node
+ * @see yang_bloom_descendant
+ */
+static void
+yang_bloom_name(yang_bloom *yb,
+                const char *name)
+{
+    uint64_t h = 14695981039346656037ULL; /* FNV-1a */
+    uint32_t i;
+
+    while (*name){
+        h ^= (unsigned char)*name++;
+        h *= 1099511628211ULL;
+    }
+    i = (uint32_t)h % (YANG_BLOOM_WORDS*64);
+    yb->yb_bits[i/64] |= (uint64_t)1 << (i%64);
+    i = (uint32_t)(h >> 32) % (YANG_BLOOM_WORDS*64);
+    yb->yb_bits[i/64] |= (uint64_t)1 << (i%64);
+}
+
+/*! Add names of child data nodes and their descendants to a bloom filter
+ *
+ * Choice and case are transparent
+ * @param[in]  yb   Bloom filter
+ * @param[in]  ys   Yang node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+yang_bloom_children(yang_bloom *yb,
+                    yang_stmt  *ys)
+{
+    yang_stmt  *yc;
+    yang_bloom *ybc;
+    int         i;
+    int         j;
+
+    for (i=0; i<ys->ys_len && !yb->yb_all; i++){
+        yc = ys->ys_stmt[i];
+        switch (yc->ys_keyword){
+        case Y_CHOICE:
+        case Y_CASE:
+            if (yang_bloom_children(yb, yc) < 0)
+                return -1;
+            break;
+        case Y_CONTAINER:
+        case Y_LEAF:
+        case Y_LIST:
+        case Y_LEAF_LIST:
+        case Y_ANYDATA:
+        case Y_ANYXML:
+        case Y_RPC:
+        case Y_ACTION:
+        case Y_INPUT:
+        case Y_OUTPUT:
+        case Y_NOTIFICATION:
+            if (yc->ys_argument)
+                yang_bloom_name(yb, yc->ys_argument);
+            if ((ybc = yang_bloom_get(yc)) == NULL)
+                return -1;
+            if (ybc->yb_all)
+                yb->yb_all = 1;
+            else
+                for (j=0; j<YANG_BLOOM_WORDS; j++)
+                    yb->yb_bits[j] |= ybc->yb_bits[j];
+            break;
+        default:
+            break;
+        }
+    }
+    return 0;
+}
+
+/*! Get bloom filter of the names of all descendant data nodes, compute it if needed
+ *
+ * Anydata, anyxml and mount-points may contain any name
+ * @param[in]  ys   Yang node
+ * @retval     yb   Bloom filter. Do not free
+ * @retval     NULL Error
+ */
+static yang_bloom *
+yang_bloom_get(yang_stmt *ys)
+{
+    yang_bloom *yb;
+    int         ret;
+
+    if ((yb = ys->ys_bloom) != NULL && yb->yb_gen == _yang_gen)
+        return yb;
+    if (yb == NULL && (yb = malloc(sizeof(*yb))) == NULL){
+        clicon_err(OE_YANG, errno, "malloc");
+        return NULL;
+    }
+    memset(yb, 0, sizeof(*yb));
+    ys->ys_bloom = yb;
+    if (ys->ys_keyword == Y_ANYDATA || ys->ys_keyword == Y_ANYXML)
+        yb->yb_all = 1;
+    else if ((ret = yang_schema_mount_point(ys)) < 0)
+        return NULL;
+    else if (ret == 1)
+        yb->yb_all = 1;
+    else if (yang_bloom_children(yb, ys) < 0)
+        return NULL;
+    yb->yb_gen = _yang_gen;
+    return yb;
+}
+
+/*! Check if a yang node may have a descendant data node with a name
+ *
+ * Used to skip subtrees in descendant xpath queries such as //name. Names of all descendant data
+ * nodes are kept in a bloom filter that is computed on first use and again if the yang tree
+ * has changed. Namespaces are not considered.
+ * @param[in]  ys   Yang node
+ * @param[in]  name Name of descendant data node
+ * @retval     1    Yes, or maybe
+ * @retval     0    No, there is no such descendant
+ * @retval    -1    Error
+ * @see XPATH_SCHEMA_PRUNE
+ */
+int
+yang_bloom_descendant(yang_stmt  *ys,
+                      const char *name)
+{
+    yang_bloom yb0 = {0,};
+    yang_bloom *yb;
+    int         i;
+
+    if ((yb = yang_bloom_get(ys)) == NULL)
+        return -1;
+    if (yb->yb_all)
+        return 1;
+    yang_bloom_name(&yb0, name);
+    for (i=0; i<YANG_BLOOM_WORDS; i++)
+        if ((yb->yb_bits[i] & yb0.yb_bits[i]) != yb0.yb_bits[i])
+            return 0;
+    return 1;
+}
+
 /*! Get yang filename for error/debug purpose
  *
  * @param[in]  ys       Yang statement
@@ -553,27 +901,40 @@ yang_stats_one(yang_stmt *y,
     
     sz += sizeof(struct yang_stmt);
     sz += y->ys_len*sizeof(struct yang_stmt*);
-    if (y->ys_argument)
-        sz += strlen(y->ys_argument) + 1;
+    if (y->ys_argument && (y->ys_flags & YANG_FLAG_ARG_INTERN) == 0)
+        sz += strlen(y->ys_argument) + 1; /* Interned arguments are in string intern stats */
     if (y->ys_cv)
         sz += cv_size(y->ys_cv);
     if (y->ys_cvec)
         sz += cvec_size(y->ys_cvec);
+    if (y->ys_keycmp)
+        sz += sizeof(yang_keycmp) + y->ys_keycmp->yk_len*sizeof(y->ys_keycmp->yk_keys[0]);
+    if (y->ys_json)
+        sz += sizeof(yang_json) + strlen(y->ys_json->yj_qname) + strlen(y->ys_json->yj_module) + 2;
+    if (y->ys_bloom)
+        sz += sizeof(yang_bloom);
     if ((yc = y->ys_typecache) != NULL){
-        sz += sizeof(struct yang_type_cache);
+        size_t ycsz = sizeof(struct yang_type_cache);
         if (yc->yc_cvv)
-            sz += cvec_size(yc->yc_cvv);
+            ycsz += cvec_size(yc->yc_cvv);
         if (yc->yc_patterns)
-            sz += cvec_size(yc->yc_patterns);
+            ycsz += cvec_size(yc->yc_patterns);
         if (yc->yc_regexps)
-            sz += cvec_size(yc->yc_regexps);
+            ycsz += cvec_size(yc->yc_regexps);
+        ycsz += yc->yc_nmembers*sizeof(yang_type_member);
+        sz += ycsz / yc->yc_refcnt; /* Shared by copies */
     }
     if (y->ys_when_xpath)
         sz += strlen(y->ys_when_xpath) + 1;
     if (y->ys_when_nsc)
         sz += cvec_size(y->ys_when_nsc);
+    if (y->ys_xpath_nsc)
+        sz += cvec_size(y->ys_xpath_nsc);
     if (y->ys_filename)
         sz += strlen(y->ys_filename) + 1;
+#ifdef YANG_INDEX
+    sz += yang_index_size(y);
+#endif
     if (szp)
         *szp = sz;
     return 0;
@@ -634,7 +995,7 @@ yspec_new(void)
     }
     memset(yspec, 0, sizeof(*yspec));
     yspec->ys_keyword = Y_SPEC;
-    _stats_yang_nr++;
+    __atomic_add_fetch(&_stats_yang_nr, 1, __ATOMIC_RELAXED);
     return yspec;
 }
 
@@ -654,7 +1015,8 @@ ys_new(enum rfc_6020 keyw)
     }
     memset(ys, 0, sizeof(*ys));
     ys->ys_keyword    = keyw;
-    _stats_yang_nr++;
+    /* Atomic since statements are created by parse threads, see yang_spec_load_dir */
+    __atomic_add_fetch(&_stats_yang_nr, 1, __ATOMIC_RELAXED);
     return ys;
 }
 
@@ -689,19 +1051,45 @@ ys_free1(yang_stmt *ys,
         ys->ys_cvec = NULL;
     }
     if (ys->ys_argument){
-        free(ys->ys_argument);
+        if (ys->ys_flags & YANG_FLAG_ARG_INTERN)
+            clixon_string_unintern(ys->ys_argument);
+        else
+            free(ys->ys_argument);
         ys->ys_argument = NULL;
     }
     if (ys->ys_typecache){
         yang_type_cache_free(ys->ys_typecache);
         ys->ys_typecache = NULL;
     }
+    if (ys->ys_keycmp){
+        yang_keycmp_free(ys->ys_keycmp);
+        ys->ys_keycmp = NULL;
+    }
+    if (ys->ys_json){
+        free(ys->ys_json);
+        ys->ys_json = NULL;
+    }
+    if (ys->ys_bloom){
+        free(ys->ys_bloom);
+        ys->ys_bloom = NULL;
+    }
     if (ys->ys_when_xpath)
         free(ys->ys_when_xpath);
     if (ys->ys_when_nsc)
         cvec_free(ys->ys_when_nsc);
+    if (ys->ys_xpath){
+        xpath_tree_free(ys->ys_xpath);
+        ys->ys_xpath = NULL;
+    }
+    if (ys->ys_xpath_nsc){
+        cvec_free(ys->ys_xpath_nsc);
+        ys->ys_xpath_nsc = NULL;
+    }
     if (ys->ys_stmt)
         free(ys->ys_stmt);
+#ifdef YANG_INDEX
+    yang_index_free(ys);
+#endif
     if (ys->ys_filename)
         free(ys->ys_filename);
     while((rc = ys->ys_action_cb) != NULL) {
@@ -714,7 +1102,7 @@ ys_free1(yang_stmt *ys,
     }
     if (self){
         free(ys);
-        _stats_yang_nr--;
+        __atomic_sub_fetch(&_stats_yang_nr, 1, __ATOMIC_RELAXED);
     }
     return 0;
 }
@@ -738,6 +1126,10 @@ ys_prune(yang_stmt *yp,
     
     if (i >= yp->ys_len)
         goto done;
+#ifdef YANG_INDEX
+    yang_index_drop(yp);
+#endif
+    _yang_gen++;
     yc = yp->ys_stmt[i];
     if (i < yp->ys_len - 1){
         size = (yp->ys_len - i - 1)*sizeof(struct yang_stmt *);
@@ -797,6 +1189,9 @@ ys_freechildren(yang_stmt *ys)
     int i;
     yang_stmt *yc;
     
+#ifdef YANG_INDEX
+    yang_index_free(ys);
+#endif
     for (i=0; i<ys->ys_len; i++){
         if ((yc = ys->ys_stmt[i]) != NULL)
             ys_free(yc);
@@ -828,6 +1223,10 @@ ys_free(yang_stmt *ys)
 static int 
 yn_realloc(yang_stmt *yn)
 {
+#ifdef YANG_INDEX
+    yang_index_drop(yn);
+#endif
+    _yang_gen++;
     yn->ys_len++;
 
     if ((yn->ys_stmt = realloc(yn->ys_stmt, (yn->ys_len)*sizeof(yang_stmt *))) == 0){
@@ -864,16 +1263,23 @@ ys_cp(yang_stmt *ynew,
 
     memcpy(ynew, yold, sizeof(*yold)); 
     ynew->ys_parent = NULL;
+#ifdef YANG_INDEX
+    ynew->ys_index = NULL; /* Built after yang_parse_post */
+#endif
     if (yold->ys_stmt)
         if ((ynew->ys_stmt = calloc(yold->ys_len, sizeof(yang_stmt *))) == NULL){
             clicon_err(OE_YANG, errno, "calloc");
             goto done;
         }
-    if (yold->ys_argument)
-        if ((ynew->ys_argument = strdup(yold->ys_argument)) == NULL){
-            clicon_err(OE_YANG, errno, "strdup");
+    /* Copies share the argument as an interned string, eg all leafs expanded from a
+     * grouping. The original keeps its own argument */
+    ynew->ys_flags &= ~YANG_FLAG_ARG_INTERN;
+    ynew->ys_argument = NULL;
+    if (yold->ys_argument){
+        if ((ynew->ys_argument = clixon_string_intern(yold->ys_argument)) == NULL)
             goto done;
-        }
+        ynew->ys_flags |= YANG_FLAG_ARG_INTERN;
+    }
     yang_cv_set(ynew, NULL);
     if ((cvo = yang_cv_get(yold)) != NULL){
         if ((cvn = cv_dup(cvo)) == NULL){
@@ -892,6 +1298,9 @@ ys_cp(yang_stmt *ynew,
         if (yang_type_cache_cp(ynew, yold) < 0)
             goto done;
     }
+    if (yold->ys_keycmp)
+        if ((ynew->ys_keycmp = yang_keycmp_dup(yold->ys_keycmp)) == NULL)
+            goto done;
     if (yold->ys_when_xpath)
         if ((ynew->ys_when_xpath = strdup(yold->ys_when_xpath)) == NULL){
             clicon_err(OE_YANG, errno, "strdup");
@@ -903,6 +1312,13 @@ ys_cp(yang_stmt *ynew,
             goto done;
         }
     }
+    /* Namespace context depends on the module, parse again on first use */
+    ynew->ys_xpath = NULL;
+    ynew->ys_xpath_nsc = NULL;
+    ynew->ys_nsid = 0;
+    ynew->ys_json = NULL;
+    ynew->ys_bloom = NULL;
+    ynew->ys_order_gen = 0;
     for (i=0; i<ynew->ys_len; i++){
         yco = yold->ys_stmt[i];
         if ((ycn = ys_dup(yco)) == NULL)
@@ -966,6 +1382,11 @@ ys_replace(yang_stmt *yorig,
     yang_stmt *yc; /* child */
 
     yp = yang_parent_get(yorig);
+#ifdef YANG_INDEX
+    if (yp)
+        yang_index_drop(yp);
+#endif
+    _yang_gen++;
     /* Remove old yangs all children */
     yc = NULL;
     while ((yc = yn_each(yorig, yc)) != NULL) 
@@ -1079,6 +1500,10 @@ yang_find(yang_stmt  *yn,
     yang_stmt *yspec;
     yang_stmt *ym;
 
+#ifdef YANG_INDEX
+    /* Linear scan if not indexed */
+    if (keyword == 0 || argument == NULL || yang_index_find(yn, keyword, argument, &yret) == 0)
+#endif
     for (i=0; i<yn->ys_len; i++){
         ys = yn->ys_stmt[i];
         if (keyword == 0 || ys->ys_keyword == keyword){
@@ -1163,6 +1588,10 @@ yang_find_datanode(yang_stmt *yn,
     char      *name;
 
     ys = NULL;
+#ifdef YANG_INDEX
+    /* Linear scan if not indexed */
+    if (argument == NULL || yang_index_find(yn, YANG_INDEX_DATANODE, argument, &ysmatch) == 0)
+#endif
     while ((ys = yn_each(yn, ys)) != NULL){
         if (yang_keyword_get(ys) == Y_CHOICE){ /* Look for its children */
             yc = NULL;
@@ -1232,6 +1661,10 @@ yang_find_schemanode(yang_stmt *yn,
     char      *name;
     int        i, j;
 
+#ifdef YANG_INDEX
+    /* Linear scan if not indexed */
+    if (argument == NULL || yang_index_find(yn, YANG_INDEX_SCHEMANODE, argument, &ysmatch) == 0)
+#endif
     for (i=0; i<yn->ys_len; i++){
         ys = yn->ys_stmt[i];
         if (yang_keyword_get(ys) == Y_CHOICE){ 
@@ -1638,6 +2071,8 @@ yang_order1(yang_stmt *yp,
 
 /*! Return order of yang statement y in parents child vector
  *
+ * The order is computed on first use and again if the yang tree has changed, since it is
+ * used for every comparison when sorting and searching XML children.
  * @param[in]  y      Find position of this data-node
  * @param[out] index  Index of y in yp:s list of children
  * @retval   >=0      Order of child with specified argument
@@ -1660,6 +2095,10 @@ yang_order(yang_stmt *y)
         retval = -1; 
         goto done;
     }
+    if (y->ys_order_gen == _yang_gen){
+        retval = y->ys_order;
+        goto done;
+    }
     /* Some special handling if yp is choice (or case)
      * if so, the real parent (from an xml point of view) is the parents
      * parent. 
@@ -1688,6 +2127,9 @@ yang_order(yang_stmt *y)
         goto done;
     }
     retval = tot + j;
+    /* Order before generation, sort threads may read it concurrently */
+    y->ys_order = retval;
+    y->ys_order_gen = _yang_gen;
  done:
     return retval;
 }
@@ -2326,6 +2768,119 @@ ys_populate_list(clicon_handle h,
     return 0;
 }
 
+/*! Get key class of a leaf or leaf-list from its resolved type
+ *
+ * Same type resolving as when the value is parsed into a cligen value for comparison
+ * @param[in]  ys   Yang leaf or leaf-list
+ * @param[out] ykc  Key class
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+ys_key_class(yang_stmt           *ys,
+             enum yang_key_class *ykc)
+{
+    int          retval = -1;
+    yang_stmt   *yrestype = NULL;
+    enum cv_type cvtype;
+
+    if (yang_type_get(ys, NULL, &yrestype, NULL, NULL, NULL, NULL, NULL) < 0)
+        goto done;
+    *ykc = YK_GENERIC;
+    if (yrestype == NULL || yang2cv_type(yang_argument_get(yrestype), &cvtype) < 0)
+        goto ok;
+    switch (cvtype){
+    case CGV_STRING:
+        *ykc = YK_STRING;
+        break;
+    case CGV_INT8:
+    case CGV_INT16:
+    case CGV_INT32:
+    case CGV_INT64:
+        *ykc = YK_INT;
+        break;
+    case CGV_UINT8:
+    case CGV_UINT16:
+    case CGV_UINT32:
+    case CGV_UINT64:
+        *ykc = YK_UINT;
+        break;
+    default:
+        break;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Populate list or leaf-list with a precompiled key comparator
+ *
+ * The comparator contains the interned key names and how each key value is compared, so
+ * that they need not be derived for each comparison.
+ * Done in the 2nd populate step since keys may come from groupings
+ * @param[in] ys   The yang list or leaf-list
+ * @retval    0    OK
+ * @retval   -1    Error with clicon_err called
+ * @see xml_cmp where it is used
+ */
+static int
+ys_populate_keycmp(yang_stmt *ys)
+{
+    int          retval = -1;
+    yang_keycmp *yk = NULL;
+    cvec        *cvk;
+    cg_var      *cvi;
+    yang_stmt   *yleaf;
+    int          len;
+    int          i;
+
+    if (ys->ys_keycmp){
+        yang_keycmp_free(ys->ys_keycmp);
+        ys->ys_keycmp = NULL;
+    }
+    if (ys->ys_keyword == Y_LIST){
+        if ((cvk = yang_cvec_get(ys)) == NULL) /* No keys */
+            goto ok;
+        len = cvec_len(cvk);
+    }
+    else{
+        cvk = NULL;
+        len = 1;
+    }
+    if ((yk = calloc(1, sizeof(*yk) + len*sizeof(yk->yk_keys[0]))) == NULL){
+        clicon_err(OE_YANG, errno, "calloc");
+        goto done;
+    }
+    yk->yk_len = len;
+    if (cvk == NULL){
+        if (ys_key_class(ys, &yk->yk_keys[0].yk_class) < 0)
+            goto done;
+    }
+    else {
+        i = 0;
+        cvi = NULL;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+            /* Missing key leaf is detected in ys_list_check */
+            if ((yleaf = yang_find(ys, Y_LEAF, cv_string_get(cvi))) == NULL)
+                goto ok;
+            if (ys_key_class(yleaf, &yk->yk_keys[i].yk_class) < 0)
+                goto done;
+            if ((yk->yk_keys[i].yk_name = clixon_string_intern(cv_string_get(cvi))) == NULL)
+                goto done;
+            i++;
+        }
+    }
+    ys->ys_keycmp = yk;
+    yk = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (yk)
+        yang_keycmp_free(yk);
+    return retval;
+}
+
 /*! Set range or length boundary for built-in yang types
  *
  * Help functions to range and length statements 
@@ -2605,6 +3160,9 @@ ys_populate_identity(clicon_handle h,
             clicon_err(OE_UNIX, errno, "cv_new"); 
             goto done;
         }
+#ifdef YANG_INDEX
+        yang_index_free(ybaseid); /* Built again after yang_parse_post */
+#endif
         /* Transitive to the root */
         if (ys_populate_identity(h, ybaseid, idref) < 0)
             goto done;
@@ -2944,9 +3502,18 @@ ys_populate2(yang_stmt    *ys,
     
     switch(ys->ys_keyword){
     case Y_LEAF:
+        if (ys_populate_leaf(h, ys) < 0)
+            goto done;
+        break;
     case Y_LEAF_LIST:
         if (ys_populate_leaf(h, ys) < 0)
             goto done;
+        if (ys_populate_keycmp(ys) < 0)
+            goto done;
+        break;
+    case Y_LIST:
+        if (ys_populate_keycmp(ys) < 0)
+            goto done;
         break;
     case Y_MANDATORY: /* call yang_mandatory() to check if set */
     case Y_CONFIG:
@@ -3011,13 +3578,20 @@ yang_features(clicon_handle h,
                 case 0: /* disabled: remove ys */
                     /* Change datanodes YANG to ANYDATA, other nodes are removed
                      */
+                    _yang_gen++;
                     if (yang_datanode(ys) && yang_config_ancestor(ys)){
+#ifdef YANG_INDEX
+                        yang_index_drop(yt);
+#endif
                         ys->ys_keyword = Y_ANYDATA;
                         ys_freechildren(ys);
                         ys->ys_len = 0;
                         yang_flag_set(ys, YANG_FLAG_DISABLED);
                         break;
                     }
+#ifdef YANG_INDEX
+                    yang_index_drop(yt);
+#endif
                     for (j=i+1; j<yt->ys_len; j++)
                         yt->ys_stmt[j-1] = yt->ys_stmt[j];
                     yt->ys_len--;
@@ -3561,6 +4135,7 @@ yang_type_cache_set(yang_stmt        *ys,
     }
     ycache = ys->ys_typecache;
     memset(ycache, 0, sizeof(*ycache));
+    ycache->yc_refcnt = 1;
     ycache->yc_resolved  = resolved;
     ycache->yc_options  = options;
     if (cvv){
@@ -3657,41 +4232,97 @@ yang_type_cache_get(yang_stmt   *ytype,
     return retval;
 }
 
+/*! Get resolved member types of a union from the yang type cache
+ *
+ * @param[in]  ytype    Yang type statement of union
+ * @param[out] members  Vector of resolved member types, owned by the cache
+ * @param[out] len      Length of members
+ * @retval     1        Members are cached
+ * @retval     0        No cache or members not set
+ * @see yang_type_cache_members_set
+ */
+int
+yang_type_cache_members_get(yang_stmt         *ytype,
+                            yang_type_member **members,
+                            int               *len)
+{
+    yang_type_cache *ycache;
+
+    if ((ycache = ytype->ys_typecache) == NULL ||
+        ycache->yc_members == NULL)
+        return 0;
+    *members = ycache->yc_members;
+    *len = ycache->yc_nmembers;
+    return 1;
+}
+
+/*! Set resolved member types of a union in the yang type cache
+ *
+ * @param[in]  ytype    Yang type statement of union
+ * @param[in]  members  Vector of resolved member types, consumed if 1 is returned
+ * @param[in]  len      Length of members
+ * @retval     1        OK, members are cached
+ * @retval     0        No type cache or members already set, members not consumed
+ * @retval    -1        Error
+ */
+int
+yang_type_cache_members_set(yang_stmt        *ytype,
+                            yang_type_member *members,
+                            int               len)
+{
+    yang_type_cache *ycache;
+
+    if (yang_keyword_get(ytype) != Y_TYPE){
+        clicon_err(OE_YANG, EINVAL, "Expected Y_TYPE");
+        return -1;
+    }
+    if ((ycache = ytype->ys_typecache) == NULL ||
+        ycache->yc_members != NULL ||
+        members == NULL)
+        return 0;
+    ycache->yc_members = members;
+    ycache->yc_nmembers = len;
+    return 1;
+}
+
+/*! Free vector of resolved union member types
+ *
+ * @param[in]  members  Vector of resolved member types
+ * @param[in]  len      Length of members
+ * @retval     0        OK
+ */
+int
+yang_type_members_free(yang_type_member *members,
+                       int               len)
+{
+    int i;
+
+    if (members == NULL)
+        return 0;
+    for (i=0; i<len; i++)
+        if (members[i].ym_regexps)
+            cvec_free(members[i].ym_regexps);
+    free(members);
+    return 0;
+}
+
 /*! Copy yang type cache
+ *
+ * The cache is shared, not copied: a type is resolved where it is defined, eg in a grouping,
+ * so all copies have the same resolved type and restrictions. Regexps are compiled once
+ * for all copies.
+ * The cache is freed with the last type statement sharing it
  */
 static int
 yang_type_cache_cp(yang_stmt *ynew,
                    yang_stmt *yold)
 {
-    int        retval = -1;
-    int        options;
-    cvec      *cvv;
-    cvec      *patterns = NULL;
-    uint8_t    fraction;
-    yang_stmt *resolved;
-    int        ret;
-
-    if ((patterns = cvec_new(0)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_new");
-        goto done;
-    }
-    /* Note, regexps are not copied since they are voids, if they were, they
-     * could not be freed in a simple way since copies are made at augment/group
-     */
-    if ((ret = yang_type_cache_get(yold,
-                                   &resolved, &options, &cvv, patterns, NULL, NULL, &fraction)) < 0)
-        goto done;
-    if (ret == 1 &&
-        yang_type_cache_set(ynew, resolved, options, cvv, patterns, fraction) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (patterns)
-        cvec_free(patterns);
-    return retval;
+    if ((ynew->ys_typecache = yold->ys_typecache) != NULL)
+        ynew->ys_typecache->yc_refcnt++;
+    return 0;
 }
 
-/*! Free yang type cache
+/*! Free yang type cache, or release a reference to a shared cache
  */
 static int
 yang_type_cache_free(yang_type_cache *ycache)
@@ -3699,6 +4330,8 @@ yang_type_cache_free(yang_type_cache *ycache)
     cg_var *cv;
     void   *p;
     
+    if (--ycache->yc_refcnt > 0)
+        return 0;
     if (ycache->yc_cvv)
         cvec_free(ycache->yc_cvv);
     if (ycache->yc_patterns)
@@ -3722,6 +4355,10 @@ yang_type_cache_free(yang_type_cache *ycache)
                     cv_void_set(cv, NULL);
                 }
                 break;
+            case REGEXP_PCRE2:
+                regex_pcre2_free(cv_void_get(cv));
+                cv_void_set(cv, NULL);
+                break;
             default:
                 break;
             }
@@ -3729,6 +4366,8 @@ yang_type_cache_free(yang_type_cache *ycache)
         }
         cvec_free(ycache->yc_regexps);
     }
+    if (ycache->yc_members)
+        yang_type_members_free(ycache->yc_members, ycache->yc_nmembers);
     free(ycache);
     return 0;
 }
@@ -3881,6 +4520,9 @@ yang_sort_subelements(yang_stmt *ys)
          yang_keyword_get(ys) == Y_LIST)){
         /* This enumerates _ys_vector_i in ys->ys_stmt vector */
         while ((yc = yn_each(ys, yc)) != NULL) ;
+#ifdef YANG_INDEX
+        yang_index_drop(ys);
+#endif
         qsort(ys->ys_stmt, ys->ys_len, sizeof(ys), yang_sort_subelements_fn);
     }
     retval = 0;
@@ -3912,6 +4554,7 @@ yang_list_index_add(yang_stmt *ys)
         goto ok;
     }
     yang_flag_set(ys, YANG_FLAG_INDEX);
+    yang_flag_set(yp, YANG_FLAG_INDEX_LIST);
  ok:
     retval = 0;
    // done:
@@ -3940,7 +4583,9 @@ yang_search_index_extension(clicon_handle h,
     ymod = ys_module(yext);
     modname = yang_argument_get(ymod);
     extname = yang_argument_get(yext);
-    if (strcmp(modname, "clixon-config") != 0 || strcmp(extname, "search_index") != 0)
+    /* clixon-config:search_index is kept for backward compatibility */
+    if (!(strcmp(modname, "clixon-lib") == 0 && strcmp(extname, "search-index") == 0) &&
+        !(strcmp(modname, "clixon-config") == 0 && strcmp(extname, "search_index") == 0))
         goto ok;
     clicon_debug(1, "%s Enabled extension:%s:%s", __FUNCTION__, modname, extname);
     yp = yang_parent_get(ys);
@@ -0,0 +1,1393 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Cache of the compiled yang spec of a daemon, see CLICON_YANG_CACHE_DIR
+ *
+ * After all yang modules are parsed, expanded and populated, the yang spec is written to
+ * <CLICON_YANG_CACHE_DIR>/<name>.ycache. At next start, the file is mapped and decoded
+ * into yang statements instead of parsing the modules again, if it is still valid:
+ * - The key is the same: a hash of all clixon options, the config file and the names of
+ *   loaded plugins, which includes features and yang directories.
+ * - All module files have the same size and content hash.
+ * - The directories of the module files and the yang directories have the same mtime,
+ *   ie no module file has been added or removed.
+ * Otherwise the yang modules are parsed and a new cache file is written.
+ *
+ * References between statements (module, resolved type, extension instances) are
+ * encoded as preorder indexes, as are type caches shared by copies of a type. Compiled regexps, parsed xpaths and child indexes are not
+ * stored, they are created on use or after decoding.
+ * All integers are 32-bit unsigned in network byte order:
+ *
+ *   header: "CLYC" <version> <key:64> <nfiles> <file>* <ndirs> <dir>* <nnodes> <nchildren>
+ *   file:   <path> <size:64> <hash:64>
+ *   dir:    <path> <mtime-sec:64> <mtime-nsec>
+ *   node:   <keyword> <flags> <argument> <module> <filename> <linenum> <mask>
+ *           [<cv>] [<cvec>] [<typecache> | <ref>] [<keycmp>] [<when-xpath>] [<when-nsc>]
+ *           <nchildren> <node>*
+ *   string: <len+1> <bytes> '\0', where 0 means NULL
+ *   cv:     <type> <flags> <name> <ref> if void, else <fraction-digits> if decimal64, <value>
+ *   cvec:   <len> <cv>*
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <syslog.h>
+#include <libgen.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/param.h>
+#include <arpa/inet.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_yang_type.h"
+#include "clixon_xml_map.h"
+#include "clixon_yang_module.h"
+#include "clixon_plugin.h"
+#include "clixon_options.h"
+#include "clixon_data.h"
+#include "clixon_yang_internal.h"
+#include "clixon_yang_index.h"
+#include "clixon_yang_cache.h"
+
+/*
+ * Constants
+ */
+#define YANG_CACHE_MAGIC   "CLYC"
+#define YANG_CACHE_VERSION 2
+#define YANG_CACHE_NONE    0xffffffff     /* No statement reference */
+#define YANG_CACHE_KEY     "yang-cache-key" /* Handle data: key computed at load */
+
+/* Node mask bits of optional fields */
+#define YC_CV        0x01
+#define YC_CVEC      0x02
+#define YC_TYPECACHE 0x04
+#define YC_KEYCMP    0x08
+#define YC_WHENXPATH 0x10
+#define YC_WHENNSC   0x20
+#define YC_TYPEREF   0x40 /* Type cache shared with an earlier statement */
+#define YC_MASK      0x7f
+
+/* cv flag bits */
+#define YC_CV_UNSET  0x01
+#define YC_CV_INVERT 0x02
+
+/*! Statement or type cache and preorder index of its statement, sorted on pointer for lookup
+ */
+struct yang_cache_ref {
+    void      *yr_ptr;
+    uint32_t   yr_i;
+};
+
+/*! Yang cache encoder state
+ */
+struct yang_cache_enc {
+    cbuf                  *ye_cb;   /* Encoded file */
+    struct yang_cache_ref *ye_refs; /* Sorted on statement */
+    uint32_t               ye_nr;   /* Number of statements including yspec */
+    struct yang_cache_ref *ye_tcs;  /* Type caches and first statement, sorted on cache */
+    uint32_t               ye_ntc;  /* Number of type caches */
+};
+
+/*! Yang cache decoder state, a mapped file
+ */
+struct yang_cache_dec {
+    const char  *yd_buf;   /* Mapped file */
+    size_t       yd_len;   /* Length of file */
+    size_t       yd_pos;   /* Current position */
+    yang_stmt  **yd_vec;   /* Statements in preorder, 0 is yspec */
+    uint32_t     yd_nr;    /* Number of statements including yspec */
+    uint32_t     yd_next;  /* Next statement to decode */
+};
+
+/*! FNV-1a 64-bit hash of a buffer, continued from h
+ */
+static uint64_t
+yang_cache_hash(uint64_t    h,
+                const void *buf,
+                size_t      len)
+{
+    const uint8_t *p = buf;
+    size_t         i;
+
+    for (i=0; i<len; i++){
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/*! Hash a string including its terminating null, continued from h
+ */
+static uint64_t
+yang_cache_hash_str(uint64_t    h,
+                    const char *str)
+{
+    if (str == NULL)
+        str = "";
+    return yang_cache_hash(h, str, strlen(str)+1);
+}
+
+static int
+yang_cache_strcmp(const void *a,
+                  const void *b)
+{
+    return strcmp(*(char**)a, *(char**)b);
+}
+
+/*! Compute cache key of a daemon from its options, config and plugins
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  name  Name of daemon, eg "backend"
+ * @param[out] keyp  Key
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+yang_cache_key(clicon_handle h,
+               const char   *name,
+               uint64_t     *keyp)
+{
+    int              retval = -1;
+    uint64_t         k = 14695981039346656037ULL;
+    clicon_hash_t   *copt = clicon_options(h);
+    char           **keys = NULL;
+    size_t           klen;
+    size_t           vlen;
+    void            *val;
+    uint32_t         u;
+    cxobj           *x;
+    clixon_plugin_t *cp;
+    int              i;
+
+    u = YANG_CACHE_VERSION;
+    k = yang_cache_hash(k, &u, sizeof(u));
+    u = sizeof(struct yang_stmt);
+    k = yang_cache_hash(k, &u, sizeof(u));
+    k = yang_cache_hash_str(k, CLIXON_VERSION_STRING);
+    k = yang_cache_hash_str(k, name);
+    /* Options, sorted since hash order is not defined */
+    if (clicon_hash_keys(copt, &keys, &klen) < 0)
+        goto done;
+    if (klen)
+        qsort(keys, klen, sizeof(*keys), yang_cache_strcmp);
+    for (i=0; i<klen; i++){
+        k = yang_cache_hash_str(k, keys[i]);
+        if ((val = clicon_hash_value(copt, keys[i], &vlen)) != NULL)
+            k = yang_cache_hash(k, val, vlen);
+    }
+    /* Config file, including lists such as CLICON_FEATURE and CLICON_YANG_DIR */
+    x = NULL;
+    while ((x = xml_child_each(clicon_conf_xml(h), x, CX_ELMNT)) != NULL) {
+        k = yang_cache_hash_str(k, xml_name(x));
+        k = yang_cache_hash_str(k, xml_body(x));
+    }
+    /* Plugins loaded before yangs may change them in extension callbacks */
+    cp = NULL;
+    while ((cp = clixon_plugin_each(h, cp)) != NULL)
+        k = yang_cache_hash_str(k, clixon_plugin_name_get(cp));
+    *keyp = k;
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Compute size and content hash of a file
+ *
+ * @param[in]  path   File name
+ * @param[out] sizep  Size of file
+ * @param[out] hashp  Hash of contents
+ * @retval     1      OK
+ * @retval     0      File not found or not readable
+ * @retval    -1      Error
+ */
+static int
+yang_cache_file_hash(const char *path,
+                     uint64_t   *sizep,
+                     uint64_t   *hashp)
+{
+    int         retval = -1;
+    int         fd = -1;
+    struct stat st;
+    void       *buf = MAP_FAILED;
+
+    if ((fd = open(path, O_RDONLY)) < 0 || fstat(fd, &st) < 0){
+        retval = 0;
+        goto done;
+    }
+    *sizep = st.st_size;
+    *hashp = 14695981039346656037ULL;
+    if (st.st_size > 0){
+        if ((buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED){
+            clicon_err(OE_UNIX, errno, "mmap");
+            goto done;
+        }
+        *hashp = yang_cache_hash(*hashp, buf, st.st_size);
+    }
+    retval = 1;
+ done:
+    if (buf != MAP_FAILED)
+        munmap(buf, st.st_size);
+    if (fd != -1)
+        close(fd);
+    return retval;
+}
+
+/*! Get name of cache file of a daemon
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  name  Name of daemon
+ * @param[out] cb    Cache file name
+ * @retval     1     OK
+ * @retval     0     No cache, CLICON_YANG_CACHE_DIR not set
+ */
+static int
+yang_cache_filename(clicon_handle h,
+                    const char   *name,
+                    cbuf         *cb)
+{
+    char *dir;
+
+    if ((dir = clicon_option_str(h, "CLICON_YANG_CACHE_DIR")) == NULL)
+        return 0;
+    cprintf(cb, "%s/%s.ycache", dir, name);
+    return 1;
+}
+
+/*! Get yang directories: directories of module files and configured yang directories
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Yang spec
+ * @param[in]  cvv    Directory names, each added once
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+yang_cache_dirs(clicon_handle h,
+                yang_stmt    *yspec,
+                cvec         *cvv)
+{
+    int         retval = -1;
+    yang_stmt  *ym = NULL;
+    const char *filename;
+    char       *dir;
+    char       *str = NULL;
+    cxobj      *x;
+
+    while ((ym = yn_each(yspec, ym)) != NULL){
+        if ((filename = yang_filename_get(ym)) == NULL)
+            continue;
+        if ((str = strdup(filename)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        dir = dirname(str);
+        if (cvec_find(cvv, dir) == NULL &&
+            cvec_add_string(cvv, dir, NULL) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+        free(str);
+        str = NULL;
+    }
+    x = NULL;
+    while ((x = xml_child_each(clicon_conf_xml(h), x, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(x), "CLICON_YANG_DIR") != 0 &&
+            strcmp(xml_name(x), "CLICON_YANG_MAIN_DIR") != 0)
+            continue;
+        if ((dir = xml_body(x)) == NULL || cvec_find(cvv, dir) != NULL)
+            continue;
+        if (cvec_add_string(cvv, dir, NULL) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (str)
+        free(str);
+    return retval;
+}
+
+/*
+ * Encoding
+ */
+
+/*! Append a 32-bit integer in network byte order
+ */
+static int
+yc_put32(cbuf    *cb,
+         uint32_t u)
+{
+    uint32_t n = htonl(u);
+
+    if (cbuf_append_buf(cb, &n, sizeof(n)) < 0){
+        clicon_err(OE_YANG, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Append a 64-bit integer as two 32-bit integers, high first
+ */
+static int
+yc_put64(cbuf    *cb,
+         uint64_t u)
+{
+    if (yc_put32(cb, u >> 32) < 0 ||
+        yc_put32(cb, u & 0xffffffff) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Append a length-prefixed and null-terminated string, or NULL
+ */
+static int
+yc_putstr(cbuf       *cb,
+          const char *str)
+{
+    size_t len;
+
+    if (str == NULL)
+        return yc_put32(cb, 0);
+    len = strlen(str);
+    if (yc_put32(cb, len+1) < 0)
+        return -1;
+    if (cbuf_append_buf(cb, (void*)str, len+1) < 0){
+        clicon_err(OE_YANG, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+static int
+yang_cache_ref_cmp(const void *a,
+                   const void *b)
+{
+    const struct yang_cache_ref *ra = a;
+    const struct yang_cache_ref *rb = b;
+
+    if ((uintptr_t)ra->yr_ptr != (uintptr_t)rb->yr_ptr)
+        return (uintptr_t)ra->yr_ptr < (uintptr_t)rb->yr_ptr ? -1 : 1;
+    if (ra->yr_i != rb->yr_i) /* Same type cache: first statement first */
+        return ra->yr_i < rb->yr_i ? -1 : 1;
+    return 0;
+}
+
+/*! Compare pointer only, for bsearch
+ */
+static int
+yang_cache_ptr_cmp(const void *a,
+                   const void *b)
+{
+    const struct yang_cache_ref *ra = a;
+    const struct yang_cache_ref *rb = b;
+
+    if ((uintptr_t)ra->yr_ptr < (uintptr_t)rb->yr_ptr)
+        return -1;
+    return (uintptr_t)ra->yr_ptr > (uintptr_t)rb->yr_ptr;
+}
+
+/*! Add a pointer and preorder index to a reference vector
+ */
+static int
+yang_cache_ref_add(struct yang_cache_ref **refsp,
+                   uint32_t               *nrp,
+                   size_t                 *maxp,
+                   void                   *ptr,
+                   uint32_t                i)
+{
+    if (*nrp == *maxp){
+        *maxp = *maxp ? 2 * *maxp : 1024;
+        if ((*refsp = realloc(*refsp, *maxp*sizeof(**refsp))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+    }
+    (*refsp)[*nrp].yr_ptr = ptr;
+    (*refsp)[*nrp].yr_i = i;
+    (*nrp)++;
+    return 0;
+}
+
+/*! Add statements and type caches of a yang tree to reference vectors in preorder
+ */
+static int
+yang_cache_refs(struct yang_cache_enc *ye,
+                yang_stmt             *ys,
+                size_t                *maxp,
+                size_t                *maxtcp)
+{
+    int i;
+
+    if (ys->ys_typecache &&
+        yang_cache_ref_add(&ye->ye_tcs, &ye->ye_ntc, maxtcp, ys->ys_typecache, ye->ye_nr) < 0)
+        return -1;
+    if (yang_cache_ref_add(&ye->ye_refs, &ye->ye_nr, maxp, ys, ye->ye_nr) < 0)
+        return -1;
+    for (i=0; i<ys->ys_len; i++)
+        if (yang_cache_refs(ye, ys->ys_stmt[i], maxp, maxtcp) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Get preorder index of a statement
+ *
+ * @retval     1    OK
+ * @retval     0    Not a statement in the tree
+ */
+static int
+yang_cache_index(struct yang_cache_enc *ye,
+                 yang_stmt             *ys,
+                 uint32_t              *ip)
+{
+    struct yang_cache_ref  key;
+    struct yang_cache_ref *yr;
+
+    key.yr_ptr = ys;
+    if ((yr = bsearch(&key, ye->ye_refs, ye->ye_nr, sizeof(key), yang_cache_ptr_cmp)) == NULL)
+        return 0;
+    *ip = yr->yr_i;
+    return 1;
+}
+
+/*! Append a reference to a statement as its preorder index
+ *
+ * @retval     1    OK
+ * @retval     0    Not a statement in the tree, cannot be encoded
+ * @retval    -1    Error
+ */
+static int
+yc_putref(struct yang_cache_enc *ye,
+          yang_stmt             *ys)
+{
+    uint32_t i;
+
+    if (ys == NULL)
+        return yc_put32(ye->ye_cb, YANG_CACHE_NONE) < 0 ? -1 : 1;
+    if (yang_cache_index(ye, ys, &i) == 0)
+        return 0;
+    return yc_put32(ye->ye_cb, i) < 0 ? -1 : 1;
+}
+
+/*! Append a cligen variable
+ *
+ * @retval     1    OK
+ * @retval     0    Void pointer not to a statement in the tree, cannot be encoded
+ * @retval    -1    Error
+ */
+static int
+yc_putcv(struct yang_cache_enc *ye,
+         cg_var                *cv)
+{
+    int          retval = -1;
+    enum cv_type type = cv_type_get(cv);
+    uint32_t     flags = 0;
+    char        *str = NULL;
+    int          ret;
+
+    if (cv_flag(cv, V_UNSET))
+        flags |= YC_CV_UNSET;
+    if (cv_flag(cv, V_INVERT))
+        flags |= YC_CV_INVERT;
+    if (yc_put32(ye->ye_cb, type) < 0 ||
+        yc_put32(ye->ye_cb, flags) < 0 ||
+        yc_putstr(ye->ye_cb, cv_name_get(cv)) < 0)
+        goto done;
+    if (type == CGV_VOID){
+        if ((ret = yc_putref(ye, cv_void_get(cv))) <= 0){
+            retval = ret;
+            goto done;
+        }
+    }
+    else if ((flags & YC_CV_UNSET) == 0){
+        if (type == CGV_DEC64 &&
+            yc_put32(ye->ye_cb, cv_dec64_n_get(cv)) < 0)
+            goto done;
+        str = cv2str_dup(cv);
+        if (yc_putstr(ye->ye_cb, str) < 0)
+            goto done;
+    }
+    retval = 1;
+ done:
+    if (str)
+        free(str);
+    return retval;
+}
+
+/*! Append a cligen variable vector
+ *
+ * @retval     1    OK
+ * @retval     0    Cannot be encoded
+ * @retval    -1    Error
+ */
+static int
+yc_putcvec(struct yang_cache_enc *ye,
+           cvec                  *cvv)
+{
+    cg_var *cv = NULL;
+    int     ret;
+
+    if (yc_put32(ye->ye_cb, cvec_len(cvv)) < 0)
+        return -1;
+    while ((cv = cvec_each(cvv, cv)) != NULL)
+        if ((ret = yc_putcv(ye, cv)) <= 0)
+            return ret;
+    return 1;
+}
+
+/*! Append a yang statement and its children recursively
+ *
+ * @retval     1    OK
+ * @retval     0    Cannot be encoded, eg a mounted yang spec
+ * @retval    -1    Error
+ */
+static int
+yang_cache_encode(struct yang_cache_enc *ye,
+                  yang_stmt             *ys)
+{
+    cbuf                  *cb = ye->ye_cb;
+    yang_type_cache       *yc;
+    struct yang_cache_ref  key;
+    struct yang_cache_ref *tc = NULL;
+    uint32_t               mask = 0;
+    uint32_t               self;
+    int                    ret;
+    int                    i;
+
+    if (ys->ys_cv)
+        mask |= YC_CV;
+    if (ys->ys_cvec)
+        mask |= YC_CVEC;
+    if ((yc = ys->ys_typecache) != NULL){
+        /* First statement of a shared type cache encodes it, the others refer to it */
+        key.yr_ptr = yc;
+        if ((tc = bsearch(&key, ye->ye_tcs, ye->ye_ntc, sizeof(key), yang_cache_ptr_cmp)) == NULL ||
+            yang_cache_index(ye, ys, &self) == 0)
+            return 0;
+        mask |= tc->yr_i == self ? YC_TYPECACHE : YC_TYPEREF;
+    }
+    if (ys->ys_keycmp)
+        mask |= YC_KEYCMP;
+    if (ys->ys_when_xpath)
+        mask |= YC_WHENXPATH;
+    if (ys->ys_when_nsc)
+        mask |= YC_WHENNSC;
+    if (yc_put32(cb, ys->ys_keyword) < 0 ||
+        yc_put32(cb, ys->ys_flags) < 0 ||
+        yc_putstr(cb, ys->ys_argument) < 0)
+        return -1;
+    if ((ret = yc_putref(ye, ys->ys_mymodule)) <= 0)
+        return ret;
+    if (yc_putstr(cb, ys->ys_filename) < 0 ||
+        yc_put32(cb, ys->ys_linenum) < 0 ||
+        yc_put32(cb, mask) < 0)
+        return -1;
+    if ((mask & YC_CV) && (ret = yc_putcv(ye, ys->ys_cv)) <= 0)
+        return ret;
+    if ((mask & YC_CVEC) && (ret = yc_putcvec(ye, ys->ys_cvec)) <= 0)
+        return ret;
+    if ((mask & YC_TYPEREF) && yc_put32(cb, tc->yr_i) < 0)
+        return -1;
+    if (mask & YC_TYPECACHE){
+        if (yc_put32(cb, yc->yc_options) < 0 ||
+            yc_put32(cb, yc->yc_cvv != NULL) < 0)
+            return -1;
+        if (yc->yc_cvv && (ret = yc_putcvec(ye, yc->yc_cvv)) <= 0)
+            return ret;
+        if (yc_put32(cb, yc->yc_patterns != NULL) < 0)
+            return -1;
+        if (yc->yc_patterns && (ret = yc_putcvec(ye, yc->yc_patterns)) <= 0)
+            return ret;
+        if (yc_put32(cb, yc->yc_fraction) < 0)
+            return -1;
+        if ((ret = yc_putref(ye, yc->yc_resolved)) <= 0)
+            return ret;
+    }
+    if (ys->ys_keycmp){
+        if (yc_put32(cb, ys->ys_keycmp->yk_len) < 0)
+            return -1;
+        for (i=0; i<ys->ys_keycmp->yk_len; i++)
+            if (yc_putstr(cb, ys->ys_keycmp->yk_keys[i].yk_name) < 0 ||
+                yc_put32(cb, ys->ys_keycmp->yk_keys[i].yk_class) < 0)
+                return -1;
+    }
+    if ((mask & YC_WHENXPATH) && yc_putstr(cb, ys->ys_when_xpath) < 0)
+        return -1;
+    if ((mask & YC_WHENNSC) && (ret = yc_putcvec(ye, ys->ys_when_nsc)) <= 0)
+        return ret;
+    if (yc_put32(cb, ys->ys_len) < 0)
+        return -1;
+    for (i=0; i<ys->ys_len; i++)
+        if ((ret = yang_cache_encode(ye, ys->ys_stmt[i])) <= 0)
+            return ret;
+    return 1;
+}
+
+/*
+ * Decoding
+ */
+
+/*! Get a 32-bit integer in network byte order with bounds check
+ */
+static int
+yc_get32(struct yang_cache_dec *yd,
+         uint32_t              *up)
+{
+    uint32_t n;
+
+    if (yd->yd_pos + sizeof(n) > yd->yd_len){
+        clicon_err(OE_YANG, EFAULT, "Yang cache truncated at %zu", yd->yd_pos);
+        return -1;
+    }
+    memcpy(&n, yd->yd_buf + yd->yd_pos, sizeof(n));
+    *up = ntohl(n);
+    yd->yd_pos += sizeof(n);
+    return 0;
+}
+
+/*! Get a 64-bit integer encoded as two 32-bit integers
+ */
+static int
+yc_get64(struct yang_cache_dec *yd,
+         uint64_t              *up)
+{
+    uint32_t hi;
+    uint32_t lo;
+
+    if (yc_get32(yd, &hi) < 0 ||
+        yc_get32(yd, &lo) < 0)
+        return -1;
+    *up = ((uint64_t)hi << 32) | lo;
+    return 0;
+}
+
+/*! Get a length-prefixed and null-terminated string, pointing into the mapped file
+ *
+ * @param[in]  yd   Decoder state
+ * @param[out] sp   Pointer to string in mapped file, or NULL
+ */
+static int
+yc_getstr(struct yang_cache_dec *yd,
+          const char           **sp)
+{
+    uint32_t len;
+
+    if (yc_get32(yd, &len) < 0)
+        return -1;
+    if (len == 0){
+        *sp = NULL;
+        return 0;
+    }
+    if (len > yd->yd_len - yd->yd_pos || yd->yd_buf[yd->yd_pos + len - 1] != '\0'){
+        clicon_err(OE_YANG, EFAULT, "Yang cache malformed string at %zu", yd->yd_pos);
+        return -1;
+    }
+    *sp = yd->yd_buf + yd->yd_pos;
+    yd->yd_pos += len;
+    return 0;
+}
+
+/*! Get a string and copy it
+ */
+static int
+yc_getstrdup(struct yang_cache_dec *yd,
+             char                 **sp)
+{
+    const char *s;
+
+    if (yc_getstr(yd, &s) < 0)
+        return -1;
+    if (s == NULL)
+        *sp = NULL;
+    else if ((*sp = strdup(s)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Get a reference to a decoded or not yet decoded statement
+ */
+static int
+yc_getref(struct yang_cache_dec *yd,
+          yang_stmt            **ysp)
+{
+    uint32_t i;
+
+    if (yc_get32(yd, &i) < 0)
+        return -1;
+    if (i == YANG_CACHE_NONE)
+        *ysp = NULL;
+    else if (i < yd->yd_nr)
+        *ysp = yd->yd_vec[i];
+    else {
+        clicon_err(OE_YANG, EFAULT, "Yang cache malformed reference %u", i);
+        return -1;
+    }
+    return 0;
+}
+
+/*! Get the value of a cligen variable, created with its type
+ */
+static int
+yc_getcv(struct yang_cache_dec *yd,
+         cg_var                *cv)
+{
+    uint32_t    flags;
+    uint32_t    n;
+    const char *name;
+    const char *str;
+    yang_stmt  *ys;
+    char       *reason = NULL;
+    int         ret;
+
+    if (yc_get32(yd, &flags) < 0 ||
+        yc_getstr(yd, &name) < 0)
+        return -1;
+    if (name && cv_name_set(cv, name) == NULL){
+        clicon_err(OE_UNIX, errno, "cv_name_set");
+        return -1;
+    }
+    if (flags & YC_CV_UNSET)
+        cv_flag_set(cv, V_UNSET);
+    if (flags & YC_CV_INVERT)
+        cv_flag_set(cv, V_INVERT);
+    if (cv_type_get(cv) == CGV_VOID){
+        if (yc_getref(yd, &ys) < 0)
+            return -1;
+        cv_void_set(cv, ys);
+    }
+    else if ((flags & YC_CV_UNSET) == 0){
+        if (cv_type_get(cv) == CGV_DEC64){
+            if (yc_get32(yd, &n) < 0)
+                return -1;
+            cv_dec64_n_set(cv, n);
+        }
+        if (yc_getstr(yd, &str) < 0)
+            return -1;
+        if (str != NULL){
+            if ((ret = cv_parse1(str, cv, &reason)) < 0){
+                clicon_err(OE_YANG, errno, "cv_parse1");
+                return -1;
+            }
+            if (ret == 0){
+                clicon_err(OE_YANG, EFAULT, "Yang cache malformed value %s: %s", str, reason);
+                free(reason);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*! Get a cligen variable vector
+ */
+static int
+yc_getcvec(struct yang_cache_dec *yd,
+           cvec                 **cvvp)
+{
+    cvec    *cvv;
+    cg_var  *cv;
+    uint32_t len;
+    uint32_t type;
+    uint32_t i;
+
+    if (yc_get32(yd, &len) < 0)
+        return -1;
+    if ((cvv = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        return -1;
+    }
+    *cvvp = cvv;
+    for (i=0; i<len; i++){
+        if (yc_get32(yd, &type) < 0)
+            return -1;
+        if ((cv = cvec_add(cvv, type)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_add");
+            return -1;
+        }
+        if (yc_getcv(yd, cv) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Decode a yang statement and its children recursively
+ *
+ * @param[in]  yd   Decoder state
+ * @param[in]  yp   Parent, the statement is added as its last child
+ * @retval     0    OK
+ * @retval    -1    Error, eg malformed file
+ */
+static int
+yang_cache_decode(struct yang_cache_dec *yd,
+                  yang_stmt             *yp)
+{
+    yang_stmt       *ys;
+    yang_stmt       *yr;
+    yang_type_cache *yc;
+    yang_keycmp     *yk;
+    uint32_t         u;
+    uint32_t         mask;
+    uint32_t         len;
+    uint32_t         i;
+    const char      *name;
+
+    if (yd->yd_next >= yd->yd_nr){
+        clicon_err(OE_YANG, EFAULT, "Yang cache malformed, too many statements");
+        return -1;
+    }
+    ys = yd->yd_vec[yd->yd_next++];
+    if (yn_insert(yp, ys) < 0)
+        return -1;
+    if (yc_get32(yd, &u) < 0)
+        return -1;
+    ys->ys_keyword = u;
+    if (yc_get32(yd, &u) < 0)
+        return -1;
+    ys->ys_flags = u;
+    if (ys->ys_flags & YANG_FLAG_ARG_INTERN){
+        if (yc_getstr(yd, &name) < 0)
+            return -1;
+        if (name == NULL)
+            ys->ys_flags &= ~YANG_FLAG_ARG_INTERN;
+        else if ((ys->ys_argument = clixon_string_intern(name)) == NULL)
+            return -1;
+    }
+    else if (yc_getstrdup(yd, &ys->ys_argument) < 0)
+        return -1;
+    if (yc_getref(yd, &ys->ys_mymodule) < 0 ||
+        yc_getstrdup(yd, &ys->ys_filename) < 0 ||
+        yc_get32(yd, &u) < 0)
+        return -1;
+    ys->ys_linenum = u;
+    if (yc_get32(yd, &mask) < 0)
+        return -1;
+    if ((mask & ~YC_MASK) || (mask & YC_TYPECACHE && mask & YC_TYPEREF)){
+        clicon_err(OE_YANG, EFAULT, "Yang cache malformed mask 0x%x", mask);
+        return -1;
+    }
+    if (mask & YC_CV){
+        if (yc_get32(yd, &u) < 0)
+            return -1;
+        if ((ys->ys_cv = cv_new(u)) == NULL){
+            clicon_err(OE_UNIX, errno, "cv_new");
+            return -1;
+        }
+        if (yc_getcv(yd, ys->ys_cv) < 0)
+            return -1;
+    }
+    if ((mask & YC_CVEC) && yc_getcvec(yd, &ys->ys_cvec) < 0)
+        return -1;
+    if (mask & YC_TYPEREF){
+        if (yc_getref(yd, &yr) < 0)
+            return -1;
+        if (yr == NULL || yr == ys || yr->ys_typecache == NULL){
+            clicon_err(OE_YANG, EFAULT, "Yang cache malformed type cache reference");
+            return -1;
+        }
+        ys->ys_typecache = yr->ys_typecache;
+        ys->ys_typecache->yc_refcnt++;
+    }
+    if (mask & YC_TYPECACHE){
+        if ((yc = calloc(1, sizeof(*yc))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        yc->yc_refcnt = 1;
+        ys->ys_typecache = yc;
+        if (yc_get32(yd, &u) < 0)
+            return -1;
+        yc->yc_options = u;
+        if (yc_get32(yd, &u) < 0)
+            return -1;
+        if (u && yc_getcvec(yd, &yc->yc_cvv) < 0)
+            return -1;
+        if (yc_get32(yd, &u) < 0)
+            return -1;
+        if (u && yc_getcvec(yd, &yc->yc_patterns) < 0)
+            return -1;
+        if (yc_get32(yd, &u) < 0)
+            return -1;
+        yc->yc_fraction = u;
+        if (yc_getref(yd, &yc->yc_resolved) < 0)
+            return -1;
+    }
+    if (mask & YC_KEYCMP){
+        if (yc_get32(yd, &len) < 0)
+            return -1;
+        if (len > yd->yd_len){
+            clicon_err(OE_YANG, EFAULT, "Yang cache malformed key comparator");
+            return -1;
+        }
+        if ((yk = calloc(1, sizeof(*yk) + len*sizeof(yk->yk_keys[0]))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        ys->ys_keycmp = yk;
+        for (i=0; i<len; i++){
+            if (yc_getstr(yd, &name) < 0 ||
+                yc_get32(yd, &u) < 0)
+                return -1;
+            if (name && (yk->yk_keys[i].yk_name = clixon_string_intern(name)) == NULL)
+                return -1;
+            yk->yk_keys[i].yk_class = u;
+            yk->yk_len++;
+        }
+    }
+    if ((mask & YC_WHENXPATH) && yc_getstrdup(yd, &ys->ys_when_xpath) < 0)
+        return -1;
+    if ((mask & YC_WHENNSC) && yc_getcvec(yd, &ys->ys_when_nsc) < 0)
+        return -1;
+    if (yc_get32(yd, &len) < 0)
+        return -1;
+    for (i=0; i<len; i++)
+        if (yang_cache_decode(yd, ys) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Check that module files and directories of a cache file are unchanged
+ *
+ * @param[in]  yd   Decoder state, positioned at file list
+ * @retval     1    Valid
+ * @retval     0    Stale
+ * @retval    -1    Error
+ */
+static int
+yang_cache_check(struct yang_cache_dec *yd)
+{
+    uint32_t    n;
+    uint32_t    i;
+    const char *path;
+    uint64_t    size;
+    uint64_t    hash;
+    uint64_t    size1;
+    uint64_t    hash1;
+    uint64_t    sec;
+    uint32_t    nsec;
+    struct stat st;
+    int         ret;
+
+    if (yc_get32(yd, &n) < 0)
+        return -1;
+    for (i=0; i<n; i++){
+        if (yc_getstr(yd, &path) < 0 ||
+            yc_get64(yd, &size) < 0 ||
+            yc_get64(yd, &hash) < 0)
+            return -1;
+        if (path == NULL)
+            return 0;
+        if (stat(path, &st) < 0 || st.st_size != size)
+            return 0;
+        if ((ret = yang_cache_file_hash(path, &size1, &hash1)) <= 0)
+            return ret;
+        if (size1 != size || hash1 != hash)
+            return 0;
+    }
+    if (yc_get32(yd, &n) < 0)
+        return -1;
+    for (i=0; i<n; i++){
+        if (yc_getstr(yd, &path) < 0 ||
+            yc_get64(yd, &sec) < 0 ||
+            yc_get32(yd, &nsec) < 0)
+            return -1;
+        if (path == NULL || stat(path, &st) < 0)
+            return 0;
+        if (st.st_mtim.tv_sec != sec || st.st_mtim.tv_nsec != nsec)
+            return 0;
+    }
+    return 1;
+}
+
+/*! Load yang spec of a daemon from its cache file, if valid
+ *
+ * Call before the yang modules are loaded. If the spec is loaded, the following calls
+ * that load yang modules find them already loaded. If not, call yang_spec_cache_save()
+ * after the yang modules are loaded.
+ * @param[in]  h      Clixon handle
+ * @param[in]  name   Name of daemon, eg "backend", also name of cache file
+ * @param[in]  yspec  Empty yang spec
+ * @retval     1      Yang spec loaded from cache
+ * @retval     0      No cache, or cache is stale or malformed: load yang modules
+ * @retval    -1      Error
+ * @see yang_spec_cache_save
+ */
+int
+yang_spec_cache_load(clicon_handle h,
+                     const char   *name,
+                     yang_stmt    *yspec)
+{
+    int                   retval = -1;
+    cbuf                 *cb = NULL;
+    int                   fd = -1;
+    struct stat           st;
+    void                 *buf = MAP_FAILED;
+    struct yang_cache_dec yd = {0,};
+    uint64_t              key;
+    uint64_t              key1;
+    uint32_t              u;
+    uint32_t              i;
+    char                  keystr[32];
+    int                   ret;
+
+    if (yang_len_get(yspec) != 0){
+        clicon_err(OE_YANG, EINVAL, "yang spec is not empty");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (yang_cache_filename(h, name, cb) == 0)
+        goto stale;
+    if (yang_cache_key(h, name, &key) < 0)
+        goto done;
+    /* Save key for yang_spec_cache_save, options may change during loading */
+    snprintf(keystr, sizeof(keystr), "%016llx", (unsigned long long)key);
+    if (clicon_data_set(h, YANG_CACHE_KEY, keystr) < 0)
+        goto done;
+    if ((fd = open(cbuf_get(cb), O_RDONLY)) < 0)
+        goto stale;
+    if (fstat(fd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat");
+        goto done;
+    }
+    if (st.st_size < 12)
+        goto stale;
+    if ((buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED){
+        clicon_err(OE_UNIX, errno, "mmap");
+        goto done;
+    }
+    yd.yd_buf = buf;
+    yd.yd_len = st.st_size;
+    if (memcmp(yd.yd_buf, YANG_CACHE_MAGIC, 4) != 0)
+        goto stale;
+    yd.yd_pos = 4;
+    if (yc_get32(&yd, &u) < 0 || u != YANG_CACHE_VERSION)
+        goto malformed;
+    if (yc_get64(&yd, &key1) < 0)
+        goto malformed;
+    if (key1 != key)
+        goto stale;
+    if ((ret = yang_cache_check(&yd)) < 0)
+        goto malformed;
+    if (ret == 0)
+        goto stale;
+    if (yc_get32(&yd, &yd.yd_nr) < 0 ||
+        yc_get32(&yd, &u) < 0)
+        goto malformed;
+    if (yd.yd_nr == 0 || yd.yd_nr > yd.yd_len){
+        clicon_err(OE_YANG, EFAULT, "Yang cache malformed statement count");
+        goto malformed;
+    }
+    /* Create all statements first, so that references can be resolved while decoding */
+    if ((yd.yd_vec = calloc(yd.yd_nr, sizeof(yang_stmt *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    yd.yd_vec[0] = yspec;
+    for (i=1; i<yd.yd_nr; i++)
+        if ((yd.yd_vec[i] = ys_new(Y_SPEC)) == NULL)
+            goto done;
+    yd.yd_next = 1;
+    for (i=0; i<u; i++)
+        if (yang_cache_decode(&yd, yspec) < 0)
+            goto malformed;
+    if (yd.yd_next != yd.yd_nr || yd.yd_pos != yd.yd_len){
+        clicon_err(OE_YANG, EFAULT, "Yang cache malformed, trailing data");
+        goto malformed;
+    }
+    free(yd.yd_vec);
+    yd.yd_vec = NULL;
+#ifdef YANG_INDEX
+    if (yang_index_build(yspec) < 0)
+        goto done;
+#endif
+    clicon_debug(1, "%s loaded %s", __FUNCTION__, cbuf_get(cb));
+    retval = 1;
+ done:
+    if (yd.yd_vec){ /* Free statements of a partially decoded spec */
+        for (i=1; i<yd.yd_nr; i++)
+            if (yd.yd_vec[i])
+                ys_free1(yd.yd_vec[i], 1);
+        if (yspec->ys_stmt){
+            free(yspec->ys_stmt);
+            yspec->ys_stmt = NULL;
+        }
+        yspec->ys_len = 0;
+        free(yd.yd_vec);
+    }
+    if (buf != MAP_FAILED)
+        munmap(buf, st.st_size);
+    if (fd != -1)
+        close(fd);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ malformed:
+    clicon_log(LOG_WARNING, "%s: %s: %s, parsing yang modules", __FUNCTION__,
+               cbuf_get(cb), clicon_err_reason);
+    clicon_err_reset();
+ stale:
+    retval = 0;
+    goto done;
+}
+
+/*! Save yang spec of a daemon to its cache file
+ *
+ * Call after the yang modules are loaded, if yang_spec_cache_load returned 0.
+ * A yang spec that cannot be encoded, eg with mounted yang specs, is not saved. Neither is
+ * it if the cache file cannot be written, only a warning is logged.
+ * @param[in]  h      Clixon handle
+ * @param[in]  name   Name of daemon, same as in yang_spec_cache_load
+ * @param[in]  yspec  Yang spec
+ * @retval     0      OK, saved or not
+ * @retval    -1      Error
+ * @see yang_spec_cache_load
+ */
+int
+yang_spec_cache_save(clicon_handle h,
+                     const char   *name,
+                     yang_stmt    *yspec)
+{
+    int                   retval = -1;
+    cbuf                 *cbf = NULL;
+    cbuf                 *cbt = NULL;
+    struct yang_cache_enc ye = {0,};
+    size_t                max = 0;
+    size_t                maxtc = 0;
+    uint32_t              j;
+    uint32_t              k;
+    char                 *keystr = NULL;
+    uint64_t              key;
+    uint64_t              size;
+    uint64_t              hash;
+    yang_stmt            *ym;
+    const char           *filename;
+    cvec                 *dirs = NULL;
+    cg_var               *cv;
+    struct stat           st;
+    FILE                 *f = NULL;
+    int                   ret;
+    int                   i;
+
+    if ((cbf = cbuf_new()) == NULL ||
+        (cbt = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (yang_cache_filename(h, name, cbf) == 0)
+        goto ok;
+    if (clicon_data_get(h, YANG_CACHE_KEY, &keystr) < 0 || keystr == NULL)
+        goto ok; /* yang_spec_cache_load not called */
+    key = strtoull(keystr, NULL, 16);
+    if ((ye.ye_cb = cbuf_new_alloc(1024*1024)) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
+        goto done;
+    }
+    if (cbuf_append_buf(ye.ye_cb, YANG_CACHE_MAGIC, 4) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        goto done;
+    }
+    if (yc_put32(ye.ye_cb, YANG_CACHE_VERSION) < 0 ||
+        yc_put64(ye.ye_cb, key) < 0)
+        goto done;
+    /* Module files */
+    if (yc_put32(ye.ye_cb, yang_len_get(yspec)) < 0)
+        goto done;
+    ym = NULL;
+    while ((ym = yn_each(yspec, ym)) != NULL){
+        if ((filename = yang_filename_get(ym)) == NULL){
+            clicon_debug(1, "%s %s has no file, not cached", __FUNCTION__, yang_argument_get(ym));
+            goto ok;
+        }
+        if ((ret = yang_cache_file_hash(filename, &size, &hash)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+        if (yc_putstr(ye.ye_cb, filename) < 0 ||
+            yc_put64(ye.ye_cb, size) < 0 ||
+            yc_put64(ye.ye_cb, hash) < 0)
+            goto done;
+    }
+    /* Directories */
+    if ((dirs = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if (yang_cache_dirs(h, yspec, dirs) < 0)
+        goto done;
+    if (yc_put32(ye.ye_cb, cvec_len(dirs)) < 0)
+        goto done;
+    cv = NULL;
+    while ((cv = cvec_each(dirs, cv)) != NULL){
+        if (stat(cv_name_get(cv), &st) < 0)
+            goto ok;
+        if (yc_putstr(ye.ye_cb, cv_name_get(cv)) < 0 ||
+            yc_put64(ye.ye_cb, st.st_mtim.tv_sec) < 0 ||
+            yc_put32(ye.ye_cb, st.st_mtim.tv_nsec) < 0)
+            goto done;
+    }
+    /* Statements */
+    if (yang_cache_refs(&ye, yspec, &max, &maxtc) < 0)
+        goto done;
+    qsort(ye.ye_refs, ye.ye_nr, sizeof(*ye.ye_refs), yang_cache_ref_cmp);
+    if (ye.ye_ntc){
+        /* Keep the first statement of each type cache */
+        qsort(ye.ye_tcs, ye.ye_ntc, sizeof(*ye.ye_tcs), yang_cache_ref_cmp);
+        for (j=1, k=0; j<ye.ye_ntc; j++)
+            if (ye.ye_tcs[j].yr_ptr != ye.ye_tcs[k].yr_ptr)
+                ye.ye_tcs[++k] = ye.ye_tcs[j];
+        ye.ye_ntc = k + 1;
+    }
+    if (yc_put32(ye.ye_cb, ye.ye_nr) < 0 ||
+        yc_put32(ye.ye_cb, yspec->ys_len) < 0)
+        goto done;
+    for (i=0; i<yspec->ys_len; i++){
+        if ((ret = yang_cache_encode(&ye, yspec->ys_stmt[i])) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_debug(1, "%s reference outside yang spec, not cached", __FUNCTION__);
+            goto ok;
+        }
+    }
+    /* Write to temporary file and rename, so that readers see a complete file */
+    cprintf(cbt, "%s.%d", cbuf_get(cbf), getpid());
+    if ((f = fopen(cbuf_get(cbt), "w")) == NULL){
+        clicon_log(LOG_WARNING, "%s: %s: %s", __FUNCTION__, cbuf_get(cbt), strerror(errno));
+        goto ok;
+    }
+    if (fwrite(cbuf_get(ye.ye_cb), 1, cbuf_len(ye.ye_cb), f) != cbuf_len(ye.ye_cb) ||
+        fclose(f) != 0){
+        f = NULL;
+        clicon_log(LOG_WARNING, "%s: %s: %s", __FUNCTION__, cbuf_get(cbt), strerror(errno));
+        unlink(cbuf_get(cbt));
+        goto ok;
+    }
+    f = NULL;
+    if (rename(cbuf_get(cbt), cbuf_get(cbf)) < 0){
+        clicon_log(LOG_WARNING, "%s: %s: %s", __FUNCTION__, cbuf_get(cbf), strerror(errno));
+        unlink(cbuf_get(cbt));
+        goto ok;
+    }
+    clicon_debug(1, "%s saved %s", __FUNCTION__, cbuf_get(cbf));
+ ok:
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (dirs)
+        cvec_free(dirs);
+    if (ye.ye_tcs)
+        free(ye.ye_tcs);
+    if (ye.ye_refs)
+        free(ye.ye_refs);
+    if (ye.ye_cb)
+        cbuf_free(ye.ye_cb);
+    if (cbt)
+        cbuf_free(cbt);
+    if (cbf)
+        cbuf_free(cbf);
+    return retval;
+}
+
+/*! Compute a hash of the sources of a loaded yang spec, for caches of data derived from it
+ *
+ * The hash covers the cache key of the daemon, ie options, config and plugins, and the
+ * name, size and content of all module files.
+ * @param[in]  h      Clixon handle
+ * @param[in]  name   Name of daemon, same as in yang_spec_cache_load
+ * @param[in]  yspec  Yang spec
+ * @param[out] hashp  Hash
+ * @retval     1      OK
+ * @retval     0      A module has no file, eg a mounted yang spec, no hash
+ * @retval    -1      Error
+ */
+int
+yang_spec_cache_hash(clicon_handle h,
+                     const char   *name,
+                     yang_stmt    *yspec,
+                     uint64_t     *hashp)
+{
+    char       *keystr = NULL;
+    uint64_t    k;
+    uint64_t    size;
+    uint64_t    hash;
+    yang_stmt  *ym;
+    const char *filename;
+    int         ret;
+
+    /* Key computed at load if any, since options may change during loading */
+    if (clicon_data_get(h, YANG_CACHE_KEY, &keystr) == 0 && keystr != NULL)
+        k = yang_cache_hash_str(14695981039346656037ULL, keystr);
+    else if (yang_cache_key(h, name, &k) < 0)
+        return -1;
+    ym = NULL;
+    while ((ym = yn_each(yspec, ym)) != NULL){
+        if ((filename = yang_filename_get(ym)) == NULL)
+            return 0;
+        if ((ret = yang_cache_file_hash(filename, &size, &hash)) < 0)
+            return -1;
+        if (ret == 0)
+            return 0;
+        k = yang_cache_hash_str(k, filename);
+        k = yang_cache_hash(k, &size, sizeof(size));
+        k = yang_cache_hash(k, &hash, sizeof(hash));
+    }
+    *hashp = k;
+    return 1;
+}
@@ -0,0 +1,491 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2020-2023 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Hash index of YANG child statements
+ *
+ * yang_find(), yang_find_datanode() and yang_find_schemanode() otherwise scan the child
+ * vector and compare the argument of each child, and the two latter also descend into
+ * choice and case. This is made on every bind, api-path and xpath yang step.
+ * The index of a statement maps, in one hash table:
+ * - (keyword, argument) of each child, for yang_find
+ * - name of each data node found by yang_find_datanode, through choice, case, input
+ *   and output
+ * - name of each schema node found by yang_find_schemanode, through choice and case
+ * - of an identity: the derived identities, for identityref validation and derived-from()
+ * - of the yang spec: namespace and prefix of each module, for
+ *   yang_find_module_by_namespace and yang_find_module_by_prefix_yspec
+ * The entries of a name are chained in child order, so a lookup returns the same
+ * (first) match as the linear scan. Submodule includes are not indexed, but searched
+ * by the callers as before if there is no match.
+ *
+ * Indexes are built after yang_parse_post() for statements with at least
+ * YANG_INDEX_THRESHOLD entries. Lookups only read the index, so they can be made in
+ * parallel. A change of the children of a statement drops its index, and the index of
+ * the choice/case/input/output ancestors whose lookups descend into it. Lookups then
+ * scan linearly until the index is built again after the next yang_parse_post().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/param.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_yang_type.h"
+#include "clixon_xml_map.h"
+#include "clixon_yang_module.h"
+#include "clixon_plugin.h"
+#include "clixon_yang_internal.h"
+#include "clixon_yang_index.h"
+
+#ifdef YANG_INDEX
+
+/*! An indexed child statement, member of a hash bucket chain
+ */
+struct yang_index_entry{
+    struct yang_index_entry *ye_next;    /* Next entry in same bucket */
+    uint32_t                 ye_hash;    /* Hash value of keyword and name */
+    int                      ye_keyword; /* enum rfc_6020 or YANG_INDEX_DATANODE/SCHEMANODE */
+    const char              *ye_name;    /* Argument, or "input"/"output", not copied */
+    yang_stmt               *ye_ys;      /* Child statement */
+};
+
+/*! Hash index of the children of one yang statement
+ */
+struct yang_index{
+    struct yang_index_entry **yi_bucket; /* Vector of hash buckets */
+    size_t                    yi_size;   /* Number of buckets, power of 2 */
+    struct yang_index_entry  *yi_vec;    /* Vector of entries, in child order */
+    size_t                    yi_nr;     /* Number of entries */
+    size_t                    yi_max;    /* Allocated entries */
+};
+
+/*! Compute hash value of keyword and name (FNV-1a)
+ */
+static uint32_t
+yang_index_hash(int         keyword,
+                const char *name)
+{
+    uint32_t    h = 2166136261U;
+    const char *p;
+
+    for (p = name; *p; p++){
+        h ^= (uint8_t)*p;
+        h *= 16777619U;
+    }
+    h ^= (uint32_t)keyword;
+    h *= 16777619U;
+    return h;
+}
+
+/*! Add entry to index vector, buckets are linked later
+ *
+ * @param[in]  yi       Yang index
+ * @param[in]  keyword  enum rfc_6020 or YANG_INDEX_DATANODE/SCHEMANODE
+ * @param[in]  name     Name, not copied
+ * @param[in]  ys       Child statement
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+yang_index_add(struct yang_index *yi,
+               int                keyword,
+               const char        *name,
+               yang_stmt         *ys)
+{
+    struct yang_index_entry *ye;
+
+    if (name == NULL)
+        return 0;
+    if (yi->yi_nr == yi->yi_max){
+        yi->yi_max = yi->yi_max ? 2*yi->yi_max : 16;
+        if ((yi->yi_vec = realloc(yi->yi_vec, yi->yi_max*sizeof(*ye))) == NULL){
+            clicon_err(OE_YANG, errno, "realloc");
+            return -1;
+        }
+    }
+    ye = &yi->yi_vec[yi->yi_nr++];
+    ye->ye_next = NULL;
+    ye->ye_hash = yang_index_hash(keyword, name);
+    ye->ye_keyword = keyword;
+    ye->ye_name = name;
+    ye->ye_ys = ys;
+    return 0;
+}
+
+/*! Add data nodes found by yang_find_datanode, in the same order
+ *
+ * @param[in]  yi   Yang index
+ * @param[in]  yn   Yang statement, or choice/case/input/output below it
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+yang_index_datanodes(struct yang_index *yi,
+                     yang_stmt         *yn)
+{
+    yang_stmt *ys;
+    yang_stmt *yc;
+    int        i;
+    int        j;
+
+    for (i=0; i<yn->ys_len; i++){
+        ys = yn->ys_stmt[i];
+        if (ys->ys_keyword == Y_CHOICE){
+            for (j=0; j<ys->ys_len; j++){
+                yc = ys->ys_stmt[j];
+                if (yc->ys_keyword == Y_CASE){
+                    if (yang_index_datanodes(yi, yc) < 0)
+                        return -1;
+                }
+                else if (yang_datanode(yc) &&
+                         yang_index_add(yi, YANG_INDEX_DATANODE, yc->ys_argument, yc) < 0)
+                    return -1;
+            }
+        }
+        else if (ys->ys_keyword == Y_INPUT || ys->ys_keyword == Y_OUTPUT){
+            if (yang_index_datanodes(yi, ys) < 0)
+                return -1;
+        }
+        else if (yang_datanode(ys) &&
+                 yang_index_add(yi, YANG_INDEX_DATANODE, ys->ys_argument, ys) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Add schema nodes found by yang_find_schemanode, in the same order
+ *
+ * @param[in]  yi   Yang index
+ * @param[in]  yn   Yang statement, or case below it
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+yang_index_schemanodes(struct yang_index *yi,
+                       yang_stmt         *yn)
+{
+    yang_stmt *ys;
+    yang_stmt *yc;
+    int        i;
+    int        j;
+
+    for (i=0; i<yn->ys_len; i++){
+        ys = yn->ys_stmt[i];
+        if (ys->ys_keyword == Y_CHOICE){
+            if (yang_index_add(yi, YANG_INDEX_SCHEMANODE, ys->ys_argument, ys) < 0)
+                return -1;
+            for (j=0; j<ys->ys_len; j++){
+                yc = ys->ys_stmt[j];
+                if (yc->ys_keyword == Y_CASE){
+                    if (yang_index_schemanodes(yi, yc) < 0)
+                        return -1;
+                }
+                else if (yang_schemanode(yc) &&
+                         yang_index_add(yi, YANG_INDEX_SCHEMANODE, yc->ys_argument, yc) < 0)
+                    return -1;
+            }
+        }
+        else if (yang_schemanode(ys)){
+            if (ys->ys_keyword == Y_INPUT &&
+                yang_index_add(yi, YANG_INDEX_SCHEMANODE, "input", ys) < 0)
+                return -1;
+            if (ys->ys_keyword == Y_OUTPUT &&
+                yang_index_add(yi, YANG_INDEX_SCHEMANODE, "output", ys) < 0)
+                return -1;
+            if (yang_index_add(yi, YANG_INDEX_SCHEMANODE, ys->ys_argument, ys) < 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+/*! Add derived identities, or the namespaces and prefixes of modules
+ *
+ * @param[in]  yi   Yang index
+ * @param[in]  yn   Yang identity or yang spec
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see ys_populate_identity  where the derived identities of an identity are set
+ */
+static int
+yang_index_others(struct yang_index *yi,
+                  yang_stmt         *yn)
+{
+    cg_var    *cv = NULL;
+    yang_stmt *ymod;
+    yang_stmt *yc;
+    int        i;
+
+    switch (yn->ys_keyword){
+    case Y_IDENTITY: /* The base identity is the value: only presence is of interest */
+        if (yn->ys_cvec == NULL)
+            break;
+        while ((cv = cvec_each(yn->ys_cvec, cv)) != NULL)
+            if (yang_index_add(yi, YANG_INDEX_DERIVED, cv_string_get(cv), yn) < 0)
+                return -1;
+        break;
+    case Y_SPEC:
+        for (i=0; i<yn->ys_len; i++){
+            ymod = yn->ys_stmt[i];
+            if ((yc = yang_find(ymod, Y_NAMESPACE, NULL)) != NULL &&
+                yang_index_add(yi, YANG_INDEX_NAMESPACE, yc->ys_argument, ymod) < 0)
+                return -1;
+            if (ymod->ys_keyword == Y_MODULE &&
+                (yc = yang_find(ymod, Y_PREFIX, NULL)) != NULL &&
+                yang_index_add(yi, YANG_INDEX_PREFIX, yc->ys_argument, ymod) < 0)
+                return -1;
+        }
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*! Free a yang index
+ */
+static void
+yang_index_free1(struct yang_index *yi)
+{
+    if (yi->yi_bucket)
+        free(yi->yi_bucket);
+    if (yi->yi_vec)
+        free(yi->yi_vec);
+    free(yi);
+}
+
+/*! Create index of one yang statement, if it has enough entries
+ *
+ * @param[in]  yn   Yang statement
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+yang_index_create(yang_stmt *yn)
+{
+    int                      retval = -1;
+    struct yang_index       *yi = NULL;
+    struct yang_index_entry *ye;
+    size_t                   n;
+    size_t                   ndata;
+    size_t                   nothers;
+    int                      i;
+
+    if ((yi = calloc(1, sizeof(*yi))) == NULL){
+        clicon_err(OE_YANG, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<yn->ys_len; i++)
+        if (yang_index_add(yi, yn->ys_stmt[i]->ys_keyword, yn->ys_stmt[i]->ys_argument,
+                           yn->ys_stmt[i]) < 0)
+            goto done;
+    n = yi->yi_nr;
+    if (yang_index_datanodes(yi, yn) < 0)
+        goto done;
+    ndata = yi->yi_nr - n;
+    n = yi->yi_nr;
+    if (yang_index_others(yi, yn) < 0)
+        goto done;
+    nothers = yi->yi_nr - n;
+    /* Few children, data nodes and others: linear scan is as fast */
+    if (yn->ys_len < YANG_INDEX_THRESHOLD &&
+        ndata < YANG_INDEX_THRESHOLD &&
+        nothers < YANG_INDEX_THRESHOLD)
+        goto ok;
+    if (yang_index_schemanodes(yi, yn) < 0)
+        goto done;
+    for (yi->yi_size = 16; yi->yi_size < yi->yi_nr; yi->yi_size <<= 1)
+        ;
+    if ((yi->yi_bucket = calloc(yi->yi_size, sizeof(*yi->yi_bucket))) == NULL){
+        clicon_err(OE_YANG, errno, "calloc");
+        goto done;
+    }
+    /* Link in reverse so that each chain is in child order and the first match is found */
+    for (n = yi->yi_nr; n > 0; n--){
+        ye = &yi->yi_vec[n-1];
+        ye->ye_next = yi->yi_bucket[ye->ye_hash & (yi->yi_size-1)];
+        yi->yi_bucket[ye->ye_hash & (yi->yi_size-1)] = ye;
+    }
+    yn->ys_index = yi;
+    yi = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (yi)
+        yang_index_free1(yi);
+    return retval;
+}
+
+/*! Look up a child statement in the index of a yang statement
+ *
+ * @param[in]  yn       Yang statement
+ * @param[in]  keyword  enum rfc_6020, or YANG_INDEX_DATANODE or YANG_INDEX_SCHEMANODE
+ * @param[in]  argument Argument or node name
+ * @param[out] ysp      Matching child, or NULL if no match
+ * @retval     1        Statement is indexed, ysp is set
+ * @retval     0        Statement is not indexed, search linearly
+ */
+int
+yang_index_find(yang_stmt  *yn,
+                int         keyword,
+                const char *argument,
+                yang_stmt **ysp)
+{
+    struct yang_index       *yi;
+    struct yang_index_entry *ye;
+    uint32_t                 h;
+
+    if ((yi = yn->ys_index) == NULL)
+        return 0;
+    h = yang_index_hash(keyword, argument);
+    for (ye = yi->yi_bucket[h & (yi->yi_size-1)]; ye; ye = ye->ye_next)
+        if (ye->ye_hash == h &&
+            ye->ye_keyword == keyword &&
+            strcmp(ye->ye_name, argument) == 0)
+            break;
+    *ysp = ye ? ye->ye_ys : NULL;
+    return 1;
+}
+
+/*! Check if an identity is derived from a base identity using the index of the base identity
+ *
+ * @param[in]  ybaseid  Base identity
+ * @param[in]  idref    Identity in canonical form <module>:<id>
+ * @param[out] derived  1 if idref is derived from ybaseid, 0 if not
+ * @retval     1        Base identity is indexed, derived is set
+ * @retval     0        Base identity is not indexed, search the derived identity list
+ */
+int
+yang_index_identity_derived(yang_stmt  *ybaseid,
+                            const char *idref,
+                            int        *derived)
+{
+    yang_stmt *ys;
+
+    if (yang_index_find(ybaseid, YANG_INDEX_DERIVED, idref, &ys) == 0)
+        return 0;
+    *derived = (ys != NULL);
+    return 1;
+}
+
+/*! Build missing indexes of a yang tree recursively
+ *
+ * Called after yang_parse_post, existing indexes are kept
+ * @param[in]  yt   Yang statement, eg yang spec
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+yang_index_build(yang_stmt *yt)
+{
+    int i;
+
+    if (yt->ys_index == NULL &&
+        (yt->ys_len > 0 || yt->ys_keyword == Y_IDENTITY) &&
+        yang_index_create(yt) < 0)
+        return -1;
+    for (i=0; i<yt->ys_len; i++)
+        if (yang_index_build(yt->ys_stmt[i]) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Drop index of a yang statement whose children change
+ *
+ * Also drop indexes of ancestors whose data or schema node lookups descend into it, ie
+ * through choice, case, input and output
+ * @param[in]  ys   Yang statement
+ * @retval     0    OK
+ */
+int
+yang_index_drop(yang_stmt *ys)
+{
+    while (ys != NULL){
+        yang_index_free(ys);
+        if (ys->ys_keyword != Y_CHOICE &&
+            ys->ys_keyword != Y_CASE &&
+            ys->ys_keyword != Y_INPUT &&
+            ys->ys_keyword != Y_OUTPUT)
+            break;
+        ys = ys->ys_parent;
+    }
+    return 0;
+}
+
+/*! Free index of a yang statement
+ *
+ * @param[in]  ys   Yang statement
+ * @retval     0    OK
+ */
+int
+yang_index_free(yang_stmt *ys)
+{
+    if (ys->ys_index){
+        yang_index_free1(ys->ys_index);
+        ys->ys_index = NULL;
+    }
+    return 0;
+}
+
+/*! Return memory used by index of a yang statement
+ *
+ * @param[in]  ys   Yang statement
+ * @retval     sz   Size in bytes
+ */
+size_t
+yang_index_size(yang_stmt *ys)
+{
+    struct yang_index *yi;
+
+    if ((yi = ys->ys_index) == NULL)
+        return 0;
+    return sizeof(*yi) + yi->yi_size*sizeof(*yi->yi_bucket) + yi->yi_max*sizeof(*yi->yi_vec);
+}
+
+#endif /* YANG_INDEX */
@@ -0,0 +1,65 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2020-2023 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Hash index of YANG child statements on keyword/argument and on data and schema node names
+ * Internal to the YANG library, see clixon_yang_index.c
+ */
+#ifndef _CLIXON_YANG_INDEX_H
+#define _CLIXON_YANG_INDEX_H
+
+/*
+ * Constants
+ */
+/* Keywords of data and schema node name lookups, other lookups use enum rfc_6020 */
+#define YANG_INDEX_DATANODE   -1
+#define YANG_INDEX_SCHEMANODE -2
+#define YANG_INDEX_DERIVED    -3 /* Y_IDENTITY: derived identities as <module>:<id> */
+#define YANG_INDEX_NAMESPACE  -4 /* Y_SPEC: modules by namespace */
+#define YANG_INDEX_PREFIX     -5 /* Y_SPEC: modules by prefix */
+
+/*
+ * Types
+ */
+struct yang_index; /* Opaque, see clixon_yang_index.c */
+
+/*
+ * Prototypes
+ */
+int    yang_index_identity_derived(yang_stmt *ybaseid, const char *idref, int *derived);
+int    yang_index_find(yang_stmt *yn, int keyword, const char *argument, yang_stmt **ysp);
+int    yang_index_build(yang_stmt *yt);
+int    yang_index_drop(yang_stmt *ys);
+int    yang_index_free(yang_stmt *ys);
+size_t yang_index_size(yang_stmt *ys);
+
+#endif  /* _CLIXON_YANG_INDEX_H */
@@ -42,7 +42,7 @@
 #define _CLIXON_YANG_INTERNAL_H_
 
 /*! Yang type cache. Yang type statements can cache all typedef info here
- * @note unions not cached
+ * For unions, the resolved member types are cached
 */
 struct yang_type_cache{
     int        yc_options;  /* See YANG_OPTIONS_* that determines pattern/
@@ -56,6 +56,9 @@ struct yang_type_cache{
     uint8_t    yc_fraction; /* Fraction digits for decimal64 (if 
                                YANG_OPTIONS_FRACTION_DIGITS */
     yang_stmt *yc_resolved; /* Resolved type object, can be NULL - note direct ptr */
+    int        yc_refcnt;   /* Number of type statements sharing this cache, see ys_cp */
+    yang_type_member *yc_members; /* Resolved member types if union, see ys_cv_validate_union */
+    int        yc_nmembers; /* Length of yc_members */
 };
 typedef struct yang_type_cache yang_type_cache;
 
@@ -71,6 +74,7 @@ struct yang_stmt{
 
     char              *ys_argument;  /* String / argument depending on keyword */   
     uint16_t           ys_flags;     /* Flags according to YANG_FLAG_MARK and others */
+    uint16_t           ys_nsid;      /* Namespace id of my module, see yang_nsid_get */
     yang_stmt         *ys_mymodule;  /* Shortcut to "my" module. Used by:
                                         1) Augmented nodes "belong" to the module where the 
                                            augment is declared, which may be differnt from
@@ -99,12 +103,23 @@ struct yang_stmt{
                                         Y_EXTENSION: vector of instantiated UNKNOWNSo
                                         Y_UNKNOWN: app-dep: yang-mount-points
                                      */
-    yang_type_cache   *ys_typecache; /* If ys_keyword==Y_TYPE, cache all typedef data except unions */
+    yang_type_cache   *ys_typecache; /* If ys_keyword==Y_TYPE, cache all typedef data */
+    yang_keycmp       *ys_keycmp;    /* Y_LIST and Y_LEAF_LIST: precompiled key comparator */
+    yang_json         *ys_json;      /* JSON member name, see yang_json_get */
+    yang_bloom        *ys_bloom;     /* Names of descendant data nodes, see yang_bloom_descendant */
+    int                ys_order;     /* Data nodes: yang order among siblings, see yang_order */
+    uint32_t           ys_order_gen; /* Yang tree generation of ys_order, 0 if not computed */
     char              *ys_when_xpath; /* Special conditional for a "when"-associated augment/uses xpath */
     cvec              *ys_when_nsc;   /* Special conditional for a "when"-associated augment/uses namespace ctx */
+    struct xpath_tree *ys_xpath;      /* Y_MUST and Y_WHEN: parsed xpath argument, see yang_xpath_get */
+    cvec              *ys_xpath_nsc;  /* Y_MUST and Y_WHEN: namespace context of xpath
+                                         Y_MODULE and Y_SUBMODULE: see yang_nsctx_get */
     char              *ys_filename;   /* For debug/errors: filename (only (sub)modules) */
     int                ys_linenum;    /* For debug/errors: line number (in ys_filename) */
     rpc_callback_t    *ys_action_cb;  /* Action callback list, only for Y_ACTION */
+#ifdef YANG_INDEX
+    struct yang_index *ys_index;      /* Hash index of children, see clixon_yang_index.c */
+#endif
     /* Internal use */
     int               _ys_vector_i;   /* internal use: yn_each */
 };
@@ -81,6 +81,7 @@
 #include "clixon_netconf_lib.h"
 #include "clixon_xml_map.h"
 #include "clixon_yang_parse_lib.h"
+#include "clixon_yang_index.h"
 
 /*! Force add ietf-yang-library@2019-01-04 on all mount-points
  * This is a limitation of of the current implementation
@@ -583,6 +584,10 @@ yang_find_module_by_prefix_yspec(yang_stmt *yspec,
     yang_stmt *ymod = NULL;
     yang_stmt *yprefix;
     
+#ifdef YANG_INDEX
+    if (yang_index_find(yspec, YANG_INDEX_PREFIX, prefix, &ymod) == 1)
+        return ymod;
+#endif
     while ((ymod = yn_each(yspec, ymod)) != NULL) 
         if (yang_keyword_get(ymod) == Y_MODULE &&
             (yprefix = yang_find(ymod, Y_PREFIX, NULL)) != NULL &&
@@ -609,6 +614,10 @@ yang_find_module_by_namespace(yang_stmt *yspec,
 
     if (ns == NULL)
         goto done;
+#ifdef YANG_INDEX
+    if (yang_index_find(yspec, YANG_INDEX_NAMESPACE, ns, &ymod) == 1)
+        goto done;
+#endif
     while ((ymod = yn_each(yspec, ymod)) != NULL) {
         if (yang_find(ymod, Y_NAMESPACE, ns) != NULL)
             break;
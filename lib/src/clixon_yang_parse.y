@@ -158,6 +158,7 @@
 %token D_DELETE
 %token D_REPLACE
 
+%define api.pure full
 %lex-param     {void *_yy} /* Add this argument to parse() and lex() function */
 %parse-param   {void *_yy}
 
@@ -167,7 +168,7 @@
 /* typecast macro */
 #define _YY ((clixon_yang_yacc *)_yy)
 
-#define _YYERROR(msg) {clicon_debug(1, "YYERROR %s '%s' %d", (msg), clixon_yang_parsetext, _YY->yy_linenum); YYERROR;}
+#define _YYERROR(msg) {clicon_debug(1, "YYERROR %s '%s' %d", (msg), clixon_yang_parseget_text(_YY->yy_scanner), _YY->yy_linenum); YYERROR;}
 
 /* add _yy to error parameters */
 #define YY_(msgid) msgid 
@@ -197,6 +198,9 @@
 #include "clixon_yang_parse_lib.h"
 #include "clixon_yang_parse.h"
 
+/* Reentrant lex function, defined in clixon_yang_parse.l */
+int clixon_yang_parselex(YYSTYPE *lvalp, void *_yy);
+
 /* Best debugging is to enable PARSE_DEBUG below and add -d to the LEX compile statement in the Makefile
  * And then run the testcase with -D 1
  * Disable it to stop any calls to clicon_debug. Having it on by default would mean very large debug outputs.
@@ -209,7 +213,7 @@
 #define _PARSE_DEBUG1(s, s1)
 #endif
     
-extern int clixon_yang_parseget_lineno  (void);
+extern int clixon_yang_parseget_lineno  (void *yyscanner);
 
 /* 
    clixon_yang_parseerror
@@ -223,7 +227,7 @@ clixon_yang_parseerror(void *_yy,
                _YY->yy_name,
                _YY->yy_linenum ,
                s, 
-               clixon_yang_parsetext); 
+               clixon_yang_parseget_text(_YY->yy_scanner)); 
   return;
 }
 
@@ -315,6 +319,8 @@ ysp_add(clixon_yang_yacc *yy,
     if (yn_insert(yn, ys) < 0) /* Insert into hierarchy */
         goto err; 
     yang_linenum_set(ys, yy->yy_linenum); /* For error/debugging */
+    if (yy->yy_defer_sub && ys_parse_sub_deferred(keyword))
+        return ys; /* Checked by the caller after the parse, see ys_parse_sub_tree */
     if (ys_parse_sub(ys, yy->yy_name, extra) < 0)     /* Check statement-specific syntax */
         goto err2; /* dont free since part of tree */
     return ys;
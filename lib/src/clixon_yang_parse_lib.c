@@ -70,6 +70,9 @@
 #include <sys/param.h>
 #include <netinet/in.h>
 #include <libgen.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -97,6 +100,7 @@
 #include "clixon_yang_cardinality.h"
 #include "clixon_plugin.h"
 #include "clixon_yang_internal.h"
+#include "clixon_yang_index.h"
 #include "clixon_yang_sub_parse.h"
 #include "clixon_yang_parse_lib.h"
 
@@ -603,6 +607,9 @@ yang_expand_uses_node(yang_stmt *yn,
         int oldbuflen = yn->ys_len;
         /* size of existing elements up from i+1 (not uses-stmt) */
         size = (yang_len_get(yn) - i - 1)*sizeof(struct yang_stmt *);
+#ifdef YANG_INDEX
+        yang_index_drop(yn);
+#endif
         yn->ys_len += glen;
         if ((yn->ys_stmt = realloc(yn->ys_stmt, (yang_len_get(yn))*sizeof(yang_stmt *))) == 0){
             clicon_err(OE_YANG, errno, "realloc");
@@ -779,14 +786,16 @@ yang_expand_grouping(yang_stmt *yn)
  * @param[in] str    String of yang statements
  * @param[in] name   Log string, typically filename
  * @param[in] yspec  Yang specification. 
+ * @param[in] defer  Do not invoke sub-parsers, statements are checked later by ys_parse_sub_tree
  * @retval    ymod   Top-level yang (sub)module
  * @retval    NULL   Error encountered
  * See top of file for diagram of calling order
  */
-yang_stmt *
-yang_parse_str(char         *str,
-               const char   *name, /* just for errs */
-               yang_stmt    *yspec)
+static yang_stmt *
+yang_parse_str1(char         *str,
+                const char   *name, /* just for errs */
+                yang_stmt    *yspec,
+                int           defer)
 {
     clixon_yang_yacc yy = {0,};
     yang_stmt       *ymod = NULL;
@@ -800,6 +809,7 @@ yang_parse_str(char         *str,
     yy.yy_parse_string = str;
     yy.yy_stack        = NULL;
     yy.yy_module       = NULL; /* this is the return value - the module/sub-module */
+    yy.yy_defer_sub    = defer;
     if (ystack_push(&yy, yspec) == NULL)
         goto done;
     if (strlen(str)){ /* Not empty */
@@ -834,19 +844,40 @@ yang_parse_str(char         *str,
     return ymod;  /* top-level (sub)module */
 }
 
+/*! Parse a string containing a YANG spec into a parse-tree
+ * 
+ * Syntax parsing. A string is input and a YANG syntax-tree is returned (or error). 
+ * As a side-effect, Yang modules present in the text will be inserted under the global Yang 
+ * specification
+ * @param[in] str    String of yang statements
+ * @param[in] name   Log string, typically filename
+ * @param[in] yspec  Yang specification. 
+ * @retval    ymod   Top-level yang (sub)module
+ * @retval    NULL   Error encountered
+ * See top of file for diagram of calling order
+ */
+yang_stmt *
+yang_parse_str(char         *str,
+               const char   *name, /* just for errs */
+               yang_stmt    *yspec)
+{
+    return yang_parse_str1(str, name, yspec, 0);
+}
+
 /*! Parse yang spec from an open file descriptor
  *
  * @param[in] fd     File descriptor containing the YANG file as ASCII characters
  * @param[in] name   For debug, eg filename
  * @param[in] yspec  Yang specification. Should have been created by caller using yspec_new
+ * @param[in] defer  Do not invoke sub-parsers, see yang_parse_str1
  * @retval ymod      Top-level yang (sub)module
  * @retval NULL      Error 
- * @note this function simply parse a yang spec, no dependencies or checks
  */
-yang_stmt *
-yang_parse_file(FILE       *fp,
-                const char *name,
-                yang_stmt  *yspec)
+static yang_stmt *
+yang_parse_file1(FILE       *fp,
+                 const char *name,
+                 yang_stmt  *yspec,
+                 int         defer)
 {
     char         *buf = NULL;
     int           i;
@@ -879,7 +910,7 @@ yang_parse_file(FILE       *fp,
         }
         buf[i++] = (char)(c&0xff);
     } /* read a line */
-    if ((ymod = yang_parse_str(buf, name, yspec)) < 0)
+    if ((ymod = yang_parse_str1(buf, name, yspec, defer)) < 0)
         goto done;
   done:
     if (buf != NULL)
@@ -887,6 +918,23 @@ yang_parse_file(FILE       *fp,
     return ymod; /* top-level (sub)module */
 }
 
+/*! Parse yang spec from an open file descriptor
+ *
+ * @param[in] fd     File descriptor containing the YANG file as ASCII characters
+ * @param[in] name   For debug, eg filename
+ * @param[in] yspec  Yang specification. Should have been created by caller using yspec_new
+ * @retval ymod      Top-level yang (sub)module
+ * @retval NULL      Error 
+ * @note this function simply parse a yang spec, no dependencies or checks
+ */
+yang_stmt *
+yang_parse_file(FILE       *fp,
+                const char *name,
+                yang_stmt  *yspec)
+{
+    return yang_parse_file1(fp, name, yspec, 0);
+}
+
 /*! Given a yang filename, extract the revision as an integer as YYYYMMDD
  *
  * @param[in]  filename  Filename on the form: name [+ @rev ] + .yang  
@@ -1527,6 +1575,11 @@ yang_parse_post(clicon_handle h,
     for (i=0; i<ylen; i++)
         if (yang_cardinality(h, ylist[i], yang_argument_get(ylist[i])) < 0)
             goto done;
+#ifdef YANG_INDEX
+    /* 12. Build child lookup indexes, also of earlier modules changed by eg augment */
+    if (yang_index_build(yspec) < 0)
+        goto done;
+#endif
     retval = 0;
  done:
     if (ylist)
@@ -1627,6 +1680,160 @@ yang_spec_parse_file(clicon_handle h,
     return retval;
 }
 
+/*! Check the statements of a module that were skipped by a deferred parse
+ *
+ * @param[in] ys       Yang statement, eg a module parsed in a thread
+ * @param[in] filename Name of parsed file
+ * @retval    0        OK
+ * @retval   -1        Error
+ * @see ys_parse_sub_deferred
+ */
+static int
+ys_parse_sub_tree(yang_stmt  *ys,
+                  const char *filename)
+{
+    int        retval = -1;
+    yang_stmt *yc = NULL;
+
+    while ((yc = yn_each(ys, yc)) != NULL){
+        if (ys_parse_sub_deferred(yang_keyword_get(yc)) &&
+            ys_parse_sub(yc, filename, NULL) < 0)
+            goto done;
+        if (ys_parse_sub_tree(yc, filename) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! A yang file in a directory to be loaded, see yang_spec_load_dir
+ */
+struct yang_parse_task {
+    char      *pt_filename; /* Full filename */
+    char      *pt_base;     /* Filename without dir, revision and .yang: module name */
+    uint32_t   pt_revf;     /* Revision in filename */
+    yang_stmt *pt_yspec;    /* If parsed in a thread: private yang spec of the module */
+    yang_stmt *pt_ymod;     /* If parsed in a thread: module, or NULL on error */
+};
+
+#ifdef HAVE_LIBPTHREAD
+/*! Yang files shared by a pool of parse threads
+ */
+struct yang_parse_job {
+    pthread_mutex_t         pj_mutex;
+    struct yang_parse_task *pj_vec;  /* Tasks */
+    int                     pj_len;  /* Number of tasks */
+    int                     pj_next; /* Next task to take */
+};
+
+/*! Parse thread: take yang files from the job until no more remain
+ *
+ * Each file is parsed into a private yang spec without sub-parsers, which are not reentrant.
+ * A file that fails is left to the calling thread, which parses it again and reports the error
+ * Errors and logs of other threads are dropped, see clicon_err_thread
+ * The calling thread also runs this, so all files are parsed even if no thread could be created
+ */
+static void *
+yang_parse_worker(void *arg)
+{
+    struct yang_parse_job  *pj = (struct yang_parse_job *)arg;
+    struct yang_parse_task *pt;
+    FILE                   *fp;
+    int                     i;
+
+    while (1){
+        pthread_mutex_lock(&pj->pj_mutex);
+        i = pj->pj_next++;
+        pthread_mutex_unlock(&pj->pj_mutex);
+        if (i >= pj->pj_len)
+            break;
+        pt = &pj->pj_vec[i];
+        if ((pt->pt_yspec = yspec_new()) == NULL)
+            continue;
+        if ((fp = fopen(pt->pt_filename, "r")) == NULL)
+            continue;
+        pt->pt_ymod = yang_parse_file1(fp, pt->pt_filename, pt->pt_yspec, 1);
+        fclose(fp);
+    }
+    return NULL;
+}
+
+/*! Parse all yang files of a job using at most nthreads threads, return when all are done
+ *
+ * @param[in]  pj        Parse job
+ * @param[in]  nthreads  Number of threads including the calling thread
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+yang_parse_job_run(struct yang_parse_job *pj,
+                   int                    nthreads)
+{
+    int        retval = -1;
+    pthread_t *tids = NULL;
+    int        n = 0;
+    
+    if (nthreads > pj->pj_len)
+        nthreads = pj->pj_len;
+    if (nthreads > 1 &&
+        (tids = malloc((nthreads-1)*sizeof(pthread_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    clicon_err_thread(1);
+    clixon_string_intern_lock(1);
+    /* Failing to create a thread is not an error: the remaining threads do the work */
+    for (n=0; n<nthreads-1; n++)
+        if (pthread_create(&tids[n], NULL, yang_parse_worker, pj) != 0)
+            break;
+    yang_parse_worker(pj);
+    while (n > 0)
+        pthread_join(tids[--n], NULL);
+    clixon_string_intern_lock(0);
+    clicon_err_thread(0);
+    retval = 0;
+ done:
+    if (tids)
+        free(tids);
+    return retval;
+}
+#endif /* HAVE_LIBPTHREAD */
+
+/*! Parse a yang file of a directory, or take the module if it was parsed in a thread
+ *
+ * A module parsed in a thread is moved to yspec and its deferred statements are checked,
+ * then the YANG patch hook is called, as in yang_parse_filename
+ * @param[in] h      Clixon handle
+ * @param[in] pt     Yang file
+ * @param[in] yspec  Yang specification
+ * @retval    ymod   Top-level yang (sub)module
+ * @retval    NULL   Error encountered
+ */
+static yang_stmt *
+yang_parse_task_take(clicon_handle           h,
+                     struct yang_parse_task *pt,
+                     yang_stmt              *yspec)
+{
+    yang_stmt *ymod;
+
+    if ((ymod = pt->pt_ymod) == NULL)
+        return yang_parse_filename(h, pt->pt_filename, yspec);
+    pt->pt_ymod = NULL;
+    if (ys_prune_self(ymod) < 0)
+        return NULL;
+    if (yn_insert(yspec, ymod) < 0){
+        ys_free(ymod);
+        return NULL;
+    }
+    if (ys_parse_sub_tree(ymod, pt->pt_filename) < 0)
+        return NULL;
+    /* YANG patch hook */
+    if (h && clixon_plugin_yang_patch_all(h, ymod) < 0)
+        return NULL;
+    return ymod;
+}
+
 /*! Load all yang modules in directory
  *
  * @param[in]  h     Clicon handle
@@ -1642,6 +1849,9 @@ yang_spec_parse_file(clicon_handle h,
  * 3) If only x@rev.yang's found, prefer newest (newest revision)
  * There is also an extra failsafe which may not be necessary, which removes
  * the oldest module if 1-3 for some reason fails.
+ * If CLICON_YANG_PARSE_THREADS is larger than one, the files are parsed by a pool of threads
+ * and then added to yspec in the same order as in a serial parse. Imports, augments and
+ * groupings are resolved serially afterwards in yang_parse_post
  */
 int
 yang_spec_load_dir(clicon_handle h,
@@ -1664,6 +1874,14 @@ yang_spec_load_dir(clicon_handle h,
     uint32_t       rev0; /* revision in existing module */
     char          *oldbase = NULL;
     int            taken = 0;
+    struct yang_parse_task *ptvec = NULL;
+    struct yang_parse_task *pt;
+    int            ptlen = 0;
+#ifdef HAVE_LIBPTHREAD
+    struct yang_parse_job   pj = {0,};
+    int            nthreads;
+    int            ret;
+#endif
     
     /* Get yang files names from yang module directory. Note that these
      * are sorted alphatetically:
@@ -1675,9 +1893,13 @@ yang_spec_load_dir(clicon_handle h,
         goto done;
     if (ndp == 0)
         goto ok;
+    if ((ptvec = calloc(ndp, sizeof(*ptvec))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
     /* Apply post steps on new modules, ie ones after modmin. */
     modmin = yang_len_get(yspec);
-    /* Load all yang files in dir */
+    /* Select yang files in dir */
     for (i = 0; i < ndp; i++) {
         /* base = module name [+ @rev ] + .yang */
        if (oldbase)
@@ -1709,25 +1931,48 @@ yang_spec_load_dir(clicon_handle h,
             }
             taken = 1; /* last in line and not taken */
         }
-        /* Here only a single file is reached(taken)
-         * Check if module already exists -> ym0/rev0 */
+        /* Here only a single file is reached(taken), create full filename */
+        snprintf(filename, MAXPATHLEN-1, "%s/%s", dir, dp[i].d_name);
+        pt = &ptvec[ptlen++];
+        if ((pt->pt_filename = strdup(filename)) == NULL ||
+            (pt->pt_base = strdup(base)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        pt->pt_revf = revf;
+    }
+#ifdef HAVE_LIBPTHREAD
+    nthreads = clicon_option_int(h, "CLICON_YANG_PARSE_THREADS");
+    if (nthreads > 1 && ptlen > 1){
+        pthread_mutex_init(&pj.pj_mutex, NULL);
+        pj.pj_vec = ptvec;
+        pj.pj_len = ptlen;
+        ret = yang_parse_job_run(&pj, nthreads);
+        pthread_mutex_destroy(&pj.pj_mutex);
+        if (ret < 0)
+            goto done;
+    }
+#endif
+    /* Load the selected yang files in order */
+    for (i = 0; i < ptlen; i++) {
+        pt = &ptvec[i];
+        /* Check if module already exists -> ym0/rev0 */
         rev0 = 0;
-        if ((ym0 = yang_find(yspec, Y_MODULE, base)) != NULL ||
-            (ym0 = yang_find(yspec, Y_SUBMODULE, base)) != NULL){
+        if ((ym0 = yang_find(yspec, Y_MODULE, pt->pt_base)) != NULL ||
+            (ym0 = yang_find(yspec, Y_SUBMODULE, pt->pt_base)) != NULL){
             yrev = yang_find(ym0, Y_REVISION, NULL);
             rev0 = cv_uint32_get(yang_cv_get(yrev));
             continue; /* skip if already added by specific file or module */
         }
-        /* Create full filename */
-        snprintf(filename, MAXPATHLEN-1, "%s/%s", dir, dp[i].d_name);
-        if ((ym = yang_parse_filename(h, filename, yspec)) == NULL)
+        if ((ym = yang_parse_task_take(h, pt, yspec)) == NULL)
             goto done;
+        revf = pt->pt_revf;
         revm = 0;
         if ((yrev = yang_find(ym, Y_REVISION, NULL)) != NULL)
             revm = cv_uint32_get(yang_cv_get(yrev));
         /* Sanity check that file revision does not match internal rev stmt */
         if (revf && revm && revm != revf){ /* XXX */
-            clicon_err(OE_YANG, EINVAL, "Yang module file revision and in yang does not match: %s(%u) vs %u", filename, revf, revm); 
+            clicon_err(OE_YANG, EINVAL, "Yang module file revision and in yang does not match: %s(%u) vs %u", pt->pt_filename, revf, revm); 
             goto done;
         }
         /* If ym0 and ym exists, delete the yang with oldest revision 
@@ -1748,6 +1993,18 @@ yang_spec_load_dir(clicon_handle h,
  ok:
     retval = 0;
   done:
+    if (ptvec){
+        for (i = 0; i < ptlen; i++){
+            pt = &ptvec[i];
+            if (pt->pt_filename)
+                free(pt->pt_filename);
+            if (pt->pt_base)
+                free(pt->pt_base);
+            if (pt->pt_yspec)
+                ys_free(pt->pt_yspec);
+        }
+        free(ptvec);
+    }
     if (dp)
         free(dp);
     if (base)
@@ -2000,3 +2257,31 @@ ys_parse_sub(yang_stmt  *ys,
         free(extra);
     return retval;
 }
+
+/*! Check if the syntax check of a statement invokes a sub-parser
+ *
+ * The sub-parsers (if-feature, schema-nodeid and xpath) are not reentrant. If a yang file is
+ * parsed in a thread, these statements are checked afterwards in the calling thread
+ * @param[in] keyword  Yang keyword
+ * @retval    1        Statement is checked by a sub-parser in ys_parse_sub
+ * @retval    0        No sub-parser
+ * @see ys_parse_sub
+ */
+int
+ys_parse_sub_deferred(enum rfc_6020 keyword)
+{
+    switch (keyword){
+    case Y_BASE:
+    case Y_TYPE:
+    case Y_USES:
+    case Y_MUST:
+    case Y_WHEN:
+    case Y_IF_FEATURE:
+    case Y_AUGMENT:
+    case Y_REFINE:
+        return 1;
+    default:
+        break;
+    }
+    return 0;
+}
@@ -43,7 +43,8 @@
  * 2. xml_yang_mount_get(): from xml_bind_yang and xmldb_put 
  * 3. xml_yang_mount_freeall(): from ys_free1 when deallocatin YANG trees
  * 4. yang_schema_mount_statedata(): from get_common/get_statedata to retrieve system state
- * 5. yang_schema_yanglib_parse_mount(): from xml_bind_yang to parse and mount
+ * 5. yang_schema_yanglib_parse_mount(): from xml_bind_yang to parse and mount, yspecs with
+ *    the same yang-library module-set are shared between mount-points
  * 6. yang_schema_get_child(): from xmldb_put/text_modify when adding new XML nodes
  *
  * Note: the xpath used as key in yang unknown cvec is "canonical" in the sense:
@@ -87,6 +88,197 @@
 #include "clixon_netconf_lib.h"
 #include "clixon_yang_schema_mount.h"
 
+/*! Cache of mounted yang specs shared between mount-points with the same yang-library
+ *
+ * The key is the module-set as sorted "name@revision" lines. Each mount-point using a
+ * cached yspec holds a reference
+ */
+struct yang_mount_cache {
+    qelem_t    ymc_qelem;   /* List header, must be first */
+    char      *ymc_key;     /* Canonical module-set */
+    uint32_t   ymc_hash;    /* FNV-1a hash of key */
+    yang_stmt *ymc_yspec;   /* Shared yang spec */
+    int        ymc_refcnt;  /* Number of mount-points */
+};
+
+static struct yang_mount_cache *_mount_cache = NULL;
+
+/*! FNV-1a hash of a string
+ */
+static uint32_t
+yang_mount_cache_hash(const char *str)
+{
+    uint32_t h = 2166136261U;
+
+    while (*str){
+        h ^= (uint8_t)*str++;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*! qsort callback for module-set lines
+ */
+static int
+yang_mount_cache_cmp(const void *a,
+                     const void *b)
+{
+    return strcmp(*(char**)a, *(char**)b);
+}
+
+/*! Make canonical cache key of a yang-library
+ *
+ * Order of modules in yang-library is not significant
+ * @param[in]  yanglib  XML yang-library as returned by the yang-mount plugin callback
+ * @param[out] keyp     Key, free with free()
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see yang_lib2yspec   which parses the same module entries
+ */
+static int
+yang_mount_cache_key(cxobj *yanglib,
+                     char **keyp)
+{
+    int     retval = -1;
+    cxobj **vec = NULL;
+    size_t  veclen;
+    char  **lines = NULL;
+    int     nr = 0;
+    char   *name;
+    char   *revision;
+    cbuf   *cb = NULL;
+    int     i;
+
+    if (xpath_vec(yanglib, NULL, "module-set/module", &vec, &veclen) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (veclen && (lines = calloc(veclen, sizeof(char*))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<veclen; i++){
+        if ((name = xml_find_body(vec[i], "name")) == NULL)
+            continue;
+        revision = xml_find_body(vec[i], "revision");
+        cbuf_reset(cb);
+        cprintf(cb, "%s@%s", name, revision?revision:"");
+        if ((lines[nr++] = strdup(cbuf_get(cb))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    }
+    qsort(lines, nr, sizeof(char*), yang_mount_cache_cmp);
+    cbuf_reset(cb);
+    for (i=0; i<nr; i++)
+        cprintf(cb, "%s\n", lines[i]);
+    if ((*keyp = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (lines){
+        for (i=0; i<nr; i++)
+            if (lines[i])
+                free(lines[i]);
+        free(lines);
+    }
+    if (cb)
+        cbuf_free(cb);
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Find cached yspec of a yang-library and take a reference
+ *
+ * @param[in]  key    Canonical key
+ * @retval     yspec  Shared yang spec
+ * @retval     NULL   Not found
+ */
+static yang_stmt *
+yang_mount_cache_get(const char *key)
+{
+    struct yang_mount_cache *ymc;
+    uint32_t                 hash;
+
+    hash = yang_mount_cache_hash(key);
+    if ((ymc = _mount_cache) != NULL){
+        do {
+            if (ymc->ymc_hash == hash && strcmp(ymc->ymc_key, key) == 0){
+                ymc->ymc_refcnt++;
+                return ymc->ymc_yspec;
+            }
+            ymc = NEXTQ(struct yang_mount_cache *, ymc);
+        } while (ymc && ymc != _mount_cache);
+    }
+    return NULL;
+}
+
+/*! Add yspec to the mount cache with one reference
+ *
+ * @param[in]  key    Canonical key
+ * @param[in]  yspec  Yang spec
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+yang_mount_cache_add(const char *key,
+                     yang_stmt  *yspec)
+{
+    int                      retval = -1;
+    struct yang_mount_cache *ymc;
+
+    if ((ymc = malloc(sizeof(*ymc))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(ymc, 0, sizeof(*ymc));
+    if ((ymc->ymc_key = strdup(key)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        free(ymc);
+        goto done;
+    }
+    ymc->ymc_hash = yang_mount_cache_hash(key);
+    ymc->ymc_yspec = yspec;
+    ymc->ymc_refcnt = 1;
+    ADDQ(ymc, _mount_cache);
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Release a reference to a cached yspec, free it when the last mount-point is removed
+ *
+ * @param[in]  yspec  Yang spec
+ * @retval     1      yspec was cached and its reference is released
+ * @retval     0      yspec is not cached
+ */
+static int
+yang_mount_cache_release(yang_stmt *yspec)
+{
+    struct yang_mount_cache *ymc;
+
+    if ((ymc = _mount_cache) != NULL){
+        do {
+            if (ymc->ymc_yspec == yspec){
+                if (--ymc->ymc_refcnt == 0){
+                    DELQ(ymc, _mount_cache, struct yang_mount_cache *);
+                    free(ymc->ymc_key);
+                    free(ymc);
+                    ys_free(yspec);
+                }
+                return 1;
+            }
+            ymc = NEXTQ(struct yang_mount_cache *, ymc);
+        } while (ymc && ymc != _mount_cache);
+    }
+    return 0;
+}
+
 /*! Check if YANG node is a RFC 8525 YANG schema mount
  *
  * Check if:
@@ -168,6 +360,7 @@ yang_mount_get(yang_stmt  *yu,
  * @param[in]  yspec  Yangspec for this mount-point (consumed)
  * @retval     0      OK
  * @retval     -1     Error
+ * @note yspec may be shared by several mount-points, see yang_schema_yanglib_parse_mount
  */
 int
 yang_mount_set(yang_stmt *yu,
@@ -186,20 +379,24 @@ yang_mount_set(yang_stmt *yu,
 #if 0 /* Problematic to free yang specs here, upper layers should handle it? */
         ys_free(yspec0);
 #endif
+        /* Shared yspecs are reference counted */
+        yang_mount_cache_release(yspec0);
         cv_void_set(cv, NULL);
     }
     else if ((cv = yang_cvec_add(yu, CGV_VOID, xpath)) == NULL)
         goto done;
-    if ((cv2 = cv_new(CGV_STRING)) == NULL){
-        clicon_err(OE_YANG, errno, "cv_new"); 
-        goto done;
-    }
-    if (cv_string_set(cv2, xpath) == NULL){
-        clicon_err(OE_UNIX, errno, "cv_string_set"); 
-        goto done;
+    /* tag yspec with key/xpath, a shared yspec keeps the tag of its first mount-point */
+    if (yang_cv_get(yspec) == NULL){
+        if ((cv2 = cv_new(CGV_STRING)) == NULL){
+            clicon_err(OE_YANG, errno, "cv_new"); 
+            goto done;
+        }
+        if (cv_string_set(cv2, xpath) == NULL){
+            clicon_err(OE_UNIX, errno, "cv_string_set"); 
+            goto done;
+        }
+        yang_cv_set(yspec, cv2);
     }
-    /* tag yspec with key/xpath */
-    yang_cv_set(yspec, cv2);
     cv_void_set(cv, yspec);
     retval = 0;
  done:
@@ -300,7 +497,8 @@ xml_yang_mount_freeall(cvec *cvv)
     
     cv = NULL;    
     while ((cv = cvec_each(cvv, cv)) != NULL){
-        if ((ys = cv_void_get(cv)) != NULL)
+        if ((ys = cv_void_get(cv)) != NULL &&
+            yang_mount_cache_release(ys) == 0)
             ys_free(ys);
     }
     return 0;
@@ -505,6 +703,38 @@ yang_schema_mount_statedata(clicon_handle h,
     goto done;
 }
 
+/*! Memory of all mounted yang specs
+ *
+ * A yang spec shared by several mount-points is counted once. Unlike
+ * yang_schema_mount_statistics, the datastore is not searched for mount-points
+ * @param[out] nr    Number of mounted yang specs
+ * @param[out] size  Size in bytes of yang objects of mounted yang specs
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+yang_schema_mount_mem_stats(uint64_t *nr,
+                            size_t   *size)
+{
+    struct yang_mount_cache *ymc;
+    uint64_t                 ynr;
+    size_t                   sz;
+
+    *nr = 0;
+    *size = 0;
+    if ((ymc = _mount_cache) != NULL){
+        do {
+            ynr = 0; sz = 0;
+            if (yang_stats(ymc->ymc_yspec, &ynr, &sz) < 0)
+                return -1;
+            (*nr)++;
+            *size += sz;
+            ymc = NEXTQ(struct yang_mount_cache *, ymc);
+        } while (ymc && ymc != _mount_cache);
+    }
+    return 0;
+}
+
 /*! Statistics about mountpoints
  * @see yang_schema_mount_statedata
  */
@@ -576,9 +806,12 @@ yang_schema_mount_statistics(clicon_handle h,
 
 /*! Get yanglib from user plugin callback, parse it and mount it
  * 
+ * Mount-points with the same module-set in their yang-library share one yspec, which is
+ * parsed by the first of them
  * @param[in]     h     Clixon handle
  * @param[in]     xt       
- * @retval        0     OK
+ * @retval        1     OK
+ * @retval        0     No yang-library or parse failed, treat as anydata
  * @retval       -1     Error
  */
 int
@@ -591,25 +824,42 @@ yang_schema_yanglib_parse_mount(clicon_handle h,
     int            ret;
     int            config = 1;
     validate_level vl = VL_FULL;
+    char          *key = NULL;
+    int            cached = 0;
 
     if (clixon_plugin_yang_mount_all(h, xt, &config, &vl, &yanglib) < 0)
         goto done;
     if (yanglib == NULL)
         goto anydata;
-    /* Parse it and set mount-point */
-    if ((yspec = yspec_new()) == NULL)
+    if (yang_mount_cache_key(yanglib, &key) < 0)
         goto done;
-    if ((ret = yang_lib2yspec(h, yanglib, yspec)) < 0)
-        goto done;
-    if (ret == 0)
-        goto anydata;
+    if ((yspec = yang_mount_cache_get(key)) != NULL)
+        cached++;
+    else {
+        /* Parse it and set mount-point */
+        if ((yspec = yspec_new()) == NULL)
+            goto done;
+        if ((ret = yang_lib2yspec(h, yanglib, yspec)) < 0)
+            goto done;
+        if (ret == 0)
+            goto anydata;
+        if (yang_mount_cache_add(key, yspec) < 0)
+            goto done;
+        cached++;
+    }
     if (xml_yang_mount_set(xt, yspec) < 0)
         goto done;
     yspec = NULL;
     retval = 1;
  done:
-    if (yspec)
-        ys_free(yspec);
+    if (yspec){
+        if (cached)
+            yang_mount_cache_release(yspec);
+        else
+            ys_free(yspec);
+    }
+    if (key)
+        free(key);
     if (yanglib)
         xml_free(yanglib);
     return retval;
@@ -54,9 +54,9 @@
  * NOTE
  * 1) ys_cv_validate/ys_cv_validate_union_one and 
  *    yang2cli_var/yang2cli_var_union_one can unify?
- * 2) Cache of regex is set in ys_cv_validate - not in ys_reolve_parse
- *    This is because trees are copied in yang_parse_post after ys_reolve_type
- *    is called, and regexps (void*) cannot be copied (COMPLEX)
+ * 2) Cache of regex is set in ys_resolve_type when the yang spec is loaded. Trees are
+ *    copied in yang_parse_post after ys_resolve_type, but copies share the type cache.
+ *    If not set, eg a cache made by yang_spec_cache_load, it is set in ys_cv_validate
  * 3) We know I think when cache is set and when it is not set in the calls
  *    to yang_type_resolve. maybe we should make code easier by a separate
  *    yang_type_resolve_cache() call?
@@ -102,6 +102,7 @@
 #include "clixon_plugin.h"
 #include "clixon_options.h"
 #include "clixon_yang_type.h"
+#include "clixon_yang_index.h"
 
 /* 
  * Local types and variables
@@ -219,9 +220,74 @@ compile_pattern2regexp(clicon_handle h,
     return retval;
 }
 
+/*! Compile patterns of a type when the yang spec is loaded and cache the regexps
+ *
+ * If a pattern does not compile, no regexps are cached, and the error is reported when a
+ * value is validated, as it would without this step.
+ * @param[in]  h        Clixon handle
+ * @param[in]  ys       Yang type statement with type cache
+ * @param[in]  patterns Patterns in string form
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see ys_cv_validate  where regexps are compiled if not cached
+ */
+static int
+ys_resolve_regexps(clicon_handle h,
+                   yang_stmt    *ys,
+                   cvec         *patterns)
+{
+    int     retval = -1;
+    cvec   *regexps = NULL;
+    cg_var *pcv;
+    cg_var *rcv;
+    void   *re;
+    int     ret;
+
+    if ((regexps = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    pcv = NULL;
+    while ((pcv = cvec_each(patterns, pcv)) != NULL){
+        re = NULL;
+        if ((ret = regex_compile(h, cv_string_get(pcv), &re)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if ((rcv = cvec_add(regexps, CGV_VOID)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_add");
+            goto done;
+        }
+        cv_void_set(rcv, re);
+        if (cv_flag(pcv, V_INVERT))
+            cv_flag_set(rcv, V_INVERT);
+    }
+    if (yang_type_cache_regexp_set(ys, clicon_yang_regexp(h), regexps) < 0)
+        goto done;
+    cvec_free(regexps);
+    regexps = NULL;
+    retval = 0;
+ done:
+    if (regexps){ /* Not cached */
+        rcv = NULL;
+        while ((rcv = cvec_each(regexps, rcv)) != NULL)
+            if ((re = cv_void_get(rcv)) != NULL){
+                regex_free(h, re);
+                if (clicon_yang_regexp(h) == REGEXP_POSIX)
+                    free(re);
+                cv_void_set(rcv, NULL);
+            }
+        cvec_free(regexps);
+    }
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Resolve types: populate type caches 
  * @param[in]  ys  This is a type statement
- * @param[in]  arg Not used
+ * @param[in]  arg Clixon handle, if set patterns are compiled
  * Typically only called once when loading the yang type system.
  * @note unions not cached
  */
@@ -229,7 +295,7 @@ int
 ys_resolve_type(yang_stmt    *ys, 
                 void         *arg)
 {
-    //    clicon_handle     h = (clicon_handle)arg;
+    clicon_handle     h = (clicon_handle)arg;
     int               retval = -1;
     int               options = 0x0;
     cvec             *cvv = NULL;
@@ -262,6 +328,10 @@ ys_resolve_type(yang_stmt    *ys,
     if (yang_type_cache_set(ys, resolved, options, cvv,
                             patterns, fraction) < 0)
         goto done;
+    /* Compile patterns once here instead of at first validation */
+    if (h != NULL && cvec_len(patterns) != 0 &&
+        ys_resolve_regexps(h, ys, patterns) < 0)
+        goto done;
     retval = 0;
  done:
     if (patterns)
@@ -799,108 +869,168 @@ ys_cv_validate_leafref(clicon_handle h,
     goto done;
 }
 
-/*!
+/*! Resolve member types of a union and add them to a member vector
+ *
+ * Nested unions are flattened, their members get the index of the top-level member type.
+ * Patterns of member types are compiled if not already done
+ * @param[in]     h       Clixon handle
+ * @param[in]     ys      Yang statement (leaf or leaf-list)
+ * @param[in]     yunion  Resolved union type
+ * @param[in]     type    Original type
+ * @param[in]     index   Index of top-level member, or -1 if yunion is the top-level union
+ * @param[in,out] vec     Member vector, free with yang_type_members_free
+ * @param[in,out] len     Length of vec
+ * @retval        0       OK
+ * @retval       -1       Error
+ * @see ys_cv_validate_union
+ */
+static int
+ys_union_members_add(clicon_handle     h,
+                     yang_stmt        *ys,
+                     yang_stmt        *yunion,
+                     char             *type,
+                     int               index,
+                     yang_type_member **vec,
+                     int              *len)
+{
+    int               retval = -1;
+    yang_stmt        *yt = NULL;
+    yang_stmt        *yrestype;
+    char             *restype;
+    cvec             *patterns = NULL;
+    cvec             *regexps = NULL;
+    yang_type_member *ym;
+    int               options;
+    cvec             *cvv;
+    uint8_t           fraction;
+    int               i = 0;
+
+    while ((yt = yn_each(yunion, yt)) != NULL){
+        if (yang_keyword_get(yt) != Y_TYPE)
+            continue;
+        if ((regexps = cvec_new(0)) == NULL ||
+            (patterns = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        options = 0;
+        cvv = NULL;
+        fraction = 0;
+        if (yang_type_resolve(ys, ys, yt, &yrestype, &options, &cvv, patterns, regexps,
+                              &fraction) < 0)
+            goto done;
+        if (yrestype == NULL){
+            clicon_err(OE_YANG, 0, "result-type should not be NULL");
+            goto done;
+        }
+        restype = yang_argument_get(yrestype);
+        if (strcmp(restype, "union") == 0){      /* recursive union */
+            if (ys_union_members_add(h, ys, yrestype, type, index<0?i:index, vec, len) < 0)
+                goto done;
+        }
+        else {
+            /* The regexp cache may be invalidated, in that case re-compile */
+            if (cvec_len(patterns)!=0 && cvec_len(regexps)==0){
+                if (compile_pattern2regexp(h, patterns, regexps) < 1)
+                    goto done;
+                if (yang_type_cache_regexp_set(yt,
+                                               clicon_yang_regexp(h),
+                                               regexps) < 0)
+                    goto done;
+            }
+            if ((*vec = realloc(*vec, (*len+1)*sizeof(**vec))) == NULL){
+                clicon_err(OE_UNIX, errno, "realloc");
+                goto done;
+            }
+            ym = &(*vec)[(*len)++];
+            memset(ym, 0, sizeof(*ym));
+            ym->ym_index = index<0?i:index;
+            ym->ym_resolved = yrestype;
+            ym->ym_options = options;
+            ym->ym_cvv = cvv;
+            ym->ym_fraction = fraction;
+            ym->ym_cvtype = CGV_ERR; /* leafref is resolved at validation */
+            if (strcmp(restype, "leafref") != 0 &&
+                clicon_type2cv(type, restype, ys, &ym->ym_cvtype) < 0)
+                goto done;
+            ym->ym_regexps = regexps; /* consumed */
+            regexps = NULL;
+        }
+        if (regexps){
+            cvec_free(regexps);
+            regexps = NULL;
+        }
+        cvec_free(patterns);
+        patterns = NULL;
+        i++;
+    }
+    retval = 0;
+ done:
+    if (patterns)
+        cvec_free(patterns);
+    if (regexps)
+        cvec_free(regexps);
+    return retval;
+}
+
+/*! Validate value against one resolved member type of a union
+ *
  * @param[in]  h      Clixon handle
- * @param[in]  ys     Yang statement (union)
+ * @param[in]  ys     Yang statement (leaf or leaf-list)
  * @param[out] reason If given, and return value is 0, contains malloced string
- * param[in]   yt     One of the types in the union
- * param[in]   type   Original type
+ * @param[in]  ym     Resolved member type
  * @param[in]  val    Value to match
  * @retval     -1     Error (fatal), with errno set to indicate error
  * @retval     0      Validation not OK, malloced reason is returned. Free reason with free()
  * @retval     1      Validation OK
  */
 static int
-ys_cv_validate_union_one(clicon_handle h,
-                         yang_stmt    *ys,
-                         char        **reason,
-                         yang_stmt    *yt,
-                         char         *type,  /* orig type */
-                         char         *val)
+ys_cv_validate_union_one(clicon_handle     h,
+                         yang_stmt        *ys,
+                         char            **reason,
+                         yang_type_member *ym,
+                         char             *val)
 {
     int          retval = -1;
-    yang_stmt   *yrestype;      /* union subtype */
-    int          options = 0;
-    cvec        *cvv = NULL;
-    cvec        *regexps = NULL;
-    cvec        *patterns = NULL;
-    uint8_t      fraction = 0; 
-    char        *restype;
-    enum cv_type cvtype;
-    cg_var      *cvt=NULL;
-    yang_stmt   *ysubt = NULL;
+    cg_var      *cvt = NULL;
 
-    if ((regexps = cvec_new(0)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_new");
+    /* Leafref needs to resolve referred node for type information */
+    if (ym->ym_cvtype == CGV_ERR){
+        if ((retval = ys_cv_validate_leafref(h, val, ys, ym->ym_resolved, NULL, reason)) < 0)  /* XXX: ysub? */
+            goto done;
         goto done;
     }
-    if ((patterns = cvec_new(0)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_new");
+    if (val == NULL){ /* Fail validation on NULL */
+        retval = 0;
         goto done;
     }
-    if (yang_type_resolve(ys, ys, yt, &yrestype, &options, &cvv, patterns, regexps,
-                          &fraction) < 0)
+    /* reparse value with the member type */
+    if ((cvt = cv_new(ym->ym_cvtype)) == NULL){
+        clicon_err(OE_UNIX, errno, "cv_new");
         goto done;
-    if (yrestype == NULL){
-        clicon_err(OE_YANG, 0, "result-type should not be NULL");
-        goto done;
-    }
-    restype = yrestype?yang_argument_get(yrestype):NULL;
-    if (restype && strcmp(restype, "union") == 0){      /* recursive union */
-        if ((retval = ys_cv_validate_union(h, ys, reason, yrestype, type, val, &ysubt)) < 0)
-            goto done;
     }
-        /* Leafref needs to resolve referred node for type information */
-    else if (restype && strcmp(restype,"leafref") == 0){
-        if ((retval = ys_cv_validate_leafref(h, val, ys, yrestype, NULL, reason)) < 0)  /* XXX: ysub? */
-            goto done;
-    }
-    else {
-        if (clicon_type2cv(type, restype, ys, &cvtype) < 0)
-            goto done;
-        /* reparse value with the new type */
-        if ((cvt = cv_new(cvtype)) == NULL){
-            clicon_err(OE_UNIX, errno, "cv_new");
-            goto done;
-        }
-        if (cvtype == CGV_DEC64)
-            cv_dec64_n_set(cvt, fraction);
-        if (val == NULL){ /* Fail validation on NULL */
-            retval = 0;
-            goto done;
-        }
-        if ((retval = cv_parse1(val, cvt, reason)) < 0){
-            clicon_err(OE_UNIX, errno, "cv_parse");
-            goto done;
-        }
-        if (retval == 0)
-            goto done;
-        /* The regexp cache may be invalidated, in that case re-compile
-         * eg due to copying
-         */
-        if (cvec_len(patterns)!=0 && cvec_len(regexps)==0){
-            if (compile_pattern2regexp(h, patterns, regexps) < 1)
-                goto done;
-            if (yang_type_cache_regexp_set(yt,
-                                           clicon_yang_regexp(h),
-                                           regexps) < 0)
-                goto done;
-        }
-        if ((retval = cv_validate1(h, cvt, cvtype, options, cvv, 
-                                   regexps, yrestype, restype, reason)) < 0)
-            goto done;
+    if (ym->ym_cvtype == CGV_DEC64)
+        cv_dec64_n_set(cvt, ym->ym_fraction);
+    if ((retval = cv_parse1(val, cvt, reason)) < 0){
+        clicon_err(OE_UNIX, errno, "cv_parse");
+        goto done;
     }
+    if (retval == 0)
+        goto done;
+    if ((retval = cv_validate1(h, cvt, ym->ym_cvtype, ym->ym_options, ym->ym_cvv,
+                               ym->ym_regexps, ym->ym_resolved,
+                               yang_argument_get(ym->ym_resolved), reason)) < 0)
+        goto done;
  done:
-    if (patterns)
-        cvec_free(patterns);
-    if (regexps)
-        cvec_free(regexps);
     if (cvt)
         cv_free(cvt);
     return retval;
 }
 
 /*! Validate union
+ *
+ * The member types of the union are resolved once, and cached in the type cache of the
+ * union type, so that validation is a loop over the resolved member types
  * @param[in]  h        Clixon handle
  * @param[in]  ys       Yang statement (union)
  * @param[out] reason   If given, and return value is 0, contains malloced string
@@ -921,14 +1051,24 @@ ys_cv_validate_union(clicon_handle h,
                      char         *val,
                      yang_stmt   **ysubp)
 {
-    int        retval = 1; /* valid */
-    yang_stmt *yt = NULL;
-    char      *reason1 = NULL;  /* saved reason */
-
-    while ((yt = yn_each(yrestype, yt)) != NULL){
-        if (yang_keyword_get(yt) != Y_TYPE)
-            continue;
-        if ((retval = ys_cv_validate_union_one(h, ys, reason, yt, type, val)) < 0)
+    int               retval = -1;
+    yang_stmt        *yt = NULL;
+    char             *reason1 = NULL;  /* saved reason */
+    yang_type_member *vec = NULL;
+    int               len = 0;
+    int               cached;
+    int               i;
+    int               j;
+
+    if ((cached = yang_type_cache_members_get(yrestype, &vec, &len)) == 0){
+        if (ys_union_members_add(h, ys, yrestype, type, -1, &vec, &len) < 0)
+            goto done;
+        if ((cached = yang_type_cache_members_set(yrestype, vec, len)) < 0)
+            goto done;
+    }
+    retval = 1; /* valid */
+    for (i=0; i<len; i++){
+        if ((retval = ys_cv_validate_union_one(h, ys, reason, &vec[i], val)) < 0)
             goto done;
         /* If validation failed, save reason, reset error and continue,
          * save latest reason if noithing validates.
@@ -942,8 +1082,16 @@ ys_cv_validate_union(clicon_handle h,
         /* Enough that one type validates value, return that value
          */
         if (retval == 1) {
-            if (ysubp)
+            if (ysubp){
+                j = 0;
+                while ((yt = yn_each(yrestype, yt)) != NULL){
+                    if (yang_keyword_get(yt) != Y_TYPE)
+                        continue;
+                    if (j++ == vec[i].ym_index)
+                        break;
+                }
                 *ysubp = yt;
+            }
             break;
         }
     }
@@ -954,6 +1102,8 @@ ys_cv_validate_union(clicon_handle h,
     }
     if (reason1)
         free(reason1);
+    if (cached != 1)
+        yang_type_members_free(vec, len);
     return retval;
 }
 
@@ -1216,6 +1366,28 @@ yang_find_identity_nsc(yang_stmt *yspec,
     return yid;
 }
 
+/*! Check if an identity is derived from a base identity
+ *
+ * Hash lookup if the base identity has many derived identities, see YANG_INDEX 
+ * @param[in] ybaseid  Base identity
+ * @param[in] idref    Identity in canonical form <module>:<id>
+ * @retval    1        idref is derived from ybaseid
+ * @retval    0        idref is not derived from ybaseid
+ * @see ys_populate_identity  where the derived identities are set
+ */
+int
+yang_identity_derived(yang_stmt  *ybaseid,
+                      const char *idref)
+{
+#ifdef YANG_INDEX
+    int derived;
+
+    if (yang_index_identity_derived(ybaseid, idref, &derived) == 1)
+        return derived;
+#endif
+    return cvec_find(yang_cvec_get(ybaseid), idref) != NULL;
+}
+
 /*! Resolve type restrictions, return constraining parameters
  *
  * This is for types with range/length/regexp restrictions of the base type
@@ -1325,8 +1497,6 @@ yang_type_resolve(yang_stmt   *yorig,
         *options = 0x0;
     *yrestype    = NULL; /* Initialization of resolved type that may not be necessary */
 
-    if (nodeid_split(yang_argument_get(ytype), &prefix, &type) < 0)
-        goto done;
     /* Cache does not work for eg string length 32? */
 #if 1
     if ((ret = yang_type_cache_get(ytype, yrestype,
@@ -1342,6 +1512,8 @@ yang_type_resolve(yang_stmt   *yorig,
         goto ok;
     }
 #endif
+    if (nodeid_split(yang_argument_get(ytype), &prefix, &type) < 0)
+        goto done;
     /* Check if type is basic type. If so, return that */
     if ((prefix == NULL && yang_builtin(type))){
         *yrestype = ytype; 
@@ -1402,7 +1574,7 @@ yang_type_resolve(yang_stmt   *yorig,
   done:
 #if 1
     if (retval == 0 && yrestype != NULL && *yrestype == NULL){
-        clicon_err(OE_YANG, 0, "No such type: \"%s\"", type);
+        clicon_err(OE_YANG, 0, "No such type: \"%s\"", yang_argument_get(ytype));
         retval = -1;
     }
 #endif
@@ -236,6 +236,7 @@ if $SNMPCHECK; then
         snmpwalk="$(type -p snmpwalk) -c public -v2c localhost "
     fi
     snmpwalkstr="$(type -p snmpwalk) -c public -v2c localhost "
+    snmpbulkwalk="$(type -p snmpbulkwalk) -c public -v2c localhost "
     snmptranslate="$(type -p snmptranslate) "
 
     if [ "${ENABLE_NETSNMP}" == "yes" ]; then
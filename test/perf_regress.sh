@@ -0,0 +1,284 @@
+#!/usr/bin/env bash
+# Performance regression check of large lists. See doc/scaling/large-lists.md
+# Runs the scaling scenarios of plot_perf.sh for a set of sizes, writes the result as CSV
+# and JSON, and compares with a stored baseline.
+# Each result is the time in milliseconds of:
+#   startup: start backend once with N entries in startup
+#   put:     write N entries into candidate in one edit-config
+#   commit:  commit N entries from candidate to empty running
+#   get:     read N entries from running in one get-config
+#   get1:    read 1 entry, <reqs> times, in a datastore of N entries
+#   put1:    write 1 entry, <reqs> times, in a datastore of N entries
+#   delete:  delete N entries from candidate and commit
+# Restconf is measured for get and put if "restconf" is in <protos>.
+# Examples
+# 1. Run and store result as baseline in baseline.csv
+#    sizes="1000 10000" resdir=/tmp/perf update=true baseline=/tmp/perf/baseline.csv ./perf_regress.sh
+# 2. Run and compare with baseline, fail if any time is more than 30% and 50ms slower
+#    sizes="1000 10000" tolerance=30 mintime=50 baseline=/tmp/perf/baseline.csv ./perf_regress.sh
+# 3. Also run with 10^6 entries and restconf
+#    sizes="1000 10000 100000 1000000" protos="netconf restconf" ./perf_regress.sh
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Default values
+: ${sizes:="1000 10000 100000"} # Number of entries N
+: ${reqs:=100}          # Number of requests in each single entry burst
+: ${protos:=netconf}    # Protocols, alt: "netconf restconf"
+: ${resdir:=$dir}       # Result dir
+: ${baseline:=}         # Baseline CSV file, if set compare with it
+: ${update:=false}      # If true, write result to baseline instead of comparing
+: ${tolerance:=20}      # Allowed slowdown in percent
+: ${mintime:=20}        # Allowed slowdown in ms regardless of percent, to ignore noise
+
+APPNAME=example
+cfg=$dir/perf-conf.xml
+fyang=$dir/scaling.yang
+fxml=$dir/data.xml
+fjson=$dir/data.json
+
+if [ ! -d $resdir ]; then
+    mkdir -p $resdir
+fi
+
+rev=$(git rev-parse --short HEAD 2> /dev/null || echo unknown)
+host=$(uname -n)
+arch=$(uname -m)
+ncpu=$(nproc)
+now=$(date -u +%Y-%m-%dT%H:%M:%SZ)
+
+fcsv=$resdir/perf-$rev-$arch.csv
+fres=$resdir/perf-$rev-$arch.json
+
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix sc;
+   container x {
+      list y {
+         key "a";
+         leaf a {
+            type int32;
+         }
+         leaf b {
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+RESTCONFIG=$(restconf_config none false)
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+# Print <nr> list entries as XML
+# 1: <nr>
+function genxml()
+{
+    seq 0 $(($1-1)) | awk '{printf "<y><a>%d</a><b>%d</b></y>", $1, $1}'
+}
+
+# Time in ms since epoch
+function now_ms()
+{
+    echo $(( $(date +%s%N) / 1000000 ))
+}
+
+# Run a command and add its time to the result file
+# 1: <op>
+# 2: <proto>
+# 3: <nr>
+# 4..: command
+function measure()
+{
+    op=$1
+    proto=$2
+    nr=$3
+    shift 3
+    new "measure $op $proto $nr"
+    t0=$(now_ms)
+    "$@" > /dev/null
+    t1=$(now_ms)
+    echo "$op,$proto,$nr,$((t1-t0))" >> $fcsv
+}
+
+# Send a file of netconf to netconf client
+# 1: <file>
+function netconf_file()
+{
+    $clixon_netconf -qf $cfg < $1
+}
+
+# Send rpc:s as one session to netconf client
+# 1..: <rpc>
+function netconf_rpc()
+{
+    {
+        echo -n "$DEFAULTHELLO"
+        for rpc in "$@"; do
+            chunked_framing "$rpc"
+        done
+    } | $clixon_netconf -qf $cfg
+}
+
+# 1: <nr>
+function netconf_get1()
+{
+    for (( i=0; i<$reqs; i++ )); do
+        rnd=$(( RANDOM % $1 ))
+        if [ $i = 0 ]; then
+            echo -n "$DEFAULTHELLO"
+        fi
+        chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/sc:x/sc:y[sc:a=$rnd]\" xmlns:sc=\"urn:example:clixon\"/></get-config></rpc>"
+    done | $clixon_netconf -qf $cfg
+}
+
+# 1: <nr>
+function netconf_put1()
+{
+    for (( i=0; i<$reqs; i++ )); do
+        rnd=$(( RANDOM % $1 ))
+        if [ $i = 0 ]; then
+            echo -n "$DEFAULTHELLO"
+        fi
+        chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$rnd</a><b>x$rnd</b></y></x></config></edit-config></rpc>"
+    done | $clixon_netconf -qf $cfg
+}
+
+function restconf_put()
+{
+    curl $CURLOPTS -X PUT -H 'Content-Type: application/yang-data+json' -d @$fjson $RCPROTO://localhost/restconf/data/scaling:x
+}
+
+function restconf_get()
+{
+    curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/scaling:x?content=config
+}
+
+# 1: <nr>
+function restconf_get1()
+{
+    for (( i=0; i<$reqs; i++ )); do
+        rnd=$(( RANDOM % $1 ))
+        curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/scaling:x/y=$rnd?content=config
+    done
+}
+
+# Delete all entries in candidate and running
+function reset()
+{
+    new "reset"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>none</default-operation><config operation='delete'/></edit-config></rpc><rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply><rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+# Run all scenarios with <nr> entries
+# 1: <nr>
+function runall()
+{
+    nr=$1
+
+    new "generate $nr entries"
+    rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><x xmlns=\"urn:example:clixon\">$(genxml $nr)</x></config></edit-config></rpc>"
+    echo -n "$DEFAULTHELLO" > $fxml
+    chunked_framing "$rpc" >> $fxml
+    echo -n '{"scaling:x":{"y":[' > $fjson
+    seq 0 $(($nr-1)) | awk '{printf "%s{\"a\":%d,\"b\":\"%d\"}", NR>1?",":"", $1, $1}' >> $fjson
+    echo ']}}' >> $fjson
+
+    # Startup before regular backend start
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        echo "<config><x xmlns=\"urn:example:clixon\">$(genxml $nr)</x></config>" > $dir/startup_db
+        measure startup - $nr sudo $clixon_backend -F1 -D $DBG -s startup -f $cfg
+
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+    fi
+    new "wait backend"
+    wait_backend
+    if [ $RC -ne 0 ] && [[ "$protos" == *restconf* ]]; then
+        new "kill old restconf daemon"
+        stop_restconf_pre
+        new "start restconf daemon"
+        start_restconf -f $cfg
+        new "wait restconf"
+        wait_restconf
+    fi
+
+    measure put netconf $nr netconf_file $fxml
+    measure commit netconf $nr netconf_rpc "<rpc $DEFAULTNS><commit/></rpc>"
+    measure get netconf $nr netconf_rpc "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>"
+    measure get1 netconf $nr netconf_get1 $nr
+    measure put1 netconf $nr netconf_put1 $nr
+    measure delete netconf $nr netconf_rpc "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\" nc:operation=\"delete\"/></config></edit-config></rpc>" "<rpc $DEFAULTNS><commit/></rpc>"
+
+    if [ $RC -ne 0 ] && [[ "$protos" == *restconf* ]]; then
+        reset
+        measure put restconf $nr restconf_put
+        measure get restconf $nr restconf_get
+        measure get1 restconf $nr restconf_get1 $nr
+
+        new "Kill restconf daemon"
+        stop_restconf
+    fi
+    reset
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        stop_backend -f $cfg
+    fi
+}
+
+echo "op,proto,nr,ms" > $fcsv
+for nr in $sizes; do
+    runall $nr
+done
+
+new "write $fres"
+awk -F, -v rev="$rev" -v host="$host" -v arch="$arch" -v ncpu="$ncpu" -v now="$now" '
+BEGIN { printf "{\"revision\":\"%s\",\"host\":\"%s\",\"arch\":\"%s\",\"cpus\":%s,\"date\":\"%s\",\"unit\":\"ms\",\"results\":[", rev, host, arch, ncpu, now }
+NR > 1 { printf "%s{\"op\":\"%s\",\"proto\":\"%s\",\"nr\":%s,\"time\":%s}", NR>2?",":"", $1, $2, $3, $4 }
+END { print "]}" }' $fcsv > $fres
+
+if [ -n "$baseline" ]; then
+    if $update; then
+        new "update baseline $baseline"
+        cp $fcsv $baseline
+    else
+        new "compare with baseline $baseline tolerance $tolerance% $mintime ms"
+        # Print all results and mark regressions, exit status is number of regressions
+        awk -F, -v tol=$tolerance -v mint=$mintime '
+NR == FNR { if (FNR > 1) base[$1","$2","$3] = $4; next }
+FNR > 1 {
+    k = $1","$2","$3
+    if (!(k in base)) { printf "%-8s %-9s %8s %10s %10s\n", $1, $2, $3, "-", $4; next }
+    mark = ""
+    if ($4 > base[k] * (1 + tol/100) && $4 - base[k] > mint) { mark = " REGRESSION"; nreg++ }
+    printf "%-8s %-9s %8s %10s %10s%s\n", $1, $2, $3, base[k], $4, mark
+}
+END { exit nreg > 255 ? 255 : nreg }' $baseline $fcsv
+        if [ $? -ne 0 ]; then
+            err "No regression compared to $baseline" "Regression, see $fcsv"
+        fi
+    fi
+fi
+
+new "endtest"
+endtest
@@ -0,0 +1,152 @@
+#!/usr/bin/env bash
+# Autocli cache of generated clispec, see CLICON_YANG_CACHE_DIR
+# Start the cli once to save the cache, then again to load it
+# Check that the cache is not used if a yang file or the autocli config is changed
+# Then run commands from the cached clispec
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+clispec=$dir/spec.cli
+ydir=$dir/yang
+cdir=$dir/cache
+fyang=$ydir/clixon-example.yang
+
+test -d $ydir || mkdir $ydir
+test -d $cdir || mkdir $cdir
+
+cat <<EOF > $fyang
+module clixon-example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type uint32{
+                    range "0..100";
+                }
+            }
+        }
+    }
+}
+EOF
+
+cat <<EOF > $clispec
+CLICON_MODE="example";
+CLICON_PROMPT="%U@%H %W> ";
+
+# Autocli syntax tree operations
+set @datamodel, cli_auto_set();
+delete("Delete a configuration item") @datamodel, cli_auto_del();
+commit("Commit the changes"), cli_commit();
+show("Show a particular state of the system"){
+    configuration("Show configuration"), cli_show_auto_mode("candidate", "xml", false, false);
+}
+EOF
+
+# 1: autocli module-default
+autocli_cfg(){
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$ydir</CLICON_YANG_MAIN_DIR>
+  <CLICON_YANG_CACHE_DIR>$cdir</CLICON_YANG_CACHE_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_CLISPEC_DIR>$dir</CLICON_CLISPEC_DIR>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <autocli>
+     <module-default>$1</module-default>
+     <list-keyword-default>kw-nokey</list-keyword-default>
+     <treeref-state-default>false</treeref-state-default>
+     <rule>
+       <name>include example</name>
+       <operation>enable</operation>
+       <module-name>clixon-example</module-name>
+     </rule>
+  </autocli>
+</clixon-config>
+EOF
+}
+
+# Start cli once with debug and check if cache is loaded or saved
+# 1: expected debug message
+cli_once(){
+    expectpart "$($clixon_cli -1 -f $cfg -D 1 -l e show configuration 2>&1)" 0 "$1"
+}
+
+autocli_cfg false
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "cli saves autocli cache"
+cli_once "autocli_cache_save saved $cdir/basemodel.acache"
+
+new "autocli cache file exists"
+if [ ! -f $cdir/basemodel.acache ]; then
+    err "$cdir/basemodel.acache" ""
+fi
+
+new "cli loads autocli cache"
+cli_once "autocli_cache_load loaded $cdir/basemodel.acache"
+
+new "yang file changed"
+sed -i 's/range "0..100"/range "0..99"/' $fyang
+cli_once "autocli_cache_save saved"
+
+new "cli loads new autocli cache"
+cli_once "autocli_cache_load loaded"
+
+new "autocli config changed"
+autocli_cfg true
+cli_once "autocli_cache_save saved"
+
+new "cli loads autocli cache again"
+cli_once "autocli_cache_load loaded"
+
+new "cli set from cache"
+expectpart "$($clixon_cli -1 -f $cfg set table parameter x value 42)" 0 "^$"
+
+new "cli set out of range from cache"
+expectpart "$($clixon_cli -1 -f $cfg set table parameter x value 100 2>&1)" 255 "out of range"
+
+new "cli show from cache"
+expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "<table xmlns=\"urn:example:clixon\"><parameter><name>x</name><value>42</value></parameter></table>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+sudo rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,133 @@
+#!/usr/bin/env bash
+# Autocli lazy generation of top-level container sub-trees, see clixon-autocli lazy
+# One-shot commands only generate the sub-trees they refer to
+# Interactive commands, completion and edit-modes see the complete tree
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fspec=$dir/automode.cli
+fin=$dir/in
+fyang=$dir/clixon-example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_CLISPEC_DIR>$dir</CLICON_CLISPEC_DIR>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <autocli>
+     <module-default>false</module-default>
+     <list-keyword-default>kw-nokey</list-keyword-default>
+     <treeref-state-default>false</treeref-state-default>
+     <lazy>true</lazy>
+     <rule>
+       <name>include example</name>
+       <operation>enable</operation>
+       <module-name>clixon-example</module-name>
+     </rule>
+  </autocli>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type uint32;
+            }
+        }
+    }
+    container other{
+        leaf x{
+            type string;
+        }
+    }
+}
+EOF
+
+cat <<EOF > $fspec
+CLICON_MODE="example";
+CLICON_PROMPT="%U@%H %w> ";
+
+# Autocli syntax tree operations
+edit @datamodelmode, cli_auto_edit("basemodel");
+up, cli_auto_up("basemodel");
+top, cli_auto_top("basemodel");
+set @datamodel, cli_auto_set();
+delete("Delete a configuration item") @datamodel, cli_auto_del();
+commit("Commit the changes"), cli_commit();
+show("Show a particular state of the system"){
+    configuration("Show configuration"), cli_show_auto_mode("candidate", "xml", false, false);
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "one-shot set generates table only"
+expectpart "$($clixon_cli -1 -f $cfg -D 1 -l e set table parameter a value 42 2>&1)" 0 "yang2cli_lazy lazy-urn:example:clixon-table" --not-- "lazy-urn:example:clixon-other"
+
+new "one-shot show generates nothing"
+expectpart "$($clixon_cli -1 -f $cfg -D 1 -l e show configuration 2>&1)" 0 "<table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>42</value></parameter></table>" --not-- "yang2cli_lazy lazy-"
+
+new "one-shot set abbreviated"
+expectpart "$($clixon_cli -1 -f $cfg set oth x foo)" 0 "^$"
+
+new "one-shot syntax error in sub-tree"
+expectpart "$($clixon_cli -1 -f $cfg set table parameter a value foo 2>&1)" 255 "CLI syntax error"
+
+new "interactive completion of sub-trees"
+expectpart "$(echo "set other ?" | $clixon_cli -f $cfg 2>&1)" 0 "x"
+
+cat <<EOF > $fin
+edit table parameter a
+show configuration
+EOF
+new "interactive edit table parameter a; show"
+expectpart "$(cat $fin | $clixon_cli -f $cfg 2>&1)" 0 "<name>a</name><value>42</value>" --not-- '<table xmlns="urn:example:clixon">'
+
+new "show configuration"
+expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "<table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>42</value></parameter></table><other xmlns=\"urn:example:clixon\"><x>foo</x></other>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,120 @@
+#!/usr/bin/env bash
+# Group commit of autocommit edits, see CLICON_AUTOCOMMIT_GROUP_WINDOW
+# Start concurrent autocommit edits and check that all are committed
+# Check that an invalid edit in a group fails only for its client
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/group.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_AUTOCOMMIT>1</CLICON_AUTOCOMMIT>
+  <CLICON_AUTOCOMMIT_GROUP_WINDOW>1000</CLICON_AUTOCOMMIT_GROUP_WINDOW>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module group{
+  yang-version 1.1;
+  namespace "urn:example:group";
+  prefix g;
+  container c{
+    list y{
+      key k;
+      leaf k{
+        type string;
+      }
+      leaf v{
+        type string;
+        must ". != 'bad'"{
+          error-message "bad value";
+        }
+      }
+    }
+  }
+}
+EOF
+
+# Edit list entry in background
+# 1: key
+# 2: value
+edit(){
+    k=$1
+    v=$2
+    rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:group\"><y><k>$k</k><v>$v</v></y></c></config></edit-config></rpc>"
+    $clixon_netconf -qef $cfg > $dir/out$k <<EOF &
+$DEFAULTHELLO$(chunked_framing "$rpc")
+EOF
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "concurrent autocommit edits"
+edit 1 a
+edit 2 b
+edit 3 c
+wait
+
+for k in 1 2 3; do
+    new "edit $k ok"
+    expectpart "$(cat $dir/out$k)" 0 "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+done
+
+new "check running"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:group\"><y><k>1</k><v>a</v></y><y><k>2</k><v>b</v></y><y><k>3</k><v>c</v></y></c></data></rpc-reply>"
+
+new "concurrent autocommit edits, one invalid"
+edit 4 d
+edit 5 bad
+wait
+
+new "valid edit ok"
+expectpart "$(cat $dir/out4)" 0 "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "invalid edit fails"
+expectpart "$(cat $dir/out5)" 0 "<rpc-error>" "bad value"
+
+new "check running"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:group\"><y><k>1</k><v>a</v></y><y><k>2</k><v>b</v></y><y><k>3</k><v>c</v></y><y><k>4</k><v>d</v></y></c></data></rpc-reply>"
+
+new "check candidate"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:group\"><y><k>1</k><v>a</v></y><y><k>2</k><v>b</v></y><y><k>3</k><v>c</v></y><y><k>4</k><v>d</v></y></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,114 @@
+#!/usr/bin/env bash
+# Output queues of backend clients, see CLICON_BACKEND_OUTPUT_HWM
+# Use a small high-water mark, so that large replies are queued and requests are not read
+# until the queue is written. Start concurrent clients reading a large reply and check that
+# all get the whole reply
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/output.yang
+
+# Number of list entries
+: ${perfnr:=5000}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_BACKEND_OUTPUT_HWM>1024</CLICON_BACKEND_OUTPUT_HWM>
+  <CLICON_BACKEND_OUTPUT_POLICY>drop</CLICON_BACKEND_OUTPUT_POLICY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module output{
+  yang-version 1.1;
+  namespace "urn:example:output";
+  prefix o;
+  container c{
+    list y{
+      key k;
+      leaf k{
+        type int32;
+      }
+      leaf v{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+data=""
+for (( i=0; i<$perfnr; i++ )); do
+    data+="<y><k>$i</k><v>value$i</v></y>"
+done
+
+# Get running in background
+# 1: client number
+get(){
+    nr=$1
+    rpc="<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>"
+    $clixon_netconf -qef $cfg > $dir/out$nr <<EOF &
+$DEFAULTHELLO$(chunked_framing "$rpc")
+EOF
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit $perfnr entries"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:output\">$data</c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "concurrent get-config"
+for nr in 1 2 3 4; do
+    get $nr
+done
+wait
+
+last=$((perfnr-1))
+for nr in 1 2 3 4; do
+    new "get-config $nr complete"
+    expectpart "$(cat $dir/out$nr)" 0 "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:output\"><y><k>0</k><v>value0</v></y>" "<y><k>$last</k><v>value$last</v></y></c></data></rpc-reply>"
+done
+
+new "get-config after large replies"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/o:c/o:y[o:k=1]\" xmlns:o=\"urn:example:output\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:output\"><y><k>1</k><v>value1</v></y></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+# Interactive requests at safe points of long RPCs, see CLICON_BACKEND_YIELD_INTERVAL
+# A large commit is made in the background while other clients ping the backend.
+# The scheduler statistics of the stats rpc show the yields and the request classes
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/yield.yang
+fconfig=$dir/large.xml
+
+# Number of list entries
+: ${perfnr:=50000}
+
+cat <<EOF > $fyang
+module yield{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+     list y {
+       key "a";
+       leaf a {
+         type int32;
+       }
+       leaf b {
+         type int32;
+       }
+     }
+   }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_NACM_MODE>disabled</CLICON_NACM_MODE>
+  <CLICON_BACKEND_YIELD_INTERVAL>1</CLICON_BACKEND_YIELD_INTERVAL>
+</clixon-config>
+EOF
+
+function stats_get()
+{
+    rpc=$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")
+    echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "stats scheduler with yield interval"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats $LIBNS/></rpc>" "<scheduler $LIBNS><yield-interval>1000</yield-interval>.*<class><name>interactive</name><target>1000</target>" "<class><name>bulk</name><missed>"
+
+new "generate config with $perfnr list entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\">"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<y><a>$i</a><b>$i</b></y>"
+done
+rpc+="</x></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fconfig
+echo "$(chunked_framing "$rpc")" >> $fconfig
+
+new "netconf write large config"
+expecteof_file "$clixon_netconf -qef $cfg" 0 "$fconfig" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$"
+
+new "commit large config in background"
+(echo "$HELLONO11<rpc $DEFAULTNS><commit/></rpc>]]>]]>" | $clixon_netconf -qf $cfg > /dev/null) &
+
+new "ping during commit"
+for (( i=0; i<5; i++ )); do
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><ping $LIBNS/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+done
+wait
+
+new "get-config last entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a='$((perfnr-1))']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>$((perfnr-1))</a><b>$((perfnr-1))</b></y></x></data></rpc-reply>"
+
+res=$(stats_get)
+
+new "check yields in long RPCs"
+match=$(echo "$res" | grep --null -o "<yields>[1-9][0-9]*</yields>")
+if [ -z "$match" ]; then
+    err "<yields>[1-9][0-9]*</yields>" "$res"
+fi
+
+new "check interactive requests"
+match=$(echo "$res" | grep --null -o "<class><name>interactive</name><target>1000</target><missed>[0-9]*</missed><preempted>[0-9]*</preempted><latency><count>[1-9][0-9]*</count>")
+if [ -z "$match" ]; then
+    err "<class><name>interactive</name>...<latency><count>" "$res"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
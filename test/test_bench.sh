@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+# Microbenchmarks of core library functions using clixon_util_bench
+# Run all benchmarks on small data to check they work, no timing limits are checked
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_bench:="clixon_util_bench"}
+
+: ${perfnr:=1000}
+
+new "all benchmarks $perfnr entries"
+expectpart "$($clixon_util_bench -n $perfnr -d 100 -w 1 -r 3)" 0 "^benchmark(us)" "xml_parse_list" "xml_parse_deep" "json_parse" "xml_bind_yang" "xml_sort" "xml_insert" "xml_search_binary" "xpath_vec " "xpath_vec_noopt" "xml_diff" "xml_yang_validate_all" "nacm_read" "xml2cbuf_list" "xml2cbuf_deep"
+
+new "xpath benchmarks as JSON"
+expectpart "$($clixon_util_bench -n $perfnr -w 0 -r 2 -b xpath -j)" 0 "{\"nr\":$perfnr,\"depth\":1000,\"warmup\":0,\"runs\":2,\"unit\":\"us\",\"benchmarks\":\[{\"name\":\"xpath_vec\",\"min\":[0-9.]*,\"p50\":" "{\"name\":\"xpath_vec_noopt\"" --not-- "xml_diff"
+
+new "single entry"
+expectpart "$($clixon_util_bench -n 1 -d 1 -r 1)" 0 "xml_diff"
+
+# unset conditional parameters
+unset clixon_util_bench
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,167 @@
+#!/usr/bin/env bash
+# YANG-CBOR encoding, name-based variant of RFC 9254
+# Encode JSON input as CBOR with clixon_util_json -C and compare with expected bytes,
+# decode CBOR with -c and check that the result is the same as from JSON
+# Then store the datastore in CBOR format, CLICON_XMLDB_FORMAT=cbor, and convert from/to xml
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_json:=clixon_util_json}
+: ${clixon_util_datastore:=clixon_util_datastore}
+
+fyang=$dir/cbor.yang
+
+cat <<EOF > $fyang
+module cbor{
+  yang-version 1.1;
+  namespace "urn:example:cbor";
+  prefix c;
+  identity base;
+  identity one{
+    base base;
+  }
+  container c{
+    leaf i8{
+      type int8;
+    }
+    leaf u64{
+      type uint64;
+    }
+    leaf d{
+      type decimal64{
+        fraction-digits 2;
+      }
+    }
+    leaf b{
+      type boolean;
+    }
+    leaf e{
+      type empty;
+    }
+    leaf s{
+      type string;
+    }
+    leaf bin{
+      type binary;
+    }
+    leaf id{
+      type identityref{
+        base base;
+      }
+    }
+    leaf-list ll{
+      type int32;
+    }
+    list l{
+      key k;
+      leaf k{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+# Hex dump of stdin
+hexdump(){
+    od -An -tx1 | tr -d ' \n'
+}
+
+json='{"cbor:c":{"i8":-5,"u64":"18446744073709551615","d":"12.50","b":true,"e":[null],"s":"x","bin":"AAE=","id":"one","ll":[1]}}'
+
+new "cbor encode"
+ret=$(echo -n "$json" | $clixon_util_json -y $fyang -C | hexdump)
+expect="a16663626f723a63a962693824637536341bffffffffffffffff6164c482211904e26162f56165f6617361786362696e420001626964636f6e65626c6c8101"
+if [ "$ret" != "$expect" ]; then
+    err "$expect" "$ret"
+fi
+
+new "cbor decode same as json"
+ret0=$(echo -n "$json" | $clixon_util_json -y $fyang -j)
+ret1=$(echo -n "$json" | $clixon_util_json -y $fyang -C | $clixon_util_json -c -y $fyang -j)
+if [ "$ret0" != "$ret1" ]; then
+    err "$ret0" "$ret1"
+fi
+
+new "cbor list and negative decimal roundtrip"
+json='{"cbor:c":{"d":"-0.05","l":[{"k":"a"},{"k":"b"}],"ll":[-1,2]}}'
+ret0=$(echo -n "$json" | $clixon_util_json -y $fyang -j)
+ret1=$(echo -n "$json" | $clixon_util_json -y $fyang -C | $clixon_util_json -c -y $fyang -j)
+if [ "$ret0" != "$ret1" ]; then
+    err "$ret0" "$ret1"
+fi
+
+new "cbor decode indefinite lengths"
+# {_ "cbor:c": {_ "s": (_ "a", "b"), "ll": [_ 1, 2]}}
+ret=$(printf '\xbf\x66cbor:c\xbf\x61s\x7f\x61a\x61b\xff\x62ll\x9f\x01\x02\xff\xff\xff' | $clixon_util_json -c -y $fyang)
+expectmatch "$ret" $? "0" "^<c xmlns=\"urn:example:cbor\"><s>ab</s><ll>1</ll><ll>2</ll></c>$"
+
+new "cbor decode truncated"
+expectpart "$(printf '\xa1\x66cbor' | $clixon_util_json -c -y $fyang 2>&1)" 255 "CBOR unexpected end of data"
+
+new "cbor decode trailing data"
+expectpart "$(printf '\xa0\x00' | $clixon_util_json -c -y $fyang 2>&1)" 255 "CBOR trailing data"
+
+new "cbor decode top-level not a map"
+expectpart "$(printf '\x81\x00' | $clixon_util_json -c -y $fyang 2>&1)" 255 "CBOR top-level item is not a map"
+
+new "cbor decode unknown module"
+expectpart "$(printf '\xa1\x65foo:c\xa0' | $clixon_util_json -c -y $fyang 2>&1)" 255 "<error-tag>unknown-namespace</error-tag>"
+
+xml="<c xmlns=\"urn:example:cbor\"><i8>-5</i8><d>1.00</d><e/><s>second &amp; entry</s><ll>1</ll><ll>2</ll><l><k>a</k></l></c>"
+
+mydir=$dir/cbor
+if [ ! -d $mydir ]; then
+    mkdir $mydir
+fi
+rm -rf $mydir/*
+
+conf="-d candidate -b $mydir -y $fyang"
+
+new "datastore cbor init"
+expectpart "$($clixon_util_datastore $conf -f cbor init)" 0 ""
+
+new "datastore cbor get empty"
+expectpart "$($clixon_util_datastore $conf -f cbor get /)" 0 "^<${DATASTORE_TOP}/>$"
+
+new "datastore cbor put all replace"
+expectpart "$($clixon_util_datastore $conf -f cbor put replace "$xml")" 0 ""
+
+new "datastore cbor file is a map"
+ret=$(head -c 1 $mydir/candidate_db | hexdump)
+if [ "$ret" != "a1" ]; then
+    err "a1" "$ret"
+fi
+
+new "datastore cbor get"
+expectpart "$($clixon_util_datastore $conf -f cbor get /)" 0 "^<${DATASTORE_TOP}>$xml</${DATASTORE_TOP}>$"
+
+new "datastore cbor put merge"
+expectpart "$($clixon_util_datastore $conf -f cbor put merge "<c xmlns=\"urn:example:cbor\"><u64>18446744073709551615</u64></c>")" 0 ""
+
+new "datastore cbor get merged"
+expectpart "$($clixon_util_datastore $conf -f cbor get /c/u64)" 0 "<u64>18446744073709551615</u64>"
+
+new "datastore convert cbor to xml"
+expectpart "$($clixon_util_datastore $conf -f cbor convert xml $dir/conv.xml)" 0 ""
+
+new "datastore converted file is xml"
+expectpart "$(cat $dir/conv.xml)" 0 "<${DATASTORE_TOP}>" "<u64>18446744073709551615</u64>"
+
+new "datastore convert xml to cbor"
+cp $dir/conv.xml $mydir/running_db
+expectpart "$($clixon_util_datastore -d running -b $mydir -y $fyang -f xml convert cbor $mydir/candidate_db)" 0 ""
+
+new "datastore cbor get converted"
+expectpart "$($clixon_util_datastore $conf -f cbor get /c/s)" 0 "<s>second &amp; entry</s>"
+
+new "datastore cbor delete"
+expectpart "$($clixon_util_datastore $conf -f cbor delete)" 0 ""
+
+rm -rf $mydir
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,140 @@
+#!/usr/bin/env bash
+# CLI script edits batched into one edit-config, see CLICON_CLI_BATCH_EDITS
+# Check number of edits sent together, chunks, edits of same node, and that errors
+# refer to script lines
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fspec=$dir/automode.cli
+fin=$dir/in
+fyang=$dir/clixon-example.yang
+
+: ${perfnr:=20}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_CLISPEC_DIR>$dir</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_BATCH_EDITS>1000</CLICON_CLI_BATCH_EDITS>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <autocli>
+     <module-default>false</module-default>
+     <list-keyword-default>kw-nokey</list-keyword-default>
+     <treeref-state-default>false</treeref-state-default>
+     <rule>
+       <name>include example</name>
+       <operation>enable</operation>
+       <module-name>clixon-example</module-name>
+     </rule>
+  </autocli>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type uint32;
+            }
+        }
+    }
+}
+EOF
+
+cat <<EOF > $fspec
+CLICON_MODE="example";
+CLICON_PROMPT="%U@%H %w> ";
+
+set @datamodel, cli_auto_set();
+create @datamodel, cli_auto_create();
+delete("Delete a configuration item") @datamodel, cli_auto_del();
+commit("Commit the changes"), cli_commit();
+show("Show a particular state of the system"){
+    configuration("Show configuration"), cli_show_auto_mode("candidate", "xml", false, false);
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+rm -f $fin
+for (( i=0; i<$perfnr; i++ )); do
+    echo "set table parameter p$i value $i" >> $fin
+done
+echo "commit" >> $fin
+new "script with $perfnr sets is one edit-config"
+expectpart "$($clixon_cli -f $cfg -F $fin -D 1 -l e 2>&1)" 0 "cli_batch_flush $perfnr edits lines 1-$perfnr"
+
+new "show all entries"
+expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "<parameter><name>p0</name><value>0</value></parameter>" "<parameter><name>p$(($perfnr-1))</name><value>$(($perfnr-1))</value></parameter>"
+
+new "script with chunks of 5 edits"
+expectpart "$($clixon_cli -f $cfg -o CLICON_CLI_BATCH_EDITS=5 -F $fin -D 1 -l e 2>&1)" 0 "cli_batch_flush 5 edits lines 1-5" "cli_batch_flush 5 edits lines 6-10"
+
+cat <<EOF > $fin
+set table parameter a value 1
+delete table parameter a value 1
+set table parameter a value 2
+set table parameter b value 3
+EOF
+new "edits of same node are sent in order"
+expectpart "$($clixon_cli -f $cfg -F $fin -D 1 -l e 2>&1)" 0 "cli_batch_flush 1 edits lines 1-1" "cli_batch_flush 1 edits lines 2-2" "cli_batch_flush 2 edits lines 3-4"
+
+new "show a and b"
+expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "<parameter><name>a</name><value>2</value></parameter><parameter><name>b</name><value>3</value></parameter>"
+
+cat <<EOF > $fin
+set table parameter c value 4
+create table parameter p1
+set table parameter d value 5
+show configuration
+EOF
+new "error refers to script lines"
+expectpart "$($clixon_cli -f $cfg -F $fin 2>&1)" 0 "Lines 1-3: "
+
+new "not batched without option"
+expectpart "$($clixon_cli -f $cfg -o CLICON_CLI_BATCH_EDITS=0 -F $fin -D 1 -l e 2>&1)" 0 "<name>c</name>" --not-- "cli_batch_flush"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
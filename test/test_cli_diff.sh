@@ -1,6 +1,7 @@
 #!/usr/bin/env bash
 # CLI compare for all formats
 # Create a diff by committing one set, then add/remove some parts in candidate and show diff in all formats
+# The backend datastore-diff rpc only sends the nodes that differ
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -171,6 +172,17 @@ expectpart "$($clixon_cli -1 -f $cfg show compare xml)" 0 "<table>" "^\-\ *<para
 new "check compare text"
 expectpart "$($clixon_cli -1 -f $cfg show compare text)" 0 "^\ *table {" "^\-\ *parameter a {" "^+\ *parameter c {" "^\-\ *value 98;" "^+\ *value 99;"
 
+LIBNS="xmlns=\"http://clicon.org/lib\""
+
+new "netconf datastore-diff only differing nodes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-diff $LIBNS><datastore1>running</datastore1><datastore2>candidate</datastore2></datastore-diff></rpc>" "" "<rpc-reply $DEFAULTNS><config1 $LIBNS><top xmlns=\"urn:example:clixon\"><section><name>x</name><table><parameter><name>a</name><value>17</value></parameter><parameter><name>d</name><value>98</value></parameter></table></section></top></config1><config2 $LIBNS><top xmlns=\"urn:example:clixon\"><section><name>x</name><table><parameter><name>c</name><value>72</value></parameter><parameter><name>d</name><value>99</value></parameter></table></section></top></config2></rpc-reply>"
+
+new "netconf datastore-diff no difference"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-diff $LIBNS><datastore1>candidate</datastore1><datastore2>candidate</datastore2></datastore-diff></rpc>" "" "<rpc-reply $DEFAULTNS><config1 $LIBNS/*>*\(</config1>\)*<config2 $LIBNS/*>*\(</config2>\)*</rpc-reply>"
+
+new "netconf datastore-diff no such datastore"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-diff $LIBNS><datastore1>running</datastore1><datastore2>xxx</datastore2></datastore-diff></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>protocol</error-type><error-tag>invalid-value</error-tag><error-severity>error</error-severity><error-message>No such datastore</error-message></rpc-error></rpc-reply>"
+
 new "delete section x"
 expectpart "$($clixon_cli -1 -f $cfg delete top section x)" 0 "^$"
 
@@ -2,6 +2,7 @@
 # CLIgen expand
 # Especially multi-level expansion, see https://github.com/clicon/clixon/issues/332
 # Have not been able to replicate it in cligen test_expand.sh
+# Expansion values are read with the datastore-values rpc and cached in the cli session
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -106,6 +107,37 @@ expectpart "$(echo "set list1 xyz list2 ?" | $clixon_cli -f $cfg 2>&1)" 0 123 ab
 new "Expand <TAB>"
 expectpart "$(echo "set list1 xyz list2 	" | $clixon_cli -f $cfg 2>&1)" 0 123 abc "<key2>"
 
+LIBNS="xmlns=\"http://clicon.org/lib\""
+
+new "netconf datastore-values"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-values $LIBNS><datastore>candidate</datastore><xpath xmlns:ex=\"urn:example:clixon\">/ex:list1[ex:key1='xyz']/ex:list2/ex:key2</xpath></datastore-values></rpc>" "" "<rpc-reply $DEFAULTNS><version $LIBNS>[0-9]*</version><values $LIBNS><value>123</value><value>abc</value></values></rpc-reply>"
+
+new "netconf datastore-values prefix"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-values $LIBNS><datastore>candidate</datastore><xpath xmlns:ex=\"urn:example:clixon\">/ex:list1/ex:list2/ex:key2</xpath><prefix>a</prefix></datastore-values></rpc>" "" "<rpc-reply $DEFAULTNS><version $LIBNS>[0-9]*</version><values $LIBNS><value>abc</value></values></rpc-reply>"
+
+new "netconf datastore-version"
+ret=$($clixon_netconf -qf $cfg<<EOF
+$DEFAULTHELLO<rpc $DEFAULTNS><datastore-version $LIBNS><datastore>candidate</datastore></datastore-version></rpc>]]>]]>
+EOF
+)
+version=$(echo "$ret" | sed 's/.*<version [^>]*>\([0-9]*\)<\/version>.*/\1/')
+if [ -z "$version" ]; then
+    err "version" "$ret"
+fi
+
+new "netconf datastore-values unchanged"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-values $LIBNS><datastore>candidate</datastore><xpath xmlns:ex=\"urn:example:clixon\">/ex:list1/ex:list2/ex:key2</xpath><version>$version</version></datastore-values></rpc>" "" "<rpc-reply $DEFAULTNS><version $LIBNS>$version</version><unchanged $LIBNS/></rpc-reply>"
+
+new "netconf datastore-values no such datastore"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-values $LIBNS><datastore>xxx</datastore><xpath>/</xpath></datastore-values></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>protocol</error-type><error-tag>invalid-value</error-tag><error-severity>error</error-severity><error-message>No such datastore</error-message></rpc-error></rpc-reply>"
+
+cat <<EOF > $dir/in
+set list1 xyz list2 def
+set list1 xyz list2 ?
+EOF
+new "Expand after change in same session"
+expectpart "$(cat $dir/in | $clixon_cli -f $cfg 2>&1)" 0 123 abc def
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
@@ -132,6 +132,9 @@ CLICON_MODE="|mypipe"; # Must start with |
      json, pipe_showas_fn("json");
      text, pipe_showas_fn("text");
    }
+   select <leaf:string> <value:string>, pipe_select_fn("leaf", "value", "xml", "false");{
+     text, pipe_select_fn("leaf", "value", "text");
+   }
 }
 EOF
 
@@ -182,6 +185,15 @@ expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| tail 5)" 0
 new "$mode show explicit | count"
 expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| count)" 0 10
 
+new "$mode show explicit | tail 0"
+expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| tail 0)" 0 "^$"
+
+new "$mode show explicit | select name y"
+expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| select name y)" 0 "<table xmlns=\"urn:example:clixon\"><parameter><name>y</name><value>b</value></parameter></table>" --not-- "<name>x</name>"
+
+new "$mode show explicit | select name z"
+expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| select name z)" 0 "<table xmlns=\"urn:example:clixon\"/>" --not-- "<name>"
+
 # XXX dont work with valgrind?                                                                   
 if [ $valgrindtest -eq 0 ]; then
 new "$mode show explicit | show json"
@@ -189,6 +201,9 @@ expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| show json)
 
 new "$mode show explicit | show text"
 expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| show text)" 0 "parameter x {" --not-- "<name>"
+
+new "$mode show explicit | select value a text"
+expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| select value a text)" 0 "parameter x {" --not-- "parameter y"
 fi # XXX
 
 new "$mode show treeref explicit | grep par"
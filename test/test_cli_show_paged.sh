@@ -0,0 +1,143 @@
+#!/usr/bin/env bash
+# CLI show of config lists page by page, see CLICON_CLI_SHOW_PAGE
+# The cli gets a page at a time from the backend using list-pagination cursors
+# Check that the paged output is the same as the complete output
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/paged.yang
+clispec=$dir/spec.cli
+
+# Number of list entries
+: ${perfnr:=10}
+
+# 1: page size
+paged_cfg(){
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$IETFRFC</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_CLISPEC_DIR>$dir</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_SHOW_PAGE>$1</CLICON_CLI_SHOW_PAGE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+}
+
+cat <<EOF > $fyang
+module paged{
+  yang-version 1.1;
+  namespace "urn:example:paged";
+  prefix p;
+  container c{
+    list e{
+      key "k1 k2";
+      leaf k1{
+        type string;
+      }
+      leaf k2{
+        type uint32;
+      }
+      leaf v{
+        type string;
+      }
+    }
+    leaf-list u{
+      type string;
+      ordered-by user;
+    }
+  }
+}
+EOF
+
+cat <<EOF > $clispec
+CLICON_MODE="example";
+CLICON_PROMPT="%U@%H %W> ";
+
+show("Show a particular state of the system"){
+    list("Show list"){
+        xml, cli_show_config("running", "xml", "/c/e", "urn:example:paged", false, false);
+        text, cli_show_config("running", "text", "/c/e", "urn:example:paged", false, false);
+        cli, cli_show_config("running", "cli", "/c/e", "urn:example:paged", false, false, NULL, "set ");
+        leaf-list, cli_show_config("running", "xml", "/c/u", "urn:example:paged", false, false);
+    }
+}
+EOF
+
+new "generate config with $perfnr list entries"
+echo "<config><c xmlns=\"urn:example:paged\">" > $dir/startup_db
+for (( i=0; i<$perfnr; i++ )); do
+    echo "<e><k1>a,b/$i</k1><k2>$i</k2><v>$i</v></e>" >> $dir/startup_db
+done
+echo "<u>c</u><u>a</u><u>b,x</u><u>d</u>" >> $dir/startup_db
+echo "</c></config>" >> $dir/startup_db
+
+paged_cfg 0
+
+new "test params: -f $cfg -s startup"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "show list xml complete"
+xml=$($clixon_cli -1 -f $cfg show list xml)
+text=$($clixon_cli -1 -f $cfg show list text)
+cli=$($clixon_cli -1 -f $cfg show list cli)
+ll=$($clixon_cli -1 -f $cfg show list leaf-list)
+expectpart "$xml" 0 "<e xmlns=\"urn:example:paged\"><k1>a,b/0</k1><k2>0</k2><v>0</v></e>" "<e xmlns=\"urn:example:paged\"><k1>a,b/9</k1><k2>9</k2><v>9</v></e>"
+
+for page in 3 1 $perfnr 100; do
+    paged_cfg $page
+
+    new "show list xml page $page"
+    expectpart "$($clixon_cli -1 -f $cfg show list xml)" 0 "^$xml$"
+
+    new "show list text page $page"
+    ret=$($clixon_cli -1 -f $cfg show list text)
+    if [ "$ret" != "$text" ]; then
+        err "$text" "$ret"
+    fi
+
+    new "show list cli page $page"
+    ret=$($clixon_cli -1 -f $cfg show list cli)
+    if [ "$ret" != "$cli" ]; then
+        err "$cli" "$ret"
+    fi
+
+    new "show ordered-by user leaf-list page $page"
+    expectpart "$($clixon_cli -1 -f $cfg show list leaf-list)" 0 "^$ll$" "<u xmlns=\"urn:example:paged\">c</u><u xmlns=\"urn:example:paged\">a</u><u xmlns=\"urn:example:paged\">b,x</u><u xmlns=\"urn:example:paged\">d</u>"
+done
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
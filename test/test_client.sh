@@ -42,6 +42,7 @@ cat <<EOF > $cfg
   <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
   <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
   <CLICON_XMLDB_FORMAT>$format</CLICON_XMLDB_FORMAT>
+  <CLICON_STREAM_DATASTORE>true</CLICON_STREAM_DATASTORE>
   $RESTCONFIG
 </clixon-config>
 EOF
@@ -75,11 +76,30 @@ cat<<EOF > $cfile
 #include <unistd.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+#include <poll.h>
 #include <syslog.h> // debug
 
 #include <clixon/clixon_log.h> // debug
 #include <clixon/clixon_client.h>
 
+/* Completion callback of asynchronous batch */
+static int
+batch_cb(clixon_client_handle ch,
+         clixon_client_result cr,
+         void                *arg)
+{
+    int i;
+
+    if (cr == NULL)
+        return -1;
+    printf("async %s:", (char*)arg);
+    for (i=0; i<clixon_client_result_len(cr); i++)
+        printf(" %s", clixon_client_result_str(cr, i));
+    printf("\n"); /* for test output */
+    return 0;
+}
+
 int
 main(int    argc,
      char **argv)
@@ -101,6 +121,23 @@ main(int    argc,
     s = clixon_client_socket_get(ch);
     if (clixon_client_hello(s, NULL, 0) < 0)
       return -1;
+    /* Cached reads, value of a is changed by the test during the reads */
+    if (argc > 1 && strcmp(argv[1], "cache") == 0){
+       uint32_t u = 0;
+       int      i;
+
+       if (clixon_client_cache_enable(ch) < 0)
+         goto done;
+       for (i=0; i<3; i++){
+          if (clixon_client_get_uint32(ch, &u, "urn:example:clixon-client", "/table/parameter[name='a']/value") < 0)
+            goto done;
+          printf("cache %d: %u\n", i, u); /* for test output */
+          fflush(stdout);
+          sleep(2);
+       }
+       retval = 0;
+       goto done;
+    }
     /* Here are read functions depending on an example YANG 
      * (Need an example YANG and XML input to confd)
      */
@@ -110,6 +147,40 @@ main(int    argc,
          goto done;
        printf("%u\n", u); /* for test output */
     }
+    /* Batch of values in one request, c does not exist */
+    {
+       const char          *xpaths[] = {"/table/parameter[name='a']/value",
+                                        "/table/parameter[name='b']/value",
+                                        "/table/parameter[name='c']/value"};
+       clixon_client_result cr = NULL;
+       char                *v;
+       int                  i;
+
+       if (clixon_client_get_batch(ch, "urn:example:clixon-client", xpaths, 3, &cr) < 0)
+         goto done;
+       for (i=0; i<clixon_client_result_len(cr); i++){
+          v = clixon_client_result_str(cr, i);
+          printf("batch %d: %s\n", i, v?v:"none"); /* for test output */
+       }
+       clixon_client_result_free(cr);
+    }
+    /* Two outstanding asynchronous batches, dispatched in an event loop */
+    {
+       const char   *xpaths[] = {"/table/parameter[name='b']/value",
+                                 "/table/parameter[name='a']/value"};
+       struct pollfd pfd = {s, POLLIN, 0};
+
+       if (clixon_client_get_batch_async(ch, "urn:example:clixon-client", xpaths, 2, batch_cb, "first") < 0)
+         goto done;
+       if (clixon_client_get_batch_async(ch, "urn:example:clixon-client", xpaths+1, 1, batch_cb, "second") < 0)
+         goto done;
+       while (clixon_client_async_pending(ch) > 0){
+          if (poll(&pfd, 1, 5000) <= 0)
+            goto done;
+          if (clixon_client_async_dispatch(ch) < 0)
+            goto done;
+       }
+    }
     retval = 0;
   done:
     clixon_client_disconnect(ch);
@@ -155,7 +226,7 @@ fi
 new "wait restconf"
 wait_restconf
 
-XML='<table xmlns="urn:example:clixon-client"><parameter><name>a</name><value>42</value></parameter></table>'
+XML='<table xmlns="urn:example:clixon-client"><parameter><name>a</name><value>42</value></parameter><parameter><name>b</name><value>17</value></parameter></table>'
 
 # Add a set of entries using restconf
 new "POST the XML"
@@ -165,7 +236,19 @@ new "Check entries"
 expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/clixon-client:table -H 'Accept: application/yang-data+xml')" 0 "HTTP/$HVER 200" "$XML"
 
 new "Run $app"
-expectpart "$($app)" 0 '^42$'
+expectpart "$($app)" 0 '^42$' "batch 0: 42" "batch 1: 17" "batch 2: none" "async first: 17 42" "async second: 42" "done"
+
+new "Run $app with read cache in background"
+$app cache > $dir/cache.out &
+sleep 1
+
+new "Change value during cached reads"
+expectpart "$(curl $CURLOPTS -X PUT -H 'Content-Type: application/yang-data+xml' $RCPROTO://localhost/restconf/data/clixon-client:table/parameter=a/value -d '<value xmlns="urn:example:clixon-client">99</value>')" 0 "HTTP/$HVER 204"
+
+wait
+
+new "Cached reads see the change"
+expectpart "$(cat $dir/cache.out)" 0 "cache 0: 42" "cache 2: 99" "done"
 
 if [ $RC -ne 0 ]; then
     new "Kill restconf daemon"
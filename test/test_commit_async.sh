@@ -0,0 +1,136 @@
+#!/usr/bin/env bash
+# Asynchronous commit with the clixon-lib commit-async rpc
+# The example backend plugin is started with -- -w <ms> and sleeps in its commit callback.
+# The reply with the job id is sent before the commit callbacks. A commit-job-done
+# notification is sent on the CLIXON-COMMIT stream and commit-job-status gives the state
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/async.yang
+
+# Commit callback sleep in ms
+: ${commitwait:=2000}
+
+cat <<EOF > $fyang
+module async{
+  yang-version 1.1;
+  namespace "urn:example:async";
+  prefix a;
+  container table{
+    must "not(value = 13)" {
+      error-message "Unlucky value";
+    }
+    leaf value{
+      type uint32;
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_STREAM_COMMIT>true</CLICON_STREAM_COMMIT>
+</clixon-config>
+EOF
+
+LIBNS="xmlns=\"http://clicon.org/lib\""
+SUBSCRIBE="<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>CLIXON-COMMIT</stream></create-subscription></rpc>"
+
+# Edit candidate
+# 1: value
+edit(){
+    new "edit-config value $1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:async\"><value>$1</value></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+# Edit and asynchronous commit in background
+# 1: sleep before
+# 2: value
+commit_bg(){
+    rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:async\"><value>$2</value></table></config></edit-config></rpc>]]>]]><rpc $DEFAULTNS><commit-async $LIBNS/></rpc>]]>]]>"
+    (sleep $1; echo "$HELLONO11$rpc" | $clixon_netconf -qf $cfg > /dev/null) &
+}
+
+new "test params: -f $cfg -- -w $commitwait"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -- -w $commitwait"
+    start_backend -s init -f $cfg -- -w $commitwait
+fi
+
+new "wait backend"
+wait_backend
+
+edit 1
+
+new "commit-async replies with job id before commit callback"
+start=$(date +%s%N)
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit-async $LIBNS/></rpc>" "" "<rpc-reply $DEFAULTNS><job-id $LIBNS>1</job-id></rpc-reply>"
+stop=$(date +%s%N)
+ms=$(( (stop - start) / 1000000 ))
+if [ $ms -ge $commitwait ]; then
+    err "reply in less than $commitwait ms" "$ms ms"
+fi
+
+new "commit-job-status job 1 completed"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit-job-status $LIBNS><job-id>1</job-id></commit-job-status></rpc>" "<rpc-reply $DEFAULTNS><job $LIBNS><job-id>1</job-id><session-id>[0-9]*</session-id><status>completed</status><version>[0-9]*</version></job></rpc-reply>" ""
+
+new "get-config running value 1"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:async\"><value>1</value></table></data></rpc-reply>"
+
+edit 13
+
+new "commit-async of invalid candidate fails synchronously"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit-async $LIBNS/></rpc>" "<error-message>Unlucky value</error-message>" "<rpc-reply $DEFAULTNS><rpc-error>"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit-job-done notification of job 3"
+commit_bg 2 3
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "$SUBSCRIBE" $NCWAIT "<rpc-reply $DEFAULTNS><ok/></rpc-reply>" "<commit-job-done $LIBNS><job-id>3</job-id><session-id>[0-9]*</session-id><status>completed</status><version>[0-9]*</version></commit-job-done>"
+
+new "commit after commit-async is made after the job"
+edit 4
+(echo "$HELLONO11<rpc $DEFAULTNS><commit-async $LIBNS/></rpc>]]>]]>" | $clixon_netconf -qf $cfg > /dev/null) &
+sleep 1
+edit 5
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+wait
+
+new "get-config running value 5"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:async\"><value>5</value></table></data></rpc-reply>"
+
+new "commit-job-status of all jobs"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit-job-status $LIBNS/></rpc>" "<job $LIBNS><job-id>3</job-id>.*<job $LIBNS><job-id>4</job-id><session-id>[0-9]*</session-id><status>completed</status>" "<job $LIBNS><job-id>1</job-id>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
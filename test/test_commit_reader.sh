@@ -0,0 +1,113 @@
+#!/usr/bin/env bash
+# Get-config of other clients during a slow commit, see CLICON_BACKEND_COMMIT_READER
+# The example backend plugin is started with -- -w <ms> and sleeps in its commit callback.
+# A client connected before the commit reads running during the commit. With the option
+# it gets the old running without waiting, without it the new running after the commit
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/reader.yang
+fget=$dir/get.xml
+
+# Commit callback sleep in ms
+: ${commitwait:=4000}
+
+cat <<EOF > $fyang
+module reader{
+  yang-version 1.1;
+  namespace "urn:example:reader";
+  prefix r;
+  container table{
+    leaf value{
+      type uint32;
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_BACKEND_COMMIT_READER>true</CLICON_BACKEND_COMMIT_READER>
+</clixon-config>
+EOF
+
+# Edit candidate
+# 1: value
+edit(){
+    new "edit-config value $1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:reader\"><value>$1</value></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+# Commit value 2 while another client reads running, check what it reads, and stop
+# 1: value expected by reader
+# 2: extra backend options
+reader_run(){
+    new "test params: -f $cfg $2 -- -w $commitwait"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg $2 -- -w $commitwait"
+        start_backend -s init -f $cfg $2 -- -w $commitwait
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    edit 1
+
+    new "commit value 1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    edit 2
+
+    new "reader connects, and reads running during commit"
+    rm -f $fget
+    (sleep 2; echo "$HELLONO11<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>]]>]]>"; sleep 1) | $clixon_netconf -qf $cfg > $fget &
+    sleep 1
+
+    new "commit value 2"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    wait
+
+    new "reader got value $1"
+    expectpart "$(cat $fget)" 0 "<data><table xmlns=\"urn:example:reader\"><value>$1</value></table></data>"
+
+    new "get-config running value 2 after commit"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:reader\"><value>2</value></table></data></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+new "old running is read during commit"
+reader_run 1
+
+new "option not set, read waits for commit"
+reader_run 2 "-o CLICON_BACKEND_COMMIT_READER=false"
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,192 @@
+#!/usr/bin/env bash
+# Commit timing and plugin callback statistics in the stats rpc
+# Compile a backend plugin with a commit callback, edit and commit twice, and check that
+# the commit phases and the plugin callback are counted
+# Also check plugin start callback and rpc callback statistics
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/stats.yang
+pdir=$dir/plugin
+
+if [ ! -d $pdir ]; then
+    mkdir $pdir
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>$pdir</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module stats{
+  yang-version 1.1;
+  namespace "urn:example:stats";
+  prefix s;
+  container c{
+    leaf a{
+      type string;
+    }
+  }
+}
+EOF
+
+cat <<EOF > $dir/ps.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syslog.h>
+
+/* clicon */
+#include <cligen/cligen.h>
+
+/* Clicon library functions. */
+#include <clixon/clixon.h>
+
+/* These include signatures for plugin and transaction callbacks. */
+#include <clixon/clixon_backend.h>
+
+static int
+ps_start(clicon_handle h)
+{
+    usleep(2000);
+    return 0;
+}
+
+static int
+ps_commit(clicon_handle    h,
+          transaction_data td)
+{
+    usleep(2000);
+    return 0;
+}
+
+clixon_plugin_api *clixon_plugin_init(clicon_handle h);
+
+static clixon_plugin_api api = {
+    "ps",
+    clixon_plugin_init,
+    .ca_start=ps_start,
+    .ca_trans_commit=ps_commit,
+};
+
+clixon_plugin_api *
+clixon_plugin_init(clicon_handle h)
+{
+    return &api;
+}
+EOF
+
+new "compile ps"
+expectpart "$($CC -g -Wall -rdynamic -fPIC -shared -I/usr/local/include $dir/ps.c -o $pdir/ps.so)" 0 ""
+
+# Get commit stats
+function stats_get()
+{
+    rpc=$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")
+    echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+for v in x y; do
+    new "edit $v"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:stats\"><a>$v</a></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit $v"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+done
+
+new "validate"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+res=$(stats_get)
+
+new "check total phase"
+match=$(echo "$res" | grep --null -o "<phase><name>total</name><count>2</count>")
+if [ -z "$match" ]; then
+    err "<phase><name>total</name><count>2</count>" "$res"
+fi
+
+new "check read phase of commits and validate"
+match=$(echo "$res" | grep --null -o "<phase><name>read</name><count>3</count>")
+if [ -z "$match" ]; then
+    err "<phase><name>read</name><count>3</count>" "$res"
+fi
+
+new "check plugin commit callback at least 2ms"
+match=$(echo "$res" | grep --null -o "<plugin><name>ps</name><callback><name>commit</name><count>2</count><total>[0-9]*</total><max>[0-9]*</max><bucket><limit>[0-9]*</limit>")
+if [ -z "$match" ]; then
+    err "<plugin><name>ps</name><callback><name>commit</name><count>2</count>" "$res"
+fi
+max=$(echo "$match" | sed -e 's/.*<max>\([0-9]*\)<\/max>.*/\1/')
+if [ -z "$max" ] || [ $max -lt 2000 ]; then
+    err "max >= 2000" "$max"
+fi
+
+new "check plugin start callback"
+match=$(echo "$res" | grep --null -o "<plugin><name>ps</name><callback><name>start</name><count>1</count><total>[0-9]*</total><max>[0-9]*</max></callback></plugin>")
+if [ -z "$match" ]; then
+    err "<plugin><name>ps</name><callback><name>start</name><count>1</count>" "$res"
+fi
+
+new "check commit rpc callback"
+match=$(echo "$res" | grep --null -o "<rpc><namespace>urn:ietf:params:xml:ns:netconf:base:1.0</namespace><name>commit</name><count>2</count>")
+if [ -z "$match" ]; then
+    err "<rpc><namespace>urn:ietf:params:xml:ns:netconf:base:1.0</namespace><name>commit</name><count>2</count>" "$res"
+fi
+
+new "check commit phase percentiles"
+match=$(echo "$res" | grep --null -o "<phase><name>total</name><count>2</count>.*</bucket><p50>[0-9]*</p50><p99>[0-9]*</p99></phase>")
+if [ -z "$match" ]; then
+    err "<p50>[0-9]*</p50><p99>[0-9]*</p99></phase>" "$res"
+fi
+
+new "check commit rpc latency and sizes"
+match=$(echo "$res" | grep --null -o "<rpcs xmlns=\"http://clicon.org/lib\">.*<rpc><namespace>urn:ietf:params:xml:ns:netconf:base:1.0</namespace><name>commit</name><latency><count>2</count>")
+if [ -z "$match" ]; then
+    err "<rpc><namespace>urn:ietf:params:xml:ns:netconf:base:1.0</namespace><name>commit</name><latency><count>2</count>" "$res"
+fi
+match=$(echo "$res" | grep --null -o "<name>edit-config</name><latency><count>2</count>.*<request><count>2</count><total>[0-9]*</total><max>[0-9]*</max>.*</request><reply><count>2</count>")
+if [ -z "$match" ]; then
+    err "<name>edit-config</name><latency><count>2</count>...<request><count>2</count>" "$res"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
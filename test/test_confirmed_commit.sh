@@ -459,6 +459,26 @@ expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+xml
 
 assert_config_equals "running" "$CONFIGB"
 
+################################################################################
+
+new "21. netconf ephemeral confirmed-commits roll back without writing rollback_db"
+reset
+edit_config "candidate" "$CONFIGB"
+commit ""
+# two confirmed-commits in one session: add eth1, then remove eth0, keep session alive in the background
+sleep 60 |  cat <(echo "$HELLONO11<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$CONFIGC</config></edit-config></rpc>]]>]]><rpc $DEFAULTNS><commit><confirmed/><confirm-timeout>60</confirm-timeout></commit></rpc>]]>]]><rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>none</default-operation><config><table xmlns=\"urn:example:clixon\"><parameter xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\" nc:operation=\"delete\"><name>eth0</name></parameter></table></config></edit-config></rpc>]]>]]><rpc $DEFAULTNS><commit><confirmed/><confirm-timeout>60</confirm-timeout></commit></rpc>]]>]]>") -| $clixon_netconf -qf $cfg  >> /dev/null &
+PIDS=($(jobs -l % | cut -c 6- | awk '{print $1}'))
+sleep 1 # TIMEOUT?
+assert_config_equals "running" "$CONFIGC"
+
+new "Check $ROLLBACK_PATH not written"
+[ -s "$ROLLBACK_PATH" ] && err "rollback_db is empty" "rollback_db is written"
+
+new "soft kill ${PIDS[0]}"
+kill ${PIDS[0]}                   # close the confirmed-commit session, which rolls back both commits
+sleep 1
+assert_config_equals "running" "$CONFIGB"
+
 if [ $RC -ne 0 ]; then
     new "Kill restconf daemon"
     stop_restconf 
@@ -0,0 +1,120 @@
+#!/usr/bin/env bash
+# Asynchronous running datastore writes, see CLICON_XMLDB_ASYNC
+# Commit with background writer in both reply modes, make several commits
+# back-to-back, use datastore-sync as barrier and check the running_db file.
+# Restart the backend with -s running and check that the last commits are there
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/async.yang
+
+cat <<EOF > $fyang
+module async{
+  yang-version 1.1;
+  namespace "urn:example:async";
+  prefix a;
+  container c{
+    leaf a{
+      type string;
+    }
+    list y{
+      key k;
+      leaf k{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+# Start backend and make commits
+# 1: startup mode
+# 2: async mode
+testrun(){
+    mode=$1
+    async=$2
+
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_ASYNC>$async</CLICON_XMLDB_ASYNC>
+</clixon-config>
+EOF
+    new "test params: -s $mode -f $cfg async: $async"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s $mode"
+        start_backend -s $mode -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    for (( i=0; i<10; i++ )); do
+        new "edit $async $i"
+        expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:async\"><a>$async$i</a><y><k>$async$i</k></y></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+        new "commit $async $i"
+        expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    done
+
+    new "check running $async"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/a:c/a:a\" xmlns:a=\"urn:example:async\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:async\"><a>${async}9</a></c></data></rpc-reply>"
+
+    new "datastore-sync barrier"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-sync xmlns=\"http://clicon.org/lib\"/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "running_db is written in commit order"
+    expectpart "$(cat $dir/running_db)" 0 "<a>${async}9</a>" "<k>${async}0</k>" "<k>${async}9</k>"
+
+    new "no temporary files left"
+    if [ -n "$(ls $dir/*.tmp 2> /dev/null)" ]; then
+        err "no tmp files" "$(ls $dir/*.tmp)"
+    fi
+}
+
+stopbackend(){
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+testrun init reply-after-durable
+
+stopbackend
+
+testrun running reply-before-durable
+
+stopbackend
+
+testrun running sync
+
+new "check running after restarts"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/a:c/a:y[a:k='reply-after-durable9' or a:k='reply-before-durable9']\" xmlns:a=\"urn:example:async\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:async\"><y><k>reply-after-durable9</k></y><y><k>reply-before-durable9</k></y></c></data></rpc-reply>"
+
+stopbackend
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,107 @@
+#!/usr/bin/env bash
+# Binary datastore format, CLICON_XMLDB_FORMAT=binary
+# Run a binary direct to datastore. No clixon.
+# Store in binary format, read back, and convert from/to xml
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+fyang=$dir/binary.yang
+
+: ${clixon_util_datastore:=clixon_util_datastore}
+
+cat <<EOF > $fyang
+module binary{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix b;
+   container x {
+    list y {
+      key "a b";
+      leaf a {
+        type string;
+      }
+      leaf b {
+        type string;
+      }
+      leaf c {
+        type string;
+      }
+    }
+    leaf d {
+        type empty;
+    }
+    leaf-list e {
+        type string;
+    }
+    leaf g {
+      type string;
+    }
+  }
+}
+EOF
+
+xml="<x xmlns=\"urn:example:clixon\"><y><a>1</a><b>2</b><c>first-entry</c></y><y><a>2</a><b>3</b><c>second &amp; entry</c></y><d/><e>a</e><e>b</e><g></g></x>"
+
+xml2="<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><y><a>1</a><b>2</b><c>first-entry</c></y><y><a>2</a><b>3</b><c>second &amp; entry</c></y><d/><e>a</e><e>b</e><g/></x></${DATASTORE_TOP}>"
+
+mydir=$dir/binary
+if [ ! -d $mydir ]; then
+    mkdir $mydir
+fi
+rm -rf $mydir/*
+
+conf="-d candidate -b $mydir -y $fyang"
+
+new "datastore binary init"
+expectpart "$($clixon_util_datastore $conf -f binary init)" 0 ""
+
+new "datastore binary get empty"
+expectpart "$($clixon_util_datastore $conf -f binary get /)" 0 "^<${DATASTORE_TOP}/>$"
+
+new "datastore binary put all replace"
+expectpart "$($clixon_util_datastore $conf -f binary put replace "$xml")" 0 ""
+
+new "datastore binary file is not xml"
+if [ "$(head -c 4 $mydir/candidate_db)" != "CLXB" ]; then
+    err "CLXB" "$(head -c 4 $mydir/candidate_db)"
+fi
+
+new "datastore binary get"
+expectpart "$($clixon_util_datastore $conf -f binary get /)" 0 "^$xml2$"
+
+new "datastore binary get xpath"
+expectpart "$($clixon_util_datastore $conf -f binary get /x/y[a=2]/c)" 0 "^<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><y><a>2</a><b>3</b><c>second &amp; entry</c></y></x></${DATASTORE_TOP}>$"
+
+new "datastore binary put merge"
+expectpart "$($clixon_util_datastore $conf -f binary put merge "<x xmlns=\"urn:example:clixon\"><g>astring</g></x>")" 0 ""
+
+new "datastore binary get merged"
+expectpart "$($clixon_util_datastore $conf -f binary get /x/g)" 0 "<g>astring</g>"
+
+new "datastore convert binary to xml"
+expectpart "$($clixon_util_datastore $conf -f binary convert xml $dir/conv.xml)" 0 ""
+
+new "datastore converted file is xml"
+expectpart "$(cat $dir/conv.xml)" 0 "<${DATASTORE_TOP}>" "<g>astring</g>"
+
+new "datastore convert xml to binary"
+cp $dir/conv.xml $mydir/running_db
+expectpart "$($clixon_util_datastore -d running -b $mydir -y $fyang -f xml convert binary $mydir/candidate_db)" 0 ""
+
+new "datastore binary get converted"
+expectpart "$($clixon_util_datastore $conf -f binary get /x/g)" 0 "<g>astring</g>"
+
+new "datastore binary truncated file"
+head -c 40 $mydir/running_db > $mydir/candidate_db
+expectpart "$($clixon_util_datastore $conf -f binary get / 2>&1)" 255 "Not a binary datastore file"
+
+new "datastore binary delete"
+expectpart "$($clixon_util_datastore $conf -f binary delete)" 0 ""
+
+rm -rf $mydir
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,100 @@
+#!/usr/bin/env bash
+# Compressed datastore files, CLICON_XMLDB_COMPRESS=zstd
+# Run a binary direct to datastore. No clixon.
+# Write compressed datastores in xml and binary format, read back, and convert
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+if [ "${WITH_ZSTD}" != "yes" ]; then
+    echo "Skipping test, zstd support not enabled."
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+fyang=$dir/compress.yang
+
+: ${clixon_util_datastore:=clixon_util_datastore}
+
+cat <<EOF > $fyang
+module compress{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix c;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type string;
+      }
+      leaf b {
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+data=""
+for (( i=0; i<100; i++ )); do
+    data+="<y><a>$i</a><b>value$i</b></y>"
+done
+xml="<x xmlns=\"urn:example:clixon\">$data</x>"
+
+mydir=$dir/compress
+if [ ! -d $mydir ]; then
+    mkdir $mydir
+fi
+rm -rf $mydir/*
+
+for format in xml binary; do
+    conf="-d candidate -b $mydir -y $fyang -f $format"
+
+    new "datastore $format zstd init"
+    expectpart "$($clixon_util_datastore $conf -z zstd init)" 0 ""
+
+    new "datastore $format zstd put replace"
+    expectpart "$($clixon_util_datastore $conf -z zstd put replace "$xml")" 0 ""
+
+    new "datastore $format zstd file is compressed"
+    magic=$(od -An -tx1 -N4 $mydir/candidate_db | tr -d ' ')
+    if [ "$magic" != "28b52ffd" ]; then
+        err "28b52ffd" "$magic"
+    fi
+
+    new "datastore $format zstd get xpath"
+    expectpart "$($clixon_util_datastore $conf -z zstd get /x/y[a=42])" 0 "^<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><y><a>42</a><b>value42</b></y></x></${DATASTORE_TOP}>$"
+
+    new "datastore $format zstd put merge"
+    expectpart "$($clixon_util_datastore $conf -z zstd put merge "<x xmlns=\"urn:example:clixon\"><y><a>100</a><b>merged</b></y></x>")" 0 ""
+
+    new "datastore $format compressed file is read without compression set"
+    expectpart "$($clixon_util_datastore $conf get /x/y[a=100])" 0 "<b>merged</b>"
+
+    new "datastore $format convert compressed to plain xml"
+    expectpart "$($clixon_util_datastore $conf convert xml $dir/conv.xml)" 0 ""
+    expectpart "$(cat $dir/conv.xml)" 0 "<${DATASTORE_TOP}>" "<b>value99</b>" "<b>merged</b>"
+
+    new "datastore $format write without compression"
+    expectpart "$($clixon_util_datastore $conf put merge "<x xmlns=\"urn:example:clixon\"><y><a>101</a></y></x>")" 0 ""
+    magic=$(od -An -tx1 -N4 $mydir/candidate_db | tr -d ' ')
+    if [ "$magic" = "28b52ffd" ]; then
+        err "not compressed" "$magic"
+    fi
+
+    new "datastore $format zstd truncated file"
+    expectpart "$($clixon_util_datastore $conf -z zstd put replace "$xml")" 0 ""
+    head -c 20 $mydir/candidate_db > $dir/trunc
+    cp $dir/trunc $mydir/candidate_db
+    expectpart "$($clixon_util_datastore $conf get / 2> /dev/null)" 255 ""
+
+    new "datastore $format zstd delete"
+    expectpart "$($clixon_util_datastore $conf delete)" 0 ""
+done
+
+rm -rf $mydir
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,147 @@
+#!/usr/bin/env bash
+# Candidate datastore as edits of running, see CLICON_XMLDB_CANDIDATE_DELTA
+# Commit and discard-changes only compare and revert edited subtrees of candidate
+# Check that commits, discard-changes and defaults with when conditions give the same
+# results as with full comparisons
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/delta.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_CANDIDATE_DELTA>true</CLICON_XMLDB_CANDIDATE_DELTA>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module delta{
+  yang-version 1.1;
+  namespace "urn:example:delta";
+  prefix d;
+  container c{
+    leaf a{
+      type string;
+    }
+    list y{
+      key k;
+      leaf k{
+        type string;
+      }
+      leaf v{
+        type string;
+      }
+    }
+    leaf-list ll{
+      type string;
+    }
+  }
+  container w{
+    leaf flag{
+      type string;
+    }
+  }
+  container e{
+    leaf b{
+      type string;
+    }
+    leaf d{
+      when "/d:w/d:flag='on'";
+      type string;
+      default "dflt";
+    }
+  }
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "add entries"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:delta\"><a>foo</a><y><k>1</k><v>x</v></y><y><k>2</k><v>y</v></y><y><k>3</k><v>z</v></y><ll>p</ll><ll>q</ll></c><e xmlns=\"urn:example:delta\"><b>bar</b></e></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+expect="<c xmlns=\"urn:example:delta\"><a>foo</a><y><k>1</k><v>x</v></y><y><k>2</k><v>y</v></y><y><k>3</k><v>z</v></y><ll>p</ll><ll>q</ll></c><e xmlns=\"urn:example:delta\"><b>bar</b></e>"
+
+new "check running"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$expect</data></rpc-reply>"
+
+new "remove, change and add entries"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:delta\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><a>fie</a><y nc:operation=\"remove\"><k>1</k></y><y><k>2</k><v>changed</v></y><y><k>4</k></y><ll nc:operation=\"remove\">p</ll><ll>r</ll></c><e xmlns=\"urn:example:delta\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\" nc:operation=\"remove\"/></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check candidate is running"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$expect</data></rpc-reply>"
+
+new "remove, change and add entries again"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:delta\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><a>fie</a><y nc:operation=\"remove\"><k>1</k></y><y><k>2</k><v>changed</v></y><y><k>4</k></y><ll nc:operation=\"remove\">p</ll><ll>r</ll></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+expect="<c xmlns=\"urn:example:delta\"><a>fie</a><y><k>2</k><v>changed</v></y><y><k>3</k><v>z</v></y><y><k>4</k></y><ll>q</ll><ll>r</ll></c><e xmlns=\"urn:example:delta\"><b>bar</b></e>"
+
+new "check running"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$expect</data></rpc-reply>"
+
+new "running_db is written"
+expectpart "$(cat $dir/running_db)" 0 "<v>changed</v>" "<k>4</k>" --not-- "<k>1</k>"
+
+new "set flag of when condition of default in other subtree"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><w xmlns=\"urn:example:delta\"><flag>on</flag></w></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check default of when condition in running"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><with-defaults xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-with-defaults\">report-all</with-defaults><source><running/></source><filter type=\"xpath\" select=\"/d:e\" xmlns:d=\"urn:example:delta\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><e xmlns=\"urn:example:delta\"><b>bar</b><d>dflt</d></e></data></rpc-reply>"
+
+new "edit and discard after commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:delta\"><y><k>3</k><v>changed</v></y></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check candidate entry"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/d:c/d:y[d:k='3']\" xmlns:d=\"urn:example:delta\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:delta\"><y><k>3</k><v>z</v></y></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
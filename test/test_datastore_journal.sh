@@ -0,0 +1,158 @@
+#!/usr/bin/env bash
+# Running datastore journal, see CLICON_XMLDB_JOURNAL
+# Commits append changes to running_db.journal instead of rewriting running_db
+# Restart the backend with -s running and check that the journal is replayed
+# Make the journal exceed CLICON_XMLDB_JOURNAL_MAX and check it is compacted
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/journal.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_JOURNAL>true</CLICON_XMLDB_JOURNAL>
+  <CLICON_XMLDB_JOURNAL_MAX>2000</CLICON_XMLDB_JOURNAL_MAX>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module journal{
+  yang-version 1.1;
+  namespace "urn:example:journal";
+  prefix j;
+  container c{
+    leaf a{
+      type string;
+    }
+    leaf d{
+      type string;
+      default "dflt";
+    }
+    list y{
+      key k;
+      leaf k{
+        type string;
+      }
+      leaf v{
+        type string;
+      }
+    }
+    leaf-list ll{
+      type string;
+    }
+  }
+}
+EOF
+
+# Start and restart backend
+testrun(){
+    mode=$1
+    new "test params: -s $mode -f $cfg"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s $mode"
+        start_backend -s $mode -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+}
+
+stopbackend(){
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+testrun init
+
+new "add entries"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:journal\"><a>foo</a><y><k>1</k><v>x</v></y><y><k>2</k><v>y</v></y><ll>p</ll><ll>q</ll></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check journal exists"
+if [ ! -s $dir/running_db.journal ]; then
+    err "$dir/running_db.journal" "no journal"
+fi
+
+new "remove, change and add entries"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:journal\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><a>bar</a><d>explicit</d><y nc:operation=\"remove\"><k>1</k></y><y><k>2</k><v>z</v></y><y><k>3</k></y><ll nc:operation=\"remove\">p</ll></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+expect="<c xmlns=\"urn:example:journal\"><a>bar</a><d>explicit</d><y><k>2</k><v>z</v></y><y><k>3</k></y><ll>q</ll></c>"
+
+new "check running"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$expect</data></rpc-reply>"
+
+new "running_db is not rewritten"
+expectpart "$(cat $dir/running_db)" 0 --not-- "bar"
+
+stopbackend
+
+testrun running
+
+new "check running after replay"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$expect</data></rpc-reply>"
+
+new "remove explicit value of leaf with default"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:journal\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><d nc:operation=\"remove\"/></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "add entries larger than journal max"
+data=""
+for (( i=10; i<100; i++ )); do
+    data+="<y><k>$i</k><v>value$i</v></y>"
+done
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:journal\">$data</c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check journal is removed"
+if [ -f $dir/running_db.journal ]; then
+    err "no journal" "$dir/running_db.journal"
+fi
+
+new "running_db is written"
+expectpart "$(cat $dir/running_db)" 0 "<a>bar</a>" "<k>99</k>" --not-- "explicit"
+
+stopbackend
+
+testrun running
+
+new "check running after restart"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/j:c/j:y[j:k='99']\" xmlns:j=\"urn:example:journal\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:journal\"><y><k>99</k><v>value99</v></y></c></data></rpc-reply>"
+
+stopbackend
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,122 @@
+#!/usr/bin/env bash
+# Read-only running snapshot for local frontends, see CLICON_XMLDB_SNAPSHOT
+# Check that the backend writes the snapshot at start and on commit, that the CLI shows
+# running from it, also after a new commit, and that the snapshot is removed when the
+# backend exits
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+clidir=$dir/cli
+fyang=$dir/snapshot.yang
+snapshot=$dir/running_db.snapshot
+
+test -d ${clidir} || rm -rf ${clidir}
+mkdir $clidir
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_CLISPEC_DIR>$clidir</CLICON_CLISPEC_DIR>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_SNAPSHOT>true</CLICON_XMLDB_SNAPSHOT>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module snapshot{
+  yang-version 1.1;
+  namespace "urn:example:snapshot";
+  prefix s;
+  container c{
+    list l{
+      key k;
+      leaf k{
+        type string;
+      }
+      leaf v{
+        type string;
+        default "none";
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $clidir/ex.cli
+CLICON_MODE="example";
+CLICON_PROMPT="%U@%H %W> ";
+
+show("Show a particular state of the system"){
+   configuration("Show configuration"), cli_show_auto_mode("running", "xml", false, false);
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "snapshot written at start"
+if [ ! -f $snapshot ]; then
+    err "$snapshot" "none"
+fi
+
+new "edit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:snapshot\"><l><k>a</k><v>x</v></l><l><k>b</k></l></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "cli show running from snapshot"
+expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "^<c xmlns=\"urn:example:snapshot\"><l><k>a</k><v>x</v></l><l><k>b</k></l></c>$"
+
+new "edit again"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:snapshot\"><l><k>a</k><v>y</v></l></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit again"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "cli show new generation of snapshot"
+expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "^<c xmlns=\"urn:example:snapshot\"><l><k>a</k><v>y</v></l><l><k>b</k></l></c>$"
+
+new "netconf get-config same as snapshot"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:snapshot\"><l><k>a</k><v>y</v></l><l><k>b</k></l></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+
+    new "snapshot removed at exit"
+    if [ -f $snapshot ]; then
+        err "none" "$snapshot"
+    fi
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
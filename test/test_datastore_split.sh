@@ -0,0 +1,177 @@
+#!/usr/bin/env bash
+# Split datastores, see CLICON_XMLDB_SPLIT
+# Each top-level module is stored in its own file in running_db.d and candidate_db.d
+# Check that a commit only replaces the module files of the changed module,
+# that files of removed modules are removed, and that running is read back on restart
+# Without cache, check that a get with an xpath only reads the module files it selects
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang1=$dir/split1.yang
+fyang2=$dir/split2.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$dir</CLICON_YANG_MAIN_DIR>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_SPLIT>true</CLICON_XMLDB_SPLIT>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang1
+module split1{
+  yang-version 1.1;
+  namespace "urn:example:split1";
+  prefix s1;
+  container c{
+    leaf a{
+      type string;
+    }
+  }
+}
+EOF
+
+cat <<EOF > $fyang2
+module split2{
+  yang-version 1.1;
+  namespace "urn:example:split2";
+  prefix s2;
+  container d{
+    leaf b{
+      type string;
+    }
+  }
+}
+EOF
+
+# Start and restart backend
+testrun(){
+    mode=$1
+    new "test params: -s $mode -f $cfg"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s $mode"
+        start_backend -s $mode -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+}
+
+stopbackend(){
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+testrun init
+
+new "add to both modules"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:split1\"><a>foo</a></c><d xmlns=\"urn:example:split2\"><b>bar</b></d></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "module files exist"
+expectpart "$(cat $dir/running_db.d/split1_db)" 0 "<a>foo</a>" --not-- "<b>bar</b>"
+expectpart "$(cat $dir/running_db.d/split2_db)" 0 "<b>bar</b>" --not-- "<a>foo</a>"
+
+new "running_db has no module data"
+expectpart "$(cat $dir/running_db)" 0 --not-- "foo" "bar"
+
+ino1=$(stat -c %i $dir/running_db.d/split1_db)
+ino2=$(stat -c %i $dir/running_db.d/split2_db)
+
+new "change one module"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:split1\"><a>fie</a></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "changed module file is replaced"
+if [ "$(stat -c %i $dir/running_db.d/split1_db)" = "$ino1" ]; then
+    err "new inode" "$ino1"
+fi
+expectpart "$(cat $dir/running_db.d/split1_db)" 0 "<a>fie</a>"
+
+new "unchanged module file is not replaced"
+if [ "$(stat -c %i $dir/running_db.d/split2_db)" != "$ino2" ]; then
+    err "$ino2" "$(stat -c %i $dir/running_db.d/split2_db)"
+fi
+
+new "remove module content"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><d xmlns=\"urn:example:split2\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\" nc:operation=\"remove\"/></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "removed module file"
+if [ -f $dir/running_db.d/split2_db ]; then
+    err "no file" "$dir/running_db.d/split2_db"
+fi
+
+stopbackend
+
+testrun running
+
+new "check running after restart"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:split1\"><a>fie</a></c></data></rpc-reply>"
+
+stopbackend
+
+cfg=$dir/conf_nocache.xml
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$dir</CLICON_YANG_MAIN_DIR>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_SPLIT>true</CLICON_XMLDB_SPLIT>
+  <CLICON_DATASTORE_CACHE>nocache</CLICON_DATASTORE_CACHE>
+</clixon-config>
+EOF
+
+testrun running
+
+new "add to second module again"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><d xmlns=\"urn:example:split2\"><b>bar</b></d></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "break second module file"
+echo "<config><d xmlns=\"urn:example:split2\"><b>bar" > $dir/running_db.d/split2_db
+
+new "get first module does not read second module file"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/s1:c/s1:a\" xmlns:s1=\"urn:example:split1\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:split1\"><a>fie</a></c></data></rpc-reply>"
+
+new "get all reads second module file"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error>"
+
+stopbackend
+
+rm -rf $dir
+
+new "endtest"
+endtest
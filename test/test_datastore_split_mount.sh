@@ -0,0 +1,168 @@
+#!/usr/bin/env bash
+# Split datastores with one shard per schema mount-point, see CLICON_XMLDB_SPLIT_MOUNT
+# The content of each mount-point is stored in its own file in
+# running_db.d/clixon-example_db.d/
+# Check that a commit only replaces the shard of the changed mount-point, that shards of
+# removed mount-points are removed, and that running is read back on restart
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_mount.xml
+fyang=$dir/clixon-example.yang
+fyang1=$dir/clixon-mount1.yang
+sdir=$dir/running_db.d/clixon-example_db.d
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${dir}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_YANG_LIBRARY>true</CLICON_YANG_LIBRARY>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_SPLIT>true</CLICON_XMLDB_SPLIT>
+  <CLICON_XMLDB_SPLIT_MOUNT>true</CLICON_XMLDB_SPLIT_MOUNT>
+  <CLICON_YANG_SCHEMA_MOUNT>true</CLICON_YANG_SCHEMA_MOUNT>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  import ietf-yang-schema-mount {
+    prefix yangmnt;
+  }
+  container top{
+    list mylist{
+      key name;
+      leaf name{
+        type string;
+      }
+      container root{
+         presence "Otherwise root is not visible";
+         yangmnt:mount-point "mylabel"{
+            description "Root for other yang models";
+         }
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $fyang1
+module clixon-mount1{
+  yang-version 1.1;
+  namespace "urn:example:mount1";
+  prefix m1;
+  container mount1{
+    list mylist1{
+      key name1;
+      leaf name1{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+# Start and restart backend
+testrun(){
+    mode=$1
+    new "test params: -s $mode -f $cfg"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s $mode"
+        start_backend -s $mode -f $cfg -- -m clixon-mount1 -M urn:example:mount1
+    fi
+
+    new "wait backend"
+    wait_backend
+}
+
+stopbackend(){
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+testrun init
+
+new "add data to two mount-points x and y"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><top xmlns=\"urn:example:clixon\"><mylist><name>x</name><root><mount1 xmlns=\"urn:example:mount1\"><mylist1><name1>x1</name1></mylist1></mount1></root></mylist><mylist><name>y</name><root><mount1 xmlns=\"urn:example:mount1\"><mylist1><name1>y1</name1></mylist1></mount1></root></mylist></top></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "module file has only shard references"
+expectpart "$(cat $dir/running_db.d/clixon-example_db)" 0 "<name>x</name>" "cl:shard=" --not-- "x1" "y1"
+
+new "two shard files"
+if [ $(ls $sdir | wc -l) -ne 2 ]; then
+    err "2" "$(ls $sdir)"
+fi
+
+fx=$(grep -l x1 $sdir/*_db)
+fy=$(grep -l y1 $sdir/*_db)
+inox=$(stat -c %i $fx)
+inoy=$(stat -c %i $fy)
+
+new "change mount-point x"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><top xmlns=\"urn:example:clixon\"><mylist><name>x</name><root><mount1 xmlns=\"urn:example:mount1\"><mylist1><name1>x2</name1></mylist1></mount1></root></mylist></top></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "changed shard file is replaced"
+if [ "$(stat -c %i $fx)" = "$inox" ]; then
+    err "new inode" "$inox"
+fi
+expectpart "$(cat $fx)" 0 "<name1>x2</name1>"
+
+new "unchanged shard file is not replaced"
+if [ "$(stat -c %i $fy)" != "$inoy" ]; then
+    err "$inoy" "$(stat -c %i $fy)"
+fi
+
+new "remove mount-point y"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><top xmlns=\"urn:example:clixon\"><mylist xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\" nc:operation=\"remove\"><name>y</name></mylist></top></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "removed shard file"
+if [ -f $fy ]; then
+    err "no file" "$fy"
+fi
+
+stopbackend
+
+testrun running
+
+new "check running after restart"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><top xmlns=\"urn:example:clixon\"><mylist><name>x</name><root><mount1 xmlns=\"urn:example:mount1\"><mylist1><name1>x1</name1></mylist1><mylist1><name1>x2</name1></mylist1></mount1></root></mylist></top></data></rpc-reply>"
+
+stopbackend
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+# Get-config printed directly from the datastore cache, see xmldb_get_cbuf
+# Selected nodes are marked in the cache and printed without copying
+# Check selections with list keys, default values and non-presence containers
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/zerocopy.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module zerocopy{
+  yang-version 1.1;
+  namespace "urn:example:zerocopy";
+  prefix z;
+  container c{
+    leaf d{
+      type string;
+      default "dflt";
+    }
+    container np{
+      leaf x{
+        type uint32;
+        default 7;
+      }
+    }
+    container p{
+      presence true;
+    }
+    list e{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf v{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+# Get-config running with xpath and check reply
+# 1: xpath
+# 2: expected data
+getconfig(){
+    new "get-config $1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"$1\" xmlns:z=\"urn:example:zerocopy\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit-config list entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:zerocopy\"><e><name>a</name><v>1</v></e><e><name>b</name><v>2</v></e></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+ENTRIES="<e><name>a</name><v>1</v></e><e><name>b</name><v>2</v></e>"
+
+getconfig "/" "<data><c xmlns=\"urn:example:zerocopy\">$ENTRIES</c></data>"
+
+getconfig "/z:c/z:e[z:name='b']" "<data><c xmlns=\"urn:example:zerocopy\"><e><name>b</name><v>2</v></e></c></data>"
+
+getconfig "/z:c/z:e/z:v" "<data><c xmlns=\"urn:example:zerocopy\">$ENTRIES</c></data>"
+
+getconfig "/z:c/z:np" "<data/>"
+
+getconfig "/z:c/z:e[z:name='x']" "<data/>"
+
+new "edit-config presence container and non-presence leaf"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:zerocopy\"><p/><np><x>8</x></np></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+getconfig "/z:c/z:p" "<data><c xmlns=\"urn:example:zerocopy\"><p/></c></data>"
+
+getconfig "/z:c/z:np" "<data><c xmlns=\"urn:example:zerocopy\"><np><x>8</x></np></c></data>"
+
+getconfig "/" "<data><c xmlns=\"urn:example:zerocopy\"><np><x>8</x></np><p/>$ENTRIES</c></data>"
+
+new "get-config candidate unchanged after get"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:zerocopy\"><np><x>8</x></np><p/>$ENTRIES</c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -2,6 +2,7 @@
 # Datastore tests:
 # - XML and JSON
 # - save and load config files
+# - load config files in the backend using file url
 # Pretty and not
 
 # Magic line must be first in script (see README.md)
@@ -12,6 +13,7 @@ APPNAME=example
 # include err() and new() functions and creates $dir
 
 cfg=$dir/conf_yang.xml
+cfgurl=$dir/conf_url.xml
 fyang=$dir/clixon-example.yang
 fclispec=$dir/clispec.cli
 
@@ -33,6 +35,9 @@ cat <<EOF > $cfg
 </clixon-config>
 EOF
 
+# Same with url feature: CLI sends path of load file to backend
+sed -e "s#<CLICON_CONFIGFILE>$cfg#<CLICON_FEATURE>ietf-netconf:url</CLICON_FEATURE><CLICON_CONFIGFILE>$cfgurl#" $cfg > $cfgurl
+
 cat <<EOF > $fyang
 module clixon-example{
     yang-version 1.1;
@@ -262,6 +267,66 @@ if [ $BE -ne 0 ]; then
     stop_backend -f $cfg
 fi
 
+# Load file in backend using file url
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -z -f $cfgurl
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfgurl"
+    start_backend -s init -f $cfgurl
+fi
+
+new "wait backend"
+wait_backend
+
+new "netconf url capability"
+expecteof "$clixon_netconf -qf $cfgurl" 0 "$DEFAULTHELLO" "<capability>urn:ietf:params:netconf:capability:url:1.0?scheme=file</capability>"
+
+new "cli configure parameter b"
+expectpart "$($clixon_cli -1 -f $cfgurl set table parameter b value 99)" 0 "^$"
+
+for format in xml json; do
+    new "save config file $format"
+    expectpart "$($clixon_cli -1 -f $cfgurl save $dir/myconfig $format)" 0 "^$"
+
+    new "discard"
+    expectpart "$($clixon_cli -1 -f $cfgurl discard)" 0 "^$"
+
+    new "load config file $format using url"
+    expectpart "$($clixon_cli -1 -f $cfgurl load $dir/myconfig $format)" 0 "^$"
+
+    new "cli show config $format"
+    expectpart "$($clixon_cli -1 -f $cfgurl show config)" 0 "^<table xmlns=\"urn:example:clixon\"><parameter><name>b</name><value>99</value></parameter></table>$"
+done
+
+new "netconf edit-config url merge"
+cat <<EOF > $dir/myconfig
+<${DATASTORE_TOP}><table xmlns="urn:example:clixon"><parameter><name>c</name><value>7</value></parameter></table></${DATASTORE_TOP}>
+EOF
+expecteof_netconf "$clixon_netconf -qf $cfgurl" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><url>file://$dir/myconfig</url></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf get-config c"
+expecteof_netconf "$clixon_netconf -qf $cfgurl" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>b</name><value>99</value></parameter><parameter><name>c</name><value>7</value></parameter></table></data></rpc-reply>"
+
+new "netconf edit-config relative url, expect fail"
+expecteof_netconf "$clixon_netconf -qf $cfgurl" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><url>file:myconfig</url></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-not-supported</error-tag><error-severity>error</error-severity><error-message>Only absolute file urls are supported: file:myconfig</error-message></rpc-error></rpc-reply>"
+
+new "netconf edit-config missing file, expect fail"
+expecteof_netconf "$clixon_netconf -qf $cfgurl" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><url>file://$dir/notexist</url></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>$dir/notexist: No such file or directory</error-message></rpc-error></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfgurl
+fi
+
 rm -rf $dir
 
 new "endtest"
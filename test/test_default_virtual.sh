@@ -0,0 +1,108 @@
+#!/usr/bin/env bash
+# Default values of filtered gets from the datastore cache
+# If the xpath does not depend on default values, defaults are added to the result only,
+# not to the cached tree. Check that results are the same as when defaults are in the cache:
+# selected list entries get their defaults, ancestors get no extra default leafs,
+# and xpaths comparing default values still match
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/virtual.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module virtual{
+  yang-version 1.1;
+  namespace "urn:example:virtual";
+  prefix v;
+  container c{
+    leaf t{
+      type string;
+      default "top";
+    }
+    list y{
+      key k;
+      leaf k{
+        type string;
+      }
+      leaf v{
+        type string;
+        default "dflt";
+      }
+      container np{
+        leaf w{
+          type string;
+          default "inner";
+        }
+      }
+    }
+  }
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+WD="<with-defaults xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-with-defaults\">report-all</with-defaults>"
+
+new "add entries"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:virtual\"><y><k>1</k></y><y><k>2</k><v>explicit</v></y></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get list entry report-all"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config>$WD<source><candidate/></source><filter type=\"xpath\" select=\"/v:c/v:y[v:k='1']\" xmlns:v=\"urn:example:virtual\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:virtual\"><y><k>1</k><v>dflt</v><np><w>inner</w></np></y></c></data></rpc-reply>"
+
+new "get list entry explicit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/v:c/v:y[v:k='1']\" xmlns:v=\"urn:example:virtual\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:virtual\"><y><k>1</k></y></c></data></rpc-reply>"
+
+new "get default leaf report-all"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config>$WD<source><candidate/></source><filter type=\"xpath\" select=\"/v:c/v:t\" xmlns:v=\"urn:example:virtual\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:virtual\"><t>top</t></c></data></rpc-reply>"
+
+new "get xpath comparing default value"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config>$WD<source><candidate/></source><filter type=\"xpath\" select=\"/v:c/v:y[v:v='dflt']\" xmlns:v=\"urn:example:virtual\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:virtual\"><y><k>1</k><v>dflt</v><np><w>inner</w></np></y></c></data></rpc-reply>"
+
+new "get all report-all"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config>$WD<source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:virtual\"><t>top</t><y><k>1</k><v>dflt</v><np><w>inner</w></np></y><y><k>2</k><v>explicit</v><np><w>inner</w></np></y></c></data></rpc-reply>"
+
+new "get all explicit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:virtual\"><y><k>1</k></y><y><k>2</k><v>explicit</v></y></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,113 @@
+#!/usr/bin/env bash
+# Compare configurations in threads, see CLICON_XML_DIFF_THREADS
+# Change, delete and add entries of a large list and check the datastore-diff and commit
+# with and without threads
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/threads.yang
+
+# Number of list entries, more than XML_DIFF_THREADS_TASKS
+: ${perfnr:=2000}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XML_DIFF_THREADS>4</CLICON_XML_DIFF_THREADS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module threads{
+  yang-version 1.1;
+  namespace "urn:example:threads";
+  prefix t;
+  container table{
+    list parameter{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf value{
+        type uint32;
+      }
+    }
+  }
+}
+EOF
+
+config="<table xmlns=\"urn:example:threads\">"
+for (( i=0; i<$perfnr; i++ )); do
+    config+="<parameter><name>p$i</name><value>$i</value></parameter>"
+done
+config+="</table>"
+
+# Edit a large list, check the diff and commit
+# 1: extra backend options
+diff_run(){
+    new "test params: -f $cfg $1"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg $1"
+        start_backend -s init -f $cfg $1
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "edit-config $perfnr entries"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$config</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "change first, delete middle and add last entry"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:threads\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><parameter><name>p0</name><value>42</value></parameter><parameter nc:operation=\"delete\"><name>p1000</name></parameter><parameter><name>zz</name><value>1</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "datastore-diff"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-diff $LIBNS><datastore1>running</datastore1><datastore2>candidate</datastore2></datastore-diff></rpc>" "" "<rpc-reply $DEFAULTNS><config1 $LIBNS><table xmlns=\"urn:example:threads\"><parameter><name>p0</name><value>0</value></parameter><parameter><name>p1000</name><value>1000</value></parameter></table></config1><config2 $LIBNS><table xmlns=\"urn:example:threads\"><parameter><name>p0</name><value>42</value></parameter><parameter><name>zz</name><value>1</value></parameter></table></config2></rpc-reply>"
+
+    new "commit"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "no datastore-diff after commit"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-diff $LIBNS><datastore1>running</datastore1><datastore2>candidate</datastore2></datastore-diff></rpc>" "" "<rpc-reply $DEFAULTNS><config1 $LIBNS/*>*\(</config1>\)*<config2 $LIBNS/*>*\(</config2>\)*</rpc-reply>"
+
+    new "get-config running changed and deleted entries"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/t:table/t:parameter[t:name='p0' or t:name='p1000']\" xmlns:t=\"urn:example:threads\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:threads\"><parameter><name>p0</name><value>42</value></parameter></table></data></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+new "diff in threads"
+diff_run
+
+new "diff in backend thread"
+diff_run "-o CLICON_XML_DIFF_THREADS=1"
+
+rm -rf $dir
+
+new "endtest"
+endtest
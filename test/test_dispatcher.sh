@@ -45,6 +45,21 @@ expectpart "$($clixon_util_dispatcher -i 1 -a ipv4 -p /route-table/ipv4 -r -a ip
 new "reg /route-table/ ipv4,ipv6 call /route-table=/ipv4"
 expectpart "$($clixon_util_dispatcher -i 1 -a ipv4 -p /route-table/ipv4 -r -a ipv6 -p /route-table/ipv6 -i 2 -r -c /route-table=/ipv4)" 0 "cb1 ipv4" --not-- "cb2 ipv6"
 
+new "reg /route-table/* call /route-table/ipv4"
+expectpart "$($clixon_util_dispatcher -i 1 -a any -p '/route-table/*' -r -c /route-table/ipv4)" 0 "cb1 any"
+
+new "reg /route-table/ipv4 and /route-table/* call /route-table/ipv4, name before wildcard"
+expectpart "$($clixon_util_dispatcher -i 1 -a ipv4 -p /route-table/ipv4 -r -a any -p '/route-table/*' -i 2 -r -c /route-table/ipv4)" 0 "cb1 ipv4" --not-- "cb2 any"
+
+new "reg /route-table/ipv4 and /route-table/* call /route-table/ipv6"
+expectpart "$($clixon_util_dispatcher -i 1 -a ipv4 -p /route-table/ipv4 -r -a any -p '/route-table/*' -i 2 -r -c /route-table/ipv6)" 0 "cb2 any" --not-- "cb1 ipv4"
+
+new "reg /route-table=ipv4 and /route-table call /route-table=ipv4, key before name"
+expectpart "$($clixon_util_dispatcher -i 1 -a ipv4 -p /route-table=ipv4 -r -a all -p /route-table -i 2 -r -c /route-table=ipv4)" 0 "cb1 ipv4" --not-- "cb2 all"
+
+new "reg /route-table=ipv4 and /route-table call /route-table=ipv6"
+expectpart "$($clixon_util_dispatcher -i 1 -a ipv4 -p /route-table=ipv4 -r -a all -p /route-table -i 2 -r -c /route-table=ipv6)" 0 "cb2 all" --not-- "cb1 ipv4"
+
 # unset conditional parameters 
 unset clixon_util_dispatcher
 
@@ -0,0 +1,30 @@
+#!/usr/bin/env bash
+# Test of clicon_hash table using clixon_util_hash
+# Add, lookup and delete keys, also enough keys to resize the table several times
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_hash:="clixon_util_hash"}
+
+: ${perfnr:=10000}
+
+new "empty hash"
+expectpart "$($clixon_util_hash -n 0)" 0 "OK 0 keys"
+
+new "one key"
+expectpart "$($clixon_util_hash -n 1)" 0 "OK 0 keys"
+
+new "keys with same characters"
+expectpart "$($clixon_util_hash -n 1000 -l 3 -k ab)" 0 "OK 500 keys"
+
+new "$perfnr keys"
+expectpart "$($clixon_util_hash -n $perfnr -k CLICON_OPTION_)" 0 "OK $(($perfnr/2)) keys"
+
+new "timing of $perfnr keys"
+expectpart "$($clixon_util_hash -n $perfnr -l 10 -t)" 0 "add: [0-9]* us" "lookup: [0-9]* us" "del: [0-9]* us"
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -218,6 +218,36 @@ EOF
         new "WWW get css"
         expectpart "$(curl $CURLOPTS -X GET -H 'Accept: text/html' $proto://localhost/data/example.css)" 0 "HTTP/$HVER 200" "Content-Type: text/css" "display: inline;" --not-- "Content-Type: text/html"
 
+        new "WWW get css entity-tag"
+        expectpart "$(curl $CURLOPTS -X GET $proto://localhost/data/example.css)" 0 "HTTP/$HVER 200" "ETag: \"" "Last-Modified:" "Cache-Control: no-cache"
+        etag=$(curl $CURLOPTS -X GET $proto://localhost/data/example.css | grep -i "^etag:" | awk '{print $2}' | tr -d '\r')
+
+        new "WWW get css if-none-match expect 304"
+        expectpart "$(curl $CURLOPTS -X GET -H "If-None-Match: $etag" $proto://localhost/data/example.css)" 0 "HTTP/$HVER 304" "ETag: $etag" --not-- "display: inline;"
+
+        new "WWW get css if-none-match other expect 200"
+        expectpart "$(curl $CURLOPTS -X GET -H 'If-None-Match: "xxx"' $proto://localhost/data/example.css)" 0 "HTTP/$HVER 200" "display: inline;"
+
+        # Change file, cached contents is not valid
+        echo "p { color: red; }" >> $dir/www/data/example.css
+
+        new "WWW get changed css"
+        expectpart "$(curl $CURLOPTS -X GET $proto://localhost/data/example.css)" 0 "HTTP/$HVER 200" "color: red;" --not-- "ETag: $etag"
+
+        new "WWW get changed css if-none-match expect 200"
+        expectpart "$(curl $CURLOPTS -X GET -H "If-None-Match: $etag" $proto://localhost/data/example.css)" 0 "HTTP/$HVER 200" "color: red;"
+
+        # Precompressed variant
+        gzip -k $dir/www/data/example.css
+
+        new "WWW get css precompressed gzip"
+        expectpart "$(curl $CURLOPTS --compressed -X GET -H 'Accept-Encoding: gzip' $proto://localhost/data/example.css)" 0 "HTTP/$HVER 200" "Content-Type: text/css" "Content-Encoding: gzip" "Vary: Accept-Encoding" "color: red;"
+
+        new "WWW get css gzip not accepted"
+        expectpart "$(curl $CURLOPTS -X GET -H 'Accept-Encoding: gzip;q=0' $proto://localhost/data/example.css)" 0 "HTTP/$HVER 200" "Vary: Accept-Encoding" "color: red;" --not-- "Content-Encoding"
+
+        rm -f $dir/www/data/example.css.gz
+
         new "WWW head"
         expectpart "$(curl $CURLOPTS --head -H 'Accept: text/html' $proto://localhost/data/index.html)" 0 "HTTP/$HVER 200" "Content-Type: text/html" --not-- "<title>Welcome to Clixon!</title>"
 
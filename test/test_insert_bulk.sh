@@ -0,0 +1,143 @@
+#!/usr/bin/env bash
+# Test bulk insert of many new list entries in one edit-config, see XML_INSERT_BULK_THRESHOLD
+# Existing entries are even, new entries are odd and sent in reverse order.
+# The result should be sorted for the ordered-by system list, and in the order
+# they were entered for the ordered-by user leaf-list.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/bulk.yang
+
+# Number of list entries, larger than XML_INSERT_BULK_THRESHOLD (64)
+: ${nr:=200}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module bulk{
+  yang-version 1.1;
+  namespace "urn:example:bulk";
+  prefix b;
+  container c{
+    leaf d{
+      type string;
+    }
+    list y{
+      ordered-by system;
+      key k;
+      leaf k{
+        type int32;
+      }
+      leaf v{
+        type string;
+      }
+    }
+    leaf-list u{
+      ordered-by user;
+      type string;
+    }
+  }
+}
+EOF
+
+new "generate running with $nr even entries"
+echo -n "<${DATASTORE_TOP}><c xmlns=\"urn:example:bulk\">" > $dir/running_db
+for (( i=0; i<$nr; i++ )); do
+    echo -n "<y><k>$(( 2*i ))</k><v>old</v></y>" >> $dir/running_db
+done
+echo -n "</c></${DATASTORE_TOP}>" >> $dir/running_db
+
+new "generate edit with $nr odd entries in reverse order"
+edit="<c xmlns=\"urn:example:bulk\"><d>x</d>"
+for (( i=$nr-1; i>=0; i-- )); do
+    edit+="<y><k>$(( 2*i+1 ))</k><v>new</v></y><u>u$i</u>"
+done
+edit+="</c>"
+
+new "generate expected result"
+expect="<c xmlns=\"urn:example:bulk\"><d>x</d>"
+for (( i=0; i<2*$nr; i++ )); do
+    if [ $(( i%2 )) -eq 0 ]; then
+        expect+="<y><k>$i</k><v>old</v></y>"
+    else
+        expect+="<y><k>$i</k><v>new</v></y>"
+    fi
+done
+for (( i=$nr-1; i>=0; i-- )); do
+    expect+="<u>u$i</u>"
+done
+expect+="</c>"
+
+new "test params: -s running -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend"
+    start_backend -s running -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit-config merge $nr new entries"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$edit</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check candidate sorted"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$expect</data></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check running sorted"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$expect</data></rpc-reply>"
+
+new "find new entry after bulk insert"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/b:c/b:y[b:k='3']\" xmlns:b=\"urn:example:bulk\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:bulk\"><y><k>3</k><v>new</v></y></c></data></rpc-reply>"
+
+new "generate edit with $nr new entries and an existing entry last"
+edit="<c xmlns=\"urn:example:bulk\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\">"
+for (( i=0; i<$nr; i++ )); do
+    edit+="<y><k>$(( 1000+i ))</k></y>"
+done
+edit+="<y nc:operation=\"create\"><k>0</k></y></c>"
+
+new "edit-config create existing entry after new entries, error"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$edit</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>data-exists</error-tag><error-severity>error</error-severity><error-message>Data already exists; cannot create new resource</error-message></rpc-error></rpc-reply>"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check candidate after discard"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$expect</data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
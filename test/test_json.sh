@@ -174,6 +174,19 @@ JSON='{"text":"bmp:\uFAIL"}'
 new "json escaping unicode BMP fail"
 expecteofx "$clixon_util_json -j -D $DBG" 255 "$JSON" 2> /dev/null
 
+# JSON stream translating in parts, output is the same as translating all at once
+JSON='{"data": {"a": [],"b": [{"name": 17},{"name": 42},{"name": 99}],"c": {"d": [1,2]}}}'
+expect=$(echo "$JSON" | $clixon_util_json -j)
+for len in 0 1 16; do
+    new "json stream parts of $len bytes"
+    expecteofx "$clixon_util_json -s $len" 0 "$JSON" "$expect"
+done
+
+JSON='{"json:c":{"a":42,"s":"string"},"json:g1":"json:blues"}'
+expect=$(echo "$JSON" | $clixon_util_json -jpy $fyang)
+new "json stream pretty with yang"
+expecteofeq "$clixon_util_json -s 1 -py $fyang" 0 "$JSON" "$expect"
+
 rm -rf $dir
 
 new "endtest"
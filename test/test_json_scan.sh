@@ -0,0 +1,146 @@
+#!/usr/bin/env bash
+# Test: hand-written JSON scanner, see CLICON_JSON_SCANNER
+# Parse with the lex/yacc parser and with the scanner (clixon_util_json -S) and check that
+# the output and exit status are the same, for valid and invalid JSON
+# With yang, module names are translated to namespaces by the scanner
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_json:=clixon_util_json}
+
+fjson=$dir/large.json
+fyang=$dir/scan.yang
+
+# Number of list entries in large file
+: ${perfnr:=1000}
+
+cat <<EOF > $fyang
+module scan{
+  yang-version 1.1;
+  namespace "urn:example:scan";
+  prefix s;
+  container c{
+    list l{
+      key "k";
+      leaf k{
+        type uint32;
+      }
+      leaf v{
+        type string;
+      }
+    }
+    leaf-list ll{
+      type string;
+    }
+    leaf x{
+      type string;
+    }
+    container e{
+      presence true;
+    }
+  }
+}
+EOF
+
+# Parse input with both parsers and compare
+# 1: JSON input
+# 2: Extra options, eg yang
+scan_cmp(){
+    input=$1
+    opts=$2
+    new "scan: $opts $input"
+    ret0=$(echo -n "$input" | $clixon_util_json $opts 2> /dev/null)
+    r0=$?
+    ret1=$(echo -n "$input" | $clixon_util_json -S $opts 2> /dev/null)
+    r1=$?
+    if [ $r0 -ne $r1 ]; then
+        err "status $r0" "status $r1"
+    fi
+    if [ $r0 -eq 0 -a "$ret0" != "$ret1" ]; then
+        err "$ret0" "$ret1"
+    fi
+}
+
+# Valid JSON
+scan_cmp '{"a":1}'
+scan_cmp '{"a":-23}'
+scan_cmp '{"a":1.5,"b":.5,"c":2.,"d":-1.5e+3,"e":1E-2}'
+scan_cmp '{"a":true,"b":false,"c":null}'
+scan_cmp '{"a":"x y","b":""}'
+scan_cmp '{"a":"\"\\\/\b\f\n\r\t"}'
+scan_cmp '{"a":"Aå€"}'
+scan_cmp '{"a":{"b":{"c":"x"}}}'
+scan_cmp '{"a":{}}'
+scan_cmp '{"a":[]}'
+scan_cmp '{"a":[1,2,3]}'
+scan_cmp '{"a":[{"b":1},{"b":2}]}'
+scan_cmp '{"a":[[1,2],[3]]}'
+scan_cmp '{"m:a":{"n:b":1,"c":2}}'
+scan_cmp '{"":1}'
+scan_cmp ' { "a" : [ 1 , 2 ] ,
+ "b" : "x" } '
+scan_cmp '"x"'
+scan_cmp '17'
+scan_cmp '[1]'
+scan_cmp '{}'
+
+# Invalid JSON
+scan_cmp ''
+scan_cmp '{'
+scan_cmp '{"a"}'
+scan_cmp '{"a":}'
+scan_cmp '{"a":1,}'
+scan_cmp '{"a":[1,]}'
+scan_cmp '{"a":1 "b":2}'
+scan_cmp '{"a":1e5}'
+scan_cmp '{"a":-}'
+scan_cmp '{"a":01.2.3}'
+scan_cmp '{"a":tru}'
+scan_cmp '{"a":"x}'
+scan_cmp '{"a":"\x"}'
+scan_cmp '{"a":"\u12"}'
+scan_cmp '{"a":"x
+y"}'
+scan_cmp '{"a":1}}'
+scan_cmp '{"a":1} x'
+scan_cmp "{'a':1}"
+
+# Module names translated to namespaces
+scan_cmp '{"scan:c":{"x":"a","l":[{"k":2},{"k":1,"v":"b"}],"ll":["b","a"]}}' "-y $fyang"
+scan_cmp '{"scan:c":{"scan:x":"a"}}' "-y $fyang"
+scan_cmp '{"scan:c":{"e":[null]}}' "-y $fyang"
+scan_cmp '[{"scan:c":{"x":"a"}}]' "-y $fyang"
+# Not qualified or unknown module
+scan_cmp '{"c":{"x":"a"}}' "-y $fyang"
+scan_cmp '{"foo:c":{"x":"a"}}' "-y $fyang"
+scan_cmp '{"scan:c":{"foo:x":"a"}}' "-y $fyang"
+
+new "generate large file with $perfnr entries"
+echo -n '{"scan:c":{"l":[' > $fjson
+for (( i=$perfnr; i>1; i-- )); do
+    echo -n "{\"k\":$i,\"v\":\"v\\\"$i\\u0041\"}," >> $fjson
+done
+echo '{"k":1}],"scan:x":"z"}}' >> $fjson
+
+new "parse large file"
+ret0=$($clixon_util_json -y $fyang < $fjson)
+if [ $? -ne 0 ]; then
+    err "0" "$?"
+fi
+
+new "scan large file"
+ret1=$($clixon_util_json -S -y $fyang < $fjson)
+if [ $? -ne 0 ]; then
+    err "0" "$?"
+fi
+
+new "compare large file"
+if [ "$ret0" != "$ret1" ]; then
+    err "$ret0" "$ret1"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
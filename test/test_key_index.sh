@@ -0,0 +1,154 @@
+#!/usr/bin/env bash
+# Test hash key index of large lists, see XML_KEY_INDEX
+# Lookups are made in lists larger than XML_KEY_INDEX_THRESHOLD (256) for these cases:
+#   - single string key, ordered-by system
+#   - single string key, ordered-by user
+#   - two string keys
+#   - int key, indexed on encoded keys, see XML_KEY_ENCODE
+#   - negative int and string keys
+#   - int key not in canonical form, compared as typed value
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_path:=clixon_util_path -D $DBG -Y /usr/local/share/clixon}
+
+# Number of list entries
+: ${nr:=2000}
+
+xml=$dir/xml.xml
+ydir=$dir/yang
+
+if [ ! -d $ydir ]; then
+    mkdir $ydir
+fi
+
+cat <<EOF > $ydir/moda.yang
+module moda{
+  namespace "urn:example:a";
+  prefix a;
+  container x1{
+    list y{
+      ordered-by system;
+      key k1;
+      leaf k1{
+        type string;
+      }
+      leaf z{
+        type string;
+      }
+    }
+  }
+  container x2{
+    list y{
+      ordered-by user;
+      key k1;
+      leaf k1{
+        type string;
+      }
+      leaf z{
+        type string;
+      }
+    }
+  }
+  container x3{
+    list y{
+      key "k1 k2";
+      leaf k1{
+        type string;
+      }
+      leaf k2{
+        type string;
+      }
+      leaf z{
+        type string;
+      }
+    }
+  }
+  container x4{
+    list y{
+      key k1;
+      leaf k1{
+        type int32;
+      }
+      leaf z{
+        type string;
+      }
+    }
+  }
+  container x5{
+    list y{
+      key "k1 k2";
+      leaf k1{
+        type int64;
+      }
+      leaf k2{
+        type string;
+      }
+      leaf z{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+new "generate lists with $nr entries to $xml"
+echo -n '<top>' > $xml
+echo -n '<x1 xmlns="urn:example:a">' >> $xml
+for (( i=0; i<$nr; i++ )); do  
+    echo -n "<y><k1>a$i</k1><z>foo$i</z></y>" >> $xml
+done
+echo -n '</x1><x2 xmlns="urn:example:a">' >> $xml
+for (( i=$nr-1; i>=0; i-- )); do  
+    echo -n "<y><k1>a$i</k1><z>foo$i</z></y>" >> $xml
+done
+echo -n '</x2><x3 xmlns="urn:example:a">' >> $xml
+for (( i=0; i<$nr; i++ )); do  
+    echo -n "<y><k1>a$i</k1><k2>b$i</k2><z>foo$i</z></y>" >> $xml
+done
+echo -n '</x3><x4 xmlns="urn:example:a">' >> $xml
+for (( i=0; i<$nr; i++ )); do  
+    echo -n "<y><k1>$i</k1><z>foo$i</z></y>" >> $xml
+done
+echo -n '</x4><x5 xmlns="urn:example:a">' >> $xml
+for (( i=0; i<$nr; i++ )); do  
+    echo -n "<y><k1>$(( i - nr/2 ))</k1><k2>b$i</k2><z>foo$i</z></y>" >> $xml
+done
+echo -n '</x5></top>' >> $xml
+
+for (( ii=0; ii<5; ii++ )); do
+    rnd=$(( ( RANDOM % $nr ) ))
+    new "ordered-by system string key k1=a$rnd"
+    expectpart "$($clixon_util_path -f $xml -y $ydir -p /a:x1/a:y[a:k1=\"a$rnd\"])" 0 "^0: <y><k1>a$rnd</k1><z>foo$rnd</z></y>$"
+
+    new "ordered-by user string key k1=a$rnd"
+    expectpart "$($clixon_util_path -f $xml -y $ydir -p /a:x2/a:y[a:k1=\"a$rnd\"])" 0 "^0: <y><k1>a$rnd</k1><z>foo$rnd</z></y>$"
+
+    new "two string keys k1=a$rnd k2=b$rnd"
+    expectpart "$($clixon_util_path -f $xml -y $ydir -p /a:x3/a:y[a:k1=\"a$rnd\"][a:k2=\"b$rnd\"])" 0 "^0: <y><k1>a$rnd</k1><k2>b$rnd</k2><z>foo$rnd</z></y>$"
+
+    new "int key k1=$rnd"
+    expectpart "$($clixon_util_path -f $xml -y $ydir -p /a:x4/a:y[a:k1=\"$rnd\"])" 0 "^0: <y><k1>$rnd</k1><z>foo$rnd</z></y>$"
+
+    k=$(( rnd - nr/2 ))
+    new "int and string keys k1=$k k2=b$rnd"
+    expectpart "$($clixon_util_path -f $xml -y $ydir -p /a:x5/a:y[a:k1=\"$k\"][a:k2=\"b$rnd\"])" 0 "^0: <y><k1>$k</k1><k2>b$rnd</k2><z>foo$rnd</z></y>$"
+done
+
+new "int key not in canonical form k1=007"
+expectpart "$($clixon_util_path -f $xml -y $ydir -p /a:x4/a:y[a:k1=\"007\"])" 0 "^0: <y><k1>7</k1><z>foo7</z></y>$"
+
+new "int key not found"
+expectpart "$($clixon_util_path -f $xml -y $ydir -p /a:x4/a:y[a:k1=\"$nr\"])" 0 "^$"
+
+new "string key not found"
+expectpart "$($clixon_util_path -f $xml -y $ydir -p /a:x1/a:y[a:k1=\"a$nr\"])" 0 "^$"
+
+new "two string keys, other key mismatch"
+expectpart "$($clixon_util_path -f $xml -y $ydir -p /a:x3/a:y[a:k1=\"a1\"][a:k2=\"b2\"])" 0 "^$"
+
+rm -rf $dir
+
+new "endtest"
+endtest
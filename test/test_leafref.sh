@@ -192,6 +192,22 @@ expectpart "$($clixon_cli -1f $cfg -l o set sender a)" 0 "^$"
 new "cli sender template"
 expectpart "$($clixon_cli -1f $cfg -l o set sender b template a)" 0 "^$"
 
+new "cli sender templates"
+expectpart "$($clixon_cli -1f $cfg -l o set sender c template b)" 0 "^$"
+
+new "cli sender template to missing sender"
+expectpart "$($clixon_cli -1f $cfg -l o set sender d template x)" 0 "^$"
+
+# Several leafrefs with the same path are looked up in the leafref index of the validation
+new "cli validate fails on missing sender"
+expectpart "$($clixon_cli -1f $cfg -l o validate 2>&1)" 255 "Leafref validation failed: No leaf x matching path /sender/name"
+
+new "cli sender template to existing sender"
+expectpart "$($clixon_cli -1f $cfg -l o set sender d template c)" 0 "^$"
+
+new "cli validate"
+expectpart "$($clixon_cli -1f $cfg -l o validate)" 0 "^$"
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
@@ -0,0 +1,95 @@
+#!/usr/bin/env bash
+# Load generator of concurrent sessions using clixon_util_load
+# Run small closed and open loop loads on the internal socket and via netconf, and check
+# that all requests are replied without errors. No timing limits are checked
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_load:="clixon_util_load"}
+
+: ${perfnr:=200}
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/scaling.yang
+sock=/usr/local/var/$APPNAME/$APPNAME.sock
+
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix sc;
+   container x {
+      list y {
+         key "a";
+         leaf a {
+            type int32;
+         }
+         leaf b {
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "closed loop internal socket, 4 sessions, mix"
+expectpart "$($clixon_util_load -s $sock -c 4 -n $perfnr -k 100 -m get=20,get-config=40,edit-config=30,commit=10)" 0 "^latency(us)" "^get " "^get-config " "^edit-config " "^commit " "^all \+$perfnr \+0 "
+
+new "open loop internal socket as JSON"
+expectpart "$($clixon_util_load -s $sock -c 2 -n 50 -r 500 -m get-config=1,edit-config=1 -j)" 0 "{\"proto\":\"internal\",\"clients\":2,\"rate\":500," "{\"name\":\"all\",\"count\":50,\"errors\":0,"
+
+new "closed loop netconf, 2 sessions"
+expectpart "$($clixon_util_load -p netconf -C "$clixon_netconf -qf $cfg" -c 2 -n 50 -m get-config=1,edit-config=1)" 0 "^all \+50 \+0 "
+
+new "whole datastore get-config and edit-config"
+expectpart "$($clixon_util_load -s $sock -n 20 -W -m get-config,edit-config)" 0 "^all \+20 \+0 "
+
+new "commit with restconf is an error"
+expectpart "$($clixon_util_load -p restconf -s 127.0.0.1 -m commit 2>&1)" 255 "commit is not supported by restconf"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+# unset conditional parameters
+unset clixon_util_load
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,96 @@
+#!/usr/bin/env bash
+# Asynchronous logging and rate limit, see CLICON_LOG_ASYNC and CLICON_LOG_RATE_LIMIT
+# Log backend debug messages in a background thread to file and check they are written.
+# Send many erroneous requests and check errors are rate limited and counted as dropped
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/log.yang
+flog=$dir/backend.log
+
+# Number of erroneous requests
+: ${perfnr:=20}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_LOG_ASYNC>true</CLICON_LOG_ASYNC>
+  <CLICON_LOG_RATE_LIMIT>2</CLICON_LOG_RATE_LIMIT>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module log{
+  yang-version 1.1;
+  namespace "urn:example:log";
+  prefix l;
+  container table{
+    leaf x{
+      type string;
+    }
+  }
+}
+EOF
+
+sudo rm -f $flog
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -D 1 -l f$flog"
+    start_backend -s init -f $cfg -D 1 -l f$flog
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:log\"><x>foo</x></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "$perfnr erroneous xpaths in one session"
+rpc="<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/l:table[[\" xmlns:l=\"urn:example:log\"/></get-config></rpc>]]>]]>"
+rpcs=""
+for (( i=0; i<$perfnr; i++ )); do
+    rpcs+="$rpc"
+done
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11$rpcs" "<rpc-error>"
+
+new "errors are dropped by rate limit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats $LIBNS/></rpc>" "" "<logdropped>[1-9][0-9]*</logdropped>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+
+    new "log messages are written"
+    expectpart "$(sudo cat $flog)" 0 "Started" "rpc:edit-config" "rpc:stats"
+
+    new "errors are rate limited"
+    nr=$(sudo grep -c "at or before" $flog)
+    if [ $nr -ge $perfnr ]; then
+        err "less than $perfnr" "$nr"
+    fi
+fi
+
+sudo rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,134 @@
+#!/usr/bin/env bash
+# Memory per subsystem in the stats rpc
+# Compile a backend plugin allocating memory with clixon_plugin_malloc, edit candidate and
+# check datastore, yang, client and plugin memory
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/mem.yang
+pdir=$dir/plugin
+
+if [ ! -d $pdir ]; then
+    mkdir $pdir
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>$pdir</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module mem{
+  yang-version 1.1;
+  namespace "urn:example:mem";
+  prefix m;
+  container c{
+    leaf a{
+      type string;
+    }
+  }
+}
+EOF
+
+cat <<EOF > $dir/pm.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syslog.h>
+
+/* clicon */
+#include <cligen/cligen.h>
+
+/* Clicon library functions. */
+#include <clixon/clixon.h>
+
+/* These include signatures for plugin and transaction callbacks. */
+#include <clixon/clixon_backend.h>
+
+static char *buf = NULL;
+
+static int
+pm_start(clicon_handle h)
+{
+    if ((buf = clixon_plugin_malloc(1000)) == NULL)
+        return -1;
+    if ((buf = clixon_plugin_realloc(buf, 10000)) == NULL)
+        return -1;
+    return 0;
+}
+
+static int
+pm_exit(clicon_handle h)
+{
+    clixon_plugin_free(buf);
+    return 0;
+}
+
+clixon_plugin_api *clixon_plugin_init(clicon_handle h);
+
+static clixon_plugin_api api = {
+    "pm",
+    clixon_plugin_init,
+    .ca_start=pm_start,
+    .ca_exit=pm_exit,
+};
+
+clixon_plugin_api *
+clixon_plugin_init(clicon_handle h)
+{
+    return &api;
+}
+EOF
+
+new "compile pm"
+expectpart "$($CC -g -Wall -rdynamic -fPIC -shared -I/usr/local/include $dir/pm.c -o $pdir/pm.so)" 0 ""
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit candidate"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:mem\"><a>x</a></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "stats memory datastore and yang"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats $LIBNS/></rpc>" "" "<memory $LIBNS>" "<datastore><name>candidate</name><size>[1-9][0-9]*</size></datastore>" "<yang><name>main</name><nr>[1-9][0-9]*</nr><size>[1-9][0-9]*</size></yang><yang><name>clixon-config</name>"
+
+new "stats memory clients and plugins"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats $LIBNS/></rpc>" "" "<clients><nr>[1-9][0-9]*</nr><size>[1-9][0-9]*</size></clients><plugins><nr>1</nr><size>10000</size></plugins><total>[1-9][0-9]*</total>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,113 @@
+#!/usr/bin/env bash
+# Prewarmed netconf: a resident clixon_netconf -Z has loaded config, yang and plugins and
+# forks one session for each handoff from clixon_netconf -z, see netconf_zygote.c
+# Sessions are independent and get their own session-id
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+zsock=$dir/zygote.sock
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_NETCONF_DIR>/usr/local/lib/$APPNAME/netconf</CLICON_NETCONF_DIR>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container table{
+    list parameter{
+      key name;
+      leaf name{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+new "test params: -f $cfg"
+# Bring your own backend
+if [ $BE -ne 0 ]; then
+    # kill old backend (if any)
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "start prewarmed netconf"
+sudo clixon_netconf -qf $cfg -Z $zsock &
+for i in $(seq 1 20); do
+    if [ -S $zsock ]; then
+        break
+    fi
+    sleep $DEMSLEEP
+done
+if [ ! -S $zsock ]; then
+    err "$zsock" "no zygote socket"
+fi
+
+# Session helper does not read config or yang
+helper="sudo clixon_netconf -z $zsock"
+
+new "Netconf edit-config via prewarmed session"
+expecteof_netconf "$helper" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Netconf get-config in new prewarmed session"
+expecteof_netconf "$helper" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>"
+
+new "Netconf discard-changes"
+expecteof_netconf "$helper" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Netconf two concurrent prewarmed sessions"
+(echo "$DEFAULTHELLO"; sleep 2) | $helper > /dev/null &
+pid1=$!
+expecteof_netconf "$helper" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+wait $pid1
+
+new "Session helper without zygote: error"
+expectpart "$(sudo clixon_netconf -l e -z $dir/notexist.sock 2>&1)" 255 "connect"
+
+new "kill prewarmed netconf"
+sudo pkill -f "clixon_netconf -qf $cfg -Z $zsock"
+sleep $DEMSLEEP
+if [ -e $zsock ]; then
+    err "no $zsock" "zygote socket remains"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
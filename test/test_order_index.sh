@@ -0,0 +1,125 @@
+#!/usr/bin/env bash
+# Test order index of large ordered-by user lists, see XML_ORDER_INDEX
+# Insert first, last, before and after entries of a list larger than
+# XML_ORDER_INDEX_THRESHOLD (1024), and remove entries, then check the order.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/orderindex.yang
+
+# Number of list entries
+: ${nr:=1500}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module orderindex{
+  yang-version 1.1;
+  namespace "urn:example:oi";
+  prefix oi;
+  container c{
+    leaf a{
+      type string;
+    }
+    list y{
+      ordered-by user;
+      key k;
+      leaf k{
+        type string;
+      }
+    }
+    leaf z{
+      type string;
+    }
+  }
+}
+EOF
+
+new "generate running with $nr entries"
+echo -n "<${DATASTORE_TOP}><c xmlns=\"urn:example:oi\"><a>x</a>" > $dir/running_db
+for (( i=0; i<$nr; i++ )); do
+    echo -n "<y><k>u$i</k></y>" >> $dir/running_db
+done
+echo -n "<z>x</z></c></${DATASTORE_TOP}>" >> $dir/running_db
+
+new "generate expected result: first, u0-u9, before, u10-u500, after, u501-, last, u3 removed"
+expect="<c xmlns=\"urn:example:oi\"><a>x</a><y><k>first</k></y>"
+for (( i=0; i<$nr; i++ )); do
+    if [ $i -eq 10 ]; then
+        expect+="<y><k>before</k></y>"
+    fi
+    if [ $i -ne 3 ]; then
+        expect+="<y><k>u$i</k></y>"
+    fi
+    if [ $i -eq 500 ]; then
+        expect+="<y><k>after</k></y>"
+    fi
+done
+expect+="<y><k>last</k></y><z>x</z></c>"
+
+new "test params: -s running -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend"
+    start_backend -s running -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "insert before u10"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:oi\"><y xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\" yang:insert=\"before\" yang:key=\"[oi:k='u10']\" xmlns:oi=\"urn:example:oi\"><k>before</k></y></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "insert after u500"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:oi\"><y xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\" yang:insert=\"after\" yang:key=\"[oi:k='u500']\" xmlns:oi=\"urn:example:oi\"><k>after</k></y></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "insert first"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:oi\"><y xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\" yang:insert=\"first\"><k>first</k></y></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "insert last"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:oi\"><y><k>last</k></y></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "remove u3"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:oi\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><y nc:operation=\"remove\"><k>u3</k></y></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check candidate order"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$expect</data></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check running order"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$expect</data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,132 @@
+#!/usr/bin/env bash
+# List pagination of config lists with offset/limit and with the clixon cursor attribute
+# The page starts after the list entry given by cl:cursor, which need not exist in an
+# ordered-by system list, but must exist in an ordered-by user list
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/cursor.yang
+
+# Number of list entries, keys are 0, 2, 4, ...
+: ${perfnr:=100}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$IETFRFC</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module cursor{
+  yang-version 1.1;
+  namespace "urn:example:cursor";
+  prefix c;
+  container c{
+    list e{
+      key k;
+      leaf k{
+        type uint32;
+      }
+    }
+    leaf-list u{
+      type string;
+      ordered-by user;
+    }
+  }
+}
+EOF
+
+# Get-config of running with list pagination
+# 1: xpath
+# 2: list-pagination children
+# 3: cursor attribute or empty
+# 4: expected reply
+getpage(){
+    xpath=$1
+    lp=$2
+    cursor=$3
+    reply=$4
+    attr=""
+    if [ -n "$cursor" ]; then
+        attr=" xmlns:cl=\"http://clicon.org/lib\" cl:cursor=\"$cursor\""
+    fi
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config$attr><source><running/></source><filter type=\"xpath\" select=\"$xpath\" xmlns:c=\"urn:example:cursor\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\">$lp</list-pagination></get-config></rpc>" "" "$reply"
+}
+
+new "generate config with $perfnr list entries"
+echo "<config><c xmlns=\"urn:example:cursor\">" > $dir/startup_db
+for (( i=$perfnr-1; i>=0; i-- )); do
+    echo "<e><k>$((2*i))</k></e>" >> $dir/startup_db
+done
+echo "<u>c</u><u>a</u><u>b</u>" >> $dir/startup_db
+echo "</c></config>" >> $dir/startup_db
+
+new "test params: -f $cfg -s startup"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "offset 10 limit 3"
+getpage "/c:c/c:e" "<offset>10</offset><limit>3</limit>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:cursor\"><e><k>20</k></e><e><k>22</k></e><e><k>24</k></e></c></data></rpc-reply>"
+
+new "offset without limit, all after offset"
+getpage "/c:c/c:e" "<offset>$(($perfnr-2))</offset>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:cursor\"><e><k>$((2*$perfnr-4))</k></e><e><k>$((2*$perfnr-2))</k></e></c></data></rpc-reply>"
+
+new "cursor 20 limit 3"
+getpage "/c:c/c:e" "<limit>3</limit>" "20" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:cursor\"><e><k>22</k></e><e><k>24</k></e><e><k>26</k></e></c></data></rpc-reply>"
+
+new "cursor non-existing key 21 limit 2"
+getpage "/c:c/c:e" "<limit>2</limit>" "21" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:cursor\"><e><k>22</k></e><e><k>24</k></e></c></data></rpc-reply>"
+
+new "cursor 20 offset 2 limit 1"
+getpage "/c:c/c:e" "<offset>2</offset><limit>1</limit>" "20" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:cursor\"><e><k>26</k></e></c></data></rpc-reply>"
+
+new "cursor last entry"
+getpage "/c:c/c:e" "<limit>2</limit>" "$((2*$perfnr-2))" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "cursor with too many keys"
+getpage "/c:c/c:e" "<limit>2</limit>" "20,22" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-attribute</error-tag><error-info><bad-attribute>cursor</bad-attribute></error-info><error-severity>error</error-severity><error-message>Cursor does not match keys of list</error-message></rpc-error></rpc-reply>"
+
+new "ordered-by user cursor a limit 1"
+getpage "/c:c/c:u" "<limit>1</limit>" "a" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:cursor\"><u>b</u></c></data></rpc-reply>"
+
+new "ordered-by user cursor not found"
+getpage "/c:c/c:u" "<limit>1</limit>" "x" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>invalid-value</error-tag><error-severity>error</error-severity><error-message>list-pagination cursor entry not found</error-message></rpc-error></rpc-reply>"
+
+new "cursor without list-pagination"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config xmlns:cl=\"http://clicon.org/lib\" cl:cursor=\"20\"><source><running/></source><filter type=\"xpath\" select=\"/c:c/c:e\" xmlns:c=\"urn:example:cursor\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-attribute</error-tag>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
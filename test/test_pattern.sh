@@ -26,7 +26,10 @@ regexlist="posix"
 if [ "${WITH_LIBXML2}" = yes ] ; then
     regexlist="$regexlist libxml2"
 fi
-# Loop over supported regexps. Always run posix, run libxml2 if configured
+if [ "${WITH_PCRE2}" = yes ] ; then
+    regexlist="$regexlist pcre2"
+fi
+# Loop over supported regexps. Always run posix, run libxml2 and pcre2 if configured
 for regex in $regexlist; do
     new "pattern tests for regex:$regex"
     
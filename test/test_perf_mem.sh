@@ -101,8 +101,12 @@ function testrun(){
     fi
     objects=$(echo "$res" | $clixon_util_xpath -p "/rpc-reply/global/xmlnr" | awk -F ">" '{print $2}' | awk -F "<" '{print $1}')
 
+    arenas=$(echo "$res" | $clixon_util_xpath -p "/rpc-reply/global/xmlarenanr" | awk -F ">" '{print $2}' | awk -F "<" '{print $1}')
+    arenasize=$(echo "$res" | $clixon_util_xpath -p "/rpc-reply/global/xmlarenasize" | awk -F ">" '{print $2}' | awk -F "<" '{print $1}')
+
     echo "Total"
     echo "   objects: $objects"
+    echo "   arenas: $arenas ($arenasize bytes)"
 
 #
     if [ -f /proc/$pid/statm ]; then     # This only works on Linux 
@@ -121,6 +125,8 @@ function testrun(){
         echo $resdb | $clixon_util_xpath -p "datastore/nr" | awk -F ">" '{print $2}' | awk -F "<" '{print $1}'
         echo -n "   mem: "
         echo $resdb | $clixon_util_xpath -p "datastore/size" | awk -F ">" '{print $2}' | awk -F "<" '{print $1}' | awk '{print $1/1000000 "M"}'
+        echo -n "   bytes per object: "
+        echo $resdb | $clixon_util_xpath -p "datastore/nodesize" | awk -F ">" '{print $2}' | awk -F "<" '{print $1}'
     done
     if [ $BE -ne 0 ]; then
         new "Kill backend"
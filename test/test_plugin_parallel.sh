@@ -0,0 +1,255 @@
+#!/usr/bin/env bash
+# Parallel commit and start callbacks of backend plugins, see CLICON_PLUGIN_COMMIT_THREADS
+# and CLICON_PLUGIN_START_THREADS
+# Compile four backend plugins:
+# pa: parallel-safe, commit and start wait until pb has started its commit or start
+# pb: parallel-safe, commit and start signal pa
+# pc: parallel-safe, after pa, commit and start check that pa is done
+# pd: not parallel-safe, commit fails on a special value
+# Check that the backend starts and commit succeeds only if pa and pb run in parallel,
+# and that a failing commit reverts the committed plugins
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/parallel.yang
+pdir=$dir/plugin
+
+if [ ! -d $pdir ]; then
+    mkdir $pdir
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>$pdir</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_PLUGIN_COMMIT_THREADS>4</CLICON_PLUGIN_COMMIT_THREADS>
+  <CLICON_PLUGIN_START_THREADS>4</CLICON_PLUGIN_START_THREADS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module parallel{
+  yang-version 1.1;
+  namespace "urn:example:parallel";
+  prefix p;
+  container c{
+    leaf a{
+      type string;
+    }
+  }
+}
+EOF
+
+# Create plugin C file
+# 1: plugin name
+# 2: parallel-safe (0 or 1)
+# 3: ca_trans_after and ca_start_after initializer
+# 4: commit function body
+# 5: start function body
+plugin(){
+    name=$1
+    parallel=$2
+    after=$3
+    body=$4
+    sbody=$5
+    cat <<EOF > $dir/$name.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syslog.h>
+
+/* clicon */
+#include <cligen/cligen.h>
+
+/* Clicon library functions. */
+#include <clixon/clixon.h>
+
+/* These include signatures for plugin and transaction callbacks. */
+#include <clixon/clixon_backend.h>
+
+static int
+file_exists(char *file)
+{
+    struct stat st;
+
+    return stat(file, &st) == 0;
+}
+
+static int
+file_touch(char *file)
+{
+    FILE *f;
+
+    if ((f = fopen(file, "w")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen %s", file);
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+static int
+${name}_commit(clicon_handle    h,
+               transaction_data td)
+{
+    int   i;
+
+    i = 0; /* may be unused */
+    $body
+    return i;
+}
+
+static int
+${name}_revert(clicon_handle    h,
+               transaction_data td)
+{
+    return file_touch("$dir/${name}_reverted");
+}
+
+static int
+${name}_start(clicon_handle h)
+{
+    int   i;
+
+    i = 0; /* may be unused */
+    $sbody
+    return i;
+}
+
+static char *after[] = {$after NULL};
+
+clixon_plugin_api *clixon_plugin_init(clicon_handle h);
+
+static clixon_plugin_api api = {
+    "$name",
+    clixon_plugin_init,
+    .ca_trans_commit=${name}_commit,
+    .ca_trans_revert=${name}_revert,
+    .ca_start=${name}_start,
+    .ca_trans_parallel=$parallel,
+    .ca_trans_after=after,
+    .ca_start_parallel=$parallel,
+    .ca_start_after=after,
+};
+
+clixon_plugin_api *
+clixon_plugin_init(clicon_handle h)
+{
+    return &api;
+}
+EOF
+    new "compile $name"
+    expectpart "$($CC -g -Wall -rdynamic -fPIC -shared -I/usr/local/include $dir/$name.c -o $pdir/$name.so)" 0 ""
+}
+
+# pa waits at most 5s for pb
+plugin pa 1 "" "for (i=0; i<50 && !file_exists(\"$dir/pb_started\"); i++) usleep(100000);
+    if (!file_exists(\"$dir/pb_started\")){
+        clicon_err(OE_PLUGIN, 0, \"pb not started\");
+        return -1;
+    }
+    unlink(\"$dir/pb_started\");
+    i = file_touch(\"$dir/pa_done\");" "for (i=0; i<50 && !file_exists(\"$dir/pb_start\"); i++) usleep(100000);
+    if (!file_exists(\"$dir/pb_start\")){
+        clicon_err(OE_PLUGIN, 0, \"pb not started\");
+        return -1;
+    }
+    unlink(\"$dir/pb_start\");
+    i = file_touch(\"$dir/pa_start\");"
+
+plugin pb 1 "" "i = file_touch(\"$dir/pb_started\");" "i = file_touch(\"$dir/pb_start\");"
+
+plugin pc 1 "\"pa\"," "if (!file_exists(\"$dir/pa_done\")){
+        clicon_err(OE_PLUGIN, 0, \"pa not done\");
+        return -1;
+    }
+    unlink(\"$dir/pa_done\");" "if (!file_exists(\"$dir/pa_start\")){
+        clicon_err(OE_PLUGIN, 0, \"pa not started\");
+        return -1;
+    }
+    unlink(\"$dir/pa_start\");"
+
+plugin pd 0 "" "cxobj *x;
+    if ((x = xpath_first(transaction_target(td), NULL, \"/c/a\")) != NULL &&
+        strcmp(xml_body(x), \"fail\") == 0){
+        clicon_err(OE_PLUGIN, 0, \"pd commit failed\");
+        return -1;
+    }" ""
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "plugins started in parallel"
+if [ -n "$(ls $dir/pa_start $dir/pb_start 2> /dev/null)" ]; then
+    err "no start files" "$(ls $dir/pa_start $dir/pb_start 2> /dev/null)"
+fi
+
+new "edit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:parallel\"><a>foo</a></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit in parallel"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "no plugin reverted"
+if [ -n "$(ls $dir/*_reverted 2> /dev/null)" ]; then
+    err "no reverted" "$(ls $dir/*_reverted)"
+fi
+
+new "edit failing value"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:parallel\"><a>fail</a></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit fails"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error>"
+
+new "parallel plugins reverted"
+for p in pa pb pc; do
+    if [ ! -f $dir/${p}_reverted ]; then
+        err "$dir/${p}_reverted" "none"
+    fi
+done
+if [ -f $dir/pd_reverted ]; then
+    err "pd not reverted" "$dir/pd_reverted"
+fi
+
+new "check running"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:parallel\"><a>foo</a></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,182 @@
+#!/usr/bin/env bash
+# State data cache of backend plugins, see ca_statedata_ttl
+# Compile a backend plugin whose state callback returns the number of times it has been
+# called, with a state data time to live, and an rpc invalidating the cache.
+# Check that repeated gets return cached state data until the cache is invalidated or the
+# time to live expires, and that cache hits and misses are counted in the stats rpc
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/cache.yang
+pdir=$dir/plugin
+cfile=$dir/pcache.c
+
+# State data time to live in ms
+ttl=2000
+
+if [ ! -d $pdir ]; then
+    mkdir $pdir
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>$pdir</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module cache{
+  yang-version 1.1;
+  namespace "urn:example:cache";
+  prefix c;
+  container s{
+    config false;
+    leaf n{
+      description "Number of state callback calls";
+      type uint32;
+    }
+  }
+  rpc invalidate{
+    description "Invalidate cached state data";
+  }
+}
+EOF
+
+cat <<EOF > $cfile
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <sys/syslog.h>
+
+/* clicon */
+#include <cligen/cligen.h>
+
+/* Clicon library functions. */
+#include <clixon/clixon.h>
+
+/* These include signatures for plugin and transaction callbacks. */
+#include <clixon/clixon_backend.h>
+
+static uint32_t calls = 0;
+
+static int
+pcache_statedata(clicon_handle h,
+                 cvec         *nsc,
+                 char         *xpath,
+                 cxobj        *xstate)
+{
+    return clixon_xml_parse_va(YB_NONE, NULL, &xstate, NULL,
+                               "<s xmlns=\"urn:example:cache\"><n>%u</n></s>", ++calls);
+}
+
+static int
+invalidate_rpc(clicon_handle h,
+               cxobj        *xe,
+               cbuf         *cbret,
+               void         *arg,
+               void         *regarg)
+{
+    if (clixon_plugin_statedata_invalidate(h, "pcache") < 0)
+        return -1;
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+    return 0;
+}
+
+clixon_plugin_api *clixon_plugin_init(clicon_handle h);
+
+static clixon_plugin_api api = {
+    "pcache",
+    clixon_plugin_init,
+    .ca_statedata=pcache_statedata,
+    .ca_statedata_ttl=$ttl,
+};
+
+clixon_plugin_api *
+clixon_plugin_init(clicon_handle h)
+{
+    if (rpc_callback_register(h, invalidate_rpc, NULL, "urn:example:cache", "invalidate") < 0)
+        return NULL;
+    return &api;
+}
+EOF
+
+new "compile $cfile"
+expectpart "$($CC -g -Wall -rdynamic -fPIC -shared -I/usr/local/include $cfile -o $pdir/pcache.so)" 0 ""
+
+# Get state and check number of state callback calls
+# 1: expected number of calls
+function state_get()
+{
+    n=$1
+    new "get state n=$n"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/c:s\" xmlns:c=\"urn:example:cache\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><s xmlns=\"urn:example:cache\"><n>$n</n></s></data></rpc-reply>"
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+# First call
+state_get 1
+
+# Served from cache
+state_get 1
+state_get 1
+
+new "get state with other xpath calls callback"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/c:s/c:n\" xmlns:c=\"urn:example:cache\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><s xmlns=\"urn:example:cache\"><n>2</n></s></data></rpc-reply>"
+
+new "stats hits and misses"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats $LIBNS/></rpc>" "" "<statedata-cache $LIBNS><plugin><name>pcache</name><nr>2</nr><hits>2</hits><misses>2</misses></plugin></statedata-cache>"
+
+new "invalidate"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><invalidate xmlns=\"urn:example:cache\"/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+# Callback called after invalidation
+state_get 3
+state_get 3
+
+new "wait for time to live to expire"
+sleep $(((ttl+999)/1000+1))
+
+# Callback called after expiry
+state_get 4
+state_get 4
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
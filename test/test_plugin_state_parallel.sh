@@ -0,0 +1,182 @@
+#!/usr/bin/env bash
+# Parallel state data callbacks of backend plugins, see CLICON_PLUGIN_STATEDATA_WORKERS
+# Compile three backend plugins with parallel-safe state callbacks:
+# a: waits until b has started its state callback
+# b: signals a
+# c: sleeps longer than CLICON_PLUGIN_STATEDATA_TIMEOUT
+# Check that get returns state of a only if a and b run in parallel, and that the state
+# of c is omitted
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/parallel.yang
+pdir=$dir/plugin
+
+if [ ! -d $pdir ]; then
+    mkdir $pdir
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>$pdir</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_PLUGIN_STATEDATA_WORKERS>4</CLICON_PLUGIN_STATEDATA_WORKERS>
+  <CLICON_PLUGIN_STATEDATA_TIMEOUT>3000</CLICON_PLUGIN_STATEDATA_TIMEOUT>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module parallel{
+  yang-version 1.1;
+  namespace "urn:example:parallel";
+  prefix p;
+  container s{
+    config false;
+    leaf a{
+      type string;
+    }
+    leaf b{
+      type string;
+    }
+    leaf c{
+      type string;
+    }
+  }
+}
+EOF
+
+# Create plugin C file
+# 1: plugin name
+# 2: state callback body
+plugin(){
+    name=$1
+    body=$2
+    cat <<EOF > $dir/$name.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syslog.h>
+
+/* clicon */
+#include <cligen/cligen.h>
+
+/* Clicon library functions. */
+#include <clixon/clixon.h>
+
+/* These include signatures for plugin and transaction callbacks. */
+#include <clixon/clixon_backend.h>
+
+static int
+file_exists(char *file)
+{
+    struct stat st;
+
+    return stat(file, &st) == 0;
+}
+
+static int
+file_touch(char *file)
+{
+    FILE *f;
+
+    if ((f = fopen(file, "w")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen %s", file);
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+static int
+${name}_statedata(clicon_handle h,
+                  cvec         *nsc,
+                  char         *xpath,
+                  cxobj        *xstate)
+{
+    int   i;
+
+    i = 0; /* may be unused */
+    $body
+    return clixon_xml_parse_string("<s xmlns=\"urn:example:parallel\"><$name>ok</$name></s>",
+                                   YB_NONE, NULL, &xstate, NULL);
+}
+
+clixon_plugin_api *clixon_plugin_init(clicon_handle h);
+
+static clixon_plugin_api api = {
+    "$name",
+    clixon_plugin_init,
+    .ca_statedata=${name}_statedata,
+    .ca_statedata_parallel=1,
+};
+
+clixon_plugin_api *
+clixon_plugin_init(clicon_handle h)
+{
+    return &api;
+}
+EOF
+    new "compile $name"
+    expectpart "$($CC -g -Wall -rdynamic -fPIC -shared -I/usr/local/include $dir/$name.c -o $pdir/$name.so)" 0 ""
+}
+
+# a waits at most 2s for b
+plugin a "for (i=0; i<20 && !file_exists(\"$dir/b_started\"); i++) usleep(100000);
+    if (!file_exists(\"$dir/b_started\")){
+        clicon_err(OE_PLUGIN, 0, \"b not started\");
+        return -1;
+    }
+    unlink(\"$dir/b_started\");"
+
+plugin b "if (file_touch(\"$dir/b_started\") < 0)
+        return -1;"
+
+plugin c "sleep(10);"
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+for i in 1 2; do
+    new "get state in parallel without c $i"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/p:s\" xmlns:p=\"urn:example:parallel\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><s xmlns=\"urn:example:parallel\"><a>ok</a><b>ok</b></s></data></rpc-reply>"
+done
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,237 @@
+#!/usr/bin/env bash
+# Subtree state providers, see clixon_statedata_subtree_register
+# Compile a backend plugin registering state providers on two subtrees: /s:a and /s:b/s:e
+# Each provider logs its calls to a file, the list provider logs the requested key.
+# Check that only providers whose subtree intersects the request are called, and
+# that the list key of the request is given to the provider
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/subtree.yang
+pdir=$dir/plugin
+cfile=$dir/psubtree.c
+flog=$dir/calls
+
+if [ ! -d $pdir ]; then
+    mkdir $pdir
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>$pdir</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module subtree{
+  yang-version 1.1;
+  namespace "urn:example:subtree";
+  prefix s;
+  container a{
+    config false;
+    leaf x{
+      type int32;
+    }
+  }
+  container b{
+    config false;
+    list e{
+      key n;
+      leaf n{
+        type int32;
+      }
+      leaf v{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfile
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/syslog.h>
+
+/* clicon */
+#include <cligen/cligen.h>
+
+/* Clicon library functions. */
+#include <clixon/clixon.h>
+
+/* These include signatures for plugin and transaction callbacks. */
+#include <clixon/clixon_backend.h>
+
+static int
+log_call(char *str)
+{
+    FILE *f;
+
+    if ((f = fopen("$flog", "a")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen");
+        return -1;
+    }
+    fprintf(f, "%s\n", str);
+    fclose(f);
+    return 0;
+}
+
+static int
+a_state(void *h,
+        char *path,
+        void *sf,
+        void *arg)
+{
+    cxobj *xstate = statedata_filter_xstate(sf);
+
+    if (log_call("a") < 0)
+        return -1;
+    return clixon_xml_parse_string("<a xmlns=\"urn:example:subtree\"><x>42</x></a>",
+                                   YB_NONE, NULL, &xstate, NULL);
+}
+
+static int
+e_state(void *h,
+        char *path,
+        void *sf,
+        void *arg)
+{
+    cxobj       *xstate = statedata_filter_xstate(sf);
+    clixon_path *cplist = statedata_filter_path(sf);
+    clixon_path *cp;
+    char        *key = NULL;
+    char         str[64];
+    cbuf        *cb;
+    int          i;
+    int          ret;
+
+    /* Key of list e in request, if any */
+    if ((cp = cplist) != NULL){
+        do {
+            if (cp->cp_yang && strcmp(cp->cp_id, "e") == 0)
+                key = statedata_filter_key(sf, cp->cp_yang, "n");
+            cp = NEXTQ(clixon_path *, cp);
+        } while (cp && cp != cplist);
+    }
+    snprintf(str, sizeof(str), "e=%s", key?key:"all");
+    if (log_call(str) < 0)
+        return -1;
+    if ((cb = cbuf_new()) == NULL)
+        return -1;
+    cprintf(cb, "<b xmlns=\"urn:example:subtree\">");
+    for (i=1; i<=3; i++)
+        if (key == NULL || atoi(key) == i)
+            cprintf(cb, "<e><n>%d</n><v>v%d</v></e>", i, i);
+    cprintf(cb, "</b>");
+    ret = clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xstate, NULL);
+    cbuf_free(cb);
+    return ret;
+}
+
+clixon_plugin_api *clixon_plugin_init(clicon_handle h);
+
+static clixon_plugin_api api = {
+    "psubtree",
+    clixon_plugin_init,
+};
+
+clixon_plugin_api *
+clixon_plugin_init(clicon_handle h)
+{
+    if (clixon_statedata_subtree_register(h, a_state, "/s:a", NULL) < 0)
+        return NULL;
+    if (clixon_statedata_subtree_register(h, e_state, "/s:b/s:e", NULL) < 0)
+        return NULL;
+    return &api;
+}
+EOF
+
+new "compile $cfile"
+expectpart "$($CC -g -Wall -rdynamic -fPIC -shared -I/usr/local/include $cfile -o $pdir/psubtree.so)" 0 ""
+
+# Get state with filter and check which providers are called
+# 1: xpath
+# 2: expected calls
+# 3: expected reply
+state_get(){
+    xpath=$1
+    calls=$2
+    reply=$3
+    rm -f $flog
+    new "get $xpath"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"$xpath\" xmlns:s=\"urn:example:subtree\"/></get></rpc>" "" "$reply"
+    new "providers called: $calls"
+    ret=$(cat $flog 2> /dev/null | tr '\n' ' ')
+    if [ "$ret" != "$calls " ]; then
+        err "$calls " "$ret"
+    fi
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+state_get "/s:a" "a" "<rpc-reply $DEFAULTNS><data><a xmlns=\"urn:example:subtree\"><x>42</x></a></data></rpc-reply>"
+
+state_get "/s:a/s:x" "a" "<rpc-reply $DEFAULTNS><data><a xmlns=\"urn:example:subtree\"><x>42</x></a></data></rpc-reply>"
+
+state_get "/s:b" "e=all" "<rpc-reply $DEFAULTNS><data><b xmlns=\"urn:example:subtree\"><e><n>1</n><v>v1</v></e><e><n>2</n><v>v2</v></e><e><n>3</n><v>v3</v></e></b></data></rpc-reply>"
+
+state_get "/s:b/s:e[s:n='2']" "e=2" "<rpc-reply $DEFAULTNS><data><b xmlns=\"urn:example:subtree\"><e><n>2</n><v>v2</v></e></b></data></rpc-reply>"
+
+state_get "/s:b/s:e[s:n='2']/s:v" "e=2" "<rpc-reply $DEFAULTNS><data><b xmlns=\"urn:example:subtree\"><e><n>2</n><v>v2</v></e></b></data></rpc-reply>"
+
+# Predicate that is not a key predicate: all entries, filtered by backend
+state_get "/s:b/s:e[s:v='v3']" "e=all" "<rpc-reply $DEFAULTNS><data><b xmlns=\"urn:example:subtree\"><e><n>3</n><v>v3</v></e></b></data></rpc-reply>"
+
+# Not a plain path: all providers
+state_get "//s:x" "a e=all" "<rpc-reply $DEFAULTNS><data><a xmlns=\"urn:example:subtree\"><x>42</x></a></data></rpc-reply>"
+
+rm -f $flog
+new "get all state"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get/></rpc>" "" "<a xmlns=\"urn:example:subtree\"><x>42</x></a><b xmlns=\"urn:example:subtree\"><e><n>1</n><v>v1</v></e><e><n>2</n><v>v2</v></e><e><n>3</n><v>v3</v></e></b>"
+
+new "all providers called"
+ret=$(cat $flog 2> /dev/null | tr '\n' ' ')
+if [ "$ret" != "a e=all " ]; then
+    err "a e=all " "$ret"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,140 @@
+#!/usr/bin/env bash
+# Trusted state data of backend plugins, see ca_statedata_trusted
+# Compile a backend plugin whose state callback returns a value that is invalid in yang.
+# With CLICON_VALIDATE_STATE_XML set, state of a trusted plugin is not validated, while state
+# of an untrusted plugin gives an internal error
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/trusted.yang
+pdir=$dir/plugin
+cfile=$dir/ptrusted.c
+
+if [ ! -d $pdir ]; then
+    mkdir $pdir
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>$pdir</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_VALIDATE_STATE_XML>true</CLICON_VALIDATE_STATE_XML>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module trusted{
+  yang-version 1.1;
+  namespace "urn:example:trusted";
+  prefix t;
+  container s{
+    config false;
+    list l{
+      key k;
+      leaf k{
+        type uint32;
+      }
+      leaf v{
+        type uint8;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfile
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <sys/syslog.h>
+
+/* clicon */
+#include <cligen/cligen.h>
+
+/* Clicon library functions. */
+#include <clixon/clixon.h>
+
+/* These include signatures for plugin and transaction callbacks. */
+#include <clixon/clixon_backend.h>
+
+static int
+ptrusted_statedata(clicon_handle h,
+                   cvec         *nsc,
+                   char         *xpath,
+                   cxobj        *xstate)
+{
+    return clixon_xml_parse_string("<s xmlns=\"urn:example:trusted\"><l><k>1</k><v>1</v></l><l><k>2</k><v>300</v></l></s>", YB_NONE, NULL, &xstate, NULL);
+}
+
+clixon_plugin_api *clixon_plugin_init(clicon_handle h);
+
+static clixon_plugin_api api = {
+    "ptrusted",
+    clixon_plugin_init,
+    .ca_statedata=ptrusted_statedata,
+    .ca_statedata_trusted=TRUSTED,
+};
+
+clixon_plugin_api *
+clixon_plugin_init(clicon_handle h)
+{
+    return &api;
+}
+EOF
+
+# Compile plugin, start backend and get state
+# 1: trusted 0 or 1
+# 2: expected reply
+function trusted_run()
+{
+    new "compile $cfile trusted=$1"
+    expectpart "$($CC -g -Wall -rdynamic -fPIC -shared -DTRUSTED=$1 -I/usr/local/include $cfile -o $pdir/ptrusted.so)" 0 ""
+
+    new "test params: -f $cfg"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "get state trusted=$1"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/t:s\" xmlns:t=\"urn:example:trusted\"/></get></rpc>" "" "$2"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+trusted_run 1 "<rpc-reply $DEFAULTNS><data><s xmlns=\"urn:example:trusted\"><l><k>1</k><v>1</v></l><l><k>2</k><v>300</v></l></s></data></rpc-reply>"
+
+trusted_run 0 "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag>"
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+# Private candidate of each session, see CLICON_XMLDB_PRIVATE_CANDIDATE
+# Two netconf sessions edit their candidates in parallel and commit. Check that edits are
+# not seen by the other session, that non-conflicting edits are rebased on the latest
+# running, and that conflicting edits fail the commit
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/private.yang
+fa=$dir/a.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRIVATE_CANDIDATE>true</CLICON_XMLDB_PRIVATE_CANDIDATE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module private{
+  yang-version 1.1;
+  namespace "urn:example:private";
+  prefix p;
+  container table{
+    leaf x{
+      type uint32;
+    }
+    leaf y{
+      type uint32;
+    }
+    leaf z{
+      type uint32;
+    }
+  }
+}
+EOF
+
+# Edit-config rpc of candidate
+# 1: leaf
+# 2: value
+edit(){
+    echo "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:private\"><$1>$2</$1></table></config></edit-config></rpc>]]>]]>"
+}
+COMMIT="<rpc $DEFAULTNS><commit/></rpc>]]>]]>"
+GETCAND="<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>]]>]]>"
+
+# Session A edits and commits after a delay in background, session B edits and commits meanwhile
+# 1: leaf of A
+# 2: leaf of B
+session_ab(){
+    rm -f $fa
+    (echo "$HELLONO11$(edit $1 1)"; sleep 3; echo "$COMMIT"; sleep 1) | $clixon_netconf -qf $cfg > $fa &
+    sleep 1
+    new "session B edit $2 and commit"
+    expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11$(edit $2 2)$COMMIT" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>]]>]]><rpc-reply $DEFAULTNS><ok/></rpc-reply>]]>]]>$"
+    wait
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit is seen in own candidate"
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11$(edit x 7)$GETCAND" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:private\"><x>7</x></table></data></rpc-reply>"
+
+new "edit is not seen by other session"
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11$GETCAND" "^<rpc-reply $DEFAULTNS><data/></rpc-reply>]]>]]>$"
+
+new "uncommitted edit is not in running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "parallel edits of x and y"
+session_ab x y
+
+new "session A commit is rebased"
+expectpart "$(cat $fa)" 0 "<rpc-reply $DEFAULTNS><ok/></rpc-reply>]]>]]><rpc-reply $DEFAULTNS><ok/></rpc-reply>]]>]]>" --not-- "rpc-error"
+
+new "running has both edits"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:private\"><x>1</x><y>2</y></table></data></rpc-reply>"
+
+new "parallel edits of z"
+session_ab z z
+
+new "session A commit conflicts"
+expectpart "$(cat $fa)" 0 "<rpc-reply $DEFAULTNS><ok/></rpc-reply>]]>]]><rpc-reply $DEFAULTNS><rpc-error>" "Private candidate conflicts with changes of running"
+
+new "running has edit of session B"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:private\"><x>1</x><y>2</y><z>2</z></table></data></rpc-reply>"
+
+new "discard-changes resets to running"
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11$(edit x 9)<rpc $DEFAULTNS><discard-changes/></rpc>]]>]]>$GETCAND" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:private\"><x>1</x><y>2</y><z>2</z></table></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
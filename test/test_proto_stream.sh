@@ -0,0 +1,112 @@
+#!/usr/bin/env bash
+# Streamed get replies on the internal backend socket, see CLICON_PROTO_STREAM_CHUNK
+# Use a small chunk size so that replies are sent in several fragments, and check that
+# get-config and get replies, with and without filter, are received as one reply
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+clidir=$dir/cli
+fyang=$dir/stream.yang
+
+test -d ${clidir} || rm -rf ${clidir}
+mkdir $clidir
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_CLISPEC_DIR>$clidir</CLICON_CLISPEC_DIR>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_PROTO_STREAM_CHUNK>64</CLICON_PROTO_STREAM_CHUNK>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module stream{
+  yang-version 1.1;
+  namespace "urn:example:stream";
+  prefix s;
+  container c{
+    list l{
+      key k;
+      leaf k{
+        type string;
+      }
+      leaf v{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $clidir/ex.cli
+CLICON_MODE="example";
+CLICON_PROMPT="%U@%H %W> ";
+
+show("Show a particular state of the system"){
+   configuration("Show configuration"), cli_show_auto_mode("running", "xml", false, false);
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:stream\"><l><k>a</k><v>x&amp;y</v></l><l><k>b</k><v></v></l><l><k>c</k><v>0123456789012345678901234567890123456789</v></l><l><k>d</k><v>z</v></l></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config streamed reply"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:stream\"><l><k>a</k><v>x&amp;y</v></l><l><k>b</k><v/></l><l><k>c</k><v>0123456789012345678901234567890123456789</v></l><l><k>d</k><v>z</v></l></c></data></rpc-reply>"
+
+new "get-config filter streamed reply"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/s:c/s:l[s:k='b']\" xmlns:s=\"urn:example:stream\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:stream\"><l><k>b</k><v/></l></c></data></rpc-reply>"
+
+new "get streamed reply"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/s:c\" xmlns:s=\"urn:example:stream\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:stream\"><l><k>a</k><v>x&amp;y</v></l><l><k>b</k><v/></l><l><k>c</k><v>0123456789012345678901234567890123456789</v></l><l><k>d</k><v>z</v></l></c></data></rpc-reply>"
+
+new "cli show configuration streamed reply"
+expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "^<c xmlns=\"urn:example:stream\"><l><k>a</k><v>x&amp;y</v></l><l><k>b</k><v/></l><l><k>c</k><v>0123456789012345678901234567890123456789</v></l><l><k>d</k><v>z</v></l></c>$"
+
+new "get-config empty streamed reply"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/s:c/s:l[s:k='z']\" xmlns:s=\"urn:example:stream\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "get-config error"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><notexist/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
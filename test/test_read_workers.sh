@@ -0,0 +1,160 @@
+#!/usr/bin/env bash
+# Read-only RPCs in backend worker processes, see CLICON_BACKEND_READ_WORKERS
+# Compile a backend plugin whose state callback sleeps 3s. Start a get in the background
+# and check that a get-config and an edit-config of another client are handled while
+# the get is in progress, and that the get returns state and config as before the edit.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/workers.yang
+pdir=$dir/plugin
+
+if [ ! -d $pdir ]; then
+    mkdir $pdir
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>$pdir</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_BACKEND_READ_WORKERS>2</CLICON_BACKEND_READ_WORKERS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module workers{
+  yang-version 1.1;
+  namespace "urn:example:workers";
+  prefix w;
+  container c{
+    leaf a{
+      type string;
+    }
+  }
+  container s{
+    config false;
+    leaf b{
+      type string;
+    }
+  }
+}
+EOF
+
+cat <<EOF > $dir/pw.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syslog.h>
+
+/* clicon */
+#include <cligen/cligen.h>
+
+/* Clicon library functions. */
+#include <clixon/clixon.h>
+
+/* These include signatures for plugin and transaction callbacks. */
+#include <clixon/clixon_backend.h>
+
+static int
+pw_statedata(clicon_handle h,
+             cvec         *nsc,
+             char         *xpath,
+             cxobj        *xstate)
+{
+    sleep(3);
+    return clixon_xml_parse_string("<s xmlns=\"urn:example:workers\"><b>slow</b></s>", YB_NONE, NULL, &xstate, NULL);
+}
+
+clixon_plugin_api *clixon_plugin_init(clicon_handle h);
+
+static clixon_plugin_api api = {
+    "pw",
+    clixon_plugin_init,
+    .ca_statedata=pw_statedata,
+};
+
+clixon_plugin_api *
+clixon_plugin_init(clicon_handle h)
+{
+    return &api;
+}
+EOF
+
+new "compile pw"
+expectpart "$($CC -g -Wall -rdynamic -fPIC -shared -I/usr/local/include $dir/pw.c -o $pdir/pw.so)" 0 ""
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit x"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:workers\"><a>x</a></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit x"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "start slow get in background"
+rpc=$(chunked_framing "<rpc $DEFAULTNS><get/></rpc>")
+echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg > $dir/get.xml &
+sleep 1
+
+new "get-config while get is in progress"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:workers\"><a>x</a></c></data></rpc-reply>"
+
+new "edit y while get is in progress"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:workers\"><a>y</a></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit y while get is in progress"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get not done"
+if [ -s $dir/get.xml ]; then
+    err "get in progress" "$(cat $dir/get.xml)"
+fi
+
+new "wait for get"
+wait
+
+new "get returns snapshot and state"
+match=$(cat $dir/get.xml | grep --null -o "<data><c xmlns=\"urn:example:workers\"><a>x</a></c><s xmlns=\"urn:example:workers\"><b>slow</b></s></data>")
+if [ -z "$match" ]; then
+    err "<data><c xmlns=\"urn:example:workers\"><a>x</a></c><s xmlns=\"urn:example:workers\"><b>slow</b></s></data>" "$(cat $dir/get.xml)"
+fi
+
+new "get-config after commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:workers\"><a>y</a></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
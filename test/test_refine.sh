@@ -4,6 +4,7 @@
 # 1. dual refine
 # 2. refine argument is non-trivial descendant-schema-nodeid stretching over a choice/case
 # 3. refine "str1" + "str2" i.e. split refine-arg-str
+# 4. refine does not change other uses of the same grouping, which share arguments and types
 #
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -72,6 +73,9 @@ module clixon-example {
            }
         }
     }
+  container other {
+     uses ex:mygrouping;
+  }
 }
 
 EOF
@@ -110,6 +114,12 @@ expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>
 new "Get config expected bar2 refined default value"
 expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><certificate xmlns=\"urn:example:clixon\"><keystore-reference/></certificate></data></rpc-reply>"
 
+new "Set other local-definition"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><other xmlns=\"urn:example:clixon\"><local-definition/></other></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Get other expected foo1 default value, not refined (report-all)"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:other\" xmlns:ex=\"urn:example:clixon\"/><with-defaults xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-with-defaults\">report-all</with-defaults></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><other xmlns=\"urn:example:clixon\"><local-definition><dummy1>foo1</dummy1></local-definition></other></data></rpc-reply>"
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
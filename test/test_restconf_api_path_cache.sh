@@ -0,0 +1,147 @@
+#!/usr/bin/env bash
+# Restconf api-path cache, see API_PATH_CACHE
+# GET the same api-path templates with different keys and check that each key is substituted,
+# for single and multiple keys, percent-encoded keys and leaf-lists
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/restconf.yang
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>/usr/local/share/clixon</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container table{
+      list parameter{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+      list pair{
+         key "a b";
+         leaf a{
+            type string;
+         }
+         leaf b{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+      leaf-list ll{
+         type string;
+      }
+   }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "restconf POST entries"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d '{"example:table":{"parameter":[{"name":"A0","value":"0"},{"name":"A1","value":"1"},{"name":"x,y","value":"comma"}],"pair":[{"a":"1","b":"2","value":"12"},{"a":"1","b":"3","value":"13"}],"ll":["foo","bar"]}}' $RCPROTO://localhost/restconf/data)" 0 "HTTP/$HVER 201"
+
+for i in 0 1 0 1; do
+    new "restconf GET parameter=A$i"
+    expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A$i)" 0 "HTTP/$HVER 200" "{\"example:parameter\":\[{\"name\":\"A$i\",\"value\":\"$i\"}\]}"
+done
+
+new "restconf GET parameter leaf"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A1/value)" 0 "HTTP/$HVER 200" '{"example:value":"1"}'
+
+new "restconf GET same template other key"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A0/value)" 0 "HTTP/$HVER 200" '{"example:value":"0"}'
+
+new "restconf GET percent-encoded key"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=x%2Cy)" 0 "HTTP/$HVER 200" '{"example:parameter":\[{"name":"x,y","value":"comma"}\]}'
+
+new "restconf GET non-existing key"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A2)" 0 "HTTP/$HVER 404"
+
+for b in 2 3 2; do
+    new "restconf GET pair=1,$b"
+    expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/pair=1,$b)" 0 "HTTP/$HVER 200" "{\"example:pair\":\[{\"a\":\"1\",\"b\":\"$b\",\"value\":\"1$b\"}\]}"
+done
+
+for v in foo bar; do
+    new "restconf GET ll=$v"
+    expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/ll=$v)" 0 "HTTP/$HVER 200" "{\"example:ll\":\[\"$v\"\]}"
+done
+
+new "restconf GET unknown element of cached template"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A0/xxx)" 0 "HTTP/$HVER 400" "unknown-element"
+
+new "restconf GET unknown module"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/xxx:table/parameter=A0)" 0 "HTTP/$HVER 400" "No such yang module"
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
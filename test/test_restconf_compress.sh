@@ -0,0 +1,158 @@
+#!/usr/bin/env bash
+# Native restconf compression of reply bodies, see compression-level
+# Content-Encoding negotiated with Accept-Encoding, gzip and deflate with zlib
+# Check that small replies are not compressed, and with CLICON_RESTCONF_STREAM_CHUNK that
+# HTTP/2 replies produced in parts are compressed
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+if [ "${WITH_RESTCONF}" != "native" ]; then
+    echo "...skipped: Must run with native restconf"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+if [ "${WITH_ZLIB}" != "yes" ]; then
+    echo "Skipping test, zlib support not enabled."
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/restconf.yang
+
+# Number of list entries
+: ${nr:=200}
+
+# Define default restconfig config: RESTCONFIG with compression
+RESTCONFIG=$(restconf_config none false)
+RESTCONFIG=${RESTCONFIG/<\/ssl>/</ssl><compression-level>6</compression-level>}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>/usr/local/share/clixon</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_RESTCONF_STREAM_CHUNK>4096</CLICON_RESTCONF_STREAM_CHUNK>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container table{
+      list parameter{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "restconf POST $nr entries"
+data="{\"example:table\":{\"parameter\":["
+for (( i=0; i<$nr; i++ )); do
+    if [ $i -ne 0 ]; then
+        data="$data,"
+    fi
+    data="$data{\"name\":\"A$i\",\"value\":\"value of entry $i\"}"
+done
+data="$data]}}"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d "$data" $RCPROTO://localhost/restconf/data)" 0 "HTTP/$HVER 201"
+
+url=$RCPROTO://localhost/restconf/data/example:table
+
+new "restconf GET not compressed without Accept-Encoding"
+expectpart "$(curl $CURLOPTS -X GET $url)" 0 "HTTP/$HVER 200" "Vary: Accept-Encoding" "\"name\":\"A$((nr-1))\"" --not-- "Content-Encoding:"
+
+new "restconf GET gzip"
+expectpart "$(curl $CURLOPTS --compressed -X GET -H "Accept-Encoding: gzip" $url)" 0 "HTTP/$HVER 200" "Content-Encoding: gzip" "\"name\":\"A$((nr-1))\""
+
+new "restconf GET deflate"
+expectpart "$(curl $CURLOPTS --compressed -X GET -H "Accept-Encoding: deflate" $url)" 0 "HTTP/$HVER 200" "Content-Encoding: deflate" "\"name\":\"A$((nr-1))\""
+
+new "restconf GET preferred by weight"
+expectpart "$(curl $CURLOPTS --compressed -X GET -H "Accept-Encoding: gzip;q=0.5, deflate;q=0.8" $url)" 0 "HTTP/$HVER 200" "Content-Encoding: deflate"
+
+new "restconf GET not acceptable coding"
+expectpart "$(curl $CURLOPTS -X GET -H "Accept-Encoding: gzip;q=0, br" $url)" 0 "HTTP/$HVER 200" "\"name\":\"A$((nr-1))\"" --not-- "Content-Encoding:"
+
+new "restconf GET xml gzip"
+expectpart "$(curl $CURLOPTS --compressed -X GET -H "Accept: application/yang-data+xml" -H "Accept-Encoding: gzip" $url)" 0 "HTTP/$HVER 200" "Content-Encoding: gzip" "<name>A$((nr-1))</name>"
+
+new "restconf GET small reply not compressed"
+expectpart "$(curl $CURLOPTS -X GET -H "Accept-Encoding: gzip" $url/parameter=A1)" 0 "HTTP/$HVER 200" '{"example:parameter":\[{"name":"A1","value":"value of entry 1"}\]}' --not-- "Content-Encoding:"
+
+new "restconf GET compressed is smaller"
+size0=$(curl $CURLOPTS -s -o /dev/null -w "%{size_download}" -X GET $url)
+size1=$(curl $CURLOPTS -s -o /dev/null -w "%{size_download}" -X GET -H "Accept-Encoding: gzip" $url)
+if [ $size1 -ge $size0 ]; then
+    err "< $size0" "$size1"
+fi
+
+new "restconf HEAD gzip not compressed"
+expectpart "$(curl $CURLOPTS --head -H "Accept-Encoding: gzip" $url)" 0 "HTTP/$HVER 200" --not-- "Content-Encoding:"
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
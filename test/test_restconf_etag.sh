@@ -0,0 +1,161 @@
+#!/usr/bin/env bash
+# Restconf conditional GET of configuration data, see api_data_get_conditional
+# GET with content=config returns ETag and Last-Modified from the running datastore version
+# Check If-None-Match and If-Modified-Since, and that the entity-tag changes on edit
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/restconf.yang
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>/usr/local/share/clixon</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container table{
+      list parameter{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+# Get entity-tag header of a GET reply
+# 1: URL
+getetag(){
+    curl $CURLOPTS -X GET $1 | grep -i "^etag:" | awk '{print $2}' | tr -d '\r'
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+url="$RCPROTO://localhost/restconf/data/example:table?content=config"
+
+new "netconf datastore-version"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-version xmlns=\"http://clicon.org/lib\"/></rpc>" "<rpc-reply $DEFAULTNS><version xmlns=\"http://clicon.org/lib\">" "<last-modified xmlns=\"http://clicon.org/lib\">"
+
+new "netconf datastore-version no such datastore"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-version xmlns=\"http://clicon.org/lib\"><datastore>xxx</datastore></datastore-version></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>protocol</error-type><error-tag>invalid-value</error-tag>" ""
+
+new "restconf POST initial"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d '{"example:parameter":[{"name":"a","value":"1"}]}' $RCPROTO://localhost/restconf/data/example:table)" 0 "HTTP/$HVER 201"
+
+new "restconf GET config has ETag and Last-Modified"
+expectpart "$(curl $CURLOPTS -X GET $url)" 0 "HTTP/$HVER 200" "ETag: \"" "Last-Modified: " '{"example:table":{"parameter":\[{"name":"a","value":"1"}\]}}'
+
+new "restconf GET all has no ETag"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table)" 0 "HTTP/$HVER 200" --not-- "ETag:"
+
+etag=$(getetag $url)
+new "restconf ETag is set: $etag"
+if [ -z "$etag" ]; then
+    err "etag" ""
+fi
+
+new "restconf GET If-None-Match not modified"
+expectpart "$(curl $CURLOPTS -X GET -H "If-None-Match: $etag" $url)" 0 "HTTP/$HVER 304" "ETag: $etag" --not-- '{"example:table"'
+
+new "restconf GET If-None-Match * not modified"
+expectpart "$(curl $CURLOPTS -X GET -H "If-None-Match: *" $url)" 0 "HTTP/$HVER 304"
+
+new "restconf GET If-None-Match other etag"
+expectpart "$(curl $CURLOPTS -X GET -H "If-None-Match: \"0-xml\"" $url)" 0 "HTTP/$HVER 200" '{"example:table":{"parameter":\[{"name":"a","value":"1"}\]}}'
+
+new "restconf GET If-None-Match other media"
+expectpart "$(curl $CURLOPTS -X GET -H "Accept: application/yang-data+xml" -H "If-None-Match: $etag" $url)" 0 "HTTP/$HVER 200" "<table xmlns=\"urn:example:clixon\">"
+
+new "restconf GET If-Modified-Since in future not modified"
+expectpart "$(curl $CURLOPTS -X GET -H "If-Modified-Since: Fri, 01 Jan 2100 00:00:00 GMT" $url)" 0 "HTTP/$HVER 304"
+
+new "restconf GET If-Modified-Since in past"
+expectpart "$(curl $CURLOPTS -X GET -H "If-Modified-Since: Thu, 01 Jan 1970 00:00:00 GMT" $url)" 0 "HTTP/$HVER 200"
+
+new "restconf GET invalid If-Modified-Since is ignored"
+expectpart "$(curl $CURLOPTS -X GET -H "If-Modified-Since: yesterday" $url)" 0 "HTTP/$HVER 200"
+
+new "restconf POST change"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d '{"example:parameter":[{"name":"b","value":"2"}]}' $RCPROTO://localhost/restconf/data/example:table)" 0 "HTTP/$HVER 201"
+
+new "restconf GET If-None-Match modified"
+expectpart "$(curl $CURLOPTS -X GET -H "If-None-Match: $etag" $url)" 0 "HTTP/$HVER 200" '{"name":"b","value":"2"}'
+
+new "restconf ETag changed"
+etag2=$(getetag $url)
+if [ "$etag" = "$etag2" ]; then
+    err "not $etag" "$etag2"
+fi
+
+new "restconf HEAD If-None-Match not modified"
+expectpart "$(curl $CURLOPTS --head -H "If-None-Match: $etag2" $url)" 0 "HTTP/$HVER 304"
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,140 @@
+#!/usr/bin/env bash
+# Restconf fields query parameter (RFC 8040 4.8.3) and get with depth
+# Only the selected nodes are copied from the datastore, see xmldb_get_depth
+# Check the fields, invalid fields, and that xpath predicates below depth still match
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/fields.yang
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>/usr/local/share/clixon</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module fields{
+   yang-version 1.1;
+   namespace "urn:example:fields";
+   prefix f;
+   container c{
+      list entry{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf a{
+            type uint32;
+         }
+         leaf b{
+            type string;
+         }
+         container d{
+            leaf e{
+               type uint32;
+            }
+         }
+      }
+   }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "restconf POST entries"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d '{"fields:c":{"entry":[{"name":"x","a":1,"b":"bx","d":{"e":42}},{"name":"y","a":2,"b":"by","d":{"e":43}}]}}' $RCPROTO://localhost/restconf/data)" 0 "HTTP/$HVER 201"
+
+new "restconf GET fields of list"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/fields:c?fields=entry\(name\;a\))" 0 "HTTP/$HVER 200" '{"fields:c":{"entry":\[{"name":"x","a":1},{"name":"y","a":2}\]}}'
+
+new "restconf GET fields of list entry"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/fields:c/entry=x?fields=d/e)" 0 "HTTP/$HVER 200" '{"fields:entry":\[{"name":"x","d":{"e":42}}\]}'
+
+new "restconf GET fields of data root"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data?fields=fields:c/entry/b)" 0 "HTTP/$HVER 200" '{"fields:c":{"entry":\[{"name":"x","b":"bx"},{"name":"y","b":"by"}\]}}'
+
+new "restconf GET fields xml"
+expectpart "$(curl $CURLOPTS -X GET -H 'Accept: application/yang-data+xml' $RCPROTO://localhost/restconf/data/fields:c/entry=y?fields=b\;d)" 0 "HTTP/$HVER 200" '<entry xmlns="urn:example:fields"><name>y</name><b>by</b><d><e>43</e></d></entry>'
+
+new "restconf GET invalid fields"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/fields:c?fields=entry\(a)" 0 "HTTP/$HVER 400" "Invalid fields parameter"
+
+new "restconf GET fields unknown node"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/fields:c?fields=entry/xxx)" 0 "HTTP/$HVER 400" "unknown-element"
+
+new "restconf GET depth=2"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/fields:c?depth=2)" 0 "HTTP/$HVER 200" '{"fields:c":{"entry":\[{},{}\]}}'
+
+new "restconf GET fields and depth"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/fields:c/entry=x?fields=d\;a\&depth=3)" 0 "HTTP/$HVER 200" '{"fields:entry":\[{"name":"x","a":1,"d":{}}\]}'
+
+new "netconf get-config depth=1 with predicate below depth"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config xmlns:cl=\"http://clicon.org/lib\" cl:depth=\"1\"><source><running/></source><filter type=\"xpath\" select=\"/f:c/f:entry[f:d/f:e=42]\" xmlns:f=\"urn:example:fields\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:fields\"></c></data></rpc-reply>"
+
+new "netconf get-config depth=1 with predicate below depth no match"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config xmlns:cl=\"http://clicon.org/lib\" cl:depth=\"1\"><source><running/></source><filter type=\"xpath\" select=\"/f:c/f:entry[f:d/f:e=44]\" xmlns:f=\"urn:example:fields\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "netconf get depth=3"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get xmlns:cl=\"http://clicon.org/lib\" cl:depth=\"3\"><filter type=\"xpath\" select=\"/f:c/f:entry[f:name='x']\" xmlns:f=\"urn:example:fields\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:fields\"><entry><name>x</name><a>1</a><b>bx</b><d></d></entry></c></data></rpc-reply>"
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
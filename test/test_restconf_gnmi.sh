@@ -0,0 +1,133 @@
+#!/usr/bin/env bash
+# gNMI over native HTTP/2 restconf, see CLICON_RESTCONF_GNMI
+# gRPC requests are made with curl from hand-encoded protobuf messages:
+# Capabilities, Get with JSON_IETF encoding, and errors of gRPC and HTTP
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Skip it other than native and HTTP/2
+if [ "${WITH_RESTCONF}" != "native" -o ${HVER} != 2 ]; then
+    echo "...skipped: native restconf and HTTP/2 only"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi # skip
+fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/gnmi.yang
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_RESTCONF_GNMI>true</CLICON_RESTCONF_GNMI>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container table{
+      list parameter{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+# gRPC messages: 5 bytes frame header followed by protobuf message
+# Capabilities: empty CapabilityRequest
+printf '\x00\x00\x00\x00\x00' > $dir/capreq.bin
+# Get: GetRequest path=<elem name="example:table"> encoding=JSON_IETF
+printf '\x00\x00\x00\x00\x15\x12\x11\x1a\x0f\x0a\x0dexample:table\x28\x04' > $dir/getreq.bin
+# Get: GetRequest path=<elem name="example:xxxxx">
+printf '\x00\x00\x00\x00\x13\x12\x11\x1a\x0f\x0a\x0dexample:xxxxx' > $dir/geterr.bin
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "restconf POST"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d '{"example:table":{"parameter":[{"name":"a","value":"1"}]}}' $RCPROTO://localhost/restconf/data)" 0 "HTTP/$HVER 201"
+
+new "gnmi Capabilities"
+expectpart "$(curl $CURLOPTS -X POST -H "content-type: application/grpc" -H "te: trailers" --data-binary @$dir/capreq.bin $RCPROTO://localhost/gnmi.gNMI/Capabilities | tr -d '\000')" 0 "HTTP/$HVER 200" "content-type: application/grpc" "example" "0.7.0" "grpc-status: 0"
+
+new "gnmi Get"
+expectpart "$(curl $CURLOPTS -X POST -H "content-type: application/grpc" -H "te: trailers" --data-binary @$dir/getreq.bin $RCPROTO://localhost/gnmi.gNMI/Get | tr -d '\000')" 0 "HTTP/$HVER 200" "example:table" '{"parameter":\[{"name":"a","value":"1"}\]}' "grpc-status: 0"
+
+new "gnmi Get unknown path"
+expectpart "$(curl $CURLOPTS -X POST -H "content-type: application/grpc" -H "te: trailers" --data-binary @$dir/geterr.bin $RCPROTO://localhost/gnmi.gNMI/Get)" 0 "HTTP/$HVER 200" "grpc-status: 3" "grpc-message: Unknown%20path%20element%20xxxxx"
+
+new "gnmi unknown rpc"
+expectpart "$(curl $CURLOPTS -X POST -H "content-type: application/grpc" -H "te: trailers" --data-binary @$dir/capreq.bin $RCPROTO://localhost/gnmi.gNMI/Foo)" 0 "HTTP/$HVER 200" "grpc-status: 12"
+
+new "gnmi wrong content-type"
+expectpart "$(curl $CURLOPTS -X POST -H "content-type: application/json" --data-binary @$dir/capreq.bin $RCPROTO://localhost/gnmi.gNMI/Capabilities)" 0 "HTTP/$HVER 415"
+
+new "gnmi GET method not allowed"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/gnmi.gNMI/Capabilities)" 0 "HTTP/$HVER 405"
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,170 @@
+#!/usr/bin/env bash
+# Restconf HTTP/1 persistent connections, pipelining and idle timeout
+# Check Connection header handling of HTTP/1.1 and HTTP/1.0, several requests sent in one
+# write on the same connection, and that an idle connection is closed, see restconf idle-timeout
+# If both HTTP/1 and /2, force to /1 to test native http/1 implementation
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+if ! ${HAVE_HTTP1}; then
+    echo "...skipped: Must run with http/1"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+if [ "${WITH_RESTCONF}" != "native" ]; then
+    echo "...skipped: Must run with native restconf"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+APPNAME=example
+
+if [ ${HAVE_LIBNGHTTP2} = true ]; then
+    # Pin to http/1
+    HAVE_LIBNGHTTP2=false
+    CURLOPTS=${CURLOPTS/http2/http1.1}
+    HVER=1.1
+fi
+
+cfg=$dir/conf.xml
+fyang=$dir/restconf.yang
+
+# Idle timeout in seconds
+: ${idle:=2}
+
+# Define default restconfig config: RESTCONFIG with idle timeout
+RESTCONFIG=$(restconf_config none false)
+RESTCONFIG=${RESTCONFIG/<enable>true<\/enable>/<enable>true</enable><idle-timeout>$idle</idle-timeout>}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>/usr/local/share/clixon</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container table{
+      list parameter{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+# Send raw HTTP/1 requests in one write on a single connection and print the replies
+# Returns when the server closes the connection
+# 1: requests
+rawrequest(){
+    if [ $RCPROTO = https ]; then
+        printf "$1" | openssl s_client -connect localhost:443 -alpn http/1.1 -quiet -ign_eof 2>/dev/null
+    else
+        exec 3<>/dev/tcp/localhost/80
+        printf "$1" >&3
+        cat <&3
+        exec 3<&-
+    fi
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "restconf POST"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d '{"example:parameter":[{"name":"A","value":"42"}]}' $RCPROTO://localhost/restconf/data/example:table)" 0 "HTTP/$HVER 201"
+
+new "restconf two GETs reuse connection"
+expectpart "$(curl $CURLOPTS -v -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A $RCPROTO://localhost/restconf/data/example:table/parameter=A 2>&1)" 0 "HTTP/$HVER 200" "Re-using existing connection"
+
+new "restconf GET Connection: close"
+expectpart "$(curl $CURLOPTS -H "Connection: close" -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A)" 0 "HTTP/$HVER 200" "Connection: close" '{"example:parameter":\[{"name":"A","value":"42"}\]}'
+
+new "restconf GET HTTP/1.0 keep-alive"
+expectpart "$(curl ${CURLOPTS/http1.1/http1.0} --http1.0 -H "Connection: keep-alive" -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A)" 0 "HTTP/1.0 200" "Connection: keep-alive"
+
+new "restconf GET HTTP/1.0 close"
+expectpart "$(curl ${CURLOPTS/http1.1/http1.0} --http1.0 -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A)" 0 "HTTP/1.0 200" "Connection: close"
+
+body='{"example:parameter":[{"name":"B","value":"43"}]}'
+new "restconf pipelined POST and GETs"
+ret=$(rawrequest "POST /restconf/data/example:table HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/yang-data+json\r\nContent-Length: ${#body}\r\n\r\n${body}GET /restconf/data/example:table/parameter=A HTTP/1.1\r\nHost: localhost\r\nAccept: application/yang-data+json\r\n\r\nGET /restconf/data/example:table/parameter=B HTTP/1.1\r\nHost: localhost\r\nAccept: application/yang-data+json\r\nConnection: close\r\n\r\n")
+expectpart "$ret" 0 "HTTP/1.1 201" '{"example:parameter":\[{"name":"A","value":"42"}\]}' '{"example:parameter":\[{"name":"B","value":"43"}\]}' "Connection: close"
+
+new "restconf pipelined replies in order"
+match=$(echo "$ret" | grep "^HTTP/1.1" | tr -d '\r' | tr '\n' ' ')
+if [ "$match" != "HTTP/1.1 201 Created HTTP/1.1 200 OK HTTP/1.1 200 OK " ]; then
+    err "HTTP/1.1 201 Created HTTP/1.1 200 OK HTTP/1.1 200 OK " "$match"
+fi
+
+new "restconf idle connection closed after $idle s"
+SECONDS=0
+if [ $RCPROTO = https ]; then
+    timeout 10 openssl s_client -connect localhost:443 -alpn http/1.1 -quiet -ign_eof < /dev/null > /dev/null 2>&1
+else
+    timeout 10 bash -c "exec 3<>/dev/tcp/localhost/80; cat <&3" > /dev/null
+fi
+if [ $SECONDS -ge 10 ]; then
+    err "closed after $idle s" "not closed after $SECONDS s"
+fi
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf 
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+# Restconf latency histograms and counters, see RESTCONF_METRICS
+# Make some requests and check the metrics of GET /.well-known/clixon-metrics
+# Metrics are per worker, restconf runs with one worker
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Skip it other than native
+if [ "${WITH_RESTCONF}" != "native" ]; then
+    echo "...skipped: native restconf only"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi # skip
+fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/restconf.yang
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container table{
+      list parameter{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "restconf POST"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d '{"example:table":{"parameter":[{"name":"a","value":"1"}]}}' $RCPROTO://localhost/restconf/data)" 0 "HTTP/$HVER 201"
+
+for i in 1 2 3; do
+    new "restconf GET $i"
+    expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table)" 0 "HTTP/$HVER 200"
+done
+
+new "restconf GET not found"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=b)" 0 "HTTP/$HVER 404"
+
+new "restconf metrics"
+ret=$(curl $CURLOPTS -X GET $RCPROTO://localhost/.well-known/clixon-metrics)
+expectpart "$ret" 0 "HTTP/$HVER 200" "Content-Type: text/plain" "# TYPE clixon_restconf_request_seconds histogram" 'clixon_restconf_request_seconds_bucket{worker="0",method="GET",code="200",le="+Inf"}' 'clixon_restconf_request_seconds_count{worker="0",method="GET",code="404"} 1' 'clixon_restconf_request_seconds_count{worker="0",method="POST",code="201"} 1' 'clixon_restconf_backend_seconds_total{worker="0",method="GET",code="200"}' 'clixon_restconf_request_bytes_total{worker="0",method="POST",code="201"} 58' 'clixon_restconf_http1_parse_seconds_count'
+
+if [ $RCPROTO = https ]; then
+    new "restconf metrics tls handshakes"
+    expectpart "$ret" 0 'clixon_restconf_tls_handshake_seconds_count{worker="0"}'
+fi
+
+new "restconf metrics method not allowed"
+expectpart "$(curl $CURLOPTS -X POST $RCPROTO://localhost/.well-known/clixon-metrics)" 0 "HTTP/$HVER 405"
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
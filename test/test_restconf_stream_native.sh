@@ -0,0 +1,145 @@
+#!/usr/bin/env bash
+# Restconf RFC8040 event streams of native restconf, see restconf_stream_native.c
+# Two subscribers of the same stream share one backend subscription and both get the
+# notifications of the example stream, which are generated every 5s by the example backend
+# Also check errors of stream requests
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Skip it other than native
+if [ "${WITH_RESTCONF}" != "native" ]; then
+    echo "...skipped: native restconf only"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi # skip
+fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/stream.yang
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_REGEXP>example_backend.so$</CLICON_BACKEND_REGEXP>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_STREAM_DISCOVERY_RFC8040>true</CLICON_STREAM_DISCOVERY_RFC8040>
+  <CLICON_STREAM_PATH>streams</CLICON_STREAM_PATH>
+  <CLICON_STREAM_RETENTION>60</CLICON_STREAM_RETENTION>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+   namespace "urn:example:clixon";
+   prefix ex;
+   notification event {
+      leaf event-class {
+         type string;
+      }
+      container reportingEntity {
+         leaf card {
+            type string;
+         }
+      }
+      leaf severity {
+         type string;
+      }
+   }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg -- -n"
+    start_backend -s init -f $cfg -- -n # create example notification stream
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "restconf stream not found"
+expectpart "$(curl $CURLOPTS -X GET -H "Accept: text/event-stream" $RCPROTO://localhost/streams/NOTEXIST)" 0 "HTTP/$HVER 400" "invalid-value" "No such stream"
+
+new "restconf stream invalid path"
+expectpart "$(curl $CURLOPTS -X GET -H "Accept: text/event-stream" $RCPROTO://localhost/streams/EXAMPLE/xxx)" 0 "HTTP/$HVER 400" "invalid-value"
+
+new "restconf stream invalid query parameter"
+expectpart "$(curl $CURLOPTS -X GET -H "Accept: text/event-stream" "$RCPROTO://localhost/streams/EXAMPLE?xxx=1")" 0 "HTTP/$HVER 400" "invalid-value"
+
+new "restconf stream method not allowed"
+expectpart "$(curl $CURLOPTS -X POST -H "Accept: text/event-stream" $RCPROTO://localhost/streams/EXAMPLE)" 0 "HTTP/$HVER 405"
+
+# Two subscribers during 12s, expect at least one notification each, see example_stream_timer
+expect="data: <notification xmlns=\"urn:ietf:params:xml:ns:netconf:notification:1.0\"><eventTime>[0-9TZ:.-]*</eventTime><event xmlns=\"urn:example:clixon\"><event-class>fault</event-class>"
+
+new "restconf two stream subscribers"
+curl $CURLOPTS -N --max-time 12 -X GET -H "Accept: text/event-stream" $RCPROTO://localhost/streams/EXAMPLE > $dir/sub1.txt 2>&1 &
+pid1=$!
+curl $CURLOPTS -N --max-time 12 -X GET -H "Accept: text/event-stream" $RCPROTO://localhost/streams/EXAMPLE > $dir/sub2.txt 2>&1 &
+pid2=$!
+wait $pid1 $pid2
+
+for f in sub1 sub2; do
+    new "restconf stream $f"
+    ret=$(cat $dir/$f.txt)
+    expectpart "$ret" 0 "HTTP/$HVER 200" "Content-Type: text/event-stream" "Cache-Control: no-cache" --not-- "Content-Length"
+    match=$(echo "$ret" | grep -Eo "$expect")
+    if [ -z "$match" ]; then
+        err "$expect" "$ret"
+    fi
+done
+
+new "restconf still works after subscribers closed"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/ietf-restconf-monitoring:restconf-state/streams/stream=EXAMPLE/name)" 0 "HTTP/$HVER 200" "EXAMPLE"
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,130 @@
+#!/usr/bin/env bash
+# TLS session resumption in native restconf, see restconf tls-session-cache and tls-session-tickets
+# Reconnect with openssl s_client and check that sessions are resumed
+# 1. by session tickets shared by several workers
+# 2. by session cache without tickets
+# 3. not resumed if both are disabled
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+if [ "${WITH_RESTCONF}" != "native" -o "$RCPROTO" != https ]; then
+    echo "...skipped: Must run with native restconf and https"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/restconf.yang
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container table{
+      leaf value{
+         type string;
+      }
+   }
+}
+EOF
+
+# Write config with restconf session resumption parameters
+# 1: extra restconf config
+mkconfig(){
+    RESTCONFIG=$(restconf_config none false)
+    RESTCONFIG=${RESTCONFIG/<enable>true<\/enable>/<enable>true</enable>$1}
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>/usr/local/share/clixon</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  $RESTCONFIG
+</clixon-config>
+EOF
+}
+
+# Start restconf, reconnect five times and count resumed sessions
+# 1: extra restconf config
+# 2: extra s_client options
+# 3: expect resumed (true/false)
+testrun(){
+    mkconfig "$1"
+
+    if [ $RC -ne 0 ]; then
+        new "kill old restconf daemon"
+        stop_restconf_pre
+
+        new "start restconf daemon"
+        start_restconf -f $cfg
+    fi
+
+    new "wait restconf"
+    wait_restconf
+
+    new "s_client reconnect $1"
+    nr=$(echo | openssl s_client -connect localhost:443 -tls1_2 -reconnect $2 2>/dev/null | grep -c "^Reused")
+    if $3; then
+        if [ $nr -lt 5 ]; then
+            err "5" "$nr"
+        fi
+    elif [ $nr -ne 0 ]; then
+        err "0" "$nr"
+    fi
+
+    if [ $RC -ne 0 ]; then
+        new "kill restconf daemon"
+        stop_restconf
+    fi
+}
+
+mkconfig ""
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "session tickets with workers"
+testrun "<tls-session-tickets>true</tls-session-tickets><workers>4</workers>" "" true
+
+new "session cache without tickets"
+testrun "<tls-session-cache>100</tls-session-cache><tls-session-tickets>false</tls-session-tickets>" "-no_ticket" true
+
+new "no session cache and no tickets"
+testrun "<tls-session-cache>0</tls-session-cache><tls-session-tickets>false</tls-session-tickets>" "" false
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,139 @@
+#!/usr/bin/env bash
+# Restconf with several worker processes, see restconf workers
+# Native: start restconf with workers sharing the listening socket with SO_REUSEPORT
+# Fcgi: start restconf with workers accepting on the same fcgi socket
+# Check that requests are served and that all workers terminate with the supervisor
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/restconf.yang
+
+# Number of worker processes
+: ${workers:=4}
+
+# Define default restconfig config: RESTCONFIG with workers
+RESTCONFIG=$(restconf_config none false)
+RESTCONFIG=${RESTCONFIG/<enable>true<\/enable>/<enable>true</enable><workers>$workers</workers>}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>/usr/local/share/clixon</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container table{
+      list parameter{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+if [ $RC -ne 0 ]; then
+    new "restconf supervisor and $workers workers"
+    sleep 1
+    nr=$(pgrep -f "clixon_restconf.*$cfg" | wc -l)
+    # sudo may also match
+    if [ $nr -lt $((workers+1)) ]; then
+        err "$((workers+1))" "$nr"
+    fi
+fi
+
+new "restconf POST from several connections"
+for (( i=0; i<10; i++ )); do
+    expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d "{\"example:parameter\":[{\"name\":\"A$i\",\"value\":\"$i\"}]}" $RCPROTO://localhost/restconf/data/example:table)" 0 "HTTP/$HVER 201"
+done
+
+new "restconf GET from several connections"
+for (( i=0; i<10; i++ )); do
+    expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A$i)" 0 "HTTP/$HVER 200" "{\"example:parameter\":\[{\"name\":\"A$i\",\"value\":\"$i\"}\]}"
+done
+
+new "restconf parallel GETs"
+for (( i=0; i<10; i++ )); do
+    curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table > $dir/get$i.txt 2>/dev/null &
+done
+wait
+for (( i=0; i<10; i++ )); do
+    expectpart "$(cat $dir/get$i.txt)" 0 "HTTP/$HVER 200" '"name":"A9"'
+done
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf supervisor"
+    pid=$(pgrep -o -u root -f "clixon_restconf.*$cfg")
+    sudo kill $pid
+    sleep 1
+
+    new "all workers terminate"
+    nr=$(pgrep -f "clixon_restconf.*$cfg" | wc -l)
+    if [ $nr -ne 0 ]; then
+        err "0" "$nr"
+    fi
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
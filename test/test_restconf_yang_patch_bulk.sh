@@ -0,0 +1,179 @@
+#!/usr/bin/env bash
+# Restconf RFC8072 yang patch with several edits, see api_data_yang_patch
+# Edits are combined in one edit-config and committed once
+# Check yang-patch-status of a successful patch, and that a failed edit is reported with its
+# edit-id and that no edit of a failed patch is applied
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+if [ -z "${CLIXON_YANG_PATCH}" ]; then
+    echo "...skipped: YANG_PATCH not enabled"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/restconf.yang
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container table{
+      list parameter{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+url=$RCPROTO://localhost/restconf/data/example:table
+
+new "restconf POST initial"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d '{"example:table":{"parameter":[{"name":"a","value":"1"},{"name":"b","value":"2"}]}}' $RCPROTO://localhost/restconf/data)" 0 "HTTP/$HVER 201"
+
+# Create, merge and delete in one patch
+REQ='{
+  "ietf-yang-patch:yang-patch": {
+    "patch-id": "bulk",
+    "edit": [
+      { "edit-id": "e1", "operation": "create", "target": "/parameter=c",
+        "value": { "example:parameter": [ { "name": "c", "value": "3" } ] } },
+      { "edit-id": "e2", "operation": "create", "target": "/parameter=d",
+        "value": { "example:parameter": [ { "name": "d", "value": "4" } ] } },
+      { "edit-id": "e3", "operation": "merge", "target": "/parameter=a",
+        "value": { "example:parameter": [ { "value": "11" } ] } },
+      { "edit-id": "e4", "operation": "delete", "target": "/parameter=b" }
+    ]
+  }
+}'
+new "restconf yang patch several edits"
+expectpart "$(curl $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-data+json' $url -d "$REQ")" 0 "HTTP/$HVER 200" '"ietf-yang-patch:yang-patch-status":{"patch-id":"bulk","ok"'
+
+new "restconf GET all edits applied"
+expectpart "$(curl $CURLOPTS -X GET $url)" 0 "HTTP/$HVER 200" '{"example:table":{"parameter":\[{"name":"a","value":"11"},{"name":"c","value":"3"},{"name":"d","value":"4"}\]}}'
+
+# Conflicting edits of the same entry are made in order
+REQ='{
+  "ietf-yang-patch:yang-patch": {
+    "patch-id": "conflict",
+    "edit": [
+      { "edit-id": "e1", "operation": "delete", "target": "/parameter=c" },
+      { "edit-id": "e2", "operation": "create", "target": "/parameter=c",
+        "value": { "example:parameter": [ { "name": "c", "value": "33" } ] } }
+    ]
+  }
+}'
+new "restconf yang patch conflicting edits"
+expectpart "$(curl $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-data+json' $url -d "$REQ")" 0 "HTTP/$HVER 200" '"patch-id":"conflict","ok"'
+
+new "restconf GET conflicting edits applied"
+expectpart "$(curl $CURLOPTS -X GET $url/parameter=c)" 0 "HTTP/$HVER 200" '{"example:parameter":\[{"name":"c","value":"33"}\]}'
+
+# The second edit fails since the entry exists
+REQ='{
+  "ietf-yang-patch:yang-patch": {
+    "patch-id": "fail",
+    "edit": [
+      { "edit-id": "e1", "operation": "create", "target": "/parameter=e",
+        "value": { "example:parameter": [ { "name": "e", "value": "5" } ] } },
+      { "edit-id": "e2", "operation": "create", "target": "/parameter=d",
+        "value": { "example:parameter": [ { "name": "d", "value": "44" } ] } }
+    ]
+  }
+}'
+new "restconf yang patch failed edit"
+expectpart "$(curl $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-data+json' $url -d "$REQ")" 0 "HTTP/$HVER 409" '"patch-id":"fail","edit-status":{"edit":{"edit-id":"e2","errors":{"error":' "data-exists"
+
+new "restconf GET no edit of failed patch applied"
+expectpart "$(curl $CURLOPTS -X GET $url)" 0 "HTTP/$HVER 200" '{"example:table":{"parameter":\[{"name":"a","value":"11"},{"name":"c","value":"33"},{"name":"d","value":"4"}\]}}'
+
+new "restconf yang patch failed edit xml"
+expectpart "$(curl $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-data+xml' $url -d "$REQ")" 0 "HTTP/$HVER 409" "<yang-patch-status xmlns=\"urn:ietf:params:xml:ns:yang:ietf-yang-patch\"><patch-id>fail</patch-id><edit-status><edit><edit-id>e2</edit-id><errors><error>"
+
+REQ='{
+  "ietf-yang-patch:yang-patch": {
+    "patch-id": "move",
+    "edit": [
+      { "edit-id": "e1", "operation": "move", "target": "/parameter=a",
+        "where": "last" }
+    ]
+  }
+}'
+new "restconf yang patch move not supported"
+expectpart "$(curl $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-data+json' $url -d "$REQ")" 0 "operation-not-supported" '"edit-id":"e1"'
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -198,7 +198,7 @@ REQ='<ietf-yang-patch:yang-patch>
       </edit>
   </ietf-yang-patch:yang-patch>'
 new "RFC 8072 YANG Patch XML Media: Error."
-expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+xml' -H 'Accept: application/yang-patch+xml' $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces -d "$REQ")" 0 "HTTP/$HVER 204 No Content"
+expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+xml' -H 'Accept: application/yang-patch+xml' $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces -d "$REQ")" 0 "HTTP/$HVER 200"
 #
 # Create artist in jukebox example
 REQ='{"example-jukebox:artist":[{"name":"Foo Fighters"}]}'
@@ -281,7 +281,7 @@ REQ='<ietf-yang-patch:yang-patch>
     </edit>
   </ietf-yang-patch:yang-patch>'
 new "RFC 8072 YANG Patch XML jukebox example: Error."
-expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/example-jukebox:jukebox/playlist=Foo-One -d "$REQ")" 0 "HTTP/$HVER 201 Created"
+expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/example-jukebox:jukebox/playlist=Foo-One -d "$REQ")" 0 "HTTP/$HVER 200"
 
 # Uncomment to get info about playlist in jukebox example
 #new "RFC 8072 YANG Patch jukebox example get : Error."
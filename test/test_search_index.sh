@@ -1,6 +1,7 @@
 #!/usr/bin/env bash
 # Test explicit search index.
 # Test done by clixon explicit-index extension
+# Test explicit indexes declared with clixon-config:search_index and clixon-lib:search-index
 # Test explicit indexes in lists these cases:
 #   - not a key string
 #   - not a key int
@@ -12,6 +13,7 @@
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
 
 : ${clixon_util_path:=clixon_util_path -D $DBG -Y /usr/local/share/clixon}
+: ${clixon_util_xpath:=clixon_util_xpath -D $DBG -Y /usr/local/share/clixon}
 
 # Number of list/leaf-list entries
 : ${nr:=10000}
@@ -36,6 +38,9 @@ module moda{
   import clixon-config {
     prefix "cc";
   }
+  import clixon-lib {
+    prefix "cl";
+  }
   container x1{
     description "extra index in list with single key";
     list y{
@@ -58,6 +63,19 @@ module moda{
       }
     }
   }
+  container x2{
+    description "secondary index declared with clixon-lib extension";
+    list y{
+      key k1;
+      leaf k1{
+        type string;
+      }
+      leaf vlan{
+        type uint16;
+        cl:search-index;
+      }
+    }
+  }
 }
 EOF
 
@@ -81,6 +99,25 @@ for (( ii=0; ii<10; ii++ )); do
     expectpart "$($clixon_util_path -f $xml1 -y $ydir -p /a:x1/a:y[a:i=\"$rndi\"])" 0 "^0: <y><k1>a$rnd</k1><z>foo$rnd</z><i>$rndi</i><j>$rndi</j></y>$"
 done
 
+new "generate list with $nr entries and clixon-lib search-index to $xml2"
+xml2=$dir/xml2.xml
+echo -n '<x2 xmlns="urn:example:a">' > $xml2
+for (( i=0; i<$nr; i++ )); do  
+    let ii=$nr-$i-1
+    echo -n "<y><k1>a$i</k1><vlan>$ii</vlan></y>" >> $xml2
+done
+echo -n '</x2>' >> $xml2
+
+for (( ii=0; ii<5; ii++ )); do
+    rnd=$(( ( RANDOM % $nr ) ))
+    rndi=$(( $nr - $rnd - 1 ))
+    new "instance-id clixon-lib search-index vlan=$rndi"
+    expectpart "$($clixon_util_path -f $xml2 -y $ydir -p /a:x2/a:y[a:vlan=\"$rndi\"])" 0 "^0: <y><k1>a$rnd</k1><vlan>$rndi</vlan></y>$"
+
+    new "xpath clixon-lib search-index vlan=$rndi"
+    expectpart "$($clixon_util_xpath -f $xml2 -y $ydir -n a:urn:example:a -p "/a:x2/a:y[a:vlan='$rndi']")" 0 "^nodeset:0:<y><k1>a$rnd</k1><vlan>$rndi</vlan></y>$"
+done
+
 # Then measure time for index and non-index, assume correct
 # For small nr, the time to parse is so much larger than searching (and also parsing involves
 # searching) which makes it hard to make a  test comparing accessing the index variable "i" and the
@@ -416,6 +416,14 @@ expectpart "$($snmpwalk IF-MIB::ifTable)" 0 "IF-MIB::ifIndex.1 = INTEGER: 1" \
            "IF-MIB::ifSpecific.1 = OID: SNMPv2-SMI::zeroDotZero" \
            "IF-MIB::ifSpecific.2 = OID: iso.2.3"
 
+# GETBULK repetitions are served from the table row cache
+new "Bulk walk is same as walk"
+walk=$($snmpwalk IF-MIB::ifTable)
+bulkwalk=$($snmpbulkwalk IF-MIB::ifTable)
+if [ "$walk" != "$bulkwalk" ]; then
+    err "$walk" "$bulkwalk"
+fi
+
 
 # There is an intricate error in the return of this test that has to with validation of state data
 # clixon_snmp queries using xpath:
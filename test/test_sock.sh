@@ -77,6 +77,16 @@ EOF
     new "hello session-id 2"
     expecteof "$clixon_util_socket -a $family -s $sock -D $DBG" 0 "<hello $DEFAULTONLY/>" "<hello $DEFAULTONLY><session-id>4</session-id></hello>"
 
+    new "pipelined get-config, three requests before any reply"
+    ret=$(echo "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" | $clixon_util_socket -a $family -s $sock -D $DBG -n 3)
+    if [ $? -ne 0 ]; then
+        err "0" "$?"
+    fi
+    nr=$(echo "$ret" | grep -c "<rpc-reply><data")
+    if [ "$nr" -ne 3 ]; then
+        err "3 replies" "$ret"
+    fi
+
     if [ $BE -ne 0 ]; then
         new "Kill backend"
         # Check if premature kill
@@ -0,0 +1,131 @@
+#!/usr/bin/env bash
+# Test parallel sort of a large startup datastore, see CLICON_XML_SORT_THREADS
+# The startup entries are in reverse order. A large list is sorted in chunks by several
+# threads (XML_SORT_PARALLEL_THRESHOLD), and nested lists are sorted by the thread pool.
+# The result should be the same as a serial sort: ordered-by system lists are sorted and
+# the ordered-by user leaf-list keeps its order.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/sort.yang
+
+# Number of entries in large list, larger than XML_SORT_PARALLEL_THRESHOLD (8192)
+: ${nr:=10000}
+# Number of entries with nested lists
+: ${nrz:=40}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XML_SORT_THREADS>4</CLICON_XML_SORT_THREADS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module sort{
+  yang-version 1.1;
+  namespace "urn:example:sort";
+  prefix s;
+  container c{
+    list y{
+      key k;
+      leaf k{
+        type int32;
+      }
+    }
+    list z{
+      key k;
+      leaf k{
+        type string;
+      }
+      list w{
+        key k;
+        leaf k{
+          type int32;
+        }
+      }
+    }
+    leaf-list u{
+      ordered-by user;
+      type string;
+    }
+  }
+}
+EOF
+
+new "generate startup with $nr and $nrz entries in reverse order"
+echo -n "<${DATASTORE_TOP}><c xmlns=\"urn:example:sort\">" > $dir/startup_db
+for (( i=$nrz-1; i>=0; i-- )); do
+    echo -n "<u>u$i</u><z><k>z$i</k>" >> $dir/startup_db
+    for (( j=9; j>=0; j-- )); do
+        echo -n "<w><k>$j</k></w>" >> $dir/startup_db
+    done
+    echo -n "</z>" >> $dir/startup_db
+done
+for (( i=$nr-1; i>=0; i-- )); do
+    echo -n "<y><k>$i</k></y>" >> $dir/startup_db
+done
+echo -n "</c></${DATASTORE_TOP}>" >> $dir/startup_db
+
+new "generate expected result"
+expect="<c xmlns=\"urn:example:sort\">"
+for (( i=0; i<$nr; i++ )); do
+    expect+="<y><k>$i</k></y>"
+done
+# string keys: lexical order
+for i in $(for (( i=0; i<$nrz; i++ )); do echo z$i; done | LC_ALL=C sort); do
+    expect+="<z><k>$i</k>"
+    for (( j=0; j<10; j++ )); do
+        expect+="<w><k>$j</k></w>"
+    done
+    expect+="</z>"
+done
+for (( i=$nrz-1; i>=0; i-- )); do
+    expect+="<u>u$i</u>"
+done
+expect+="</c>"
+
+new "test params: -s startup -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "check running sorted"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$expect</data></rpc-reply>"
+
+new "find entry in sorted list"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/s:c/s:y[s:k='4711']\" xmlns:s=\"urn:example:sort\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:sort\"><y><k>4711</k></y></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,171 @@
+#!/usr/bin/env bash
+# Journal shipping to a hot-standby backend, see CLICON_STREAM_JOURNAL and CLICON_BACKEND_STANDBY
+# Start an active and a standby backend, commit in the active backend and check that running
+# of the standby follows, including an ordered-by user list which is shipped as a full replace.
+# Then stop the active backend and promote the standby
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfgact=$dir/conf_active.xml
+cfgsby=$dir/conf_standby.xml
+fyang=$dir/standby.yang
+dbact=$dir/active
+dbsby=$dir/standby
+sockact=/usr/local/var/$APPNAME/$APPNAME.sock
+socksby=/usr/local/var/$APPNAME/${APPNAME}-standby.sock
+
+mkdir -p $dbact $dbsby
+
+cat <<EOF > $cfgact
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfgact</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$sockact</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dbact</CLICON_XMLDB_DIR>
+  <CLICON_STREAM_JOURNAL>true</CLICON_STREAM_JOURNAL>
+</clixon-config>
+EOF
+
+cat <<EOF > $cfgsby
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfgsby</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$socksby</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/${APPNAME}-standby.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dbsby</CLICON_XMLDB_DIR>
+  <CLICON_BACKEND_STANDBY>$sockact</CLICON_BACKEND_STANDBY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module standby{
+  yang-version 1.1;
+  namespace "urn:example:standby";
+  prefix s;
+  container interfaces{
+    list interface{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf mtu{
+        type uint32;
+      }
+    }
+  }
+  container rules{
+    list rule{
+      key name;
+      ordered-by user;
+      leaf name{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+# Edit and commit
+# 1: config file
+# 2: config
+function commit()
+{
+    expecteof_netconf "$clixon_netconf -qf $1" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$2</config></edit-config></rpc><rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply><rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+# Check running
+# 1: config file
+# 2: expected data
+function running()
+{
+    expecteof_netconf "$clixon_netconf -qf $1" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$2</data></rpc-reply>"
+}
+
+new "test params: -f $cfgact -f $cfgsby"
+if [ $BE -ne 0 ]; then
+    new "kill old backends"
+    sudo clixon_backend -zf $cfgsby
+    sudo clixon_backend -zf $cfgact
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start active backend -s init -f $cfgact"
+    start_backend -s init -f $cfgact
+fi
+
+cfg=$cfgact
+new "wait active backend"
+wait_backend
+
+new "commit before standby starts"
+commit $cfgact "<interfaces xmlns=\"urn:example:standby\"><interface><name>eth0</name><mtu>1400</mtu></interface></interfaces>"
+
+if [ $BE -ne 0 ]; then
+    new "start standby backend -s init -f $cfgsby"
+    start_backend -s init -f $cfgsby
+fi
+
+cfg=$cfgsby
+new "wait standby backend"
+wait_backend
+
+new "standby has running of active at start"
+running $cfgsby "<interfaces xmlns=\"urn:example:standby\"><interface><name>eth0</name><mtu>1400</mtu></interface></interfaces>"
+
+new "commit change and add in active"
+commit $cfgact "<interfaces xmlns=\"urn:example:standby\"><interface><name>eth0</name><mtu>1500</mtu></interface><interface><name>eth1</name></interface></interfaces>"
+
+sleep $DEMSLEEP
+new "standby has change and add"
+running $cfgsby "<interfaces xmlns=\"urn:example:standby\"><interface><name>eth0</name><mtu>1500</mtu></interface><interface><name>eth1</name></interface></interfaces>"
+
+new "commit remove in active"
+expecteof_netconf "$clixon_netconf -qf $cfgact" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><interfaces xmlns=\"urn:example:standby\"><interface nc:operation=\"remove\" xmlns:nc=\"${BASENS}\"><name>eth0</name></interface></interfaces></config></edit-config></rpc><rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply><rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit ordered-by user entries in active"
+commit $cfgact "<rules xmlns=\"urn:example:standby\"><rule><name>b</name></rule><rule><name>a</name></rule></rules>"
+
+sleep $DEMSLEEP
+new "standby has remove and ordered-by user entries"
+running $cfgsby "<interfaces xmlns=\"urn:example:standby\"><interface><name>eth1</name></interface></interfaces><rules xmlns=\"urn:example:standby\"><rule><name>b</name></rule><rule><name>a</name></rule></rules>"
+
+new "commit in standby is rejected"
+expecteof_netconf "$clixon_netconf -qf $cfgsby" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>Backend is standby</error-message></rpc-error></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill active backend"
+    stop_backend -f $cfgact
+fi
+
+new "promote standby"
+expecteof_netconf "$clixon_netconf -qf $cfgsby" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><standby-promote $LIBNS/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "promote again is an error"
+expecteof_netconf "$clixon_netconf -qf $cfgsby" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><standby-promote $LIBNS/></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>Backend is not standby</error-message></rpc-error></rpc-reply>"
+
+new "commit in promoted backend"
+commit $cfgsby "<interfaces xmlns=\"urn:example:standby\"><interface><name>eth2</name></interface></interfaces>"
+
+new "promoted backend has replicated and new config"
+running $cfgsby "<interfaces xmlns=\"urn:example:standby\"><interface><name>eth1</name></interface><interface><name>eth2</name></interface></interfaces><rules xmlns=\"urn:example:standby\"><rule><name>b</name></rule><rule><name>a</name></rule></rules>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill promoted backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f "clixon_backend.*$cfgsby")
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfgsby
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
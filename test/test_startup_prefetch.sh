@@ -0,0 +1,106 @@
+#!/usr/bin/env bash
+# Parse startup datastore in a thread during backend start, see CLICON_XMLDB_PREFETCH
+# Start backend in startup mode and check running and in the debug log that the
+# prefetched tree is used
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/prefetch.yang
+flog=$dir/backend.log
+
+# Number of list entries
+: ${perfnr:=1000}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PREFETCH>true</CLICON_XMLDB_PREFETCH>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module prefetch{
+  yang-version 1.1;
+  namespace "urn:example:prefetch";
+  prefix p;
+  container table{
+    list parameter{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf value{
+        type uint32;
+      }
+    }
+  }
+}
+EOF
+
+new "generate startup with $perfnr list entries"
+echo "<config><table xmlns=\"urn:example:prefetch\">" > $dir/startup_db
+for (( i=0; i<$perfnr; i++ )); do
+    echo "<parameter><name>p$i</name><value>$i</value></parameter>" >> $dir/startup_db
+done
+echo "</table></config>" >> $dir/startup_db
+
+# Start backend, check running and the log, and stop
+# 1: expect "taken" or none
+# 2: extra backend options
+prefetch_run(){
+    sudo rm -f $flog
+    new "test params: -f $cfg -s startup $2"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s startup -f $cfg -D 1 -l f$flog $2"
+        start_backend -s startup -f $cfg -D 1 -l f$flog $2
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "check running first and last entry"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:prefetch\"><parameter><name>p0</name><value>0</value></parameter>" "<parameter><name>p$(($perfnr-1))</name><value>$(($perfnr-1))</value></parameter></table></data></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+
+        new "check prefetch $1"
+        if [ "$1" = taken ]; then
+            expectpart "$(sudo cat $flog)" 0 "xmldb_prefetch_take startup taken"
+        else
+            expectpart "$(sudo cat $flog)" 0 --not-- "xmldb_prefetch_start"
+        fi
+    fi
+}
+
+new "startup is prefetched"
+prefetch_run taken
+
+new "option not set"
+prefetch_run none "-o CLICON_XMLDB_PREFETCH=false"
+
+sudo rm -rf $dir
+
+new "endtest"
+endtest
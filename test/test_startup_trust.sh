@@ -0,0 +1,121 @@
+#!/usr/bin/env bash
+# Skip validation of unchanged startup datastore, see CLICON_STARTUP_TRUST
+# Start backend in startup mode several times and check in the log if startup was validated
+# Startup is validated again if it or the yang is changed, or if the option is not set
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/trust.yang
+flog=$dir/backend.log
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_STARTUP_TRUST>true</CLICON_STARTUP_TRUST>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module trust{
+  yang-version 1.1;
+  namespace "urn:example:trust";
+  prefix t;
+  container table{
+    list parameter{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf value{
+        type uint32;
+        mandatory true;
+      }
+    }
+  }
+}
+EOF
+
+# Start backend in startup mode, check running and the log, and stop
+# 1: value in startup
+# 2: expect "validated" or "trusted"
+# 3: extra backend options
+startup_run(){
+    echo "<config><table xmlns=\"urn:example:trust\"><parameter><name>a</name><value>$1</value></parameter></table></config>" > $dir/startup_db
+    sudo rm -f $flog
+    new "test params: -f $cfg -s startup $3"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s startup -f $cfg -l f$flog $3"
+        start_backend -s startup -f $cfg -l f$flog $3
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "check running value $1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:trust\"><parameter><name>a</name><value>$1</value></parameter></table></data></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+
+        new "check startup $2"
+        if [ "$2" = trusted ]; then
+            expectpart "$(sudo cat $flog)" 0 "Startup startup unchanged since last commit, not validated"
+        else
+            expectpart "$(sudo cat $flog)" 0 --not-- "not validated"
+        fi
+    fi
+}
+
+sudo rm -f $dir/startup_db.trust
+
+new "first start"
+startup_run 42 validated
+
+if [ $BE -ne 0 ]; then
+    new "trust file exists"
+    if ! sudo test -f $dir/startup_db.trust; then
+        err "$dir/startup_db.trust" ""
+    fi
+fi
+
+new "unchanged startup"
+startup_run 42 trusted
+
+new "changed startup"
+startup_run 43 validated
+
+new "unchanged startup again"
+startup_run 43 trusted
+
+new "option not set"
+startup_run 43 validated "-o CLICON_STARTUP_TRUST=false"
+
+new "changed yang"
+sed -i 's/mandatory true;/mandatory false;/' $fyang
+startup_run 43 validated
+
+sudo rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,107 @@
+#!/usr/bin/env bash
+# Datastore-changed notifications on internal stream, see CLICON_STREAM_DATASTORE
+# Subscribe to the CLIXON-DATASTORE stream in one netconf session, commit in another and
+# check the changed top-level nodes and version of running
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+NCWAIT=5 # Time subscription session is open
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/changed.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_STREAM_DATASTORE>true</CLICON_STREAM_DATASTORE>
+  <CLICON_STREAM_DISCOVERY_RFC5277>true</CLICON_STREAM_DISCOVERY_RFC5277>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module changed{
+  yang-version 1.1;
+  namespace "urn:example:changed";
+  prefix c;
+  container interfaces{
+    list interface{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf mtu{
+        type uint32;
+      }
+    }
+  }
+  container other{
+    leaf x{
+      type string;
+    }
+  }
+}
+EOF
+
+# Edit and commit in another session in background
+# 1: delay
+# 2: config
+commit_bg(){
+    rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$2</config></edit-config></rpc>]]>]]><rpc $DEFAULTNS><commit/></rpc>]]>]]>"
+    (sleep $1; echo "$HELLONO11$rpc" | $clixon_netconf -qf $cfg > /dev/null) &
+}
+
+LIBNS="xmlns=\"http://clicon.org/lib\""
+SUBSCRIBE="<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>CLIXON-DATASTORE</stream></create-subscription></rpc>"
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "datastore stream exists"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"n:netconf/n:streams\" xmlns:n=\"urn:ietf:params:xml:ns:netmod:notification\"/></get></rpc>" "" "<stream><name>CLIXON-DATASTORE</name><description>Clixon datastore changes after commit</description><replay-support>false</replay-support></stream>"
+
+new "datastore-changed of two top-level nodes"
+commit_bg 2 "<interfaces xmlns=\"urn:example:changed\"><interface><name>eth0</name><mtu>1400</mtu></interface></interfaces><other xmlns=\"urn:example:changed\"><x>foo</x></other>"
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "$SUBSCRIBE" $NCWAIT "<rpc-reply $DEFAULTNS><ok/></rpc-reply>" "<datastore-changed $LIBNS><datastore>running</datastore><version>[0-9]*</version><subtree>/changed:interfaces</subtree><subtree>/changed:other</subtree></datastore-changed>"
+
+new "datastore-changed of one list entry"
+commit_bg 2 "<interfaces xmlns=\"urn:example:changed\"><interface><name>eth0</name><mtu>1500</mtu></interface></interfaces>"
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "$SUBSCRIBE" $NCWAIT "<version>[0-9]*</version><subtree>/changed:interfaces</subtree></datastore-changed>" --not-- "/changed:other"
+
+new "no datastore-changed if nothing changed"
+commit_bg 2 "<other xmlns=\"urn:example:changed\"><x>foo</x></other>"
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "$SUBSCRIBE" $NCWAIT "<rpc-reply $DEFAULTNS><ok/></rpc-reply>" --not-- "datastore-changed"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
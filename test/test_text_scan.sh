@@ -0,0 +1,155 @@
+#!/usr/bin/env bash
+# Test: hand-written text syntax (curly braces) scanner, see CLICON_TEXT_SCANNER
+# Parse text with the lex/yacc parser and with the scanner (clixon_util_xml -x -S) and check
+# that the output and exit status are the same, for valid and invalid input
+# Also check that XML saved as text can be loaded again
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:=clixon_util_xml}
+
+ftext=$dir/large.txt
+fxml=$dir/large.xml
+fyang=$dir/scan.yang
+
+# Number of list entries in large file
+: ${perfnr:=1000}
+
+cat <<EOF > $fyang
+module scan{
+  yang-version 1.1;
+  namespace "urn:example:scan";
+  prefix s;
+  container c{
+    list l{
+      key "k";
+      leaf k{
+        type uint32;
+      }
+      leaf v{
+        type string;
+      }
+    }
+    list m{
+      key "a b";
+      leaf a{
+        type string;
+      }
+      leaf b{
+        type string;
+      }
+      leaf c{
+        type string;
+      }
+    }
+    leaf-list ll{
+      type string;
+    }
+    leaf x{
+      type string;
+    }
+    container e{
+      presence true;
+    }
+  }
+}
+EOF
+
+# Parse input with both parsers and compare
+# 1: Text input
+scan_cmp(){
+    input=$1
+    new "scan: $input"
+    ret0=$(echo -n "$input" | $clixon_util_xml -x -y $fyang -o 2> /dev/null)
+    r0=$?
+    ret1=$(echo -n "$input" | $clixon_util_xml -x -S -y $fyang -o 2> /dev/null)
+    r1=$?
+    if [ $r0 -ne $r1 ]; then
+        err "status $r0" "status $r1"
+    fi
+    if [ $r0 -eq 0 -a "$ret0" != "$ret1" ]; then
+        err "$ret0" "$ret1"
+    fi
+}
+
+# Valid text
+scan_cmp 'scan:c { x a; }'
+scan_cmp 'scan:c { x "a b"; }'
+scan_cmp 'scan:c { x "a;{b}"; }'
+scan_cmp 'scan:c {
+  x a;
+}'
+scan_cmp 'scan:c { l 2 { v b; } l 1; x a; }'
+scan_cmp 'scan:c { l 1 { v "x y"; } }'
+scan_cmp 'scan:c { m x y { c z; } m x a; }'
+scan_cmp 'scan:c { ll [ b a c ]; }'
+scan_cmp 'scan:c { ll [
+  b
+  a
+]
+}'
+scan_cmp 'scan:c { e { } }'
+scan_cmp 'scan:c { # comment
+  x a;
+}'
+scan_cmp 'scan:c {
+  x a#b;
+}'
+scan_cmp 'scan:c { } scan:c { x a; }'
+
+# Invalid text
+scan_cmp ''
+scan_cmp 'scan:c {'
+scan_cmp 'scan:c { x a }'
+scan_cmp 'scan:c { x a; } }'
+scan_cmp 'scan:c { x "a; }'
+scan_cmp 'scan:c { x ""; }'
+scan_cmp 'scan:c { ll [ a b; }'
+scan_cmp 'scan:c { y a; }'
+scan_cmp 'foo:c { x a; }'
+scan_cmp 'c { x a; }'
+
+new "generate large file with $perfnr entries"
+echo "scan:c {" > $ftext
+for (( i=$perfnr; i>0; i-- )); do
+    echo "  l $i {" >> $ftext
+    echo "    v \"v $i\";" >> $ftext
+    echo "  }" >> $ftext
+done
+echo "  x z;" >> $ftext
+echo "}" >> $ftext
+
+new "parse large file"
+ret0=$($clixon_util_xml -x -y $fyang -o < $ftext)
+if [ $? -ne 0 ]; then
+    err "0" "$?"
+fi
+
+new "scan large file"
+ret1=$($clixon_util_xml -x -S -y $fyang -o < $ftext)
+if [ $? -ne 0 ]; then
+    err "0" "$?"
+fi
+
+new "compare large file"
+if [ "$ret0" != "$ret1" ]; then
+    err "$ret0" "$ret1"
+fi
+
+new "save large file as text and load again"
+echo "$ret1" > $fxml
+ret2=$($clixon_util_xml -y $fyang -f $fxml -X -o | $clixon_util_xml -x -S -y $fyang -o)
+if [ $? -ne 0 ]; then
+    err "0" "$?"
+fi
+
+new "compare saved and loaded file"
+if [ "$ret1" != "$ret2" ]; then
+    err "$ret1" "$ret2"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,123 @@
+#!/usr/bin/env bash
+# Change set iterator of transactions, see transaction_change_it_init
+# The example backend plugin is started with -- -C <schema-nodeid> and logs the changes of
+# that schema node on commit. Check added, deleted and changed nodes, and that changes of
+# other nodes are not logged
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/changes.yang
+flog=$dir/backend.log
+touch $flog
+
+cat <<EOF > $fyang
+module changes{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+    }
+    leaf other {
+      type string;
+    }
+  }
+  container z {
+    leaf w {
+      type string;
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+# Edit candidate and commit
+# 1: config
+edit_commit(){
+    new "edit-config"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$1</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+NCOP="xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\""
+
+new "test params: -f $cfg -l f$flog -- -C /ex:x/ex:y"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -l f$flog -- -C /ex:x/ex:y"
+    start_backend -s init -f $cfg -l f$flog -- -C /ex:x/ex:y
+fi
+
+new "wait backend"
+wait_backend
+
+new "add container with list entries"
+edit_commit "<x xmlns=\"urn:example:clixon\"><y><a>1</a><b>10</b></y><y><a>2</a><b>20</b></y></x>"
+
+new "added ancestor is logged"
+expectpart "$(sudo cat $flog)" 0 "example_changes_log add: <x xmlns=\"urn:example:clixon\"><y><a>1</a><b>10</b></y><y><a>2</a><b>20</b></y></x>"
+
+new "add list entry"
+edit_commit "<x xmlns=\"urn:example:clixon\"><y><a>3</a><b>30</b></y></x>"
+
+new "added entry is logged"
+expectpart "$(sudo cat $flog)" 0 "example_changes_log add: <y><a>3</a><b>30</b></y>"
+
+new "change and delete list entries"
+edit_commit "<x xmlns=\"urn:example:clixon\" $NCOP><y><a>1</a><b>11</b></y><y nc:operation=\"delete\"><a>2</a></y></x>"
+
+new "deleted entry is logged"
+expectpart "$(sudo cat $flog)" 0 "example_changes_log delete: <y><a>2</a><b>20</b></y>"
+
+new "changed leaf is logged"
+expectpart "$(sudo cat $flog)" 0 "example_changes_log change: <b>10</b><b>11</b>"
+
+new "change other nodes"
+edit_commit "<x xmlns=\"urn:example:clixon\"><other>foo</other></x><z xmlns=\"urn:example:clixon\"><w>bar</w></z>"
+
+new "other nodes are not logged"
+expectpart "$(sudo cat $flog)" 0 --not-- "example_changes_log add: <other>" "example_changes_log add: <z"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+sudo rm -rf $dir
+
+new "endtest"
+endtest
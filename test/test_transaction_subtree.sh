@@ -0,0 +1,136 @@
+#!/usr/bin/env bash
+# Transaction callbacks of a plugin registered on a subtree with ca_trans_subtree
+# The main example plugin is started with -- -T /ex:x and is only called in transactions
+# that change x, the nacm example plugin is called in all transactions.
+# Both plugins log transaction callbacks with -- -t, the test counts them in the log
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/trans.yang
+flog=$dir/backend.log
+touch $flog
+
+cat <<EOF > $fyang
+module trans{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+     list y {
+       key "a";
+       leaf a {
+         type int32;
+       }
+       leaf b {
+         type int32;
+       }
+     }
+   }
+   container z {
+     leaf c {
+       type int32;
+     }
+   }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+# Edit candidate and commit
+# 1: edit-config config
+commit(){
+    new "edit-config $1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$1</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+# Check number of transactions in log with a callback
+# 1: callback, eg main_commit
+# 2: expected number of transactions
+checktrans(){
+    new "Check $1 in $2 transactions"
+    n=$(grep -o "transaction_log [0-9]* $1 " $flog | sort -u | wc -l)
+    if [ $n -ne $2 ]; then
+        err "$2" "$n"
+    fi
+}
+
+new "test params: -f $cfg -l f$flog -- -t -T /ex:x"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -l f$flog -- -t -T /ex:x"
+    start_backend -s init -f $cfg -l f$flog -- -t -T /ex:x
+fi
+
+new "wait backend"
+wait_backend
+
+new "1. Add z: main plugin not called"
+commit "<z xmlns='urn:example:clixon'><c>1</c></z>"
+checktrans nacm_commit 1
+checktrans main_begin 0
+checktrans main_commit 0
+
+new "2. Add x: main plugin called"
+commit "<x xmlns='urn:example:clixon'><y><a>1</a></y></x>"
+checktrans nacm_commit 2
+checktrans main_begin 1
+checktrans main_validate 1
+checktrans main_commit 1
+checktrans main_end 1
+
+new "3. Change leaf below x: main plugin called"
+commit "<x xmlns='urn:example:clixon'><y><a>1</a><b>2</b></y></x>"
+checktrans nacm_commit 3
+checktrans main_commit 2
+
+new "4. Change z: main plugin not called"
+commit "<z xmlns='urn:example:clixon'><c>2</c></z>"
+checktrans nacm_commit 4
+checktrans main_commit 2
+checktrans main_end 2
+
+new "5. Delete x and change z: main plugin called, also at end"
+commit "<x xmlns='urn:example:clixon' xmlns:nc='${BASENS}' nc:operation='delete'/><z xmlns='urn:example:clixon'><c>3</c></z>"
+checktrans nacm_commit 5
+checktrans main_commit 3
+checktrans main_end 3
+
+new "get-config running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><z xmlns=\"urn:example:clixon\"><c>3</c></z></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
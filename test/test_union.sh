@@ -1,6 +1,7 @@
 #!/usr/bin/env bash
 # Advanced union types and generated code
 # and enum w values
+# Validation of nested unions, where the member types are cached in the union type
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -45,6 +46,14 @@ module example3{
   typedef t{
     type string;
   }
+  typedef n{
+     type union {
+       type u;
+       type string{
+          pattern '[a-z]+';
+       }
+     }
+  }
 }
 EOF
 cat <<EOF > $fyang2
@@ -59,6 +68,9 @@ module example2{
     leaf ulle{
       type ex3:u;
     }
+    leaf-list nlle{
+      type ex3:n;
+    }
   }
 }
 EOF
@@ -99,6 +111,30 @@ expectpart "$($clixon_cli -1f $cfg -l o set c ulle 33)" 0 "^$"
 new "cli set transitive union error"
 expectpart "$($clixon_cli -1f $cfg -l o set c ulle kalle)" 255 "^CLI syntax error: \"set c ulle kalle\": 'kalle' is not a number$"
 
+# Set a value of the nested union in candidate and validate
+# 1: value
+# 2: expected validate reply
+union_validate(){
+    new "netconf edit nested union $1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><nlle>$1</nlle></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    new "netconf validate nested union $1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "$2" ""
+    new "netconf discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+union_validate 4 "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+union_validate unbounded "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+union_validate abc "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+union_validate 45 "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag><error-info><bad-element>nlle</bad-element></error-info><error-severity>error</error-severity><error-message>regexp match fail:"
+union_validate ABC "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag><error-info><bad-element>nlle</bad-element></error-info>"
+
+new "netconf edit nested union several"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><nlle>44</nlle><nlle>x</nlle><nlle>unbounded</nlle></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf validate nested union several"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
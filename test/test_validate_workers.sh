@@ -0,0 +1,132 @@
+#!/usr/bin/env bash
+# Validation of top-level nodes in worker processes, see CLICON_VALIDATE_WORKERS
+# Commit a configuration large enough to be validated in workers, with a leafref from one
+# top-level node to another, and check that errors are the same as without workers
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/workers.yang
+
+# Number of list entries in each top-level node
+: ${perfnr:=2000}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_VALIDATE_WORKERS>4</CLICON_VALIDATE_WORKERS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module workers{
+  yang-version 1.1;
+  namespace "urn:example:workers";
+  prefix w;
+  container a{
+    list entry{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf value{
+        type uint32;
+      }
+    }
+  }
+  container b{
+    list entry{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf ref{
+        type leafref{
+          path "/w:a/w:entry/w:name";
+        }
+      }
+    }
+  }
+  container c{
+    leaf x{
+      type string;
+    }
+  }
+}
+EOF
+
+config="<a xmlns=\"urn:example:workers\">"
+for (( i=0; i<$perfnr; i++ )); do
+    config+="<entry><name>e$i</name><value>$i</value></entry>"
+done
+config+="</a><b xmlns=\"urn:example:workers\">"
+for (( i=0; i<$perfnr; i++ )); do
+    config+="<entry><name>e$i</name><ref>e$i</ref></entry>"
+done
+config+="</b><c xmlns=\"urn:example:workers\"><x>foo</x></c>"
+
+# Commit config with and without workers
+# 1: extra backend options
+workers_run(){
+    new "test params: -f $cfg $1"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg $1"
+        start_backend -s init -f $cfg $1
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "edit-config $perfnr entries"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$config</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "delete leafref target"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><a xmlns=\"urn:example:workers\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><entry nc:operation=\"delete\"><name>e$(($perfnr-1))</name></entry></a></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate leafref error"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>data-missing</error-tag>" "Leafref validation failed: No leaf e$(($perfnr-1)) matching path /w:a/w:entry/w:name"
+
+    new "discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate ok"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+new "validate in workers"
+workers_run
+
+new "validate in backend"
+workers_run "-o CLICON_VALIDATE_WORKERS=0"
+
+rm -rf $dir
+
+new "endtest"
+endtest
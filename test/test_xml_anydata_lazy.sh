@@ -0,0 +1,132 @@
+#!/usr/bin/env bash
+# Unparsed anydata content, see CLICON_XML_ANYDATA_LAZY
+# Start backend with anydata in startup, check that the content is returned as is, that
+# xpath selects nodes inside it, and that it survives edits of other nodes and a restart
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/lazy.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_XML_SCANNER>true</CLICON_XML_SCANNER>
+  <CLICON_XML_ANYDATA_LAZY>true</CLICON_XML_ANYDATA_LAZY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module lazy{
+  yang-version 1.1;
+  namespace "urn:example:lazy";
+  prefix l;
+  container devices{
+    list device{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf descr{
+        type string;
+      }
+      anydata blob;
+    }
+  }
+}
+EOF
+
+# Anydata content with nested elements, attributes, prefixes, entities and empty elements
+blob1="<x xmlns=\"urn:example:x\"><y a=\"1&gt;2\">foo &amp; bar</y><y a=\"b\"/><z><w>42</w></z></x>"
+blob2="<p:q xmlns:p=\"urn:example:p\"><p:r>1</p:r><p:r>2</p:r></p:q>"
+dev1="<device><name>d1</name><descr>one</descr><blob>$blob1</blob></device>"
+dev2="<device><name>d2</name><blob>$blob2</blob></device>"
+echo "<config><devices xmlns=\"urn:example:lazy\">$dev1$dev2</devices></config>" > $dir/startup_db
+
+# Start backend in startup mode
+# 1: extra backend options
+lazy_start(){
+    new "test params: -f $cfg -s startup $1"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s startup -f $cfg $1"
+        start_backend -s startup -f $cfg $1
+    fi
+
+    new "wait backend"
+    wait_backend
+}
+
+lazy_stop(){
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+lazy_start
+
+new "get-config running anydata as is"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><devices xmlns=\"urn:example:lazy\">$dev1$dev2</devices></data></rpc-reply>"
+
+new "xpath into anydata content"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/l:devices/l:device[l:name='d1']/l:blob/x:x/x:z\" xmlns:l=\"urn:example:lazy\" xmlns:x=\"urn:example:x\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><devices xmlns=\"urn:example:lazy\"><device><name>d1</name><blob><x xmlns=\"urn:example:x\"><z><w>42</w></z></x></blob></device></devices></data></rpc-reply>"
+
+new "edit other leaf"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><devices xmlns=\"urn:example:lazy\"><device><name>d2</name><descr>two</descr></device></devices></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+dev2="<device><name>d2</name><descr>two</descr><blob>$blob2</blob></device>"
+
+new "get-config running after commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><devices xmlns=\"urn:example:lazy\">$dev1$dev2</devices></data></rpc-reply>"
+
+new "replace anydata"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><devices xmlns=\"urn:example:lazy\"><device><name>d1</name><blob><x xmlns=\"urn:example:x\"><z>new</z></x></blob></device></devices></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+dev1="<device><name>d1</name><descr>one</descr><blob><x xmlns=\"urn:example:x\"><z>new</z></x></blob></device>"
+
+new "get-config replaced anydata"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><devices xmlns=\"urn:example:lazy\">$dev1$dev2</devices></data></rpc-reply>"
+
+new "copy running to startup"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><copy-config><target><startup/></target><source><running/></source></copy-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+lazy_stop
+
+new "restart without lazy anydata"
+lazy_start "-o CLICON_XML_ANYDATA_LAZY=false"
+
+new "get-config running after restart"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><devices xmlns=\"urn:example:lazy\">$dev1$dev2</devices></data></rpc-reply>"
+
+lazy_stop
+
+sudo rm -rf $dir
+
+new "endtest"
+endtest
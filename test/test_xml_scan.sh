@@ -0,0 +1,192 @@
+#!/usr/bin/env bash
+# Test: hand-written XML scanner, see CLICON_XML_SCANNER
+# Parse with the lex/yacc parser and with the scanner (clixon_util_xml -S) and check that
+# the output and exit status are the same, for valid and invalid XML
+# With yang, the scanner binds and sorts while parsing
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml"}
+
+fxml=$dir/large.xml
+fyang=$dir/scan.yang
+
+# Number of list entries in large file
+: ${perfnr:=1000}
+
+cat <<EOF > $fyang
+module scan{
+  yang-version 1.1;
+  namespace "urn:example:scan";
+  prefix s;
+  container c{
+    list l{
+      key "k";
+      leaf k{
+        type uint32;
+      }
+      leaf v{
+        type string;
+      }
+    }
+    leaf-list ll{
+      type string;
+    }
+    leaf x{
+      type string;
+    }
+    anydata ad;
+  }
+  container st{
+    config false;
+    list l{
+      key "k";
+      leaf k{
+        type uint32;
+      }
+    }
+  }
+}
+EOF
+
+# Parse input with both parsers and compare
+# 1: XML input
+# 2: Extra options, eg yang
+scan_cmp(){
+    input=$1
+    opts=$2
+    new "scan: $opts $input"
+    ret0=$(echo -n "$input" | $clixon_util_xml -o $opts 2> /dev/null)
+    r0=$?
+    ret1=$(echo -n "$input" | $clixon_util_xml -S -o $opts 2> /dev/null)
+    r1=$?
+    if [ $r0 -ne $r1 ]; then
+        err "status $r0" "status $r1"
+    fi
+    if [ $r0 -eq 0 -a "$ret0" != "$ret1" ]; then
+        err "$ret0" "$ret1"
+    fi
+}
+
+# Valid XML
+scan_cmp "<a/>"
+scan_cmp "<a><b/></a>"
+scan_cmp "<a>x</a>"
+scan_cmp "<a> <b>x y</b> <c/> </a>"
+scan_cmp "<a>text<b/>more</a>"
+scan_cmp "<_-><b0.><c-.-._/></b0.></_->"
+scan_cmp "<a x=\"1\" y='2'><b z=\"a&amp;b\"/></a>"
+scan_cmp "<a xmlns=\"urn:example:a\" xmlns:p=\"urn:example:p\"><p:b>x</p:b></a>"
+scan_cmp "<a >x</a >"
+scan_cmp "<a><!-- comment --><b/><!----></a>"
+scan_cmp "<a><b>x<!-- comment -->y</b></a>"
+scan_cmp "<a><?pi stuff?><b/></a>"
+scan_cmp "<a><![CDATA[<not>&xml;]]></a>"
+scan_cmp "<a>x<![CDATA[]]>y</a>"
+scan_cmp "<a>&amp;&lt;&gt;&apos;&quot;</a>"
+scan_cmp "<a>&#65;&#x42;</a>"
+scan_cmp "<a>
+  <b>x</b>
+</a>"
+scan_cmp "<a>x
+y</a>"
+scan_cmp "<?xml version=\"1.0\"?><a/>"
+scan_cmp "<?xml version=\"1.0\" encoding=\"UTF-8\"?>
+<a><b/></a>
+"
+scan_cmp "<?xml version='1.0' encoding='UTF-8' standalone='yes'?><a/>"
+scan_cmp "<a/><b/>"
+scan_cmp "<a/><!-- comment --><b/>"
+scan_cmp "<a/> <?pi x?> <b/>"
+
+# Invalid XML
+scan_cmp ""
+scan_cmp "<-a/>"
+scan_cmp "<9/>"
+scan_cmp "<a>"
+scan_cmp "<a></b>"
+scan_cmp "<p:a></q:a>"
+scan_cmp "<a x=1/>"
+scan_cmp "<a x=\"1/>"
+scan_cmp "<a/ >"
+scan_cmp "<a>&foo;</a>"
+scan_cmp "<a>&amp</a>"
+scan_cmp "<a><!-- comment </a>"
+scan_cmp "<a><![CDATA[x</a>"
+scan_cmp "<?xml version=\"2.0\"?><a/>"
+scan_cmp "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?><a/>"
+scan_cmp "<?xml version=\"1.0\"?><a/><b/>"
+scan_cmp "<a/><?xml version=\"1.0\"?>"
+scan_cmp "<a><?pi?></a>"
+
+# Bind and sort while parsing
+ns="xmlns=\"urn:example:scan\""
+scan_cmp "<c $ns><x>a</x><l><k>3</k></l><l><k>1</k><v>x</v></l><ll>b</ll><ll>a</ll></c>" "-y $fyang"
+scan_cmp "<c $ns><l><k>1</k></l><l><k>2</k></l><l><k>10</k></l></c>" "-y $fyang"
+scan_cmp "<c $ns>text<x>a</x></c>" "-y $fyang"
+scan_cmp "<c $ns>text</c>" "-y $fyang"
+scan_cmp "<c $ns><ad><z>1</z><y/></ad></c>" "-y $fyang"
+scan_cmp "<st $ns><l><k>3</k></l><l><k>1</k></l></st>" "-y $fyang"
+scan_cmp "<st $ns/><c $ns/>" "-y $fyang"
+scan_cmp "<s:c xmlns:s=\"urn:example:scan\"><s:x>a</s:x></s:c>" "-y $fyang"
+scan_cmp "<c $ns><l x=\"1\"><k>2</k></l><l><k>1</k></l></c>" "-y $fyang"
+# Binding not made
+scan_cmp "<c $ns><y/></c>" "-y $fyang"
+scan_cmp "<c xmlns=\"urn:example:other\"/>" "-y $fyang"
+scan_cmp "<c><x>a</x></c>" "-y $fyang"
+scan_cmp "<y $ns/>" "-y $fyang"
+
+new "generate large file with $perfnr entries"
+echo -n "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" > $fxml
+echo "<x xmlns=\"urn:example:x\"><!-- large -->" >> $fxml
+for (( i=0; i<$perfnr; i++ )); do
+    echo "  <y k=\"$i\"><a>$i</a><b>x&amp;$i&lt;</b><c><![CDATA[<$i>]]></c><d/></y>" >> $fxml
+done
+echo "</x>" >> $fxml
+
+new "parse large file"
+ret0=$($clixon_util_xml -o -f $fxml)
+if [ $? -ne 0 ]; then
+    err "0" "$?"
+fi
+
+new "scan large file"
+ret1=$($clixon_util_xml -S -o -f $fxml)
+if [ $? -ne 0 ]; then
+    err "0" "$?"
+fi
+
+new "compare large file"
+if [ "$ret0" != "$ret1" ]; then
+    err "$ret0" "$ret1"
+fi
+
+new "generate large unsorted file with $perfnr entries"
+echo "<c $ns>" > $fxml
+for (( i=$perfnr; i>0; i-- )); do
+    echo "  <l><k>$i</k><v>v$i</v></l>" >> $fxml
+done
+echo "</c>" >> $fxml
+
+new "parse and bind large file"
+ret0=$($clixon_util_xml -o -y $fyang -f $fxml)
+if [ $? -ne 0 ]; then
+    err "0" "$?"
+fi
+
+new "scan and bind large file"
+ret1=$($clixon_util_xml -S -o -y $fyang -f $fxml)
+if [ $? -ne 0 ]; then
+    err "0" "$?"
+fi
+
+new "compare large bound file"
+if [ "$ret0" != "$ret1" ]; then
+    err "$ret0" "$ret1"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
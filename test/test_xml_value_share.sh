@@ -0,0 +1,107 @@
+#!/usr/bin/env bash
+# Large leaf values shared between copies of a tree, see XML_VALUE_SHARE
+# Write, commit, change and read large binary and string leafs
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/share.yang
+
+# Length of large values, larger than XML_VALUE_SHARE
+: ${perfnr:=8000}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module share{
+  yang-version 1.1;
+  namespace "urn:example:share";
+  prefix s;
+  container blobs{
+    list blob{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf data{
+        type binary;
+      }
+      leaf text{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+v1=$(head -c $perfnr /dev/zero | tr '\0' 'A')
+v2=$(head -c $perfnr /dev/zero | tr '\0' 'B')
+t1=$(head -c $perfnr /dev/zero | tr '\0' 'x')
+# Same length and prefix as t1, differs at the end
+t2="${t1:1}y"
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit-config large values"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><blobs xmlns=\"urn:example:share\"><blob><name>a</name><data>$v1</data><text>$t1</text></blob><blob><name>b</name><data>$v1</data><text>$t1</text></blob></blobs></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><blobs xmlns=\"urn:example:share\"><blob><name>a</name><data>$v1</data><text>$t1</text></blob><blob><name>b</name><data>$v1</data><text>$t1</text></blob></blobs></data></rpc-reply>"
+
+new "change one binary and one string of same length"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><blobs xmlns=\"urn:example:share\"><blob><name>a</name><data>$v2</data></blob><blob><name>b</name><text>$t2</text></blob></blobs></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config running changed"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><blobs xmlns=\"urn:example:share\"><blob><name>a</name><data>$v2</data><text>$t1</text></blob><blob><name>b</name><data>$v1</data><text>$t2</text></blob></blobs></data></rpc-reply>"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config candidate equal to running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><blobs xmlns=\"urn:example:share\"><blob><name>a</name><data>$v2</data><text>$t1</text></blob><blob><name>b</name><data>$v1</data><text>$t2</text></blob></blobs></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,110 @@
+#!/usr/bin/env bash
+# Test xpath cache, see XPATH_CACHE
+# Evaluate the same xpath filter repeatedly and check that cache hits increase and that
+# the result is the same.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/cache.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module cache{
+  yang-version 1.1;
+  namespace "urn:example:cache";
+  prefix c;
+  container c{
+    list y{
+      key k;
+      leaf k{
+        type int32;
+      }
+      leaf v{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $dir/running_db
+<${DATASTORE_TOP}><c xmlns="urn:example:cache"><y><k>1</k><v>one</v></y><y><k>2</k><v>two</v></y></c></${DATASTORE_TOP}>
+EOF
+
+# Get global stats counter
+# @param[in] name  Name of counter, eg xpathcachehits
+function stats_get()
+{
+    name=$1
+    rpc=$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")
+    res=$(echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg)
+    echo "$res" | $clixon_util_xpath -p "/rpc-reply/global/$name" | awk -F ">" '{print $2}' | awk -F "<" '{print $1}'
+}
+
+new "test params: -s running -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend"
+    start_backend -s running -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "get-config with xpath filter"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/c:c/c:y[c:v='two']\" xmlns:c=\"urn:example:cache\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:cache\"><y><k>2</k><v>two</v></y></c></data></rpc-reply>"
+
+new "get xpath cache hits"
+hits0=$(stats_get xpathcachehits)
+if [ -z "$hits0" ]; then
+    err "xpathcachehits" "$hits0"
+fi
+
+new "get-config with same xpath filter"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/c:c/c:y[c:v='two']\" xmlns:c=\"urn:example:cache\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:cache\"><y><k>2</k><v>two</v></y></c></data></rpc-reply>"
+
+new "check xpath cache hits increased"
+hits1=$(stats_get xpathcachehits)
+if [ -z "$hits1" ] || [ $hits1 -le $hits0 ]; then
+    err "xpathcachehits > $hits0" "$hits1"
+fi
+
+new "check xpath cache entries"
+nr=$(stats_get xpathcachenr)
+if [ -z "$nr" ] || [ $nr -eq 0 ]; then
+    err "xpathcachenr > 0" "$nr"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,145 @@
+#!/usr/bin/env bash
+# Test of xpath deref() function in must constraints
+# Leafrefs to list keys are looked up with the list key index
+# Instance-identifiers, also with key predicates in other order than the yang keys
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/deref.yang
+
+# Number of list entries
+: ${perfnr:=100}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module deref{
+  yang-version 1.1;
+  namespace "urn:example:deref";
+  prefix d;
+  container interfaces{
+    list interface{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf type{
+        type string;
+      }
+    }
+  }
+  container routes{
+    list route{
+      key "a b";
+      leaf a{
+        type string;
+      }
+      leaf b{
+        type string;
+      }
+      leaf c{
+        type string;
+      }
+    }
+  }
+  container mgmt{
+    leaf ifref{
+      type leafref{
+        path "../../interfaces/interface/name";
+      }
+      must "deref(.)/../type = 'eth'"{
+        error-message "ifref is not eth";
+      }
+    }
+    leaf iiref{
+      type instance-identifier;
+      must "deref(.) = 'x'"{
+        error-message "iiref is not x";
+      }
+    }
+  }
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+config="<interfaces xmlns=\"urn:example:deref\">"
+for (( i=0; i<$perfnr; i++ )); do
+    config+="<interface><name>e$i</name><type>eth</type></interface>"
+done
+config+="<interface><name>lo</name><type>loopback</type></interface></interfaces>"
+config+="<routes xmlns=\"urn:example:deref\"><route><a>1</a><b>2</b><c>x</c></route><route><a>2</a><b>1</b><c>y</c></route></routes>"
+
+new "edit-config $perfnr interfaces and routes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$config</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "leafref to last eth interface"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><mgmt xmlns=\"urn:example:deref\"><ifref>e$(($perfnr-1))</ifref></mgmt></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "validate deref leafref ok"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "leafref to loopback interface"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><mgmt xmlns=\"urn:example:deref\"><ifref>lo</ifref></mgmt></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "validate deref leafref fail"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error>" "ifref is not eth"
+
+new "instance-identifier to route with keys in yang order"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><mgmt xmlns=\"urn:example:deref\" xmlns:d=\"urn:example:deref\"><ifref>e0</ifref><iiref>/d:routes/d:route[d:a='1'][d:b='2']/d:c</iiref></mgmt></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "validate deref instance-identifier ok"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "instance-identifier to route with keys in other order"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><mgmt xmlns=\"urn:example:deref\" xmlns:d=\"urn:example:deref\"><iiref>/d:routes/d:route[d:b='2'][d:a='1']/d:c</iiref></mgmt></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "validate deref instance-identifier other order ok"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "instance-identifier to other route"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><mgmt xmlns=\"urn:example:deref\" xmlns:d=\"urn:example:deref\"><iiref>/d:routes/d:route[d:b='1'][d:a='2']/d:c</iiref></mgmt></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "validate deref instance-identifier fail"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error>" "iiref is not x"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,139 @@
+#!/usr/bin/env bash
+# Test xpath list optimization, see XPATH_LIST_OPTIMIZE
+# Lookups that are optimized with binary search should give the same result as
+# regular xpath evaluation:
+# - Chained lists: a[k='x']/b[k1='1'][k2='2']
+# - Keys given in any order and combined with "and"
+# - Leaf-list values: ll[.='x']
+# - Non-optimized predicates: "or", positions and non-key equalities
+# - Counting and indexing lists without node-sets: count(b), b[1], b[last()]
+# - Descendant queries skipping subtrees by yang, see XPATH_SCHEMA_PRUNE: //v
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xpath:=clixon_util_xpath}
+
+xml=$dir/opt.xml
+fyang=$dir/opt.yang
+
+cat <<EOF > $fyang
+module opt{
+  yang-version 1.1;
+  namespace "urn:example:opt";
+  prefix o;
+  container c{
+    list a{
+      key k;
+      leaf k{
+        type string;
+      }
+      list b{
+        key "k1 k2";
+        leaf k1{
+          type int32;
+        }
+        leaf k2{
+          type string;
+        }
+        leaf v{
+          type string;
+        }
+      }
+      leaf-list ll{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+# Unsorted, the tree is sorted after yang binding
+cat <<EOF > $xml
+<c xmlns="urn:example:opt">
+  <a><k>y</k>
+    <b><k1>2</k1><k2>b</k2><v>y2b</v></b>
+    <b><k1>1</k1><k2>a</k2><v>y1a</v></b>
+    <ll>q</ll>
+    <ll>p</ll>
+  </a>
+  <a><k>x</k>
+    <b><k1>10</k1><k2>a</k2><v>x10a</v></b>
+    <b><k1>1</k1><k2>b</k2><v>x1b</v></b>
+    <b><k1>1</k1><k2>a</k2><v>x1a</v></b>
+    <ll>r</ll>
+    <ll>p</ll>
+  </a>
+</c>
+EOF
+
+new "chained lists"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[k='x']/b[k1='1'][k2='b']/v")" 0 "^nodeset:0:<v>x1b</v>$"
+
+new "chained lists keys in reverse order"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[k='y']/b[k2='a'][k1='1']/v")" 0 "^nodeset:0:<v>y1a</v>$"
+
+new "keys combined with and"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[k='x']/b[k2='a' and k1=10]/v")" 0 "^nodeset:0:<v>x10a</v>$"
+
+new "keys in several parent list entries"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a/b[k1='1' and k2='a']/v")" 0 "^nodeset:0:<v>x1a</v>1:<v>y1a</v>$"
+
+new "keys and non-key equality"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[k='x']/b[k1='1'][k2='a'][v='nomatch']")" 0 "^nodeset:$"
+
+new "keys with or"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[k='x']/b[k1='1' and k2='b' or k1='10']/v")" 0 "^nodeset:0:<v>x1b</v>1:<v>x10a</v>$"
+
+new "position and key"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[1][k='y']")" 0 "^nodeset:$"
+
+new "leaf-list value"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a/ll[.='p']")" 0 "^nodeset:0:<ll>p</ll>1:<ll>p</ll>$"
+
+new "leaf-list no value"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[k='y']/ll[.='r']")" 0 "^nodeset:$"
+
+new "count list"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "count(/c/a[k='x']/b)")" 0 "^number:3$"
+
+new "count list in several parent list entries"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "count(/c/a/b)")" 0 "^number:5$"
+
+new "count leaf-list"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "count(/c/a/ll)")" 0 "^number:4$"
+
+new "count list in predicate"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[count(b)=2]/k")" 0 "^nodeset:0:<k>y</k>$"
+
+new "count list with predicate"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "count(/c/a/b[k1='1'])")" 0 "^number:3$"
+
+new "list position"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[k='x']/b[1]/v")" 0 "^nodeset:0:<v>x1b</v>$"
+
+new "list position out of range"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[k='x']/b[3]")" 0 "^nodeset:$"
+
+new "list last"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[k='x']/b[last()]/v")" 0 "^nodeset:0:<v>x10a</v>$"
+
+new "leaf-list last"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[k='y']/ll[last()]")" 0 "^nodeset:0:<ll>q</ll>$"
+
+new "last in several parent list entries"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a/b[last()]/v")" 0 "^nodeset:0:<v>y2b</v>$"
+
+new "descendant leaf"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "//v")" 0 "^nodeset:0:<v>x1a</v>1:<v>x1b</v>2:<v>x10a</v>3:<v>y1a</v>4:<v>y2b</v>$"
+
+new "descendant leaf-list below list"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "/c/a[k='y']//ll")" 0 "^nodeset:0:<ll>p</ll>1:<ll>q</ll>$"
+
+new "descendant not in yang"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:opt -p "//nomatch")" 0 "^nodeset:$"
+
+rm -rf $dir
+
+new "endtest"
+endtest
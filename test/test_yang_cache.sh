@@ -0,0 +1,193 @@
+#!/usr/bin/env bash
+# Yang spec cache, see CLICON_YANG_CACHE_DIR
+# Start the backend once to save the cache, then again to load it
+# Check that the cache is not used if a yang file is changed or added, an option is changed,
+# or the cache file is malformed
+# Then run the backend and netconf from the cache and validate ranges and patterns
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+ydir=$dir/yang
+cdir=$dir/cache
+fyang=$ydir/cache.yang
+
+test -d $ydir || mkdir $ydir
+test -d $cdir || mkdir $cdir
+
+# Yang files are not in the datastore dir, since a changed yang directory invalidates the cache
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$ydir</CLICON_YANG_MAIN_DIR>
+  <CLICON_YANG_CACHE_DIR>$cdir</CLICON_YANG_CACHE_DIR>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module cache{
+  yang-version 1.1;
+  namespace "urn:example:cache";
+  prefix c;
+  import ietf-inet-types {
+    prefix inet;
+  }
+  typedef percent{
+    type uint8{
+      range "0..100";
+    }
+  }
+  container c{
+    leaf p{
+      type percent;
+      default 50;
+    }
+    leaf d{
+      type decimal64{
+        fraction-digits 2;
+        range "-1.5..1.5";
+      }
+    }
+    leaf s{
+      type string{
+        pattern '[a-z]+';
+        length "1..4";
+      }
+    }
+    leaf a{
+      type inet:ipv4-address;
+    }
+    list l{
+      key "k";
+      leaf k{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+# Start backend once with debug and check if cache is loaded or saved
+# 1: expected debug message
+backend_once(){
+    expectpart "$(sudo $clixon_backend -1 -s init -f $cfg -D 1 -l e $2 2>&1)" 0 "$1"
+}
+
+# Set a value in candidate and validate
+# 1: xml
+# 2: expected reply
+candidate_validate(){
+    new "netconf edit $1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:cache\">$1</c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    new "netconf validate $1"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "$2" ""
+    new "netconf discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+new "backend saves cache"
+backend_once "yang_spec_cache_save saved $cdir/backend.ycache"
+
+new "cache file exists"
+if [ ! -f $cdir/backend.ycache ]; then
+    err "$cdir/backend.ycache" ""
+fi
+
+new "backend loads cache"
+backend_once "yang_spec_cache_load loaded $cdir/backend.ycache"
+
+new "yang file changed"
+sed -i 's/range "0..100"/range "0..99"/' $fyang
+backend_once "yang_spec_cache_save saved"
+
+new "backend loads new cache"
+backend_once "yang_spec_cache_load loaded"
+
+new "yang file added"
+cat <<EOF > $ydir/extra.yang
+module extra{
+  namespace "urn:example:extra";
+  prefix e;
+  leaf x{
+    type string;
+  }
+}
+EOF
+backend_once "yang_spec_cache_save saved"
+
+new "option changed"
+backend_once "yang_spec_cache_save saved" "-o CLICON_MODULE_SET_ID=42"
+
+new "option changed back"
+backend_once "yang_spec_cache_save saved"
+
+new "malformed cache"
+sudo truncate -s 100 $cdir/backend.ycache
+backend_once "yang_spec_cache_save saved"
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "netconf saves cache"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "netconf cache file exists"
+if [ ! -f $cdir/netconf.ycache ]; then
+    err "$cdir/netconf.ycache" ""
+fi
+
+new "netconf edit valid"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:cache\"><d>-1.25</d><s>abc</s><a>10.0.0.1</a><l><k>b</k></l><l><k>a</k></l></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf validate"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf get sorted with default"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><with-defaults xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-with-defaults\">report-all</with-defaults></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:cache\"><p>50</p><d>-1.25</d><s>abc</s><a>10.0.0.1</a><l><k>a</k></l><l><k>b</k></l></c></data></rpc-reply>"
+
+new "netconf discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+# Changed range of typedef
+candidate_validate "<p>100</p>" "Number 100 out of range: 0 - 99"
+
+candidate_validate "<d>1.75</d>" "<rpc-reply $DEFAULTNS><rpc-error>"
+
+candidate_validate "<s>ab1</s>" "regexp match fail:"
+
+# Pattern in imported module
+candidate_validate "<a>10.0.0.x</a>" "regexp match fail:"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+sudo rm -rf $dir
+
+new "endtest"
+endtest
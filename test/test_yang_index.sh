@@ -0,0 +1,95 @@
+#!/usr/bin/env bash
+# Test: hash index of YANG child statements, see YANG_INDEX
+# A container with more children than YANG_INDEX_THRESHOLD, with data nodes in choice/case,
+# augmented from a second module. Bind XML to nodes found through the index, and to unknown
+# nodes added as anydata after the index is built
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml"}
+
+ydir=$dir/yang
+fyang=$ydir/index.yang
+fyang2=$ydir/index2.yang
+
+# Number of leafs in container
+: ${perfnr:=100}
+
+if [ ! -d $ydir ]; then
+    mkdir $ydir
+fi
+
+echo "module index{" > $fyang
+echo "  yang-version 1.1;" >> $fyang
+echo "  namespace \"urn:example:index\";" >> $fyang
+echo "  prefix i;" >> $fyang
+echo "  container c{" >> $fyang
+for (( i=0; i<$perfnr; i++ )); do
+    echo "    leaf l$i{ type int32; }" >> $fyang
+done
+cat <<EOF >> $fyang
+    choice ch{
+      case a{
+        leaf x{ type string; }
+        choice ch2{
+          leaf y{ type string; }
+        }
+      }
+      leaf z{ type string; }
+    }
+    list e{
+      key k;
+      leaf k{ type string; }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $fyang2
+module index2{
+  yang-version 1.1;
+  namespace "urn:example:index2";
+  prefix i2;
+  import index{
+    prefix i;
+  }
+  augment "/i:c"{
+    leaf w{ type string; }
+    leaf l0{ type string; }
+  }
+}
+EOF
+
+ns="xmlns=\"urn:example:index\""
+ns2="xmlns=\"urn:example:index2\""
+last=$(( $perfnr - 1 ))
+
+new "bind first and last leaf"
+expecteof "$clixon_util_xml -y $ydir -vo" 0 "<c $ns><l0>1</l0><l$last>2</l$last></c>" "^<c $ns><l0>1</l0><l$last>2</l$last></c>$"
+
+new "bind leafs in case and nested choice"
+expecteof "$clixon_util_xml -y $ydir -vo" 0 "<c $ns><x>a</x><y>b</y></c>" "^<c $ns><x>a</x><y>b</y></c>$"
+
+new "bind leaf in short-hand case"
+expecteof "$clixon_util_xml -y $ydir -vo" 0 "<c $ns><z>a</z></c>" "^<c $ns><z>a</z></c>$"
+
+new "bind list"
+expecteof "$clixon_util_xml -y $ydir -vo" 0 "<c $ns><e><k>b</k></e><e><k>a</k></e></c>" "^<c $ns><e><k>a</k></e><e><k>b</k></e></c>$"
+
+new "bind augmented leafs"
+expectpart "$(echo "<c $ns><w $ns2>a</w><l0 $ns2>b</l0><l0>3</l0></c>" | $clixon_util_xml -y $ydir -vo)" 0 "<w $ns2>a</w>" "<l0 $ns2>b</l0>" "<l0>3</l0>"
+
+new "choice name is not a data node"
+expecteof "$clixon_util_xml -y $ydir -vo" 255 "<c $ns><ch>a</ch></c>" 2> /dev/null
+
+new "unknown node"
+expecteof "$clixon_util_xml -y $ydir -vo" 255 "<c $ns><l$perfnr>1</l$perfnr></c>" 2> /dev/null
+
+new "unknown nodes as anydata"
+expectpart "$(echo "<c $ns><u>1</u><u>2</u><l1>3</l1></c>" | $clixon_util_xml -uy $ydir -o)" 0 "<u>1</u><u>2</u>" "<l1>3</l1>"
+
+rm -rf $dir
+
+new "endtest"
+endtest
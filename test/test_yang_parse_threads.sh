@@ -0,0 +1,192 @@
+#!/usr/bin/env bash
+# Parallel parsing of yang files in CLICON_YANG_MAIN_DIR, see CLICON_YANG_PARSE_THREADS
+# Many modules importing and augmenting a common module, with groupings, if-features and musts
+# which are checked by sub-parsers after the parallel parse
+# Check that the newest revision is loaded and that parse errors in a thread are reported
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+ydir=$dir/yang
+idir=$dir/import
+
+# Number of modules in main dir
+: ${nr:=20}
+
+test -d $ydir || mkdir $ydir
+test -d $idir || mkdir $idir
+rm -f $ydir/*
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>*:*</CLICON_FEATURE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$idir</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$ydir</CLICON_YANG_MAIN_DIR>
+  <CLICON_YANG_PARSE_THREADS>4</CLICON_YANG_PARSE_THREADS>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $idir/base.yang
+module base{
+  yang-version 1.1;
+  namespace "urn:example:base";
+  prefix b;
+  typedef percent{
+    type uint8{
+      range "0..100";
+    }
+  }
+  container top{
+  }
+}
+EOF
+
+for (( i=0; i<$nr; i++ )); do
+    cat <<EOF > $ydir/m$i.yang
+module m$i{
+  yang-version 1.1;
+  namespace "urn:example:m$i";
+  prefix m$i;
+  import base{
+    prefix b;
+  }
+  feature f;
+  grouping g{
+    leaf x{
+      type b:percent;
+    }
+  }
+  container c{
+    uses g;
+    leaf y{
+      if-feature "f or not f";
+      must "string-length(.) < 4";
+      type string;
+    }
+  }
+  augment "/b:top"{
+    leaf a$i{
+      type uint8;
+    }
+  }
+}
+EOF
+done
+
+# The newest revision is loaded
+cat <<EOF > $ydir/rev@2020-01-01.yang
+module rev{
+  namespace "urn:example:rev";
+  prefix r;
+  revision 2020-01-01;
+  leaf old{
+    type string;
+  }
+}
+EOF
+
+cat <<EOF > $ydir/rev@2021-01-01.yang
+module rev{
+  namespace "urn:example:rev";
+  prefix r;
+  revision 2021-01-01;
+  leaf new{
+    type string;
+  }
+}
+EOF
+
+new "backend parses $nr modules in parallel"
+expectpart "$(sudo $clixon_backend -1 -s init -f $cfg -l o)" 0 ""
+
+new "backend parses $nr modules serially"
+expectpart "$(sudo $clixon_backend -1 -s init -f $cfg -l o -o CLICON_YANG_PARSE_THREADS=1)" 0 ""
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "netconf edit grouping and augment"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:m7\"><x>42</x><y>abc</y></c><top xmlns=\"urn:example:base\"><a12 xmlns=\"urn:example:m12\">7</a12></top><new xmlns=\"urn:example:rev\">x</new></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf validate"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf get augment"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/b:top\" xmlns:b=\"urn:example:base\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><top xmlns=\"urn:example:base\"><a12 xmlns=\"urn:example:m12\">7</a12></top></data></rpc-reply>"
+
+new "netconf edit old revision"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><old xmlns=\"urn:example:rev\">x</old></config></edit-config></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>unknown-element</error-tag>" ""
+
+new "netconf edit out of range"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:m3\"><x>101</x></c></config></edit-config></rpc>" "" ""
+
+new "netconf validate out of range"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "Number 101 out of range: 0 - 100" ""
+
+new "netconf discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+# Syntax error is found in a parse thread
+cat <<EOF > $ydir/bad.yang
+module bad{
+  namespace "urn:example:bad";
+  prefix bad
+  leaf x{
+    type string;
+  }
+}
+EOF
+
+new "syntax error in parse thread"
+expectpart "$(sudo $clixon_backend -1 -s init -f $cfg -l o)" 255 "$ydir/bad.yang on line"
+
+# If-feature error is found by the sub-parser after the parse
+cat <<EOF > $ydir/bad.yang
+module bad{
+  namespace "urn:example:bad";
+  prefix bad;
+  feature f;
+  leaf x{
+    if-feature "f and";
+    type string;
+  }
+}
+EOF
+
+new "if-feature error after parse thread"
+expectpart "$(sudo $clixon_backend -1 -s init -f $cfg -l o)" 255 "yang_sub_parse: file:$ydir/bad.yang"
+
+sudo rm -rf $dir
+
+new "endtest"
+endtest
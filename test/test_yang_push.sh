@@ -0,0 +1,122 @@
+#!/usr/bin/env bash
+# On-change and periodic push of running datastore, see clixon-lib datastore-push rpc
+# Subscribe in one netconf session, commit in another and check the push-change-update
+# yang-patch notifications
+# Periodic subscriptions check the push-update notifications
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+NCWAIT=5 # Time subscription session is open
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/push.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module push{
+  yang-version 1.1;
+  namespace "urn:example:push";
+  prefix p;
+  container interfaces{
+    list interface{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf mtu{
+        type uint32;
+      }
+    }
+  }
+  container other{
+    leaf x{
+      type string;
+    }
+  }
+}
+EOF
+
+# Edit and commit in another session in background
+# 1: delay
+# 2: config
+commit_bg(){
+    rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$2</config></edit-config></rpc>]]>]]><rpc $DEFAULTNS><commit/></rpc>]]>]]>"
+    (sleep $1; echo "$HELLONO11$rpc" | $clixon_netconf -qf $cfg > /dev/null) &
+}
+
+LIBNS="xmlns=\"http://clicon.org/lib\""
+PUSHNS="xmlns=\"urn:ietf:params:xml:ns:yang:ietf-yang-push\""
+PATCHNS="xmlns=\"urn:ietf:params:xml:ns:yang:ietf-yang-patch\""
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "datastore-push invalid xpath"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-push $LIBNS><datastore-xpath-filter>/p:[</datastore-xpath-filter></datastore-push></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>invalid-value</error-tag><error-severity>error</error-severity><error-message>Invalid datastore-xpath-filter</error-message></rpc-error></rpc-reply>"
+
+new "datastore-push create"
+commit_bg 2 "<interfaces xmlns=\"urn:example:push\"><interface><name>eth0</name><mtu>1400</mtu></interface></interfaces>"
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-push $LIBNS><datastore-xpath-filter xmlns:p=\"urn:example:push\">/p:interfaces</datastore-xpath-filter></datastore-push></rpc>" $NCWAIT "<rpc-reply $DEFAULTNS><id $LIBNS>[0-9]*</id></rpc-reply>" "<push-change-update $PUSHNS><id>[0-9]*</id><datastore-changes><yang-patch $PATCHNS><patch-id>0</patch-id><edit><edit-id>edit1</edit-id><operation>create</operation><target>/push:interfaces</target><value><interfaces xmlns=\"urn:example:push\"><interface><name>eth0</name><mtu>1400</mtu></interface></interfaces></value></edit></yang-patch></datastore-changes></push-change-update>"
+
+new "datastore-push replace leaf"
+commit_bg 2 "<interfaces xmlns=\"urn:example:push\"><interface><name>eth0</name><mtu>1500</mtu></interface></interfaces>"
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-push $LIBNS><datastore-xpath-filter xmlns:p=\"urn:example:push\">/p:interfaces/p:interface</datastore-xpath-filter></datastore-push></rpc>" $NCWAIT "<operation>replace</operation><target>/push:interfaces/interface=eth0/mtu</target><value><mtu xmlns=\"urn:example:push\">1500</mtu></value>"
+
+new "datastore-push filter other container"
+commit_bg 1 "<interfaces xmlns=\"urn:example:push\"><interface><name>eth1</name></interface></interfaces>"
+commit_bg 3 "<other xmlns=\"urn:example:push\"><x>foo</x></other>"
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-push $LIBNS><datastore-xpath-filter xmlns:p=\"urn:example:push\">/p:other</datastore-xpath-filter></datastore-push></rpc>" $NCWAIT "<operation>create</operation><target>/push:other</target>" --not-- "eth1"
+
+new "datastore-push delete list entry"
+commit_bg 2 "<interfaces xmlns=\"urn:example:push\"><interface nc:operation=\"delete\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><name>eth0</name></interface></interfaces>"
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-push $LIBNS><datastore-xpath-filter xmlns:p=\"urn:example:push\">/p:interfaces/p:interface[p:name='eth0']</datastore-xpath-filter></datastore-push></rpc>" $NCWAIT "<edit><edit-id>edit1</edit-id><operation>delete</operation><target>/push:interfaces/interface=eth0</target></edit>"
+
+new "datastore-push periodic"
+commit_bg 0 "<interfaces xmlns=\"urn:example:push\"><interface><name>eth2</name><mtu>9000</mtu></interface></interfaces>"
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-push $LIBNS><datastore-xpath-filter xmlns:p=\"urn:example:push\">/p:interfaces</datastore-xpath-filter><period>100</period></datastore-push></rpc>" $NCWAIT "<rpc-reply $DEFAULTNS><id $LIBNS>[0-9]*</id></rpc-reply>" "<push-update $PUSHNS><id>[0-9]*</id><datastore-contents><interfaces xmlns=\"urn:example:push\">" "<interface><name>eth2</name><mtu>9000</mtu></interface>" --not-- "push-change-update"
+
+new "datastore-push periodic filter"
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-push $LIBNS><datastore-xpath-filter xmlns:p=\"urn:example:push\">/p:other</datastore-xpath-filter><period>100</period></datastore-push></rpc>" $NCWAIT "<push-update $PUSHNS><id>[0-9]*</id><datastore-contents><other xmlns=\"urn:example:push\"><x>foo</x></other></datastore-contents></push-update>" --not-- "eth2"
+
+new "datastore-push period 0"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><datastore-push $LIBNS><datastore-xpath-filter xmlns:p=\"urn:example:push\">/p:other</datastore-xpath-filter><period>0</period></datastore-push></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
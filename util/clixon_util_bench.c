@@ -0,0 +1,804 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Microbenchmarks of core library functions on generated data
+  * A large list of nr entries in random order and a deep tree of depth levels are generated,
+  * each benchmark is run a number of warmup times, then timed a number of runs, and the
+  * min, percentiles, max and mean of the runs are printed
+  * Example:
+  *   clixon_util_bench -n 100000 -r 20
+  *   clixon_util_bench -b xpath -j
+  */
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include <time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon/clixon.h"
+
+/* Command line options to be passed to getopt(3) */
+#define BENCH_OPTS "hD:n:d:w:r:b:j"
+
+/* Number of lookups in each run of the search and xpath benchmarks */
+#define BENCH_LOOKUPS 100
+
+#define BENCH_NS "urn:example:bench"
+
+static char *bench_yang =
+    "module bench{"
+    "  yang-version 1.1;"
+    "  namespace \"" BENCH_NS "\";"
+    "  prefix b;"
+    "  container table{"
+    "    list parameter{"
+    "      key name;"
+    "      leaf name{"
+    "        type string;"
+    "      }"
+    "      leaf value{"
+    "        type uint32;"
+    "      }"
+    "    }"
+    "  }"
+    "}";
+
+/* Deny read of every value in the list with a path rule */
+static char *bench_nacm =
+    "<nacm xmlns=\"" NACM_NS "\">"
+    "<enable-nacm>true</enable-nacm>"
+    "<read-default>permit</read-default>"
+    "<write-default>deny</write-default>"
+    "<exec-default>permit</exec-default>"
+    "<groups><group><name>limited</name><user-name>bench</user-name></group></groups>"
+    "<rule-list><name>limited</name><group>limited</group>"
+    "<rule><name>deny-value</name><module-name>bench</module-name>"
+    "<path xmlns:b=\"" BENCH_NS "\">/b:table/b:parameter/b:value</path>"
+    "<access-operations>read</access-operations><action>deny</action></rule>"
+    "</rule-list>"
+    "</nacm>";
+
+/* Generated data shared by all benchmarks */
+struct bench_ctx {
+    clicon_handle bc_h;
+    yang_stmt    *bc_yspec;
+    int           bc_nr;     /* Number of list entries */
+    int           bc_depth;  /* Depth of deep tree */
+    int          *bc_perm;   /* Random permutation of 0..nr-1 */
+    cbuf         *bc_listxml;/* List as XML string, in random order */
+    cbuf         *bc_deepxml;/* Deep tree as XML string */
+    cbuf         *bc_json;   /* List as JSON string */
+    cxobj        *bc_xlist;  /* List bound to yang and sorted */
+    cxobj        *bc_xlist2; /* As bc_xlist with every tenth value changed */
+    cxobj        *bc_xdeep;  /* Deep tree, not bound */
+    cxobj        *bc_xnacm;  /* NACM rules */
+    cvec         *bc_nsc;    /* Namespace context with b prefix */
+    cbuf         *bc_cb;     /* Output buffer */
+    cxobj        *bc_xt;     /* Tree of a single run, created in setup */
+    cxobj       **bc_xvec;   /* Vector of a single run, created in setup */
+};
+
+typedef int (bench_fn_t)(struct bench_ctx *bc);
+
+/* A benchmark, setup and teardown are called before and after each run and are not timed */
+struct bench {
+    char       *b_name;
+    bench_fn_t *b_setup;
+    bench_fn_t *b_run;
+    bench_fn_t *b_teardown;
+};
+
+static int
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s [options]\n"
+            "where options are\n"
+            "\t-h \t\tHelp\n"
+            "\t-D <level>\tDebug\n"
+            "\t-n <nr>     \tNumber of list entries (default: 10000)\n"
+            "\t-d <depth>  \tDepth of deep tree (default: 1000)\n"
+            "\t-w <nr>     \tWarmup runs of each benchmark (default: 2)\n"
+            "\t-r <nr>     \tTimed runs of each benchmark (default: 10)\n"
+            "\t-b <name>   \tOnly run benchmarks whose name starts with <name>\n"
+            "\t-j          \tPrint result as JSON\n",
+            argv0
+            );
+    exit(0);
+}
+
+/*! Monotonic time in nanoseconds
+ */
+static uint64_t
+bench_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+static int
+bench_cmp(const void *a,
+          const void *b)
+{
+    uint64_t x = *(uint64_t*)a;
+    uint64_t y = *(uint64_t*)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/*! Free tree and vector of a single run
+ */
+static int
+bench_xt_free(struct bench_ctx *bc)
+{
+    if (bc->bc_xt){
+        xml_free(bc->bc_xt);
+        bc->bc_xt = NULL;
+    }
+    if (bc->bc_xvec){
+        free(bc->bc_xvec);
+        bc->bc_xvec = NULL;
+    }
+    return 0;
+}
+
+/*! Parse list into tree of a single run, not bound to yang
+ */
+static int
+bench_list_parse_nobind(struct bench_ctx *bc)
+{
+    if (clixon_xml_parse_string(cbuf_get(bc->bc_listxml), YB_NONE, NULL, &bc->bc_xt, NULL) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Duplicate bound list into tree of a single run
+ */
+static int
+bench_list_dup(struct bench_ctx *bc)
+{
+    if ((bc->bc_xt = xml_dup(bc->bc_xlist)) == NULL)
+        return -1;
+    return 0;
+}
+
+static int
+bench_xml_parse_list(struct bench_ctx *bc)
+{
+    cxobj *xt = NULL;
+
+    if (clixon_xml_parse_string(cbuf_get(bc->bc_listxml), YB_NONE, NULL, &xt, NULL) < 0)
+        return -1;
+    xml_free(xt);
+    return 0;
+}
+
+static int
+bench_xml_parse_deep(struct bench_ctx *bc)
+{
+    cxobj *xt = NULL;
+
+    if (clixon_xml_parse_string(cbuf_get(bc->bc_deepxml), YB_NONE, NULL, &xt, NULL) < 0)
+        return -1;
+    xml_free(xt);
+    return 0;
+}
+
+static int
+bench_json_parse(struct bench_ctx *bc)
+{
+    cxobj *xt = NULL;
+    cxobj *xerr = NULL;
+    int    ret;
+
+    if ((ret = clixon_json_parse_string(cbuf_get(bc->bc_json), 1, YB_MODULE, bc->bc_yspec, &xt, &xerr)) < 0)
+        return -1;
+    if (xerr)
+        xml_free(xerr);
+    if (xt)
+        xml_free(xt);
+    if (ret == 0){
+        clicon_err(OE_JSON, 0, "JSON parse failed");
+        return -1;
+    }
+    return 0;
+}
+
+static int
+bench_xml_bind_yang(struct bench_ctx *bc)
+{
+    cxobj *xerr = NULL;
+    int    ret;
+
+    if ((ret = xml_bind_yang(bc->bc_h, bc->bc_xt, YB_MODULE, bc->bc_yspec, &xerr)) < 0)
+        return -1;
+    if (xerr)
+        xml_free(xerr);
+    if (ret == 0){
+        clicon_err(OE_YANG, 0, "Yang bind failed");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Parse and bind list but do not sort
+ */
+static int
+bench_xml_sort_setup(struct bench_ctx *bc)
+{
+    if (bench_list_parse_nobind(bc) < 0)
+        return -1;
+    return bench_xml_bind_yang(bc);
+}
+
+static int
+bench_xml_sort(struct bench_ctx *bc)
+{
+    return xml_sort_recurse(bc->bc_xt);
+}
+
+/*! Duplicate bound list and remove all entries from it
+ */
+static int
+bench_xml_insert_setup(struct bench_ctx *bc)
+{
+    cxobj *xtable;
+    cxobj *x;
+    int    i;
+
+    if (bench_list_dup(bc) < 0)
+        return -1;
+    if ((xtable = xml_find_type(bc->bc_xt, NULL, "table", CX_ELMNT)) == NULL){
+        clicon_err(OE_XML, 0, "table not found");
+        return -1;
+    }
+    if ((bc->bc_xvec = calloc(bc->bc_nr, sizeof(cxobj *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return -1;
+    }
+    /* Remove from end to avoid moving the remaining children */
+    for (i = bc->bc_nr-1; i >= 0; i--){
+        if ((x = xml_child_i_type(xtable, i, CX_ELMNT)) == NULL){
+            clicon_err(OE_XML, 0, "parameter %d not found", i);
+            return -1;
+        }
+        if (xml_rm(x) < 0)
+            return -1;
+        bc->bc_xvec[i] = x;
+    }
+    return 0;
+}
+
+/*! Insert all entries in random order
+ */
+static int
+bench_xml_insert(struct bench_ctx *bc)
+{
+    cxobj *xtable;
+    cxobj *x;
+    int    i;
+
+    xtable = xml_find_type(bc->bc_xt, NULL, "table", CX_ELMNT);
+    for (i = 0; i < bc->bc_nr; i++){
+        x = bc->bc_xvec[bc->bc_perm[i]];
+        bc->bc_xvec[bc->bc_perm[i]] = NULL;
+        if (xml_insert(xtable, x, INS_LAST, NULL, NULL) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Free also entries not inserted, if a run failed
+ */
+static int
+bench_xml_insert_teardown(struct bench_ctx *bc)
+{
+    int i;
+
+    if (bc->bc_xvec)
+        for (i = 0; i < bc->bc_nr; i++)
+            if (bc->bc_xvec[i])
+                xml_free(bc->bc_xvec[i]);
+    return bench_xt_free(bc);
+}
+
+/*! Binary search of list entries by key
+ */
+static int
+bench_xml_search_binary(struct bench_ctx *bc)
+{
+    int          retval = -1;
+    cxobj       *xtable;
+    cvec        *cvk = NULL;
+    cg_var      *cv;
+    clixon_xvec *xv = NULL;
+    char         key[32];
+    int          i;
+
+    xtable = xml_find_type(bc->bc_xlist, NULL, "table", CX_ELMNT);
+    if ((cvk = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if ((cv = cvec_add(cvk, CGV_STRING)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_add");
+        goto done;
+    }
+    cv_name_set(cv, "name");
+    for (i = 0; i < BENCH_LOOKUPS; i++){
+        snprintf(key, sizeof(key), "p%d", bc->bc_perm[i % bc->bc_nr]);
+        cv_string_set(cv, key);
+        if ((xv = clixon_xvec_new()) == NULL)
+            goto done;
+        if (clixon_xml_find_index(xtable, xml_spec(xtable), NULL, "parameter", cvk, xv) < 0)
+            goto done;
+        if (clixon_xvec_len(xv) != 1){
+            clicon_err(OE_XML, 0, "%s not found", key);
+            goto done;
+        }
+        clixon_xvec_free(xv);
+        xv = NULL;
+    }
+    retval = 0;
+ done:
+    if (xv)
+        clixon_xvec_free(xv);
+    if (cvk)
+        cvec_free(cvk);
+    return retval;
+}
+
+/*! Xpath lookups of list entries by key
+ */
+static int
+bench_xpath_vec1(struct bench_ctx *bc)
+{
+    int     retval = -1;
+    cxobj **vec = NULL;
+    size_t  veclen;
+    int     i;
+
+    for (i = 0; i < BENCH_LOOKUPS; i++){
+        if (xpath_vec(bc->bc_xlist, bc->bc_nsc, "/b:table/b:parameter[b:name='p%d']",
+                      &vec, &veclen, bc->bc_perm[i % bc->bc_nr]) < 0)
+            goto done;
+        if (veclen != 1){
+            clicon_err(OE_XML, 0, "p%d not found", bc->bc_perm[i % bc->bc_nr]);
+            goto done;
+        }
+        free(vec);
+        vec = NULL;
+    }
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+static int
+bench_xpath_vec(struct bench_ctx *bc)
+{
+    xpath_list_optimize_set(1);
+    return bench_xpath_vec1(bc);
+}
+
+static int
+bench_xpath_vec_noopt(struct bench_ctx *bc)
+{
+    int retval;
+
+    xpath_list_optimize_set(0);
+    retval = bench_xpath_vec1(bc);
+    xpath_list_optimize_set(1);
+    return retval;
+}
+
+static int
+bench_xml_diff(struct bench_ctx *bc)
+{
+    int     retval = -1;
+    cxobj **first = NULL;
+    cxobj **second = NULL;
+    cxobj **changed0 = NULL;
+    cxobj **changed1 = NULL;
+    int     firstlen = 0;
+    int     secondlen = 0;
+    int     changedlen = 0;
+
+    if (xml_diff(bc->bc_xlist, bc->bc_xlist2,
+                 &first, &firstlen,
+                 &second, &secondlen,
+                 &changed0, &changed1, &changedlen) < 0)
+        goto done;
+    if (changedlen != (bc->bc_nr+9)/10){
+        clicon_err(OE_XML, 0, "%d changed, expected %d", changedlen, (bc->bc_nr+9)/10);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (first)
+        free(first);
+    if (second)
+        free(second);
+    if (changed0)
+        free(changed0);
+    if (changed1)
+        free(changed1);
+    return retval;
+}
+
+static int
+bench_xml_yang_validate_all(struct bench_ctx *bc)
+{
+    cxobj *xret = NULL;
+    int    ret;
+
+    if ((ret = xml_yang_validate_all_top(bc->bc_h, bc->bc_xlist, &xret)) < 0)
+        return -1;
+    if (xret)
+        xml_free(xret);
+    if (ret == 0){
+        clicon_err(OE_YANG, 0, "Validation failed");
+        return -1;
+    }
+    return 0;
+}
+
+static int
+bench_nacm_read(struct bench_ctx *bc)
+{
+    if (nacm_datanode_read(bc->bc_h, bc->bc_xt, &bc->bc_xt, 1, "bench", bc->bc_xnacm) < 0)
+        return -1;
+    return 0;
+}
+
+static int
+bench_xml2cbuf_list(struct bench_ctx *bc)
+{
+    cbuf_reset(bc->bc_cb);
+    return clixon_xml2cbuf(bc->bc_cb, bc->bc_xlist, 0, 0, NULL, -1, 1);
+}
+
+static int
+bench_xml2cbuf_deep(struct bench_ctx *bc)
+{
+    cbuf_reset(bc->bc_cb);
+    return clixon_xml2cbuf(bc->bc_cb, bc->bc_xdeep, 0, 0, NULL, -1, 1);
+}
+
+static struct bench bench_list[] = {
+    {"xml_parse_list",        NULL,                    bench_xml_parse_list,        NULL},
+    {"xml_parse_deep",        NULL,                    bench_xml_parse_deep,        NULL},
+    {"json_parse",            NULL,                    bench_json_parse,            NULL},
+    {"xml_bind_yang",         bench_list_parse_nobind, bench_xml_bind_yang,         bench_xt_free},
+    {"xml_sort",              bench_xml_sort_setup,    bench_xml_sort,              bench_xt_free},
+    {"xml_insert",            bench_xml_insert_setup,  bench_xml_insert,            bench_xml_insert_teardown},
+    {"xml_search_binary",     NULL,                    bench_xml_search_binary,     NULL},
+    {"xpath_vec",             NULL,                    bench_xpath_vec,             NULL},
+    {"xpath_vec_noopt",       NULL,                    bench_xpath_vec_noopt,       NULL},
+    {"xml_diff",              NULL,                    bench_xml_diff,              NULL},
+    {"xml_yang_validate_all", NULL,                    bench_xml_yang_validate_all, NULL},
+    {"nacm_read",             bench_list_dup,          bench_nacm_read,             bench_xt_free},
+    {"xml2cbuf_list",         NULL,                    bench_xml2cbuf_list,         NULL},
+    {"xml2cbuf_deep",         NULL,                    bench_xml2cbuf_deep,         NULL},
+    {NULL,                    NULL,                    NULL,                        NULL}
+};
+
+/*! Generate yang, data strings and trees of the benchmarks
+ */
+static int
+bench_init(struct bench_ctx *bc)
+{
+    int    retval = -1;
+    int    modmin;
+    int    i;
+    int    j;
+    int    tmp;
+    char  *str;
+    cxobj *x;
+
+    if ((bc->bc_h = clicon_handle_init()) == NULL)
+        goto done;
+    if ((bc->bc_yspec = yspec_new()) == NULL)
+        goto done;
+    clicon_dbspec_yang_set(bc->bc_h, bc->bc_yspec);
+    modmin = yang_len_get(bc->bc_yspec);
+    if ((str = strdup(bench_yang)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (yang_parse_str(str, "bench", bc->bc_yspec) == NULL){
+        free(str);
+        goto done;
+    }
+    free(str);
+    if (yang_parse_post(bc->bc_h, bc->bc_yspec, modmin) < 0)
+        goto done;
+    if ((bc->bc_nsc = xml_nsctx_init("b", BENCH_NS)) == NULL)
+        goto done;
+    /* Random permutation, same in each invocation */
+    if ((bc->bc_perm = calloc(bc->bc_nr, sizeof(int))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i = 0; i < bc->bc_nr; i++)
+        bc->bc_perm[i] = i;
+    srandom(1);
+    for (i = bc->bc_nr-1; i > 0; i--){
+        j = random() % (i+1);
+        tmp = bc->bc_perm[i];
+        bc->bc_perm[i] = bc->bc_perm[j];
+        bc->bc_perm[j] = tmp;
+    }
+    if ((bc->bc_listxml = cbuf_new()) == NULL ||
+        (bc->bc_deepxml = cbuf_new()) == NULL ||
+        (bc->bc_json = cbuf_new()) == NULL ||
+        (bc->bc_cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(bc->bc_listxml, "<table xmlns=\"%s\">", BENCH_NS);
+    cprintf(bc->bc_json, "{\"bench:table\":{\"parameter\":[");
+    for (i = 0; i < bc->bc_nr; i++){
+        cprintf(bc->bc_listxml, "<parameter><name>p%d</name><value>%d</value></parameter>",
+                bc->bc_perm[i], bc->bc_perm[i]);
+        cprintf(bc->bc_json, "%s{\"name\":\"p%d\",\"value\":%d}",
+                i?",":"", bc->bc_perm[i], bc->bc_perm[i]);
+    }
+    cprintf(bc->bc_listxml, "</table>");
+    cprintf(bc->bc_json, "]}}");
+    for (i = 0; i < bc->bc_depth; i++)
+        cprintf(bc->bc_deepxml, "<d%s><x>%d</x>", i?"":" xmlns=\"" BENCH_NS "\"", i);
+    for (i = 0; i < bc->bc_depth; i++)
+        cprintf(bc->bc_deepxml, "</d>");
+    if (clixon_xml_parse_string(cbuf_get(bc->bc_listxml), YB_MODULE, bc->bc_yspec, &bc->bc_xlist, NULL) < 0)
+        goto done;
+    if ((bc->bc_xlist2 = xml_dup(bc->bc_xlist)) == NULL)
+        goto done;
+    for (i = 0; i < bc->bc_nr; i += 10){
+        if ((x = xpath_first(bc->bc_xlist2, bc->bc_nsc, "/b:table/b:parameter[b:name='p%d']/b:value", i)) == NULL ||
+            (x = xml_body_get(x)) == NULL){
+            clicon_err(OE_XML, 0, "p%d not found", i);
+            goto done;
+        }
+        if (xml_value_set(x, "42424242") < 0)
+            goto done;
+    }
+    if (clixon_xml_parse_string(cbuf_get(bc->bc_deepxml), YB_NONE, NULL, &bc->bc_xdeep, NULL) < 0)
+        goto done;
+    if (clixon_xml_parse_string(bench_nacm, YB_NONE, NULL, &bc->bc_xnacm, NULL) < 0)
+        goto done;
+    if (xml_rootchild(bc->bc_xnacm, 0, &bc->bc_xnacm) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+static int
+bench_exit(struct bench_ctx *bc)
+{
+    bench_xt_free(bc);
+    if (bc->bc_xnacm)
+        xml_free(bc->bc_xnacm);
+    if (bc->bc_xdeep)
+        xml_free(bc->bc_xdeep);
+    if (bc->bc_xlist2)
+        xml_free(bc->bc_xlist2);
+    if (bc->bc_xlist)
+        xml_free(bc->bc_xlist);
+    if (bc->bc_cb)
+        cbuf_free(bc->bc_cb);
+    if (bc->bc_json)
+        cbuf_free(bc->bc_json);
+    if (bc->bc_deepxml)
+        cbuf_free(bc->bc_deepxml);
+    if (bc->bc_listxml)
+        cbuf_free(bc->bc_listxml);
+    if (bc->bc_perm)
+        free(bc->bc_perm);
+    if (bc->bc_nsc)
+        cvec_free(bc->bc_nsc);
+    if (bc->bc_yspec)
+        ys_free(bc->bc_yspec);
+    if (bc->bc_h)
+        clicon_handle_exit(bc->bc_h);
+    return 0;
+}
+
+/*! Run one benchmark warmup + runs times, time the runs and print result
+ *
+ * @param[in]  bc      Benchmark context
+ * @param[in]  b       Benchmark
+ * @param[in]  warmup  Number of warmup runs, not timed
+ * @param[in]  runs    Number of timed runs
+ * @param[in]  json    Print as JSON object
+ * @param[in]  first   First JSON object of list
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+bench_run(struct bench_ctx *bc,
+          struct bench     *b,
+          int               warmup,
+          int               runs,
+          int               json,
+          int               first)
+{
+    int       retval = -1;
+    uint64_t *samples = NULL;
+    uint64_t  t0;
+    uint64_t  sum = 0;
+    int       i;
+
+    if ((samples = calloc(runs, sizeof(uint64_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i = 0; i < warmup + runs; i++){
+        if (b->b_setup && b->b_setup(bc) < 0)
+            goto done;
+        t0 = bench_ns();
+        if (b->b_run(bc) < 0)
+            goto done;
+        if (i >= warmup){
+            samples[i-warmup] = bench_ns() - t0;
+            sum += samples[i-warmup];
+        }
+        if (b->b_teardown && b->b_teardown(bc) < 0)
+            goto done;
+    }
+    qsort(samples, runs, sizeof(uint64_t), bench_cmp);
+    if (json)
+        fprintf(stdout, "%s{\"name\":\"%s\",\"min\":%.1f,\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"max\":%.1f,\"mean\":%.1f}",
+                first?"":",",
+                b->b_name,
+                samples[0]/1000.0,
+                samples[(runs-1)*50/100]/1000.0,
+                samples[(runs-1)*90/100]/1000.0,
+                samples[(runs-1)*99/100]/1000.0,
+                samples[runs-1]/1000.0,
+                sum/1000.0/runs);
+    else
+        fprintf(stdout, "%-22s %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                b->b_name,
+                samples[0]/1000.0,
+                samples[(runs-1)*50/100]/1000.0,
+                samples[(runs-1)*90/100]/1000.0,
+                samples[(runs-1)*99/100]/1000.0,
+                samples[runs-1]/1000.0,
+                sum/1000.0/runs);
+    retval = 0;
+ done:
+    if (retval < 0 && b->b_teardown)
+        b->b_teardown(bc);
+    if (samples)
+        free(samples);
+    return retval;
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int              retval = -1;
+    char            *argv0 = argv[0];
+    int              c;
+    int              dbg = 0;
+    int              warmup = 2;
+    int              runs = 10;
+    char            *name = NULL;
+    int              json = 0;
+    int              first = 1;
+    struct bench_ctx bc = {0,};
+    struct bench    *b;
+
+    bc.bc_nr = 10000;
+    bc.bc_depth = 1000;
+    optind = 1;
+    opterr = 0;
+    while ((c = getopt(argc, argv, BENCH_OPTS)) != -1)
+        switch (c) {
+        case 'h':
+            usage(argv0);
+            break;
+        case 'D':
+            if (sscanf(optarg, "%d", &dbg) != 1)
+                usage(argv0);
+            break;
+        case 'n': /* Number of list entries */
+            if ((bc.bc_nr = atoi(optarg)) < 1)
+                usage(argv0);
+            break;
+        case 'd': /* Depth of deep tree */
+            if ((bc.bc_depth = atoi(optarg)) < 1)
+                usage(argv0);
+            break;
+        case 'w': /* Warmup runs */
+            if ((warmup = atoi(optarg)) < 0)
+                usage(argv0);
+            break;
+        case 'r': /* Timed runs */
+            if ((runs = atoi(optarg)) < 1)
+                usage(argv0);
+            break;
+        case 'b': /* Benchmark name prefix */
+            name = optarg;
+            break;
+        case 'j':
+            json++;
+            break;
+        default:
+            usage(argv[0]);
+            break;
+        }
+    clicon_log_init(__FILE__, dbg?LOG_DEBUG:LOG_INFO, CLICON_LOG_STDERR);
+    clicon_debug_init(dbg, NULL);
+
+    if (bench_init(&bc) < 0)
+        goto done;
+    if (json)
+        fprintf(stdout, "{\"nr\":%d,\"depth\":%d,\"warmup\":%d,\"runs\":%d,\"unit\":\"us\",\"benchmarks\":[",
+                bc.bc_nr, bc.bc_depth, warmup, runs);
+    else
+        fprintf(stdout, "%-22s %10s %10s %10s %10s %10s %10s\n",
+                "benchmark(us)", "min", "p50", "p90", "p99", "max", "mean");
+    for (b = bench_list; b->b_name; b++){
+        if (name && strncmp(b->b_name, name, strlen(name)) != 0)
+            continue;
+        if (bench_run(&bc, b, warmup, runs, json, first) < 0)
+            goto done;
+        first = 0;
+    }
+    if (json)
+        fprintf(stdout, "]}\n");
+    retval = 0;
+ done:
+    bench_exit(&bc);
+    return retval;
+}
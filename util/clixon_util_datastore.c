@@ -66,7 +66,7 @@
 #include <clixon/clixon.h>
 
 /* Command line options to be passed to getopt(3) */
-#define DATASTORE_OPTS "hDd:b:f:x:y:Y:"
+#define DATASTORE_OPTS "hDd:b:f:z:x:y:Y:"
 
 /*! usage
  */
@@ -79,7 +79,8 @@ usage(char *argv0)
             "\t-D\t\tDebug\n"
             "\t-d <db>\t\tDatabase name. Default: running. Alt: candidate,startup\n"
             "\t-b <dir>\tDatabase directory. Mandatory\n"
-            "\t-f <fmt>\tDatabase format: xml or json\n"
+            "\t-f <fmt>\tDatabase format: xml, json, binary or cbor\n"
+            "\t-z <cmp>\tDatabase compression: none or zstd\n"
             "\t-x <xml>\tXML file. Alternative to put <xml> argument\n"
             "\t-y <file>\tYang file. Mandatory\n"
             "\t-Y <dir> \tYang dirs (can be several)\n"
@@ -95,12 +96,111 @@ usage(char *argv0)
             "\texists\n"
             "\tdelete\n"
             "\tinit\n"
+            "\tconvert (xml|json|binary|cbor) <file>\tWrite db file in another format\n"
             ,
             argv0
             );
     exit(0);
 }
 
+/*! Read a datastore file in the -f format and write it to another file in another format
+ *
+ * The file is converted as is, without yang binding, eg modstate is kept
+ * Module names of json and cbor are translated to namespaces using the yang spec
+ * The output file is compressed if -z is given, compressed input is recognized
+ * @param[in]  h       Clixon handle
+ * @param[in]  db      Name of datastore
+ * @param[in]  format  Format of output file: xml, json, binary or cbor
+ * @param[in]  file    Output file
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+datastore_convert(clicon_handle h,
+                  char         *db,
+                  char         *format,
+                  char         *file)
+{
+    int    retval = -1;
+    char  *dbfile = NULL;
+    char  *format0;
+    FILE  *fp = NULL;
+    FILE  *fout = NULL;
+    cxobj *xt = NULL;
+    cxobj *x;
+
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if ((fp = fopen(dbfile, "r")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen(%s)", dbfile);
+        goto done;
+    }
+    if (xmldb_compress_wrap(h, "r", &fp) < 0)
+        goto done;
+    format0 = clicon_option_str(h, "CLICON_XMLDB_FORMAT");
+    if (strcmp(format0, "json")==0){
+        if (clixon_json_parse_file(fp, 1, YB_NONE, NULL, &xt, NULL) < 0)
+            goto done;
+    }
+    else if (strcmp(format0, "binary")==0){
+        if (clixon_binary_parse_file(fp, YB_NONE, NULL, &xt, NULL) < 0)
+            goto done;
+    }
+    else if (strcmp(format0, "cbor")==0){
+        if (clixon_cbor_parse_file(fp, YB_NONE, clicon_dbspec_yang(h), &xt, NULL) < 0)
+            goto done;
+    }
+    else if (clixon_xml_parse_file(fp, YB_NONE, NULL, &xt, NULL) < 0)
+        goto done;
+    if ((fout = fopen(file, "w")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen(%s)", file);
+        goto done;
+    }
+    if (xmldb_compress_wrap(h, "w", &fout) < 0)
+        goto done;
+    /* Skip the top symbol: write the datastore top, eg <config>...</config> */
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL){
+        if (strcmp(format, "json")==0){
+            if (clixon_json2file(fout, x, 1, fprintf, 0, 0) < 0)
+                goto done;
+        }
+        else if (strcmp(format, "binary")==0){
+            if (clixon_xml2binary_file(fout, x) < 0)
+                goto done;
+        }
+        else if (strcmp(format, "cbor")==0){
+            if (clixon_xml2cbor_file(fout, x) < 0)
+                goto done;
+        }
+        else if (strcmp(format, "xml")==0){
+            if (clixon_xml2file(fout, x, 0, 1, NULL, fprintf, 0, 0) < 0)
+                goto done;
+        }
+        else{
+            clicon_err(OE_DB, 0, "Unrecognized format: %s", format);
+            goto done;
+        }
+    }
+    if (fclose(fout) != 0){
+        fout = NULL;
+        clicon_err(OE_UNIX, errno, "fclose(%s)", file);
+        goto done;
+    }
+    fout = NULL;
+    retval = 0;
+ done:
+    if (fp)
+        fclose(fp);
+    if (fout)
+        fclose(fout);
+    if (dbfile)
+        free(dbfile);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -138,6 +238,7 @@ main(int argc, char **argv)
         goto done;
     /* getopt in two steps, first find config-file before over-riding options. */
     clicon_option_str_set(h, "CLICON_XMLDB_FORMAT", "xml"); /* default */
+    clicon_option_str_set(h, "CLICON_XMLDB_COMPRESS", "none"); /* default */
     while ((c = getopt(argc, argv, DATASTORE_OPTS)) != -1)
         switch (c) {
         case '?' :
@@ -162,6 +263,11 @@ main(int argc, char **argv)
                 usage(argv0);
             clicon_option_str_set(h, "CLICON_XMLDB_FORMAT", optarg);
             break;
+        case 'z': /* db compression */
+            if (!optarg)
+                usage(argv0);
+            clicon_option_str_set(h, "CLICON_XMLDB_COMPRESS", optarg);
+            break;
         case 'x': /* XML file */
             if (!optarg)
                 usage(argv0);
@@ -343,6 +449,12 @@ main(int argc, char **argv)
         if (xmldb_create(h, db) < 0)
             goto done;
     }
+    else if (strcmp(cmd, "convert")==0){
+        if (argc != 3)
+            usage(argv0);
+        if (datastore_convert(h, db, argv[1], argv[2]) < 0)
+            goto done;
+    }
     else{
         clicon_err(OE_DB, 0, "Unrecognized command: %s", cmd);
         usage(argv0);
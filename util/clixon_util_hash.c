@@ -0,0 +1,198 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Utility for checking and timing the clicon_hash table
+  * Adds nr keys, looks them up, deletes every second key, and checks the result
+  * Example:
+  *   clixon_util_hash -n 100000 -l 10 -k CLICON_OPTION_
+  */
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <syslog.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon/clixon.h"
+
+static int
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s [options]\n"
+            "where options are\n"
+            "\t-h \t\tHelp\n"
+            "\t-D <level>\tDebug\n"
+            "\t-n <nr>     \tNumber of keys (default: 1000)\n"
+            "\t-l <nr>     \tLookups of each key (default: 1)\n"
+            "\t-k <prefix> \tKey prefix, key is prefix and number (default: \"key\")\n"
+            "\t-t          \tPrint time in us of add, lookup and delete\n",
+            argv0
+            );
+    exit(0);
+}
+
+/*! Microseconds elapsed since t0
+ */
+static uint64_t
+hash_us(struct timeval *t0)
+{
+    struct timeval t1;
+
+    gettimeofday(&t1, NULL);
+    timersub(&t1, t0, &t1);
+    return (uint64_t)t1.tv_sec*1000000 + t1.tv_usec;
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int            retval = -1;
+    char          *argv0 = argv[0];
+    int            c;
+    int            dbg = 0;
+    int            nr = 1000;
+    int            lookups = 1;
+    char          *prefix = "key";
+    int            timing = 0;
+    clicon_hash_t *hash = NULL;
+    char           key[128];
+    char         **keys = NULL;
+    size_t         nkeys = 0;
+    size_t         vlen;
+    int           *v;
+    int            i;
+    int            j;
+    struct timeval t0;
+    uint64_t       tadd;
+    uint64_t       tlookup;
+    uint64_t       tdel;
+
+    optind = 1;
+    opterr = 0;
+    while ((c = getopt(argc, argv, "hD:n:l:k:t")) != -1)
+        switch (c) {
+        case 'h':
+            usage(argv0);
+            break;
+        case 'D':
+            if (sscanf(optarg, "%d", &dbg) != 1)
+                usage(argv0);
+            break;
+        case 'n': /* Number of keys */
+            if ((nr = atoi(optarg)) < 0)
+                usage(argv0);
+            break;
+        case 'l': /* Lookups of each key */
+            if ((lookups = atoi(optarg)) < 0)
+                usage(argv0);
+            break;
+        case 'k': /* Key prefix */
+            prefix = optarg;
+            break;
+        case 't':
+            timing++;
+            break;
+        default:
+            usage(argv[0]);
+            break;
+        }
+    clicon_log_init(__FILE__, dbg?LOG_DEBUG:LOG_INFO, CLICON_LOG_STDERR);
+    clicon_debug_init(dbg, NULL);
+
+    if ((hash = clicon_hash_init()) == NULL)
+        goto done;
+    gettimeofday(&t0, NULL);
+    for (i=0; i<nr; i++){
+        snprintf(key, sizeof(key), "%s%d", prefix, i);
+        if (clicon_hash_add(hash, key, &i, sizeof(i)) == NULL)
+            goto done;
+    }
+    tadd = hash_us(&t0);
+    gettimeofday(&t0, NULL);
+    for (j=0; j<lookups; j++)
+        for (i=0; i<nr; i++){
+            snprintf(key, sizeof(key), "%s%d", prefix, i);
+            if ((v = clicon_hash_value(hash, key, &vlen)) == NULL ||
+                vlen != sizeof(i) || *v != i){
+                fprintf(stderr, "%s: lookup of %s failed\n", __FUNCTION__, key);
+                goto done;
+            }
+        }
+    tlookup = hash_us(&t0);
+    gettimeofday(&t0, NULL);
+    for (i=0; i<nr; i+=2){
+        snprintf(key, sizeof(key), "%s%d", prefix, i);
+        if (clicon_hash_del(hash, key) < 0){
+            fprintf(stderr, "%s: delete of %s failed\n", __FUNCTION__, key);
+            goto done;
+        }
+    }
+    tdel = hash_us(&t0);
+    /* Every second key is left */
+    for (i=0; i<nr; i++){
+        snprintf(key, sizeof(key), "%s%d", prefix, i);
+        if ((clicon_hash_lookup(hash, key) != NULL) != (i%2 == 1)){
+            fprintf(stderr, "%s: %s %sfound after delete\n", __FUNCTION__, key, i%2?"not ":"");
+            goto done;
+        }
+    }
+    if (clicon_hash_keys(hash, &keys, &nkeys) < 0)
+        goto done;
+    if (nkeys != nr/2){
+        fprintf(stderr, "%s: %zu keys, expected %d\n", __FUNCTION__, nkeys, nr/2);
+        goto done;
+    }
+    if (timing)
+        fprintf(stdout, "add: %" PRIu64 " us\nlookup: %" PRIu64 " us\ndel: %" PRIu64 " us\n",
+                tadd, tlookup, tdel);
+    fprintf(stdout, "OK %zu keys\n", nkeys);
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    if (hash)
+        clicon_hash_free(hash);
+    return retval;
+}
@@ -74,10 +74,14 @@ usage(char *argv0)
     fprintf(stderr, "usage:%s [options] JSON as input on stdin\n"
             "where options are\n"
             "\t-h \t\tHelp\n"
+            "\t-c \t\tInput is YANG-CBOR (default is JSON)\n"
+            "\t-C \t\tOutput as YANG-CBOR\n"
             "\t-D <level> \tDebug\n"
             "\t-j \t\tOutput as JSON (default is as XML)\n"
             "\t-l <s|e|o> \tLog on (s)yslog, std(e)rr, std(o)ut (stderr is default)\n"
             "\t-p \t\tPretty-print output\n"
+            "\t-s <len> \tOutput JSON with a JSON stream in parts of at least len bytes\n"
+            "\t-S \t\tParse JSON with hand-written scanner\n"
             "\t-y <filename> \tyang filename to parse (must be stand-alone)\n"      ,
             argv0);
     exit(0);
@@ -99,14 +103,27 @@ main(int    argc,
     int        ret;
     int        pretty = 0;
     int        dbg = 0;
+    int        cbor_in = 0;
+    int        cbor_out = 0;
+    int        streamlen = -1;
+    clixon_json_stream *js = NULL;
+    cxobj     *xc;
+    cxobj     *x1;
+    int        i = 0;
     
     optind = 1;
     opterr = 0;
-    while ((c = getopt(argc, argv, "hD:jl:py:")) != -1)
+    while ((c = getopt(argc, argv, "hcCD:jl:ps:Sy:")) != -1)
         switch (c) {
         case 'h':
             usage(argv[0]);
             break;
+        case 'c':
+            cbor_in++;
+            break;
+        case 'C':
+            cbor_out++;
+            break;
         case 'D':
             if (sscanf(optarg, "%d", &dbg) != 1)
                 usage(argv[0]);
@@ -121,6 +138,14 @@ main(int    argc,
         case 'p':
             pretty++;
             break;
+        case 's':
+            if (sscanf(optarg, "%d", &streamlen) != 1)
+                usage(argv[0]);
+            json++;
+            break;
+        case 'S':
+            clixon_json_parse_scanner(1);
+            break;
         case 'y':
             yang_filename = optarg;
             break;
@@ -139,12 +164,47 @@ main(int    argc,
             return -1;
         }
     }
-    if ((ret = clixon_json_parse_file(stdin, yspec?1:0, yspec?YB_MODULE:YB_NONE, yspec, &xt, &xerr)) < 0)
+    if (cbor_in)
+        ret = clixon_cbor_parse_file(stdin, yspec?YB_MODULE:YB_NONE, yspec, &xt, &xerr);
+    else
+        ret = clixon_json_parse_file(stdin, yspec?1:0, yspec?YB_MODULE:YB_NONE, yspec, &xt, &xerr);
+    if (ret < 0)
         goto done;
     if (ret == 0){
         xml_print(stderr, xerr);
         goto done;
     }
+    if (cbor_out){
+        if (clixon_xml2cbor_cbuf(cb, xt, 1) < 0)
+            goto done;
+        fwrite(cbuf_get(cb), 1, cbuf_len(cb), stdout);
+        fflush(stdout);
+        goto ok;
+    }
+    if (streamlen >= 0){
+        /* Same as clixon_json2cbuf with skiptop, but each part is printed as it is produced */
+        xc = NULL;
+        while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL){
+            if (i++)
+                fprintf(stdout, ",");
+            if ((x1 = xml_dup(xc)) == NULL)
+                goto done;
+            if ((js = clixon_json_stream_new(x1, pretty)) == NULL){
+                xml_free(x1);
+                goto done;
+            }
+            do {
+                cbuf_reset(cb);
+                if ((ret = clixon_json_stream_next(js, cb, streamlen)) < 0)
+                    goto done;
+                fprintf(stdout, "%s", cbuf_get(cb));
+            } while (ret == 1);
+            clixon_json_stream_free(js);
+            js = NULL;
+        }
+        fflush(stdout);
+        goto ok;
+    }
     if (json){
         if (clixon_json2cbuf(cb, xt, pretty, 1, 0) < 0)
             goto done;
@@ -153,8 +213,11 @@ main(int    argc,
         goto done;
     fprintf(stdout, "%s", cbuf_get(cb));
     fflush(stdout);
+ ok:
     retval = 0;
  done:
+    if (js)
+        clixon_json_stream_free(js);
     if (yspec)
         ys_free(yspec);
     if (xt)
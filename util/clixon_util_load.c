@@ -0,0 +1,968 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Load generator of concurrent client sessions
+  * Opens a number of sessions to a running backend, either directly on the internal socket,
+  * via NETCONF over stdio of netconf client processes, or via RESTCONF HTTP/1.1, and sends
+  * a random mix of get, get-config, edit-config and commit requests.
+  * In closed loop (default) each session sends its next request when it gets a reply.
+  * In open loop (-r) requests arrive at a fixed rate and wait for a free session, latency
+  * is measured from the arrival, not from the send.
+  * Data is a list y with key a and leaf b in a container x, as in test/plot_perf.sh
+  * Throughput and latency percentiles are printed per operation.
+  * Example:
+  *   clixon_util_load -s /usr/local/var/example/example.sock -c 10 -n 10000 -m get-config=80,edit-config=20
+  *   clixon_util_load -p netconf -C "clixon_netconf -qf /usr/local/etc/example.xml" -c 4 -t 10 -r 200
+  *   clixon_util_load -p restconf -s 127.0.0.1 -P 80 -c 8 -n 1000 -j
+  */
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <syslog.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <arpa/inet.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon/clixon.h"
+
+/* Command line options to be passed to getopt(3) */
+#define LOAD_OPTS "hD:p:a:s:P:C:c:n:t:r:m:k:y:M:Wj"
+
+/* NETCONF end-of-message framing */
+#define LOAD_EOM "]]>]]>"
+
+enum load_proto {
+    LP_INTERNAL, /* Internal protocol on backend socket */
+    LP_NETCONF,  /* NETCONF over stdio of a netconf client process */
+    LP_RESTCONF  /* RESTCONF over HTTP/1.1 */
+};
+
+enum load_op {
+    LO_GET,
+    LO_GET_CONFIG,
+    LO_EDIT_CONFIG,
+    LO_COMMIT,
+    LO_NR
+};
+
+static const char *load_op_names[LO_NR] = {
+    "get",
+    "get-config",
+    "edit-config",
+    "commit"
+};
+
+/*! One client session
+ */
+struct load_client {
+    int      lc_rfd;   /* Read replies, socket or stdout pipe of netconf client */
+    int      lc_wfd;   /* Write requests, socket or stdin pipe of netconf client */
+    pid_t    lc_pid;   /* Netconf client process, or 0 */
+    int      lc_busy;  /* Waiting for reply */
+    int      lc_op;    /* Operation of outstanding request */
+    uint64_t lc_t0;    /* Start time of outstanding request in ns */
+    int      lc_msgid; /* Next NETCONF message-id */
+    cbuf    *lc_in;    /* Received data of outstanding reply */
+};
+
+/*! Latencies and errors of one operation
+ */
+struct load_stats {
+    uint64_t *ls_samples; /* Latencies in ns of successful requests */
+    int       ls_nr;
+    int       ls_len;
+    int       ls_errors;
+};
+
+struct load_ctx {
+    clicon_handle       lx_h;
+    enum load_proto     lx_proto;
+    char               *lx_family;   /* Internal socket family: UNIX or IPv4 */
+    char               *lx_sock;     /* Unix socket path or IPv4 address */
+    int                 lx_port;
+    char               *lx_cmd;      /* Netconf client command */
+    int                 lx_clients;
+    int                 lx_nreq;     /* Total requests, unless duration is set */
+    int                 lx_duration; /* Seconds */
+    int                 lx_rate;     /* Arrivals per second, 0 for closed loop */
+    int                 lx_mix[LO_NR]; /* Weights of operations */
+    int                 lx_mixsum;
+    int                 lx_keys;     /* Range of random list keys */
+    char               *lx_ns;
+    char               *lx_module;
+    int                 lx_whole;    /* Read whole datastore, not one entry */
+    struct load_client *lx_cl;
+    int                 lx_sent;     /* Requests sent */
+    int                 lx_busy;     /* Outstanding requests */
+    uint64_t            lx_tstart;
+    struct load_stats   lx_stats[LO_NR];
+};
+
+static int
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s [options]\n"
+            "where options are\n"
+            "\t-h \t\tHelp\n"
+            "\t-D <level>\tDebug\n"
+            "\t-p <proto>  \tinternal, netconf or restconf (default: internal)\n"
+            "\t-a <family> \tInternal socket address family, UNIX or IPv4 (default: UNIX)\n"
+            "\t-s <sock>   \tUnix socket path, or IPv4 address of internal socket or restconf\n"
+            "\t-P <port>   \tTCP port (default: 4535 internal, 80 restconf)\n"
+            "\t-C <cmd>    \tNetconf client command (default: clixon_netconf -q)\n"
+            "\t-c <nr>     \tNumber of concurrent sessions (default: 1)\n"
+            "\t-n <nr>     \tTotal number of requests (default: 1000)\n"
+            "\t-t <sec>    \tRun for a duration instead of a number of requests\n"
+            "\t-r <rate>   \tOpen loop with <rate> requests per second (default: closed loop)\n"
+            "\t-m <mix>    \tWeights of operations, eg get-config=80,edit-config=15,commit=5\n"
+            "\t            \t(default: get-config=100)\n"
+            "\t-k <nr>     \tRange of random list keys (default: 1000)\n"
+            "\t-y <ns>     \tNamespace of data (default: urn:example:clixon)\n"
+            "\t-M <module> \tModule of data, used by restconf (default: scaling)\n"
+            "\t-W          \tRead whole datastore, not one random entry\n"
+            "\t-j          \tPrint result as JSON\n",
+            argv0
+            );
+    exit(0);
+}
+
+/*! Monotonic time in nanoseconds
+ */
+static uint64_t
+load_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+static int
+load_cmp(const void *a,
+         const void *b)
+{
+    uint64_t x = *(uint64_t*)a;
+    uint64_t y = *(uint64_t*)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/*! Parse operation mix, eg get-config=80,commit=20
+ *
+ * @param[in]  lx   Load context
+ * @param[in]  str  Comma-separated list of <op>=<weight>
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+load_mix_parse(struct load_ctx *lx,
+               char            *str)
+{
+    int    retval = -1;
+    char **vec = NULL;
+    int    nvec;
+    char  *val;
+    int    i;
+    int    op;
+
+    memset(lx->lx_mix, 0, sizeof(lx->lx_mix));
+    lx->lx_mixsum = 0;
+    if ((vec = clicon_strsep(str, ",", &nvec)) == NULL)
+        goto done;
+    for (i=0; i<nvec; i++){
+        if ((val = strchr(vec[i], '=')) != NULL)
+            *val++ = '\0';
+        for (op=0; op<LO_NR; op++)
+            if (strcmp(vec[i], load_op_names[op]) == 0)
+                break;
+        if (op == LO_NR){
+            clicon_err(OE_UNIX, EINVAL, "Unknown operation: %s", vec[i]);
+            goto done;
+        }
+        if ((lx->lx_mix[op] = val?atoi(val):1) < 0){
+            clicon_err(OE_UNIX, EINVAL, "Negative weight of %s", vec[i]);
+            goto done;
+        }
+        lx->lx_mixsum += lx->lx_mix[op];
+    }
+    if (lx->lx_mixsum == 0){
+        clicon_err(OE_UNIX, EINVAL, "Empty operation mix");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Select a random operation according to the mix
+ */
+static int
+load_op_random(struct load_ctx *lx)
+{
+    int r;
+    int op;
+
+    r = random() % lx->lx_mixsum;
+    for (op=0; op<LO_NR-1; op++){
+        if (r < lx->lx_mix[op])
+            break;
+        r -= lx->lx_mix[op];
+    }
+    return op;
+}
+
+/*! Write NETCONF rpc body of an operation
+ *
+ * @param[in]  lx   Load context
+ * @param[in]  op   Operation
+ * @param[in]  key  Random list key
+ * @param[out] cb   RPC body is appended
+ */
+static void
+load_netconf_body(struct load_ctx *lx,
+                  int              op,
+                  int              key,
+                  cbuf            *cb)
+{
+    switch (op){
+    case LO_GET:
+    case LO_GET_CONFIG:
+        if (op == LO_GET)
+            cprintf(cb, "<get>");
+        else
+            cprintf(cb, "<get-config><source><running/></source>");
+        if (lx->lx_whole)
+            cprintf(cb, "<filter type=\"xpath\" select=\"/ld:x\" xmlns:ld=\"%s\"/>",
+                    lx->lx_ns);
+        else
+            cprintf(cb, "<filter type=\"xpath\" select=\"/ld:x/ld:y[ld:a=%d]\" xmlns:ld=\"%s\"/>",
+                    key, lx->lx_ns);
+        cprintf(cb, "%s", op == LO_GET ? "</get>" : "</get-config>");
+        break;
+    case LO_EDIT_CONFIG:
+        cprintf(cb, "<edit-config><target><candidate/></target><config>"
+                "<x xmlns=\"%s\"><y><a>%d</a><b>%ld</b></y></x></config></edit-config>",
+                lx->lx_ns, key, random());
+        break;
+    case LO_COMMIT:
+        cprintf(cb, "<commit/>");
+        break;
+    }
+}
+
+/*! Write HTTP/1.1 request of an operation
+ */
+static void
+load_http_request(struct load_ctx *lx,
+                  int              op,
+                  int              key,
+                  cbuf            *cb)
+{
+    char body[128];
+
+    switch (op){
+    case LO_GET:
+    case LO_GET_CONFIG:
+        cprintf(cb, "GET /restconf/data/%s:x", lx->lx_module);
+        if (!lx->lx_whole)
+            cprintf(cb, "/y=%d", key);
+        cprintf(cb, "?content=%s HTTP/1.1\r\n", op == LO_GET ? "all" : "config");
+        cprintf(cb, "Host: localhost\r\n");
+        cprintf(cb, "Accept: application/yang-data+xml\r\n\r\n");
+        break;
+    case LO_EDIT_CONFIG:
+        snprintf(body, sizeof(body), "<y xmlns=\"%s\"><a>%d</a><b>%ld</b></y>",
+                 lx->lx_ns, key, random());
+        cprintf(cb, "PUT /restconf/data/%s:x/y=%d HTTP/1.1\r\n", lx->lx_module, key);
+        cprintf(cb, "Host: localhost\r\n");
+        cprintf(cb, "Content-Type: application/yang-data+xml\r\n");
+        cprintf(cb, "Content-Length: %zu\r\n\r\n%s", strlen(body), body);
+        break;
+    default: /* commit is checked in main */
+        break;
+    }
+}
+
+/*! Write whole buffer on a blocking fd
+ */
+static int
+load_write(int     fd,
+           char   *buf,
+           size_t  len)
+{
+    ssize_t n;
+
+    while (len > 0){
+        if ((n = write(fd, buf, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "write");
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Start a netconf client process with pipes to its stdin and stdout, and exchange hello
+ */
+static int
+load_netconf_open(struct load_ctx    *lx,
+                  struct load_client *lc)
+{
+    int  retval = -1;
+    int  in[2] = {-1, -1};
+    int  out[2] = {-1, -1};
+    char buf[BUFSIZ];
+    int  n;
+
+    if (pipe(in) < 0 || pipe(out) < 0){
+        clicon_err(OE_UNIX, errno, "pipe");
+        goto done;
+    }
+    if ((lc->lc_pid = fork()) < 0){
+        clicon_err(OE_UNIX, errno, "fork");
+        goto done;
+    }
+    if (lc->lc_pid == 0){ /* child */
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        close(in[0]); close(in[1]);
+        close(out[0]); close(out[1]);
+        execl("/bin/sh", "sh", "-c", lx->lx_cmd, (char*)NULL);
+        _exit(127);
+    }
+    close(in[0]); in[0] = -1;
+    close(out[1]); out[1] = -1;
+    lc->lc_wfd = in[1]; in[1] = -1;
+    lc->lc_rfd = out[0]; out[0] = -1;
+    cprintf(lc->lc_in, "<hello xmlns=\"%s\"><capabilities><capability>%s</capability>"
+            "</capabilities></hello>%s", NETCONF_BASE_NAMESPACE, NETCONF_BASE_CAPABILITY_1_0, LOAD_EOM);
+    if (load_write(lc->lc_wfd, cbuf_get(lc->lc_in), cbuf_len(lc->lc_in)) < 0)
+        goto done;
+    cbuf_reset(lc->lc_in);
+    /* Wait for server hello */
+    while (strstr(cbuf_get(lc->lc_in), LOAD_EOM) == NULL){
+        if ((n = read(lc->lc_rfd, buf, sizeof(buf)-1)) < 0){
+            clicon_err(OE_UNIX, errno, "read");
+            goto done;
+        }
+        if (n == 0){
+            clicon_err(OE_PROTO, ESHUTDOWN, "Netconf client exited: %s", lx->lx_cmd);
+            goto done;
+        }
+        buf[n] = '\0';
+        cprintf(lc->lc_in, "%s", buf);
+    }
+    cbuf_reset(lc->lc_in);
+    retval = 0;
+ done:
+    if (in[0] != -1)
+        close(in[0]);
+    if (in[1] != -1)
+        close(in[1]);
+    if (out[0] != -1)
+        close(out[0]);
+    if (out[1] != -1)
+        close(out[1]);
+    return retval;
+}
+
+/*! Open all sessions
+ */
+static int
+load_open(struct load_ctx *lx)
+{
+    int                 retval = -1;
+    struct load_client *lc;
+    int                 s;
+    int                 i;
+
+    if ((lx->lx_cl = calloc(lx->lx_clients, sizeof(*lx->lx_cl))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<lx->lx_clients; i++){
+        lc = &lx->lx_cl[i];
+        lc->lc_rfd = lc->lc_wfd = -1;
+        lc->lc_msgid = 1;
+        if ((lc->lc_in = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+    }
+    for (i=0; i<lx->lx_clients; i++){
+        lc = &lx->lx_cl[i];
+        switch (lx->lx_proto){
+        case LP_INTERNAL:
+            if (strcmp(lx->lx_family, "UNIX") == 0){
+                if (clicon_rpc_connect_unix(lx->lx_h, lx->lx_sock, &s) < 0)
+                    goto done;
+            }
+            else if (clicon_rpc_connect_inet(lx->lx_h, lx->lx_sock, lx->lx_port, &s) < 0)
+                goto done;
+            lc->lc_rfd = lc->lc_wfd = s;
+            break;
+        case LP_NETCONF:
+            if (load_netconf_open(lx, lc) < 0)
+                goto done;
+            break;
+        case LP_RESTCONF:
+            if (clicon_rpc_connect_inet(lx->lx_h, lx->lx_sock, lx->lx_port, &s) < 0)
+                goto done;
+            lc->lc_rfd = lc->lc_wfd = s;
+            break;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Close all sessions and wait for netconf client processes
+ */
+static void
+load_close(struct load_ctx *lx)
+{
+    struct load_client *lc;
+    int                 i;
+    int                 status;
+
+    if (lx->lx_cl == NULL)
+        return;
+    for (i=0; i<lx->lx_clients; i++){
+        lc = &lx->lx_cl[i];
+        if (lc->lc_wfd != -1 && lc->lc_wfd != lc->lc_rfd)
+            close(lc->lc_wfd);
+        if (lc->lc_rfd != -1)
+            close(lc->lc_rfd);
+        if (lc->lc_pid > 0)
+            waitpid(lc->lc_pid, &status, 0);
+        if (lc->lc_in)
+            cbuf_free(lc->lc_in);
+    }
+    free(lx->lx_cl);
+    lx->lx_cl = NULL;
+}
+
+/*! Send a random request on an idle session
+ *
+ * @param[in]  lx   Load context
+ * @param[in]  lc   Idle session
+ * @param[in]  t0   Start time of request: now in closed loop, arrival time in open loop
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+load_send(struct load_ctx    *lx,
+          struct load_client *lc,
+          uint64_t            t0)
+{
+    int                retval = -1;
+    cbuf              *cb = NULL;
+    struct clicon_msg *msg = NULL;
+    int                op;
+    int                key;
+
+    op = load_op_random(lx);
+    key = random() % lx->lx_keys;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    switch (lx->lx_proto){
+    case LP_INTERNAL:
+        cprintf(cb, "<rpc xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+        load_netconf_body(lx, op, key, cb);
+        cprintf(cb, "</rpc>");
+        if ((msg = clicon_msg_encode(0, "%s", cbuf_get(cb))) == NULL)
+            goto done;
+        if (clicon_msg_send(lc->lc_wfd, NULL, msg) < 0)
+            goto done;
+        break;
+    case LP_NETCONF:
+        cprintf(cb, "<rpc xmlns=\"%s\" message-id=\"%d\">", NETCONF_BASE_NAMESPACE, lc->lc_msgid++);
+        load_netconf_body(lx, op, key, cb);
+        cprintf(cb, "</rpc>%s", LOAD_EOM);
+        if (load_write(lc->lc_wfd, cbuf_get(cb), cbuf_len(cb)) < 0)
+            goto done;
+        break;
+    case LP_RESTCONF:
+        load_http_request(lx, op, key, cb);
+        if (load_write(lc->lc_wfd, cbuf_get(cb), cbuf_len(cb)) < 0)
+            goto done;
+        break;
+    }
+    lc->lc_busy = 1;
+    lc->lc_op = op;
+    lc->lc_t0 = t0;
+    cbuf_reset(lc->lc_in);
+    lx->lx_sent++;
+    lx->lx_busy++;
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Check if a reply is complete
+ *
+ * @param[in]  lx   Load context
+ * @param[in]  lc   Session
+ * @param[out] err  Set if the reply is an error
+ * @retval     1    Complete reply
+ * @retval     0    Not complete
+ */
+static int
+load_reply_complete(struct load_ctx    *lx,
+                    struct load_client *lc,
+                    int                *err)
+{
+    char              *buf = cbuf_get(lc->lc_in);
+    size_t             len = cbuf_len(lc->lc_in);
+    struct clicon_msg *msg;
+    char              *hdrend;
+    char              *p;
+    size_t             clen = 0;
+    int                code = 0;
+
+    switch (lx->lx_proto){
+    case LP_INTERNAL:
+        msg = (struct clicon_msg *)buf;
+        if (len < sizeof(*msg) || len < ntohl(msg->op_len))
+            return 0;
+        *err = strstr(msg->op_body, "<rpc-error") != NULL;
+        return 1;
+    case LP_NETCONF:
+        if (strstr(buf, LOAD_EOM) == NULL)
+            return 0;
+        *err = strstr(buf, "<rpc-error") != NULL;
+        return 1;
+    case LP_RESTCONF:
+        if ((hdrend = strstr(buf, "\r\n\r\n")) == NULL)
+            return 0;
+        sscanf(buf, "HTTP/%*s %d", &code);
+        for (p = buf; p && p < hdrend; p = strchr(p, '\n')){
+            if (*p == '\n')
+                p++;
+            if (strncasecmp(p, "Content-Length:", strlen("Content-Length:")) == 0)
+                clen = strtoul(p + strlen("Content-Length:"), NULL, 10);
+        }
+        if (len < (hdrend - buf) + 4 + clen)
+            return 0;
+        *err = code >= 400;
+        return 1;
+    }
+    return 0;
+}
+
+/*! Read reply data of a busy session, and record latency if reply is complete
+ */
+static int
+load_read(struct load_ctx    *lx,
+          struct load_client *lc)
+{
+    int                retval = -1;
+    char               buf[BUFSIZ];
+    ssize_t            n;
+    int                err = 0;
+    struct load_stats *ls;
+
+    if ((n = read(lc->lc_rfd, buf, sizeof(buf))) < 0){
+        clicon_err(OE_UNIX, errno, "read");
+        goto done;
+    }
+    if (n == 0){
+        clicon_err(OE_PROTO, ESHUTDOWN, "Session closed by server");
+        goto done;
+    }
+    if (cbuf_append_buf(lc->lc_in, buf, n) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        goto done;
+    }
+    if (load_reply_complete(lx, lc, &err) == 0)
+        goto ok;
+    ls = &lx->lx_stats[lc->lc_op];
+    if (err)
+        ls->ls_errors++;
+    else {
+        if (ls->ls_nr == ls->ls_len){
+            ls->ls_len = ls->ls_len ? 2*ls->ls_len : 1024;
+            if ((ls->ls_samples = realloc(ls->ls_samples, ls->ls_len*sizeof(uint64_t))) == NULL){
+                clicon_err(OE_UNIX, errno, "realloc");
+                goto done;
+            }
+        }
+        ls->ls_samples[ls->ls_nr++] = load_ns() - lc->lc_t0;
+    }
+    lc->lc_busy = 0;
+    lx->lx_busy--;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check if more requests should be sent
+ *
+ * @param[in]  lx   Load context
+ * @param[in]  t    Now in closed loop, next arrival time in open loop
+ */
+static int
+load_more(struct load_ctx *lx,
+          uint64_t         t)
+{
+    if (lx->lx_duration)
+        return t < lx->lx_tstart + (uint64_t)lx->lx_duration*1000000000;
+    return lx->lx_sent < lx->lx_nreq;
+}
+
+/*! Run load until all requests are sent and replied
+ */
+static int
+load_run(struct load_ctx *lx)
+{
+    int                 retval = -1;
+    struct pollfd      *pfds = NULL;
+    struct load_client *lc;
+    uint64_t            now;
+    uint64_t            next;
+    int                 timeout;
+    int                 i;
+    int                 j;
+    int                 n;
+
+    if ((pfds = calloc(lx->lx_clients, sizeof(*pfds))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    lx->lx_tstart = load_ns();
+    while (1){
+        now = load_ns();
+        timeout = -1;
+        /* Send on idle sessions */
+        for (i=0; i<lx->lx_clients; i++){
+            lc = &lx->lx_cl[i];
+            if (lc->lc_busy)
+                continue;
+            if (lx->lx_rate){ /* Arrival time of next request */
+                next = lx->lx_tstart + (uint64_t)lx->lx_sent*1000000000/lx->lx_rate;
+                if (!load_more(lx, next))
+                    break;
+                if (next > now){
+                    timeout = (next - now + 999999)/1000000;
+                    break;
+                }
+            }
+            else {
+                next = now;
+                if (!load_more(lx, now))
+                    break;
+            }
+            if (load_send(lx, lc, next) < 0)
+                goto done;
+        }
+        if (lx->lx_busy == 0 && timeout == -1)
+            break;
+        n = 0;
+        for (i=0; i<lx->lx_clients; i++){
+            if (!lx->lx_cl[i].lc_busy)
+                continue;
+            pfds[n].fd = lx->lx_cl[i].lc_rfd;
+            pfds[n].events = POLLIN;
+            pfds[n].revents = 0;
+            n++;
+        }
+        if (poll(pfds, n, timeout) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "poll");
+            goto done;
+        }
+        /* pfds are in the same order as busy sessions */
+        j = 0;
+        for (i=0; i<lx->lx_clients; i++){
+            lc = &lx->lx_cl[i];
+            if (!lc->lc_busy)
+                continue;
+            if ((pfds[j++].revents & (POLLIN|POLLHUP|POLLERR)) == 0)
+                continue;
+            if (load_read(lx, lc) < 0)
+                goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (pfds)
+        free(pfds);
+    return retval;
+}
+
+/*! Print throughput and latency percentiles in microseconds of one operation
+ */
+static void
+load_print(const char        *name,
+           struct load_stats *ls,
+           double             sec,
+           int                json,
+           int                first)
+{
+    uint64_t *s = ls->ls_samples;
+    int       nr = ls->ls_nr;
+    uint64_t  sum = 0;
+    int       i;
+
+    qsort(s, nr, sizeof(uint64_t), load_cmp);
+    for (i=0; i<nr; i++)
+        sum += s[i];
+    if (json)
+        fprintf(stdout, "%s{\"name\":\"%s\",\"count\":%d,\"errors\":%d,\"rps\":%.1f,\"min\":%.1f,\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"max\":%.1f,\"mean\":%.1f}",
+                first?"":",",
+                name, nr, ls->ls_errors, (nr + ls->ls_errors)/sec,
+                nr?s[0]/1000.0:0,
+                nr?s[(nr-1)*50/100]/1000.0:0,
+                nr?s[(nr-1)*90/100]/1000.0:0,
+                nr?s[(nr-1)*99/100]/1000.0:0,
+                nr?s[nr-1]/1000.0:0,
+                nr?sum/1000.0/nr:0);
+    else
+        fprintf(stdout, "%-12s %8d %6d %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                name, nr, ls->ls_errors, (nr + ls->ls_errors)/sec,
+                nr?s[0]/1000.0:0,
+                nr?s[(nr-1)*50/100]/1000.0:0,
+                nr?s[(nr-1)*90/100]/1000.0:0,
+                nr?s[(nr-1)*99/100]/1000.0:0,
+                nr?s[nr-1]/1000.0:0,
+                nr?sum/1000.0/nr:0);
+}
+
+/*! Print result of all operations and of all together
+ */
+static int
+load_result(struct load_ctx *lx,
+            int              json)
+{
+    int               retval = -1;
+    struct load_stats all = {0,};
+    struct load_stats *ls;
+    double            sec;
+    int               op;
+    int               first = 1;
+
+    sec = (load_ns() - lx->lx_tstart)/1000000000.0;
+    if (json)
+        fprintf(stdout, "{\"proto\":\"%s\",\"clients\":%d,\"rate\":%d,\"seconds\":%.3f,\"unit\":\"us\",\"operations\":[",
+                lx->lx_proto==LP_INTERNAL?"internal":lx->lx_proto==LP_NETCONF?"netconf":"restconf",
+                lx->lx_clients, lx->lx_rate, sec);
+    else
+        fprintf(stdout, "%-12s %8s %6s %10s %10s %10s %10s %10s %10s %10s\n",
+                "latency(us)", "count", "errors", "req/s", "min", "p50", "p90", "p99", "max", "mean");
+    for (op=0; op<LO_NR; op++){
+        ls = &lx->lx_stats[op];
+        if (ls->ls_nr + ls->ls_errors == 0)
+            continue;
+        if ((all.ls_samples = realloc(all.ls_samples, (all.ls_nr + ls->ls_nr + 1)*sizeof(uint64_t))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        memcpy(all.ls_samples + all.ls_nr, ls->ls_samples, ls->ls_nr*sizeof(uint64_t));
+        all.ls_nr += ls->ls_nr;
+        all.ls_errors += ls->ls_errors;
+        load_print(load_op_names[op], ls, sec, json, first);
+        first = 0;
+    }
+    load_print("all", &all, sec, json, first);
+    if (json)
+        fprintf(stdout, "]}\n");
+    retval = 0;
+ done:
+    if (all.ls_samples)
+        free(all.ls_samples);
+    return retval;
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int             retval = -1;
+    char           *argv0 = argv[0];
+    int             c;
+    int             dbg = 0;
+    int             json = 0;
+    char           *mix = NULL;
+    struct load_ctx lx = {0,};
+    int             op;
+
+    lx.lx_proto = LP_INTERNAL;
+    lx.lx_family = "UNIX";
+    lx.lx_cmd = "clixon_netconf -q";
+    lx.lx_clients = 1;
+    lx.lx_nreq = 1000;
+    lx.lx_keys = 1000;
+    lx.lx_ns = "urn:example:clixon";
+    lx.lx_module = "scaling";
+    lx.lx_mix[LO_GET_CONFIG] = lx.lx_mixsum = 100;
+    clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR);
+    if ((lx.lx_h = clicon_handle_init()) == NULL)
+        goto done;
+    optind = 1;
+    opterr = 0;
+    while ((c = getopt(argc, argv, LOAD_OPTS)) != -1)
+        switch (c) {
+        case 'h':
+            usage(argv0);
+            break;
+        case 'D':
+            if (sscanf(optarg, "%d", &dbg) != 1)
+                usage(argv0);
+            break;
+        case 'p': /* Protocol */
+            if (strcmp(optarg, "internal") == 0)
+                lx.lx_proto = LP_INTERNAL;
+            else if (strcmp(optarg, "netconf") == 0)
+                lx.lx_proto = LP_NETCONF;
+            else if (strcmp(optarg, "restconf") == 0)
+                lx.lx_proto = LP_RESTCONF;
+            else
+                usage(argv0);
+            break;
+        case 'a': /* Internal socket family */
+            lx.lx_family = optarg;
+            break;
+        case 's': /* Socket path or address */
+            lx.lx_sock = optarg;
+            break;
+        case 'P': /* TCP port */
+            if ((lx.lx_port = atoi(optarg)) < 1)
+                usage(argv0);
+            break;
+        case 'C': /* Netconf client command */
+            lx.lx_cmd = optarg;
+            break;
+        case 'c': /* Sessions */
+            if ((lx.lx_clients = atoi(optarg)) < 1)
+                usage(argv0);
+            break;
+        case 'n': /* Requests */
+            if ((lx.lx_nreq = atoi(optarg)) < 1)
+                usage(argv0);
+            break;
+        case 't': /* Duration */
+            if ((lx.lx_duration = atoi(optarg)) < 1)
+                usage(argv0);
+            break;
+        case 'r': /* Rate */
+            if ((lx.lx_rate = atoi(optarg)) < 1)
+                usage(argv0);
+            break;
+        case 'm': /* Mix */
+            mix = optarg;
+            break;
+        case 'k': /* Keys */
+            if ((lx.lx_keys = atoi(optarg)) < 1)
+                usage(argv0);
+            break;
+        case 'y':
+            lx.lx_ns = optarg;
+            break;
+        case 'M':
+            lx.lx_module = optarg;
+            break;
+        case 'W':
+            lx.lx_whole++;
+            break;
+        case 'j':
+            json++;
+            break;
+        default:
+            usage(argv0);
+            break;
+        }
+    clicon_log_init(__FILE__, dbg?LOG_DEBUG:LOG_INFO, CLICON_LOG_STDERR);
+    clicon_debug_init(dbg, NULL);
+
+    if (lx.lx_proto != LP_NETCONF && lx.lx_sock == NULL){
+        fprintf(stderr, "Mandatory option missing: -s <sock>\n");
+        usage(argv0);
+    }
+    if (lx.lx_port == 0)
+        lx.lx_port = lx.lx_proto == LP_RESTCONF ? 80 : 4535;
+    if (mix && load_mix_parse(&lx, mix) < 0)
+        goto done;
+    if (lx.lx_proto == LP_RESTCONF && lx.lx_mix[LO_COMMIT]){
+        clicon_err(OE_UNIX, EINVAL, "commit is not supported by restconf");
+        goto done;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    srandom(getpid());
+    if (load_open(&lx) < 0)
+        goto done;
+    if (load_run(&lx) < 0)
+        goto done;
+    if (load_result(&lx, json) < 0)
+        goto done;
+    retval = 0;
+ done:
+    load_close(&lx);
+    for (op=0; op<LO_NR; op++)
+        if (lx.lx_stats[op].ls_samples)
+            free(lx.lx_stats[op].ls_samples);
+    if (lx.lx_h)
+        clicon_handle_exit(lx.lx_h);
+    return retval;
+}
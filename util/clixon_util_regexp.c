@@ -52,6 +52,10 @@
 #ifdef HAVE_LIBXML2 /* Actually it should check for  a header file */
 #include <libxml/xmlregexp.h>
 #endif
+#ifdef HAVE_LIBPCRE2_8
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+#endif
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -93,6 +97,57 @@ regex_libxml2(char *regexp0,
     return retval;
 }
 
+/*! PCRE2 regex implementation with xsd->pcre2 translation and JIT
+ * @retval -1   Error
+ * @retval  0   Not match
+ * @retval  1   Match
+ */
+static int
+regex_pcre2(char *regexp,
+            char *content,
+            int   nr,
+            int   debug)
+{
+    int               retval = -1;
+#ifdef HAVE_LIBPCRE2_8
+    char             *pcre = NULL;
+    pcre2_code       *re = NULL;
+    pcre2_match_data *md = NULL;
+    int               errcode;
+    PCRE2_SIZE        erroffset;
+    int               ret = 0;
+    int               i;
+
+    if (regexp_xsd2pcre2(regexp, &pcre) < 0)
+        goto done;
+    clicon_debug(1, "pcre2: %s", pcre);
+    if ((re = pcre2_compile((PCRE2_SPTR)pcre, PCRE2_ZERO_TERMINATED,
+                            PCRE2_UTF | PCRE2_UCP | PCRE2_DOLLAR_ENDONLY,
+                            &errcode, &erroffset, NULL)) == NULL){
+        retval = 0;
+        goto done;
+    }
+    (void)pcre2_jit_compile(re, PCRE2_JIT_COMPLETE);
+    if (nr==0){
+        retval = 1;
+        goto done;
+    }
+    if ((md = pcre2_match_data_create(1, NULL)) == NULL)
+        goto done;
+    for (i=0; i<nr; i++)
+        ret = pcre2_match(re, (PCRE2_SPTR)content, PCRE2_ZERO_TERMINATED, 0, 0, md, NULL);
+    retval = ret >= 0 ? 1 : 0;
+ done:
+    if (md)
+        pcre2_match_data_free(md);
+    if (re)
+        pcre2_code_free(re);
+    if (pcre)
+        free(pcre);
+#endif
+    return retval;
+}
+
 static int
 regex_posix(char *regexp,
             char *content,
@@ -147,6 +202,7 @@ usage(char *argv0)
             "\t-D <level>\tDebug\n"
             "\t-p          \txsd->posix translation regexp (default)\n"
             "\t-x          \tlibxml2 regexp (alternative to -p)\n"
+            "\t-P          \txsd->pcre2 translation regexp (alternative to -p)\n"
             "\t-n <nr>     \tIterate content match (default: 1, 0: no match only compile)\n"
             "\t-r <regexp> \tregexp (mandatory)\n"
             "\t-c <string> \tValue content string(mandatory if -n > 0)\n",
@@ -166,12 +222,12 @@ main(int    argc,
     char       *content = NULL;
     int         ret = 0;
     int         nr = 1;
-    int         mode = 0; /* 0 is posix, 1 is libxml */
+    int         mode = 0; /* 0 is posix, 1 is libxml, 2 is pcre2 */
     int         dbg = 0;
 
     optind = 1;
     opterr = 0;
-    while ((c = getopt(argc, argv, "hD:pxn:r:c:")) != -1)
+    while ((c = getopt(argc, argv, "hD:pxPn:r:c:")) != -1)
         switch (c) {
         case 'h':
             usage(argv0);
@@ -190,6 +246,9 @@ main(int    argc,
         case 'x': /* libxml2 */
             mode = 1;
             break;
+        case 'P': /* xsd->pcre2 */
+            mode = 2;
+            break;
         case 'r': /* regexp */
             regexp = optarg;
             break;
@@ -211,8 +270,8 @@ main(int    argc,
         fprintf(stderr, "-c mandatory (if -n > 0)\n");
         usage(argv0);
     }
-    if (mode != 0 && mode != 1){
-        fprintf(stderr, "Neither posix or libxml2 set\n");
+    if (mode != 0 && mode != 1 && mode != 2){
+        fprintf(stderr, "Neither posix, libxml2 or pcre2 set\n");
         usage(argv0);
     }
     clicon_debug(1, "regexp:%s", regexp);
@@ -226,6 +285,10 @@ main(int    argc,
         if ((ret = regex_libxml2(regexp, content, nr, dbg)) < 0)
             goto done;
     }
+    else if (mode == 2){
+        if ((ret = regex_pcre2(regexp, content, nr, dbg)) < 0)
+            goto done;
+    }
     else
         usage(argv0);
     fprintf(stdout, "%d\n", ret);
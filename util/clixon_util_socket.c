@@ -62,6 +62,61 @@
 /* clixon */
 #include "clixon/clixon.h"
 
+/* Number of replies of pipelined requests not yet received */
+static int _pipeline_nr = 0;
+
+/*! Reply of pipelined request, print it and exit event loop after last reply
+ */
+static int
+pipeline_reply(clicon_handle h,
+               cxobj        *xret,
+               void         *arg)
+{
+    if (xret == NULL){
+        clicon_err(OE_PROTO, ESHUTDOWN, "Backend closed connection");
+        return -1;
+    }
+    if (clixon_xml2file(stdout, xml_child_i(xret, 0), 0, 0, NULL, fprintf, 0, 0) < 0)
+        return -1;
+    fprintf(stdout, "\n");
+    if (--_pipeline_nr == 0)
+        clixon_exit_set(1);
+    return 0;
+}
+
+/*! Send request nr times on asynchronous connection without waiting, print replies in order
+ */
+static int
+pipeline_send(clicon_handle h,
+              char         *sockpath,
+              char         *family,
+              char         *xmlstr,
+              int           nr)
+{
+    int                 retval = -1;
+    clicon_rpc_async_t *ra = NULL;
+    int                 i;
+
+    if (clicon_option_str_set(h, "CLICON_SOCK", sockpath) < 0 ||
+        clicon_option_str_set(h, "CLICON_SOCK_FAMILY", family) < 0 ||
+        clicon_option_str_set(h, "CLICON_SOCK_PORT", "4535") < 0)
+        goto done;
+    if ((ra = clicon_rpc_async_open(h)) == NULL)
+        goto done;
+    for (i=0; i<nr; i++){
+        if (clicon_rpc_async_send(ra, xmlstr, pipeline_reply, NULL) < 0)
+            goto done;
+        _pipeline_nr++;
+    }
+    if (clixon_event_loop(h) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (ra)
+        clicon_rpc_async_close(ra);
+    return retval;
+}
+
 static int
 usage(char *argv0)
 {
@@ -73,6 +128,7 @@ usage(char *argv0)
             "\t-s <sockpath> \tPath to unix domain socket (or IP addr)\n"
             "\t-f <file>\tXML input file (overrides stdin)\n"
             "\t-J \t\tInput as JSON (instead of XML)\n"
+            "\t-n <nr>\tSend request nr times pipelined, print replies\n"
             ,
             argv0);
     exit(0);
@@ -101,6 +157,7 @@ main(int    argc,
     int                dbg = 0;
     int                s;
     int                eof = 0;
+    int                nr = 0;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR); 
@@ -110,7 +167,7 @@ main(int    argc,
 
     optind = 1;
     opterr = 0;
-    while ((c = getopt(argc, argv, "hD:s:f:Ja:")) != -1)
+    while ((c = getopt(argc, argv, "hD:s:f:Ja:n:")) != -1)
         switch (c) {
         case 'h':
             usage(argv[0]);
@@ -131,6 +188,10 @@ main(int    argc,
         case 'a':
             family = optarg;
             break;
+        case 'n':
+            if (sscanf(optarg, "%d", &nr) != 1)
+                usage(argv[0]);
+            break;
         default:
             usage(argv[0]);
             break;
@@ -169,6 +230,12 @@ main(int    argc,
     }
     if (clixon_xml2cbuf(cb, xc, 0, 0, NULL, -1, 0) < 0)
         goto done;
+    if (nr > 0){
+        if (pipeline_send(h, sockpath, family, cbuf_get(cb), nr) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
     if ((msg = clicon_msg_encode(getpid(), "%s", cbuf_get(cb))) < 0)
         goto done;
     if (strcmp(family, "UNIX")==0){
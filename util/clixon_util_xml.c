@@ -67,7 +67,7 @@
 #include "clixon/clixon.h"
 
 /* Command line options passed to getopt(3) */
-#define UTIL_XML_OPTS "hD:f:JjXl:pvoy:Y:t:T:u"
+#define UTIL_XML_OPTS "hD:f:JjxXl:pvoy:Y:t:T:uS"
 
 static int
 validate_tree(clicon_handle h,
@@ -118,6 +118,7 @@ usage(char *argv0)
             "\t-f <file>\tXML input file (overrides stdin)\n"
             "\t-J \t\tInput as JSON\n"
             "\t-j \t\tOutput as JSON\n"
+            "\t-x \t\tInput as TEXT (requires -y)\n"
             "\t-X \t\tOutput as TEXT \n"
             "\t-l <s|e|o> \tLog on (s)yslog, std(e)rr, std(o)ut (stderr is default)\n"
             "\t-o \t\tOutput the file\n"
@@ -128,6 +129,7 @@ usage(char *argv0)
             "\t-t <file>\tXML top input file (where base tree is pasted to)\n"
             "\t-T <path>\tXPath to where in top input file base should be pasted\n"
             "\t-u \t\tTreat unknown XML as anydata\n"
+            "\t-S \t\tParse XML and TEXT with hand-written scanner\n"
             ,
             argv0);
     exit(0);
@@ -144,6 +146,7 @@ main(int    argc,
     int           c;
     int           logdst = CLICON_LOG_STDERR;
     int           jsonin = 0;
+    int           textin = 0;
     int           jsonout = 0;
     int           textout = 0;
     char         *input_filename = NULL;
@@ -195,6 +198,9 @@ main(int    argc,
         case 'J':
             jsonin++;
             break;
+        case 'x':
+            textin++;
+            break;
         case 'j':
             jsonout++;
             break;
@@ -232,6 +238,10 @@ main(int    argc,
                 goto done;
             xml_bind_yang_unknown_anydata(1);
             break;
+        case 'S':
+            clixon_xml_parse_scanner(1);
+            clixon_text_syntax_parse_scanner(1);
+            break;
         default:
             usage(argv[0]);
             break;
@@ -309,6 +319,16 @@ main(int    argc,
             goto done;
         }
     }
+    else if (textin){
+        if ((ret = clixon_text_syntax_parse_file(fp, YB_MODULE, yspec, &xt, &xerr)) < 0){
+            fprintf(stderr, "text parse error: %s\n", clicon_err_reason);
+            goto done;
+        }
+        if (ret == 0){
+            clixon_netconf_error(xerr, "util_xml", NULL);
+            goto done;
+        }
+    }
     else{ /* XML */
         if (!yang_file_dir)
             yb = YB_NONE;